@@ -0,0 +1,95 @@
+#version 330 core
+#extension GL_ARB_compute_shader : require
+#extension GL_ARB_shader_storage_buffer_object : require
+
+// Each work group culls the instances of one draw command, a few at a time.
+layout(local_size_x = 64) in;
+
+// The instance data of the frame as the CPU uploaded it, and the buffer the instances in view are compacted into, with
+//   the same layout, both read as words so the matrices, masks, handles and spins can all be copied the same way.
+layout(std430) readonly buffer SourceInstanceBlock
+{
+	uint sourceInstanceWords[];
+};
+layout(std430) writeonly buffer CulledInstanceBlock
+{
+	uint culledInstanceWords[];
+};
+// The draw commands, whose instance counts start at 0 and count the instances kept, and the jobs of the commands, with
+//   the number of instances of the command, and the sphere around the mesh drawn and the cone around its normals, in the
+//   space of its vertices.
+layout(std430) buffer CommandBlock
+{
+	uint commandWords[];
+};
+
+// The planes of the frustum of the camera, with the normals pointing inside the frustum.
+uniform vec4 frustumPlanes[6];
+// The first words of the matrices, the shadow masks, the texture handles and the spins of the instances of the frame.
+uniform uvec4 instanceWordBases;
+// The first words of the draw commands and of their jobs.
+uniform uvec2 commandWordBases;
+// The position of the camera, which the meshlets drawn on their own are left out of view of when they face away from it.
+uniform vec3 cameraPosition;
+
+// Copy a number of words of an instance from the uploaded instance data to the compacted slot.
+void copyInstanceWords(uint wordBase, uint wordsCount, uint sourceInstance, uint culledInstance)
+{
+	for (uint i = 0u; i < wordsCount; i++)
+	{
+		culledInstanceWords[wordBase + culledInstance * wordsCount + i] = sourceInstanceWords[wordBase + sourceInstance * wordsCount + i];
+	}
+}
+
+void main()
+{
+	uint commandWord = commandWordBases.x + gl_WorkGroupID.x * 5u;
+	uint jobWord = commandWordBases.y + gl_WorkGroupID.x * 9u;
+	uint instanceCount = commandWords[jobWord];
+	vec4 boundingSphere = uintBitsToFloat(uvec4(commandWords[jobWord + 1u], commandWords[jobWord + 2u], commandWords[jobWord + 3u], commandWords[jobWord + 4u]));
+	vec4 normalCone = uintBitsToFloat(uvec4(commandWords[jobWord + 5u], commandWords[jobWord + 6u], commandWords[jobWord + 7u], commandWords[jobWord + 8u]));
+	uint baseInstance = commandWords[commandWord + 4u];
+
+	for (uint i = gl_LocalInvocationID.x; i < instanceCount; i += gl_WorkGroupSize.x)
+	{
+		// Read the model matrix of the instance, move the centre of the sphere with it, and grow the sphere by the largest
+		//   scale of its axes. The spheres of the meshes spun in the vertex shader are around their vertical axis, so the
+		//   spins don't move them.
+		uint sourceInstance = baseInstance + i;
+		uint matrixWord = instanceWordBases.x + sourceInstance * 16u;
+		mat4 modelMatrix;
+		for (uint column = 0u; column < 4u; column++)
+		{
+			modelMatrix[column] = uintBitsToFloat(uvec4(sourceInstanceWords[matrixWord + column * 4u], sourceInstanceWords[matrixWord + column * 4u + 1u],
+																									 sourceInstanceWords[matrixWord + column * 4u + 2u], sourceInstanceWords[matrixWord + column * 4u + 3u]));
+		}
+		vec3 center = (modelMatrix * vec4(boundingSphere.xyz, 1.0)).xyz;
+		float radius = boundingSphere.w * max(length(modelMatrix[0].xyz), max(length(modelMatrix[1].xyz), length(modelMatrix[2].xyz)));
+
+		// Leave out the instance if its sphere is entirely behind any of the planes.
+		bool inView = true;
+		for (int plane = 0; plane < 6; plane++)
+		{
+			inView = inView && dot(frustumPlanes[plane].xyz, center) + frustumPlanes[plane].w >= -radius;
+		}
+		// Leave out the instance as well if the camera is inside the cone of directions all the triangles of its meshlet
+		//   face away from, grown by the sphere around the meshlet. The axis of the cone is in the space of the vertices, so
+		//   the model matrix turns it like the normals.
+		if (inView && normalCone.w < 1.0)
+		{
+			vec3 cameraDirection = center - cameraPosition;
+			inView = dot(cameraDirection, normalize(mat3(modelMatrix) * normalCone.xyz)) < normalCone.w * length(cameraDirection) + radius;
+		}
+		if (!inView)
+		{
+			continue;
+		}
+
+		// Take the next slot of the command, and copy the instance data there, so the draw reads the instances kept in order.
+		uint culledInstance = baseInstance + atomicAdd(commandWords[commandWord + 1u], 1u);
+		copyInstanceWords(instanceWordBases.x, 16u, sourceInstance, culledInstance);
+		copyInstanceWords(instanceWordBases.y, 1u, sourceInstance, culledInstance);
+		copyInstanceWords(instanceWordBases.z, 2u, sourceInstance, culledInstance);
+		copyInstanceWords(instanceWordBases.w, 2u, sourceInstance, culledInstance);
+	}
+}
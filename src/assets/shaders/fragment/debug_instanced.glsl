@@ -1,15 +1,15 @@
 #version 330 core
 
-// The color to use for coloring the object line fragments.
-uniform vec4 lineColor;
+// The line color of the instance the fragment belongs to.
+in vec4 fragmentColor;
 
 // The final color of the fragment.
 out vec4 color;
 
 void main()
 {
-	// We color the line as defined by the debug renderer.
+	// We color the line as defined by the debug renderer for the instance.
 	// This is because we need to use different colors for
 	//   different kinds of debug information.
-	color = lineColor;
-}
\ No newline at end of file
+	color = fragmentColor;
+}
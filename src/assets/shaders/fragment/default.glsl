@@ -2,6 +2,8 @@
 
 #extension GL_ARB_texture_cube_map_array: require
 
+#include "../include/diffuse_texture_fragment.glsl"
+
 // The reason for suffixing structures and uniform variables with
 //   the shader component name, is so that they don't collide with
 //   definitions in other shaders.
@@ -16,9 +18,65 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
-#define MAX_SIMPLE_LIGHTS 2
-#define MAX_CUBE_LIGHTS 5
-
+// The sizes of the light arrays, MAX_SIMPLE_LIGHTS, MAX_CUBE_LIGHTS and MAX_DIRECTIONAL_LIGHTS, the number of cascades
+//   of each directional light, SHADOW_CASCADES_COUNT, and the number of light clusters along the
+//   width, height and depth of the view frustum, CLUSTER_GRID_WIDTH, CLUSTER_GRID_HEIGHT and CLUSTER_GRID_DEPTH, are
+//   defined by the shader manager from the constants of the game, so they always match the render manager.
+
+// The quality tiers of shadow filtering. The render manager picks the tier by compiling a variant of the shader with
+//   SHADOW_QUALITY defined, and the full kernel is used when it isn't defined.
+// LOW takes a single hardware filtered comparison, MEDIUM a rotated Poisson disk of them, and HIGH the full kernel of
+//   unfiltered comparisons for the flat shadow maps and a cube of filtered comparisons covering the same texels for the
+//   point lights.
+#define SHADOW_QUALITY_LOW 0
+#define SHADOW_QUALITY_MEDIUM 1
+#define SHADOW_QUALITY_HIGH 2
+#ifndef SHADOW_QUALITY
+#define SHADOW_QUALITY SHADOW_QUALITY_HIGH
+#endif
+// The number of Poisson disk samples taken per light by the medium shadow quality tier.
+#define SHADOW_POISSON_SAMPLES 8
+
+// The number of active lights and the disabled features can be fixed when the shader is compiled, by the render manager
+//   defining them when picking a shader variant, so the loops and branches over them are resolved by the compiler.
+//   Otherwise they're read from the uniforms every time.
+#ifdef CONE_LIGHTS_COUNT
+#define ACTIVE_CONE_LIGHTS_COUNT CONE_LIGHTS_COUNT
+#else
+#define ACTIVE_CONE_LIGHTS_COUNT coneLightsCount
+#endif
+#ifdef POINT_LIGHTS_COUNT
+#define ACTIVE_POINT_LIGHTS_COUNT POINT_LIGHTS_COUNT
+#else
+#define ACTIVE_POINT_LIGHTS_COUNT pointLightsCount
+#endif
+#ifdef DIRECTIONAL_LIGHTS_COUNT
+#define ACTIVE_DIRECTIONAL_LIGHTS_COUNT DIRECTIONAL_LIGHTS_COUNT
+#else
+#define ACTIVE_DIRECTIONAL_LIGHTS_COUNT directionalLightsCount
+#endif
+#ifdef DISABLE_FEATURE_MASK
+#define ACTIVE_DISABLE_FEATURE_MASK DISABLE_FEATURE_MASK
+#else
+#define ACTIVE_DISABLE_FEATURE_MASK disableFeatureMask
+#endif
+
+// The shader runs in one of three modes. By default it shades the fragments of a model directly (forward shading).
+//   With DEFERRED_GBUFFER defined, it only records the surface details of the fragments of a model in the geometry
+//   buffer. With DEFERRED_LIGHTING defined, it runs once per pixel of the screen and shades the surface details read
+//   back from the geometry buffer.
+#ifdef DEFERRED_LIGHTING
+// The details of the fragment, read back from the geometry buffer at the start of the shader instead of being
+//   interpolated from the vertex shader.
+vec4 fragmentPosition_worldSpace;
+vec4 fragmentPosition_viewSpace;
+vec3 fragmentNormal_viewSpace;
+vec4 coneLightShadowMapCoord[MAX_SIMPLE_LIGHTS];
+vec4 coneLightPosition_viewSpace[MAX_SIMPLE_LIGHTS];
+vec4 pointLightPosition_viewSpace[MAX_CUBE_LIGHTS];
+// The lighting pass has no model to pick the lights that can reach the pixel from, so it is lit by all of them.
+const uint fragmentLightMask = 0xffffffffu;
+#else
 // The UV coordinates of the diffuse color of the fragment in the standard object texture.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 in vec2 fragmentUv;
@@ -28,9 +86,18 @@ in vec4 fragmentPosition_worldSpace;
 // The coordinates of the fragment in the standard object model in view-space.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 in vec4 fragmentPosition_viewSpace;
+#ifdef IMPOSTOR
+// The normal vector of the fragment in view-space, read from the views of the impostor at the start of the shader
+//   instead of being interpolated across its quad.
+vec3 fragmentNormal_viewSpace;
+// The views of the impostor instance, and the directions of their axes in view-space.
+flat in vec4 fragmentImpostor;
+flat in mat3 fragmentImpostorBasis_viewSpace;
+#else
 // The normal vector of the fragment in the standard object model in view-space.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 in vec3 fragmentNormal_viewSpace;
+#endif
 
 // The shadow map coordinates of the current fragment w.r.t all the active cone lights.
 in vec4 coneLightShadowMapCoord[MAX_SIMPLE_LIGHTS];
@@ -42,50 +109,77 @@ in vec4 coneLightPosition_viewSpace[MAX_SIMPLE_LIGHTS];
 // Since this value would be the same for all vertices, interpolation won't affect anything.
 in vec4 pointLightPosition_viewSpace[MAX_CUBE_LIGHTS];
 
+// The mask of the shadowed lights that can reach the fragment, with a bit per cone light followed by a bit per point
+//   light and then a bit per directional light.
+flat in uint fragmentLightMask;
+#endif
 
+
+#ifdef DEFERRED_GBUFFER
+// The albedo of the fragment, with an alpha of 1 marking it as covered.
+layout(location = 0) out vec4 geometryAlbedo;
+// The normal vector of the fragment in view-space, with a w of 1 marking it as lit.
+layout(location = 1) out vec4 geometryNormal;
+#else
 // The final color of the fragment.
 out vec3 color;
+#endif
 
 
-// The structure defining the details regarding the model.
-struct ModelDetails_Fragment
-{
-	// mat4 modelMatrix;
-	mat4 viewMatrix;
-	// mat4 projectionMatrix;
-};
-// The structure defining the details regarding the active lights.
-struct LightDetails_Fragment
-{
-	vec3 lightPosition;
-	// mat4 lightVpMatrix;
-	vec3 lightColorIntensity;
-	// float nearPlane;
-	float farPlane;
-	int layerId;
-};
 
+#ifdef DEFERRED_LIGHTING
+// The texture samplers of the albedo, view-space normals and depths recorded in the geometry buffer.
+uniform sampler2D geometryAlbedoTexture;
+uniform sampler2D geometryNormalTexture;
+uniform sampler2D geometryDepthTexture;
+
+// The inverses of the view and projection matrices of the active camera, for getting the position of a pixel back
+//   from its depth.
+uniform mat4 inverseViewMatrix;
+uniform mat4 inverseProjectionMatrix;
+// The size of the part of the geometry buffer the scene was drawn to, from its bottom-left corner, in pixels.
+uniform vec2 geometryViewportSize;
 
-// The details of the model.
-uniform ModelDetails_Fragment modelDetails_fragment;
+#include "../include/camera.glsl"
+#endif
 
-// The standard object texture sampler.
-uniform sampler2D diffuseTexture;
+#ifdef IMPOSTOR
+// The texture arrays holding the albedo and the normals of the views of the objects drawn as impostors.
+uniform sampler2DArray impostorAlbedoTextures;
+uniform sampler2DArray impostorNormalTextures;
+#endif
 
+#if SHADOW_QUALITY == SHADOW_QUALITY_HIGH
+// The type of the texture samplers of the arrays of flat shadow maps, of cone lights and of directional light cascades.
+#define FLAT_SHADOW_SAMPLER sampler2DArray
 // The texture sampler of the array of shadow maps of cone lights (2D texture lights).
 uniform sampler2DArray coneLightTextures;
-// The texture samplers of the array of shadow maps of point lights (cubemap texture lights).
-uniform samplerCubeArray pointLightTextures;
-
-// The number of active cone lights (2D texture lights).
-uniform int coneLightsCount;
-// The number of active point lights (cubemap texture lights).
-uniform int pointLightsCount;
-
-// The details of the active cone lights (2D texture lights).
-uniform LightDetails_Fragment coneLightDetails_fragment[MAX_SIMPLE_LIGHTS];
-// The details of the active point lights (cubemap texture lights).
-uniform LightDetails_Fragment pointLightDetails_fragment[MAX_CUBE_LIGHTS];
+// The texture sampler of the array of the cascades of the shadow maps of directional lights.
+uniform sampler2DArray directionalLightTextures;
+#else
+// The type of the texture samplers of the arrays of flat shadow maps, of cone lights and of directional light cascades.
+#define FLAT_SHADOW_SAMPLER sampler2DArrayShadow
+// The texture sampler of the array of shadow maps of cone lights (2D texture lights), read with depth comparisons.
+uniform sampler2DArrayShadow coneLightTextures;
+// The texture sampler of the array of the cascades of the shadow maps of directional lights, read with depth comparisons.
+uniform sampler2DArrayShadow directionalLightTextures;
+#endif
+// The texture samplers of the array of shadow maps of point lights (cubemap texture lights), read with hardware filtered
+//   depth comparisons by every quality tier, since a comparison in the shader could only read one texel per sample.
+uniform samplerCubeArrayShadow pointLightTextures;
+
+// The view-space positions and radii (first texel) and the colors multiplied by intensity (second texel)
+//   of the lights without shadows.
+uniform samplerBuffer clusteredLights;
+// The offset and count of the light indices of each light cluster.
+uniform usamplerBuffer clusterLightRanges;
+// The indices of the lights of all the light clusters, which the ranges of the clusters point into.
+uniform usamplerBuffer clusterLightIndices;
+// The position of the bottom-left corner of the viewport of the view in the framebuffer, in pixels, which the screen
+//   positions of the fragments are taken relative to.
+uniform vec2 viewportOffset;
+
+#include "../include/lights.glsl"
 
 // The ambient light factor to use.
 // This defines how much of the surface color is visible from ambient lighting.
@@ -97,6 +191,7 @@ uniform int disableFeatureMask;
 // The bias values to use to combat acne bias with the various light source types.
 float coneLightAcneBias = 0.0001;
 float pointLightAcneBias = 0.05;
+float directionalLightAcneBias = 0.0005;
 
 // The specular values to use that define specular reflectivity and the lobe size.
 // This could also be passed using a specular map, which would also allow to define
@@ -105,38 +200,44 @@ float specularReflectivity = 0.5;
 float specularLobeFactor = 3.5;
 
 // The mask flags for disabling shadows and lighting.
-int DISABLE_SHADOW = 1;
-int DISABLE_LIGHT = 2;
+const int DISABLE_SHADOW = 1;
+const int DISABLE_LIGHT = 2;
 
 /**
  * Function that returns the size of a single texel (texture-pixel) of the given
- *   cone light shadow map texture.
+ *   cone light (or directional light cascade) shadow map, relative to the size of
+ *   its shadow atlas tile.
+ *
+ * @param shadowMaps  The array of the shadow maps.
+ * @param tileBounds  The texture coordinates of the corners of the shadow atlas tile.
  *
- * @return The texel size of the texture.
+ * @return The texel size of the shadow map.
  */
-vec2 getConeLightShadowMapTexelValue()
+vec2 getConeLightShadowMapTexelValue(FLAT_SHADOW_SAMPLER shadowMaps, vec4 tileBounds)
 {
 	// Grab the shadow map texture size from the sampler array
 	//   (just the first two coordinates, the third indicates number of layers in the
 	//   sampler array).
-	vec2 shadowMapSize = textureSize(coneLightTextures, 0).xy;
-	// Calculate the size of a single texel by taking the inverse of the texture size,
-	//   and return it.
-	return 1.0 / shadowMapSize;
+	vec2 shadowMapSize = textureSize(shadowMaps, 0).xy;
+	// Calculate the size of a single texel by taking the inverse of the size of the
+	//   tile in the texture, and return it.
+	return 1.0 / (shadowMapSize * (tileBounds.zw - tileBounds.xy));
 }
 
 /**
  * Function that returns the size of a single texel (texture-pixel) of the given
- *   point light shadow map texture.
+ *   point light shadow map, relative to the size of its shadow atlas tile.
  *
- * @return The texel size of the texture.
+ * @param tileBounds  The texture coordinates of the corners of the shadow atlas tile.
+ *
+ * @return The texel size of the shadow map.
  */
-vec3 getPointLightShadowMapTexelValue()
+vec3 getPointLightShadowMapTexelValue(vec4 tileBounds)
 {
 	// Grab the shadow map texture size value depending on which index is provided
 	//   (just the first two coordinates, the third indicates number of layers in the
-	//   sampler array).
-	vec2 shadowMapSize = textureSize(pointLightTextures, 0).xy;
+	//   sampler array), and scale it down to the size of the tile.
+	vec2 shadowMapSize = textureSize(pointLightTextures, 0).xy * (tileBounds.zw - tileBounds.xy);
 	// Calculate the size of a single texel by taking the inverse of the texture size,
 	//   and return it. The third coordinate is calculated by taking the average of the
 	//   size of the texture on the x-axis and y-axis.
@@ -144,82 +245,180 @@ vec3 getPointLightShadowMapTexelValue()
 }
 
 /**
- * Function that returns the closest depth value recorded in the given cone
- *   light shadow map texture at the given UV coordinates.
+ * Function that moves the given UV coordinates of a cone light (or directional
+ *   light cascade) shadow map into its shadow atlas tile.
  *
- * @param coords   The UV coordinates from where to get the closest depth value.
- * @param layerId  The index of the cone light shadow map texture to use.
+ * @param shadowMaps  The array of the shadow maps.
+ * @param coords      The UV coordinates in the shadow map.
+ * @param tileBounds  The texture coordinates of the corners of the shadow atlas tile.
  *
- * @return The closest depth value at the given UV coordinates.
+ * @return The texture coordinates in the tile.
  */
-float getConeLightShadowMapCoordValue(vec2 coords, int layerId)
+vec2 getConeLightTileCoords(FLAT_SHADOW_SAMPLER shadowMaps, vec2 coords, vec4 tileBounds)
 {
-	// Grab the closest depth value from the shadow map indexed at the given layer.
-	// We grab the value from the red channel because that is where the depth value
-	//   is recorded.
-	return texture(coneLightTextures, vec3(coords, layerId)).r;
+	// Move the coordinates into the tile, keeping them half a texel away from its
+	//   edges so the neighbouring tiles are never sampled (even by filtering).
+	vec2 halfTexelSize = 0.5 / textureSize(shadowMaps, 0).xy;
+	return clamp(mix(tileBounds.xy, tileBounds.zw, coords), tileBounds.xy + halfTexelSize, tileBounds.zw - halfTexelSize);
+}
+
+/**
+ * Function that moves the given direction in a point light cube map to point at
+ *   the same place in the shadow atlas tile of the light, on the same face.
+ *
+ * @param coords      The direction in the cube map.
+ * @param tileBounds  The texture coordinates of the corners of the shadow atlas tile.
+ *
+ * @return The direction pointing into the tile.
+ */
+vec3 getPointLightTileCoords(vec3 coords, vec4 tileBounds)
+{
+	// Pick the face of the cube map the direction points at, the same way the GPU
+	//   does, along with the coordinates on the face before dividing by the major axis.
+	vec3 absCoords = abs(coords);
+	int face;
+	float majorAxis;
+	vec2 faceCoords;
+	if (absCoords.x >= absCoords.y && absCoords.x >= absCoords.z)
+	{
+		face = coords.x > 0.0 ? 0 : 1;
+		majorAxis = absCoords.x;
+		faceCoords = vec2(coords.x > 0.0 ? -coords.z : coords.z, -coords.y);
+	}
+	else if (absCoords.y >= absCoords.z)
+	{
+		face = coords.y > 0.0 ? 2 : 3;
+		majorAxis = absCoords.y;
+		faceCoords = vec2(coords.x, coords.y > 0.0 ? coords.z : -coords.z);
+	}
+	else
+	{
+		face = coords.z > 0.0 ? 4 : 5;
+		majorAxis = absCoords.z;
+		faceCoords = vec2(coords.z > 0.0 ? coords.x : -coords.x, -coords.y);
+	}
+
+	// Move the UV coordinates on the face into the tile, keeping them half a texel
+	//   away from its edges so the neighbouring tiles are never sampled.
+	vec2 halfTexelSize = 0.5 / textureSize(pointLightTextures, 0).xy;
+	vec2 tileCoords = clamp(mix(tileBounds.xy, tileBounds.zw, (faceCoords / majorAxis) * 0.5 + 0.5), tileBounds.xy + halfTexelSize, tileBounds.zw - halfTexelSize);
+
+	// Turn the coordinates in the tile back into a direction pointing at the same face.
+	vec2 sc = tileCoords * 2.0 - 1.0;
+	if (face == 0)
+	{
+		return vec3(1.0, -sc.y, -sc.x);
+	}
+	if (face == 1)
+	{
+		return vec3(-1.0, -sc.y, sc.x);
+	}
+	if (face == 2)
+	{
+		return vec3(sc.x, 1.0, sc.y);
+	}
+	if (face == 3)
+	{
+		return vec3(sc.x, -1.0, -sc.y);
+	}
+	if (face == 4)
+	{
+		return vec3(sc.x, -sc.y, 1.0);
+	}
+	return vec3(-sc.x, -sc.y, -1.0);
+}
+
+/**
+ * Function that returns the visibility of the fragment from the given
+ *   point light source, with a single hardware filtered depth comparison.
+ *
+ * @param shadowMapCoords  The shadow map coordinates of the current fragment.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source.
+ * @param layerId          The index of the point light shadow map texture to use.
+ * @param farPlane         The maximum distance the light source can travel till.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ *
+ * @return The visibility of the fragment.
+ */
+float getPointLightVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane, vec4 tileBounds)
+{
+	// The point light shadow maps record the depth divided by the far plane, so the depth of the fragment
+	//   (accounting for some bias) is divided the same way before comparing.
+	return texture(pointLightTextures, vec4(getPointLightTileCoords(shadowMapCoords, tileBounds), layerId), (currentDepth - pointLightAcneBias) / farPlane);
 }
 
+#if SHADOW_QUALITY == SHADOW_QUALITY_HIGH
+
 /**
- * Function that returns the closest depth value recorded in the given point
- *   light shadow map at the given UV coordinates.
+ * Function that returns the closest depth value recorded in the given cone
+ *   light (or directional light cascade) shadow map texture at the given UV
+ *   coordinates.
  *
- * @param coords    The UV coordinates from where to get the closest depth value.
- * @param layerId   The index of the point light shadow map texture to use.
- * @param farPlane  The maximum distance the light source can travel till.
+ * @param shadowMaps  The array of the shadow maps.
+ * @param coords      The UV coordinates from where to get the closest depth value.
+ * @param layerId     The index of the shadow map texture to use.
+ * @param tileBounds  The texture coordinates of the corners of the shadow atlas tile.
  *
  * @return The closest depth value at the given UV coordinates.
  */
-float getPointLightShadowMapCoordValue(vec3 coords, int layerId, float farPlane)
+float getConeLightShadowMapCoordValue(FLAT_SHADOW_SAMPLER shadowMaps, vec2 coords, int layerId, vec4 tileBounds)
 {
+	// Coordinates outside the shadow map are always in shadow, since other shadow
+	//   maps share the layer around the tile.
+	if (any(lessThan(coords, vec2(0.0))) || any(greaterThan(coords, vec2(1.0))))
+	{
+		return 0.0;
+	}
 	// Grab the closest depth value from the shadow map indexed at the given layer.
 	// We grab the value from the red channel because that is where the depth value
 	//   is recorded.
-	float closestDepth = texture(pointLightTextures, vec4(coords, layerId)).r;
-	// Since for point lights, we divided the actual depth against the max distance
-	//   the light could reach till (the far plane), multiply by the same value again
-	//   to the actual value back and return it.
-	return closestDepth * farPlane;
+	return texture(shadowMaps, vec3(getConeLightTileCoords(shadowMaps, coords, tileBounds), layerId)).r;
 }
 
 /**
  * Function that returns the visibility of the fragment from the given
- *   cone light source.
+ *   cone light source (or directional light cascade).
  *
+ * @param shadowMaps       The array of the shadow maps.
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
  * @param currentDepth     The depth of the current fragment w.r.t. the light source.
- * @param layerId          The index of the cone light shadow map texture to use.
+ * @param layerId          The index of the shadow map texture to use.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ * @param acneBias         The bias to combat acne with for the type of light source.
  *
  * @return The visibility of the fragment.
  */
-float getConeLightVisibility(vec2 shadowMapCoords, float currentDepth, int layerId)
+float getConeLightVisibility(FLAT_SHADOW_SAMPLER shadowMaps, vec2 shadowMapCoords, float currentDepth, int layerId, vec4 tileBounds, float acneBias)
 {
 	// Grab the depth of the fragment that was closest to the light source at the given coordinates from the
 	//   shadow map at the given layer.
-	float closestDepth = getConeLightShadowMapCoordValue(shadowMapCoords, layerId);
+	float closestDepth = getConeLightShadowMapCoordValue(shadowMaps, shadowMapCoords, layerId, tileBounds);
 	// If the depth of the current fragment w.r.t. the light source is larger than the depth of the closest
 	//   recorded fragment (accounting for some bias), that means the current fragment is not visible to the
 	//   light source, so the fragment should not be visible. If this is the case, return 0, otherwise return 1.
-	return currentDepth - coneLightAcneBias > closestDepth ? 0.0 : 1.0;
+	return currentDepth - acneBias > closestDepth ? 0.0 : 1.0;
 }
 
 /**
  * Function that returns the average visibility of the fragment from the given
- *   cone light source by taking multiple samples at and around the given shadow
+ *   cone light source (or directional light cascade) by taking multiple samples at and around the given shadow
  *   map coordinates.
  *
+ * @param shadowMaps       The array of the shadow maps.
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
  * @param currentDepth     The depth of the current fragment w.r.t. the light source.
- * @param layerId          The index of the cone light shadow map texture to use.
+ * @param layerId          The index of the shadow map texture to use.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ * @param acneBias         The bias to combat acne with for the type of light source.
  *
  * @return The average visibility of the fragment.
  */
-float getConeLightAverageVisibility(vec2 shadowMapCoords, float currentDepth, int layerId)
+float getConeLightAverageVisibility(FLAT_SHADOW_SAMPLER shadowMaps, vec2 shadowMapCoords, float currentDepth, int layerId, vec4 tileBounds, float acneBias)
 {
 	// Define the variable where we'll store the average visibility.
   float visibility = 0.0;
 	// Get the texel size of the shadow map texture.
-	vec2 texelSize = getConeLightShadowMapTexelValue();
+	vec2 texelSize = getConeLightShadowMapTexelValue(shadowMaps, tileBounds);
 	// We'll sample the closest depth values from the given coordinate and the
 	//   immediately surrounding coordinates as well to get a better average
 	//   visibility value.
@@ -228,7 +427,7 @@ float getConeLightAverageVisibility(vec2 shadowMapCoords, float currentDepth, in
 		for (int y = -2; y <= 2; y++)
 		{
 			// Get the visibility of the fragment at the given shadow map coordinates (with variance).
-			visibility += getConeLightVisibility(shadowMapCoords + (vec2(x, y) * texelSize), currentDepth, layerId);
+			visibility += getConeLightVisibility(shadowMaps, shadowMapCoords + (vec2(x, y) * texelSize), currentDepth, layerId, tileBounds, acneBias);
 		}
 	}
 	// Return the average visibility across the number of shadow map samples taken (5 * 5 = 25).
@@ -242,52 +441,228 @@ float getConeLightAverageVisibility(vec2 shadowMapCoords, float currentDepth, in
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
  * @param currentDepth     The depth of the current fragment w.r.t. the light source.
  * @param layerId          The index of the point light shadow map texture to use.
+ * @param farPlane         The maximum distance the light source can travel till.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ *
+ * @return The average visibility of the fragment.
+ */
+float getPointLightAverageVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane, vec4 tileBounds)
+{
+	// Define the variable where we'll store the average visibility.
+  float visibility = 0.0;
+	// Get the texel size of the shadow map texture.
+	vec3 texelSize = getPointLightShadowMapTexelValue(tileBounds);
+	// Each filtered comparison already averages the closest four texels, so sampling at the corners of a cube half
+	//   a texel away from the given coordinates covers the same texels as the 3 * 3 * 3 kernel of single comparisons.
+	for (int x = -1; x <= 1; x += 2)
+	{
+		for (int y = -1; y <= 1; y += 2)
+		{
+			for (int z = -1; z <= 1; z += 2)
+			{
+				// Get the visibility of the fragment at the given shadow map coordinates (with variance).
+				visibility += getPointLightVisibility(shadowMapCoords + (vec3(x, y, z) * 0.5 * texelSize), currentDepth, layerId, farPlane, tileBounds);
+			}
+		}
+	}
+	// Return the average visibility across the number of shadow map samples taken (2 * 2 * 2 = 8).
+  return visibility / 8.0;
+}
+
+#else
+
+/**
+ * Function that returns the visibility of the fragment from the given
+ *   cone light source (or directional light cascade), with a single hardware filtered depth comparison.
+ *
+ * @param shadowMaps       The array of the shadow maps.
+ * @param shadowMapCoords  The shadow map coordinates of the current fragment.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source.
+ * @param layerId          The index of the shadow map texture to use.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ * @param acneBias         The bias to combat acne with for the type of light source.
  *
  * @return The visibility of the fragment.
  */
-float getPointLightVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane)
+float getConeLightVisibility(FLAT_SHADOW_SAMPLER shadowMaps, vec2 shadowMapCoords, float currentDepth, int layerId, vec4 tileBounds, float acneBias)
 {
-	// Grab the depth of the fragment that was closest to the light source at the given coordinates from the
-	//   shadow map at the given layer.
-	float closestDepth = getPointLightShadowMapCoordValue(shadowMapCoords, layerId, farPlane);
-	// If the depth of the current fragment w.r.t. the light source is larger than the depth of the closest
-	//   recorded fragment (accounting for some bias), that means the current fragment is not visible to the
-	//   light source, so the fragment should not be visible. If this is the case, return 0, otherwise return 1.
-	return currentDepth - pointLightAcneBias > closestDepth ? 0.0 : 1.0;
+	// Coordinates outside the shadow map are always in shadow, since other shadow
+	//   maps share the layer around the tile.
+	if (any(lessThan(shadowMapCoords, vec2(0.0))) || any(greaterThan(shadowMapCoords, vec2(1.0))))
+	{
+		return 0.0;
+	}
+	// Compare the depth of the fragment (accounting for some bias) against the four closest recorded depths
+	//   in the tile, and return the filtered result.
+	return texture(shadowMaps, vec4(getConeLightTileCoords(shadowMaps, shadowMapCoords, tileBounds), layerId, currentDepth - acneBias));
 }
 
+#if SHADOW_QUALITY == SHADOW_QUALITY_LOW
+
 /**
  * Function that returns the average visibility of the fragment from the given
- *   point light source.
+ *   cone light source (or directional light cascade). The single filtered comparison already averages the
+ *   closest four texels.
+ *
+ * @param shadowMaps       The array of the shadow maps.
+ * @param shadowMapCoords  The shadow map coordinates of the current fragment.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source.
+ * @param layerId          The index of the shadow map texture to use.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ * @param acneBias         The bias to combat acne with for the type of light source.
+ *
+ * @return The average visibility of the fragment.
+ */
+float getConeLightAverageVisibility(FLAT_SHADOW_SAMPLER shadowMaps, vec2 shadowMapCoords, float currentDepth, int layerId, vec4 tileBounds, float acneBias)
+{
+	return getConeLightVisibility(shadowMaps, shadowMapCoords, currentDepth, layerId, tileBounds, acneBias);
+}
+
+/**
+ * Function that returns the average visibility of the fragment from the given
+ *   point light source. The single filtered comparison already averages the
+ *   closest four texels.
  *
  * @param shadowMapCoords  The shadow map coordinates of the current fragment.
  * @param currentDepth     The depth of the current fragment w.r.t. the light source.
  * @param layerId          The index of the point light shadow map texture to use.
+ * @param farPlane         The maximum distance the light source can travel till.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
  *
  * @return The average visibility of the fragment.
  */
-float getPointLightAverageVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane)
+float getPointLightAverageVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane, vec4 tileBounds)
+{
+	return getPointLightVisibility(shadowMapCoords, currentDepth, layerId, farPlane, tileBounds);
+}
+
+#else
+
+// The offsets of the Poisson disk samples, spread evenly but irregularly around the unit circle.
+const vec2 shadowPoissonDisk[SHADOW_POISSON_SAMPLES] = vec2[SHADOW_POISSON_SAMPLES](
+	vec2(-0.94201624, -0.39906216),
+	vec2(0.94558609, -0.76890725),
+	vec2(-0.09418410, -0.92938870),
+	vec2(0.34495938, 0.29387760),
+	vec2(-0.91588581, 0.45771432),
+	vec2(-0.81544232, -0.87912464),
+	vec2(-0.38277543, 0.27676845),
+	vec2(0.97484398, 0.75648379)
+);
+// The radius of the Poisson disk, in texels of the shadow map.
+float shadowPoissonRadius = 1.5;
+
+/**
+ * Function that returns a rotation of the Poisson disk which changes from pixel
+ *   to pixel, turning the banding a fixed pattern would leave into fine noise.
+ *
+ * @return The rotation matrix of the Poisson disk.
+ */
+mat2 getShadowPoissonRotation()
+{
+	// Interleaved gradient noise of the screen position of the fragment.
+	float angle = 6.28318531 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+	float s = sin(angle);
+	float c = cos(angle);
+	return mat2(c, s, -s, c);
+}
+
+/**
+ * Function that returns the average visibility of the fragment from the given
+ *   cone light source (or directional light cascade) by taking filtered samples in a rotated Poisson disk
+ *   around the given shadow map coordinates.
+ *
+ * @param shadowMaps       The array of the shadow maps.
+ * @param shadowMapCoords  The shadow map coordinates of the current fragment.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source.
+ * @param layerId          The index of the shadow map texture to use.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ * @param acneBias         The bias to combat acne with for the type of light source.
+ *
+ * @return The average visibility of the fragment.
+ */
+float getConeLightAverageVisibility(FLAT_SHADOW_SAMPLER shadowMaps, vec2 shadowMapCoords, float currentDepth, int layerId, vec4 tileBounds, float acneBias)
 {
 	// Define the variable where we'll store the average visibility.
-  float visibility = 0.0;
-	// Get the texel size of the shadow map texture.
-	vec3 texelSize = getPointLightShadowMapTexelValue();
-	// We'll sample the closest depth values from the given coordinate and the
-	//   immediately surrounding coordinates as well to get a better average
-	//   visibility value.
-	for (int x = -1; x <= 1; x++)
+	float visibility = 0.0;
+	// Get the size of the disk in the shadow map, and the rotation of the disk for this fragment.
+	vec2 diskSize = shadowPoissonRadius * getConeLightShadowMapTexelValue(shadowMaps, tileBounds);
+	mat2 diskRotation = getShadowPoissonRotation();
+	for (int i = 0; i < SHADOW_POISSON_SAMPLES; i++)
+	{
+		// Get the visibility of the fragment at the rotated sample of the disk.
+		visibility += getConeLightVisibility(shadowMaps, shadowMapCoords + (diskRotation * shadowPoissonDisk[i]) * diskSize, currentDepth, layerId, tileBounds, acneBias);
+	}
+	// Return the average visibility across the number of shadow map samples taken.
+	return visibility / float(SHADOW_POISSON_SAMPLES);
+}
+
+/**
+ * Function that returns the average visibility of the fragment from the given
+ *   point light source by taking filtered samples in a rotated Poisson disk
+ *   around the given shadow map coordinates, on the plane facing the light.
+ *
+ * @param shadowMapCoords  The shadow map coordinates of the current fragment.
+ * @param currentDepth     The depth of the current fragment w.r.t. the light source.
+ * @param layerId          The index of the point light shadow map texture to use.
+ * @param farPlane         The maximum distance the light source can travel till.
+ * @param tileBounds       The texture coordinates of the corners of the shadow atlas tile.
+ *
+ * @return The average visibility of the fragment.
+ */
+float getPointLightAverageVisibility(vec3 shadowMapCoords, float currentDepth, int layerId, float farPlane, vec4 tileBounds)
+{
+	// Define the variable where we'll store the average visibility.
+	float visibility = 0.0;
+	// Find two directions perpendicular to the direction from the light, for laying out the disk.
+	vec3 direction = normalize(shadowMapCoords);
+	vec3 tangent = normalize(cross(direction, abs(direction.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+	vec3 bitangent = cross(direction, tangent);
+	// A texel of a cube map face spans two texel sizes on the face at a distance of one, so scale that up to
+	//   the distance of the fragment to get the size of the disk.
+	float diskSize = shadowPoissonRadius * 2.0 * getPointLightShadowMapTexelValue(tileBounds).z * currentDepth;
+	mat2 diskRotation = getShadowPoissonRotation();
+	for (int i = 0; i < SHADOW_POISSON_SAMPLES; i++)
+	{
+		// Get the visibility of the fragment at the rotated sample of the disk.
+		vec2 offset = (diskRotation * shadowPoissonDisk[i]) * diskSize;
+		visibility += getPointLightVisibility(shadowMapCoords + offset.x * tangent + offset.y * bitangent, currentDepth, layerId, farPlane, tileBounds);
+	}
+	// Return the average visibility across the number of shadow map samples taken.
+	return visibility / float(SHADOW_POISSON_SAMPLES);
+}
+
+#endif
+
+#endif
+
+/**
+ * Function that returns the average visibility of the fragment from the given
+ *   directional light source, from the first (and so the most detailed) of its
+ *   cascades that covers the fragment. Fragments beyond the last cascade are
+ *   fully visible.
+ *
+ * @param lightIndex  The index of the directional light source.
+ *
+ * @return The average visibility of the fragment.
+ */
+float getDirectionalLightVisibility(int lightIndex)
+{
+	int layerId = directionalLightDetails[lightIndex].layerId;
+	vec4 tileBounds = directionalLightDetails[lightIndex].tileBounds;
+	// Keep a margin of a few texels inside the edges of each cascade, so the samples taken
+	//   around the fragment never fall outside the cascade it was found in.
+	vec2 margin = 3.0 * getConeLightShadowMapTexelValue(directionalLightTextures, tileBounds);
+	for (int cascade = 0; cascade < SHADOW_CASCADES_COUNT; cascade++)
 	{
-		for (int y = -1; y <= 1; y++)
+		// Calculate the shadow map coordinates of the fragment in the cascade (the projection is orthographic).
+		vec3 shadowMapCoords = (directionalLightDetails[lightIndex].cascadeVpMatrices[cascade] * fragmentPosition_worldSpace).xyz * 0.5 + 0.5;
+		if (all(greaterThanEqual(shadowMapCoords.xy, margin)) && all(lessThanEqual(shadowMapCoords.xy, 1.0 - margin)) && shadowMapCoords.z <= 1.0)
 		{
-			for (int z = -1; z <= 1; z++)
-			{
-				// Get the visibility of the fragment at the given shadow map coordinates (with variance).
-				visibility += getPointLightVisibility(shadowMapCoords + (vec3(x, y, z) * texelSize), currentDepth, layerId, farPlane);
-			}
+			return getConeLightAverageVisibility(directionalLightTextures, shadowMapCoords.xy, shadowMapCoords.z, layerId + cascade, tileBounds, directionalLightAcneBias);
 		}
 	}
-	// Return the average visibility across the number of shadow map samples taken (3 * 3 * 3 = 27).
-  return visibility / 27.0;
+	return 1.0;
 }
 
 /**
@@ -340,30 +715,95 @@ vec3 getLightSpecularLighting(vec4 fragmentPosition_viewSpace, vec3 lightColorIn
 
 void main()
 {
+#ifdef DEFERRED_LIGHTING
+	// Read the depth of the pixel from the geometry buffer, and write it back out so the passes drawn after the lighting
+	//   pass are depth tested against the scene.
+	ivec2 pixel = ivec2(gl_FragCoord.xy - viewportOffset);
+	float depth = texelFetch(geometryDepthTexture, pixel, 0).r;
+	gl_FragDepth = depth;
+	// Pixels that aren't covered by a lit model (the background and unlit models) keep the color they were drawn with.
+	vec3 surfaceColor = texelFetch(geometryAlbedoTexture, pixel, 0).rgb;
+	vec4 geometryNormalLit = texelFetch(geometryNormalTexture, pixel, 0);
+	if (geometryNormalLit.w < 0.5)
+	{
+		color = surfaceColor;
+		return;
+	}
+	fragmentNormal_viewSpace = geometryNormalLit.xyz;
+
+	// Get the position of the pixel back from its depth, first in view-space and then in world-space.
+	vec4 pixelPosition_ndc = vec4(((gl_FragCoord.xy - viewportOffset) / geometryViewportSize) * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+	fragmentPosition_viewSpace = inverseProjectionMatrix * pixelPosition_ndc;
+	fragmentPosition_viewSpace /= fragmentPosition_viewSpace.w;
+	fragmentPosition_worldSpace = inverseViewMatrix * fragmentPosition_viewSpace;
+
+	// Calculate the light details the vertex shader would have calculated in forward shading.
+	for (int lightIndex = 0; lightIndex < ACTIVE_CONE_LIGHTS_COUNT; lightIndex++)
+	{
+		coneLightPosition_viewSpace[lightIndex] = viewMatrix * vec4(coneLightDetails[lightIndex].lightPosition, 1.0);
+		coneLightShadowMapCoord[lightIndex] = coneLightDetails[lightIndex].lightVpMatrix * fragmentPosition_worldSpace;
+	}
+	for (int lightIndex = 0; lightIndex < ACTIVE_POINT_LIGHTS_COUNT; lightIndex++)
+	{
+		pointLightPosition_viewSpace[lightIndex] = viewMatrix * vec4(pointLightDetails[lightIndex].lightPosition, 1.0);
+	}
+#elif defined(IMPOSTOR)
+	// While the model fades into its impostor, only the share of the pixels of the impostor that's faded in is drawn,
+	//   picked by an ordered dither so the model drawn behind it shows through the rest.
+	const float ditherThresholds[16] = float[](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+	ivec2 ditherPixel = ivec2(gl_FragCoord.xy) & 3;
+	if (fragmentImpostor.w <= (ditherThresholds[ditherPixel.y * 4 + ditherPixel.x] + 0.5) / 16.0)
+	{
+		discard;
+	}
+	// Blend the two views of the object closest to the direction the camera looks at the model from, leaving out the
+	//   pixels that neither view covers.
+	vec4 impostorAlbedo = mix(texture(impostorAlbedoTextures, vec3(fragmentUv, fragmentImpostor.x)), texture(impostorAlbedoTextures, vec3(fragmentUv, fragmentImpostor.y)), fragmentImpostor.z);
+	if (impostorAlbedo.a < 0.5)
+	{
+		discard;
+	}
+	vec3 surfaceColor = impostorAlbedo.rgb / impostorAlbedo.a;
+	vec3 impostorNormal = mix(texture(impostorNormalTextures, vec3(fragmentUv, fragmentImpostor.x)), texture(impostorNormalTextures, vec3(fragmentUv, fragmentImpostor.y)), fragmentImpostor.z).xyz;
+	fragmentNormal_viewSpace = normalize(fragmentImpostorBasis_viewSpace * impostorNormal);
+#else
 	// Grab the diffuse color defined in the shot texture using the given UV coordinates.
-	vec3 surfaceColor = texture(diffuseTexture, fragmentUv).rgb;
+	vec3 surfaceColor = texture(DIFFUSE_TEXTURE, fragmentUv).rgb;
+#endif
+
+#ifdef DEFERRED_GBUFFER
+	// Record the surface details of the fragment for the lighting pass, and leave the lighting to it.
+	geometryAlbedo = vec4(surfaceColor, 1.0);
+	geometryNormal = vec4(fragmentNormal_viewSpace, 1.0);
+#else
 	// Set the initial color value as the ambient lighting color value of the surface.
 	// If lighting is disabled, the ambient factor is set to 1, since lighting should be ignored as a factor.
-	color = surfaceColor * clamp(ambientFactor + clamp(disableFeatureMask - 1, 0, 1), 0.0, 1.0);
+	color = surfaceColor * clamp(ambientFactor + clamp(ACTIVE_DISABLE_FEATURE_MASK - 1, 0, 1), 0.0, 1.0);
 
 	// Perform lighting calculations as long as lighting has not been disabled.
-	if (disableFeatureMask < DISABLE_LIGHT)
+	if (ACTIVE_DISABLE_FEATURE_MASK < DISABLE_LIGHT)
 	{
 		// Iterate through all the active cone lights.
-		for (int lightIndex = 0; lightIndex < coneLightsCount; lightIndex++)
+		for (int lightIndex = 0; lightIndex < ACTIVE_CONE_LIGHTS_COUNT; lightIndex++)
 		{
+			// Skip the lights whose range doesn't reach the model.
+			if ((fragmentLightMask & (1u << uint(lightIndex))) == 0u)
+			{
+				continue;
+			}
+
 			// Calculate the direction of the light from the source to the fragment in view-space.
 			vec3 coneLightDirection_viewSpace = normalize((coneLightPosition_viewSpace[lightIndex] - fragmentPosition_viewSpace).xyz);
 
 			// Define variable for storing the visibility of the fragment to the current light source.
 			float visibility;
 			// Perform shadow visibility calculations as long as shadows have not been disabled.
-			if (disableFeatureMask < DISABLE_SHADOW)
+			if (ACTIVE_DISABLE_FEATURE_MASK < DISABLE_SHADOW)
 			{
 				// Calculate the shadow map coordinates of the fragment w.r.t. the current light source (while applying perspective-division).
 				vec3 shadowMapCoords = (((coneLightShadowMapCoord[lightIndex].xyz) / coneLightShadowMapCoord[lightIndex].w) * 0.5) + 0.5;
 				// Calculate the visibilty of the fragment to the current light source.
-				visibility = getConeLightAverageVisibility(shadowMapCoords.xy, shadowMapCoords.z, coneLightDetails_fragment[lightIndex].layerId);
+				visibility = getConeLightAverageVisibility(coneLightTextures, shadowMapCoords.xy, shadowMapCoords.z, coneLightDetails[lightIndex].layerId, coneLightDetails[lightIndex].tileBounds, coneLightAcneBias);
 			}
 			else
 			{
@@ -376,27 +816,33 @@ void main()
 
 			// Calculate and add the light diffuse lighting value to the final color output, factored against the color of the surface
 			//   and the visibility of the fragment to the light source.
-			color += visibility * surfaceColor * getLightDiffuseLighting(coneLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, coneLightDirection_viewSpace);
+			color += visibility * surfaceColor * getLightDiffuseLighting(coneLightDetails[lightIndex].lightColorIntensity, distanceFromLight, coneLightDirection_viewSpace);
 			// Calculate and add the light specular lighting value to the final color output, factored against the visibility of the
 			//   fragment to the light source.
-			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, coneLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, coneLightDirection_viewSpace);
+			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, coneLightDetails[lightIndex].lightColorIntensity, distanceFromLight, coneLightDirection_viewSpace);
 		}
 
 		// Iterate through all the active point lights.
-		for (int lightIndex = 0; lightIndex < pointLightsCount; lightIndex++)
+		for (int lightIndex = 0; lightIndex < ACTIVE_POINT_LIGHTS_COUNT; lightIndex++)
 		{
+			// Skip the lights whose range doesn't reach the model.
+			if ((fragmentLightMask & (1u << uint(MAX_SIMPLE_LIGHTS + lightIndex))) == 0u)
+			{
+				continue;
+			}
+
 			// Calculate the direction of the light from the source to the fragment in view-space.
 			vec3 pointLightDirection_viewSpace = normalize((pointLightPosition_viewSpace[lightIndex] - fragmentPosition_viewSpace).xyz);
 
 			// Define variable for storing the visibility of the fragment to the current light source.
 			float visibility;
 			// Perform shadow visibility calculations as long as shadows have not been disabled.
-			if (disableFeatureMask < DISABLE_SHADOW)
+			if (ACTIVE_DISABLE_FEATURE_MASK < DISABLE_SHADOW)
 			{
 				// Calculate the shadow map coordinates of the fragment w.r.t. the current light source.
-				vec3 shadowMapCoords = fragmentPosition_worldSpace.xyz - pointLightDetails_fragment[lightIndex].lightPosition;
+				vec3 shadowMapCoords = fragmentPosition_worldSpace.xyz - pointLightDetails[lightIndex].lightPosition;
 				// Calculate the visibilty of the fragment to the current light source.
-				visibility = getPointLightAverageVisibility(shadowMapCoords.xyz, length(shadowMapCoords), pointLightDetails_fragment[lightIndex].layerId, pointLightDetails_fragment[lightIndex].farPlane);
+				visibility = getPointLightAverageVisibility(shadowMapCoords.xyz, length(shadowMapCoords), pointLightDetails[lightIndex].layerId, pointLightDetails[lightIndex].farPlane, pointLightDetails[lightIndex].tileBounds);
 			}
 			else
 			{
@@ -409,10 +855,73 @@ void main()
 
 			// Calculate and add the light diffuse lighting value to the final color output, factored against the color of the surface
 			//   and the visibility of the fragment to the light source.
-			color += visibility * surfaceColor * getLightDiffuseLighting(pointLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace);
+			color += visibility * surfaceColor * getLightDiffuseLighting(pointLightDetails[lightIndex].lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace);
 			// Calculate and add the light specular lighting value to the final color output, factored against the visibility of the
 			//   fragment to the light source.
-			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, pointLightDetails_fragment[lightIndex].lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace);
+			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, pointLightDetails[lightIndex].lightColorIntensity, distanceFromLight, pointLightDirection_viewSpace);
+		}
+
+		// Iterate through all the active directional lights.
+		for (int lightIndex = 0; lightIndex < ACTIVE_DIRECTIONAL_LIGHTS_COUNT; lightIndex++)
+		{
+			// Skip the lights whose range doesn't reach the model.
+			if ((fragmentLightMask & (1u << uint(MAX_SIMPLE_LIGHTS + MAX_CUBE_LIGHTS + lightIndex))) == 0u)
+			{
+				continue;
+			}
+
+			// The light reaches every fragment from the same direction, so the direction of the light from the fragment
+			//   is just the opposite of the direction it shines in.
+			vec3 directionalLightDirection_viewSpace = -directionalLightDetails[lightIndex].lightDirection_viewSpace;
+
+			// Define variable for storing the visibility of the fragment to the current light source.
+			float visibility;
+			// Perform shadow visibility calculations as long as shadows have not been disabled.
+			if (ACTIVE_DISABLE_FEATURE_MASK < DISABLE_SHADOW)
+			{
+				visibility = getDirectionalLightVisibility(lightIndex);
+			}
+			else
+			{
+				// Since shadows have been disabled, the fragment will be fully visible to the light source.
+				visibility = 1.0;
+			}
+
+			// Calculate and add the light diffuse and specular lighting values to the final color output, the same way as the
+			//   other lights, with the light not fading with distance.
+			color += visibility * surfaceColor * getLightDiffuseLighting(directionalLightDetails[lightIndex].lightColorIntensity, 1.0, directionalLightDirection_viewSpace);
+			color += visibility * getLightSpecularLighting(fragmentPosition_viewSpace, directionalLightDetails[lightIndex].lightColorIntensity, 1.0, directionalLightDirection_viewSpace);
+		}
+
+		// Go through the lights without shadows that can reach the light cluster of the fragment.
+		if (clusteredLightsCount > 0)
+		{
+			// Find the cluster of the fragment from its position on the screen and the logarithm of its depth.
+			vec3 clusterCoords = vec3((gl_FragCoord.xy - viewportOffset) / clusterParameters.xy, log(-fragmentPosition_viewSpace.z) * clusterParameters.z + clusterParameters.w);
+			ivec3 cluster = clamp(ivec3(floor(clusterCoords)), ivec3(0), ivec3(CLUSTER_GRID_WIDTH, CLUSTER_GRID_HEIGHT, CLUSTER_GRID_DEPTH) - 1);
+			uvec2 clusterLightRange = texelFetch(clusterLightRanges, cluster.x + CLUSTER_GRID_WIDTH * (cluster.y + CLUSTER_GRID_HEIGHT * cluster.z)).rg;
+
+			for (uint i = 0u; i < clusterLightRange.y; i++)
+			{
+				// Grab the details of the light.
+				int lightIndex = int(texelFetch(clusterLightIndices, int(clusterLightRange.x + i)).r);
+				vec4 lightPositionRadius_viewSpace = texelFetch(clusteredLights, 2 * lightIndex);
+				vec3 lightColorIntensity = texelFetch(clusteredLights, 2 * lightIndex + 1).rgb;
+
+				// Calculate the direction of the light from the source to the fragment in view-space, and the distance between them.
+				vec3 clusteredLightDirection_viewSpace = normalize(lightPositionRadius_viewSpace.xyz - fragmentPosition_viewSpace.xyz);
+				float distanceFromLight = distance(fragmentPosition_viewSpace.xyz, lightPositionRadius_viewSpace.xyz);
+				// Fade the light out smoothly towards the edge of its radius, so there's no visible edge where the light
+				//   stops being assigned to clusters.
+				float radiusFalloff = clamp(1.0 - pow(distanceFromLight / lightPositionRadius_viewSpace.w, 4.0), 0.0, 1.0);
+				radiusFalloff *= radiusFalloff;
+
+				// Calculate and add the light diffuse and specular lighting values to the final color output, the same way
+				//   as the other lights, with the fragment always being visible to the light source.
+				color += radiusFalloff * surfaceColor * getLightDiffuseLighting(lightColorIntensity, distanceFromLight, clusteredLightDirection_viewSpace);
+				color += radiusFalloff * getLightSpecularLighting(fragmentPosition_viewSpace, lightColorIntensity, distanceFromLight, clusteredLightDirection_viewSpace);
+			}
 		}
 	}
+#endif
 }
\ No newline at end of file
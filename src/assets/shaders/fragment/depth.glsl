@@ -0,0 +1,8 @@
+#version 330 core
+
+void main()
+{
+	// Don't need to do anything. Only the depth of the fragment is recorded,
+	//   which the GPU already interpolated from the positions returned by the
+	//   vertex shader.
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330 core
+
+// How far the particle the fragment belongs to is through its life.
+in float fragmentAge;
+
+// The final color of the fragment.
+out vec4 color;
+
+void main()
+{
+	// Round the point sprite off, fading it out towards its edge.
+	float distanceToCenter = length(gl_PointCoord - vec2(0.5)) * 2.0;
+	if (distanceToCenter > 1.0)
+	{
+		discard;
+	}
+	// The particles start out yellow and cool down to orange, fading away as they die.
+	vec3 particleColor = mix(vec3(1.0, 0.9, 0.4), vec3(1.0, 0.35, 0.05), fragmentAge);
+	color = vec4(particleColor, (1.0 - distanceToCenter) * (1.0 - fragmentAge));
+}
@@ -1,5 +1,7 @@
 #version 330 core
 
+#include "../include/diffuse_texture_fragment.glsl"
+
 // The reason for suffixing the structure and variables with the
 //   shader component name, is so that they don't collide with
 //   definitions in other shaders.
@@ -15,15 +17,25 @@
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 in vec2 fragmentUv;
 
+#ifdef DEFERRED_GBUFFER
+// The color of the fragment recorded as its albedo in the geometry buffer, with an alpha of 1 marking it as covered.
+layout(location = 0) out vec4 geometryAlbedo;
+// The normal vector of the fragment in view-space, which unlit fragments don't need, with a w of 0 marking it as unlit
+//   so the lighting pass keeps the color as it is.
+layout(location = 1) out vec4 geometryNormal;
+#else
 // The final color of the fragment.
 out vec3 color;
-
-// The shot object texture sampler.
-uniform sampler2D diffuseTexture;
+#endif
 
 void main()
 {
 	// Grab the diffuse color defined in the shot tecture using the given UV coordinates,
 	//   and set that as the color of the fragment.
-	color = texture(diffuseTexture, fragmentUv).rgb;
+#ifdef DEFERRED_GBUFFER
+	geometryAlbedo = vec4(texture(DIFFUSE_TEXTURE, fragmentUv).rgb, 1.0);
+	geometryNormal = vec4(0.0);
+#else
+	color = texture(DIFFUSE_TEXTURE, fragmentUv).rgb;
+#endif
 }
\ No newline at end of file
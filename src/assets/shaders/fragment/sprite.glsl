@@ -0,0 +1,19 @@
+#version 330 core
+
+// The UV coordinates of the fragment along with the layer of the sprite texture array, interpolated by the GPU.
+in vec3 fragmentUv;
+// Whether the alpha of the fragment is taken from how bright its color is.
+flat in uint fragmentBlackAlpha;
+
+// The final color of the fragment, blended over what's behind it.
+out vec4 color;
+
+// The texture array the textures of the sprites are copied into, one texture per layer.
+uniform sampler2DArray spriteTextures;
+
+void main()
+{
+	// The unlit shaders draw the texture as it is, and the black alpha variant fades out the dark parts of it.
+	color.rgb = texture(spriteTextures, fragmentUv).rgb;
+	color.a = fragmentBlackAlpha != 0u ? color.r * color.g * color.b : 1.0;
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+// The UV coordinates of the pixel in the layer of the sprite texture array, from the bottom-left to the top-right.
+in vec2 screenUv;
+
+// The color of the pixel in the layer.
+out vec4 color;
+
+// The texture sampler of the texture copied into the layer.
+uniform sampler2D sourceTexture;
+
+void main()
+{
+	// Sample the texture with its own filtering, which scales it to the size of the layer whatever its format is, and
+	//   reads it from the finest mip level it has uploaded.
+	color = vec4(texture(sourceTexture, screenUv).rgb, 1.0);
+}
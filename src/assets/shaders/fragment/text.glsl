@@ -1,14 +1,14 @@
 #version 330 core
 
 in vec2 fragmentUv;
-in float fragmentUvLayer;
+in vec4 fragmentColor;
 
 out vec4 color;
 
-uniform sampler2DArray textTexture;
+uniform sampler2D textTexture;
 
 void main()
 {    
-    vec4 textSample = vec4(1.0, 1.0, 1.0, texture(textTexture, vec3(fragmentUv, fragmentUvLayer)).r);
+    vec4 textSample = vec4(fragmentColor.rgb, fragmentColor.a * texture(textTexture, fragmentUv).r);
     color = textSample;
 }
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 330 core
+
+// The UV coordinates of the pixel on the screen, from the bottom-left to the top-right.
+in vec2 screenUv;
+
+// The final color of the pixel, with its color multiplied by its alpha.
+out vec4 color;
+
+// The texture sampler of the text overlay, of the size of the screen.
+uniform sampler2D overlayTexture;
+
+void main()
+{
+	color = texture(overlayTexture, screenUv);
+}
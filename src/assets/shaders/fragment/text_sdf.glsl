@@ -0,0 +1,17 @@
+#version 330 core
+
+in vec2 fragmentUv;
+in vec4 fragmentColor;
+
+out vec4 color;
+
+uniform sampler2D textTexture;
+
+void main()
+{
+    // The distance is 0.5 on the outline of the glyph, so fade across the outline over about a pixel on screen,
+    //   whatever the text is scaled to.
+    float distance = texture(textTexture, fragmentUv).r;
+    float smoothing = max(fwidth(distance) * 0.5, 0.001);
+    color = vec4(fragmentColor.rgb, fragmentColor.a * smoothstep(0.5 - smoothing, 0.5 + smoothing, distance));
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#version 330 core
+
+// The UV coordinates of the pixel on the screen, from the bottom-left to the top-right.
+in vec2 screenUv;
+
+// The final color of the pixel.
+out vec3 color;
+
+// The texture samplers of the colors and depths the scene was rendered with.
+uniform sampler2D sceneColorTexture;
+uniform sampler2D sceneDepthTexture;
+// The part of the scene textures the scene was rendered to, from their bottom-left corner.
+uniform vec2 sceneScale;
+
+// The UV coordinates of the center of the top-right texel the scene was rendered to, which the filter can't read past.
+vec2 maxSceneUv;
+
+// Read the color of the scene at the given UV coordinates, staying within the part the scene was rendered to.
+vec3 readSceneColor(vec2 uv)
+{
+	return texture(sceneColorTexture, min(uv, maxSceneUv)).rgb;
+}
+
+#ifdef FXAA
+// The smallest contrast of an edge, and how much of the brightest luma around a pixel the contrast has to be over for
+//   the pixel to be treated as on an edge.
+#define FXAA_EDGE_THRESHOLD_MIN (1.0 / 32.0)
+#define FXAA_EDGE_THRESHOLD (1.0 / 8.0)
+// How far along an edge the pixels are blended, in texels, and how much the blend direction is shortened on dark edges.
+#define FXAA_SPAN_MAX 8.0
+#define FXAA_REDUCE_MUL (1.0 / 8.0)
+#define FXAA_REDUCE_MIN (1.0 / 128.0)
+
+// Smooth the edges of the scene by blending each pixel along the edge it's on, found from the luma of the pixels
+//   around it (FXAA).
+vec3 applyFxaa(vec2 uv)
+{
+	vec2 texelSize = 1.0 / vec2(textureSize(sceneColorTexture, 0));
+	vec3 lumaWeights = vec3(0.299, 0.587, 0.114);
+	vec3 colorCenter = readSceneColor(uv);
+	float lumaCenter = dot(colorCenter, lumaWeights);
+	float lumaTopLeft = dot(readSceneColor(uv + vec2(-1.0, 1.0) * texelSize), lumaWeights);
+	float lumaTopRight = dot(readSceneColor(uv + vec2(1.0, 1.0) * texelSize), lumaWeights);
+	float lumaBottomLeft = dot(readSceneColor(uv + vec2(-1.0, -1.0) * texelSize), lumaWeights);
+	float lumaBottomRight = dot(readSceneColor(uv + vec2(1.0, -1.0) * texelSize), lumaWeights);
+	float lumaMin = min(lumaCenter, min(min(lumaTopLeft, lumaTopRight), min(lumaBottomLeft, lumaBottomRight)));
+	float lumaMax = max(lumaCenter, max(max(lumaTopLeft, lumaTopRight), max(lumaBottomLeft, lumaBottomRight)));
+
+	// Leave the pixels without enough contrast around them to be on an edge as they are.
+	if (lumaMax - lumaMin < max(FXAA_EDGE_THRESHOLD_MIN, lumaMax * FXAA_EDGE_THRESHOLD))
+	{
+		return colorCenter;
+	}
+
+	// Find the direction along the edge, which is across the gradient of the luma.
+	vec2 direction = vec2(-((lumaTopLeft + lumaTopRight) - (lumaBottomLeft + lumaBottomRight)),
+						  (lumaTopLeft + lumaBottomLeft) - (lumaTopRight + lumaBottomRight));
+	float directionReduce = max((lumaTopLeft + lumaTopRight + lumaBottomLeft + lumaBottomRight) * 0.25 * FXAA_REDUCE_MUL, FXAA_REDUCE_MIN);
+	float inverseDirectionMin = 1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+	direction = clamp(direction * inverseDirectionMin, -FXAA_SPAN_MAX, FXAA_SPAN_MAX) * texelSize;
+
+	// Blend the pixels close along the edge, and further along it unless that reaches past the edge.
+	vec3 colorNear = 0.5 * (readSceneColor(uv + direction * (1.0 / 3.0 - 0.5)) + readSceneColor(uv + direction * (2.0 / 3.0 - 0.5)));
+	vec3 colorFar = colorNear * 0.5 + 0.25 * (readSceneColor(uv - direction * 0.5) + readSceneColor(uv + direction * 0.5));
+	float lumaFar = dot(colorFar, lumaWeights);
+	return lumaFar < lumaMin || lumaFar > lumaMax ? colorNear : colorFar;
+}
+#endif
+
+void main()
+{
+	maxSceneUv = sceneScale - 0.5 / vec2(textureSize(sceneColorTexture, 0));
+	vec2 uv = min(screenUv * sceneScale, maxSceneUv);
+#ifdef FXAA
+	color = applyFxaa(uv);
+#else
+	color = readSceneColor(uv);
+#endif
+	// Copy the depth over as well, so the passes drawn after the scene are still depth tested against the models.
+	gl_FragDepth = texture(sceneDepthTexture, uv).r;
+}
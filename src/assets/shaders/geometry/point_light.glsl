@@ -28,12 +28,18 @@ struct LightDetails_Geometry
   vec3 lightPosition;
   mat4 vpMatrices[6];
   int vpMatrixCount;
+  // The bottom-left (x, y) and top-right (z, w) corners of the shadow atlas tile of the light,
+  //   in normalized device coordinates.
+  vec4 tileBounds;
 };
 
 // The details of the current light.
 uniform LightDetails_Geometry lightDetails_geometry[MAX_LIGHTS];
 uniform int lightsCount;
 
+// The shadow map face mask of the model instance the triangle belongs to.
+flat in uint shadowMask_geometry[];
+
 // The vertex position being used to interpolate fragments.
 out vec4 fragmentPosition;
 // The index of the light for that fragment.
@@ -47,6 +53,11 @@ void main()
     // For point lights, this will be 6 faces, for other maps it is just 1 face.
     for(int face = 0; face < lightDetails_geometry[light].vpMatrixCount; ++face)
     {
+      // Skip the face if the model instance was culled from it.
+      if((shadowMask_geometry[0] & (1u << uint(light * 6 + face))) == 0u)
+      {
+        continue;
+      }
       // Set the current layer of the shadow map being modified.
       // Since shadow maps of lights are saved in arrays, we need to make sure that
       //   the current positions are saved only for the layer in the array that this
@@ -65,6 +76,14 @@ void main()
         // Transform the position of the model vertex using the view and projection
         //   matrices of the light.
         gl_Position = lightDetails_geometry[light].vpMatrices[face] * fragmentPosition;
+        // Clip the triangle to the shadow atlas tile of the light, since the projection-view
+        //   matrices only move the face into the tile, leaving anything outside the face
+        //   to spill into the tiles next to it.
+        vec4 tileBounds = lightDetails_geometry[light].tileBounds;
+        gl_ClipDistance[0] = gl_Position.x - tileBounds.x * gl_Position.w;
+        gl_ClipDistance[1] = tileBounds.z * gl_Position.w - gl_Position.x;
+        gl_ClipDistance[2] = gl_Position.y - tileBounds.y * gl_Position.w;
+        gl_ClipDistance[3] = tileBounds.w * gl_Position.w - gl_Position.y;
         // Emit the resultant model vertex.
         EmitVertex();
       }
@@ -0,0 +1,8 @@
+// The view and projection matrices of the active camera, shared by all shaders and filled once per frame.
+layout(std140) uniform CameraUniformBlock
+{
+	// The view matrix of the active camera.
+	mat4 viewMatrix;
+	// The projection matrix of the active camera.
+	mat4 projectionMatrix;
+};
@@ -0,0 +1,14 @@
+// With bindless textures, the diffuse texture is sampled through the texture handle of the model instance, instead of
+//   the texture bound to the first texture unit. The extension has to be enabled before any declarations, so this file
+//   is included right after the version directive.
+#ifdef BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+// The texture handle of the model instance.
+flat in uvec2 fragmentTextureHandle;
+// The diffuse texture sampler of the model instance.
+#define DIFFUSE_TEXTURE sampler2D(fragmentTextureHandle)
+#else
+// The diffuse texture sampler of the model.
+uniform sampler2D diffuseTexture;
+#define DIFFUSE_TEXTURE diffuseTexture
+#endif
@@ -0,0 +1,8 @@
+// With bindless textures, each model instance samples its diffuse texture through its own texture handle, which
+//   advances once per instance, so models with different textures can be drawn with a single call.
+#ifdef BINDLESS_TEXTURES
+// The texture handle attribute of the model instance, as a pair of integers.
+layout(location = 10) in uvec2 instanceTextureHandle;
+// The texture handle of the model instance, passed on as is to every fragment of the instance.
+flat out uvec2 fragmentTextureHandle;
+#endif
@@ -0,0 +1,27 @@
+// The time of the frame being rendered, shared by all shaders and filled once per frame, which the spins of the model
+//   instances are evaluated at.
+layout(std140) uniform FrameUniformBlock
+{
+	// The time the frame started at, in seconds.
+	float frameTime;
+};
+
+// The spin attribute of the model instance around its own vertical axis, as the angle it's turned by at time 0 (x) and
+//   the speed it turns at in radians per second (y). This advances once per instance, so purely cosmetic spinning costs
+//   the CPU nothing. The passes drawing the instances without spins leave the attribute at its default of 0, so nothing
+//   turns.
+layout(location = 11) in vec2 instanceSpin;
+
+// Get the model matrix of the model instance, turned by its spin at the time of the frame.
+mat4 getSpunInstanceMatrix()
+{
+	float angle = instanceSpin.x + instanceSpin.y * frameTime;
+	float angleSin = sin(angle);
+	float angleCos = cos(angle);
+	// The rotation around the Y axis, column by column.
+	return instanceModelMatrix * mat4(
+		vec4(angleCos, 0.0, -angleSin, 0.0),
+		vec4(0.0, 1.0, 0.0, 0.0),
+		vec4(angleSin, 0.0, angleCos, 0.0),
+		vec4(0.0, 0.0, 0.0, 1.0));
+}
@@ -0,0 +1,51 @@
+// The sizes of the arrays of light details, MAX_SIMPLE_LIGHTS, MAX_CUBE_LIGHTS and MAX_DIRECTIONAL_LIGHTS, and the
+//   number of cascades of each directional light, SHADOW_CASCADES_COUNT, are defined by the shader manager from the
+//   constants of the game.
+
+// The structure defining the details regarding the active lights.
+// The layout of this structure must match the std140 layout of the light uniform block in the render manager.
+struct LightDetails
+{
+	mat4 lightVpMatrix;
+	vec3 lightPosition;
+	float nearPlane;
+	vec3 lightColorIntensity;
+	float farPlane;
+	vec4 tileBounds;
+	int layerId;
+};
+
+// The structure defining the details regarding the active directional lights, whose shadow maps are split into cascades.
+// The layout of this structure must match the std140 layout of the light uniform block in the render manager.
+struct DirectionalLightDetails
+{
+	mat4 cascadeVpMatrices[SHADOW_CASCADES_COUNT];
+	vec3 lightDirection_viewSpace;
+	int layerId;
+	vec3 lightColorIntensity;
+	float padding;
+	vec4 tileBounds;
+};
+
+// The details of all the active lights, shared by all model shaders and filled once per frame.
+// Uniform blocks are never partially optimized away, so the same definition is safe to use in every shader component.
+layout(std140) uniform LightUniformBlock
+{
+	// The details of the active cone lights (2D texture lights).
+	LightDetails coneLightDetails[MAX_SIMPLE_LIGHTS];
+	// The details of the active point lights (cubemap texture lights).
+	LightDetails pointLightDetails[MAX_CUBE_LIGHTS];
+	// The details of the active directional lights (2D texture lights split into cascades).
+	DirectionalLightDetails directionalLightDetails[MAX_DIRECTIONAL_LIGHTS];
+	// The number of active cone lights (2D texture lights).
+	int coneLightsCount;
+	// The number of active point lights (cubemap texture lights).
+	int pointLightsCount;
+	// The number of lights without shadows, which are only found through the light clusters.
+	int clusteredLightsCount;
+	// The number of active directional lights.
+	int directionalLightsCount;
+	// The width and height of a light cluster on the screen in pixels, and the scale and bias turning the
+	//   logarithm of the view depth into a cluster slice.
+	vec4 clusterParameters;
+};
@@ -0,0 +1,89 @@
+#version 330 core
+// Rendering into every layer of the cone light shadow atlas in a single pass needs multiview, with the clip distances
+//   depending on the view as well as the position, which only the second version of the extension allows. The cone
+//   light only uses this shader when the driver reports it, and its framebuffer is then attached with a view for each
+//   layer.
+#extension GL_OVR_multiview2 : require
+
+// The reason for suffixing structures and uniform variables with
+//   the shader component name, is so that they don't collide with
+//   definitions in other shaders.
+// GPU shader compilers optimize and remove any unused variables,
+//   and if there are different unused variables in the same structure
+//   definition in different shader components, with both being used
+//   through the same variable, then the shader first deletes the unused
+//   variables in the initial shader component compilation step, then
+//   fails to link the two shader components together because their
+//   structures are now different.
+// Note that for primitive uniform variables this cannot be an issue,
+//   because there is no structure to change. Either the entire
+//   variable is kept as is, or completely removed.
+
+#define MAX_LIGHTS 5
+
+// Each view of the draw is a layer of the cone light shadow atlas, with the view ID being the index of the layer.
+layout(num_views = CONE_SHADOW_ATLAS_LAYERS) in;
+
+// The vertex position attribute of the model.
+layout(location = 0) in vec3 vertexPosition;
+
+// The transformation matrix to transform the model instance into world-space, occupying four consecutive
+//   locations (one per column). Each model instance is drawn once for every light, so this advances once
+//   every lightsCount instances.
+layout(location = 3) in mat4 instanceModelMatrix;
+// The mask of the shadow map faces the model instance can be seen from, with one bit for each face of each light
+//   (bit light * 6 + face).
+layout(location = 7) in uint instanceShadowMask;
+
+#include "../include/instance_spin.glsl"
+
+// The structure defining the details regarding the light.
+struct LightDetails_Vertex
+{
+  int layerId;
+  vec3 lightPosition;
+  mat4 vpMatrices[6];
+  int vpMatrixCount;
+  // The bottom-left (x, y) and top-right (z, w) corners of the shadow atlas tile of the light,
+  //   in normalized device coordinates.
+  vec4 tileBounds;
+};
+
+// The details of the current lights.
+uniform LightDetails_Vertex lightDetails_vertex[MAX_LIGHTS];
+uniform int lightsCount;
+
+// The vertex position being used to interpolate fragments.
+out vec4 fragmentPosition;
+
+void main()
+{
+  // Work out which light this instance of the model is being drawn into, with cone lights having a single face.
+  int light = gl_InstanceID % lightsCount;
+
+  // Transform the model vertex into world-space, to be used to interpolate fragments.
+  fragmentPosition = getSpunInstanceMatrix() * vec4(vertexPosition, 1.0);
+
+  // Skip the view if the light isn't stored in its layer, or the light if the model instance was culled from it, by
+  //   moving all the vertices of the triangle outside the clip volume. Lights sharing a layer are drawn by their own
+  //   instances into their own tiles of it.
+  if(lightDetails_vertex[light].layerId != int(gl_ViewID_OVR) || (instanceShadowMask & (1u << uint(light * 6))) == 0u)
+  {
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    gl_ClipDistance[0] = -1.0;
+    gl_ClipDistance[1] = -1.0;
+    gl_ClipDistance[2] = -1.0;
+    gl_ClipDistance[3] = -1.0;
+    return;
+  }
+
+  // Transform the position of the model vertex using the view and projection matrices of the light.
+  gl_Position = lightDetails_vertex[light].vpMatrices[0] * fragmentPosition;
+  // Clip the triangle to the shadow atlas tile of the light, since the projection-view matrices only move
+  //   the face into the tile, leaving anything outside the face to spill into the tiles next to it.
+  vec4 tileBounds = lightDetails_vertex[light].tileBounds;
+  gl_ClipDistance[0] = gl_Position.x - tileBounds.x * gl_Position.w;
+  gl_ClipDistance[1] = tileBounds.z * gl_Position.w - gl_Position.x;
+  gl_ClipDistance[2] = gl_Position.y - tileBounds.y * gl_Position.w;
+  gl_ClipDistance[3] = tileBounds.w * gl_Position.w - gl_Position.y;
+}
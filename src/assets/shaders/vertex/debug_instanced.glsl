@@ -16,14 +16,19 @@
 
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
+// The model matrix and the line color of the instance.
+layout(location = 3) in mat4 instanceModelMatrix;
+layout(location = 8) in vec4 instanceColor;
 
-// The model-view-projection matrix of the model against the camera.
-uniform mat4 mvpMatrix;
+// The line color of the instance, passed on to the fragment shader.
+out vec4 fragmentColor;
+
+#include "../include/camera.glsl"
 
 void main()
 {
-	// Transform the model vertex using the model-view-projection matrix,
+	// Transform the model vertex using the model matrix of the instance, and the view and projection matrices,
 	//   and return that as the vertex position.
-	gl_Position = mvpMatrix * vec4(vertexPosition, 1.0);
+	gl_Position = projectionMatrix * viewMatrix * instanceModelMatrix * vec4(vertexPosition, 1.0);
+	fragmentColor = instanceColor;
 }
-
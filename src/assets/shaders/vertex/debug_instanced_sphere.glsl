@@ -16,19 +16,22 @@
 
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
+// The model matrix and the line color of the instance.
+layout(location = 3) in mat4 instanceModelMatrix;
+layout(location = 8) in vec4 instanceColor;
 
-// The model-view-projection matrix of the model against the camera.
-uniform mat4 mvpMatrix;
-uniform float radius;
+// The line color of the instance, passed on to the fragment shader.
+out vec4 fragmentColor;
+
+#include "../include/camera.glsl"
 
 void main()
 {
-	// First normalize the mode vertex position so that we get a unit direction
-	//   vector going from the sphere center to the vertex. Then scale to the
-	//   actual position the vertex is supposed to be in based on what the radius
-	//   of the sphere is
-	vec3 scaledVertexPosition = normalize(vertexPosition) * radius;
-	// Transform the scaled model vertex using the model-view-projection matrix,
+	// First normalize the model vertex position so that we get a vertex of a unit sphere, which the model matrix of
+	//   the instance then scales to the radius of the sphere.
+	vec3 unitVertexPosition = normalize(vertexPosition);
+	// Transform the unit sphere vertex using the model matrix of the instance, and the view and projection matrices,
 	//   and return that as the vertex position.
-	gl_Position = mvpMatrix * vec4(scaledVertexPosition, 1.0);
-}
\ No newline at end of file
+	gl_Position = projectionMatrix * viewMatrix * instanceModelMatrix * vec4(unitVertexPosition, 1.0);
+	fragmentColor = instanceColor;
+}
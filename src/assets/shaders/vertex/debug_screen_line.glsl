@@ -0,0 +1,19 @@
+#version 330 core
+
+// The vertex position attribute of the line, in pixels from the bottom-left of the screen.
+layout(location = 0) in vec2 vertexPosition;
+// The color attribute of the line.
+layout(location = 9) in vec4 vertexColor;
+
+// The line color, passed on to the fragment shader.
+out vec4 fragmentColor;
+
+// The projection of the pixels of the screen.
+uniform mat4 projection;
+
+void main()
+{
+	// Project the vertex onto the screen in front of everything else, the same way the text is.
+	gl_Position = projection * vec4(vertexPosition, 1.0, 1.0);
+	fragmentColor = vertexColor;
+}
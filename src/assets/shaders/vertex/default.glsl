@@ -14,8 +14,19 @@
 //   because there is no structure to change. Either the entire
 //   variable is kept as is, or completely removed.
 
-#define MAX_SIMPLE_LIGHTS 2
-#define MAX_CUBE_LIGHTS 5
+// The number of active lights and the disabled features can be fixed when the shader is compiled, by the render manager
+//   defining them when picking a shader variant, so the loops and branches over them are resolved by the compiler.
+//   Otherwise they're read from the uniforms every time.
+#ifdef CONE_LIGHTS_COUNT
+#define ACTIVE_CONE_LIGHTS_COUNT CONE_LIGHTS_COUNT
+#else
+#define ACTIVE_CONE_LIGHTS_COUNT coneLightsCount
+#endif
+#ifdef POINT_LIGHTS_COUNT
+#define ACTIVE_POINT_LIGHTS_COUNT POINT_LIGHTS_COUNT
+#else
+#define ACTIVE_POINT_LIGHTS_COUNT pointLightsCount
+#endif
 
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
@@ -23,6 +34,12 @@ layout(location = 0) in vec3 vertexPosition;
 layout(location = 1) in vec2 vertexUv;
 // The vertex normal vector attribute of the model.
 layout(location = 2) in vec3 vertexNormal;
+// The model matrix attribute of the model instance, occupying four consecutive locations (one per column).
+// This advances once per instance, so all the models sharing a mesh can be drawn with a single call.
+layout(location = 3) in mat4 instanceModelMatrix;
+// The mask of the shadowed lights whose range reaches the model instance, with a bit per cone light followed by a bit
+//   per point light and then a bit per directional light.
+layout(location = 7) in uint instanceLightMask;
 
 // The UV coordinates of the diffuse color of the fragment in the standard object texture.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
@@ -36,6 +53,20 @@ out vec4 fragmentPosition_viewSpace;
 // The normal vector of the fragment in the standard object model in view-space.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 out vec3 fragmentNormal_viewSpace;
+// The mask of the shadowed lights that can reach the fragment, which is the same for the whole model instance.
+flat out uint fragmentLightMask;
+
+#ifdef IMPOSTOR
+// The views of the impostor instance, as the layers of the two views of its object closest to the camera (x and y), how
+//   far the camera is from the first towards the second (z), and the share of the pixels of the impostor drawn (w).
+//   This is read where the spins of the other model instances are, since impostors always face the camera.
+layout(location = 11) in vec4 instanceImpostor;
+// The views of the impostor instance, passed on as are to every fragment of the instance.
+flat out vec4 fragmentImpostor;
+// The directions of the axes of the views of the impostor instance in view-space, which the normals pre-rendered in the
+//   space of the views are turned into view-space by.
+flat out mat3 fragmentImpostorBasis_viewSpace;
+#endif
 
 // The shadow map coordinates of the current fragment w.r.t all the active cone lights.
 out vec4 coneLightShadowMapCoord[MAX_SIMPLE_LIGHTS];
@@ -47,76 +78,83 @@ out vec4 coneLightPosition_viewSpace[MAX_SIMPLE_LIGHTS];
 // Since this value would be the same for all vertices, interpolation won't affect anything.
 out vec4 pointLightPosition_viewSpace[MAX_CUBE_LIGHTS];
 
-// The structure defining the details regarding the model.
-struct ModelDetails_Vertex
-{
-	mat4 modelMatrix;
-	mat4 viewMatrix;
-	mat4 projectionMatrix;
-};
 
-// The structure defining the details regarding the active lights.
-struct LightDetails_Vertex
-{
-	vec3 lightPosition;
-	mat4 lightVpMatrix;
-	// vec3 lightColor;
-	// float lightIntensity;
-	// float nearPlane;
-	// float farPlane;
-	// int layerId;
-};
+#include "../include/camera.glsl"
 
+#ifndef IMPOSTOR
+#include "../include/instance_spin.glsl"
+#endif
 
-// The details of the model.
-uniform ModelDetails_Vertex modelDetails_vertex;
+#include "../include/diffuse_texture_vertex.glsl"
 
-// The number of active cone lights (2D texture lights).
-uniform int coneLightsCount;
-// The number of active point lights (cubemap texture lights).
-uniform int pointLightsCount;
+#include "../include/lights.glsl"
 
-// The details of the active cone lights (2D texture lights).
-uniform LightDetails_Vertex coneLightDetails_vertex[MAX_SIMPLE_LIGHTS];
-// The details of the active point lights (cubemap texture lights).
-uniform LightDetails_Vertex pointLightDetails_vertex[MAX_CUBE_LIGHTS];
+// The position is computed the same way as in the depth pre-pass shader, so it needs to give exactly the same result
+//   for the colour pass to pass the equal depth test.
+invariant gl_Position;
 
 void main()
 {
+#ifdef DEFERRED_LIGHTING
+	// The lighting pass of deferred shading doesn't draw a model, but a single triangle covering the whole screen,
+	//   with its corners (-1, -1), (3, -1) and (-1, 3) picked from the index of the vertex.
+	gl_Position = vec4((gl_VertexID & 1) * 4 - 1, (gl_VertexID & 2) * 2 - 1, 0.0, 1.0);
+#else
+#ifdef IMPOSTOR
+	// Impostors are turned to face the camera on the CPU, spin included, so their model matrix is used as is.
+	mat4 spunModelMatrix = instanceModelMatrix;
+	fragmentImpostor = instanceImpostor;
+	mat3 impostorBasis_viewSpace = mat3(viewMatrix * instanceModelMatrix);
+	fragmentImpostorBasis_viewSpace = mat3(normalize(impostorBasis_viewSpace[0]), normalize(impostorBasis_viewSpace[1]), normalize(impostorBasis_viewSpace[2]));
+#else
+	// Calculate the model matrix of the instance, turned by its spin.
+	mat4 spunModelMatrix = getSpunInstanceMatrix();
+#endif
 	// Calculate the position of the model vertex in world-space.
-	vec4 vertexPosition_worldSpace = modelDetails_vertex.modelMatrix * vec4(vertexPosition, 1.0);
+	vec4 vertexPosition_worldSpace = spunModelMatrix * vec4(vertexPosition, 1.0);
 
 	// Transform the model vertex from view-space using the projection matrix of the camera,
-	//   and set that as the position of the vertex.
-	gl_Position = modelDetails_vertex.projectionMatrix * modelDetails_vertex.viewMatrix * vertexPosition_worldSpace;
+	//   and set that as the position of the vertex. This must stay the same expression as
+	//   in the depth pre-pass shader, so the depths match exactly.
+	gl_Position = projectionMatrix * viewMatrix * vertexPosition_worldSpace;
 
 	// Calculate the direction of the vertex normal in view-space.
-	vec3 vertexNormal_viewSpace = (modelDetails_vertex.viewMatrix * modelDetails_vertex.modelMatrix * vec4(vertexNormal, 0.0)).xyz;
+	vec3 vertexNormal_viewSpace = (viewMatrix * spunModelMatrix * vec4(vertexNormal, 0.0)).xyz;
 
 	// Set the value of the UV coordinate of all fragments that are interpolated through this vertex.
 	fragmentUv = vertexUv;
+#ifdef BINDLESS_TEXTURES
+	// Pass on the texture handle of the model instance.
+	fragmentTextureHandle = instanceTextureHandle;
+#endif
 	// Set the value of the world-space position of all fragments that are interpolated through this vertex.
 	fragmentPosition_worldSpace = vertexPosition_worldSpace;
 	// Set the value of the view-space normal vector of all fragments that are interpolated through this vertex.
 	fragmentNormal_viewSpace = vertexNormal_viewSpace;
+	// Pass on the lights that can reach the model instance.
+	fragmentLightMask = instanceLightMask;
 
 	// Calculate the position of the current fragment in view-space.
-	fragmentPosition_viewSpace = modelDetails_vertex.viewMatrix * vertexPosition_worldSpace;
+	fragmentPosition_viewSpace = viewMatrix * vertexPosition_worldSpace;
 
-	// Iterate through all the active cone lights.
-	for (int lightIndex = 0; lightIndex < coneLightsCount; lightIndex++)
+#ifndef DEFERRED_GBUFFER
+	// Iterate through all the active cone lights. The geometry pass of deferred shading leaves the lights to the
+	//   lighting pass, so it doesn't need them.
+	for (int lightIndex = 0; lightIndex < ACTIVE_CONE_LIGHTS_COUNT; lightIndex++)
 	{
 		// Calculate the position of the light in view-space.
-		coneLightPosition_viewSpace[lightIndex] = modelDetails_vertex.viewMatrix * vec4(coneLightDetails_vertex[lightIndex].lightPosition, 1.0);
+		coneLightPosition_viewSpace[lightIndex] = viewMatrix * vec4(coneLightDetails[lightIndex].lightPosition, 1.0);
 
 		// Calculate the depth of the interpolated fragment w.r.t to the light source (without accounting for perspective division).
-		coneLightShadowMapCoord[lightIndex] = coneLightDetails_vertex[lightIndex].lightVpMatrix * modelDetails_vertex.modelMatrix * vec4(vertexPosition, 1.0);
+		coneLightShadowMapCoord[lightIndex] = coneLightDetails[lightIndex].lightVpMatrix * spunModelMatrix * vec4(vertexPosition, 1.0);
 	}
 
 	// Iterate through all the active point lights.
-	for (int lightIndex = 0; lightIndex < pointLightsCount; lightIndex++)
+	for (int lightIndex = 0; lightIndex < ACTIVE_POINT_LIGHTS_COUNT; lightIndex++)
 	{
 		// Calculate the position of the light in view-space.
-		pointLightPosition_viewSpace[lightIndex] = modelDetails_vertex.viewMatrix * vec4(pointLightDetails_vertex[lightIndex].lightPosition, 1.0);
+		pointLightPosition_viewSpace[lightIndex] = viewMatrix * vec4(pointLightDetails[lightIndex].lightPosition, 1.0);
 	}
+#endif
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,24 @@
+#version 330 core
+
+// The vertex position attribute of the model.
+layout(location = 0) in vec3 vertexPosition;
+// The model matrix attribute of the model instance, occupying four consecutive locations (one per column).
+// This advances once per instance, so all the models sharing a mesh can be drawn with a single call.
+layout(location = 3) in mat4 instanceModelMatrix;
+
+
+#include "../include/camera.glsl"
+
+#include "../include/instance_spin.glsl"
+
+// The colour pass tests its depths for being equal to the ones written by this shader, so the position needs to come
+//   out exactly the same as in the model shaders.
+invariant gl_Position;
+
+void main()
+{
+	// Transform the model vertex into world-space, and then further transform it
+	//   based on the view and projection of the camera, and return that as the
+	//   vertex position. This must stay the same expression as in the model shaders.
+	gl_Position = projectionMatrix * viewMatrix * (getSpunInstanceMatrix() * vec4(vertexPosition, 1.0));
+}
\ No newline at end of file
@@ -17,11 +17,23 @@
 // The vertex position attribute of the model.
 layout(location = 0) in vec3 vertexPosition;
 
-// The transformation matrix to transform the model into world-space.
-uniform mat4 modelMatrix;
+// The transformation matrix to transform the model instance into world-space, occupying four consecutive
+//   locations (one per column). This advances once per instance, so all the models sharing a mesh can be
+//   drawn with a single call.
+layout(location = 3) in mat4 instanceModelMatrix;
+// The mask of the shadow map faces the model instance can be seen from, with one bit for each face of each light
+//   (bit light * 6 + face). Faces the instance is culled from are skipped by the geometry shader.
+layout(location = 7) in uint instanceShadowMask;
+
+#include "../include/instance_spin.glsl"
+
+// The shadow map face mask of the model instance, passed on to the geometry shader.
+flat out uint shadowMask_geometry;
 
 void main()
 {
 	// Transform the model vertex into world-space, and return that as the vertex position.
-	gl_Position = modelMatrix * vec4(vertexPosition, 1.0);
+	gl_Position = getSpunInstanceMatrix() * vec4(vertexPosition, 1.0);
+	// Pass on the shadow map face mask of the model instance.
+	shadowMask_geometry = instanceShadowMask;
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 330 core
+
+// The corners of the box tested for occlusion, in world space.
+uniform vec3 boxMinCorner;
+uniform vec3 boxMaxCorner;
+
+#include "../include/camera.glsl"
+
+// The corners of a unit cube in the order of a triangle strip covering all of its faces, so the box is drawn from its
+//   uniforms alone without any vertex buffer.
+const vec3 cubeStripCorners[14] = vec3[14](vec3(0.0, 1.0, 1.0), vec3(1.0, 1.0, 1.0), vec3(0.0, 0.0, 1.0), vec3(1.0, 0.0, 1.0),
+																					 vec3(1.0, 0.0, 0.0), vec3(1.0, 1.0, 1.0), vec3(1.0, 1.0, 0.0), vec3(0.0, 1.0, 1.0),
+																					 vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0),
+																					 vec3(0.0, 1.0, 0.0), vec3(1.0, 1.0, 0.0));
+
+void main()
+{
+	// Stretch the corner of the unit cube over the box, and project it with the camera matrices.
+	vec3 position = mix(boxMinCorner, boxMaxCorner, cubeStripCorners[gl_VertexID]);
+	gl_Position = projectionMatrix * viewMatrix * vec4(position, 1.0);
+}
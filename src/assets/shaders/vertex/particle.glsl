@@ -0,0 +1,38 @@
+#version 330 core
+
+// The state of the particle.
+layout(location = 0) in vec3 particlePosition;
+layout(location = 1) in float particleBirthTime;
+layout(location = 3) in float particleLifetime;
+
+// How far the particle is through its life, passed on to the fragment shader.
+out float fragmentAge;
+
+#include "../include/camera.glsl"
+
+// The time of the frame, in seconds, and the height of the viewport the particles are drawn to, in pixels.
+uniform float particleTime;
+uniform float viewportHeight;
+
+// The size of the particles, in world units.
+const float particleSize = 0.15;
+
+void main()
+{
+	float age = (particleTime - particleBirthTime) / particleLifetime;
+	vec4 viewPosition = viewMatrix * vec4(particlePosition, 1.0);
+	// Move the dead particles and the ones behind the camera outside the clip volume, so they're clipped away.
+	if (age < 0.0 || age >= 1.0 || viewPosition.z >= 0.0)
+	{
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		gl_PointSize = 0.0;
+		fragmentAge = 1.0;
+		return;
+	}
+
+	gl_Position = projectionMatrix * viewPosition;
+	// Size the point sprite the way the projection would size a quad of the particle size at its distance, shrinking it
+	//   as the particle gets older.
+	gl_PointSize = particleSize * projectionMatrix[1][1] * viewportHeight / -viewPosition.z * (1.0 - age * 0.5);
+	fragmentAge = age;
+}
@@ -0,0 +1,60 @@
+#version 330 core
+
+// The state of the particle, as the last update left it.
+layout(location = 0) in vec3 particlePosition;
+layout(location = 1) in float particleBirthTime;
+layout(location = 2) in vec3 particleVelocity;
+layout(location = 3) in float particleLifetime;
+
+// The state of the particle after the update, captured into the other particle buffer.
+out vec3 nextPosition;
+out float nextBirthTime;
+out vec3 nextVelocity;
+out float nextLifetime;
+
+// The emitters of the bursts, with the position of the burst in xyz and the time it was emitted at in w. Each emitter
+//   owns a block of particles, which are all thrown out again whenever the emitter is given a newer burst.
+uniform vec4 emitters[MAX_PARTICLE_EMITTERS];
+// The time of the frame and the time since the last update, in seconds.
+uniform float particleTime;
+uniform float particleDeltaTime;
+
+// The pull of gravity, and the share of their speed the particles lose every second.
+const vec3 gravity = vec3(0.0, -9.8, 0.0);
+const float drag = 1.5;
+
+// Hash the given seed into a random number between 0 and 1.
+float random(inout uint seed)
+{
+	seed = seed * 747796405u + 2891336453u;
+	uint word = ((seed >> ((seed >> 28u) + 4u)) ^ seed) * 277803737u;
+	return float((word >> 22u) ^ word) / 4294967295.0;
+}
+
+void main()
+{
+	vec4 emitter = emitters[gl_VertexID / PARTICLES_PER_EMITTER];
+	if (emitter.w > particleBirthTime)
+	{
+		// The emitter was given a new burst, so throw the particle out of its position in a random direction, with a
+		//   random speed and lifetime, seeded by the particle and the burst so every burst looks different.
+		uint seed = uint(gl_VertexID) ^ floatBitsToUint(emitter.w);
+		float z = random(seed) * 2.0 - 1.0;
+		float angle = random(seed) * 6.2831853;
+		vec3 direction = vec3(sqrt(1.0 - z * z) * vec2(cos(angle), sin(angle)), z);
+		nextPosition = emitter.xyz;
+		nextBirthTime = emitter.w;
+		nextVelocity = direction * mix(2.0, 10.0, random(seed));
+		nextLifetime = mix(0.4, PARTICLE_MAX_LIFETIME, random(seed));
+		return;
+	}
+
+	// Move the particle along its velocity, slowed by the drag and pulled down by gravity. The particles that died are
+	//   carried over as they are.
+	bool alive = particleTime - particleBirthTime < particleLifetime;
+	vec3 velocity = alive ? (particleVelocity + gravity * particleDeltaTime) * max(1.0 - drag * particleDeltaTime, 0.0) : particleVelocity;
+	nextPosition = alive ? particlePosition + velocity * particleDeltaTime : particlePosition;
+	nextBirthTime = particleBirthTime;
+	nextVelocity = velocity;
+	nextLifetime = particleLifetime;
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// The vertex position attribute of the sprite mesh.
+layout(location = 0) in vec3 vertexPosition;
+// The vertex UV coordinate attribute of the sprite mesh.
+layout(location = 1) in vec2 vertexUv;
+// The model matrix attribute of the sprite instance, occupying four consecutive locations (one per column), with any
+//   spin of the model already applied on the CPU.
+layout(location = 3) in mat4 instanceModelMatrix;
+// The layer of the sprite texture array the texture of the sprite instance was copied into, with the top bit set if the
+//   black parts of the texture are drawn transparent.
+layout(location = 7) in uint instanceSprite;
+
+// The UV coordinates of the fragment along with the layer of the sprite texture array, interpolated by the GPU.
+out vec3 fragmentUv;
+// Whether the alpha of the fragment is taken from how bright its color is.
+flat out uint fragmentBlackAlpha;
+
+#include "../include/camera.glsl"
+
+void main()
+{
+	gl_Position = projectionMatrix * viewMatrix * (instanceModelMatrix * vec4(vertexPosition, 1.0));
+	fragmentUv = vec3(vertexUv, float(instanceSprite & 0x7fffffffu));
+	fragmentBlackAlpha = instanceSprite >> 31;
+}
@@ -1,17 +1,22 @@
 #version 330 core
 
-layout (location = 0) in vec2 vertexPosition;
-layout (location = 1) in vec2 vertexUv;
-layout (location = 2) in float vertexUvLayer;
+// The instance record of the character, with the bottom-left corner (x, y) and the size (z, w) of its quad on the screen,
+//   the UVs of the top-left (x, y) and bottom-right (z, w) corners of its glyph in the atlas, and its color.
+layout (location = 0) in vec4 glyphRect;
+layout (location = 1) in vec4 glyphUvRect;
+layout (location = 8) in vec4 glyphColor;
 
 out vec2 fragmentUv;
-out float fragmentUvLayer;
+out vec4 fragmentColor;
 
 uniform mat4 projection;
 
 void main()
 {
-    gl_Position = projection * vec4(vertexPosition.xy, 1.0, 1.0);
-    fragmentUv = vertexUv;
-    fragmentUvLayer = vertexUvLayer;
-}
\ No newline at end of file
+    // The quad is drawn as a strip of four vertices, running bottom-left, bottom-right, top-left, top-right.
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = projection * vec4(glyphRect.xy + corner * glyphRect.zw, 1.0, 1.0);
+    // The rows of the glyphs are stored from the top, so the V coordinates run down the quad.
+    fragmentUv = vec2(mix(glyphUvRect.x, glyphUvRect.z, corner.x), mix(glyphUvRect.w, glyphUvRect.y, corner.y));
+    fragmentColor = glyphColor;
+}
@@ -20,30 +20,37 @@ layout(location = 0) in vec3 vertexPosition;
 layout(location = 1) in vec2 vertexUv;
 // The vertex normal vector attribute of the model.
 layout(location = 2) in vec3 vertexNormal;
+// The model matrix attribute of the model instance, occupying four consecutive locations (one per column).
+// This advances once per instance, so all the models sharing a mesh can be drawn with a single call.
+layout(location = 3) in mat4 instanceModelMatrix;
 
 // The UV coordinates of the diffuse color of the fragment in the shot object texture.
 // This is interpolated by the GPU for the fragment when passed from the vertex shader.
 out vec2 fragmentUv;
 
 
-// The structure defining the details regarding the model.
-struct ModelDetails_Vertex
-{
-	mat4 modelMatrix;
-	mat4 viewMatrix;
-	mat4 projectionMatrix;
-};
+#include "../include/camera.glsl"
+
+#include "../include/instance_spin.glsl"
+
+#include "../include/diffuse_texture_vertex.glsl"
 
-// The details of the model.
-uniform ModelDetails_Vertex modelDetails_vertex;
+// The position is computed the same way as in the depth pre-pass shader, so it needs to give exactly the same result
+//   for the colour pass to pass the equal depth test.
+invariant gl_Position;
 
 void main()
 {
 	// Transform the model vertex into world-space, and then further transform it
 	//   based on the view and projection of the camera, and return that as the
-	//   vertex position.
-	gl_Position = modelDetails_vertex.projectionMatrix * modelDetails_vertex.viewMatrix * modelDetails_vertex.modelMatrix * vec4(vertexPosition, 1.0);
+	//   vertex position. This must stay the same expression as in the depth pre-pass
+	//   shader, so the depths match exactly.
+	gl_Position = projectionMatrix * viewMatrix * (getSpunInstanceMatrix() * vec4(vertexPosition, 1.0));
 
 	// Set the value of the UV coordinate of all fragments that are interpolated through this vertex.
 	fragmentUv = vertexUv;
+#ifdef BINDLESS_TEXTURES
+	// Pass on the texture handle of the model instance.
+	fragmentTextureHandle = instanceTextureHandle;
+#endif
 }
\ No newline at end of file
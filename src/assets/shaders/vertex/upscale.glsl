@@ -0,0 +1,11 @@
+#version 330 core
+
+// The UV coordinates of the pixel on the screen, from the bottom-left to the top-right.
+out vec2 screenUv;
+
+void main()
+{
+	// Cover the screen with a single triangle, with its corners picked from the vertex ID since it has no vertex data.
+	gl_Position = vec4((gl_VertexID & 1) * 4 - 1, (gl_VertexID & 2) * 2 - 1, 0.0, 1.0);
+	screenUv = gl_Position.xy * 0.5 + 0.5;
+}
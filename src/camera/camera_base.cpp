@@ -7,6 +7,11 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "../include/frustum.cpp"
+#include "../include/collider.cpp"
+#include "../include/slot_map.cpp"
+#include "../include/frame_time.cpp"
+
 /**
  * Base class for creating cameras.
  */
@@ -14,8 +19,10 @@ class CameraBase
 {
 
 private:
-  // The ID of the camera.
+  // The ID of the camera, kept for debugging.
   const std::string cameraId;
+  // The handle of the camera in the camera manager, which is invalid while the camera isn't registered.
+  SlotHandle cameraHandle;
   // The name of the camera.
   const std::string cameraName;
 
@@ -26,24 +33,68 @@ private:
   // The direction that is the up direction for the camera.
   glm::vec3 up;
 
-  // The view matrix of the camera.
-  glm::mat4 viewMatrix;
-  // The projection matrix of the camera.
-  glm::mat4 projectionMatrix;
+  // The view and projection matrices of the camera, along with their inverses.
+  mutable glm::mat4 viewMatrix;
+  mutable glm::mat4 inverseViewMatrix;
+  mutable glm::mat4 projectionMatrix;
+  mutable glm::mat4 inverseProjectionMatrix;
+  // The projection-view matrix of the camera, its inverse, and the view frustum it makes.
+  mutable glm::mat4 viewProjectionMatrix;
+  mutable glm::mat4 inverseViewProjectionMatrix;
+  mutable Frustum frustum;
+  // Whether the view or projection matrix is stale. The matrices are only rebuilt when they're asked for after the camera
+  //   moved, so cameras that stay put never rebuild them. The projection details of a camera are fixed, so its projection
+  //   matrix is only built the first time.
+  mutable bool isViewMatrixDirty;
+  mutable bool isProjectionMatrixDirty;
+
+  /**
+   * Rebuild the stale matrices of the camera, and everything made from them.
+   */
+  void updateMatrices() const
+  {
+    if (!isViewMatrixDirty && !isProjectionMatrixDirty)
+    {
+      return;
+    }
+    if (isViewMatrixDirty)
+    {
+      viewMatrix = glm::lookAt(position, position + direction, up);
+      inverseViewMatrix = glm::inverse(viewMatrix);
+    }
+    if (isProjectionMatrixDirty)
+    {
+      projectionMatrix = createProjectionMatrix();
+      inverseProjectionMatrix = glm::inverse(projectionMatrix);
+    }
+    viewProjectionMatrix = projectionMatrix * viewMatrix;
+    inverseViewProjectionMatrix = inverseViewMatrix * inverseProjectionMatrix;
+    frustum = Frustum(viewProjectionMatrix);
+    isViewMatrixDirty = false;
+    isProjectionMatrixDirty = false;
+  }
 
 protected:
   CameraBase(const std::string &cameraId,
              const std::string &cameraName,
              const glm::vec3 &position,
              const glm::vec3 &direction,
-             const glm::vec3 &up,
-             const glm::mat4 &projectionMatrix)
+             const glm::vec3 &up)
       : cameraId(cameraId),
+        cameraHandle({0, 0}),
         cameraName(cameraName),
         position(position),
         direction(direction),
         up(up),
-        projectionMatrix(projectionMatrix) {}
+        viewMatrix(1.0f),
+        inverseViewMatrix(1.0f),
+        projectionMatrix(1.0f),
+        inverseProjectionMatrix(1.0f),
+        viewProjectionMatrix(1.0f),
+        inverseViewProjectionMatrix(1.0f),
+        frustum(glm::mat4(1.0f)),
+        isViewMatrixDirty(true),
+        isProjectionMatrixDirty(true) {}
 
   virtual ~CameraBase() {}
 
@@ -58,6 +109,26 @@ public:
     return cameraId;
   }
 
+  /**
+   * Get the handle of the camera in the camera manager.
+   * 
+   * @return The camera handle.
+   */
+  const SlotHandle &getCameraHandle() const
+  {
+    return cameraHandle;
+  }
+
+  /**
+   * Set the handle of the camera in the camera manager, done by the camera manager when the camera is registered.
+   * 
+   * @param newCameraHandle  The camera handle.
+   */
+  void setCameraHandle(const SlotHandle &newCameraHandle)
+  {
+    cameraHandle = newCameraHandle;
+  }
+
   /**
    * Get the name of the camera.
    * 
@@ -99,25 +170,101 @@ public:
   }
 
   /**
-   * Get the view matrix of the camera.
+   * Get the view matrix of the camera, rebuilding it first if it's stale.
    * 
    * @return The camera view matrix.
    */
   const glm::mat4 &getViewMatrix() const
   {
+    updateMatrices();
     return viewMatrix;
   }
 
   /**
-   * Get the projection matrix of the camera.
+   * Get the inverse of the view matrix of the camera, rebuilding it first if it's stale.
+   * 
+   * @return The camera inverse view matrix.
+   */
+  const glm::mat4 &getInverseViewMatrix() const
+  {
+    updateMatrices();
+    return inverseViewMatrix;
+  }
+
+  /**
+   * Get the projection matrix of the camera, rebuilding it first if it's stale.
    * 
    * @return The camera projection matrix.
    */
   const glm::mat4 &getProjectionMatrix() const
   {
+    updateMatrices();
     return projectionMatrix;
   }
 
+  /**
+   * Get the inverse of the projection matrix of the camera, rebuilding it first if it's stale.
+   * 
+   * @return The camera inverse projection matrix.
+   */
+  const glm::mat4 &getInverseProjectionMatrix() const
+  {
+    updateMatrices();
+    return inverseProjectionMatrix;
+  }
+
+  /**
+   * Get the projection-view matrix of the camera, rebuilding it first if it's stale.
+   * 
+   * @return The camera projection-view matrix.
+   */
+  const glm::mat4 &getViewProjectionMatrix() const
+  {
+    updateMatrices();
+    return viewProjectionMatrix;
+  }
+
+  /**
+   * Get the inverse of the projection-view matrix of the camera, rebuilding it first if it's stale.
+   * 
+   * @return The camera inverse projection-view matrix.
+   */
+  const glm::mat4 &getInverseViewProjectionMatrix() const
+  {
+    updateMatrices();
+    return inverseViewProjectionMatrix;
+  }
+
+  /**
+   * Get the view frustum of the camera, for checking what the camera can see, rebuilding it first if it's stale.
+   * 
+   * @return The camera view frustum.
+   */
+  const Frustum &getFrustum() const
+  {
+    updateMatrices();
+    return frustum;
+  }
+
+  /**
+   * Get the ray going from the near plane of the camera through the given point of the screen, for finding what's under
+   *   the cursor.
+   * 
+   * @param screenPosition  The point of the screen, from 0 to 1 across it and from 0 at the top to 1 at the bottom, the
+   *                          same as the cursor position.
+   * 
+   * @return The ray through the point.
+   */
+  Ray getScreenRay(const glm::vec2 &screenPosition) const
+  {
+    // Move the point on the near and far planes back out of clip space.
+    const auto clipPosition = glm::vec2(screenPosition.x * 2.0f - 1.0f, 1.0f - screenPosition.y * 2.0f);
+    const auto nearPoint = getInverseViewProjectionMatrix() * glm::vec4(clipPosition, -1.0f, 1.0f);
+    const auto farPoint = getInverseViewProjectionMatrix() * glm::vec4(clipPosition, 1.0f, 1.0f);
+    const auto nearPosition = glm::vec3(nearPoint) / nearPoint.w;
+    return Ray(nearPosition, glm::vec3(farPoint) / farPoint.w - nearPosition);
+  }
+
   /**
    * Set the position of the camera.
    * 
@@ -161,15 +308,23 @@ public:
    */
   virtual void deinit() {}
 
+  /**
+   * Mark the view matrix of the camera as stale after any of its properties changed, so it's rebuilt once it's next
+   * asked for.
+   */
+  void update()
+  {
+    isViewMatrixDirty = true;
+  }
+
   /**
    * Update the camera during the update step before starting rendering.
+   * 
+   * @param frameTime  The time of the frame.
    */
-  virtual void update()
+  virtual void update(const FrameTime &)
   {
-    // Calculate the view matrix of the camera.
-    viewMatrix = glm::lookAt(position, position + direction, up);
-    // Calculate the projection matrix of the camera.
-    projectionMatrix = createProjectionMatrix();
+    update();
   }
 
   /**
@@ -177,7 +332,7 @@ public:
    * 
    * @return The calculated projection matrix.
    */
-  const virtual glm::mat4 createProjectionMatrix() = 0;
+  virtual glm::mat4 createProjectionMatrix() const = 0;
 };
 
 #endif
\ No newline at end of file
@@ -36,16 +36,12 @@ private:
   // The farthest distance the camera can capture till.
   const float_t farPlane;
 
-  // The timestamp of the last time the update for the camera was started.
-  float_t lastTime;
   // The horizontal angle of the camera.
   float_t horizontalAngle;
   // The vertical angle of the camera.
   float_t verticalAngle;
   // Whether to accept input or not.
   bool acceptInput;
-  // The last time the ability to accept input was changed.
-  float_t lastAcceptInputChange;
 
   /**
    * Update the camera.
@@ -79,8 +75,7 @@ public:
             "Orthographic",
             glm::vec3(0.0f),
             glm::vec3(0.0f),
-            glm::vec3(0.0f, 1.0f, 0.0f),
-            glm::ortho(-1.0f / ASPECT_RATIO, 1.0f / ASPECT_RATIO, -1.0f, 1.0f, 0.1f, 100.0f)),
+            glm::vec3(0.0f, 1.0f, 0.0f)),
         controlManager(ControlManager::getInstance()),
         defaultPosition(glm::vec3(0.0f)),
         defaultHorizontalAngle(0.0f),
@@ -88,21 +83,17 @@ public:
         aspectRatio(ASPECT_RATIO),
         nearPlane(0.1f),
         farPlane(100.0f),
-        lastTime(glfwGetTime()),
         horizontalAngle(0.0f),
         verticalAngle(0.0f),
-        acceptInput(false),
-        lastAcceptInputChange(glfwGetTime() - 10.0f) {}
+        acceptInput(false) {}
 
-  void update() override
+  void update(const FrameTime &frameTime) override
   {
-    // Get the current time for the start of the update.
-    const auto currentTime = glfwGetTime();
-    // Get the time difference since the start of the last update.
-    const auto deltaTime = float_t(currentTime - lastTime);
+    // Get the time difference since the start of the last frame.
+    const auto &deltaTime = frameTime.delta;
 
-    // Check if the M key was pressed after 500ms since the last accept input change.
-    if (controlManager.isKeyPressed(GLFW_KEY_M) && (currentTime - lastAcceptInputChange) > 0.5f)
+    // Check if the M key was pressed for the accept input toggle.
+    if (controlManager.wasKeyPressed(GLFW_KEY_M))
     {
       // "M" key was pressed. Toggle accepting input.
       acceptInput = !acceptInput;
@@ -116,13 +107,6 @@ public:
       {
         controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
       }
-      // Update the timestamp for the last time accept input flag was changed.
-      lastAcceptInputChange = currentTime;
-      // Consume any keypresses used for moving the camera.
-      controlManager.isKeyPressed(GLFW_KEY_UP);
-      controlManager.isKeyPressed(GLFW_KEY_DOWN);
-      controlManager.isKeyPressed(GLFW_KEY_RIGHT);
-      controlManager.isKeyPressed(GLFW_KEY_LEFT);
     }
 
     // If input is not being accepted, just consume mouse inputs and end.
@@ -176,9 +160,6 @@ public:
 
     /// Update the camera.
     updateCamera(newDirection);
-
-    // Set the timestamp for the start of the last update to the starting timestamp of the current update.
-    lastTime = currentTime;
   }
 
   /**
@@ -256,7 +237,7 @@ public:
    * 
    * @return The camera's projection matrix.
    */
-  const glm::mat4 createProjectionMatrix() override
+  glm::mat4 createProjectionMatrix() const override
   {
     return glm::ortho(-1.0f / aspectRatio, 1.0f / aspectRatio, -1.0f, 1.0f, nearPlane, farPlane);
   }
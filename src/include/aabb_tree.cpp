@@ -0,0 +1,516 @@
+#ifndef INCLUDE_AABB_TREE_CPP
+#define INCLUDE_AABB_TREE_CPP
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "slot_map.cpp"
+#include "collider.cpp"
+#include "frustum.cpp"
+#include "broadphase.cpp"
+
+/**
+ * Class for a broadphase that keeps the bounding boxes of the entries in a dynamic bounding volume hierarchy, a binary
+ * tree whose every node bounds the boxes under it. Entries are inserted under the sibling that grows the tree the least,
+ * and the tree is kept balanced with rotations, so it adapts to entries bunched up in a few places or of very different
+ * sizes. Each entry is stored with a box fattened by a margin, so an entry only needs to be re-inserted once it moves
+ * out of its fattened box.
+ */
+class DynamicAabbTree : public Broadphase
+{
+private:
+  // The index standing for no node.
+  static const int32_t NULL_NODE = -1;
+
+  /**
+   * Structure for defining a node of the tree. Leaves hold the entries, and the other nodes always have two children.
+   */
+  struct TreeNode
+  {
+    // The corners of the box bounding every entry under the node, fattened for leaves.
+    glm::vec3 minCorner;
+    glm::vec3 maxCorner;
+    // The indices of the parent and the children of the node.
+    int32_t parent;
+    int32_t child1;
+    int32_t child2;
+    // The height of the node in the tree, 0 for leaves and -1 for free nodes.
+    int32_t height;
+    // The handle of the entry, if the node is a leaf.
+    SlotHandle entryId;
+    // The mask of the collision layers of every entry under the node, so the queries skip the subtrees without any of
+    //   the layers they look for.
+    uint32_t layers;
+
+    /**
+     * Check if the node is a leaf.
+     *
+     * @return Whether the node is a leaf.
+     */
+    bool isLeaf() const
+    {
+      return child1 == NULL_NODE;
+    }
+  };
+
+  // The margin the boxes of the entries are fattened by on every side.
+  const float_t fatMargin;
+
+  // The nodes of the tree, with the free ones reused before new ones are added.
+  std::vector<TreeNode> nodes;
+  std::vector<int32_t> freeNodes;
+  // The index of the root node.
+  int32_t root;
+  // The index of the leaf of each entry, by the handle of the entry.
+  std::unordered_map<SlotHandle, int32_t> entryLeaves;
+
+  /**
+   * Get the surface area of the box with the given corners, which is what the tree tries to keep small.
+   *
+   * @param minCorner  The minimum corner of the box.
+   * @param maxCorner  The maximum corner of the box.
+   *
+   * @return The surface area of the box.
+   */
+  static float_t getSurfaceArea(const glm::vec3 &minCorner, const glm::vec3 &maxCorner)
+  {
+    const auto size = maxCorner - minCorner;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+  }
+
+  /**
+   * Check if the boxes with the given corners overlap.
+   *
+   * @param minCorner1  The minimum corner of the first box.
+   * @param maxCorner1  The maximum corner of the first box.
+   * @param minCorner2  The minimum corner of the second box.
+   * @param maxCorner2  The maximum corner of the second box.
+   *
+   * @return Whether the boxes overlap.
+   */
+  static bool haveBoxesOverlapped(const glm::vec3 &minCorner1, const glm::vec3 &maxCorner1, const glm::vec3 &minCorner2, const glm::vec3 &maxCorner2)
+  {
+    return glm::all(glm::lessThanEqual(minCorner1, maxCorner2)) && glm::all(glm::lessThanEqual(minCorner2, maxCorner1));
+  }
+
+  /**
+   * Allocate a node, reusing a free one if there are any.
+   *
+   * @return The index of the node.
+   */
+  int32_t allocateNode()
+  {
+    int32_t nodeIndex;
+    if (!freeNodes.empty())
+    {
+      nodeIndex = freeNodes.back();
+      freeNodes.pop_back();
+    }
+    else
+    {
+      nodeIndex = nodes.size();
+      nodes.push_back({});
+    }
+    nodes[nodeIndex] = {glm::vec3(0.0f), glm::vec3(0.0f), NULL_NODE, NULL_NODE, NULL_NODE, 0, {0, 0}, 0};
+    return nodeIndex;
+  }
+
+  /**
+   * Free the node, so it can be reused.
+   *
+   * @param nodeIndex  The index of the node.
+   */
+  void freeNode(const int32_t &nodeIndex)
+  {
+    nodes[nodeIndex].height = -1;
+    nodes[nodeIndex].entryId = {0, 0};
+    freeNodes.push_back(nodeIndex);
+  }
+
+  /**
+   * Recalculate the box, height and layers of the node from its children.
+   *
+   * @param nodeIndex  The index of the node.
+   */
+  void refitNode(const int32_t &nodeIndex)
+  {
+    auto &node = nodes[nodeIndex];
+    const auto &child1 = nodes[node.child1];
+    const auto &child2 = nodes[node.child2];
+    node.minCorner = glm::min(child1.minCorner, child2.minCorner);
+    node.maxCorner = glm::max(child1.maxCorner, child2.maxCorner);
+    node.height = 1 + std::max(child1.height, child2.height);
+    node.layers = child1.layers | child2.layers;
+  }
+
+  /**
+   * Rotate the subtree of the node if one of its children is more than one level taller than the other, moving a
+   *   grandchild of the taller side up to take the node's place.
+   *
+   * @param nodeIndex  The index of the node.
+   *
+   * @return The index of the node at the top of the subtree after rotating.
+   */
+  int32_t balance(const int32_t &nodeIndex)
+  {
+    const auto a = nodeIndex;
+    if (nodes[a].isLeaf() || nodes[a].height < 2)
+    {
+      return a;
+    }
+
+    const auto b = nodes[a].child1;
+    const auto c = nodes[a].child2;
+    const auto heightDifference = nodes[c].height - nodes[b].height;
+    if (heightDifference == 0 || std::abs(heightDifference) == 1)
+    {
+      return a;
+    }
+
+    // Move the taller child up, keeping its taller child under it and moving its other child under the node.
+    const auto up = heightDifference > 1 ? c : b;
+    const auto other = heightDifference > 1 ? b : c;
+    const auto f = nodes[up].child1;
+    const auto g = nodes[up].child2;
+
+    // Put the taller child in the place of the node.
+    nodes[up].child1 = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+    if (nodes[up].parent != NULL_NODE)
+    {
+      auto &upParent = nodes[nodes[up].parent];
+      (upParent.child1 == a ? upParent.child1 : upParent.child2) = up;
+    }
+    else
+    {
+      root = up;
+    }
+
+    // Keep the taller grandchild under the moved child, and move the shorter one under the node.
+    const auto keptGrandchild = nodes[f].height > nodes[g].height ? f : g;
+    const auto movedGrandchild = keptGrandchild == f ? g : f;
+    nodes[up].child2 = keptGrandchild;
+    nodes[a].child1 = other;
+    nodes[a].child2 = movedGrandchild;
+    nodes[movedGrandchild].parent = a;
+    refitNode(a);
+    refitNode(up);
+    return up;
+  }
+
+  /**
+   * Insert the leaf into the tree, next to the node that makes the tree grow the least.
+   *
+   * @param leafIndex  The index of the leaf.
+   */
+  void insertLeaf(const int32_t &leafIndex)
+  {
+    if (root == NULL_NODE)
+    {
+      root = leafIndex;
+      nodes[root].parent = NULL_NODE;
+      return;
+    }
+
+    // Walk down from the root to the best sibling, by the cost of the area pairing with each child would add.
+    const auto leafMinCorner = nodes[leafIndex].minCorner;
+    const auto leafMaxCorner = nodes[leafIndex].maxCorner;
+    auto siblingIndex = root;
+    while (!nodes[siblingIndex].isLeaf())
+    {
+      const auto &sibling = nodes[siblingIndex];
+      const auto area = getSurfaceArea(sibling.minCorner, sibling.maxCorner);
+      const auto combinedArea = getSurfaceArea(glm::min(sibling.minCorner, leafMinCorner), glm::max(sibling.maxCorner, leafMaxCorner));
+      // The cost of pairing the leaf with the node, and the cost every node below pays for the node growing.
+      const auto cost = 2.0f * combinedArea;
+      const auto inheritanceCost = 2.0f * (combinedArea - area);
+
+      const auto getChildCost = [&](const int32_t &childIndex) {
+        const auto &child = nodes[childIndex];
+        const auto childCombinedArea = getSurfaceArea(glm::min(child.minCorner, leafMinCorner), glm::max(child.maxCorner, leafMaxCorner));
+        return child.isLeaf() ? childCombinedArea + inheritanceCost
+                              : childCombinedArea - getSurfaceArea(child.minCorner, child.maxCorner) + inheritanceCost;
+      };
+      const auto cost1 = getChildCost(sibling.child1);
+      const auto cost2 = getChildCost(sibling.child2);
+      if (cost < cost1 && cost < cost2)
+      {
+        break;
+      }
+      siblingIndex = cost1 < cost2 ? sibling.child1 : sibling.child2;
+    }
+
+    // Create a new parent for the sibling and the leaf.
+    const auto oldParentIndex = nodes[siblingIndex].parent;
+    const auto newParentIndex = allocateNode();
+    nodes[newParentIndex].parent = oldParentIndex;
+    nodes[newParentIndex].child1 = siblingIndex;
+    nodes[newParentIndex].child2 = leafIndex;
+    nodes[siblingIndex].parent = newParentIndex;
+    nodes[leafIndex].parent = newParentIndex;
+    if (oldParentIndex != NULL_NODE)
+    {
+      auto &oldParent = nodes[oldParentIndex];
+      (oldParent.child1 == siblingIndex ? oldParent.child1 : oldParent.child2) = newParentIndex;
+    }
+    else
+    {
+      root = newParentIndex;
+    }
+
+    // Walk back up, refitting and balancing the ancestors of the leaf.
+    refitAncestors(newParentIndex);
+  }
+
+  /**
+   * Remove the leaf from the tree, replacing its parent with its sibling.
+   *
+   * @param leafIndex  The index of the leaf.
+   */
+  void removeLeaf(const int32_t &leafIndex)
+  {
+    if (leafIndex == root)
+    {
+      root = NULL_NODE;
+      return;
+    }
+
+    const auto parentIndex = nodes[leafIndex].parent;
+    const auto grandparentIndex = nodes[parentIndex].parent;
+    const auto siblingIndex = nodes[parentIndex].child1 == leafIndex ? nodes[parentIndex].child2 : nodes[parentIndex].child1;
+    freeNode(parentIndex);
+    if (grandparentIndex == NULL_NODE)
+    {
+      root = siblingIndex;
+      nodes[siblingIndex].parent = NULL_NODE;
+      return;
+    }
+
+    auto &grandparent = nodes[grandparentIndex];
+    (grandparent.child1 == parentIndex ? grandparent.child1 : grandparent.child2) = siblingIndex;
+    nodes[siblingIndex].parent = grandparentIndex;
+    refitAncestors(grandparentIndex);
+  }
+
+  /**
+   * Refit and balance the node and every node above it.
+   *
+   * @param nodeIndex  The index of the lowest node to refit.
+   */
+  void refitAncestors(int32_t nodeIndex)
+  {
+    while (nodeIndex != NULL_NODE)
+    {
+      nodeIndex = balance(nodeIndex);
+      refitNode(nodeIndex);
+      nodeIndex = nodes[nodeIndex].parent;
+    }
+  }
+
+  /**
+   * Walk the tree from the root, only going into the nodes accepted by the given test, and run the given function on the
+   *   entries of the accepted leaves.
+   *
+   * @param nodeTest  The function testing whether the entries under a node might be wanted.
+   * @param function  The function to run on the index of each accepted leaf.
+   */
+  template <typename T, typename F>
+  void forEachLeaf(const T &nodeTest, const F &function) const
+  {
+    if (root == NULL_NODE)
+    {
+      return;
+    }
+    std::vector<int32_t> stack({root});
+    while (!stack.empty())
+    {
+      const auto nodeIndex = stack.back();
+      stack.pop_back();
+      const auto &node = nodes[nodeIndex];
+      if (!nodeTest(node))
+      {
+        continue;
+      }
+      if (node.isLeaf())
+      {
+        function(nodeIndex);
+      }
+      else
+      {
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+      }
+    }
+  }
+
+public:
+  /**
+   * Create a dynamic AABB tree.
+   *
+   * @param fatMargin  The margin the boxes of the entries are fattened by, which should be around how far they move in
+   *                     a few frames.
+   */
+  DynamicAabbTree(const float_t &fatMargin)
+      : fatMargin(fatMargin),
+        nodes({}),
+        freeNodes({}),
+        root(NULL_NODE),
+        entryLeaves({}) {}
+
+  /**
+   * Insert the entry with the given box, or move it to the box if it was already inserted. The entry is only
+   *   re-inserted if the box went outside its fattened box.
+   *
+   * @param entryId  The handle of the entry.
+   * @param box      The bounding box of the entry.
+   * @param layers   The mask of the collision layers of the entry.
+   */
+  void update(const SlotHandle &entryId, const AxisAlignedBoundingBox &box, const uint32_t &layers) override
+  {
+    const auto entryLeaf = entryLeaves.find(entryId);
+    int32_t leafIndex;
+    if (entryLeaf != entryLeaves.end())
+    {
+      leafIndex = entryLeaf->second;
+      // Moving inside the fattened box doesn't change anything, which is the case for most moves.
+      const auto &leaf = nodes[leafIndex];
+      if (leaf.layers == layers && glm::all(glm::lessThanEqual(leaf.minCorner, box.getMinCorner())) && glm::all(glm::lessThanEqual(box.getMaxCorner(), leaf.maxCorner)))
+      {
+        return;
+      }
+      removeLeaf(leafIndex);
+    }
+    else
+    {
+      leafIndex = allocateNode();
+      nodes[leafIndex].entryId = entryId;
+      entryLeaves.emplace(entryId, leafIndex);
+    }
+
+    nodes[leafIndex].minCorner = box.getMinCorner() - glm::vec3(fatMargin);
+    nodes[leafIndex].maxCorner = box.getMaxCorner() + glm::vec3(fatMargin);
+    nodes[leafIndex].layers = layers;
+    insertLeaf(leafIndex);
+  }
+
+  /**
+   * Remove the entry, if it was inserted.
+   *
+   * @param entryId  The handle of the entry.
+   */
+  void remove(const SlotHandle &entryId) override
+  {
+    const auto entryLeaf = entryLeaves.find(entryId);
+    if (entryLeaf == entryLeaves.end())
+    {
+      return;
+    }
+    removeLeaf(entryLeaf->second);
+    freeNode(entryLeaf->second);
+    entryLeaves.erase(entryLeaf);
+  }
+
+  /**
+   * Remove all the entries.
+   */
+  void clear() override
+  {
+    nodes.clear();
+    freeNodes.clear();
+    root = NULL_NODE;
+    entryLeaves.clear();
+  }
+
+  /**
+   * Get the handles of the entries on any of the given layers whose fattened boxes overlap the given box.
+   *
+   * @param box        The box to query.
+   * @param layerMask  The mask of the collision layers of the entries to find.
+   * @param entryIds   The list to store the handles of the entries to, each only once and ordered by handle.
+   */
+  void query(const AxisAlignedBoundingBox &box, const uint32_t &layerMask, std::vector<SlotHandle> &entryIds) const override
+  {
+    entryIds.clear();
+    forEachLeaf([&](const TreeNode &node) { return (node.layers & layerMask) != 0 && haveBoxesOverlapped(node.minCorner, node.maxCorner, box.getMinCorner(), box.getMaxCorner()); },
+                [&](const int32_t &leafIndex) { entryIds.push_back(nodes[leafIndex].entryId); });
+    std::sort(entryIds.begin(), entryIds.end());
+  }
+
+  /**
+   * Get every pair of entries whose fattened boxes overlap.
+   *
+   * @param entryIdPairs  The list to store the pairs of handles to, each pair only once with the smaller handle first,
+   *                        ordered by the handles.
+   */
+  void queryPairs(std::vector<std::pair<SlotHandle, SlotHandle>> &entryIdPairs) const
+  {
+    entryIdPairs.clear();
+    for (const auto &entryLeaf : entryLeaves)
+    {
+      const auto &leaf = nodes[entryLeaf.second];
+      forEachLeaf([&](const TreeNode &node) { return haveBoxesOverlapped(node.minCorner, node.maxCorner, leaf.minCorner, leaf.maxCorner); },
+                  [&](const int32_t &leafIndex) {
+                    // Each pair is found from both of its entries, so only keep it from the one with the smaller handle.
+                    if (entryLeaf.first < nodes[leafIndex].entryId)
+                    {
+                      entryIdPairs.push_back({entryLeaf.first, nodes[leafIndex].entryId});
+                    }
+                  });
+    }
+    std::sort(entryIdPairs.begin(), entryIdPairs.end());
+  }
+
+  /**
+   * Get the handles of the entries whose fattened boxes are hit by the given ray, along with the distance the ray enters them.
+   *
+   * @param origin       The origin of the ray.
+   * @param direction    The normalized direction of the ray.
+   * @param maxDistance  The furthest distance along the ray to look for entries at.
+   * @param entryHits    The list to store the distances and handles of the hit entries to, ordered from the nearest,
+   *                       and by handle for the ones entered at the same distance.
+   */
+  void queryRay(const glm::vec3 &origin, const glm::vec3 &direction, const float_t &maxDistance, std::vector<std::pair<float_t, SlotHandle>> &entryHits) const
+  {
+    entryHits.clear();
+    const Ray ray(origin, direction);
+    const auto getEntryDistance = [&](const TreeNode &node) {
+      float_t distance;
+      return ray.raycastSlabs(node.minCorner, node.maxCorner, maxDistance, distance) ? distance : -1.0f;
+    };
+    forEachLeaf([&](const TreeNode &node) { return getEntryDistance(node) >= 0.0f; },
+                [&](const int32_t &leafIndex) { entryHits.push_back({getEntryDistance(nodes[leafIndex]), nodes[leafIndex].entryId}); });
+    std::sort(entryHits.begin(), entryHits.end());
+  }
+
+  /**
+   * Get the handles of the entries whose fattened boxes might be inside the given frustum.
+   *
+   * @param frustum   The frustum to query.
+   * @param entryIds  The list to store the handles of the entries to, ordered by handle.
+   */
+  void queryFrustum(const Frustum &frustum, std::vector<SlotHandle> &entryIds) const
+  {
+    entryIds.clear();
+    forEachLeaf([&](const TreeNode &node) { return frustum.intersectsBox(node.minCorner, node.maxCorner); },
+                [&](const int32_t &leafIndex) { entryIds.push_back(nodes[leafIndex].entryId); });
+    std::sort(entryIds.begin(), entryIds.end());
+  }
+
+  /**
+   * Get the height of the tree, which stays around the logarithm of the number of entries while it's balanced.
+   *
+   * @return The height of the tree, or -1 if it's empty.
+   */
+  int32_t getHeight() const
+  {
+    return root == NULL_NODE ? -1 : nodes[root].height;
+  }
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef INCLUDE_ALLOCATION_COUNTER_CPP
+#define INCLUDE_ALLOCATION_COUNTER_CPP
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+
+/**
+ * Class counting the heap allocations made through new, both across all the threads and by each thread, so frames and
+ *   profiling zones can tell how many allocations they made. The global operators new and delete are replaced to count
+ *   into it, which only works because the whole program is built as a single translation unit including this once.
+ */
+class AllocationCounter
+{
+private:
+  // The number of allocations made by every thread.
+  static std::atomic<uint64_t> allocationsCount;
+  // The number of allocations made by the current thread, which needs no synchronization.
+  static thread_local uint64_t threadAllocationsCount;
+
+public:
+  // Prevent creating the allocation counter, since it only has static members.
+  AllocationCounter() = delete;
+
+  /**
+   * Allocate memory from the C heap and count the allocation, without throwing if it fails.
+   *
+   * @param size  The number of bytes to allocate.
+   *
+   * @return The allocated memory, or null if it couldn't be allocated.
+   */
+  static void *allocate(const size_t &size) noexcept
+  {
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+    threadAllocationsCount++;
+    // Allocating no bytes still has to return a unique pointer.
+    return std::malloc(size == 0 ? 1 : size);
+  }
+
+  /**
+   * Allocate memory from the C heap and count the allocation, throwing if it fails like new does.
+   *
+   * @param size  The number of bytes to allocate.
+   *
+   * @return The allocated memory.
+   */
+  static void *allocateOrThrow(const size_t &size)
+  {
+    const auto pointer = allocate(size);
+    if (pointer == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    return pointer;
+  }
+
+  /**
+   * Get the number of allocations made by every thread so far.
+   *
+   * @return The number of allocations.
+   */
+  static uint64_t getAllocationsCount()
+  {
+    return allocationsCount.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the number of allocations made by the current thread so far.
+   *
+   * @return The number of allocations.
+   */
+  static uint64_t getThreadAllocationsCount()
+  {
+    return threadAllocationsCount;
+  }
+};
+
+// Initialize the allocation counts static variables.
+std::atomic<uint64_t> AllocationCounter::allocationsCount(0);
+thread_local uint64_t AllocationCounter::threadAllocationsCount = 0;
+
+// Replace the global operators new and delete with ones counting the allocations. The aligned versions are left as they
+//   are, since nothing asks for over-aligned allocations.
+void *operator new(size_t size)
+{
+  return AllocationCounter::allocateOrThrow(size);
+}
+
+void *operator new[](size_t size)
+{
+  return AllocationCounter::allocateOrThrow(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  return AllocationCounter::allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+  return AllocationCounter::allocate(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+  std::free(pointer);
+}
+
+#endif
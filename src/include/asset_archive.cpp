@@ -0,0 +1,547 @@
+#ifndef INCLUDE_ASSET_ARCHIVE_CPP
+#define INCLUDE_ASSET_ARCHIVE_CPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "mapped_file.cpp"
+#include "lz4_block.cpp"
+#include "parallel.cpp"
+#include "log.cpp"
+
+/**
+ * The compressions the entries of an asset archive can be stored with. LZ4 entries are split into chunks compressed on
+ *   their own, stored as the compressed size of each chunk followed by the chunks one after the other, so the chunks can
+ *   be decompressed in parallel.
+ */
+enum class AssetCompression : uint32_t
+{
+  NONE,
+  LZ4
+};
+
+/**
+ * Structure of the header at the start of an asset archive, followed by its table of contents, then the names of its
+ *   entries, and then the data of the entries, each starting at a multiple of the entry alignment.
+ */
+struct AssetArchiveHeader
+{
+  char magic[4];
+  uint32_t version;
+  // The number of entries in the table of contents.
+  uint32_t entriesCount;
+  // The size of the names of the entries, in bytes.
+  uint32_t namesSize;
+  // The size of the chunks the compressed entries are split into once decompressed, in bytes.
+  uint32_t chunkSize;
+  uint32_t reserved;
+};
+
+/**
+ * Structure of an entry of the table of contents of an asset archive. The entries are sorted by their names, so an entry
+ *   is found with a binary search.
+ */
+struct AssetArchiveEntry
+{
+  // The offset of the data of the entry in the archive.
+  uint64_t offset;
+  // The size of the data of the entry once decompressed.
+  uint64_t size;
+  // The size of the data of the entry as stored in the archive.
+  uint64_t storedSize;
+  // The offset and length of the name of the entry in the names, which is the path the asset is loaded from.
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  // The compression the data of the entry is stored with.
+  AssetCompression compression;
+  uint32_t reserved;
+};
+
+// Make sure the binary layout of the structures match the asset archive format.
+static_assert(sizeof(AssetArchiveHeader) == 24, "AssetArchiveHeader must be tightly packed");
+static_assert(sizeof(AssetArchiveEntry) == 40, "AssetArchiveEntry must be tightly packed");
+
+/**
+ * Class for the contents of an asset opened through the asset file system, which they stay valid for as long as the
+ *   asset file is. Uncompressed archive entries and loose files point straight into their mapped files, and compressed
+ *   archive entries into the memory they were decompressed into.
+ */
+class AssetFile
+{
+private:
+  friend class AssetFileSystem;
+
+  // The contents of the asset, and their size.
+  const unsigned char *data;
+  size_t size;
+  // The decompressed contents of a compressed archive entry.
+  std::vector<unsigned char> decompressedData;
+  // The mapped loose file of an asset that isn't in the archive.
+  MappedFile looseFile;
+
+public:
+  AssetFile()
+      : data(nullptr),
+        size(0),
+        decompressedData({}),
+        looseFile() {}
+
+  // Preventing copying the asset file, since its contents can be owned by it.
+  AssetFile(const AssetFile &) = delete;
+
+  /**
+   * Copy the next part of the contents of the asset, like reading from a file.
+   *
+   * @param position     The position in the contents to copy from, which is moved past the copied part.
+   * @param destination  The memory to copy to.
+   * @param count        The number of bytes to copy.
+   *
+   * @return Whether the contents had enough bytes left to copy.
+   */
+  bool read(size_t &position, void *const destination, const size_t &count) const
+  {
+    if (position > size || count > size - position)
+    {
+      return false;
+    }
+    memcpy(destination, data + position, count);
+    position += count;
+    return true;
+  }
+
+  /**
+   * Get the contents of the asset.
+   *
+   * @return The asset data.
+   */
+  const unsigned char *getData() const
+  {
+    return data;
+  }
+
+  /**
+   * Get the size of the contents of the asset.
+   *
+   * @return The asset size, in bytes.
+   */
+  const size_t &getSize() const
+  {
+    return size;
+  }
+};
+
+/**
+ * Class for the virtual file system the assets are loaded through. Once an asset archive is mounted, the assets packed in
+ *   it are served from it, which is mapped into memory and read in ahead with one sequential read, instead of each asset
+ *   being opened and read on its own. The assets that aren't packed, or all of them when no archive is mounted, are read
+ *   from their loose files. It doesn't depend on OpenGL, so it can also be used by tools.
+ */
+class AssetFileSystem
+{
+private:
+  // The magic and version at the start of asset archives.
+  static constexpr const char *archiveMagic = "GTPK";
+  static const uint32_t archiveVersion = 2;
+  // The alignment the data of the entries start at, so the data can be used in place as it's mapped.
+  static const uint64_t entryAlignment = 64;
+  // The size of the chunks the entries are split into when they're compressed, which are decompressed in parallel.
+  static const uint32_t compressionChunkSize = 256 * 1024;
+
+  // The mounted archive, along with its table of contents, the names of its entries, and the size of the chunks of its
+  //   compressed entries.
+  MappedFile archiveFile;
+  const AssetArchiveEntry *entries;
+  uint32_t entriesCount;
+  const char *names;
+  uint32_t chunkSize;
+
+  AssetFileSystem()
+      : archiveFile(),
+        entries(nullptr),
+        entriesCount(0),
+        names(nullptr),
+        chunkSize(0) {}
+
+  /**
+   * Get the number of chunks an entry of the given size is split into when it's compressed.
+   *
+   * @param size       The size of the entry.
+   * @param chunkSize  The size of the chunks.
+   *
+   * @return The number of chunks.
+   */
+  static uint64_t getChunksCount(const uint64_t &size, const uint32_t &chunkSize)
+  {
+    return (size + chunkSize - 1) / chunkSize;
+  }
+
+  /**
+   * Decompress the chunks of a compressed entry of the mounted archive in parallel on the job system, each straight into
+   *   its part of the destination.
+   *
+   * @param entry        The compressed entry.
+   * @param destination  The memory to decompress the entry into, the size of the entry.
+   *
+   * @return Whether every chunk of the entry was valid and decompressed.
+   */
+  bool decompressEntry(const AssetArchiveEntry &entry, unsigned char *const destination) const
+  {
+    // Find where each chunk is stored from the compressed sizes of the chunks before it.
+    const auto storedData = archiveFile.getData() + entry.offset;
+    const auto chunksCount = getChunksCount(entry.size, chunkSize);
+    if (chunksCount * sizeof(uint32_t) > entry.storedSize)
+    {
+      return false;
+    }
+    std::vector<uint64_t> chunkOffsets(chunksCount + 1, chunksCount * sizeof(uint32_t));
+    for (uint64_t i = 0; i < chunksCount; i++)
+    {
+      uint32_t storedChunkSize;
+      memcpy(&storedChunkSize, storedData + i * sizeof(uint32_t), sizeof(uint32_t));
+      chunkOffsets[i + 1] = chunkOffsets[i] + storedChunkSize;
+    }
+    if (chunkOffsets.back() != entry.storedSize)
+    {
+      return false;
+    }
+
+    // Decompress the chunks, splitting them evenly across the tasks.
+    std::atomic<bool> valid(true);
+    ParallelTasks::runChunked(chunksCount, 1, [&](const uint32_t, const size_t chunksStart, const size_t chunksEnd) {
+      for (auto i = chunksStart; i < chunksEnd && valid.load(std::memory_order_relaxed); i++)
+      {
+        const auto decompressedOffset = i * chunkSize;
+        const auto decompressedSize = std::min<uint64_t>(chunkSize, entry.size - decompressedOffset);
+        if (!Lz4Block::decompress(storedData + chunkOffsets[i], chunkOffsets[i + 1] - chunkOffsets[i], destination + decompressedOffset, decompressedSize))
+        {
+          valid.store(false, std::memory_order_relaxed);
+        }
+      }
+    });
+    return valid.load();
+  }
+
+  /**
+   * Get the name of the given entry of the mounted archive.
+   *
+   * @param entry  The entry of the archive.
+   *
+   * @return The name of the entry.
+   */
+  std::string_view getEntryName(const AssetArchiveEntry &entry) const
+  {
+    return std::string_view(names + entry.nameOffset, entry.nameLength);
+  }
+
+  /**
+   * Find the entry of the mounted archive an asset is packed in.
+   *
+   * @param filePath  The path the asset is loaded from.
+   *
+   * @return The entry of the asset, or null if it isn't packed.
+   */
+  const AssetArchiveEntry *findEntry(const std::string &filePath) const
+  {
+    const auto entriesEnd = entries + entriesCount;
+    const auto foundEntry = std::lower_bound(entries, entriesEnd, std::string_view(filePath), [&](const AssetArchiveEntry &entry, const std::string_view &name) {
+      return getEntryName(entry) < name;
+    });
+    return foundEntry != entriesEnd && getEntryName(*foundEntry) == filePath ? foundEntry : nullptr;
+  }
+
+  /**
+   * Round the offset up to the alignment the entries of archives start at.
+   *
+   * @param offset  The offset to align.
+   *
+   * @return The aligned offset.
+   */
+  static uint64_t alignEntryOffset(const uint64_t &offset)
+  {
+    return (offset + entryAlignment - 1) / entryAlignment * entryAlignment;
+  }
+
+public:
+  // Preventing copying the asset file system, making sure only one instance can exist.
+  AssetFileSystem(const AssetFileSystem &) = delete;
+
+  /**
+   * Mount the asset archive, which the assets packed in it are served from from then on, replacing the archive mounted
+   *   before if there is one. An archive that's missing or isn't valid leaves the assets to be read from their loose files.
+   *
+   * @param archivePath  The path to the asset archive.
+   *
+   * @return Whether the archive was mounted.
+   */
+  bool mountArchive(const std::string &archivePath)
+  {
+    entries = nullptr;
+    entriesCount = 0;
+    names = nullptr;
+    if (!archiveFile.open(archivePath))
+    {
+      return false;
+    }
+
+    // Check the header, and that the table of contents and the names fit in the archive.
+    const auto archiveData = archiveFile.getData();
+    const auto archiveSize = archiveFile.getSize();
+    AssetArchiveHeader header;
+    if (archiveSize >= sizeof(AssetArchiveHeader))
+    {
+      memcpy(&header, archiveData, sizeof(AssetArchiveHeader));
+    }
+    if (archiveSize < sizeof(AssetArchiveHeader) || memcmp(header.magic, archiveMagic, 4) != 0 || header.version != archiveVersion || header.chunkSize == 0 ||
+        sizeof(AssetArchiveHeader) + uint64_t(header.entriesCount) * sizeof(AssetArchiveEntry) + header.namesSize > archiveSize)
+    {
+      Logger::getInstance().error(archivePath, "\nFailed at asset archive 1");
+      archiveFile.close();
+      return false;
+    }
+    const auto archiveEntries = reinterpret_cast<const AssetArchiveEntry *>(archiveData + sizeof(AssetArchiveHeader));
+    const auto archiveNames = reinterpret_cast<const char *>(archiveEntries + header.entriesCount);
+
+    // Check that the names and the data of each of the entries fit in the archive.
+    for (uint32_t i = 0; i < header.entriesCount; i++)
+    {
+      const auto &entry = archiveEntries[i];
+      if (uint64_t(entry.nameOffset) + entry.nameLength > header.namesSize || entry.offset > archiveSize || entry.storedSize > archiveSize - entry.offset ||
+          (entry.compression != AssetCompression::NONE && entry.compression != AssetCompression::LZ4) ||
+          (entry.compression == AssetCompression::NONE && entry.storedSize != entry.size))
+      {
+        Logger::getInstance().error(archivePath, "\nFailed at asset archive 2");
+        archiveFile.close();
+        return false;
+      }
+    }
+
+    entries = archiveEntries;
+    entriesCount = header.entriesCount;
+    names = archiveNames;
+    chunkSize = header.chunkSize;
+    // Read the whole archive in ahead, in one go, instead of seeking to each asset as it's loaded.
+    archiveFile.prefetch();
+    return true;
+  }
+
+  /**
+   * Check if an archive is mounted.
+   *
+   * @return Whether an archive is mounted.
+   */
+  bool isArchiveMounted() const
+  {
+    return archiveFile.getData() != nullptr;
+  }
+
+  /**
+   * Open an asset, from the mounted archive if it's packed in it, or from its loose file otherwise.
+   *
+   * @param filePath  The path the asset is loaded from.
+   * @param file      The asset file to open the asset in.
+   *
+   * @return Whether the asset was found and opened.
+   */
+  bool open(const std::string &filePath, AssetFile &file) const
+  {
+    file.data = nullptr;
+    file.size = 0;
+    file.decompressedData.clear();
+    file.looseFile.close();
+
+    const auto entry = findEntry(filePath);
+    if (entry != nullptr)
+    {
+      const auto storedData = archiveFile.getData() + entry->offset;
+      if (entry->compression == AssetCompression::NONE)
+      {
+        // Use the data of the entry where it's mapped.
+        file.data = storedData;
+        file.size = entry->size;
+        return true;
+      }
+      file.decompressedData.resize(entry->size);
+      if (!decompressEntry(*entry, file.decompressedData.data()))
+      {
+        Logger::getInstance().error(filePath, "\nFailed at asset archive 3");
+        file.decompressedData.clear();
+        return false;
+      }
+      file.data = file.decompressedData.data();
+      file.size = file.decompressedData.size();
+      return true;
+    }
+
+    // Map the loose file, where empty files can't be mapped but still open with no contents.
+    if (file.looseFile.open(filePath))
+    {
+      file.data = file.looseFile.getData();
+      file.size = file.looseFile.getSize();
+      return true;
+    }
+    std::error_code errorCode;
+    return std::filesystem::is_regular_file(filePath, errorCode) && std::filesystem::file_size(filePath, errorCode) == 0 && !errorCode;
+  }
+
+  /**
+   * Get the size of an asset, from the mounted archive if it's packed in it, or from its loose file otherwise.
+   *
+   * @param filePath  The path the asset is loaded from.
+   *
+   * @return The size of the asset, or -1 if it couldn't be found.
+   */
+  int64_t getFileSize(const std::string &filePath) const
+  {
+    const auto entry = findEntry(filePath);
+    if (entry != nullptr)
+    {
+      return static_cast<int64_t>(entry->size);
+    }
+    std::error_code errorCode;
+    const auto fileSize = std::filesystem::file_size(filePath, errorCode);
+    return errorCode ? -1 : static_cast<int64_t>(fileSize);
+  }
+
+  /**
+   * Compress the data as chunks of the compression chunk size, each compressed on its own in parallel on the job system,
+   *   laid out the way compressed entries are stored.
+   *
+   * @param data  The data to compress.
+   *
+   * @return The compressed sizes of the chunks, followed by the compressed chunks.
+   */
+  static std::vector<unsigned char> compressChunks(const std::vector<unsigned char> &data)
+  {
+    const auto chunksCount = getChunksCount(data.size(), compressionChunkSize);
+    std::vector<std::vector<unsigned char>> compressedChunks(chunksCount);
+    ParallelTasks::runChunked(chunksCount, 1, [&](const uint32_t, const size_t chunksStart, const size_t chunksEnd) {
+      for (auto i = chunksStart; i < chunksEnd; i++)
+      {
+        const auto chunkOffset = i * compressionChunkSize;
+        compressedChunks[i] = Lz4Block::compress(data.data() + chunkOffset, std::min<size_t>(compressionChunkSize, data.size() - chunkOffset));
+      }
+    });
+
+    std::vector<unsigned char> compressedData(chunksCount * sizeof(uint32_t));
+    for (size_t i = 0; i < chunksCount; i++)
+    {
+      const auto storedChunkSize = static_cast<uint32_t>(compressedChunks[i].size());
+      memcpy(compressedData.data() + i * sizeof(uint32_t), &storedChunkSize, sizeof(uint32_t));
+      compressedData.insert(compressedData.end(), compressedChunks[i].begin(), compressedChunks[i].end());
+    }
+    return compressedData;
+  }
+
+  /**
+   * Pack the given files into an asset archive. Each file is compressed with LZ4 when asked for and when that saves at
+   *   least an eighth of its size, since the files that don't compress well are better used in place.
+   *
+   * @param archivePath  The path to write the archive to.
+   * @param files        The files to pack, as the paths they're loaded from, along with the paths to read them from.
+   * @param compress     Whether to compress the files that compress well.
+   *
+   * @return Whether every file was read and the archive was written.
+   */
+  static bool writeArchive(const std::string &archivePath, std::vector<std::pair<std::string, std::string>> files, const bool &compress)
+  {
+    // Sort the files by the paths they're loaded from, so their entries can be found with a binary search.
+    std::sort(files.begin(), files.end());
+
+    // Lay out the names, then read and compress the files, placing their data after the table of contents and the names.
+    std::string entryNames;
+    for (const auto &file : files)
+    {
+      entryNames += file.first;
+    }
+    std::vector<AssetArchiveEntry> archiveEntries;
+    std::vector<std::vector<unsigned char>> storedData;
+    auto dataOffset = alignEntryOffset(sizeof(AssetArchiveHeader) + files.size() * sizeof(AssetArchiveEntry) + entryNames.size());
+    uint32_t nameOffset = 0;
+    for (const auto &file : files)
+    {
+      std::ifstream sourceFile(file.second, std::ios::in | std::ios::binary);
+      if (!sourceFile.is_open())
+      {
+        Logger::getInstance().error("Could not read ", file.second);
+        return false;
+      }
+      std::vector<unsigned char> data((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+
+      AssetArchiveEntry entry = {dataOffset, data.size(), data.size(), nameOffset, static_cast<uint32_t>(file.first.size()), AssetCompression::NONE, 0};
+      if (compress && !data.empty())
+      {
+        auto compressedData = compressChunks(data);
+        if (compressedData.size() <= data.size() - data.size() / 8)
+        {
+          entry.storedSize = compressedData.size();
+          entry.compression = AssetCompression::LZ4;
+          data = std::move(compressedData);
+        }
+      }
+      archiveEntries.push_back(entry);
+      storedData.push_back(std::move(data));
+      dataOffset = alignEntryOffset(dataOffset + entry.storedSize);
+      nameOffset += entry.nameLength;
+    }
+
+    // Write the archive to a temporary file, moving it in place once it's complete, so a half written archive is never
+    //   mounted.
+    const auto temporaryFilePath = archivePath + ".tmp";
+    {
+      std::ofstream archiveFile(temporaryFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!archiveFile.is_open())
+      {
+        Logger::getInstance().error("Could not write ", archivePath);
+        return false;
+      }
+      AssetArchiveHeader header;
+      memcpy(header.magic, archiveMagic, 4);
+      header.version = archiveVersion;
+      header.entriesCount = static_cast<uint32_t>(archiveEntries.size());
+      header.namesSize = static_cast<uint32_t>(entryNames.size());
+      header.chunkSize = compressionChunkSize;
+      header.reserved = 0;
+      archiveFile.write(reinterpret_cast<const char *>(&header), sizeof(AssetArchiveHeader));
+      archiveFile.write(reinterpret_cast<const char *>(archiveEntries.data()), archiveEntries.size() * sizeof(AssetArchiveEntry));
+      archiveFile.write(entryNames.data(), entryNames.size());
+      for (size_t i = 0; i < archiveEntries.size(); i++)
+      {
+        // Pad up to where the data of the entry starts.
+        const std::vector<char> padding(archiveEntries[i].offset - static_cast<uint64_t>(archiveFile.tellp()), 0);
+        archiveFile.write(padding.data(), padding.size());
+        archiveFile.write(reinterpret_cast<const char *>(storedData[i].data()), storedData[i].size());
+      }
+      if (!archiveFile.good())
+      {
+        Logger::getInstance().error("Could not write ", archivePath);
+        return false;
+      }
+    }
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryFilePath, archivePath, errorCode);
+    return !errorCode;
+  }
+
+  /**
+   * Returns the singleton instance of the asset file system.
+   *
+   * @return The asset file system singleton instance.
+   */
+  static AssetFileSystem &getInstance()
+  {
+    // Singleton instance of the asset file system, constructed the first time it's asked for.
+    static AssetFileSystem instance;
+    return instance;
+  }
+};
+
+#endif
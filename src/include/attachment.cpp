@@ -0,0 +1,253 @@
+#ifndef INCLUDE_ATTACHMENT_CPP
+#define INCLUDE_ATTACHMENT_CPP
+
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "slot_map.cpp"
+#include "../models/model_base_intf.cpp"
+#include "../light/light_base.cpp"
+#include "../camera/camera_base.cpp"
+
+/**
+ * A manager class for attaching lights, cameras and models to the models they move with, at an offset from them. The
+ *   attached children are all placed in one pass after the models update, and only the ones whose parent moved since
+ *   they were last placed are moved, so the children of the models standing still cost nothing.
+ */
+class AttachmentManager
+{
+private:
+  /**
+   * Structure for defining a child attached to a model.
+   */
+  struct Attachment
+  {
+    // The handle of the attachment, so the attachments of the children or parents no longer around can be dropped.
+    SlotHandle attachmentHandle;
+    // The model the child is attached to, which the attachment doesn't keep alive.
+    std::weak_ptr<const ModelBaseIntf> parent;
+    // The offset of the child from the position of the parent.
+    glm::vec3 localOffset;
+    // Whether the offset turns with the parent, or stays along the axes of the world.
+    bool followsRotation;
+    // The function moving the child to the given position, which returns whether the child is still around.
+    std::function<bool(const glm::vec3 &)> placeChild;
+    // The change generation of the parent when the child was last placed.
+    uint64_t parentChangeGeneration;
+  };
+
+  // The attachments of the children, in the order they were attached.
+  SlotMap<Attachment> attachments;
+  // The list the handles of the attachments to drop are stored to, reused between passes.
+  std::vector<SlotHandle> droppedAttachmentHandles;
+
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local AttachmentManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the attachment manager, which is the one of the default world.
+   *
+   * @return The attachment manager singleton instance.
+   */
+  static AttachmentManager &getSingleton()
+  {
+    // Singleton instance of the attachment manager, constructed the first time it's asked for.
+    static AttachmentManager instance;
+    return instance;
+  }
+
+  AttachmentManager()
+      : attachments(),
+        droppedAttachmentHandles({}) {}
+
+  /**
+   * Get where the child of the attachment goes, from where its parent is now.
+   *
+   * @param parent           The parent of the attachment.
+   * @param localOffset      The offset of the child from the parent.
+   * @param followsRotation  Whether the offset turns with the parent.
+   *
+   * @return The position of the child.
+   */
+  static glm::vec3 getChildPosition(const ModelBaseIntf &parent, const glm::vec3 &localOffset, const bool &followsRotation)
+  {
+    return parent.getModelPosition() + (followsRotation ? parent.getModelOrientation() * localOffset : localOffset);
+  }
+
+  /**
+   * Attach a child to the model, placing it at the offset from the model right away.
+   *
+   * @param parent           The model to attach the child to.
+   * @param localOffset      The offset of the child from the model.
+   * @param followsRotation  Whether the offset turns with the model.
+   * @param placeChild       The function moving the child to the given position.
+   *
+   * @return The handle of the attachment.
+   */
+  SlotHandle attach(const std::shared_ptr<const ModelBaseIntf> &parent, const glm::vec3 &localOffset, const bool &followsRotation,
+                    const std::function<bool(const glm::vec3 &)> &placeChild)
+  {
+    placeChild(getChildPosition(*parent, localOffset, followsRotation));
+    const auto attachmentHandle = attachments.insert({{0, 0}, parent, localOffset, followsRotation, placeChild, parent->getChangeGeneration()});
+    attachments.find(attachmentHandle)->attachmentHandle = attachmentHandle;
+    return attachmentHandle;
+  }
+
+public:
+  // Preventing copying the attachment manager, making sure only one instance can exist.
+  AttachmentManager(const AttachmentManager &) = delete;
+
+  /**
+   * Attach a light to the model, so it moves with the model at the given offset from it.
+   *
+   * @param light            The light to attach.
+   * @param parent           The model to attach the light to.
+   * @param localOffset      The offset of the light from the model.
+   * @param followsRotation  Whether the offset turns with the model.
+   *
+   * @return The handle of the attachment.
+   */
+  SlotHandle attachLight(const std::shared_ptr<LightBase> &light, const std::shared_ptr<const ModelBaseIntf> &parent, const glm::vec3 &localOffset,
+                         const bool &followsRotation = false)
+  {
+    const std::weak_ptr<LightBase> child(light);
+    return attach(parent, localOffset, followsRotation, [child](const glm::vec3 &position) {
+      const auto light = child.lock();
+      if (light != nullptr)
+      {
+        light->setLightPosition(position);
+      }
+      return light != nullptr;
+    });
+  }
+
+  /**
+   * Attach a camera to the model, so it moves with the model at the given offset from it.
+   *
+   * @param camera           The camera to attach.
+   * @param parent           The model to attach the camera to.
+   * @param localOffset      The offset of the camera from the model.
+   * @param followsRotation  Whether the offset turns with the model.
+   *
+   * @return The handle of the attachment.
+   */
+  SlotHandle attachCamera(const std::shared_ptr<CameraBase> &camera, const std::shared_ptr<const ModelBaseIntf> &parent, const glm::vec3 &localOffset,
+                          const bool &followsRotation = false)
+  {
+    const std::weak_ptr<CameraBase> child(camera);
+    return attach(parent, localOffset, followsRotation, [child](const glm::vec3 &position) {
+      const auto camera = child.lock();
+      if (camera != nullptr)
+      {
+        camera->setCameraPosition(position);
+      }
+      return camera != nullptr;
+    });
+  }
+
+  /**
+   * Attach a model to another model, so it moves with it at the given offset from it. The models attached to a model
+   *   that is attached itself follow it in the same pass if they were attached after it.
+   *
+   * @param model            The model to attach.
+   * @param parent           The model to attach the model to.
+   * @param localOffset      The offset of the model from the other model.
+   * @param followsRotation  Whether the offset turns with the other model.
+   *
+   * @return The handle of the attachment.
+   */
+  SlotHandle attachModel(const std::shared_ptr<ModelBaseIntf> &model, const std::shared_ptr<const ModelBaseIntf> &parent, const glm::vec3 &localOffset,
+                         const bool &followsRotation = false)
+  {
+    const std::weak_ptr<ModelBaseIntf> child(model);
+    return attach(parent, localOffset, followsRotation, [child](const glm::vec3 &position) {
+      const auto model = child.lock();
+      if (model != nullptr)
+      {
+        model->setModelPosition(position);
+      }
+      return model != nullptr;
+    });
+  }
+
+  /**
+   * Detach a child from the model it is attached to, leaving it where it is.
+   *
+   * @param attachmentHandle  The handle of the attachment.
+   */
+  void detach(const SlotHandle &attachmentHandle)
+  {
+    attachments.remove(attachmentHandle);
+  }
+
+  /**
+   * Detach all the children.
+   */
+  void detachAll()
+  {
+    attachments.clear();
+  }
+
+  /**
+   * Move the attached children whose parents moved since they were last placed to where their parents are now. The
+   *   attachments whose parent or child is no longer around are dropped. Must be called while nothing updates in
+   *   parallel, once the models updated.
+   */
+  void updateAttachments()
+  {
+    droppedAttachmentHandles.clear();
+    // Go over the attachments in order, finding each by its handle to change it in place.
+    for (size_t i = 0; i < attachments.size(); i++)
+    {
+      auto &attachment = *attachments.find(attachments.getValues()[i].attachmentHandle);
+      const auto parent = attachment.parent.lock();
+      if (parent == nullptr)
+      {
+        droppedAttachmentHandles.push_back(attachment.attachmentHandle);
+        continue;
+      }
+      if (parent->getChangeGeneration() == attachment.parentChangeGeneration)
+      {
+        continue;
+      }
+      attachment.parentChangeGeneration = parent->getChangeGeneration();
+      if (!attachment.placeChild(getChildPosition(*parent, attachment.localOffset, attachment.followsRotation)))
+      {
+        droppedAttachmentHandles.push_back(attachment.attachmentHandle);
+      }
+    }
+    for (const auto &attachmentHandle : droppedAttachmentHandles)
+    {
+      attachments.remove(attachmentHandle);
+    }
+  }
+
+  /**
+   * Get the number of attached children.
+   *
+   * @return The number of attachments.
+   */
+  size_t getAttachmentsCount() const
+  {
+    return attachments.size();
+  }
+
+  /**
+   * Returns the instance of the attachment manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
+   * 
+   * @return The attachment manager instance.
+   */
+  static AttachmentManager &getInstance()
+  {
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
+  }
+};
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef INCLUDE_BENCHMARK_CPP
+#define INCLUDE_BENCHMARK_CPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "memory.cpp"
+#include "render_stats.cpp"
+#include "input_recording.cpp"
+#include "startup.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for defining the keys held down from a frame of a benchmark onwards, until the next step of its input track.
+ */
+struct BenchmarkInputStep
+{
+  // The frame the step starts at.
+  uint32_t startFrame;
+  // The keys held down during the step.
+  std::set<int32_t> keys;
+};
+
+/**
+ * Structure for defining a benchmark scenario, which plays the game with a fixed random seed, a fixed time step and a
+ * scripted input track, so every run of it simulates the same frames. A scenario replaying a recorded play session takes
+ * the time and the input of each frame from the recording instead.
+ */
+struct BenchmarkScenario
+{
+  // The name of the scenario, which is also used to name the results file.
+  std::string name;
+  // The number of frames run before any are measured, so shader variants and shadow maps are ready.
+  uint32_t warmupFramesCount;
+  // The number of frames measured.
+  uint32_t framesCount;
+  // The seed of the random number generators of the scene.
+  uint32_t seed;
+  // The number of enemies along the width, height and depth of the grid of enemies.
+  glm::uvec3 enemyGridSize;
+  // The shortest time between two shots of the player, in seconds.
+  float_t shotInterval;
+  // Whether the shots have lights.
+  bool shotLightsEnabled;
+  // Whether the box-box collision tests use the separating axis test, instead of the corner containment test.
+  bool separatingAxisBoxTestEnabled;
+  // The steps of the input track, in order of their start frames.
+  std::vector<BenchmarkInputStep> inputTrack;
+  // The recorded play session the scenario replays, if it's not scripted.
+  std::shared_ptr<const InputRecording> inputRecording = nullptr;
+
+  /**
+   * Get the keys held down at the given frame of the input track.
+   *
+   * @param frame  The frame, counting the warmup frames.
+   *
+   * @return The keys held down.
+   */
+  const std::set<int32_t> &getKeysAtFrame(const uint32_t &frame) const
+  {
+    static const std::set<int32_t> noKeys({});
+    const std::set<int32_t> *keys = &noKeys;
+    for (const auto &inputStep : inputTrack)
+    {
+      if (inputStep.startFrame > frame)
+      {
+        break;
+      }
+      keys = &inputStep.keys;
+    }
+    return *keys;
+  }
+
+  /**
+   * Create the scenario replaying a recorded play session, with the settings the session started with. The first frames
+   *   of the session are the warmup frames, as long as there are enough frames left to measure.
+   *
+   * @param name       The name of the scenario.
+   * @param recording  The recorded play session.
+   *
+   * @return The scenario.
+   */
+  static BenchmarkScenario fromRecording(const std::string &name, const std::shared_ptr<const InputRecording> &recording)
+  {
+    const auto framesCount = static_cast<uint32_t>(recording->frames.size());
+    const auto warmupFramesCount = framesCount > 120 ? 60u : 0u;
+    return {name, warmupFramesCount, framesCount - warmupFramesCount, recording->seed, recording->enemyGridSize, recording->shotInterval,
+            recording->shotLightsEnabled, recording->separatingAxisBoxTestEnabled, {}, recording};
+  }
+
+  /**
+   * Get the benchmark scenario with the given name.
+   *
+   * @param name      The name of the scenario.
+   * @param scenario  The scenario to store the found scenario to.
+   *
+   * @return Whether a scenario with the name exists.
+   */
+  static bool find(const std::string &name, BenchmarkScenario &scenario)
+  {
+    static const std::vector<BenchmarkScenario> scenarios({
+        // The scene without any input, measuring the cost of the scene itself.
+        {"idle", 60, 1200, 1, glm::uvec3(5, 3, 3), 0.17f, true, true, {}},
+        // The player sweeps across the enemies while firing, with the shots hitting them and being removed.
+        {"sweep", 60, 1800, 1, glm::uvec3(5, 3, 3), 0.17f, true, true, {{0, {GLFW_KEY_SPACE, GLFW_KEY_A}}, {180, {GLFW_KEY_SPACE, GLFW_KEY_D}}, {540, {GLFW_KEY_SPACE, GLFW_KEY_A, GLFW_KEY_W}}, {900, {GLFW_KEY_SPACE, GLFW_KEY_D, GLFW_KEY_S}}, {1260, {GLFW_KEY_SPACE}}}},
+        // The load test, with a much bigger grid of enemies and the player firing lit shots far more often while sweeping
+        // across them, as the enemies are cleared out.
+        {"stress", 60, 3600, 1, glm::uvec3(10, 6, 6), 0.05f, true, true, {{0, {GLFW_KEY_SPACE, GLFW_KEY_A}}, {180, {GLFW_KEY_SPACE, GLFW_KEY_D}}, {540, {GLFW_KEY_SPACE, GLFW_KEY_A, GLFW_KEY_W}}, {900, {GLFW_KEY_SPACE, GLFW_KEY_D, GLFW_KEY_S}}, {1260, {GLFW_KEY_SPACE, GLFW_KEY_A}}, {1440, {GLFW_KEY_SPACE, GLFW_KEY_D}}, {1800, {GLFW_KEY_SPACE}}}},
+    });
+    for (const auto &candidate : scenarios)
+    {
+      if (candidate.name == name)
+      {
+        scenario = candidate;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/**
+ * Structure for defining what was measured in a frame of a benchmark.
+ */
+struct BenchmarkFrame
+{
+  // The time the whole frame took on the CPU, in milliseconds.
+  double_t frameTime;
+  // The time the CPU took to submit the rendering of the scene, in milliseconds.
+  double_t cpuRenderTime;
+  // The time the GPU took to render the scene, in milliseconds, as of the latest available timer results.
+  double_t gpuRenderTime;
+  // The work each pass submitted to render the scene.
+  std::array<RenderStats, RENDER_PASSES_COUNT> renderStats;
+  // The number of models in the scene.
+  uint32_t modelsCount;
+  // The number of narrowphase collision tests made.
+  uint32_t collisionChecksCount;
+  // The number of heap allocations made during the frame.
+  uint64_t allocationsCount;
+  // The CPU and GPU memory used by each subsystem at the end of the frame.
+  MemorySizes memorySizes;
+};
+
+/**
+ * Class for collecting the measurements of the frames of a benchmark, and writing their percentiles to a JSON file.
+ */
+class BenchmarkRecorder
+{
+private:
+  // The measured frames.
+  std::vector<BenchmarkFrame> frames;
+
+  /**
+   * Write the percentiles and the mean of a measurement of the frames as a JSON object.
+   *
+   * @param resultsFile  The file to write to.
+   * @param name         The name of the measurement.
+   * @param values       The values of the measurement in each frame.
+   */
+  static void writeStatistics(std::ofstream &resultsFile, const std::string &name, std::vector<double_t> values)
+  {
+    std::sort(values.begin(), values.end());
+    double_t sum = 0.0;
+    for (const auto &value : values)
+    {
+      sum += value;
+    }
+    resultsFile << "  \"" << name << "\": {\"mean\": " << (values.empty() ? 0.0 : sum / values.size())
+                << ", \"p50\": " << getPercentile(values, 0.5) << ", \"p95\": " << getPercentile(values, 0.95)
+                << ", \"p99\": " << getPercentile(values, 0.99) << ", \"max\": " << (values.empty() ? 0.0 : values.back()) << "}";
+  }
+
+  /**
+   * Write the mean frame time of the frames grouped into ten ranges of the number of models in the scene, showing how
+   * the frame time scales with the number of models as they're added and removed.
+   *
+   * @param resultsFile  The file to write to.
+   */
+  void writeFrameTimeScaling(std::ofstream &resultsFile) const
+  {
+    uint32_t maxModelsCount = 0;
+    for (const auto &frame : frames)
+    {
+      maxModelsCount = std::max(maxModelsCount, frame.modelsCount);
+    }
+    // Sum the frame times of the frames in each range of model counts.
+    const auto rangeSize = std::max(1u, (maxModelsCount + 9) / 10);
+    std::map<uint32_t, std::pair<uint32_t, double_t>> rangeFrameTimes({});
+    for (const auto &frame : frames)
+    {
+      auto &rangeFrameTime = rangeFrameTimes[frame.modelsCount / rangeSize * rangeSize];
+      rangeFrameTime.first++;
+      rangeFrameTime.second += frame.frameTime;
+    }
+
+    resultsFile << "  \"frameTimeByModelCount\": [";
+    for (auto rangeFrameTime = rangeFrameTimes.begin(); rangeFrameTime != rangeFrameTimes.end(); rangeFrameTime++)
+    {
+      resultsFile << (rangeFrameTime == rangeFrameTimes.begin() ? "" : ",") << "\n    {\"minModels\": " << rangeFrameTime->first
+                  << ", \"maxModels\": " << rangeFrameTime->first + rangeSize - 1 << ", \"frames\": " << rangeFrameTime->second.first
+                  << ", \"meanFrameTime\": " << rangeFrameTime->second.second / rangeFrameTime->second.first << "}";
+    }
+    resultsFile << "\n  ]";
+  }
+
+public:
+  BenchmarkRecorder() : frames({}) {}
+
+  /**
+   * Get the given percentile of the sorted values, picking the nearest value ranked at or above it.
+   *
+   * @param sortedValues  The values, in ascending order.
+   * @param percentile    The percentile, between 0 and 1.
+   *
+   * @return The value at the percentile, or 0 if there are no values.
+   */
+  static double_t getPercentile(const std::vector<double_t> &sortedValues, const double_t &percentile)
+  {
+    if (sortedValues.empty())
+    {
+      return 0.0;
+    }
+    const auto rank = static_cast<size_t>(std::ceil(percentile * sortedValues.size()));
+    return sortedValues[std::min(std::max<size_t>(rank, 1), sortedValues.size()) - 1];
+  }
+
+  /**
+   * Record the measurements of a frame.
+   *
+   * @param frame  The measurements of the frame.
+   */
+  void addFrame(const BenchmarkFrame &frame)
+  {
+    frames.push_back(frame);
+  }
+
+  /**
+   * Write the results of the benchmark to a JSON file.
+   *
+   * @param filePath  The path of the file to write the results to.
+   * @param scenario  The scenario that was run.
+   *
+   * @return Whether the results could be written.
+   */
+  bool writeResults(const std::string &filePath, const BenchmarkScenario &scenario) const
+  {
+    std::ofstream resultsFile(filePath, std::ios::out | std::ios::trunc);
+    if (!resultsFile.is_open())
+    {
+      Logger::getInstance().error("Failed at benchmark 1");
+      return false;
+    }
+
+    std::vector<double_t> frameTimes({}), cpuRenderTimes({}), gpuRenderTimes({}), drawCallsCounts({}), instancesCounts({}), trianglesCounts({}), uniformCallsCounts({}), uploadedSizes({}), stateChangesCounts({}), collisionChecksCounts({}), allocationsCounts({});
+    for (const auto &frame : frames)
+    {
+      frameTimes.push_back(frame.frameTime);
+      cpuRenderTimes.push_back(frame.cpuRenderTime);
+      gpuRenderTimes.push_back(frame.gpuRenderTime);
+      const auto totalRenderStats = sumRenderStats(frame.renderStats);
+      drawCallsCounts.push_back(totalRenderStats.drawCalls);
+      instancesCounts.push_back(totalRenderStats.instances);
+      trianglesCounts.push_back(totalRenderStats.triangles);
+      uniformCallsCounts.push_back(totalRenderStats.uniformCalls);
+      uploadedSizes.push_back(totalRenderStats.uploadedBytes / 1024.0);
+      stateChangesCounts.push_back(totalRenderStats.stateChanges);
+      collisionChecksCounts.push_back(frame.collisionChecksCount);
+      allocationsCounts.push_back(frame.allocationsCount);
+    }
+
+    resultsFile << "{\n  \"scenario\": \"" << scenario.name << "\",\n  \"seed\": " << scenario.seed << ",\n  \"enemyGridSize\": ["
+                << scenario.enemyGridSize.x << ", " << scenario.enemyGridSize.y << ", " << scenario.enemyGridSize.z << "],\n  \"boxBoxTest\": \""
+                << (scenario.separatingAxisBoxTestEnabled ? "separatingAxis" : "corners") << "\",\n  \"frames\": " << frames.size() << ",\n";
+    writeStatistics(resultsFile, "frameTime", frameTimes);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "cpuRenderTime", cpuRenderTimes);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "gpuRenderTime", gpuRenderTimes);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "drawCalls", drawCallsCounts);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "instances", instancesCounts);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "triangles", trianglesCounts);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "uniformCalls", uniformCallsCounts);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "uploadedKilobytes", uploadedSizes);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "stateChanges", stateChangesCounts);
+    resultsFile << ",\n";
+    // Write the draw calls and the triangles of each pass, named without the spaces and dashes of the pass names.
+    for (uint32_t i = 0; i < RENDER_PASSES_COUNT; i++)
+    {
+      std::vector<double_t> passDrawCallsCounts({}), passTrianglesCounts({});
+      for (const auto &frame : frames)
+      {
+        passDrawCallsCounts.push_back(frame.renderStats[i].drawCalls);
+        passTrianglesCounts.push_back(frame.renderStats[i].triangles);
+      }
+      auto passName = renderPassNames[i];
+      passName.erase(std::remove_if(passName.begin(), passName.end(), [](const char &character) { return character == ' ' || character == '-'; }), passName.end());
+      writeStatistics(resultsFile, "drawCalls" + passName, passDrawCallsCounts);
+      resultsFile << ",\n";
+      writeStatistics(resultsFile, "triangles" + passName, passTrianglesCounts);
+      resultsFile << ",\n";
+    }
+    writeStatistics(resultsFile, "collisionChecks", collisionChecksCounts);
+    resultsFile << ",\n";
+    writeStatistics(resultsFile, "allocations", allocationsCounts);
+    resultsFile << ",\n";
+    // Write the memory of each subsystem in megabytes, named without the spaces of the subsystem names.
+    for (uint32_t i = 0; i < MEMORY_SUBSYSTEMS_COUNT; i++)
+    {
+      std::vector<double_t> cpuMemorySizes({}), gpuMemorySizes({});
+      for (const auto &frame : frames)
+      {
+        cpuMemorySizes.push_back(frame.memorySizes.cpuSizes[i] / (1024.0 * 1024.0));
+        gpuMemorySizes.push_back(frame.memorySizes.gpuSizes[i] / (1024.0 * 1024.0));
+      }
+      auto subsystemName = MemoryManager::getSubsystemName(i);
+      subsystemName.erase(std::remove(subsystemName.begin(), subsystemName.end(), ' '), subsystemName.end());
+      writeStatistics(resultsFile, "cpuMemory" + subsystemName, cpuMemorySizes);
+      resultsFile << ",\n";
+      writeStatistics(resultsFile, "gpuMemory" + subsystemName, gpuMemorySizes);
+      resultsFile << ",\n";
+    }
+    // Write the CPU memory of each model in bytes, on average over the models of each frame.
+    std::vector<double_t> modelSizes({});
+    for (const auto &frame : frames)
+    {
+      modelSizes.push_back(double_t(frame.memorySizes.cpuSizes[static_cast<uint32_t>(MemorySubsystem::MODELS)]) / std::max<uint32_t>(frame.modelsCount, 1));
+    }
+    writeStatistics(resultsFile, "modelBytes", modelSizes);
+    resultsFile << ",\n";
+    // Write the time taken to start up, and the time each phase of it took, named without the spaces of the phase names.
+    const auto &startupProfiler = StartupProfiler::getInstance();
+    resultsFile << "  \"startupTime\": " << startupProfiler.getStartupTime() << ",\n";
+    for (uint32_t i = 0; i < STARTUP_PHASES_COUNT; i++)
+    {
+      auto phaseName = startupPhaseNames[i];
+      phaseName.erase(std::remove(phaseName.begin(), phaseName.end(), ' '), phaseName.end());
+      resultsFile << "  \"startupTime" << phaseName << "\": " << startupProfiler.getPhaseTime(static_cast<StartupPhase>(i)).duration << ",\n";
+    }
+    writeFrameTimeScaling(resultsFile);
+    resultsFile << "\n}\n";
+    return true;
+  }
+};
+
+#endif
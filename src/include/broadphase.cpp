@@ -0,0 +1,60 @@
+#ifndef INCLUDE_BROADPHASE_CPP
+#define INCLUDE_BROADPHASE_CPP
+
+#include <vector>
+
+#include "slot_map.cpp"
+#include "collider.cpp"
+
+/**
+ * Enum for the supported broadphase structures.
+ */
+enum class BroadphaseType
+{
+  // A uniform grid of cells, best when the entries are spread evenly and are about the same size.
+  SPATIAL_HASH,
+  // A dynamic bounding volume hierarchy, best when the entries are bunched up or vary a lot in size.
+  AABB_TREE,
+};
+
+/**
+ * A base class for the structures that find which entries might overlap a box, so only those need an exact test.
+ */
+class Broadphase
+{
+public:
+  virtual ~Broadphase() {}
+
+  /**
+   * Insert the entry with the given box, or move it to the box if it was already inserted.
+   *
+   * @param entryId  The handle of the entry.
+   * @param box      The bounding box of the entry.
+   * @param layers   The mask of the collision layers of the entry.
+   */
+  virtual void update(const SlotHandle &entryId, const AxisAlignedBoundingBox &box, const uint32_t &layers) = 0;
+
+  /**
+   * Remove the entry, if it was inserted.
+   *
+   * @param entryId  The handle of the entry.
+   */
+  virtual void remove(const SlotHandle &entryId) = 0;
+
+  /**
+   * Remove all the entries.
+   */
+  virtual void clear() = 0;
+
+  /**
+   * Get the handles of the entries on any of the given layers that might overlap the given box. The entries on the
+   *   other layers are skipped before their boxes are looked at.
+   *
+   * @param box        The box to query.
+   * @param layerMask  The mask of the collision layers of the entries to find.
+   * @param entryIds   The list to store the handles of the entries to, each only once and ordered by handle.
+   */
+  virtual void query(const AxisAlignedBoundingBox &box, const uint32_t &layerMask, std::vector<SlotHandle> &entryIds) const = 0;
+};
+
+#endif
@@ -7,6 +7,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "text.cpp"
+#include "profiler.cpp"
+#include "slot_map.cpp"
 #include "../camera/camera_base.cpp"
 
 /**
@@ -15,54 +17,56 @@
 class CameraManager
 {
 private:
-  // Singleton instance of the camera manager.
-  static CameraManager instance;
+  // The registered cameras, found by their handles and packed together for iterating them.
+  SlotMap<std::shared_ptr<CameraBase>> registeredCameras;
 
-  // The text manager responsible for rendering text.
-  TextManager &textManager;
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local CameraManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
 
-  // The map of registered cameras.
-  std::map<const std::string, const std::shared_ptr<CameraBase>> registeredCameras;
-  std::vector<std::string> registeredCamerasInsertionOrder;
+  /**
+   * Returns the singleton instance of the camera manager, which is the one of the default world.
+   *
+   * @return The camera manager singleton instance.
+   */
+  static CameraManager &getSingleton()
+  {
+    // Singleton instance of the camera manager, constructed the first time it's asked for.
+    static CameraManager instance;
+    return instance;
+  }
 
   CameraManager()
-      : textManager(TextManager::getInstance()),
-        registeredCameras({}),
-        registeredCamerasInsertionOrder({}) {}
+      : registeredCameras() {}
 
 public:
   // Preventing copying the camera manager, making sure only one instance can exist.
   CameraManager(const CameraManager &) = delete;
 
   /**
-   * Register a new camera into the camera manager.
+   * Register a new camera into the camera manager, giving it the handle it is found by from then on.
    * 
    * @param camera  The camera to register.
+   * 
+   * @return The handle of the camera.
    */
-  void registerCamera(const std::shared_ptr<CameraBase> &&camera)
+  SlotHandle registerCamera(const std::shared_ptr<CameraBase> &&camera)
   {
-    // Insert the camera to the map of registered cameras.
-    registeredCameras.emplace(camera->getCameraId(), std::move(camera));
-    registeredCamerasInsertionOrder.push_back(camera->getCameraId());
+    const auto cameraHandle = registeredCameras.insert(camera);
+    camera->setCameraHandle(cameraHandle);
+    return cameraHandle;
   }
 
   /**
-   * De-register an existing camera from the camera manager.
+   * De-register an existing camera from the camera manager. Removing a camera moves the last registered camera into its
+   *   place in the list of all cameras.
    * 
-   * @param camera  The ID of the camera to de-register.
+   * @param cameraHandle  The handle of the camera to de-register.
    */
-  void deregisterCamera(const std::string &cameraId)
+  void deregisterCamera(const SlotHandle &cameraHandle)
   {
-    // Check if camera actually exists. If not, just return since it's not registered.
-    if (std::find(registeredCamerasInsertionOrder.begin(), registeredCamerasInsertionOrder.end(), cameraId) == registeredCamerasInsertionOrder.end())
-    {
-      return;
-    }
-
-    // Get the camera that is registered with the given camera ID.
-    auto camera = registeredCameras[cameraId];
-    // Remove the camera from the map of registered cameras.
-    deregisterCamera(camera);
+    registeredCameras.remove(cameraHandle);
   }
 
   /**
@@ -72,21 +76,19 @@ public:
    */
   void deregisterCamera(const std::shared_ptr<CameraBase> &camera)
   {
-    // Remove the camera from the map of registered cameras.
-    registeredCameras.erase(camera->getCameraId());
-    registeredCamerasInsertionOrder.erase(std::remove(registeredCamerasInsertionOrder.begin(), registeredCamerasInsertionOrder.end(), camera->getCameraId()), registeredCamerasInsertionOrder.end());
+    deregisterCamera(camera->getCameraHandle());
   }
 
   /**
-   * Return the camera registered with the given camera ID.
+   * Return the camera registered with the given handle.
    * 
-   * @param cameraId  The ID of the camera to return.
+   * @param cameraHandle  The handle of the camera to return.
    * 
-   * @return The camera registered with the given camera ID.
+   * @return The camera registered with the given handle.
    */
-  const std::shared_ptr<CameraBase> &getCamera(const std::string &cameraId) const
+  const std::shared_ptr<CameraBase> &getCamera(const SlotHandle &cameraHandle) const
   {
-    return registeredCameras.at(cameraId);
+    return registeredCameras.get(cameraHandle);
   }
 
   /**
@@ -94,18 +96,9 @@ public:
    * 
    * @return The list of all registered cameras.
    */
-  const std::vector<std::shared_ptr<CameraBase>> getAllCameras() const
+  const std::vector<std::shared_ptr<CameraBase>> &getAllCameras() const
   {
-    // Define a vector to store the list of registered cameras.
-    std::vector<std::shared_ptr<CameraBase>> cameras({});
-    // Iterate through the map of registered cameras.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
-    {
-      // Push each registered model into the models list.
-      cameras.push_back(registeredCameras.find(cameraId)->second);
-    }
-    // Return the list of registered cameras.
-    return cameras;
+    return registeredCameras.getValues();
   }
 
   /**
@@ -113,16 +106,10 @@ public:
    */
   void initAllCameras()
   {
-    // Iterate through the list of camera IDs.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
+    // Iterate through the list of registered cameras.
+    for (const auto &camera : registeredCameras.getValues())
     {
-      // Find the camera registered with the given camera ID.
-      const auto result = registeredCameras.find(cameraId);
-      // Check if the camera still exists in the registration map.
-      if (result != registeredCameras.end())
-      {
-        result->second->init();
-      }
+      camera->init();
     }
   }
 
@@ -131,74 +118,61 @@ public:
    */
   void deinitAllCameras()
   {
-    // Iterate through the list of camera IDs.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
+    // Iterate through the list of registered cameras.
+    for (const auto &camera : registeredCameras.getValues())
     {
-      // Find the camera registered with the given camera ID.
-      const auto result = registeredCameras.find(cameraId);
-      // Check if the camera still exists in the registration map.
-      if (result != registeredCameras.end())
-      {
-        result->second->deinit();
-      }
+      camera->deinit();
     }
   }
 
   /**
    * Run the update operation on all the registered cameras.
+   * 
+   * @param frameTime  The time of the frame.
    */
-  void updateAllCameras()
+  void updateAllCameras(const FrameTime &frameTime)
   {
     auto cameraNamesCount = std::map<const std::string, int>({});
     auto cameraNamesProcessTime = std::map<const std::string, double>({});
 
-    // Iterate through the list of camera IDs.
-    for (const auto &cameraId : registeredCamerasInsertionOrder)
+    // Iterate through the list of registered cameras.
+    for (const auto &camera : registeredCameras.getValues())
     {
-      // Find the camera registered with the given camera ID.
-      const auto result = registeredCameras.find(cameraId);
-      // Check if the camera still exists in the registration map.
-      if (result != registeredCameras.end())
+      if (cameraNamesCount.find(camera->getCameraName()) != cameraNamesCount.end())
       {
-        if (cameraNamesCount.find(result->second->getCameraName()) != cameraNamesCount.end())
-        {
-          cameraNamesCount[result->second->getCameraName()]++;
-        }
-        else
-        {
-          cameraNamesCount[result->second->getCameraName()] = 1;
-          cameraNamesProcessTime[result->second->getCameraName()] = 0.0f;
-        }
-
-        // If it does, tell the camera to perform an update on itself.
-        const auto startTime = glfwGetTime();
-        result->second->update();
-        const auto endTime = glfwGetTime();
-        cameraNamesProcessTime[result->second->getCameraName()] += (endTime - startTime) * 1000;
+        cameraNamesCount[camera->getCameraName()]++;
       }
+      else
+      {
+        cameraNamesCount[camera->getCameraName()] = 1;
+        cameraNamesProcessTime[camera->getCameraName()] = 0.0f;
+      }
+
+      // Tell the camera to perform an update on itself.
+      ProfileZone cameraZone(camera->getCameraName());
+      camera->update(frameTime);
+      cameraNamesProcessTime[camera->getCameraName()] += cameraZone.end();
     }
 
     auto height = 13.5f;
     for (const auto &cameraCounts : cameraNamesCount)
     {
       const auto avgRenderTime = cameraNamesProcessTime[cameraCounts.first] / cameraCounts.second;
-      textManager.addText(cameraCounts.first + " Camera Object Instances: " + std::to_string(cameraCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+      TextManager::getInstance().addFormattedText(glm::vec2(1, height), 0.5f, cameraCounts.first, " Camera Object Instances: ", cameraCounts.second, " | Update (avg): ", avgRenderTime, "ms");
       height -= 0.5f;
     }
   }
 
   /**
-   * Returns the singleton instance of the camera manager.
+   * Returns the instance of the camera manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
    * 
-   * @return The camera manager singleton instance.
+   * @return The camera manager instance.
    */
   static CameraManager &getInstance()
   {
-    return instance;
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
   }
 };
 
-// Initialize the camera manager singleton instance static variable.
-CameraManager CameraManager::instance;
-
 #endif
\ No newline at end of file
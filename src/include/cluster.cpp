@@ -0,0 +1,215 @@
+#ifndef INCLUDE_CLUSTER_CPP
+#define INCLUDE_CLUSTER_CPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+/**
+ * Class for splitting the view frustum of a camera into a grid of clusters, and finding the lights that can reach each
+ * cluster, so a fragment only needs to go through the lights of its own cluster. The clusters are tiles of the screen
+ * on the x-axis and y-axis, and slices of the view depth on the z-axis, growing exponentially with distance so they
+ * stay roughly cube-shaped.
+ */
+class LightClusterGrid
+{
+private:
+  // The number of clusters along the x-axis, y-axis and depth of the grid.
+  const glm::uvec3 gridSize;
+
+  // The offset and count of the light indices of each cluster, in the order x, then y, then depth.
+  std::vector<glm::uvec2> clusterLightRanges;
+  // The indices of the lights of all the clusters, one range after another.
+  std::vector<uint32_t> clusterLightIndices;
+  // The width and height of a cluster on the screen in pixels, and the scale and bias turning the logarithm of the view
+  //   depth into a slice.
+  glm::vec4 clusterParameters;
+  // The number of lights that were assigned to the clusters.
+  uint32_t lightsCount;
+
+  /**
+   * Get the depth slice of the given view depth.
+   *
+   * @param viewDepth  The distance in front of the camera.
+   *
+   * @return The index of the slice.
+   */
+  uint32_t getDepthSlice(const float_t &viewDepth) const
+  {
+    const auto slice = std::floor(std::log(viewDepth) * clusterParameters.z + clusterParameters.w);
+    return static_cast<uint32_t>(glm::clamp(slice, 0.0f, static_cast<float_t>(gridSize.z - 1)));
+  }
+
+  /**
+   * Get the depth of the given point of normalized device coordinates in front of the camera.
+   *
+   * @param inverseProjectionMatrix  The inverse of the projection matrix of the camera.
+   * @param ndcDepth                 The depth of the point in normalized device coordinates.
+   *
+   * @return The view depth of the point.
+   */
+  static float_t getViewDepth(const glm::mat4 &inverseProjectionMatrix, const float_t &ndcDepth)
+  {
+    const auto viewPosition = inverseProjectionMatrix * glm::vec4(0.0f, 0.0f, ndcDepth, 1.0f);
+    return -viewPosition.z / viewPosition.w;
+  }
+
+public:
+  LightClusterGrid(const glm::uvec3 &gridSize)
+      : gridSize(gridSize),
+        clusterLightRanges(gridSize.x * gridSize.y * gridSize.z, glm::uvec2(0)),
+        clusterLightIndices({}),
+        clusterParameters(1.0f, 1.0f, 0.0f, 0.0f),
+        lightsCount(0) {}
+
+  /**
+   * Assign the given lights to the clusters they can reach. A light is assigned to every cluster its bounding box
+   * overlaps, which can include a few clusters it can't actually reach.
+   *
+   * @param lightSpheres      The spheres of the reach of the lights, as the view-space position (x, y, z) and the radius (w).
+   * @param projectionMatrix  The projection matrix of the camera.
+   * @param viewportSize      The size of the viewport of the camera, in pixels.
+   */
+  void assignLights(const std::vector<glm::vec4> &lightSpheres, const glm::mat4 &projectionMatrix, const glm::vec2 &viewportSize)
+  {
+    // Get the near and far planes of the camera from its projection matrix.
+    const auto inverseProjectionMatrix = glm::inverse(projectionMatrix);
+    const auto nearPlane = std::max(getViewDepth(inverseProjectionMatrix, -1.0f), 0.001f);
+    const auto farPlane = std::max(getViewDepth(inverseProjectionMatrix, 1.0f), nearPlane * 2.0f);
+    // Work out the size of the screen tiles and how to get the slice of a depth.
+    const auto depthScale = gridSize.z / std::log(farPlane / nearPlane);
+    clusterParameters = glm::vec4(std::ceil(viewportSize.x / gridSize.x), std::ceil(viewportSize.y / gridSize.y), depthScale, -std::log(nearPlane) * depthScale);
+    lightsCount = lightSpheres.size();
+
+    // Find the range of clusters each light overlaps, and count the lights of each cluster.
+    std::vector<std::pair<glm::uvec3, glm::uvec3>> lightClusterBounds({});
+    std::vector<uint32_t> clusterLightCounts(clusterLightRanges.size(), 0);
+    for (const auto &lightSphere : lightSpheres)
+    {
+      const auto center = glm::vec3(lightSphere);
+      const auto radius = lightSphere.w;
+      // Skip the light if it's entirely in front of the near plane or behind the far plane.
+      const auto minDepth = -center.z - radius, maxDepth = -center.z + radius;
+      if (maxDepth < nearPlane || minDepth > farPlane)
+      {
+        lightClusterBounds.push_back({glm::uvec3(1), glm::uvec3(0)});
+        continue;
+      }
+
+      // Find the area of the screen the light covers. If the light reaches the near plane, parts of it may be behind the
+      //   camera, so it's treated as covering the whole screen.
+      auto minNdc = glm::vec2(-1.0f), maxNdc = glm::vec2(1.0f);
+      if (minDepth > nearPlane)
+      {
+        minNdc = glm::vec2(1.0f);
+        maxNdc = glm::vec2(-1.0f);
+        // Project the corners of the box around the light and take their bounds.
+        for (auto i = 0; i < 8; i++)
+        {
+          const auto corner = center + radius * glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+          const auto clipCorner = projectionMatrix * glm::vec4(corner, 1.0f);
+          const auto ndcCorner = glm::vec2(clipCorner) / clipCorner.w;
+          minNdc = glm::min(minNdc, ndcCorner);
+          maxNdc = glm::max(maxNdc, ndcCorner);
+        }
+        minNdc = glm::max(minNdc, glm::vec2(-1.0f));
+        maxNdc = glm::min(maxNdc, glm::vec2(1.0f));
+        // Skip the light if it's off the screen.
+        if (minNdc.x > maxNdc.x || minNdc.y > maxNdc.y)
+        {
+          lightClusterBounds.push_back({glm::uvec3(1), glm::uvec3(0)});
+          continue;
+        }
+      }
+
+      // Turn the screen area and the depths into ranges of clusters.
+      const auto minTile = glm::uvec2(glm::min((minNdc * 0.5f + 0.5f) * viewportSize / glm::vec2(clusterParameters), glm::vec2(gridSize) - 1.0f));
+      const auto maxTile = glm::uvec2(glm::min((maxNdc * 0.5f + 0.5f) * viewportSize / glm::vec2(clusterParameters), glm::vec2(gridSize) - 1.0f));
+      const auto minCluster = glm::uvec3(minTile, getDepthSlice(std::max(minDepth, nearPlane)));
+      const auto maxCluster = glm::uvec3(maxTile, getDepthSlice(std::min(maxDepth, farPlane)));
+      lightClusterBounds.push_back({minCluster, maxCluster});
+      for (auto z = minCluster.z; z <= maxCluster.z; z++)
+      {
+        for (auto y = minCluster.y; y <= maxCluster.y; y++)
+        {
+          for (auto x = minCluster.x; x <= maxCluster.x; x++)
+          {
+            clusterLightCounts[x + gridSize.x * (y + gridSize.y * z)]++;
+          }
+        }
+      }
+    }
+
+    // Lay out the ranges of the clusters one after another.
+    uint32_t indicesCount = 0;
+    for (unsigned long i = 0; i < clusterLightRanges.size(); i++)
+    {
+      clusterLightRanges[i] = glm::uvec2(indicesCount, 0);
+      indicesCount += clusterLightCounts[i];
+    }
+
+    // Fill the ranges with the indices of the lights, in the order of the lights.
+    clusterLightIndices.assign(indicesCount, 0);
+    for (uint32_t i = 0; i < lightClusterBounds.size(); i++)
+    {
+      const auto &minCluster = lightClusterBounds[i].first, &maxCluster = lightClusterBounds[i].second;
+      for (auto z = minCluster.z; z <= maxCluster.z; z++)
+      {
+        for (auto y = minCluster.y; y <= maxCluster.y; y++)
+        {
+          for (auto x = minCluster.x; x <= maxCluster.x; x++)
+          {
+            auto &clusterLightRange = clusterLightRanges[x + gridSize.x * (y + gridSize.y * z)];
+            clusterLightIndices[clusterLightRange.x + clusterLightRange.y] = i;
+            clusterLightRange.y++;
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Get the offset and count of the light indices of each cluster, in the order x, then y, then depth.
+   *
+   * @return The ranges of the clusters.
+   */
+  const std::vector<glm::uvec2> &getClusterLightRanges() const
+  {
+    return clusterLightRanges;
+  }
+
+  /**
+   * Get the indices of the lights of all the clusters, which the ranges of the clusters point into.
+   *
+   * @return The light indices.
+   */
+  const std::vector<uint32_t> &getClusterLightIndices() const
+  {
+    return clusterLightIndices;
+  }
+
+  /**
+   * Get the width and height of a cluster on the screen in pixels (x, y), and the scale (z) and bias (w) turning the
+   * logarithm of the view depth into a slice.
+   *
+   * @return The cluster parameters.
+   */
+  const glm::vec4 &getClusterParameters() const
+  {
+    return clusterParameters;
+  }
+
+  /**
+   * Get the number of lights assigned in the last call to assign lights.
+   *
+   * @return The number of lights.
+   */
+  const uint32_t &getLightsCount() const
+  {
+    return lightsCount;
+  }
+};
+
+#endif
@@ -3,10 +3,14 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <map>
 #include <memory>
+#include <algorithm>
+#include <variant>
 #include <iostream>
 #include <fstream>
+#include <cmath>
 
 #include <stdlib.h>
 #include <string.h>
@@ -19,6 +23,10 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include "parallel.cpp"
+#include "constants.cpp"
+#include "transform_batch.cpp"
+
 class ColliderShape;
 class SphereColliderShape;
 class BoxColliderShape;
@@ -30,22 +38,96 @@ bool haveBoxBoxCollided(const BoxColliderShape &box1, const BoxColliderShape &bo
 // https://developer.mozilla.org/en-US/docs/Games/Techniques/3D_collision_detection
 //   is a good read to understand the collision concepts here.
 
+/**
+ * Structure for defining a ray, starting at a point and going along a direction, for finding the colliders along a line
+ *   such as the one under the cursor.
+ */
+struct Ray
+{
+  // The point the ray starts at.
+  glm::vec3 origin;
+  // The unit direction the ray goes along.
+  glm::vec3 direction;
+  // The reciprocal of the direction, which the slab tests divide by along each axis.
+  glm::vec3 inverseDirection;
+
+  Ray(const glm::vec3 &origin, const glm::vec3 &direction)
+      : origin(origin),
+        direction(glm::normalize(direction)),
+        inverseDirection(1.0f / glm::normalize(direction)) {}
+
+  /**
+   * Get the point the given distance along the ray.
+   *
+   * @param distance  The distance from the start of the ray.
+   *
+   * @return The point.
+   */
+  glm::vec3 getPoint(const float_t &distance) const
+  {
+    return origin + direction * distance;
+  }
+
+  /**
+   * Find the distance along the ray the box between the given corners is first hit at, using the slab test. The ray is
+   *   inside the box between where it enters the last of the slabs between the corners along each axis and where it
+   *   leaves the first. Along the axes the ray is parallel to, the slab is skipped if the ray starts inside it, since
+   *   the distances to its sides would be 0 times infinity.
+   *
+   * @param minCorner    The minimum corner of the box.
+   * @param maxCorner    The maximum corner of the box.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the box is hit at, which is 0 if the ray starts
+   *                       inside the box.
+   *
+   * @return Whether the ray hits the box before the given distance.
+   */
+  bool raycastSlabs(const glm::vec3 &minCorner, const glm::vec3 &maxCorner, const float_t &maxDistance, float_t &distance) const
+  {
+    float_t enterDistance = 0.0f, exitDistance = maxDistance;
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      if (direction[axis] == 0.0f)
+      {
+        if (origin[axis] < minCorner[axis] || origin[axis] > maxCorner[axis])
+        {
+          return false;
+        }
+        continue;
+      }
+      const auto minSideDistance = (minCorner[axis] - origin[axis]) * inverseDirection[axis];
+      const auto maxSideDistance = (maxCorner[axis] - origin[axis]) * inverseDirection[axis];
+      enterDistance = std::max(enterDistance, std::min(minSideDistance, maxSideDistance));
+      exitDistance = std::min(exitDistance, std::max(minSideDistance, maxSideDistance));
+      if (enterDistance > exitDistance)
+      {
+        return false;
+      }
+    }
+    distance = enterDistance;
+    return true;
+  }
+};
+
 /**
  * A class for defining an axis-aligned bounding box (AABB) collider.
  */
 class AxisAlignedBoundingBox
 {
 private:
+  // The minimum number of vertices worth splitting across parallel tasks.
+  static constexpr size_t MIN_PARALLEL_VERTICES = 100000;
+
   // The corner of the cube with the smallest coordinates.
   glm::vec3 minCorner;
   // The corner of the cube with the smallest coordinates.
   glm::vec3 maxCorner;
 
-  // The list of the eight corners of the AABB.
-  std::vector<glm::vec3> corners;
+  // The eight corners of the AABB, kept in place so updating the AABB never allocates.
+  std::array<glm::vec3, 8> corners;
 
   /**
-   * Calculate the corners of the AABB and save them in the vector.
+   * Calculate the corners of the AABB and save them in the array.
    */
   void updateCorners()
   {
@@ -62,7 +144,7 @@ private:
         for (auto z = 0; z < 2; z++)
         {
           // The combination of the various min/max values of each axis gives us a coordinate of the box.
-          corners.push_back(glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]));
+          corners[x * 4 + y * 2 + z] = glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]);
         }
       }
     }
@@ -75,16 +157,25 @@ private:
    */
   void updateMinMaxCorners(const std::vector<glm::vec3> &vertices)
   {
-    // Iterate through all the vertices
-    for (const auto &vertex : vertices)
-    {
-      // For each axis of a vertex coordinate...
-      for (auto axis = 0; axis < 3; axis++)
+    // Split the vertices into chunks, and find the min/max-corners of each chunk in parallel. Small vertex lists end up in a
+    // single chunk that is processed on this thread.
+    const auto chunkCount = ParallelTasks::getTaskCount(vertices.size(), MIN_PARALLEL_VERTICES);
+    std::vector<glm::vec3> chunkMinCorners(chunkCount, minCorner), chunkMaxCorners(chunkCount, maxCorner);
+    ParallelTasks::runChunked(vertices.size(), MIN_PARALLEL_VERTICES, [&](const uint32_t chunkIndex, const size_t begin, const size_t end) {
+      // Iterate through all the vertices of the chunk.
+      for (auto i = begin; i < end; i++)
       {
-        // Store that value if it is the lowest/highest value observed so far.
-        minCorner[axis] = glm::min(minCorner[axis], vertex[axis]);
-        maxCorner[axis] = glm::max(maxCorner[axis], vertex[axis]);
+        // Store the values of each axis if they are the lowest/highest value observed so far.
+        chunkMinCorners[chunkIndex] = glm::min(chunkMinCorners[chunkIndex], vertices[i]);
+        chunkMaxCorners[chunkIndex] = glm::max(chunkMaxCorners[chunkIndex], vertices[i]);
       }
+    });
+
+    // Merge the min/max-corners of the chunks.
+    for (uint32_t i = 0; i < chunkCount; i++)
+    {
+      minCorner = glm::min(minCorner, chunkMinCorners[i]);
+      maxCorner = glm::max(maxCorner, chunkMaxCorners[i]);
     }
   }
 
@@ -132,7 +223,7 @@ public:
    * 
    * @return The list of the eight corners.
    */
-  const std::vector<glm::vec3> &getCorners() const
+  const std::array<glm::vec3, 8> &getCorners() const
   {
     return corners;
   }
@@ -192,6 +283,36 @@ public:
     // True is returned only if a collision has occured along all three axes, false otherwise.
     return hasCollided;
   }
+
+  /**
+   * Calculate and return whether the current AABB intersects the given sphere, by checking the distance to the sphere
+   *   from the point of the AABB closest to its center.
+   * 
+   * @param center  The center of the sphere.
+   * @param radius  The radius of the sphere.
+   * 
+   * @return Whether the AABB and the sphere intersect.
+   */
+  bool intersectsSphere(const glm::vec3 &center, const float_t &radius) const
+  {
+    const auto offset = glm::clamp(center, getMinCorner(), getMaxCorner()) - center;
+    return glm::dot(offset, offset) <= radius * radius;
+  }
+
+  /**
+   * Find the distance along the ray the AABB is first hit at, using the slab test.
+   *
+   * @param ray          The ray.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the AABB is hit at, which is 0 if the ray starts
+   *                       inside the AABB.
+   *
+   * @return Whether the ray hits the AABB before the given distance.
+   */
+  bool raycast(const Ray &ray, const float_t &maxDistance, float_t &distance) const
+  {
+    return ray.raycastSlabs(getMinCorner(), getMaxCorner(), maxDistance, distance);
+  }
 };
 
 /**
@@ -215,8 +336,8 @@ protected:
   const ColliderShapeType type;
   // The position of the collider.
   glm::vec3 position;
-  // The rotation of the collider.
-  glm::vec3 rotation;
+  // The rotation of the collider, as a quaternion so the matrices are built without any trig.
+  glm::quat rotation;
   // The scale of the collider.
   glm::vec3 scale;
 
@@ -226,51 +347,110 @@ protected:
   // This may seem to defeat the purpose of the AABB since it looses its axis-aligned properties, but if we inverse-transform
   //   the entire world back using the models' transformation matrix, the base AABB becomes a proper AABB again, and everything
   //   is now aligned with that AABB, making it possible to detect collisions against it again.
-  std::shared_ptr<const AxisAlignedBoundingBox> baseBox;
+  AxisAlignedBoundingBox baseBox;
   // Since the base AABB is being transformed around, another AABB is generated using the base AABB post-transformation.
-  //   This gives us a base AABB to perform a shallow collision check against.
-  std::shared_ptr<const AxisAlignedBoundingBox> transformedBox;
+  //   This gives us a base AABB to perform a shallow collision check against. It is updated in place the first time it
+  //   is read after the collider moves, so a collider moved several times in a row only generates it once.
+  mutable AxisAlignedBoundingBox transformedBox;
+  // Whether the collider moved since the transformed AABB was last generated.
+  mutable bool transformedBoxStale;
+
+  // The transformation matrix of the collider, and its inverse for taking other shapes into the space of the collider.
+  //   The inverse is only needed by the deeper collision checks, so it is also calculated the first time it is read
+  //   after the collider moves. Colliders read from several threads at once have to be resolved first.
+  glm::mat4 transformationMatrix;
+  mutable glm::mat4 inverseTransformationMatrix;
+  // Whether the collider moved since the inverse transformation matrix was last calculated.
+  mutable bool inverseTransformationMatrixStale;
 
-  // Update the transformed AABB using the transformed base AABB.
-  void updateTransformedBox()
-  {
-    // Get all the corners of the base AABB.
-    const auto baseBoxCorners = baseBox->getCorners();
-    // Define a vector where we will store the transformed corners of the base AABB.
-    std::vector<glm::vec3> newCorners({});
-    // Iterate through each corner of the base AABB.
-    for (const auto &corner : baseBoxCorners)
+  /**
+   * Calculate the transformation matrix for the given transformations.
+   * 
+   * @param position  The position.
+   * @param rotation  The rotation.
+   * @param scale     The scale.
+   * 
+   * @return The transformation matrix.
+   */
+  static glm::mat4 createTransformationMatrix(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale)
+  {
+    // Scale the rotated axes and put the position in, instead of multiplying the three matrices together.
+    const auto rotationMatrix = glm::mat3_cast(rotation);
+    return glm::mat4(glm::vec4(rotationMatrix[0] * scale.x, 0.0f),
+                     glm::vec4(rotationMatrix[1] * scale.y, 0.0f),
+                     glm::vec4(rotationMatrix[2] * scale.z, 0.0f),
+                     glm::vec4(position, 1.0f));
+  }
+
+  /**
+   * Update the transformation matrix to the given one, and mark its inverse and the transformed AABB to be generated
+   *   again the next time they are read.
+   * 
+   * @param newTransformationMatrix  The new transformation matrix, made from the current transformations.
+   */
+  void updateTransformationMatrices(const glm::mat4 &newTransformationMatrix)
+  {
+    transformationMatrix = newTransformationMatrix;
+    inverseTransformationMatrixStale = true;
+    transformedBoxStale = true;
+  }
+
+  /**
+   * Update the inverse transformation matrix to match the transformations. The inverse is put together from the
+   *   reciprocal of the scale and the transpose of the rotation instead of a full matrix inverse.
+   */
+  void updateInverseTransformationMatrix() const
+  {
+    // The transposed rotation with each row divided by its scale, followed by the rotated and scaled negated position.
+    const auto inverseRotationScale = glm::transpose(glm::mat3_cast(rotation));
+    glm::mat3 inverseMatrix;
+    for (auto i = 0; i < 3; i++)
     {
-      // Transform the corner using the models' transformation matrix and store the result.
-      newCorners.push_back(glm::vec3(glm::translate(position) * glm::toMat4(glm::quat(rotation)) * glm::scale(scale) * glm::vec4(corner, 1.0f)));
+      inverseMatrix[i] = inverseRotationScale[i] / scale;
     }
-    // Generate the new AABB using the transformed base AABB.
-    transformedBox = std::make_shared<const AxisAlignedBoundingBox>(newCorners);
+    inverseTransformationMatrix = glm::mat4(glm::vec4(inverseMatrix[0], 0.0f), glm::vec4(inverseMatrix[1], 0.0f), glm::vec4(inverseMatrix[2], 0.0f),
+                                            glm::vec4(inverseMatrix * -position, 1.0f));
+    inverseTransformationMatrixStale = false;
+  }
+
+  // Update the transformed AABB using the transformed base AABB.
+  void updateTransformedBox() const
+  {
+    // Transform the corners of the base AABB using the models' transformation matrix, and grow the min/max-corners to
+    //   them.
+    glm::vec3 newMinCorner, newMaxCorner;
+    TransformBatch::transformBox(transformationMatrix, baseBox.getCorners(), newMinCorner, newMaxCorner);
+    // Update the AABB using the transformed base AABB.
+    transformedBox.update(newMinCorner, newMaxCorner);
+    transformedBoxStale = false;
   }
 
-  void updateBaseBox(const std::shared_ptr<const AxisAlignedBoundingBox> &newBaseBox)
+  void updateBaseBox(const AxisAlignedBoundingBox &newBaseBox)
   {
     // Update the base AABB.
     baseBox = newBaseBox;
-    // Generate the transformation AABB.
-    updateTransformedBox();
+    // Generate the transformation AABB the next time it is read.
+    transformedBoxStale = true;
   }
 
 public:
   ColliderShape(
       const ColliderShapeType &type,
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
-      const std::shared_ptr<const AxisAlignedBoundingBox> &baseBox)
+      const AxisAlignedBoundingBox &baseBox)
       : type(type),
         position(position),
         rotation(rotation),
         scale(scale),
-        baseBox(baseBox)
+        baseBox(baseBox),
+        transformedBox(baseBox),
+        transformedBoxStale(true),
+        inverseTransformationMatrixStale(true)
   {
-    // Generate the transformation AABB.
-    updateTransformedBox();
+    // Generate the transformation matrix, leaving the rest for when it is read.
+    updateTransformationMatrices(createTransformationMatrix(position, rotation, scale));
   }
 
   virtual ~ColliderShape(){};
@@ -300,7 +480,7 @@ public:
    * 
    * @return The collider rotation.
    */
-  const glm::vec3 &getRotation() const
+  const glm::quat &getRotation() const
   {
     return rotation;
   }
@@ -320,21 +500,71 @@ public:
    * 
    * @return The collider base AABB.
    */
-  const std::shared_ptr<const AxisAlignedBoundingBox> &getBaseBox() const
+  const AxisAlignedBoundingBox &getBaseBox() const
   {
     return baseBox;
   }
 
+  /**
+   * Returns the radius of the sphere around the position of the collider that holds the whole collider however it is
+   *   rotated.
+   * 
+   * @return The collider bounding radius.
+   */
+  float_t getBoundingRadius() const
+  {
+    const auto furthestCorner = glm::max(glm::abs(baseBox.getMinCorner()), glm::abs(baseBox.getMaxCorner()));
+    return glm::length(furthestCorner) * std::max(std::max(std::abs(scale.x), std::abs(scale.y)), std::abs(scale.z));
+  }
+
   /**
    * Returns the transformation AABB of the collider.
    * 
    * @return The collider transformation AABB.
    */
-  const std::shared_ptr<const AxisAlignedBoundingBox> &getTransformedBox() const
+  const AxisAlignedBoundingBox &getTransformedBox() const
   {
+    if (transformedBoxStale)
+    {
+      updateTransformedBox();
+    }
     return transformedBox;
   }
 
+  /**
+   * Returns the transformation matrix of the collider.
+   * 
+   * @return The collider transformation matrix.
+   */
+  const glm::mat4 &getTransformationMatrix() const
+  {
+    return transformationMatrix;
+  }
+
+  /**
+   * Returns the inverse of the transformation matrix of the collider.
+   * 
+   * @return The collider inverse transformation matrix.
+   */
+  const glm::mat4 &getInverseTransformationMatrix() const
+  {
+    if (inverseTransformationMatrixStale)
+    {
+      updateInverseTransformationMatrix();
+    }
+    return inverseTransformationMatrix;
+  }
+
+  /**
+   * Generate everything about the collider that is only generated when read, so the collider can then be read from
+   *   several threads at once without any of them writing to it.
+   */
+  void resolveTransformations() const
+  {
+    getTransformedBox();
+    getInverseTransformationMatrix();
+  }
+
   /**
    * Update the transformations of the collider (position, rotation, scale).
    * 
@@ -342,7 +572,21 @@ public:
    * @param newRotation  The new rotation of the collider.
    * @param newScale     The new scale of the collider.
    */
-  virtual void updateTransformations(const glm::vec3 &newPosition, const glm::vec3 &newRotation, const glm::vec3 &newScale)
+  void updateTransformations(const glm::vec3 &newPosition, const glm::quat &newRotation, const glm::vec3 &newScale)
+  {
+    updateTransformations(newPosition, newRotation, newScale, createTransformationMatrix(newPosition, newRotation, newScale));
+  }
+
+  /**
+   * Update the transformations of the collider (position, rotation, scale), using a transformation matrix already
+   *   calculated for them, such as the model matrix.
+   * 
+   * @param newPosition              The new position of the collider.
+   * @param newRotation              The new rotation of the collider.
+   * @param newScale                 The new scale of the collider.
+   * @param newTransformationMatrix  The transformation matrix for the new transformations.
+   */
+  virtual void updateTransformations(const glm::vec3 &newPosition, const glm::quat &newRotation, const glm::vec3 &newScale, const glm::mat4 &newTransformationMatrix)
   {
     // Update the collider position.
     position = newPosition;
@@ -350,8 +594,8 @@ public:
     rotation = newRotation;
     // Update the collider scale.
     scale = newScale;
-    // Generate the transformation AABB.
-    updateTransformedBox();
+    // Update the transformation matrix, leaving its inverse and the transformation AABB for when they are read.
+    updateTransformationMatrices(newTransformationMatrix);
   }
 };
 
@@ -371,10 +615,10 @@ private:
    * 
    * @return The collider base AABB.
    */
-  const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const float_t radius)
+  const AxisAlignedBoundingBox createBaseBox(const float_t radius)
   {
     // Generates the base AABB by using the negative and positive values of the radius to get the min/max-corners of the AABB.
-    return std::make_shared<AxisAlignedBoundingBox>(glm::vec3(-radius, -radius, -radius), glm::vec3(radius, radius, radius));
+    return AxisAlignedBoundingBox(glm::vec3(-radius, -radius, -radius), glm::vec3(radius, radius, radius));
   }
 
   /**
@@ -412,7 +656,7 @@ private:
 public:
   SphereColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const float_t &radius)
       : ColliderShape(
@@ -425,7 +669,7 @@ public:
 
   SphereColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const std::vector<glm::vec3> &vertices)
       : ColliderShape(
@@ -446,16 +690,27 @@ public:
     return radius;
   }
 
+  using ColliderShape::updateTransformations;
+
   /**
    * Update the transformations of the collider (position, rotation, scale).
    * 
-   * @param newPosition  The new position of the collider.
-   * @param newRotation  The new rotation of the collider.
-   * @param newScale  The new scale of the collider.
+   * @param newPosition              The new position of the collider.
+   * @param newRotation              The new rotation of the collider.
+   * @param newScale                 The new scale of the collider.
+   * @param newTransformationMatrix  The transformation matrix for the new transformations, which isn't used since it
+   *                                   includes the rotation.
    */
-  void updateTransformations(const glm::vec3 &newPosition, const glm::vec3 &newRotation, const glm::vec3 &newScale) override
+  void updateTransformations(const glm::vec3 &newPosition, const glm::quat &newRotation, const glm::vec3 &newScale, const glm::mat4 &newTransformationMatrix) override
   {
     (void)newRotation;
+    (void)newTransformationMatrix;
+
+    // A sphere that only turned is still the same sphere, so its matrices and box stay as they are.
+    if (newPosition == position && newScale == scale)
+    {
+      return;
+    }
 
     // Update the collider position.
     position = newPosition;
@@ -464,8 +719,8 @@ public:
     // // rotation = newRotation;
     // Update the collider scale.
     scale = newScale;
-    // Generate the transformation AABB.
-    updateTransformedBox();
+    // Update the transformation matrix, leaving the rotation out of it as well.
+    updateTransformationMatrices(createTransformationMatrix(position, rotation, scale));
   }
 
   /**
@@ -502,7 +757,7 @@ class BoxColliderShape : public ColliderShape
 {
 private:
   // The list of the eight corners of the collider box.
-  std::vector<glm::vec3> corners;
+  std::array<glm::vec3, 8> corners;
 
   /**
    * Creates the colliders' base AABB using the corners of the box.
@@ -511,10 +766,10 @@ private:
    * 
    * @return The collider base AABB.
    */
-  const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const std::vector<glm::vec3> &corners)
+  const AxisAlignedBoundingBox createBaseBox(const std::array<glm::vec3, 8> &corners)
   {
-    // Just forward the corners of the box to the AABB constructor, which can generate the AABB accordingly.
-    return std::make_shared<const AxisAlignedBoundingBox>(corners);
+    // The corners are ordered from the min-corner to the max-corner, so the AABB can be made straight from those two.
+    return AxisAlignedBoundingBox(corners.front(), corners.back());
   }
 
   /**
@@ -524,7 +779,7 @@ private:
    * 
    * @return The corners of the box.
    */
-  const std::vector<glm::vec3> createCorners(const std::vector<glm::vec3> &vertices)
+  const std::array<glm::vec3, 8> createCorners(const std::vector<glm::vec3> &vertices)
   {
     // Set the min-corner to the first vertex in the list.
     glm::vec3 minCorner = vertices[0];
@@ -548,8 +803,8 @@ private:
     const glm::vec2 minMaxY(glm::min(minCorner.y, maxCorner.y), glm::max(minCorner.y, maxCorner.y));
     const glm::vec2 minMaxZ(glm::min(minCorner.z, maxCorner.z), glm::max(minCorner.z, maxCorner.z));
 
-    // Define a vector for storing the corners of the collider box.
-    std::vector<glm::vec3> newCorners({});
+    // Define an array for storing the corners of the collider box.
+    std::array<glm::vec3, 8> newCorners;
     // Iterate through the minimum and maximum coordinate values of all the axes
     for (auto x = 0; x < 2; x++)
     {
@@ -558,7 +813,7 @@ private:
         for (auto z = 0; z < 2; z++)
         {
           // The combination of the various min/max values of each axis gives us a coordinate of the box.
-          newCorners.push_back(glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]));
+          newCorners[x * 4 + y * 2 + z] = glm::vec3(minMaxX[x], minMaxY[y], minMaxZ[z]);
         }
       }
     }
@@ -570,7 +825,7 @@ private:
 public:
   BoxColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const glm::vec3 &oppositeCorner1,
       const glm::vec3 &oppositeCorner2)
@@ -584,7 +839,7 @@ public:
 
   BoxColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const std::vector<glm::vec3> &vertices)
       : ColliderShape(
@@ -600,7 +855,7 @@ public:
    * 
    * @return The list of the eight corners.
    */
-  const std::vector<glm::vec3> &getCorners() const
+  const std::array<glm::vec3, 8> &getCorners() const
   {
     return corners;
   }
@@ -634,7 +889,7 @@ public:
 };
 
 /**
- * A collider that has the shape of a sphere.
+ * A collider that has the shape of a cylinder, standing along its y-axis.
  */
 class CylinderColliderShape : public ColliderShape
 {
@@ -652,10 +907,10 @@ private:
    * 
    * @return The collider base AABB.
    */
-  const std::shared_ptr<const AxisAlignedBoundingBox> createBaseBox(const float_t radius, const float_t halfHeight)
+  const AxisAlignedBoundingBox createBaseBox(const float_t radius, const float_t halfHeight)
   {
     // Generates the base AABB by using the negative and positive values of the radius and half-height to get the min/max-corners of the AABB.
-    return std::make_shared<AxisAlignedBoundingBox>(glm::vec3(-radius, -halfHeight, -radius), glm::vec3(radius, halfHeight, radius));
+    return AxisAlignedBoundingBox(glm::vec3(-radius, -halfHeight, -radius), glm::vec3(radius, halfHeight, radius));
   }
 
   /**
@@ -667,28 +922,11 @@ private:
    */
   const float_t calculateRadius(const std::vector<glm::vec3> &vertices)
   {
-    // Set the min-corner to the first vertex in the list.
-    glm::vec3 minCorner = vertices[0];
-    // Set the max-corner to the first vertex in the list.
-    glm::vec3 maxCorner = vertices[0];
-
-    // Iterate through all the vertices.
+    // The radius is the largest distance of a vertex from the axis of the cylinder, which runs along the y-axis.
+    auto radius = 0.0f;
     for (const auto &vertex : vertices)
     {
-      // For each axis of a vertex coordinate...
-      for (auto axis = 0; axis < 3; axis++)
-      {
-        // Store that value if it is the lowest/highest value observed so far.
-        minCorner[axis] = glm::min(minCorner[axis], vertex[axis]);
-        maxCorner[axis] = glm::max(maxCorner[axis], vertex[axis]);
-      }
-    }
-
-    const auto furthestDistances = std::vector<float_t>({std::abs(minCorner.x), std::abs(minCorner.z), std::abs(maxCorner.x), std::abs(maxCorner.z)});
-    auto radius = furthestDistances[0];
-    for (const auto &distance : furthestDistances)
-    {
-      radius = std::max(radius, distance);
+      radius = std::max(radius, glm::length(glm::vec2(vertex.x, vertex.z)));
     }
 
     // Return the radius of the cylinder.
@@ -722,13 +960,13 @@ private:
     }
 
     // Return the half-height of the cylinder.
-    return std::max(std::abs(minCorner.y), std::abs(minCorner.y));
+    return std::max(std::abs(minCorner.y), std::abs(maxCorner.y));
   }
 
 public:
   CylinderColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const float_t &radius,
       const float_t &halfHeight)
@@ -743,17 +981,17 @@ public:
 
   CylinderColliderShape(
       const glm::vec3 &position,
-      const glm::vec3 &rotation,
+      const glm::quat &rotation,
       const glm::vec3 &scale,
       const std::vector<glm::vec3> &vertices)
-      : radius(calculateRadius(vertices)),
-        halfHeight(calculateHalfHeight(vertices)),
-        ColliderShape(
-            ColliderShapeType::BOX,
+      : ColliderShape(
+            ColliderShapeType::CYLINDER,
             position,
             rotation,
             scale,
-            createBaseBox(calculateRadius(vertices), calculateHalfHeight(vertices))) {}
+            createBaseBox(calculateRadius(vertices), calculateHalfHeight(vertices))),
+        radius(calculateRadius(vertices)),
+        halfHeight(calculateHalfHeight(vertices)) {}
 
   /**
    * Get the radius of the collider cylinder.
@@ -805,12 +1043,217 @@ public:
   }
 };
 
+/**
+ * A collider that has the shape of a pill (a capsule), made of every point within its radius of a line segment running
+ * along its y-axis.
+ */
+class PillColliderShape : public ColliderShape
+{
+private:
+  // The radius of the collider.
+  float_t radius;
+  // The half-height of the segment in the middle of the collider, not counting the rounded ends.
+  float_t halfHeight;
+
+  /**
+   * Creates the colliders' base AABB using the radius and half-height of the pill.
+   * 
+   * @param radius      The radius of the pill.
+   * @param halfHeight  The half-height of the segment of the pill.
+   * 
+   * @return The collider base AABB.
+   */
+  const AxisAlignedBoundingBox createBaseBox(const float_t radius, const float_t halfHeight)
+  {
+    // The rounded ends reach out past the segment by the radius.
+    return AxisAlignedBoundingBox(glm::vec3(-radius, -halfHeight - radius, -radius), glm::vec3(radius, halfHeight + radius, radius));
+  }
+
+  /**
+   * Calculates the radius of the collider pill using the given vertices of the model.
+   * 
+   * @param vertices  The vertices of the model.
+   * 
+   * @return The radius of the pill.
+   */
+  const float_t calculateRadius(const std::vector<glm::vec3> &vertices)
+  {
+    // The radius is the largest distance of a vertex from the axis of the pill, the same as a cylinder.
+    auto radius = 0.0f;
+    for (const auto &vertex : vertices)
+    {
+      radius = std::max(radius, glm::length(glm::vec2(vertex.x, vertex.z)));
+    }
+    return radius;
+  }
+
+  /**
+   * Calculates the half-height of the segment of the collider pill using the given vertices of the model, so each vertex
+   *   is within the rounded end of its side of the pill.
+   * 
+   * @param vertices  The vertices of the model.
+   * @param radius    The radius of the pill.
+   * 
+   * @return The half-height of the segment of the pill.
+   */
+  const float_t calculateHalfHeight(const std::vector<glm::vec3> &vertices, const float_t &radius)
+  {
+    auto halfHeight = 0.0f;
+    for (const auto &vertex : vertices)
+    {
+      // The rounded end covers the vertex up to the height where its distance from the axis meets the sphere of the end.
+      const auto distanceFromAxis = glm::length(glm::vec2(vertex.x, vertex.z));
+      const auto endHeight = std::sqrt(std::max(radius * radius - distanceFromAxis * distanceFromAxis, 0.0f));
+      halfHeight = std::max(halfHeight, std::abs(vertex.y) - endHeight);
+    }
+    return halfHeight;
+  }
+
+public:
+  PillColliderShape(
+      const glm::vec3 &position,
+      const glm::quat &rotation,
+      const glm::vec3 &scale,
+      const float_t &radius,
+      const float_t &halfHeight)
+      : ColliderShape(
+            ColliderShapeType::PILL,
+            position,
+            rotation,
+            scale,
+            createBaseBox(radius, halfHeight)),
+        radius(radius),
+        halfHeight(halfHeight) {}
+
+  PillColliderShape(
+      const glm::vec3 &position,
+      const glm::quat &rotation,
+      const glm::vec3 &scale,
+      const std::vector<glm::vec3> &vertices)
+      : ColliderShape(
+            ColliderShapeType::PILL,
+            position,
+            rotation,
+            scale,
+            createBaseBox(calculateRadius(vertices), calculateHalfHeight(vertices, calculateRadius(vertices)))),
+        radius(calculateRadius(vertices)),
+        halfHeight(calculateHalfHeight(vertices, radius)) {}
+
+  /**
+   * Get the radius of the collider pill.
+   * 
+   * @return The radius.
+   */
+  const float_t &getRadius() const
+  {
+    return radius;
+  }
+
+  /**
+   * Get the half-height of the segment of the collider pill.
+   * 
+   * @return The half-height.
+   */
+  const float_t &getHalfHeight() const
+  {
+    return halfHeight;
+  }
+
+  /**
+   * Update the radius and half-height of the collider pill using the given radius and half-height of the new pill.
+   * 
+   * @param newRadius      The radius of the pill.
+   * @param newHalfHeight  The half-height of the segment of the pill.
+   */
+  void update(const float_t &newRadius, const float_t &newHalfHeight)
+  {
+    radius = newRadius;
+    halfHeight = newHalfHeight;
+    // Generate the new base AABB of the collider.
+    updateBaseBox(createBaseBox(newRadius, newHalfHeight));
+  }
+
+  /**
+   * Update the radius and half-height of the collider pill using the given list of vertices of the model.
+   * 
+   * @param newVertices  The list vertices of the model to use to calculate the new radius and half-height.
+   */
+  void update(const std::vector<glm::vec3> &newVertices)
+  {
+    // Generate the new radius of the pill using the given vertices of the model.
+    radius = calculateRadius(newVertices);
+    // Generate the new half-height of the pill using the given vertices of the model and the new radius.
+    halfHeight = calculateHalfHeight(newVertices, radius);
+    // Generate the new base AABB of the collider.
+    updateBaseBox(createBaseBox(radius, halfHeight));
+  }
+};
+
 /**
  * A class that can perform a collision check between all supported collider types.
  */
 class DeepCollisionValidator
 {
 private:
+  /**
+   * Structure for defining a box by its centre, the directions of its sides and half of its size along each of them.
+   */
+  struct OrientedBox
+  {
+    // The centre of the box.
+    glm::vec3 center;
+    // The unit directions of the local x, y and z axes of the box.
+    glm::vec3 axes[3];
+    // Half of the size of the box along each of its axes.
+    glm::vec3 halfExtents;
+  };
+
+  /**
+   * Structure for defining a sphere in world space.
+   */
+  struct WorldSphere
+  {
+    // The centre of the sphere.
+    glm::vec3 center;
+    // The radius of the sphere.
+    float_t radius;
+  };
+
+  /**
+   * Structure for defining a pill in world space, by the ends of its segment and its radius.
+   */
+  struct WorldPill
+  {
+    // The ends of the segment of the pill.
+    glm::vec3 start;
+    glm::vec3 end;
+    // The radius of the pill.
+    float_t radius;
+  };
+
+  /**
+   * Structure for defining a cylinder in world space.
+   */
+  struct WorldCylinder
+  {
+    // The centre of the cylinder.
+    glm::vec3 center;
+    // The unit direction of the axis of the cylinder.
+    glm::vec3 axis;
+    // Half of the height of the cylinder along its axis.
+    float_t halfHeight;
+    // The radius of the cylinder.
+    float_t radius;
+  };
+
+  // The largest number of points the intersection test of convex shapes adds before it gives up, treating the shapes as
+  //   touching, which bounds its cost when the shapes only just touch.
+  static const uint32_t MAX_CONVEX_ITERATIONS = 32;
+
+  // Whether the box-box tests use the separating axis test, instead of checking whether any corner of either box is
+  //   inside the other.
+  static bool separatingAxisBoxTestEnabled;
+
   /**
    * Check if two sphere colliders have interesected/collided with each other.
    * 
@@ -819,75 +1262,600 @@ private:
    * 
    * @return Whether the two sphere colliders have collided or not.
    */
-  static bool haveSphereSphereCollided(const std::shared_ptr<const SphereColliderShape> &sphere1, const std::shared_ptr<const SphereColliderShape> &sphere2)
+  static bool haveSphereSphereCollided(const SphereColliderShape &sphere1, const SphereColliderShape &sphere2)
   {
     // Calculate the scaled radius of the first collider sphere based on the scale of the collider.
-    const auto sphere1ScaledRadius = sphere1->getRadius() * sphere1->getScale().x;
+    const auto sphere1ScaledRadius = sphere1.getRadius() * sphere1.getScale().x;
     // Calculate the scaled radius of the second collider sphere based on the scale of the collider.
-    const auto sphere2ScaledRadius = sphere2->getRadius() * sphere2->getScale().x;
+    const auto sphere2ScaledRadius = sphere2.getRadius() * sphere2.getScale().x;
 
     // Calculate the distance between the centres of the spheres.
-    const auto distanceBetweenSpheres = glm::distance(sphere1->getPosition(), sphere2->getPosition());
+    const auto distanceBetweenSpheres = glm::distance(sphere1.getPosition(), sphere2.getPosition());
     // If the distance between the spheres is greater than the sum of the radii of the two spheres, then the two have not collided.
     return distanceBetweenSpheres <= (sphere1ScaledRadius + sphere2ScaledRadius);
   }
 
   /**
-   * Check if two cylinder colliders have interesected/collided with each other.
+   * Get the box collider as a box in world space, using its transformation matrix.
    * 
-   * @param cylinder1  The first cylinder collider.
-   * @param cylinder2  The second cylinder collider.
+   * @param box  The box collider.
    * 
-   * @return Whether the two cylinder colliders have collided or not.
+   * @return The oriented box.
    */
-  static bool haveCylinderCylinderCollided(const std::shared_ptr<const CylinderColliderShape> &cylinder1, const std::shared_ptr<const CylinderColliderShape> &cylinder2)
+  static OrientedBox getOrientedBox(const BoxColliderShape &box)
   {
-    return false;
+    const auto &transformationMatrix = box.getTransformationMatrix();
+    const auto &baseBox = box.getBaseBox();
+    OrientedBox orientedBox;
+    // The centre of the base AABB is moved along with the box.
+    orientedBox.center = glm::vec3(transformationMatrix * glm::vec4((baseBox.getMinCorner() + baseBox.getMaxCorner()) / 2.0f, 1.0f));
+    // Each column of the transformation matrix is an axis of the box, with its length being the scale along that axis.
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      const auto column = glm::vec3(transformationMatrix[axis]);
+      const auto columnLength = glm::length(column);
+      orientedBox.axes[axis] = column / columnLength;
+      orientedBox.halfExtents[axis] = (baseBox.getMaxCorner()[axis] - baseBox.getMinCorner()[axis]) / 2.0f * columnLength;
+    }
+    return orientedBox;
   }
 
   /**
-   * Check if two box colliders have interesected/collided with each other.
+   * Get the sphere collider as a sphere in world space, with the same scaled radius as the sphere-sphere test.
    * 
-   * @param box1  The first box collider.
-   * @param box2  The second box collider.
+   * @param sphere  The sphere collider.
    * 
-   * @return Whether the two box colliders have collided or not.
+   * @return The sphere in world space.
    */
-  static bool haveBoxBoxCollided(const std::shared_ptr<const BoxColliderShape> &box1, const std::shared_ptr<const BoxColliderShape> &box2)
+  static WorldSphere getWorldShape(const SphereColliderShape &sphere)
   {
-    // Get the transformation matrix of the first collider box.
-    const auto box1TransformationMatrix = glm::translate(box1->getPosition()) * glm::toMat4(glm::quat(box1->getRotation())) * glm::scale(box1->getScale()) * glm::mat4();
-    // Calculate the inverse of the first boxes' transformation matrix.
-    const auto box1InverseTransformationMatrix = glm::inverse(box1TransformationMatrix);
+    return {sphere.getPosition(), sphere.getRadius() * sphere.getScale().x};
+  }
 
-    // Get the transformation matrix of the second collider box.
-    const auto box2TransformationMatrix = glm::translate(box2->getPosition()) * glm::toMat4(glm::quat(box2->getRotation())) * glm::scale(box2->getScale()) * glm::mat4();
-    // Calculate the inverse of the second boxes' transformation matrix.
-    const auto box2InverseTransformationMatrix = glm::inverse(box2TransformationMatrix);
+  /**
+   * Get the box collider as a box in world space.
+   * 
+   * @param box  The box collider.
+   * 
+   * @return The oriented box.
+   */
+  static OrientedBox getWorldShape(const BoxColliderShape &box)
+  {
+    return getOrientedBox(box);
+  }
+
+  /**
+   * Get the pill collider as a pill in world space. The radius is scaled by the larger of the scales across the axis, so
+   *   the pill only ever grows to cover an uneven scale.
+   * 
+   * @param pill  The pill collider.
+   * 
+   * @return The pill in world space.
+   */
+  static WorldPill getWorldShape(const PillColliderShape &pill)
+  {
+    const auto &transformationMatrix = pill.getTransformationMatrix();
+    return {glm::vec3(transformationMatrix * glm::vec4(0.0f, -pill.getHalfHeight(), 0.0f, 1.0f)),
+            glm::vec3(transformationMatrix * glm::vec4(0.0f, pill.getHalfHeight(), 0.0f, 1.0f)),
+            pill.getRadius() * glm::max(glm::abs(pill.getScale().x), glm::abs(pill.getScale().z))};
+  }
+
+  /**
+   * Get the cylinder collider as a cylinder in world space. The radius is scaled by the larger of the scales across the
+   *   axis, the same as the pill.
+   * 
+   * @param cylinder  The cylinder collider.
+   * 
+   * @return The cylinder in world space.
+   */
+  static WorldCylinder getWorldShape(const CylinderColliderShape &cylinder)
+  {
+    const auto &transformationMatrix = cylinder.getTransformationMatrix();
+    const auto axis = glm::vec3(transformationMatrix[1]);
+    const auto axisLength = glm::length(axis);
+    return {glm::vec3(transformationMatrix[3]), axis / axisLength, cylinder.getHalfHeight() * axisLength,
+            cylinder.getRadius() * glm::max(glm::abs(cylinder.getScale().x), glm::abs(cylinder.getScale().z))};
+  }
+
+  /**
+   * Get the points of the shapes furthest along the given direction, which is all the intersection test of convex shapes
+   *   needs to know about them.
+   * 
+   * @param shape      The shape.
+   * @param direction  The direction, which doesn't need to be a unit direction.
+   * 
+   * @return The furthest point.
+   */
+  static glm::vec3 getSupportPoint(const WorldSphere &sphere, const glm::vec3 &direction)
+  {
+    return sphere.center + glm::normalize(direction) * sphere.radius;
+  }
+
+  static glm::vec3 getSupportPoint(const OrientedBox &box, const glm::vec3 &direction)
+  {
+    auto point = box.center;
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      point += box.axes[axis] * (glm::dot(direction, box.axes[axis]) >= 0.0f ? box.halfExtents[axis] : -box.halfExtents[axis]);
+    }
+    return point;
+  }
+
+  static glm::vec3 getSupportPoint(const WorldPill &pill, const glm::vec3 &direction)
+  {
+    return (glm::dot(direction, pill.end - pill.start) >= 0.0f ? pill.end : pill.start) + glm::normalize(direction) * pill.radius;
+  }
+
+  static glm::vec3 getSupportPoint(const WorldCylinder &cylinder, const glm::vec3 &direction)
+  {
+    const auto axialDistance = glm::dot(direction, cylinder.axis);
+    auto point = cylinder.center + cylinder.axis * (axialDistance >= 0.0f ? cylinder.halfHeight : -cylinder.halfHeight);
+    // Go out to the rim in the direction across the axis, if the direction isn't along the axis.
+    const auto radialDirection = direction - cylinder.axis * axialDistance;
+    const auto radialLength = glm::length(radialDirection);
+    if (radialLength > 0.000001f)
+    {
+      point += radialDirection * (cylinder.radius / radialLength);
+    }
+    return point;
+  }
+
+  /**
+   * Get the point of a shape all the others are found around, to start the intersection test of convex shapes with.
+   * 
+   * @param shape  The shape.
+   * 
+   * @return The centre of the shape.
+   */
+  static glm::vec3 getCenter(const WorldSphere &sphere) { return sphere.center; }
+  static glm::vec3 getCenter(const OrientedBox &box) { return box.center; }
+  static glm::vec3 getCenter(const WorldPill &pill) { return (pill.start + pill.end) / 2.0f; }
+  static glm::vec3 getCenter(const WorldCylinder &cylinder) { return cylinder.center; }
+
+  /**
+   * Reduce the simplex of the intersection test of convex shapes to the part of it closest to the origin, and find the
+   *   direction to look for the next point in. The newest point comes first in the simplex.
+   * 
+   * @param simplex       The points of the simplex, updated to the ones kept.
+   * @param pointsCount   The number of points of the simplex, updated to the number kept.
+   * @param direction     The direction to store the direction towards the origin to.
+   * 
+   * @return Whether the simplex holds the origin, which means the shapes intersect.
+   */
+  static bool reduceSimplex(glm::vec3 (&simplex)[4], uint32_t &pointsCount, glm::vec3 &direction)
+  {
+    const auto a = simplex[0];
+    const auto ao = -a;
+    if (pointsCount == 2)
+    {
+      // A line, keeping the part of it towards the origin.
+      const auto ab = simplex[1] - a;
+      if (glm::dot(ab, ao) > 0.0f)
+      {
+        direction = glm::cross(glm::cross(ab, ao), ab);
+      }
+      else
+      {
+        pointsCount = 1;
+        direction = ao;
+      }
+    }
+    else if (pointsCount == 3)
+    {
+      // A triangle, keeping the edge or the side of the face towards the origin.
+      const auto b = simplex[1], c = simplex[2];
+      const auto ab = b - a, ac = c - a;
+      const auto abc = glm::cross(ab, ac);
+      if (glm::dot(glm::cross(abc, ac), ao) > 0.0f)
+      {
+        if (glm::dot(ac, ao) > 0.0f)
+        {
+          simplex[1] = c;
+          pointsCount = 2;
+          direction = glm::cross(glm::cross(ac, ao), ac);
+        }
+        else
+        {
+          pointsCount = 2;
+          return reduceSimplex(simplex, pointsCount, direction);
+        }
+      }
+      else if (glm::dot(glm::cross(ab, abc), ao) > 0.0f)
+      {
+        pointsCount = 2;
+        return reduceSimplex(simplex, pointsCount, direction);
+      }
+      else if (glm::dot(abc, ao) > 0.0f)
+      {
+        direction = abc;
+      }
+      else
+      {
+        simplex[1] = c;
+        simplex[2] = b;
+        direction = -abc;
+      }
+    }
+    else
+    {
+      // A tetrahedron, keeping the face towards the origin if there is one, or holding the origin otherwise.
+      const auto b = simplex[1], c = simplex[2], d = simplex[3];
+      const auto ab = b - a, ac = c - a, ad = d - a;
+      pointsCount = 3;
+      if (glm::dot(glm::cross(ab, ac), ao) > 0.0f)
+      {
+        return reduceSimplex(simplex, pointsCount, direction);
+      }
+      if (glm::dot(glm::cross(ac, ad), ao) > 0.0f)
+      {
+        simplex[1] = c;
+        simplex[2] = d;
+        return reduceSimplex(simplex, pointsCount, direction);
+      }
+      if (glm::dot(glm::cross(ad, ab), ao) > 0.0f)
+      {
+        simplex[1] = d;
+        simplex[2] = b;
+        return reduceSimplex(simplex, pointsCount, direction);
+      }
+      pointsCount = 4;
+      return true;
+    }
+    // A direction of zero means the origin is on the simplex, so the shapes touch.
+    return glm::dot(direction, direction) < 0.0000001f;
+  }
+
+  /**
+   * Check if two convex shapes have intersected/collided with each other, using the GJK algorithm. It looks for a simplex
+   *   of points of the Minkowski difference of the shapes holding the origin, using only the furthest points of the shapes
+   *   along the directions it picks, and is bounded to a fixed number of points.
+   * 
+   * @param shape1  The first shape in world space.
+   * @param shape2  The second shape in world space.
+   * 
+   * @return Whether the two shapes have collided or not.
+   */
+  template <typename WorldShape1, typename WorldShape2>
+  static bool haveConvexShapesCollided(const WorldShape1 &shape1, const WorldShape2 &shape2)
+  {
+    const auto getDifferenceSupportPoint = [&](const glm::vec3 &direction) {
+      return getSupportPoint(shape1, direction) - getSupportPoint(shape2, -direction);
+    };
+
+    auto direction = getCenter(shape2) - getCenter(shape1);
+    if (glm::dot(direction, direction) < 0.0000001f)
+    {
+      direction = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+    glm::vec3 simplex[4] = {getDifferenceSupportPoint(direction)};
+    uint32_t pointsCount = 1;
+    direction = -simplex[0];
+    for (uint32_t i = 0; i < MAX_CONVEX_ITERATIONS; i++)
+    {
+      if (glm::dot(direction, direction) < 0.0000001f)
+      {
+        return true;
+      }
+      const auto point = getDifferenceSupportPoint(direction);
+      // The furthest point doesn't get past the origin, so the origin is outside the difference and the shapes are apart.
+      if (glm::dot(point, direction) < 0.0f)
+      {
+        return false;
+      }
+      for (auto j = pointsCount; j > 0; j--)
+      {
+        simplex[j] = simplex[j - 1];
+      }
+      simplex[0] = point;
+      pointsCount++;
+      if (reduceSimplex(simplex, pointsCount, direction))
+      {
+        return true;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Check if two collider shapes have intersected/collided with each other, using the intersection test of convex shapes,
+   *   for the pairs that don't have a closed form test.
+   * 
+   * @param shape1  The first collider shape.
+   * @param shape2  The second collider shape.
+   * 
+   * @return Whether the two collider shapes have collided or not.
+   */
+  template <typename Shape1, typename Shape2>
+  static bool haveConvexCollidersCollided(const Shape1 &shape1, const Shape2 &shape2)
+  {
+    return haveConvexShapesCollided(getWorldShape(shape1), getWorldShape(shape2));
+  }
+
+  /**
+   * Get the point on a segment closest to the given point.
+   * 
+   * @param start  The start of the segment.
+   * @param end    The end of the segment.
+   * @param point  The point.
+   * 
+   * @return The closest point on the segment.
+   */
+  static glm::vec3 getClosestSegmentPoint(const glm::vec3 &start, const glm::vec3 &end, const glm::vec3 &point)
+  {
+    const auto segment = end - start;
+    const auto segmentLengthSquared = glm::dot(segment, segment);
+    if (segmentLengthSquared <= 0.0f)
+    {
+      return start;
+    }
+    return start + segment * glm::clamp(glm::dot(point - start, segment) / segmentLengthSquared, 0.0f, 1.0f);
+  }
+
+  /**
+   * Get the squared distance between the closest points of two segments, solving for the point along each of them in
+   *   closed form.
+   * 
+   * @param start1  The start of the first segment.
+   * @param end1    The end of the first segment.
+   * @param start2  The start of the second segment.
+   * @param end2    The end of the second segment.
+   * 
+   * @return The squared distance between the segments.
+   */
+  static float_t getSegmentsDistanceSquared(const glm::vec3 &start1, const glm::vec3 &end1, const glm::vec3 &start2, const glm::vec3 &end2)
+  {
+    const auto segment1 = end1 - start1, segment2 = end2 - start2, offset = start1 - start2;
+    const auto a = glm::dot(segment1, segment1), e = glm::dot(segment2, segment2), f = glm::dot(segment2, offset);
+    auto s = 0.0f, t = 0.0f;
+    if (a <= 0.000001f && e <= 0.000001f)
+    {
+      // Both segments are points.
+      return glm::dot(offset, offset);
+    }
+    if (a <= 0.000001f)
+    {
+      // The first segment is a point.
+      t = glm::clamp(f / e, 0.0f, 1.0f);
+    }
+    else
+    {
+      const auto c = glm::dot(segment1, offset);
+      if (e <= 0.000001f)
+      {
+        // The second segment is a point.
+        s = glm::clamp(-c / a, 0.0f, 1.0f);
+      }
+      else
+      {
+        // Find the closest point along the first segment to the line of the second, unless they're parallel, then the
+        //   point along the second segment closest to it, clamping both back onto the segments.
+        const auto b = glm::dot(segment1, segment2);
+        const auto denominator = a * e - b * b;
+        s = denominator > 0.0f ? glm::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+        t = (b * s + f) / e;
+        if (t < 0.0f)
+        {
+          t = 0.0f;
+          s = glm::clamp(-c / a, 0.0f, 1.0f);
+        }
+        else if (t > 1.0f)
+        {
+          t = 1.0f;
+          s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+        }
+      }
+    }
+    const auto difference = (start1 + segment1 * s) - (start2 + segment2 * t);
+    return glm::dot(difference, difference);
+  }
+
+  /**
+   * Check if a pill collider and a sphere collider have interesected/collided with each other, by the distance of the
+   *   centre of the sphere from the segment of the pill.
+   * 
+   * @param pill    The pill collider.
+   * @param sphere  The sphere collider.
+   * 
+   * @return Whether the pill and sphere colliders have collided or not.
+   */
+  static bool havePillSphereCollided(const PillColliderShape &pill, const SphereColliderShape &sphere)
+  {
+    const auto worldPill = getWorldShape(pill);
+    const auto worldSphere = getWorldShape(sphere);
+    return glm::distance(getClosestSegmentPoint(worldPill.start, worldPill.end, worldSphere.center), worldSphere.center) <= worldPill.radius + worldSphere.radius;
+  }
+
+  /**
+   * Check if two pill colliders have interesected/collided with each other, by the distance between their segments.
+   * 
+   * @param pill1  The first pill collider.
+   * @param pill2  The second pill collider.
+   * 
+   * @return Whether the two pill colliders have collided or not.
+   */
+  static bool havePillPillCollided(const PillColliderShape &pill1, const PillColliderShape &pill2)
+  {
+    const auto worldPill1 = getWorldShape(pill1);
+    const auto worldPill2 = getWorldShape(pill2);
+    const auto radiiSum = worldPill1.radius + worldPill2.radius;
+    return getSegmentsDistanceSquared(worldPill1.start, worldPill1.end, worldPill2.start, worldPill2.end) <= radiiSum * radiiSum;
+  }
+
+  /**
+   * Check if a cylinder collider and a sphere collider have interesected/collided with each other, by the distance of the
+   *   centre of the sphere from the point of the cylinder closest to it.
+   * 
+   * @param cylinder  The cylinder collider.
+   * @param sphere    The sphere collider.
+   * 
+   * @return Whether the cylinder and sphere colliders have collided or not.
+   */
+  static bool haveCylinderSphereCollided(const CylinderColliderShape &cylinder, const SphereColliderShape &sphere)
+  {
+    const auto worldCylinder = getWorldShape(cylinder);
+    const auto worldSphere = getWorldShape(sphere);
+    // Split the offset of the sphere into the parts along and across the axis, and clamp each to the cylinder.
+    const auto offset = worldSphere.center - worldCylinder.center;
+    const auto axialDistance = glm::dot(offset, worldCylinder.axis);
+    const auto radialOffset = offset - worldCylinder.axis * axialDistance;
+    const auto radialDistance = glm::length(radialOffset);
+    auto closestPoint = worldCylinder.center + worldCylinder.axis * glm::clamp(axialDistance, -worldCylinder.halfHeight, worldCylinder.halfHeight);
+    if (radialDistance > worldCylinder.radius)
+    {
+      closestPoint += radialOffset * (worldCylinder.radius / radialDistance);
+    }
+    else
+    {
+      closestPoint += radialOffset;
+    }
+    return glm::distance(closestPoint, worldSphere.center) <= worldSphere.radius;
+  }
+
+  /**
+   * Check if two collider shapes have intersected/collided with each other, with a test written for the shapes the other
+   *   way around.
+   * 
+   * @param shape1  The first collider shape.
+   * @param shape2  The second collider shape.
+   * 
+   * @return Whether the two collider shapes have collided or not.
+   */
+  template <typename Shape1, typename Shape2, bool (*test)(const Shape2 &, const Shape1 &)>
+  static bool haveSwappedCollided(const Shape1 &shape1, const Shape2 &shape2)
+  {
+    return test(shape2, shape1);
+  }
+
+  /**
+   * Check if two box colliders have interesected/collided with each other, using the separating axis test. Two boxes
+   *   don't overlap only if they can be split apart along one of fifteen axes: the three axes of each box, and the nine
+   *   cross products of an axis of one box with an axis of the other. The test stops at the first axis found splitting them.
+   * 
+   * @param box1  The first box collider.
+   * @param box2  The second box collider.
+   * 
+   * @return Whether the two box colliders have collided or not.
+   */
+  static bool haveBoxBoxSeparatingAxisCollided(const BoxColliderShape &box1, const BoxColliderShape &box2)
+  {
+    const auto orientedBox1 = getOrientedBox(box1);
+    const auto orientedBox2 = getOrientedBox(box2);
+    const auto &halfExtents1 = orientedBox1.halfExtents;
+    const auto &halfExtents2 = orientedBox2.halfExtents;
+
+    // Express the axes of the second box and the offset between the centres in the space of the first box. A small value
+    //   is added to the absolute rotations so nearly parallel axes, whose cross products are close to zero, don't produce
+    //   a false split from rounding errors.
+    glm::mat3 rotation, absoluteRotation;
+    for (auto i = 0; i < 3; i++)
+    {
+      for (auto j = 0; j < 3; j++)
+      {
+        rotation[i][j] = glm::dot(orientedBox1.axes[i], orientedBox2.axes[j]);
+        absoluteRotation[i][j] = glm::abs(rotation[i][j]) + 0.00001f;
+      }
+    }
+    const auto centerOffset = orientedBox2.center - orientedBox1.center;
+    const glm::vec3 offset(glm::dot(centerOffset, orientedBox1.axes[0]), glm::dot(centerOffset, orientedBox1.axes[1]), glm::dot(centerOffset, orientedBox1.axes[2]));
+
+    // Test the axes of the first box.
+    for (auto i = 0; i < 3; i++)
+    {
+      const auto radius2 = halfExtents2[0] * absoluteRotation[i][0] + halfExtents2[1] * absoluteRotation[i][1] + halfExtents2[2] * absoluteRotation[i][2];
+      if (glm::abs(offset[i]) > halfExtents1[i] + radius2)
+      {
+        return false;
+      }
+    }
+
+    // Test the axes of the second box.
+    for (auto j = 0; j < 3; j++)
+    {
+      const auto radius1 = halfExtents1[0] * absoluteRotation[0][j] + halfExtents1[1] * absoluteRotation[1][j] + halfExtents1[2] * absoluteRotation[2][j];
+      const auto distance = offset[0] * rotation[0][j] + offset[1] * rotation[1][j] + offset[2] * rotation[2][j];
+      if (glm::abs(distance) > radius1 + halfExtents2[j])
+      {
+        return false;
+      }
+    }
+
+    // Test the cross products of each axis of the first box with each axis of the second box.
+    for (auto i = 0; i < 3; i++)
+    {
+      const auto i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+      for (auto j = 0; j < 3; j++)
+      {
+        const auto j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+        const auto radius1 = halfExtents1[i1] * absoluteRotation[i2][j] + halfExtents1[i2] * absoluteRotation[i1][j];
+        const auto radius2 = halfExtents2[j1] * absoluteRotation[i][j2] + halfExtents2[j2] * absoluteRotation[i][j1];
+        const auto distance = offset[i2] * rotation[i1][j] - offset[i1] * rotation[i2][j];
+        if (glm::abs(distance) > radius1 + radius2)
+        {
+          return false;
+        }
+      }
+    }
+
+    // No axis splits the boxes, so they have collided.
+    return true;
+  }
+
+  /**
+   * Check if two box colliders have interesected/collided with each other, using the selected box-box test.
+   * 
+   * @param box1  The first box collider.
+   * @param box2  The second box collider.
+   * 
+   * @return Whether the two box colliders have collided or not.
+   */
+  static bool haveBoxBoxCollided(const BoxColliderShape &box1, const BoxColliderShape &box2)
+  {
+    return separatingAxisBoxTestEnabled ? haveBoxBoxSeparatingAxisCollided(box1, box2) : haveBoxBoxCornersCollided(box1, box2);
+  }
+
+  /**
+   * Check if two box colliders have interesected/collided with each other, by checking whether any corner of either box
+   *   is inside the other. This misses boxes that only cross at their edges, and is only kept to compare against the
+   *   separating axis test.
+   * 
+   * @param box1  The first box collider.
+   * @param box2  The second box collider.
+   * 
+   * @return Whether the two box colliders have collided or not.
+   */
+  static bool haveBoxBoxCornersCollided(const BoxColliderShape &box1, const BoxColliderShape &box2)
+  {
+    // Get the transformation matrix of the first collider box, and its inverse.
+    const auto &box1TransformationMatrix = box1.getTransformationMatrix();
+    const auto &box1InverseTransformationMatrix = box1.getInverseTransformationMatrix();
+
+    // Get the transformation matrix of the second collider box, and its inverse.
+    const auto &box2TransformationMatrix = box2.getTransformationMatrix();
+    const auto &box2InverseTransformationMatrix = box2.getInverseTransformationMatrix();
 
     // Get the corners of the first box.
-    const auto box1Corners = box1->getCorners();
+    const auto &box1Corners = box1.getCorners();
     // Define a vector for storing the transformed corners of the first box.
-    std::vector<glm::vec3> box1TransformedCorners({});
+    std::array<glm::vec3, 8> box1TransformedCorners;
     // Iterate through the corners of the first box.
-    for (const auto &box1Corner : box1Corners)
+    for (size_t i = 0; i < box1Corners.size(); i++)
     {
       // Transform the corner using the boxes' transformation matrix and add it to the result list.
-      box1TransformedCorners.push_back(glm::vec3(box1TransformationMatrix * glm::vec4(box1Corner, 1.0f)));
+      box1TransformedCorners[i] = glm::vec3(box1TransformationMatrix * glm::vec4(box1Corners[i], 1.0f));
     }
 
-    const auto box2Corners = box2->getCorners();
+    const auto &box2Corners = box2.getCorners();
     // Define a vector for storing the transformed corners of the first box.
-    std::vector<glm::vec3> box2TransformedCorners({});
+    std::array<glm::vec3, 8> box2TransformedCorners;
     // Iterate through the corners of the second box.
-    for (const auto &box2Corner : box2Corners)
+    for (size_t i = 0; i < box2Corners.size(); i++)
     {
       // Transform the corner using the boxes' transformation matrix and add it to the result list.
-      box2TransformedCorners.push_back(glm::vec3(box2TransformationMatrix * glm::vec4(box2Corner, 1.0f)));
+      box2TransformedCorners[i] = glm::vec3(box2TransformationMatrix * glm::vec4(box2Corners[i], 1.0f));
     }
 
-    // Create an AABB using the corners of the second box (doing this just as a way to get the min/max-corners).
-    const AxisAlignedBoundingBox box2AABB(box2->getCorners());
+    // The base AABB of the second box has the same min/max-corners as the box itself.
+    const auto &box2AABB = box2.getBaseBox();
     // Get the min-corner of the second box.
     const auto box2AABBMinCorners = box2AABB.getMinCorner();
     // Get the max-corner of the second box.
@@ -908,8 +1876,8 @@ private:
       }
     }
 
-    // Create an AABB using the corners of the first box (doing this just as a way to get the min/max-corners).
-    const AxisAlignedBoundingBox box1AABB(box1->getCorners());
+    // The base AABB of the first box has the same min/max-corners as the box itself.
+    const auto &box1AABB = box1.getBaseBox();
     // Get the min-corner of the first box.
     const auto box1AABBMinCorners = box1AABB.getMinCorner();
     // Get the max-corner of the first box.
@@ -942,23 +1910,21 @@ private:
    * 
    * @return Whether the box and sphere colliders have collided or not.
    */
-  static bool haveBoxSphereCollided(const std::shared_ptr<const BoxColliderShape> &box, const std::shared_ptr<const SphereColliderShape> &sphere)
+  static bool haveBoxSphereCollided(const BoxColliderShape &box, const SphereColliderShape &sphere)
   {
-    // Get the transformation matrix of the collider box.
-    const auto boxTransformationMatrix = glm::translate(box->getPosition()) * glm::toMat4(glm::quat(box->getRotation())) * glm::scale(box->getScale());
-    // Calculate the inverse of the boxes' transformation matrix.
-    const auto boxInverseTransformationMatrix = glm::inverse(boxTransformationMatrix);
-    // Create an AABB using the corners of the box (doing this just as a way to get the min/max-corners).
-    const AxisAlignedBoundingBox boxAABB(box->getCorners());
+    // Get the inverse of the boxes' transformation matrix.
+    const auto &boxInverseTransformationMatrix = box.getInverseTransformationMatrix();
+    // The base AABB of the box has the same min/max-corners as the box itself.
+    const auto &boxAABB = box.getBaseBox();
     // Get the min-corner of the box.
     const auto boxAABBMinCorners = boxAABB.getMinCorner();
     // Get the max-corner of the box.
     const auto boxAABBMaxCorners = boxAABB.getMaxCorner();
 
     // Calculate the scaled radius of the collider sphere based on the scale of the collider.
-    const auto sphereScaledRadius = glm::length(glm::inverse(glm::scale(box->getScale())) * glm::scale(sphere->getScale()) * glm::vec4(glm::vec3(sphere->getRadius()), 1.0f));
+    const auto sphereScaledRadius = glm::length(glm::scale(1.0f / box.getScale()) * glm::scale(sphere.getScale()) * glm::vec4(glm::vec3(sphere.getRadius()), 1.0f));
     // Calculate the position of the wphere w.r.t the box using the boxes' inverse transformation matrix.
-    const auto spherePositionInBoxSpace = glm::vec3(boxInverseTransformationMatrix * glm::vec4(sphere->getPosition(), 1.0f));
+    const auto spherePositionInBoxSpace = glm::vec3(boxInverseTransformationMatrix * glm::vec4(sphere.getPosition(), 1.0f));
     // Calculate the point on the box that is closest to the sphere.
     const auto boxPointClosesToSphere = glm::vec3(
         glm::max(boxAABBMinCorners.x, glm::min(spherePositionInBoxSpace.x, boxAABBMaxCorners.x)),
@@ -972,72 +1938,721 @@ private:
     return distanceBetweenClosestBoxPointAndSphereCenter <= sphereScaledRadius;
   }
 
-public:
   /**
-   * Checks if the two given collider shapes have intersected/collided with each other.
+   * Find the earliest time a gap that changes convexly over the motion closes, such as the distance between a convex
+   *   shape and a point moving in a straight line. The smallest gap is found with a ternary search since the gap only
+   *   falls then rises, and the time it first closes is then narrowed down with a bisection before it.
    * 
-   * @param shape1              The first collider shape.
-   * @param shape2              The second collider shape.
-   * @param deepCollisionCheck  Whether to perform a deep collision check or not. If not, we just check if the
-   *                              AABBs of the two colliders have collided or not.
+   * @param getGap        The function giving the gap at a time between 0 and 1, which is 0 or less when touching.
+   * @param timeOfImpact  The time to store the earliest time the gap closes at.
    * 
-   * @return Whether the two colldier shapes have collided or not.
+   * @return Whether the gap closes during the motion.
    */
-  static bool haveShapesCollided(const std::shared_ptr<const ColliderShape> &shape1, const std::shared_ptr<const ColliderShape> &shape2, const bool &deepCollisionCheck)
+  template <typename F>
+  static bool getConvexGapTimeOfImpact(const F &getGap, float_t &timeOfImpact)
   {
-    // Check if the AABBs of the two shapes have collided or not.
-    if (!shape1->getTransformedBox()->hasCollided(*(shape2->getTransformedBox())))
-    {
-      // If not, no need to do a deeper check, so just return false.
-      return false;
-    }
-    // If a deep collision check wasn't request, then just return true since the shallow check has passed.
-    if (!deepCollisionCheck)
+    // Check if the gap is already closed at the start.
+    if (getGap(0.0f) <= 0.0f)
     {
+      timeOfImpact = 0.0f;
       return true;
     }
 
-    // Calculate a mask to determine what shape collision function is required.
-    const auto shapeTypeMask = (shape1->getType()) + (2 * shape2->getType());
-    // Put the mask through a switch case.
-    switch (shapeTypeMask)
+    // Find when the gap is smallest.
+    auto low = 0.0f, high = 1.0f;
+    for (auto i = 0; i < 32; i++)
+    {
+      const auto third1 = low + (high - low) / 3.0f;
+      const auto third2 = high - (high - low) / 3.0f;
+      if (getGap(third1) < getGap(third2))
+      {
+        high = third2;
+      }
+      else
+      {
+        low = third1;
+      }
+    }
+    const auto closestTime = (low + high) / 2.0f;
+    if (getGap(closestTime) > 0.0f)
     {
-    case 0:
-      // Both colliders are a sphere. Perform the check accordingly.
-      return haveSphereSphereCollided(std::dynamic_pointer_cast<const SphereColliderShape>(shape1), std::dynamic_pointer_cast<const SphereColliderShape>(shape2));
-    case 1:
-      // First collider is a box, second is a sphere. Perform the check accordingly.
-      return haveBoxSphereCollided(std::dynamic_pointer_cast<const BoxColliderShape>(shape1), std::dynamic_pointer_cast<const SphereColliderShape>(shape2));
-    case 2:
-      // First collider is a sphere, second is a box. Perform the check accordingly.
-      return haveBoxSphereCollided(std::dynamic_pointer_cast<const BoxColliderShape>(shape2), std::dynamic_pointer_cast<const SphereColliderShape>(shape1));
-    case 3:
-      // Both colliders are a box. Perform the check accordingly.
-      return haveBoxBoxCollided(std::dynamic_pointer_cast<const BoxColliderShape>(shape1), std::dynamic_pointer_cast<const BoxColliderShape>(shape2));
-    default:
-      // Can't determine the shapes, so say the two haven't collided.
       return false;
     }
+
+    // Find when the gap closes before it's smallest, keeping the time on the closed side.
+    low = 0.0f;
+    high = closestTime;
+    for (auto i = 0; i < 24; i++)
+    {
+      const auto middle = (low + high) / 2.0f;
+      if (getGap(middle) <= 0.0f)
+      {
+        high = middle;
+      }
+      else
+      {
+        low = middle;
+      }
+    }
+    timeOfImpact = high;
+    return true;
   }
-};
 
-/**
- * Class for containing the details of the collider.
- */
+  /**
+   * Find the earliest time a sphere moving in a straight line touches another sphere, by solving for when the distance
+   *   between their centres equals the sum of their radii.
+   * 
+   * @param sphere1       The moving sphere collider, at the end of its motion.
+   * @param motion1       The motion of the first sphere collider.
+   * @param sphere2       The other sphere collider.
+   * @param timeOfImpact  The time to store the earliest time of impact at.
+   * 
+   * @return Whether the spheres touch during the motion.
+   */
+  static bool getSphereSphereTimeOfImpact(const SphereColliderShape &sphere1, const glm::vec3 &motion1, const SphereColliderShape &sphere2, float_t &timeOfImpact)
+  {
+    const auto radiiSum = sphere1.getRadius() * sphere1.getScale().x + sphere2.getRadius() * sphere2.getScale().x;
+    // The offset from the second sphere to the first at the start of the motion.
+    const auto startOffset = (sphere1.getPosition() - motion1) - sphere2.getPosition();
+    const auto c = glm::dot(startOffset, startOffset) - radiiSum * radiiSum;
+    if (c <= 0.0f)
+    {
+      timeOfImpact = 0.0f;
+      return true;
+    }
+    // Solve |startOffset + t * motion1| = radiiSum for the smaller root.
+    const auto a = glm::dot(motion1, motion1);
+    const auto b = glm::dot(startOffset, motion1);
+    const auto discriminant = b * b - a * c;
+    if (a <= 0.0f || b >= 0.0f || discriminant < 0.0f)
+    {
+      return false;
+    }
+    timeOfImpact = (-b - std::sqrt(discriminant)) / a;
+    return timeOfImpact <= 1.0f;
+  }
+
+  /**
+   * Find the earliest time a box and a sphere touch while the sphere moves in a straight line relative to the box. The
+   *   path of the sphere's centre is taken into the space of the box, where the distance from it to the box is convex.
+   * 
+   * @param box                  The box collider.
+   * @param sphere               The sphere collider, at the end of the motion.
+   * @param sphereRelativeMotion The motion of the sphere collider relative to the box collider.
+   * @param timeOfImpact         The time to store the earliest time of impact at.
+   * 
+   * @return Whether the box and the sphere touch during the motion.
+   */
+  static bool getBoxSphereTimeOfImpact(const BoxColliderShape &box, const SphereColliderShape &sphere, const glm::vec3 &sphereRelativeMotion, float_t &timeOfImpact)
+  {
+    // Get the inverse transformation matrix of the box, and the corners of the box space AABB, the same as the overlap test.
+    const auto &boxInverseTransformationMatrix = box.getInverseTransformationMatrix();
+    const auto &boxAABB = box.getBaseBox();
+    const auto sphereScaledRadius = glm::length(glm::scale(1.0f / box.getScale()) * glm::scale(sphere.getScale()) * glm::vec4(glm::vec3(sphere.getRadius()), 1.0f));
+
+    // Take the start and end of the path of the sphere's centre into the space of the box.
+    const auto startPosition = glm::vec3(boxInverseTransformationMatrix * glm::vec4(sphere.getPosition() - sphereRelativeMotion, 1.0f));
+    const auto endPosition = glm::vec3(boxInverseTransformationMatrix * glm::vec4(sphere.getPosition(), 1.0f));
+    return getConvexGapTimeOfImpact([&](const float_t &time) {
+      const auto position = glm::mix(startPosition, endPosition, time);
+      return glm::distance(glm::clamp(position, boxAABB.getMinCorner(), boxAABB.getMaxCorner()), position) - sphereScaledRadius;
+    },
+                                    timeOfImpact);
+  }
+
+  /**
+   * Find the earliest time a collider shape moving in a straight line touches another one, by testing for an overlap at
+   *   steps along the motion no longer than half the smallest side of the AABB of either shape, so neither can pass
+   *   through the other in between. Used for the pairs of shapes without a closed form swept test.
+   * 
+   * @param shape1        The moving collider shape, at the end of its motion.
+   * @param motion1       The motion of the first collider shape.
+   * @param shape2        The other collider shape.
+   * @param timeOfImpact  The time to store the earliest step the shapes overlap at.
+   * 
+   * @return Whether the shapes overlap during the motion.
+   */
+  template <typename Shape1, typename Shape2, bool (*test)(const Shape1 &, const Shape2 &)>
+  static bool getSteppedTimeOfImpact(const Shape1 &shape1, const glm::vec3 &motion1, const Shape2 &shape2, float_t &timeOfImpact)
+  {
+    const auto shape1Size = shape1.getTransformedBox().getMaxCorner() - shape1.getTransformedBox().getMinCorner();
+    const auto shape2Size = shape2.getTransformedBox().getMaxCorner() - shape2.getTransformedBox().getMinCorner();
+    const auto smallestSide = glm::max(glm::min(glm::min(glm::min(shape1Size.x, shape1Size.y), shape1Size.z), glm::min(glm::min(shape2Size.x, shape2Size.y), shape2Size.z)), 0.001f);
+    const auto stepsCount = std::max(1, static_cast<int32_t>(std::ceil(glm::length(motion1) / (smallestSide / 2.0f))));
+
+    // Test a copy of the moving shape at every step, starting from the start of the motion, so the shape itself stays put.
+    Shape1 steppedShape1(shape1);
+    for (auto step = 0; step <= stepsCount; step++)
+    {
+      const auto time = static_cast<float_t>(step) / stepsCount;
+      steppedShape1.updateTransformations(shape1.getPosition() - motion1 * (1.0f - time), shape1.getRotation(), shape1.getScale());
+      if (test(steppedShape1, shape2))
+      {
+        timeOfImpact = time;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Check if a sphere collider and a box collider have interesected/collided with each other.
+   * 
+   * @param sphere  The sphere collider.
+   * @param box     The box collider.
+   * 
+   * @return Whether the sphere and box colliders have collided or not.
+   */
+  static bool haveSphereBoxCollided(const SphereColliderShape &sphere, const BoxColliderShape &box)
+  {
+    return haveBoxSphereCollided(box, sphere);
+  }
+
+  /**
+   * Find the earliest time a box moving in a straight line touches a sphere, with the sphere moving the opposite way
+   *   relative to the box.
+   * 
+   * @param box           The moving box collider, at the end of its motion.
+   * @param motion        The motion of the box collider.
+   * @param sphere        The sphere collider.
+   * @param timeOfImpact  The time to store the earliest time of impact at.
+   * 
+   * @return Whether the box and the sphere touch during the motion.
+   */
+  static bool getMovingBoxSphereTimeOfImpact(const BoxColliderShape &box, const glm::vec3 &motion, const SphereColliderShape &sphere, float_t &timeOfImpact)
+  {
+    return getBoxSphereTimeOfImpact(box, sphere, -motion, timeOfImpact);
+  }
+
+  /**
+   * Find the earliest time a sphere moving in a straight line touches a box.
+   * 
+   * @param sphere        The moving sphere collider, at the end of its motion.
+   * @param motion        The motion of the sphere collider.
+   * @param box           The box collider.
+   * @param timeOfImpact  The time to store the earliest time of impact at.
+   * 
+   * @return Whether the sphere and the box touch during the motion.
+   */
+  static bool getMovingSphereBoxTimeOfImpact(const SphereColliderShape &sphere, const glm::vec3 &motion, const BoxColliderShape &box, float_t &timeOfImpact)
+  {
+    return getBoxSphereTimeOfImpact(box, sphere, motion, timeOfImpact);
+  }
+
+  /**
+   * Find the distance along the ray a sphere in world space is first hit at.
+   *
+   * @param ray          The ray.
+   * @param center       The centre of the sphere.
+   * @param radius       The radius of the sphere.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the sphere is hit at, which is 0 if the ray
+   *                       starts inside the sphere.
+   *
+   * @return Whether the ray hits the sphere before the given distance.
+   */
+  static bool raycastWorldSphere(const Ray &ray, const glm::vec3 &center, const float_t &radius, const float_t &maxDistance, float_t &distance)
+  {
+    // Solve for the distances along the ray that are the radius away from the centre.
+    const auto offset = ray.origin - center;
+    const auto halfB = glm::dot(offset, ray.direction);
+    const auto c = glm::dot(offset, offset) - radius * radius;
+    if (c <= 0.0f)
+    {
+      distance = 0.0f;
+      return true;
+    }
+    // The ray starts outside the sphere, so it misses if it's going away from the centre or never gets close enough.
+    const auto discriminant = halfB * halfB - c;
+    if (halfB > 0.0f || discriminant < 0.0f)
+    {
+      return false;
+    }
+    distance = -halfB - std::sqrt(discriminant);
+    return distance <= maxDistance;
+  }
+
+  /**
+   * Find the distance along the ray the side of a cylinder in world space is first hit at, between the ends of its
+   *   segment, for a ray starting outside of it.
+   *
+   * @param ray       The ray.
+   * @param start     The start of the segment of the cylinder.
+   * @param end       The end of the segment of the cylinder.
+   * @param radius    The radius of the cylinder.
+   * @param distance  The distance to store the distance along the ray the side is hit at.
+   *
+   * @return Whether the ray hits the side.
+   */
+  static bool raycastCylinderSide(const Ray &ray, const glm::vec3 &start, const glm::vec3 &end, const float_t &radius, float_t &distance)
+  {
+    // Solve for the distances along the ray that are the radius away from the line of the segment, with everything
+    //   scaled by the squared length of the segment to avoid normalizing it.
+    const auto segment = end - start;
+    const auto offset = ray.origin - start;
+    const auto segmentLengthSquared = glm::dot(segment, segment);
+    const auto segmentDirection = glm::dot(segment, ray.direction);
+    const auto segmentOffset = glm::dot(segment, offset);
+    const auto a = segmentLengthSquared - segmentDirection * segmentDirection;
+    // A ray parallel to the segment can only hit the ends.
+    if (a <= 1e-6f * segmentLengthSquared)
+    {
+      return false;
+    }
+    const auto halfB = segmentLengthSquared * glm::dot(offset, ray.direction) - segmentOffset * segmentDirection;
+    const auto c = segmentLengthSquared * glm::dot(offset, offset) - segmentOffset * segmentOffset - radius * radius * segmentLengthSquared;
+    const auto discriminant = halfB * halfB - a * c;
+    if (discriminant < 0.0f)
+    {
+      return false;
+    }
+    distance = (-halfB - std::sqrt(discriminant)) / a;
+    // The hit only counts between the ends of the segment, and ahead of the start of the ray.
+    const auto along = segmentOffset + distance * segmentDirection;
+    return distance >= 0.0f && along >= 0.0f && along <= segmentLengthSquared;
+  }
+
+  /**
+   * Find the distance along the ray the sphere collider is first hit at.
+   *
+   * @param ray          The ray.
+   * @param sphere       The sphere collider.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the collider is hit at.
+   *
+   * @return Whether the ray hits the collider before the given distance.
+   */
+  static bool raycastSphere(const Ray &ray, const SphereColliderShape &sphere, const float_t &maxDistance, float_t &distance)
+  {
+    const auto worldSphere = getWorldShape(sphere);
+    return raycastWorldSphere(ray, worldSphere.center, worldSphere.radius, maxDistance, distance);
+  }
+
+  /**
+   * Find the distance along the ray the box collider is first hit at, with the slab test along the axes of the box.
+   *
+   * @param ray          The ray.
+   * @param box          The box collider.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the collider is hit at.
+   *
+   * @return Whether the ray hits the collider before the given distance.
+   */
+  static bool raycastBox(const Ray &ray, const BoxColliderShape &box, const float_t &maxDistance, float_t &distance)
+  {
+    // Move the ray into the space of the box, where the box is an AABB around its centre. The axes of the box are unit
+    //   directions, so distances along the ray stay the same.
+    const auto orientedBox = getOrientedBox(box);
+    const auto offset = ray.origin - orientedBox.center;
+    glm::vec3 localOrigin, localDirection;
+    for (auto axis = 0; axis < 3; axis++)
+    {
+      localOrigin[axis] = glm::dot(offset, orientedBox.axes[axis]);
+      localDirection[axis] = glm::dot(ray.direction, orientedBox.axes[axis]);
+    }
+    return AxisAlignedBoundingBox(-orientedBox.halfExtents, orientedBox.halfExtents).raycast(Ray(localOrigin, localDirection), maxDistance, distance);
+  }
+
+  /**
+   * Find the distance along the ray the pill collider is first hit at, which is the first of its side and the spheres
+   *   at the ends of its segment.
+   *
+   * @param ray          The ray.
+   * @param pill         The pill collider.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the collider is hit at.
+   *
+   * @return Whether the ray hits the collider before the given distance.
+   */
+  static bool raycastPill(const Ray &ray, const PillColliderShape &pill, const float_t &maxDistance, float_t &distance)
+  {
+    const auto worldPill = getWorldShape(pill);
+    const auto closestPoint = getClosestSegmentPoint(worldPill.start, worldPill.end, ray.origin);
+    if (glm::distance(closestPoint, ray.origin) <= worldPill.radius)
+    {
+      distance = 0.0f;
+      return true;
+    }
+
+    auto nearestDistance = maxDistance;
+    auto hit = false;
+    float_t partDistance;
+    if (raycastCylinderSide(ray, worldPill.start, worldPill.end, worldPill.radius, partDistance) && partDistance <= nearestDistance)
+    {
+      nearestDistance = partDistance;
+      hit = true;
+    }
+    for (const auto &end : {worldPill.start, worldPill.end})
+    {
+      if (raycastWorldSphere(ray, end, worldPill.radius, nearestDistance, partDistance))
+      {
+        nearestDistance = partDistance;
+        hit = true;
+      }
+    }
+    distance = nearestDistance;
+    return hit;
+  }
+
+  /**
+   * Find the distance along the ray the cylinder collider is first hit at, which is the first of its side and its caps.
+   *
+   * @param ray          The ray.
+   * @param cylinder     The cylinder collider.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the collider is hit at.
+   *
+   * @return Whether the ray hits the collider before the given distance.
+   */
+  static bool raycastCylinder(const Ray &ray, const CylinderColliderShape &cylinder, const float_t &maxDistance, float_t &distance)
+  {
+    const auto worldCylinder = getWorldShape(cylinder);
+    const auto offset = ray.origin - worldCylinder.center;
+    const auto originHeight = glm::dot(offset, worldCylinder.axis);
+    const auto isWithinRadius = [&](const glm::vec3 &point) {
+      const auto pointOffset = point - worldCylinder.center;
+      const auto pointHeight = glm::dot(pointOffset, worldCylinder.axis);
+      return glm::length(pointOffset - worldCylinder.axis * pointHeight) <= worldCylinder.radius;
+    };
+    if (std::abs(originHeight) <= worldCylinder.halfHeight && isWithinRadius(ray.origin))
+    {
+      distance = 0.0f;
+      return true;
+    }
+
+    auto nearestDistance = maxDistance;
+    auto hit = false;
+    float_t partDistance;
+    const auto axisOffset = worldCylinder.axis * worldCylinder.halfHeight;
+    if (raycastCylinderSide(ray, worldCylinder.center - axisOffset, worldCylinder.center + axisOffset, worldCylinder.radius, partDistance) && partDistance <= nearestDistance)
+    {
+      nearestDistance = partDistance;
+      hit = true;
+    }
+    // Hit the planes of the caps, counting the points within the radius of the axis.
+    const auto directionHeight = glm::dot(ray.direction, worldCylinder.axis);
+    if (directionHeight != 0.0f)
+    {
+      for (const auto &capHeight : {-worldCylinder.halfHeight, worldCylinder.halfHeight})
+      {
+        partDistance = (capHeight - originHeight) / directionHeight;
+        if (partDistance >= 0.0f && partDistance <= nearestDistance && isWithinRadius(ray.getPoint(partDistance)))
+        {
+          nearestDistance = partDistance;
+          hit = true;
+        }
+      }
+    }
+    distance = nearestDistance;
+    return hit;
+  }
+
+  // A function testing whether two collider shapes overlap, and one finding the earliest time the first touches the second
+  //   while moving, for a single pair of shape types.
+  typedef bool (*OverlapTest)(const ColliderShape &shape1, const ColliderShape &shape2);
+  typedef bool (*TimeOfImpactTest)(const ColliderShape &shape1, const glm::vec3 &motion1, const ColliderShape &shape2, float_t &timeOfImpact);
+  // A function finding the distance along a ray a collider shape is first hit at, for a single shape type.
+  typedef bool (*RaycastTest)(const Ray &ray, const ColliderShape &shape, const float_t &maxDistance, float_t &distance);
+
+  // The number of collider shape types.
+  static const size_t SHAPE_TYPES_COUNT = 4;
+
+  /**
+   * Test whether two collider shapes overlap, with the test for their exact types. The shapes are cast statically, since
+   *   the dispatch tables only pick this for shapes of the given types.
+   * 
+   * @param shape1  The first collider shape.
+   * @param shape2  The second collider shape.
+   * 
+   * @return Whether the two collider shapes have collided or not.
+   */
+  template <typename Shape1, typename Shape2, bool (*test)(const Shape1 &, const Shape2 &)>
+  static bool testOverlap(const ColliderShape &shape1, const ColliderShape &shape2)
+  {
+    return test(static_cast<const Shape1 &>(shape1), static_cast<const Shape2 &>(shape2));
+  }
+
+  /**
+   * Find the earliest time the first collider shape touches the second one while moving, with the test for their exact
+   *   types. The shapes are cast statically, since the dispatch tables only pick this for shapes of the given types.
+   * 
+   * @param shape1        The moving collider shape, at the end of its motion.
+   * @param motion1       The motion of the first collider shape.
+   * @param shape2        The other collider shape.
+   * @param timeOfImpact  The time to store the earliest time of impact at.
+   * 
+   * @return Whether the collider shapes touch during the motion.
+   */
+  template <typename Shape1, typename Shape2, bool (*test)(const Shape1 &, const glm::vec3 &, const Shape2 &, float_t &)>
+  static bool testTimeOfImpact(const ColliderShape &shape1, const glm::vec3 &motion1, const ColliderShape &shape2, float_t &timeOfImpact)
+  {
+    return test(static_cast<const Shape1 &>(shape1), motion1, static_cast<const Shape2 &>(shape2), timeOfImpact);
+  }
+
+  /**
+   * Find the distance along the ray the collider shape is first hit at, with the test for its exact type. The shape is
+   *   cast statically, since the dispatch table only picks this for shapes of the given type.
+   * 
+   * @param ray          The ray.
+   * @param shape        The collider shape.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the shape is hit at.
+   * 
+   * @return Whether the ray hits the collider shape before the given distance.
+   */
+  template <typename Shape, bool (*test)(const Ray &, const Shape &, const float_t &, float_t &)>
+  static bool testRaycast(const Ray &ray, const ColliderShape &shape, const float_t &maxDistance, float_t &distance)
+  {
+    return test(ray, static_cast<const Shape &>(shape), maxDistance, distance);
+  }
+
+  /**
+   * Get the overlap test for the given pair of shape types, from a table indexed by the types of both shapes.
+   * 
+   * @param type1  The type of the first shape.
+   * @param type2  The type of the second shape.
+   * 
+   * @return The overlap test.
+   */
+  static OverlapTest getOverlapTest(const ColliderShapeType &type1, const ColliderShapeType &type2)
+  {
+    static constexpr OverlapTest overlapTests[SHAPE_TYPES_COUNT][SHAPE_TYPES_COUNT] = {
+        // The first shape is a sphere.
+        {&testOverlap<SphereColliderShape, SphereColliderShape, haveSphereSphereCollided>,
+         &testOverlap<SphereColliderShape, BoxColliderShape, haveSphereBoxCollided>,
+         &testOverlap<SphereColliderShape, CylinderColliderShape, haveSwappedCollided<SphereColliderShape, CylinderColliderShape, haveCylinderSphereCollided>>,
+         &testOverlap<SphereColliderShape, PillColliderShape, haveSwappedCollided<SphereColliderShape, PillColliderShape, havePillSphereCollided>>},
+        // The first shape is a box.
+        {&testOverlap<BoxColliderShape, SphereColliderShape, haveBoxSphereCollided>,
+         &testOverlap<BoxColliderShape, BoxColliderShape, haveBoxBoxCollided>,
+         &testOverlap<BoxColliderShape, CylinderColliderShape, haveConvexCollidersCollided<BoxColliderShape, CylinderColliderShape>>,
+         &testOverlap<BoxColliderShape, PillColliderShape, haveConvexCollidersCollided<BoxColliderShape, PillColliderShape>>},
+        // The first shape is a cylinder.
+        {&testOverlap<CylinderColliderShape, SphereColliderShape, haveCylinderSphereCollided>,
+         &testOverlap<CylinderColliderShape, BoxColliderShape, haveConvexCollidersCollided<CylinderColliderShape, BoxColliderShape>>,
+         &testOverlap<CylinderColliderShape, CylinderColliderShape, haveConvexCollidersCollided<CylinderColliderShape, CylinderColliderShape>>,
+         &testOverlap<CylinderColliderShape, PillColliderShape, haveConvexCollidersCollided<CylinderColliderShape, PillColliderShape>>},
+        // The first shape is a pill.
+        {&testOverlap<PillColliderShape, SphereColliderShape, havePillSphereCollided>,
+         &testOverlap<PillColliderShape, BoxColliderShape, haveConvexCollidersCollided<PillColliderShape, BoxColliderShape>>,
+         &testOverlap<PillColliderShape, CylinderColliderShape, haveConvexCollidersCollided<PillColliderShape, CylinderColliderShape>>,
+         &testOverlap<PillColliderShape, PillColliderShape, havePillPillCollided>},
+    };
+    return overlapTests[type1][type2];
+  }
+
+  /**
+   * Get the swept test for the given pair of shape types, from a table indexed by the types of both shapes.
+   * 
+   * @param type1  The type of the moving shape.
+   * @param type2  The type of the other shape.
+   * 
+   * @return The swept test.
+   */
+  static TimeOfImpactTest getTimeOfImpactTest(const ColliderShapeType &type1, const ColliderShapeType &type2)
+  {
+    static constexpr TimeOfImpactTest timeOfImpactTests[SHAPE_TYPES_COUNT][SHAPE_TYPES_COUNT] = {
+        // The moving shape is a sphere.
+        {&testTimeOfImpact<SphereColliderShape, SphereColliderShape, getSphereSphereTimeOfImpact>,
+         &testTimeOfImpact<SphereColliderShape, BoxColliderShape, getMovingSphereBoxTimeOfImpact>,
+         &testTimeOfImpact<SphereColliderShape, CylinderColliderShape, getSteppedTimeOfImpact<SphereColliderShape, CylinderColliderShape, haveSwappedCollided<SphereColliderShape, CylinderColliderShape, haveCylinderSphereCollided>>>,
+         &testTimeOfImpact<SphereColliderShape, PillColliderShape, getSteppedTimeOfImpact<SphereColliderShape, PillColliderShape, haveSwappedCollided<SphereColliderShape, PillColliderShape, havePillSphereCollided>>>},
+        // The moving shape is a box.
+        {&testTimeOfImpact<BoxColliderShape, SphereColliderShape, getMovingBoxSphereTimeOfImpact>,
+         &testTimeOfImpact<BoxColliderShape, BoxColliderShape, getSteppedTimeOfImpact<BoxColliderShape, BoxColliderShape, haveBoxBoxCollided>>,
+         &testTimeOfImpact<BoxColliderShape, CylinderColliderShape, getSteppedTimeOfImpact<BoxColliderShape, CylinderColliderShape, haveConvexCollidersCollided<BoxColliderShape, CylinderColliderShape>>>,
+         &testTimeOfImpact<BoxColliderShape, PillColliderShape, getSteppedTimeOfImpact<BoxColliderShape, PillColliderShape, haveConvexCollidersCollided<BoxColliderShape, PillColliderShape>>>},
+        // The moving shape is a cylinder.
+        {&testTimeOfImpact<CylinderColliderShape, SphereColliderShape, getSteppedTimeOfImpact<CylinderColliderShape, SphereColliderShape, haveCylinderSphereCollided>>,
+         &testTimeOfImpact<CylinderColliderShape, BoxColliderShape, getSteppedTimeOfImpact<CylinderColliderShape, BoxColliderShape, haveConvexCollidersCollided<CylinderColliderShape, BoxColliderShape>>>,
+         &testTimeOfImpact<CylinderColliderShape, CylinderColliderShape, getSteppedTimeOfImpact<CylinderColliderShape, CylinderColliderShape, haveConvexCollidersCollided<CylinderColliderShape, CylinderColliderShape>>>,
+         &testTimeOfImpact<CylinderColliderShape, PillColliderShape, getSteppedTimeOfImpact<CylinderColliderShape, PillColliderShape, haveConvexCollidersCollided<CylinderColliderShape, PillColliderShape>>>},
+        // The moving shape is a pill.
+        {&testTimeOfImpact<PillColliderShape, SphereColliderShape, getSteppedTimeOfImpact<PillColliderShape, SphereColliderShape, havePillSphereCollided>>,
+         &testTimeOfImpact<PillColliderShape, BoxColliderShape, getSteppedTimeOfImpact<PillColliderShape, BoxColliderShape, haveConvexCollidersCollided<PillColliderShape, BoxColliderShape>>>,
+         &testTimeOfImpact<PillColliderShape, CylinderColliderShape, getSteppedTimeOfImpact<PillColliderShape, CylinderColliderShape, haveConvexCollidersCollided<PillColliderShape, CylinderColliderShape>>>,
+         &testTimeOfImpact<PillColliderShape, PillColliderShape, getSteppedTimeOfImpact<PillColliderShape, PillColliderShape, havePillPillCollided>>},
+    };
+    return timeOfImpactTests[type1][type2];
+  }
+
+  /**
+   * Get the ray test for the given shape type, from a table indexed by the type of the shape.
+   * 
+   * @param type  The type of the shape.
+   * 
+   * @return The ray test.
+   */
+  static RaycastTest getRaycastTest(const ColliderShapeType &type)
+  {
+    static constexpr RaycastTest raycastTests[SHAPE_TYPES_COUNT] = {
+        &testRaycast<SphereColliderShape, raycastSphere>,
+        &testRaycast<BoxColliderShape, raycastBox>,
+        &testRaycast<CylinderColliderShape, raycastCylinder>,
+        &testRaycast<PillColliderShape, raycastPill>,
+    };
+    return raycastTests[type];
+  }
+
+public:
+  /**
+   * Set whether the box-box tests use the separating axis test, or the older test checking whether any corner of either
+   *   box is inside the other.
+   * 
+   * @param enabled  Whether the separating axis test is used.
+   */
+  static void setSeparatingAxisBoxTestEnabled(const bool &enabled)
+  {
+    separatingAxisBoxTestEnabled = enabled;
+  }
+
+  /**
+   * Get whether the box-box tests use the separating axis test.
+   * 
+   * @return Whether the separating axis test is used.
+   */
+  static const bool &isSeparatingAxisBoxTestEnabled()
+  {
+    return separatingAxisBoxTestEnabled;
+  }
+
+  /**
+   * Checks if the two given collider shapes have intersected/collided with each other.
+   * 
+   * @param shape1              The first collider shape.
+   * @param shape2              The second collider shape.
+   * @param deepCollisionCheck  Whether to perform a deep collision check or not. If not, we just check if the
+   *                              AABBs of the two colliders have collided or not.
+   * 
+   * @return Whether the two colldier shapes have collided or not.
+   */
+  static bool haveShapesCollided(const ColliderShape &shape1, const ColliderShape &shape2, const bool &deepCollisionCheck)
+  {
+    // Check if the AABBs of the two shapes have collided or not.
+    if (!shape1.getTransformedBox().hasCollided(shape2.getTransformedBox()))
+    {
+      // If not, no need to do a deeper check, so just return false.
+      return false;
+    }
+    // If a deep collision check wasn't request, then just return true since the shallow check has passed.
+    if (!deepCollisionCheck)
+    {
+      return true;
+    }
+
+    // Look up the test for the types of the two shapes, and run it if the pair is supported.
+    const auto overlapTest = getOverlapTest(shape1.getType(), shape2.getType());
+    return overlapTest != nullptr && overlapTest(shape1, shape2);
+  }
+
+  /**
+   * Finds the earliest time the first collider shape touches the second one while moving in a straight line, so fast
+   *   shapes can't pass through the shapes they should hit without ever overlapping them at the end of a frame. The
+   *   rotations of the shapes are taken as they are at the end of the motion.
+   * 
+   * @param shape1        The moving collider shape, at the end of its motion.
+   * @param motion1       The motion of the first collider shape, from where it started to where it is now.
+   * @param shape2        The other collider shape, which doesn't move.
+   * @param timeOfImpact  The time to store the earliest time of impact at, from 0 at the start of the motion to 1 at the end.
+   * 
+   * @return Whether the collider shapes touch during the motion.
+   */
+  static bool getTimeOfImpact(const ColliderShape &shape1, const glm::vec3 &motion1, const ColliderShape &shape2, float_t &timeOfImpact)
+  {
+    // Check if the AABBs of the two shapes collide anywhere along the motion, by growing the first one to cover it.
+    const auto &box1 = shape1.getTransformedBox();
+    const AxisAlignedBoundingBox pathBox1(glm::min(box1.getMinCorner(), box1.getMinCorner() - motion1), glm::max(box1.getMaxCorner(), box1.getMaxCorner() - motion1));
+    if (!pathBox1.hasCollided(shape2.getTransformedBox()))
+    {
+      return false;
+    }
+
+    // Look up the swept test for the types of the two shapes, the same as the overlap check.
+    const auto timeOfImpactTest = getTimeOfImpactTest(shape1.getType(), shape2.getType());
+    return timeOfImpactTest != nullptr && timeOfImpactTest(shape1, motion1, shape2, timeOfImpact);
+  }
+
+  /**
+   * Finds the distance along the ray the collider shape is first hit at, checking the AABB of the shape with the slab
+   *   test before the test for the type of the shape.
+   * 
+   * @param ray          The ray.
+   * @param shape        The collider shape.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param distance     The distance to store the distance along the ray the shape is hit at, which is 0 if the ray
+   *                       starts inside the shape.
+   * 
+   * @return Whether the ray hits the collider shape before the given distance.
+   */
+  static bool raycast(const Ray &ray, const ColliderShape &shape, const float_t &maxDistance, float_t &distance)
+  {
+    // Rays missing the AABB of the shape can't hit the shape.
+    float_t boxDistance;
+    if (!shape.getTransformedBox().raycast(ray, maxDistance, boxDistance))
+    {
+      return false;
+    }
+
+    const auto raycastTest = getRaycastTest(shape.getType());
+    return raycastTest != nullptr && raycastTest(ray, shape, maxDistance, distance);
+  }
+};
+
+// Initialize the box-box tests to use the separating axis test.
+bool DeepCollisionValidator::separatingAxisBoxTestEnabled = true;
+
+/**
+ * Enum for how a collider moves, which decides how the broadphase keeps track of it.
+ */
+enum class ColliderMotion
+{
+  // Never moves while registered, so it is kept in a broadphase built once and is only ever tested against by the
+  //   moving colliders.
+  STATIC,
+  // Only moved by the logic of its own model, such as the shots and the player.
+  KINEMATIC,
+  // Can be moved by anything at any time.
+  DYNAMIC,
+};
+
+// The storage of a collider shape of any of the shape types, as large as the largest of them, so the shape is kept by
+//   value in the collider instead of in an allocation of its own.
+typedef std::variant<SphereColliderShape, BoxColliderShape, CylinderColliderShape, PillColliderShape> ColliderShapeStorage;
+
+/**
+ * Class for containing the details of the collider, which is kept by value in its model along with its shape.
+ */
 class ColliderDetails
 {
 private:
-  // The name of the collider.
-  const std::string colliderName;
+  // The name of the collider, which is shared by the colliders of all the models of the same type.
+  const std::string &colliderName;
   // The shape of the collider.
-  const std::shared_ptr<ColliderShape> colliderShape;
+  ColliderShapeStorage colliderShape;
+  // How the collider moves.
+  ColliderMotion colliderMotion;
+  // The mask of the collision layers the collider is on.
+  uint32_t collisionLayers;
+
+  // The layers the moving colliders on each layer collide with, by the index of the layer.
+  static std::array<uint32_t, COLLISION_LAYERS_COUNT> layerCollisionMasks;
 
 public:
+  /**
+   * Create the details of a collider, with its shape created in place from the given arguments.
+   * 
+   * @param colliderName  The name of the collider, which has to outlive the collider.
+   * @param shapeType     The class of the shape.
+   * @param shapeArgs     The arguments to create the shape with.
+   */
+  template <typename S, typename... Args>
   ColliderDetails(
-      const std::string colliderName,
-      const std::shared_ptr<ColliderShape> colliderShape)
+      const std::string &colliderName,
+      std::in_place_type_t<S> shapeType, Args &&...shapeArgs)
       : colliderName(colliderName),
-        colliderShape(colliderShape) {}
+        colliderShape(shapeType, std::forward<Args>(shapeArgs)...),
+        colliderMotion(ColliderMotion::DYNAMIC),
+        collisionLayers(COLLISION_LAYER_DEFAULT) {}
 
   /**
    * Get the name of the colldier.
@@ -1054,10 +2669,107 @@ public:
    * 
    * @return The collider shape.
    */
-  const std::shared_ptr<ColliderShape> &getColliderShape() const
+  ColliderShape *getColliderShape()
+  {
+    return std::visit([](ColliderShape &shape) { return &shape; }, colliderShape);
+  }
+
+  /**
+   * Get the shape of the colldier.
+   * 
+   * @return The collider shape.
+   */
+  const ColliderShape *getColliderShape() const
+  {
+    return std::visit([](const ColliderShape &shape) { return &shape; }, colliderShape);
+  }
+
+  /**
+   * Get how the collider moves.
+   * 
+   * @return The collider motion.
+   */
+  const ColliderMotion &getColliderMotion() const
+  {
+    return colliderMotion;
+  }
+
+  /**
+   * Set how the collider moves. Must be set before the model of the collider is registered.
+   * 
+   * @param newColliderMotion  The collider motion.
+   */
+  void setColliderMotion(const ColliderMotion &newColliderMotion)
+  {
+    colliderMotion = newColliderMotion;
+  }
+
+  /**
+   * Get the mask of the collision layers the collider is on.
+   * 
+   * @return The collision layers.
+   */
+  const uint32_t &getCollisionLayers() const
   {
-    return colliderShape;
+    return collisionLayers;
+  }
+
+  /**
+   * Set the mask of the collision layers the collider is on. Must be set before the model of the collider is registered.
+   * 
+   * @param newCollisionLayers  The collision layers.
+   */
+  void setCollisionLayers(const uint32_t &newCollisionLayers)
+  {
+    collisionLayers = newCollisionLayers;
+  }
+
+  /**
+   * Get the mask of the layers the collider collides with while it moves, from the layers of the layers it is on.
+   * 
+   * @return The mask of the layers, which is 0 for the colliders only ever hit by others.
+   */
+  uint32_t getCollisionMask() const
+  {
+    uint32_t collisionMask = 0;
+    for (uint32_t layerIndex = 0; layerIndex < COLLISION_LAYERS_COUNT; layerIndex++)
+    {
+      if (collisionLayers & (1u << layerIndex))
+      {
+        collisionMask |= layerCollisionMasks[layerIndex];
+      }
+    }
+    return collisionMask;
+  }
+
+  /**
+   * Make the moving colliders on the given layers collide with the colliders on the other layers. The pairs only go
+   *   one way, so the colliders on the other layers don't look for the ones on the given layers themselves.
+   * 
+   * @param layers       The mask of the layers of the moving colliders.
+   * @param otherLayers  The mask of the layers they collide with.
+   */
+  static void setLayersCollide(const uint32_t &layers, const uint32_t &otherLayers)
+  {
+    for (uint32_t layerIndex = 0; layerIndex < COLLISION_LAYERS_COUNT; layerIndex++)
+    {
+      if (layers & (1u << layerIndex))
+      {
+        layerCollisionMasks[layerIndex] |= otherLayers;
+      }
+    }
+  }
+
+  /**
+   * Make no layers collide with each other.
+   */
+  static void clearLayerCollisions()
+  {
+    layerCollisionMasks.fill(0);
   }
 };
 
+// Initialize the layer-pair matrix static variable, with no layers colliding.
+std::array<uint32_t, COLLISION_LAYERS_COUNT> ColliderDetails::layerCollisionMasks = {};
+
 #endif
\ No newline at end of file
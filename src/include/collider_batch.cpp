@@ -0,0 +1,260 @@
+#ifndef INCLUDE_COLLIDER_BATCH_CPP
+#define INCLUDE_COLLIDER_BATCH_CPP
+
+#include <vector>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLLIDER_BATCH_SSE2
+#endif
+
+#include <glm/glm.hpp>
+
+#include "collider.cpp"
+
+/**
+ * Class for storing a batch of sphere colliders as a structure of arrays, so a single moving collider can be tested
+ * against four of them at once using SSE2, or one at a time with the same math where SSE2 isn't available. The arrays
+ * are padded to a multiple of four spheres, and the results of the padding are never read.
+ */
+class SphereColliderBatch
+{
+private:
+  // The number of spheres tested at once.
+  static const size_t LANES_COUNT = 4;
+
+  // The number of spheres in the batch.
+  size_t spheresCount;
+
+  // The positions of the spheres along each axis.
+  std::vector<float_t> positionsX, positionsY, positionsZ;
+  // The radii of the spheres, scaled by the scale of each sphere along each axis.
+  std::vector<float_t> scaledRadiiX, scaledRadiiY, scaledRadiiZ;
+
+  /**
+   * Get the number of spheres the arrays need to hold, padded up to a multiple of the lanes.
+   *
+   * @return The padded number of spheres.
+   */
+  size_t getPaddedCount() const
+  {
+    return (spheresCount + LANES_COUNT - 1) / LANES_COUNT * LANES_COUNT;
+  }
+
+public:
+  SphereColliderBatch()
+      : spheresCount(0),
+        positionsX({}),
+        positionsY({}),
+        positionsZ({}),
+        scaledRadiiX({}),
+        scaledRadiiY({}),
+        scaledRadiiZ({}) {}
+
+  /**
+   * Remove all the spheres from the batch, keeping the memory of the arrays for the next spheres.
+   */
+  void clear()
+  {
+    spheresCount = 0;
+    for (auto *values : {&positionsX, &positionsY, &positionsZ, &scaledRadiiX, &scaledRadiiY, &scaledRadiiZ})
+    {
+      values->clear();
+    }
+  }
+
+  /**
+   * Add a sphere collider to the end of the batch.
+   *
+   * @param sphere  The sphere collider.
+   */
+  void add(const SphereColliderShape &sphere)
+  {
+    // Replace the padding with the sphere if there is any, and pad the arrays up again otherwise.
+    if (spheresCount == positionsX.size())
+    {
+      for (auto *values : {&positionsX, &positionsY, &positionsZ, &scaledRadiiX, &scaledRadiiY, &scaledRadiiZ})
+      {
+        values->resize(spheresCount + LANES_COUNT, 0.0f);
+      }
+    }
+    positionsX[spheresCount] = sphere.getPosition().x;
+    positionsY[spheresCount] = sphere.getPosition().y;
+    positionsZ[spheresCount] = sphere.getPosition().z;
+    scaledRadiiX[spheresCount] = sphere.getRadius() * sphere.getScale().x;
+    scaledRadiiY[spheresCount] = sphere.getRadius() * sphere.getScale().y;
+    scaledRadiiZ[spheresCount] = sphere.getRadius() * sphere.getScale().z;
+    spheresCount++;
+  }
+
+  /**
+   * Get the number of spheres in the batch.
+   *
+   * @return The number of spheres.
+   */
+  const size_t &size() const
+  {
+    return spheresCount;
+  }
+
+  /**
+   * Find the earliest time a sphere moving in a straight line touches each sphere of the batch, the same as the single
+   *   sphere-sphere swept test.
+   *
+   * @param sphere          The moving sphere collider, at the end of its motion.
+   * @param motion          The motion of the sphere collider.
+   * @param hits            The list to store whether the moving sphere touches each sphere of the batch to.
+   * @param timesOfImpact   The list to store the earliest time of impact with each sphere of the batch to, for the ones
+   *                          it touches.
+   */
+  void getSphereTimesOfImpact(const SphereColliderShape &sphere, const glm::vec3 &motion, std::vector<uint8_t> &hits, std::vector<float_t> &timesOfImpact) const
+  {
+    hits.resize(getPaddedCount());
+    timesOfImpact.resize(getPaddedCount());
+    const auto startPosition = sphere.getPosition() - motion;
+    const auto radius = sphere.getRadius() * sphere.getScale().x;
+    const auto a = glm::dot(motion, motion);
+
+#ifdef COLLIDER_BATCH_SSE2
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    for (size_t i = 0; i < getPaddedCount(); i += LANES_COUNT)
+    {
+      // The offsets from the spheres of the batch to the moving sphere at the start of the motion.
+      const auto offsetX = _mm_sub_ps(_mm_set1_ps(startPosition.x), _mm_loadu_ps(&positionsX[i]));
+      const auto offsetY = _mm_sub_ps(_mm_set1_ps(startPosition.y), _mm_loadu_ps(&positionsY[i]));
+      const auto offsetZ = _mm_sub_ps(_mm_set1_ps(startPosition.z), _mm_loadu_ps(&positionsZ[i]));
+      const auto radiiSum = _mm_add_ps(_mm_set1_ps(radius), _mm_loadu_ps(&scaledRadiiX[i]));
+      const auto c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY)), _mm_mul_ps(offsetZ, offsetZ)), _mm_mul_ps(radiiSum, radiiSum));
+      const auto startsTouching = _mm_cmple_ps(c, zero);
+      auto hitMask = startsTouching;
+      auto timeOfImpact = zero;
+      if (a > 0.0f)
+      {
+        // Solve |offset + t * motion| = radiiSum for the smaller root, for the spheres the moving sphere heads towards.
+        const auto b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, _mm_set1_ps(motion.x)), _mm_mul_ps(offsetY, _mm_set1_ps(motion.y))), _mm_mul_ps(offsetZ, _mm_set1_ps(motion.z)));
+        const auto discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_set1_ps(a), c));
+        const auto root = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(discriminant, zero))), _mm_set1_ps(a));
+        const auto rootHitMask = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(b, zero), _mm_cmpge_ps(discriminant, zero)), _mm_cmple_ps(root, one));
+        hitMask = _mm_or_ps(hitMask, rootHitMask);
+        timeOfImpact = _mm_andnot_ps(startsTouching, root);
+      }
+      _mm_storeu_ps(&timesOfImpact[i], timeOfImpact);
+      const auto hitBits = _mm_movemask_ps(hitMask);
+      for (size_t lane = 0; lane < LANES_COUNT; lane++)
+      {
+        hits[i + lane] = (hitBits >> lane) & 1;
+      }
+    }
+#else
+    for (size_t i = 0; i < getPaddedCount(); i++)
+    {
+      const auto offset = startPosition - glm::vec3(positionsX[i], positionsY[i], positionsZ[i]);
+      const auto radiiSum = radius + scaledRadiiX[i];
+      const auto c = glm::dot(offset, offset) - radiiSum * radiiSum;
+      const auto b = glm::dot(offset, motion);
+      const auto discriminant = b * b - a * c;
+      timesOfImpact[i] = 0.0f;
+      hits[i] = c <= 0.0f;
+      if (!hits[i] && a > 0.0f && b < 0.0f && discriminant >= 0.0f)
+      {
+        timesOfImpact[i] = (-b - std::sqrt(discriminant)) / a;
+        hits[i] = timesOfImpact[i] <= 1.0f;
+      }
+    }
+#endif
+  }
+
+  /**
+   * Find which spheres of the batch might touch a box moving in a straight line. The path of each sphere's centre is
+   *   taken into the space of the box, and tested against the box grown by the sphere's radius along every axis, using
+   *   the same radius as the single box-sphere swept test. The grown box holds every point the sphere can touch the box
+   *   from, so a sphere whose path misses it can't touch the box, while the ones left still need the single test.
+   *
+   * @param box       The moving box collider, at the end of its motion.
+   * @param motion    The motion of the box collider.
+   * @param overlaps  The list to store whether the path of each sphere of the batch overlaps the grown box to.
+   */
+  void getBoxPathOverlaps(const BoxColliderShape &box, const glm::vec3 &motion, std::vector<uint8_t> &overlaps) const
+  {
+    overlaps.resize(getPaddedCount());
+    const auto &inverseTransformationMatrix = box.getInverseTransformationMatrix();
+    const auto &boxMinCorner = box.getBaseBox().getMinCorner();
+    const auto &boxMaxCorner = box.getBaseBox().getMaxCorner();
+    const auto boxScaleReciprocal = 1.0f / box.getScale();
+    // The spheres move the opposite way relative to the box, by the same amount in the space of the box for all of them.
+    const auto pathDirection = glm::mat3(inverseTransformationMatrix) * -motion;
+
+#ifdef COLLIDER_BATCH_SSE2
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    for (size_t i = 0; i < getPaddedCount(); i += LANES_COUNT)
+    {
+      const __m128 positions[3] = {_mm_loadu_ps(&positionsX[i]), _mm_loadu_ps(&positionsY[i]), _mm_loadu_ps(&positionsZ[i])};
+      // The radius of each sphere in the space of the box.
+      const auto radiusX = _mm_mul_ps(_mm_loadu_ps(&scaledRadiiX[i]), _mm_set1_ps(boxScaleReciprocal.x));
+      const auto radiusY = _mm_mul_ps(_mm_loadu_ps(&scaledRadiiY[i]), _mm_set1_ps(boxScaleReciprocal.y));
+      const auto radiusZ = _mm_mul_ps(_mm_loadu_ps(&scaledRadiiZ[i]), _mm_set1_ps(boxScaleReciprocal.z));
+      const auto radius = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(radiusX, radiusX), _mm_mul_ps(radiusY, radiusY)), _mm_mul_ps(radiusZ, radiusZ)), one));
+
+      // Clip the path of each sphere against the slabs of the grown box along each axis.
+      auto overlapMask = _mm_cmpeq_ps(zero, zero);
+      auto entryTime = zero, exitTime = one;
+      for (auto axis = 0; axis < 3; axis++)
+      {
+        // The end of the path of each sphere in the space of the box along the axis, and its start.
+        const auto endPosition = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(positions[0], _mm_set1_ps(inverseTransformationMatrix[0][axis])),
+                                                                  _mm_mul_ps(positions[1], _mm_set1_ps(inverseTransformationMatrix[1][axis]))),
+                                                       _mm_mul_ps(positions[2], _mm_set1_ps(inverseTransformationMatrix[2][axis]))),
+                                            _mm_set1_ps(inverseTransformationMatrix[3][axis]));
+        const auto startPosition = _mm_sub_ps(endPosition, _mm_set1_ps(pathDirection[axis]));
+        const auto slabMin = _mm_sub_ps(_mm_set1_ps(boxMinCorner[axis]), radius);
+        const auto slabMax = _mm_add_ps(_mm_set1_ps(boxMaxCorner[axis]), radius);
+        if (std::abs(pathDirection[axis]) < 0.000001f)
+        {
+          // The paths run along the slab, so they have to start inside it.
+          overlapMask = _mm_and_ps(overlapMask, _mm_and_ps(_mm_cmpge_ps(startPosition, slabMin), _mm_cmple_ps(startPosition, slabMax)));
+          continue;
+        }
+        const auto directionReciprocal = _mm_set1_ps(1.0f / pathDirection[axis]);
+        const auto slabTime1 = _mm_mul_ps(_mm_sub_ps(slabMin, startPosition), directionReciprocal);
+        const auto slabTime2 = _mm_mul_ps(_mm_sub_ps(slabMax, startPosition), directionReciprocal);
+        entryTime = _mm_max_ps(entryTime, _mm_min_ps(slabTime1, slabTime2));
+        exitTime = _mm_min_ps(exitTime, _mm_max_ps(slabTime1, slabTime2));
+      }
+      const auto overlapBits = _mm_movemask_ps(_mm_and_ps(overlapMask, _mm_cmple_ps(entryTime, exitTime)));
+      for (size_t lane = 0; lane < LANES_COUNT; lane++)
+      {
+        overlaps[i + lane] = (overlapBits >> lane) & 1;
+      }
+    }
+#else
+    for (size_t i = 0; i < getPaddedCount(); i++)
+    {
+      const auto radius = std::sqrt(glm::dot(glm::vec3(scaledRadiiX[i], scaledRadiiY[i], scaledRadiiZ[i]) * boxScaleReciprocal,
+                                             glm::vec3(scaledRadiiX[i], scaledRadiiY[i], scaledRadiiZ[i]) * boxScaleReciprocal) +
+                                    1.0f);
+      const auto endPosition = glm::vec3(inverseTransformationMatrix * glm::vec4(positionsX[i], positionsY[i], positionsZ[i], 1.0f));
+      const auto startPosition = endPosition - pathDirection;
+      auto overlap = true;
+      auto entryTime = 0.0f, exitTime = 1.0f;
+      for (auto axis = 0; axis < 3 && overlap; axis++)
+      {
+        const auto slabMin = boxMinCorner[axis] - radius;
+        const auto slabMax = boxMaxCorner[axis] + radius;
+        if (std::abs(pathDirection[axis]) < 0.000001f)
+        {
+          overlap = startPosition[axis] >= slabMin && startPosition[axis] <= slabMax;
+          continue;
+        }
+        const auto slabTime1 = (slabMin - startPosition[axis]) / pathDirection[axis];
+        const auto slabTime2 = (slabMax - startPosition[axis]) / pathDirection[axis];
+        entryTime = glm::max(entryTime, glm::min(slabTime1, slabTime2));
+        exitTime = glm::min(exitTime, glm::max(slabTime1, slabTime2));
+      }
+      overlaps[i] = overlap && entryTime <= exitTime;
+    }
+#endif
+  }
+};
+
+#endif
@@ -0,0 +1,546 @@
+#ifndef INCLUDE_COLLISION_CPP
+#define INCLUDE_COLLISION_CPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "collider.cpp"
+#include "collider_batch.cpp"
+#include "models.cpp"
+#include "parallel.cpp"
+#include "profiler.cpp"
+#include "constants.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Structure for defining a collision found between two models.
+ */
+struct CollisionEvent
+{
+  // The moving model of the pair, whose path since the last check was tested.
+  std::shared_ptr<ModelBaseIntf> model;
+  // The model it collided with.
+  std::shared_ptr<ModelBaseIntf> otherModel;
+  // The time along the moving model's path it hit the other model at, from 0 at its last check to 1 where it is now.
+  float_t timeOfImpact;
+};
+
+/**
+ * Structure for defining the model a ray query hit first.
+ */
+struct RaycastHit
+{
+  // The model hit.
+  std::shared_ptr<ModelBaseIntf> model;
+  // The distance along the ray the model was hit at.
+  float_t distance;
+  // The point the model was hit at.
+  glm::vec3 point;
+};
+
+/**
+ * A manager class for finding the collisions between the models of the registered pairs of collision layers once per
+ * frame, and letting the models of each collision react to it. The moving models of the pairs are tested along their path since
+ * the last check, so fast models can't pass through the models they should hit in between frames.
+ */
+class CollisionManager
+{
+private:
+  /**
+   * Structure for defining a pair of models the broadphase found close enough to be tested by the narrowphase.
+   */
+  struct CandidatePair
+  {
+    // The moving model of the pair.
+    std::shared_ptr<ModelBaseIntf> model;
+    // The model it might collide with.
+    std::shared_ptr<ModelBaseIntf> otherModel;
+    // The position the moving model was at when it was last checked.
+    glm::vec3 previousPosition;
+  };
+
+  /**
+   * Structure for defining the handles of the models of a pair, used as the key of the pairs kept between checks.
+   */
+  struct PairHandles
+  {
+    // The handles of the moving model and the model it might collide with.
+    SlotHandle modelHandle;
+    SlotHandle otherModelHandle;
+
+    bool operator==(const PairHandles &other) const
+    {
+      return modelHandle == other.modelHandle && otherModelHandle == other.otherModelHandle;
+    }
+  };
+
+  /**
+   * Structure for hashing the handles of the models of a pair.
+   */
+  struct PairHandlesHash
+  {
+    size_t operator()(const PairHandles &pairHandles) const
+    {
+      const auto hash1 = std::hash<SlotHandle>()(pairHandles.modelHandle);
+      return hash1 ^ (std::hash<SlotHandle>()(pairHandles.otherModelHandle) + 0x9E3779B9 + (hash1 << 6) + (hash1 >> 2));
+    }
+  };
+
+  /**
+   * Structure for defining how far apart the models of a pair were found to be, kept between checks.
+   */
+  struct PairSeparation
+  {
+    // The position the other model was at when the separation was last brought up to date.
+    glm::vec3 otherPosition;
+    // The distance between the bounding spheres of the models, less how far the models moved since it was measured.
+    float_t separation;
+    // The sum of the bounding radiuses of the models when the separation was measured.
+    float_t radiusSum;
+    // The check the pair was last found by the broadphase in, so the pairs no longer found are dropped.
+    uint64_t lastCheck;
+  };
+
+  // The minimum number of candidate pairs worth splitting across parallel tasks.
+  static constexpr size_t MIN_PARALLEL_PAIRS = 64;
+
+  // The model manager responsible for managing the models in the scene.
+  ModelManager &modelManager;
+  // The event bus the collisions are published to, and the models react to them through.
+  EventBus &eventBus;
+  // The positions the moving models were at when they were last checked, by their handles.
+  std::unordered_map<SlotHandle, glm::vec3> previousPositions;
+  // The separations of the pairs found by the latest checks, by the handles of their models.
+  std::unordered_map<PairHandles, PairSeparation, PairHandlesHash> pairSeparations;
+  // The number of checks made, numbering the checks the pairs were last found in.
+  uint64_t checksCount;
+
+  // The collisions found by the latest check, in the order of the models in the model manager.
+  std::vector<CollisionEvent> collisionEvents;
+  // The number of candidate pairs, of the pairs skipped by their separation, and of narrowphase tests of the latest check.
+  uint32_t candidatePairsCount;
+  uint32_t separatedPairsCount;
+  uint32_t narrowphaseChecksCount;
+
+  // The batches of sphere colliders used by each narrowphase task, with the lists of their results, kept between checks
+  //   so the tasks don't allocate them again every frame.
+  std::vector<SphereColliderBatch> narrowphaseBatches;
+  std::vector<std::vector<uint8_t>> narrowphaseBatchHits;
+  std::vector<std::vector<float_t>> narrowphaseBatchTimesOfImpact;
+  // The collisions found by each narrowphase task, in the order of its pairs, merged in the order of the tasks once they
+  //   are all done, kept between checks like the batches.
+  std::vector<std::vector<CollisionEvent>> narrowphaseEvents;
+
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local CollisionManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the collision manager, which is the one of the default world.
+   *
+   * @return The collision manager singleton instance.
+   */
+  static CollisionManager &getSingleton()
+  {
+    // Singleton instance of the collision manager, constructed the first time it's asked for.
+    static CollisionManager instance;
+    return instance;
+  }
+
+  CollisionManager()
+      : modelManager(ModelManager::getInstance()),
+        eventBus(EventBus::getInstance()),
+        previousPositions({}),
+        pairSeparations({}),
+        checksCount(0),
+        collisionEvents({}),
+        candidatePairsCount(0),
+        separatedPairsCount(0),
+        narrowphaseChecksCount(0),
+        narrowphaseBatches(ParallelTasks::getTaskCount()),
+        narrowphaseBatchHits(ParallelTasks::getTaskCount()),
+        narrowphaseBatchTimesOfImpact(ParallelTasks::getTaskCount()),
+        narrowphaseEvents(ParallelTasks::getTaskCount())
+  {
+    // Let the models of each collision react to it, skipping it if one of them was destroyed by an earlier collision.
+    //   The destroys the reactions publish are handled right after them, so a model destroyed by a collision doesn't go
+    //   on to hit anything else.
+    eventBus.subscribe<ModelCollisionEvent>([this](const ModelCollisionEvent &event) {
+      if (!modelManager.isModelRegistered(event.model->getModelHandle()) || !modelManager.isModelRegistered(event.otherModel->getModelHandle()))
+      {
+        return;
+      }
+      event.model->onCollision(event.otherModel);
+      event.otherModel->onCollision(event.model);
+      eventBus.dispatch<ModelDestroyEvent>();
+    });
+  }
+
+  /**
+   * Find the pairs of models whose colliders are close enough to collide, using the box covering each moving model's
+   *   path since its last check. The models on the layers the moving model doesn't collide with are skipped by the
+   *   broadphases, and the models on layers that don't look for collisions themselves aren't moving models.
+   *
+   * @return The list of candidate pairs, ordered by the moving models and then by the IDs of the models they might hit.
+   */
+  std::vector<CandidatePair> findCandidatePairs()
+  {
+    std::vector<CandidatePair> candidatePairs({});
+    std::unordered_map<SlotHandle, glm::vec3> currentPositions({});
+    for (const auto &model : modelManager.getAllModels())
+    {
+      const auto collisionMask = model->getColliderDetails()->getCollisionMask();
+      if (collisionMask == 0 || !modelManager.isModelRegistered(model->getModelHandle()))
+      {
+        continue;
+      }
+
+      // Models checked for the first time are only tested where they are now.
+      const auto previousPosition = previousPositions.find(model->getModelHandle());
+      const auto startPosition = previousPosition != previousPositions.end() ? previousPosition->second : model->getModelPosition();
+      currentPositions.emplace(model->getModelHandle(), model->getModelPosition());
+
+      // Cover the box of the model at both ends of its path.
+      const auto &transformedBox = model->getColliderDetails()->getColliderShape()->getTransformedBox();
+      const auto offset = startPosition - model->getModelPosition();
+      const AxisAlignedBoundingBox pathBox(glm::min(transformedBox.getMinCorner(), transformedBox.getMinCorner() + offset),
+                                           glm::max(transformedBox.getMaxCorner(), transformedBox.getMaxCorner() + offset));
+
+      for (const auto &otherModel : modelManager.getCollisionCandidates(pathBox, collisionMask))
+      {
+        // A model on a layer that collides with itself still doesn't collide with itself.
+        if (otherModel != model)
+        {
+          candidatePairs.push_back({model, otherModel, startPosition});
+        }
+      }
+    }
+    // Only the moving models that still exist need their positions kept.
+    previousPositions.swap(currentPositions);
+    return candidatePairs;
+  }
+
+  /**
+   * Drop the candidate pairs whose models are still too far apart to have collided, by how far apart their bounding
+   *   spheres were when the pairs were last tested, less how far both models moved since. Neither model can have got
+   *   closer to the other by more than that, so while any of the separation is left, the pair is skipped without being
+   *   tested. The separations of the pairs that are tested are measured again where their models are now.
+   *
+   * @param candidatePairs  The candidate pairs, which the pairs still separated are removed from, keeping the order.
+   */
+  void removeSeparatedPairs(std::vector<CandidatePair> &candidatePairs)
+  {
+    checksCount++;
+    const auto candidatePairsEnd = std::remove_if(candidatePairs.begin(), candidatePairs.end(), [&](const CandidatePair &candidatePair) {
+      const auto &model = candidatePair.model;
+      const auto &otherModel = candidatePair.otherModel;
+      const auto radiusSum = model->getColliderDetails()->getColliderShape()->getBoundingRadius() +
+                             otherModel->getColliderDetails()->getColliderShape()->getBoundingRadius();
+      auto &pairSeparation = pairSeparations[{model->getModelHandle(), otherModel->getModelHandle()}];
+      const auto found = pairSeparation.lastCheck != 0 && pairSeparation.radiusSum == radiusSum;
+      pairSeparation.lastCheck = checksCount;
+      if (found)
+      {
+        pairSeparation.separation -= glm::length(model->getModelPosition() - candidatePair.previousPosition) +
+                                     glm::length(otherModel->getModelPosition() - pairSeparation.otherPosition);
+        pairSeparation.otherPosition = otherModel->getModelPosition();
+        if (pairSeparation.separation > 0.0f)
+        {
+          return true;
+        }
+      }
+      pairSeparation = {otherModel->getModelPosition(), glm::length(model->getModelPosition() - otherModel->getModelPosition()) - radiusSum, radiusSum, checksCount};
+      return false;
+    });
+    separatedPairsCount = candidatePairs.end() - candidatePairsEnd;
+    candidatePairs.erase(candidatePairsEnd, candidatePairs.end());
+
+    // Forget the pairs the broadphase didn't find this time.
+    for (auto pairSeparation = pairSeparations.begin(); pairSeparation != pairSeparations.end();)
+    {
+      pairSeparation = pairSeparation->second.lastCheck != checksCount ? pairSeparations.erase(pairSeparation) : std::next(pairSeparation);
+    }
+  }
+
+  /**
+   * Test whether the moving model of the pair collides with the other model anywhere along its path, with a single swept
+   *   test of their colliders.
+   *
+   * @param candidatePair  The pair to test.
+   * @param timeOfImpact   The time to store the time along the path the models collide at.
+   *
+   * @return Whether the models collided.
+   */
+  static bool haveModelsCollided(const CandidatePair &candidatePair, float_t &timeOfImpact)
+  {
+    const auto &model = candidatePair.model;
+    return DeepCollisionValidator::getTimeOfImpact(*model->getColliderDetails()->getColliderShape(), model->getModelPosition() - candidatePair.previousPosition,
+                                                   *candidatePair.otherModel->getColliderDetails()->getColliderShape(), timeOfImpact);
+  }
+
+  /**
+   * Test the candidate pairs in the given range, all sharing the same moving model. The other models of the pairs with
+   *   sphere colliders are tested together in a batch when the moving model has a sphere or a box collider, and the rest
+   *   are tested a pair at a time.
+   *
+   * @param candidatePairs  The candidate pairs.
+   * @param start           The index of the first pair of the range.
+   * @param end             The index after the last pair of the range.
+   * @param taskIndex       The index of the narrowphase task, picking the batch to use.
+   * @param events          The list to add the collisions of the pairs that collided to, in the order of the pairs.
+   */
+  void testCandidatePairs(const std::vector<CandidatePair> &candidatePairs, const size_t &start, const size_t &end, const uint32_t &taskIndex,
+                          std::vector<CollisionEvent> &events)
+  {
+    const auto &model = candidatePairs[start].model;
+    const auto &shape = model->getColliderDetails()->getColliderShape();
+    const auto motion = model->getModelPosition() - candidatePairs[start].previousPosition;
+
+    // Gather the sphere colliders of the other models, if the moving model's collider can be tested against a batch of them.
+    auto &batch = narrowphaseBatches[taskIndex];
+    batch.clear();
+    if (shape->getType() == ColliderShapeType::SPHERE || shape->getType() == ColliderShapeType::BOX)
+    {
+      for (auto i = start; i < end; i++)
+      {
+        const auto &otherShape = candidatePairs[i].otherModel->getColliderDetails()->getColliderShape();
+        if (otherShape->getType() == ColliderShapeType::SPHERE)
+        {
+          batch.add(static_cast<const SphereColliderShape &>(*otherShape));
+        }
+      }
+    }
+
+    // Moving spheres get their times of impact straight from the batch, while moving boxes only use it to skip the spheres
+    //   that can't be hit.
+    auto &batchHits = narrowphaseBatchHits[taskIndex];
+    auto &batchTimesOfImpact = narrowphaseBatchTimesOfImpact[taskIndex];
+    if (batch.size() > 0 && shape->getType() == ColliderShapeType::SPHERE)
+    {
+      batch.getSphereTimesOfImpact(static_cast<const SphereColliderShape &>(*shape), motion, batchHits, batchTimesOfImpact);
+    }
+    else if (batch.size() > 0)
+    {
+      batch.getBoxPathOverlaps(static_cast<const BoxColliderShape &>(*shape), motion, batchHits);
+    }
+
+    size_t batchIndex = 0;
+    for (auto i = start; i < end; i++)
+    {
+      const auto &otherShape = candidatePairs[i].otherModel->getColliderDetails()->getColliderShape();
+      auto collided = false;
+      auto timeOfImpact = 0.0f;
+      if (batch.size() == 0 || otherShape->getType() != ColliderShapeType::SPHERE)
+      {
+        collided = haveModelsCollided(candidatePairs[i], timeOfImpact);
+      }
+      else if (shape->getType() == ColliderShapeType::SPHERE)
+      {
+        collided = batchHits[batchIndex++];
+        timeOfImpact = batchTimesOfImpact[batchIndex - 1];
+      }
+      else
+      {
+        collided = batchHits[batchIndex++] && haveModelsCollided(candidatePairs[i], timeOfImpact);
+      }
+      if (collided)
+      {
+        events.push_back({model, candidatePairs[i].otherModel, timeOfImpact});
+      }
+    }
+  }
+
+public:
+  // Preventing copying the collision manager, making sure only one instance can exist.
+  CollisionManager(const CollisionManager &) = delete;
+
+  /**
+   * Register a pair of collision layers whose models collide. The other models are tested where they are now, so the
+   *   fast models should be on the layers of the moving models of the pairs.
+   *
+   * @param layers       The mask of the layers of the moving models.
+   * @param otherLayers  The mask of the layers of the models they collide with.
+   */
+  void registerCollisionPair(const uint32_t &layers, const uint32_t &otherLayers)
+  {
+    ColliderDetails::setLayersCollide(layers, otherLayers);
+  }
+
+  /**
+   * De-register all the pairs of collision layers, and forget the positions of the moving models.
+   */
+  void deregisterAllCollisionPairs()
+  {
+    ColliderDetails::clearLayerCollisions();
+    previousPositions.clear();
+    pairSeparations.clear();
+    collisionEvents.clear();
+  }
+
+  /**
+   * Find the collisions between the models of the registered pairs, then let the models of each collision react to it
+   *   in the order they happened along the paths. A collision is skipped if one of its models was de-registered while
+   *   reacting to an earlier collision, so a model destroyed by a collision doesn't go on to hit anything else.
+   * 
+   * @param frameTime  The time of the frame.
+   */
+  void updateCollisions(const FrameTime &)
+  {
+    // Find the pairs close enough to collide.
+    std::vector<CandidatePair> candidatePairs({});
+    {
+      ProfileZone broadphaseZone("Collision Broadphase");
+      candidatePairs = findCandidatePairs();
+      candidatePairsCount = candidatePairs.size();
+      removeSeparatedPairs(candidatePairs);
+    }
+
+    // The colliders generate some of their details the first time they are read after moving, so generate them for
+    //   the colliders of the pairs here, leaving the parallel tests to only read them.
+    for (const auto &candidatePair : candidatePairs)
+    {
+      candidatePair.model->getColliderDetails()->getColliderShape()->resolveTransformations();
+      candidatePair.otherModel->getColliderDetails()->getColliderShape()->resolveTransformations();
+    }
+
+    // Test the pairs in parallel. The swept tests only read the colliders, so the pairs can be split anywhere, with each
+    //   task testing the pairs of each moving model in its part together, and adding the collisions it finds to its own
+    //   list so the tasks never share anything they write to.
+    uint32_t narrowphaseTasksCount = 0;
+    {
+      ProfileZone narrowphaseZone("Collision Narrowphase");
+      narrowphaseTasksCount = ParallelTasks::runChunked(candidatePairs.size(), MIN_PARALLEL_PAIRS, [&](const uint32_t taskIndex, const size_t start, const size_t end) {
+        auto &events = narrowphaseEvents[taskIndex];
+        events.clear();
+        auto modelStart = start;
+        for (auto i = start + 1; i <= end; i++)
+        {
+          if (i == end || candidatePairs[i].model != candidatePairs[modelStart].model)
+          {
+            testCandidatePairs(candidatePairs, modelStart, i, taskIndex, events);
+            modelStart = i;
+          }
+        }
+      });
+      narrowphaseChecksCount = candidatePairs.size();
+    }
+
+    // Emit the collisions in the order they happened, and in the order of the pairs for the ones happening at the same
+    //   time, so the reactions happen in the same order every time. The tasks cover the pairs in order, so merging their
+    //   lists in the order of the tasks gives the collisions in the order of the pairs, however many tasks there were.
+    collisionEvents.clear();
+    for (uint32_t taskIndex = 0; taskIndex < narrowphaseTasksCount; taskIndex++)
+    {
+      collisionEvents.insert(collisionEvents.end(), narrowphaseEvents[taskIndex].begin(), narrowphaseEvents[taskIndex].end());
+      // Drop the models of the collisions, so the ones destroyed by them aren't kept alive until the next check.
+      narrowphaseEvents[taskIndex].clear();
+    }
+    std::stable_sort(collisionEvents.begin(), collisionEvents.end(), [](const CollisionEvent &event1, const CollisionEvent &event2) {
+      return event1.timeOfImpact < event2.timeOfImpact;
+    });
+
+    // Publish the collisions in that order, and let the models react to them.
+    for (const auto &collisionEvent : collisionEvents)
+    {
+      eventBus.publish(ModelCollisionEvent({collisionEvent.model, collisionEvent.otherModel}));
+    }
+    eventBus.dispatch<ModelCollisionEvent>();
+  }
+
+  /**
+   * Find the first registered model on the given collision layers the ray hits. The broadphase finds the models on the
+   *   layers sharing a cell with the box around the ray, which the slab test against the boxes of their colliders narrows
+   *   down before their shapes are tested. Of the models hit at the same distance, such as when the ray starts inside
+   *   several of them, the one with the first ID is picked, as when the broadphases returned the models by ID, instead
+   *   of the one that happens to have the first handle.
+   *
+   * @param ray          The ray.
+   * @param maxDistance  The distance along the ray to stop looking at.
+   * @param layerMask    The mask of the collision layers of the models the ray can hit.
+   * @param hit          The hit to store the first model hit at.
+   *
+   * @return Whether the ray hits any of the models before the given distance.
+   */
+  bool raycast(const Ray &ray, const float_t &maxDistance, const uint32_t &layerMask, RaycastHit &hit)
+  {
+    const auto rayEnd = ray.getPoint(maxDistance);
+    const AxisAlignedBoundingBox rayBox(glm::min(ray.origin, rayEnd), glm::max(ray.origin, rayEnd));
+
+    auto nearestDistance = maxDistance;
+    auto hasHit = false;
+    for (const auto &model : modelManager.getCollisionCandidates(rayBox, layerMask))
+    {
+      float_t distance;
+      if (DeepCollisionValidator::raycast(ray, *model->getColliderDetails()->getColliderShape(), nearestDistance, distance) &&
+          (!hasHit || distance < nearestDistance || model->getModelId() < hit.model->getModelId()))
+      {
+        nearestDistance = distance;
+        hit = {model, distance, ray.getPoint(distance)};
+        hasHit = true;
+      }
+    }
+    return hasHit;
+  }
+
+  /**
+   * Get the collisions found by the latest check.
+   *
+   * @return The list of collisions.
+   */
+  const std::vector<CollisionEvent> &getCollisionEvents() const
+  {
+    return collisionEvents;
+  }
+
+  /**
+   * Get the number of candidate pairs the broadphase found in the latest check.
+   *
+   * @return The number of candidate pairs.
+   */
+  const uint32_t &getCandidatePairsCount() const
+  {
+    return candidatePairsCount;
+  }
+
+  /**
+   * Get the number of candidate pairs skipped in the latest check, since their models were still too far apart.
+   *
+   * @return The number of separated pairs.
+   */
+  const uint32_t &getSeparatedPairsCount() const
+  {
+    return separatedPairsCount;
+  }
+
+  /**
+   * Get the number of narrowphase tests made in the latest check, one swept test for each candidate pair that wasn't
+   *   skipped.
+   *
+   * @return The number of narrowphase tests.
+   */
+  const uint32_t &getNarrowphaseChecksCount() const
+  {
+    return narrowphaseChecksCount;
+  }
+
+  /**
+   * Returns the instance of the collision manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
+   * 
+   * @return The collision manager instance.
+   */
+  static CollisionManager &getInstance()
+  {
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
+  }
+};
+
+#endif
@@ -4,91 +4,186 @@
 #include <iostream>
 #include <string>
 #include <map>
-#include <set>
-#include <limits>
 
 #include <GL/glew.h>
 
+#include "gl_state.cpp"
+
 /**
- * Class for storing the vertex attribute array information.
+ * Class for defining the vertex attribute arrays of vertex array objects.
+ * A vertex array object records the attribute layout of its buffers once, so drawing only requires binding it.
  */
-class VertexAttributeArray
+class VertexArray
 {
-private:
-  // The set of attribute IDs already in use.
-  static std::set<GLuint> attributeIds;
+public:
+  /**
+   * Create a new vertex array object.
+   * 
+   * @return The ID of the vertex array object.
+   */
+  static GLuint create()
+  {
+    // Define a variable for storing the vertex array ID.
+    GLuint vertexArrayId;
+    // Create a new vertex array and store the ID.
+    glGenVertexArrays(1, &vertexArrayId);
+    // Return the ID of the created vertex array.
+    return vertexArrayId;
+  }
+
+  /**
+   * Attach a buffer to the currently bound vertex array object as the given vertex attribute.
+   * 
+   * @param attributeId        The location of the attribute in the shaders.
+   * @param bufferId           The ID of the buffer the attribute is linked to.
+   * @param bufferElementSize  The size of the elements in the buffer.
+   * @param stride             The distance in bytes between consecutive elements, or 0 if they are tightly packed.
+   * @param offset             The offset in bytes of the first element in the buffer.
+   * @param attributeType      The type of the attribute data.
+   * @param normalized         Whether integer attribute data is read as a fraction of the range of its type.
+   */
+  static void attachAttribute(const GLuint &attributeId, const GLuint &bufferId, const uint32_t &bufferElementSize, const size_t &stride = 0, const size_t &offset = 0, const GLenum &attributeType = GL_FLOAT, const GLboolean &normalized = GL_FALSE)
+  {
+    // Enable the vertex attribute array for being used by the GPU.
+    glEnableVertexAttribArray(attributeId);
+    // Bind the buffer as the array buffer the vertex attribute will link with.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, bufferId);
+    // Define the details regarding the vertex attribute list stored in the array buffer.
+    glVertexAttribPointer(attributeId, bufferElementSize, attributeType, normalized, stride, (void *)offset);
+    // Unbind the buffer now that the vertex array has recorded it.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+  }
 
-  // The ID of the attribute.
-  const GLuint attributeId;
-  // The name of the attribute.
-  const std::string attributeName;
-  // The ID of the buffer the attribute is linked to.
-  const GLuint bufferId;
-  // The size of the elements in the buffer.
-  const uint32_t bufferElementSize;
-  // The type of the attribute data
-  const GLenum attributeType;
+  /**
+   * Attach an element buffer to the currently bound vertex array object as its index buffer.
+   * 
+   * @param bufferId  The ID of the element buffer containing the vertex indices.
+   */
+  static void attachIndexBuffer(const GLuint &bufferId)
+  {
+    // Bind the buffer as the element array buffer, which is recorded by the vertex array and so must stay bound.
+    GlStateCache::getInstance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferId);
+  }
 
   /**
-   * Creates a new attribute ID for the current attribute to use.
+   * Attach a buffer of model matrices to the currently bound vertex array object as the per-instance matrix attribute.
+   * The matrix takes up four consecutive attribute locations, one for each column.
    * 
-   * @return The attribute ID.
+   * @param attributeId    The location of the first column of the attribute in the shaders.
+   * @param bufferId       The ID of the buffer containing the model matrices.
+   * @param firstInstance  The index of the matrix in the buffer to use for the first instance drawn.
+   * @param divisor        The number of instances drawn with each matrix.
    */
-  GLuint createAttributeId()
+  static void attachInstanceMatrixAttribute(const GLuint &attributeId, const GLuint &bufferId, const uint32_t &firstInstance, const GLuint &divisor = 1)
   {
-    // Get the maximum possible attribute ID that can be used.
-    const GLuint maxId = std::numeric_limits<GLuint>::max();
-    // Iterate through all possible attribute IDs that can be used.
-    for (GLuint i = 0; i < maxId; i++)
+    // Bind the buffer as the array buffer the vertex attribute will link with.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, bufferId);
+    // Iterate through the columns of the matrix.
+    for (GLuint column = 0; column < 4; column++)
     {
-      // Check if the atribute ID is being used.
-      if (attributeIds.find(i) == attributeIds.end())
-      {
-        // The attribute ID is available. Return it for use.
-        return i;
-      }
+      // Enable the vertex attribute array of the column for being used by the GPU.
+      glEnableVertexAttribArray(attributeId + column);
+      // Define the details regarding the column, which is a vec4 at an offset of the column within the matrix.
+      glVertexAttribPointer(attributeId + column, 4, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 16, (void *)(sizeof(GLfloat) * (16 * firstInstance + 4 * column)));
+      // Advance the attribute once every divisor instances instead of once per vertex.
+      glVertexAttribDivisor(attributeId + column, divisor);
     }
-
-    // Could not get an available attribute ID. Time to crash.
-    std::cout << "Failed at vertex attribute array" << std::endl;
-    exit(1);
+    // Unbind the buffer now that the vertex array has recorded it.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
   }
 
-public:
-  // Preventing copying the vertex attribute array, making sure only one instance can exist.
-  VertexAttributeArray(const VertexAttributeArray &) = delete;
-
-  VertexAttributeArray(const std::string &attributeName, const GLuint &bufferId, const uint32_t &bufferElementSize, const GLenum &attributeType = GL_FLOAT)
-      : attributeId(createAttributeId()),
-        attributeName(attributeName),
-        bufferId(bufferId),
-        bufferElementSize(bufferElementSize),
-        attributeType(attributeType)
+  /**
+   * Attach a buffer of unsigned integers to the currently bound vertex array object as a per-instance integer attribute.
+   * 
+   * @param attributeId    The location of the attribute in the shaders.
+   * @param bufferId       The ID of the buffer containing the integers.
+   * @param firstInstance  The index of the integer in the buffer to use for the first instance drawn.
+   * @param divisor        The number of instances drawn with each integer.
+   */
+  static void attachInstanceIntegerAttribute(const GLuint &attributeId, const GLuint &bufferId, const uint32_t &firstInstance, const GLuint &divisor = 1)
   {
-    // Insert it to the set of attribute IDs being used.
-    attributeIds.insert(attributeId);
+    // Bind the buffer as the array buffer the vertex attribute will link with.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, bufferId);
+    // Enable the vertex attribute array for being used by the GPU.
+    glEnableVertexAttribArray(attributeId);
+    // Define the details regarding the attribute, which is read as an integer instead of being converted to a float.
+    glVertexAttribIPointer(attributeId, 1, GL_UNSIGNED_INT, 0, (void *)(sizeof(GLuint) * firstInstance));
+    // Advance the attribute once every divisor instances instead of once per vertex.
+    glVertexAttribDivisor(attributeId, divisor);
+    // Unbind the buffer now that the vertex array has recorded it.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
   }
 
-  ~VertexAttributeArray()
+  /**
+   * Attach a buffer of float vectors to the currently bound vertex array object as a per-instance attribute.
+   * 
+   * @param attributeId      The location of the attribute in the shaders.
+   * @param bufferId         The ID of the buffer containing the vectors.
+   * @param componentsCount  The number of components of each vector.
+   * @param firstInstance    The index of the vector in the buffer to use for the first instance drawn.
+   * @param divisor          The number of instances drawn with each vector.
+   */
+  static void attachInstanceVectorAttribute(const GLuint &attributeId, const GLuint &bufferId, const GLint &componentsCount, const uint32_t &firstInstance, const GLuint &divisor = 1)
   {
-    // Delete the attribute ID from the set of used IDs.
-    attributeIds.erase(attributeId);
-    // Disable the vertex attribute array from being used by the GPU.
-    glDisableVertexAttribArray(attributeId);
+    // Bind the buffer as the array buffer the vertex attribute will link with.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, bufferId);
+    // Enable the vertex attribute array for being used by the GPU.
+    glEnableVertexAttribArray(attributeId);
+    // Define the details regarding the attribute, which is a tightly packed vector of floats.
+    glVertexAttribPointer(attributeId, componentsCount, GL_FLOAT, GL_FALSE, 0, (void *)(sizeof(GLfloat) * componentsCount * firstInstance));
+    // Advance the attribute once every divisor instances instead of once per vertex.
+    glVertexAttribDivisor(attributeId, divisor);
+    // Unbind the buffer now that the vertex array has recorded it.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
   }
 
-  void enableAttribute()
+  /**
+   * Attach a buffer of interleaved instance records to the currently bound vertex array object as a per-instance
+   * attribute, read from one field of each record.
+   * 
+   * @param attributeId      The location of the attribute in the shaders.
+   * @param bufferId         The ID of the buffer containing the records.
+   * @param componentsCount  The number of components of the field.
+   * @param stride           The size in bytes of each record.
+   * @param offset           The offset in bytes of the field of the record of the first instance drawn.
+   * @param attributeType    The type of the field data.
+   * @param normalized       Whether integer field data is read as a fraction of the range of its type.
+   */
+  static void attachInstanceRecordAttribute(const GLuint &attributeId, const GLuint &bufferId, const GLint &componentsCount, const size_t &stride, const size_t &offset, const GLenum &attributeType = GL_FLOAT, const GLboolean &normalized = GL_FALSE)
   {
+    // Bind the buffer as the array buffer the vertex attribute will link with.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, bufferId);
     // Enable the vertex attribute array for being used by the GPU.
     glEnableVertexAttribArray(attributeId);
+    // Define the details regarding the attribute, which is a field of the records spaced out by their size.
+    glVertexAttribPointer(attributeId, componentsCount, attributeType, normalized, stride, (void *)offset);
+    // Advance the attribute once per instance instead of once per vertex.
+    glVertexAttribDivisor(attributeId, 1);
+    // Unbind the buffer now that the vertex array has recorded it.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  /**
+   * Attach a buffer of bindless texture handles to the currently bound vertex array object as a per-instance attribute.
+   * Each 64-bit handle is read as a pair of unsigned integers, which the shaders turn back into a sampler.
+   * 
+   * @param attributeId    The location of the attribute in the shaders.
+   * @param bufferId       The ID of the buffer containing the texture handles.
+   * @param firstInstance  The index of the handle in the buffer to use for the first instance drawn.
+   */
+  static void attachInstanceTextureHandleAttribute(const GLuint &attributeId, const GLuint &bufferId, const uint32_t &firstInstance)
+  {
     // Bind the buffer as the array buffer the vertex attribute will link with.
-    glBindBuffer(GL_ARRAY_BUFFER, bufferId);
-    // Define the details regarding the vertex attribute list stored in the array buffer.
-    glVertexAttribPointer(attributeId, bufferElementSize, attributeType, GL_FALSE, 0, (void *)0);
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, bufferId);
+    // Enable the vertex attribute array for being used by the GPU.
+    glEnableVertexAttribArray(attributeId);
+    // Define the details regarding the attribute, which is a pair of integers instead of being converted to floats.
+    glVertexAttribIPointer(attributeId, 2, GL_UNSIGNED_INT, 0, (void *)(sizeof(GLuint64) * firstInstance));
+    // Advance the attribute once per instance instead of once per vertex.
+    glVertexAttribDivisor(attributeId, 1);
+    // Unbind the buffer now that the vertex array has recorded it.
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
   }
 };
 
-// Initialize the set of used attribute IDs to an empty set.
-std::set<GLuint> VertexAttributeArray::attributeIds = std::set<GLuint>({});
-
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_CONSTANTS_CPP
 #define INCLUDE_CONSTANTS_CPP
 
+#include <string>
+
 /**
  * A bunch of constants that's required to be known globally.
  */
@@ -10,16 +12,261 @@ const int32_t WINDOW_HEIGHT = 768;
 const float_t ASPECT_RATIO = WINDOW_WIDTH / WINDOW_HEIGHT;
 const int32_t MAX_CONE_LIGHTS = 2;
 const int32_t MAX_POINT_LIGHTS = 5;
-const int32_t MAX_LIGHTS = MAX_CONE_LIGHTS + MAX_POINT_LIGHTS;
+const int32_t MAX_DIRECTIONAL_LIGHTS = 1;
+const int32_t MAX_LIGHTS = MAX_CONE_LIGHTS + MAX_POINT_LIGHTS + MAX_DIRECTIONAL_LIGHTS;
+// The number of layers of the shadow atlases, in 2D layers for cone lights, in cube maps for point lights and in stacks
+// of cascades for directional lights, along with the number of tile sizes the layers can be split into.
+const uint32_t CONE_SHADOW_ATLAS_LAYERS = MAX_CONE_LIGHTS;
+const uint32_t POINT_SHADOW_ATLAS_LAYERS = 2;
+const uint32_t DIRECTIONAL_SHADOW_ATLAS_LAYERS = MAX_DIRECTIONAL_LIGHTS;
+const uint32_t SHADOW_ATLAS_TILE_LEVELS = 4;
+// The most layers the shadow atlases of each type of light grow to when they run out of space, doubling their layers
+// each time, and the GPU memory in bytes the shadow atlases can take up together, past which the lights that don't fit
+// go without shadows instead.
+const uint32_t CONE_SHADOW_ATLAS_MAX_LAYERS = 8;
+const uint32_t POINT_SHADOW_ATLAS_MAX_LAYERS = 8;
+const uint32_t DIRECTIONAL_SHADOW_ATLAS_MAX_LAYERS = 4;
+uint64_t SHADOW_ATLAS_MEMORY_BUDGET = 256 * 1024 * 1024;
+// The width and height of the layers of the shadow atlases of each type of light, in texels, which the largest shadow maps
+// of the type take up. They're set apart from the size of the window, so bigger displays don't multiply the memory and the
+// fill of the shadows, and they can be picked by the options before the shadow atlases are created.
+uint32_t CONE_SHADOW_ATLAS_SIZE = 1024;
+uint32_t POINT_SHADOW_ATLAS_SIZE = 1024;
+uint32_t DIRECTIONAL_SHADOW_ATLAS_SIZE = 1024;
+// The number of shadow cascades of a directional light, each covering a slice of the view frustum of the camera further
+// out than the one before, how much the slices are split logarithmically rather than evenly, and how far behind each
+// slice the cascades still catch the models casting shadows into it.
+const uint32_t SHADOW_CASCADES_COUNT = 4;
+const float_t SHADOW_CASCADE_SPLIT_LAMBDA = 0.75f;
+const float_t SHADOW_CASCADE_CASTER_DISTANCE = 50.0f;
+// The number of light clusters along the width, height and depth of the view frustum, which must match the model shaders,
+// and the attenuation below which a light no longer reaches the clusters around it.
+const uint32_t LIGHT_CLUSTER_GRID_WIDTH = 16;
+const uint32_t LIGHT_CLUSTER_GRID_HEIGHT = 9;
+const uint32_t LIGHT_CLUSTER_GRID_DEPTH = 24;
+const float_t CLUSTERED_LIGHT_ATTENUATION_CUTOFF = 0.05f;
+// The number of round-robin shadow maps rendered each frame, and their size as a fraction of the size they'd have as
+// full shadow maps.
+const uint32_t ROUND_ROBIN_SHADOW_UPDATES = 1;
+const float_t ROUND_ROBIN_SHADOW_MAP_SCALE = 0.5f;
+// The number of shot lights casting shadows, with the rest only glowing, and the number of faces of their shadow maps
+// rendered again each frame while they're stale.
+const uint32_t SHADOWED_SHOT_LIGHTS_COUNT = 1;
+const uint32_t SHOT_LIGHT_FACES_PER_UPDATE = 2;
+// The most projectiles there can be at once, and the number of projectiles the player sprays every burst interval, in
+// seconds, the speed they fly at and the time they fly for before they're removed.
+const uint32_t MAX_PROJECTILES_COUNT = 16384;
+const uint32_t PROJECTILE_BURST_SIZE = 96;
+const float_t PROJECTILE_BURST_INTERVAL = 1.0f / 60.0f;
+const float_t PROJECTILE_SPEED = 40.0f;
+const float_t PROJECTILE_LIFETIME = 2.0f;
+// The most bursts of hit particles there can be at once, the number of particles in each burst, and the longest time
+// a particle lives for, in seconds, after which the particles are left alone until the next burst.
+const uint32_t MAX_PARTICLE_EMITTERS = 32;
+const uint32_t PARTICLES_PER_EMITTER = 256;
+const float_t PARTICLE_MAX_LIFETIME = 1.2f;
+// The render layers models are drawn in unless they're given others, which the camera views pick the models they draw by.
+const uint32_t DEFAULT_RENDER_LAYERS = 1;
+// The lowest scale of the resolution the scene is rendered at with dynamic resolution, how much the scale changes at a
+// time, and the number of frames the GPU timers get to measure a scale before it changes again.
+const float_t MIN_RESOLUTION_SCALE = 0.5f;
+const float_t RESOLUTION_SCALE_STEP = 0.05f;
+const uint32_t RESOLUTION_SCALE_INTERVAL = 15;
 const int32_t MAX_TEXT_LENGTH = 80;
-const int32_t MAX_TEXT_CHARS = 10240;
+// The number of characters the buffer the text is streamed through starts with room for each frame, which it grows past
+// when a frame has more.
+const int32_t INITIAL_TEXT_CHARS = 10240;
+// The most characters a number is written with in the text, so it can be formatted in place.
+const uint32_t MAX_FORMATTED_NUMBER_LENGTH = 64;
+// The number of times a second the text overlay is drawn again, being composited from the texture it was last drawn into
+// in the frames in between, or 0 to draw it again every frame.
+float_t TEXT_OVERLAY_REFRESH_RATE = 0.0f;
+// The pixel size the glyphs of signed distance field fonts are rendered at, which doesn't depend on the size of the
+// viewport, and the distance in pixels from the outline of the glyphs the fields reach.
+const uint32_t TEXT_SDF_GLYPH_SIZE = 48;
+const uint32_t TEXT_SDF_SPREAD = 6;
+// The width and height of the glyph atlas of the font, which the characters are rasterized into the first time they're
+// used, and taken back out of once they haven't been used for the longest time of the characters and the atlas is full.
+const uint32_t TEXT_GLYPH_ATLAS_SIZE = 1024;
+const uint32_t LIGHT_UNIFORM_BLOCK_BINDING = 0;
+const uint32_t CAMERA_UNIFORM_BLOCK_BINDING = 1;
+const uint32_t FRAME_UNIFORM_BLOCK_BINDING = 2;
+const uint32_t VERTEX_POSITION_ATTRIBUTE_LOCATION = 0;
+const uint32_t VERTEX_UV_ATTRIBUTE_LOCATION = 1;
+const uint32_t VERTEX_NORMAL_ATTRIBUTE_LOCATION = 2;
+const uint32_t INSTANCE_MATRIX_ATTRIBUTE_LOCATION = 3;
+const uint32_t INSTANCE_SHADOW_MASK_ATTRIBUTE_LOCATION = 7;
+// The model shaders read the masks of the lights reaching the instances where the light shaders read the shadow masks.
+const uint32_t INSTANCE_LIGHT_MASK_ATTRIBUTE_LOCATION = INSTANCE_SHADOW_MASK_ATTRIBUTE_LOCATION;
+// The sprite shader reads the texture array layers of the sprite instances there as well.
+const uint32_t INSTANCE_SPRITE_ATTRIBUTE_LOCATION = INSTANCE_SHADOW_MASK_ATTRIBUTE_LOCATION;
+const uint32_t INSTANCE_COLOR_ATTRIBUTE_LOCATION = 8;
+const uint32_t VERTEX_COLOR_ATTRIBUTE_LOCATION = 9;
+const uint32_t INSTANCE_TEXTURE_HANDLE_ATTRIBUTE_LOCATION = 10;
+const uint32_t INSTANCE_SPIN_ATTRIBUTE_LOCATION = 11;
+// The impostor variant of the model shaders reads the views of the impostor instances in place of their spins.
+const uint32_t INSTANCE_IMPOSTOR_ATTRIBUTE_LOCATION = INSTANCE_SPIN_ATTRIBUTE_LOCATION;
+const uint32_t TEXTURE_UPLOAD_BUFFER_SIZE = 4 * 1024 * 1024;
+const uint32_t TEXTURE_UPLOAD_BUFFER_COUNT = 3;
+// The number of bytes of the textures of the scenes being preloaded that are uploaded each frame of the running scene,
+// so preloading doesn't hitch the frames.
+const uint32_t PRELOAD_UPLOAD_BYTES_PER_FRAME = TEXTURE_UPLOAD_BUFFER_SIZE;
+// The size in pixels of the largest mip level of a block compressed texture uploaded when it's loaded, with the finer
+// levels streamed in once the models using the texture get big enough on the screen, and the number of bytes of the
+// streamed levels uploaded each frame.
+const uint32_t TEXTURE_STREAMING_INITIAL_SIZE = 64;
+const uint32_t TEXTURE_STREAMING_BYTES_PER_FRAME = TEXTURE_UPLOAD_BUFFER_SIZE;
+// The number of frames of data the streaming buffers hold, so the GPU can read the data of the frames before while the
+// next frame writes its own.
+const uint32_t STREAMING_BUFFER_REGION_COUNT = 3;
+// The number of bytes of the model instance data and the debug instance data streamed each frame before the streaming
+// buffers need to grow.
+const uint32_t INSTANCE_STREAMING_BUFFER_SIZE = 1024 * 1024;
+// The number of vertices and indices the mesh arena holds before its buffers need to grow.
+const uint32_t MESH_ARENA_VERTEX_CAPACITY = 256 * 1024;
+const uint32_t MESH_ARENA_INDEX_CAPACITY = 1024 * 1024;
+// The largest distance in pixels the surface of a level of detail of a mesh can be drawn from the full mesh, and the number
+// of levels coarser than that the shadow casters are drawn with.
+const float_t MESH_LOD_PIXEL_ERROR = 1.0f;
+const uint32_t SHADOW_LOD_BIAS = 1;
+// The number of bytes of the indirect draw commands streamed each frame before the streaming buffer needs to grow.
+const uint32_t INDIRECT_STREAMING_BUFFER_SIZE = 64 * 1024;
+// The fewest meshlets a mesh culled on the GPU needs to be drawn a meshlet at a time, and the most draws a group of its
+// instances can be split into, past which the instances are culled whole.
+const uint32_t MESHLET_CULLING_MIN_MESHLETS = 64;
+const uint32_t MESHLET_CULLING_MAX_DRAWS = 2048;
+// The number of packets of work the scene can queue up for the render thread before waiting for it to catch up.
+const uint32_t RENDER_PACKET_QUEUE_SIZE = 64;
+// The time in seconds between the checks for asset files that changed on disk, while hot reloading is enabled.
+const double_t ASSET_WATCH_INTERVAL = 0.5;
+const uint32_t DEBUG_STREAMING_BUFFER_SIZE = 64 * 1024;
+// The number of bytes of the sprite instance data streamed each frame before the streaming buffer needs to grow.
+const uint32_t SPRITE_STREAMING_BUFFER_SIZE = 16 * 1024;
+// The width and height the textures of the sprites are copied into the sprite texture array at, and the number of
+// textures the array holds, with the texture used the longest time ago taken back out once it's full.
+const uint32_t SPRITE_TEXTURE_SIZE = 512;
+const uint32_t SPRITE_TEXTURE_LAYERS_COUNT = 8;
+// The number of bytes of the impostor instance data streamed each frame before the streaming buffer needs to grow.
+const uint32_t IMPOSTOR_STREAMING_BUFFER_SIZE = 64 * 1024;
+// The width and height the views of the objects drawn as impostors are pre-rendered at, the number of views around their
+// vertical axes, and the number of objects the impostor texture arrays hold.
+const uint32_t IMPOSTOR_TEXTURE_SIZE = 128;
+const uint32_t IMPOSTOR_VIEWS_COUNT = 16;
+const uint32_t IMPOSTOR_OBJECTS_COUNT = 4;
+// The size the arena of the scratch data of each frame starts at, which grows to fit the frames going over it.
+const size_t FRAME_ARENA_SIZE = 1024 * 1024;
+const std::string SHADER_CACHE_DIRECTORY = "shader-cache";
+// The number of latest frames of profiling zones written out when a profile trace is exported, and the file they go to.
+const uint64_t PROFILE_TRACE_FRAMES = 120;
+const std::string PROFILE_TRACE_FILE = "profile-trace.json";
+// The number of times longer than the median of the latest frames a frame has to take to count as a hitch, or 0 to not
+//   look for hitches, and the shortest time in milliseconds a hitch can take, so the fast frames aren't counted for a few
+//   missed scheduler ticks. Each hitch writes the latest frames of profiling zones to one of a number of trace files in
+//   the hitch directory, reused in turn.
+double_t HITCH_THRESHOLD = 2.0;
+double_t HITCH_MIN_FRAME_TIME = 20.0;
+const std::string HITCH_TRACE_DIRECTORY = "hitches";
+const uint32_t HITCH_TRACES_KEPT = 8;
+// Whether the window asks for a debug context, whose performance warnings are logged to the file along with the profiling
+//   zones they came from, and the number of times a warning is logged before its repeats are only counted.
+const bool DEBUG_CONTEXT_ENABLED = true;
+const std::string GL_DEBUG_LOG_FILE = "gl-debug.log";
+const uint64_t GL_DEBUG_REPEATED_MESSAGES_LOGGED = 8;
+// The number of pixel pack buffers the captured frames are read back through, which is how many frames can be on their
+//   way to their files at once before new ones are dropped, and the directory the captured frames are written to.
+const uint32_t FRAME_CAPTURE_BUFFERS_COUNT = 4;
+const std::string FRAME_CAPTURE_DIRECTORY = "captures";
+// Whether the profiling zones marked as allocation free stop the program when they allocate, checked once the frames of
+//   a scene have warmed up the storage they reuse.
+bool ALLOCATION_FREE_ZONES_CHECKED = false;
+const uint64_t ALLOCATION_FREE_WARMUP_FRAMES = 120;
+// The number of latest frames the timings of the profiled stages are kept for in the overlay graph.
+const uint32_t FRAME_HISTORY_LENGTH = 240;
+// The number of frames the thread running the scene can push ahead of the telemetry exporter before dropping them, and
+// the number of the latest frames the exported percentiles are taken over.
+const uint32_t TELEMETRY_QUEUE_SIZE = 512;
+const uint32_t TELEMETRY_WINDOW_FRAMES = 600;
+// The number of messages the threads can queue up for the log writer before new ones are dropped, the number of bytes
+//   of the parts of a queued message, and the longest time in seconds a message waits in the queue before it's written.
+const uint32_t LOG_QUEUE_SIZE = 1024;
+const uint32_t LOG_RECORD_SIZE = 256;
+const double_t LOG_WRITE_INTERVAL = 0.05;
+// The number of frames the CPU can queue up ahead of the GPU in the low latency mode limiting the frames in flight.
+const uint32_t LOW_LATENCY_FRAMES_IN_FLIGHT = 1;
+// The size of the cells of the broadphase the model colliders are hashed into, a bit larger than the biggest collider.
+const float_t COLLISION_CELL_SIZE = 4.0f;
+// The margin the colliders are fattened by in the AABB tree broadphase, so small moves don't re-insert them.
+const float_t COLLISION_TREE_MARGIN = 0.25f;
+// The collision layers the colliders can be on, each a bit of a mask, with the colliders on the default layer unless
+// they're given others. The layers that collide with each other are set by the scenes.
+const uint32_t COLLISION_LAYERS_COUNT = 32;
+const uint32_t COLLISION_LAYER_DEFAULT = 1 << 0;
+const uint32_t COLLISION_LAYER_PLAYER = 1 << 1;
+const uint32_t COLLISION_LAYER_SHOT = 1 << 2;
+const uint32_t COLLISION_LAYER_ENEMY = 1 << 3;
+const uint32_t COLLISION_LAYER_MENU = 1 << 4;
+// The time the game simulation moves forward by in each step, and the most time it catches up on after a slow frame
+// before dropping the rest, in seconds.
+const double_t SIMULATION_TIME_STEP = 1.0 / 120.0;
+const double_t MAX_SIMULATION_CATCH_UP_TIME = 0.25;
 
 int32_t VIEWPORT_WIDTH = WINDOW_WIDTH;
 int32_t VIEWPORT_HEIGHT = WINDOW_HEIGHT;
-int32_t FRAMEBUFFER_WIDTH = VIEWPORT_WIDTH;
-int32_t FRAMEBUFFER_HEIGHT = VIEWPORT_HEIGHT;
 int32_t TEXT_HEIGHT = VIEWPORT_HEIGHT / 26;
 int32_t TEXT_WIDTH = VIEWPORT_WIDTH / 80;
 int32_t SWAP_INTERVAL = 0;
+// The frame rate the frames are limited to in the frame rate cap mode of V-Sync, and the time before the end of each
+// frame the limiter stops sleeping and spins instead, since sleeping can overshoot by about a scheduler tick.
+uint32_t FRAME_RATE_CAP = 60;
+const double_t FRAME_RATE_CAP_SPIN_TIME = 0.002;
+// Whether the frames are slowed down to the idle frame rate while the window is minimized or unfocused, skipping the
+// render while it's minimized, and whether the scene is kept from updating while the window is idle.
+bool IDLE_THROTTLE_ENABLED = true;
+uint32_t IDLE_FRAME_RATE = 5;
+bool IDLE_PAUSE_ENABLED = false;
+// The time the GPU can spend rendering the shadow maps of a frame, in milliseconds, before the light scheduler moves
+// the least important lights off full shadow maps.
+float_t SHADOW_RENDER_BUDGET = 2.0f;
+// The time the GPU can spend rendering a frame, in milliseconds, before dynamic resolution lowers the resolution.
+float_t GPU_RENDER_BUDGET = 12.0f;
+// The size on the screen in pixels below which the models having impostors are drawn as impostors, or 0 to never draw
+// them as impostors, and how many times bigger than that they start fading into their impostors.
+float_t IMPOSTOR_SCREEN_SIZE = 48.0f;
+const float_t IMPOSTOR_FADE_RANGE = 1.5f;
+// The budgets for keeping unused resources resident, in bytes of GPU memory for objects and textures, and in programs for shaders.
+uint64_t OBJECT_RESIDENCY_BUDGET = 64 * 1024 * 1024;
+uint64_t TEXTURE_RESIDENCY_BUDGET = 256 * 1024 * 1024;
+uint64_t SHADER_RESIDENCY_BUDGET = 32;
+// The budget for the mip levels of the textures streamed in after they're loaded, in bytes of GPU memory.
+uint64_t TEXTURE_STREAMING_BUDGET = 128 * 1024 * 1024;
+// Whether the game scene keeps its models, camera and assets between runs, putting them back where they started when
+// it's restarted instead of creating them again.
+bool KEEP_GAME_SCENE_WARM = true;
+// Whether the GL work of the frames runs on a render thread owning the GL context, so the next frame can be updated
+// while the previous one is swapped.
+bool RENDER_THREAD_ENABLED = false;
+// Whether the threads of the engine are pinned to the cores of their roles and given the priorities of their roles.
+bool THREAD_AFFINITY_ENABLED = true;
+// Whether the game runs headless, simulating the models without a window or a GL context, so the objects keep their
+// meshes on the CPU and the textures and shaders aren't loaded.
+bool HEADLESS_ENABLED = false;
+// Whether the game renders offscreen, into a framebuffer of the size of the window instead of the window, which is
+// kept hidden, so the GPU work of the frames can be measured on machines without a screen to show them on.
+bool OFFSCREEN_ENABLED = false;
+// Whether the shaders, textures and objects are reloaded in place when their files change on disk.
+bool ASSET_HOT_RELOAD_ENABLED = false;
+// The packed archive of the assets, mounted at startup so the assets are served from it instead of their loose files,
+// unless the assets are hot reloaded, which needs their loose files.
+const std::string ASSET_ARCHIVE_FILE = "assets.pak";
+// The file the input and the time of every frame of the game scene are recorded to, so the play session can be replayed
+// as a benchmark, or empty if the game isn't recorded.
+std::string INPUT_RECORDING_FILE = "";
+// Whether the objects keep the vertex positions of their coarsest level of detail as a low-poly collision hull once their
+// meshes are uploaded. Only the bounds are kept otherwise, which is all the colliders need.
+bool COLLISION_HULLS_RETAINED = false;
+// The settings file loaded at startup when no other one is given, if it exists, which the renderer settings are read from.
+const std::string DEFAULT_SETTINGS_FILE = "settings.cfg";
+// The port the telemetry of the frames is served on as a Prometheus scrape endpoint, or 0 if it isn't exported.
+uint16_t TELEMETRY_PORT = 0;
 
 #endif
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <set>
+#include <array>
+#include <vector>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -47,7 +50,129 @@ public:
 };
 
 /**
- * A class to manage controls and inputs of the window.
+ * Structure for a key or mouse button that changed in a poll for events, as it's recorded to replay the input later.
+ */
+struct InputChange
+{
+  // The key or mouse button.
+  uint16_t button;
+  // Whether the button is a mouse button instead of a key.
+  bool mouseButton;
+  // Whether the button is held down after the poll, and whether it went down and up during the poll.
+  bool down;
+  bool pressed;
+  bool released;
+};
+
+/**
+ * Class for the states of a set of buttons, like the keys of the keyboard or the buttons of the mouse, as of the latest
+ *   poll for events, along with which of them went down or up since the poll before it.
+ */
+template <size_t ButtonsCount>
+class ButtonStates
+{
+private:
+  // Whether each button is held down.
+  std::array<bool, ButtonsCount> downStates;
+  // Whether each button went down, and whether it went up, since the previous poll. A button can do both in one poll.
+  std::array<bool, ButtonsCount> pressedEdges;
+  std::array<bool, ButtonsCount> releasedEdges;
+
+public:
+  ButtonStates()
+      : downStates(),
+        pressedEdges(),
+        releasedEdges() {}
+
+  /**
+   * Set whether the button is held down, noting the edge if it changed.
+   *
+   * @param button  The button.
+   * @param isDown  Whether the button is held down.
+   */
+  void setDown(const int32_t &button, const bool &isDown)
+  {
+    // GLFW reports the buttons it doesn't know as negative.
+    if (button < 0 || button >= int32_t(ButtonsCount) || downStates[button] == isDown)
+    {
+      return;
+    }
+    downStates[button] = isDown;
+    (isDown ? pressedEdges : releasedEdges)[button] = true;
+  }
+
+  bool isDown(const int32_t &button) const
+  {
+    return button >= 0 && button < int32_t(ButtonsCount) && downStates[button];
+  }
+
+  bool wasPressed(const int32_t &button) const
+  {
+    return button >= 0 && button < int32_t(ButtonsCount) && pressedEdges[button];
+  }
+
+  bool wasReleased(const int32_t &button) const
+  {
+    return button >= 0 && button < int32_t(ButtonsCount) && releasedEdges[button];
+  }
+
+  /**
+   * Add the buttons that went down or up in the latest poll to the list of changes.
+   *
+   * @param changes      The list of changes to add to.
+   * @param mouseButton  Whether the buttons are mouse buttons.
+   * @param includeHeld  Whether to also add the buttons held down that didn't change, for the first poll recorded.
+   */
+  void getChanges(std::vector<InputChange> &changes, const bool &mouseButton, const bool &includeHeld) const
+  {
+    for (size_t button = 0; button < ButtonsCount; button++)
+    {
+      if (pressedEdges[button] || releasedEdges[button] || (includeHeld && downStates[button]))
+      {
+        changes.push_back({uint16_t(button), mouseButton, downStates[button], pressedEdges[button], releasedEdges[button]});
+      }
+    }
+  }
+
+  /**
+   * Set the state and the edges of a button as they were recorded.
+   *
+   * @param change  The recorded change of the button.
+   */
+  void applyChange(const InputChange &change)
+  {
+    if (change.button >= ButtonsCount)
+    {
+      return;
+    }
+    downStates[change.button] = change.down;
+    pressedEdges[change.button] = change.pressed;
+    releasedEdges[change.button] = change.released;
+  }
+
+  /**
+   * Forget the edges of the previous poll, before the next one.
+   */
+  void clearEdges()
+  {
+    pressedEdges.fill(false);
+    releasedEdges.fill(false);
+  }
+
+  /**
+   * Forget everything, as if every button was up and hadn't changed.
+   */
+  void reset()
+  {
+    downStates.fill(false);
+    clearEdges();
+  }
+};
+
+/**
+ * A class to manage controls and inputs of the window. The keys and mouse buttons are taken from the events of the
+ *   window as they are polled, so everything reading them in a frame sees the same snapshot, and a key press is only
+ *   seen in the frame after the poll it happened in.
  */
 class ControlManager
 {
@@ -57,13 +182,80 @@ private:
   // The height of the window.
   const static int32_t height;
 
-  // Singleton instance of the control manager.
-  static ControlManager instance;
+  // The states of the keys and the mouse buttons as of the latest poll.
+  ButtonStates<GLFW_KEY_LAST + 1> keyStates;
+  ButtonStates<GLFW_MOUSE_BUTTON_LAST + 1> mouseButtonStates;
 
-  // The window manager responsible for managing the window and properties related to it.
-  const WindowManager &windowManager;
+  // Whether the keys come from a script instead of the keyboard.
+  bool inputScripted;
 
-  ControlManager() : windowManager(WindowManager::getInstance()) {}
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local ControlManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the control manager, which is the one of the default world.
+   *
+   * @return The control manager singleton instance.
+   */
+  static ControlManager &getSingleton()
+  {
+    // Singleton instance of the control manager, constructed the first time it's asked for.
+    static ControlManager instance;
+    return instance;
+  }
+
+  ControlManager()
+      : keyStates(),
+        mouseButtonStates(),
+        inputScripted(false)
+  {
+    // The window is created before the control manager, so its events can be listened to right away. A headless game
+    //   has no window, and takes its keys from a script.
+    if (!HEADLESS_ENABLED)
+    {
+      glfwSetKeyCallback(WindowManager::getInstance().getWindow(), onKeyEvent);
+      glfwSetMouseButtonCallback(WindowManager::getInstance().getWindow(), onMouseButtonEvent);
+    }
+  }
+
+  /**
+   * Note the key going down or up, while the events are polled.
+   *
+   * @param window    The window of the event.
+   * @param key       The key.
+   * @param scancode  The platform-specific code of the key.
+   * @param action    Whether the key went down, up or was repeated.
+   * @param mods      The modifier keys held down.
+   */
+  static void onKeyEvent(GLFWwindow *, int32_t key, int32_t, int32_t action, int32_t)
+  {
+    // The keyboard is ignored while a script holds down the keys, and repeats aren't new presses.
+    if (getInstance().inputScripted || action == GLFW_REPEAT)
+    {
+      return;
+    }
+    getInstance().keyStates.setDown(key, action == GLFW_PRESS);
+  }
+
+  /**
+   * Note the mouse button going down or up, while the events are polled.
+   *
+   * @param window  The window of the event.
+   * @param button  The mouse button.
+   * @param action  Whether the mouse button went down or up.
+   * @param mods    The modifier keys held down.
+   */
+  static void onMouseButtonEvent(GLFWwindow *, int32_t button, int32_t action, int32_t)
+  {
+    // The scripts don't use the mouse.
+    if (getInstance().inputScripted)
+    {
+      return;
+    }
+    getInstance().mouseButtonStates.setDown(button, action == GLFW_PRESS);
+  }
 
 public:
   // Preventing copying the control manager, making sure only one instance can exist.
@@ -79,7 +271,7 @@ public:
     // Define variables for the x,y-coordinates of the cursor.
     double_t x, y;
     // Get the cursor position in the window from GLFW.
-    glfwGetCursorPos(windowManager.getWindow(), &x, &y);
+    glfwGetCursorPos(WindowManager::getInstance().getWindow(), &x, &y);
     // The cursor position is based on the size of the window, so normalize accordingly and return it.
     return std::make_shared<CursorPosition>(x / width, y / height);
   }
@@ -93,40 +285,169 @@ public:
   {
     // Tell GLFW to set the position of the cursor. GLFW requires the absolute position of the cursor on the window,
     //   but the input coordinates are normalized, so multiply them with the dimensions of the window.
-    glfwSetCursorPos(windowManager.getWindow(), newPosition.getX() * width, newPosition.getY() * height);
+    glfwSetCursorPos(WindowManager::getInstance().getWindow(), newPosition.getX() * width, newPosition.getY() * height);
   }
 
   /**
-   * Checks whether a key has been pressed or not.
+   * Checks whether a key is held down or not.
    * 
    * @param key  The key to check.
    * 
-   * @return Whether the key has been pressed or not.
+   * @return Whether the key is held down or not.
    */
   bool isKeyPressed(const int32_t &key) const
   {
-    // Query GLFW to see the status of the key and return true if it is being pressed.
-    return glfwGetKey(windowManager.getWindow(), key) == GLFW_PRESS;
+    return keyStates.isDown(key);
+  }
+
+  /**
+   * Checks whether a key went down since the previous poll, for reacting to a key press once however long it's held.
+   * 
+   * @param key  The key to check.
+   * 
+   * @return Whether the key went down or not.
+   */
+  bool wasKeyPressed(const int32_t &key) const
+  {
+    return keyStates.wasPressed(key);
+  }
+
+  /**
+   * Checks whether a key went up since the previous poll.
+   * 
+   * @param key  The key to check.
+   * 
+   * @return Whether the key went up or not.
+   */
+  bool wasKeyReleased(const int32_t &key) const
+  {
+    return keyStates.wasReleased(key);
+  }
+
+  /**
+   * Take the keys from a script instead of the keyboard, holding down only the given keys until they're changed again.
+   *   The keys that changed since the previous call go down or up as if they were pressed or released.
+   * 
+   * @param keys  The keys held down.
+   */
+  void setScriptedKeys(const std::set<int32_t> &keys)
+  {
+    if (!inputScripted)
+    {
+      inputScripted = true;
+      keyStates.reset();
+      mouseButtonStates.reset();
+    }
+    keyStates.clearEdges();
+    for (int32_t key = 0; key <= GLFW_KEY_LAST; key++)
+    {
+      keyStates.setDown(key, keys.find(key) != keys.end());
+    }
+  }
+
+  /**
+   * Take the keys and mouse buttons from a recording instead of the keyboard and mouse, replacing the edges of the
+   *   latest poll with the changes recorded for the frame. The buttons that didn't change stay as they were.
+   *
+   * @param changes  The changes recorded for the frame.
+   */
+  void setRecordedInput(const std::vector<InputChange> &changes)
+  {
+    if (!inputScripted)
+    {
+      inputScripted = true;
+      keyStates.reset();
+      mouseButtonStates.reset();
+    }
+    clearInputEdges();
+    for (const auto &change : changes)
+    {
+      if (change.mouseButton)
+      {
+        mouseButtonStates.applyChange(change);
+      }
+      else
+      {
+        keyStates.applyChange(change);
+      }
+    }
   }
 
   /**
-   * Checks whether a mouse button has been pressed or not.
+   * Get the keys and mouse buttons that went down or up in the latest poll, to record them.
+   *
+   * @param changes      The list of changes to add to.
+   * @param includeHeld  Whether to also add the buttons held down that didn't change, for the first poll recorded.
+   */
+  void getInputChanges(std::vector<InputChange> &changes, const bool &includeHeld) const
+  {
+    keyStates.getChanges(changes, false, includeHeld);
+    mouseButtonStates.getChanges(changes, true, includeHeld);
+  }
+
+  /**
+   * Go back to taking the keys from the keyboard.
+   */
+  void disableScriptedInput()
+  {
+    inputScripted = false;
+    keyStates.reset();
+    mouseButtonStates.reset();
+  }
+
+  /**
+   * Checks whether a mouse button is held down or not.
    * 
-   * @param key  The mouse button to check.
+   * @param button  The mouse button to check.
    * 
-   * @return Whether the mouse button has been pressed or not.
+   * @return Whether the mouse button is held down or not.
    */
-  bool isMouseButtonPressed(const int32_t &key) const
+  bool isMouseButtonPressed(const int32_t &button) const
   {
-    // Query GLFW to see the status of the mouse button and return true if it is being pressed.
-    return glfwGetMouseButton(windowManager.getWindow(), key) == GLFW_PRESS;
+    return mouseButtonStates.isDown(button);
   }
 
   /**
-   * Poll for input/control events on the window.
+   * Checks whether a mouse button went down since the previous poll.
+   * 
+   * @param button  The mouse button to check.
+   * 
+   * @return Whether the mouse button went down or not.
+   */
+  bool wasMouseButtonPressed(const int32_t &button) const
+  {
+    return mouseButtonStates.wasPressed(button);
+  }
+
+  /**
+   * Checks whether a mouse button went up since the previous poll.
+   * 
+   * @param button  The mouse button to check.
+   * 
+   * @return Whether the mouse button went up or not.
+   */
+  bool wasMouseButtonReleased(const int32_t &button) const
+  {
+    return mouseButtonStates.wasReleased(button);
+  }
+
+  /**
+   * Forget the presses and releases of the latest poll, so the ones left over from a previous scene aren't reacted to
+   *   again. The keys and mouse buttons held down stay held down.
+   */
+  void clearInputEdges()
+  {
+    keyStates.clearEdges();
+    mouseButtonStates.clearEdges();
+  }
+
+  /**
+   * Poll for input/control events on the window, replacing the presses and releases of the previous poll with the ones
+   *   that happened since.
    */
   void pollEvents()
   {
+    clearInputEdges();
     glfwPollEvents();
   }
 
@@ -136,7 +457,7 @@ public:
    */
   void disableCursor()
   {
-    glfwSetInputMode(windowManager.getWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetInputMode(WindowManager::getInstance().getWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
   }
 
   /**
@@ -145,7 +466,7 @@ public:
    */
   void enableCursor()
   {
-    glfwSetInputMode(windowManager.getWindow(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+    glfwSetInputMode(WindowManager::getInstance().getWindow(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
   }
 
   /**
@@ -154,17 +475,18 @@ public:
    */
   void hideCursor()
   {
-    glfwSetInputMode(windowManager.getWindow(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+    glfwSetInputMode(WindowManager::getInstance().getWindow(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
   }
 
   /**
-   * Returns the singleton instance of the control manager.
+   * Returns the instance of the control manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
    * 
-   * @return The control manager singleton instance.
+   * @return The control manager instance.
    */
   static ControlManager &getInstance()
   {
-    return instance;
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
   }
 };
 
@@ -172,7 +494,5 @@ public:
 const int32_t ControlManager::width = WINDOW_WIDTH;
 // Initialize the window height to the WINDOW_HEIGHT constant.
 const int32_t ControlManager::height = WINDOW_HEIGHT;
-// Initialize the control manager singleton instance static variable.
-ControlManager ControlManager::instance;
 
 #endif
\ No newline at end of file
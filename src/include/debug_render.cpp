@@ -3,9 +3,17 @@
 
 #include <map>
 #include <set>
+#include <array>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
 
 #include <GL/glew.h>
 
+#include "gl_state.cpp"
 #include "common.cpp"
 #include "window.cpp"
 #include "shader.cpp"
@@ -15,12 +23,14 @@
 #include "models.cpp"
 #include "render.cpp"
 #include "text.cpp"
+#include "profiler.cpp"
+#include "streaming_buffer.cpp"
+#include "frame_arena.cpp"
+#include "gl_debug.cpp"
 
 class DebugRenderManager
 {
 private:
-  static DebugRenderManager instance;
-
   const static glm::vec4 debugColor1;
   const static glm::vec4 debugColor2;
   const static glm::vec4 debugColor3;
@@ -39,18 +49,118 @@ private:
   const RenderManager &renderManager;
 
   const std::shared_ptr<const ObjectDetails> sphereDetails;
-  const std::shared_ptr<const ShaderDetails> debugAabbShader;
-  const std::shared_ptr<const ShaderDetails> debugBoxShader;
-  const std::shared_ptr<const ShaderDetails> debugSphereShader;
-  const GLuint debugModelBufferId;
+  // The shaders drawing instances of a mesh with a model matrix and a color each, as is or as a unit sphere.
+  const std::shared_ptr<const ShaderDetails> debugInstancedShader;
+  const std::shared_ptr<const ShaderDetails> debugInstancedSphereShader;
+  // The buffer holding the lines of a unit box, and the vertex array drawing them.
+  const uint32_t unitBoxVertexCount;
+  const GLuint unitBoxBufferId;
+  const GLuint unitBoxVertexArrayId;
+  // The buffer the model matrices and colors of the debug instances are streamed through.
+  StreamingBuffer debugInstanceStreamingBuffer;
+  // The shader, vertex array and streaming buffer drawing lines on the screen over everything else, and the projection
+  //   of the screen.
+  const std::shared_ptr<const ShaderDetails> debugScreenLineShader;
+  StreamingBuffer screenLineStreamingBuffer;
+  const GLuint screenLineVertexArrayId;
+  const glm::mat4 screenProjectionMatrix;
+  const uint32_t projectionKey;
+
+  // The model matrices and colors of the spheres and boxes of the frame, and the objects and model matrices of the meshes
+  //   of the models, along with the mesh matrices sorted by their object to draw each object in one go. They're cleared
+  //   after every frame but keep their storage, so they're reused between frames.
+  std::vector<glm::mat4> sphereInstanceMatrices;
+  std::vector<glm::vec4> sphereInstanceColors;
+  std::vector<glm::mat4> boxInstanceMatrices;
+  std::vector<glm::vec4> boxInstanceColors;
+  std::vector<std::pair<const ObjectDetails *, glm::mat4>> meshInstances;
+  std::vector<glm::mat4> meshInstanceMatrices;
+  // The positions and colors of the vertices of the lines to draw on the screen in the frame, reused between frames.
+  std::vector<glm::vec2> screenLineVertices;
+  std::vector<glm::vec4> screenLineColors;
+
+  /**
+   * Get the lines between every pair of corners of a box.
+   * 
+   * @param boundingBoxVertices  The corners of the box.
+   * 
+   * @return The vertices of the lines.
+   */
+  static std::vector<glm::vec3> getLineVertices(const std::array<glm::vec3, 8> &boundingBoxVertices)
+  {
+    std::vector<glm::vec3> lineVertices({});
+    for (unsigned long i = 0; i < boundingBoxVertices.size(); i++)
+    {
+      for (unsigned long j = i + 1; j < boundingBoxVertices.size(); j++)
+      {
+        lineVertices.push_back(boundingBoxVertices[i]);
+        lineVertices.push_back(boundingBoxVertices[j]);
+      }
+    }
+    return lineVertices;
+  }
+
+  /**
+   * Get the matrix placing the unit box over the given box.
+   * 
+   * @param box  The box.
+   * 
+   * @return The matrix of the box.
+   */
+  static glm::mat4 getBoxMatrix(const AxisAlignedBoundingBox &box)
+  {
+    return glm::translate(box.getMinCorner()) * glm::scale(box.getMaxCorner() - box.getMinCorner());
+  }
 
-  GLuint createDebugModelBuffer()
+  GLuint createUnitBoxBuffer()
   {
+    const auto unitBoxVertices = getLineVertices(AxisAlignedBoundingBox(glm::vec3(0.0f), glm::vec3(1.0f)).getCorners());
     GLuint bufferId;
     glGenBuffers(1, &bufferId);
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, bufferId);
+    glBufferData(GL_ARRAY_BUFFER, unitBoxVertices.size() * sizeof(glm::vec3), &unitBoxVertices[0], GL_STATIC_DRAW);
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
     return bufferId;
   }
 
+  GLuint createUnitBoxVertexArray()
+  {
+    const auto vertexArrayId = VertexArray::create();
+    GlStateCache::getInstance().bindVertexArray(vertexArrayId);
+    VertexArray::attachAttribute(VERTEX_POSITION_ATTRIBUTE_LOCATION, unitBoxBufferId, 3);
+    GlStateCache::getInstance().bindVertexArray(0);
+    return vertexArrayId;
+  }
+
+  /**
+   * Stream the model matrices and colors of the instances, and point the instance attributes of the bound vertex array
+   *   at them. Without colors, all the instances take the given color instead.
+   * 
+   * @param instanceMatrices  The model matrices of the instances.
+   * @param instanceColors    The colors of the instances, or null to use the same color for all of them.
+   * @param instancesCount    The number of instances.
+   * @param color             The color of all the instances, when they have no colors of their own.
+   */
+  void attachInstances(const glm::mat4 *instanceMatrices, const glm::vec4 *instanceColors, const size_t &instancesCount, const glm::vec4 &color = glm::vec4(1.0f))
+  {
+    const auto matricesSize = instancesCount * sizeof(glm::mat4);
+    const auto colorsSize = instanceColors != nullptr ? instancesCount * sizeof(glm::vec4) : 0;
+    debugInstanceStreamingBuffer.reserve(matricesSize + colorsSize, sizeof(glm::mat4));
+    const auto matricesOffset = debugInstanceStreamingBuffer.write(instanceMatrices, matricesSize, sizeof(glm::mat4));
+    VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, debugInstanceStreamingBuffer.getBufferId(), matricesOffset / sizeof(glm::mat4));
+
+    if (instanceColors == nullptr)
+    {
+      // Read every instance the same color from the constant value of the attribute.
+      glDisableVertexAttribArray(INSTANCE_COLOR_ATTRIBUTE_LOCATION);
+      glVertexAttrib4fv(INSTANCE_COLOR_ATTRIBUTE_LOCATION, &color[0]);
+      return;
+    }
+    const auto colorsOffset = debugInstanceStreamingBuffer.write(instanceColors, colorsSize, sizeof(glm::vec4));
+    VertexArray::attachAttribute(INSTANCE_COLOR_ATTRIBUTE_LOCATION, debugInstanceStreamingBuffer.getBufferId(), 4, 0, colorsOffset);
+    glVertexAttribDivisor(INSTANCE_COLOR_ATTRIBUTE_LOCATION, 1);
+  }
+
   DebugRenderManager()
       : windowManager(WindowManager::getInstance()),
         objectManager(ObjectManager::getInstance()),
@@ -61,10 +171,25 @@ private:
         modelManager(ModelManager::getInstance()),
         renderManager(RenderManager::getInstance()),
         sphereDetails(objectManager.createObject("DebugSphere", "assets/objects/sphere.obj")),
-        debugAabbShader(shaderManager.createShaderProgram("DebugAabbShader", "assets/shaders/vertex/debug_aabb.glsl", "assets/shaders/fragment/debug.glsl")),
-        debugBoxShader(shaderManager.createShaderProgram("DebugBoxShader", "assets/shaders/vertex/debug_box.glsl", "assets/shaders/fragment/debug.glsl")),
-        debugSphereShader(shaderManager.createShaderProgram("DebugSphereShader", "assets/shaders/vertex/debug_sphere.glsl", "assets/shaders/fragment/debug.glsl")),
-        debugModelBufferId(createDebugModelBuffer())
+        debugInstancedShader(shaderManager.createShaderProgram("DebugInstancedShader", "assets/shaders/vertex/debug_instanced.glsl", "assets/shaders/fragment/debug_instanced.glsl")),
+        debugInstancedSphereShader(shaderManager.createShaderProgram("DebugInstancedSphereShader", "assets/shaders/vertex/debug_instanced_sphere.glsl", "assets/shaders/fragment/debug_instanced.glsl")),
+        unitBoxVertexCount(28 * 2),
+        unitBoxBufferId(createUnitBoxBuffer()),
+        unitBoxVertexArrayId(createUnitBoxVertexArray()),
+        debugInstanceStreamingBuffer(DEBUG_STREAMING_BUFFER_SIZE),
+        debugScreenLineShader(shaderManager.createShaderProgram("DebugScreenLineShader", "assets/shaders/vertex/debug_screen_line.glsl", "assets/shaders/fragment/debug_instanced.glsl")),
+        screenLineStreamingBuffer(DEBUG_STREAMING_BUFFER_SIZE),
+        screenLineVertexArrayId(VertexArray::create()),
+        screenProjectionMatrix(glm::ortho(0.0f, 1.0f * VIEWPORT_WIDTH, 0.0f, 1.0f * VIEWPORT_HEIGHT)),
+        projectionKey(shaderManager.getUniformKey("projection")),
+        sphereInstanceMatrices({}),
+        sphereInstanceColors({}),
+        boxInstanceMatrices({}),
+        boxInstanceColors({}),
+        meshInstances({}),
+        meshInstanceMatrices({}),
+        screenLineVertices({}),
+        screenLineColors({})
   {
   }
 
@@ -74,243 +199,205 @@ public:
   ~DebugRenderManager()
   {
     objectManager.destroyObject(sphereDetails);
-    shaderManager.destroyShaderProgram(debugAabbShader);
-    shaderManager.destroyShaderProgram(debugBoxShader);
-    shaderManager.destroyShaderProgram(debugSphereShader);
-    glDeleteBuffers(1, &debugModelBufferId);
+    shaderManager.destroyShaderProgram(debugInstancedShader);
+    shaderManager.destroyShaderProgram(debugInstancedSphereShader);
+    shaderManager.destroyShaderProgram(debugScreenLineShader);
+    GlStateCache::getInstance().deleteVertexArrays(1, &screenLineVertexArrayId);
+    GlStateCache::getInstance().deleteBuffers(1, &unitBoxBufferId);
+    GlStateCache::getInstance().deleteVertexArrays(1, &unitBoxVertexArrayId);
   }
 
-  std::vector<glm::vec3> getLineVertices(const std::vector<glm::vec3> &boundingBoxVertices) const
+  /**
+   * Add the spheres of the near planes of the lights to the debug instances of the frame.
+   */
+  void addLights()
   {
-    std::vector<glm::vec3> lineVertices({});
-    for (unsigned long i = 0; i < boundingBoxVertices.size(); i++)
-    {
-      for (unsigned long j = i + 1; j < boundingBoxVertices.size(); j++)
-      {
-        lineVertices.push_back(boundingBoxVertices[i]);
-        lineVertices.push_back(boundingBoxVertices[j]);
-      }
-    }
-    return lineVertices;
-  }
-
-  void renderLights() const
-  {
-    const auto activeCamera = cameraManager.getCamera(renderManager.activeCameraId);
-    const auto viewMatrix = activeCamera->getViewMatrix();
-    const auto projectionMatrix = activeCamera->getProjectionMatrix();
-
-    auto lightNamesCount = std::map<const std::string, int>({});
-    auto lightNamesProcessTime = std::map<const std::string, double>({});
-
-    GLuint shaderId = -1;
+    std::pmr::map<std::string_view, int> lightNamesCount(&FrameArena::getInstance());
     for (const auto &light : lightManager.getAllLights())
     {
-      if (shaderId != debugSphereShader->getShaderId())
-      {
-        shaderId = debugSphereShader->getShaderId();
-        glUseProgram(shaderId);
-      }
-
-      if (lightNamesCount.find(light->getLightName()) != lightNamesCount.end())
-      {
-        lightNamesCount[light->getLightName()]++;
-      }
-      else
-      {
-        lightNamesCount[light->getLightName()] = 1;
-        lightNamesProcessTime[light->getLightName()] = 0.0f;
-      }
-
-      const auto startTime = glfwGetTime();
-
-      const auto mvpMatrixId = glGetUniformLocation(debugSphereShader->getShaderId(), "mvpMatrix");
-      const auto radiusId = glGetUniformLocation(debugSphereShader->getShaderId(), "radius");
-      const auto lineColorId = glGetUniformLocation(debugSphereShader->getShaderId(), "lineColor");
-
-      const auto mvpMatrix = projectionMatrix * viewMatrix * glm::translate(light->getLightPosition()) * glm::mat4();
-      glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-      glUniform1f(radiusId, light->getLightNearPlane());
-      glUniform4f(lineColorId, debugColor3.r, debugColor3.g, debugColor3.b, debugColor3.a);
-
-      VertexAttributeArray vertexArray("VertexArray", sphereDetails->getVertexBufferId(), 3);
-      vertexArray.enableAttribute();
-
-      glDrawArrays(GL_TRIANGLES, 0, sphereDetails->getBufferSize());
-
-      const auto endTime = glfwGetTime();
-
-      lightNamesProcessTime[light->getLightName()] += (endTime - startTime) * 1000;
+      lightNamesCount[light->getLightName()]++;
+      sphereInstanceMatrices.push_back(glm::translate(light->getLightPosition()) * glm::scale(glm::vec3(light->getLightNearPlane())));
+      sphereInstanceColors.push_back(debugColor3);
     }
 
     auto height = 18.5f;
     for (const auto &lightCounts : lightNamesCount)
     {
-      const auto avgRenderTime = lightNamesProcessTime[lightCounts.first] / lightCounts.second;
-      textManager.addText(lightCounts.first + " Debug Light Render Instances: " + std::to_string(lightCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+      textManager.addFormattedText(glm::vec2(1, height), 0.5f, lightCounts.first, " Debug Light Render Instances: ", lightCounts.second);
       height -= 0.5f;
     }
   }
 
-  void renderModels() const
+  /**
+   * Add the colliders, bounding boxes and meshes of the models to the debug instances of the frame.
+   */
+  void addModels()
   {
-    const auto activeCamera = cameraManager.getCamera(renderManager.activeCameraId);
-    const auto viewMatrix = activeCamera->getViewMatrix();
-    const auto projectionMatrix = activeCamera->getProjectionMatrix();
-
-    auto modelNamesCount = std::map<const std::string, int>({});
-    auto modelNamesProcessTime = std::map<const std::string, double>({});
-
-    GLuint shaderId = -1;
+    std::pmr::map<std::string_view, int> modelNamesCount(&FrameArena::getInstance());
     for (const auto &model : modelManager.getAllModels())
     {
-      if (modelNamesCount.find(model->getModelName()) != modelNamesCount.end())
-      {
-        modelNamesCount[model->getModelName()]++;
-      }
-      else
-      {
-        modelNamesCount[model->getModelName()] = 1;
-        modelNamesProcessTime[model->getModelName()] = 0.0f;
-      }
-
-      const auto startTime = glfwGetTime();
+      modelNamesCount[model->getModelName()]++;
 
-      if (model->getColliderDetails()->getColliderShape()->getType() == ColliderShapeType::SPHERE)
+      const auto &modelMatrix = model->getRenderMatrix();
+      const auto &colliderShape = model->getColliderDetails()->getColliderShape();
+      if (colliderShape->getType() == ColliderShapeType::SPHERE)
       {
-        if (shaderId != debugSphereShader->getShaderId())
-        {
-          shaderId = debugSphereShader->getShaderId();
-          glUseProgram(shaderId);
-        }
-
-        const auto mvpMatrixId = glGetUniformLocation(debugSphereShader->getShaderId(), "mvpMatrix");
-        const auto radiusId = glGetUniformLocation(debugSphereShader->getShaderId(), "radius");
-        const auto lineColorId = glGetUniformLocation(debugSphereShader->getShaderId(), "lineColor");
-
-        const auto mvpMatrix = projectionMatrix * viewMatrix * model->getModelMatrix() * glm::mat4();
-        glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glUniform1f(radiusId, std::dynamic_pointer_cast<SphereColliderShape>(model->getColliderDetails()->getColliderShape())->getRadius());
-        glUniform4f(lineColorId, debugColor1.r, debugColor1.g, debugColor1.b, debugColor1.a);
-
-        VertexAttributeArray vertexArray("VertexArray", sphereDetails->getVertexBufferId(), 3);
-        vertexArray.enableAttribute();
-
-        glDrawArrays(GL_TRIANGLES, 0, sphereDetails->getBufferSize());
+        const auto radius = static_cast<const SphereColliderShape &>(*colliderShape).getRadius();
+        sphereInstanceMatrices.push_back(modelMatrix * glm::scale(glm::vec3(radius)));
+        sphereInstanceColors.push_back(debugColor1);
       }
-      else if (model->getColliderDetails()->getColliderShape()->getType() == ColliderShapeType::BOX)
+      else if (colliderShape->getType() == ColliderShapeType::BOX)
       {
-        if (shaderId != debugBoxShader->getShaderId())
-        {
-          shaderId = debugBoxShader->getShaderId();
-          glUseProgram(shaderId);
-        }
+        boxInstanceMatrices.push_back(modelMatrix * getBoxMatrix(colliderShape->getBaseBox()));
+        boxInstanceColors.push_back(debugColor1);
+      }
 
-        const auto mvpMatrixId = glGetUniformLocation(debugBoxShader->getShaderId(), "mvpMatrix");
-        const auto lineColorId = glGetUniformLocation(debugBoxShader->getShaderId(), "lineColor");
+      // The bounding box is already in world space.
+      boxInstanceMatrices.push_back(getBoxMatrix(colliderShape->getTransformedBox()));
+      boxInstanceColors.push_back(debugColor1);
 
-        const auto mvpMatrix = projectionMatrix * viewMatrix * model->getModelMatrix() * glm::mat4();
-        glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glUniform4f(lineColorId, debugColor1.r, debugColor1.g, debugColor1.b, debugColor1.a);
+      meshInstances.emplace_back(model->getObjectDetails().get(), modelMatrix * model->getObjectDetails()->getVertexMatrix());
+    }
 
-        const auto debugModelBuffer = getLineVertices(model->getColliderDetails()->getColliderShape()->getBaseBox()->getCorners());
-        glBindBuffer(GL_ARRAY_BUFFER, debugModelBufferId);
-        glBufferData(GL_ARRAY_BUFFER, debugModelBuffer.size() * sizeof(glm::vec3), &debugModelBuffer[0], GL_DYNAMIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    auto height = 20.0f;
+    for (const auto &modelCounts : modelNamesCount)
+    {
+      textManager.addFormattedText(glm::vec2(1, height), 0.5f, modelCounts.first, " Debug Model Render Instances: ", modelCounts.second);
+      height -= 0.5f;
+    }
+  }
 
-        VertexAttributeArray vertexArray("VertexArray", debugModelBufferId, 3);
-        vertexArray.enableAttribute();
+  /**
+   * Draw all the debug instances of the frame, with one instanced draw for all the spheres, one for all the boxes, and
+   *   one for the meshes of each object.
+   */
+  void renderInstances()
+  {
+    if (!sphereInstanceMatrices.empty())
+    {
+      GlStateCache::getInstance().useProgram(debugInstancedSphereShader->getShaderId());
+      GlStateCache::getInstance().bindVertexArray(sphereDetails->getVertexArrayId());
+      attachInstances(sphereInstanceMatrices.data(), sphereInstanceColors.data(), sphereInstanceMatrices.size());
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES, sphereDetails->getBufferSize(), GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * sphereDetails->getFirstIndex()), sphereInstanceMatrices.size(), sphereDetails->getBaseVertex());
+    }
 
-        glDrawArrays(GL_LINES, 0, debugModelBuffer.size());
-      }
+    GlStateCache::getInstance().useProgram(debugInstancedShader->getShaderId());
+    if (!boxInstanceMatrices.empty())
+    {
+      GlStateCache::getInstance().bindVertexArray(unitBoxVertexArrayId);
+      attachInstances(boxInstanceMatrices.data(), boxInstanceColors.data(), boxInstanceMatrices.size());
+      glDrawArraysInstanced(GL_LINES, 0, unitBoxVertexCount, boxInstanceMatrices.size());
+    }
 
+    // Group the meshes by their object, so the matrices of each object are next to each other.
+    std::stable_sort(meshInstances.begin(), meshInstances.end(), [](const auto &first, const auto &second) { return std::less<const ObjectDetails *>()(first.first, second.first); });
+    for (const auto &meshInstance : meshInstances)
+    {
+      meshInstanceMatrices.push_back(meshInstance.second);
+    }
+    for (size_t first = 0; first < meshInstances.size();)
+    {
+      auto last = first + 1;
+      while (last < meshInstances.size() && meshInstances[last].first == meshInstances[first].first)
       {
-        if (shaderId != debugBoxShader->getShaderId())
-        {
-          shaderId = debugBoxShader->getShaderId();
-          glUseProgram(shaderId);
-        }
-
-        const auto mvpMatrixId = glGetUniformLocation(debugBoxShader->getShaderId(), "mvpMatrix");
-        const auto lineColorId = glGetUniformLocation(debugBoxShader->getShaderId(), "lineColor");
-
-        const auto mvpMatrix = projectionMatrix * viewMatrix * model->getModelMatrix() * glm::mat4();
-        glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glUniform4f(lineColorId, debugColor2.r, debugColor2.g, debugColor2.b, debugColor2.a);
-
-        VertexAttributeArray vertexArray("VertexArray", model->getObjectDetails()->getVertexBufferId(), 3);
-        vertexArray.enableAttribute();
-
-        glDrawArrays(GL_TRIANGLES, 0, model->getObjectDetails()->getBufferSize());
+        last++;
       }
+      const auto &objectDetails = *meshInstances[first].first;
+      GlStateCache::getInstance().bindVertexArray(objectDetails.getVertexArrayId());
+      attachInstances(meshInstanceMatrices.data() + first, nullptr, last - first, debugColor2);
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES, objectDetails.getBufferSize(), GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * objectDetails.getFirstIndex()), last - first, objectDetails.getBaseVertex());
+      first = last;
+    }
 
-      {
-        if (shaderId != debugAabbShader->getShaderId())
-        {
-          shaderId = debugAabbShader->getShaderId();
-          glUseProgram(shaderId);
-        }
+    // Fence the instances of the frame now that everything drawing with them was queued.
+    debugInstanceStreamingBuffer.endFrame();
 
-        const auto viewMatrixId = glGetUniformLocation(debugAabbShader->getShaderId(), "viewMatrix");
-        const auto projectionMatrixId = glGetUniformLocation(debugAabbShader->getShaderId(), "projectionMatrix");
-        const auto lineColorId = glGetUniformLocation(debugAabbShader->getShaderId(), "lineColor");
+    sphereInstanceMatrices.clear();
+    sphereInstanceColors.clear();
+    boxInstanceMatrices.clear();
+    boxInstanceColors.clear();
+    meshInstances.clear();
+    meshInstanceMatrices.clear();
+  }
 
-        glUniformMatrix4fv(viewMatrixId, 1, GL_FALSE, &viewMatrix[0][0]);
-        glUniformMatrix4fv(projectionMatrixId, 1, GL_FALSE, &projectionMatrix[0][0]);
-        glUniform4f(lineColorId, debugColor1.r, debugColor1.g, debugColor1.b, debugColor1.a);
+  void render()
+  {
+    GpuDebugGroup debugGroup("Debug Colliders");
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-        const auto debugModelBuffer = getLineVertices(model->getColliderDetails()->getColliderShape()->getTransformedBox()->getCorners());
-        glBindBuffer(GL_ARRAY_BUFFER, debugModelBufferId);
-        glBufferData(GL_ARRAY_BUFFER, debugModelBuffer.size() * sizeof(glm::vec3), &debugModelBuffer[0], GL_DYNAMIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    {
+      ProfileZone lightDebugRenderZone("Light Debug Render");
+      addLights();
+      textManager.addFormattedText(glm::vec2(1, 24.5f), 0.5f, "Light Debug Render: ", lightDebugRenderZone.end(), "ms");
+    }
 
-        VertexAttributeArray vertexArray("VertexArray", debugModelBufferId, 3);
-        vertexArray.enableAttribute();
+    {
+      ProfileZone modelDebugRenderZone("Model Debug Render");
+      addModels();
+      renderInstances();
+      textManager.addFormattedText(glm::vec2(1, 24), 0.5f, "Model Debug Render: ", modelDebugRenderZone.end(), "ms");
+    }
 
-        glDrawArrays(GL_LINES, 0, debugModelBuffer.size());
-      }
+    GlStateCache::getInstance().bindVertexArray(0);
 
-      const auto endTime = glfwGetTime();
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  }
 
-      modelNamesProcessTime[model->getModelName()] += (endTime - startTime) * 1000;
-    }
+  /**
+   * Add a line to draw on the screen in the frame.
+   * 
+   * @param start  The start of the line, in pixels from the bottom-left of the screen.
+   * @param end    The end of the line, in pixels from the bottom-left of the screen.
+   * @param color  The color of the line.
+   */
+  void addScreenLine(const glm::vec2 &start, const glm::vec2 &end, const glm::vec4 &color)
+  {
+    screenLineVertices.push_back(start);
+    screenLineVertices.push_back(end);
+    screenLineColors.push_back(color);
+    screenLineColors.push_back(color);
+  }
 
-    auto height = 20.0f;
-    for (const auto &modelCounts : modelNamesCount)
+  /**
+   * Draw all the lines added to the screen in the frame in one go, over everything drawn so far.
+   */
+  void renderScreenLines()
+  {
+    if (screenLineVertices.empty())
     {
-      const auto avgRenderTime = modelNamesProcessTime[modelCounts.first] / modelCounts.second;
-      textManager.addText(modelCounts.first + " Debug Model Render Instances: " + std::to_string(modelCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
-      height -= 0.5f;
+      return;
     }
-  }
 
-  void render() const
-  {
-    const auto currentTime = glfwGetTime();
-    auto updateStartTime = currentTime, updateEndTime = currentTime;
+    const auto verticesSize = screenLineVertices.size() * sizeof(glm::vec2);
+    const auto colorsSize = screenLineColors.size() * sizeof(glm::vec4);
+    screenLineStreamingBuffer.reserve(verticesSize + colorsSize);
+    const auto verticesOffset = screenLineStreamingBuffer.write(&screenLineVertices[0], verticesSize);
+    const auto colorsOffset = screenLineStreamingBuffer.write(&screenLineColors[0], colorsSize);
 
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    GlStateCache::getInstance().useProgram(debugScreenLineShader->getShaderId());
+    const auto projectionId = debugScreenLineShader->getUniformLocation(projectionKey);
+    glUniformMatrix4fv(projectionId, 1, GL_FALSE, &screenProjectionMatrix[0][0]);
 
-    updateStartTime = glfwGetTime();
-    renderLights();
-    updateEndTime = glfwGetTime();
-    textManager.addText("Light Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 24.5f), 0.5f);
+    GlStateCache::getInstance().bindVertexArray(screenLineVertexArrayId);
+    VertexArray::attachAttribute(VERTEX_POSITION_ATTRIBUTE_LOCATION, screenLineStreamingBuffer.getBufferId(), 2, 0, verticesOffset);
+    VertexArray::attachAttribute(VERTEX_COLOR_ATTRIBUTE_LOCATION, screenLineStreamingBuffer.getBufferId(), 4, 0, colorsOffset);
+    glDrawArrays(GL_LINES, 0, screenLineVertices.size());
+    GlStateCache::getInstance().bindVertexArray(0);
 
-    updateStartTime = glfwGetTime();
-    renderModels();
-    updateEndTime = glfwGetTime();
-    textManager.addText("Model Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 24), 0.5f);
+    screenLineStreamingBuffer.endFrame();
 
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    screenLineVertices.clear();
+    screenLineColors.clear();
   }
 
   static DebugRenderManager &getInstance()
   {
+    // Singleton instance of the debug render manager, constructed the first time it's asked for.
+    static DebugRenderManager instance;
     return instance;
   }
 };
 
-DebugRenderManager DebugRenderManager::instance;
 const glm::vec4 DebugRenderManager::debugColor1 = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
 const glm::vec4 DebugRenderManager::debugColor2 = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 const glm::vec4 DebugRenderManager::debugColor3 = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
@@ -0,0 +1,358 @@
+#ifndef INCLUDE_EVENTS_CPP
+#define INCLUDE_EVENTS_CPP
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include "slot_map.cpp"
+#include "job_system.cpp"
+#include "log.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Structure for the event of a model being spawned, which registers it with the model manager.
+ */
+struct ModelSpawnEvent
+{
+  // The model, already initialized.
+  std::shared_ptr<ModelBaseIntf> model;
+};
+
+/**
+ * Structure for the event of a model being destroyed, which destroys it through the model manager.
+ */
+struct ModelDestroyEvent
+{
+  // The handle of the model.
+  SlotHandle modelHandle;
+};
+
+/**
+ * Structure for the event of the last registered model of a type being de-registered, for the scenes to react to a
+ *   type of model running out, such as the last enemy being destroyed, without counting the models every frame.
+ */
+struct ModelTypeClearedEvent
+{
+  // The type ID of the models.
+  size_t modelTypeId;
+};
+
+/**
+ * Structure for the event of two models colliding, which lets both of them react to it.
+ */
+struct ModelCollisionEvent
+{
+  // The moving model of the pair, and the model it collided with.
+  std::shared_ptr<ModelBaseIntf> model;
+  std::shared_ptr<ModelBaseIntf> otherModel;
+};
+
+/**
+ * Enum for the lights a light toggle event toggles.
+ */
+enum class LightToggleTarget
+{
+  SHOT_LIGHTS,
+  EYE_LIGHTS
+};
+
+/**
+ * Structure for the event of a light being toggled.
+ */
+struct LightToggleEvent
+{
+  // The lights toggled.
+  LightToggleTarget target;
+};
+
+/**
+ * A manager class for passing the gameplay events of a world from whoever raises them to the handlers reacting to them,
+ *   such as a shot taken by the player to the model manager registering it, so the models raising them don't change the
+ *   state the other models read while they update in parallel. Each type of event has a channel of its own, with a queue
+ *   for each thread of the job system that only that thread publishes to, so publishing takes no locks and no atomics.
+ *   The queues are drained by the thread that stepped the world at the fixed points of the step, once the parallel work
+ *   before it is done, which the job system orders after everything the work published. The events of all the queues
+ *   are handled in the order of their order keys, and in the order they were published for the same key, so they're
+ *   handled the same way however the work was split between the threads.
+ */
+class EventBus
+{
+private:
+  /**
+   * Class for the channel of a type of event, without the type of the event.
+   */
+  class EventChannelBase
+  {
+  public:
+    virtual ~EventChannelBase() = default;
+
+    /**
+     * Handle the events published to the channel so far, leaving the events the handlers publish for the next dispatch.
+     *
+     * @return Whether there were any events.
+     */
+    virtual bool dispatch() = 0;
+  };
+
+  /**
+   * Class for the channel of a type of event.
+   */
+  template <typename Event>
+  class EventChannel : public EventChannelBase
+  {
+  private:
+    /**
+     * Structure for an event waiting to be handled.
+     */
+    struct QueuedEvent
+    {
+      // The key the events are handled in the order of.
+      uint64_t orderKey;
+      // The event.
+      Event event;
+    };
+
+    // The queues of the events of each thread of the job system, by the index of the thread.
+    std::vector<std::vector<QueuedEvent>> threadQueues;
+    // The list the events of all the queues are gathered to while they're handled, reused between dispatches.
+    std::vector<QueuedEvent> dispatchingEvents;
+    // The handlers of the events, by the handles of their subscriptions.
+    SlotMap<std::function<void(const Event &)>> handlers;
+
+  public:
+    EventChannel()
+        : threadQueues(JobSystem::getInstance().getThreadsCount()),
+          dispatchingEvents({}),
+          handlers() {}
+
+    /**
+     * Add an event to the queue of the calling thread.
+     *
+     * @param event     The event.
+     * @param orderKey  The key the event is handled in the order of.
+     */
+    void publish(const Event &event, const uint64_t &orderKey)
+    {
+      threadQueues[JobSystem::getCurrentThreadIndex()].push_back({orderKey, event});
+    }
+
+    SlotHandle subscribe(const std::function<void(const Event &)> &handler)
+    {
+      return handlers.insert(handler);
+    }
+
+    void unsubscribe(const SlotHandle &subscription)
+    {
+      handlers.remove(subscription);
+    }
+
+    bool dispatch() override
+    {
+      // Gather the events of the queues in the order of the threads, then into the order of their keys, which the
+      //   events of the same thread are already in the order of when they're all published by one thread.
+      dispatchingEvents.clear();
+      uint32_t publishingThreadsCount = 0;
+      for (auto &threadQueue : threadQueues)
+      {
+        if (!threadQueue.empty())
+        {
+          dispatchingEvents.insert(dispatchingEvents.end(), threadQueue.begin(), threadQueue.end());
+          threadQueue.clear();
+          publishingThreadsCount++;
+        }
+      }
+      if (dispatchingEvents.empty())
+      {
+        return false;
+      }
+      if (publishingThreadsCount > 1)
+      {
+        std::stable_sort(dispatchingEvents.begin(), dispatchingEvents.end(), [](const QueuedEvent &event1, const QueuedEvent &event2) {
+          return event1.orderKey < event2.orderKey;
+        });
+      }
+
+      // Handle the gathered events, while the events the handlers publish go back into the queues.
+      for (const auto &queuedEvent : dispatchingEvents)
+      {
+        for (const auto &handler : handlers.getValues())
+        {
+          handler(queuedEvent.event);
+        }
+      }
+      // Drop the events, so the models in them aren't kept alive until the next dispatch.
+      dispatchingEvents.clear();
+      return true;
+    }
+  };
+
+  // The number of event types given a type ID so far.
+  inline static std::atomic<size_t> eventTypesCount{0};
+
+  // The channels of the types of events, by the type IDs of the events, in the order they were subscribed to.
+  std::vector<std::unique_ptr<EventChannelBase>> channels;
+  std::vector<EventChannelBase *> subscribedChannels;
+  // The thread the event bus was created on, which runs the scene. The threads that aren't workers of the job system all
+  //   share the queues of the first thread, so only this one of them can publish.
+  const std::thread::id sceneThreadId;
+
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local EventBus *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the event bus, which is the one of the default world.
+   *
+   * @return The event bus singleton instance.
+   */
+  static EventBus &getSingleton()
+  {
+    // Singleton instance of the event bus, constructed the first time it's asked for.
+    static EventBus instance;
+    return instance;
+  }
+
+  EventBus()
+      : channels(),
+        subscribedChannels({}),
+        sceneThreadId(std::this_thread::get_id()) {}
+
+  /**
+   * Get the type ID of the given event type, handing out the next ID to each type the first time it is asked for.
+   *
+   * @return The type ID of the event type.
+   */
+  template <typename Event>
+  static size_t getEventTypeId()
+  {
+    static const size_t typeId = eventTypesCount.fetch_add(1, std::memory_order_relaxed);
+    return typeId;
+  }
+
+  /**
+   * Get the channel of the given event type, if it was ever subscribed to.
+   *
+   * @return The channel, or null if there is none.
+   */
+  template <typename Event>
+  EventChannel<Event> *findChannel() const
+  {
+    const auto typeId = getEventTypeId<Event>();
+    return typeId < channels.size() ? static_cast<EventChannel<Event> *>(channels[typeId].get()) : nullptr;
+  }
+
+public:
+  // Preventing copying the event bus, making sure only one instance can exist.
+  EventBus(const EventBus &) = delete;
+
+  /**
+   * Subscribe a handler to the events of the given type, creating their channel the first time its type is subscribed
+   *   to. Only done while nothing is publishing, such as while setting up a scene, since the channels are created here.
+   *
+   * @param handler  The handler, called on the thread draining the events.
+   *
+   * @return The handle of the subscription.
+   */
+  template <typename Event>
+  SlotHandle subscribe(const std::function<void(const Event &)> &handler)
+  {
+    const auto typeId = getEventTypeId<Event>();
+    if (typeId >= channels.size())
+    {
+      channels.resize(typeId + 1);
+    }
+    if (channels[typeId] == nullptr)
+    {
+      channels[typeId] = std::make_unique<EventChannel<Event>>();
+      subscribedChannels.push_back(channels[typeId].get());
+    }
+    return static_cast<EventChannel<Event> *>(channels[typeId].get())->subscribe(handler);
+  }
+
+  /**
+   * Drop a subscription to the events of the given type.
+   *
+   * @param subscription  The handle of the subscription.
+   */
+  template <typename Event>
+  void unsubscribe(const SlotHandle &subscription)
+  {
+    const auto channel = findChannel<Event>();
+    if (channel != nullptr)
+    {
+      channel->unsubscribe(subscription);
+    }
+  }
+
+  /**
+   * Publish an event from the calling thread, to be handled once the events of its type are next drained. The events of
+   *   a type never subscribed to are dropped. Only the scene thread and the workers of the job system can publish.
+   *
+   * @param event     The event.
+   * @param orderKey  The key the event is handled in the order of, such as the index of the handle of the model raising
+   *                  it, so the events are handled in the same order whichever threads raised them.
+   */
+  template <typename Event>
+  void publish(const Event &event, const uint64_t &orderKey = 0)
+  {
+    // Publishing from another thread that isn't a worker, such as the render thread or a loader thread, would race with
+    //   the scene thread on the queue they share.
+    if (JobSystem::getCurrentThreadIndex() == 0 && std::this_thread::get_id() != sceneThreadId)
+    {
+      Logger::getInstance().error("Failed at EventBus 1");
+      exit(1);
+    }
+    const auto channel = findChannel<Event>();
+    if (channel != nullptr)
+    {
+      channel->publish(event, orderKey);
+    }
+  }
+
+  /**
+   * Handle the events of the given type published so far, along with the ones their handlers publish of the same type.
+   */
+  template <typename Event>
+  void dispatch()
+  {
+    const auto channel = findChannel<Event>();
+    while (channel != nullptr && channel->dispatch())
+    {
+    }
+  }
+
+  /**
+   * Handle the events of every type published so far, channel by channel in the order they were subscribed to, until
+   *   the handlers publish no more.
+   */
+  void dispatch()
+  {
+    auto dispatched = true;
+    while (dispatched)
+    {
+      dispatched = false;
+      for (const auto &channel : subscribedChannels)
+      {
+        dispatched = channel->dispatch() || dispatched;
+      }
+    }
+  }
+
+  /**
+   * Returns the instance of the event bus of the world the thread is simulating, or the singleton instance of the default
+   *   world if there is none.
+   *
+   * @return The event bus instance.
+   */
+  static EventBus &getInstance()
+  {
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
+  }
+};
+
+#endif
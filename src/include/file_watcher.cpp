@@ -0,0 +1,108 @@
+#ifndef INCLUDE_FILE_WATCHER_CPP
+#define INCLUDE_FILE_WATCHER_CPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <filesystem>
+
+/**
+ * Class for watching the files of the loaded assets, by the names of the assets, so the assets whose files changed on
+ *   disk can be found and reloaded. A file that's missing, such as one being written, counts as unchanged until it's
+ *   back, and a file that shows up where there was none counts as changed.
+ */
+class FileWatcher
+{
+private:
+  /**
+   * Structure for a watched file, and the time it was last written at when it was last checked.
+   */
+  struct WatchedFile
+  {
+    // The path to the file.
+    std::string filePath;
+    // The time the file was last written at, which is the minimum time if the file didn't exist.
+    std::filesystem::file_time_type lastWriteTime;
+  };
+
+  // The watched files of each asset, by the name of the asset.
+  std::map<const std::string, std::vector<WatchedFile>> watchedAssets;
+
+  /**
+   * Get the time the file was last written at.
+   *
+   * @param filePath  The path to the file.
+   *
+   * @return The time the file was last written at, or the minimum time if it doesn't exist.
+   */
+  static std::filesystem::file_time_type getLastWriteTime(const std::string &filePath)
+  {
+    std::error_code errorCode;
+    const auto lastWriteTime = std::filesystem::last_write_time(filePath, errorCode);
+    return errorCode ? std::filesystem::file_time_type::min() : lastWriteTime;
+  }
+
+public:
+  FileWatcher()
+      : watchedAssets({}) {}
+
+  /**
+   * Start watching the files of the asset, replacing the files it was watched with before.
+   *
+   * @param assetName  The name of the asset.
+   * @param filePaths  The paths to the files the asset is loaded from.
+   */
+  void watch(const std::string &assetName, const std::vector<std::string> &filePaths)
+  {
+    auto &watchedFiles = watchedAssets[assetName];
+    watchedFiles.clear();
+    for (const auto &filePath : filePaths)
+    {
+      if (!filePath.empty())
+      {
+        watchedFiles.push_back({filePath, getLastWriteTime(filePath)});
+      }
+    }
+  }
+
+  /**
+   * Stop watching the files of the asset.
+   *
+   * @param assetName  The name of the asset.
+   */
+  void unwatch(const std::string &assetName)
+  {
+    watchedAssets.erase(assetName);
+  }
+
+  /**
+   * Find the assets with files written since they were last checked, taking the files as they are now as the ones the
+   *   assets are loaded from.
+   *
+   * @return The names of the assets whose files changed.
+   */
+  std::vector<std::string> findChangedAssets()
+  {
+    std::vector<std::string> changedAssetNames({});
+    for (auto &watchedAsset : watchedAssets)
+    {
+      auto changed = false;
+      for (auto &watchedFile : watchedAsset.second)
+      {
+        const auto lastWriteTime = getLastWriteTime(watchedFile.filePath);
+        if (lastWriteTime != std::filesystem::file_time_type::min() && lastWriteTime != watchedFile.lastWriteTime)
+        {
+          watchedFile.lastWriteTime = lastWriteTime;
+          changed = true;
+        }
+      }
+      if (changed)
+      {
+        changedAssetNames.push_back(watchedAsset.first);
+      }
+    }
+    return changedAssetNames;
+  }
+};
+
+#endif
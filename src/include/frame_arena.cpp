@@ -0,0 +1,157 @@
+#ifndef INCLUDE_FRAME_ARENA_CPP
+#define INCLUDE_FRAME_ARENA_CPP
+
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
+
+#include "constants.cpp"
+
+/**
+ * A memory resource for the scratch data of a frame, handing out memory by bumping an offset into its blocks and only
+ *   taking it all back at once when the frame is swapped, so the containers of a frame cost no heap allocations. A frame
+ *   needing more than the arena holds gets more blocks, which are merged into a single block big enough for the whole
+ *   frame once it's reset. It's only used by the thread rendering the frames, between the start of a frame and its swap,
+ *   so it needs no locking.
+ */
+class FrameArena : public std::pmr::memory_resource
+{
+private:
+  /**
+   * Structure for a block of memory of the arena.
+   */
+  struct ArenaBlock
+  {
+    // The memory of the block.
+    std::unique_ptr<uint8_t[]> memory;
+    // The size of the block, in bytes.
+    size_t size;
+  };
+
+  // The blocks of the arena, with the block being allocated from last.
+  std::vector<ArenaBlock> blocks;
+  // The number of bytes used of the block being allocated from, and of the blocks before it.
+  size_t blockUsedSize;
+  size_t previousBlocksUsedSize;
+  // The number of bytes used by the latest frame that was reset.
+  size_t lastFrameUsedSize;
+
+  FrameArena()
+      : blocks(),
+        blockUsedSize(0),
+        previousBlocksUsedSize(0),
+        lastFrameUsedSize(0)
+  {
+    blocks.push_back({std::make_unique<uint8_t[]>(FRAME_ARENA_SIZE), FRAME_ARENA_SIZE});
+  }
+
+  /**
+   * Hand out memory from the block being allocated from, adding a new block if it doesn't fit.
+   *
+   * @param size       The number of bytes.
+   * @param alignment  The alignment of the memory.
+   *
+   * @return The memory.
+   */
+  void *do_allocate(size_t size, size_t alignment) override
+  {
+    auto *block = &blocks.back();
+    auto address = reinterpret_cast<uintptr_t>(block->memory.get()) + blockUsedSize;
+    auto alignedAddress = (address + alignment - 1) & ~uintptr_t(alignment - 1);
+    if (alignedAddress + size > reinterpret_cast<uintptr_t>(block->memory.get()) + block->size)
+    {
+      // Double the size of the blocks as the frame keeps going over, making sure the allocation fits.
+      const auto newBlockSize = std::max(block->size * 2, size + alignment);
+      previousBlocksUsedSize += blockUsedSize;
+      blocks.push_back({std::make_unique<uint8_t[]>(newBlockSize), newBlockSize});
+      block = &blocks.back();
+      blockUsedSize = 0;
+      address = reinterpret_cast<uintptr_t>(block->memory.get());
+      alignedAddress = (address + alignment - 1) & ~uintptr_t(alignment - 1);
+    }
+    blockUsedSize += alignedAddress - address + size;
+    return reinterpret_cast<void *>(alignedAddress);
+  }
+
+  /**
+   * Nothing is given back until the arena is reset.
+   */
+  void do_deallocate(void *, size_t, size_t) override {}
+
+  /**
+   * Memory of the arena can only be given back to the arena itself.
+   *
+   * @param other  The other memory resource.
+   *
+   * @return Whether the other memory resource is the arena.
+   */
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+  {
+    return this == &other;
+  }
+
+public:
+  // Preventing copying the frame arena, making sure only one instance can exist.
+  FrameArena(const FrameArena &) = delete;
+
+  /**
+   * Take back all the memory handed out for the frame. Nothing allocated from the arena can be used afterwards.
+   */
+  void reset()
+  {
+    lastFrameUsedSize = previousBlocksUsedSize + blockUsedSize;
+    // Merge the blocks into one holding all of them, so the next frame fits in a single block.
+    if (blocks.size() > 1)
+    {
+      size_t totalSize = 0;
+      for (const auto &block : blocks)
+      {
+        totalSize += block.size;
+      }
+      blocks.clear();
+      blocks.push_back({std::make_unique<uint8_t[]>(totalSize), totalSize});
+    }
+    blockUsedSize = 0;
+    previousBlocksUsedSize = 0;
+  }
+
+  /**
+   * Get the number of bytes the latest frame that was reset used.
+   *
+   * @return The size in bytes.
+   */
+  const size_t &getLastFrameUsedSize() const
+  {
+    return lastFrameUsedSize;
+  }
+
+  /**
+   * Get the number of bytes the arena holds.
+   *
+   * @return The size in bytes.
+   */
+  size_t getCapacity() const
+  {
+    size_t capacity = 0;
+    for (const auto &block : blocks)
+    {
+      capacity += block.size;
+    }
+    return capacity;
+  }
+
+  /**
+   * Returns the singleton instance of the frame arena.
+   *
+   * @return The frame arena singleton instance.
+   */
+  static FrameArena &getInstance()
+  {
+    // Singleton instance of the frame arena, constructed the first time it's asked for.
+    static FrameArena instance;
+    return instance;
+  }
+};
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef INCLUDE_FRAME_CAPTURE_CPP
+#define INCLUDE_FRAME_CAPTURE_CPP
+
+#include <fstream>
+#include <string>
+#include <array>
+#include <future>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+#include <GL/glew.h>
+
+#include "gl_state.cpp"
+#include "constants.cpp"
+#include "gl_debug.cpp"
+#include "thread_affinity.cpp"
+#include "log.cpp"
+
+/**
+ * Enum for the states of a pixel pack buffer of the frame capture ring.
+ */
+enum class CaptureSlotState
+{
+  // The buffer can take the next frame.
+  FREE = 0,
+  // The GPU is copying a frame into the buffer.
+  READING = 1,
+  // A worker is writing the frame in the mapped buffer to its file.
+  WRITING = 2,
+};
+
+/**
+ * Structure for a pixel pack buffer of the frame capture ring, along with the frame it holds.
+ */
+struct CaptureSlot
+{
+  // The ID of the buffer, and the number of bytes of its storage.
+  GLuint bufferId;
+  size_t bufferSize;
+  // The state of the buffer.
+  CaptureSlotState state;
+  // The fence signalled once the GPU copied the frame into the buffer.
+  GLsync fence;
+  // The size of the frame in the buffer, and the file it's written to.
+  glm::ivec2 frameSize;
+  std::string filePath;
+  // The writing of the frame to its file, which reads the mapped buffer until it's done.
+  std::future<bool> writingFrame;
+};
+
+/**
+ * A manager class for capturing the frames shown in the window to BMP files, without waiting for the GPU. Each captured
+ *   frame is copied by the GPU into a pixel pack buffer of a ring, which is only mapped once the fence placed after the
+ *   copy is signalled a few frames later, and written to its file by a worker straight from the mapped buffer. Frames
+ *   arriving while every buffer of the ring is still busy are dropped instead of stalling, so capturing every frame for
+ *   videos doesn't slow the frames down. Must only be used on the thread owning the GL context.
+ */
+class FrameCaptureManager
+{
+private:
+  // The ring of pixel pack buffers the frames are read back through.
+  std::array<CaptureSlot, FRAME_CAPTURE_BUFFERS_COUNT> slots;
+  // The index of the buffer the next captured frame tries first.
+  uint32_t nextSlotIndex;
+  // Whether a screenshot of the next frame was asked for, and whether every frame is captured.
+  bool screenshotRequested;
+  bool continuousCaptureEnabled;
+  // The number of screenshots and continuously captured frames taken, which number their files.
+  uint32_t screenshotsCount;
+  uint64_t capturedFramesCount;
+  // The number of frames written to their files, and the number dropped because the ring was busy or a write failed.
+  uint64_t savedFramesCount;
+  uint64_t droppedFramesCount;
+
+  FrameCaptureManager()
+      : slots(),
+        nextSlotIndex(0),
+        screenshotRequested(false),
+        continuousCaptureEnabled(false),
+        screenshotsCount(0),
+        capturedFramesCount(0),
+        savedFramesCount(0),
+        droppedFramesCount(0)
+  {
+    for (auto &slot : slots)
+    {
+      slot.bufferId = 0;
+      slot.bufferSize = 0;
+      slot.state = CaptureSlotState::FREE;
+      slot.fence = nullptr;
+      slot.frameSize = glm::ivec2(0);
+    }
+  }
+
+  /**
+   * Write a frame read back with the default pack alignment to a 24-bit BMP file, whose rows are stored bottom-up and
+   *   padded to four bytes just like the frame.
+   *
+   * @param filePath   The path of the file to write.
+   * @param pixels     The BGR pixels of the frame, starting from the bottom row.
+   * @param frameSize  The size of the frame.
+   *
+   * @return Whether the file could be written.
+   */
+  static bool writeBmpFile(const std::string &filePath, const uint8_t *const pixels, const glm::ivec2 &frameSize)
+  {
+    std::ofstream bmpFile(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!bmpFile.is_open())
+    {
+      Logger::getInstance().error(filePath, "\nFailed at frame capture 1");
+      return false;
+    }
+
+    const uint32_t imageSize = getRowSize(frameSize.x) * frameSize.y;
+    const uint32_t headerSize = 54;
+    uint8_t header[headerSize] = {'B', 'M'};
+    const auto writeValue = [&](const uint32_t &offset, const uint32_t &value, const uint32_t &bytesCount) {
+      for (uint32_t i = 0; i < bytesCount; i++)
+      {
+        header[offset + i] = (value >> (i * 8)) & 0xFF;
+      }
+    };
+    // The file header, with the size of the file and where the pixels start.
+    writeValue(2, headerSize + imageSize, 4);
+    writeValue(10, headerSize, 4);
+    // The info header, with the size of the image, a single plane and 24 bits per pixel without compression.
+    writeValue(14, 40, 4);
+    writeValue(18, frameSize.x, 4);
+    writeValue(22, frameSize.y, 4);
+    writeValue(26, 1, 2);
+    writeValue(28, 24, 2);
+    writeValue(34, imageSize, 4);
+    bmpFile.write(reinterpret_cast<const char *>(header), headerSize);
+    bmpFile.write(reinterpret_cast<const char *>(pixels), imageSize);
+    return bmpFile.good();
+  }
+
+  /**
+   * Get the number of bytes of a row of a frame read back as BGR with the default pack alignment of four bytes.
+   *
+   * @param width  The width of the frame.
+   *
+   * @return The size in bytes.
+   */
+  static uint32_t getRowSize(const int32_t &width)
+  {
+    return (width * 3 + 3) & ~3u;
+  }
+
+  /**
+   * Hand the frames the GPU finished copying over to the workers writing them, and free the buffers whose frames were
+   *   written.
+   *
+   * @param waitForFrames  Whether to wait for the GPU and the workers instead of moving on when they're not done.
+   */
+  void collectFrames(const bool &waitForFrames)
+  {
+    for (auto &slot : slots)
+    {
+      if (slot.state == CaptureSlotState::READING)
+      {
+        // The wait only times out so the commands get flushed, so keep waiting until the fence is signalled if asked.
+        auto waitResult = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (waitForFrames && waitResult == GL_TIMEOUT_EXPIRED)
+        {
+          waitResult = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        if (waitResult == GL_TIMEOUT_EXPIRED)
+        {
+          continue;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        // The buffer stays mapped while the worker reads the frame from it, and isn't used by the GPU until it's unmapped.
+        GlStateCache::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.bufferId);
+        const auto pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.bufferSize, GL_MAP_READ_BIT));
+        GlStateCache::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (pixels == nullptr)
+        {
+          droppedFramesCount++;
+          slot.state = CaptureSlotState::FREE;
+          continue;
+        }
+        slot.writingFrame = launchLoader(writeBmpFile, slot.filePath, pixels, slot.frameSize);
+        slot.state = CaptureSlotState::WRITING;
+      }
+
+      if (slot.state == CaptureSlotState::WRITING)
+      {
+        if (!waitForFrames && slot.writingFrame.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+          continue;
+        }
+        (slot.writingFrame.get() ? savedFramesCount : droppedFramesCount)++;
+        GlStateCache::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.bufferId);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        GlStateCache::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.state = CaptureSlotState::FREE;
+      }
+    }
+  }
+
+  /**
+   * Start copying the back buffer of the window into a free buffer of the ring, to be written to the given file once
+   *   the copy is done.
+   *
+   * @param filePath  The path of the file to write the frame to.
+   *
+   * @return Whether there was a free buffer to copy the frame into.
+   */
+  bool readFrame(const std::string &filePath)
+  {
+    // Take the first free buffer, starting from the one after the buffer taken last so the frames stay in order.
+    auto slotIndex = nextSlotIndex;
+    while (slots[slotIndex].state != CaptureSlotState::FREE)
+    {
+      slotIndex = (slotIndex + 1) % FRAME_CAPTURE_BUFFERS_COUNT;
+      if (slotIndex == nextSlotIndex)
+      {
+        return false;
+      }
+    }
+    nextSlotIndex = (slotIndex + 1) % FRAME_CAPTURE_BUFFERS_COUNT;
+    auto &slot = slots[slotIndex];
+
+    // Create the buffer with the first frame it holds, and grow it if the window got bigger.
+    slot.frameSize = glm::ivec2(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    const size_t frameBytes = size_t(getRowSize(slot.frameSize.x)) * slot.frameSize.y;
+    if (slot.bufferId == 0)
+    {
+      glGenBuffers(1, &slot.bufferId);
+      GlStateCache::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.bufferId);
+      GpuDebugLabels::labelObject(GL_BUFFER, slot.bufferId, "Frame Capture Buffer");
+    }
+    GlStateCache::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, slot.bufferId);
+    if (slot.bufferSize < frameBytes)
+    {
+      glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+      slot.bufferSize = frameBytes;
+    }
+
+    // Queue the copy of the back buffer, or of the framebuffer rendered into in its place, into the buffer, which returns
+    //   right away, and fence it.
+    GlStateCache::getInstance().bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer(GlStateCache::getInstance().getWindowFramebuffer() == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, slot.frameSize.x, slot.frameSize.y, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    GlStateCache::getInstance().bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.filePath = filePath;
+    slot.state = CaptureSlotState::READING;
+    return true;
+  }
+
+public:
+  // Preventing copying the frame capture manager, making sure only one instance can exist.
+  FrameCaptureManager(const FrameCaptureManager &) = delete;
+
+  /**
+   * Ask for a screenshot of the next frame captured.
+   */
+  void requestScreenshot()
+  {
+    screenshotRequested = true;
+  }
+
+  /**
+   * Toggle capturing every frame, numbering their files from the first frame captured.
+   */
+  void toggleContinuousCapture()
+  {
+    continuousCaptureEnabled = !continuousCaptureEnabled;
+  }
+
+  /**
+   * Set whether every frame is captured, numbering their files from the first frame captured.
+   *
+   * @param enabled  Whether the continuous capture is enabled.
+   */
+  void setContinuousCaptureEnabled(const bool &enabled)
+  {
+    continuousCaptureEnabled = enabled;
+  }
+
+  /**
+   * Check if every frame is captured.
+   *
+   * @return Whether the continuous capture is enabled.
+   */
+  bool isContinuousCaptureEnabled() const
+  {
+    return continuousCaptureEnabled;
+  }
+
+  /**
+   * Capture the frame drawn to the back buffer of the window if it was asked for, and move the frames captured before
+   *   along. Must be called once the frame is drawn, before it's swapped.
+   */
+  void captureFrame()
+  {
+    collectFrames(false);
+    if (!screenshotRequested && !continuousCaptureEnabled)
+    {
+      return;
+    }
+    std::filesystem::create_directories(FRAME_CAPTURE_DIRECTORY);
+
+    if (screenshotRequested)
+    {
+      screenshotRequested = false;
+      const auto filePath = FRAME_CAPTURE_DIRECTORY + "/screenshot-" + std::to_string(++screenshotsCount) + ".bmp";
+      if (!readFrame(filePath))
+      {
+        droppedFramesCount++;
+      }
+    }
+    if (continuousCaptureEnabled)
+    {
+      std::stringstream filePath;
+      filePath << FRAME_CAPTURE_DIRECTORY << "/frame-" << std::setw(6) << std::setfill('0') << capturedFramesCount++ << ".bmp";
+      if (!readFrame(filePath.str()))
+      {
+        droppedFramesCount++;
+      }
+    }
+  }
+
+  /**
+   * Wait for every frame captured so far to be written to its file. Must be called before the GL context is destroyed
+   *   or handed over to another thread.
+   */
+  void finishCaptures()
+  {
+    collectFrames(true);
+  }
+
+  /**
+   * Get the number of captured frames written to their files.
+   *
+   * @return The number of frames.
+   */
+  const uint64_t &getSavedFramesCount() const
+  {
+    return savedFramesCount;
+  }
+
+  /**
+   * Get the number of frames asked to be captured that were dropped, because every buffer of the ring was still busy
+   *   or the file couldn't be written.
+   *
+   * @return The number of frames.
+   */
+  const uint64_t &getDroppedFramesCount() const
+  {
+    return droppedFramesCount;
+  }
+
+  /**
+   * Returns the singleton instance of the frame capture manager.
+   *
+   * @return The frame capture manager singleton instance.
+   */
+  static FrameCaptureManager &getInstance()
+  {
+    // Singleton instance of the frame capture manager, constructed the first time it's asked for.
+    static FrameCaptureManager instance;
+    return instance;
+  }
+};
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef INCLUDE_FRAME_HISTORY_CPP
+#define INCLUDE_FRAME_HISTORY_CPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "constants.cpp"
+#include "text.cpp"
+#include "debug_render.cpp"
+
+/**
+ * Class for the timings of the latest frames of a profiled stage, kept in a fixed-size ring so recording a frame never
+ *   allocates.
+ */
+class TimingHistory
+{
+private:
+  // The name of the stage.
+  const std::string name;
+  // The color the stage is drawn with in the graph.
+  const glm::vec4 color;
+  // The timings of the latest frames, in milliseconds, with the next one written at the given index.
+  std::array<float_t, FRAME_HISTORY_LENGTH> samples;
+  uint32_t nextSampleIndex;
+  // The number of timings recorded, up to the size of the ring.
+  uint32_t samplesCount;
+  // The list the timings are sorted in to find their percentiles, reused between frames.
+  std::array<float_t, FRAME_HISTORY_LENGTH> sortedSamples;
+
+public:
+  TimingHistory(const std::string &name, const glm::vec4 &color)
+      : name(name),
+        color(color),
+        samples(),
+        nextSampleIndex(0),
+        samplesCount(0),
+        sortedSamples() {}
+
+  const std::string &getName() const
+  {
+    return name;
+  }
+
+  const glm::vec4 &getColor() const
+  {
+    return color;
+  }
+
+  const uint32_t &getSamplesCount() const
+  {
+    return samplesCount;
+  }
+
+  /**
+   * Record the timing of the latest frame, replacing the oldest one once the ring is full.
+   *
+   * @param timing  The timing, in milliseconds.
+   */
+  void record(const float_t &timing)
+  {
+    samples[nextSampleIndex] = timing;
+    nextSampleIndex = (nextSampleIndex + 1) % FRAME_HISTORY_LENGTH;
+    samplesCount = std::min<uint32_t>(samplesCount + 1, FRAME_HISTORY_LENGTH);
+  }
+
+  /**
+   * Get one of the recorded timings, from the oldest to the latest.
+   *
+   * @param index  The index of the timing, where 0 is the oldest recorded one.
+   *
+   * @return The timing, in milliseconds.
+   */
+  const float_t &getSample(const uint32_t &index) const
+  {
+    return samples[(nextSampleIndex + FRAME_HISTORY_LENGTH - samplesCount + index) % FRAME_HISTORY_LENGTH];
+  }
+
+  /**
+   * Get the minimum, average and 99th percentile of the recorded timings.
+   *
+   * @param minimum     The minimum, set in milliseconds.
+   * @param average     The average, set in milliseconds.
+   * @param percentile  The 99th percentile, set in milliseconds.
+   */
+  void getStatistics(float_t &minimum, float_t &average, float_t &percentile)
+  {
+    minimum = average = percentile = 0.0f;
+    if (samplesCount == 0)
+    {
+      return;
+    }
+
+    auto sum = 0.0;
+    minimum = samples[0];
+    for (uint32_t i = 0; i < samplesCount; i++)
+    {
+      minimum = std::min(minimum, samples[i]);
+      sum += samples[i];
+      sortedSamples[i] = samples[i];
+    }
+    average = float_t(sum / samplesCount);
+
+    // Only the timing at the percentile needs to be in its sorted place.
+    const auto percentileIndex = (samplesCount * 99 + 99) / 100 - 1;
+    std::nth_element(sortedSamples.begin(), sortedSamples.begin() + percentileIndex, sortedSamples.begin() + samplesCount);
+    percentile = sortedSamples[percentileIndex];
+  }
+};
+
+/**
+ * A manager class for keeping the timings of the latest frames of the profiled stages, and showing them in the overlay
+ *   as a graph and rolling statistics, so hitches stand out instead of only the timings of the last frame being shown.
+ */
+class FrameHistoryManager
+{
+private:
+  // The color of the guide lines of the graph, and of the markers of the frames that spiked.
+  const static glm::vec4 guideColor;
+  const static glm::vec4 spikeColor;
+
+  TextManager &textManager;
+  DebugRenderManager &debugRenderManager;
+
+  // The timings of the stages, with the frame times first, which the graph and the spikes follow.
+  std::vector<TimingHistory> stageHistories;
+
+  FrameHistoryManager()
+      : textManager(TextManager::getInstance()),
+        debugRenderManager(DebugRenderManager::getInstance()),
+        stageHistories({}) {}
+
+public:
+  // Preventing copying the frame history manager, making sure only one instance can exist.
+  FrameHistoryManager(const FrameHistoryManager &) = delete;
+
+  /**
+   * Add a stage to keep the timings of. The first stage added is the frame time, which the graph is scaled to.
+   *
+   * @param name   The name of the stage.
+   * @param color  The color the stage is drawn with in the graph.
+   *
+   * @return The index of the stage.
+   */
+  uint32_t addStage(const std::string &name, const glm::vec4 &color)
+  {
+    stageHistories.emplace_back(name, color);
+    return stageHistories.size() - 1;
+  }
+
+  /**
+   * Record the timing of the latest frame of the stage.
+   *
+   * @param stageIndex  The index of the stage.
+   * @param timing      The timing, in milliseconds.
+   */
+  void record(const uint32_t &stageIndex, const float_t &timing)
+  {
+    stageHistories[stageIndex].record(timing);
+  }
+
+  /**
+   * Add the statistics of every stage to the text of the frame, and the graph of their timings to the lines drawn on
+   *   the screen, with the frames that took more than twice the average frame time marked.
+   */
+  void addOverlay()
+  {
+    if (stageHistories.empty())
+    {
+      return;
+    }
+
+    // The graph takes up the bottom right of the screen, with the latest frame on the right.
+    const glm::vec2 graphMin(VIEWPORT_WIDTH * 0.55f, VIEWPORT_HEIGHT * 0.02f);
+    const glm::vec2 graphSize(VIEWPORT_WIDTH * 0.43f, VIEWPORT_HEIGHT * 0.2f);
+
+    // Find the statistics, listed above the graph, scaling the graph so the slow frames fit under the top of it.
+    const auto textX = graphMin.x / TEXT_WIDTH;
+    auto height = (graphMin.y + graphSize.y) / TEXT_HEIGHT + 0.5f * stageHistories.size();
+    auto frameAverage = 0.0f, graphMaximum = 1000.0f / 30.0f;
+    for (auto &stageHistory : stageHistories)
+    {
+      auto minimum = 0.0f, average = 0.0f, percentile = 0.0f;
+      stageHistory.getStatistics(minimum, average, percentile);
+      textManager.addFormattedText(glm::vec2(textX, height), 0.5f, stageHistory.getName(), " (ms) Min: ", minimum, " | Avg: ", average, " | P99: ", percentile);
+      height -= 0.5f;
+      if (&stageHistory == &stageHistories.front())
+      {
+        frameAverage = average;
+        graphMaximum = std::max(graphMaximum, percentile * 1.25f);
+      }
+    }
+
+    const auto sampleWidth = graphSize.x / (FRAME_HISTORY_LENGTH - 1);
+    const auto getGraphY = [&](const float_t &timing) {
+      return graphMin.y + graphSize.y * std::min(timing / graphMaximum, 1.0f);
+    };
+
+    // Mark the frame times of 60 and 30 frames per second, and the bounds of the graph.
+    debugRenderManager.addScreenLine(graphMin, glm::vec2(graphMin.x + graphSize.x, graphMin.y), guideColor);
+    debugRenderManager.addScreenLine(graphMin, glm::vec2(graphMin.x, graphMin.y + graphSize.y), guideColor);
+    for (const auto &guideTiming : {1000.0f / 60.0f, 1000.0f / 30.0f})
+    {
+      const auto guideY = getGraphY(guideTiming);
+      debugRenderManager.addScreenLine(glm::vec2(graphMin.x, guideY), glm::vec2(graphMin.x + graphSize.x, guideY), guideColor);
+    }
+
+    for (const auto &stageHistory : stageHistories)
+    {
+      const auto samplesCount = stageHistory.getSamplesCount();
+      // Align the latest timing with the right of the graph, however many timings there are so far.
+      const auto startX = graphMin.x + graphSize.x - sampleWidth * (samplesCount - 1);
+      for (uint32_t i = 1; i < samplesCount; i++)
+      {
+        debugRenderManager.addScreenLine(glm::vec2(startX + sampleWidth * (i - 1), getGraphY(stageHistory.getSample(i - 1))),
+                                         glm::vec2(startX + sampleWidth * i, getGraphY(stageHistory.getSample(i))),
+                                         stageHistory.getColor());
+      }
+    }
+
+    // Mark the frames that spiked with a line up the whole graph.
+    const auto &frameHistory = stageHistories.front();
+    const auto frameStartX = graphMin.x + graphSize.x - sampleWidth * (frameHistory.getSamplesCount() - 1);
+    for (uint32_t i = 0; i < frameHistory.getSamplesCount(); i++)
+    {
+      if (frameHistory.getSample(i) > frameAverage * 2.0f)
+      {
+        const auto spikeX = frameStartX + sampleWidth * i;
+        debugRenderManager.addScreenLine(glm::vec2(spikeX, graphMin.y), glm::vec2(spikeX, graphMin.y + graphSize.y), spikeColor);
+      }
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the frame history manager.
+   *
+   * @return The frame history manager singleton instance.
+   */
+  static FrameHistoryManager &getInstance()
+  {
+    // Singleton instance of the frame history manager, constructed the first time it's asked for.
+    static FrameHistoryManager instance;
+    return instance;
+  }
+};
+
+// Initialize the graph colors static variables.
+const glm::vec4 FrameHistoryManager::guideColor = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+const glm::vec4 FrameHistoryManager::spikeColor = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef INCLUDE_FRAME_TIME_CPP
+#define INCLUDE_FRAME_TIME_CPP
+
+#include <cstdint>
+#include <cmath>
+
+#include <GLFW/glfw3.h>
+
+/**
+ * Structure for the time of a frame, read once at the start of the frame and passed to everything updating in it, so
+ *   they all see the same time.
+ */
+struct FrameTime
+{
+  // The time the frame started at, in seconds.
+  double_t now;
+  // The time since the previous frame started, in seconds.
+  float_t delta;
+  // The index of the frame, starting from 0.
+  uint64_t frameIndex;
+};
+
+/**
+ * Class for the clock of a scene, giving the time of each frame of the scene.
+ */
+class FrameClock
+{
+private:
+  // The time of the latest frame.
+  FrameTime frameTime;
+  // The number of frames started.
+  uint64_t framesCount;
+
+public:
+  /**
+   * Create a clock, counting the time of the first frame from now.
+   */
+  FrameClock()
+      : frameTime({glfwGetTime(), 0.0f, 0}),
+        framesCount(0) {}
+
+  /**
+   * Start the next frame, reading the time for it.
+   *
+   * @return The time of the frame.
+   */
+  const FrameTime &tick()
+  {
+    return tick(glfwGetTime());
+  }
+
+  /**
+   * Start the next frame at the given time, such as the time of a frame being replayed.
+   *
+   * @param now  The time the frame starts at, in seconds.
+   *
+   * @return The time of the frame.
+   */
+  const FrameTime &tick(const double_t &now)
+  {
+    frameTime.delta = float_t(now - frameTime.now);
+    frameTime.now = now;
+    frameTime.frameIndex = framesCount++;
+    return frameTime;
+  }
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef INCLUDE_FRUSTUM_CPP
+#define INCLUDE_FRUSTUM_CPP
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+/**
+ * Class for defining the view frustum of a projection-view matrix as six planes, for testing if a volume can be seen.
+ */
+class Frustum
+{
+private:
+  // The planes of the frustum (left, right, bottom, top, near, far), with the normals pointing inside the frustum.
+  std::array<glm::vec4, 6> planes;
+
+public:
+  /**
+   * Extract the planes of the frustum from the given projection-view matrix.
+   *
+   * @param vpMatrix  The projection-view matrix.
+   */
+  Frustum(const glm::mat4 &vpMatrix)
+  {
+    // Get the rows of the matrix, since glm stores the matrix by columns.
+    const auto row0 = glm::vec4(vpMatrix[0][0], vpMatrix[1][0], vpMatrix[2][0], vpMatrix[3][0]);
+    const auto row1 = glm::vec4(vpMatrix[0][1], vpMatrix[1][1], vpMatrix[2][1], vpMatrix[3][1]);
+    const auto row2 = glm::vec4(vpMatrix[0][2], vpMatrix[1][2], vpMatrix[2][2], vpMatrix[3][2]);
+    const auto row3 = glm::vec4(vpMatrix[0][3], vpMatrix[1][3], vpMatrix[2][3], vpMatrix[3][3]);
+
+    // Each plane is where a clip space coordinate equals +/- w.
+    planes = {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2};
+    // Normalize the planes so their distances are in world units.
+    for (auto &plane : planes)
+    {
+      plane /= glm::length(glm::vec3(plane));
+    }
+  }
+
+  /**
+   * Check if the axis-aligned box is at least partially inside the frustum. Boxes close to the corners of the frustum may
+   * be reported as inside even when they're not, which only means they're drawn when they don't need to be.
+   *
+   * @param minCorner  The minimum size corner of the box.
+   * @param maxCorner  The maximum size corner of the box.
+   *
+   * @return Whether the box might be inside the frustum.
+   */
+  bool intersectsBox(const glm::vec3 &minCorner, const glm::vec3 &maxCorner) const
+  {
+    // Iterate through the planes of the frustum.
+    for (const auto &plane : planes)
+    {
+      // Find the corner of the box furthest along the normal of the plane.
+      const auto furthestCorner = glm::vec3(plane.x > 0 ? maxCorner.x : minCorner.x,
+                                            plane.y > 0 ? maxCorner.y : minCorner.y,
+                                            plane.z > 0 ? maxCorner.z : minCorner.z);
+      // If even that corner is behind the plane, the whole box is outside the frustum.
+      if (glm::dot(glm::vec3(plane), furthestCorner) + plane.w < 0)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Get the corners of the frustum, where each three of its planes meet.
+   *
+   * @return The corners, with the bits of the index picking the right (1), top (2) and far (4) planes instead of the left,
+   *   bottom and near planes.
+   */
+  std::array<glm::vec3, 8> getCorners() const
+  {
+    std::array<glm::vec3, 8> corners;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+      const auto &plane1 = planes[i & 1 ? 1 : 0], &plane2 = planes[i & 2 ? 3 : 2], &plane3 = planes[i & 4 ? 5 : 4];
+      const auto normal1 = glm::vec3(plane1), normal2 = glm::vec3(plane2), normal3 = glm::vec3(plane3);
+      const auto cross23 = glm::cross(normal2, normal3), cross31 = glm::cross(normal3, normal1), cross12 = glm::cross(normal1, normal2);
+      corners[i] = -(plane1.w * cross23 + plane2.w * cross31 + plane3.w * cross12) / glm::dot(normal1, cross23);
+    }
+    return corners;
+  }
+
+  /**
+   * Check if the other frustum is at least partially inside the frustum, by looking for a plane of either frustum with
+   * all the corners of the other one behind it. Frustums crossing near their edges may be reported as overlapping even
+   * when they're not.
+   *
+   * @param other  The other frustum.
+   *
+   * @return Whether the frustums might overlap.
+   */
+  bool intersectsFrustum(const Frustum &other) const
+  {
+    const auto isSeparatedBy = [](const std::array<glm::vec4, 6> &separatingPlanes, const std::array<glm::vec3, 8> &corners) {
+      for (const auto &plane : separatingPlanes)
+      {
+        bool allBehind = true;
+        for (const auto &corner : corners)
+        {
+          if (glm::dot(glm::vec3(plane), corner) + plane.w >= 0)
+          {
+            allBehind = false;
+            break;
+          }
+        }
+        if (allBehind)
+        {
+          return true;
+        }
+      }
+      return false;
+    };
+    return !isSeparatedBy(planes, other.getCorners()) && !isSeparatedBy(other.planes, getCorners());
+  }
+
+  /**
+   * Get the planes of the frustum, such as for testing volumes against them on the GPU.
+   *
+   * @return The planes (left, right, bottom, top, near, far), with the normals pointing inside the frustum.
+   */
+  const std::array<glm::vec4, 6> &getPlanes() const
+  {
+    return planes;
+  }
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef INCLUDE_GBUFFER_CPP
+#define INCLUDE_GBUFFER_CPP
+
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+#include "constants.cpp"
+#include "window.cpp"
+#include "log.cpp"
+
+/**
+ * Class for the geometry buffer of deferred shading, which the models draw their surface details into (albedo, view-space
+ * normal and depth), so the lights can then be applied once per pixel of the screen in a single lighting pass.
+ */
+class GeometryBuffer
+{
+private:
+  // The width and height of the textures of the geometry buffer.
+  const int32_t width;
+  const int32_t height;
+
+  // The texture holding the albedo of the surfaces (rgb), and whether they are covered (a).
+  const GLuint albedoTextureId;
+  // The texture holding the view-space normals of the surfaces (xyz), and whether they are lit (w).
+  const GLuint normalTextureId;
+  // The texture holding the depths of the surfaces.
+  const GLuint depthTextureId;
+  // The framebuffer the textures are attached to.
+  const GLuint framebufferId;
+
+  /**
+   * Create a texture of the size of the geometry buffer, read without filtering since the lighting pass reads exactly one
+   *   texel per pixel.
+   *
+   * @param internalFormat  The format the texture stores its data in.
+   * @param format          The format of the pixel data.
+   * @param type            The data type of the pixel data.
+   *
+   * @return The ID of the created texture.
+   */
+  GLuint createTexture(const GLenum &internalFormat, const GLenum &format, const GLenum &type) const
+  {
+    GLuint newTextureId;
+    glGenTextures(1, &newTextureId);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, newTextureId);
+    if (WindowManager::getInstance().isTextureStorageSupported())
+    {
+      glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+    }
+    else
+    {
+      glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+    return newTextureId;
+  }
+
+  /**
+   * Create the framebuffer of the geometry buffer, with the albedo and normal textures as its two color outputs and the
+   *   depth texture as its depth buffer.
+   *
+   * @return The ID of the created framebuffer.
+   */
+  GLuint createFramebuffer() const
+  {
+    GLuint newFramebufferId;
+    glGenFramebuffers(1, &newFramebufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, newFramebufferId);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, albedoTextureId, 0);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, normalTextureId, 0);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTextureId, 0);
+    // The fragment shader outputs at locations 0 and 1 go to the albedo and normal textures.
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+
+    // Check if the framebuffer was successfully created.
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      // Framebuffer is not ready. Time to crash.
+      Logger::getInstance().error("Failed at gbuffer 1");
+      exit(1);
+    }
+
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return newFramebufferId;
+  }
+
+public:
+  /**
+   * Create a geometry buffer of the given size.
+   *
+   * @param width   The width of the geometry buffer, in pixels.
+   * @param height  The height of the geometry buffer, in pixels.
+   */
+  GeometryBuffer(const int32_t &width, const int32_t &height)
+      : width(width),
+        height(height),
+        albedoTextureId(createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE)),
+        normalTextureId(createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT)),
+        depthTextureId(createTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT)),
+        framebufferId(createFramebuffer()) {}
+
+  // Preventing copying the geometry buffer, since it owns its textures and framebuffer.
+  GeometryBuffer(const GeometryBuffer &) = delete;
+
+  ~GeometryBuffer()
+  {
+    GlStateCache::getInstance().deleteFramebuffers(1, &framebufferId);
+    GlStateCache::getInstance().deleteTextures(1, &albedoTextureId);
+    GlStateCache::getInstance().deleteTextures(1, &normalTextureId);
+    GlStateCache::getInstance().deleteTextures(1, &depthTextureId);
+  }
+
+  /**
+   * Get the ID of the framebuffer of the geometry buffer.
+   *
+   * @return The framebuffer ID.
+   */
+  const GLuint &getFramebufferId() const
+  {
+    return framebufferId;
+  }
+
+  /**
+   * Clear the bound framebuffer of the geometry buffer, so the models can be drawn into it. Pixels no model is drawn to
+   *   are left transparent black and unlit, at the furthest depth.
+   *
+   * @param viewportSize  The size of the part of the geometry buffer to draw to, from its bottom-left corner, which is at
+   *                      most the size of the geometry buffer.
+   */
+  void clearForGeometryPass(const glm::ivec2 &viewportSize) const
+  {
+    GlStateCache::getInstance().setViewport(0, 0, std::min(viewportSize.x, width), std::min(viewportSize.y, height));
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  }
+
+  /**
+   * Bind the textures of the geometry buffer to the given texture units, starting from the albedo, then the normal, then
+   *   the depth.
+   *
+   * @param firstTextureUnit  The texture unit of the albedo texture.
+   */
+  void bindTextures(const GLuint &firstTextureUnit) const
+  {
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0 + firstTextureUnit);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, albedoTextureId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0 + firstTextureUnit + 1);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, normalTextureId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0 + firstTextureUnit + 2);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, depthTextureId);
+  }
+};
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef INCLUDE_GL_DEBUG_CPP
+#define INCLUDE_GL_DEBUG_CPP
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <map>
+#include <mutex>
+
+#include <GL/glew.h>
+
+#include "gl_state.cpp"
+#include "constants.cpp"
+#include "profiler.cpp"
+#include "log.cpp"
+
+/**
+ * A class to log the performance warnings the driver reports through the debug output, such as shader recompiles,
+ *   buffer stalls and implicit syncs, along with the profiling zones the thread was in when it made the call causing
+ *   them. The output is synchronous, so the warnings are reported on the thread making the call, inside its zones.
+ */
+class GlDebugLog
+{
+private:
+  // The lock guarding the log, since whichever thread owns the context reports its warnings.
+  std::mutex logMutex;
+  // The file the warnings are written to, opened with the first warning.
+  std::ofstream logFile;
+  // The number of times each warning was reported, by its ID, so repeated warnings are only counted after a while.
+  std::map<GLuint, uint64_t> messageCounts;
+  // The number of warnings reported.
+  uint64_t messagesCount;
+
+  GlDebugLog()
+      : logMutex(),
+        logFile(),
+        messageCounts({}),
+        messagesCount(0) {}
+
+  /**
+   * Get the name of the severity of a debug message.
+   *
+   * @param severity  The severity of the message.
+   *
+   * @return The name of the severity.
+   */
+  static const char *getSeverityName(const GLenum &severity)
+  {
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH:
+      return "High";
+    case GL_DEBUG_SEVERITY_MEDIUM:
+      return "Medium";
+    case GL_DEBUG_SEVERITY_LOW:
+      return "Low";
+    default:
+      return "Notification";
+    }
+  }
+
+  /**
+   * Write a warning reported by the driver to the log, with the zones of the thread from the innermost one out.
+   *
+   * @param id        The ID of the warning, which the driver keeps the same for repeats of it.
+   * @param severity  The severity of the warning.
+   * @param message   The text of the warning.
+   */
+  void logMessage(const GLuint &id, const GLenum &severity, const GLchar *message)
+  {
+    std::lock_guard<std::mutex> logLock(logMutex);
+    messagesCount++;
+    const auto messageCount = ++messageCounts[id];
+    if (messageCount > GL_DEBUG_REPEATED_MESSAGES_LOGGED)
+    {
+      return;
+    }
+    if (!logFile.is_open())
+    {
+      logFile.open(GL_DEBUG_LOG_FILE, std::ios::out | std::ios::trunc);
+      if (!logFile.is_open())
+      {
+        Logger::getInstance().error("Failed at GL debug 1");
+        return;
+      }
+    }
+    logFile << "[Frame " << ProfileManager::getInstance().getCurrentFrame() << "] [" << getSeverityName(severity) << "] " << id << ": " << message << "\n  Zones:";
+    for (auto zone = ProfileZone::getCurrentZone(); zone != nullptr; zone = zone->getParentZone())
+    {
+      logFile << " " << zone->getName() << (zone->getParentZone() != nullptr ? " <" : "");
+    }
+    if (messageCount == GL_DEBUG_REPEATED_MESSAGES_LOGGED)
+    {
+      logFile << "\n  Further repeats of this warning are only counted.";
+    }
+    logFile << std::endl;
+  }
+
+  /**
+   * Receive a debug message from the driver.
+   *
+   * @param source     The part of the driver that sent the message.
+   * @param type       The type of the message.
+   * @param id         The ID of the message.
+   * @param severity   The severity of the message.
+   * @param length     The length of the text of the message.
+   * @param message    The text of the message.
+   * @param userParam  The GL debug log the messages are sent to.
+   */
+  static void GLAPIENTRY receiveMessage(GLenum, GLenum type, GLuint id, GLenum severity, GLsizei, const GLchar *message, const void *userParam)
+  {
+    if (type != GL_DEBUG_TYPE_PERFORMANCE)
+    {
+      return;
+    }
+    static_cast<GlDebugLog *>(const_cast<void *>(userParam))->logMessage(id, severity, message);
+  }
+
+public:
+  // Preventing copying the GL debug log, making sure only one instance can exist.
+  GlDebugLog(const GlDebugLog &) = delete;
+
+  /**
+   * Start receiving the performance warnings of the driver for the current context. Must be called on the thread owning
+   *   the GL context, once the debug output is known to be supported.
+   */
+  void attach()
+  {
+    GlStateCache::getInstance().setCapability(GL_DEBUG_OUTPUT, true);
+    // Report the warnings during the calls causing them, so the zones of the thread point at where they came from.
+    GlStateCache::getInstance().setCapability(GL_DEBUG_OUTPUT_SYNCHRONOUS, true);
+    glDebugMessageCallback(receiveMessage, this);
+    // Only the performance warnings are logged, so the driver doesn't have to send anything else.
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+  }
+
+  /**
+   * Get the number of performance warnings the driver reported, including the repeats that weren't logged.
+   *
+   * @return The number of warnings.
+   */
+  uint64_t getMessagesCount()
+  {
+    std::lock_guard<std::mutex> logLock(logMutex);
+    return messagesCount;
+  }
+
+  /**
+   * Returns the singleton instance of the GL debug log.
+   *
+   * @return The GL debug log singleton instance.
+   */
+  static GlDebugLog &getInstance()
+  {
+    // Singleton instance of the GL debug log, constructed the first time it's asked for.
+    static GlDebugLog instance;
+    return instance;
+  }
+};
+
+
+/**
+ * Class for naming the GL objects after the assets they hold, so GPU capture tools such as RenderDoc and Nsight show
+ *   the names instead of the IDs. Nothing is named where the driver doesn't support debug labels.
+ */
+class GpuDebugLabels
+{
+public:
+  // Prevent creating the debug labels, since they only have static members.
+  GpuDebugLabels() = delete;
+
+  /**
+   * Check if the driver supports debug groups and object labels. Must be called once GLEW is initialized.
+   *
+   * @return Whether debug labels are supported.
+   */
+  static bool isSupported()
+  {
+    return GLEW_VERSION_4_3 || GLEW_KHR_debug;
+  }
+
+  /**
+   * Name a GL object.
+   *
+   * @param identifier  The type of the object, such as GL_TEXTURE or GL_PROGRAM.
+   * @param objectId    The ID of the object.
+   * @param label       The name of the object.
+   */
+  static void labelObject(const GLenum &identifier, const GLuint &objectId, const std::string &label)
+  {
+    if (!isSupported() || objectId == 0)
+    {
+      return;
+    }
+    glObjectLabel(identifier, objectId, label.size(), label.c_str());
+  }
+};
+
+/**
+ * Class for a debug group covering the scope it's created in, which GPU capture tools show the calls made inside it
+ *   nested under, like the profiling zones do for the CPU.
+ */
+class GpuDebugGroup
+{
+private:
+  // Whether the group was pushed, which it isn't where the driver doesn't support debug groups.
+  const bool pushed;
+
+public:
+  /**
+   * Push a debug group.
+   *
+   * @param name  The name of the group.
+   */
+  GpuDebugGroup(const std::string &name)
+      : pushed(GpuDebugLabels::isSupported())
+  {
+    if (pushed)
+    {
+      glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, name.size(), name.c_str());
+    }
+  }
+
+  // Preventing copying the group, since it would be popped twice.
+  GpuDebugGroup(const GpuDebugGroup &) = delete;
+
+  ~GpuDebugGroup()
+  {
+    if (pushed)
+    {
+      glPopDebugGroup();
+    }
+  }
+};
+
+#endif
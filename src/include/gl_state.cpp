@@ -0,0 +1,594 @@
+#ifndef INCLUDE_GL_STATE_CPP
+#define INCLUDE_GL_STATE_CPP
+
+#include <array>
+#include <map>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/**
+ * A class caching the state of the OpenGL context that the managers change the most, such as the bound shader program,
+ *   buffers, textures, samplers, framebuffers and vertex array, the enabled capabilities, the blend function and the
+ *   viewport. All the code changing that state goes through the cache, which leaves out the calls that wouldn't change
+ *   anything, and counts the calls it made and left out. State the cache doesn't know yet, or forgot, is always set.
+ */
+class GlStateCache
+{
+private:
+  // The value of the state the cache doesn't know.
+  static const GLuint UNKNOWN;
+  // The buffer targets cached, in the order of the bound buffers.
+  static const std::array<GLenum, 12> bufferTargets;
+  // The texture targets cached, in the order of the bound textures of each unit.
+  static const std::array<GLenum, 7> textureTargets;
+  // The number of texture units cached.
+  static const uint32_t TEXTURE_UNITS_COUNT = 32;
+
+  // The bound shader program.
+  GLuint programId;
+  // The buffers bound to each of the buffer targets.
+  std::array<GLuint, 12> boundBuffers;
+  // The active texture unit, and the textures bound to each of the texture targets of each unit.
+  GLuint activeTextureUnit;
+  std::array<std::array<GLuint, 7>, TEXTURE_UNITS_COUNT> boundTextures;
+  // The samplers bound to each texture unit.
+  std::array<GLuint, TEXTURE_UNITS_COUNT> boundSamplers;
+  // The framebuffers bound for drawing and for reading.
+  GLuint drawFramebufferId;
+  GLuint readFramebufferId;
+  // The framebuffer bound whenever the window is asked for, which is the window itself unless it renders offscreen.
+  GLuint windowFramebufferId;
+  // The bound vertex array.
+  GLuint vertexArrayId;
+  // Whether the capabilities are enabled, for those known.
+  std::map<GLenum, bool> capabilities;
+  // The source and destination blend factors of the colors and of the alphas, and whether they're known.
+  glm::uvec4 blendFactors;
+  bool blendFactorsKnown;
+  // The viewport, and whether it's known.
+  glm::ivec4 viewport;
+  bool viewportKnown;
+
+  // The calls made and left out since the counts were last reset.
+  uint64_t issuedCallsCount;
+  uint64_t skippedCallsCount;
+
+  GlStateCache()
+      : programId(UNKNOWN),
+        boundBuffers(),
+        activeTextureUnit(UNKNOWN),
+        boundTextures(),
+        boundSamplers(),
+        drawFramebufferId(UNKNOWN),
+        readFramebufferId(UNKNOWN),
+        windowFramebufferId(0),
+        vertexArrayId(UNKNOWN),
+        capabilities({}),
+        blendFactors(0),
+        blendFactorsKnown(false),
+        viewport(0),
+        viewportKnown(false),
+        issuedCallsCount(0),
+        skippedCallsCount(0)
+  {
+    invalidate();
+  }
+
+  /**
+   * Get the index of the given buffer target among the cached ones.
+   *
+   * @param target  The buffer target.
+   *
+   * @return The index of the target, or the number of targets cached if it isn't cached.
+   */
+  static uint32_t getBufferTargetIndex(const GLenum &target)
+  {
+    for (uint32_t i = 0; i < bufferTargets.size(); i++)
+    {
+      if (bufferTargets[i] == target)
+      {
+        return i;
+      }
+    }
+    return bufferTargets.size();
+  }
+
+  /**
+   * Get the index of the given texture target among the cached ones.
+   *
+   * @param target  The texture target.
+   *
+   * @return The index of the target, or the number of targets cached if it isn't cached.
+   */
+  static uint32_t getTextureTargetIndex(const GLenum &target)
+  {
+    for (uint32_t i = 0; i < textureTargets.size(); i++)
+    {
+      if (textureTargets[i] == target)
+      {
+        return i;
+      }
+    }
+    return textureTargets.size();
+  }
+
+  /**
+   * Check if the cached state already has the given value, counting the call as left out if it does, or as made after
+   *   storing the value if it doesn't.
+   *
+   * @param cachedValue  The cached state.
+   * @param value        The value being set.
+   *
+   * @return Whether the call has to be made.
+   */
+  template <typename T>
+  bool update(T &cachedValue, const T &value)
+  {
+    if (cachedValue == value)
+    {
+      skippedCallsCount++;
+      return false;
+    }
+    cachedValue = value;
+    issuedCallsCount++;
+    return true;
+  }
+
+  /**
+   * Forget the given object wherever it's cached, since it was deleted, which unbinds it from the context and frees its
+   *   name for a new object.
+   *
+   * @param cachedValues  The cached state the object can be in.
+   * @param objectId      The ID of the deleted object.
+   */
+  template <size_t N>
+  static void forget(std::array<GLuint, N> &cachedValues, const GLuint &objectId)
+  {
+    for (auto &cachedValue : cachedValues)
+    {
+      cachedValue = cachedValue == objectId ? UNKNOWN : cachedValue;
+    }
+  }
+
+public:
+  // Preventing copying the GL state cache, making sure only one instance can exist.
+  GlStateCache(const GlStateCache &) = delete;
+
+  /**
+   * Forget all the cached state, so everything is set again, such as after code outside the cache changed it.
+   */
+  void invalidate()
+  {
+    programId = UNKNOWN;
+    boundBuffers.fill(UNKNOWN);
+    activeTextureUnit = UNKNOWN;
+    for (auto &unitTextures : boundTextures)
+    {
+      unitTextures.fill(UNKNOWN);
+    }
+    boundSamplers.fill(UNKNOWN);
+    drawFramebufferId = UNKNOWN;
+    readFramebufferId = UNKNOWN;
+    vertexArrayId = UNKNOWN;
+    capabilities.clear();
+    blendFactorsKnown = false;
+    viewportKnown = false;
+  }
+
+  /**
+   * Use the given shader program, unless it's already used.
+   *
+   * @param newProgramId  The ID of the shader program.
+   */
+  void useProgram(const GLuint &newProgramId)
+  {
+    if (update(programId, newProgramId))
+    {
+      glUseProgram(newProgramId);
+    }
+  }
+
+  /**
+   * Bind the given buffer to the given target, unless it's already bound there.
+   *
+   * @param target    The buffer target.
+   * @param bufferId  The ID of the buffer.
+   */
+  void bindBuffer(const GLenum &target, const GLuint &bufferId)
+  {
+    const auto targetIndex = getBufferTargetIndex(target);
+    if (targetIndex == bufferTargets.size())
+    {
+      issuedCallsCount++;
+      glBindBuffer(target, bufferId);
+      return;
+    }
+    if (update(boundBuffers[targetIndex], bufferId))
+    {
+      glBindBuffer(target, bufferId);
+    }
+  }
+
+  /**
+   * Bind the given buffer to an indexed binding point of the given target, which binds it to the target as well.
+   *
+   * @param target    The buffer target.
+   * @param index     The index of the binding point.
+   * @param bufferId  The ID of the buffer.
+   */
+  void bindBufferBase(const GLenum &target, const GLuint &index, const GLuint &bufferId)
+  {
+    const auto targetIndex = getBufferTargetIndex(target);
+    if (targetIndex != bufferTargets.size())
+    {
+      boundBuffers[targetIndex] = bufferId;
+    }
+    issuedCallsCount++;
+    glBindBufferBase(target, index, bufferId);
+  }
+
+  /**
+   * Bind a range of the given buffer to an indexed binding point of the given target, which binds it to the target as
+   *   well.
+   *
+   * @param target    The buffer target.
+   * @param index     The index of the binding point.
+   * @param bufferId  The ID of the buffer.
+   * @param offset    The offset of the range, in bytes.
+   * @param size      The size of the range, in bytes.
+   */
+  void bindBufferRange(const GLenum &target, const GLuint &index, const GLuint &bufferId, const GLintptr &offset, const GLsizeiptr &size)
+  {
+    const auto targetIndex = getBufferTargetIndex(target);
+    if (targetIndex != bufferTargets.size())
+    {
+      boundBuffers[targetIndex] = bufferId;
+    }
+    issuedCallsCount++;
+    glBindBufferRange(target, index, bufferId, offset, size);
+  }
+
+  /**
+   * Make the given texture unit active, unless it already is.
+   *
+   * @param textureUnit  The texture unit, from GL_TEXTURE0 on.
+   */
+  void activeTexture(const GLenum &textureUnit)
+  {
+    if (update(activeTextureUnit, GLuint(textureUnit)))
+    {
+      glActiveTexture(textureUnit);
+    }
+  }
+
+  /**
+   * Bind the given texture to the given target of the active texture unit, unless it's already bound there.
+   *
+   * @param target     The texture target.
+   * @param textureId  The ID of the texture.
+   */
+  void bindTexture(const GLenum &target, const GLuint &textureId)
+  {
+    const auto targetIndex = getTextureTargetIndex(target);
+    const auto unitIndex = activeTextureUnit - GL_TEXTURE0;
+    if (targetIndex == textureTargets.size() || activeTextureUnit == UNKNOWN || unitIndex >= TEXTURE_UNITS_COUNT)
+    {
+      // The texture is bound without knowing what it replaced, so wherever it went is forgotten.
+      if (targetIndex != textureTargets.size() && activeTextureUnit == UNKNOWN)
+      {
+        for (auto &unitTextures : boundTextures)
+        {
+          unitTextures[targetIndex] = UNKNOWN;
+        }
+      }
+      issuedCallsCount++;
+      glBindTexture(target, textureId);
+      return;
+    }
+    if (update(boundTextures[unitIndex][targetIndex], textureId))
+    {
+      glBindTexture(target, textureId);
+    }
+  }
+
+  /**
+   * Bind the given sampler to the given texture unit, unless it's already bound there, overriding how the textures bound
+   *   to the unit are filtered and wrapped.
+   *
+   * @param unit       The index of the texture unit, from 0 on.
+   * @param samplerId  The ID of the sampler, or 0 for the textures to use their own parameters.
+   */
+  void bindSampler(const GLuint &unit, const GLuint &samplerId)
+  {
+    if (unit >= TEXTURE_UNITS_COUNT)
+    {
+      issuedCallsCount++;
+      glBindSampler(unit, samplerId);
+      return;
+    }
+    if (update(boundSamplers[unit], samplerId))
+    {
+      glBindSampler(unit, samplerId);
+    }
+  }
+
+  /**
+   * Bind the given framebuffer for drawing, reading or both, unless it's already bound that way.
+   *
+   * @param target                  The framebuffer target, where GL_FRAMEBUFFER binds it for both.
+   * @param requestedFramebufferId  The ID of the framebuffer, where 0 is the window, or the framebuffer set in its place.
+   */
+  void bindFramebuffer(const GLenum &target, const GLuint &requestedFramebufferId)
+  {
+    const auto framebufferId = requestedFramebufferId == 0 ? windowFramebufferId : requestedFramebufferId;
+    if (target == GL_FRAMEBUFFER)
+    {
+      if (drawFramebufferId == framebufferId && readFramebufferId == framebufferId)
+      {
+        skippedCallsCount++;
+        return;
+      }
+      drawFramebufferId = framebufferId;
+      readFramebufferId = framebufferId;
+      issuedCallsCount++;
+      glBindFramebuffer(target, framebufferId);
+      return;
+    }
+    if (update(target == GL_DRAW_FRAMEBUFFER ? drawFramebufferId : readFramebufferId, framebufferId))
+    {
+      glBindFramebuffer(target, framebufferId);
+    }
+  }
+
+  /**
+   * Bind the given vertex array, unless it's already bound. The element buffer belongs to the vertex array, so it's
+   *   forgotten when another vertex array is bound.
+   *
+   * @param newVertexArrayId  The ID of the vertex array.
+   */
+  void bindVertexArray(const GLuint &newVertexArrayId)
+  {
+    if (update(vertexArrayId, newVertexArrayId))
+    {
+      boundBuffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+      glBindVertexArray(newVertexArrayId);
+    }
+  }
+
+  /**
+   * Enable or disable the given capability, unless it already is.
+   *
+   * @param capability  The capability.
+   * @param enabled     Whether the capability is enabled.
+   */
+  void setCapability(const GLenum &capability, const bool &enabled)
+  {
+    const auto knownCapability = capabilities.find(capability);
+    if (knownCapability != capabilities.end() && knownCapability->second == enabled)
+    {
+      skippedCallsCount++;
+      return;
+    }
+    capabilities[capability] = enabled;
+    issuedCallsCount++;
+    if (enabled)
+    {
+      glEnable(capability);
+    }
+    else
+    {
+      glDisable(capability);
+    }
+  }
+
+  /**
+   * Set the factors the source and destination colors are blended with, unless they already are.
+   *
+   * @param sourceFactor       The source blend factor.
+   * @param destinationFactor  The destination blend factor.
+   */
+  void setBlendFunc(const GLenum &sourceFactor, const GLenum &destinationFactor)
+  {
+    setBlendFuncSeparate(sourceFactor, destinationFactor, sourceFactor, destinationFactor);
+  }
+
+  /**
+   * Set the factors the source and destination colors are blended with, and the ones their alphas are blended with,
+   *   unless they already are.
+   *
+   * @param sourceColorFactor       The source blend factor of the colors.
+   * @param destinationColorFactor  The destination blend factor of the colors.
+   * @param sourceAlphaFactor       The source blend factor of the alphas.
+   * @param destinationAlphaFactor  The destination blend factor of the alphas.
+   */
+  void setBlendFuncSeparate(const GLenum &sourceColorFactor, const GLenum &destinationColorFactor, const GLenum &sourceAlphaFactor, const GLenum &destinationAlphaFactor)
+  {
+    const glm::uvec4 newBlendFactors(sourceColorFactor, destinationColorFactor, sourceAlphaFactor, destinationAlphaFactor);
+    if (blendFactorsKnown && blendFactors == newBlendFactors)
+    {
+      skippedCallsCount++;
+      return;
+    }
+    blendFactors = newBlendFactors;
+    blendFactorsKnown = true;
+    issuedCallsCount++;
+    glBlendFuncSeparate(sourceColorFactor, destinationColorFactor, sourceAlphaFactor, destinationAlphaFactor);
+  }
+
+  /**
+   * Set the viewport, unless it already is.
+   *
+   * @param x       The left of the viewport, in pixels.
+   * @param y       The bottom of the viewport, in pixels.
+   * @param width   The width of the viewport, in pixels.
+   * @param height  The height of the viewport, in pixels.
+   */
+  void setViewport(const GLint &x, const GLint &y, const GLsizei &width, const GLsizei &height)
+  {
+    const glm::ivec4 newViewport(x, y, width, height);
+    if (viewportKnown && viewport == newViewport)
+    {
+      skippedCallsCount++;
+      return;
+    }
+    viewport = newViewport;
+    viewportKnown = true;
+    issuedCallsCount++;
+    glViewport(x, y, width, height);
+  }
+
+  /**
+   * Delete the given shader program, forgetting it if it's used.
+   *
+   * @param deletedProgramId  The ID of the shader program.
+   */
+  void deleteProgram(const GLuint &deletedProgramId)
+  {
+    programId = programId == deletedProgramId ? UNKNOWN : programId;
+    glDeleteProgram(deletedProgramId);
+  }
+
+  /**
+   * Delete the given buffers, forgetting them wherever they're bound.
+   *
+   * @param count      The number of buffers.
+   * @param bufferIds  The IDs of the buffers.
+   */
+  void deleteBuffers(const GLsizei &count, const GLuint *bufferIds)
+  {
+    for (GLsizei i = 0; i < count; i++)
+    {
+      forget(boundBuffers, bufferIds[i]);
+    }
+    glDeleteBuffers(count, bufferIds);
+  }
+
+  /**
+   * Delete the given textures, forgetting them wherever they're bound.
+   *
+   * @param count       The number of textures.
+   * @param textureIds  The IDs of the textures.
+   */
+  void deleteTextures(const GLsizei &count, const GLuint *textureIds)
+  {
+    for (GLsizei i = 0; i < count; i++)
+    {
+      for (auto &unitTextures : boundTextures)
+      {
+        forget(unitTextures, textureIds[i]);
+      }
+    }
+    glDeleteTextures(count, textureIds);
+  }
+
+  /**
+   * Set the framebuffer bound in place of the window, so everything drawn to the window is drawn offscreen instead.
+   *
+   * @param framebufferId  The ID of the framebuffer, or 0 for the window itself.
+   */
+  void setWindowFramebuffer(const GLuint &framebufferId)
+  {
+    windowFramebufferId = framebufferId;
+    drawFramebufferId = UNKNOWN;
+    readFramebufferId = UNKNOWN;
+  }
+
+  /**
+   * Get the framebuffer bound in place of the window.
+   *
+   * @return The ID of the framebuffer, or 0 for the window itself.
+   */
+  const GLuint &getWindowFramebuffer() const
+  {
+    return windowFramebufferId;
+  }
+
+  /**
+   * Delete the given framebuffers, forgetting them wherever they're bound.
+   *
+   * @param count           The number of framebuffers.
+   * @param framebufferIds  The IDs of the framebuffers.
+   */
+  void deleteFramebuffers(const GLsizei &count, const GLuint *framebufferIds)
+  {
+    for (GLsizei i = 0; i < count; i++)
+    {
+      drawFramebufferId = drawFramebufferId == framebufferIds[i] ? UNKNOWN : drawFramebufferId;
+      readFramebufferId = readFramebufferId == framebufferIds[i] ? UNKNOWN : readFramebufferId;
+    }
+    glDeleteFramebuffers(count, framebufferIds);
+  }
+
+  /**
+   * Delete the given vertex arrays, forgetting them if they're bound, along with the element buffers bound with them.
+   *
+   * @param count           The number of vertex arrays.
+   * @param vertexArrayIds  The IDs of the vertex arrays.
+   */
+  void deleteVertexArrays(const GLsizei &count, const GLuint *vertexArrayIds)
+  {
+    for (GLsizei i = 0; i < count; i++)
+    {
+      if (vertexArrayId == vertexArrayIds[i])
+      {
+        vertexArrayId = UNKNOWN;
+        boundBuffers[getBufferTargetIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+      }
+    }
+    glDeleteVertexArrays(count, vertexArrayIds);
+  }
+
+  /**
+   * Get the number of calls made since the counts were last reset.
+   *
+   * @return The calls count.
+   */
+  const uint64_t &getIssuedCallsCount() const
+  {
+    return issuedCallsCount;
+  }
+
+  /**
+   * Get the number of calls left out since the counts were last reset, since they wouldn't have changed anything.
+   *
+   * @return The skipped calls count.
+   */
+  const uint64_t &getSkippedCallsCount() const
+  {
+    return skippedCallsCount;
+  }
+
+  /**
+   * Reset the counts of the calls made and left out, such as at the start of a frame.
+   */
+  void resetCounts()
+  {
+    issuedCallsCount = 0;
+    skippedCallsCount = 0;
+  }
+
+  /**
+   * Returns the singleton instance of the GL state cache.
+   *
+   * @return The GL state cache singleton instance.
+   */
+  static GlStateCache &getInstance()
+  {
+    // Singleton instance of the GL state cache, constructed the first time it's asked for.
+    static GlStateCache instance;
+    return instance;
+  }
+};
+
+// Initialize the value of the unknown state static variable.
+const GLuint GlStateCache::UNKNOWN = ~0u;
+// Initialize the cached buffer targets static variable.
+const std::array<GLenum, 12> GlStateCache::bufferTargets({GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_TEXTURE_BUFFER,
+                                                         GL_DRAW_INDIRECT_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_TRANSFORM_FEEDBACK_BUFFER, GL_PIXEL_PACK_BUFFER,
+                                                         GL_PIXEL_UNPACK_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_QUERY_BUFFER});
+// Initialize the cached texture targets static variable.
+const std::array<GLenum, 7> GlStateCache::textureTargets({GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_CUBE_MAP_ARRAY,
+                                                         GL_TEXTURE_BUFFER, GL_TEXTURE_3D, GL_TEXTURE_2D_MULTISAMPLE});
+
+#endif
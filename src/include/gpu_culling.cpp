@@ -0,0 +1,225 @@
+#ifndef INCLUDE_GPU_CULLING_CPP
+#define INCLUDE_GPU_CULLING_CPP
+
+#include <array>
+#include <memory>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+#include "window.cpp"
+#include "shader.cpp"
+#include "frustum.cpp"
+#include "gl_debug.cpp"
+
+/**
+ * Structure for the culling job of a draw command, read by the culling compute shader next to the command, whose own
+ *   instance count starts at 0 and counts the instances found in view.
+ */
+struct InstanceCullingJob
+{
+  // The number of instances of the draw before culling.
+  GLuint instanceCount;
+  // The sphere around the mesh of the draw, in the space of its vertices, with the centre in xyz and the radius in w.
+  glm::vec4 boundingSphere;
+  // The cone around the normals of the triangles of the draw, with its axis in the space of the vertices in xyz, and the
+  //   sine of the spread of the normals in w, which is 1 for the draws that can't be culled for facing away.
+  glm::vec4 normalCone;
+};
+
+static_assert(sizeof(InstanceCullingJob) == 9 * sizeof(GLuint), "Instance culling jobs must be tightly packed");
+
+/**
+ * Class for culling the instances of multi-draw indirect commands against the frustum of the camera on the GPU, with a
+ *   compute shader where the GPU supports them. Each command gets a work group, which tests the instances of the command
+ *   and copies those in view to the front of the instances of the command in a buffer of culled instance data, laid out
+ *   like the uploaded instance data, counting them into the instance count of the command. The draws then read their
+ *   instances from the culled instance data, so the CPU never goes over the instances in view of the camera. The commands
+ *   drawing a single meshlet of an instance are culled the same way, and left out as well when the camera only sees the
+ *   backs of their triangles.
+ */
+class GpuInstanceCuller
+{
+private:
+  // The binding points of the uploaded and the culled instance data, and of the commands, as shader storage buffers.
+  static const GLuint SOURCE_INSTANCE_BINDING;
+  static const GLuint CULLED_INSTANCE_BINDING;
+  static const GLuint COMMAND_BINDING;
+
+  // Whether the GPU can run the culling compute shader.
+  const bool supported;
+  // The compute shader program culling the instances, which is only created where it's supported.
+  const std::shared_ptr<const ShaderDetails> cullShader;
+  // The keys of the uniforms of the culling compute shader.
+  const uint32_t frustumPlanesKey;
+  const uint32_t instanceWordBasesKey;
+  const uint32_t commandWordBasesKey;
+  const uint32_t cameraPositionKey;
+  // The ID of the shader program the storage blocks were last bound for, which changes when the shader is reloaded.
+  GLuint boundProgramId;
+
+  // The buffer the instances in view are copied to, and the size of its storage.
+  GLuint culledInstanceBufferId;
+  size_t culledInstanceBufferSize;
+
+  // The buffer holding the uploaded instance data of the frame, the first words of the matrices, the shadow masks, the
+  //   texture handles and the spins in it, and the frustum of the camera the instances are culled against.
+  GLuint sourceInstanceBufferId;
+  glm::uvec4 instanceWordBases;
+  std::array<glm::vec4, 6> frustumPlanes;
+  // The position of the camera, which the meshlets facing away from are culled.
+  glm::vec3 cameraPosition;
+  // The number of commands culled since the view started.
+  uint32_t culledCommandsCount;
+
+  /**
+   * Point the storage blocks of the culling compute shader at their binding points, unless they already were.
+   */
+  void bindStorageBlocks()
+  {
+    const auto programId = cullShader->getShaderId();
+    if (programId == boundProgramId)
+    {
+      return;
+    }
+    glShaderStorageBlockBinding(programId, glGetProgramResourceIndex(programId, GL_SHADER_STORAGE_BLOCK, "SourceInstanceBlock"), SOURCE_INSTANCE_BINDING);
+    glShaderStorageBlockBinding(programId, glGetProgramResourceIndex(programId, GL_SHADER_STORAGE_BLOCK, "CulledInstanceBlock"), CULLED_INSTANCE_BINDING);
+    glShaderStorageBlockBinding(programId, glGetProgramResourceIndex(programId, GL_SHADER_STORAGE_BLOCK, "CommandBlock"), COMMAND_BINDING);
+    boundProgramId = programId;
+  }
+
+public:
+  GpuInstanceCuller()
+      : supported(WindowManager::getInstance().isComputeShaderSupported() && WindowManager::getInstance().isMultiDrawIndirectSupported()),
+        cullShader(supported ? ShaderManager::getInstance().createComputeProgram("CullInstancesShader", "assets/shaders/compute/cull_instances.glsl") : nullptr),
+        frustumPlanesKey(ShaderManager::getInstance().getUniformKey("frustumPlanes")),
+        instanceWordBasesKey(ShaderManager::getInstance().getUniformKey("instanceWordBases")),
+        commandWordBasesKey(ShaderManager::getInstance().getUniformKey("commandWordBases")),
+        cameraPositionKey(ShaderManager::getInstance().getUniformKey("cameraPosition")),
+        boundProgramId(0),
+        culledInstanceBufferId(0),
+        culledInstanceBufferSize(0),
+        sourceInstanceBufferId(0),
+        instanceWordBases(0),
+        frustumPlanes(),
+        cameraPosition(0.0f),
+        culledCommandsCount(0)
+  {
+    if (supported)
+    {
+      glGenBuffers(1, &culledInstanceBufferId);
+      GpuDebugLabels::labelObject(GL_BUFFER, culledInstanceBufferId, "Culled Instances");
+    }
+  }
+
+  // Preventing copying the culler, since it owns its buffer.
+  GpuInstanceCuller(const GpuInstanceCuller &) = delete;
+
+  ~GpuInstanceCuller()
+  {
+    if (supported)
+    {
+      GlStateCache::getInstance().deleteBuffers(1, &culledInstanceBufferId);
+      ShaderManager::getInstance().destroyShaderProgram(cullShader);
+    }
+  }
+
+  /**
+   * Check if the GPU can cull the instances, which needs compute shaders and multi-draw indirect.
+   *
+   * @return Whether GPU culling is supported.
+   */
+  bool isSupported() const
+  {
+    return supported;
+  }
+
+  /**
+   * Start culling the draws of a view against the frustum of its camera, growing the culled instance data to the size of
+   *   the uploaded instance data so every instance can be copied to where it was uploaded.
+   *
+   * @param frustum            The frustum of the camera of the view.
+   * @param cameraPosition     The position of the camera of the view.
+   * @param sourceBufferId     The ID of the buffer holding the uploaded instance data.
+   * @param sourceBufferSize   The size of the storage of the buffer.
+   * @param matrixBase         The index of the first matrix of the frame in the buffer.
+   * @param shadowMaskBase     The index of the first shadow mask of the frame in the buffer.
+   * @param textureHandleBase  The index of the first texture handle of the frame in the buffer.
+   * @param spinBase           The index of the first spin of the frame in the buffer.
+   */
+  void beginView(const Frustum &frustum, const glm::vec3 &cameraPosition, const GLuint &sourceBufferId, const size_t &sourceBufferSize, const uint32_t &matrixBase,
+                 const uint32_t &shadowMaskBase, const uint32_t &textureHandleBase, const uint32_t &spinBase)
+  {
+    if (culledInstanceBufferSize < sourceBufferSize)
+    {
+      // The draws of the earlier frames still reading the old storage keep it until they're done.
+      GlStateCache::getInstance().bindBuffer(GL_SHADER_STORAGE_BUFFER, culledInstanceBufferId);
+      glBufferData(GL_SHADER_STORAGE_BUFFER, sourceBufferSize, nullptr, GL_DYNAMIC_COPY);
+      GlStateCache::getInstance().bindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+      culledInstanceBufferSize = sourceBufferSize;
+    }
+    sourceInstanceBufferId = sourceBufferId;
+    // The matrices are 16 words each, the masks 1, and the 64-bit handles and the spins 2.
+    instanceWordBases = glm::uvec4(matrixBase * 16, shadowMaskBase, textureHandleBase * 2, spinBase * 2);
+    frustumPlanes = frustum.getPlanes();
+    this->cameraPosition = cameraPosition;
+    culledCommandsCount = 0;
+  }
+
+  /**
+   * Cull the instances of the given commands, counting the instances in view into the commands and copying them to the
+   *   culled instance data, and make the results visible to the draws reading them. The shader program of the draws has
+   *   to be bound again afterwards.
+   *
+   * @param commandBufferId  The ID of the buffer holding the commands and their jobs.
+   * @param commandsOffset   The offset in bytes of the commands, whose instance counts have to be 0.
+   * @param jobsOffset       The offset in bytes of the culling jobs of the commands.
+   * @param commandsCount    The number of commands.
+   */
+  void cullCommands(const GLuint &commandBufferId, const size_t &commandsOffset, const size_t &jobsOffset, const uint32_t &commandsCount)
+  {
+    GpuDebugGroup cullGroup("Cull Instances");
+    GlStateCache::getInstance().useProgram(cullShader->getShaderId());
+    bindStorageBlocks();
+    glUniform4fv(cullShader->getUniformLocation(frustumPlanesKey), frustumPlanes.size(), &frustumPlanes[0][0]);
+    glUniform4uiv(cullShader->getUniformLocation(instanceWordBasesKey), 1, &instanceWordBases[0]);
+    glUniform2ui(cullShader->getUniformLocation(commandWordBasesKey), commandsOffset / sizeof(GLuint), jobsOffset / sizeof(GLuint));
+    glUniform3fv(cullShader->getUniformLocation(cameraPositionKey), 1, &cameraPosition[0]);
+    GlStateCache::getInstance().bindBufferBase(GL_SHADER_STORAGE_BUFFER, SOURCE_INSTANCE_BINDING, sourceInstanceBufferId);
+    GlStateCache::getInstance().bindBufferBase(GL_SHADER_STORAGE_BUFFER, CULLED_INSTANCE_BINDING, culledInstanceBufferId);
+    GlStateCache::getInstance().bindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, commandBufferId);
+    glDispatchCompute(commandsCount, 1, 1);
+    // The draws read the counts from the commands and the instance data as vertex attributes.
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    culledCommandsCount += commandsCount;
+  }
+
+  /**
+   * Get the ID of the buffer the instances in view are copied to, which the instance attributes of the culled draws
+   *   point at instead of the uploaded instance data.
+   *
+   * @return The ID of the buffer.
+   */
+  const GLuint &getCulledInstanceBufferId() const
+  {
+    return culledInstanceBufferId;
+  }
+
+  /**
+   * Get the number of commands culled since the view started.
+   *
+   * @return The number of commands.
+   */
+  uint32_t getCulledCommandsCount() const
+  {
+    return culledCommandsCount;
+  }
+};
+
+// Initialize the binding points of the storage blocks of the culling compute shader.
+const GLuint GpuInstanceCuller::SOURCE_INSTANCE_BINDING = 0;
+const GLuint GpuInstanceCuller::CULLED_INSTANCE_BINDING = 1;
+const GLuint GpuInstanceCuller::COMMAND_BINDING = 2;
+
+#endif
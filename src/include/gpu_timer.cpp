@@ -0,0 +1,104 @@
+#ifndef INCLUDE_GPU_TIMER_CPP
+#define INCLUDE_GPU_TIMER_CPP
+
+#include <array>
+#include <cmath>
+
+#include <GL/glew.h>
+
+/**
+ * Class for measuring the time the GPU takes to run the commands between a begin and an end, which the CPU time around
+ * them doesn't show since the commands only get queued. Each measurement uses one of a ring of queries, and results are
+ * only read once the GPU has made them available, a couple of frames later, so the CPU never waits on the GPU for them.
+ * Only one timer can be measuring at a time.
+ */
+class GpuTimer
+{
+private:
+  // The number of queries in the ring, which is how many frames a result can take to become available before it's dropped.
+  static const uint32_t QUERIES_COUNT = 3;
+
+  // The IDs of the time elapsed queries of the ring.
+  std::array<GLuint, QUERIES_COUNT> queryIds;
+  // The number of measurements started so far.
+  uint64_t queriesCount;
+  // The number of measurements whose results were read or dropped so far, the rest still waiting on the GPU.
+  uint64_t resultsCount;
+  // The time of the latest measurement read, in milliseconds.
+  double_t elapsedTime;
+
+  /**
+   * Read the results of the waiting measurements, from the oldest, until one isn't available yet.
+   */
+  void readResults()
+  {
+    while (resultsCount < queriesCount)
+    {
+      const auto queryId = queryIds[resultsCount % QUERIES_COUNT];
+      GLint queryResultAvailable = GL_FALSE;
+      glGetQueryObjectiv(queryId, GL_QUERY_RESULT_AVAILABLE, &queryResultAvailable);
+      if (queryResultAvailable != GL_TRUE)
+      {
+        break;
+      }
+      GLuint64 queryResult = 0;
+      glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &queryResult);
+      elapsedTime = queryResult / 1000000.0;
+      resultsCount++;
+    }
+  }
+
+public:
+  GpuTimer()
+      : queryIds({}),
+        queriesCount(0),
+        resultsCount(0),
+        elapsedTime(0.0)
+  {
+    glGenQueries(queryIds.size(), queryIds.data());
+  }
+
+  // Preventing copying the timer, since it owns its queries.
+  GpuTimer(const GpuTimer &) = delete;
+
+  ~GpuTimer()
+  {
+    glDeleteQueries(queryIds.size(), queryIds.data());
+  }
+
+  /**
+   * Start measuring the commands issued from now on.
+   */
+  void begin()
+  {
+    readResults();
+    // If every query of the ring is still waiting, the oldest result is dropped so its query can be used again.
+    if (queriesCount - resultsCount == QUERIES_COUNT)
+    {
+      resultsCount++;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, queryIds[queriesCount % QUERIES_COUNT]);
+  }
+
+  /**
+   * Stop measuring the commands issued since begin was called.
+   */
+  void end()
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+    queriesCount++;
+  }
+
+  /**
+   * Get the time the GPU took for the latest measurement whose result is available, which is usually from a couple
+   * of frames before.
+   *
+   * @return The time the GPU took, in milliseconds.
+   */
+  const double_t &getElapsedTime() const
+  {
+    return elapsedTime;
+  }
+};
+
+#endif
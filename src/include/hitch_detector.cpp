@@ -0,0 +1,140 @@
+#ifndef INCLUDE_HITCH_DETECTOR_CPP
+#define INCLUDE_HITCH_DETECTOR_CPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+
+#include "constants.cpp"
+#include "render_stats.cpp"
+#include "benchmark.cpp"
+#include "profiler.cpp"
+#include "log.cpp"
+
+/**
+ * Class for finding the frames that take much longer than the ones before them, and writing the profiling zones of the
+ *   latest frames around each of them to a trace file along with the measurements of the frame, so a hitch that's hard to
+ *   reproduce can be looked at after it happened, and the trace attached to a bug report.
+ */
+class HitchDetector
+{
+private:
+  // The times of the latest frames, as a ring of at most PROFILE_TRACE_FRAMES frames, along with the number of frames
+  //   added since the detector was reset.
+  std::vector<double_t> frameTimes;
+  uint64_t framesCount;
+  // The copy of the frame times the median is picked from, kept so picking it doesn't allocate.
+  std::vector<double_t> sortedFrameTimes;
+  // The frame the last hitch was found at, and the number of hitch traces written so far.
+  uint64_t lastHitchFrame;
+  uint32_t tracesCount;
+
+  /**
+   * Get the median time of the latest frames.
+   *
+   * @return The median frame time, in milliseconds.
+   */
+  double_t getMedianFrameTime()
+  {
+    sortedFrameTimes.assign(frameTimes.begin(), frameTimes.end());
+    const auto median = sortedFrameTimes.begin() + sortedFrameTimes.size() / 2;
+    std::nth_element(sortedFrameTimes.begin(), median, sortedFrameTimes.end());
+    return *median;
+  }
+
+public:
+  HitchDetector()
+      : frameTimes({}),
+        framesCount(0),
+        sortedFrameTimes({}),
+        lastHitchFrame(0),
+        tracesCount(0)
+  {
+    frameTimes.reserve(PROFILE_TRACE_FRAMES);
+    sortedFrameTimes.reserve(PROFILE_TRACE_FRAMES);
+  }
+
+  /**
+   * Forget the latest frames, for when the frames stop being comparable with the ones before them, like when a scene
+   * starts running.
+   */
+  void reset()
+  {
+    frameTimes.clear();
+    framesCount = 0;
+    lastHitchFrame = 0;
+  }
+
+  /**
+   * Add the time of a frame, checking whether the frame was a hitch. Only a full ring of the latest frames is compared
+   * against, and a hitch isn't looked for again until the frames of the trace of the last one are all newer than it, so
+   * the traces don't overlap.
+   *
+   * @param frameTime  The time the frame took, in milliseconds.
+   *
+   * @return The median time of the frames before the frame if it was a hitch, or 0 if it wasn't.
+   */
+  double_t addFrame(const double_t &frameTime)
+  {
+    auto medianFrameTime = 0.0;
+    if (HITCH_THRESHOLD > 0.0 && frameTimes.size() == PROFILE_TRACE_FRAMES && framesCount >= lastHitchFrame + PROFILE_TRACE_FRAMES)
+    {
+      const auto latestMedianFrameTime = getMedianFrameTime();
+      if (frameTime >= HITCH_MIN_FRAME_TIME && frameTime > latestMedianFrameTime * HITCH_THRESHOLD)
+      {
+        medianFrameTime = latestMedianFrameTime;
+        lastHitchFrame = framesCount;
+      }
+    }
+
+    if (frameTimes.size() < PROFILE_TRACE_FRAMES)
+    {
+      frameTimes.push_back(frameTime);
+    }
+    else
+    {
+      frameTimes[framesCount % PROFILE_TRACE_FRAMES] = frameTime;
+    }
+    framesCount++;
+    return medianFrameTime;
+  }
+
+  /**
+   * Write the profiling zones of the latest frames to the next hitch trace file, along with the measurements of the
+   * hitch frame, reusing the oldest of the files once there are enough of them. This should be called while no other
+   * thread is recording zones.
+   *
+   * @param frame            The measurements of the hitch frame.
+   * @param medianFrameTime  The median time of the frames before the hitch frame, in milliseconds.
+   *
+   * @return The path of the trace file.
+   */
+  std::string writeTrace(const BenchmarkFrame &frame, const double_t &medianFrameTime)
+  {
+    std::vector<std::pair<std::string, std::string>> metadata({{"frameTime", std::to_string(frame.frameTime)},
+                                                               {"medianFrameTime", std::to_string(medianFrameTime)},
+                                                               {"cpuRenderTime", std::to_string(frame.cpuRenderTime)},
+                                                               {"gpuRenderTime", std::to_string(frame.gpuRenderTime)},
+                                                               {"models", std::to_string(frame.modelsCount)},
+                                                               {"collisionChecks", std::to_string(frame.collisionChecksCount)},
+                                                               {"allocations", std::to_string(frame.allocationsCount)}});
+    for (uint32_t i = 0; i < RENDER_PASSES_COUNT; i++)
+    {
+      const auto &passStats = frame.renderStats[i];
+      metadata.push_back({renderPassNames[i], std::to_string(passStats.drawCalls) + " draws, " + std::to_string(passStats.instances) + " instances, " + std::to_string(passStats.triangles) + " triangles, " +
+                                                  std::to_string(passStats.uniformCalls) + " uniforms, " + std::to_string(passStats.uploadedBytes) + " bytes uploaded, " + std::to_string(passStats.stateChanges) + " state changes"});
+    }
+
+    // Failing to make the directory is reported by the export, which can't open the file then.
+    std::error_code errorCode;
+    std::filesystem::create_directories(HITCH_TRACE_DIRECTORY, errorCode);
+    const auto traceFilePath = HITCH_TRACE_DIRECTORY + "/hitch-" + std::to_string(tracesCount++ % HITCH_TRACES_KEPT) + ".json";
+    ProfileManager::getInstance().exportChromeTrace(traceFilePath, PROFILE_TRACE_FRAMES, metadata);
+    return traceFilePath;
+  }
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef INCLUDE_HOT_RELOAD_CPP
+#define INCLUDE_HOT_RELOAD_CPP
+
+#include <string>
+#include <vector>
+
+#include "constants.cpp"
+#include "shader.cpp"
+#include "texture.cpp"
+#include "object.cpp"
+#include "log.cpp"
+
+/**
+ * A manager class for reloading the shaders, textures and objects whose files changed on disk while the game runs, so
+ *   they can be worked on without restarting it. The managers of the assets swap the reloaded assets into the details
+ *   the models already share, so the models draw with them from the next frame on.
+ */
+class HotReloadManager
+{
+private:
+  ShaderManager &shaderManager;
+  TextureManager &textureManager;
+  ObjectManager &objectManager;
+
+  // The time the asset files were last checked at.
+  double_t lastCheckTime;
+
+  HotReloadManager()
+      : shaderManager(ShaderManager::getInstance()),
+        textureManager(TextureManager::getInstance()),
+        objectManager(ObjectManager::getInstance()),
+        lastCheckTime(0.0) {}
+
+  /**
+   * Report the reloaded assets of a type.
+   *
+   * @param assetType   The type of the assets.
+   * @param assetNames  The names of the reloaded assets.
+   */
+  static void reportReloadedAssets(const std::string &assetType, const std::vector<std::string> &assetNames)
+  {
+    for (const auto &assetName : assetNames)
+    {
+      Logger::getInstance().info("Reloaded ", assetType, " ", assetName);
+    }
+  }
+
+public:
+  // Preventing copying the hot reload manager, making sure only one instance can exist.
+  HotReloadManager(const HotReloadManager &) = delete;
+
+  /**
+   * Check whether the asset files are due to be checked again, which they are every watch interval while hot reloading
+   *   is enabled.
+   *
+   * @param currentTime  The time of the frame.
+   *
+   * @return Whether the asset files should be checked.
+   */
+  bool isCheckDue(const double_t &currentTime)
+  {
+    if (!ASSET_HOT_RELOAD_ENABLED || currentTime - lastCheckTime < ASSET_WATCH_INTERVAL)
+    {
+      return false;
+    }
+    lastCheckTime = currentTime;
+    return true;
+  }
+
+  /**
+   * Reload the assets whose files changed since they were last checked. This makes GL calls, and replaces details the
+   *   models read while updating, so it has to run with the GL context while the models aren't updating.
+   */
+  void reloadChangedAssets()
+  {
+    reportReloadedAssets("shader", shaderManager.reloadChangedShaders());
+    reportReloadedAssets("texture", textureManager.reloadChangedTextures());
+    reportReloadedAssets("object", objectManager.reloadChangedObjects());
+  }
+
+  /**
+   * Returns the singleton instance of the hot reload manager.
+   *
+   * @return The hot reload manager singleton instance.
+   */
+  static HotReloadManager &getInstance()
+  {
+    // Singleton instance of the hot reload manager, constructed the first time it's asked for.
+    static HotReloadManager instance;
+    return instance;
+  }
+};
+
+#endif
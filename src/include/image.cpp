@@ -0,0 +1,660 @@
+#ifndef INCLUDE_IMAGE_CPP
+#define INCLUDE_IMAGE_CPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_archive.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for containing an uncompressed image, with 3 bytes per pixel in BGR order and rows stored bottom to top.
+ */
+struct ImageData
+{
+	// The width of the image.
+	uint32_t width;
+	// The height of the image.
+	uint32_t height;
+	// The BGR pixel data of the image.
+	std::vector<unsigned char> pixels;
+};
+
+/**
+ * Structure for an uncompressed BMP image read straight from its asset file, with the pixels in the same layout as
+ *   ImageData, which stay valid for as long as the asset file stays open.
+ */
+struct MappedImageData
+{
+	// The width of the image.
+	uint32_t width;
+	// The height of the image.
+	uint32_t height;
+	// The BGR pixel data of the image, pointing into the asset file.
+	const unsigned char *pixels;
+	// The opened BMP file.
+	AssetFile file;
+};
+
+/**
+ * The block compression formats supported for compressed images.
+ */
+enum CompressedImageFormat
+{
+	BC1,
+	BC3,
+	BC7
+};
+
+/**
+ * Structure for containing a block compressed image with its full mip chain, with rows stored bottom to top.
+ */
+struct CompressedImageData
+{
+	// The block compression format of the image.
+	CompressedImageFormat format;
+	// The width of the base level of the image.
+	uint32_t width;
+	// The height of the base level of the image.
+	uint32_t height;
+	// The compressed data of each mip level of the image, starting from the base level.
+	std::vector<std::vector<unsigned char>> levels;
+};
+
+/**
+ * Structure of the pixel format of a DDS file.
+ */
+struct DdsPixelFormat
+{
+	uint32_t size;
+	uint32_t flags;
+	char fourCc[4];
+	uint32_t rgbBitCount;
+	uint32_t rBitMask;
+	uint32_t gBitMask;
+	uint32_t bBitMask;
+	uint32_t aBitMask;
+};
+
+/**
+ * Structure of the header of a DDS file, following the "DDS " magic.
+ */
+struct DdsHeader
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];
+	DdsPixelFormat pixelFormat;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+
+/**
+ * Structure of the extended header of a DDS file, present when the pixel format is "DX10".
+ */
+struct DdsHeaderDx10
+{
+	uint32_t dxgiFormat;
+	uint32_t resourceDimension;
+	uint32_t miscFlag;
+	uint32_t arraySize;
+	uint32_t miscFlags2;
+};
+
+// Make sure the binary layout of the structures match the DDS file format.
+static_assert(sizeof(DdsPixelFormat) == 32, "DdsPixelFormat must be tightly packed");
+static_assert(sizeof(DdsHeader) == 124, "DdsHeader must be tightly packed");
+static_assert(sizeof(DdsHeaderDx10) == 20, "DdsHeaderDx10 must be tightly packed");
+
+/**
+ * Class for loading, converting and storing images. It does not depend on OpenGL, so it can also be used by tools.
+ */
+class ImageLoader
+{
+private:
+	// The DDS flags and capabilities used when writing DDS files.
+	static const uint32_t ddsFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+	static const uint32_t ddsPixelFormatFourCcFlag = 0x4;
+	static const uint32_t ddsCaps = 0x8 | 0x1000 | 0x400000;
+	// The DXGI formats of the block compression formats, used by DDS files with the extended header.
+	static const uint32_t dxgiFormatBc1 = 71;
+	static const uint32_t dxgiFormatBc1Srgb = 72;
+	static const uint32_t dxgiFormatBc3 = 77;
+	static const uint32_t dxgiFormatBc3Srgb = 78;
+	static const uint32_t dxgiFormatBc7 = 98;
+	static const uint32_t dxgiFormatBc7Srgb = 99;
+
+	/**
+	 * Pack the color into the 5:6:5 bit format used by BC1 blocks.
+	 *
+	 * @param color  The RGB color to pack.
+	 *
+	 * @return The packed color.
+	 */
+	static uint16_t packColor565(const int32_t *const color)
+	{
+		return ((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255);
+	}
+
+	/**
+	 * Unpack the color from the 5:6:5 bit format used by BC1 blocks.
+	 *
+	 * @param packedColor  The packed color.
+	 * @param outColor     The RGB color to store the unpacked color to.
+	 */
+	static void unpackColor565(const uint16_t &packedColor, int32_t *const outColor)
+	{
+		outColor[0] = ((packedColor >> 11) & 31) * 255 / 31;
+		outColor[1] = ((packedColor >> 5) & 63) * 255 / 63;
+		outColor[2] = (packedColor & 31) * 255 / 31;
+	}
+
+	/**
+	 * Compress a block of 4x4 pixels into a BC1 block.
+	 *
+	 * @param blockPixels  The RGB colors of the 16 pixels of the block, row by row.
+	 * @param outBlock     The 8 bytes to store the compressed block to.
+	 */
+	static void compressBc1Block(const int32_t (*const blockPixels)[3], unsigned char *const outBlock)
+	{
+		// Use the corners of the bounding box of the block colors as the end points of the color line.
+		int32_t minColor[3] = {255, 255, 255}, maxColor[3] = {0, 0, 0};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				minColor[c] = std::min(minColor[c], blockPixels[i][c]);
+				maxColor[c] = std::max(maxColor[c], blockPixels[i][c]);
+			}
+		}
+
+		// Pack the end points. The first has to be larger for the block to use the four color mode.
+		uint16_t color0 = packColor565(maxColor), color1 = packColor565(minColor);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		// Build the palette of the four colors the block can pick from.
+		int32_t palette[4][3];
+		unpackColor565(color0, palette[0]);
+		unpackColor565(color1, palette[1]);
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		// Pick the closest palette color for each pixel. Identical end points can't use the four color mode, so they always use the first.
+		uint32_t indices = 0;
+		for (uint32_t i = 0; color0 != color1 && i < 16; i++)
+		{
+			uint32_t bestIndex = 0;
+			int32_t bestDistance = INT32_MAX;
+			for (uint32_t p = 0; p < 4; p++)
+			{
+				const int32_t dr = blockPixels[i][0] - palette[p][0], dg = blockPixels[i][1] - palette[p][1], db = blockPixels[i][2] - palette[p][2];
+				const int32_t distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (2 * i);
+		}
+
+		// Store the end points and indices in little-endian order.
+		outBlock[0] = color0 & 0xFF;
+		outBlock[1] = color0 >> 8;
+		outBlock[2] = color1 & 0xFF;
+		outBlock[3] = color1 >> 8;
+		outBlock[4] = indices & 0xFF;
+		outBlock[5] = (indices >> 8) & 0xFF;
+		outBlock[6] = (indices >> 16) & 0xFF;
+		outBlock[7] = indices >> 24;
+	}
+
+public:
+	/**
+	 * Get the size of a block of 4x4 pixels in the given compression format.
+	 *
+	 * @param format  The block compression format.
+	 *
+	 * @return The size of a block in bytes.
+	 */
+	static uint32_t getBlockSize(const CompressedImageFormat &format)
+	{
+		return format == BC1 ? 8 : 16;
+	}
+
+	/**
+	 * Get the size of a mip level of the given dimensions in the given compression format.
+	 *
+	 * @param format  The block compression format.
+	 * @param width   The width of the mip level.
+	 * @param height  The height of the mip level.
+	 *
+	 * @return The size of the mip level in bytes.
+	 */
+	static uint32_t getLevelSize(const CompressedImageFormat &format, const uint32_t &width, const uint32_t &height)
+	{
+		return std::max(1u, (width + 3) / 4) * std::max(1u, (height + 3) / 4) * getBlockSize(format);
+	}
+
+	/**
+	 * Get the path of the compressed DDS file for the given image file.
+	 *
+	 * @param imageFilePath  The file path to the image.
+	 *
+	 * @return The file path to the DDS file.
+	 */
+	static std::string getCompressedFilePath(const std::string &imageFilePath)
+	{
+		return imageFilePath + ".dds";
+	}
+
+	/**
+	 * Read the layout of the pixel data of a BMP image from its 54 byte header.
+	 *
+	 * @param header     The header of the BMP file.
+	 * @param width      The width of the image, which is set.
+	 * @param height     The height of the image, which is set.
+	 * @param dataPos    The offset of the pixel data in the file, which is set.
+	 * @param imageSize  The size of the pixel data, which is set.
+	 *
+	 * @return 0 if the image is supported, otherwise the number of the texture failure.
+	 */
+	static uint32_t readBmpHeader(const unsigned char *const header, uint32_t &width, uint32_t &height, uint32_t &dataPos, uint32_t &imageSize)
+	{
+		// Check if the first two characters of the header start with "BM".
+		if (header[0] != 'B' || header[1] != 'M')
+		{
+			// Invalid file.
+			return 3;
+		}
+		// Check if number of bits per pixel is 24 (1 byte per color channel).
+		if (*(int32_t *)&(header[0x1C]) != 24)
+		{
+			// Cannot support color format.
+			return 4;
+		}
+		// Check if compression is enabled.
+		if (*(int32_t *)&(header[0x1E]) != 0)
+		{
+			// Cannot support compressed BMPs.
+			return 5;
+		}
+
+		// Grab the BMP metadata information
+		dataPos = *(int32_t *)&(header[0x0A]);
+		imageSize = *(int32_t *)&(header[0x22]);
+		width = *(int32_t *)&(header[0x12]);
+		height = *(int32_t *)&(header[0x16]);
+
+		// Some BMP files can be misformatted, so guess missing information.
+		if (imageSize == 0)
+		{
+			// Image size would be width times height. But since each pixel contains 3 bytes of information
+			//   (one per color channel), multiply that result by 3.
+			imageSize = width * height * 3;
+		}
+		if (dataPos == 0)
+		{
+			// Data should start right after the BMP header, which is located at the start of the file and is 54 bytes in size.
+			// So read from that point after.
+			dataPos = 54;
+		}
+		return 0;
+	}
+
+	/**
+	 * Read the BMP image file.
+	 *
+	 * @param imageName      The name of the image being loaded.
+	 * @param imageFilePath  The file path to the image data.
+	 * @param exitOnFailure  Whether to crash if the image can't be read, instead of reporting it.
+	 *
+	 * @return The image data, which has no pixels if the image couldn't be read.
+	 */
+	static ImageData readBmpFile(const std::string &imageName, const std::string &imageFilePath, const bool &exitOnFailure = true)
+	{
+		// Define vectors for storing the BMP metadata information.
+		uint32_t dataPos;
+		uint32_t imageSize;
+
+		// Open the BMP file.
+		AssetFile file;
+		// Check if the file is accessible.
+		if (!AssetFileSystem::getInstance().open(imageFilePath, file))
+		{
+			// Could not read the BMP file. Time to crash.
+			Logger::getInstance().error(imageName, "\nFailed at texture 1");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return {0, 0, {}};
+		}
+
+		// Check if the file has the first 54 bytes (contains the BMP header).
+		if (file.getSize() < 54)
+		{
+			// Could not read the BMP file. Time to crash.
+			Logger::getInstance().error(imageName, "\nFailed at texture 2");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return {0, 0, {}};
+		}
+		// Check if the BMP image is supported.
+		ImageData imageData;
+		const auto headerFailure = readBmpHeader(file.getData(), imageData.width, imageData.height, dataPos, imageSize);
+		if (headerFailure != 0)
+		{
+			// Cannot support the BMP file. Time to crash.
+			Logger::getInstance().error(imageName, "\nFailed at texture ", headerFailure);
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return {0, 0, {}};
+		}
+
+		// Copy the texture data from the file, leaving the pixels past the end of a file cut short black.
+		imageData.pixels.resize(imageSize);
+		if (dataPos < file.getSize())
+		{
+			const auto pixelsData = file.getData() + dataPos;
+			std::copy(pixelsData, pixelsData + std::min<size_t>(imageSize, file.getSize() - dataPos), imageData.pixels.begin());
+		}
+
+		// Return the image data.
+		return imageData;
+	}
+
+	/**
+	 * Open the BMP image file, so its pixels can be uploaded straight from where the asset file holds them without being
+	 * copied into a buffer first. Files that can't be opened, or that are shorter than their pixel data, are left to
+	 * readBmpFile.
+	 *
+	 * @param imageName      The name of the image being loaded.
+	 * @param imageFilePath  The file path to the image data.
+	 * @param mappedImage    The opened image, which is set.
+	 * @param exitOnFailure  Whether to crash if the image isn't supported, instead of leaving it to readBmpFile.
+	 *
+	 * @return Whether the image was opened.
+	 */
+	static bool mapBmpFile(const std::string &imageName, const std::string &imageFilePath, MappedImageData &mappedImage, const bool &exitOnFailure = true)
+	{
+		if (!AssetFileSystem::getInstance().open(imageFilePath, mappedImage.file) || mappedImage.file.getSize() < 54)
+		{
+			return false;
+		}
+
+		// Check if the BMP image is supported.
+		uint32_t dataPos;
+		uint32_t imageSize;
+		const auto headerFailure = readBmpHeader(mappedImage.file.getData(), mappedImage.width, mappedImage.height, dataPos, imageSize);
+		if (headerFailure != 0)
+		{
+			// Cannot support the BMP file. Time to crash, or report it when reading it again.
+			if (!exitOnFailure)
+			{
+				return false;
+			}
+			Logger::getInstance().error(imageName, "\nFailed at texture ", headerFailure);
+			exit(1);
+		}
+		if (static_cast<uint64_t>(dataPos) + imageSize > mappedImage.file.getSize())
+		{
+			return false;
+		}
+
+		mappedImage.pixels = mappedImage.file.getData() + dataPos;
+		return true;
+	}
+
+	/**
+	 * Generate the full mip chain of the image by repeatedly averaging 2x2 pixels.
+	 *
+	 * @param imageData  The base level of the image.
+	 *
+	 * @return The mip levels of the image, starting from the base level.
+	 */
+	static std::vector<ImageData> generateMipmaps(const ImageData &imageData)
+	{
+		std::vector<ImageData> levels({imageData});
+		// Keep halving the image until it's a single pixel.
+		while (levels.back().width > 1 || levels.back().height > 1)
+		{
+			const auto &source = levels.back();
+			ImageData level;
+			level.width = std::max(1u, source.width / 2);
+			level.height = std::max(1u, source.height / 2);
+			level.pixels.resize(level.width * level.height * 3);
+			for (uint32_t y = 0; y < level.height; y++)
+			{
+				for (uint32_t x = 0; x < level.width; x++)
+				{
+					// Grab the 2x2 source pixels, clamping to the edges of single pixel wide/high images.
+					const uint32_t x0 = std::min(2 * x, source.width - 1), x1 = std::min(2 * x + 1, source.width - 1);
+					const uint32_t y0 = std::min(2 * y, source.height - 1), y1 = std::min(2 * y + 1, source.height - 1);
+					for (uint32_t c = 0; c < 3; c++)
+					{
+						const uint32_t sum = source.pixels[(y0 * source.width + x0) * 3 + c] + source.pixels[(y0 * source.width + x1) * 3 + c] +
+																 source.pixels[(y1 * source.width + x0) * 3 + c] + source.pixels[(y1 * source.width + x1) * 3 + c];
+						level.pixels[(y * level.width + x) * 3 + c] = (sum + 2) / 4;
+					}
+				}
+			}
+			levels.push_back(level);
+		}
+		return levels;
+	}
+
+	/**
+	 * Compress the image and its generated mip chain into the BC1 format.
+	 *
+	 * @param imageData  The image to compress.
+	 *
+	 * @return The compressed image.
+	 */
+	static CompressedImageData compressBc1(const ImageData &imageData)
+	{
+		CompressedImageData compressedImageData;
+		compressedImageData.format = BC1;
+		compressedImageData.width = imageData.width;
+		compressedImageData.height = imageData.height;
+
+		// Compress each mip level as 4x4 pixel blocks.
+		for (const auto &level : generateMipmaps(imageData))
+		{
+			std::vector<unsigned char> compressedLevel(getLevelSize(BC1, level.width, level.height));
+			auto outBlock = compressedLevel.data();
+			for (uint32_t blockY = 0; blockY < level.height; blockY += 4)
+			{
+				for (uint32_t blockX = 0; blockX < level.width; blockX += 4)
+				{
+					// Grab the RGB colors of the pixels of the block, repeating edge pixels for levels smaller than a block.
+					int32_t blockPixels[16][3];
+					for (uint32_t i = 0; i < 16; i++)
+					{
+						const uint32_t x = std::min(blockX + i % 4, level.width - 1), y = std::min(blockY + i / 4, level.height - 1);
+						const auto pixel = &level.pixels[(y * level.width + x) * 3];
+						blockPixels[i][0] = pixel[2];
+						blockPixels[i][1] = pixel[1];
+						blockPixels[i][2] = pixel[0];
+					}
+					compressBc1Block(blockPixels, outBlock);
+					outBlock += 8;
+				}
+			}
+			compressedImageData.levels.push_back(compressedLevel);
+		}
+
+		return compressedImageData;
+	}
+
+	/**
+	 * Read the block compressed DDS image file into the given compressed image data.
+	 *
+	 * @param imageFilePath  The file path to the DDS file.
+	 * @param outImageData   The compressed image data to store the image to.
+	 *
+	 * @return Whether the DDS file existed, was of a supported format, and was read.
+	 */
+	static bool readDdsFile(const std::string &imageFilePath, CompressedImageData &outImageData)
+	{
+		// Open the DDS file.
+		AssetFile file;
+		size_t filePosition = 0;
+		// Check if the file is accessible.
+		if (!AssetFileSystem::getInstance().open(imageFilePath, file))
+		{
+			return false;
+		}
+
+		// Read the magic and header, and check that they describe a 2D texture.
+		char magic[4];
+		DdsHeader header;
+		if (!file.read(filePosition, magic, 4) || memcmp(magic, "DDS ", 4) != 0 ||
+				!file.read(filePosition, &header, sizeof(DdsHeader)) || header.size != sizeof(DdsHeader) ||
+				!(header.pixelFormat.flags & ddsPixelFormatFourCcFlag))
+		{
+			return false;
+		}
+
+		// Find the block compression format from the pixel format, or the extended header if present.
+		if (memcmp(header.pixelFormat.fourCc, "DXT1", 4) == 0)
+		{
+			outImageData.format = BC1;
+		}
+		else if (memcmp(header.pixelFormat.fourCc, "DXT5", 4) == 0)
+		{
+			outImageData.format = BC3;
+		}
+		else if (memcmp(header.pixelFormat.fourCc, "DX10", 4) == 0)
+		{
+			DdsHeaderDx10 headerDx10;
+			if (!file.read(filePosition, &headerDx10, sizeof(DdsHeaderDx10)))
+			{
+				return false;
+			}
+			switch (headerDx10.dxgiFormat)
+			{
+			case dxgiFormatBc1:
+			case dxgiFormatBc1Srgb:
+				outImageData.format = BC1;
+				break;
+			case dxgiFormatBc3:
+			case dxgiFormatBc3Srgb:
+				outImageData.format = BC3;
+				break;
+			case dxgiFormatBc7:
+			case dxgiFormatBc7Srgb:
+				outImageData.format = BC7;
+				break;
+			default:
+				return false;
+			}
+		}
+		else
+		{
+			// Not a block compression format we support.
+			return false;
+		}
+
+		// Read each of the mip levels stored in the file.
+		outImageData.width = header.width;
+		outImageData.height = header.height;
+		outImageData.levels.clear();
+		uint32_t levelWidth = header.width, levelHeight = header.height;
+		for (uint32_t i = 0; i < std::max(1u, header.mipMapCount); i++)
+		{
+			std::vector<unsigned char> level(getLevelSize(outImageData.format, levelWidth, levelHeight));
+			if (!file.read(filePosition, level.data(), level.size()))
+			{
+				// The file was truncated.
+				return false;
+			}
+			outImageData.levels.push_back(level);
+			levelWidth = std::max(1u, levelWidth / 2);
+			levelHeight = std::max(1u, levelHeight / 2);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Write the BC1 compressed image into a DDS file.
+	 *
+	 * @param imageFilePath  The file path to the DDS file.
+	 * @param imageData      The BC1 compressed image to write.
+	 *
+	 * @return Whether the DDS file was written.
+	 */
+	static bool writeDdsFile(const std::string &imageFilePath, const CompressedImageData &imageData)
+	{
+		// Only BC1 can be described without the extended header, which is the only format the images are compressed to.
+		if (imageData.format != BC1 || imageData.levels.empty())
+		{
+			return false;
+		}
+
+		// Open the DDS file for writing.
+		const auto file = fopen(imageFilePath.c_str(), "wb");
+		// Check if the file is writable.
+		if (file == NULL)
+		{
+			return false;
+		}
+
+		// Fill in the header of the image.
+		DdsHeader header;
+		memset(&header, 0, sizeof(DdsHeader));
+		header.size = sizeof(DdsHeader);
+		header.flags = ddsFlags;
+		header.height = imageData.height;
+		header.width = imageData.width;
+		header.pitchOrLinearSize = imageData.levels[0].size();
+		header.mipMapCount = imageData.levels.size();
+		header.pixelFormat.size = sizeof(DdsPixelFormat);
+		header.pixelFormat.flags = ddsPixelFormatFourCcFlag;
+		memcpy(header.pixelFormat.fourCc, "DXT1", 4);
+		header.caps = ddsCaps;
+
+		// Write the magic, header and mip levels.
+		auto written = fwrite("DDS ", 1, 4, file) == 4 && fwrite(&header, sizeof(DdsHeader), 1, file) == 1;
+		for (const auto &level : imageData.levels)
+		{
+			written = written && fwrite(level.data(), 1, level.size(), file) == level.size();
+		}
+		fclose(file);
+
+		// Remove partially written files, so they don't get read later.
+		if (!written)
+		{
+			remove(imageFilePath.c_str());
+		}
+
+		return written;
+	}
+};
+
+#endif
@@ -0,0 +1,506 @@
+#ifndef INCLUDE_IMPOSTOR_BATCH_CPP
+#define INCLUDE_IMPOSTOR_BATCH_CPP
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include "gl_state.cpp"
+#include "common.cpp"
+#include "constants.cpp"
+#include "shader.cpp"
+#include "texture.cpp"
+#include "object.cpp"
+#include "streaming_buffer.cpp"
+#include "render_stats.cpp"
+#include "gl_debug.cpp"
+#include "log.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Structure for the range of the impostor instances of the frame drawn in a view.
+ */
+struct ImpostorInstanceRange
+{
+  // The index of the first impostor instance of the view, and the number of them.
+  uint32_t firstInstance;
+  uint32_t instanceCount;
+};
+
+/**
+ * Class for drawing the models that are only a few pixels on the screen as impostors, quads facing the camera showing
+ *   their objects pre-rendered from around their vertical axes, which they spin along. The first time an object is drawn
+ *   as an impostor, the geometry buffer variant of its shader renders its albedo and its normals from each of the views
+ *   into the layers of a pair of texture arrays. The impostors are then drawn with an impostor variant of the shader of
+ *   the model, which blends the two views closest to the direction the camera looks at the model from, and lights them
+ *   with the normals of the views, so they're lit and shadowed like the models they stand in for. All the impostors of a
+ *   view are drawn with a single instanced call, whatever their objects. While a model fades between its full mesh and
+ *   its impostor, both are drawn, with the impostor in front of the mesh covering more and more of its pixels.
+ */
+class ImpostorBatch
+{
+private:
+  /**
+   * Structure for the object pre-rendered into the views of a slot of the impostor texture arrays.
+   */
+  struct ImpostorSlot
+  {
+    // The details of the object and of its texture, which the slot is free to take over once they're gone.
+    std::weak_ptr<const ObjectDetails> objectDetails;
+    std::weak_ptr<const TextureDetails> textureDetails;
+    // The ID of the texture and the first index of the mesh that were pre-rendered, which change once the texture or the
+    //   object file is reloaded, so it's pre-rendered again.
+    GLuint sourceTextureId;
+    uint32_t sourceFirstIndex;
+    // The frame the slot was last drawn with, so the slot used the longest time ago is taken over once all are used.
+    uint64_t lastUsedFrame;
+  };
+
+  // The uniform keys of the texture arrays the impostors are drawn with, and of the diffuse texture of the objects they
+  //   are pre-rendered with.
+  const uint32_t impostorAlbedoTexturesKey;
+  const uint32_t impostorNormalTexturesKey;
+  const uint32_t diffuseTextureKey;
+  // The IDs of the texture arrays the albedo and the normals of the views of the objects are pre-rendered into, and of
+  //   the framebuffer and the depth buffer they are pre-rendered with.
+  const GLuint albedoTextureArrayId;
+  const GLuint normalTextureArrayId;
+  GLuint framebufferId;
+  GLuint depthRenderbufferId;
+  std::array<ImpostorSlot, IMPOSTOR_OBJECTS_COUNT> slots;
+  // The IDs of the vertex array of the quad the impostors are drawn with, and of the buffer of its vertices.
+  GLuint quadVertexArrayId;
+  GLuint quadVertexBufferId;
+  // The number of frames drawn so far.
+  uint64_t framesCount;
+
+  // The model matrices, light masks and views of the impostor instances of the frame, which are the layers of the two
+  //   views closest to the camera, how far the camera is between them, and the share of the pixels of the impostor drawn.
+  //   They keep their memory from frame to frame, so they aren't allocated from the frame arena.
+  std::vector<glm::mat4> instanceMatrices;
+  std::vector<GLuint> instanceLightMasks;
+  std::vector<glm::vec4> instanceViews;
+  // The buffer the instance data of the impostors is streamed through, and the index of the first matrix, mask and view
+  //   of the frame within it.
+  StreamingBuffer instanceStreamingBuffer;
+  uint32_t instanceMatrixBase;
+  uint32_t instanceLightMaskBase;
+  uint32_t instanceViewBase;
+  // The number of impostors drawn in the latest frame, and the number of objects pre-rendered since the batch was created.
+  uint32_t drawnImpostorsCount;
+  uint32_t capturedObjectsCount;
+
+  /**
+   * Create a texture array the views of the objects are pre-rendered into, with all its mip levels.
+   *
+   * @param internalFormat  The format of the texels.
+   * @param label           The label of the texture array in the GPU debuggers.
+   *
+   * @return The ID of the texture array.
+   */
+  static GLuint createTextureArray(const GLenum &internalFormat, const char *label)
+  {
+    GLuint textureArrayId;
+    glGenTextures(1, &textureArrayId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, textureArrayId);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, IMPOSTOR_TEXTURE_SIZE, IMPOSTOR_TEXTURE_SIZE, IMPOSTOR_OBJECTS_COUNT * IMPOSTOR_VIEWS_COUNT, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // Generating the mip levels creates their storage, so the array can be sampled before anything is rendered into it.
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    GpuDebugLabels::labelObject(GL_TEXTURE, textureArrayId, label);
+    return textureArrayId;
+  }
+
+  /**
+   * Get the bounding radius of an object, which the views of its impostor are framed around.
+   *
+   * @param objectDetails  The details of the object.
+   *
+   * @return The bounding radius.
+   */
+  static float_t getImpostorRadius(const ObjectDetails &objectDetails)
+  {
+    return std::max(objectDetails.getBoundingRadius(), 0.001f);
+  }
+
+  /**
+   * Pre-render the views of an object around its vertical axis into a slot of the texture arrays, looking at it from the
+   *   side with an orthographic projection framing its bounding sphere. The albedo and the normals are taken as the
+   *   geometry buffer variant of the shader of the object records them, with the normals in the space of each view.
+   *
+   * @param objectDetails          The details of the object.
+   * @param textureDetails         The details of the diffuse texture of the object.
+   * @param captureShader          The geometry buffer variant of the shader of the object.
+   * @param cameraUniformBufferId  The ID of the buffer of the camera uniform block, which the views are set in.
+   * @param slot                   The slot of the texture arrays.
+   */
+  void captureImpostor(const ObjectDetails &objectDetails, const TextureDetails &textureDetails, const ShaderDetails &captureShader, const GLuint &cameraUniformBufferId, const uint32_t &slot)
+  {
+    GpuDebugGroup captureGroup("Impostor Capture");
+    auto &glStateCache = GlStateCache::getInstance();
+
+    // The object is drawn as a single instance, with the vertex matrix of its compact vertex format and without a spin.
+    const auto &vertexMatrix = objectDetails.getVertexMatrix();
+    const auto noSpin = glm::vec2(0.0f);
+    instanceStreamingBuffer.reserve(sizeof(glm::mat4) + sizeof(glm::vec2), sizeof(glm::mat4));
+    const auto matrixBase = instanceStreamingBuffer.write(&vertexMatrix, sizeof(glm::mat4), sizeof(glm::mat4)) / sizeof(glm::mat4);
+    const auto spinBase = instanceStreamingBuffer.write(&noSpin, sizeof(glm::vec2), sizeof(glm::vec2)) / sizeof(glm::vec2);
+
+    glStateCache.bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glStateCache.setViewport(0, 0, IMPOSTOR_TEXTURE_SIZE, IMPOSTOR_TEXTURE_SIZE);
+    glStateCache.useProgram(captureShader.getShaderId());
+    glUniform1i(captureShader.getUniformLocation(diffuseTextureKey), 0);
+    glStateCache.activeTexture(GL_TEXTURE0);
+    glStateCache.bindTexture(GL_TEXTURE_2D, textureDetails.getTextureId());
+    glStateCache.bindVertexArray(objectDetails.getVertexArrayId());
+    VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), matrixBase);
+    VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), 2, spinBase);
+
+    const auto radius = getImpostorRadius(objectDetails);
+    const auto &lod = objectDetails.getLod(0);
+    const std::array<glm::mat4, 2> cameraMatrices = {glm::mat4(1.0f), glm::ortho(-radius, radius, -radius, radius, radius, 3.0f * radius)};
+    const GLfloat clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat clearDepth = 1.0f;
+    for (uint32_t view = 0; view < IMPOSTOR_VIEWS_COUNT; view++)
+    {
+      // The views look at the object from all around its vertical axis, counter-clockwise from the front.
+      const auto angle = 2.0f * glm::pi<float_t>() * view / IMPOSTOR_VIEWS_COUNT;
+      auto viewCameraMatrices = cameraMatrices;
+      viewCameraMatrices[0] = glm::lookAt(2.0f * radius * glm::vec3(std::sin(angle), 0.0f, std::cos(angle)), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+      glStateCache.bindBuffer(GL_UNIFORM_BUFFER, cameraUniformBufferId);
+      glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(viewCameraMatrices), &viewCameraMatrices[0]);
+      glStateCache.bindBuffer(GL_UNIFORM_BUFFER, 0);
+
+      const auto layer = slot * IMPOSTOR_VIEWS_COUNT + view;
+      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, albedoTextureArrayId, 0, layer);
+      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, normalTextureArrayId, 0, layer);
+      glClearBufferfv(GL_COLOR, 0, clearColor);
+      glClearBufferfv(GL_COLOR, 1, clearColor);
+      glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * lod.firstIndex), 1, objectDetails.getBaseVertex());
+    }
+    glStateCache.bindVertexArray(0);
+    glStateCache.bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Filter the views down to their coarser mip levels, which the impostors a few pixels across are drawn from.
+    glStateCache.bindTexture(GL_TEXTURE_2D_ARRAY, albedoTextureArrayId);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glStateCache.bindTexture(GL_TEXTURE_2D_ARRAY, normalTextureArrayId);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glStateCache.bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    capturedObjectsCount++;
+  }
+
+  /**
+   * Find the slot of the texture arrays holding the views of the object of the model, pre-rendering them into the slot
+   *   used the longest time ago if they aren't in the arrays yet, or if the object or its texture was reloaded since.
+   *
+   * @param model                  The model.
+   * @param captureShader          The geometry buffer variant of the shader of the model.
+   * @param cameraUniformBufferId  The ID of the buffer of the camera uniform block.
+   *
+   * @return The slot, or nothing if every slot holds an object drawn in the frame already.
+   */
+  std::optional<uint32_t> findImpostorSlot(ModelBaseIntf &model, const ShaderDetails &captureShader, const GLuint &cameraUniformBufferId)
+  {
+    const auto &objectDetails = model.getObjectDetails();
+    const auto &textureDetails = model.getTextureDetails();
+    uint32_t slot = 0;
+    for (uint32_t i = 0; i < IMPOSTOR_OBJECTS_COUNT; i++)
+    {
+      if (slots[i].objectDetails.lock() == objectDetails && slots[i].textureDetails.lock() == textureDetails)
+      {
+        slot = i;
+        break;
+      }
+      // Slots whose objects are gone are taken over before any others.
+      if (slots[i].objectDetails.expired() || slots[i].textureDetails.expired())
+      {
+        slots[i].lastUsedFrame = 0;
+      }
+      if (slots[i].lastUsedFrame < slots[slot].lastUsedFrame)
+      {
+        slot = i;
+      }
+    }
+
+    auto &impostorSlot = slots[slot];
+    if (impostorSlot.objectDetails.lock() != objectDetails || impostorSlot.textureDetails.lock() != textureDetails)
+    {
+      if (impostorSlot.lastUsedFrame == framesCount)
+      {
+        return std::nullopt;
+      }
+      impostorSlot.objectDetails = objectDetails;
+      impostorSlot.textureDetails = textureDetails;
+      impostorSlot.sourceTextureId = 0;
+    }
+    if (impostorSlot.sourceTextureId != textureDetails->getTextureId() || impostorSlot.sourceFirstIndex != objectDetails->getLod(0).firstIndex)
+    {
+      impostorSlot.sourceTextureId = textureDetails->getTextureId();
+      impostorSlot.sourceFirstIndex = objectDetails->getLod(0).firstIndex;
+      captureImpostor(*objectDetails, *textureDetails, captureShader, cameraUniformBufferId, slot);
+    }
+    impostorSlot.lastUsedFrame = framesCount;
+    return slot;
+  }
+
+public:
+  ImpostorBatch()
+      : impostorAlbedoTexturesKey(ShaderManager::getInstance().getUniformKey("impostorAlbedoTextures")),
+        impostorNormalTexturesKey(ShaderManager::getInstance().getUniformKey("impostorNormalTextures")),
+        diffuseTextureKey(ShaderManager::getInstance().getUniformKey("diffuseTexture")),
+        albedoTextureArrayId(createTextureArray(GL_RGBA8, "Impostor Albedo")),
+        normalTextureArrayId(createTextureArray(GL_RGBA16F, "Impostor Normals")),
+        framebufferId(0),
+        depthRenderbufferId(0),
+        slots(),
+        quadVertexArrayId(0),
+        quadVertexBufferId(0),
+        framesCount(0),
+        instanceMatrices(),
+        instanceLightMasks(),
+        instanceViews(),
+        instanceStreamingBuffer(IMPOSTOR_STREAMING_BUFFER_SIZE),
+        instanceMatrixBase(0),
+        instanceLightMaskBase(0),
+        instanceViewBase(0),
+        drawnImpostorsCount(0),
+        capturedObjectsCount(0)
+  {
+    slots.fill({std::weak_ptr<const ObjectDetails>(), std::weak_ptr<const TextureDetails>(), 0, 0, 0});
+
+    // The views are rendered into both texture arrays at once, tested against a depth buffer of their own.
+    glGenRenderbuffers(1, &depthRenderbufferId);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbufferId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, IMPOSTOR_TEXTURE_SIZE, IMPOSTOR_TEXTURE_SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &framebufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbufferId);
+    const GLenum drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // The quad spans from -1 to 1 along the axes of the model matrix of each impostor, with the texture coordinates of
+    //   the views across it.
+    const GLfloat quadVertices[] = {-1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+                                    1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+                                    -1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+                                    1.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+    glGenBuffers(1, &quadVertexBufferId);
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, quadVertexBufferId);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+    GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+    quadVertexArrayId = VertexArray::create();
+    GlStateCache::getInstance().bindVertexArray(quadVertexArrayId);
+    VertexArray::attachAttribute(VERTEX_POSITION_ATTRIBUTE_LOCATION, quadVertexBufferId, 3, sizeof(GLfloat) * 5, 0);
+    VertexArray::attachAttribute(VERTEX_UV_ATTRIBUTE_LOCATION, quadVertexBufferId, 2, sizeof(GLfloat) * 5, sizeof(GLfloat) * 3);
+    GlStateCache::getInstance().bindVertexArray(0);
+  }
+
+  // Preventing copying the impostor batch, since it owns its texture arrays, framebuffer and quad.
+  ImpostorBatch(const ImpostorBatch &) = delete;
+
+  ~ImpostorBatch()
+  {
+    GlStateCache::getInstance().deleteVertexArrays(1, &quadVertexArrayId);
+    GlStateCache::getInstance().deleteBuffers(1, &quadVertexBufferId);
+    GlStateCache::getInstance().deleteFramebuffers(1, &framebufferId);
+    glDeleteRenderbuffers(1, &depthRenderbufferId);
+    GlStateCache::getInstance().deleteTextures(1, &albedoTextureArrayId);
+    GlStateCache::getInstance().deleteTextures(1, &normalTextureArrayId);
+  }
+
+  /**
+   * Get how much of a model is drawn as its impostor for how big it is on the screen, which is all of it below the
+   *   impostor screen size, and less and less of it up to the end of the range it fades in over.
+   *
+   * @param model       The model.
+   * @param screenSize  The size of the model on the screen, in pixels.
+   *
+   * @return The share of the pixels of the impostor drawn, where 0 is drawing the model without its impostor, and 1
+   *         drawing the impostor alone.
+   */
+  static float_t getImpostorCoverage(const ModelBaseIntf &model, const float_t &screenSize)
+  {
+    if (IMPOSTOR_SCREEN_SIZE <= 0.0f || !model.hasImpostor())
+    {
+      return 0.0f;
+    }
+    const auto fadeEndSize = IMPOSTOR_SCREEN_SIZE * IMPOSTOR_FADE_RANGE;
+    return glm::clamp((fadeEndSize - screenSize) / (fadeEndSize - IMPOSTOR_SCREEN_SIZE), 0.0f, 1.0f);
+  }
+
+  /**
+   * Start collecting the impostor instances of a new frame.
+   */
+  void beginFrame()
+  {
+    framesCount++;
+    instanceMatrices.clear();
+    instanceLightMasks.clear();
+    instanceViews.clear();
+  }
+
+  /**
+   * Add an impostor instance of the model to the frame, facing the camera and moved towards it by the bounding radius of
+   *   the object, so it's drawn in front of the full mesh while fading in over it. This pre-renders the views of the
+   *   object if needed, so it has to be called before the views are rendered.
+   *
+   * @param model                  The model.
+   * @param lightMask              The mask of the shadowed lights reaching the model.
+   * @param coverage               The share of the pixels of the impostor drawn.
+   * @param cameraPosition         The position of the camera the impostor is seen from.
+   * @param spinTime               The time the spin of the model is evaluated at.
+   * @param captureShader          The geometry buffer variant of the shader of the model.
+   * @param cameraUniformBufferId  The ID of the buffer of the camera uniform block.
+   *
+   * @return Whether the impostor was added, which it isn't if every slot holds an object drawn in the frame already.
+   */
+  bool addInstance(ModelBaseIntf &model, const GLuint &lightMask, const float_t &coverage, const glm::vec3 &cameraPosition, const float_t &spinTime, const ShaderDetails &captureShader, const GLuint &cameraUniformBufferId)
+  {
+    const auto slot = findImpostorSlot(model, captureShader, cameraUniformBufferId);
+    if (!slot.has_value())
+    {
+      return false;
+    }
+
+    // Turn the model by its spin, as the vertex shaders would, and find the direction of the camera around its vertical axis.
+    const auto spin = model.getRenderSpin();
+    const auto spinMatrix = spin.y != 0.0f || spin.x != 0.0f ? glm::rotate(spin.x + spin.y * spinTime, glm::vec3(0.0f, 1.0f, 0.0f)) : glm::mat4(1.0f);
+    const auto modelMatrix = model.getRenderMatrix() * spinMatrix;
+    const auto center = glm::vec3(modelMatrix[3]);
+    const auto scale = std::max(glm::length(glm::vec3(modelMatrix[0])), std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+    const auto radius = getImpostorRadius(*model.getObjectDetails()) * scale;
+    const auto toCamera = cameraPosition - center;
+    const auto cameraDistance = std::max(glm::length(toCamera), 2.0f * radius);
+    const auto toCamera_objectSpace = glm::inverse(glm::mat3(modelMatrix)) * toCamera;
+    auto viewPosition = std::atan2(toCamera_objectSpace.x, toCamera_objectSpace.z) / (2.0f * glm::pi<float_t>()) * IMPOSTOR_VIEWS_COUNT;
+    viewPosition -= std::floor(viewPosition / IMPOSTOR_VIEWS_COUNT) * IMPOSTOR_VIEWS_COUNT;
+    const auto firstView = std::min(uint32_t(viewPosition), IMPOSTOR_VIEWS_COUNT - 1);
+    const auto firstLayer = *slot * IMPOSTOR_VIEWS_COUNT;
+
+    // Face the camera with the vertical axis of the model kept up, and shrink the quad by as much as moving it towards the
+    //   camera grows it, so it still covers the bounding sphere of the model.
+    const auto forward = toCamera / std::max(glm::length(toCamera), 0.001f);
+    const auto modelUp = glm::normalize(glm::vec3(modelMatrix[1]));
+    auto right = glm::cross(modelUp, forward);
+    right = glm::length(right) > 0.001f ? glm::normalize(right) : glm::vec3(1.0f, 0.0f, 0.0f);
+    const auto up = glm::cross(forward, right);
+    const auto quadSize = radius * (cameraDistance - radius) / cameraDistance;
+    instanceMatrices.push_back(glm::mat4(glm::vec4(right * quadSize, 0.0f), glm::vec4(up * quadSize, 0.0f), glm::vec4(forward * quadSize, 0.0f), glm::vec4(center + forward * radius, 1.0f)));
+    instanceLightMasks.push_back(lightMask);
+    instanceViews.push_back(glm::vec4(firstLayer + firstView, firstLayer + (firstView + 1) % IMPOSTOR_VIEWS_COUNT, viewPosition - firstView, coverage));
+    return true;
+  }
+
+  /**
+   * Get the number of impostor instances added to the frame so far, which is where the instances added next start.
+   *
+   * @return The number of impostor instances.
+   */
+  uint32_t getInstancesCount() const
+  {
+    return instanceMatrices.size();
+  }
+
+  /**
+   * Upload the instance data of the impostors of the frame once all of them were added.
+   *
+   * @param stats  The work of the pass, which the uploaded data is added to.
+   */
+  void uploadInstanceData(RenderStats &stats)
+  {
+    drawnImpostorsCount = instanceMatrices.size();
+    if (instanceMatrices.empty())
+    {
+      return;
+    }
+    const auto matricesSize = sizeof(glm::mat4) * instanceMatrices.size();
+    const auto lightMasksSize = sizeof(GLuint) * instanceLightMasks.size();
+    const auto viewsSize = sizeof(glm::vec4) * instanceViews.size();
+    instanceStreamingBuffer.reserve(matricesSize + lightMasksSize + viewsSize, sizeof(glm::mat4));
+    instanceMatrixBase = instanceStreamingBuffer.write(&instanceMatrices[0], matricesSize, sizeof(glm::mat4)) / sizeof(glm::mat4);
+    instanceLightMaskBase = instanceStreamingBuffer.write(&instanceLightMasks[0], lightMasksSize, sizeof(GLuint)) / sizeof(GLuint);
+    instanceViewBase = instanceStreamingBuffer.write(&instanceViews[0], viewsSize, sizeof(glm::vec4)) / sizeof(glm::vec4);
+    stats.uploadedBytes += matricesSize + lightMasksSize + viewsSize;
+  }
+
+  /**
+   * Draw the impostor instances of a view with a single instanced call, with the impostor variant of the model shader
+   *   in use and its lighting uniforms set.
+   *
+   * @param instanceRange   The range of the impostor instances of the view.
+   * @param impostorShader  The impostor variant of the model shader.
+   * @param stats           The work of the pass, which the work of drawing the impostors is added to.
+   */
+  void draw(const ImpostorInstanceRange &instanceRange, const ShaderDetails &impostorShader, RenderStats &stats)
+  {
+    if (instanceRange.instanceCount == 0)
+    {
+      return;
+    }
+    auto &glStateCache = GlStateCache::getInstance();
+    glUniform1i(impostorShader.getUniformLocation(impostorAlbedoTexturesKey), 0);
+    glUniform1i(impostorShader.getUniformLocation(impostorNormalTexturesKey), 10);
+    glStateCache.activeTexture(GL_TEXTURE0);
+    glStateCache.bindTexture(GL_TEXTURE_2D_ARRAY, albedoTextureArrayId);
+    glStateCache.activeTexture(GL_TEXTURE10);
+    glStateCache.bindTexture(GL_TEXTURE_2D_ARRAY, normalTextureArrayId);
+    glStateCache.activeTexture(GL_TEXTURE0);
+
+    glStateCache.bindVertexArray(quadVertexArrayId);
+    VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase + instanceRange.firstInstance);
+    VertexArray::attachInstanceIntegerAttribute(INSTANCE_LIGHT_MASK_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceLightMaskBase + instanceRange.firstInstance);
+    VertexArray::attachInstanceVectorAttribute(INSTANCE_IMPOSTOR_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), 4, instanceViewBase + instanceRange.firstInstance);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instanceRange.instanceCount);
+    glStateCache.bindVertexArray(0);
+    stats.drawCalls++;
+    stats.instances += instanceRange.instanceCount;
+    stats.triangles += uint64_t(instanceRange.instanceCount) * 2;
+    stats.uniformCalls += 2;
+    stats.stateChanges += 7;
+  }
+
+  /**
+   * Finish the current frame once the impostors were drawn, so the next one streams its data elsewhere.
+   */
+  void endFrame()
+  {
+    instanceStreamingBuffer.endFrame();
+  }
+
+  /**
+   * Get the number of impostors drawn in the latest frame, across all the views.
+   *
+   * @return The number of impostors.
+   */
+  const uint32_t &getDrawnImpostorsCount() const
+  {
+    return drawnImpostorsCount;
+  }
+
+  /**
+   * Get the number of objects pre-rendered into the impostor texture arrays since the batch was created.
+   *
+   * @return The number of objects.
+   */
+  const uint32_t &getCapturedObjectsCount() const
+  {
+    return capturedObjectsCount;
+  }
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef INCLUDE_INDIRECT_DRAW_CPP
+#define INCLUDE_INDIRECT_DRAW_CPP
+
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+#include "constants.cpp"
+#include "streaming_buffer.cpp"
+#include "gpu_culling.cpp"
+
+/**
+ * Structure for an indexed draw command read by the GPU from the indirect draw buffer, laid out as OpenGL expects it.
+ */
+struct DrawElementsIndirectCommand
+{
+  // The number of indices of the mesh.
+  GLuint count;
+  // The number of instances drawn.
+  GLuint instanceCount;
+  // The index of the first index of the mesh in the element array buffer, and the value added to every index.
+  GLuint firstIndex;
+  GLint baseVertex;
+  // The index of the per-instance data of the first instance, added to the index of every instance attribute.
+  GLuint baseInstance;
+};
+
+/**
+ * Class for collecting the draws sharing the same program, texture and vertex array, and submitting them all with a
+ *   single multi-draw indirect call once the state changes. The instance attributes point at the start of the instance
+ *   data of the frame, and each draw picks its instances through its base instance and its mesh through its first index
+ *   and base vertex within the mesh arena, so nothing has to be changed between the draws.
+ */
+class IndirectDrawBatch
+{
+private:
+  // The buffer the draw commands are streamed through.
+  StreamingBuffer commandStreamingBuffer;
+  // The draw commands collected since the last submission, and the culling jobs of the commands.
+  std::vector<DrawElementsIndirectCommand> commands;
+  std::vector<InstanceCullingJob> cullingJobs;
+  // The culler the instances of the commands are culled with on the GPU before they're drawn, or null if they're drawn
+  //   as they are.
+  GpuInstanceCuller *instanceCuller;
+  // The state the collected draws share.
+  GLuint programId;
+  GLuint textureId;
+  GLuint vertexArrayId;
+
+public:
+  IndirectDrawBatch()
+      : commandStreamingBuffer(INDIRECT_STREAMING_BUFFER_SIZE),
+        commands({}),
+        cullingJobs({}),
+        instanceCuller(nullptr),
+        programId(0),
+        textureId(0),
+        vertexArrayId(0) {}
+
+  /**
+   * Check if draws with the given state can be added to the collected draws. Draws needing a different state have to
+   *   wait until the collected draws are submitted, before the state is changed.
+   * 
+   * @param programId      The ID of the shader program of the draw.
+   * @param textureId      The ID of the texture of the draw.
+   * @param vertexArrayId  The ID of the vertex array of the draw.
+   * 
+   * @return Whether the draw shares the state of the collected draws, which is false if there are none.
+   */
+  bool isBatching(const GLuint &programId, const GLuint &textureId, const GLuint &vertexArrayId) const
+  {
+    return !commands.empty() && this->programId == programId && this->textureId == textureId && this->vertexArrayId == vertexArrayId;
+  }
+
+  /**
+   * Add a draw to the collected draws, which the given state has to be bound for once they're submitted.
+   * 
+   * @param programId      The ID of the shader program of the draw.
+   * @param textureId      The ID of the texture of the draw.
+   * @param vertexArrayId  The ID of the vertex array of the draw.
+   * @param command        The draw command.
+   * @param boundingSphere  The sphere around the mesh of the draw in the space of its vertices, which its instances are
+   *                        culled with if they're culled on the GPU.
+   * @param normalCone      The cone around the normals of the triangles of the draw in the space of its vertices, which
+   *                        its instances are culled with when they face away, or one with a sine of 1 to never do so.
+   */
+  void add(const GLuint &programId, const GLuint &textureId, const GLuint &vertexArrayId, const DrawElementsIndirectCommand &command, const glm::vec4 &boundingSphere = glm::vec4(0.0f), const glm::vec4 &normalCone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f))
+  {
+    this->programId = programId;
+    this->textureId = textureId;
+    this->vertexArrayId = vertexArrayId;
+    commands.push_back(command);
+    cullingJobs.push_back({command.instanceCount, boundingSphere, normalCone});
+  }
+
+  /**
+   * Set the culler the instances of the draws submitted from now on are culled with on the GPU before they're drawn,
+   *   which then read their instances from the culled instance data of the culler.
+   *
+   * @param instanceCuller  The culler, or null to draw every instance.
+   */
+  void setInstanceCuller(GpuInstanceCuller *instanceCuller)
+  {
+    this->instanceCuller = instanceCuller;
+  }
+
+  /**
+   * Get the size of the collected draw commands, which is uploaded once they're submitted.
+   * 
+   * @return The size in bytes.
+   */
+  size_t getCommandsSize() const
+  {
+    return (sizeof(DrawElementsIndirectCommand) + (instanceCuller != nullptr ? sizeof(InstanceCullingJob) : 0)) * commands.size();
+  }
+
+  /**
+   * Submit the collected draws with a single call, using the state that's currently bound.
+   * 
+   * @return The number of draw calls made, which is 0 if there were no draws collected.
+   */
+  uint32_t submit()
+  {
+    if (commands.empty())
+    {
+      return 0;
+    }
+    size_t commandsOffset = 0;
+    if (instanceCuller != nullptr)
+    {
+      // The commands start out without instances, and the culler counts the instances in view into them from the jobs.
+      for (auto &command : commands)
+      {
+        command.instanceCount = 0;
+      }
+      const auto commandsSize = sizeof(DrawElementsIndirectCommand) * commands.size();
+      const auto jobsSize = sizeof(InstanceCullingJob) * cullingJobs.size();
+      commandStreamingBuffer.reserve(commandsSize + jobsSize, sizeof(GLuint));
+      commandsOffset = commandStreamingBuffer.write(&commands[0], commandsSize, sizeof(GLuint));
+      const auto jobsOffset = commandStreamingBuffer.write(&cullingJobs[0], jobsSize, sizeof(GLuint));
+      instanceCuller->cullCommands(commandStreamingBuffer.getBufferId(), commandsOffset, jobsOffset, commands.size());
+      GlStateCache::getInstance().useProgram(programId);
+    }
+    else
+    {
+      commandsOffset = commandStreamingBuffer.write(&commands[0], sizeof(DrawElementsIndirectCommand) * commands.size(), sizeof(GLuint));
+    }
+    // The buffer can grow while writing, so it's only bound once the commands are written.
+    GlStateCache::getInstance().bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandStreamingBuffer.getBufferId());
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void *)commandsOffset, commands.size(), 0);
+    GlStateCache::getInstance().bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    commands.clear();
+    cullingJobs.clear();
+    return 1;
+  }
+
+  /**
+   * Finish the current frame once all its draws are submitted, so the next one writes its commands elsewhere.
+   */
+  void endFrame()
+  {
+    commandStreamingBuffer.endFrame();
+  }
+};
+
+#endif
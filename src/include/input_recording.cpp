@@ -0,0 +1,159 @@
+#ifndef INCLUDE_INPUT_RECORDING_CPP
+#define INCLUDE_INPUT_RECORDING_CPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "control.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for a frame of a recorded play session.
+ */
+struct InputRecordingFrame
+{
+  // The time the frame started at, in seconds since the start of the recording.
+  double_t time;
+  // The keys and mouse buttons that changed in the poll for events of the frame.
+  std::vector<InputChange> changes;
+};
+
+/**
+ * Structure for a recorded play session of the game scene, holding what the scene started with and the input and the
+ *   time of every frame, so the session can be replayed frame for frame. The file holds the settings of the scene,
+ *   followed by the time of each frame and only the buttons that changed in it, which keeps it to a few bytes a frame.
+ */
+struct InputRecording
+{
+  // The seed of the random number generators of the scene.
+  uint32_t seed;
+  // The number of enemies along the width, height and depth of the grid of enemies.
+  glm::uvec3 enemyGridSize;
+  // The shortest time between two shots of the player, in seconds.
+  float_t shotInterval;
+  // Whether the shots had lights at the start.
+  bool shotLightsEnabled;
+  // Whether the box-box collision tests used the separating axis test.
+  bool separatingAxisBoxTestEnabled;
+  // The recorded frames, in order.
+  std::vector<InputRecordingFrame> frames;
+
+  // The tag at the start of the recording files, and their version.
+  static const uint32_t fileTag;
+  static const uint32_t fileVersion;
+
+  /**
+   * Write the recording to a file.
+   *
+   * @param filePath  The path of the file.
+   *
+   * @return Whether the recording could be written.
+   */
+  bool save(const std::string &filePath) const
+  {
+    std::ofstream recordingFile(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!recordingFile.is_open())
+    {
+      Logger::getInstance().error(filePath, "\nFailed at input recording 1");
+      return false;
+    }
+
+    const auto write = [&](const auto &value) { recordingFile.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+    write(fileTag);
+    write(fileVersion);
+    write(seed);
+    write(enemyGridSize.x);
+    write(enemyGridSize.y);
+    write(enemyGridSize.z);
+    write(shotInterval);
+    write(uint8_t(shotLightsEnabled));
+    write(uint8_t(separatingAxisBoxTestEnabled));
+    write(uint32_t(frames.size()));
+    for (const auto &frame : frames)
+    {
+      write(frame.time);
+      write(uint16_t(frame.changes.size()));
+      // Each change is packed into the button, with the highest bit marking mouse buttons, and the bits of its states.
+      for (const auto &change : frame.changes)
+      {
+        write(uint16_t(change.button | (change.mouseButton ? 0x8000 : 0)));
+        write(uint8_t((change.down ? 1 : 0) | (change.pressed ? 2 : 0) | (change.released ? 4 : 0)));
+      }
+    }
+    return recordingFile.good();
+  }
+
+  /**
+   * Read a recording from a file.
+   *
+   * @param filePath   The path of the file.
+   * @param recording  The recording to store the read recording to.
+   *
+   * @return Whether the file held a recording.
+   */
+  static bool load(const std::string &filePath, InputRecording &recording)
+  {
+    std::ifstream recordingFile(filePath, std::ios::in | std::ios::binary);
+    if (!recordingFile.is_open())
+    {
+      Logger::getInstance().error(filePath, "\nFailed at input recording 2");
+      return false;
+    }
+
+    const auto read = [&](auto &value) { recordingFile.read(reinterpret_cast<char *>(&value), sizeof(value)); };
+    uint32_t tag = 0, version = 0, framesCount = 0;
+    uint8_t shotLightsEnabled = 0, separatingAxisBoxTestEnabled = 0;
+    read(tag);
+    read(version);
+    if (!recordingFile.good() || tag != fileTag || version != fileVersion)
+    {
+      Logger::getInstance().error(filePath, "\nFailed at input recording 3");
+      return false;
+    }
+    read(recording.seed);
+    read(recording.enemyGridSize.x);
+    read(recording.enemyGridSize.y);
+    read(recording.enemyGridSize.z);
+    read(recording.shotInterval);
+    read(shotLightsEnabled);
+    read(separatingAxisBoxTestEnabled);
+    read(framesCount);
+    recording.shotLightsEnabled = shotLightsEnabled != 0;
+    recording.separatingAxisBoxTestEnabled = separatingAxisBoxTestEnabled != 0;
+    recording.frames.clear();
+    recording.frames.reserve(framesCount);
+    for (uint32_t i = 0; i < framesCount && recordingFile.good(); i++)
+    {
+      InputRecordingFrame frame({0.0, {}});
+      uint16_t changesCount = 0;
+      read(frame.time);
+      read(changesCount);
+      frame.changes.reserve(changesCount);
+      for (uint16_t j = 0; j < changesCount; j++)
+      {
+        uint16_t button = 0;
+        uint8_t states = 0;
+        read(button);
+        read(states);
+        frame.changes.push_back({uint16_t(button & 0x7FFF), (button & 0x8000) != 0, (states & 1) != 0, (states & 2) != 0, (states & 4) != 0});
+      }
+      recording.frames.push_back(std::move(frame));
+    }
+    if (!recordingFile.good() || recording.enemyGridSize.x == 0 || recording.enemyGridSize.y == 0 || recording.enemyGridSize.z == 0)
+    {
+      Logger::getInstance().error(filePath, "\nFailed at input recording 4");
+      return false;
+    }
+    return true;
+  }
+};
+
+// Initialize the tag of the recording files, which reads "GTIR" in the file, and their version.
+const uint32_t InputRecording::fileTag = 0x52495447;
+const uint32_t InputRecording::fileVersion = 1;
+
+#endif
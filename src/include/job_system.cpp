@@ -0,0 +1,271 @@
+#ifndef INCLUDE_JOB_SYSTEM_CPP
+#define INCLUDE_JOB_SYSTEM_CPP
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+#include "thread_affinity.cpp"
+
+/**
+ * A class for running jobs on a fixed set of worker threads, one for each core the thread layout leaves for the jobs
+ *   besides the calling one, each pinned to its core. Every
+ *   thread has its own queue of jobs, taking its newest job first and stealing the oldest jobs of the other threads once
+ *   its own queue is empty. A thread waiting for its jobs runs jobs itself until they are done, so jobs can wait for
+ *   jobs of their own. It does not depend on OpenGL, so it can also be used by tools.
+ */
+class JobSystem
+{
+private:
+  /**
+   * Structure for a job, which is one task out of a group of tasks sharing the same function.
+   */
+  struct Job
+  {
+    // The function of the group of tasks, given the index of the task.
+    const std::function<void(const uint32_t)> *task;
+    // The index of the task.
+    uint32_t taskIndex;
+    // The number of tasks of the group that haven't completed yet.
+    std::atomic<uint32_t> *pendingTasks;
+  };
+
+  /**
+   * Structure for the queue of jobs of a thread.
+   */
+  struct JobQueue
+  {
+    // The lock guarding the jobs, since the other threads steal from them.
+    std::mutex mutex;
+    // The jobs, with the newest at the back.
+    std::deque<Job> jobs;
+  };
+
+  // The queues of jobs, where the first one belongs to the threads that aren't workers and the rest to the workers.
+  std::vector<std::unique_ptr<JobQueue>> jobQueues;
+  // The worker threads.
+  std::vector<std::thread> workers;
+  // The number of jobs queued and not yet taken by any thread.
+  std::atomic<uint32_t> queuedJobsCount;
+  // Whether the workers should stop.
+  bool stopping;
+  // The lock and condition the idle workers wait on for jobs to be queued.
+  std::mutex idleMutex;
+  std::condition_variable idleCondition;
+
+  JobSystem()
+      : jobQueues(),
+        workers(),
+        queuedJobsCount(0),
+        stopping(false),
+        idleMutex(),
+        idleCondition()
+  {
+    const auto threadsCount = ThreadLayout::getInstance().getJobThreadsCount();
+    for (uint32_t i = 0; i < threadsCount; i++)
+    {
+      jobQueues.push_back(std::make_unique<JobQueue>());
+    }
+    for (uint32_t i = 1; i < threadsCount; i++)
+    {
+      workers.emplace_back(&JobSystem::runWorker, this, i);
+    }
+  }
+
+  ~JobSystem()
+  {
+    {
+      std::lock_guard<std::mutex> idleLock(idleMutex);
+      stopping = true;
+    }
+    idleCondition.notify_all();
+    for (auto &worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  /**
+   * Get the index of the queue of the current thread, which is 0 for all the threads that aren't workers.
+   *
+   * @return The index of the queue.
+   */
+  static uint32_t &getCurrentQueueIndex()
+  {
+    thread_local uint32_t currentQueueIndex = 0;
+    return currentQueueIndex;
+  }
+
+  /**
+   * Take a job for the current thread, trying its own queue first and stealing from the others after.
+   *
+   * @param job  The job to take, set if one was found.
+   *
+   * @return Whether a job was found.
+   */
+  bool takeJob(Job &job)
+  {
+    const auto queueIndex = getCurrentQueueIndex();
+    {
+      // Take the newest job of the own queue, which is the most likely to be in the cache still.
+      auto &ownQueue = *jobQueues[queueIndex];
+      std::lock_guard<std::mutex> queueLock(ownQueue.mutex);
+      if (!ownQueue.jobs.empty())
+      {
+        job = ownQueue.jobs.back();
+        ownQueue.jobs.pop_back();
+        queuedJobsCount--;
+        return true;
+      }
+    }
+    for (size_t i = 1; i < jobQueues.size(); i++)
+    {
+      // Steal the oldest job of the other queues, starting from the next one so the threads don't all steal from the same.
+      auto &otherQueue = *jobQueues[(queueIndex + i) % jobQueues.size()];
+      std::lock_guard<std::mutex> queueLock(otherQueue.mutex);
+      if (!otherQueue.jobs.empty())
+      {
+        job = otherQueue.jobs.front();
+        otherQueue.jobs.pop_front();
+        queuedJobsCount--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Run the job, and mark its task as completed.
+   *
+   * @param job  The job to run.
+   */
+  static void runJob(const Job &job)
+  {
+    (*job.task)(job.taskIndex);
+    job.pendingTasks->fetch_sub(1, std::memory_order_release);
+  }
+
+  /**
+   * Run the jobs of the worker until the job system stops, sleeping while there are none.
+   *
+   * @param queueIndex  The index of the queue of the worker.
+   */
+  void runWorker(const uint32_t queueIndex)
+  {
+    getCurrentQueueIndex() = queueIndex;
+    ThreadLayout::getInstance().applyToCurrentThread(ThreadRole::JOB, queueIndex);
+    Job job;
+    while (true)
+    {
+      if (takeJob(job))
+      {
+        runJob(job);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> idleLock(idleMutex);
+      idleCondition.wait(idleLock, [&]() { return stopping || queuedJobsCount > 0; });
+      if (stopping)
+      {
+        return;
+      }
+    }
+  }
+
+public:
+  // Preventing copying the job system, making sure only one instance can exist.
+  JobSystem(const JobSystem &) = delete;
+
+  /**
+   * Get the number of threads running jobs, which is the number of cores the thread layout leaves for the jobs.
+   *
+   * @return The number of threads.
+   */
+  uint32_t getThreadsCount() const
+  {
+    return jobQueues.size();
+  }
+
+  /**
+   * Run the given number of tasks as jobs, and wait for all of them to complete. The first task runs on the calling
+   *   thread, and the calling thread keeps running jobs while it waits for the rest.
+   *
+   * @param taskCount  The number of tasks to run.
+   * @param task       The function to run for each task, given the index of the task.
+   */
+  void run(const uint32_t &taskCount, const std::function<void(const uint32_t)> &task)
+  {
+    if (taskCount == 0)
+    {
+      return;
+    }
+
+    std::atomic<uint32_t> pendingTasks(taskCount - 1);
+    if (taskCount > 1)
+    {
+      {
+        // Count the jobs before queuing them, so the count never drops below zero when they're taken right away, and
+        //   lock the idle workers out while counting, so none of them misses the wake up.
+        std::lock_guard<std::mutex> idleLock(idleMutex);
+        queuedJobsCount += taskCount - 1;
+      }
+      {
+        // Queue all but the first task on the queue of this thread, for the idle workers to steal.
+        auto &ownQueue = *jobQueues[getCurrentQueueIndex()];
+        std::lock_guard<std::mutex> queueLock(ownQueue.mutex);
+        for (uint32_t i = taskCount - 1; i > 0; i--)
+        {
+          ownQueue.jobs.push_back({&task, i, &pendingTasks});
+        }
+      }
+      idleCondition.notify_all();
+    }
+
+    // Run the first task on this thread, then help with the queued jobs until all the tasks are done.
+    task(0);
+    Job job;
+    while (pendingTasks.load(std::memory_order_acquire) > 0)
+    {
+      if (takeJob(job))
+      {
+        runJob(job);
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the job system.
+   *
+   * @return The job system singleton instance.
+   */
+  static JobSystem &getInstance()
+  {
+    // Singleton instance of the job system, constructed the first time it's asked for.
+    static JobSystem instance;
+    return instance;
+  }
+
+  /**
+   * Get the index of the thread running the current job, which is 0 for all the threads that aren't workers. It can be
+   *   used to give each thread its own part of some shared state.
+   *
+   * @return The index of the thread.
+   */
+  static uint32_t getCurrentThreadIndex()
+  {
+    return getCurrentQueueIndex();
+  }
+};
+
+#endif
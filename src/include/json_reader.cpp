@@ -0,0 +1,227 @@
+#ifndef INCLUDE_JSON_READER_CPP
+#define INCLUDE_JSON_READER_CPP
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+
+/**
+ * Structure for defining a value read from a JSON file. Only the parts needed for the benchmark results and baselines
+ * are kept: numbers, strings, arrays and objects, with booleans and nulls read as numbers.
+ */
+struct JsonValue
+{
+	// The number, if the value is a number.
+	double_t number;
+	// The string, if the value is a string.
+	std::string string;
+	// The items, if the value is an array.
+	std::vector<JsonValue> items;
+	// The members, if the value is an object.
+	std::map<std::string, JsonValue> members;
+};
+
+/**
+ * Class for reading the JSON files written by the benchmarks and the baseline they're compared to.
+ */
+class JsonReader
+{
+private:
+	// The text being read.
+	const std::string text;
+	// The position of the next character to read.
+	size_t position;
+
+	/**
+	 * Skip the whitespace from the current position.
+	 */
+	void skipWhitespace()
+	{
+		while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+		{
+			position++;
+		}
+	}
+
+	/**
+	 * Read the given character, skipping the whitespace before it.
+	 *
+	 * @param character  The character to read.
+	 *
+	 * @return Whether the character was next.
+	 */
+	bool readCharacter(const char &character)
+	{
+		skipWhitespace();
+		if (position < text.size() && text[position] == character)
+		{
+			position++;
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * Read a string, without any support for escapes other than passing on the escaped character.
+	 *
+	 * @param string  The string to store the read string to.
+	 *
+	 * @return Whether a string was read.
+	 */
+	bool readString(std::string &string)
+	{
+		if (!readCharacter('"'))
+		{
+			return false;
+		}
+		string.clear();
+		while (position < text.size() && text[position] != '"')
+		{
+			if (text[position] == '\\')
+			{
+				position++;
+			}
+			if (position < text.size())
+			{
+				string += text[position++];
+			}
+		}
+		return readCharacter('"');
+	}
+
+public:
+	JsonReader(const std::string &text)
+			: text(text),
+				position(0) {}
+
+	/**
+	 * Read a value from the current position.
+	 *
+	 * @param value  The value to store the read value to.
+	 *
+	 * @return Whether a value was read.
+	 */
+	bool readValue(JsonValue &value)
+	{
+		value = JsonValue({0.0, "", {}, {}});
+		skipWhitespace();
+		if (position >= text.size())
+		{
+			return false;
+		}
+
+		// Read an object's members until its closing brace.
+		if (readCharacter('{'))
+		{
+			if (readCharacter('}'))
+			{
+				return true;
+			}
+			do
+			{
+				std::string name;
+				if (!readString(name) || !readCharacter(':') || !readValue(value.members[name]))
+				{
+					return false;
+				}
+			} while (readCharacter(','));
+			return readCharacter('}');
+		}
+
+		// Read an array's items until its closing bracket.
+		if (readCharacter('['))
+		{
+			if (readCharacter(']'))
+			{
+				return true;
+			}
+			do
+			{
+				value.items.push_back(JsonValue());
+				if (!readValue(value.items.back()))
+				{
+					return false;
+				}
+			} while (readCharacter(','));
+			return readCharacter(']');
+		}
+
+		if (text[position] == '"')
+		{
+			return readString(value.string);
+		}
+
+		// Read the literals, and anything else as a number.
+		for (const auto &literal : {std::make_pair("true", 1.0), std::make_pair("false", 0.0), std::make_pair("null", 0.0)})
+		{
+			if (text.compare(position, std::string(literal.first).size(), literal.first) == 0)
+			{
+				position += std::string(literal.first).size();
+				value.number = literal.second;
+				return true;
+			}
+		}
+		char *numberEnd = nullptr;
+		value.number = std::strtod(text.c_str() + position, &numberEnd);
+		if (numberEnd == text.c_str() + position)
+		{
+			return false;
+		}
+		position = numberEnd - text.c_str();
+		return true;
+	}
+
+	/**
+	 * Read the JSON file at the given path.
+	 *
+	 * @param filePath  The path of the file.
+	 * @param value     The value to store the read value to.
+	 *
+	 * @return Whether the file could be read.
+	 */
+	static bool readFile(const std::string &filePath, JsonValue &value)
+	{
+		std::ifstream jsonFile(filePath, std::ios::in);
+		if (!jsonFile.is_open())
+		{
+			return false;
+		}
+		std::stringstream jsonStream;
+		jsonStream << jsonFile.rdbuf();
+		return JsonReader(jsonStream.str()).readValue(value);
+	}
+};
+
+/**
+ * Get a number from the benchmark results by its path, such as "frameTime.p95" for the 95th percentile of the frame time.
+ *
+ * @param results     The benchmark results.
+ * @param metricPath  The path of the number, with the names of the objects it's in separated by dots.
+ * @param number      The number to store the found number to.
+ *
+ * @return Whether the number was found.
+ */
+bool findMetric(const JsonValue &results, const std::string &metricPath, double_t &number)
+{
+	const JsonValue *value = &results;
+	std::stringstream metricPathStream(metricPath);
+	std::string name;
+	while (std::getline(metricPathStream, name, '.'))
+	{
+		const auto member = value->members.find(name);
+		if (member == value->members.end())
+		{
+			return false;
+		}
+		value = &member->second;
+	}
+	number = value->number;
+	return true;
+}
+
+#endif
@@ -2,12 +2,49 @@
 #define INCLUDE_LIGHT_CPP
 
 #include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "constants.cpp"
 #include "text.cpp"
+#include "profiler.cpp"
+#include "slot_map.cpp"
 #include "../light/light_base.cpp"
+#include "../camera/camera_base.cpp"
+
+/**
+ * Enum for how the shadow map of a light is kept up to date, as given by the light scheduler.
+ */
+enum class ShadowTier
+{
+  // Rendered at its full size whenever it's stale.
+  FULL,
+  // Rendered at a reduced size, and only when it's its turn among the other round-robin lights.
+  ROUND_ROBIN,
+  // Not rendered, with point lights lit through the light clusters instead and cone lights left out.
+  NONE
+};
+
+/**
+ * Structure for a light as ranked by the light scheduler.
+ */
+struct ScheduledLight
+{
+  // The light.
+  std::shared_ptr<LightBase> light;
+  // How much the light adds to the screen, which the lights are ranked by.
+  float_t importance;
+  // How the shadow map of the light is kept up to date.
+  ShadowTier shadowTier;
+  // Whether the shadow map of the light can be rendered in the frame, which is only false for round-robin lights
+  //   waiting for their turn.
+  bool shadowUpdateAllowed;
+};
 
 /**
  * A manager class for managing lights in a scene.
@@ -15,54 +52,115 @@
 class LightManager
 {
 private:
-  // Singleton instance of the light manager.
-  static LightManager instance;
+  // The registered lights, found by their handles and packed together for iterating them.
+  SlotMap<std::shared_ptr<LightBase>> registeredLights;
+  // The lines of debug text with the update times of the lights, as of the latest update.
+  std::vector<std::string> updateStatsTexts;
 
-  // The text manager responsible for rendering text.
-  TextManager &textManager;
+  // The lights ranked by their importance in the latest frame, with the tiers of their shadow maps.
+  std::vector<ScheduledLight> scheduledLights;
+  // The number of the most important lights given full shadow maps, which shrinks while the shadow maps take longer
+  //   than the budget to render and grows again once they're well under it.
+  uint32_t fullShadowLightsCount;
+  // The frame the light scheduler is on, and the frames the round-robin lights last had their turn in.
+  uint64_t scheduleFrame;
+  std::unordered_map<SlotHandle, uint64_t> lastShadowTurns;
 
-  // The map of registered lights.
-  std::map<const std::string, std::shared_ptr<LightBase>> registeredLights;
-  std::vector<std::string> registeredLightsInsertionOrder;
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local LightManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the light manager, which is the one of the default world.
+   *
+   * @return The light manager singleton instance.
+   */
+  static LightManager &getSingleton()
+  {
+    // Singleton instance of the light manager, constructed the first time it's asked for.
+    static LightManager instance;
+    return instance;
+  }
 
   LightManager()
-      : textManager(TextManager::getInstance()),
-        registeredLights({}),
-        registeredLightsInsertionOrder({}) {}
+      : registeredLights(),
+        updateStatsTexts({}),
+        scheduledLights({}),
+        fullShadowLightsCount(MAX_LIGHTS),
+        scheduleFrame(0),
+        lastShadowTurns({}) {}
+
+  /**
+   * Get how much the light adds to what the camera sees. Brighter lights count for more, falling off with the square of
+   *   their distance from the camera, and cone lights count for the share of the directions around them they light.
+   *   Directional lights light everything the camera sees, so they don't fall off and count for every direction.
+   * 
+   * @param light   The light.
+   * @param camera  The camera the scene is rendered from.
+   * 
+   * @return The importance of the light.
+   */
+  static float_t getLightImportance(const LightBase &light, const CameraBase &camera)
+  {
+    const auto lightColorIntensity = light.getLightColor() * light.getLightIntensity();
+    const auto brightestChannel = std::max(lightColorIntensity.r, std::max(lightColorIntensity.g, lightColorIntensity.b));
+    if (light.getLightType() == ShadowBufferType::DIRECTIONAL)
+    {
+      return brightestChannel;
+    }
+    const auto distance = glm::distance(camera.getCameraPosition(), light.getLightPosition());
+    const auto coverage = float_t(light.getFacesCount()) / LightBase::MAX_FACES_COUNT;
+    return brightestChannel * coverage / (1.0f + distance * distance);
+  }
+
+  /**
+   * Get the most lights of the given type the model shaders have shadow maps for.
+   * 
+   * @param lightType  The type of the lights.
+   * 
+   * @return The most lights of the type.
+   */
+  static int32_t getMaxShadowedLightsCount(const ShadowBufferType &lightType)
+  {
+    switch (lightType)
+    {
+    case ShadowBufferType::POINT:
+      return MAX_POINT_LIGHTS;
+    case ShadowBufferType::DIRECTIONAL:
+      return MAX_DIRECTIONAL_LIGHTS;
+    default:
+      return MAX_CONE_LIGHTS;
+    }
+  }
 
 public:
   // Preventing copying the light manager, making sure only one instance can exist.
   LightManager(const LightManager &) = delete;
 
   /**
-   * Register a new light into the light manager.
+   * Register a new light into the light manager, giving it the handle it is found by from then on.
    * 
    * @param light  The light to register.
+   * 
+   * @return The handle of the light.
    */
-  void registerLight(const std::shared_ptr<LightBase> &&light)
+  SlotHandle registerLight(const std::shared_ptr<LightBase> &light)
   {
-    // Insert the light to the map of registered lights.
-    registeredLights.emplace(light->getLightId(), std::move(light));
-    registeredLightsInsertionOrder.push_back(light->getLightId());
+    const auto lightHandle = registeredLights.insert(light);
+    light->setLightHandle(lightHandle);
+    return lightHandle;
   }
 
   /**
-   * De-register an existing light from the light manager.
+   * De-register an existing light from the light manager. Removing a light moves the last registered light into its
+   *   place in the list of all lights.
    * 
-   * @param light  The ID of the light to de-register.
+   * @param lightHandle  The handle of the light to de-register.
    */
-  void deregisterLight(const std::string &lightId)
+  void deregisterLight(const SlotHandle &lightHandle)
   {
-    // Check if light actually exists. If not, just return since it's not registered.
-    if (std::find(registeredLightsInsertionOrder.begin(), registeredLightsInsertionOrder.end(), lightId) == registeredLightsInsertionOrder.end())
-    {
-      return;
-    }
-
-    // Get the light that is registered with the given light ID.
-    auto light = registeredLights[lightId];
-    // Remove the light from the map of registered lights.
-    deregisterLight(light);
+    registeredLights.remove(lightHandle);
   }
 
   /**
@@ -72,21 +170,19 @@ public:
    */
   void deregisterLight(const std::shared_ptr<LightBase> &light)
   {
-    // Remove the light from the map of registered lights.
-    registeredLights.erase(light->getLightId());
-    registeredLightsInsertionOrder.erase(std::remove(registeredLightsInsertionOrder.begin(), registeredLightsInsertionOrder.end(), light->getLightId()), registeredLightsInsertionOrder.end());
+    deregisterLight(light->getLightHandle());
   }
 
   /**
-   * Return the light registered with the given light ID.
+   * Return the light registered with the given handle.
    * 
-   * @param light  The ID of the light to return.
+   * @param lightHandle  The handle of the light to return.
    * 
-   * @return The light registered with the given light ID.
+   * @return The light registered with the given handle.
    */
-  const std::shared_ptr<LightBase> &getLight(const std::string &lightId) const
+  const std::shared_ptr<LightBase> &getLight(const SlotHandle &lightHandle) const
   {
-    return registeredLights.at(lightId);
+    return registeredLights.get(lightHandle);
   }
 
   /**
@@ -94,18 +190,9 @@ public:
    * 
    * @return The list of all registered lights.
    */
-  const std::vector<std::shared_ptr<LightBase>> getAllLights() const
+  const std::vector<std::shared_ptr<LightBase>> &getAllLights() const
   {
-    // Define a vector to store the list of registered lights.
-    std::vector<std::shared_ptr<LightBase>> lights({});
-    // Iterate through the map of registered lights.
-    for (const auto &lightId : registeredLightsInsertionOrder)
-    {
-      // Push each registered model into the models list.
-      lights.push_back(registeredLights.find(lightId)->second);
-    }
-    // Return the list of registered lights.
-    return lights;
+    return registeredLights.getValues();
   }
 
   /**
@@ -113,16 +200,10 @@ public:
    */
   void initAllLights()
   {
-    // Iterate through the list of light IDs.
-    for (const auto &lightId : registeredLightsInsertionOrder)
+    // Iterate through the list of registered lights.
+    for (const auto &light : registeredLights.getValues())
     {
-      // Find the light registered with the given light ID.
-      const auto result = registeredLights.find(lightId);
-      // Check if the light still exists in the registration map.
-      if (result != registeredLights.end())
-      {
-        result->second->init();
-      }
+      light->init();
     }
   }
 
@@ -131,74 +212,156 @@ public:
    */
   void deinitAllLights()
   {
-    // Iterate through the list of light IDs.
-    for (const auto &lightId : registeredLightsInsertionOrder)
+    // Iterate through the list of registered lights.
+    for (const auto &light : registeredLights.getValues())
     {
-      // Find the light registered with the given light ID.
-      const auto result = registeredLights.find(lightId);
-      // Check if the light still exists in the registration map.
-      if (result != registeredLights.end())
-      {
-        result->second->deinit();
-      }
+      light->deinit();
     }
   }
 
   /**
    * Run the update operation on all the registered lights.
+   * 
+   * @param frameTime  The time of the frame.
    */
-  void updateAllLights()
+  void updateAllLights(const FrameTime &frameTime)
   {
     auto lightNamesCount = std::map<const std::string, int>({});
     auto lightNamesProcessTime = std::map<const std::string, double>({});
 
-    // Iterate through the list of light IDs.
-    for (const auto &lightId : registeredLightsInsertionOrder)
+    // Iterate through the list of registered lights.
+    for (const auto &light : registeredLights.getValues())
     {
-      // Find the light registered with the given light ID.
-      const auto result = registeredLights.find(lightId);
-      // Check if the light still exists in the registration map.
-      if (result != registeredLights.end())
+      if (lightNamesCount.find(light->getLightName()) != lightNamesCount.end())
+      {
+        lightNamesCount[light->getLightName()]++;
+      }
+      else
       {
-        if (lightNamesCount.find(result->second->getLightName()) != lightNamesCount.end())
-        {
-          lightNamesCount[result->second->getLightName()]++;
-        }
-        else
-        {
-          lightNamesCount[result->second->getLightName()] = 1;
-          lightNamesProcessTime[result->second->getLightName()] = 0.0f;
-        }
-
-        // If it does, tell the light to perform an update on itself.
-        const auto startTime = glfwGetTime();
-        result->second->update();
-        const auto endTime = glfwGetTime();
-        lightNamesProcessTime[result->second->getLightName()] += (endTime - startTime) * 1000;
+        lightNamesCount[light->getLightName()] = 1;
+        lightNamesProcessTime[light->getLightName()] = 0.0f;
       }
+
+      // Tell the light to perform an update on itself.
+      ProfileZone lightZone(light->getLightName());
+      light->update(frameTime);
+      lightNamesProcessTime[light->getLightName()] += lightZone.end();
     }
 
-    auto height = 15.0f;
+    updateStatsTexts.clear();
     for (const auto &lightCounts : lightNamesCount)
     {
       const auto avgRenderTime = lightNamesProcessTime[lightCounts.first] / lightCounts.second;
-      textManager.addText(lightCounts.first + " Light Object Instances: " + std::to_string(lightCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+      updateStatsTexts.push_back(lightCounts.first + " Light Object Instances: " + std::to_string(lightCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms");
+    }
+  }
+
+  /**
+   * Rank the registered lights by their importance from the given camera, and decide how each of their shadow maps is
+   *   kept up to date in the frame. The most important lights that fit the shadow maps of the model shaders get full
+   *   shadow maps, up to the number the shadow budget allows, and the rest of those that fit take turns rendering
+   *   smaller shadow maps. The lights that don't fit, or don't cast shadows, get none.
+   * 
+   * @param camera            The camera the scene is rendered from.
+   * @param shadowRenderTime  The time the GPU took to render the shadow maps of the latest measured frame, in
+   *                          milliseconds.
+   * 
+   * @return The ranked lights, from the most important.
+   */
+  const std::vector<ScheduledLight> &scheduleShadows(const CameraBase &camera, const float_t &shadowRenderTime)
+  {
+    // Move lights off full shadow maps while over the budget, and back once well under it.
+    if (shadowRenderTime > SHADOW_RENDER_BUDGET && fullShadowLightsCount > 1)
+    {
+      fullShadowLightsCount--;
+    }
+    else if (shadowRenderTime < SHADOW_RENDER_BUDGET * 0.5f && fullShadowLightsCount < uint32_t(MAX_LIGHTS))
+    {
+      fullShadowLightsCount++;
+    }
+
+    scheduledLights.clear();
+    for (const auto &light : registeredLights.getValues())
+    {
+      scheduledLights.push_back({light, getLightImportance(*light, camera), ShadowTier::NONE, false});
+    }
+    std::stable_sort(scheduledLights.begin(), scheduledLights.end(), [](const ScheduledLight &a, const ScheduledLight &b) {
+      return a.importance > b.importance;
+    });
+
+    // Give the lights their tiers in the order of their importance, until the shadow maps of each type run out.
+    std::array<int32_t, 3> lightsCounts({0, 0, 0});
+    uint32_t fullLightsCount = 0;
+    std::vector<ScheduledLight *> roundRobinLights({});
+    for (auto &scheduledLight : scheduledLights)
+    {
+      const auto &light = scheduledLight.light;
+      auto &lightsCount = lightsCounts[light->getLightType()];
+      if (!light->castsShadows() || lightsCount >= getMaxShadowedLightsCount(light->getLightType()))
+      {
+        continue;
+      }
+      lightsCount++;
+      if (fullLightsCount < fullShadowLightsCount)
+      {
+        scheduledLight.shadowTier = ShadowTier::FULL;
+        scheduledLight.shadowUpdateAllowed = true;
+        fullLightsCount++;
+      }
+      else
+      {
+        scheduledLight.shadowTier = ShadowTier::ROUND_ROBIN;
+        roundRobinLights.push_back(&scheduledLight);
+      }
+    }
+
+    // Give the turns to the round-robin lights that waited the longest for one, forgetting the lights that are gone.
+    scheduleFrame++;
+    std::unordered_map<SlotHandle, uint64_t> newShadowTurns({});
+    for (const auto &roundRobinLight : roundRobinLights)
+    {
+      const auto lastShadowTurn = lastShadowTurns.find(roundRobinLight->light->getLightHandle());
+      newShadowTurns[roundRobinLight->light->getLightHandle()] = lastShadowTurn != lastShadowTurns.end() ? lastShadowTurn->second : 0;
+    }
+    std::stable_sort(roundRobinLights.begin(), roundRobinLights.end(), [&newShadowTurns](const ScheduledLight *a, const ScheduledLight *b) {
+      return newShadowTurns.at(a->light->getLightHandle()) < newShadowTurns.at(b->light->getLightHandle());
+    });
+    for (uint32_t i = 0; i < roundRobinLights.size() && i < ROUND_ROBIN_SHADOW_UPDATES; i++)
+    {
+      roundRobinLights[i]->shadowUpdateAllowed = true;
+      newShadowTurns[roundRobinLights[i]->light->getLightHandle()] = scheduleFrame;
+    }
+    lastShadowTurns = newShadowTurns;
+
+    TextManager::getInstance().addFormattedText(glm::vec2(1, 13.5f), 0.5f, "Shadow Schedule: ", fullLightsCount, " Full | ", roundRobinLights.size(), " Round-Robin | ",
+                                 scheduledLights.size() - fullLightsCount - roundRobinLights.size(), " None | Budget: ", SHADOW_RENDER_BUDGET, "ms");
+    return scheduledLights;
+  }
+
+  /**
+   * Add the debug text with the update times of the lights as of the latest update, which can be a few frames back
+   *   when the lights don't update every frame.
+   */
+  void addUpdateStatsText()
+  {
+    auto height = 15.0f;
+    for (const auto &updateStatsText : updateStatsTexts)
+    {
+      TextManager::getInstance().addText(updateStatsText, glm::vec2(1, height), 0.5f);
       height -= 0.5f;
     }
   }
 
   /**
-   * Returns the singleton instance of the light manager.
+   * Returns the instance of the light manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
    * 
-   * @return The light manager singleton instance.
+   * @return The light manager instance.
    */
   static LightManager &getInstance()
   {
-    return instance;
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
   }
 };
 
-// Initialize the light manager singleton instance static variable.
-LightManager LightManager::instance;
-
 #endif
\ No newline at end of file
@@ -0,0 +1,403 @@
+#ifndef INCLUDE_LOG_CPP
+#define INCLUDE_LOG_CPP
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+
+#include "constants.cpp"
+#include "mpsc_queue.cpp"
+
+/**
+ * Enum for the severities of the messages logged, from the least to the most severe.
+ */
+enum LogSeverity
+{
+  DEBUG_SEVERITY,
+  INFO_SEVERITY,
+  WARNING_SEVERITY,
+  ERROR_SEVERITY
+};
+
+/**
+ * Class for writing the diagnostic messages of the engine out without the threads logging them waiting on the output. A
+ *   message is queued as the raw values of its parts, with the numbers copied as they are and the text copied into the
+ *   record, so logging takes no locks, no allocations and no formatting. A writer thread formats the queued messages
+ *   and writes them out in batches, woken right away for the errors, which are usually followed by the program exiting,
+ *   and otherwise every so often. The queue is written out in full before the program exits.
+ */
+class Logger
+{
+private:
+  /**
+   * Enum for the types of the parts of a queued message.
+   */
+  enum LogPartType : uint8_t
+  {
+    SIGNED_PART,
+    UNSIGNED_PART,
+    FLOATING_PART,
+    TEXT_PART
+  };
+
+  /**
+   * Structure for a queued message, with its parts packed one after the other as a type followed by its value, and the
+   *   text parts as their length followed by their characters.
+   */
+  struct LogRecord
+  {
+    // The number of bytes of the parts.
+    uint16_t size;
+    // The parts.
+    char parts[LOG_RECORD_SIZE - sizeof(uint16_t)];
+  };
+
+  // The queue of the messages waiting to be written.
+  MpscQueue<LogRecord, LOG_QUEUE_SIZE> queue;
+  // The least severe messages logged, with the messages less severe than it dropped before they're queued.
+  std::atomic<int32_t> minSeverity;
+  // The number of messages queued, the number of them written, and the number of messages dropped because the queue
+  //   was full since that was last written out.
+  std::atomic<uint64_t> queuedCount;
+  std::atomic<uint64_t> writtenCount;
+  std::atomic<uint64_t> droppedCount;
+  // The lock making the writer thread wake up, written out or stop, along with whether it was asked to.
+  std::mutex writerMutex;
+  std::condition_variable writerCondition;
+  std::condition_variable writtenCondition;
+  bool writeRequested;
+  bool stopRequested;
+  // The lock of the output, held while the messages are written so the ones written right away don't get mixed in.
+  std::mutex outputMutex;
+  // The thread writing out the queued messages.
+  std::thread writerThread;
+
+  Logger()
+      : queue(),
+        minSeverity(INFO_SEVERITY),
+        queuedCount(0),
+        writtenCount(0),
+        droppedCount(0),
+        writerMutex(),
+        writerCondition(),
+        writtenCondition(),
+        writeRequested(false),
+        stopRequested(false),
+        outputMutex(),
+        writerThread()
+  {
+    writerThread = std::thread(&Logger::runWriter, this);
+  }
+
+  ~Logger()
+  {
+    {
+      std::lock_guard<std::mutex> lock(writerMutex);
+      stopRequested = true;
+    }
+    writerCondition.notify_one();
+    writerThread.join();
+  }
+
+  /**
+   * Add the bytes of a part to the record.
+   *
+   * @param record  The record.
+   * @param data    The bytes.
+   * @param size    The number of bytes.
+   *
+   * @return Whether the bytes fit into the record.
+   */
+  static bool append(LogRecord &record, const void *data, const size_t &size)
+  {
+    if (record.size + size > sizeof(record.parts))
+    {
+      return false;
+    }
+    std::memcpy(record.parts + record.size, data, size);
+    record.size += static_cast<uint16_t>(size);
+    return true;
+  }
+
+  /**
+   * Add a text part to the record.
+   *
+   * @param record  The record.
+   * @param text    The text.
+   *
+   * @return Whether the text fit into the record.
+   */
+  static bool appendText(LogRecord &record, const std::string_view &text)
+  {
+    const auto type = TEXT_PART;
+    const auto length = static_cast<uint16_t>(text.size());
+    return text.size() <= UINT16_MAX && append(record, &type, sizeof(type)) && append(record, &length, sizeof(length)) && append(record, text.data(), text.size());
+  }
+
+  /**
+   * Add a number part to the record.
+   *
+   * @param record  The record.
+   * @param type    The type of the number.
+   * @param value   The number.
+   *
+   * @return Whether the number fit into the record.
+   */
+  template <typename Value>
+  static bool appendNumber(LogRecord &record, const LogPartType &type, const Value &value)
+  {
+    return append(record, &type, sizeof(type)) && append(record, &value, sizeof(value));
+  }
+
+  /**
+   * Add a part of a message to the record, as the number or the text it's written as.
+   *
+   * @param record  The record.
+   * @param part    The part.
+   *
+   * @return Whether the part fit into the record.
+   */
+  template <typename Part>
+  static bool appendPart(LogRecord &record, const Part &part)
+  {
+    if constexpr (std::is_same_v<Part, char>)
+    {
+      return appendText(record, std::string_view(&part, 1));
+    }
+    else if constexpr (std::is_enum_v<Part>)
+    {
+      return appendNumber(record, SIGNED_PART, static_cast<int64_t>(part));
+    }
+    else if constexpr (std::is_integral_v<Part> && std::is_signed_v<Part>)
+    {
+      return appendNumber(record, SIGNED_PART, static_cast<int64_t>(part));
+    }
+    else if constexpr (std::is_integral_v<Part>)
+    {
+      return appendNumber(record, UNSIGNED_PART, static_cast<uint64_t>(part));
+    }
+    else if constexpr (std::is_floating_point_v<Part>)
+    {
+      return appendNumber(record, FLOATING_PART, static_cast<double_t>(part));
+    }
+    else
+    {
+      return appendText(record, std::string_view(part));
+    }
+  }
+
+  /**
+   * Write a queued message out, formatted the way writing its parts to a stream one after the other would.
+   *
+   * @param record  The record of the message.
+   */
+  static void writeRecord(const LogRecord &record)
+  {
+    size_t offset = 0;
+    while (offset < record.size)
+    {
+      LogPartType type;
+      std::memcpy(&type, record.parts + offset, sizeof(type));
+      offset += sizeof(type);
+      if (type == TEXT_PART)
+      {
+        uint16_t length;
+        std::memcpy(&length, record.parts + offset, sizeof(length));
+        offset += sizeof(length);
+        std::cout.write(record.parts + offset, length);
+        offset += length;
+      }
+      else if (type == SIGNED_PART)
+      {
+        int64_t value;
+        std::memcpy(&value, record.parts + offset, sizeof(value));
+        offset += sizeof(value);
+        std::cout << value;
+      }
+      else if (type == UNSIGNED_PART)
+      {
+        uint64_t value;
+        std::memcpy(&value, record.parts + offset, sizeof(value));
+        offset += sizeof(value);
+        std::cout << value;
+      }
+      else
+      {
+        double_t value;
+        std::memcpy(&value, record.parts + offset, sizeof(value));
+        offset += sizeof(value);
+        std::cout << value;
+      }
+    }
+    std::cout << '\n';
+  }
+
+  /**
+   * Write out the messages queued so far.
+   */
+  void writeQueued()
+  {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    LogRecord record;
+    uint64_t recordsCount = 0;
+    while (queue.pop(record))
+    {
+      writeRecord(record);
+      recordsCount++;
+    }
+    const auto dropped = droppedCount.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0)
+    {
+      std::cout << "Dropped " << dropped << " log messages" << '\n';
+    }
+    if (recordsCount > 0 || dropped > 0)
+    {
+      std::cout.flush();
+    }
+    writtenCount.fetch_add(recordsCount, std::memory_order_release);
+  }
+
+  /**
+   * Run the writer thread, writing out the queued messages whenever it's woken up or the write interval passes, until
+   *   it's asked to stop with nothing left in the queue.
+   */
+  void runWriter()
+  {
+    const auto writeInterval = std::chrono::duration<double_t>(LOG_WRITE_INTERVAL);
+    std::unique_lock<std::mutex> lock(writerMutex);
+    while (true)
+    {
+      writeRequested = false;
+      lock.unlock();
+      writeQueued();
+      lock.lock();
+      writtenCondition.notify_all();
+      if (stopRequested && writtenCount.load(std::memory_order_acquire) >= queuedCount.load(std::memory_order_acquire))
+      {
+        return;
+      }
+      writerCondition.wait_for(lock, writeInterval, [&]() { return writeRequested || stopRequested; });
+    }
+  }
+
+  /**
+   * Wake the writer thread up, to write out the queued messages right away.
+   */
+  void requestWrite()
+  {
+    {
+      std::lock_guard<std::mutex> lock(writerMutex);
+      writeRequested = true;
+    }
+    writerCondition.notify_one();
+  }
+
+public:
+  // Preventing copying the logger, making sure only one instance can exist.
+  Logger(const Logger &) = delete;
+
+  /**
+   * Set the least severe messages logged, as the messages less severe than it are dropped before they're queued.
+   *
+   * @param severity  The severity.
+   */
+  void setMinSeverity(const LogSeverity &severity)
+  {
+    minSeverity.store(severity, std::memory_order_relaxed);
+  }
+
+  /**
+   * Log a message, queueing its parts to be written out as a line by the writer thread. A message too long for a record,
+   *   or a warning or an error with the queue full, is instead written right away once the messages before it are.
+   *
+   * @param severity  The severity of the message.
+   * @param parts     The parts of the message, each a number or a text.
+   */
+  template <typename... Parts>
+  void log(const LogSeverity &severity, const Parts &...parts)
+  {
+    if (severity < minSeverity.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+    LogRecord record;
+    record.size = 0;
+    const auto fits = (appendPart(record, parts) && ...);
+    if (fits && queue.push(record))
+    {
+      queuedCount.fetch_add(1, std::memory_order_release);
+      if (severity == ERROR_SEVERITY)
+      {
+        requestWrite();
+      }
+      return;
+    }
+    if (!fits || severity >= WARNING_SEVERITY)
+    {
+      flush();
+      std::lock_guard<std::mutex> lock(outputMutex);
+      (std::cout << ... << parts) << std::endl;
+      return;
+    }
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  template <typename... Parts>
+  void debug(const Parts &...parts)
+  {
+    log(DEBUG_SEVERITY, parts...);
+  }
+
+  template <typename... Parts>
+  void info(const Parts &...parts)
+  {
+    log(INFO_SEVERITY, parts...);
+  }
+
+  template <typename... Parts>
+  void warning(const Parts &...parts)
+  {
+    log(WARNING_SEVERITY, parts...);
+  }
+
+  template <typename... Parts>
+  void error(const Parts &...parts)
+  {
+    log(ERROR_SEVERITY, parts...);
+  }
+
+  /**
+   * Wait for the messages queued so far to be written out.
+   */
+  void flush()
+  {
+    const auto targetCount = queuedCount.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(writerMutex);
+    writeRequested = true;
+    writerCondition.notify_one();
+    writtenCondition.wait(lock, [&]() { return writtenCount.load(std::memory_order_acquire) >= targetCount; });
+  }
+
+  /**
+   * Returns the singleton instance of the logger.
+   *
+   * @return The logger singleton instance.
+   */
+  static Logger &getInstance()
+  {
+    // Singleton instance of the logger, constructed the first time it's asked for.
+    static Logger instance;
+    return instance;
+  }
+};
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef INCLUDE_LZ4_BLOCK_CPP
+#define INCLUDE_LZ4_BLOCK_CPP
+
+#include <vector>
+#include <algorithm>
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Class for compressing and decompressing data in the LZ4 block format, which is a run of sequences of literal bytes
+ *   each followed by a match copying earlier output. Decompressing it is little more than copying memory, so compressed
+ *   assets cost next to nothing to unpack.
+ */
+class Lz4Block
+{
+private:
+  // The number of bits of the hash of the 4 byte sequences the compressor finds matches with.
+  static const uint32_t hashBits = 16;
+  // The shortest match a sequence can have.
+  static const size_t minMatchLength = 4;
+  // The furthest back a match can copy from.
+  static const size_t maxMatchOffset = 65535;
+  // The format requires the last match to start at least 12 bytes before the end, and the last 5 bytes to be literals.
+  static const size_t matchStartLimit = 12;
+  static const size_t lastLiteralsLength = 5;
+
+  /**
+   * Write the part of a length past the 15 that fits in the token of a sequence, as bytes of 255 ending with a smaller one.
+   *
+   * @param output  The compressed data to write to.
+   * @param length  The rest of the length.
+   */
+  static void writeLength(std::vector<unsigned char> &output, size_t length)
+  {
+    for (; length >= 255; length -= 255)
+    {
+      output.push_back(255);
+    }
+    output.push_back(static_cast<unsigned char>(length));
+  }
+
+  /**
+   * Read the part of a length past the 15 that fits in the token of a sequence.
+   *
+   * @param source      The compressed data.
+   * @param sourceSize  The size of the compressed data.
+   * @param position    The position in the compressed data to read from, which is moved past the length.
+   * @param length      The length to add to.
+   *
+   * @return Whether the length ended before the compressed data did.
+   */
+  static bool readLength(const unsigned char *const source, const size_t &sourceSize, size_t &position, size_t &length)
+  {
+    unsigned char lengthByte;
+    do
+    {
+      if (position >= sourceSize)
+      {
+        return false;
+      }
+      lengthByte = source[position++];
+      length += lengthByte;
+    } while (lengthByte == 255);
+    return true;
+  }
+
+  /**
+   * Write a sequence of literal bytes, followed by a match unless it's the last sequence.
+   *
+   * @param output         The compressed data to write to.
+   * @param literals       The literal bytes.
+   * @param literalLength  The number of literal bytes.
+   * @param matchOffset    How far back the match copies from.
+   * @param matchLength    The length of the match, or 0 for the last sequence.
+   */
+  static void writeSequence(std::vector<unsigned char> &output, const unsigned char *const literals, const size_t &literalLength, const size_t &matchOffset, const size_t &matchLength)
+  {
+    const auto matchLengthCode = matchLength > 0 ? matchLength - minMatchLength : 0;
+    output.push_back(static_cast<unsigned char>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchLengthCode, 15)));
+    if (literalLength >= 15)
+    {
+      writeLength(output, literalLength - 15);
+    }
+    output.insert(output.end(), literals, literals + literalLength);
+    if (matchLength == 0)
+    {
+      return;
+    }
+    output.push_back(static_cast<unsigned char>(matchOffset & 0xFF));
+    output.push_back(static_cast<unsigned char>(matchOffset >> 8));
+    if (matchLengthCode >= 15)
+    {
+      writeLength(output, matchLengthCode - 15);
+    }
+  }
+
+public:
+  /**
+   * Compress the data into an LZ4 block, matching each 4 byte sequence against the last place it was seen at.
+   *
+   * @param source      The data to compress.
+   * @param sourceSize  The size of the data.
+   *
+   * @return The compressed block.
+   */
+  static std::vector<unsigned char> compress(const unsigned char *const source, const size_t &sourceSize)
+  {
+    std::vector<unsigned char> output;
+    output.reserve(sourceSize + sourceSize / 255 + 16);
+    // The positions each hash of a 4 byte sequence was last seen at, offset by 1 so 0 is never seen.
+    std::vector<size_t> lastPositions(size_t(1) << hashBits, 0);
+
+    size_t anchor = 0, position = 0;
+    while (position + matchStartLimit < sourceSize)
+    {
+      uint32_t sequence;
+      memcpy(&sequence, source + position, sizeof(uint32_t));
+      const auto hash = (sequence * 2654435761u) >> (32 - hashBits);
+      const auto candidate = lastPositions[hash];
+      lastPositions[hash] = position + 1;
+      if (candidate == 0 || position + 1 - candidate > maxMatchOffset || memcmp(source + candidate - 1, source + position, minMatchLength) != 0)
+      {
+        position++;
+        continue;
+      }
+
+      // Extend the match as far as it goes, leaving the last bytes as literals.
+      const auto matchPosition = candidate - 1;
+      auto matchLength = minMatchLength;
+      while (position + matchLength < sourceSize - lastLiteralsLength && source[matchPosition + matchLength] == source[position + matchLength])
+      {
+        matchLength++;
+      }
+      writeSequence(output, source + anchor, position - anchor, position - matchPosition, matchLength);
+      position += matchLength;
+      anchor = position;
+    }
+    // The rest of the data is written as the literals of the last sequence.
+    writeSequence(output, source + anchor, sourceSize - anchor, 0, 0);
+    return output;
+  }
+
+  /**
+   * Decompress the LZ4 block into the given memory, which it has to fill exactly.
+   *
+   * @param source           The compressed block.
+   * @param sourceSize       The size of the compressed block.
+   * @param destination      The memory to decompress the block into.
+   * @param destinationSize  The size of the decompressed data.
+   *
+   * @return Whether the block was valid and decompressed into exactly the size of the data.
+   */
+  static bool decompress(const unsigned char *const source, const size_t &sourceSize, unsigned char *const destination, const size_t &destinationSize)
+  {
+    size_t sourcePosition = 0, destinationPosition = 0;
+    while (sourcePosition < sourceSize)
+    {
+      // Copy the literals of the sequence.
+      const auto token = source[sourcePosition++];
+      size_t literalLength = token >> 4;
+      if (literalLength == 15 && !readLength(source, sourceSize, sourcePosition, literalLength))
+      {
+        return false;
+      }
+      if (literalLength > sourceSize - sourcePosition || literalLength > destinationSize - destinationPosition)
+      {
+        return false;
+      }
+      memcpy(destination + destinationPosition, source + sourcePosition, literalLength);
+      sourcePosition += literalLength;
+      destinationPosition += literalLength;
+      // The last sequence has no match.
+      if (sourcePosition == sourceSize)
+      {
+        break;
+      }
+
+      // Copy the match of the sequence from the data decompressed before it, a byte at a time since they can overlap.
+      if (sourceSize - sourcePosition < 2)
+      {
+        return false;
+      }
+      const size_t matchOffset = source[sourcePosition] | (source[sourcePosition + 1] << 8);
+      sourcePosition += 2;
+      size_t matchLength = token & 15;
+      if (matchLength == 15 && !readLength(source, sourceSize, sourcePosition, matchLength))
+      {
+        return false;
+      }
+      matchLength += minMatchLength;
+      if (matchOffset == 0 || matchOffset > destinationPosition || matchLength > destinationSize - destinationPosition)
+      {
+        return false;
+      }
+      for (size_t i = 0; i < matchLength; i++, destinationPosition++)
+      {
+        destination[destinationPosition] = destination[destinationPosition - matchOffset];
+      }
+    }
+    return destinationPosition == destinationSize;
+  }
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef INCLUDE_MAPPED_FILE_CPP
+#define INCLUDE_MAPPED_FILE_CPP
+
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * Class for a file mapped read-only into memory, so its contents can be read where they are instead of being copied into
+ *   a buffer first. The pages are read from the page cache of the OS as they're touched, so loading the same file again is
+ *   served from memory, and the file is unmapped when the mapped file is closed or destroyed.
+ */
+class MappedFile
+{
+private:
+  // The mapped contents of the file, or null if no file is mapped.
+  const unsigned char *data;
+  // The size of the file, in bytes.
+  size_t size;
+#ifdef _WIN32
+  // The handles of the opened file and of its mapping.
+  HANDLE fileHandle;
+  HANDLE mappingHandle;
+#endif
+
+public:
+  MappedFile()
+      : data(nullptr),
+        size(0)
+#ifdef _WIN32
+        ,
+        fileHandle(INVALID_HANDLE_VALUE),
+        mappingHandle(NULL)
+#endif
+  {
+  }
+
+  // Preventing copying the mapped file, since it owns the mapping.
+  MappedFile(const MappedFile &) = delete;
+
+  ~MappedFile()
+  {
+    close();
+  }
+
+  /**
+   * Map the given file into memory, unmapping the file mapped before if there is one. Empty files can't be mapped.
+   *
+   * @param filePath  The path to the file.
+   *
+   * @return Whether the file was mapped.
+   */
+  bool open(const std::string &filePath)
+  {
+    close();
+#ifdef _WIN32
+    fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    LARGE_INTEGER fileSize;
+    if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+      close();
+      return false;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    const auto mappedData = mappingHandle != NULL ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (mappedData == NULL)
+    {
+      close();
+      return false;
+    }
+    data = static_cast<const unsigned char *>(mappedData);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const auto fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+      return false;
+    }
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+      ::close(fileDescriptor);
+      return false;
+    }
+    // The mapping keeps the file open by itself, so the descriptor isn't needed past this.
+    const auto mappedData = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    ::close(fileDescriptor);
+    if (mappedData == MAP_FAILED)
+    {
+      return false;
+    }
+    // The file is read from start to end, so let the OS read ahead of the pages being touched.
+    madvise(mappedData, fileStatus.st_size, MADV_SEQUENTIAL);
+    data = static_cast<const unsigned char *>(mappedData);
+    size = static_cast<size_t>(fileStatus.st_size);
+#endif
+    return true;
+  }
+
+  /**
+   * Unmap the mapped file, if there is one.
+   */
+  void close()
+  {
+#ifdef _WIN32
+    if (data != nullptr)
+    {
+      UnmapViewOfFile(data);
+    }
+    if (mappingHandle != NULL)
+    {
+      CloseHandle(mappingHandle);
+      mappingHandle = NULL;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(fileHandle);
+      fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (data != nullptr)
+    {
+      munmap(const_cast<unsigned char *>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+  }
+
+  /**
+   * Ask the OS to read the whole mapped file in ahead of it being touched, in one sequential read instead of one for each
+   *   part of it as it's first used. The OS is free to ignore it.
+   */
+  void prefetch() const
+  {
+#ifndef _WIN32
+    if (data != nullptr)
+    {
+      madvise(const_cast<unsigned char *>(data), size, MADV_WILLNEED);
+    }
+#endif
+  }
+
+  /**
+   * Get the mapped contents of the file.
+   *
+   * @return The file data, or null if no file is mapped.
+   */
+  const unsigned char *getData() const
+  {
+    return data;
+  }
+
+  /**
+   * Get the size of the mapped file.
+   *
+   * @return The file size, in bytes.
+   */
+  const size_t &getSize() const
+  {
+    return size;
+  }
+};
+
+#endif
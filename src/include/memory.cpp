@@ -0,0 +1,216 @@
+#ifndef INCLUDE_MEMORY_CPP
+#define INCLUDE_MEMORY_CPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include <GL/glew.h>
+
+/**
+ * The subsystems whose memory is tracked, each by the manager owning it.
+ */
+enum class MemorySubsystem : uint32_t
+{
+  OBJECTS = 0,
+  TEXTURES = 1,
+  SHADOW_BUFFERS = 2,
+  TEXT = 3,
+  MODELS = 4,
+};
+
+// The number of subsystems whose memory is tracked.
+const uint32_t MEMORY_SUBSYSTEMS_COUNT = 5;
+
+/**
+ * Structure for the memory used by each subsystem at a point in time, in bytes.
+ */
+struct MemorySizes
+{
+  // The CPU memory allocated by the containers of each subsystem, or by the objects themselves for the models.
+  std::array<uint64_t, MEMORY_SUBSYSTEMS_COUNT> cpuSizes;
+  // The GPU memory of the buffers and textures of each subsystem.
+  std::array<uint64_t, MEMORY_SUBSYSTEMS_COUNT> gpuSizes;
+};
+
+/**
+ * A manager class for tracking the memory used by each subsystem. The CPU memory is counted by the allocators of the
+ *   containers of the managers as they allocate, and the GPU memory is reported by the managers once a frame, since
+ *   they already know the sizes of their buffers and textures.
+ */
+class MemoryManager
+{
+private:
+  // The names of the subsystems, for reporting.
+  const static std::array<std::string, MEMORY_SUBSYSTEMS_COUNT> subsystemNames;
+
+  // The bytes allocated by the containers of each subsystem, which can be counted from any thread.
+  std::array<std::atomic<int64_t>, MEMORY_SUBSYSTEMS_COUNT> cpuSizes;
+  // The bytes of the buffers and textures of each subsystem, as last reported.
+  std::array<std::atomic<uint64_t>, MEMORY_SUBSYSTEMS_COUNT> gpuSizes;
+
+  // The counters are constant initialized, so the containers of the managers created before the memory manager count
+  //   into it instead of being reset with it.
+  constexpr MemoryManager()
+      : cpuSizes(),
+        gpuSizes() {}
+
+public:
+  // Preventing copying the memory manager, making sure only one instance can exist.
+  MemoryManager(const MemoryManager &) = delete;
+
+  /**
+   * Count memory allocated or freed by a container of the subsystem.
+   *
+   * @param subsystem  The subsystem.
+   * @param size       The number of bytes allocated, or negative for the bytes freed.
+   */
+  void addCpuSize(const MemorySubsystem &subsystem, const int64_t &size)
+  {
+    cpuSizes[static_cast<uint32_t>(subsystem)].fetch_add(size, std::memory_order_relaxed);
+  }
+
+  /**
+   * Set the GPU memory used by the buffers and textures of the subsystem.
+   *
+   * @param subsystem  The subsystem.
+   * @param size       The number of bytes.
+   */
+  void setGpuSize(const MemorySubsystem &subsystem, const uint64_t &size)
+  {
+    gpuSizes[static_cast<uint32_t>(subsystem)].store(size, std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the memory used by every subsystem.
+   *
+   * @return The CPU and GPU memory of each subsystem, in bytes.
+   */
+  MemorySizes getSizes() const
+  {
+    MemorySizes sizes;
+    for (uint32_t i = 0; i < MEMORY_SUBSYSTEMS_COUNT; i++)
+    {
+      sizes.cpuSizes[i] = static_cast<uint64_t>(std::max<int64_t>(cpuSizes[i].load(std::memory_order_relaxed), 0));
+      sizes.gpuSizes[i] = gpuSizes[i].load(std::memory_order_relaxed);
+    }
+    return sizes;
+  }
+
+  /**
+   * Get the name of the subsystem.
+   *
+   * @param subsystemIndex  The index of the subsystem.
+   *
+   * @return The name of the subsystem.
+   */
+  static const std::string &getSubsystemName(const uint32_t &subsystemIndex)
+  {
+    return subsystemNames[subsystemIndex];
+  }
+
+  /**
+   * Ask the driver for the GPU memory it has left, through the memory info extension of the vendor, if there is one.
+   *   Must be called on the thread owning the GL context.
+   *
+   * @param totalSize      The dedicated GPU memory, set in bytes if the driver reports it.
+   * @param availableSize  The GPU memory left, set in bytes.
+   *
+   * @return Whether the driver reports its memory.
+   */
+  static bool queryDeviceMemory(uint64_t &totalSize, uint64_t &availableSize)
+  {
+    // The extensions report their sizes in kilobytes.
+    if (GLEW_NVX_gpu_memory_info)
+    {
+      GLint totalKilobytes = 0, availableKilobytes = 0;
+      glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &totalKilobytes);
+      glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &availableKilobytes);
+      totalSize = uint64_t(totalKilobytes) * 1024;
+      availableSize = uint64_t(availableKilobytes) * 1024;
+      return true;
+    }
+    if (GLEW_ATI_meminfo)
+    {
+      // The first value is the free memory of the pool the textures are allocated from. The total isn't reported.
+      GLint textureMemoryInfo[4] = {0, 0, 0, 0};
+      glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, textureMemoryInfo);
+      totalSize = 0;
+      availableSize = uint64_t(textureMemoryInfo[0]) * 1024;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Returns the singleton instance of the memory manager.
+   *
+   * @return The memory manager singleton instance.
+   */
+  static MemoryManager &getInstance()
+  {
+    // Singleton instance of the memory manager, constructed the first time it's asked for.
+    static MemoryManager instance;
+    return instance;
+  }
+};
+
+// Initialize the subsystem names static variable.
+const std::array<std::string, MEMORY_SUBSYSTEMS_COUNT> MemoryManager::subsystemNames = {"Objects", "Textures", "Shadow Buffers", "Text", "Models"};
+
+/**
+ * Allocator counting the memory it allocates and frees against a subsystem, for the containers of its manager. It
+ *   allocates through the standard allocator.
+ */
+template <typename T, MemorySubsystem subsystem>
+class CountingAllocator
+{
+public:
+  typedef T value_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef CountingAllocator<U, subsystem> other;
+  };
+
+  CountingAllocator() noexcept {}
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U, subsystem> &) noexcept {}
+
+  T *allocate(const size_t count)
+  {
+    MemoryManager::getInstance().addCpuSize(subsystem, int64_t(count * sizeof(T)));
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T *const pointer, const size_t count) noexcept
+  {
+    MemoryManager::getInstance().addCpuSize(subsystem, -int64_t(count * sizeof(T)));
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U, subsystem> &) const noexcept
+  {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const CountingAllocator<U, subsystem> &) const noexcept
+  {
+    return false;
+  }
+};
+
+// The containers of the managers, counting their memory against the subsystem of the manager.
+template <typename T, MemorySubsystem subsystem>
+using CountedVector = std::vector<T, CountingAllocator<T, subsystem>>;
+template <typename K, typename V, MemorySubsystem subsystem>
+using CountedMap = std::map<K, V, std::less<K>, CountingAllocator<std::pair<const K, V>, subsystem>>;
+
+#endif
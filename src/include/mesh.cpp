@@ -0,0 +1,1766 @@
+#ifndef INCLUDE_MESH_CPP
+#define INCLUDE_MESH_CPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <queue>
+#include <limits>
+#include <charconv>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <functional>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glm/glm.hpp>
+
+#include "parallel.cpp"
+#include "asset_archive.cpp"
+#include "log.cpp"
+
+/**
+ * Structure of a single vertex of a mesh, interleaving all the vertex information so it can be stored and uploaded as one block.
+ */
+struct MeshVertex
+{
+	// The position of the vertex.
+	glm::vec3 position;
+	// The UV coordinates of the vertex.
+	glm::vec2 uv;
+	// The normal vector of the vertex.
+	glm::vec3 normal;
+};
+
+/**
+ * Formats the vertices of a mesh can be stored and uploaded in.
+ */
+enum class MeshVertexFormat : uint16_t
+{
+	// Full precision floats, 32 bytes per vertex.
+	FULL = 0,
+	// 16-bit positions within the bounding box of the mesh, 16-bit UV coordinates and 10-bit normals, 16 bytes per vertex.
+	COMPACT = 1,
+};
+
+/**
+ * Structure of a single vertex of a mesh in the compact format, interleaved like the full vertices. The positions are
+ *   turned back into object space by the vertex matrix of the mesh, which is applied along with the model matrix.
+ */
+struct CompactMeshVertex
+{
+	// The position of the vertex within the bounding box of the mesh, from 0 at its lowest corner to 65535 at its highest
+	//   corner, with the fourth component unused.
+	uint16_t position[4];
+	// The UV coordinates of the vertex, from 0 to 65535.
+	uint16_t uv[2];
+	// The normal vector of the vertex, as three signed 10-bit components. The scale of the vertex matrix is divided out of
+	//   it, so the vertex matrix brings back its direction along with the positions.
+	uint32_t normal;
+};
+
+/**
+ * Structure for a level of detail of a mesh, as a range of the indices of the mesh.
+ */
+struct MeshLod
+{
+	// The index of the first index of the level of detail, and the number of indices.
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	// The largest distance of the surface of the level of detail from the surface of the full mesh.
+	float error;
+};
+
+/**
+ * Structure for a meshlet of a mesh, as a run of the indices of its full mesh using few enough vertices to be culled on
+ *   its own, along with the sphere around its triangles and the cone around their normals.
+ */
+struct Meshlet
+{
+	// The index of the first index of the meshlet, and the number of indices.
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	// The sphere around the triangles of the meshlet, with the centre in xyz and the radius in w.
+	glm::vec4 boundingSphere;
+	// The cone around the normals of the triangles of the meshlet, with its axis in xyz and the sine of the largest angle
+	//   of a normal from it in w, which is 1 when the normals spread too far for the meshlet to ever face away as a whole.
+	glm::vec4 normalCone;
+};
+
+/**
+ * Structure of the header of a binary mesh file, which is followed by the vertices, the indices, the levels of detail and
+ *   then the meshlets of the mesh.
+ */
+struct MeshFileHeader
+{
+	// The identifier of the binary mesh file format.
+	char magic[4];
+	// The version of the binary mesh file format.
+	uint32_t version;
+	// The size of the OBJ file the mesh was created from, used to detect when the binary mesh is outdated.
+	uint64_t sourceFileSize;
+	// The number of unique vertices of the mesh.
+	uint32_t vertexCount;
+	// The number of indices of the mesh.
+	uint32_t indexCount;
+	// The corner of the bounding box of the mesh with the lowest coordinates.
+	glm::vec3 boundsMin;
+	// The corner of the bounding box of the mesh with the highest coordinates.
+	glm::vec3 boundsMax;
+	// The distance of the furthest vertex of the mesh from its origin.
+	float boundingRadius;
+	// The format the mesh was asked to be stored in, and the format its vertices are stored in, which is the full format if
+	//   the mesh can't be stored compact.
+	MeshVertexFormat requestedVertexFormat;
+	MeshVertexFormat vertexFormat;
+	// The number of levels of detail of the mesh, listed after the indices.
+	uint32_t lodCount;
+	// The largest distance of a vertex of the mesh from its y-axis, and the half-height of the segment of the pill along the
+	//   y-axis with that radius holding every vertex.
+	float axisRadius;
+	float pillHalfHeight;
+	// The number of meshlets of the full mesh, listed after the levels of detail, which also keeps the vertex data after
+	//   the header aligned.
+	uint32_t meshletCount;
+};
+
+// Make sure the binary layout of the structures doesn't depend on the compiler.
+static_assert(sizeof(MeshVertex) == 32, "MeshVertex must be tightly packed");
+static_assert(sizeof(CompactMeshVertex) == 16, "CompactMeshVertex must be tightly packed");
+static_assert(sizeof(MeshLod) == 12, "MeshLod must be tightly packed");
+static_assert(sizeof(Meshlet) == 40, "Meshlet must be tightly packed");
+static_assert(sizeof(MeshFileHeader) == 72, "MeshFileHeader must be tightly packed");
+
+/**
+ * Structure for containing the data of a loaded mesh.
+ */
+struct MeshData
+{
+	// The list of unique vertices of the mesh.
+	std::vector<MeshVertex> vertices;
+	// The format the vertices are uploaded in, and the vertices in the compact format, only filled in for it.
+	MeshVertexFormat vertexFormat = MeshVertexFormat::FULL;
+	std::vector<CompactMeshVertex> compactVertices;
+	// The list of indices to the vertices in order of their use for each triangle, with the indices of each level of detail
+	//   following the ones of the full mesh.
+	std::vector<uint32_t> indices;
+	// The levels of detail of the mesh, from the full mesh to the coarsest.
+	std::vector<MeshLod> lods;
+	// The meshlets of the full mesh, in the order of its indices.
+	std::vector<Meshlet> meshlets;
+	// The average number of vertices transformed per triangle of the full mesh, in the order it was parsed in and after
+	//   it was optimized, only measured when the mesh is parsed.
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+	// The corner of the bounding box of the mesh with the lowest coordinates.
+	glm::vec3 boundsMin;
+	// The corner of the bounding box of the mesh with the highest coordinates.
+	glm::vec3 boundsMax;
+	// The distance of the furthest vertex of the mesh from its origin.
+	float boundingRadius;
+	// The largest distance of a vertex of the mesh from its y-axis, and the half-height of the segment of the pill along the
+	//   y-axis with that radius holding every vertex, which the cylinder and pill colliders of the mesh are made from.
+	float axisRadius;
+	float pillHalfHeight;
+};
+
+/**
+ * Structure for containing the vertex information and face corners parsed from (a chunk of) an OBJ file.
+ */
+struct ObjChunkData
+{
+	// The vertex positions.
+	std::vector<glm::vec3> positions;
+	// The vertex UV coordinates.
+	std::vector<glm::vec2> uvs;
+	// The vertex normal vectors.
+	std::vector<glm::vec3> normals;
+	// The 1-based position, UV coordinates and normal vector indices of each triangle corner, three per corner.
+	std::vector<uint32_t> corners;
+};
+
+/**
+ * Class for simplifying meshes by collapsing their edges in the order of the least quadric error, so the coarser levels of
+ *   detail of a mesh can be drawn in its place when it's small on the screen. Each collapse moves the vertices of one
+ *   position onto the vertices of a neighbouring position, so the simplified triangles only use vertices of the original
+ *   mesh, and every level of detail can share its vertices.
+ */
+class MeshSimplifier
+{
+private:
+	/**
+	 * Structure of a quadric, measuring the squared distances of a point to a set of planes, weighted by their areas.
+	 */
+	struct Quadric
+	{
+		double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0, b2 = 0.0, bc = 0.0, bd = 0.0, c2 = 0.0, cd = 0.0, d2 = 0.0;
+		// The total weight of the planes.
+		double weight = 0.0;
+
+		/**
+		 * Add the plane through the point with the given normal vector.
+		 *
+		 * @param normal       The unit normal vector of the plane.
+		 * @param point        A point on the plane.
+		 * @param planeWeight  The weight of the plane.
+		 */
+		void addPlane(const glm::dvec3 &normal, const glm::dvec3 &point, const double &planeWeight)
+		{
+			const auto d = -glm::dot(normal, point);
+			a2 += planeWeight * normal.x * normal.x;
+			ab += planeWeight * normal.x * normal.y;
+			ac += planeWeight * normal.x * normal.z;
+			ad += planeWeight * normal.x * d;
+			b2 += planeWeight * normal.y * normal.y;
+			bc += planeWeight * normal.y * normal.z;
+			bd += planeWeight * normal.y * d;
+			c2 += planeWeight * normal.z * normal.z;
+			cd += planeWeight * normal.z * d;
+			d2 += planeWeight * d * d;
+			weight += planeWeight;
+		}
+
+		void add(const Quadric &other)
+		{
+			a2 += other.a2, ab += other.ab, ac += other.ac, ad += other.ad, b2 += other.b2;
+			bc += other.bc, bd += other.bd, c2 += other.c2, cd += other.cd, d2 += other.d2;
+			weight += other.weight;
+		}
+
+		/**
+		 * Get the weighted mean squared distance of the point to the planes.
+		 *
+		 * @param point  The point.
+		 *
+		 * @return The mean squared distance.
+		 */
+		double getError(const glm::dvec3 &point) const
+		{
+			const auto &x = point.x, &y = point.y, &z = point.z;
+			const auto error = a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+												 b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+												 c2 * z * z + 2.0 * cd * z + d2;
+			return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+		}
+	};
+
+	/**
+	 * Structure of a candidate collapse of the vertices of a position onto the vertices of a neighbouring position.
+	 */
+	struct Collapse
+	{
+		// The error of the position after the collapse.
+		double error;
+		// The positions collapsed from and onto, and how many times each had changed when the error was measured.
+		uint32_t fromPosition;
+		uint32_t toPosition;
+		uint32_t fromVersion;
+		uint32_t toVersion;
+
+		bool operator>(const Collapse &other) const
+		{
+			return error > other.error;
+		}
+	};
+
+	/**
+	 * Structure for hashing vertex positions by their exact bits, to weld the vertices at the same position.
+	 */
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3 &position) const
+		{
+			uint32_t bits[3];
+			memcpy(bits, &position, sizeof(bits));
+			return std::hash<uint64_t>()((uint64_t(bits[0]) * 73856093u) ^ (uint64_t(bits[1]) * 19349663u) ^ (uint64_t(bits[2]) * 83492791u));
+		}
+	};
+
+	// The weight of the planes along the open edges of the mesh, which keeps its outline from shrinking.
+	static constexpr double openEdgeWeight = 10.0;
+	// The lowest cosine of the angle a triangle can turn by in a collapse, which keeps triangles from folding over.
+	static constexpr double minTurnCosine = 0.2;
+
+	/**
+	 * Get the normal vector of the triangle, scaled by twice its area.
+	 */
+	static glm::dvec3 getScaledNormal(const glm::dvec3 &a, const glm::dvec3 &b, const glm::dvec3 &c)
+	{
+		return glm::cross(b - a, c - a);
+	}
+
+public:
+	/**
+	 * Simplify the triangles of the mesh down to the given number of indices, or until the next collapse would move the
+	 *   surface by more than the given distance.
+	 *
+	 * @param vertices          The vertices of the mesh.
+	 * @param indices           The indices of the triangles of the mesh, using the vertices.
+	 * @param targetIndexCount  The number of indices to simplify the triangles down to.
+	 * @param maxError          The largest distance from the original surface allowed.
+	 * @param outError          The distance of the simplified surface from the original surface, set as measured by the quadrics.
+	 *
+	 * @return The indices of the simplified triangles, using the same vertices.
+	 */
+	static std::vector<uint32_t> simplify(const std::vector<MeshVertex> &vertices, const std::vector<uint32_t> &indices, const size_t &targetIndexCount, const float &maxError, float &outError)
+	{
+		// Weld the vertices at the same position, which the collapses work on, so the seams of the UV coordinates and normal
+		//   vectors stay closed.
+		std::unordered_map<glm::vec3, uint32_t, PositionHash> positionIds({});
+		std::vector<uint32_t> vertexPositions(vertices.size());
+		std::vector<glm::dvec3> positions({});
+		std::vector<std::vector<uint32_t>> positionVertices({});
+		for (uint32_t i = 0; i < vertices.size(); i++)
+		{
+			const auto insertedPosition = positionIds.insert(std::make_pair(vertices[i].position, positions.size()));
+			if (insertedPosition.second)
+			{
+				positions.push_back(glm::dvec3(vertices[i].position));
+				positionVertices.push_back({});
+			}
+			vertexPositions[i] = insertedPosition.first->second;
+			positionVertices[vertexPositions[i]].push_back(i);
+		}
+
+		// Gather the triangles around each position, and the quadrics of the planes of the triangles.
+		std::vector<uint32_t> triangles(indices);
+		const auto trianglesCount = static_cast<uint32_t>(triangles.size() / 3);
+		std::vector<bool> liveTriangles(trianglesCount, true);
+		std::vector<std::vector<uint32_t>> positionTriangles(positions.size());
+		std::vector<Quadric> quadrics(positions.size());
+		std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>> edgeTriangles({});
+		for (uint32_t t = 0; t < trianglesCount; t++)
+		{
+			const uint32_t corners[3] = {vertexPositions[triangles[t * 3]], vertexPositions[triangles[t * 3 + 1]], vertexPositions[triangles[t * 3 + 2]]};
+			const auto scaledNormal = getScaledNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]]);
+			const auto doubleArea = glm::length(scaledNormal);
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				positionTriangles[corners[i]].push_back(t);
+				if (doubleArea > 0.0)
+				{
+					quadrics[corners[i]].addPlane(scaledNormal / doubleArea, positions[corners[0]], doubleArea * 0.5);
+				}
+				edgeTriangles[std::minmax(corners[i], corners[(i + 1) % 3])].push_back(t);
+			}
+		}
+
+		// Keep the open edges of the mesh in place with planes along them, perpendicular to their triangles.
+		for (const auto &edge : edgeTriangles)
+		{
+			if (edge.second.size() != 1)
+			{
+				continue;
+			}
+			const auto t = edge.second.front();
+			const auto &a = positions[edge.first.first], &b = positions[edge.first.second];
+			const auto faceNormal = getScaledNormal(positions[vertexPositions[triangles[t * 3]]], positions[vertexPositions[triangles[t * 3 + 1]]], positions[vertexPositions[triangles[t * 3 + 2]]]);
+			const auto edgeNormal = glm::cross(b - a, faceNormal);
+			const auto edgeNormalLength = glm::length(edgeNormal);
+			if (edgeNormalLength > 0.0)
+			{
+				const auto edgeLengthSquared = glm::dot(b - a, b - a);
+				quadrics[edge.first.first].addPlane(edgeNormal / edgeNormalLength, a, edgeLengthSquared * openEdgeWeight);
+				quadrics[edge.first.second].addPlane(edgeNormal / edgeNormalLength, a, edgeLengthSquared * openEdgeWeight);
+			}
+		}
+
+		// Queue the collapses along every edge, both ways.
+		std::vector<uint32_t> positionVersions(positions.size(), 0);
+		std::vector<bool> collapsedPositions(positions.size(), false);
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+		const auto queueCollapse = [&](const uint32_t &fromPosition, const uint32_t &toPosition) {
+			auto quadric = quadrics[fromPosition];
+			quadric.add(quadrics[toPosition]);
+			collapses.push({quadric.getError(positions[toPosition]), fromPosition, toPosition, positionVersions[fromPosition], positionVersions[toPosition]});
+		};
+		for (const auto &edge : edgeTriangles)
+		{
+			queueCollapse(edge.first.first, edge.first.second);
+			queueCollapse(edge.first.second, edge.first.first);
+		}
+		edgeTriangles.clear();
+
+		auto liveIndexCount = triangles.size();
+		const auto maxSquaredError = double(maxError) * maxError;
+		auto squaredError = 0.0;
+		std::unordered_map<uint32_t, uint32_t> collapsedVertices({});
+		while (liveIndexCount > targetIndexCount && !collapses.empty())
+		{
+			const auto collapse = collapses.top();
+			collapses.pop();
+			if (collapse.error > maxSquaredError)
+			{
+				break;
+			}
+			const auto &from = collapse.fromPosition, &to = collapse.toPosition;
+			if (collapsedPositions[from] || collapsedPositions[to] || positionVersions[from] != collapse.fromVersion || positionVersions[to] != collapse.toVersion)
+			{
+				continue;
+			}
+
+			// Check that the positions still share a triangle, and that none of the other triangles around the collapsed
+			//   position would fold over. The vertices of the triangles being removed are collapsed onto the vertices they share
+			//   an edge with, so each side of a seam stays with its own side.
+			auto sharesTriangle = false, foldsOver = false;
+			collapsedVertices.clear();
+			for (const auto &t : positionTriangles[from])
+			{
+				if (!liveTriangles[t])
+				{
+					continue;
+				}
+				uint32_t fromCorner = 3, toCorner = 3;
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					const auto cornerPosition = vertexPositions[triangles[t * 3 + i]];
+					fromCorner = cornerPosition == from ? i : fromCorner;
+					toCorner = cornerPosition == to ? i : toCorner;
+				}
+				if (toCorner != 3)
+				{
+					sharesTriangle = true;
+					collapsedVertices.insert(std::make_pair(triangles[t * 3 + fromCorner], triangles[t * 3 + toCorner]));
+					continue;
+				}
+				const auto &a = positions[vertexPositions[triangles[t * 3]]], &b = positions[vertexPositions[triangles[t * 3 + 1]]], &c = positions[vertexPositions[triangles[t * 3 + 2]]];
+				const auto oldNormal = getScaledNormal(a, b, c);
+				const auto newNormal = getScaledNormal(fromCorner == 0 ? positions[to] : a, fromCorner == 1 ? positions[to] : b, fromCorner == 2 ? positions[to] : c);
+				if (glm::dot(oldNormal, newNormal) < minTurnCosine * glm::length(oldNormal) * glm::length(newNormal))
+				{
+					foldsOver = true;
+					break;
+				}
+			}
+			if (!sharesTriangle || foldsOver)
+			{
+				continue;
+			}
+
+			// Remove the triangles along the collapsed edge, and move the other triangles onto the position collapsed onto.
+			for (const auto &t : positionTriangles[from])
+			{
+				if (!liveTriangles[t])
+				{
+					continue;
+				}
+				auto removed = false;
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					removed = removed || vertexPositions[triangles[t * 3 + i]] == to;
+				}
+				if (removed)
+				{
+					liveTriangles[t] = false;
+					liveIndexCount -= 3;
+					continue;
+				}
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					auto &corner = triangles[t * 3 + i];
+					if (vertexPositions[corner] != from)
+					{
+						continue;
+					}
+					const auto collapsedVertex = collapsedVertices.find(corner);
+					if (collapsedVertex != collapsedVertices.end())
+					{
+						corner = collapsedVertex->second;
+						continue;
+					}
+					// The vertex doesn't share an edge with the position collapsed onto, so pick its vertex with the closest
+					//   UV coordinates and normal vector.
+					auto closestDistance = std::numeric_limits<float>::max();
+					auto closestVertex = positionVertices[to].front();
+					for (const auto &vertex : positionVertices[to])
+					{
+						const auto distance = glm::distance(vertices[vertex].uv, vertices[corner].uv) + glm::distance(vertices[vertex].normal, vertices[corner].normal);
+						if (distance < closestDistance)
+						{
+							closestDistance = distance;
+							closestVertex = vertex;
+						}
+					}
+					collapsedVertices.insert(std::make_pair(corner, closestVertex));
+					corner = closestVertex;
+				}
+				positionTriangles[to].push_back(t);
+			}
+			collapsedPositions[from] = true;
+			quadrics[to].add(quadrics[from]);
+			positionVersions[to]++;
+			squaredError = std::max(squaredError, collapse.error);
+
+			// Queue the collapses along the edges around the position collapsed onto again, with its new quadric.
+			for (const auto &t : positionTriangles[to])
+			{
+				if (!liveTriangles[t])
+				{
+					continue;
+				}
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					const auto cornerPosition = vertexPositions[triangles[t * 3 + i]];
+					if (cornerPosition != to)
+					{
+						queueCollapse(to, cornerPosition);
+						queueCollapse(cornerPosition, to);
+					}
+				}
+			}
+		}
+
+		// Gather the triangles left, in their original order.
+		std::vector<uint32_t> simplifiedIndices({});
+		simplifiedIndices.reserve(liveIndexCount);
+		for (uint32_t t = 0; t < trianglesCount; t++)
+		{
+			if (liveTriangles[t])
+			{
+				simplifiedIndices.insert(simplifiedIndices.end(), triangles.begin() + t * 3, triangles.begin() + t * 3 + 3);
+			}
+		}
+		outError = float(std::sqrt(squaredError));
+		return simplifiedIndices;
+	}
+};
+
+/**
+ * Class for reordering the triangles and vertices of meshes so the GPU draws them faster. The triangles are ordered to
+ *   reuse the vertices already in the post-transform vertex cache, then grouped in clusters ordered to draw the triangles
+ *   facing outwards first, cutting overdraw, and the vertices are ordered by their first use so they're fetched in order.
+ */
+class MeshOptimizer
+{
+private:
+	// The size of the cache the triangles are ordered for, and the size of the FIFO cache the miss ratios are measured with,
+	//   which is closer to how most GPUs reuse vertices.
+	static const uint32_t optimizedCacheSize = 32;
+	static const uint32_t measuredCacheSize = 16;
+	// The scores of the vertices in the cache, from Forsyth's linear-speed vertex cache optimisation.
+	static constexpr float_t cacheDecayPower = 1.5f;
+	static constexpr float_t lastTriangleScore = 0.75f;
+	static constexpr float_t valenceBoostScale = 2.0f;
+	static constexpr float_t valenceBoostPower = 0.5f;
+	// How much worse than the miss ratio of the whole cluster the miss ratio of the triangles of a cluster can get before it
+	//   can't be split there.
+	static constexpr float_t overdrawThreshold = 1.05f;
+
+	/**
+	 * Get the score of a vertex, which is higher the more recently it was used and the fewer triangles are left using it.
+	 *
+	 * @param cachePosition      The position of the vertex in the cache, where 0 is the latest, or -1 if it isn't in it.
+	 * @param remainingTriangles The number of triangles using the vertex that aren't ordered yet.
+	 *
+	 * @return The score of the vertex.
+	 */
+	static float_t getVertexScore(const int32_t &cachePosition, const uint32_t &remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return -1.0f;
+		}
+		auto score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// The vertices of the latest triangle get a fixed score, so the next triangle isn't only picked from them.
+			score = cachePosition < 3 ? lastTriangleScore : std::pow(1.0f - float_t(cachePosition - 3) / (optimizedCacheSize - 3), cacheDecayPower);
+		}
+		// Boost the vertices with few triangles left, so they're finished off before they leave the cache.
+		return score + valenceBoostScale * std::pow(float_t(remainingTriangles), -valenceBoostPower);
+	}
+
+public:
+	/**
+	 * Get the average number of vertices transformed per triangle, going through a FIFO cache.
+	 *
+	 * @param indices      The indices of the mesh.
+	 * @param firstIndex   The first index of the triangles.
+	 * @param indexCount   The number of indices of the triangles.
+	 * @param vertexCount  The number of vertices of the mesh.
+	 *
+	 * @return The average cache miss ratio, from 3 for no reuse to about 0.5 for a regular grid.
+	 */
+	static float_t getAcmr(const std::vector<uint32_t> &indices, const uint32_t &firstIndex, const uint32_t &indexCount, const size_t &vertexCount)
+	{
+		if (indexCount == 0)
+		{
+			return 0.0f;
+		}
+		// The time each vertex was added to the cache, which it's still in while less than the size of the cache ago.
+		std::vector<uint32_t> cacheTimes(vertexCount, 0);
+		uint32_t misses = 0;
+		for (auto i = firstIndex; i < firstIndex + indexCount; i++)
+		{
+			if (cacheTimes[indices[i]] == 0 || misses + 1 - cacheTimes[indices[i]] >= measuredCacheSize)
+			{
+				misses++;
+				cacheTimes[indices[i]] = misses;
+			}
+		}
+		return float_t(misses) / (indexCount / 3);
+	}
+
+	/**
+	 * Reorder the triangles to reuse the vertices in the vertex cache, with Forsyth's greedy optimisation, picking the
+	 *   triangle of the vertices in the cache with the best score each time.
+	 *
+	 * @param indices      The indices of the mesh, whose triangles are reordered in place.
+	 * @param firstIndex   The first index of the triangles.
+	 * @param indexCount   The number of indices of the triangles.
+	 * @param vertexCount  The number of vertices of the mesh.
+	 */
+	static void optimizeVertexCache(std::vector<uint32_t> &indices, const uint32_t &firstIndex, const uint32_t &indexCount, const size_t &vertexCount)
+	{
+		const auto trianglesCount = indexCount / 3;
+		// Gather the triangles using each vertex, as ranges of one list.
+		std::vector<uint32_t> vertexTriangleOffsets(vertexCount + 1, 0);
+		for (auto i = firstIndex; i < firstIndex + indexCount; i++)
+		{
+			vertexTriangleOffsets[indices[i] + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			vertexTriangleOffsets[v + 1] += vertexTriangleOffsets[v];
+		}
+		std::vector<uint32_t> vertexTriangles(indexCount);
+		std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+		for (uint32_t t = 0; t < trianglesCount; t++)
+		{
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const auto vertex = indices[firstIndex + t * 3 + i];
+				vertexTriangles[vertexTriangleOffsets[vertex] + remainingTriangles[vertex]++] = t;
+			}
+		}
+
+		// Score the vertices and triangles before any are in the cache.
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float_t> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			vertexScores[v] = getVertexScore(-1, remainingTriangles[v]);
+		}
+		std::vector<float_t> triangleScores(trianglesCount);
+		std::vector<bool> orderedTriangles(trianglesCount, false);
+		for (uint32_t t = 0; t < trianglesCount; t++)
+		{
+			const auto triangle = &indices[firstIndex + t * 3];
+			triangleScores[t] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+		}
+
+		std::vector<uint32_t> orderedIndices({});
+		orderedIndices.reserve(indexCount);
+		std::vector<uint32_t> cache({}), newCache({});
+		uint32_t nextUnorderedTriangle = 0;
+		for (uint32_t orderedCount = 0; orderedCount < trianglesCount; orderedCount++)
+		{
+			// Pick the best triangle using the vertices in the cache, or the next triangle not ordered yet if there's none.
+			auto bestTriangle = trianglesCount;
+			auto bestScore = -1.0f;
+			for (const auto &vertex : cache)
+			{
+				for (auto i = vertexTriangleOffsets[vertex]; i < vertexTriangleOffsets[vertex] + remainingTriangles[vertex]; i++)
+				{
+					if (triangleScores[vertexTriangles[i]] > bestScore)
+					{
+						bestScore = triangleScores[vertexTriangles[i]];
+						bestTriangle = vertexTriangles[i];
+					}
+				}
+			}
+			if (bestTriangle == trianglesCount)
+			{
+				while (orderedTriangles[nextUnorderedTriangle])
+				{
+					nextUnorderedTriangle++;
+				}
+				bestTriangle = nextUnorderedTriangle;
+			}
+
+			// Add the triangle, and take it off the triangles left for its vertices.
+			orderedTriangles[bestTriangle] = true;
+			const auto triangle = &indices[firstIndex + bestTriangle * 3];
+			orderedIndices.insert(orderedIndices.end(), triangle, triangle + 3);
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const auto vertex = triangle[i];
+				const auto begin = vertexTriangles.begin() + vertexTriangleOffsets[vertex];
+				std::iter_swap(std::find(begin, begin + remainingTriangles[vertex], bestTriangle), begin + remainingTriangles[vertex] - 1);
+				remainingTriangles[vertex]--;
+			}
+
+			// Move the vertices of the triangle to the front of the cache, pushing the others back.
+			newCache.assign(triangle, triangle + 3);
+			for (const auto &vertex : cache)
+			{
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+				{
+					newCache.push_back(vertex);
+				}
+			}
+			std::swap(cache, newCache);
+
+			// Score the vertices in the cache and the ones pushed out of it again, along with their triangles.
+			for (uint32_t i = 0; i < cache.size(); i++)
+			{
+				const auto vertex = cache[i];
+				cachePositions[vertex] = i < optimizedCacheSize ? i : -1;
+				vertexScores[vertex] = getVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			}
+			for (const auto &vertex : cache)
+			{
+				for (auto i = vertexTriangleOffsets[vertex]; i < vertexTriangleOffsets[vertex] + remainingTriangles[vertex]; i++)
+				{
+					const auto scoredTriangle = &indices[firstIndex + vertexTriangles[i] * 3];
+					triangleScores[vertexTriangles[i]] = vertexScores[scoredTriangle[0]] + vertexScores[scoredTriangle[1]] + vertexScores[scoredTriangle[2]];
+				}
+			}
+			if (cache.size() > optimizedCacheSize)
+			{
+				cache.resize(optimizedCacheSize);
+			}
+		}
+		std::copy(orderedIndices.begin(), orderedIndices.end(), indices.begin() + firstIndex);
+	}
+
+	/**
+	 * Reorder the triangles ordered for the vertex cache in clusters, drawing the clusters facing outwards from the centre
+	 *   of the mesh first, since they're the most likely to hide the others. The clusters are split where the cache has just
+	 *   missed on every vertex, or where starting again with an empty cache barely raises the miss ratio, so the order
+	 *   stays almost as good for the cache.
+	 *
+	 * @param vertices    The vertices of the mesh.
+	 * @param indices     The indices of the mesh, whose triangles are reordered in place.
+	 * @param firstIndex  The first index of the triangles.
+	 * @param indexCount  The number of indices of the triangles.
+	 */
+	static void optimizeOverdraw(const std::vector<MeshVertex> &vertices, std::vector<uint32_t> &indices, const uint32_t &firstIndex, const uint32_t &indexCount)
+	{
+		const auto trianglesCount = indexCount / 3;
+		if (trianglesCount == 0)
+		{
+			return;
+		}
+
+		// Find the hard boundaries, where all the vertices of a triangle missed the cache.
+		std::vector<uint32_t> clusterStarts({});
+		std::vector<uint32_t> cacheTimes(vertices.size(), 0);
+		uint32_t misses = 0;
+		for (uint32_t t = 0; t < trianglesCount; t++)
+		{
+			uint32_t triangleMisses = 0;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const auto vertex = indices[firstIndex + t * 3 + i];
+				if (cacheTimes[vertex] == 0 || misses + 1 - cacheTimes[vertex] >= measuredCacheSize)
+				{
+					misses++;
+					triangleMisses++;
+					cacheTimes[vertex] = misses;
+				}
+			}
+			if (triangleMisses == 3)
+			{
+				clusterStarts.push_back(t);
+			}
+		}
+		clusterStarts.push_back(trianglesCount);
+
+		// Split the hard clusters further wherever the triangles so far miss the cache rarely enough that starting again
+		//   with an empty cache keeps the miss ratio close to the one of the whole cluster.
+		std::vector<uint32_t> softClusterStarts({});
+		for (size_t c = 0; c + 1 < clusterStarts.size(); c++)
+		{
+			const auto clusterFirstIndex = firstIndex + clusterStarts[c] * 3;
+			const auto clusterIndexCount = (clusterStarts[c + 1] - clusterStarts[c]) * 3;
+			const auto clusterAcmr = getAcmr(indices, clusterFirstIndex, clusterIndexCount, vertices.size());
+			std::fill(cacheTimes.begin(), cacheTimes.end(), 0);
+			uint32_t clusterMisses = 0, softClusterStart = clusterStarts[c];
+			softClusterStarts.push_back(softClusterStart);
+			for (auto t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+			{
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					const auto vertex = indices[firstIndex + t * 3 + i];
+					if (cacheTimes[vertex] == 0 || clusterMisses + 1 - cacheTimes[vertex] >= measuredCacheSize)
+					{
+						clusterMisses++;
+						cacheTimes[vertex] = clusterMisses;
+					}
+				}
+				if (t + 1 < clusterStarts[c + 1] && float_t(clusterMisses) / (t + 1 - softClusterStart) <= clusterAcmr * overdrawThreshold)
+				{
+					softClusterStart = t + 1;
+					softClusterStarts.push_back(softClusterStart);
+					clusterMisses = 0;
+					std::fill(cacheTimes.begin(), cacheTimes.end(), 0);
+				}
+			}
+		}
+		softClusterStarts.push_back(trianglesCount);
+
+		// Find the area weighted centre of the mesh, and the centre and normal of each cluster, sorting the clusters by how
+		//   far they face out of the centre of the mesh.
+		const auto getTriangle = [&](const uint32_t &t, glm::vec3 &center, glm::vec3 &scaledNormal) {
+			const auto &a = vertices[indices[firstIndex + t * 3]].position, &b = vertices[indices[firstIndex + t * 3 + 1]].position, &c = vertices[indices[firstIndex + t * 3 + 2]].position;
+			center = (a + b + c) / 3.0f;
+			scaledNormal = glm::cross(b - a, c - a);
+		};
+		glm::vec3 meshCenter(0.0f), center, scaledNormal;
+		auto meshArea = 0.0f;
+		for (uint32_t t = 0; t < trianglesCount; t++)
+		{
+			getTriangle(t, center, scaledNormal);
+			const auto area = glm::length(scaledNormal);
+			meshCenter += center * area;
+			meshArea += area;
+		}
+		meshCenter /= std::max(meshArea, std::numeric_limits<float_t>::min());
+
+		std::vector<std::pair<float_t, uint32_t>> clusterKeys({});
+		for (size_t c = 0; c + 1 < softClusterStarts.size(); c++)
+		{
+			glm::vec3 clusterCenter(0.0f), clusterNormal(0.0f);
+			auto clusterArea = 0.0f;
+			for (auto t = softClusterStarts[c]; t < softClusterStarts[c + 1]; t++)
+			{
+				getTriangle(t, center, scaledNormal);
+				const auto area = glm::length(scaledNormal);
+				clusterCenter += center * area;
+				clusterNormal += scaledNormal;
+				clusterArea += area;
+			}
+			clusterCenter /= std::max(clusterArea, std::numeric_limits<float_t>::min());
+			const auto normalLength = glm::length(clusterNormal);
+			clusterKeys.push_back(std::make_pair(normalLength > 0.0f ? glm::dot(clusterCenter - meshCenter, clusterNormal / normalLength) : 0.0f, c));
+		}
+		std::stable_sort(clusterKeys.begin(), clusterKeys.end(), [](const std::pair<float_t, uint32_t> &a, const std::pair<float_t, uint32_t> &b) {
+			return a.first > b.first;
+		});
+
+		std::vector<uint32_t> orderedIndices({});
+		orderedIndices.reserve(indexCount);
+		for (const auto &clusterKey : clusterKeys)
+		{
+			orderedIndices.insert(orderedIndices.end(), indices.begin() + firstIndex + softClusterStarts[clusterKey.second] * 3, indices.begin() + firstIndex + softClusterStarts[clusterKey.second + 1] * 3);
+		}
+		std::copy(orderedIndices.begin(), orderedIndices.end(), indices.begin() + firstIndex);
+	}
+
+	/**
+	 * Reorder the vertices of the mesh in the order the indices first use them, so the vertices are fetched from memory in
+	 *   order. Vertices no index uses are kept after the others.
+	 *
+	 * @param vertices  The vertices of the mesh, reordered in place.
+	 * @param indices   The indices of the mesh, changed to the new order of the vertices.
+	 */
+	static void optimizeVertexFetch(std::vector<MeshVertex> &vertices, std::vector<uint32_t> &indices)
+	{
+		const auto unused = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> vertexRemap(vertices.size(), unused);
+		std::vector<MeshVertex> orderedVertices({});
+		orderedVertices.reserve(vertices.size());
+		for (auto &index : indices)
+		{
+			if (vertexRemap[index] == unused)
+			{
+				vertexRemap[index] = orderedVertices.size();
+				orderedVertices.push_back(vertices[index]);
+			}
+			index = vertexRemap[index];
+		}
+		for (size_t v = 0; v < vertices.size(); v++)
+		{
+			if (vertexRemap[v] == unused)
+			{
+				orderedVertices.push_back(vertices[v]);
+			}
+		}
+		vertices = std::move(orderedVertices);
+	}
+};
+
+/**
+ * Class for loading mesh data from OBJ files and binary mesh files. It does not depend on OpenGL, so it can also be used
+ * by tools.
+ */
+class MeshLoader
+{
+private:
+	// The identifier of the binary mesh file format.
+	static constexpr const char *meshFileMagic = "GTMS";
+	// The version of the binary mesh file format, to be changed whenever the layout changes.
+	static const uint32_t meshFileVersion = 7;
+	// The minimum amount of work worth running a parallel task for, for each step of loading a mesh.
+	static constexpr size_t MIN_OBJ_CHUNK_SIZE = 256 * 1024;
+	static constexpr size_t MIN_MESH_ASSEMBLY_CORNERS = 32 * 1024;
+	static constexpr size_t MIN_BOUNDS_VERTICES = 64 * 1024;
+	// The most levels of detail of a mesh including the full mesh, the fewest triangles worth simplifying further, the
+	//   largest share of the triangles of the level before a new level can keep, and the largest distance of a level from
+	//   the full mesh as a share of the size of its bounding box.
+	static const size_t MAX_MESH_LODS = 4;
+	static constexpr size_t MIN_LOD_TRIANGLES = 64;
+	static constexpr float_t MAX_LOD_TRIANGLE_SHARE = 0.8f;
+	static constexpr float_t MAX_LOD_ERROR_SHARE = 0.05f;
+	// The most vertices and triangles of a meshlet, and the smallest cosine of the angle between the normals of the
+	//   triangles of a meshlet and their axis for the meshlet to be culled when it faces away.
+	static constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+	static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+	static constexpr float_t MIN_MESHLET_CONE_COSINE = 0.1f;
+
+	/**
+	 * Calculate the bounding box, bounding radius and collider bounds of the mesh from its vertices, once for every model
+	 *   using the mesh.
+	 *
+	 * @param meshData  The mesh data to calculate the bounds of.
+	 */
+	static void calculateBounds(MeshData &meshData)
+	{
+		// Start with an empty bounding box at the origin, in case there are no vertices.
+		meshData.boundsMin = meshData.vertices.empty() ? glm::vec3(0.0f) : meshData.vertices[0].position;
+		meshData.boundsMax = meshData.boundsMin;
+		meshData.boundingRadius = 0.0f;
+		meshData.axisRadius = 0.0f;
+		meshData.pillHalfHeight = 0.0f;
+
+		// Calculate the bounds of chunks of the vertices in parallel.
+		const auto chunkCount = ParallelTasks::getTaskCount(meshData.vertices.size(), MIN_BOUNDS_VERTICES);
+		std::vector<glm::vec3> chunkMins(chunkCount, meshData.boundsMin), chunkMaxs(chunkCount, meshData.boundsMax);
+		std::vector<float> chunkRadii(chunkCount, 0.0f), chunkAxisRadii(chunkCount, 0.0f);
+		ParallelTasks::runChunked(meshData.vertices.size(), MIN_BOUNDS_VERTICES, [&](const uint32_t chunkIndex, const size_t begin, const size_t end) {
+			// Iterate through the vertices of the chunk and grow the bounds to include them.
+			for (auto i = begin; i < end; i++)
+			{
+				const auto &position = meshData.vertices[i].position;
+				chunkMins[chunkIndex] = glm::min(chunkMins[chunkIndex], position);
+				chunkMaxs[chunkIndex] = glm::max(chunkMaxs[chunkIndex], position);
+				chunkRadii[chunkIndex] = std::max(chunkRadii[chunkIndex], glm::length(position));
+				chunkAxisRadii[chunkIndex] = std::max(chunkAxisRadii[chunkIndex], glm::length(glm::vec2(position.x, position.z)));
+			}
+		});
+
+		// Merge the bounds of the chunks.
+		for (uint32_t i = 0; i < chunkCount; i++)
+		{
+			meshData.boundsMin = glm::min(meshData.boundsMin, chunkMins[i]);
+			meshData.boundsMax = glm::max(meshData.boundsMax, chunkMaxs[i]);
+			meshData.boundingRadius = std::max(meshData.boundingRadius, chunkRadii[i]);
+			meshData.axisRadius = std::max(meshData.axisRadius, chunkAxisRadii[i]);
+		}
+
+		// Find the half-height of the segment of the pill, which needs the radius of the whole mesh. The rounded end covers
+		//   each vertex up to the height where its distance from the axis meets the sphere of the end.
+		std::vector<float> chunkHalfHeights(chunkCount, 0.0f);
+		ParallelTasks::runChunked(meshData.vertices.size(), MIN_BOUNDS_VERTICES, [&](const uint32_t chunkIndex, const size_t begin, const size_t end) {
+			for (auto i = begin; i < end; i++)
+			{
+				const auto &position = meshData.vertices[i].position;
+				const auto distanceFromAxis = glm::length(glm::vec2(position.x, position.z));
+				const auto endHeight = std::sqrt(std::max(meshData.axisRadius * meshData.axisRadius - distanceFromAxis * distanceFromAxis, 0.0f));
+				chunkHalfHeights[chunkIndex] = std::max(chunkHalfHeights[chunkIndex], std::abs(position.y) - endHeight);
+			}
+		});
+		for (uint32_t i = 0; i < chunkCount; i++)
+		{
+			meshData.pillHalfHeight = std::max(meshData.pillHalfHeight, chunkHalfHeights[i]);
+		}
+	}
+
+	/**
+	 * Pack the normal vector as three signed 10-bit components, in the layout of GL_INT_2_10_10_10_REV.
+	 *
+	 * @param normal  The normal vector.
+	 *
+	 * @return The packed normal vector.
+	 */
+	static uint32_t packNormal(const glm::vec3 &normal)
+	{
+		const auto packComponent = [](const float &component) {
+			return static_cast<uint32_t>(static_cast<int32_t>(std::round(glm::clamp(component, -1.0f, 1.0f) * 511.0f)) & 0x3FF);
+		};
+		return packComponent(normal.x) | packComponent(normal.y) << 10 | packComponent(normal.z) << 20;
+	}
+
+	/**
+	 * Unpack the normal vector from three signed 10-bit components.
+	 *
+	 * @param packedNormal  The packed normal vector.
+	 *
+	 * @return The normal vector.
+	 */
+	static glm::vec3 unpackNormal(const uint32_t &packedNormal)
+	{
+		// Shift each component up to the sign bit and back down, to extend its sign.
+		const auto unpackComponent = [&](const uint32_t &shift) {
+			return std::max(static_cast<int32_t>(packedNormal << (22 - shift)) >> 22, -511) / 511.0f;
+		};
+		return glm::vec3(unpackComponent(0), unpackComponent(10), unpackComponent(20));
+	}
+
+	/**
+	 * Turn the compact vertices of the mesh back into full vertices, for the parts of the game reading the mesh on the CPU.
+	 *
+	 * @param meshData  The mesh data with the compact vertices, whose full vertices are filled in.
+	 */
+	static void expandCompactVertices(MeshData &meshData)
+	{
+		const auto scale = getCompactScale(meshData.boundsMin, meshData.boundsMax);
+		meshData.vertices.resize(meshData.compactVertices.size());
+		for (size_t i = 0; i < meshData.compactVertices.size(); i++)
+		{
+			const auto &compactVertex = meshData.compactVertices[i];
+			auto &vertex = meshData.vertices[i];
+			vertex.position = meshData.boundsMin + glm::vec3(compactVertex.position[0], compactVertex.position[1], compactVertex.position[2]) / 65535.0f * scale;
+			vertex.uv = glm::vec2(compactVertex.uv[0], compactVertex.uv[1]) / 65535.0f;
+			vertex.normal = glm::normalize(unpackNormal(compactVertex.normal) * scale);
+		}
+	}
+
+	/**
+	 * Skip the spaces and tabs at the cursor.
+	 *
+	 * @param cursor  The position in the text to skip from, moved past the spaces.
+	 * @param end     The end of the text.
+	 */
+	static void skipSpaces(const char *&cursor, const char *const end)
+	{
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+		{
+			cursor++;
+		}
+	}
+
+	/**
+	 * Parse the given number of space separated numbers at the cursor.
+	 *
+	 * @param cursor  The position in the text to parse from, moved past the parsed numbers.
+	 * @param end     The end of the text.
+	 * @param values  The array to store the parsed numbers to.
+	 * @param count   The number of numbers to parse.
+	 *
+	 * @return Whether all the numbers were parsed.
+	 */
+	template <typename ValueType>
+	static bool parseValues(const char *&cursor, const char *const end, ValueType *const values, const uint32_t &count)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			skipSpaces(cursor, end);
+			const auto result = std::from_chars(cursor, end, values[i]);
+			if (result.ec != std::errc())
+			{
+				return false;
+			}
+			cursor = result.ptr;
+		}
+		return true;
+	}
+
+	/**
+	 * Parse a face corner in the "position/uv/normal" index format at the cursor.
+	 *
+	 * @param cursor  The position in the text to parse from, moved past the parsed corner.
+	 * @param end     The end of the text.
+	 * @param corner  The array to store the three indices of the corner to.
+	 *
+	 * @return Whether the corner was parsed.
+	 */
+	static bool parseFaceCorner(const char *&cursor, const char *const end, uint32_t *const corner)
+	{
+		skipSpaces(cursor, end);
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			// Indices after the first are separated by a slash.
+			if (i > 0 && (cursor >= end || *cursor++ != '/'))
+			{
+				return false;
+			}
+			const auto result = std::from_chars(cursor, end, corner[i]);
+			if (result.ec != std::errc())
+			{
+				return false;
+			}
+			cursor = result.ptr;
+		}
+		return true;
+	}
+
+	/**
+	 * Parse the lines of a chunk of an OBJ file.
+	 *
+	 * @param begin     The start of the chunk, which is the start of a line.
+	 * @param end       The end of the chunk, which is the end of a line.
+	 * @param outChunk  The chunk data to store the parsed vertex information and face corners to.
+	 *
+	 * @return Whether all the faces of the chunk were in a supported format.
+	 */
+	static bool parseObjChunk(const char *const begin, const char *const end, ObjChunkData &outChunk)
+	{
+		// Iterate through the lines of the chunk.
+		for (auto lineStart = begin; lineStart < end;)
+		{
+			// Find the end of the line, and move on to the next line after that.
+			const auto newLine = (const char *)memchr(lineStart, '\n', end - lineStart);
+			const auto lineEnd = newLine != NULL ? newLine : end;
+			auto cursor = lineStart;
+			lineStart = lineEnd + 1;
+
+			// Read the first string in the line.
+			skipSpaces(cursor, lineEnd);
+			const auto header = cursor;
+			while (cursor < lineEnd && *cursor != ' ' && *cursor != '\t')
+			{
+				cursor++;
+			}
+			const auto headerLength = cursor - header;
+
+			// If the string equals "v".
+			if (headerLength == 1 && header[0] == 'v')
+			{
+				// Line defines a vertex position data, so store it.
+				glm::vec3 vertex;
+				if (parseValues(cursor, lineEnd, &vertex.x, 3))
+				{
+					outChunk.positions.push_back(vertex);
+				}
+			}
+			// If the string equals "vt".
+			else if (headerLength == 2 && header[0] == 'v' && header[1] == 't')
+			{
+				// Line defines a vertex UV coordinates data, so store it.
+				glm::vec2 uv;
+				if (parseValues(cursor, lineEnd, &uv.x, 2))
+				{
+					outChunk.uvs.push_back(uv);
+				}
+			}
+			// If the string equals "vn".
+			else if (headerLength == 2 && header[0] == 'v' && header[1] == 'n')
+			{
+				// Line defines a vertex normal vector data, so store it.
+				glm::vec3 normal;
+				if (parseValues(cursor, lineEnd, &normal.x, 3))
+				{
+					outChunk.normals.push_back(normal);
+				}
+			}
+			// If the string equals "f".
+			else if (headerLength == 1 && header[0] == 'f')
+			{
+				// Line defines the indexes of the vertex information of the corners of a triangle or quad.
+				uint32_t corners[4][3];
+				uint32_t cornerCount = 0;
+				while (cornerCount < 4 && parseFaceCorner(cursor, lineEnd, corners[cornerCount]))
+				{
+					cornerCount++;
+				}
+				skipSpaces(cursor, lineEnd);
+				// Only triangles and quads with all three indices of every corner are supported.
+				if (cornerCount < 3 || cursor != lineEnd)
+				{
+					return false;
+				}
+				// Store the corners of the face as triangles, splitting quads into two.
+				const uint32_t triangleCorners[] = {0, 1, 2, 0, 2, 3};
+				for (uint32_t i = 0; i < (cornerCount == 4 ? 6u : 3u); i++)
+				{
+					outChunk.corners.insert(outChunk.corners.end(), corners[triangleCorners[i]], corners[triangleCorners[i]] + 3);
+				}
+			}
+			// Otherwise it's some information about the object we don't care about, so ignore the line.
+		}
+		return true;
+	}
+
+public:
+	/**
+	 * Get the size of the given file, from the asset archive if it's packed in it.
+	 *
+	 * @param filePath  The path to the file.
+	 *
+	 * @return The size of the file, or -1 if it could not be found.
+	 */
+	static int64_t getFileSize(const std::string &filePath)
+	{
+		return AssetFileSystem::getInstance().getFileSize(filePath);
+	}
+
+	/**
+	 * Get the path of the binary mesh file for the given OBJ file.
+	 *
+	 * @param objectFilePath  The file path to the OBJ file.
+	 *
+	 * @return The file path to the binary mesh file.
+	 */
+	static std::string getMeshFilePath(const std::string &objectFilePath)
+	{
+		return objectFilePath + ".mesh";
+	}
+
+	/**
+	 * Get the size of the bounding box of the mesh the compact positions are scaled to, with the flat sides counted as 1
+	 *   so the normals can still be scaled by it.
+	 *
+	 * @param boundsMin  The corner of the bounding box with the lowest coordinates.
+	 * @param boundsMax  The corner of the bounding box with the highest coordinates.
+	 *
+	 * @return The size of the bounding box.
+	 */
+	static glm::vec3 getCompactScale(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+	{
+		const auto size = boundsMax - boundsMin;
+		return glm::vec3(size.x > 0.0f ? size.x : 1.0f, size.y > 0.0f ? size.y : 1.0f, size.z > 0.0f ? size.z : 1.0f);
+	}
+
+	/**
+	 * Get the matrix turning the compact positions of the mesh, read from 0 to 1, back into object space, by scaling them
+	 *   to the size of the bounding box and moving them to its lowest corner.
+	 *
+	 * @param boundsMin  The corner of the bounding box with the lowest coordinates.
+	 * @param boundsMax  The corner of the bounding box with the highest coordinates.
+	 *
+	 * @return The vertex matrix of the compact mesh.
+	 */
+	static glm::mat4 getCompactVertexMatrix(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+	{
+		const auto scale = getCompactScale(boundsMin, boundsMax);
+		glm::mat4 vertexMatrix(1.0f);
+		vertexMatrix[0][0] = scale.x;
+		vertexMatrix[1][1] = scale.y;
+		vertexMatrix[2][2] = scale.z;
+		vertexMatrix[3] = glm::vec4(boundsMin, 1.0f);
+		return vertexMatrix;
+	}
+
+	/**
+	 * Fill in the compact vertices of the mesh, switching it to the compact format. The compact UV coordinates only cover 0
+	 *   to 1, so meshes with UV coordinates outside of it stay in the full format.
+	 *
+	 * @param meshData  The mesh data, with its full vertices and bounds.
+	 *
+	 * @return Whether the mesh was switched to the compact format.
+	 */
+	static bool compactMesh(MeshData &meshData)
+	{
+		for (const auto &vertex : meshData.vertices)
+		{
+			if (glm::any(glm::lessThan(vertex.uv, glm::vec2(0.0f))) || glm::any(glm::greaterThan(vertex.uv, glm::vec2(1.0f))))
+			{
+				return false;
+			}
+		}
+
+		const auto scale = getCompactScale(meshData.boundsMin, meshData.boundsMax);
+		const auto quantize = [](const float &value) {
+			return static_cast<uint16_t>(std::round(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+		};
+		meshData.compactVertices.resize(meshData.vertices.size());
+		for (size_t i = 0; i < meshData.vertices.size(); i++)
+		{
+			const auto &vertex = meshData.vertices[i];
+			auto &compactVertex = meshData.compactVertices[i];
+			const auto position = (vertex.position - meshData.boundsMin) / scale;
+			compactVertex.position[0] = quantize(position.x);
+			compactVertex.position[1] = quantize(position.y);
+			compactVertex.position[2] = quantize(position.z);
+			compactVertex.position[3] = 0;
+			compactVertex.uv[0] = quantize(vertex.uv.x);
+			compactVertex.uv[1] = quantize(vertex.uv.y);
+			// The vertex matrix scales the normal along with the positions, so the scale is divided out of it beforehand.
+			compactVertex.normal = packNormal(glm::normalize(vertex.normal / scale));
+		}
+		meshData.vertexFormat = MeshVertexFormat::COMPACT;
+		return true;
+	}
+
+	/**
+	 * Parse the OBJ object file into indexed mesh data, de-duplicating vertices that share their position, UV coordinates and
+	 * normal vector. The file is split into line-aligned chunks that are parsed in parallel, and the vertices are then
+	 * de-duplicated in parallel by splitting them across tasks by their position index.
+	 *
+	 * @param objectName      The name of the object being loaded.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param exitOnFailure   Whether to crash if the object file can't be parsed, instead of reporting it.
+	 *
+	 * @return The mesh data of the object, which has no indices if the object file couldn't be parsed.
+	 */
+	static MeshData parseObjFile(const std::string &objectName, const std::string &objectFilePath, const bool &exitOnFailure = true)
+	{
+		// Open the OBJ file, which is parsed where it's held without being copied.
+		AssetFile file;
+		// Check if the file is accessible.
+		if (!AssetFileSystem::getInstance().open(objectFilePath, file))
+		{
+			// Could not read the object file. Time to crash.
+			Logger::getInstance().error(objectName, "\nFailed at object 1");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return MeshData();
+		}
+
+		// Split the file into chunks, moving the end of each chunk forward to the end of its line.
+		const char *const fileStart = reinterpret_cast<const char *>(file.getData()), *const fileEnd = fileStart + file.getSize();
+		const auto chunkCount = ParallelTasks::getTaskCount(file.getSize(), MIN_OBJ_CHUNK_SIZE);
+		std::vector<const char *> chunkBoundaries({fileStart});
+		for (uint32_t i = 1; i < chunkCount; i++)
+		{
+			const auto boundary = std::max(chunkBoundaries.back(), fileStart + file.getSize() * i / chunkCount);
+			const auto newLine = (const char *)memchr(boundary, '\n', fileEnd - boundary);
+			chunkBoundaries.push_back(newLine != NULL ? newLine + 1 : fileEnd);
+		}
+		chunkBoundaries.push_back(fileEnd);
+
+		// Parse the chunks in parallel.
+		std::vector<ObjChunkData> chunks(chunkCount);
+		std::vector<char> chunksValid(chunkCount);
+		ParallelTasks::run(chunkCount, [&](const uint32_t chunkIndex) {
+			chunksValid[chunkIndex] = parseObjChunk(chunkBoundaries[chunkIndex], chunkBoundaries[chunkIndex + 1], chunks[chunkIndex]);
+		});
+		if (std::find(chunksValid.begin(), chunksValid.end(), false) != chunksValid.end())
+		{
+			// A face is formatted in a way that we can't support. Time to crash.
+			Logger::getInstance().error(objectName, "\nFailed at object 2");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return MeshData();
+		}
+
+		// Merge the chunks in order. OBJ indices refer to the whole file, so they stay valid once the chunks are concatenated.
+		ObjChunkData objData;
+		for (const auto &chunk : chunks)
+		{
+			objData.positions.insert(objData.positions.end(), chunk.positions.begin(), chunk.positions.end());
+			objData.uvs.insert(objData.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+			objData.normals.insert(objData.normals.end(), chunk.normals.begin(), chunk.normals.end());
+			objData.corners.insert(objData.corners.end(), chunk.corners.begin(), chunk.corners.end());
+		}
+
+		// De-duplicate the corners into unique vertices. Each task owns the corners whose position index falls in its partition,
+		// so identical corners always end up in the same task and no task needs to see another's vertices.
+		const uint32_t cornerCount = objData.corners.size() / 3;
+		const auto partitionCount = ParallelTasks::getTaskCount(cornerCount, MIN_MESH_ASSEMBLY_CORNERS);
+		std::vector<uint32_t> partitionIndices(cornerCount);
+		std::vector<std::vector<MeshVertex>> partitionVertices(partitionCount);
+		std::vector<char> partitionsValid(partitionCount, true);
+		ParallelTasks::run(partitionCount, [&](const uint32_t partition) {
+			// Define a map of the vertex information index triples seen so far to the index of their unique vertex in the partition.
+			std::unordered_map<uint64_t, uint32_t> uniqueVertexIndices;
+			for (uint32_t i = 0; i < cornerCount; i++)
+			{
+				// Grab the indices of the vertex information of the corner, skipping corners of other partitions.
+				const auto corner = &objData.corners[i * 3];
+				if (corner[0] % partitionCount != partition)
+				{
+					continue;
+				}
+
+				// Check if the indices point to vertex information that exists.
+				if (corner[0] == 0 || corner[0] > objData.positions.size() || corner[1] == 0 || corner[1] > objData.uvs.size() || corner[2] == 0 || corner[2] > objData.normals.size())
+				{
+					partitionsValid[partition] = false;
+					return;
+				}
+
+				// Check if a vertex with the same position, UV coordinates and normal vector was already stored, storing it if not.
+				const uint64_t vertexKey = ((uint64_t)corner[0] * objData.uvs.size() + corner[1]) * objData.normals.size() + corner[2];
+				const auto vertex = uniqueVertexIndices.try_emplace(vertexKey, partitionVertices[partition].size());
+				if (vertex.second)
+				{
+					partitionVertices[partition].push_back({objData.positions[corner[0] - 1], objData.uvs[corner[1] - 1], objData.normals[corner[2] - 1]});
+				}
+				partitionIndices[i] = vertex.first->second;
+			}
+		});
+		if (std::find(partitionsValid.begin(), partitionsValid.end(), false) != partitionsValid.end())
+		{
+			// A face refers to vertex information that doesn't exist. Time to crash.
+			Logger::getInstance().error(objectName, "\nFailed at object 3");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return MeshData();
+		}
+
+		// Lay the vertices of the partitions out one after the other, and offset the indices of each partition to match.
+		MeshData meshData;
+		std::vector<uint32_t> partitionOffsets({0});
+		for (const auto &vertices : partitionVertices)
+		{
+			meshData.vertices.insert(meshData.vertices.end(), vertices.begin(), vertices.end());
+			partitionOffsets.push_back(meshData.vertices.size());
+		}
+		meshData.indices.resize(cornerCount);
+		ParallelTasks::runChunked(cornerCount, MIN_MESH_ASSEMBLY_CORNERS, [&](const uint32_t, const size_t begin, const size_t end) {
+			for (auto i = begin; i < end; i++)
+			{
+				meshData.indices[i] = partitionOffsets[objData.corners[i * 3] % partitionCount] + partitionIndices[i];
+			}
+		});
+
+		// Calculate the bounds of the mesh now that all vertices are known, which the levels of detail are measured against.
+		calculateBounds(meshData);
+		generateLods(meshData);
+		optimizeMesh(meshData);
+		buildMeshlets(meshData);
+
+		// Return the parsed mesh data.
+		return meshData;
+	}
+
+	/**
+	 * Read the binary mesh file into the given mesh data.
+	 *
+	 * @param meshFilePath    The file path to the binary mesh file.
+	 * @param sourceFileSize  The size of the OBJ file the mesh should have been created from, or -1 to accept any.
+	 * @param vertexFormat    The format the mesh should have been asked to be stored in, only checked along with the size
+	 *                        of the OBJ file.
+	 * @param outMeshData     The mesh data to store the read mesh to.
+	 *
+	 * @return Whether the binary mesh file existed, was valid, and was read.
+	 */
+	static bool readMeshFile(const std::string &meshFilePath, const int64_t &sourceFileSize, const MeshVertexFormat &vertexFormat, MeshData &outMeshData)
+	{
+		// Open the binary mesh file.
+		AssetFile file;
+		size_t filePosition = 0;
+		// Check if the file is accessible.
+		if (!AssetFileSystem::getInstance().open(meshFilePath, file))
+		{
+			return false;
+		}
+
+		// Read the header and check that it's of the current format and created from the same OBJ file.
+		MeshFileHeader header;
+		if (!file.read(filePosition, &header, sizeof(MeshFileHeader)) ||
+				memcmp(header.magic, meshFileMagic, 4) != 0 ||
+				header.version != meshFileVersion ||
+				(sourceFileSize >= 0 && (header.sourceFileSize != static_cast<uint64_t>(sourceFileSize) || header.requestedVertexFormat != vertexFormat)))
+		{
+			// The binary mesh file is outdated or not a mesh file.
+			return false;
+		}
+
+		// Read the vertices, in the format they were stored in, indices, levels of detail and meshlets in one block each.
+		outMeshData.vertexFormat = header.vertexFormat;
+		outMeshData.indices.resize(header.indexCount);
+		outMeshData.lods.resize(header.lodCount);
+		outMeshData.meshlets.resize(header.meshletCount);
+		bool verticesRead;
+		if (header.vertexFormat == MeshVertexFormat::COMPACT)
+		{
+			outMeshData.compactVertices.resize(header.vertexCount);
+			verticesRead = file.read(filePosition, outMeshData.compactVertices.data(), sizeof(CompactMeshVertex) * header.vertexCount);
+		}
+		else
+		{
+			outMeshData.vertices.resize(header.vertexCount);
+			verticesRead = file.read(filePosition, outMeshData.vertices.data(), sizeof(MeshVertex) * header.vertexCount);
+		}
+		const auto indicesRead = verticesRead && file.read(filePosition, outMeshData.indices.data(), sizeof(uint32_t) * header.indexCount);
+		const auto lodsRead = indicesRead && file.read(filePosition, outMeshData.lods.data(), sizeof(MeshLod) * header.lodCount);
+		const auto meshletsRead = lodsRead && file.read(filePosition, outMeshData.meshlets.data(), sizeof(Meshlet) * header.meshletCount);
+		// Check if the file was truncated.
+		if (!meshletsRead)
+		{
+			return false;
+		}
+
+		// Store the precomputed bounds of the mesh.
+		outMeshData.boundsMin = header.boundsMin;
+		outMeshData.boundsMax = header.boundsMax;
+		outMeshData.boundingRadius = header.boundingRadius;
+		outMeshData.axisRadius = header.axisRadius;
+		outMeshData.pillHalfHeight = header.pillHalfHeight;
+		if (header.vertexFormat == MeshVertexFormat::COMPACT)
+		{
+			expandCompactVertices(outMeshData);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Write the mesh data into a binary mesh file.
+	 *
+	 * @param meshFilePath           The file path to the binary mesh file.
+	 * @param sourceFileSize         The size of the OBJ file the mesh was created from.
+	 * @param requestedVertexFormat  The format the mesh was asked to be stored in.
+	 * @param meshData               The mesh data to write, with its vertices in the format they're stored in.
+	 *
+	 * @return Whether the binary mesh file was written.
+	 */
+	static bool writeMeshFile(const std::string &meshFilePath, const int64_t &sourceFileSize, const MeshVertexFormat &requestedVertexFormat, const MeshData &meshData)
+	{
+		// Write to a temporary file unique to the thread, so concurrent loads never read or write a partially written mesh file.
+		const auto temporaryFilePath = meshFilePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		// Open the temporary file for writing.
+		const auto file = fopen(temporaryFilePath.c_str(), "wb");
+		// Check if the file is writable.
+		if (file == NULL)
+		{
+			return false;
+		}
+
+		// Fill in the header of the mesh.
+		MeshFileHeader header;
+		memcpy(header.magic, meshFileMagic, 4);
+		header.version = meshFileVersion;
+		header.sourceFileSize = sourceFileSize;
+		header.vertexCount = meshData.vertices.size();
+		header.indexCount = meshData.indices.size();
+		header.boundsMin = meshData.boundsMin;
+		header.boundsMax = meshData.boundsMax;
+		header.boundingRadius = meshData.boundingRadius;
+		header.axisRadius = meshData.axisRadius;
+		header.pillHalfHeight = meshData.pillHalfHeight;
+		header.requestedVertexFormat = requestedVertexFormat;
+		header.vertexFormat = meshData.vertexFormat;
+		header.lodCount = meshData.lods.size();
+		header.meshletCount = meshData.meshlets.size();
+
+		// Write the header, vertices in the format they're stored in, indices, levels of detail and meshlets.
+		const auto written = fwrite(&header, sizeof(MeshFileHeader), 1, file) == 1 &&
+												 (meshData.vertexFormat == MeshVertexFormat::COMPACT
+															? fwrite(meshData.compactVertices.data(), sizeof(CompactMeshVertex), header.vertexCount, file)
+															: fwrite(meshData.vertices.data(), sizeof(MeshVertex), header.vertexCount, file)) == header.vertexCount &&
+												 fwrite(meshData.indices.data(), sizeof(uint32_t), header.indexCount, file) == header.indexCount &&
+												 fwrite(meshData.lods.data(), sizeof(MeshLod), header.lodCount, file) == header.lodCount &&
+												 fwrite(meshData.meshlets.data(), sizeof(Meshlet), header.meshletCount, file) == header.meshletCount;
+		fclose(file);
+
+		// Remove partially written files, so they don't get read later.
+		if (!written)
+		{
+			remove(temporaryFilePath.c_str());
+			return false;
+		}
+
+		// Replace the binary mesh file with the written file.
+		remove(meshFilePath.c_str());
+		return rename(temporaryFilePath.c_str(), meshFilePath.c_str()) == 0;
+	}
+
+	/**
+	 * Generate the levels of detail of the mesh, each with about half the triangles of the level before, until simplifying
+	 *   further would keep most of the triangles or move the surface too far. The indices of each level are added after the
+	 *   ones of the full mesh, using the same vertices.
+	 *
+	 * @param meshData  The mesh data to generate the levels of detail of, with its full mesh in its indices.
+	 */
+	static void generateLods(MeshData &meshData)
+	{
+		meshData.lods.clear();
+		meshData.lods.push_back({0, static_cast<uint32_t>(meshData.indices.size()), 0.0f});
+		const auto maxError = glm::length(meshData.boundsMax - meshData.boundsMin) * MAX_LOD_ERROR_SHARE;
+
+		std::vector<uint32_t> lodIndices(meshData.indices);
+		while (meshData.lods.size() < MAX_MESH_LODS && lodIndices.size() / 3 >= MIN_LOD_TRIANGLES)
+		{
+			// Simplify the level before rather than the full mesh, which is faster and keeps the levels consistent, adding up
+			//   the errors of the levels to bound the distance from the full mesh.
+			const auto error = meshData.lods.back().error;
+			auto lodError = 0.0f;
+			const auto simplifiedIndices = MeshSimplifier::simplify(meshData.vertices, lodIndices, lodIndices.size() / 6 * 3, maxError - error, lodError);
+			if (simplifiedIndices.size() > lodIndices.size() * MAX_LOD_TRIANGLE_SHARE)
+			{
+				break;
+			}
+
+			meshData.lods.push_back({static_cast<uint32_t>(meshData.indices.size()), static_cast<uint32_t>(simplifiedIndices.size()), error + lodError});
+			meshData.indices.insert(meshData.indices.end(), simplifiedIndices.begin(), simplifiedIndices.end());
+			lodIndices = simplifiedIndices;
+		}
+	}
+
+	/**
+	 * Optimize the order of the triangles of each level of detail of the mesh for the vertex cache and overdraw, and the
+	 *   order of the vertices for fetching them, measuring the vertex cache miss ratio of the full mesh before and after.
+	 *
+	 * @param meshData  The mesh data to optimize, with its levels of detail generated.
+	 */
+	static void optimizeMesh(MeshData &meshData)
+	{
+		meshData.acmrBefore = MeshOptimizer::getAcmr(meshData.indices, meshData.lods.front().firstIndex, meshData.lods.front().indexCount, meshData.vertices.size());
+		ParallelTasks::runChunked(meshData.lods.size(), 1, [&](const uint32_t, const size_t begin, const size_t end) {
+			for (auto i = begin; i < end; i++)
+			{
+				const auto &lod = meshData.lods[i];
+				MeshOptimizer::optimizeVertexCache(meshData.indices, lod.firstIndex, lod.indexCount, meshData.vertices.size());
+				MeshOptimizer::optimizeOverdraw(meshData.vertices, meshData.indices, lod.firstIndex, lod.indexCount);
+			}
+		});
+		// The full mesh comes first in the indices, so the vertices end up in the order it uses them.
+		MeshOptimizer::optimizeVertexFetch(meshData.vertices, meshData.indices);
+		meshData.acmrAfter = MeshOptimizer::getAcmr(meshData.indices, meshData.lods.front().firstIndex, meshData.lods.front().indexCount, meshData.vertices.size());
+	}
+
+	/**
+	 * Split the full mesh into meshlets, each taking the triangles in the order of the indices until the next one would use
+	 *   too many vertices or make too many triangles. The triangles are ordered for the vertex cache by then, so those next to
+	 *   each other in the indices are mostly next to each other on the mesh, and each meshlet stays a range of the indices.
+	 *
+	 * @param meshData  The mesh data to build the meshlets of, with its full mesh optimized.
+	 */
+	static void buildMeshlets(MeshData &meshData)
+	{
+		meshData.meshlets.clear();
+		if (meshData.lods.empty())
+		{
+			return;
+		}
+		const auto &fullLod = meshData.lods.front();
+		// The meshlet each vertex was last used by, so the vertices of the meshlet being built are counted once.
+		std::vector<uint32_t> vertexMeshlets(meshData.vertices.size(), std::numeric_limits<uint32_t>::max());
+		uint32_t meshletFirstIndex = fullLod.firstIndex, meshletVertexCount = 0;
+		const auto addMeshlet = [&](const uint32_t &endIndex) {
+			if (endIndex == meshletFirstIndex)
+			{
+				return;
+			}
+			// The sphere is around the centre of the box around the vertices of the meshlet.
+			auto minCorner = meshData.vertices[meshData.indices[meshletFirstIndex]].position, maxCorner = minCorner;
+			for (auto i = meshletFirstIndex; i < endIndex; i++)
+			{
+				minCorner = glm::min(minCorner, meshData.vertices[meshData.indices[i]].position);
+				maxCorner = glm::max(maxCorner, meshData.vertices[meshData.indices[i]].position);
+			}
+			const auto center = (minCorner + maxCorner) * 0.5f;
+			auto radius = 0.0f;
+			// The axis of the cone is the average of the normals of the triangles, which are turned the way the front faces are
+			//   wound, and the triangles without an area are left out.
+			std::vector<glm::vec3> triangleNormals;
+			for (auto i = meshletFirstIndex; i < endIndex; i += 3)
+			{
+				const auto &a = meshData.vertices[meshData.indices[i]].position;
+				const auto &b = meshData.vertices[meshData.indices[i + 1]].position;
+				const auto &c = meshData.vertices[meshData.indices[i + 2]].position;
+				radius = std::max(radius, std::max(glm::length(a - center), std::max(glm::length(b - center), glm::length(c - center))));
+				const auto normal = glm::cross(b - a, c - a);
+				if (glm::length(normal) > 0.0f)
+				{
+					triangleNormals.push_back(glm::normalize(normal));
+				}
+			}
+			auto axis = glm::vec3(0.0f);
+			for (const auto &normal : triangleNormals)
+			{
+				axis += normal;
+			}
+			auto normalCone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			if (glm::length(axis) > 0.0f)
+			{
+				axis = glm::normalize(axis);
+				auto minCosine = 1.0f;
+				for (const auto &normal : triangleNormals)
+				{
+					minCosine = std::min(minCosine, glm::dot(normal, axis));
+				}
+				// The meshlet faces away from every point the direction to the meshlet is within 90 degrees less the spread of
+				//   the normals from the axis, whose cosine is the sine of the spread.
+				normalCone = glm::vec4(axis, minCosine > MIN_MESHLET_CONE_COSINE ? std::sqrt(1.0f - minCosine * minCosine) : 1.0f);
+			}
+			meshData.meshlets.push_back({meshletFirstIndex, endIndex - meshletFirstIndex, glm::vec4(center, radius), normalCone});
+		};
+
+		for (auto i = fullLod.firstIndex; i < fullLod.firstIndex + fullLod.indexCount; i += 3)
+		{
+			// Start a new meshlet if the triangle would need too many vertices or triangles in the one being built.
+			for (auto attempt = 0; attempt < 2; attempt++)
+			{
+				const auto meshletIndex = static_cast<uint32_t>(meshData.meshlets.size());
+				uint32_t newVertexCount = 0;
+				for (auto corner = 0; corner < 3; corner++)
+				{
+					const auto vertex = meshData.indices[i + corner];
+					newVertexCount += vertexMeshlets[vertex] != meshletIndex && (corner < 1 || meshData.indices[i] != vertex) && (corner < 2 || meshData.indices[i + 1] != vertex);
+				}
+				if (meshletVertexCount + newVertexCount <= MAX_MESHLET_VERTICES && (i - meshletFirstIndex) / 3 < MAX_MESHLET_TRIANGLES)
+				{
+					for (auto corner = 0; corner < 3; corner++)
+					{
+						vertexMeshlets[meshData.indices[i + corner]] = meshletIndex;
+					}
+					meshletVertexCount += newVertexCount;
+					break;
+				}
+				addMeshlet(i);
+				meshletFirstIndex = i;
+				meshletVertexCount = 0;
+			}
+		}
+		addMeshlet(fullLod.firstIndex + fullLod.indexCount);
+	}
+
+	/**
+	 * Load the mesh of the OBJ object file, using the binary mesh file next to it if it's up to date, and creating it if not.
+	 * If the OBJ file is missing, an existing binary mesh file is used as is.
+	 *
+	 * @param objectName      The name of the object being loaded.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format to store the vertices of the mesh in, where the mesh allows it.
+	 *
+	 * @return The mesh data of the object.
+	 */
+	static MeshData loadMesh(const std::string &objectName, const std::string &objectFilePath, const MeshVertexFormat &vertexFormat = MeshVertexFormat::FULL)
+	{
+		// Get the size of the OBJ file, and the path to its binary mesh file.
+		const auto sourceFileSize = getFileSize(objectFilePath);
+		const auto meshFilePath = getMeshFilePath(objectFilePath);
+
+		// Try reading the binary mesh file first.
+		MeshData meshData;
+		if (readMeshFile(meshFilePath, sourceFileSize, vertexFormat, meshData))
+		{
+			return meshData;
+		}
+
+		// No usable binary mesh file, so parse the OBJ file.
+		meshData = parseObjFile(objectName, objectFilePath);
+		if (vertexFormat == MeshVertexFormat::COMPACT)
+		{
+			compactMesh(meshData);
+		}
+		// Write the binary mesh file for the next load. It's only a cache, so failing to write it is fine.
+		writeMeshFile(meshFilePath, sourceFileSize, vertexFormat, meshData);
+
+		return meshData;
+	}
+
+	/**
+	 * Load the mesh of the OBJ object file after it changed, parsing the OBJ file even if the binary mesh file looks up to
+	 *   date, since an edit can leave the size of the OBJ file the same. The binary mesh file is written again with it.
+	 *   An OBJ file that can't be parsed, such as one still being written, is reported instead of crashing.
+	 *
+	 * @param objectName      The name of the object being reloaded.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format to store the vertices of the mesh in, where the mesh allows it.
+	 *
+	 * @return The mesh data of the object, which has no indices if the OBJ file couldn't be parsed.
+	 */
+	static MeshData reloadMesh(const std::string &objectName, const std::string &objectFilePath, const MeshVertexFormat &vertexFormat = MeshVertexFormat::FULL)
+	{
+		auto meshData = parseObjFile(objectName, objectFilePath, false);
+		if (meshData.indices.empty())
+		{
+			return meshData;
+		}
+		if (vertexFormat == MeshVertexFormat::COMPACT)
+		{
+			compactMesh(meshData);
+		}
+		writeMeshFile(getMeshFilePath(objectFilePath), getFileSize(objectFilePath), vertexFormat, meshData);
+		return meshData;
+	}
+};
+
+#endif
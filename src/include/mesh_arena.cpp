@@ -0,0 +1,357 @@
+#ifndef INCLUDE_MESH_ARENA_CPP
+#define INCLUDE_MESH_ARENA_CPP
+
+#include <vector>
+#include <map>
+#include <cstddef>
+
+#include <GL/glew.h>
+
+#include "gl_state.cpp"
+#include "common.cpp"
+#include "constants.cpp"
+#include "mesh.cpp"
+#include "gl_debug.cpp"
+#include "window.cpp"
+
+/**
+ * Structure for the range of the mesh arena buffers holding the vertices and indices of a mesh. The indices are relative
+ *   to the first vertex of the mesh, so they're drawn with the base vertex added to them.
+ */
+struct MeshAllocation
+{
+  // The format of the vertices of the mesh, which picks the arena holding them.
+  MeshVertexFormat vertexFormat;
+  // The index of the first vertex of the mesh in the vertex buffer, and the number of vertices.
+  GLint baseVertex;
+  uint32_t vertexCount;
+  // The index of the first index of the mesh in the index buffer, and the number of indices.
+  uint32_t firstIndex;
+  uint32_t indexCount;
+};
+
+/**
+ * Class for handing out ranges of a fixed number of elements, first fit, merging the ranges given back with the free
+ *   ranges next to them.
+ */
+class RangeAllocator
+{
+private:
+  // The number of elements the ranges are handed out from.
+  uint32_t capacity;
+  // The sizes of the free ranges, by their first element.
+  std::map<uint32_t, uint32_t> freeRanges;
+
+public:
+  RangeAllocator(const uint32_t &capacity)
+      : capacity(capacity),
+        freeRanges({{0, capacity}}) {}
+
+  const uint32_t &getCapacity() const
+  {
+    return capacity;
+  }
+
+  /**
+   * Hand out a range of the given number of elements.
+   * 
+   * @param size   The number of elements.
+   * @param first  The first element of the range, set if one was free.
+   * 
+   * @return Whether a free range big enough was found.
+   */
+  bool allocate(const uint32_t &size, uint32_t &first)
+  {
+    if (size == 0)
+    {
+      first = 0;
+      return true;
+    }
+    for (auto freeRangeIt = freeRanges.begin(); freeRangeIt != freeRanges.end(); ++freeRangeIt)
+    {
+      if (freeRangeIt->second < size)
+      {
+        continue;
+      }
+      first = freeRangeIt->first;
+      // Keep the rest of the free range free.
+      const auto remainingSize = freeRangeIt->second - size;
+      freeRanges.erase(freeRangeIt);
+      if (remainingSize > 0)
+      {
+        freeRanges[first + size] = remainingSize;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Give back a range handed out before, merging it with the free ranges right before and after it.
+   * 
+   * @param first  The first element of the range.
+   * @param size   The number of elements.
+   */
+  void free(uint32_t first, uint32_t size)
+  {
+    if (size == 0)
+    {
+      return;
+    }
+    const auto nextRangeIt = freeRanges.find(first + size);
+    if (nextRangeIt != freeRanges.end())
+    {
+      size += nextRangeIt->second;
+      freeRanges.erase(nextRangeIt);
+    }
+    auto previousRangeIt = freeRanges.lower_bound(first);
+    if (previousRangeIt != freeRanges.begin() && (--previousRangeIt)->first + previousRangeIt->second == first)
+    {
+      first = previousRangeIt->first;
+      size += previousRangeIt->second;
+    }
+    freeRanges[first] = size;
+  }
+
+  /**
+   * Grow the number of elements the ranges are handed out from, with the new elements free.
+   * 
+   * @param newCapacity  The new number of elements, more than the current one.
+   */
+  void grow(const uint32_t &newCapacity)
+  {
+    const auto oldCapacity = capacity;
+    capacity = newCapacity;
+    free(oldCapacity, newCapacity - oldCapacity);
+  }
+};
+
+/**
+ * Class for holding the vertices and indices of every mesh in one interleaved vertex buffer and one index buffer, recorded
+ *   in one vertex array object. Since the meshes share their buffers, switching between them needs no rebinding, and
+ *   meshes can be drawn together by the offsets of their ranges, with base vertex and multi-draw indirect calls. The
+ *   buffers grow into new ones twice as big when a mesh doesn't fit, with the vertex array pointed at the new ones. Each
+ *   arena holds the vertices of one format, which its vertex array reads them in.
+ */
+class MeshArena
+{
+private:
+  // The format of the vertices held by the arena.
+  const MeshVertexFormat vertexFormat;
+  // The IDs of the buffers holding the vertices and indices of the meshes, and of the vertex array recording them, which
+  //   are created with the first mesh, once there's a GL context.
+  GLuint vertexBufferId;
+  GLuint indexBufferId;
+  GLuint vertexArrayId;
+  // The allocators of the ranges of vertices and indices of the buffers.
+  RangeAllocator vertexAllocator;
+  RangeAllocator indexAllocator;
+
+  /**
+   * Create a buffer holding the given number of bytes, copying the bytes of the old buffer into its start.
+   * 
+   * @param size         The size of the buffer in bytes.
+   * @param oldBufferId  The ID of the old buffer, or 0 if there's nothing to copy.
+   * @param oldSize      The size of the old buffer in bytes.
+   * 
+   * @return The ID of the buffer.
+   */
+  static GLuint createBuffer(const size_t &size, const GLuint &oldBufferId = 0, const size_t &oldSize = 0)
+  {
+    GLuint bufferId;
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      // Allocate immutable storage that can still be written to, and copy into it by name, leaving the bindings alone.
+      glCreateBuffers(1, &bufferId);
+      glNamedBufferStorage(bufferId, size, NULL, GL_DYNAMIC_STORAGE_BIT);
+      if (oldBufferId != 0)
+      {
+        glCopyNamedBufferSubData(oldBufferId, bufferId, 0, 0, oldSize);
+        GlStateCache::getInstance().deleteBuffers(1, &oldBufferId);
+      }
+      return bufferId;
+    }
+    glGenBuffers(1, &bufferId);
+    // Bind the buffer for the copy instead of as an element buffer, since that binding belongs to the bound vertex array.
+    GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STATIC_DRAW);
+    if (oldBufferId != 0)
+    {
+      GlStateCache::getInstance().bindBuffer(GL_COPY_READ_BUFFER, oldBufferId);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+      GlStateCache::getInstance().bindBuffer(GL_COPY_READ_BUFFER, 0);
+      // The driver keeps the old buffer until the commands drawing with it are done.
+      GlStateCache::getInstance().deleteBuffers(1, &oldBufferId);
+    }
+    GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return bufferId;
+  }
+
+  /**
+   * Point the vertex array at the current buffers.
+   */
+  void attachBuffers()
+  {
+    GlStateCache::getInstance().bindVertexArray(vertexArrayId);
+    // Attach the interleaved vertex positions, UV coordinates and normal vectors to their fixed attribute locations.
+    if (vertexFormat == MeshVertexFormat::COMPACT)
+    {
+      // The compact vertices are read as fractions of their range, which the shaders get as the same floats as the full
+      //   vertices, with the positions still to be moved into the bounding box of the mesh by its vertex matrix.
+      VertexArray::attachAttribute(VERTEX_POSITION_ATTRIBUTE_LOCATION, vertexBufferId, 3, sizeof(CompactMeshVertex), offsetof(CompactMeshVertex, position), GL_UNSIGNED_SHORT, GL_TRUE);
+      VertexArray::attachAttribute(VERTEX_UV_ATTRIBUTE_LOCATION, vertexBufferId, 2, sizeof(CompactMeshVertex), offsetof(CompactMeshVertex, uv), GL_UNSIGNED_SHORT, GL_TRUE);
+      VertexArray::attachAttribute(VERTEX_NORMAL_ATTRIBUTE_LOCATION, vertexBufferId, 4, sizeof(CompactMeshVertex), offsetof(CompactMeshVertex, normal), GL_INT_2_10_10_10_REV, GL_TRUE);
+    }
+    else
+    {
+      VertexArray::attachAttribute(VERTEX_POSITION_ATTRIBUTE_LOCATION, vertexBufferId, 3, sizeof(MeshVertex), offsetof(MeshVertex, position));
+      VertexArray::attachAttribute(VERTEX_UV_ATTRIBUTE_LOCATION, vertexBufferId, 2, sizeof(MeshVertex), offsetof(MeshVertex, uv));
+      VertexArray::attachAttribute(VERTEX_NORMAL_ATTRIBUTE_LOCATION, vertexBufferId, 3, sizeof(MeshVertex), offsetof(MeshVertex, normal));
+    }
+    // Attach the vertex indices as the element buffer of the vertex array object.
+    VertexArray::attachIndexBuffer(indexBufferId);
+    GlStateCache::getInstance().bindVertexArray(0);
+
+    // Name the buffers and the vertex array for GPU captures. The objects share them, so they're named after the arena.
+    const std::string arenaName = vertexFormat == MeshVertexFormat::COMPACT ? "Compact Mesh Arena" : "Full Mesh Arena";
+    GpuDebugLabels::labelObject(GL_VERTEX_ARRAY, vertexArrayId, arenaName);
+    GpuDebugLabels::labelObject(GL_BUFFER, vertexBufferId, arenaName + " Vertices");
+    GpuDebugLabels::labelObject(GL_BUFFER, indexBufferId, arenaName + " Indices");
+  }
+
+  /**
+   * Hand out a range of the allocator, growing the buffer it's for until the range fits.
+   * 
+   * @param allocator    The allocator of the ranges of the buffer.
+   * @param bufferId     The ID of the buffer, replaced with the grown one.
+   * @param elementSize  The size of the elements of the buffer in bytes.
+   * @param size         The number of elements of the range.
+   * 
+   * @return The first element of the range.
+   */
+  static uint32_t allocate(RangeAllocator &allocator, GLuint &bufferId, const size_t &elementSize, const uint32_t &size)
+  {
+    uint32_t first;
+    while (!allocator.allocate(size, first))
+    {
+      const auto oldCapacity = allocator.getCapacity();
+      allocator.grow(oldCapacity * 2);
+      bufferId = createBuffer(elementSize * allocator.getCapacity(), bufferId, elementSize * oldCapacity);
+    }
+    return first;
+  }
+
+  /**
+   * Write the data to the buffer.
+   * 
+   * @param bufferId  The ID of the buffer.
+   * @param offset    The offset of the data in the buffer in bytes.
+   * @param size      The size of the data in bytes.
+   * @param data      The data.
+   */
+  static void write(const GLuint &bufferId, const size_t &offset, const size_t &size, const void *data)
+  {
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      glNamedBufferSubData(bufferId, offset, size, data);
+      return;
+    }
+    GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+    GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+public:
+  MeshArena(const MeshVertexFormat &vertexFormat)
+      : vertexFormat(vertexFormat),
+        vertexBufferId(0),
+        indexBufferId(0),
+        vertexArrayId(0),
+        vertexAllocator(MESH_ARENA_VERTEX_CAPACITY),
+        indexAllocator(MESH_ARENA_INDEX_CAPACITY) {}
+
+  MeshArena(const MeshArena &) = delete;
+
+  /**
+   * Get the size of a vertex of the given format.
+   * 
+   * @param vertexFormat  The format of the vertex.
+   * 
+   * @return The size of the vertex in bytes.
+   */
+  static size_t getVertexSize(const MeshVertexFormat &vertexFormat)
+  {
+    return vertexFormat == MeshVertexFormat::COMPACT ? sizeof(CompactMeshVertex) : sizeof(MeshVertex);
+  }
+
+  /**
+   * Get the ID of the vertex array object every mesh in the arena is drawn with.
+   * 
+   * @return The vertex array object ID.
+   */
+  const GLuint &getVertexArrayId() const
+  {
+    return vertexArrayId;
+  }
+
+  /**
+   * Get the GPU memory the buffers of the arena take up, including the ranges that are still free.
+   * 
+   * @return The size of the buffers, in bytes.
+   */
+  uint64_t getCapacitySize() const
+  {
+    return uint64_t(vertexAllocator.getCapacity()) * getVertexSize(vertexFormat) + uint64_t(indexAllocator.getCapacity()) * sizeof(uint32_t);
+  }
+
+  /**
+   * Copy the vertices and indices of the mesh into the arena.
+   * 
+   * @param meshData  The mesh, with its vertices in the format of the arena.
+   * 
+   * @return The ranges of the arena holding the mesh.
+   */
+  MeshAllocation add(const MeshData &meshData)
+  {
+    // Create the buffers and the vertex array with the first mesh.
+    if (vertexArrayId == 0)
+    {
+      vertexBufferId = createBuffer(getVertexSize(vertexFormat) * vertexAllocator.getCapacity());
+      indexBufferId = createBuffer(sizeof(uint32_t) * indexAllocator.getCapacity());
+      vertexArrayId = VertexArray::create();
+      attachBuffers();
+    }
+
+    const auto oldVertexBufferId = vertexBufferId, oldIndexBufferId = indexBufferId;
+    const auto vertexSize = getVertexSize(vertexFormat);
+    MeshAllocation meshAllocation;
+    meshAllocation.vertexFormat = vertexFormat;
+    meshAllocation.vertexCount = meshData.vertices.size();
+    meshAllocation.baseVertex = allocate(vertexAllocator, vertexBufferId, vertexSize, meshAllocation.vertexCount);
+    meshAllocation.indexCount = meshData.indices.size();
+    meshAllocation.firstIndex = allocate(indexAllocator, indexBufferId, sizeof(uint32_t), meshAllocation.indexCount);
+    if (vertexBufferId != oldVertexBufferId || indexBufferId != oldIndexBufferId)
+    {
+      attachBuffers();
+    }
+
+    const auto vertexData = vertexFormat == MeshVertexFormat::COMPACT ? static_cast<const void *>(meshData.compactVertices.data()) : meshData.vertices.data();
+    write(vertexBufferId, vertexSize * meshAllocation.baseVertex, vertexSize * meshAllocation.vertexCount, vertexData);
+    write(indexBufferId, sizeof(uint32_t) * meshAllocation.firstIndex, sizeof(uint32_t) * meshAllocation.indexCount, meshData.indices.data());
+    return meshAllocation;
+  }
+
+  /**
+   * Give back the ranges of the arena holding a mesh, for other meshes to be copied into. Writing over them is ordered
+   *   after the commands already drawing the mesh, so it can still be drawn by the frames in flight.
+   * 
+   * @param meshAllocation  The ranges holding the mesh.
+   */
+  void remove(const MeshAllocation &meshAllocation)
+  {
+    vertexAllocator.free(meshAllocation.baseVertex, meshAllocation.vertexCount);
+    indexAllocator.free(meshAllocation.firstIndex, meshAllocation.indexCount);
+  }
+};
+
+#endif
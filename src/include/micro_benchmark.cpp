@@ -0,0 +1,162 @@
+#ifndef INCLUDE_MICRO_BENCHMARK_CPP
+#define INCLUDE_MICRO_BENCHMARK_CPP
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// The time each batch of iterations of a micro-benchmark is run for at least, in seconds, and the number of batches
+// timed, whose median is reported so a batch slowed down by the OS doesn't skew the result.
+const double_t MICRO_BENCHMARK_BATCH_TIME = 0.02;
+const uint32_t MICRO_BENCHMARK_BATCHES_COUNT = 15;
+
+// The function running the given number of iterations of a micro-benchmark, returning a checksum of what it computed so
+// the compiler can't leave the work out.
+typedef std::function<uint64_t(const uint64_t &iterations)> MicroBenchmarkFunction;
+
+/**
+ * Structure for a micro-benchmark of a hot function of the engine.
+ */
+struct MicroBenchmark
+{
+  // The name of the micro-benchmark, grouped by the subsystem it measures, such as "collision/box-sphere".
+  std::string name;
+  // Whether the micro-benchmark needs the window and its GL context.
+  bool needsContext;
+  // The function setting up what the micro-benchmark works on, outside of the timing, returning the function running it.
+  std::function<MicroBenchmarkFunction()> prepare;
+};
+
+/**
+ * Structure for the time a micro-benchmark took per iteration.
+ */
+struct MicroBenchmarkResult
+{
+  // The name of the micro-benchmark.
+  std::string name;
+  // The number of iterations in each batch.
+  uint64_t iterations;
+  // The median, the fastest and the slowest time per iteration of the batches, in nanoseconds.
+  double_t medianTime;
+  double_t minTime;
+  double_t maxTime;
+};
+
+/**
+ * Class for running the micro-benchmarks of the hot functions of the engine one at a time, so each function can be judged
+ *   on its own rather than by the noise of whole frames. The number of iterations of each batch is doubled until a batch
+ *   takes long enough to be timed reliably, and the batches are then repeated to report the median time per iteration.
+ */
+class MicroBenchmarkRunner
+{
+private:
+  // The registered micro-benchmarks, in the order they're run.
+  std::vector<MicroBenchmark> benchmarks;
+  // The checksums of the micro-benchmarks, written so the compiler has to compute them.
+  volatile uint64_t checksumSink;
+
+  /**
+   * Check if the micro-benchmark is selected by the prefixes of the names to run.
+   *
+   * @param benchmark  The micro-benchmark.
+   * @param prefixes   The prefixes of the names of the micro-benchmarks to run, or none for every micro-benchmark.
+   *
+   * @return Whether the micro-benchmark is selected.
+   */
+  static bool isSelected(const MicroBenchmark &benchmark, const std::vector<std::string> &prefixes)
+  {
+    return prefixes.empty() || std::any_of(prefixes.begin(), prefixes.end(), [&](const std::string &prefix) { return benchmark.name.compare(0, prefix.size(), prefix) == 0; });
+  }
+
+  /**
+   * Time a batch of iterations of a micro-benchmark.
+   *
+   * @param function    The function running the micro-benchmark.
+   * @param iterations  The number of iterations.
+   *
+   * @return The time the batch took, in seconds.
+   */
+  double_t timeBatch(const MicroBenchmarkFunction &function, const uint64_t &iterations)
+  {
+    const auto startTime = std::chrono::steady_clock::now();
+    checksumSink = checksumSink + function(iterations);
+    return std::chrono::duration<double_t>(std::chrono::steady_clock::now() - startTime).count();
+  }
+
+public:
+  MicroBenchmarkRunner()
+      : benchmarks({}),
+        checksumSink(0) {}
+
+  /**
+   * Register a micro-benchmark.
+   *
+   * @param name          The name of the micro-benchmark.
+   * @param needsContext  Whether the micro-benchmark needs the window and its GL context.
+   * @param prepare       The function setting up the micro-benchmark, returning the function running it.
+   */
+  void add(const std::string &name, const bool &needsContext, const std::function<MicroBenchmarkFunction()> &prepare)
+  {
+    benchmarks.push_back({name, needsContext, prepare});
+  }
+
+  /**
+   * Check if any of the selected micro-benchmarks needs the window and its GL context.
+   *
+   * @param prefixes  The prefixes of the names of the micro-benchmarks to run, or none for every micro-benchmark.
+   *
+   * @return Whether the GL context is needed.
+   */
+  bool needsContext(const std::vector<std::string> &prefixes) const
+  {
+    return std::any_of(benchmarks.begin(), benchmarks.end(), [&](const MicroBenchmark &benchmark) { return benchmark.needsContext && isSelected(benchmark, prefixes); });
+  }
+
+  /**
+   * Run the selected micro-benchmarks, printing the time per iteration of each of them once it's done.
+   *
+   * @param prefixes  The prefixes of the names of the micro-benchmarks to run, or none for every micro-benchmark.
+   *
+   * @return The results of the micro-benchmarks that ran.
+   */
+  std::vector<MicroBenchmarkResult> run(const std::vector<std::string> &prefixes)
+  {
+    std::vector<MicroBenchmarkResult> results({});
+    std::cout << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(14) << "Median ns" << std::setw(14) << "Min ns"
+              << std::setw(14) << "Max ns" << std::setw(14) << "Iterations" << std::endl;
+    for (const auto &benchmark : benchmarks)
+    {
+      if (!isSelected(benchmark, prefixes))
+      {
+        continue;
+      }
+      const auto function = benchmark.prepare();
+
+      // Double the iterations of a batch until it runs for long enough, which also warms up the caches of the function.
+      uint64_t iterations = 1;
+      while (timeBatch(function, iterations) < MICRO_BENCHMARK_BATCH_TIME)
+      {
+        iterations *= 2;
+      }
+      std::vector<double_t> iterationTimes({});
+      for (uint32_t i = 0; i < MICRO_BENCHMARK_BATCHES_COUNT; i++)
+      {
+        iterationTimes.push_back(timeBatch(function, iterations) * 1e9 / iterations);
+      }
+      std::sort(iterationTimes.begin(), iterationTimes.end());
+
+      const MicroBenchmarkResult result({benchmark.name, iterations, iterationTimes[iterationTimes.size() / 2], iterationTimes.front(), iterationTimes.back()});
+      std::cout << std::left << std::setw(44) << result.name << std::right << std::fixed << std::setprecision(1) << std::setw(14) << result.medianTime
+                << std::setw(14) << result.minTime << std::setw(14) << result.maxTime << std::setw(14) << result.iterations << std::endl;
+      results.push_back(result);
+    }
+    return results;
+  }
+};
+
+#endif
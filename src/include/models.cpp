@@ -3,11 +3,13 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <algorithm>
 #include <iterator>
 #include <any>
+#include <mutex>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -19,63 +21,466 @@
 #include "texture.cpp"
 #include "shader.cpp"
 #include "collider.cpp"
+#include "broadphase.cpp"
+#include "spatial_hash.cpp"
+#include "aabb_tree.cpp"
+#include "constants.cpp"
 #include "text.cpp"
+#include "slot_map.cpp"
+#include "transform.cpp"
+#include "profiler.cpp"
+#include "parallel.cpp"
+#include "events.cpp"
+#include "log.cpp"
 #include "../models/model_base_intf.cpp"
 
+/**
+ * Class for a view over the registered models of one type, giving out the models as that type without copying them.
+ */
+template <typename T>
+class ModelView
+{
+private:
+  // The registered models of the type.
+  const std::vector<std::shared_ptr<ModelBaseIntf>> &models;
+
+public:
+  /**
+   * Class for the iterator over the models of a view.
+   */
+  class Iterator
+  {
+  private:
+    // The iterator over the list of models.
+    std::vector<std::shared_ptr<ModelBaseIntf>>::const_iterator model;
+
+  public:
+    Iterator(const std::vector<std::shared_ptr<ModelBaseIntf>>::const_iterator &model)
+        : model(model) {}
+
+    T &operator*() const
+    {
+      return static_cast<T &>(**model);
+    }
+
+    Iterator &operator++()
+    {
+      ++model;
+      return *this;
+    }
+
+    bool operator!=(const Iterator &other) const
+    {
+      return model != other.model;
+    }
+  };
+
+  ModelView(const std::vector<std::shared_ptr<ModelBaseIntf>> &models)
+      : models(models) {}
+
+  Iterator begin() const
+  {
+    return Iterator(models.begin());
+  }
+
+  Iterator end() const
+  {
+    return Iterator(models.end());
+  }
+
+  /**
+   * Get the number of models in the view.
+   * 
+   * @return The number of models.
+   */
+  size_t size() const
+  {
+    return models.size();
+  }
+};
+
 /**
  * A manager class for managing models in a scene.
  */
 class ModelManager
 {
 private:
-  // Singleton instance of the model manager.
-  static ModelManager instance;
+  /**
+   * Enum for the types of the changes to the registered models.
+   */
+  enum class ModelCommandType
+  {
+    REGISTER,
+    DEREGISTER
+  };
 
-  // The text manager responsible for rendering text.
-  TextManager &textManager;
+  /**
+   * Structure for a change to the registered models made while the models are updating, applied once they're done.
+   */
+  struct ModelCommand
+  {
+    // The type of the change.
+    ModelCommandType type;
+    // The model to register.
+    std::shared_ptr<ModelBaseIntf> model;
+    // The handle of the model to de-register.
+    SlotHandle modelHandle;
+  };
+
+  /**
+   * Structure for a run of the models to update that are all of the same type, updated by the function of the type.
+   */
+  struct ModelUpdateRun
+  {
+    // The function updating the models of the type.
+    ModelBaseIntf::UpdateModelsFunction updateModels;
+    // The index of the first model of the run in the list of models to update, and the index after its last one.
+    size_t begin;
+    size_t end;
+  };
+
+  // The minimum number of models with thread-safe updates worth splitting across parallel tasks.
+  static constexpr size_t MIN_PARALLEL_MODEL_UPDATES = 32;
+
+  // The transform manager storing the transformations of the models.
+  TransformManager &transformManager;
+  // The event bus the models spawn and destroy models through while they update.
+  EventBus &eventBus;
+
+  // The registered models in the order they were registered, kept contiguous so they can be iterated without copying.
+  std::vector<std::shared_ptr<ModelBaseIntf>> registeredModels;
+  // The index of each registered model in the list of registered models, by the handle of the model.
+  SlotMap<size_t> registeredModelIndices;
+  // The registered models of each model type in the order they were registered, by the type ID of the models.
+  std::vector<std::vector<std::shared_ptr<ModelBaseIntf>>> registeredModelsByType;
+  // The number of models of each model type registered right now, by the type ID of the models, and of all of them,
+  //   kept as the models are registered and de-registered so they're never counted.
+  std::vector<uint32_t> registeredModelsCounts;
+  uint32_t registeredModelsCount;
+  // An empty list of models, viewed for the model types without any models registered yet.
+  const std::vector<std::shared_ptr<ModelBaseIntf>> noModels;
+  // Whether any model was de-registered but is still in the list of registered models, waiting to be removed from it.
+  bool deregisteredModelsPending;
+  // The list the models dropped from the list of registered models are stored to, reused between removals.
+  std::vector<std::shared_ptr<ModelBaseIntf>> removedModels;
+  // The models destroyed since the last removal, de-initialized once the de-registered models are removed.
+  std::vector<std::shared_ptr<ModelBaseIntf>> destroyedModels;
+
+  // Whether the models are updating, during which the changes to the registered models are queued.
+  bool isUpdatingModels;
+  // The lock guarding the queued changes, since they can be made by models updating in parallel.
+  std::mutex modelCommandsMutex;
+  // The changes to the registered models made while the models were updating, in the order they were made.
+  std::vector<ModelCommand> modelCommands;
+  // The list the models to update are stored to, with the models with thread-safe updates first, and the models of each
+  //   type next to each other within both, reused between updates.
+  std::vector<std::shared_ptr<ModelBaseIntf>> updatingModels;
+  // The time of the frame each of the models to update is updated with, reused between updates.
+  std::vector<FrameTime> updatingFrameTimes;
+  // The runs of the models of the same type in the list of models to update, in the order of the list, reused between
+  //   updates.
+  std::vector<ModelUpdateRun> modelUpdateRuns;
+  // The time each of the models to update took to update, reused between updates.
+  std::vector<double> modelUpdateTimes;
+  // The lines of debug text with the update times of the models, as of the latest update.
+  std::vector<std::string> updateStatsTexts;
+  // The number of updates of all the models so far, which the models updated every few steps are scheduled by.
+  uint64_t updateStepsCount;
+
+  // The type of the broadphase of the colliders.
+  BroadphaseType broadphaseType;
+  // The broadphase of the moving colliders of the registered models, kept up to date as the models move.
+  std::unique_ptr<Broadphase> collidersBroadphase;
+  // The broadphase of the static colliders of the registered models, only changed when they are registered and
+  //   de-registered.
+  std::unique_ptr<Broadphase> staticCollidersBroadphase;
+  // The change generation of each registered model as of when its collider was last moved in the broadphase, by the
+  //   handle of the model, so the colliders of the models that didn't move aren't read again.
+  std::unordered_map<SlotHandle, uint64_t> colliderChangeGenerations;
+  // The lists the handles of the models found by the broadphases are stored to, reused between queries.
+  std::vector<SlotHandle> collisionCandidateHandles;
+  std::vector<SlotHandle> staticCollisionCandidateHandles;
+  // The list the models found by the broadphase are stored to, reused between queries.
+  std::vector<std::shared_ptr<ModelBaseIntf>> collisionCandidates;
 
-  // The map of registered models.
-  std::map<const std::string, std::shared_ptr<ModelBaseIntf>> registeredModels;
-  std::vector<std::string> registeredModelsInsertionOrder;
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local ModelManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the model manager, which is the one of the default world.
+   *
+   * @return The model manager singleton instance.
+   */
+  static ModelManager &getSingleton()
+  {
+    // Singleton instance of the model manager, constructed the first time it's asked for.
+    static ModelManager instance;
+    return instance;
+  }
 
   ModelManager()
-      : textManager(TextManager::getInstance()),
+      : transformManager(TransformManager::getInstance()),
+        eventBus(EventBus::getInstance()),
         registeredModels({}),
-        registeredModelsInsertionOrder({}) {}
+        registeredModelIndices(),
+        registeredModelsByType({}),
+        registeredModelsCounts({}),
+        registeredModelsCount(0),
+        noModels({}),
+        deregisteredModelsPending(false),
+        removedModels({}),
+        destroyedModels({}),
+        isUpdatingModels(false),
+        modelCommandsMutex(),
+        modelCommands({}),
+        updatingModels({}),
+        updatingFrameTimes({}),
+        modelUpdateRuns({}),
+        modelUpdateTimes({}),
+        updateStatsTexts({}),
+        updateStepsCount(0),
+        broadphaseType(BroadphaseType::SPATIAL_HASH),
+        collidersBroadphase(createBroadphase(BroadphaseType::SPATIAL_HASH, false)),
+        staticCollidersBroadphase(createBroadphase(BroadphaseType::SPATIAL_HASH, true)),
+        colliderChangeGenerations({}),
+        collisionCandidateHandles({}),
+        staticCollisionCandidateHandles({}),
+        collisionCandidates({})
+  {
+    // Register the models spawned and destroy the models destroyed by the events of the models, once they're drained.
+    eventBus.subscribe<ModelSpawnEvent>([this](const ModelSpawnEvent &event) { registerModel(std::shared_ptr<ModelBaseIntf>(event.model)); });
+    eventBus.subscribe<ModelDestroyEvent>([this](const ModelDestroyEvent &event) { destroyModelLater(event.modelHandle); });
+  }
+
+  /**
+   * Create an empty broadphase of the given type.
+   * 
+   * @param type           The type of the broadphase.
+   * @param staticEntries  Whether the entries of the broadphase never move, so the boxes of the tree don't need to be
+   *                         fattened.
+   * 
+   * @return The created broadphase.
+   */
+  static std::unique_ptr<Broadphase> createBroadphase(const BroadphaseType &type, const bool &staticEntries)
+  {
+    switch (type)
+    {
+    case BroadphaseType::AABB_TREE:
+      return std::make_unique<DynamicAabbTree>(staticEntries ? 0.0f : COLLISION_TREE_MARGIN);
+    case BroadphaseType::SPATIAL_HASH:
+    default:
+      return std::make_unique<SpatialHash>(COLLISION_CELL_SIZE);
+    }
+  }
+
+  /**
+   * Get the list of the registered models of the given type, adding the lists for the types up to it if needed.
+   * 
+   * @param modelTypeId  The type ID of the models.
+   * 
+   * @return The list of the registered models of the type.
+   */
+  std::vector<std::shared_ptr<ModelBaseIntf>> &getRegisteredModelsOfType(const size_t &modelTypeId)
+  {
+    if (modelTypeId >= registeredModelsByType.size())
+    {
+      registeredModelsByType.resize(modelTypeId + 1);
+    }
+    return registeredModelsByType[modelTypeId];
+  }
+
+  /**
+   * Get the broadphase the collider of the model is kept in.
+   * 
+   * @param model  The model.
+   * 
+   * @return The broadphase of the collider.
+   */
+  Broadphase &getColliderBroadphase(const std::shared_ptr<ModelBaseIntf> &model) const
+  {
+    return model->getColliderDetails()->getColliderMotion() == ColliderMotion::STATIC ? *staticCollidersBroadphase : *collidersBroadphase;
+  }
+
+  /**
+   * Move the collider of the model to where it is now in its broadphase, unless the model hasn't moved since it was
+   *   last moved there. The static colliders that are moved anyway, such as when a scene puts its models back, are moved
+   *   in the static broadphase the same way.
+   * 
+   * @param model  The model.
+   */
+  void updateColliderCells(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    const auto changeGeneration = colliderChangeGenerations.find(model->getModelHandle());
+    if (changeGeneration != colliderChangeGenerations.end())
+    {
+      if (changeGeneration->second == model->getChangeGeneration())
+      {
+        return;
+      }
+      changeGeneration->second = model->getChangeGeneration();
+    }
+    else
+    {
+      colliderChangeGenerations.emplace(model->getModelHandle(), model->getChangeGeneration());
+    }
+    const auto &colliderDetails = model->getColliderDetails();
+    getColliderBroadphase(model).update(model->getModelHandle(), colliderDetails->getColliderShape()->getTransformedBox(), colliderDetails->getCollisionLayers());
+  }
+
+  /**
+   * Register the model right away.
+   * 
+   * @param model  The model to register.
+   * 
+   * @return The handle of the model.
+   */
+  SlotHandle addModel(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    // Append the model to the list of registered models. Loops going over the list by index while the model is added
+    //   don't reach it until their next pass.
+    const auto modelHandle = registeredModelIndices.insert(registeredModels.size());
+    model->setModelHandle(modelHandle);
+    // Render the model where it was registered, since reused models would otherwise move there from where they last were.
+    model->resetRenderInterpolation();
+    registeredModels.push_back(model);
+    getRegisteredModelsOfType(model->getModelTypeId()).push_back(model);
+    registeredModelsCounts.resize(registeredModelsByType.size(), 0);
+    registeredModelsCounts[model->getModelTypeId()]++;
+    registeredModelsCount++;
+    updateColliderCells(model);
+    return modelHandle;
+  }
+
+  /**
+   * De-register the model right away, leaving it in the list of all models until the de-registered models are removed.
+   * 
+   * @param modelHandle  The handle of the model to de-register.
+   */
+  void dropModel(const SlotHandle &modelHandle)
+  {
+    // Check if model actually exists. If not, just return since it's not registered.
+    const auto modelIndex = registeredModelIndices.find(modelHandle);
+    if (modelIndex == nullptr)
+    {
+      return;
+    }
+
+    const auto &model = registeredModels[*modelIndex];
+    getColliderBroadphase(model).remove(modelHandle);
+    colliderChangeGenerations.erase(modelHandle);
+    // Let the scenes know once the last model of the type is gone, with the events of the step.
+    const auto modelTypeId = model->getModelTypeId();
+    registeredModelsCount--;
+    if (--registeredModelsCounts[modelTypeId] == 0)
+    {
+      eventBus.publish(ModelTypeClearedEvent({modelTypeId}));
+    }
+    registeredModelIndices.remove(modelHandle);
+    deregisteredModelsPending = true;
+  }
+
+  /**
+   * Apply the changes to the registered models queued while the models were updating, in the order they were made.
+   */
+  void applyModelCommands()
+  {
+    for (const auto &modelCommand : modelCommands)
+    {
+      if (modelCommand.type == ModelCommandType::REGISTER)
+      {
+        addModel(modelCommand.model);
+      }
+      else
+      {
+        dropModel(modelCommand.modelHandle);
+      }
+    }
+    modelCommands.clear();
+  }
+
+  /**
+   * Get the number of steps between the updates of the model, which is 1 unless it updates every few steps.
+   *
+   * @param model  The model.
+   *
+   * @return The update interval of the model.
+   */
+  static uint32_t getUpdateInterval(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    return model->getUpdateFrequency() == UpdateFrequency::EVERY_NTH_STEP ? std::max<uint32_t>(model->getUpdateInterval(), 1) : 1;
+  }
+
+  /**
+   * Get the number of steps the updates of the model are shifted by, picked by its handle so the models of the same
+   *   interval have their updates spread evenly over the steps.
+   *
+   * @param model  The model.
+   *
+   * @return The update phase of the model.
+   */
+  static uint32_t getUpdatePhase(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    return model->getModelHandle().index % getUpdateInterval(model);
+  }
 
 public:
   // Preventing copying the model manager, making sure only one instance can exist.
   ModelManager(const ModelManager &) = delete;
 
   /**
-   * Register a new model into the model manager.
+   * Register a new model into the model manager, giving it the handle it is found by from then on. Models registered
+   *   while the models are updating are only registered once all of them are done, and get their handle then.
    * 
    * @param model  The model to register.
+   * 
+   * @return The handle of the model, or an invalid handle if the registration was queued.
    */
-  void registerModel(const std::shared_ptr<ModelBaseIntf> &&model)
+  SlotHandle registerModel(const std::shared_ptr<ModelBaseIntf> &&model)
   {
-    // Insert the model to the map of registered models.
-    registeredModels.emplace(model->getModelId(), std::move(model));
-    registeredModelsInsertionOrder.push_back(model->getModelId());
+    if (isUpdatingModels)
+    {
+      std::lock_guard<std::mutex> modelCommandsLock(modelCommandsMutex);
+      modelCommands.push_back({ModelCommandType::REGISTER, model, {0, 0}});
+      return {0, 0};
+    }
+    return addModel(model);
   }
 
   /**
-   * De-register an existing model from the model manager.
+   * De-register an existing model from the model manager. The model stops being registered right away, but stays in the
+   *   list of all models until the de-registered models are removed from it, so the list can be iterated while models
+   *   de-register. Models de-registered while the models are updating stay registered until all of them are done.
    * 
-   * @param model  The ID of the model to de-register.
+   * @param modelHandle  The handle of the model to de-register.
    */
-  void deregisterModel(const std::string &modelId)
+  void deregisterModel(const SlotHandle &modelHandle)
   {
-    // Check if model actually exists. If not, just return since it's not registered.
-    if (std::find(registeredModelsInsertionOrder.begin(), registeredModelsInsertionOrder.end(), modelId) == registeredModelsInsertionOrder.end())
+    if (isUpdatingModels)
     {
+      std::lock_guard<std::mutex> modelCommandsLock(modelCommandsMutex);
+      modelCommands.push_back({ModelCommandType::DEREGISTER, nullptr, modelHandle});
       return;
     }
+    dropModel(modelHandle);
+  }
 
-    // Get the model that is registered with the given model ID.
-    auto model = registeredModels[modelId];
-    // Remove the model from the map of registered models.
-    deregisterModel(model);
+  /**
+   * De-register an existing model from the model manager, going through all the models to find it by its ID.
+   * 
+   * @param modelId  The ID of the model to de-register.
+   */
+  void deregisterModel(const std::string &modelId)
+  {
+    for (const auto &model : registeredModels)
+    {
+      if (model->getModelId() == modelId && isModelRegistered(model->getModelHandle()))
+      {
+        deregisterModel(model->getModelHandle());
+        return;
+      }
+    }
   }
 
   /**
@@ -85,41 +490,260 @@ public:
    */
   void deregisterModel(const std::shared_ptr<ModelBaseIntf> &model)
   {
-    // Remove the model from the map of registered models.
-    registeredModels.erase(model->getModelId());
-    registeredModelsInsertionOrder.erase(std::remove(registeredModelsInsertionOrder.begin(), registeredModelsInsertionOrder.end(), model->getModelId()), registeredModelsInsertionOrder.end());
+    deregisterModel(model->getModelHandle());
+  }
+
+  /**
+   * Destroy a registered model, de-registering it and de-initializing it once the de-registered models are removed.
+   *   Like de-registering, the model stops being registered right away, or once the models are done updating.
+   * 
+   * @param modelHandle  The handle of the model to destroy.
+   */
+  void destroyModelLater(const SlotHandle &modelHandle)
+  {
+    // Check if model actually exists. If not, just return since it's not registered.
+    const auto modelIndex = registeredModelIndices.find(modelHandle);
+    if (modelIndex == nullptr)
+    {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> modelCommandsLock(modelCommandsMutex);
+      destroyedModels.push_back(registeredModels[*modelIndex]);
+    }
+    deregisterModel(modelHandle);
   }
 
   /**
-   * Return the model registered with the given model ID.
+   * De-initialize the destroyed models, and remove the de-registered models from the list of all models in one pass,
+   *   keeping the rest in the order they were registered, which the models that don't update in parallel update in.
+   *   Run once the models are no longer being iterated: at the end of each simulation step in the game, once per frame
+   *   in the menus, and after initializing or de-initializing all the models. Until then, the lists of models still
+   *   hold the models de-registered since the last removal.
+   */
+  void removeDeregisteredModels()
+  {
+    for (const auto &destroyedModel : destroyedModels)
+    {
+      destroyedModel->deinit();
+    }
+    destroyedModels.clear();
+
+    if (!deregisteredModelsPending)
+    {
+      return;
+    }
+    deregisteredModelsPending = false;
+
+    // Compact the registered models to the front of the list, moving their indices along with them, and put them back
+    //   into the lists of their types in the same order.
+    for (auto &registeredModelsOfType : registeredModelsByType)
+    {
+      registeredModelsOfType.clear();
+    }
+    size_t registeredModelsCount = 0;
+    for (size_t i = 0; i < registeredModels.size(); i++)
+    {
+      const auto modelIndex = registeredModelIndices.find(registeredModels[i]->getModelHandle());
+      if (modelIndex == nullptr || *modelIndex != i)
+      {
+        // Let the model know it was dropped, unless it was registered again and is further along the list.
+        if (modelIndex == nullptr)
+        {
+          removedModels.push_back(registeredModels[i]);
+        }
+        continue;
+      }
+      *modelIndex = registeredModelsCount;
+      registeredModelsByType[registeredModels[i]->getModelTypeId()].push_back(registeredModels[i]);
+      if (i != registeredModelsCount)
+      {
+        registeredModels[registeredModelsCount] = std::move(registeredModels[i]);
+      }
+      ++registeredModelsCount;
+    }
+    registeredModels.resize(registeredModelsCount);
+
+    for (const auto &removedModel : removedModels)
+    {
+      removedModel->onRemoved();
+    }
+    removedModels.clear();
+  }
+
+  /**
+   * Return the model registered with the given handle.
    * 
-   * @param model  The ID of the model to return.
+   * @param modelHandle  The handle of the model to return.
+   * 
+   * @return The model registered with the given handle.
+   */
+  const std::shared_ptr<ModelBaseIntf> &getModel(const SlotHandle &modelHandle) const
+  {
+    return registeredModels[registeredModelIndices.get(modelHandle)];
+  }
+
+  /**
+   * Return the model registered with the given model ID, going through all the models to find it. Only meant for the
+   *   few models found by name when a scene starts, since the IDs are otherwise only kept for debugging.
+   * 
+   * @param modelId  The ID of the model to return.
    * 
    * @return The model registered with the given model ID.
    */
   const std::shared_ptr<ModelBaseIntf> &getModel(const std::string &modelId) const
   {
-    return registeredModels.at(modelId);
+    for (const auto &model : registeredModels)
+    {
+      if (model->getModelId() == modelId && isModelRegistered(model->getModelHandle()))
+      {
+        return model;
+      }
+    }
+    Logger::getInstance().error("Failed at finding the model ", modelId);
+    exit(1);
   }
 
   /**
-   * Return the list of all models registered with the model manager.
+   * Return the list of all models registered with the model manager, in the order they were registered. The list is
+   *   only changed by registering models and removing the de-registered ones, so it can be iterated while models
+   *   de-register, but models de-registered since the last removal are still in it.
    * 
    * @return The list of all registered models.
    */
-  const std::vector<std::shared_ptr<ModelBaseIntf>> getAllModels() const
+  const std::vector<std::shared_ptr<ModelBaseIntf>> &getAllModels() const
+  {
+    return registeredModels;
+  }
+
+  /**
+   * Return a view over the models of the given type registered with the model manager, in the order they were
+   *   registered. Like the list of all models, it can be iterated while models de-register, but models de-registered
+   *   since the last removal are still in it.
+   * 
+   * @return The view over the registered models of the type.
+   */
+  template <typename T>
+  ModelView<T> view() const
+  {
+    const auto modelTypeId = ModelBaseIntf::getTypeId<T>();
+    return ModelView<T>(modelTypeId < registeredModelsByType.size() ? registeredModelsByType[modelTypeId] : noModels);
+  }
+
+  /**
+   * Get the number of models of the given type registered right now, which unlike the size of the view of the type
+   *   leaves out the models de-registered since the last removal.
+   * 
+   * @return The number of registered models of the type.
+   */
+  template <typename T>
+  uint32_t getRegisteredModelsCount() const
+  {
+    const auto modelTypeId = ModelBaseIntf::getTypeId<T>();
+    return modelTypeId < registeredModelsCounts.size() ? registeredModelsCounts[modelTypeId] : 0;
+  }
+
+  /**
+   * Get the number of models registered right now, which unlike the size of the list of all models leaves out the
+   *   models de-registered since the last removal.
+   * 
+   * @return The number of registered models.
+   */
+  const uint32_t &getRegisteredModelsCount() const
+  {
+    return registeredModelsCount;
+  }
+
+  /**
+   * Get the type of the broadphase of the colliders.
+   * 
+   * @return The type of the broadphase.
+   */
+  const BroadphaseType &getBroadphaseType() const
+  {
+    return broadphaseType;
+  }
+
+  /**
+   * Switch the broadphase of the colliders to the given type, inserting the colliders of all the registered models into it.
+   * 
+   * @param newBroadphaseType  The type of the broadphase.
+   */
+  void setBroadphaseType(const BroadphaseType &newBroadphaseType)
   {
-    // Define a vector to store the list of registered models.
-    std::vector<std::shared_ptr<ModelBaseIntf>> models({});
-    // Iterate through the map of registered models.
-    for (const auto &modelId : registeredModelsInsertionOrder)
+    broadphaseType = newBroadphaseType;
+    collidersBroadphase = createBroadphase(newBroadphaseType, false);
+    staticCollidersBroadphase = createBroadphase(newBroadphaseType, true);
+    colliderChangeGenerations.clear();
+    for (const auto &model : registeredModels)
     {
-      // Push each registered model into the models list.
-      models.push_back(registeredModels.find(modelId)->second);
+      if (isModelRegistered(model->getModelHandle()))
+      {
+        updateColliderCells(model);
+      }
     }
+  }
 
-    // Return the list of registered models.
-    return models;
+  /**
+   * Check whether a model is registered with the given handle.
+   * 
+   * @param modelHandle  The handle of the model.
+   * 
+   * @return Whether the model is registered.
+   */
+  bool isModelRegistered(const SlotHandle &modelHandle) const
+  {
+    return registeredModelIndices.contains(modelHandle);
+  }
+
+  /**
+   * Return the registered models with colliders on any of the given layers that share a cell of the broadphases with the
+   *   given box, which are the only ones that can collide with anything inside it. The moving colliders are moved to
+   *   their cells after each model updates, while the static ones stay where they were registered.
+   * 
+   * @param box        The box to find the candidates for.
+   * @param layerMask  The mask of the collision layers of the colliders to find.
+   * 
+   * @return The list of models that can collide with anything inside the box, ordered by their handles, valid until the
+   *   next query.
+   */
+  const std::vector<std::shared_ptr<ModelBaseIntf>> &getCollisionCandidates(const AxisAlignedBoundingBox &box, const uint32_t &layerMask)
+  {
+    collidersBroadphase->query(box, layerMask, collisionCandidateHandles);
+    staticCollidersBroadphase->query(box, layerMask, staticCollisionCandidateHandles);
+
+    // Merge the handles found by both broadphases, which are each ordered by handle already.
+    collisionCandidates.clear();
+    auto movingHandle = collisionCandidateHandles.begin();
+    auto staticHandle = staticCollisionCandidateHandles.begin();
+    while (movingHandle != collisionCandidateHandles.end() || staticHandle != staticCollisionCandidateHandles.end())
+    {
+      if (staticHandle == staticCollisionCandidateHandles.end() || (movingHandle != collisionCandidateHandles.end() && *movingHandle < *staticHandle))
+      {
+        collisionCandidates.push_back(getModel(*movingHandle++));
+      }
+      else
+      {
+        collisionCandidates.push_back(getModel(*staticHandle++));
+      }
+    }
+    return collisionCandidates;
+  }
+
+  /**
+   * Find the handles of the registered models on the given collision layers whose colliders share a cell with the given
+   *   box, without going through the lists of the model manager, so it can run in parallel with other queries once the
+   *   models are done updating.
+   * 
+   * @param box                     The box to find the candidates for.
+   * @param layerMask               The mask of the collision layers of the colliders to find.
+   * @param candidateHandles        The list to store the handles of the moving models found to.
+   * @param staticCandidateHandles  The list to store the handles of the static models found to.
+   */
+  void findCollisionCandidateHandles(const AxisAlignedBoundingBox &box, const uint32_t &layerMask, std::vector<SlotHandle> &candidateHandles, std::vector<SlotHandle> &staticCandidateHandles) const
+  {
+    collidersBroadphase->query(box, layerMask, candidateHandles);
+    staticCollidersBroadphase->query(box, layerMask, staticCandidateHandles);
   }
 
   /**
@@ -127,17 +751,18 @@ public:
    */
   void initAllModels()
   {
-    // Iterate through the list of model IDs.
-    for (const auto &modelId : registeredModelsInsertionOrder)
+    // Iterate through the list of registered models by index, since models can be registered while it runs.
+    for (size_t i = 0; i < registeredModels.size(); i++)
     {
-      // Find the model registered with the given model ID.
-      const auto result = registeredModels.find(modelId);
-      // Check if the model still exists in the registration map.
-      if (result != registeredModels.end())
+      // Copy the model, since registering models can move the list.
+      const auto model = registeredModels[i];
+      // Check if the model is still registered.
+      if (isModelRegistered(model->getModelHandle()))
       {
-        result->second->init();
+        model->init();
       }
     }
+    removeDeregisteredModels();
   }
 
   /**
@@ -145,75 +770,192 @@ public:
    */
   void deinitAllModels()
   {
-    // Iterate through the list of model IDs.
-    for (const auto &modelId : registeredModelsInsertionOrder)
+    // Iterate through the list of registered models by index, since models can be registered while it runs.
+    for (size_t i = 0; i < registeredModels.size(); i++)
     {
-      // Find the model registered with the given model ID.
-      const auto result = registeredModels.find(modelId);
-      // Check if the model still exists in the registration map.
-      if (result != registeredModels.end())
+      // Copy the model, since registering models can move the list.
+      const auto model = registeredModels[i];
+      // Check if the model is still registered.
+      if (isModelRegistered(model->getModelHandle()))
       {
-        result->second->deinit();
+        model->deinit();
       }
     }
+    removeDeregisteredModels();
   }
 
   /**
-   * Run the update operation on all the registered models.
+   * Run the update operation on all the registered models. The models with thread-safe updates update in parallel
+   *   first, and the rest update one after the other. Both go through the models type by type, in the order they were
+   *   registered within each type, calling the update of each type directly. The models registered and de-registered
+   *   meanwhile are only registered and de-registered once all the models are done.
+   * 
+   * @param frameTime  The time of the frame.
    */
-  void updateAllModels()
+  void updateAllModels(const FrameTime &frameTime)
   {
+    // The models updated every few steps are only updated at their steps, with the time of all the steps since their
+    //   previous update, and the event-driven models aren't updated at all.
+    const auto isUpdateDue = [&](const std::shared_ptr<ModelBaseIntf> &model) {
+      return model->getUpdateFrequency() != UpdateFrequency::EVENT_DRIVEN && (updateStepsCount + getUpdatePhase(model)) % getUpdateInterval(model) == 0;
+    };
+    const auto getModelFrameTime = [&](const std::shared_ptr<ModelBaseIntf> &model) {
+      return FrameTime({frameTime.now, frameTime.delta * getUpdateInterval(model), frameTime.frameIndex});
+    };
+
     auto modelNamesCount = std::map<const std::string, int>({});
     auto modelNamesProcessTime = std::map<const std::string, double>({});
 
-    // Iterate through the list of model IDs.
-    for (const auto &modelId : registeredModelsInsertionOrder)
-    {
-      // Find the model registered with the given model ID.
-      const auto result = registeredModels.find(modelId);
-      // Check if the model still exists in the registration map.
-      if (result != registeredModels.end())
+    // Split the registered models into the ones with thread-safe updates and the rest, going through the models of each
+    //   type together so they end up in one run of the type.
+    updatingModels.clear();
+    updatingFrameTimes.clear();
+    modelUpdateRuns.clear();
+    const auto addUpdatingModels = [&](const bool &threadSafe) {
+      for (const auto &registeredModelsOfType : registeredModelsByType)
       {
-        const auto model = result->second;
-        if (modelNamesCount.find(model->getModelName()) != modelNamesCount.end())
+        const auto runBegin = updatingModels.size();
+        for (const auto &model : registeredModelsOfType)
         {
-          modelNamesCount[model->getModelName()]++;
+          if (isModelRegistered(model->getModelHandle()) && model->isUpdateThreadSafe() == threadSafe && isUpdateDue(model))
+          {
+            updatingModels.push_back(model);
+            updatingFrameTimes.push_back(getModelFrameTime(model));
+          }
         }
-        else
+        if (updatingModels.size() > runBegin)
         {
-          modelNamesCount[model->getModelName()] = 1;
-          modelNamesProcessTime[model->getModelName()] = 0.0f;
+          modelUpdateRuns.push_back({updatingModels[runBegin]->getUpdateModelsFunction(), runBegin, updatingModels.size()});
         }
+      }
+    };
+    addUpdatingModels(true);
+    const auto threadSafeModelsCount = updatingModels.size();
+    const auto threadSafeRunsCount = modelUpdateRuns.size();
+    addUpdatingModels(false);
+    modelUpdateTimes.resize(updatingModels.size());
 
-        // If it does, tell the model to perform an update on itself.
-        const auto startTime = glfwGetTime();
-        model->update();
-        const auto endTime = glfwGetTime();
-        modelNamesProcessTime[model->getModelName()] += (endTime - startTime) * 1000;
+    // Update the models of a run between the given indices of the list of models to update.
+    const auto updateModelsOfRun = [&](const ModelUpdateRun &run, const size_t &begin, const size_t &end) {
+      const auto runBegin = std::max(begin, run.begin);
+      const auto runEnd = std::min(end, run.end);
+      if (runBegin < runEnd)
+      {
+        run.updateModels(&updatingModels[runBegin], &updatingFrameTimes[runBegin], &modelUpdateTimes[runBegin], runEnd - runBegin);
       }
+    };
+
+    // Queue the changes to the registered models until all the models are done, so the lists stay the same meanwhile.
+    isUpdatingModels = true;
+    // Tell the models with thread-safe updates to perform an update on themselves, in chunks running in parallel, each
+    //   going through the runs it overlaps.
+    ParallelTasks::runChunked(threadSafeModelsCount, MIN_PARALLEL_MODEL_UPDATES, [&](const uint32_t, const size_t begin, const size_t end) {
+      for (size_t i = 0; i < threadSafeRunsCount; i++)
+      {
+        updateModelsOfRun(modelUpdateRuns[i], begin, end);
+      }
+    });
+    // Tell the rest of the models to perform an update on themselves.
+    for (size_t i = threadSafeRunsCount; i < modelUpdateRuns.size(); i++)
+    {
+      updateModelsOfRun(modelUpdateRuns[i], modelUpdateRuns[i].begin, modelUpdateRuns[i].end);
     }
+    isUpdatingModels = false;
 
-    auto height = 17.0f;
+    // Sync the registered models with the changes made while they were updating, and handle the events the models
+    //   published meanwhile, which is the point of the step the spawns and the destroys of the updates are batched up to.
+    //   The de-registered models are only removed from the lists at the end of the step.
+    applyModelCommands();
+    eventBus.dispatch();
+
+    for (size_t i = 0; i < updatingModels.size(); i++)
+    {
+      const auto &modelName = updatingModels[i]->getModelName();
+      if (modelNamesCount.find(modelName) != modelNamesCount.end())
+      {
+        modelNamesCount[modelName]++;
+      }
+      else
+      {
+        modelNamesCount[modelName] = 1;
+        modelNamesProcessTime[modelName] = 0.0f;
+      }
+      modelNamesProcessTime[modelName] += modelUpdateTimes[i];
+    }
+    // Drop the models to update, so the de-registered ones aren't kept alive until the next update.
+    updatingModels.clear();
+
+    // Rebuild the model matrices of all the models that moved in one pass, then move their colliders in the broadphases.
+    //   The colliders of the models that didn't move, such as all the static ones, are skipped without being read.
+    transformManager.updateDirtyMatrices();
+    for (const auto &model : registeredModels)
+    {
+      if (isModelRegistered(model->getModelHandle()))
+      {
+        updateColliderCells(model);
+      }
+    }
+
+    updateStatsTexts.clear();
     for (const auto &modelCounts : modelNamesCount)
     {
       const auto avgRenderTime = modelNamesProcessTime[modelCounts.first] / modelCounts.second;
-      textManager.addText(modelCounts.first + " Model Object Instances: " + std::to_string(modelCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
+      updateStatsTexts.push_back(modelCounts.first + " Model Object Instances: " + std::to_string(modelCounts.second) + " | Update (avg): " + std::to_string(avgRenderTime) + "ms");
+    }
+    updateStepsCount++;
+  }
+
+  /**
+   * Add the debug text with the update times of the models as of the latest update, which can be a few frames back
+   *   when the models don't update every frame.
+   */
+  void addUpdateStatsText()
+  {
+    auto height = 17.0f;
+    for (const auto &updateStatsText : updateStatsTexts)
+    {
+      TextManager::getInstance().addText(updateStatsText, glm::vec2(1, height), 0.5f);
       height -= 0.5f;
     }
   }
 
   /**
-   * Returns the singleton instance of the model manager.
+   * Store the transformations of the models updating at the next simulation step as the ones of their previous update,
+   *   before the step moves them, scheduling the models updated every few steps so they're rendered over all the steps
+   *   between their updates.
+   */
+  void storePreviousTransformations()
+  {
+    for (const auto &model : registeredModels)
+    {
+      if (isModelRegistered(model->getModelHandle()))
+      {
+        model->setUpdateSchedule(getUpdateInterval(model), getUpdatePhase(model));
+      }
+    }
+    transformManager.storePreviousTransforms(updateStepsCount);
+  }
+
+  /**
+   * Place all the models to render between where they were at the previous and the latest simulation step.
    * 
-   * @return The model manager singleton instance.
+   * @param factor  How far along to the latest simulation step the rendered frame is, between 0 and 1.
+   */
+  void interpolateRenderTransformations(const float_t &factor)
+  {
+    transformManager.interpolateRenderMatrices(factor);
+  }
+
+  /**
+   * Returns the instance of the model manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
+   * 
+   * @return The model manager instance.
    */
   static ModelManager &getInstance()
   {
-    return instance;
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
   }
 };
 
-// Initialize the model manager singleton instance static variable.
-ModelManager ModelManager::instance;
-
 #endif
\ No newline at end of file
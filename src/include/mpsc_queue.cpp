@@ -0,0 +1,114 @@
+#ifndef INCLUDE_MPSC_QUEUE_CPP
+#define INCLUDE_MPSC_QUEUE_CPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Class for a fixed-size queue between any number of threads pushing into it and one thread popping from it, which needs
+ *   no locking. Each slot of the ring has a sequence number telling whether it's free for the push of its lap round the
+ *   ring or written for the pop of it, so a pushing thread claims a slot by moving the tail past it, writes it on its own,
+ *   and then publishes it with release ordering, without waiting on the other pushing threads.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue
+{
+private:
+  static_assert((Capacity & (Capacity - 1)) == 0, "The capacity of the queue must be a power of two");
+
+  /**
+   * Structure for a slot of the ring.
+   */
+  struct Slot
+  {
+    // The number of the push the slot is free for, or one past it once that push wrote the slot.
+    std::atomic<size_t> sequence;
+    // The value.
+    T value;
+  };
+
+  // The slots of the ring.
+  std::array<Slot, Capacity> slots;
+  // The number of values popped, written only by the popping thread, and the number of slots claimed by the pushing
+  //   threads. They're kept on their own cache lines, so the threads don't contend over them.
+  alignas(64) std::atomic<size_t> head;
+  alignas(64) std::atomic<size_t> tail;
+
+public:
+  MpscQueue()
+      : slots(),
+        head(0),
+        tail(0)
+  {
+    for (size_t i = 0; i < Capacity; i++)
+    {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Preventing copying the queue, since the threads hold on to it.
+  MpscQueue(const MpscQueue &) = delete;
+
+  /**
+   * Push a value into the queue, from any thread.
+   *
+   * @param value  The value.
+   *
+   * @return Whether the value was pushed, which it isn't if the queue is full.
+   */
+  bool push(const T &value)
+  {
+    auto position = tail.load(std::memory_order_relaxed);
+    while (true)
+    {
+      auto &slot = slots[position & (Capacity - 1)];
+      const auto difference = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(position);
+      if (difference == 0)
+      {
+        // The slot is free for this push, as long as no other thread claims it first.
+        if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          slot.value = value;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0)
+      {
+        // The slot still holds the value of the lap before, so the queue is full.
+        return false;
+      }
+      else
+      {
+        // Another thread claimed the slot, so try the next one.
+        position = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Pop the oldest value from the queue, from the popping thread.
+   *
+   * @param value  The value, set if one was popped.
+   *
+   * @return Whether a value was popped, which it isn't if the queue is empty or the oldest value is still being written.
+   */
+  bool pop(T &value)
+  {
+    const auto position = head.load(std::memory_order_relaxed);
+    auto &slot = slots[position & (Capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+    {
+      return false;
+    }
+    value = std::move(slot.value);
+    slot.sequence.store(position + Capacity, std::memory_order_release);
+    head.store(position + 1, std::memory_order_relaxed);
+    return true;
+  }
+};
+
+#endif
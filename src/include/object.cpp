@@ -2,18 +2,29 @@
 #define INCLUDE_OBJECT_CPP
 
 #include <string>
+#include <filesystem>
 #include <vector>
 #include <map>
 #include <memory>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <chrono>
 #include <iostream>
-#include <fstream>
-
-#include <stdlib.h>
-#include <string.h>
+#include <algorithm>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include "common.cpp"
+#include "constants.cpp"
+#include "mesh.cpp"
+#include "mesh_arena.cpp"
+#include "residency.cpp"
+#include "file_watcher.cpp"
+#include "memory.cpp"
+#include "thread_affinity.cpp"
+
 /**
  * Class for containing the details of the object.
  */
@@ -23,44 +34,78 @@ class ObjectDetails
 	friend class ObjectManager;
 
 private:
-	// The name of the object.
+	// The key of the object, made from the path to its file and its vertex format, which is what the object manager shares
+	//   it by.
 	const std::string objectName;
 	// The file path to the object data.
 	const std::string objectFilePath;
-
-	// The list of vertices of the object.
-	const std::vector<glm::vec3> vertices;
-
-	// The ID of the array buffer containing the vertex position data of the object.
-	const GLuint vertexBufferId;
-	// The ID of the array buffer containing the vertex UV coordinates data of the object.
-	const GLuint uvBufferId;
-	// The ID of the array buffer containing the vertex normal vector data of the object.
-	const GLuint normalBufferId;
-	// The size of the buffer/number of vertices of the object.
-	const uint32_t bufferSize;
+	// The format the vertices of the object were asked to be stored in.
+	const MeshVertexFormat requestedVertexFormat;
+
+	// The rest of the details are swapped in place by the object manager when the object file is reloaded, so every model
+	//   sharing the details draws the reloaded mesh.
+
+	// The corner of the bounding box of the object with the lowest coordinates.
+	mutable glm::vec3 boundsMin;
+	// The corner of the bounding box of the object with the highest coordinates.
+	mutable glm::vec3 boundsMax;
+	// The distance of the furthest vertex of the object from its origin.
+	mutable float boundingRadius;
+	// The largest distance of a vertex of the object from its y-axis, and the half-height of the segment of the pill along
+	//   the y-axis with that radius holding every vertex.
+	mutable float axisRadius;
+	mutable float pillHalfHeight;
+	// The vertex positions of the coarsest level of detail of the object, only kept if the collision hulls are retained.
+	//   None of the rest of the mesh is kept on the CPU once it's uploaded.
+	mutable CountedVector<glm::vec3, MemorySubsystem::OBJECTS> collisionHull;
+
+	// The ranges of the mesh arena buffers holding the interleaved vertex position, UV coordinates and normal vector data,
+	//   and the vertex indices of the triangles of the object.
+	mutable MeshAllocation meshAllocation;
+	// The levels of detail of the object, from the full mesh to the coarsest, as ranges of the mesh arena index buffer.
+	mutable std::vector<MeshLod> lods;
+	// The meshlets of the full mesh of the object, as ranges of the mesh arena index buffer, with their spheres and cones in
+	//   the space of the stored vertices.
+	mutable std::vector<Meshlet> meshlets;
+	// The ID of the vertex array object recording the vertex attribute layout of the mesh arena buffers.
+	mutable GLuint vertexArrayId;
+	// The matrix moving the stored vertex positions into object space.
+	mutable glm::mat4 vertexMatrix;
 
 public:
 	ObjectDetails(
 			const std::string &objectName,
 			const std::string &objectFilePath,
-			const std::vector<glm::vec3> &vertices,
-			const GLuint &vertexBufferId,
-			const GLuint &uvBufferId,
-			const GLuint &normalBufferId,
-			const uint32_t &bufferCount)
+			const MeshVertexFormat &requestedVertexFormat,
+			const glm::vec3 &boundsMin,
+			const glm::vec3 &boundsMax,
+			const float &boundingRadius,
+			const float &axisRadius,
+			const float &pillHalfHeight,
+			const CountedVector<glm::vec3, MemorySubsystem::OBJECTS> &collisionHull,
+			const MeshAllocation &meshAllocation,
+			const std::vector<MeshLod> &lods,
+			const std::vector<Meshlet> &meshlets,
+			const GLuint &vertexArrayId)
 			: objectName(objectName),
 				objectFilePath(objectFilePath),
-				vertices(vertices),
-				vertexBufferId(vertexBufferId),
-				uvBufferId(uvBufferId),
-				normalBufferId(normalBufferId),
-				bufferSize(bufferCount) {}
+				requestedVertexFormat(requestedVertexFormat),
+				boundsMin(boundsMin),
+				boundsMax(boundsMax),
+				boundingRadius(boundingRadius),
+				axisRadius(axisRadius),
+				pillHalfHeight(pillHalfHeight),
+				collisionHull(collisionHull),
+				meshAllocation(meshAllocation),
+				lods(lods),
+				meshlets(meshlets),
+				vertexArrayId(vertexArrayId),
+				vertexMatrix(meshAllocation.vertexFormat == MeshVertexFormat::COMPACT ? MeshLoader::getCompactVertexMatrix(boundsMin, boundsMax) : glm::mat4(1.0f)) {}
 
 	/**
-   * Get the name of the object.
+   * Get the key of the object, shared by every name it was asked for with.
    * 
-   * @return The object name.
+   * @return The object key.
    */
 	const std::string &getObjectName() const
 	{
@@ -68,54 +113,187 @@ public:
 	}
 
 	/**
-   * Get the list of vertices of the object.
+   * Get the number of unique vertices of the object.
    * 
-   * @return The object vertices.
+   * @return The number of vertices.
    */
-	const std::vector<glm::vec3> &getVertices() const
+	const uint32_t &getVertexCount() const
 	{
-		return vertices;
+		return meshAllocation.vertexCount;
 	}
 
 	/**
-   * Get the array buffer ID of the object vertex positions.
+   * Get the corner of the bounding box of the object with the lowest coordinates.
    * 
-   * @return The array buffer ID.
+   * @return The minimum corner of the bounding box.
    */
-	const GLuint &getVertexBufferId() const
+	const glm::vec3 &getBoundsMin() const
 	{
-		return vertexBufferId;
+		return boundsMin;
 	}
 
 	/**
-   * Get the array buffer ID of the object vertex UV coordinates.
+   * Get the corner of the bounding box of the object with the highest coordinates.
    * 
-   * @return The array buffer ID.
+   * @return The maximum corner of the bounding box.
    */
-	const GLuint &getUvBufferId() const
+	const glm::vec3 &getBoundsMax() const
 	{
-		return uvBufferId;
+		return boundsMax;
 	}
 
 	/**
-   * Get the array buffer ID of the object vertex normal vectors.
+   * Get the distance of the furthest vertex of the object from its origin.
    * 
-   * @return The array buffer ID.
+   * @return The bounding radius.
    */
-	const GLuint &getNormalBufferId() const
+	const float &getBoundingRadius() const
 	{
-		return normalBufferId;
+		return boundingRadius;
 	}
 
 	/**
-   * Get the size of the buffer/number of vertices of the object.
+   * Get the largest distance of a vertex of the object from its y-axis, which is the radius of its cylinder and pill
+   * colliders.
    * 
-   * @return The number of vertices.
+   * @return The axis radius.
+   */
+	const float &getAxisRadius() const
+	{
+		return axisRadius;
+	}
+
+	/**
+   * Get the half-height of the segment of the pill along the y-axis with the axis radius holding every vertex of the
+   * object.
+   * 
+   * @return The pill half-height.
+   */
+	const float &getPillHalfHeight() const
+	{
+		return pillHalfHeight;
+	}
+
+	/**
+   * Get the vertex positions of the low-poly collision hull of the object.
+   * 
+   * @return The collision hull positions, which are empty unless the collision hulls are retained.
+   */
+	const CountedVector<glm::vec3, MemorySubsystem::OBJECTS> &getCollisionHull() const
+	{
+		return collisionHull;
+	}
+
+	/**
+   * Get the index of the first vertex of the object in the mesh arena vertex buffer, which is added to its indices.
+   * 
+   * @return The base vertex.
+   */
+	const GLint &getBaseVertex() const
+	{
+		return meshAllocation.baseVertex;
+	}
+
+	/**
+   * Get the index of the first index of the full mesh of the object in the mesh arena index buffer.
+   * 
+   * @return The first index.
+   */
+	const uint32_t &getFirstIndex() const
+	{
+		return lods.front().firstIndex;
+	}
+
+	/**
+   * Get the number of indices of the full mesh of the object.
+   * 
+   * @return The number of indices.
    */
 	const uint32_t &getBufferSize() const
 	{
-		return bufferSize;
+		return lods.front().indexCount;
 	}
+
+	/**
+   * Get the number of levels of detail of the object, including the full mesh.
+   * 
+   * @return The number of levels of detail.
+   */
+	uint32_t getLodCount() const
+	{
+		return lods.size();
+	}
+
+	/**
+   * Get a level of detail of the object, with its first index in the mesh arena index buffer.
+   * 
+   * @param lodLevel  The level of detail, where 0 is the full mesh.
+   * 
+   * @return The level of detail.
+   */
+	const MeshLod &getLod(const uint32_t &lodLevel) const
+	{
+		return lods[lodLevel];
+	}
+
+	/**
+   * Get the meshlets of the full mesh of the object, with their first indices in the mesh arena index buffer, and their
+   *   spheres and cones in the space of the stored vertices, which the vertex matrix moves into object space.
+   * 
+   * @return The meshlets, which are empty for the objects whose mesh files have none.
+   */
+	const std::vector<Meshlet> &getMeshlets() const
+	{
+		return meshlets;
+	}
+
+	/**
+   * Get the ID of the vertex array object of the object, which is shared by every object in the mesh arena.
+   * 
+   * @return The vertex array object ID.
+   */
+	const GLuint &getVertexArrayId() const
+	{
+		return vertexArrayId;
+	}
+
+	/**
+   * Get the format the vertices of the object are stored in.
+   * 
+   * @return The vertex format.
+   */
+	const MeshVertexFormat &getVertexFormat() const
+	{
+		return meshAllocation.vertexFormat;
+	}
+
+	/**
+   * Get the matrix moving the stored vertex positions of the object into object space, which is applied before the model
+   * matrix. It's the identity for the full vertex format.
+   * 
+   * @return The vertex matrix.
+   */
+	const glm::mat4 &getVertexMatrix() const
+	{
+		return vertexMatrix;
+	}
+};
+
+/**
+ * Structure for tracking an object being loaded in the background.
+ */
+struct PendingObjectLoad
+{
+	// The key of the object.
+	std::string objectName;
+	// The file path to the object data.
+	std::string objectFilePath;
+	// The format the vertices of the object were asked to be stored in.
+	MeshVertexFormat vertexFormat;
+	// The mesh of the object being loaded by a worker thread.
+	std::future<MeshData> loadingMesh;
+	// The callbacks to call with the details of the object once it's created.
+	std::vector<std::function<void(const std::shared_ptr<const ObjectDetails> &)>> callbacks;
 };
 
 /**
@@ -124,265 +302,305 @@ public:
 class ObjectManager
 {
 private:
-	// Singleton instance of the object manager.
-	static ObjectManager instance;
-
 	// A map of created objects.
-	std::map<const std::string, const std::shared_ptr<const ObjectDetails>> namedObjects;
+	CountedMap<const std::string, const std::shared_ptr<const ObjectDetails>, MemorySubsystem::OBJECTS> namedObjects;
 	// A map counting the references to the created objects.
-	std::map<const std::string, int32_t> namedObjectReferences;
+	CountedMap<const std::string, int32_t, MemorySubsystem::OBJECTS> namedObjectReferences;
+	// The keys of the objects by the names they were asked for with, which the maps of the objects are keyed by instead,
+	//   so the models loading the same file under different names share a single object.
+	CountedMap<const std::string, std::string, MemorySubsystem::OBJECTS> objectKeys;
+	// The objects with no more references that are kept resident until they're evicted.
+	ResidencyCache residentObjects;
+	// The list of objects being loaded in the background, in the order they were requested.
+	CountedVector<std::shared_ptr<PendingObjectLoad>, MemorySubsystem::OBJECTS> pendingLoads;
+	// The number of objects requested since the last time there were no pending loads, used for reporting progress.
+	uint32_t requestedLoadsCount;
+	// The watcher of the files of the created objects, by the keys of the objects.
+	FileWatcher objectFileWatcher;
+	// The arenas holding the vertices and indices of the created objects, in the full and compact vertex formats.
+	MeshArena meshArena;
+	MeshArena compactMeshArena;
 
 	/**
-	 * Create a array buffer of the given vector type, and store data as static draw use.
+	 * Get the key of the object loaded from the given file in the given vertex format, being the normalized path to the
+	 * file, along with the format if it's the compact one, since the same file stored in another format is another object.
 	 * 
-	 * @param bufferData  The data to store in the buffer.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format the vertices of the object were asked to be stored in.
 	 * 
-	 * @return The ID of the array buffer.
+	 * @return The key of the object.
 	 */
-	template <typename VecType>
-	GLuint createBuffer(const std::vector<VecType> &bufferData)
+	static std::string getObjectKey(const std::string &objectFilePath, const MeshVertexFormat &vertexFormat)
 	{
-		// Define a variable for storing the buffer ID.
-		GLuint bufferId;
-		// Create a new buffer and store the ID.
-		glGenBuffers(1, &bufferId);
-		// Bind the buffer as an array buffer.
-		glBindBuffer(GL_ARRAY_BUFFER, bufferId);
-		// Store the data into the array buffer, with usage set as static draw (won't be modified, and will be used for drawing repeatedly).
-		glBufferData(GL_ARRAY_BUFFER, bufferData.size() * sizeof(VecType), &bufferData[0], GL_STATIC_DRAW);
-		// Unbind the buffer now that we're done.
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		// Return the ID of the created array buffer.
-		return bufferId;
+		const auto normalizedFilePath = std::filesystem::path(objectFilePath).lexically_normal().generic_string();
+		return vertexFormat == MeshVertexFormat::COMPACT ? normalizedFilePath + "#compact" : normalizedFilePath;
 	}
 
 	/**
-	 * Load the OBJ object file and create array buffers for it.
+	 * Get the arena holding the vertices of the given format.
+	 * 
+	 * @param vertexFormat  The vertex format.
 	 * 
-	 * @param objectName      The name of the object being loaded.
+	 * @return The mesh arena.
+	 */
+	MeshArena &getMeshArena(const MeshVertexFormat &vertexFormat)
+	{
+		return vertexFormat == MeshVertexFormat::COMPACT ? compactMeshArena : meshArena;
+	}
+
+	/**
+	 * Copy the loaded mesh of the object into the mesh arena, and create the details of the object.
+	 * 
+	 * @param objectName      The name of the object.
 	 * @param objectFilePath  The file path to the object data.
-	 * @param outVertices     The vector to store the object vertices to.
+	 * @param vertexFormat    The format the vertices of the object were asked to be stored in.
+	 * @param meshData        The loaded mesh of the object.
 	 * 
-	 * @return The number of vertices in the object.
+	 * @return The details of the created object.
 	 */
-	uint32_t loadObjObject(const std::string &objectName, const std::string &objectFilePath, std::vector<glm::vec3> &outVertices, GLuint *const vertexBufferId, GLuint *const uvBufferId, GLuint *const normalBufferId)
-	{
-		// Define vectors for storing the indices to the vertex information.
-		std::vector<uint32_t> vertexIndices, uvIndices, normalIndices;
-		// Define temporary vectors for storing the vertex information stored in the OBJ file.
-		std::vector<glm::vec3> tempVertices;
-		std::vector<glm::vec2> tempUvs;
-		std::vector<glm::vec3> tempNormals;
-
-		// Define vectors for storing the final list of vertex information of the object in order of their use for each triangle.
-		std::vector<glm::vec2> outUvs;
-		std::vector<glm::vec3> outNormals;
-
-		// Open the OBJ file.
-		const auto file = fopen(objectFilePath.c_str(), "r");
-		// Check if the file is accessible.
-		if (file == NULL)
+	std::shared_ptr<const ObjectDetails> createObjectFromMesh(const std::string &objectName, const std::string &objectFilePath, const MeshVertexFormat &vertexFormat, const MeshData &meshData)
+	{
+		// Copy the interleaved vertex information and the indices into the mesh arena of their format, whose vertex array
+		//   object already records the layout of its buffers, so rendering only needs to bind it.
+		//   A headless game has no GL context to upload to, so the object only keeps the bounds of its mesh on the CPU.
+		auto &objectMeshArena = getMeshArena(meshData.vertexFormat);
+		const auto meshAllocation = HEADLESS_ENABLED
+																		? MeshAllocation({meshData.vertexFormat, 0, static_cast<uint32_t>(meshData.vertices.size()), 0, static_cast<uint32_t>(meshData.indices.size())})
+																		: objectMeshArena.add(meshData);
+
+		// Move the levels of detail to the range of the index buffer holding the mesh, taking the whole mesh as the only level
+		//   if it has none.
+		auto lods = meshData.lods.empty() ? std::vector<MeshLod>({{0, meshAllocation.indexCount, 0.0f}}) : meshData.lods;
+		for (auto &lod : lods)
 		{
-			// Could not read the object file. Time to crash.
-			std::cout << objectName << std::endl
-								<< "Failed at object 1" << std::endl;
-			exit(1);
+			lod.firstIndex += meshAllocation.firstIndex;
 		}
-
-		// Keep reading the file until we hit a condition.
-		while (1)
+		// Move the meshlets to the range of the index buffer as well, and their spheres and cones into the space of the stored
+		//   vertices, which the instances are culled in. The radius is divided by the least scale of the vertex matrix, so the
+		//   sphere still holds the meshlet once the largest scale of the matrices of the instances is applied to it.
+		const auto inverseVertexMatrix = meshData.vertexFormat == MeshVertexFormat::COMPACT ? glm::inverse(MeshLoader::getCompactVertexMatrix(meshData.boundsMin, meshData.boundsMax)) : glm::mat4(1.0f);
+		const auto inverseScale = std::max(glm::length(glm::vec3(inverseVertexMatrix[0])), std::max(glm::length(glm::vec3(inverseVertexMatrix[1])), glm::length(glm::vec3(inverseVertexMatrix[2]))));
+		auto meshlets = meshData.meshlets;
+		for (auto &meshlet : meshlets)
 		{
-			// Define a variable for storing the first string in a line
-			char lineHeader[128];
-			// Read a string from the file.
-			int32_t res = fscanf(file, "%s", lineHeader);
-			// Check if we hit the end of the file.
-			if (res == EOF)
-			{
-				// Completed reading the file. So break out of the loop.
-				break;
-			}
+			meshlet.firstIndex += meshAllocation.firstIndex;
+			meshlet.boundingSphere = glm::vec4(glm::vec3(inverseVertexMatrix * glm::vec4(glm::vec3(meshlet.boundingSphere), 1.0f)), meshlet.boundingSphere.w * inverseScale);
+			meshlet.normalCone = glm::vec4(glm::mat3(inverseVertexMatrix) * glm::vec3(meshlet.normalCone), meshlet.normalCone.w);
+		}
 
-			// If the string equals "v".
-			if (strcmp(lineHeader, "v") == 0)
-			{
-				// Line defines a vertex position data.
-				// Define a variable for storing the vertex position.
-				glm::vec3 vertex;
-				// Read the position coordinates of the vertex from the file.
-				fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
-				// Store it in the temporary vertex position vector.
-				tempVertices.push_back(vertex);
-			}
-			// If the string equals "vt".
-			else if (strcmp(lineHeader, "vt") == 0)
-			{
-				// Line defines a vertex UV coordinates data.
-				// Define a variable for storing the vertex UV coordinates.
-				glm::vec2 uv;
-				// Read the UV coordinates of the vertex from the file.
-				fscanf(file, "%f %f\n", &uv.x, &uv.y);
-				// Store it in the temporary vertex UV coordinates vector.
-				tempUvs.push_back(uv);
-			}
-			// If the string equals "vt".
-			else if (strcmp(lineHeader, "vn") == 0)
-			{
-				// Line defines a vertex normal vector data.
-				// Define a variable for storing the vertex normal vector.
-				glm::vec3 normal;
-				// Read the normal vector of the vertex from the file.
-				fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
-				// Store it in the temporary vertex normal vector vector.
-				tempNormals.push_back(normal);
-			}
-			// If the string equals "f".
-			else if (strcmp(lineHeader, "f") == 0)
-			{
-				// Line defines the indexes of the vertex information that describes a single face/polygon of the object.
-				// Define a variable for storing the indices to the vertex information stored in the temp vectors.
-				uint32_t vertexIndex[4], uvIndex[4], normalIndex[4];
-
-				// Read the indices to the vertex information.
-				int32_t matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2], &vertexIndex[3], &uvIndex[3], &normalIndex[3]);
-				if (matches == 12)
-				{
-					// Push the vertex position indices of the face/polygon into the vertex position vector.
-					vertexIndices.push_back(vertexIndex[0]);
-					vertexIndices.push_back(vertexIndex[1]);
-					vertexIndices.push_back(vertexIndex[2]);
-					vertexIndices.push_back(vertexIndex[0]);
-					vertexIndices.push_back(vertexIndex[2]);
-					vertexIndices.push_back(vertexIndex[3]);
-
-					// Push the vertex UV coordinates indices of the face/polygon into the vertex UV coordinates vector.
-					uvIndices.push_back(uvIndex[0]);
-					uvIndices.push_back(uvIndex[1]);
-					uvIndices.push_back(uvIndex[2]);
-					uvIndices.push_back(uvIndex[0]);
-					uvIndices.push_back(uvIndex[2]);
-					uvIndices.push_back(uvIndex[3]);
-
-					// Push the vertex normal vector indices of the face/polygon into the vertex normal vector vector.
-					normalIndices.push_back(normalIndex[0]);
-					normalIndices.push_back(normalIndex[1]);
-					normalIndices.push_back(normalIndex[2]);
-					normalIndices.push_back(normalIndex[0]);
-					normalIndices.push_back(normalIndex[2]);
-					normalIndices.push_back(normalIndex[3]);
-				}
-				else if (matches == 9)
-				{
-					// Push the vertex position indices of the face/polygon into the vertex position vector.
-					vertexIndices.push_back(vertexIndex[0]);
-					vertexIndices.push_back(vertexIndex[1]);
-					vertexIndices.push_back(vertexIndex[2]);
-
-					// Push the vertex UV coordinates indices of the face/polygon into the vertex UV coordinates vector.
-					uvIndices.push_back(uvIndex[0]);
-					uvIndices.push_back(uvIndex[1]);
-					uvIndices.push_back(uvIndex[2]);
-
-					// Push the vertex normal vector indices of the face/polygon into the vertex normal vector vector.
-					normalIndices.push_back(normalIndex[0]);
-					normalIndices.push_back(normalIndex[1]);
-					normalIndices.push_back(normalIndex[2]);
-				}
-				else
-				{
-					// If we don't manage to read all nine coordinates, then this OBJ file is formatted in a way that we can't support. Close the file and time to crash.
-					fclose(file);
-					std::cout << objectName << std::endl
-										<< "Failed at object 2" << std::endl;
-					exit(1);
-				}
-			}
-			else
+		// Keep the unique positions of the coarsest level of detail as the collision hull, if asked to.
+		CountedVector<glm::vec3, MemorySubsystem::OBJECTS> collisionHull({});
+		if (COLLISION_HULLS_RETAINED && !meshData.lods.empty())
+		{
+			const auto &hullLod = meshData.lods.back();
+			for (auto i = hullLod.firstIndex; i < hullLod.firstIndex + hullLod.indexCount; i++)
 			{
-				// Some information about the object we don't care about. Read the entire line and ignore it.
-				char ingoreBuffer[1000];
-				fgets(ingoreBuffer, 1000, file);
+				collisionHull.push_back(meshData.vertices[meshData.indices[i]].position);
 			}
+			const auto isLess = [](const glm::vec3 &a, const glm::vec3 &b) {
+				return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+			};
+			std::sort(collisionHull.begin(), collisionHull.end(), isLess);
+			collisionHull.erase(std::unique(collisionHull.begin(), collisionHull.end()), collisionHull.end());
+			collisionHull.shrink_to_fit();
 		}
 
-		// Done reading the file, so close it.
-		fclose(file);
+		// Create a new object details with the captured data, and return it. The mesh data is released once it's copied.
+		return std::make_shared<ObjectDetails>(objectName, objectFilePath, vertexFormat, meshData.boundsMin, meshData.boundsMax, meshData.boundingRadius, meshData.axisRadius, meshData.pillHalfHeight, collisionHull, meshAllocation, lods, meshlets, HEADLESS_ENABLED ? 0 : objectMeshArena.getVertexArrayId());
+	}
 
-		// Loop through the vertex indices of the faces/polygons that we read.
-		for (uint32_t i = 0; i < vertexIndices.size(); i++)
+	/**
+	 * Get the GPU memory used by the object buffers.
+	 * 
+	 * @param objectDetails  The details of the object.
+	 * 
+	 * @return The size of the object buffers, in bytes.
+	 */
+	static uint64_t getObjectSize(const ObjectDetails &objectDetails)
+	{
+		return objectDetails.getVertexCount() * MeshArena::getVertexSize(objectDetails.getVertexFormat()) + objectDetails.meshAllocation.indexCount * sizeof(uint32_t);
+	}
+
+	/**
+	 * Remove the object from the created objects map, and give back its ranges of the mesh arena.
+	 * 
+	 * @param objectName  The name of the object to delete.
+	 */
+	void deleteObject(const std::string &objectName)
+	{
+		// Keep the object details alive until its ranges are given back.
+		const auto objectDetails = namedObjects.at(objectName);
+		// Remove the object from the created objects map, and stop watching its file.
+		namedObjects.erase(objectName);
+		objectFileWatcher.unwatch(objectName);
+		if (!HEADLESS_ENABLED)
 		{
-			// Grab the indices of the vertex information that represent the face/polygon.
-			auto vertexIndex = vertexIndices[i];
-			auto uvIndex = uvIndices[i];
-			auto normalIndex = normalIndices[i];
-
-			// Grab the actual vertex information that the indices point to.
-			auto vertex = tempVertices[vertexIndex - 1];
-			auto uv = tempUvs[uvIndex - 1];
-			auto normal = tempNormals[normalIndex - 1];
-
-			// Store the vertex information into the final output vectors.
-			outVertices.push_back(vertex);
-			outUvs.push_back(uv);
-			outNormals.push_back(normal);
+			getMeshArena(objectDetails->getVertexFormat()).remove(objectDetails->meshAllocation);
 		}
-
-		// Create buffers for the vertex information, and store them in the buffer ID output variables
-		*vertexBufferId = createBuffer(outVertices);
-		*uvBufferId = createBuffer(outUvs);
-		*normalBufferId = createBuffer(outNormals);
-
-		// Return the number of vertices that were read from the OBJ file.
-		return outVertices.size();
 	}
 
 	ObjectManager()
 			: namedObjects({}),
-				namedObjectReferences({}) {}
+				namedObjectReferences({}),
+				objectKeys({}),
+				residentObjects(),
+				pendingLoads({}),
+				requestedLoadsCount(0),
+				objectFileWatcher(),
+				meshArena(MeshVertexFormat::FULL),
+				compactMeshArena(MeshVertexFormat::COMPACT) {}
 
 public:
 	// Preventing copying the object manager, making sure only one instance can exist.
 	ObjectManager(const ObjectManager &) = delete;
 
 	/**
-	 * Load and create an object from the given object file path. If an object with the same name was already created,
-	 * return the same object.
+	 * Load and create an object from the given object file path. If an object was already created from the same file in the
+	 * same vertex format, under any name, return the same object.
 	 * 
 	 * @param objectName      The name of the object.
 	 * @param objectFilePath  The file path to the object data.
+	 * @param vertexFormat    The format to store the vertices of the object in, where its mesh allows it.
 	 * 
 	 * @return The details of the loaded object.
 	 */
-	const std::shared_ptr<const ObjectDetails> &createObject(const std::string &objectName, const std::string &objectFilePath)
+	const std::shared_ptr<const ObjectDetails> &createObject(const std::string &objectName, const std::string &objectFilePath, const MeshVertexFormat &vertexFormat = MeshVertexFormat::FULL)
 	{
-		// Check if an object with the name already exists.
-		const auto existingObject = namedObjects.find(objectName);
+		// Share the object with whatever else loaded the same file, keeping the name as an alias of it.
+		const auto objectKey = getObjectKey(objectFilePath, vertexFormat);
+		objectKeys[objectName] = objectKey;
+
+		// Check if an object with the key already exists.
+		const auto existingObject = namedObjects.find(objectKey);
 		if (existingObject != namedObjects.end())
 		{
-			// Object already loaded. Increase its reference count and return it.
-			namedObjectReferences[objectName]++;
+			// Object already loaded. Increase its reference count, keep it from being evicted, and return it.
+			namedObjectReferences[objectKey]++;
+			residentObjects.markUsed(objectKey);
 			return existingObject->second;
 		}
 
-		// Create variables for storing the object details after loading it.
-		std::vector<glm::vec3> vertices;
-		GLuint vertexBufferId;
-		GLuint uvBufferId;
-		GLuint normalBufferId;
+		// Load the mesh of the object, from its binary mesh file if possible.
+		const auto meshData = MeshLoader::loadMesh(objectKey, objectFilePath, vertexFormat);
+		// Create the object from the mesh.
+		const auto newObject = createObjectFromMesh(objectKey, objectFilePath, vertexFormat, meshData);
+
+		// Insert the newly created object into the map of created objects, and watch its file.
+		namedObjects.insert(std::make_pair(objectKey, newObject));
+		objectFileWatcher.watch(objectKey, {objectFilePath});
+		// Set the reference count of the object to 1.
+		namedObjectReferences[objectKey] = 1;
 
-		// Load the OBJ object file and store its details.
-		const uint32_t bufferSize = loadObjObject(objectName, objectFilePath, vertices, &vertexBufferId, &uvBufferId, &normalBufferId);
+		// Return the object details.
+		return namedObjects[objectKey];
+	}
 
-		// Create a new object details with the captured data.
-		const auto newObject = std::make_shared<ObjectDetails>(objectName, objectFilePath, vertices, vertexBufferId, uvBufferId, normalBufferId, bufferSize);
+	/**
+	 * Load and create an object from the given object file path in the background. The mesh is loaded by a worker thread,
+	 * and its buffers are created by processPendingLoads once it's ready. If an object was already created from the same
+	 * file in the same vertex format, under any name, the callback is called right away with it.
+	 * 
+	 * @param objectName      The name of the object.
+	 * @param objectFilePath  The file path to the object data.
+	 * @param callback        The function to call with the details of the object once it's created.
+	 * @param vertexFormat    The format to store the vertices of the object in, where its mesh allows it.
+	 */
+	void createObjectAsync(const std::string &objectName, const std::string &objectFilePath, const std::function<void(const std::shared_ptr<const ObjectDetails> &)> &callback, const MeshVertexFormat &vertexFormat = MeshVertexFormat::FULL)
+	{
+		// Share the object with whatever else loaded the same file, keeping the name as an alias of it.
+		const auto objectKey = getObjectKey(objectFilePath, vertexFormat);
+		objectKeys[objectName] = objectKey;
+
+		// Check if an object with the key already exists.
+		const auto existingObject = namedObjects.find(objectKey);
+		if (existingObject != namedObjects.end())
+		{
+			// Object already loaded. Increase its reference count, keep it from being evicted, and pass it on.
+			namedObjectReferences[objectKey]++;
+			residentObjects.markUsed(objectKey);
+			callback(existingObject->second);
+			return;
+		}
+
+		// Check if the object is already being loaded.
+		for (const auto &pendingLoad : pendingLoads)
+		{
+			if (pendingLoad->objectName == objectKey)
+			{
+				// Object is on its way. Increase its reference count and wait for it with the other callbacks.
+				namedObjectReferences[objectKey]++;
+				pendingLoad->callbacks.push_back(callback);
+				return;
+			}
+		}
+
+		// Start loading the mesh on a worker thread.
+		const auto pendingLoad = std::make_shared<PendingObjectLoad>();
+		pendingLoad->objectName = objectKey;
+		pendingLoad->objectFilePath = objectFilePath;
+		pendingLoad->vertexFormat = vertexFormat;
+		pendingLoad->loadingMesh = launchLoader(MeshLoader::loadMesh, objectKey, objectFilePath, vertexFormat);
+		pendingLoad->callbacks.push_back(callback);
+		pendingLoads.push_back(pendingLoad);
+		requestedLoadsCount++;
 
-		// Insert the newly created object into the map of created objects.
-		namedObjects.insert(std::make_pair(objectName, newObject));
 		// Set the reference count of the object to 1.
-		namedObjectReferences[objectName] = 1;
+		namedObjectReferences[objectKey] = 1;
+	}
 
-		// Return the object details.
-		return namedObjects[objectName];
+	/**
+	 * Create the objects whose meshes have finished loading in the background, and pass them on to their callbacks.
+	 */
+	void processPendingLoads()
+	{
+		for (auto pendingLoadIt = pendingLoads.begin(); pendingLoadIt != pendingLoads.end();)
+		{
+			auto &pendingLoad = **pendingLoadIt;
+
+			// Check if the mesh has finished loading, skipping it if not.
+			if (pendingLoad.loadingMesh.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				++pendingLoadIt;
+				continue;
+			}
+
+			// Create the object from the mesh, insert it into the map of created objects, and pass it on.
+			const auto newObject = createObjectFromMesh(pendingLoad.objectName, pendingLoad.objectFilePath, pendingLoad.vertexFormat, pendingLoad.loadingMesh.get());
+			namedObjects.insert(std::make_pair(pendingLoad.objectName, newObject));
+			objectFileWatcher.watch(pendingLoad.objectName, {pendingLoad.objectFilePath});
+			for (const auto &callback : pendingLoad.callbacks)
+			{
+				callback(newObject);
+			}
+
+			pendingLoadIt = pendingLoads.erase(pendingLoadIt);
+		}
+
+		// Reset the progress once all the objects are created.
+		if (pendingLoads.empty())
+		{
+			requestedLoadsCount = 0;
+		}
+	}
+
+	/**
+	 * Check if there are objects still being loaded in the background.
+	 * 
+	 * @return Whether there are pending object loads.
+	 */
+	bool hasPendingLoads() const
+	{
+		return !pendingLoads.empty();
+	}
+
+	/**
+	 * Get the progress of the objects being loaded in the background.
+	 * 
+	 * @return The fraction of the requested objects that have been created, from 0 to 1.
+	 */
+	float getPendingLoadProgress() const
+	{
+		return requestedLoadsCount == 0 ? 1.0f : 1.0f - (float)pendingLoads.size() / requestedLoadsCount;
 	}
 
 	/**
@@ -394,11 +612,12 @@ public:
    */
 	const std::shared_ptr<const ObjectDetails> &getObjectDetails(const std::string &objectName) const
 	{
-		return namedObjects.at(objectName);
+		return namedObjects.at(objectKeys.at(objectName));
 	}
 
 	/**
-	 * Delete a reference to the object, and destroy it if no more references are present.
+	 * Delete a reference to the object. Once no more references are present, the object is kept resident so it can be reused,
+	 * and the least recently used unused objects are destroyed if they go over the residency budget.
 	 * 
 	 * @param objectDetails  The details of the object to destroy.
 	 */
@@ -409,20 +628,67 @@ public:
 		// Check if there are no more references to the object.
 		if (namedObjectReferences[objectDetails->getObjectName()] <= 0)
 		{
-			// No more references left, so time to clean.
-			// Remove the object from the created objects references map.
+			// No more references left, so remove the object from the created objects references map and keep it resident.
 			namedObjectReferences.erase(objectDetails->getObjectName());
-			// Remove the object from the created objects map.
-			namedObjects.erase(objectDetails->getObjectName());
-			// Delete the array buffer containing the vertex position data of the object.
-			glDeleteBuffers(1, &objectDetails->vertexBufferId);
-			// Delete the array buffer containing the vertex UV coordinates data of the object.
-			glDeleteBuffers(1, &objectDetails->uvBufferId);
-			// Delete the array buffer containing the vertex normal vector data of the object.
-			glDeleteBuffers(1, &objectDetails->normalBufferId);
+			residentObjects.markUnused(objectDetails->getObjectName(), getObjectSize(*objectDetails));
+			// Destroy the unused objects that don't fit in the residency budget.
+			for (const auto &evictedObjectName : residentObjects.evict(OBJECT_RESIDENCY_BUDGET))
+			{
+				deleteObject(evictedObjectName);
+			}
 		}
 	}
 
+	/**
+	 * Reload the objects whose files changed since they were last checked. The meshes are swapped into the details every
+	 *   model already shares, so nothing has to ask for them again. The colliders of the models already created keep the
+	 *   shape of the old mesh until the models are created again. An object whose file can't be parsed keeps its last mesh.
+	 * 
+	 * @return The names of the reloaded objects.
+	 */
+	std::vector<std::string> reloadChangedObjects()
+	{
+		std::vector<std::string> reloadedObjectNames({});
+		for (const auto &objectName : objectFileWatcher.findChangedAssets())
+		{
+			const auto &objectDetails = namedObjects.at(objectName);
+			// A file still being written can fail to parse, in which case the last mesh is kept until it's written again.
+			auto meshData = MeshLoader::reloadMesh(objectName, objectDetails->objectFilePath, objectDetails->requestedVertexFormat);
+			if (meshData.indices.empty())
+			{
+				Logger::getInstance().warning(objectName, "\nFailed at reloading object, keeping the last one");
+				continue;
+			}
+			const auto reloadedObject = createObjectFromMesh(objectName, objectDetails->objectFilePath, objectDetails->requestedVertexFormat, meshData);
+
+			// Writing over the old ranges is ordered after the commands drawing with them.
+			getMeshArena(objectDetails->getVertexFormat()).remove(objectDetails->meshAllocation);
+			objectDetails->boundsMin = reloadedObject->boundsMin;
+			objectDetails->boundsMax = reloadedObject->boundsMax;
+			objectDetails->boundingRadius = reloadedObject->boundingRadius;
+			objectDetails->axisRadius = reloadedObject->axisRadius;
+			objectDetails->pillHalfHeight = reloadedObject->pillHalfHeight;
+			objectDetails->collisionHull = std::move(reloadedObject->collisionHull);
+			objectDetails->meshAllocation = reloadedObject->meshAllocation;
+			objectDetails->lods = std::move(reloadedObject->lods);
+			objectDetails->meshlets = std::move(reloadedObject->meshlets);
+			objectDetails->vertexArrayId = reloadedObject->vertexArrayId;
+			objectDetails->vertexMatrix = reloadedObject->vertexMatrix;
+			reloadedObjectNames.push_back(objectName);
+		}
+		return reloadedObjectNames;
+	}
+
+	/**
+	 * Get the GPU memory used by the objects, being the capacity of the mesh arena buffers.
+	 *
+	 * @return The size in bytes.
+	 */
+	uint64_t getGpuMemorySize() const
+	{
+		return meshArena.getCapacitySize() + compactMeshArena.getCapacitySize();
+	}
+
 	/**
    * Returns the singleton instance of the object manager.
    * 
@@ -430,11 +696,10 @@ public:
    */
 	static ObjectManager &getInstance()
 	{
+		// Singleton instance of the object manager, constructed the first time it's asked for.
+		static ObjectManager instance;
 		return instance;
 	}
 };
 
-// Initialize the object manager singleton instance static variable.
-ObjectManager ObjectManager::instance;
-
 #endif
\ No newline at end of file
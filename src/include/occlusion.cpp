@@ -0,0 +1,251 @@
+#ifndef INCLUDE_OCCLUSION_CPP
+#define INCLUDE_OCCLUSION_CPP
+
+#include <vector>
+#include <memory>
+#include <memory_resource>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+#include "common.cpp"
+#include "shader.cpp"
+#include "frame_arena.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Class for culling the models hidden behind other models, with a hardware occlusion query for each model in view. The
+ *   boxes around the models are drawn against the depth of the frame once the models were drawn, and the models whose
+ *   boxes had no samples pass are left out from the next frame on, until a query finds them in sight again. The results
+ *   are only read once the GPU has made them available, so the CPU never waits on them, at the cost of a model coming
+ *   into view a frame late.
+ */
+class OcclusionCuller
+{
+private:
+  /**
+   * Structure for the occlusion query of a model.
+   */
+  struct OcclusionQuery
+  {
+    // The ID of the query, created with the first test of the slot.
+    GLuint queryId;
+    // The generation of the handle of the model the query is for, so the model taking the slot over starts out in view.
+    uint32_t generation;
+    // Whether the query was issued and its result wasn't read yet.
+    bool pending;
+    // Whether the latest result found the model hidden.
+    bool occluded;
+  };
+
+  // How far the boxes are grown by for the tests, so the models drawn between two simulation steps stay inside them,
+  //   and the distance from a box the camera counts as inside it at, since the near plane would clip the box away.
+  static const float_t BOX_MARGIN;
+
+  // The shader program drawing the boxes, and the keys of the uniforms of the corners of the box.
+  const std::shared_ptr<const ShaderDetails> &boxShader;
+  const uint32_t boxMinCornerKey;
+  const uint32_t boxMaxCornerKey;
+  // The vertex array object drawn with, which has no attributes since the shader makes up the box from its uniforms.
+  const GLuint boxVertexArrayId;
+
+  // The queries of the models, by the index of the slot of their handles.
+  std::vector<OcclusionQuery> queries;
+  // The number of models hidden by the latest culling, and the number of queries issued by the latest tests.
+  uint32_t occludedModelsCount;
+  uint32_t issuedQueriesCount;
+
+  /**
+   * Get the query of the model, reset for it if it was last used by another model in the same slot.
+   *
+   * @param modelHandle  The handle of the model.
+   *
+   * @return The query of the model.
+   */
+  OcclusionQuery &getQuery(const SlotHandle &modelHandle)
+  {
+    if (modelHandle.index >= queries.size())
+    {
+      queries.resize(modelHandle.index + 1, {0, 0, false, false});
+    }
+    auto &query = queries[modelHandle.index];
+    if (query.generation != modelHandle.generation)
+    {
+      // A query still waiting for the previous model of the slot is dropped, since a new query on it replaces the result.
+      query.generation = modelHandle.generation;
+      query.pending = false;
+      query.occluded = false;
+    }
+    return query;
+  }
+
+  /**
+   * Check if the camera is close enough to the box around the model that the box can't be drawn for testing it.
+   *
+   * @param model           The model to check.
+   * @param cameraPosition  The position of the camera.
+   *
+   * @return Whether the camera is inside the box.
+   */
+  static bool isCameraInsideBox(const ModelBaseIntf &model, const glm::vec3 &cameraPosition)
+  {
+    const auto &transformedBox = model.getColliderDetails()->getColliderShape()->getTransformedBox();
+    return glm::all(glm::greaterThanEqual(cameraPosition, transformedBox.getMinCorner() - glm::vec3(BOX_MARGIN))) &&
+           glm::all(glm::lessThanEqual(cameraPosition, transformedBox.getMaxCorner() + glm::vec3(BOX_MARGIN)));
+  }
+
+public:
+  OcclusionCuller()
+      : boxShader(ShaderManager::getInstance().createShaderProgram("OcclusionBoxShader", "assets/shaders/vertex/occlusion_box.glsl", "assets/shaders/fragment/depth.glsl")),
+        boxMinCornerKey(ShaderManager::getInstance().getUniformKey("boxMinCorner")),
+        boxMaxCornerKey(ShaderManager::getInstance().getUniformKey("boxMaxCorner")),
+        boxVertexArrayId(VertexArray::create()),
+        queries({}),
+        occludedModelsCount(0),
+        issuedQueriesCount(0) {}
+
+  // Preventing copying the occlusion culler, since it owns its queries.
+  OcclusionCuller(const OcclusionCuller &) = delete;
+
+  ~OcclusionCuller()
+  {
+    for (const auto &query : queries)
+    {
+      if (query.queryId != 0)
+      {
+        glDeleteQueries(1, &query.queryId);
+      }
+    }
+    GlStateCache::getInstance().deleteVertexArrays(1, &boxVertexArrayId);
+    ShaderManager::getInstance().destroyShaderProgram(boxShader);
+  }
+
+  /**
+   * Read the results of the queries the GPU made available, and leave out the models found hidden by their latest
+   *   results. The models with a query still waiting keep the result before it.
+   *
+   * @param models          The models in view of the camera.
+   * @param cameraPosition  The position of the camera.
+   *
+   * @return The models not hidden behind other models.
+   */
+  std::pmr::vector<std::shared_ptr<ModelBaseIntf>> cullOccludedModels(const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &models, const glm::vec3 &cameraPosition)
+  {
+    std::pmr::vector<std::shared_ptr<ModelBaseIntf>> unoccludedModels(&FrameArena::getInstance());
+    unoccludedModels.reserve(models.size());
+    occludedModelsCount = 0;
+    for (const auto &model : models)
+    {
+      auto &query = getQuery(model->getModelHandle());
+      if (query.pending)
+      {
+        GLint queryResultAvailable = GL_FALSE;
+        glGetQueryObjectiv(query.queryId, GL_QUERY_RESULT_AVAILABLE, &queryResultAvailable);
+        if (queryResultAvailable == GL_TRUE)
+        {
+          GLuint queryResult = 0;
+          glGetQueryObjectuiv(query.queryId, GL_QUERY_RESULT, &queryResult);
+          query.occluded = queryResult == 0;
+          query.pending = false;
+        }
+      }
+      // The camera moving into a box hidden before would keep the model hidden, since the box can't be tested from inside.
+      if (query.occluded && !isCameraInsideBox(*model, cameraPosition))
+      {
+        occludedModelsCount++;
+        continue;
+      }
+      unoccludedModels.push_back(model);
+    }
+    return unoccludedModels;
+  }
+
+  /**
+   * Test the boxes around the models against the depth of the bound framebuffer, drawn with the bound camera matrices,
+   *   without writing to it. The models whose query is still waiting and those whose box the camera is inside aren't
+   *   tested again, the latter being counted as in view.
+   *
+   * @param models          The models in view of the camera, hidden or not.
+   * @param cameraPosition  The position of the camera.
+   */
+  void testModels(const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &models, const glm::vec3 &cameraPosition)
+  {
+    GlStateCache::getInstance().useProgram(boxShader->getShaderId());
+    GlStateCache::getInstance().bindVertexArray(boxVertexArrayId);
+    // Only count the samples passing the depth test, drawing both sides of the boxes without writing anything.
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    GlStateCache::getInstance().setCapability(GL_CULL_FACE, false);
+    issuedQueriesCount = 0;
+    for (const auto &model : models)
+    {
+      auto &query = getQuery(model->getModelHandle());
+      if (query.pending)
+      {
+        continue;
+      }
+      if (isCameraInsideBox(*model, cameraPosition))
+      {
+        query.occluded = false;
+        continue;
+      }
+      if (query.queryId == 0)
+      {
+        glGenQueries(1, &query.queryId);
+      }
+      const auto &transformedBox = model->getColliderDetails()->getColliderShape()->getTransformedBox();
+      const auto boxMinCorner = transformedBox.getMinCorner() - glm::vec3(BOX_MARGIN);
+      const auto boxMaxCorner = transformedBox.getMaxCorner() + glm::vec3(BOX_MARGIN);
+      glUniform3fv(boxShader->getUniformLocation(boxMinCornerKey), 1, &boxMinCorner[0]);
+      glUniform3fv(boxShader->getUniformLocation(boxMaxCornerKey), 1, &boxMaxCorner[0]);
+      glBeginQuery(GL_ANY_SAMPLES_PASSED, query.queryId);
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, 14);
+      glEndQuery(GL_ANY_SAMPLES_PASSED);
+      query.pending = true;
+      issuedQueriesCount++;
+    }
+    GlStateCache::getInstance().setCapability(GL_CULL_FACE, true);
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    GlStateCache::getInstance().bindVertexArray(0);
+  }
+
+  /**
+   * Bring every model back into view, dropping the results of the queries, such as once the culling is turned off.
+   */
+  void resetQueries()
+  {
+    for (auto &query : queries)
+    {
+      query.occluded = false;
+    }
+    occludedModelsCount = 0;
+    issuedQueriesCount = 0;
+  }
+
+  /**
+   * Get the number of models hidden by the latest culling.
+   *
+   * @return The number of hidden models.
+   */
+  uint32_t getOccludedModelsCount() const
+  {
+    return occludedModelsCount;
+  }
+
+  /**
+   * Get the number of queries issued by the latest tests, each of which is a draw call.
+   *
+   * @return The number of issued queries.
+   */
+  uint32_t getIssuedQueriesCount() const
+  {
+    return issuedQueriesCount;
+  }
+};
+
+// Initialize the margin of the boxes tested for occlusion.
+const float_t OcclusionCuller::BOX_MARGIN = 0.1f;
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef INCLUDE_PARALLEL_CPP
+#define INCLUDE_PARALLEL_CPP
+
+#include <functional>
+#include <algorithm>
+
+#include "profiler.cpp"
+#include "job_system.cpp"
+
+/**
+ * Class for splitting work into tasks that run in parallel on the job system. It does not depend on OpenGL, so it can
+ * also be used by tools.
+ */
+class ParallelTasks
+{
+private:
+  /**
+   * Get whether the work of the calling thread stays on it instead of being split into tasks.
+   * 
+   * @return The flag of the calling thread.
+   */
+  static bool &getSerialFlag()
+  {
+    thread_local bool serial = false;
+    return serial;
+  }
+
+public:
+  /**
+   * Set whether the work of the calling thread stays on it instead of being split into tasks, for the threads that each
+   * run one of many independent jobs side by side, which already keep every thread busy.
+   * 
+   * @param serial  Whether the work stays on the calling thread.
+   */
+  static void setSerial(const bool &serial)
+  {
+    getSerialFlag() = serial;
+  }
+
+  /**
+   * Get the number of tasks worth splitting work into, which is the number of hardware threads, or only the one if the
+   * work of the calling thread stays on it.
+   * 
+   * @return The number of tasks.
+   */
+  static uint32_t getTaskCount()
+  {
+    return getSerialFlag() ? 1 : JobSystem::getInstance().getThreadsCount();
+  }
+
+  /**
+   * Get the number of tasks to split the given number of items into, so that each task gets at least the given number of items.
+   * 
+   * @param itemCount     The number of items to split.
+   * @param minTaskItems  The minimum number of items worth running a task for.
+   * 
+   * @return The number of tasks.
+   */
+  static uint32_t getTaskCount(const size_t &itemCount, const size_t &minTaskItems)
+  {
+    return std::max<size_t>(1, std::min<size_t>(getTaskCount(), itemCount / std::max<size_t>(1, minTaskItems)));
+  }
+
+  /**
+   * Run the given number of tasks in parallel, and wait for all of them to complete. The first task runs on the calling
+   * thread, and the rest are taken by the workers of the job system, or by the calling thread once it runs out of work.
+   * 
+   * @param taskCount  The number of tasks to run.
+   * @param task       The function to run for each task, given the index of the task.
+   */
+  static void run(const uint32_t &taskCount, const std::function<void(const uint32_t)> &task)
+  {
+    // Each task is recorded as a profiling zone, so the tasks of the workers show up next to the calling thread.
+    const auto profiledTask = [&](const uint32_t taskIndex) {
+      ProfileZone taskZone("Parallel Task");
+      task(taskIndex);
+    };
+    JobSystem::getInstance().run(taskCount, profiledTask);
+  }
+
+  /**
+   * Split the range of items into contiguous chunks, and process the chunks in parallel.
+   * 
+   * @param itemCount     The number of items to process.
+   * @param minTaskItems  The minimum number of items worth running a task for.
+   * @param task          The function to run for each chunk, given the index of the chunk and the range of items in it.
+   * 
+   * @return The number of chunks the items were split into.
+   */
+  static uint32_t runChunked(const size_t &itemCount, const size_t &minTaskItems, const std::function<void(const uint32_t, const size_t, const size_t)> &task)
+  {
+    const auto taskCount = getTaskCount(itemCount, minTaskItems);
+    run(taskCount, [&](const uint32_t taskIndex) {
+      task(taskIndex, itemCount * taskIndex / taskCount, itemCount * (taskIndex + 1) / taskCount);
+    });
+    return taskCount;
+  }
+};
+
+#endif
@@ -0,0 +1,278 @@
+#ifndef INCLUDE_PARTICLES_CPP
+#define INCLUDE_PARTICLES_CPP
+
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+#include "common.cpp"
+#include "constants.cpp"
+#include "window.cpp"
+#include "shader.cpp"
+#include "gl_debug.cpp"
+
+/**
+ * Structure for a particle as the particle buffers hold it, matching the interleaved outputs of the update shader.
+ */
+struct Particle
+{
+  // The position of the particle.
+  glm::vec3 position;
+  // The time the particle was thrown out at, in seconds.
+  float_t birthTime;
+  // The velocity of the particle.
+  glm::vec3 velocity;
+  // The time the particle lives for, in seconds.
+  float_t lifetime;
+};
+
+/**
+ * A manager class for the bursts of particles thrown out where the models hit each other. The particles only ever live
+ *   on the GPU, moved by a vertex shader whose outputs are captured with transform feedback into a second buffer, which
+ *   the two buffers then swap for the next frame, and drawn as point sprites straight from the buffer they were moved
+ *   to. The CPU only keeps a ring of emitters, each owning a block of the particles, so a burst is the position and
+ *   the time written to the next emitter and the whole cost of a frame is uploading the emitters.
+ */
+class ParticleManager
+{
+private:
+  // The total number of particles, which the emitters share in equal blocks.
+  static const uint32_t PARTICLES_COUNT;
+  // The time the particles and the emitters start out born at, far enough in the past that they're all dead.
+  static const float_t UNBORN_TIME;
+
+  // The shader program moving the particles, and the one drawing them.
+  const std::shared_ptr<const ShaderDetails> &updateShader;
+  const std::shared_ptr<const ShaderDetails> &renderShader;
+  // The keys of the uniforms of the particle shaders.
+  const uint32_t emittersKey;
+  const uint32_t particleTimeKey;
+  const uint32_t particleDeltaTimeKey;
+  const uint32_t viewportHeightKey;
+
+  // The two particle buffers, read from and captured into in turn, and a vertex array object for reading each.
+  std::array<GLuint, 2> particleBufferIds;
+  std::array<GLuint, 2> particleVertexArrayIds;
+  // The index of the particle buffer holding the latest particles.
+  uint32_t currentBufferIndex;
+
+  // The emitters, with the position of their latest burst in xyz and the time it was emitted at in w.
+  std::array<glm::vec4, MAX_PARTICLE_EMITTERS> emitters;
+  // The index of the emitter the next burst is given to, going back to the first after the last.
+  uint32_t nextEmitterIndex;
+  // The time of the latest burst, and the time the particles were last moved at, in seconds.
+  double_t lastEmitTime;
+  double_t lastUpdateTime;
+  // The number of bursts emitted since the particles were last cleared.
+  uint64_t burstsCount;
+
+  ParticleManager()
+      : updateShader(ShaderManager::getInstance().createTransformFeedbackProgram("ParticleUpdateShader", "assets/shaders/vertex/particle_update.glsl",
+                                                                                  {"nextPosition", "nextBirthTime", "nextVelocity", "nextLifetime"})),
+        renderShader(ShaderManager::getInstance().createShaderProgram("ParticleShader", "assets/shaders/vertex/particle.glsl", "assets/shaders/fragment/particle.glsl")),
+        emittersKey(ShaderManager::getInstance().getUniformKey("emitters")),
+        particleTimeKey(ShaderManager::getInstance().getUniformKey("particleTime")),
+        particleDeltaTimeKey(ShaderManager::getInstance().getUniformKey("particleDeltaTime")),
+        viewportHeightKey(ShaderManager::getInstance().getUniformKey("viewportHeight")),
+        particleBufferIds({0, 0}),
+        particleVertexArrayIds({0, 0}),
+        currentBufferIndex(0),
+        emitters(),
+        nextEmitterIndex(0),
+        lastEmitTime(UNBORN_TIME),
+        lastUpdateTime(0.0),
+        burstsCount(0)
+  {
+    // Fill both buffers with particles born long ago, so none of them are alive until the first burst.
+    const std::vector<Particle> particles(PARTICLES_COUNT, {glm::vec3(0.0f), UNBORN_TIME, glm::vec3(0.0f), 1.0f});
+    emitters.fill(glm::vec4(0.0f, 0.0f, 0.0f, UNBORN_TIME));
+    glGenBuffers(2, particleBufferIds.data());
+    for (uint32_t i = 0; i < 2; i++)
+    {
+      GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, particleBufferIds[i]);
+      glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(Particle), particles.data(), GL_DYNAMIC_COPY);
+      GlStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, 0);
+      GpuDebugLabels::labelObject(GL_BUFFER, particleBufferIds[i], "Particles " + std::to_string(i));
+
+      // Read the interleaved particles of the buffer as the position, birth time, velocity and lifetime attributes.
+      particleVertexArrayIds[i] = VertexArray::create();
+      GlStateCache::getInstance().bindVertexArray(particleVertexArrayIds[i]);
+      VertexArray::attachAttribute(0, particleBufferIds[i], 3, sizeof(Particle), offsetof(Particle, position));
+      VertexArray::attachAttribute(1, particleBufferIds[i], 1, sizeof(Particle), offsetof(Particle, birthTime));
+      VertexArray::attachAttribute(2, particleBufferIds[i], 3, sizeof(Particle), offsetof(Particle, velocity));
+      VertexArray::attachAttribute(3, particleBufferIds[i], 1, sizeof(Particle), offsetof(Particle, lifetime));
+      GlStateCache::getInstance().bindVertexArray(0);
+    }
+  }
+
+public:
+  // Preventing copying the particle manager, making sure only one instance can exist.
+  ParticleManager(const ParticleManager &) = delete;
+
+  ~ParticleManager()
+  {
+    // Delete the particle buffers and their vertex array objects, and release the particle shaders.
+    GlStateCache::getInstance().deleteVertexArrays(2, particleVertexArrayIds.data());
+    GlStateCache::getInstance().deleteBuffers(2, particleBufferIds.data());
+    ShaderManager::getInstance().destroyShaderProgram(updateShader);
+    ShaderManager::getInstance().destroyShaderProgram(renderShader);
+  }
+
+  /**
+   * Throw out a burst of particles from the given position, reusing the emitter of the oldest burst. Must be called
+   *   while the particles aren't being updated or rendered.
+   *
+   * @param position  The position to throw the particles out from.
+   * @param time      The time of the burst, in seconds.
+   */
+  void emitBurst(const glm::vec3 &position, const double_t &time)
+  {
+    emitters[nextEmitterIndex] = glm::vec4(position, float_t(time));
+    nextEmitterIndex = (nextEmitterIndex + 1) % MAX_PARTICLE_EMITTERS;
+    lastEmitTime = time;
+    burstsCount++;
+  }
+
+  /**
+   * Kill all the particles, by moving the emitters back to before any particles were born.
+   */
+  void clearParticles()
+  {
+    emitters.fill(glm::vec4(0.0f, 0.0f, 0.0f, UNBORN_TIME));
+    nextEmitterIndex = 0;
+    lastEmitTime = UNBORN_TIME;
+    burstsCount = 0;
+  }
+
+  /**
+   * Check if any particles can still be alive at the given time, so the particles are only moved and drawn while the
+   *   latest burst lasts.
+   *
+   * @param time  The time of the frame, in seconds.
+   *
+   * @return Whether the particles are active.
+   */
+  bool isActive(const double_t &time) const
+  {
+    return time - lastEmitTime <= PARTICLE_MAX_LIFETIME;
+  }
+
+  /**
+   * Move the particles to where they are at the given time, throwing out the particles of the emitters given new
+   *   bursts since the last update. Does nothing while no particles are alive. Must be called once per frame, on the
+   *   thread owning the GL context.
+   *
+   * @param time  The time of the frame, in seconds.
+   *
+   * @return Whether the particles were moved.
+   */
+  bool updateParticles(const double_t &time)
+  {
+    // The time since the last update is only ever a frame long while the particles are updated every frame, but the
+    //   first update after a pause would move the particles still waiting for their burst a long way.
+    const auto deltaTime = float_t(glm::clamp(time - lastUpdateTime, 0.0, 0.1));
+    lastUpdateTime = time;
+    if (!isActive(time))
+    {
+      return false;
+    }
+
+    GpuDebugGroup updateGroup("Particle Update");
+    GlStateCache::getInstance().useProgram(updateShader->getShaderId());
+    glUniform4fv(updateShader->getUniformLocation(emittersKey), MAX_PARTICLE_EMITTERS, &emitters[0][0]);
+    glUniform1f(updateShader->getUniformLocation(particleTimeKey), float_t(time));
+    glUniform1f(updateShader->getUniformLocation(particleDeltaTimeKey), deltaTime);
+
+    // Move the particles of the current buffer into the other one, without drawing anything.
+    const auto nextBufferIndex = 1 - currentBufferIndex;
+    GlStateCache::getInstance().setCapability(GL_RASTERIZER_DISCARD, true);
+    GlStateCache::getInstance().bindVertexArray(particleVertexArrayIds[currentBufferIndex]);
+    GlStateCache::getInstance().bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, particleBufferIds[nextBufferIndex]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, PARTICLES_COUNT);
+    glEndTransformFeedback();
+    GlStateCache::getInstance().bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    GlStateCache::getInstance().bindVertexArray(0);
+    GlStateCache::getInstance().setCapability(GL_RASTERIZER_DISCARD, false);
+    currentBufferIndex = nextBufferIndex;
+    return true;
+  }
+
+  /**
+   * Draw the particles as point sprites to the bound framebuffer as they were at the last update, blended over what is
+   *   already there and depth tested against it without writing to the depth buffer. Does nothing while no particles
+   *   are alive.
+   *
+   * @param viewportHeight  The height of the viewport, in pixels, which the sizes of the particles are scaled by.
+   *
+   * @return Whether the particles were drawn.
+   */
+  bool renderParticles(const float_t &viewportHeight) const
+  {
+    if (!isActive(lastUpdateTime))
+    {
+      return false;
+    }
+
+    GpuDebugGroup renderGroup("Particles");
+    GlStateCache::getInstance().useProgram(renderShader->getShaderId());
+    glUniform1f(renderShader->getUniformLocation(particleTimeKey), float_t(lastUpdateTime));
+    glUniform1f(renderShader->getUniformLocation(viewportHeightKey), viewportHeight);
+
+    // Add the particles onto the scene, so the overlapping ones glow brighter and their order doesn't matter.
+    GlStateCache::getInstance().setCapability(GL_PROGRAM_POINT_SIZE, true);
+    glDepthMask(GL_FALSE);
+    WindowManager::getInstance().enableBlending(GL_SRC_ALPHA, GL_ONE);
+    GlStateCache::getInstance().bindVertexArray(particleVertexArrayIds[currentBufferIndex]);
+    glDrawArrays(GL_POINTS, 0, PARTICLES_COUNT);
+    GlStateCache::getInstance().bindVertexArray(0);
+    WindowManager::getInstance().disableBlending();
+    glDepthMask(GL_TRUE);
+    GlStateCache::getInstance().setCapability(GL_PROGRAM_POINT_SIZE, false);
+    return true;
+  }
+
+  /**
+   * Get the total number of particles, alive or not, which each update and draw goes over.
+   *
+   * @return The number of particles.
+   */
+  uint32_t getParticlesCount() const
+  {
+    return PARTICLES_COUNT;
+  }
+
+  /**
+   * Get the number of bursts emitted since the particles were last cleared.
+   *
+   * @return The number of bursts.
+   */
+  uint64_t getBurstsCount() const
+  {
+    return burstsCount;
+  }
+
+  /**
+   * Returns the singleton instance of the particle manager.
+   *
+   * @return The particle manager singleton instance.
+   */
+  static ParticleManager &getInstance()
+  {
+    // Singleton instance of the particle manager, constructed the first time it's asked for.
+    static ParticleManager instance;
+    return instance;
+  }
+};
+
+// Initialize the static variables of the particle manager.
+const uint32_t ParticleManager::PARTICLES_COUNT = MAX_PARTICLE_EMITTERS * PARTICLES_PER_EMITTER;
+const float_t ParticleManager::UNBORN_TIME = -1e6f;
+
+#endif
@@ -0,0 +1,471 @@
+#ifndef INCLUDE_PROFILER_CPP
+#define INCLUDE_PROFILER_CPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "allocation_counter.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for defining a profiling zone that was recorded.
+ */
+struct ProfileZoneRecord
+{
+  // The name of the zone.
+  std::string name;
+  // The times the zone started and ended at, in microseconds since the profiler started.
+  double_t startTime;
+  double_t endTime;
+  // The frame the zone ended in.
+  uint64_t frame;
+  // The number of heap allocations the thread made during the zone.
+  uint64_t allocationsCount;
+};
+
+/**
+ * Class for the ring buffer of the profiling zones recorded by a single thread. Only the thread owning the buffer writes
+ * to it, so it needs no locking.
+ */
+class ProfileThreadBuffer
+{
+private:
+  // The number of zones kept before the oldest ones start getting overwritten.
+  static const uint32_t MAX_RECORDS = 65536;
+
+  // The ID of the thread in the exported traces.
+  const uint32_t threadId;
+  // The recorded zones, growing up to the maximum before being reused from the start.
+  std::vector<ProfileZoneRecord> records;
+  // The total number of zones recorded by the thread.
+  uint64_t recordsCount;
+
+public:
+  ProfileThreadBuffer(const uint32_t &threadId)
+      : threadId(threadId),
+        records({}),
+        recordsCount(0) {}
+
+  /**
+   * Record a zone, replacing the oldest zone once the buffer is full.
+   *
+   * @param name       The name of the zone.
+   * @param startTime  The time the zone started at, in microseconds.
+   * @param endTime    The time the zone ended at, in microseconds.
+   * @param frame             The frame the zone ended in.
+   * @param allocationsCount  The number of heap allocations made during the zone.
+   */
+  void addRecord(const std::string &name, const double_t &startTime, const double_t &endTime, const uint64_t &frame, const uint64_t &allocationsCount)
+  {
+    if (records.size() < MAX_RECORDS)
+    {
+      records.push_back({name, startTime, endTime, frame, allocationsCount});
+    }
+    else
+    {
+      // Assigning over the oldest record reuses the memory of its name.
+      auto &record = records[recordsCount % MAX_RECORDS];
+      record.name = name;
+      record.startTime = startTime;
+      record.endTime = endTime;
+      record.frame = frame;
+      record.allocationsCount = allocationsCount;
+    }
+    recordsCount++;
+  }
+
+  /**
+   * Get the ID of the thread in the exported traces.
+   *
+   * @return The thread ID.
+   */
+  const uint32_t &getThreadId() const
+  {
+    return threadId;
+  }
+
+  /**
+   * Get the zones recorded by the thread that are still in the buffer, in no particular order.
+   *
+   * @return The recorded zones.
+   */
+  const std::vector<ProfileZoneRecord> &getRecords() const
+  {
+    return records;
+  }
+
+  /**
+   * Get the frame of the latest zone recorded by the thread.
+   *
+   * @return The frame of the latest zone, or 0 if there are none.
+   */
+  uint64_t getLastFrame() const
+  {
+    return recordsCount == 0 ? 0 : records[(recordsCount - 1) % MAX_RECORDS].frame;
+  }
+};
+
+/**
+ * A class to manage the profiling zones recorded by every thread, and export the latest frames of them as a trace that
+ * can be opened in chrome://tracing or Perfetto.
+ */
+class ProfileManager
+{
+private:
+  // The time the profiler started.
+  const std::chrono::steady_clock::time_point startTime;
+  // The current frame, which the zones ending now are recorded in.
+  uint64_t currentFrame;
+
+  // The lock guarding the list of thread buffers, since threads register their buffers on their first zone.
+  std::mutex threadBuffersMutex;
+  // The buffers of the threads that recorded zones, kept after their threads end until their zones are too old to export.
+  std::vector<std::shared_ptr<ProfileThreadBuffer>> threadBuffers;
+  // The ID given to the next thread buffer.
+  uint32_t nextThreadId;
+  // Whether the zones marked as allocation free stop the program when they allocate, which any thread can read.
+  std::atomic<bool> allocationFreeZonesChecked;
+
+  ProfileManager()
+      : startTime(std::chrono::steady_clock::now()),
+        currentFrame(0),
+        threadBuffersMutex(),
+        threadBuffers({}),
+        nextThreadId(0),
+        allocationFreeZonesChecked(false) {}
+
+  /**
+   * Escape the text for a JSON string, so the quotes, backslashes and control characters in it don't end the string
+   * early or make the trace invalid.
+   *
+   * @param text  The text to escape.
+   *
+   * @return The escaped text, without the quotes around it.
+   */
+  static std::string escapeJsonString(const std::string &text)
+  {
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string escapedText;
+    escapedText.reserve(text.size());
+    for (const auto character : text)
+    {
+      switch (character)
+      {
+      case '"':
+        escapedText += "\\\"";
+        break;
+      case '\\':
+        escapedText += "\\\\";
+        break;
+      case '\n':
+        escapedText += "\\n";
+        break;
+      case '\t':
+        escapedText += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(character) < 0x20)
+        {
+          escapedText += "\\u00";
+          escapedText += hexDigits[(character >> 4) & 0xf];
+          escapedText += hexDigits[character & 0xf];
+        }
+        else
+        {
+          escapedText += character;
+        }
+      }
+    }
+    return escapedText;
+  }
+
+public:
+  // Preventing copying the profile manager, making sure only one instance can exist.
+  ProfileManager(const ProfileManager &) = delete;
+
+  /**
+   * Get the time since the profiler started.
+   *
+   * @return The time, in microseconds.
+   */
+  double_t getTime() const
+  {
+    return std::chrono::duration<double_t, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+  }
+
+  /**
+   * Get the current frame.
+   *
+   * @return The current frame.
+   */
+  const uint64_t &getCurrentFrame() const
+  {
+    return currentFrame;
+  }
+
+  /**
+   * Move on to the next frame, and drop the buffers of the threads that have ended once their zones are older than the
+   * given number of frames.
+   *
+   * @param framesKept  The number of latest frames that can still be exported.
+   */
+  void nextFrame(const uint64_t &framesKept)
+  {
+    currentFrame++;
+    std::lock_guard<std::mutex> threadBuffersLock(threadBuffersMutex);
+    threadBuffers.erase(std::remove_if(threadBuffers.begin(), threadBuffers.end(), [&](const std::shared_ptr<ProfileThreadBuffer> &threadBuffer) {
+                          // Only the list holds on to the buffers of the threads that ended.
+                          return threadBuffer.use_count() == 1 && threadBuffer->getLastFrame() + framesKept < currentFrame;
+                        }),
+                        threadBuffers.end());
+  }
+
+  /**
+   * Set whether the zones marked as allocation free stop the program when they allocate, which is meant to be turned on
+   * once the frames have warmed up the storage they reuse.
+   *
+   * @param checked  Whether the allocation free zones are checked.
+   */
+  void setAllocationFreeZonesChecked(const bool &checked)
+  {
+    allocationFreeZonesChecked.store(checked, std::memory_order_relaxed);
+  }
+
+  /**
+   * Get whether the zones marked as allocation free stop the program when they allocate.
+   *
+   * @return Whether the allocation free zones are checked.
+   */
+  bool areAllocationFreeZonesChecked() const
+  {
+    return allocationFreeZonesChecked.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get the buffer the current thread records its zones to, creating it on the first call from the thread.
+   *
+   * @return The buffer of the current thread.
+   */
+  ProfileThreadBuffer &getThreadBuffer()
+  {
+    thread_local std::shared_ptr<ProfileThreadBuffer> threadBuffer;
+    if (!threadBuffer)
+    {
+      std::lock_guard<std::mutex> threadBuffersLock(threadBuffersMutex);
+      threadBuffer = std::make_shared<ProfileThreadBuffer>(nextThreadId++);
+      threadBuffers.push_back(threadBuffer);
+    }
+    return *threadBuffer;
+  }
+
+  /**
+   * Write the zones of the given number of latest frames to a file in the Chrome trace event format. This should be
+   * called while no other thread is recording zones.
+   *
+   * @param filePath     The path of the file to write the trace to.
+   * @param framesCount  The number of latest frames to write.
+   * @param metadata     The names and values written along with the zones, which the trace viewers show as the
+   *                     metadata of the trace.
+   *
+   * @return The number of zones written.
+   */
+  uint64_t exportChromeTrace(const std::string &filePath, const uint64_t &framesCount, const std::vector<std::pair<std::string, std::string>> &metadata = {})
+  {
+    std::ofstream traceFile(filePath, std::ios::out | std::ios::trunc);
+    if (!traceFile.is_open())
+    {
+      Logger::getInstance().error("Failed at profiler 1");
+      return 0;
+    }
+
+    uint64_t zonesCount = 0;
+    const auto firstFrame = currentFrame >= framesCount ? currentFrame - framesCount : 0;
+    traceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    std::lock_guard<std::mutex> threadBuffersLock(threadBuffersMutex);
+    for (const auto &threadBuffer : threadBuffers)
+    {
+      for (const auto &record : threadBuffer->getRecords())
+      {
+        if (record.frame < firstFrame)
+        {
+          continue;
+        }
+        // Each zone is written as a complete event, which the trace viewers nest by their times.
+        traceFile << (zonesCount == 0 ? "" : ",") << "\n{\"name\":\"" << escapeJsonString(record.name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadBuffer->getThreadId()
+                  << ",\"ts\":" << std::to_string(record.startTime) << ",\"dur\":" << std::to_string(record.endTime - record.startTime)
+                  << ",\"args\":{\"frame\":" << record.frame << ",\"allocations\":" << record.allocationsCount << "}}";
+        zonesCount++;
+      }
+    }
+    traceFile << "\n]";
+    if (!metadata.empty())
+    {
+      traceFile << ",\"otherData\":{";
+      for (size_t i = 0; i < metadata.size(); i++)
+      {
+        traceFile << (i == 0 ? "" : ",") << "\n\"" << escapeJsonString(metadata[i].first) << "\":\"" << escapeJsonString(metadata[i].second) << "\"";
+      }
+      traceFile << "\n}";
+    }
+    traceFile << "}\n";
+    return zonesCount;
+  }
+
+  /**
+   * Returns the singleton instance of the profile manager.
+   *
+   * @return The profile manager singleton instance.
+   */
+  static ProfileManager &getInstance()
+  {
+    // Singleton instance of the profile manager, constructed the first time it's asked for.
+    static ProfileManager instance;
+    return instance;
+  }
+};
+
+
+/**
+ * Class for a profiling zone covering the scope it's created in, or until it's ended early. Zones created inside other
+ * zones show up nested under them in the exported traces.
+ */
+class ProfileZone
+{
+private:
+  // The innermost zone of the current thread that hasn't ended yet.
+  static thread_local ProfileZone *currentZone;
+
+  // The name of the zone.
+  const std::string name;
+  // The zone this zone was started inside of, or null if it's the outermost zone of the thread.
+  ProfileZone *parentZone;
+  // Whether the zone is expected not to allocate, once the allocation free zones are checked.
+  const bool allocationFree;
+  // The time the zone started at, in microseconds.
+  const double_t startTime;
+  // The number of allocations the thread made before the zone started, counted after the name is copied.
+  const uint64_t startAllocationsCount;
+  // Whether the zone was already ended.
+  bool ended;
+  // The time the zone took once it ended, in milliseconds.
+  double_t duration;
+  // The number of allocations the thread made during the zone once it ended.
+  uint64_t allocationsCount;
+
+public:
+  /**
+   * Start a profiling zone.
+   *
+   * @param name            The name of the zone.
+   * @param allocationFree  Whether the zone is expected not to allocate, stopping the program if it does while the
+   *                        allocation free zones are checked.
+   */
+  ProfileZone(const std::string &name, const bool &allocationFree = false)
+      : name(name),
+        parentZone(currentZone),
+        allocationFree(allocationFree),
+        startTime(ProfileManager::getInstance().getTime()),
+        startAllocationsCount(AllocationCounter::getThreadAllocationsCount()),
+        ended(false),
+        duration(0.0),
+        allocationsCount(0)
+  {
+    currentZone = this;
+  }
+
+  // Preventing copying the zone, since it would be recorded twice.
+  ProfileZone(const ProfileZone &) = delete;
+
+  ~ProfileZone()
+  {
+    end();
+  }
+
+  /**
+   * End the zone and record it, if it wasn't already ended.
+   *
+   * @return The time the zone took, in milliseconds.
+   */
+  double_t end()
+  {
+    if (!ended)
+    {
+      // Count the allocations before recording the zone, since recording it can allocate.
+      allocationsCount = AllocationCounter::getThreadAllocationsCount() - startAllocationsCount;
+      auto &profileManager = ProfileManager::getInstance();
+      const auto endTime = profileManager.getTime();
+      if (allocationFree && allocationsCount > 0 && profileManager.areAllocationFreeZonesChecked())
+      {
+        Logger::getInstance().error("Failed at profiler 2: ", allocationsCount, " allocations in zone ", name);
+        exit(1);
+      }
+      profileManager.getThreadBuffer().addRecord(name, startTime, endTime, profileManager.getCurrentFrame(), allocationsCount);
+      // Take the zone out of the zones of the thread, which it isn't the innermost of if a zone inside it is still going.
+      auto zoneLink = &currentZone;
+      while (*zoneLink != nullptr && *zoneLink != this)
+      {
+        zoneLink = &(*zoneLink)->parentZone;
+      }
+      if (*zoneLink != nullptr)
+      {
+        *zoneLink = parentZone;
+      }
+      ended = true;
+      duration = (endTime - startTime) / 1000.0;
+    }
+    return duration;
+  }
+
+  /**
+   * Get the number of heap allocations the thread made during the zone, once it's ended.
+   *
+   * @return The number of allocations.
+   */
+  const uint64_t &getAllocationsCount() const
+  {
+    return allocationsCount;
+  }
+
+  /**
+   * Get the name of the zone.
+   *
+   * @return The name of the zone.
+   */
+  const std::string &getName() const
+  {
+    return name;
+  }
+
+  /**
+   * Get the zone this zone was started inside of, if it hasn't ended yet.
+   *
+   * @return The parent zone, or null if there is none.
+   */
+  const ProfileZone *getParentZone() const
+  {
+    return parentZone;
+  }
+
+  /**
+   * Get the innermost zone of the current thread that hasn't ended yet, which tells where the thread is in the frame.
+   *
+   * @return The innermost zone, or null if there is none.
+   */
+  static const ProfileZone *getCurrentZone()
+  {
+    return currentZone;
+  }
+};
+
+// Initialize the innermost zone static variable.
+thread_local ProfileZone *ProfileZone::currentZone = nullptr;
+
+#endif
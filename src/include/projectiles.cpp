@@ -0,0 +1,409 @@
+#ifndef INCLUDE_PROJECTILES_CPP
+#define INCLUDE_PROJECTILES_CPP
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PROJECTILES_SSE2
+#endif
+
+#include <glm/glm.hpp>
+
+#include "collider.cpp"
+#include "models.cpp"
+#include "parallel.cpp"
+#include "profiler.cpp"
+#include "constants.cpp"
+#include "slot_map.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * A manager class for the projectiles fired by the hundreds, which are too many to be models of their own. The
+ *   projectiles are kept in flat lists of each of their fields, in the order they were fired, so all of them are moved
+ *   four at a time using SSE2, or one at a time with the same math where SSE2 isn't available. Their paths are then tested against the broadphases
+ *   of the model manager in parallel chunks, and they are all drawn as instances of a single model.
+ */
+class ProjectileManager
+{
+private:
+  // The minimum number of projectiles worth splitting the tests of their paths across parallel tasks.
+  static constexpr size_t MIN_PARALLEL_PROJECTILE_TESTS = 256;
+
+  // The model manager, whose broadphases the paths of the projectiles are tested against.
+  ModelManager &modelManager;
+  // The event bus the models hit publish their destroys to.
+  EventBus &eventBus;
+
+  // The model the projectiles are drawn as, standing at the origin, which is never registered.
+  std::shared_ptr<ModelBaseIntf> projectileModel;
+
+  // The positions of the projectiles, along each axis.
+  std::vector<float_t> positionsX;
+  std::vector<float_t> positionsY;
+  std::vector<float_t> positionsZ;
+  // The positions of the projectiles before the latest step, along each axis, which their paths start from.
+  std::vector<float_t> previousPositionsX;
+  std::vector<float_t> previousPositionsY;
+  std::vector<float_t> previousPositionsZ;
+  // The velocities of the projectiles, along each axis.
+  std::vector<float_t> velocitiesX;
+  std::vector<float_t> velocitiesY;
+  std::vector<float_t> velocitiesZ;
+  // The time the projectiles have left before they're removed, in seconds.
+  std::vector<float_t> lifetimes;
+  // The handles of the models that fired the projectiles, which the projectiles never hit.
+  std::vector<SlotHandle> owners;
+  // The masks of the collision layers of the models the projectiles can hit.
+  std::vector<uint32_t> collisionMasks;
+  // The handles of the models the projectiles hit in the latest step, which are invalid for the projectiles that
+  //   didn't hit anything.
+  std::vector<SlotHandle> hitModelHandles;
+  // The positions to draw the projectiles at, between where they were at the previous and the latest step.
+  std::vector<glm::vec3> renderPositions;
+
+  // The lists the handles of the models found by the broadphases are stored to by each task, reused between steps.
+  std::vector<std::vector<SlotHandle>> taskCandidateHandles;
+  std::vector<std::vector<SlotHandle>> taskStaticCandidateHandles;
+
+  // The number of projectiles that hit a model in the latest step.
+  uint32_t hitsCount;
+
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local ProjectileManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the projectile manager, which is the one of the default world.
+   *
+   * @return The projectile manager singleton instance.
+   */
+  static ProjectileManager &getSingleton()
+  {
+    // Singleton instance of the projectile manager, constructed the first time it's asked for.
+    static ProjectileManager instance;
+    return instance;
+  }
+
+  ProjectileManager()
+      : modelManager(ModelManager::getInstance()),
+        eventBus(EventBus::getInstance()),
+        projectileModel(nullptr),
+        positionsX({}),
+        positionsY({}),
+        positionsZ({}),
+        previousPositionsX({}),
+        previousPositionsY({}),
+        previousPositionsZ({}),
+        velocitiesX({}),
+        velocitiesY({}),
+        velocitiesZ({}),
+        lifetimes({}),
+        owners({}),
+        collisionMasks({}),
+        hitModelHandles({}),
+        renderPositions({}),
+        taskCandidateHandles(ParallelTasks::getTaskCount()),
+        taskStaticCandidateHandles(ParallelTasks::getTaskCount()),
+        hitsCount(0)
+  {
+    // Make room for all the projectiles there can be up front, so firing them never allocates.
+    for (auto field : {&positionsX, &positionsY, &positionsZ, &previousPositionsX, &previousPositionsY, &previousPositionsZ, &velocitiesX, &velocitiesY, &velocitiesZ, &lifetimes})
+    {
+      field->reserve(MAX_PROJECTILES_COUNT);
+    }
+    owners.reserve(MAX_PROJECTILES_COUNT);
+    collisionMasks.reserve(MAX_PROJECTILES_COUNT);
+    hitModelHandles.reserve(MAX_PROJECTILES_COUNT);
+    renderPositions.reserve(MAX_PROJECTILES_COUNT);
+  }
+
+  /**
+   * Remove the projectile, moving the last projectile into its place.
+   *
+   * @param index  The index of the projectile.
+   */
+  void removeProjectile(const size_t &index)
+  {
+    const auto removeField = [&](auto &field) {
+      field[index] = field.back();
+      field.pop_back();
+    };
+    removeField(positionsX);
+    removeField(positionsY);
+    removeField(positionsZ);
+    removeField(previousPositionsX);
+    removeField(previousPositionsY);
+    removeField(previousPositionsZ);
+    removeField(velocitiesX);
+    removeField(velocitiesY);
+    removeField(velocitiesZ);
+    removeField(lifetimes);
+    removeField(owners);
+    removeField(collisionMasks);
+    removeField(hitModelHandles);
+    removeField(renderPositions);
+  }
+
+  /**
+   * Find the first model each of the given projectiles hit along its path since the previous step.
+   *
+   * @param taskIndex  The index of the task testing the projectiles, whose lists the broadphases are queried into.
+   * @param begin      The index of the first projectile to test.
+   * @param end        The index after the last projectile to test.
+   */
+  void testProjectilePaths(const uint32_t &taskIndex, const size_t &begin, const size_t &end)
+  {
+    auto &candidateHandles = taskCandidateHandles[taskIndex];
+    auto &staticCandidateHandles = taskStaticCandidateHandles[taskIndex];
+    for (size_t i = begin; i < end; i++)
+    {
+      hitModelHandles[i] = {0, 0};
+      const glm::vec3 start(previousPositionsX[i], previousPositionsY[i], previousPositionsZ[i]);
+      const glm::vec3 path = glm::vec3(positionsX[i], positionsY[i], positionsZ[i]) - start;
+      const auto pathLength = glm::length(path);
+      if (collisionMasks[i] == 0 || pathLength <= 0.0f)
+      {
+        continue;
+      }
+
+      // Find the models around the path, and test the path as a ray against the shapes of their colliders.
+      modelManager.findCollisionCandidateHandles(AxisAlignedBoundingBox(glm::min(start, start + path), glm::max(start, start + path)), collisionMasks[i], candidateHandles, staticCandidateHandles);
+      const Ray ray(start, path);
+      auto nearestDistance = pathLength;
+      for (const auto candidates : {&candidateHandles, &staticCandidateHandles})
+      {
+        for (const auto &candidateHandle : *candidates)
+        {
+          float_t distance;
+          if (candidateHandle != owners[i] && DeepCollisionValidator::raycast(ray, *modelManager.getModel(candidateHandle)->getColliderDetails()->getColliderShape(), nearestDistance, distance))
+          {
+            nearestDistance = distance;
+            hitModelHandles[i] = candidateHandle;
+          }
+        }
+      }
+    }
+  }
+
+public:
+  // Preventing copying the projectile manager, making sure only one instance can exist.
+  ProjectileManager(const ProjectileManager &) = delete;
+
+  /**
+   * Set the model the projectiles are drawn as. The model is drawn moved to each projectile, as it would be drawn standing
+   *   at the origin.
+   *
+   * @param newProjectileModel  The model, or nothing to stop drawing the projectiles.
+   */
+  void setProjectileModel(const std::shared_ptr<ModelBaseIntf> &newProjectileModel)
+  {
+    projectileModel = newProjectileModel;
+  }
+
+  /**
+   * Get the model the projectiles are drawn as.
+   *
+   * @return The projectile model, or nothing if the projectiles aren't drawn.
+   */
+  const std::shared_ptr<ModelBaseIntf> &getProjectileModel() const
+  {
+    return projectileModel;
+  }
+
+  /**
+   * Fire a projectile, unless there are already as many projectiles as there can be.
+   *
+   * @param ownerHandle    The handle of the model firing the projectile, which the projectile never hits.
+   * @param position       The position to fire the projectile from.
+   * @param velocity       The velocity of the projectile.
+   * @param lifetime       The time before the projectile is removed, in seconds.
+   * @param collisionMask  The mask of the collision layers of the models the projectile can hit.
+   *
+   * @return Whether the projectile was fired.
+   */
+  bool fireProjectile(const SlotHandle &ownerHandle, const glm::vec3 &position, const glm::vec3 &velocity, const float_t &lifetime, const uint32_t &collisionMask)
+  {
+    if (lifetimes.size() >= MAX_PROJECTILES_COUNT)
+    {
+      return false;
+    }
+    positionsX.push_back(position.x);
+    positionsY.push_back(position.y);
+    positionsZ.push_back(position.z);
+    // The projectile starts where it's fired, so its first path starts there too.
+    previousPositionsX.push_back(position.x);
+    previousPositionsY.push_back(position.y);
+    previousPositionsZ.push_back(position.z);
+    velocitiesX.push_back(velocity.x);
+    velocitiesY.push_back(velocity.y);
+    velocitiesZ.push_back(velocity.z);
+    lifetimes.push_back(lifetime);
+    owners.push_back(ownerHandle);
+    collisionMasks.push_back(collisionMask);
+    hitModelHandles.push_back({0, 0});
+    renderPositions.push_back(position);
+    return true;
+  }
+
+  /**
+   * Keep where the projectiles are before the next step, which their paths in the step start from, and which they're
+   *   rendered moving away from.
+   */
+  void storePreviousPositions()
+  {
+    std::copy(positionsX.begin(), positionsX.end(), previousPositionsX.begin());
+    std::copy(positionsY.begin(), positionsY.end(), previousPositionsY.begin());
+    std::copy(positionsZ.begin(), positionsZ.end(), previousPositionsZ.begin());
+  }
+
+  /**
+   * Move the projectiles along their velocities, test their paths against the colliders of the registered models, and
+   *   let the models hit react. The projectiles that hit a model or ran out of time are removed. Must be called once the
+   *   models are done updating and their colliders are in the broadphases.
+   *
+   * @param frameTime  The time of the step.
+   */
+  void updateProjectiles(const FrameTime &frameTime)
+  {
+    const auto projectilesCount = lifetimes.size();
+    const auto deltaTime = frameTime.delta;
+
+    // Move the projectiles, going over each field on its own so the loops run over contiguous numbers.
+    ProfileZone integrateZone("Integrate Projectiles");
+    auto *const xs = positionsX.data();
+    auto *const ys = positionsY.data();
+    auto *const zs = positionsZ.data();
+    const auto *const vxs = velocitiesX.data();
+    const auto *const vys = velocitiesY.data();
+    const auto *const vzs = velocitiesZ.data();
+    auto *const ts = lifetimes.data();
+    size_t i = 0;
+#ifdef PROJECTILES_SSE2
+    const auto deltaTimes = _mm_set1_ps(deltaTime);
+    for (; i + 4 <= projectilesCount; i += 4)
+    {
+      _mm_storeu_ps(&xs[i], _mm_add_ps(_mm_loadu_ps(&xs[i]), _mm_mul_ps(_mm_loadu_ps(&vxs[i]), deltaTimes)));
+      _mm_storeu_ps(&ys[i], _mm_add_ps(_mm_loadu_ps(&ys[i]), _mm_mul_ps(_mm_loadu_ps(&vys[i]), deltaTimes)));
+      _mm_storeu_ps(&zs[i], _mm_add_ps(_mm_loadu_ps(&zs[i]), _mm_mul_ps(_mm_loadu_ps(&vzs[i]), deltaTimes)));
+      _mm_storeu_ps(&ts[i], _mm_sub_ps(_mm_loadu_ps(&ts[i]), deltaTimes));
+    }
+#endif
+    // The projectiles left over after the last full group of four, or all of them without SSE2.
+    for (; i < projectilesCount; i++)
+    {
+      xs[i] += vxs[i] * deltaTime;
+      ys[i] += vys[i] * deltaTime;
+      zs[i] += vzs[i] * deltaTime;
+      ts[i] -= deltaTime;
+    }
+    integrateZone.end();
+
+    // Test the paths of the projectiles in chunks running in parallel, each writing to the hits of its own projectiles.
+    ProfileZone testZone("Test Projectiles");
+    ParallelTasks::runChunked(projectilesCount, MIN_PARALLEL_PROJECTILE_TESTS, [&](const uint32_t taskIndex, const size_t begin, const size_t end) {
+      testProjectilePaths(taskIndex, begin, end);
+    });
+    testZone.end();
+
+    // Let the models hit react, skipping the ones an earlier projectile already destroyed, and remove the projectiles
+    //   that are done, from the last so the projectiles moved into their places were already looked at.
+    hitsCount = 0;
+    for (size_t i = projectilesCount; i-- > 0;)
+    {
+      if (hitModelHandles[i].isValid())
+      {
+        if (modelManager.isModelRegistered(hitModelHandles[i]))
+        {
+          modelManager.getModel(hitModelHandles[i])->onProjectileHit(owners[i]);
+          // Destroy the models the hit destroyed right away, so the projectiles after it skip them.
+          eventBus.dispatch<ModelDestroyEvent>();
+        }
+        hitsCount++;
+        removeProjectile(i);
+      }
+      else if (lifetimes[i] <= 0.0f)
+      {
+        removeProjectile(i);
+      }
+    }
+  }
+
+  /**
+   * Move the projectiles to where they're drawn, between where they were at the previous and the latest step.
+   *
+   * @param factor  How far along from the previous to the latest step to draw the projectiles, from 0 to 1.
+   */
+  void interpolateRenderPositions(const float_t &factor)
+  {
+    for (size_t i = 0; i < renderPositions.size(); i++)
+    {
+      renderPositions[i] = glm::vec3(previousPositionsX[i] + (positionsX[i] - previousPositionsX[i]) * factor,
+                                     previousPositionsY[i] + (positionsY[i] - previousPositionsY[i]) * factor,
+                                     previousPositionsZ[i] + (positionsZ[i] - previousPositionsZ[i]) * factor);
+    }
+  }
+
+  /**
+   * Get the positions to draw the projectiles at.
+   *
+   * @return The list of render positions, one for each projectile.
+   */
+  const std::vector<glm::vec3> &getRenderPositions() const
+  {
+    return renderPositions;
+  }
+
+  /**
+   * Remove all the projectiles.
+   */
+  void clearProjectiles()
+  {
+    for (auto field : {&positionsX, &positionsY, &positionsZ, &previousPositionsX, &previousPositionsY, &previousPositionsZ, &velocitiesX, &velocitiesY, &velocitiesZ, &lifetimes})
+    {
+      field->clear();
+    }
+    owners.clear();
+    collisionMasks.clear();
+    hitModelHandles.clear();
+    renderPositions.clear();
+    hitsCount = 0;
+  }
+
+  /**
+   * Get the number of projectiles.
+   *
+   * @return The number of projectiles.
+   */
+  size_t getProjectilesCount() const
+  {
+    return lifetimes.size();
+  }
+
+  /**
+   * Get the number of projectiles that hit a model in the latest step.
+   *
+   * @return The number of hits.
+   */
+  const uint32_t &getHitsCount() const
+  {
+    return hitsCount;
+  }
+
+  /**
+   * Returns the instance of the projectile manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
+   * 
+   * @return The projectile manager instance.
+   */
+  static ProjectileManager &getInstance()
+  {
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
+  }
+};
+
+#endif
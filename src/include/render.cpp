@@ -3,9 +3,16 @@
 
 #include <map>
 #include <set>
+#include <algorithm>
+#include <tuple>
+#include <optional>
+#include <memory_resource>
+#include <string_view>
+#include <functional>
 
 #include <GL/glew.h>
 
+#include "gl_state.cpp"
 #include "common.cpp"
 #include "constants.cpp"
 #include "window.cpp"
@@ -14,8 +21,29 @@
 #include "camera.cpp"
 #include "light.cpp"
 #include "models.cpp"
+#include "projectiles.cpp"
+#include "particles.cpp"
 #include "text.cpp"
+#include "cluster.cpp"
+#include "gbuffer.cpp"
+#include "render_graph.cpp"
+#include "render_queue.cpp"
+#include "gpu_timer.cpp"
+#include "profiler.cpp"
+#include "streaming_buffer.cpp"
+#include "indirect_draw.cpp"
+#include "render_stats.cpp"
+#include "slot_map.cpp"
+#include "frame_arena.cpp"
+#include "gl_debug.cpp"
+#include "occlusion.cpp"
+#include "sprite_batch.cpp"
+#include "impostor_batch.cpp"
+#include "settings.cpp"
+#include "parallel.cpp"
+#include "sampler.cpp"
 #include "../light/light_base.cpp"
+#include "../light/directional_light.cpp"
 #include "../camera/camera_base.cpp"
 #include "../models/model_base.cpp"
 
@@ -28,6 +56,10 @@ struct LightDetails
   const glm::vec3 lightPosition;
   // The projection-view matrix of the light.
   const glm::mat4 lightVpMatrix;
+  // The projection-view matrices of the faces of the light, of which the cascades of a directional light are read.
+  const std::array<glm::mat4, LightBase::MAX_FACES_COUNT> faceVpMatrices;
+  // The direction the first face of the light looks in.
+  const glm::vec3 lightDirection;
   // The color of the light.
   const glm::vec3 lightColor;
   // The intensity of the light.
@@ -42,6 +74,258 @@ struct LightDetails
   const float_t farPlane;
   // The ID of the layer of the shadowmap texture array the shadowmap is stored in.
   const GLuint textureArrayLayerId;
+  // The texture coordinates of the bottom-left (x, y) and top-right (z, w) corners of the shadow atlas tile of the shadowmap.
+  const glm::vec4 tileBounds;
+};
+
+/**
+ * Structure for defining the details of a single light in the light uniform block.
+ * The layout of this structure matches the std140 layout of the light details structure in the model shaders.
+ */
+struct LightUniformDetails
+{
+  // The projection-view matrix of the light.
+  glm::mat4 lightVpMatrix;
+  // The position of the light.
+  glm::vec3 lightPosition;
+  // The closest distance from which the shadowmap captures objects.
+  float_t nearPlane;
+  // The product of the color and intensity of the light.
+  glm::vec3 lightColorIntensity;
+  // The farthest distance till which the shadowmap captures objects.
+  float_t farPlane;
+  // The texture coordinates of the bottom-left (x, y) and top-right (z, w) corners of the shadow atlas tile of the shadowmap.
+  glm::vec4 tileBounds;
+  // The ID of the layer of the shadowmap texture array the shadowmap is stored in.
+  int32_t layerId;
+  // Padding to round the structure up to a multiple of a vec4, as required by std140.
+  int32_t padding[3];
+};
+
+/**
+ * Structure for defining the details of a single directional light in the light uniform block.
+ * The layout of this structure matches the std140 layout of the directional light details structure in the model shaders.
+ */
+struct DirectionalLightUniformDetails
+{
+  // The projection-view matrices of the cascades of the light.
+  glm::mat4 cascadeVpMatrices[SHADOW_CASCADES_COUNT];
+  // The direction the light shines in, in the view-space of the camera.
+  glm::vec3 lightDirection_viewSpace;
+  // The ID of the layer of the shadowmap texture array the first cascade is stored in.
+  int32_t layerId;
+  // The product of the color and intensity of the light.
+  glm::vec3 lightColorIntensity;
+  // Padding to align the tile bounds to a vec4.
+  float_t padding;
+  // The texture coordinates of the bottom-left (x, y) and top-right (z, w) corners of the shadow atlas tile of the cascades.
+  glm::vec4 tileBounds;
+};
+
+/**
+ * Structure for defining the light uniform block shared by all model shaders.
+ * The layout of this structure matches the std140 layout of the light uniform block in the model shaders.
+ */
+struct LightUniformBlock
+{
+  // The details of the active cone lights.
+  LightUniformDetails coneLightDetails[MAX_CONE_LIGHTS];
+  // The details of the active point lights.
+  LightUniformDetails pointLightDetails[MAX_POINT_LIGHTS];
+  // The details of the active directional lights.
+  DirectionalLightUniformDetails directionalLightDetails[MAX_DIRECTIONAL_LIGHTS];
+  // The number of active cone lights.
+  int32_t coneLightsCount;
+  // The number of active point lights.
+  int32_t pointLightsCount;
+  // The number of lights that only light the scene through the light clusters.
+  int32_t clusteredLightsCount;
+  // The number of active directional lights.
+  int32_t directionalLightsCount;
+  // The width and height of a light cluster on the screen in pixels, and the scale and bias turning the logarithm of the
+  // view depth into a cluster slice.
+  glm::vec4 clusterParameters;
+};
+
+/**
+ * Structure for defining the camera uniform block shared by all shaders rendering from the active camera.
+ * The layout of this structure matches the std140 layout of the camera uniform block in the shaders.
+ */
+struct CameraUniformBlock
+{
+  // The view matrix of the active camera.
+  glm::mat4 viewMatrix;
+  // The projection matrix of the active camera.
+  glm::mat4 projectionMatrix;
+};
+
+/**
+ * Structure for defining the frame uniform block shared by all shaders turning the model instances by their spins.
+ * The layout of this structure matches the std140 layout of the frame uniform block in the shaders.
+ */
+struct FrameUniformBlock
+{
+  // The time the frame started at, in seconds.
+  float_t frameTime;
+  // Padding to the size of a vec4, which the block is rounded up to.
+  float_t padding[3];
+};
+
+/**
+ * Structure for defining a view the scene is rendered to besides the window, like a picture-in-picture or a minimap.
+ */
+struct CameraView
+{
+  // The handle of the camera the view is rendered from.
+  SlotHandle cameraHandle;
+  // The ID of the framebuffer the view is rendered to, where 0 is the window.
+  GLuint framebufferId;
+  // The left, bottom, width and height of the viewport of the view within its framebuffer, in pixels.
+  glm::ivec4 viewport;
+  // The mask of the render layers of the models drawn in the view.
+  uint32_t layerMask;
+};
+
+/**
+ * Structure for defining a group of models sharing the same object, level of detail, texture and shader, drawn with a
+ * single instanced call.
+ */
+struct ModelInstanceGroup
+{
+  // The first model of the group, whose object, texture and shader details are shared by the whole group.
+  const std::shared_ptr<ModelBaseIntf> firstModel;
+  // The index of the model matrix of the first model of the group in the instance buffer.
+  const uint32_t firstInstance;
+  // The number of models in the group.
+  const uint32_t instanceCount;
+  // The level of detail of the object the models of the group are drawn with.
+  const uint32_t lodLevel;
+};
+
+/**
+ * Structure for the models of a view drawn with their meshes, along with their light masks and levels of detail, once
+ * those drawn only as impostors are left out.
+ */
+struct ViewMeshModels
+{
+  std::pmr::vector<std::shared_ptr<ModelBaseIntf>> models;
+  std::pmr::vector<GLuint> lightMasks;
+  std::pmr::vector<uint32_t> lodLevels;
+};
+
+/**
+ * Structure for defining what a shadow map was rendered with, so it's only rendered again once something in it changes.
+ */
+struct ShadowMapState
+{
+  // The change generation of the light.
+  uint64_t lightGeneration;
+  // The tile of the shadow atlas the shadow map is stored in.
+  ShadowAtlasTile tile;
+  // The handles and render generations of the models casting shadows into the shadow map, in the order they were found.
+  std::vector<std::pair<SlotHandle, uint64_t>> casters;
+  // Whether any of the casters spins in the vertex shaders, which changes the shadow map every frame without changing
+  //   the change generation of the caster.
+  bool spinningCasters;
+  // The mask of the faces still rendered with older details, and waiting for their turn to be rendered again. It isn't
+  //   compared, since it's what's kept of the shadow map and not what it should be rendered with.
+  GLuint staleFacesMask;
+  // The handles and render generations of the casters that stayed in place, which are cached drawn into the shadow map
+  //   without the others, sorted by handle. Like the stale faces, they aren't compared.
+  std::vector<std::pair<SlotHandle, uint64_t>> staticCasters;
+  // The mask of the faces whose static casters are cached, and the generation of the cached static casters they were
+  //   cached in.
+  GLuint staticFacesMask;
+  uint64_t staticCasterGeneration;
+
+  bool operator==(const ShadowMapState &other) const
+  {
+    return lightGeneration == other.lightGeneration && tile == other.tile && casters == other.casters && !spinningCasters && !other.spinningCasters;
+  }
+};
+
+// Make sure the structures match the std140 layout expected by the shaders.
+static_assert(sizeof(LightUniformDetails) == 128, "LightUniformDetails does not match the std140 layout");
+static_assert(sizeof(DirectionalLightUniformDetails) == 64 * SHADOW_CASCADES_COUNT + 48, "DirectionalLightUniformDetails does not match the std140 layout");
+static_assert(sizeof(LightUniformBlock) == 128 * (MAX_CONE_LIGHTS + MAX_POINT_LIGHTS) + sizeof(DirectionalLightUniformDetails) * MAX_DIRECTIONAL_LIGHTS + 32,
+              "LightUniformBlock does not match the std140 layout");
+static_assert(sizeof(CameraUniformBlock) == 128, "CameraUniformBlock does not match the std140 layout");
+static_assert(sizeof(FrameUniformBlock) == 16, "FrameUniformBlock does not match the std140 layout");
+
+/**
+ * Structure for holding the uniform keys of the details of a single light in the light shadowmap shaders.
+ */
+struct ShadowLightUniformKeys
+{
+  // The key of the count of the projection-view matrices uniform.
+  const uint32_t vpMatrixCount;
+  // The key of the light position uniform.
+  const uint32_t lightPosition;
+  // The key of the light shadowmap layer ID uniform.
+  const uint32_t layerId;
+  // The key of the light near plane uniform.
+  const uint32_t nearPlane;
+  // The key of the light far plane uniform.
+  const uint32_t farPlane;
+  // The key of the light shadow atlas tile bounds uniform.
+  const uint32_t tileBounds;
+  // The keys of each of the projection-view matrix uniforms.
+  const std::vector<uint32_t> vpMatrices;
+};
+
+/**
+ * Enum for the quality tiers of the shadow filtering of the model shaders, trading shadow map samples for softer shadow edges.
+ */
+enum class ShadowQuality
+{
+  // A single hardware filtered depth comparison per light.
+  LOW,
+  // A rotated Poisson disk of hardware filtered depth comparisons per light.
+  MEDIUM,
+  // The full kernel of unfiltered depth comparisons per light.
+  HIGH
+};
+
+/**
+ * Enum for the faces of the shadow casters culled while they're drawn into the shadow maps.
+ */
+enum class ShadowCulling
+{
+  // The faces facing away from the light, as in the rest of the passes.
+  BACK,
+  // The faces facing the light, so closed models record their far sides and don't shadow their own lit surfaces.
+  FRONT,
+  // No faces, for models that are open or drawn from both sides.
+  NONE
+};
+
+/**
+ * Structure for the settings of drawing the shadow casters into the shadow maps of a type of light.
+ */
+struct ShadowPassSettings
+{
+  // The faces of the shadow casters culled.
+  ShadowCulling culling;
+  // The depth bias added to the depths of the shadow casters, scaled by the slope of their triangles and in the smallest
+  //   steps of the depth buffer, as for glPolygonOffset. The point lights write the distances of the fragments as their
+  //   depths themselves, so they're only biased by the model shaders.
+  float_t depthBiasSlope;
+  float_t depthBiasConstant;
+};
+
+/**
+ * Enum for the anti-aliasing modes of the window view, trading GPU time for smoother edges.
+ */
+enum class AntiAliasingMode
+{
+  // No anti-aliasing.
+  OFF,
+  // Rendering to a multisampled target with 2, 4 or 8 samples per pixel, resolved before it's shown.
+  MSAA_2X,
+  MSAA_4X,
+  MSAA_8X,
+  // A post-process pass blending the pixels along the edges found in the rendered scene.
+  FXAA
 };
 
 /**
@@ -60,8 +344,18 @@ private:
   const static int32_t DISABLE_SHADOW;
   const static int32_t DISABLE_LIGHT;
 
-  // Singleton instance of the render manager.
-  static RenderManager instance;
+  // The preprocessor definitions of the model shader variants of each shadow quality tier, and the names of the tiers.
+  const static std::map<const ShadowQuality, const std::string> shadowQualityDefines;
+  const static std::map<const ShadowQuality, const std::string> shadowQualityNames;
+  // The names of the anti-aliasing modes, and the number of samples of each pixel of the multisampled modes.
+  const static std::map<const AntiAliasingMode, const std::string> antiAliasingModeNames;
+  const static std::map<const AntiAliasingMode, const uint32_t> antiAliasingModeSamples;
+
+  // The minimum numbers of instances, models and projectiles worth splitting the preparation of their draws across
+  // parallel tasks.
+  static constexpr size_t MIN_PARALLEL_INSTANCES = 256;
+  static constexpr size_t MIN_PARALLEL_MODELS = 128;
+  static constexpr size_t MIN_PARALLEL_PROJECTILES = 512;
 
   // The window manager responsible for the window.
   WindowManager &windowManager;
@@ -71,522 +365,3044 @@ private:
   LightManager &lightManager;
   // The model manager responsible for managing all the models.
   ModelManager &modelManager;
+  // The projectile manager responsible for the projectiles drawn as instances of a single model.
+  const ProjectileManager &projectileManager;
+  // The particle manager responsible for the bursts of particles thrown out where the models hit each other.
+  ParticleManager &particleManager;
   // The text manager responsible for rendering text.
   TextManager &textManager;
   // The control manager responsible for managing controls and inputs of the window.
   const ControlManager &controlManager;
   // The shadow buffer manager responsible for creating shadow buffers for lights.
-  const ShadowBufferManager &shadowBufferManager;
-
-  // The ID of the active camera to use to render the scene to the window.
-  std::string activeCameraId;
-
-  // The timestamp when the render manager was loaded.
-  const float_t startTime;
-  // The timestamp of the start of the last render.
-  float_t lastTime;
+  ShadowBufferManager &shadowBufferManager;
+  // The shader manager responsible for creating the shader variants of the models.
+  ShaderManager &shaderManager;
+  // The texture manager responsible for streaming in the mip levels of the textures of the models.
+  TextureManager &textureManager;
+  // The arena the scratch data of each frame is allocated from, which is reset once the frame is swapped.
+  FrameArena &frameArena;
+
+  // The handle of the active camera to use to render the scene to the window.
+  SlotHandle activeCameraHandle;
+  // The views rendered besides the window, sharing the shadow maps of the frame.
+  SlotMap<CameraView> cameraViews;
+
+  // The states of the shadow maps of the lights as they were last rendered, by light handle.
+  std::map<SlotHandle, ShadowMapState> shadowMapStates;
+  // The lights with shadow maps in the frame as ranked by the light scheduler, by light handle.
+  std::map<SlotHandle, const ScheduledLight *> scheduledShadowLights;
+  // The generation of the contents of the shadow atlases the shadow maps were last rendered into.
+  uint64_t shadowContentsGeneration;
 
   // A mask defining what features to disable (shadows/lighting).
   int32_t disableFeatureMask;
-  // The timestamp of the last time the mask for disabling features was modifed.
-  float_t lastDisableFeatureMaskChange;
+  // Whether the depths of the models are drawn before their colours, so the lighting is only calculated for the closest
+  // fragments instead of for every overdrawn one.
+  bool depthPrePassEnabled;
+  // Whether the models are drawn with deferred shading (into the geometry buffer, then lit in a single full-screen pass)
+  // instead of forward shading.
+  bool deferredShadingEnabled;
+  // Whether the models sample their diffuse textures through bindless handles passed with their instance data, so the
+  // models sharing an object and a shader are drawn together whatever their textures, without binding any textures.
+  bool bindlessTexturesEnabled;
+  // Whether the draws sharing a shader, a texture and an object are collected into a buffer of draw commands and
+  // submitted with a single multi-draw indirect call, with each draw finding its instance data by its base instance.
+  bool multiDrawIndirectEnabled;
+  // The quality tier of the shadow filtering of the model shaders.
+  ShadowQuality shadowQuality;
+  // The settings of drawing the shadow casters into the shadow maps of each type of light.
+  ShadowBufferTypeArray<ShadowPassSettings> shadowPassSettings;
+  // Whether the window view is rendered at a resolution scaled to keep the GPU frame time within budget, and upscaled
+  //   to the window. The scale of the resolution, the GPU frame time it follows, smoothed over the latest frames, and the
+  //   number of frames since the scale changed.
+  bool dynamicResolutionEnabled;
+  float_t resolutionScale;
+  double_t smoothedGpuRenderTime;
+  uint32_t framesSinceResolutionChange;
+  // The anti-aliasing mode of the window view.
+  AntiAliasingMode antiAliasingMode;
+  // The preset of the sampler the textures of the models are filtered with.
+  SamplerPreset textureFilteringPreset;
+  // Whether the models hidden behind other models in the window view are culled with occlusion queries.
+  bool occlusionCullingEnabled;
+  // Whether the instances of the window view are culled against the frustum of the camera on the GPU instead of the
+  //   models on the CPU, which only happens while multi-draw indirect is enabled.
+  bool gpuCullingEnabled;
+  // Whether the draws collected for multi-draw indirect in the view being rendered are culled on the GPU.
+  bool cullingIndirectDraws;
+  // The number of meshlet draws culled on the GPU in the latest frame.
+  uint32_t meshletDrawsCount;
+
+  // The timers measuring the time the GPU takes to render the shadow maps of each type of light, the models, the
+  //   resolving and upscaling of the window view with its anti-aliasing, and the views drawn over the window.
+  ShadowBufferTypeArray<GpuTimer> shadowRenderGpuTimers;
+  GpuTimer modelRenderGpuTimer;
+  GpuTimer antiAliasingGpuTimer;
+  GpuTimer overlayViewsGpuTimer;
+  // The work each pass submitted to render the latest frame, and the pass being rendered, which the work is counted for.
+  std::array<RenderStats, RENDER_PASSES_COUNT> renderStats;
+  RenderPass currentRenderPass;
+
+  // The shader drawing only the depths of the models for the depth pre-pass.
+  const std::shared_ptr<const ShaderDetails> depthPrePassShader;
+  // The culler testing the models in the window view against the depth of the frame, for culling them in the next.
+  OcclusionCuller occlusionCuller;
+  // The culler testing the instances of the multi-draw indirect commands of the window view against the frustum on the GPU.
+  GpuInstanceCuller gpuInstanceCuller;
+
+  // The geometry buffer the models are drawn into with deferred shading.
+  const GeometryBuffer geometryBuffer;
+  // The default model shader, whose lighting pass variant lights the geometry buffer, and whose impostor variant draws
+  // the impostors.
+  const std::shared_ptr<const ShaderDetails> deferredLightingShader;
+  // The vertex array object bound for the full-screen triangle of the lighting pass, which has no vertex data.
+  const GLuint fullScreenVertexArrayId;
+  // The uniform keys of the variables only used by the lighting pass.
+  const uint32_t geometryAlbedoTextureKey;
+  const uint32_t geometryNormalTextureKey;
+  const uint32_t geometryDepthTextureKey;
+  const uint32_t inverseViewMatrixKey;
+  const uint32_t inverseProjectionMatrixKey;
+  const uint32_t geometryViewportSizeKey;
+
+  // The render graph the passes of each frame are declared in, which owns the transient targets the window view is
+  //   rendered to with dynamic resolution or anti-aliasing, and the shader upscaling the window view to the window. With
+  //   MSAA, the window view is rendered to a multisampled target, and resolved into the scene target.
+  RenderGraph renderGraph;
+  const std::shared_ptr<const ShaderDetails> upscaleShader;
+  // The uniform keys of the upscale shader variables.
+  const uint32_t sceneColorTextureKey;
+  const uint32_t sceneDepthTextureKey;
+  const uint32_t sceneScaleKey;
+
+  // The uniform keys of the model shader variables.
+  const uint32_t diffuseTextureKey;
+  const uint32_t disableFeatureMaskKey;
+  const uint32_t ambientFactorKey;
+  const uint32_t coneLightTexturesKey;
+  const uint32_t pointLightTexturesKey;
+  const uint32_t directionalLightTexturesKey;
+  const uint32_t clusteredLightsKey;
+  const uint32_t clusterLightRangesKey;
+  const uint32_t clusterLightIndicesKey;
+  const uint32_t viewportOffsetKey;
+
+  // The ID of the uniform buffer holding the light uniform block.
+  const GLuint lightUniformBufferId;
+  // The ID of the uniform buffer holding the camera uniform block.
+  const GLuint cameraUniformBufferId;
+  // The ID of the uniform buffer holding the frame uniform block, and the time of the frame the block was filled with,
+  //   which the spins of the model instances are evaluated at.
+  const GLuint frameUniformBufferId;
+  float_t spinTime;
+  // The buffer the model matrices, shadow map face masks, texture handles and spins of all the model instances drawn in
+  // the frame are streamed through, and the index of the first matrix, mask, handle and spin of the frame within it. The
+  // instances drawn in the views keep their light masks in place of shadow map face masks.
+  StreamingBuffer instanceStreamingBuffer;
+  uint32_t instanceMatrixBase;
+  uint32_t instanceShadowMaskBase;
+  uint32_t instanceTextureHandleBase;
+  uint32_t instanceSpinBase;
+  // The draws collected to be submitted with a single multi-draw indirect call, streamed through a buffer of their own.
+  IndirectDrawBatch indirectDrawBatch;
+  // The batch the unlit models of the menus are drawn with as sprites, instead of the full render of the scene.
+  SpriteBatch spriteBatch;
+  // The batch the models only a few pixels on the screen are drawn with as impostors, instead of their full meshes.
+  ImpostorBatch impostorBatch;
+  // The model matrices of the projectiles inside the frustum found by each task, reused between frames.
+  std::vector<std::vector<glm::mat4>> taskProjectileMatrices;
+  // The IDs of the buffer holding the view-space positions, radii and colors of the clustered lights, and the buffer
+  // texture the model shaders read it through.
+  const GLuint clusteredLightBufferId;
+  const GLuint clusteredLightTextureId;
+  // The IDs of the buffer holding the range of light indices of each light cluster, and its buffer texture.
+  const GLuint clusterLightRangeBufferId;
+  const GLuint clusterLightRangeTextureId;
+  // The IDs of the buffer holding the light indices of all the light clusters, and its buffer texture.
+  const GLuint clusterLightIndexBufferId;
+  const GLuint clusterLightIndexTextureId;
+
+  // The grid of light clusters the clustered lights are assigned to every frame.
+  LightClusterGrid lightClusterGrid;
+
+  // The queue the model instance groups are sorted in by their state every frame, before they're drawn.
+  RenderQueue modelRenderQueue;
+
+  // The uniform keys of the light shadowmap shader variables.
+  const uint32_t lightsCountKey;
+  // The uniform keys of the light details in the light shadowmap shaders.
+  const std::vector<ShadowLightUniformKeys> shadowLightVertexKeys;
+  const std::vector<ShadowLightUniformKeys> shadowLightGeometryKeys;
+  const std::vector<ShadowLightUniformKeys> shadowLightFragmentKeys;
+
+  /**
+   * Create a uniform buffer for a uniform block and bind it to the given binding point.
+   * 
+   * @param blockSize     The size of the uniform block in bytes.
+   * @param bindingPoint  The binding point shared by all the shaders using the uniform block.
+   * 
+   * @return The ID of the uniform buffer.
+   */
+  static GLuint createUniformBuffer(const GLsizeiptr &blockSize, const GLuint &bindingPoint)
+  {
+    // Create the uniform buffer.
+    GLuint bufferId;
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      // Allocate immutable storage by name, which can still be filled every frame.
+      glCreateBuffers(1, &bufferId);
+      glNamedBufferStorage(bufferId, blockSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+      GlStateCache::getInstance().bindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferId);
+      return bufferId;
+    }
+    glGenBuffers(1, &bufferId);
+    // Allocate the storage of the buffer, which will be filled once every frame.
+    GlStateCache::getInstance().bindBuffer(GL_UNIFORM_BUFFER, bufferId);
+    glBufferData(GL_UNIFORM_BUFFER, blockSize, nullptr, GL_DYNAMIC_DRAW);
+    GlStateCache::getInstance().bindBuffer(GL_UNIFORM_BUFFER, 0);
+    // Bind the buffer to the binding point shared by all the shaders using the block.
+    GlStateCache::getInstance().bindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferId);
+    // Return the ID of the buffer.
+    return bufferId;
+  }
+
+  /**
+   * Replace the contents of a uniform buffer with the given uniform block.
+   * 
+   * @param bufferId   The ID of the uniform buffer.
+   * @param blockSize  The size of the uniform block in bytes.
+   * @param block      The uniform block.
+   */
+  static void uploadUniformBlock(const GLuint &bufferId, const GLsizeiptr &blockSize, const void *block)
+  {
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      glNamedBufferSubData(bufferId, 0, blockSize, block);
+      return;
+    }
+    GlStateCache::getInstance().bindBuffer(GL_UNIFORM_BUFFER, bufferId);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, blockSize, block);
+    GlStateCache::getInstance().bindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  /**
+   * Create a buffer for data filled every frame, like the per-instance data of the model instances.
+   * 
+   * @return The ID of the buffer.
+   */
+  static GLuint createDataBuffer()
+  {
+    // Create the buffer. Its storage is allocated every frame based on the amount of data.
+    GLuint bufferId;
+    glGenBuffers(1, &bufferId);
+    // Return the ID of the buffer.
+    return bufferId;
+  }
+
+  /**
+   * Create a buffer texture reading the data of the given buffer, so shaders can fetch from buffers of any size.
+   * 
+   * @param bufferId        The ID of the buffer to read.
+   * @param internalFormat  The format of each element of the buffer.
+   * 
+   * @return The ID of the buffer texture.
+   */
+  static GLuint createBufferTexture(const GLuint &bufferId, const GLenum &internalFormat)
+  {
+    GLuint textureId;
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      glCreateTextures(GL_TEXTURE_BUFFER, 1, &textureId);
+      glTextureBuffer(textureId, internalFormat, bufferId);
+      return textureId;
+    }
+    glGenTextures(1, &textureId);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_BUFFER, textureId);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, bufferId);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_BUFFER, 0);
+    return textureId;
+  }
+
+  /**
+   * Upload the given data into the buffer behind a buffer texture, replacing its storage.
+   * 
+   * @param bufferId  The ID of the buffer.
+   * @param data      The list of data to upload, which must not be empty.
+   * 
+   * @return The number of bytes uploaded.
+   */
+  template <typename List>
+  static size_t uploadBufferTextureData(const GLuint &bufferId, const List &data)
+  {
+    const auto dataSize = sizeof(typename List::value_type) * data.size();
+    GlStateCache::getInstance().bindBuffer(GL_TEXTURE_BUFFER, bufferId);
+    glBufferData(GL_TEXTURE_BUFFER, dataSize, &data[0], GL_STREAM_DRAW);
+    GlStateCache::getInstance().bindBuffer(GL_TEXTURE_BUFFER, 0);
+    return dataSize;
+  }
+
+  /**
+   * Convert the details of a light into the std140 layout of the light uniform block.
+   * 
+   * @param lightDetails  The details of the light.
+   * @param layerId       The ID of the shadowmap texture layer as seen by the model shaders.
+   * 
+   * @return The details of the light in the light uniform block layout.
+   */
+  static LightUniformDetails createLightUniformDetails(const LightDetails &lightDetails, const int32_t &layerId)
+  {
+    return {lightDetails.lightVpMatrix,
+            lightDetails.lightPosition,
+            lightDetails.nearPlane,
+            lightDetails.lightColor * lightDetails.lightIntensity,
+            lightDetails.farPlane,
+            lightDetails.tileBounds,
+            layerId,
+            {0, 0, 0}};
+  }
+
+  /**
+   * Create the details of a directional light in the light uniform block from the details of the light.
+   * 
+   * @param lightDetails  The details of the light.
+   * @param viewMatrix    The view matrix of the camera the direction of the light is seen from.
+   * 
+   * @return The directional light uniform details.
+   */
+  static DirectionalLightUniformDetails createDirectionalLightUniformDetails(const LightDetails &lightDetails, const glm::mat4 &viewMatrix)
+  {
+    DirectionalLightUniformDetails directionalLightUniformDetails = {};
+    std::copy_n(lightDetails.faceVpMatrices.begin(), SHADOW_CASCADES_COUNT, directionalLightUniformDetails.cascadeVpMatrices);
+    directionalLightUniformDetails.lightDirection_viewSpace = glm::normalize(glm::vec3(viewMatrix * glm::vec4(lightDetails.lightDirection, 0.0f)));
+    directionalLightUniformDetails.layerId = lightDetails.textureArrayLayerId;
+    directionalLightUniformDetails.lightColorIntensity = lightDetails.lightColor * lightDetails.lightIntensity;
+    directionalLightUniformDetails.tileBounds = lightDetails.tileBounds;
+    return directionalLightUniformDetails;
+  }
+
+  /**
+   * Create the matrix that moves clip-space coordinates covering a whole shadowmap layer into the shadow atlas tile with
+   * the given bounds, so a light projection renders into its tile only.
+   * 
+   * @param tileBounds  The texture coordinates of the bottom-left (x, y) and top-right (z, w) corners of the tile.
+   * 
+   * @return The tile matrix.
+   */
+  static glm::mat4 createTileMatrix(const glm::vec4 &tileBounds)
+  {
+    auto tileMatrix = glm::mat4(1.0f);
+    // Scale the coordinates down to the size of the tile.
+    tileMatrix[0][0] = tileBounds.z - tileBounds.x;
+    tileMatrix[1][1] = tileBounds.w - tileBounds.y;
+    // Move the scaled coordinates to the center of the tile. The offset is multiplied by w, so it stays the same after
+    //   perspective division.
+    tileMatrix[3][0] = tileBounds.x + tileBounds.z - 1.0f;
+    tileMatrix[3][1] = tileBounds.y + tileBounds.w - 1.0f;
+    return tileMatrix;
+  }
+
+  /**
+   * Get the size of the shadow map the light needs, based on how much of the screen the reach of the light can cover from
+   * the given camera, out of the size of the shadow atlas of the type of light, limited by the shadow map scale of the light and reduced for round-robin shadow maps, and scaled
+   * along with the resolution the scene is rendered at.
+   * 
+   * @param light            The light.
+   * @param camera           The camera the scene is rendered from.
+   * @param shadowTier       The tier of the shadow map of the light.
+   * @param resolutionScale  The scale of the resolution the scene is rendered at.
+   * 
+   * @return The width and height of the shadow map, in texels.
+   */
+  static uint32_t getShadowMapSize(const LightBase &light, const CameraBase &camera, const ShadowTier &shadowTier, const float_t &resolutionScale)
+  {
+    const auto &projectionMatrix = camera.getProjectionMatrix();
+    // Get the half-height of a sphere the size of the reach of the light on the screen, as a fraction of the half-height
+    //   of the screen.
+    auto screenCoverage = light.getLightFarPlane() * projectionMatrix[1][1];
+    // Perspective projections make the sphere smaller the further away it is.
+    if (projectionMatrix[3][3] == 0.0f)
+    {
+      screenCoverage /= std::max(glm::distance(camera.getCameraPosition(), light.getLightPosition()), 0.001f);
+    }
+    // A directional light reaches across the whole screen.
+    if (light.getLightType() == ShadowBufferType::DIRECTIONAL)
+    {
+      screenCoverage = 1.0f;
+    }
+    const auto tierScale = shadowTier == ShadowTier::ROUND_ROBIN ? ROUND_ROBIN_SHADOW_MAP_SCALE : 1.0f;
+    return static_cast<uint32_t>(ShadowBufferManager::getShadowAtlasSize(light.getLightType()) * light.getShadowMapScale() * tierScale * resolutionScale * std::min(1.0f, screenCoverage));
+  }
+
+  /**
+   * Get the size of the model across the screen, from a sphere around its bounding box.
+   * 
+   * @param model           The model.
+   * @param camera          The camera the model is seen from.
+   * @param viewportHeight  The height of the viewport the model is drawn to, in pixels.
+   * 
+   * @return The size of the model on the screen, in pixels.
+   */
+  static float_t getModelScreenSize(const ModelBaseIntf &model, const CameraBase &camera, const int32_t &viewportHeight)
+  {
+    const auto &projectionMatrix = camera.getProjectionMatrix();
+    const auto &transformedBox = model.getColliderDetails()->getColliderShape()->getTransformedBox();
+    const auto boxSize = transformedBox.getMaxCorner() - transformedBox.getMinCorner();
+    // Get the size of the sphere as a fraction of the height of the screen.
+    auto screenCoverage = 0.5f * glm::length(boxSize) * projectionMatrix[1][1];
+    // Perspective projections make the sphere smaller the further away it is.
+    if (projectionMatrix[3][3] == 0.0f)
+    {
+      const auto boxCenter = transformedBox.getMinCorner() + boxSize * 0.5f;
+      screenCoverage /= std::max(glm::distance(camera.getCameraPosition(), boxCenter), 0.001f);
+    }
+    return screenCoverage * viewportHeight;
+  }
+
+  /**
+   * Select the level of detail of the object of a model, as the coarsest one whose distance from the full mesh stays
+   * under the allowed error on the screen.
+   * 
+   * @param objectDetails  The details of the object of the model.
+   * @param screenSize     The size of the model on the screen, in pixels.
+   * @param lodBias        The number of levels coarser than the selected one to draw the model with.
+   * 
+   * @return The level of detail of the object.
+   */
+  static uint32_t selectModelLod(const ObjectDetails &objectDetails, const float_t &screenSize, const uint32_t &lodBias)
+  {
+    // The errors of the levels are in object space, so scale them by how many pixels the object covers per unit.
+    const auto pixelsPerUnit = screenSize / std::max(glm::length(objectDetails.getBoundsMax() - objectDetails.getBoundsMin()), 0.001f);
+    uint32_t lodLevel = 0;
+    while (lodLevel + 1 < objectDetails.getLodCount() && objectDetails.getLod(lodLevel + 1).error * pixelsPerUnit <= MESH_LOD_PIXEL_ERROR)
+    {
+      lodLevel++;
+    }
+    return std::min(lodLevel + lodBias, objectDetails.getLodCount() - 1);
+  }
+
+  /**
+   * Create an empty list for each type of shadow map, allocated from the arena of the frame.
+   * 
+   * @return The array of the lists against the shadow map types.
+   */
+  template <typename T>
+  ShadowBufferTypeArray<std::pmr::vector<T>> createShadowBufferTypeLists()
+  {
+    static_assert(SHADOW_BUFFER_TYPES_COUNT == 3, "A list must be created for each type of shadow map.");
+    return {std::pmr::vector<T>(&frameArena), std::pmr::vector<T>(&frameArena), std::pmr::vector<T>(&frameArena)};
+  }
+
+  /**
+   * Create the uniform keys of the light details array in the light shadowmap shaders.
+   * 
+   * @param shaderStage  The suffix of the shader stage the arrays belong to (vertex, geometry, fragment).
+   * @param lightsCount  The number of elements of the array.
+   * 
+   * @return The uniform keys of each element of the array.
+   */
+  static std::vector<ShadowLightUniformKeys> createShadowLightUniformKeys(const std::string &shaderStage, const int32_t &lightsCount)
+  {
+    auto &shaderManager = ShaderManager::getInstance();
+    std::vector<ShadowLightUniformKeys> lightUniformKeys({});
+    // Iterate through each element of the array and create the keys of its fields.
+    for (auto i = 0; i < lightsCount; i++)
+    {
+      const auto lightElementName = "lightDetails_" + shaderStage + "[" + std::to_string(i) + "].";
+      const auto projectionElementName = "projectionDetails_" + shaderStage + "[" + std::to_string(i) + "].";
+      // A point light has six projection-view matrices, one for each cubemap face.
+      std::vector<uint32_t> vpMatrixKeys({});
+      for (auto j = 0; j < 6; j++)
+      {
+        vpMatrixKeys.push_back(shaderManager.getUniformKey(lightElementName + "vpMatrices[" + std::to_string(j) + "]"));
+      }
+      lightUniformKeys.push_back({shaderManager.getUniformKey(lightElementName + "vpMatrixCount"),
+                                  shaderManager.getUniformKey(lightElementName + "lightPosition"),
+                                  shaderManager.getUniformKey(lightElementName + "layerId"),
+                                  shaderManager.getUniformKey(projectionElementName + "nearPlane"),
+                                  shaderManager.getUniformKey(projectionElementName + "farPlane"),
+                                  shaderManager.getUniformKey(lightElementName + "tileBounds"),
+                                  vpMatrixKeys});
+    }
+    return lightUniformKeys;
+  }
+
+  /**
+   * Register the settings of the render features, which can be changed by the settings file while the game runs the
+   *   same way as by their keys, and the listeners reallocating the shadow atlases when their sizes change.
+   */
+  void registerSettings()
+  {
+    auto &settingsManager = SettingsManager::getInstance();
+    settingsManager.add<bool>("depth_pre_pass", true, [this](const bool &enabled) { depthPrePassEnabled = enabled; });
+    settingsManager.addChoice("disabled_features", true, {"none", "shadows", "lighting"}, [this](const size_t &index) {
+      disableFeatureMask = index == 0 ? 0 : (index == 1 ? DISABLE_SHADOW : DISABLE_LIGHT);
+    });
+    settingsManager.add<bool>("deferred_shading", true, [this](const bool &enabled) { deferredShadingEnabled = enabled; });
+    settingsManager.add<bool>("bindless_textures", true, [this](const bool &enabled) { bindlessTexturesEnabled = enabled && GLEW_ARB_bindless_texture; });
+    settingsManager.add<bool>("multi_draw_indirect", true, [this](const bool &enabled) { multiDrawIndirectEnabled = enabled && windowManager.isMultiDrawIndirectSupported(); });
+    settingsManager.add<bool>("occlusion_culling", true, [this](const bool &enabled) {
+      occlusionCullingEnabled = enabled;
+      occlusionCuller.resetQueries();
+    });
+    settingsManager.add<bool>("gpu_culling", true, [this](const bool &enabled) { gpuCullingEnabled = enabled && gpuInstanceCuller.isSupported(); });
+    settingsManager.addChoice("shadow_quality", true, {"low", "medium", "high"}, [this](const size_t &index) { shadowQuality = static_cast<ShadowQuality>(index); });
+    settingsManager.add<bool>("dynamic_resolution", true, [this](const bool &enabled) {
+      dynamicResolutionEnabled = enabled;
+      framesSinceResolutionChange = 0;
+    });
+    settingsManager.addChoice("anti_aliasing", true, {"off", "msaa_2x", "msaa_4x", "msaa_8x", "fxaa"}, [this](const size_t &index) { antiAliasingMode = static_cast<AntiAliasingMode>(index); });
+    // The textures of the models are all filtered through the same sampler, so the filtering changes without creating
+    //   them again.
+    settingsManager.addChoice("texture_filtering", true, {"trilinear", "anisotropic_2x", "anisotropic_4x", "anisotropic_8x", "anisotropic_16x"}, [this](const size_t &index) {
+      textureFilteringPreset = static_cast<SamplerPreset>(index);
+    });
+
+    // Only the texture array of the shadow atlas that changed size is reallocated, which renders every shadow map again.
+    const ShadowBufferTypeArray<std::string> shadowAtlasSizeNames = {{"cone_shadow_atlas_size", "point_shadow_atlas_size", "directional_shadow_atlas_size"}};
+    for (uint32_t lightType = 0; lightType < SHADOW_BUFFER_TYPES_COUNT; lightType++)
+    {
+      settingsManager.addListener(shadowAtlasSizeNames[lightType], [this, lightType]() {
+        shadowBufferManager.resizeShadowAtlas(static_cast<ShadowBufferType>(lightType));
+      });
+    }
+  }
 
   RenderManager()
       : windowManager(WindowManager::getInstance()),
         cameraManager(CameraManager::getInstance()),
         lightManager(LightManager::getInstance()),
         modelManager(ModelManager::getInstance()),
+        projectileManager(ProjectileManager::getInstance()),
+        particleManager(ParticleManager::getInstance()),
         textManager(TextManager::getInstance()),
         controlManager(ControlManager::getInstance()),
         shadowBufferManager(ShadowBufferManager::getInstance()),
-        startTime(glfwGetTime()),
-        lastTime(glfwGetTime()),
+        shaderManager(ShaderManager::getInstance()),
+        textureManager(TextureManager::getInstance()),
+        frameArena(FrameArena::getInstance()),
+        shadowContentsGeneration(0),
         disableFeatureMask(0),
-        lastDisableFeatureMaskChange(glfwGetTime() - 10) {}
+        depthPrePassEnabled(false),
+        deferredShadingEnabled(false),
+        bindlessTexturesEnabled(false),
+        multiDrawIndirectEnabled(windowManager.isMultiDrawIndirectSupported()),
+        shadowQuality(ShadowQuality::HIGH),
+        shadowPassSettings({{{ShadowCulling::BACK, 0.0f, 0.0f}, {ShadowCulling::BACK, 0.0f, 0.0f}, {ShadowCulling::BACK, 0.0f, 0.0f}}}),
+        dynamicResolutionEnabled(false),
+        resolutionScale(1.0f),
+        smoothedGpuRenderTime(0.0),
+        framesSinceResolutionChange(0),
+        antiAliasingMode(AntiAliasingMode::MSAA_4X),
+        textureFilteringPreset(SamplerPreset::TRILINEAR),
+        occlusionCullingEnabled(true),
+        gpuCullingEnabled(false),
+        cullingIndirectDraws(false),
+        meshletDrawsCount(0),
+        shadowRenderGpuTimers(),
+        modelRenderGpuTimer(),
+        antiAliasingGpuTimer(),
+        overlayViewsGpuTimer(),
+        renderStats(),
+        currentRenderPass(RenderPass::SETUP),
+        depthPrePassShader(shaderManager.createShaderProgram("DepthPrePassShader", "assets/shaders/vertex/depth.glsl", "assets/shaders/fragment/depth.glsl")),
+        occlusionCuller(),
+        gpuInstanceCuller(),
+        geometryBuffer(VIEWPORT_WIDTH, VIEWPORT_HEIGHT),
+        deferredLightingShader(shaderManager.createShaderProgram("DeferredLightingShader", "assets/shaders/vertex/default.glsl", "assets/shaders/fragment/default.glsl")),
+        fullScreenVertexArrayId(VertexArray::create()),
+        geometryAlbedoTextureKey(shaderManager.getUniformKey("geometryAlbedoTexture")),
+        geometryNormalTextureKey(shaderManager.getUniformKey("geometryNormalTexture")),
+        geometryDepthTextureKey(shaderManager.getUniformKey("geometryDepthTexture")),
+        inverseViewMatrixKey(shaderManager.getUniformKey("inverseViewMatrix")),
+        inverseProjectionMatrixKey(shaderManager.getUniformKey("inverseProjectionMatrix")),
+        geometryViewportSizeKey(shaderManager.getUniformKey("geometryViewportSize")),
+        renderGraph(),
+        upscaleShader(shaderManager.createShaderProgram("UpscaleShader", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/upscale.glsl")),
+        sceneColorTextureKey(shaderManager.getUniformKey("sceneColorTexture")),
+        sceneDepthTextureKey(shaderManager.getUniformKey("sceneDepthTexture")),
+        sceneScaleKey(shaderManager.getUniformKey("sceneScale")),
+        diffuseTextureKey(ShaderManager::getInstance().getUniformKey("diffuseTexture")),
+        disableFeatureMaskKey(ShaderManager::getInstance().getUniformKey("disableFeatureMask")),
+        ambientFactorKey(ShaderManager::getInstance().getUniformKey("ambientFactor")),
+        coneLightTexturesKey(ShaderManager::getInstance().getUniformKey("coneLightTextures")),
+        pointLightTexturesKey(ShaderManager::getInstance().getUniformKey("pointLightTextures")),
+        directionalLightTexturesKey(ShaderManager::getInstance().getUniformKey("directionalLightTextures")),
+        clusteredLightsKey(ShaderManager::getInstance().getUniformKey("clusteredLights")),
+        clusterLightRangesKey(ShaderManager::getInstance().getUniformKey("clusterLightRanges")),
+        clusterLightIndicesKey(ShaderManager::getInstance().getUniformKey("clusterLightIndices")),
+        viewportOffsetKey(ShaderManager::getInstance().getUniformKey("viewportOffset")),
+        lightUniformBufferId(createUniformBuffer(sizeof(LightUniformBlock), LIGHT_UNIFORM_BLOCK_BINDING)),
+        cameraUniformBufferId(createUniformBuffer(sizeof(CameraUniformBlock), CAMERA_UNIFORM_BLOCK_BINDING)),
+        frameUniformBufferId(createUniformBuffer(sizeof(FrameUniformBlock), FRAME_UNIFORM_BLOCK_BINDING)),
+        spinTime(0.0f),
+        instanceStreamingBuffer(INSTANCE_STREAMING_BUFFER_SIZE),
+        instanceMatrixBase(0),
+        instanceShadowMaskBase(0),
+        instanceTextureHandleBase(0),
+        instanceSpinBase(0),
+        indirectDrawBatch(),
+        spriteBatch(),
+        impostorBatch(),
+        taskProjectileMatrices(ParallelTasks::getTaskCount()),
+        clusteredLightBufferId(createDataBuffer()),
+        clusteredLightTextureId(createBufferTexture(clusteredLightBufferId, GL_RGBA32F)),
+        clusterLightRangeBufferId(createDataBuffer()),
+        clusterLightRangeTextureId(createBufferTexture(clusterLightRangeBufferId, GL_RG32UI)),
+        clusterLightIndexBufferId(createDataBuffer()),
+        clusterLightIndexTextureId(createBufferTexture(clusterLightIndexBufferId, GL_R32UI)),
+        lightClusterGrid(glm::uvec3(LIGHT_CLUSTER_GRID_WIDTH, LIGHT_CLUSTER_GRID_HEIGHT, LIGHT_CLUSTER_GRID_DEPTH)),
+        modelRenderQueue(),
+        lightsCountKey(ShaderManager::getInstance().getUniformKey("lightsCount")),
+        shadowLightVertexKeys(createShadowLightUniformKeys("vertex", MAX_LIGHTS)),
+        shadowLightGeometryKeys(createShadowLightUniformKeys("geometry", MAX_LIGHTS)),
+        shadowLightFragmentKeys(createShadowLightUniformKeys("fragment", MAX_LIGHTS))
+  {
+    registerSettings();
+  }
+
+public:
+  // Preventing copying the render manager, making sure only one instance can exist.
+  RenderManager(const RenderManager &) = delete;
+
+  ~RenderManager()
+  {
+    // Delete the light and camera uniform buffers.
+    GlStateCache::getInstance().deleteBuffers(1, &lightUniformBufferId);
+    GlStateCache::getInstance().deleteBuffers(1, &cameraUniformBufferId);
+    GlStateCache::getInstance().deleteBuffers(1, &frameUniformBufferId);
+    // Delete the clustered light buffers and their buffer textures.
+    GlStateCache::getInstance().deleteTextures(1, &clusteredLightTextureId);
+    GlStateCache::getInstance().deleteBuffers(1, &clusteredLightBufferId);
+    GlStateCache::getInstance().deleteTextures(1, &clusterLightRangeTextureId);
+    GlStateCache::getInstance().deleteBuffers(1, &clusterLightRangeBufferId);
+    GlStateCache::getInstance().deleteTextures(1, &clusterLightIndexTextureId);
+    GlStateCache::getInstance().deleteBuffers(1, &clusterLightIndexBufferId);
+    // Release the depth pre-pass shader.
+    shaderManager.destroyShaderProgram(depthPrePassShader);
+    // Release the deferred lighting shader and the full-screen vertex array object.
+    shaderManager.destroyShaderProgram(deferredLightingShader);
+    GlStateCache::getInstance().deleteVertexArrays(1, &fullScreenVertexArrayId);
+    // Release the upscale shader.
+    shaderManager.destroyShaderProgram(upscaleShader);
+  }
+
+  /**
+   * Add the impostor instances of the models of a view that are small enough on the screen to the impostor batch, and
+   * leave out the models drawn only as impostors. The models fading into their impostors are drawn with their meshes as
+   * well, and so are those whose objects the impostor batch has no room left for in the frame. With GPU culling, the
+   * models of the window view aren't culled against the frustum on the CPU, so the impostors are culled here instead.
+   * 
+   * @param view               The view.
+   * @param models             The models in the view.
+   * @param lightMasks         The light masks of the models, in the same order as the models.
+   * @param lodLevels          The levels of detail of the objects of the models, in the same order as the models.
+   * @param impostorCoverages  How much of each model is drawn as its impostor, in the same order as the models.
+   * 
+   * @return The models drawn with their meshes, with their light masks and levels of detail.
+   */
+  ViewMeshModels addImpostorInstances(const CameraView &view, const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &models, const std::pmr::vector<GLuint> &lightMasks, const std::pmr::vector<uint32_t> &lodLevels, const std::pmr::vector<float_t> &impostorCoverages)
+  {
+    ViewMeshModels meshModels = {std::pmr::vector<std::shared_ptr<ModelBaseIntf>>(&frameArena), std::pmr::vector<GLuint>(&frameArena), std::pmr::vector<uint32_t>(&frameArena)};
+    meshModels.models.reserve(models.size());
+    meshModels.lightMasks.reserve(models.size());
+    meshModels.lodLevels.reserve(models.size());
+    const auto &camera = *cameraManager.getCamera(view.cameraHandle);
+    for (uint32_t i = 0; i < models.size(); i++)
+    {
+      const auto &model = models[i];
+      if (impostorCoverages[i] > 0.0f)
+      {
+        const auto &transformedBox = model->getColliderDetails()->getColliderShape()->getTransformedBox();
+        if (!camera.getFrustum().intersectsBox(transformedBox.getMinCorner(), transformedBox.getMaxCorner()))
+        {
+          continue;
+        }
+        const auto &captureShader = shaderManager.getShaderVariant(model->getShaderDetails(), "#define DEFERRED_GBUFFER\n");
+        if (impostorBatch.addInstance(*model, lightMasks[i], impostorCoverages[i], camera.getCameraPosition(), spinTime, *captureShader, cameraUniformBufferId) && impostorCoverages[i] >= 1.0f)
+        {
+          continue;
+        }
+      }
+      meshModels.models.push_back(model);
+      meshModels.lightMasks.push_back(lightMasks[i]);
+      meshModels.lodLevels.push_back(lodLevels[i]);
+    }
+    return meshModels;
+  }
+
+  /**
+   * Group the given models that share the same object, level of detail, texture and shader, and append the model
+   * matrices, shadow map face masks, texture handles and spins of all the models to the lists of instance data, ordered
+   * by group.
+   * 
+   * @param models                  The models to group.
+   * @param shadowMasks             The shadow map face masks of the models, or their light masks for the models drawn in
+   *                                the views, in the same order as the models.
+   * @param lodLevels               The levels of detail of the objects of the models, in the same order as the models.
+   * @param shareTextures           Whether the models sample their textures through the texture handles, so models with
+   *                                different textures can be in the same group.
+   * @param instanceMatrices        The list of model matrices of the frame, which the matrices of the models are appended to.
+   * @param instanceShadowMasks     The list of shadow map face masks of the frame, which the masks of the models are appended to.
+   * @param instanceTextureHandles  The list of texture handles of the frame, which the handles of the models are appended
+   *                                to, or 0 for each model if they don't share textures.
+   * @param instanceSpins           The list of spins of the frame, which the spins of the models are appended to.
+   * @param modelInstanceGroups     The list to store the model groups to, in the order each group first appears in the
+   *                                list of models.
+   */
+  void groupModelInstances(const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &models, const std::pmr::vector<GLuint> &shadowMasks, const std::pmr::vector<uint32_t> &lodLevels, const bool &shareTextures, std::pmr::vector<glm::mat4> &instanceMatrices, std::pmr::vector<GLuint> &instanceShadowMasks, std::pmr::vector<GLuint64> &instanceTextureHandles, std::pmr::vector<glm::vec2> &instanceSpins, std::pmr::vector<ModelInstanceGroup> &modelInstanceGroups)
+  {
+    // Define a map of the index of each group against the details the models in it share.
+    std::pmr::map<std::tuple<const ObjectDetails *, uint32_t, const TextureDetails *, const ShaderDetails *>, uint32_t> groupIndices(&frameArena);
+    // Define a list of the indices of the models in each group.
+    std::pmr::vector<std::pmr::vector<uint32_t>> groupedModelIndices(&frameArena);
+
+    // Iterate through all the given models.
+    for (uint32_t i = 0; i < models.size(); i++)
+    {
+      const auto &model = models[i];
+      // Get the details the model shares with other models of the same group.
+      const auto groupKey = std::make_tuple(model->getObjectDetails().get(), lodLevels[i], shareTextures ? nullptr : model->getTextureDetails().get(), model->getShaderDetails().get());
+      // Check if a group already exists for the model.
+      auto existingGroup = groupIndices.find(groupKey);
+      if (existingGroup == groupIndices.end())
+      {
+        // If not, create a new group for it.
+        existingGroup = groupIndices.insert(std::make_pair(groupKey, groupedModelIndices.size())).first;
+        groupedModelIndices.emplace_back();
+      }
+      // Add the model to its group.
+      groupedModelIndices[existingGroup->second].push_back(i);
+    }
+
+    // Store the groups along with where their instance data starts in the instance buffers, and the order the models
+    // are in the instance buffers. The texture handles are created with GL calls the first time they're asked for, so
+    // they're stored here, on the thread owning the GL context.
+    const auto firstInstance = instanceMatrices.size();
+    std::pmr::vector<uint32_t> instanceModelIndices(&frameArena);
+    std::pmr::vector<const glm::mat4 *> instanceVertexMatrices(&frameArena);
+    instanceModelIndices.reserve(models.size());
+    instanceVertexMatrices.reserve(models.size());
+    for (const auto &modelIndices : groupedModelIndices)
+    {
+      modelInstanceGroups.push_back({models[modelIndices.front()], static_cast<uint32_t>(firstInstance + instanceModelIndices.size()), static_cast<uint32_t>(modelIndices.size()), lodLevels[modelIndices.front()]});
+      // The vertex matrix of the object is applied first for the compact vertex format.
+      const auto &objectDetails = models[modelIndices.front()]->getObjectDetails();
+      const auto vertexMatrix = objectDetails->getVertexFormat() == MeshVertexFormat::COMPACT ? &objectDetails->getVertexMatrix() : nullptr;
+      for (const auto &modelIndex : modelIndices)
+      {
+        instanceModelIndices.push_back(modelIndex);
+        instanceVertexMatrices.push_back(vertexMatrix);
+        instanceTextureHandles.push_back(shareTextures ? textureManager.getTextureHandle(*models[modelIndex]->getTextureDetails()) : 0);
+      }
+    }
+
+    // Store the model matrices, shadow map face masks and spins of the models in parallel, each task filling its own
+    // range of the instance buffers, which are sized for all of them first so the tasks don't allocate.
+    instanceMatrices.resize(firstInstance + instanceModelIndices.size());
+    instanceShadowMasks.resize(firstInstance + instanceModelIndices.size());
+    instanceSpins.resize(firstInstance + instanceModelIndices.size());
+    ParallelTasks::runChunked(instanceModelIndices.size(), MIN_PARALLEL_INSTANCES, [&](const uint32_t, const size_t begin, const size_t end) {
+      for (size_t i = begin; i < end; i++)
+      {
+        const auto &model = *models[instanceModelIndices[i]];
+        const auto instance = firstInstance + i;
+        // The spins turn the vertices as they are in the buffers, so the compact vertices are turned here instead, once
+        // their vertex matrix has taken them back to the space of the object.
+        const auto spin = model.getRenderSpin();
+        if (instanceVertexMatrices[i] != nullptr)
+        {
+          const auto spinMatrix = spin.y != 0.0f || spin.x != 0.0f ? glm::rotate(spin.x + spin.y * spinTime, glm::vec3(0.0f, 1.0f, 0.0f)) : glm::mat4(1.0f);
+          instanceMatrices[instance] = model.getRenderMatrix() * spinMatrix * *instanceVertexMatrices[i];
+          instanceSpins[instance] = glm::vec2(0.0f);
+        }
+        else
+        {
+          instanceMatrices[instance] = model.getRenderMatrix();
+          instanceSpins[instance] = spin;
+        }
+        instanceShadowMasks[instance] = shadowMasks[instanceModelIndices[i]];
+      }
+    });
+  }
+
+  /**
+   * Group the projectiles inside the frustum into a single group of instances of the projectile model, each the model
+   * matrix of the model moved to the projectile, so all of them are drawn with a single instanced call.
+   * 
+   * @param frustum                 The frustum of the view.
+   * @param layerMask               The mask of the render layers drawn in the view.
+   * @param shareTextures           Whether the models sample their textures through the texture handles.
+   * @param instanceMatrices        The list of model matrices of the frame, which the matrices of the projectiles are appended to.
+   * @param instanceShadowMasks     The list of shadow map face masks of the frame, which the light masks of the projectiles
+   *                                are appended to, with every light set.
+   * @param instanceTextureHandles  The list of texture handles of the frame, which the handles of the projectiles are appended to.
+   * @param instanceSpins           The list of spins of the frame, which the spins of the projectiles are appended to.
+   * @param modelInstanceGroups     The list to store the group of the projectiles to.
+   */
+  void groupProjectileInstances(const Frustum &frustum, const uint32_t &layerMask, const bool &shareTextures, std::pmr::vector<glm::mat4> &instanceMatrices, std::pmr::vector<GLuint> &instanceShadowMasks, std::pmr::vector<GLuint64> &instanceTextureHandles, std::pmr::vector<glm::vec2> &instanceSpins, std::pmr::vector<ModelInstanceGroup> &modelInstanceGroups)
+  {
+    const auto &projectileModel = projectileManager.getProjectileModel();
+    if (projectileModel == nullptr || (projectileModel->getRenderLayers() & layerMask) == 0)
+    {
+      return;
+    }
+
+    // Every projectile is drawn as the model at the origin moved to the projectile, so only the translation of the
+    // matrix changes between them, and each is culled with the box of the model moved the same way.
+    const auto &objectDetails = projectileModel->getObjectDetails();
+    const auto hasVertexMatrix = objectDetails->getVertexFormat() == MeshVertexFormat::COMPACT;
+    const auto baseMatrix = hasVertexMatrix ? projectileModel->getModelMatrix() * objectDetails->getVertexMatrix() : projectileModel->getModelMatrix();
+    const auto &baseBox = projectileModel->getColliderDetails()->getColliderShape()->getTransformedBox();
+    const auto textureHandle = shareTextures ? textureManager.getTextureHandle(*projectileModel->getTextureDetails()) : 0;
+    const auto firstInstance = static_cast<uint32_t>(instanceMatrices.size());
+    // Each task culls its own range of the projectiles into its own list, and the lists are appended in the order of the
+    // tasks, so the instances keep the order of the projectiles.
+    const auto &renderPositions = projectileManager.getRenderPositions();
+    const auto tasksCount = ParallelTasks::runChunked(renderPositions.size(), MIN_PARALLEL_PROJECTILES, [&](const uint32_t taskIndex, const size_t begin, const size_t end) {
+      auto &projectileMatrices = taskProjectileMatrices[taskIndex];
+      projectileMatrices.clear();
+      for (size_t i = begin; i < end; i++)
+      {
+        const auto &position = renderPositions[i];
+        if (!frustum.intersectsBox(baseBox.getMinCorner() + position, baseBox.getMaxCorner() + position))
+        {
+          continue;
+        }
+        projectileMatrices.push_back(baseMatrix);
+        projectileMatrices.back()[3] += glm::vec4(position, 0.0f);
+      }
+    });
+    for (uint32_t taskIndex = 0; taskIndex < tasksCount; taskIndex++)
+    {
+      const auto &projectileMatrices = taskProjectileMatrices[taskIndex];
+      instanceMatrices.insert(instanceMatrices.end(), projectileMatrices.begin(), projectileMatrices.end());
+    }
+    instanceShadowMasks.resize(instanceMatrices.size(), ~0u);
+    instanceTextureHandles.resize(instanceMatrices.size(), textureHandle);
+    instanceSpins.resize(instanceMatrices.size(), glm::vec2(0.0f));
+    const auto instanceCount = static_cast<uint32_t>(instanceMatrices.size()) - firstInstance;
+    if (instanceCount > 0)
+    {
+      modelInstanceGroups.push_back({projectileModel, firstInstance, instanceCount, 0});
+    }
+  }
+
+  /**
+   * Stream the model matrices, shadow map face masks, texture handles and spins of all the model instances drawn in the
+   * frame into the instance buffer.
+   * 
+   * @param instanceMatrices        The list of model matrices of the frame.
+   * @param instanceShadowMasks     The list of shadow map face masks of the frame.
+   * @param instanceTextureHandles  The list of texture handles of the frame.
+   * @param instanceSpins           The list of spins of the frame.
+   */
+  void uploadInstanceData(const std::pmr::vector<glm::mat4> &instanceMatrices, const std::pmr::vector<GLuint> &instanceShadowMasks, const std::pmr::vector<GLuint64> &instanceTextureHandles, const std::pmr::vector<glm::vec2> &instanceSpins)
+  {
+    // Stream the instance data into the instance buffer, if there is any, keeping the matrices, the masks, the handles
+    // and the spins in the same buffer so the attributes of a group can point at all of them.
+    if (!instanceMatrices.empty())
+    {
+      const auto matricesSize = sizeof(glm::mat4) * instanceMatrices.size();
+      const auto shadowMasksSize = sizeof(GLuint) * instanceShadowMasks.size();
+      const auto textureHandlesSize = sizeof(GLuint64) * instanceTextureHandles.size();
+      const auto spinsSize = sizeof(glm::vec2) * instanceSpins.size();
+      // The handles can need padding after the masks to be aligned, and the spins after the handles.
+      instanceStreamingBuffer.reserve(matricesSize + shadowMasksSize + textureHandlesSize + spinsSize + sizeof(GLuint64) + sizeof(glm::vec2), sizeof(glm::mat4));
+      instanceMatrixBase = instanceStreamingBuffer.write(&instanceMatrices[0], matricesSize, sizeof(glm::mat4)) / sizeof(glm::mat4);
+      instanceShadowMaskBase = instanceStreamingBuffer.write(&instanceShadowMasks[0], shadowMasksSize, sizeof(GLuint)) / sizeof(GLuint);
+      instanceTextureHandleBase = instanceStreamingBuffer.write(&instanceTextureHandles[0], textureHandlesSize, sizeof(GLuint64)) / sizeof(GLuint64);
+      instanceSpinBase = instanceStreamingBuffer.write(&instanceSpins[0], spinsSize, sizeof(glm::vec2)) / sizeof(glm::vec2);
+      getPassStats().uploadedBytes += matricesSize + shadowMasksSize + textureHandlesSize + spinsSize;
+    }
+  }
+
+  /**
+   * Sort the lights in the scene given shadow maps by the light scheduler by the type of their shadow map, from the most
+   * important. The other point lights are lit without shadows through the light clusters. Cone lights only light the
+   * area their shadow map can see, and directional lights are lit through their cascades, so those without one are left out.
+   * 
+   * @param clusteredLights  The list to store the lights to light through the light clusters to.
+   * 
+   * @return The lists of the lights in the scene casting shadows for each shadow map type.
+   */
+  ShadowBufferTypeArray<std::pmr::vector<std::shared_ptr<LightBase>>> categorizeLights(std::pmr::vector<std::shared_ptr<LightBase>> &clusteredLights)
+  {
+    // Rank the lights with the GPU time of the shadow maps of the latest measured frame.
+    const auto shadowRenderTime = shadowRenderGpuTimers[ShadowBufferType::CONE].getElapsedTime() + shadowRenderGpuTimers[ShadowBufferType::POINT].getElapsedTime() +
+                                  shadowRenderGpuTimers[ShadowBufferType::DIRECTIONAL].getElapsedTime();
+    const auto &scheduledLights = lightManager.scheduleShadows(*cameraManager.getCamera(activeCameraHandle), shadowRenderTime);
+
+    auto categorizedLights = createShadowBufferTypeLists<std::shared_ptr<LightBase>>();
+    scheduledShadowLights.clear();
+    for (const auto &scheduledLight : scheduledLights)
+    {
+      const auto &light = scheduledLight.light;
+      if (scheduledLight.shadowTier != ShadowTier::NONE)
+      {
+        categorizedLights[light->getLightType()].push_back(light);
+        scheduledShadowLights[light->getLightHandle()] = &scheduledLight;
+      }
+      else if (light->getLightType() == ShadowBufferType::POINT)
+      {
+        clusteredLights.push_back(light);
+      }
+    }
+    return categorizedLights;
+  }
+
+  /**
+   * Check if the shadow map of the light has to wait for its turn before it's rendered again, leaving the shadow map as
+   * it was last rendered. A shadow map that was never rendered doesn't wait.
+   * 
+   * @param light  The light.
+   * 
+   * @return Whether the shadow map of the light waits.
+   */
+  bool isShadowUpdateWaiting(const LightBase &light) const
+  {
+    return !scheduledShadowLights.at(light.getLightHandle())->shadowUpdateAllowed && shadowMapStates.find(light.getLightHandle()) != shadowMapStates.end();
+  }
+
+  /**
+   * Assign the given lights to the light clusters of the view frustum of the camera of the view, and upload the lights
+   * and the clusters for the model shaders.
+   * 
+   * @param clusteredLights  The lights to light through the light clusters.
+   * @param view             The view the clusters are for.
+   * @param isWindowView     Whether the view is the window view, whose statistics are shown.
+   */
+  void updateLightClusters(const std::pmr::vector<std::shared_ptr<LightBase>> &clusteredLights, const CameraView &view, const bool &isWindowView)
+  {
+    const auto &activeCamera = cameraManager.getCamera(view.cameraHandle);
+    // Get the spheres the lights can reach in view-space, along with their colors.
+    std::vector<glm::vec4> lightSpheres({});
+    std::pmr::vector<glm::vec4> lightData(&frameArena);
+    for (const auto &light : clusteredLights)
+    {
+      lightSpheres.push_back(glm::vec4(glm::vec3(activeCamera->getViewMatrix() * glm::vec4(light->getLightPosition(), 1.0f)), light->getInfluenceRadius()));
+      lightData.push_back(lightSpheres.back());
+      lightData.push_back(glm::vec4(light->getLightColor() * light->getLightIntensity(), 0.0f));
+    }
+    lightClusterGrid.assignLights(lightSpheres, activeCamera->getProjectionMatrix(), glm::vec2(view.viewport.z, view.viewport.w));
+
+    // Upload the lights and the clusters, with a placeholder element for empty lists since buffers can't be empty.
+    if (lightData.empty())
+    {
+      lightData.push_back(glm::vec4(0.0f));
+    }
+    auto &passStats = getPassStats();
+    passStats.uploadedBytes += uploadBufferTextureData(clusteredLightBufferId, lightData);
+    passStats.uploadedBytes += uploadBufferTextureData(clusterLightRangeBufferId, lightClusterGrid.getClusterLightRanges());
+    if (lightClusterGrid.getClusterLightIndices().empty())
+    {
+      passStats.uploadedBytes += uploadBufferTextureData(clusterLightIndexBufferId, std::vector<uint32_t>({0}));
+    }
+    else
+    {
+      passStats.uploadedBytes += uploadBufferTextureData(clusterLightIndexBufferId, lightClusterGrid.getClusterLightIndices());
+    }
+    if (!isWindowView)
+    {
+      return;
+    }
+    textManager.addFormattedText(glm::vec2(1, 13), 0.5f, "Clustered Lights: ", clusteredLights.size(), " | Cluster Light Indices: ", lightClusterGrid.getClusterLightIndices().size());
+  }
+
+  /**
+   * Find the lights with shadow maps that can reach each of the given models, as a mask of the lights the model shaders
+   * light the model with. The mask has a bit for each cone light at its index in the light uniform block, followed by a
+   * bit for each point light after the most cone lights there can be, and then a bit for each directional light after the
+   * most point lights there can be. A light reaches a model when the sphere of its
+   * influence radius touches the box around the model.
+   * 
+   * @param models             The models to find the lights of.
+   * @param categorizedLights  The lights casting shadows categorized by their shadow map type, in the order they're stored
+   *                           in the light uniform block.
+   * @param lightsCount        The number of lights reaching the models added up, for the statistics.
+   * 
+   * @return The light masks of the models, in the same order as the models.
+   */
+  std::pmr::vector<GLuint> findModelLightMasks(const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &models, const ShadowBufferTypeArray<std::pmr::vector<std::shared_ptr<LightBase>>> &categorizedLights, uint32_t &lightsCount)
+  {
+    // Get the spheres the lights can reach, along with the bit of each light in the masks.
+    std::pmr::vector<std::pair<glm::vec4, GLuint>> lightSpheres(&frameArena);
+    for (uint32_t lightType = 0; lightType < SHADOW_BUFFER_TYPES_COUNT; lightType++)
+    {
+      const auto &lights = categorizedLights[lightType];
+      const auto firstBit = lightType == ShadowBufferType::DIRECTIONAL ? MAX_CONE_LIGHTS + MAX_POINT_LIGHTS : (lightType == ShadowBufferType::POINT ? MAX_CONE_LIGHTS : 0);
+      for (unsigned long i = 0; i < lights.size(); i++)
+      {
+        lightSpheres.push_back(std::make_pair(glm::vec4(lights[i]->getLightPosition(), lights[i]->getInfluenceRadius()), 1u << (firstBit + i)));
+      }
+    }
+
+    // The models are tested in parallel, each task counting the lights reaching its own models.
+    std::pmr::vector<GLuint> lightMasks(models.size(), 0, &frameArena);
+    std::pmr::vector<uint32_t> taskLightsCounts(ParallelTasks::getTaskCount(), 0, &frameArena);
+    const auto tasksCount = ParallelTasks::runChunked(models.size(), MIN_PARALLEL_MODELS, [&](const uint32_t taskIndex, const size_t begin, const size_t end) {
+      for (size_t i = begin; i < end; i++)
+      {
+        const auto &transformedBox = models[i]->getColliderDetails()->getColliderShape()->getTransformedBox();
+        for (const auto &lightSphere : lightSpheres)
+        {
+          if (transformedBox.intersectsSphere(glm::vec3(lightSphere.first), lightSphere.first.w))
+          {
+            lightMasks[i] |= lightSphere.second;
+            taskLightsCounts[taskIndex]++;
+          }
+        }
+      }
+    });
+    for (uint32_t taskIndex = 0; taskIndex < tasksCount; taskIndex++)
+    {
+      lightsCount += taskLightsCounts[taskIndex];
+    }
+    return lightMasks;
+  }
+
+  /**
+   * Check if the shadow of the model changes as it spins in the vertex shaders, which renders the shadow maps it's in
+   * again every frame.
+   * 
+   * @param model  The model.
+   * 
+   * @return Whether the shadow of the model spins.
+   */
+  static bool isShadowSpinning(const ModelBaseIntf &model)
+  {
+    return model.getRenderSpin().y != 0.0f && !model.hasSpinInvariantShadow();
+  }
+
+  /**
+   * Find the models that cast shadows into the shadow maps of the given lights, along with the mask of the shadow map faces
+   * each of them can be seen from. The mask has a bit for each face of each light, at the index of the light times six
+   * plus the index of the face, which is how the light shadowmap shaders read it.
+   * 
+   * @param models           The models to check.
+   * @param lights           The lights sharing the shadow map type, in the order they are rendered.
+   * @param shadowMasks      The list to store the shadow map face masks of the found models to.
+   * @param shadowMapStates  The list to store the states of the shadow maps of the lights to, in the same order as the lights.
+   * 
+   * @return The models that can be seen from at least one face of the lights.
+   */
+  static std::pmr::vector<std::shared_ptr<ModelBaseIntf>> cullShadowCasters(const std::vector<std::shared_ptr<ModelBaseIntf>> &models, const std::pmr::vector<std::shared_ptr<LightBase>> &lights, std::pmr::vector<GLuint> &shadowMasks, std::pmr::vector<ShadowMapState> &shadowMapStates)
+  {
+    // Get the frustums of each face of each light, using their projection and view matrices.
+    std::pmr::vector<std::pmr::vector<Frustum>> lightFrustums(&FrameArena::getInstance());
+    lightFrustums.reserve(lights.size());
+    for (const auto &light : lights)
+    {
+      const auto &viewProjectionMatrices = light->getViewProjectionMatrices();
+      lightFrustums.emplace_back();
+      shadowMapStates.push_back({light->getChangeGeneration(), light->getShadowBufferDetails()->getShadowBufferTile(), {}, false, 0, {}, 0, 0});
+      for (uint32_t j = 0; j < light->getFacesCount(); j++)
+      {
+        lightFrustums.back().push_back(Frustum(viewProjectionMatrices[j]));
+      }
+    }
+
+    std::pmr::vector<std::shared_ptr<ModelBaseIntf>> shadowCasters(&FrameArena::getInstance());
+    for (const auto &model : models)
+    {
+      // Skip the models that don't cast shadows, which then don't make the shadow maps stale when they move either.
+      if (!model->castsShadows())
+      {
+        continue;
+      }
+      // Check which light faces the box around the model is inside.
+      const auto &transformedBox = model->getColliderDetails()->getColliderShape()->getTransformedBox();
+      GLuint shadowMask = 0;
+      for (unsigned long i = 0; i < lightFrustums.size(); i++)
+      {
+        const auto lightShadowMask = shadowMask;
+        for (unsigned long j = 0; j < lightFrustums[i].size(); j++)
+        {
+          if (lightFrustums[i][j].intersectsBox(transformedBox.getMinCorner(), transformedBox.getMaxCorner()))
+          {
+            shadowMask |= 1u << (i * 6 + j);
+          }
+        }
+        // Record the model as a caster of the light if any of the faces of the light can see it.
+        if (shadowMask != lightShadowMask)
+        {
+          shadowMapStates[i].casters.push_back({model->getModelHandle(), model->getRenderGeneration()});
+          shadowMapStates[i].spinningCasters = shadowMapStates[i].spinningCasters || isShadowSpinning(*model);
+        }
+      }
+      // Keep the model only if it's seen by at least one of the light faces.
+      if (shadowMask != 0)
+      {
+        shadowCasters.push_back(model);
+        shadowMasks.push_back(shadowMask);
+      }
+    }
+    return shadowCasters;
+  }
+
+  /**
+   * Pick the casters of the shadow map of a light that are cached drawn into it without the others, so only the others
+   * are drawn again while they move. The casters picked before are kept while they all stay in place, unless more of
+   * the other casters stayed in place than were picked. Otherwise those in the same place as in the previous frame that
+   * don't spin are picked, and none are cached for them yet. A light that changed since the previous frame picks none,
+   * since its whole shadow map is rendered again anyway.
+   * 
+   * @param previousState  The state of the shadow map in the previous frame, or nullptr if it wasn't rendered.
+   * @param shadowCasters  The models casting shadows into the shadow maps of the lights of the type of the light.
+   * @param shadowMasks    The shadow map face masks of the models.
+   * @param lightIndex     The index of the light among the lights of its type.
+   * @param newState       The state of the shadow map in the frame, to store the picked casters to.
+   */
+  void pickStaticShadowCasters(const ShadowMapState *previousState, const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &shadowCasters, const std::pmr::vector<GLuint> &shadowMasks, const unsigned long &lightIndex, ShadowMapState &newState)
+  {
+    if (!ShadowBufferManager::isStaticCasterCacheSupported() || previousState == nullptr || previousState->lightGeneration != newState.lightGeneration || !(previousState->tile == newState.tile))
+    {
+      return;
+    }
+
+    // Find the casters of the light with the same render generations as in the previous frame.
+    std::pmr::vector<std::pair<SlotHandle, uint64_t>> previousCasters(previousState->casters.begin(), previousState->casters.end(), &frameArena);
+    std::sort(previousCasters.begin(), previousCasters.end());
+    std::pmr::vector<std::pair<SlotHandle, uint64_t>> settledCasters(&frameArena);
+    for (unsigned long i = 0; i < shadowCasters.size(); i++)
+    {
+      const std::pair<SlotHandle, uint64_t> caster(shadowCasters[i]->getModelHandle(), shadowCasters[i]->getRenderGeneration());
+      if (((shadowMasks[i] >> (lightIndex * 6)) & 0x3fu) != 0 && !isShadowSpinning(*shadowCasters[i]) && std::binary_search(previousCasters.begin(), previousCasters.end(), caster))
+      {
+        settledCasters.push_back(caster);
+      }
+    }
+    std::sort(settledCasters.begin(), settledCasters.end());
+
+    const auto &previousStaticCasters = previousState->staticCasters;
+    if (previousState->staticCasterGeneration == shadowBufferManager.getStaticCasterGeneration() &&
+        std::includes(settledCasters.begin(), settledCasters.end(), previousStaticCasters.begin(), previousStaticCasters.end()) &&
+        settledCasters.size() - previousStaticCasters.size() <= previousStaticCasters.size())
+    {
+      newState.staticCasters = previousStaticCasters;
+      newState.staticFacesMask = previousState->staticFacesMask;
+      newState.staticCasterGeneration = previousState->staticCasterGeneration;
+      return;
+    }
+    newState.staticCasters.assign(settledCasters.begin(), settledCasters.end());
+    newState.staticFacesMask = 0;
+    newState.staticCasterGeneration = shadowBufferManager.getStaticCasterGeneration();
+  }
+
+  /**
+   * Get the models in the given render layers that are at least partially inside the given frustum, using the
+   * transformed AABB of their colliders.
+   * 
+   * @param models     The models to check.
+   * @param frustum    The frustum to check against.
+   * @param layerMask  The mask of the render layers of the models to keep.
+   * 
+   * @return The models that might be inside the frustum.
+   */
+  static std::pmr::vector<std::shared_ptr<ModelBaseIntf>> cullModels(const std::vector<std::shared_ptr<ModelBaseIntf>> &models, const Frustum &frustum, const uint32_t &layerMask)
+  {
+    std::pmr::vector<std::shared_ptr<ModelBaseIntf>> visibleModels(&FrameArena::getInstance());
+    for (const auto &model : models)
+    {
+      if ((model->getRenderLayers() & layerMask) == 0)
+      {
+        continue;
+      }
+      // Check if the box around the model is inside the frustum, and keep the model if it is.
+      const auto &transformedBox = model->getColliderDetails()->getColliderShape()->getTransformedBox();
+      if (frustum.intersectsBox(transformedBox.getMinCorner(), transformedBox.getMaxCorner()))
+      {
+        visibleModels.push_back(model);
+      }
+    }
+    return visibleModels;
+  }
+
+  /**
+   * Leave out the given models not in any of the given render layers, keeping the rest whether they can be seen or not.
+   * 
+   * @param models     The models to cull.
+   * @param layerMask  The mask of the render layers to keep the models of.
+   * 
+   * @return The models in the render layers.
+   */
+  static std::pmr::vector<std::shared_ptr<ModelBaseIntf>> cullModelLayers(const std::vector<std::shared_ptr<ModelBaseIntf>> &models, const uint32_t &layerMask)
+  {
+    std::pmr::vector<std::shared_ptr<ModelBaseIntf>> layerModels(&FrameArena::getInstance());
+    layerModels.reserve(models.size());
+    for (const auto &model : models)
+    {
+      if ((model->getRenderLayers() & layerMask) != 0)
+      {
+        layerModels.push_back(model);
+      }
+    }
+    return layerModels;
+  }
+
+  /**
+   * Registers a camera to be used as the active camera.
+   * 
+   * @param cameraHandle  The handle of the camera to set as the active camera.
+   */
+  void registerActiveCamera(const SlotHandle &cameraHandle)
+  {
+    activeCameraHandle = cameraHandle;
+  }
+
+  /**
+   * Get the handle of the active camera, which renders the scene to the window.
+   * 
+   * @return The handle of the active camera.
+   */
+  const SlotHandle &getActiveCameraHandle() const
+  {
+    return activeCameraHandle;
+  }
+
+  /**
+   * Register a view to render the scene to besides the window. Views rendering to other framebuffers are rendered before
+   * the window, so their textures can be shown in it, and views rendering to the window are drawn over it afterwards.
+   * Views rendering to the window are always forward shaded.
+   * 
+   * @param cameraView  The view.
+   * 
+   * @return The handle of the view.
+   */
+  SlotHandle registerCameraView(const CameraView &cameraView)
+  {
+    return cameraViews.insert(cameraView);
+  }
+
+  /**
+   * Deregister a view, so the scene is no longer rendered to it.
+   * 
+   * @param cameraViewHandle  The handle of the view.
+   */
+  void deregisterCameraView(const SlotHandle &cameraViewHandle)
+  {
+    cameraViews.remove(cameraViewHandle);
+  }
+
+  /**
+   * Set how the shadow casters are drawn into the shadow maps of a type of light.
+   * 
+   * @param shadowBufferType  The type of the shadow maps.
+   * @param settings          The settings of the shadow pass.
+   */
+  void setShadowPassSettings(const ShadowBufferType &shadowBufferType, const ShadowPassSettings &settings)
+  {
+    shadowPassSettings[shadowBufferType] = settings;
+  }
+
+  /**
+   * Set the face culling and the depth bias of the shadow casters drawn next.
+   * 
+   * @param settings  The settings of the shadow pass.
+   */
+  void applyShadowPassSettings(const ShadowPassSettings &settings)
+  {
+    auto &glStateCache = GlStateCache::getInstance();
+    glStateCache.setCapability(GL_CULL_FACE, settings.culling != ShadowCulling::NONE);
+    if (settings.culling != ShadowCulling::NONE)
+    {
+      glCullFace(settings.culling == ShadowCulling::FRONT ? GL_FRONT : GL_BACK);
+    }
+    const auto depthBiased = settings.depthBiasSlope != 0.0f || settings.depthBiasConstant != 0.0f;
+    glStateCache.setCapability(GL_POLYGON_OFFSET_FILL, depthBiased);
+    if (depthBiased)
+    {
+      glPolygonOffset(settings.depthBiasSlope, settings.depthBiasConstant);
+    }
+    getPassStats().stateChanges += 2;
+  }
+
+  /**
+   * Render the shadow maps for all the lights in the scene, and store the details of the lights categorized by their shadow
+   * map type.
+   * 
+   * @param categorizedLights           The lights in the scene categorized by their shadow map type.
+   * @param staticShadowInstanceGroups  The groups of the static casters for each shadow map type, drawn first, into the
+   *                                    faces they're cached from.
+   * @param storedStaticFaces           The lights whose faces have their static casters cached once they're drawn, with
+   *                                    the masks of the faces, for each shadow map type.
+   * @param shadowInstanceGroups        The groups of the other models casting shadows for each shadow map type, drawn
+   *                                    after the static casters are cached.
+   * @param categorizedLightDetails     The empty lists to store the details of the lights in, for each shadow map type.
+   */
+  void renderLights(const ShadowBufferTypeArray<std::pmr::vector<std::shared_ptr<LightBase>>> &categorizedLights, const ShadowBufferTypeArray<std::pmr::vector<ModelInstanceGroup>> &staticShadowInstanceGroups,
+                    const ShadowBufferTypeArray<std::pmr::vector<std::pair<std::shared_ptr<LightBase>, GLuint>>> &storedStaticFaces, const ShadowBufferTypeArray<std::pmr::vector<ModelInstanceGroup>> &shadowInstanceGroups,
+                    ShadowBufferTypeArray<std::pmr::vector<LightDetails>> &categorizedLightDetails)
+  {
+    currentRenderPass = RenderPass::SHADOWS;
+    auto &passStats = getPassStats();
+
+    // Set the current active shader ID to 0.
+    GLuint currentShaderId = 0;
+
+    // The shadow maps that need to be rendered again were already cleared or had their static casters restored, and the
+    //   others keep their contents from earlier frames.
+
+    // Enable the clip distances the light shadowmap shaders use to keep each light inside its shadow atlas tile.
+    for (GLenum i = 0; i < 4; i++)
+    {
+      GlStateCache::getInstance().setCapability(GL_CLIP_DISTANCE0 + i, true);
+    }
+
+    // The statistics of the lights are kept by their names, which the lights outlive the frame with.
+    std::pmr::map<std::string_view, int> lightNamesCount(&frameArena);
+    std::pmr::map<std::string_view, double> lightNamesProcessTime(&frameArena);
+
+    for (uint32_t lightType = 0; lightType < SHADOW_BUFFER_TYPES_COUNT; lightType++)
+    {
+      const auto &lights = categorizedLights[lightType];
+      if (lights.empty())
+      {
+        continue;
+      }
+
+      ProfileZone lightsZone(lights.front()->getLightName());
+      GpuDebugGroup lightsGroup(lightType == ShadowBufferType::CONE ? "Cone Shadows" : (lightType == ShadowBufferType::POINT ? "Point Shadows" : "Directional Shadows"));
+      // Measure the time the GPU takes for the shadow maps of this type of light.
+      auto &shadowRenderGpuTimer = shadowRenderGpuTimers[lightType];
+      shadowRenderGpuTimer.begin();
+
+      const auto firstLight = lights.front();
+
+      // Bind the shadowmap framebuffer of the light as the active framebuffer, with the viewport covering the layers of its
+      //   shadow atlas.
+      renderGraph.bindFramebuffer(firstLight->getShadowBufferDetails()->getShadowBufferId());
+      const auto shadowAtlasSize = ShadowBufferManager::getShadowAtlasSize(firstLight->getLightType());
+      GlStateCache::getInstance().setViewport(0, 0, shadowAtlasSize, shadowAtlasSize);
+
+      // Cull and bias the shadow casters the way the shadow maps of this type of light are set to.
+      applyShadowPassSettings(shadowPassSettings[lightType]);
+
+      // Check if the shader of the light is the same as the currently used shader.
+      if (currentShaderId != firstLight->getShaderDetails()->getShaderId())
+      {
+        // If not, set it as the currently used shader and use it.
+        currentShaderId = firstLight->getShaderDetails()->getShaderId();
+        GlStateCache::getInstance().useProgram(currentShaderId);
+        passStats.stateChanges++;
+      }
+
+      // Iterate through all the lights in the scene.
+      for (unsigned long i = 0; i < lights.size(); i++)
+      {
+        const auto &light = lights.at(i);
+
+        if (lightNamesCount.find(light->getLightName()) != lightNamesCount.end())
+        {
+          lightNamesCount[light->getLightName()]++;
+        }
+        else
+        {
+          lightNamesCount[light->getLightName()] = 1;
+          lightNamesProcessTime[light->getLightName()] = 0.0f;
+        }
+
+        // Get the type of the shadow.
+        const auto shadowType = light->getShadowBufferDetails()->getShadowBufferType();
+        // Get the tile of the shadow atlas the shadowmap of the light is stored in.
+        const auto &shadowBufferTile = light->getShadowBufferDetails()->getShadowBufferTile();
+        // Generate a structure detailing information about the light.
+        const LightDetails lightDetails = {
+            light->getLightPosition(),
+            light->getViewProjectionMatrices()[0],
+            light->getViewProjectionMatrices(),
+            -glm::vec3(glm::transpose(light->getViewMatrices()[0])[2]),
+            light->getLightColor(),
+            light->getLightIntensity(),
+            static_cast<int32_t>(shadowBufferTile.size),
+            static_cast<int32_t>(shadowBufferTile.size),
+            light->getLightNearPlane(),
+            light->getLightFarPlane(),
+            light->getShadowBufferDetails()->getShadowBufferTextureArrayLayerId(),
+            shadowBufferManager.getShadowBufferTileBounds(*light->getShadowBufferDetails())};
+        // Store the light details in the categorized map.
+        categorizedLightDetails[shadowType].push_back(lightDetails);
+
+        // If shadows are disabled, skip the shadowmap render step.
+        if (disableFeatureMask >= DISABLE_SHADOW)
+        {
+          continue;
+        }
+
+        // Get the projection-view matrices of the faces of the light.
+        const auto &facesCount = light->getFacesCount();
+        const auto &viewProjectionMatrices = light->getViewProjectionMatrices();
+
+        // Get the shader of the light and the uniform keys of the light details.
+        const auto &lightShader = light->getShaderDetails();
+        const auto &vertexKeys = shadowLightVertexKeys[i];
+        const auto &geometryKeys = shadowLightGeometryKeys[i];
+        const auto &fragmentKeys = shadowLightFragmentKeys[i];
+
+        // Get the uniform ID of the count of the projection-view matrix variable and set it.
+        glUniform1i(lightShader->getUniformLocation(vertexKeys.vpMatrixCount), facesCount);
+        glUniform1i(lightShader->getUniformLocation(geometryKeys.vpMatrixCount), facesCount);
+        glUniform1i(lightShader->getUniformLocation(fragmentKeys.vpMatrixCount), facesCount);
+
+        // Get the uniform ID of the light position variable and set it.
+        glUniform3f(lightShader->getUniformLocation(vertexKeys.lightPosition), lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
+        glUniform3f(lightShader->getUniformLocation(geometryKeys.lightPosition), lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
+        glUniform3f(lightShader->getUniformLocation(fragmentKeys.lightPosition), lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
+
+        // Get the uniform ID of the lights' shadow map layer ID variable and set it.
+        glUniform1i(lightShader->getUniformLocation(vertexKeys.layerId), lightDetails.textureArrayLayerId);
+        glUniform1i(lightShader->getUniformLocation(geometryKeys.layerId), lightDetails.textureArrayLayerId);
+        glUniform1i(lightShader->getUniformLocation(fragmentKeys.layerId), lightDetails.textureArrayLayerId);
+
+        // Get the uniform ID of the near plane of the light variable and set it.
+        glUniform1f(lightShader->getUniformLocation(vertexKeys.nearPlane), lightDetails.nearPlane);
+        glUniform1f(lightShader->getUniformLocation(geometryKeys.nearPlane), lightDetails.nearPlane);
+        glUniform1f(lightShader->getUniformLocation(fragmentKeys.nearPlane), lightDetails.nearPlane);
+
+        // Get the uniform ID of the far plane of the light variable and set it.
+        glUniform1f(lightShader->getUniformLocation(vertexKeys.farPlane), lightDetails.farPlane);
+        glUniform1f(lightShader->getUniformLocation(geometryKeys.farPlane), lightDetails.farPlane);
+        glUniform1f(lightShader->getUniformLocation(fragmentKeys.farPlane), lightDetails.farPlane);
+
+        // Get the uniform ID of the shadow atlas tile bounds of the light variable and set it, in normalized device
+        //   coordinates so the shaders can clip the light faces to the tile.
+        const auto tileClipBounds = lightDetails.tileBounds * 2.0f - 1.0f;
+        glUniform4f(lightShader->getUniformLocation(vertexKeys.tileBounds), tileClipBounds.x, tileClipBounds.y, tileClipBounds.z, tileClipBounds.w);
+        glUniform4f(lightShader->getUniformLocation(geometryKeys.tileBounds), tileClipBounds.x, tileClipBounds.y, tileClipBounds.z, tileClipBounds.w);
+        glUniform4f(lightShader->getUniformLocation(fragmentKeys.tileBounds), tileClipBounds.x, tileClipBounds.y, tileClipBounds.z, tileClipBounds.w);
+
+        // Get the matrix moving the light faces into the shadow atlas tile of the light.
+        const auto tileMatrix = createTileMatrix(lightDetails.tileBounds);
+        // Iterate through the faces of the light.
+        for (uint32_t j = 0; j < facesCount; j++)
+        {
+          // Move the projection-view matrix of the face into the tile of the light.
+          const auto vpMatrix = tileMatrix * viewProjectionMatrices[j];
+          // Get the uniform ID of the projection-view matrix of the light variable and set it.
+          glUniformMatrix4fv(lightShader->getUniformLocation(vertexKeys.vpMatrices[j]), 1, GL_FALSE, &vpMatrix[0][0]);
+          glUniformMatrix4fv(lightShader->getUniformLocation(geometryKeys.vpMatrices[j]), 1, GL_FALSE, &vpMatrix[0][0]);
+          glUniformMatrix4fv(lightShader->getUniformLocation(fragmentKeys.vpMatrices[j]), 1, GL_FALSE, &vpMatrix[0][0]);
+        }
+        // Each of the five details of the light is set for the three shader stages, and so is each of its matrices.
+        passStats.uniformCalls += 3 * (5 + facesCount);
+      }
+
+      // Get the uniform ID of the lights count variable and set it.
+      glUniform1i(firstLight->getShaderDetails()->getUniformLocation(lightsCountKey), lights.size());
+      passStats.uniformCalls++;
+
+      // Lights with instanced faces draw each model once for every face of every light, with the vertex shader picking the
+      // face from the instance ID, which for the single face of the cone lights is once per light, whose layers multiview
+      // covers in the same draw when it's supported. Otherwise the geometry shader fans each model out to the faces.
+      const GLuint instancesPerModel = firstLight->hasInstancedFaces() ? lights.size() * firstLight->getFacesCount() : 1;
+
+      // Draw the groups of models casting shadows into the shadow maps of the lights.
+      const auto lightShaderId = firstLight->getShaderDetails()->getShaderId();
+      const auto drawShadowCasters = [&](const std::pmr::vector<ModelInstanceGroup> &modelInstanceGroups) {
+        for (const auto &modelInstanceGroup : modelInstanceGroups)
+        {
+          // Get the object details and the level of detail shared by the models of the group.
+          const auto &objectDetails = modelInstanceGroup.firstModel->getObjectDetails();
+          const auto &lod = objectDetails->getLod(modelInstanceGroup.lodLevel);
+          countDrawnGeometry(lod.indexCount, modelInstanceGroup.instanceCount * instancesPerModel);
+
+          // Collect the draw of the group with the draws before it, which are all submitted at once.
+          if (multiDrawIndirectEnabled)
+          {
+            if (submitIndirectDraws(lightShaderId, 0, objectDetails->getVertexArrayId()))
+            {
+              GlStateCache::getInstance().bindVertexArray(objectDetails->getVertexArrayId());
+              VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase, instancesPerModel);
+              VertexArray::attachInstanceIntegerAttribute(INSTANCE_SHADOW_MASK_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceShadowMaskBase, instancesPerModel);
+              VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), 2, instanceSpinBase, instancesPerModel);
+              passStats.stateChanges += 4;
+            }
+            indirectDrawBatch.add(lightShaderId, 0, objectDetails->getVertexArrayId(), {lod.indexCount, modelInstanceGroup.instanceCount * instancesPerModel, lod.firstIndex, objectDetails->getBaseVertex(), modelInstanceGroup.firstInstance});
+            continue;
+          }
+
+          // Bind the vertex array object of the object, which already contains its vertex attribute layout.
+          GlStateCache::getInstance().bindVertexArray(objectDetails->getVertexArrayId());
+          // Point the instance attributes at the model matrices, shadow map face masks and spins of the group, since there is
+          // no base instance support.
+          VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase + modelInstanceGroup.firstInstance, instancesPerModel);
+          VertexArray::attachInstanceIntegerAttribute(INSTANCE_SHADOW_MASK_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceShadowMaskBase + modelInstanceGroup.firstInstance, instancesPerModel);
+          VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), 2, instanceSpinBase + modelInstanceGroup.firstInstance, instancesPerModel);
+
+          // Draw the triangles of all the models of the group.
+          glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * lod.firstIndex), modelInstanceGroup.instanceCount * instancesPerModel, objectDetails->getBaseVertex());
+          passStats.drawCalls++;
+          passStats.stateChanges += 3;
+        }
+        submitIndirectDraws();
+      };
+
+      // Draw the static casters first and cache the faces they were drawn into, before the other casters are drawn over them.
+      drawShadowCasters(staticShadowInstanceGroups[lightType]);
+      for (const auto &storedFaces : storedStaticFaces[lightType])
+      {
+        shadowBufferManager.storeStaticCasters(*storedFaces.first->getShadowBufferDetails(), storedFaces.second);
+      }
+      drawShadowCasters(shadowInstanceGroups[lightType]);
+
+      // Unbind the vertex array object.
+      GlStateCache::getInstance().bindVertexArray(0);
+
+      shadowRenderGpuTimer.end();
+      lightNamesProcessTime[firstLight->getLightName()] += lightsZone.end();
+    }
+
+    // Disable the clip distances again for the other passes.
+    for (GLenum i = 0; i < 4; i++)
+    {
+      GlStateCache::getInstance().setCapability(GL_CLIP_DISTANCE0 + i, false);
+    }
+    // Go back to the back face culling and the unbiased depths of the other passes.
+    applyShadowPassSettings({ShadowCulling::BACK, 0.0f, 0.0f});
+
+    auto height = 21.5f;
+    for (const auto &lightCounts : lightNamesCount)
+    {
+      const auto avgRenderTime = lightNamesProcessTime[lightCounts.first] / lightCounts.second;
+      textManager.addFormattedText(glm::vec2(1, height), 0.5f, lightCounts.first, " Light Render Instances: ", lightCounts.second, " | Render (avg): ", avgRenderTime, "ms");
+      height -= 0.5f;
+    }
+  }
+
+  /**
+   * Submit the draws collected for multi-draw indirect, unless the next draw shares their state and can be added to them.
+   *   The draws need to be submitted before the state they share is changed.
+   * 
+   * @param programId      The ID of the shader program of the next draw.
+   * @param textureId      The ID of the texture of the next draw.
+   * @param vertexArrayId  The ID of the vertex array of the next draw.
+   * 
+   * @return Whether the next draw starts a new batch of draws, which the instance attributes need to be pointed at the
+   *         start of the instance data of the frame for.
+   */
+  bool submitIndirectDraws(const GLuint &programId, const GLuint &textureId, const GLuint &vertexArrayId)
+  {
+    if (indirectDrawBatch.isBatching(programId, textureId, vertexArrayId))
+    {
+      return false;
+    }
+    submitIndirectDraws();
+    return true;
+  }
+
+  /**
+   * Get the buffer the instance attributes of the draws collected for multi-draw indirect point at, which is the culled
+   *   instance data while the instances are culled on the GPU.
+   * 
+   * @return The ID of the buffer.
+   */
+  GLuint getIndirectInstanceBufferId() const
+  {
+    return cullingIndirectDraws ? gpuInstanceCuller.getCulledInstanceBufferId() : instanceStreamingBuffer.getBufferId();
+  }
+
+  /**
+   * Get the sphere around the mesh of the object in the space of its vertices, which its instances are culled with on the
+   *   GPU. The compact vertices are turned into the space of the object by the instance matrices, so their sphere is the
+   *   one around their bounds as stored, while the sphere around the other objects is the one around their origin, which
+   *   spinning them in the vertex shaders doesn't change.
+   * 
+   * @param objectDetails  The details of the object.
+   * 
+   * @return The sphere, with the centre in xyz and the radius in w.
+   */
+  static glm::vec4 getVertexBoundingSphere(const ObjectDetails &objectDetails)
+  {
+    if (objectDetails.getVertexFormat() != MeshVertexFormat::COMPACT)
+    {
+      return glm::vec4(0.0f, 0.0f, 0.0f, objectDetails.getBoundingRadius());
+    }
+    const auto inverseVertexMatrix = glm::inverse(objectDetails.getVertexMatrix());
+    const auto minCorner = glm::vec3(inverseVertexMatrix * glm::vec4(objectDetails.getBoundsMin(), 1.0f));
+    const auto maxCorner = glm::vec3(inverseVertexMatrix * glm::vec4(objectDetails.getBoundsMax(), 1.0f));
+    return glm::vec4((minCorner + maxCorner) * 0.5f, glm::length(maxCorner - minCorner) * 0.5f);
+  }
+
+  /**
+   * Submit the draws collected for multi-draw indirect, counting the call and the commands uploaded for the current pass.
+   */
+  void submitIndirectDraws()
+  {
+    auto &passStats = getPassStats();
+    passStats.uploadedBytes += indirectDrawBatch.getCommandsSize();
+    // Culling the draws on the GPU first binds the culling shader, its three uniforms and three buffers, and binds the
+    //   shader of the draws again.
+    if (cullingIndirectDraws && indirectDrawBatch.getCommandsSize() > 0)
+    {
+      passStats.uniformCalls += 3;
+      passStats.stateChanges += 5;
+    }
+    passStats.drawCalls += indirectDrawBatch.submit();
+  }
+
+  /**
+   * Get the work the current pass submitted so far in the frame.
+   * 
+   * @return The work of the current pass.
+   */
+  RenderStats &getPassStats()
+  {
+    return renderStats[static_cast<uint32_t>(currentRenderPass)];
+  }
+
+  /**
+   * Set the variables of a model shader that stay the same for every model drawn with it in the view, which the shader
+   *   has to be in use for.
+   * 
+   * @param modelShader  The model shader.
+   * @param view         The view the models are drawn for.
+   */
+  void setModelShaderUniforms(const ShaderDetails &modelShader, const CameraView &view)
+  {
+    // Get the uniform ID of the disable feature mask variable and set it.
+    glUniform1i(modelShader.getUniformLocation(disableFeatureMaskKey), disableFeatureMask);
+    // Get the uniform ID of the ambient lighting factor variable and set it.
+    glUniform1f(modelShader.getUniformLocation(ambientFactorKey), ambientFactor);
+    // Get the uniform ID of the texture samplers and set them to their texture units.
+    glUniform1i(modelShader.getUniformLocation(diffuseTextureKey), 0);
+    glUniform1i(modelShader.getUniformLocation(coneLightTexturesKey), 1);
+    glUniform1i(modelShader.getUniformLocation(pointLightTexturesKey), 2);
+    glUniform1i(modelShader.getUniformLocation(clusteredLightsKey), 3);
+    glUniform1i(modelShader.getUniformLocation(clusterLightRangesKey), 4);
+    glUniform1i(modelShader.getUniformLocation(clusterLightIndicesKey), 5);
+    glUniform1i(modelShader.getUniformLocation(directionalLightTexturesKey), 9);
+    // Pass the corner of the viewport of the view, so the fragments find their light clusters relative to it.
+    glUniform2f(modelShader.getUniformLocation(viewportOffsetKey), view.viewport.x, view.viewport.y);
+    getPassStats().uniformCalls += 10;
+  }
+
+  /**
+   * Count the instances and the triangles of a draw for the current pass, whether it's drawn on its own or collected for
+   *   multi-draw indirect.
+   * 
+   * @param indexCount      The number of indices of the mesh drawn.
+   * @param instancesCount  The number of instances drawn.
+   */
+  void countDrawnGeometry(const uint32_t &indexCount, const uint32_t &instancesCount)
+  {
+    auto &passStats = getPassStats();
+    passStats.instances += instancesCount;
+    passStats.triangles += uint64_t(indexCount / 3) * instancesCount;
+  }
+
+  /**
+   * Get the number of state changes the model render queue applied since it was last cleared.
+   * 
+   * @return The number of state changes.
+   */
+  uint32_t getQueueStateChangesCount() const
+  {
+    const auto &appliedChanges = modelRenderQueue.getAppliedChanges();
+    return appliedChanges.programs + appliedChanges.textures + appliedChanges.meshes;
+  }
+
+  /**
+   * Draw only the depths of the given models, so the colour pass can skip every fragment that ends up hidden behind another.
+   *   The groups are drawn in the order of the model render queue, which needs to be sorted already.
+   * 
+   * @param modelInstanceGroups  The groups of models in the scene to draw with instancing.
+   */
+  void renderModelDepths(const std::pmr::vector<ModelInstanceGroup> &modelInstanceGroups)
+  {
+    currentRenderPass = RenderPass::DEPTH_PRE_PASS;
+    GpuDebugGroup depthPrePassGroup("Depth Pre-pass");
+    auto &passStats = getPassStats();
+    const auto queueStateChangesCount = getQueueStateChangesCount();
+
+    // Only the depth buffer is written to.
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    modelRenderQueue.resetState();
+    modelRenderQueue.useProgram(depthPrePassShader->getShaderId());
+
+    // Iterate through the groups of models in the scene, in the order of the queue.
+    for (const auto &renderQueueItem : modelRenderQueue.getItems())
+    {
+      // Bind the vertex array object of the object of the group, and point the instance matrix attribute at the group.
+      const auto &modelInstanceGroup = modelInstanceGroups[renderQueueItem.itemIndex];
+      const auto &objectDetails = modelInstanceGroup.firstModel->getObjectDetails();
+      const auto &lod = objectDetails->getLod(modelInstanceGroup.lodLevel);
+      countDrawnGeometry(lod.indexCount, modelInstanceGroup.instanceCount);
+      const auto startsBatch = multiDrawIndirectEnabled && submitIndirectDraws(depthPrePassShader->getShaderId(), 0, objectDetails->getVertexArrayId());
+      modelRenderQueue.bindVertexArray(objectDetails->getVertexArrayId());
+      if (multiDrawIndirectEnabled)
+      {
+        // Collect the draw of the group with the draws before it, which are all submitted at once.
+        if (startsBatch)
+        {
+          VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, getIndirectInstanceBufferId(), instanceMatrixBase);
+          VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, getIndirectInstanceBufferId(), 2, instanceSpinBase);
+          passStats.stateChanges += 2;
+        }
+        indirectDrawBatch.add(depthPrePassShader->getShaderId(), 0, objectDetails->getVertexArrayId(), {lod.indexCount, modelInstanceGroup.instanceCount, lod.firstIndex, objectDetails->getBaseVertex(), modelInstanceGroup.firstInstance}, getVertexBoundingSphere(*objectDetails));
+        continue;
+      }
+      VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase + modelInstanceGroup.firstInstance);
+      VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), 2, instanceSpinBase + modelInstanceGroup.firstInstance);
+
+      // Draw the triangles of all the models of the group.
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * lod.firstIndex), modelInstanceGroup.instanceCount, objectDetails->getBaseVertex());
+      passStats.drawCalls++;
+      passStats.stateChanges++;
+    }
+    submitIndirectDraws();
+    passStats.stateChanges += getQueueStateChangesCount() - queueStateChangesCount;
+
+    // Unbind the vertex array object and start writing colours again.
+    GlStateCache::getInstance().bindVertexArray(0);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    currentRenderPass = RenderPass::MODELS;
+  }
+
+  /**
+   * Get the shadow quality tier the shader variants of the models are built for, which is the highest tier, the shader's
+   * default, when shadows are disabled, since the tier isn't needed without shadows.
+   * 
+   * @return The shadow quality tier of the variants.
+   */
+  ShadowQuality getVariantShadowQuality() const
+  {
+    return disableFeatureMask < DISABLE_SHADOW ? shadowQuality : ShadowQuality::HIGH;
+  }
+
+  /**
+   * Build the definitions of the shader variants of the models, fixing the number of lights, the disabled features and
+   * the shadow quality tier so the shaders don't loop or branch over them. The light counts aren't needed without
+   * lighting, which keeps the number of variants down.
+   * 
+   * @param coneLightsCount         The number of cone lights with shadow maps.
+   * @param pointLightsCount        The number of point lights with shadow maps.
+   * @param directionalLightsCount  The number of directional lights with shadow maps.
+   * 
+   * @return The definitions of the variants.
+   */
+  std::string getModelShaderDefines(const size_t &coneLightsCount, const size_t &pointLightsCount, const size_t &directionalLightsCount) const
+  {
+    std::string modelShaderDefines = "#define DISABLE_FEATURE_MASK " + std::to_string(disableFeatureMask) + "\n";
+    if (disableFeatureMask < DISABLE_LIGHT)
+    {
+      modelShaderDefines += "#define CONE_LIGHTS_COUNT " + std::to_string(coneLightsCount) + "\n" +
+                            "#define POINT_LIGHTS_COUNT " + std::to_string(pointLightsCount) + "\n" +
+                            "#define DIRECTIONAL_LIGHTS_COUNT " + std::to_string(directionalLightsCount) + "\n";
+    }
+    return modelShaderDefines + shadowQualityDefines.at(getVariantShadowQuality());
+  }
+
+  /**
+   * Build the definitions of the shader variants the models are drawn to the views with. With deferred shading, the
+   * models only record their surfaces, which doesn't depend on the lights or features. The models sample their textures
+   * through the handles in their instance data with bindless textures.
+   * 
+   * @param deferredShading     Whether the models are drawn into the geometry buffer.
+   * @param modelShaderDefines  The definitions of the shader variants of the models for the lights of the frame.
+   * 
+   * @return The definitions of the variants.
+   */
+  std::string getGeometryShaderDefines(const bool &deferredShading, const std::string &modelShaderDefines) const
+  {
+    return (deferredShading ? std::string("#define DEFERRED_GBUFFER\n") : modelShaderDefines) + (bindlessTexturesEnabled ? "#define BINDLESS_TEXTURES\n" : "");
+  }
+
+  /**
+   * Light the surfaces recorded in the geometry buffer and draw them to the screen, with a single full-screen pass that
+   * shades every pixel once, however many models were drawn over it. The shadow maps and light clusters need to be bound
+   * already.
+   * 
+   * @param view                   The view the geometry buffer was drawn for.
+   * @param lightingShaderDefines  The definitions of the model shader variants of the frame, which the lighting pass
+   *                               variant uses as well.
+   */
+  void renderDeferredLighting(const CameraView &view, const std::string &lightingShaderDefines)
+  {
+    currentRenderPass = RenderPass::DEFERRED_LIGHTING;
+    GpuDebugGroup lightingGroup("Deferred Lighting");
+    auto &passStats = getPassStats();
+
+    // Go back to drawing to the framebuffer of the view.
+    renderGraph.bindFramebuffer(view.framebufferId);
+    GlStateCache::getInstance().setViewport(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+
+    // Get the lighting pass variant of the shader and set its variables.
+    const auto &lightingShader = shaderManager.getShaderVariant(deferredLightingShader, "#define DEFERRED_LIGHTING\n" + lightingShaderDefines);
+    GlStateCache::getInstance().useProgram(lightingShader->getShaderId());
+    glUniform1i(lightingShader->getUniformLocation(disableFeatureMaskKey), disableFeatureMask);
+    glUniform1f(lightingShader->getUniformLocation(ambientFactorKey), ambientFactor);
+    glUniform1i(lightingShader->getUniformLocation(coneLightTexturesKey), 1);
+    glUniform1i(lightingShader->getUniformLocation(pointLightTexturesKey), 2);
+    glUniform1i(lightingShader->getUniformLocation(clusteredLightsKey), 3);
+    glUniform1i(lightingShader->getUniformLocation(clusterLightRangesKey), 4);
+    glUniform1i(lightingShader->getUniformLocation(clusterLightIndicesKey), 5);
+    glUniform1i(lightingShader->getUniformLocation(geometryAlbedoTextureKey), 6);
+    glUniform1i(lightingShader->getUniformLocation(geometryNormalTextureKey), 7);
+    glUniform1i(lightingShader->getUniformLocation(geometryDepthTextureKey), 8);
+    glUniform1i(lightingShader->getUniformLocation(directionalLightTexturesKey), 9);
+    // Pass the inverse camera matrices, and the size the geometry buffer was drawn at and the corner of the viewport, so
+    //   the pixels can be found in the geometry buffer and their positions found from their depths.
+    glUniform2f(lightingShader->getUniformLocation(geometryViewportSizeKey), view.viewport.z, view.viewport.w);
+    glUniform2f(lightingShader->getUniformLocation(viewportOffsetKey), view.viewport.x, view.viewport.y);
+    const auto &activeCamera = cameraManager.getCamera(view.cameraHandle);
+    glUniformMatrix4fv(lightingShader->getUniformLocation(inverseViewMatrixKey), 1, GL_FALSE, &activeCamera->getInverseViewMatrix()[0][0]);
+    glUniformMatrix4fv(lightingShader->getUniformLocation(inverseProjectionMatrixKey), 1, GL_FALSE, &activeCamera->getInverseProjectionMatrix()[0][0]);
+
+    // Bind the textures of the geometry buffer after the light textures.
+    geometryBuffer.bindTextures(6);
+
+    // Every pixel is written by the lighting pass, along with the depth from the geometry buffer, so the passes drawn
+    // afterwards are still depth tested against the models.
+    glDepthFunc(GL_ALWAYS);
+    GlStateCache::getInstance().bindVertexArray(fullScreenVertexArrayId);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GlStateCache::getInstance().bindVertexArray(0);
+    glDepthFunc(GL_LESS);
+    // The shader, the three textures of the geometry buffer and the vertex array were bound, with the framebuffer bound
+    //   through the render graph.
+    passStats.drawCalls++;
+    countDrawnGeometry(3, 1);
+    passStats.uniformCalls += 14;
+    passStats.stateChanges += 5;
+    currentRenderPass = RenderPass::MODELS;
+  }
+
+  /**
+   * Test the models in the window view for being hidden behind the others against the depth the window view was drawn
+   *   with, using the camera matrices it left bound, for culling them in the next frame.
+   *
+   * @param view            The window view.
+   * @param models          The models in view of the camera, hidden or not.
+   * @param cameraPosition  The position of the camera.
+   */
+  void testOcclusion(const CameraView &view, const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &models, const glm::vec3 &cameraPosition)
+  {
+    currentRenderPass = RenderPass::OCCLUSION;
+    GpuDebugGroup occlusionGroup("Occlusion Queries");
+    GlStateCache::getInstance().setViewport(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+    occlusionCuller.testModels(models, cameraPosition);
+    // Every query draws the box around its model with its own corners, after the shader, the vertex array, the masks and
+    //   the culling were set.
+    auto &passStats = getPassStats();
+    passStats.drawCalls += occlusionCuller.getIssuedQueriesCount();
+    passStats.uniformCalls += occlusionCuller.getIssuedQueriesCount() * 2;
+    passStats.stateChanges += 6;
+    currentRenderPass = RenderPass::SETUP;
+  }
+
+  /**
+   * Draw the particles to the framebuffer of the given view, if any of them are alive.
+   *
+   * @param view  The view to draw the particles to.
+   */
+  void renderParticles(const CameraView &view)
+  {
+    currentRenderPass = RenderPass::PARTICLES;
+    if (particleManager.renderParticles(float_t(view.viewport.w)))
+    {
+      // The shader, the vertex array, the blending, the depth mask and the point size were set, with the two uniforms.
+      auto &passStats = getPassStats();
+      passStats.drawCalls++;
+      passStats.instances += particleManager.getParticlesCount();
+      passStats.uniformCalls += 2;
+      passStats.stateChanges += 5;
+    }
+    currentRenderPass = RenderPass::MODELS;
+  }
+
+  /**
+   * Render the models in the scene to the view. The groups of models are sorted by their shader, texture and object
+   *   first, so each of them is only bound when it changes from the group drawn before.
+   * 
+   * @param view                 The view to render to.
+   * @param isWindowView         Whether the view is the window view, which is the only one that can be deferred shaded
+   *                             and whose statistics are shown.
+   * @param categorizedLights    The details of the lights in the scene for each shadow map type.
+   * @param modelInstanceGroups  The groups of models in the view to draw with instancing.
+   * @param impostorInstances    The range of the impostor instances of the view.
+   */
+  void renderModels(const CameraView &view, const bool &isWindowView, const ShadowBufferTypeArray<std::pmr::vector<LightDetails>> &categorizedLights, const std::pmr::vector<ModelInstanceGroup> &modelInstanceGroups, const ImpostorInstanceRange &impostorInstances)
+  {
+    // The geometry buffer covers the whole window, so only the window view is deferred shaded.
+    const auto deferredShading = deferredShadingEnabled && isWindowView;
+    currentRenderPass = RenderPass::MODELS;
+    GpuDebugGroup modelsGroup(isWindowView ? "Models" : "Models (Camera View)");
+
+    // Cull the instances of the draws of the window view against the frustum of its camera on the GPU, with GPU culling.
+    cullingIndirectDraws = isWindowView && gpuCullingEnabled && multiDrawIndirectEnabled;
+    if (cullingIndirectDraws)
+    {
+      const auto &camera = *cameraManager.getCamera(view.cameraHandle);
+      gpuInstanceCuller.beginView(camera.getFrustum(), camera.getCameraPosition(), instanceStreamingBuffer.getBufferId(), instanceStreamingBuffer.getStorageSize(),
+                                  instanceMatrixBase, instanceShadowMaskBase, instanceTextureHandleBase, instanceSpinBase);
+      indirectDrawBatch.setInstanceCuller(&gpuInstanceCuller);
+    }
+
+    // Switch to the viewport of the view, whose framebuffer the render graph bound and cleared.
+    GlStateCache::getInstance().setViewport(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+
+    // Fill the light uniform block with the details of the lights in the scene.
+    LightUniformBlock lightUniformBlock = {};
+    // Get the details of the cone lights, point lights and directional lights in the scene.
+    const auto &coneLights = categorizedLights[ShadowBufferType::CONE];
+    const auto &pointLights = categorizedLights[ShadowBufferType::POINT];
+    const auto &directionalLights = categorizedLights[ShadowBufferType::DIRECTIONAL];
+    // Store the number of active lights.
+    lightUniformBlock.coneLightsCount = coneLights.size();
+    lightUniformBlock.pointLightsCount = pointLights.size();
+    lightUniformBlock.directionalLightsCount = directionalLights.size();
+    // Store the number of clustered lights and how to find the cluster of a fragment.
+    lightUniformBlock.clusteredLightsCount = lightClusterGrid.getLightsCount();
+    lightUniformBlock.clusterParameters = lightClusterGrid.getClusterParameters();
+    // Store the details of the cone lights.
+    for (unsigned long i = 0; i < coneLights.size(); i++)
+    {
+      lightUniformBlock.coneLightDetails[i] = createLightUniformDetails(coneLights[i], coneLights[i].textureArrayLayerId);
+    }
+    // Store the details of the point lights. The model shaders index cubemaps, so the layer ID is divided by the six faces.
+    for (unsigned long i = 0; i < pointLights.size(); i++)
+    {
+      lightUniformBlock.pointLightDetails[i] = createLightUniformDetails(pointLights[i], pointLights[i].textureArrayLayerId / 6);
+    }
+    // Store the details of the directional lights, with their directions in the view-space of the camera of the view.
+    const auto &viewMatrix = cameraManager.getCamera(view.cameraHandle)->getViewMatrix();
+    for (unsigned long i = 0; i < directionalLights.size(); i++)
+    {
+      lightUniformBlock.directionalLightDetails[i] = createDirectionalLightUniformDetails(directionalLights[i], viewMatrix);
+    }
+    // Upload the light uniform block to the GPU, making it available to all the model shaders.
+    uploadUniformBlock(lightUniformBufferId, sizeof(LightUniformBlock), &lightUniformBlock);
+    // The shadow map and light cluster textures were bound.
+    getPassStats().uploadedBytes += sizeof(LightUniformBlock);
+    getPassStats().stateChanges += 6;
+
+    // Bind the cone light shadow map texture array.
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE1);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, shadowBufferManager.getConeLightTextureArrayId());
+    // Bind the point light shadow map texture array.
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE2);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadowBufferManager.getPointLightTextureArrayId());
+    // Bind the directional light shadow map texture array, after the textures of the geometry buffer.
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE9);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, shadowBufferManager.getDirectionalLightTextureArrayId());
+    // Bind the buffer textures of the clustered lights and the light clusters.
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE3);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_BUFFER, clusteredLightTextureId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE4);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_BUFFER, clusterLightRangeTextureId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE5);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_BUFFER, clusterLightIndexTextureId);
+    // Build the definitions of the shader variants of the models for the lights of the frame.
+    const auto variantShadowQuality = getVariantShadowQuality();
+    const auto modelShaderDefines = getModelShaderDefines(coneLights.size(), pointLights.size(), directionalLights.size());
+    const auto geometryShaderDefines = getGeometryShaderDefines(deferredShading, modelShaderDefines);
+
+    // Push the groups of models into the render queue with the state they're drawn with, along with how far the first
+    // model of each group is from the camera, and sort them so groups sharing state are drawn one after another.
+    modelRenderQueue.clear();
+    std::pmr::vector<std::shared_ptr<const ShaderDetails>> modelInstanceGroupShaders(&frameArena);
+    modelInstanceGroupShaders.reserve(modelInstanceGroups.size());
+    const auto &vpMatrix = cameraManager.getCamera(view.cameraHandle)->getViewProjectionMatrix();
+    for (uint32_t i = 0; i < modelInstanceGroups.size(); i++)
+    {
+      const auto &model = modelInstanceGroups[i].firstModel;
+      // Get the variant of the shader of the model matching the lights and features of the frame.
+      modelInstanceGroupShaders.push_back(shaderManager.getShaderVariant(model->getShaderDetails(), geometryShaderDefines));
+      // Get the depth of the model between the near and far planes, with models behind the camera counted as the nearest.
+      const auto clipPosition = vpMatrix * glm::vec4(model->getModelPosition(), 1.0f);
+      const auto depth = clipPosition.w > 0.0f ? clipPosition.z / clipPosition.w * 0.5f + 0.5f : 0.0f;
+      const auto textureId = bindlessTexturesEnabled ? 0 : model->getTextureDetails()->getTextureId();
+      modelRenderQueue.push(0, modelInstanceGroupShaders.back()->getShaderId(), textureId, model->getObjectDetails()->getVertexArrayId(), depth, i);
+    }
+    modelRenderQueue.sort();
+
+    // With deferred shading, the models are drawn into the geometry buffer instead, and the screen is filled by the
+    // lighting pass afterwards.
+    if (deferredShading)
+    {
+      renderGraph.bindFramebuffer(geometryBuffer.getFramebufferId());
+      geometryBuffer.clearForGeometryPass(glm::ivec2(view.viewport.z, view.viewport.w));
+    }
+    // Fill the depth buffer first if the depth pre-pass is enabled, then only shade the fragments whose depths match the
+    // closest ones, without writing the depths again. Deferred shading already shades each pixel once, so it goes without.
+    else if (depthPrePassEnabled)
+    {
+      renderModelDepths(modelInstanceGroups);
+      glDepthFunc(GL_EQUAL);
+      glDepthMask(GL_FALSE);
+    }
+
+    // The lower shadow quality tiers read the flat shadow maps with hardware depth comparisons, and every tier reads the
+    // point light shadow maps with them, while the highest tier compares the nearest depths itself. The diffuse textures
+    // of the models are filtered with the preset of the texture filtering setting.
+    auto &samplerManager = SamplerManager::getInstance();
+    const auto flatShadowSamplerPreset = variantShadowQuality == ShadowQuality::HIGH ? SamplerPreset::NEAREST : SamplerPreset::SHADOW_COMPARE;
+    samplerManager.bindSampler(0, textureFilteringPreset);
+    samplerManager.bindSampler(1, flatShadowSamplerPreset);
+    samplerManager.bindSampler(2, SamplerPreset::SHADOW_COMPARE);
+    samplerManager.bindSampler(9, flatShadowSamplerPreset);
+    auto &passStats = getPassStats();
+    passStats.stateChanges += 4;
+
+    // The statistics of the models are kept by their names, which the models outlive the frame with.
+    std::pmr::map<std::string_view, int> modelNamesCount(&frameArena);
+    std::pmr::map<std::string_view, double> modelNamesProcessTime(&frameArena);
+    std::pmr::map<std::string_view, long> modelNamesPolygonCount(&frameArena);
+    auto totalPolygons = 0l;
+
+    // The diffuse textures of the models are bound to the first texture unit.
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+    modelRenderQueue.resetState();
+    const auto queueStateChangesCount = getQueueStateChangesCount();
+
+    // Iterate through the groups of models in the scene, in the order of the queue.
+    for (const auto &renderQueueItem : modelRenderQueue.getItems())
+    {
+      // Get the first model of the group, whose details are shared by the whole group.
+      const auto &modelInstanceGroup = modelInstanceGroups[renderQueueItem.itemIndex];
+      const auto &model = modelInstanceGroup.firstModel;
+      const auto &modelShader = modelInstanceGroupShaders[renderQueueItem.itemIndex];
+      const auto &lod = model->getObjectDetails()->getLod(modelInstanceGroup.lodLevel);
+      ProfileZone modelZone(model->getModelName());
+      countDrawnGeometry(lod.indexCount, modelInstanceGroup.instanceCount);
+
+      // Submit the draws collected before if the group needs a different state, before the state is changed.
+      const auto textureId = bindlessTexturesEnabled ? 0 : model->getTextureDetails()->getTextureId();
+      const auto startsBatch = multiDrawIndirectEnabled && submitIndirectDraws(modelShader->getShaderId(), textureId, model->getObjectDetails()->getVertexArrayId());
+
+      // Use the shader of the model, if it isn't already the currently used shader.
+      if (modelRenderQueue.useProgram(modelShader->getShaderId()))
+      {
+        setModelShaderUniforms(*modelShader, view);
+      }
+
+      if (modelNamesCount.find(model->getModelName()) != modelNamesCount.end())
+      {
+        modelNamesCount[model->getModelName()] += modelInstanceGroup.instanceCount;
+      }
+      else
+      {
+        modelNamesCount[model->getModelName()] = modelInstanceGroup.instanceCount;
+        modelNamesProcessTime[model->getModelName()] = 0.0f;
+      }
+
+      // Bind the diffuse texture of the model, unless the group before already used it, or the models sample their
+      // textures through their handles.
+      if (!bindlessTexturesEnabled)
+      {
+        modelRenderQueue.bindTexture(model->getTextureDetails()->getTextureId());
+      }
+
+      // Bind the vertex array object of the object, which already contains its vertex attribute layout, unless the group
+      // before already used it.
+      modelRenderQueue.bindVertexArray(model->getObjectDetails()->getVertexArrayId());
+      if (multiDrawIndirectEnabled)
+      {
+        // Point the instance attributes at the start of the instance data of the frame once per batch, with each draw
+        // of the batch picking its own instances by its base instance.
+        if (startsBatch)
+        {
+          VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, getIndirectInstanceBufferId(), instanceMatrixBase);
+          VertexArray::attachInstanceIntegerAttribute(INSTANCE_LIGHT_MASK_ATTRIBUTE_LOCATION, getIndirectInstanceBufferId(), instanceShadowMaskBase);
+          VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, getIndirectInstanceBufferId(), 2, instanceSpinBase);
+          passStats.stateChanges += 3;
+          if (bindlessTexturesEnabled)
+          {
+            VertexArray::attachInstanceTextureHandleAttribute(INSTANCE_TEXTURE_HANDLE_ATTRIBUTE_LOCATION, getIndirectInstanceBufferId(), instanceTextureHandleBase);
+            passStats.stateChanges++;
+          }
+        }
+        // Collect the draw of the group, to be submitted with the draws sharing its state. When the instances are culled on
+        // the GPU, the full meshes split into enough meshlets are drawn a meshlet of an instance per draw instead, so the
+        // meshlets out of view or facing away are culled on their own, unless that makes too many draws.
+        const auto &objectDetails = *model->getObjectDetails();
+        const auto &meshlets = objectDetails.getMeshlets();
+        if (cullingIndirectDraws && modelInstanceGroup.lodLevel == 0 && meshlets.size() >= MESHLET_CULLING_MIN_MESHLETS && modelInstanceGroup.instanceCount * meshlets.size() <= MESHLET_CULLING_MAX_DRAWS)
+        {
+          for (uint32_t instance = 0; instance < modelInstanceGroup.instanceCount; instance++)
+          {
+            for (const auto &meshlet : meshlets)
+            {
+              indirectDrawBatch.add(modelShader->getShaderId(), textureId, objectDetails.getVertexArrayId(), {meshlet.indexCount, 1, meshlet.firstIndex, objectDetails.getBaseVertex(), modelInstanceGroup.firstInstance + instance}, meshlet.boundingSphere, meshlet.normalCone);
+            }
+          }
+          meshletDrawsCount += modelInstanceGroup.instanceCount * meshlets.size();
+        }
+        else
+        {
+          indirectDrawBatch.add(modelShader->getShaderId(), textureId, objectDetails.getVertexArrayId(), {lod.indexCount, modelInstanceGroup.instanceCount, lod.firstIndex, objectDetails.getBaseVertex(), modelInstanceGroup.firstInstance}, getVertexBoundingSphere(objectDetails));
+        }
+      }
+      else
+      {
+        // Point the instance matrix, light mask and spin attributes at the model matrices, light masks and spins of the
+        // group, since there is no base instance support, and the texture handle attribute at the texture handles of the group.
+        VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase + modelInstanceGroup.firstInstance);
+        VertexArray::attachInstanceIntegerAttribute(INSTANCE_LIGHT_MASK_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceShadowMaskBase + modelInstanceGroup.firstInstance);
+        VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), 2, instanceSpinBase + modelInstanceGroup.firstInstance);
+        passStats.stateChanges += 3;
+        if (bindlessTexturesEnabled)
+        {
+          VertexArray::attachInstanceTextureHandleAttribute(INSTANCE_TEXTURE_HANDLE_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceTextureHandleBase + modelInstanceGroup.firstInstance);
+          passStats.stateChanges++;
+        }
+
+        // Draw the triangles of all the models of the group.
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * lod.firstIndex), modelInstanceGroup.instanceCount, model->getObjectDetails()->getBaseVertex());
+        passStats.drawCalls++;
+      }
+
+      modelNamesProcessTime[model->getModelName()] += modelZone.end();
+      modelNamesPolygonCount[model->getModelName()] = lod.indexCount / 3;
+      totalPolygons += modelInstanceGroup.instanceCount * lod.indexCount / 3;
+    }
+    submitIndirectDraws();
+    passStats.stateChanges += getQueueStateChangesCount() - queueStateChangesCount;
+    indirectDrawBatch.setInstanceCuller(nullptr);
+    cullingIndirectDraws = false;
+
+    // Draw the impostors of the view with the impostor variant of the default shader, which they were all captured with
+    // the geometry buffer variant of. They aren't in the depth pre-pass, so they're depth tested and write their depths.
+    if (impostorInstances.instanceCount > 0)
+    {
+      ProfileZone impostorsZone("Impostors");
+      const auto &impostorShader = shaderManager.getShaderVariant(deferredLightingShader, (deferredShading ? std::string("#define DEFERRED_GBUFFER\n") : modelShaderDefines) + "#define IMPOSTOR\n");
+      if (depthPrePassEnabled && !deferredShading)
+      {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+      }
+      GlStateCache::getInstance().useProgram(impostorShader->getShaderId());
+      setModelShaderUniforms(*impostorShader, view);
+      impostorBatch.draw(impostorInstances, *impostorShader, passStats);
+    }
+
+    // Unbind the vertex array object.
+    GlStateCache::getInstance().bindVertexArray(0);
+
+    // Light the geometry buffer onto the screen.
+    if (deferredShading)
+    {
+      renderDeferredLighting(view, modelShaderDefines);
+    }
+
+    // Unbind the samplers, so the passes after filter their textures with their own parameters.
+    SamplerManager::unbindSampler(0);
+    SamplerManager::unbindSampler(1);
+    SamplerManager::unbindSampler(2);
+    SamplerManager::unbindSampler(9);
+    // Go back to the usual depth testing after the depth pre-pass.
+    if (depthPrePassEnabled && !deferredShading)
+    {
+      glDepthFunc(GL_LESS);
+      glDepthMask(GL_TRUE);
+    }
+    // Draw the hit particles over the models, hidden behind them by the depth of the models.
+    renderParticles(view);
+
+    if (!isWindowView)
+    {
+      return;
+    }
+
+    auto height = 23.0f;
+    for (const auto &modelCounts : modelNamesCount)
+    {
+      const auto avgRenderTime = modelNamesProcessTime[modelCounts.first] / modelCounts.second;
+      textManager.addFormattedText(glm::vec2(1, height), 0.5f, modelCounts.first, " Model Render Instances: ", modelCounts.second, " | Render (avg): ", avgRenderTime, "ms | Polygon Count: ", modelNamesPolygonCount[modelCounts.first]);
+      height -= 0.5f;
+    }
+    const auto &appliedChanges = modelRenderQueue.getAppliedChanges();
+    const auto &avoidedChanges = modelRenderQueue.getAvoidedChanges();
+    textManager.addFormattedText(glm::vec2(1, 12.5f), 0.5f, "Total Polygons: ", totalPolygons, " | State Changes (Program/Texture/Mesh): ", appliedChanges.programs, "/", appliedChanges.textures, "/", appliedChanges.meshes, " | Avoided: ", avoidedChanges.programs, "/", avoidedChanges.textures, "/", avoidedChanges.meshes, " | Multi-draw Indirect (O): ", (multiDrawIndirectEnabled ? "On" : (windowManager.isMultiDrawIndirectSupported() ? "Off" : "Unsupported")));
+  }
 
-public:
-  // Preventing copying the render manager, making sure only one instance can exist.
-  RenderManager(const RenderManager &) = delete;
+  /**
+   * Move the scale of the resolution the window view is rendered at towards keeping the GPU frame time within budget,
+   * one step at a time once the GPU timers had time to measure the current scale.
+   */
+  void updateResolutionScale()
+  {
+    if (!dynamicResolutionEnabled)
+    {
+      resolutionScale = 1.0f;
+      return;
+    }
+    // Smooth the GPU frame time over the latest frames, so a single slow frame doesn't change the resolution.
+    smoothedGpuRenderTime = glm::mix(smoothedGpuRenderTime, getGpuRenderTime(), 0.1);
+    if (++framesSinceResolutionChange < RESOLUTION_SCALE_INTERVAL)
+    {
+      return;
+    }
+    // Only raise the resolution once the frames are well within budget, so the scale doesn't flip between two steps.
+    auto newResolutionScale = resolutionScale;
+    if (smoothedGpuRenderTime > GPU_RENDER_BUDGET)
+    {
+      newResolutionScale -= RESOLUTION_SCALE_STEP;
+    }
+    else if (smoothedGpuRenderTime < GPU_RENDER_BUDGET * 0.75f)
+    {
+      newResolutionScale += RESOLUTION_SCALE_STEP;
+    }
+    newResolutionScale = glm::clamp(newResolutionScale, MIN_RESOLUTION_SCALE, 1.0f);
+    if (newResolutionScale != resolutionScale)
+    {
+      resolutionScale = newResolutionScale;
+      framesSinceResolutionChange = 0;
+    }
+  }
 
   /**
-   * Registers a camera to be used as the active camera.
+   * Upscale the window view from the scene render target to the window, along with its depths so the passes drawn
+   * afterwards are still depth tested against the models. The render graph bound the window framebuffer.
    * 
-   * @param cameraId  The ID of the camera to set as the active camera.
+   * @param view         The window view, rendered to the scene render target.
+   * @param sceneTarget  The scene render target.
+   * @param fxaa         Whether the edges of the scene are smoothed with FXAA while upscaling.
    */
-  void registerActiveCamera(const std::string &cameraId)
+  void upscaleScene(const CameraView &view, const RenderTarget &sceneTarget, const bool &fxaa)
   {
-    activeCameraId = cameraId;
+    currentRenderPass = RenderPass::UPSCALE;
+    GpuDebugGroup upscaleGroup("Upscale");
+    windowManager.switchToWindowViewport();
+    const auto &shader = fxaa ? shaderManager.getShaderVariant(upscaleShader, "#define FXAA\n") : upscaleShader;
+    GlStateCache::getInstance().useProgram(shader->getShaderId());
+    glUniform1i(shader->getUniformLocation(sceneColorTextureKey), 0);
+    glUniform1i(shader->getUniformLocation(sceneDepthTextureKey), 1);
+    glUniform2f(shader->getUniformLocation(sceneScaleKey), float_t(view.viewport.z) / VIEWPORT_WIDTH, float_t(view.viewport.w) / VIEWPORT_HEIGHT);
+    sceneTarget.bindTextures(0);
+
+    // Every pixel of the window is written, so it doesn't need clearing first.
+    glDepthFunc(GL_ALWAYS);
+    GlStateCache::getInstance().bindVertexArray(fullScreenVertexArrayId);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GlStateCache::getInstance().bindVertexArray(0);
+    glDepthFunc(GL_LESS);
+    // The shader, the two textures of the scene render target and the vertex array were bound.
+    auto &passStats = getPassStats();
+    passStats.drawCalls++;
+    countDrawnGeometry(3, 1);
+    passStats.uniformCalls += 3;
+    passStats.stateChanges += 4;
   }
 
   /**
-   * Render the shadow maps for all the lights in the scene, and return the map of lights categorized by their shadow map type.
+   * Fill the camera uniform block with the view and projection matrices of the given camera.
    * 
-   * @return The map of the lights in the scene categorized by their shadow map type.
+   * @param cameraHandle  The handle of the camera to render the scene from.
    */
-  std::map<const ShadowBufferType, std::vector<LightDetails>> renderLights() const
+  void updateCameraUniformBlock(const SlotHandle &cameraHandle)
   {
-    // Switch the viewport to the size of the render framebuffers.
-    windowManager.switchToFrameBufferViewport();
+    // Get the camera to use to render the scene.
+    const auto &activeCamera = cameraManager.getCamera(cameraHandle);
+    // Store the view and projection matrices of the camera in the block.
+    const CameraUniformBlock cameraUniformBlock = {activeCamera->getViewMatrix(), activeCamera->getProjectionMatrix()};
+    // Upload the camera uniform block to the GPU, making it available to all the shaders.
+    uploadUniformBlock(cameraUniformBufferId, sizeof(CameraUniformBlock), &cameraUniformBlock);
+    getPassStats().uploadedBytes += sizeof(CameraUniformBlock);
+  }
 
-    // Create a map of the categorized lights.
-    std::map<const ShadowBufferType, std::vector<LightDetails>> categorizedLightDetails({{ShadowBufferType::CONE, {}}, {ShadowBufferType::POINT, {}}});
+  /**
+   * Render the scene with the light shadowmaps and the models.
+   * 
+   * @param frameTime  The time of the frame.
+   */
+  void render(const FrameTime &frameTime)
+  {
+    // Start counting the work of the passes of the frame, with the uploads shared by the passes counted on their own.
+    renderStats = {};
+    currentRenderPass = RenderPass::SETUP;
+    GlStateCache::getInstance().resetCounts();
+
+    // Upload the time of the frame, which every pass turns the spinning model instances by.
+    spinTime = float_t(frameTime.now);
+    const FrameUniformBlock frameUniformBlock = {spinTime, {0.0f, 0.0f, 0.0f}};
+    uploadUniformBlock(frameUniformBufferId, sizeof(FrameUniformBlock), &frameUniformBlock);
+    getPassStats().uploadedBytes += sizeof(FrameUniformBlock);
+
+    // Move the particles once for the frame, before any view draws them.
+    currentRenderPass = RenderPass::PARTICLES;
+    if (particleManager.updateParticles(frameTime.now))
+    {
+      // The emitters are the only data sent for the particles, along with the times of the frame.
+      getPassStats().uniformCalls += 3;
+      getPassStats().uploadedBytes += MAX_PARTICLE_EMITTERS * sizeof(glm::vec4);
+      getPassStats().stateChanges += 4;
+    }
+    currentRenderPass = RenderPass::SETUP;
 
-    // Set the current active shader ID to 0.
-    GLuint currentShaderId = 0;
+    // Check if the "L" has been pressed to change the disable feature mask.
+    if (controlManager.wasKeyPressed(GLFW_KEY_L))
+    {
+      // "L" was pressed, meaning we need to start disabling render features.
+      // Check which features have already been disabled.
+      switch (disableFeatureMask)
+      {
+      case 0:
+        // No features were disabled. Add the depth pre-pass first, then start disabling shadows without it.
+        if (!depthPrePassEnabled)
+        {
+          depthPrePassEnabled = true;
+        }
+        else
+        {
+          depthPrePassEnabled = false;
+          disableFeatureMask = DISABLE_SHADOW;
+        }
+        break;
+      case 1:
+        // Shadows were disabled. Start disabling lighting.
+        disableFeatureMask = DISABLE_LIGHT;
+        break;
+      case 2:
+      default:
+        // All features were disabled. Enable everything.
+        disableFeatureMask = 0;
+      }
+    }
 
+    // Check if the "G" has been pressed to change the shading mode.
+    if (controlManager.wasKeyPressed(GLFW_KEY_G))
     {
-      // Bind the cone light shadow framebuffer as the active framebuffer and clear it.
-      glBindFramebuffer(GL_FRAMEBUFFER, shadowBufferManager.getConeLightShadowBufferId());
-      glClear(GL_DEPTH_BUFFER_BIT);
+      // "G" was pressed, so switch between forward shading and deferred shading.
+      deferredShadingEnabled = !deferredShadingEnabled;
+    }
 
-      // Bind the point light shadow framebuffer as the active framebuffer and clear it.
-      glBindFramebuffer(GL_FRAMEBUFFER, shadowBufferManager.getPointLightShadowBufferId());
-      glClear(GL_DEPTH_BUFFER_BIT);
+    // Check if the "U" has been pressed to toggle bindless textures.
+    if (controlManager.wasKeyPressed(GLFW_KEY_U))
+    {
+      // "U" was pressed, so switch between binding the textures of the models and sampling them through bindless handles,
+      // if the GPU supports them.
+      bindlessTexturesEnabled = !bindlessTexturesEnabled && GLEW_ARB_bindless_texture;
+    }
 
-      // Bind the window framebuffer as the active framebuffer.
-      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // Check if the "O" has been pressed to toggle multi-draw indirect.
+    if (controlManager.wasKeyPressed(GLFW_KEY_O))
+    {
+      // "O" was pressed, so switch between a draw call for every group of models and a multi-draw indirect call for every
+      // run of groups sharing their state, if the GPU supports it.
+      multiDrawIndirectEnabled = !multiDrawIndirectEnabled && windowManager.isMultiDrawIndirectSupported();
     }
 
-    auto lightNamesCount = std::map<const std::string, int>({});
-    auto lightNamesProcessTime = std::map<const std::string, double>({});
+    // Check if the "Z" has been pressed to toggle occlusion culling.
+    if (controlManager.wasKeyPressed(GLFW_KEY_Z))
+    {
+      // "Z" was pressed, so switch between drawing every model in view and leaving out those hidden behind other models,
+      // bringing them all back into view when it's turned off.
+      occlusionCullingEnabled = !occlusionCullingEnabled;
+      occlusionCuller.resetQueries();
+    }
 
-    std::map<const ShadowBufferType, std::vector<std::shared_ptr<LightBase>>> categorizedLights({{ShadowBufferType::CONE, {}}, {ShadowBufferType::POINT, {}}});
-    for (const auto &light : lightManager.getAllLights())
+    // Check if the "X" has been pressed to toggle GPU culling.
+    if (controlManager.wasKeyPressed(GLFW_KEY_X))
     {
-      categorizedLights.at(light->getShadowBufferDetails()->getShadowBufferType()).push_back(light);
+      // "X" was pressed, so switch between culling the models of the window view on the CPU and culling their instances
+      // on the GPU, if the GPU can run the culling compute shader.
+      gpuCullingEnabled = !gpuCullingEnabled && gpuInstanceCuller.isSupported();
     }
+    const auto gpuCullingActive = gpuCullingEnabled && multiDrawIndirectEnabled;
 
-    for (const auto &lights : categorizedLights)
+    // Check if the "K" has been pressed to change the shadow quality tier.
+    if (controlManager.wasKeyPressed(GLFW_KEY_K))
     {
-      if (lights.second.empty())
+      // "K" was pressed, so move on to the next shadow quality tier, going back to the lowest after the highest.
+      switch (shadowQuality)
       {
-        continue;
+      case ShadowQuality::LOW:
+        shadowQuality = ShadowQuality::MEDIUM;
+        break;
+      case ShadowQuality::MEDIUM:
+        shadowQuality = ShadowQuality::HIGH;
+        break;
+      case ShadowQuality::HIGH:
+      default:
+        shadowQuality = ShadowQuality::LOW;
       }
+    }
 
-      const auto startTime = glfwGetTime();
-
-      const auto firstLight = lights.second.front();
-
-      // Bind the shadowmap framebuffer of the light as the active framebuffer.
-      glBindFramebuffer(GL_FRAMEBUFFER, firstLight->getShadowBufferDetails()->getShadowBufferId());
+    // Check if the "R" has been pressed to toggle dynamic resolution.
+    if (controlManager.wasKeyPressed(GLFW_KEY_R))
+    {
+      // "R" was pressed, so switch between rendering the window view at the window resolution and at a scaled one.
+      dynamicResolutionEnabled = !dynamicResolutionEnabled;
+      framesSinceResolutionChange = 0;
+    }
+    updateResolutionScale();
 
-      // Check if the shader of the light is the same as the currently used shader.
-      if (currentShaderId != firstLight->getShaderDetails()->getShaderId())
+    // Check if the "N" has been pressed to change the anti-aliasing mode.
+    if (controlManager.wasKeyPressed(GLFW_KEY_N))
+    {
+      // "N" was pressed, so move on to the next anti-aliasing mode, going back to none after FXAA.
+      switch (antiAliasingMode)
       {
-        // If not, set it as the currently used shader and use it.
-        currentShaderId = firstLight->getShaderDetails()->getShaderId();
-        glUseProgram(currentShaderId);
+      case AntiAliasingMode::OFF:
+        antiAliasingMode = AntiAliasingMode::MSAA_2X;
+        break;
+      case AntiAliasingMode::MSAA_2X:
+        antiAliasingMode = AntiAliasingMode::MSAA_4X;
+        break;
+      case AntiAliasingMode::MSAA_4X:
+        antiAliasingMode = AntiAliasingMode::MSAA_8X;
+        break;
+      case AntiAliasingMode::MSAA_8X:
+        antiAliasingMode = AntiAliasingMode::FXAA;
+        break;
+      case AntiAliasingMode::FXAA:
+      default:
+        antiAliasingMode = AntiAliasingMode::OFF;
       }
+    }
+    const auto multisampleEnabled = antiAliasingModeSamples.count(antiAliasingMode) > 0;
+    const auto fxaaEnabled = antiAliasingMode == AntiAliasingMode::FXAA;
+    const auto upscaleEnabled = dynamicResolutionEnabled || multisampleEnabled || fxaaEnabled;
+
+    // Order the views of the frame, with the views rendering to other framebuffers first so the window can show them, then
+    //   the window as seen from the active camera, then the views drawn over the window. With dynamic resolution, the
+    //   window view is rendered to the bottom-left of the scene render target at the scaled resolution, and with MSAA to
+    //   the multisampled target, resolved into the scene render target afterwards. The framebuffer of the window view is
+    //   only known once the render graph places the targets, right before the window view is rendered.
+    CameraView windowView = {activeCameraHandle,
+                             0,
+                             glm::ivec4(0, 0, std::max(1, int32_t(VIEWPORT_WIDTH * resolutionScale)), std::max(1, int32_t(VIEWPORT_HEIGHT * resolutionScale))),
+                             ~0u};
+    std::pmr::vector<const CameraView *> views(&frameArena);
+    for (const auto &cameraView : cameraViews.getValues())
+    {
+      if (cameraView.framebufferId != 0)
+      {
+        views.push_back(&cameraView);
+      }
+    }
+    const auto windowViewIndex = views.size();
+    views.push_back(&windowView);
+    for (const auto &cameraView : cameraViews.getValues())
+    {
+      if (cameraView.framebufferId == 0)
+      {
+        views.push_back(&cameraView);
+      }
+    }
 
-      // Iterate through all the lights in the scene.
-      for (unsigned long i = 0; i < lights.second.size(); i++)
+    // Cull the models outside each view, and those not in its render layers.
+    ProfileZone cullModelsZone("Cull Models");
+    const auto &allModels = modelManager.getAllModels();
+    std::pmr::vector<std::pmr::vector<std::shared_ptr<ModelBaseIntf>>> viewsVisibleModels(&frameArena);
+    viewsVisibleModels.reserve(views.size());
+    for (unsigned long i = 0; i < views.size(); i++)
+    {
+      // The instances of the window view are culled on the GPU with GPU culling, so only its render layers are checked here.
+      const auto &view = views[i];
+      viewsVisibleModels.push_back(i == windowViewIndex && gpuCullingActive ? cullModelLayers(allModels, view->layerMask)
+                                                                              : cullModels(allModels, cameraManager.getCamera(view->cameraHandle)->getFrustum(), view->layerMask));
+    }
+    // Leave out the models of the window view the latest occlusion queries found hidden, keeping all the models in view to
+    //   test them again once the window view is drawn.
+    const auto &activeCameraPosition = cameraManager.getCamera(activeCameraHandle)->getCameraPosition();
+    std::pmr::vector<std::shared_ptr<ModelBaseIntf>> occlusionTestedModels(&frameArena);
+    if (occlusionCullingEnabled)
+    {
+      occlusionTestedModels = viewsVisibleModels[windowViewIndex];
+      viewsVisibleModels[windowViewIndex] = occlusionCuller.cullOccludedModels(occlusionTestedModels, activeCameraPosition);
+    }
+    cullModelsZone.end();
+    const auto &visibleModels = viewsVisibleModels[windowViewIndex];
+
+    // Stream in the mip levels of the textures the models in view need for how big they are on the screen, and select the
+    // levels of detail of their objects for it.
+    ProfileZone streamTexturesZone("Stream Textures");
+    // How much of each model is drawn as its impostor is picked for its size on the screen as well.
+    std::pmr::vector<std::pmr::vector<uint32_t>> viewsLodLevels(&frameArena);
+    std::pmr::vector<std::pmr::vector<float_t>> viewsImpostorCoverages(&frameArena);
+    viewsLodLevels.reserve(views.size());
+    viewsImpostorCoverages.reserve(views.size());
+    for (unsigned long i = 0; i < views.size(); i++)
+    {
+      const auto &camera = *cameraManager.getCamera(views[i]->cameraHandle);
+      viewsLodLevels.emplace_back();
+      viewsImpostorCoverages.emplace_back();
+      for (const auto &model : viewsVisibleModels[i])
       {
-        const auto &light = lights.second.at(i);
+        const auto screenSize = getModelScreenSize(*model, camera, views[i]->viewport.w);
+        textureManager.requestTextureSize(*model->getTextureDetails(), screenSize);
+        viewsLodLevels.back().push_back(selectModelLod(*model->getObjectDetails(), screenSize, 0));
+        viewsImpostorCoverages.back().push_back(ImpostorBatch::getImpostorCoverage(*model, screenSize));
+      }
+    }
+    textureManager.processTextureStreaming();
+    streamTexturesZone.end();
+    textManager.addFormattedText(glm::vec2(1, 12), 0.5f, "Models Drawn: ", visibleModels.size(), " | Culled: ", allModels.size() - visibleModels.size(), " | Occluded (Z): ",
+                                 (occlusionCullingEnabled ? std::to_string(occlusionCuller.getOccludedModelsCount()) : "Off"), " | GPU Culling (X): ",
+                                 (gpuCullingActive ? "On (Meshlet Draws: " + std::to_string(meshletDrawsCount) + ")" : (gpuInstanceCuller.isSupported() ? "Off" : "Unsupported")), " | Camera Views: ", views.size(), " | Resolution (R): ", int32_t(resolutionScale * 100.0f), "% | Streamed Textures: ", textureManager.getStreamedTexturesSize() / (1024 * 1024), "MB");
+    meshletDrawsCount = 0;
+
+    // The textures sampled through their bindless handles aren't filtered by the bound sampler, so their handles are
+    // created with the sampler of the texture filtering setting instead.
+    if (bindlessTexturesEnabled)
+    {
+      textureManager.setHandleSampler(SamplerManager::getInstance().getSamplerId(textureFilteringPreset));
+    }
 
-        if (lightNamesCount.find(light->getLightName()) != lightNamesCount.end())
+    // Group the models sharing the same details for each pass, and upload their instance data once for the whole frame.
+    std::pmr::vector<glm::mat4> instanceMatrices(&frameArena);
+    std::pmr::vector<GLuint> instanceShadowMasks(&frameArena);
+    std::pmr::vector<GLuint64> instanceTextureHandles(&frameArena);
+    std::pmr::vector<glm::vec2> instanceSpins(&frameArena);
+    // Models the camera can't see can still cast shadows into view, so the shadow casters of each light are culled against
+    // the faces of the light instead.
+    ProfileZone prepareLightsZone("Prepare Lights");
+    std::pmr::vector<std::shared_ptr<LightBase>> clusteredLights(&frameArena);
+    const auto categorizedLights = categorizeLights(clusteredLights);
+    // Fit the shadow maps of the lights to how much of the screen they cover, which moves any resized shadow map to a new
+    // tile of the shadow atlas and so renders it again, and fit the cascades of the directional lights to the slices of the
+    // view of the camera. The shadow maps waiting for their turn stay where they are.
+    for (uint32_t lightType = 0; lightType < SHADOW_BUFFER_TYPES_COUNT; lightType++)
+    {
+      const auto &lights = categorizedLights[lightType];
+      for (const auto &light : lights)
+      {
+        if (isShadowUpdateWaiting(*light))
         {
-          lightNamesCount[light->getLightName()]++;
+          continue;
         }
-        else
+        const auto &shadowTier = scheduledShadowLights.at(light->getLightHandle())->shadowTier;
+        shadowBufferManager.resizeShadowBuffer(*light->getShadowBufferDetails(), getShadowMapSize(*light, *cameraManager.getCamera(activeCameraHandle), shadowTier, resolutionScale));
+        light->fitToCamera(*cameraManager.getCamera(activeCameraHandle));
+      }
+    }
+    prepareLightsZone.end();
+    ProfileZone cullShadowCastersZone("Cull Shadow Casters");
+    auto staticShadowInstanceGroups = createShadowBufferTypeLists<ModelInstanceGroup>();
+    auto storedStaticFaces = createShadowBufferTypeLists<std::pair<std::shared_ptr<LightBase>, GLuint>>();
+    auto shadowInstanceGroups = createShadowBufferTypeLists<ModelInstanceGroup>();
+    std::string shadowCastersText = "Shadow Casters (Moving+Static):";
+    uint32_t updatedShadowMapsCount = 0, shadowMapsCount = 0, restoredShadowMapsCount = 0;
+    // Render every shadow map again once the shadow atlases lost their contents, such as when they're reallocated.
+    if (shadowContentsGeneration != shadowBufferManager.getContentsGeneration())
+    {
+      shadowContentsGeneration = shadowBufferManager.getContentsGeneration();
+      shadowMapStates.clear();
+    }
+    if (disableFeatureMask < DISABLE_SHADOW)
+    {
+      std::map<SlotHandle, ShadowMapState> newShadowMapStates({});
+      const auto &cameraFrustum = cameraManager.getCamera(activeCameraHandle)->getFrustum();
+      for (uint32_t lightType = 0; lightType < SHADOW_BUFFER_TYPES_COUNT; lightType++)
+      {
+        const auto &lights = categorizedLights[lightType];
+        std::pmr::vector<GLuint> shadowMasks(&frameArena);
+        std::pmr::vector<ShadowMapState> lightShadowMapStates(&frameArena);
+        const auto shadowCasters = cullShadowCasters(allModels, lights, shadowMasks, lightShadowMapStates);
+
+        // Find the faces of the lights whose shadow maps changed since they were last rendered, and start them over from
+        //   their cached static casters, or clear them if they have none cached.
+        GLuint updatedFacesMask = 0, clearedFacesMask = 0;
+        for (unsigned long i = 0; i < lights.size(); i++)
         {
-          lightNamesCount[light->getLightName()] = 1;
-          lightNamesProcessTime[light->getLightName()] = 0.0f;
+          const auto &light = lights[i];
+          const auto shadowMapState = shadowMapStates.find(light->getLightHandle());
+          // Keep the shadow maps waiting for their turn as they were, along with the states they were rendered with, so
+          //   they're rendered once it's their turn if they're stale.
+          if (isShadowUpdateWaiting(*light))
+          {
+            newShadowMapStates.insert(*shadowMapState);
+            shadowMapsCount++;
+            continue;
+          }
+          auto &newShadowMapState = lightShadowMapStates[i];
+          pickStaticShadowCasters(shadowMapState != shadowMapStates.end() ? &shadowMapState->second : nullptr, shadowCasters, shadowMasks, i, newShadowMapState);
+          GLuint facesMask = 0;
+          if (shadowMapState == shadowMapStates.end() || !(shadowMapState->second.tile == newShadowMapState.tile))
+          {
+            // There's nothing to keep of a shadow map without a previous render in the tile, so all its faces are rendered.
+            facesMask = (1u << light->getFacesCount()) - 1;
+          }
+          else
+          {
+            // Every face is stale once the shadow map changes, and stays stale until it's picked to be rendered again.
+            const auto staleFacesMask = shadowMapState->second == newShadowMapState ? shadowMapState->second.staleFacesMask : (1u << light->getFacesCount()) - 1;
+            facesMask = staleFacesMask != 0 ? light->selectUpdatedFaces(staleFacesMask, cameraFrustum) : 0;
+            newShadowMapState.staleFacesMask = staleFacesMask & ~facesMask;
+          }
+          if (facesMask != 0)
+          {
+            // The cleared faces have the static casters drawn into them first, which they're cached with again.
+            const auto restoredFacesMask = newShadowMapState.staticCasters.empty() ? 0 : facesMask & newShadowMapState.staticFacesMask;
+            const auto lightClearedFacesMask = facesMask & ~restoredFacesMask;
+            if (restoredFacesMask != 0)
+            {
+              shadowBufferManager.restoreStaticCasters(*light->getShadowBufferDetails(), restoredFacesMask);
+              restoredShadowMapsCount++;
+            }
+            if (lightClearedFacesMask != 0)
+            {
+              shadowBufferManager.clearShadowBuffer(*light->getShadowBufferDetails(), lightClearedFacesMask);
+              if (!newShadowMapState.staticCasters.empty())
+              {
+                storedStaticFaces[lightType].push_back({light, lightClearedFacesMask});
+                newShadowMapState.staticFacesMask |= lightClearedFacesMask;
+              }
+            }
+            updatedFacesMask |= facesMask << (i * 6);
+            clearedFacesMask |= lightClearedFacesMask << (i * 6);
+            updatedShadowMapsCount++;
+          }
+          newShadowMapStates.insert(std::make_pair(light->getLightHandle(), newShadowMapState));
+          shadowMapsCount++;
         }
 
-        // Get the type of the shadow.
-        const auto shadowType = light->getShadowBufferDetails()->getShadowBufferType();
-        // Generate a structure detailing information about the light.
-        const LightDetails lightDetails = {
-            light->getLightPosition(),
-            light->getProjectionMatrices()[0] * light->getViewMatrices()[0] * glm::mat4(),
-            light->getLightColor(),
-            light->getLightIntensity(),
-            FRAMEBUFFER_WIDTH,
-            FRAMEBUFFER_WIDTH,
-            light->getLightNearPlane(),
-            light->getLightFarPlane(),
-            light->getShadowBufferDetails()->getShadowBufferTextureArrayLayerId()};
-        // Store the light details in the categorized map.
-        categorizedLightDetails.at(shadowType).push_back(lightDetails);
-
-        // If shadows are disabled, skip the shadowmap render step.
-        if (disableFeatureMask >= DISABLE_SHADOW)
+        // Only draw the shadow casters into the faces of the lights being rendered again. The static casters of a light are
+        //   only drawn into its cleared faces, since the others already have them, and the other casters into all of them.
+        // The shadows are seen through the window, so the shadow casters are drawn a few levels of detail coarser than they'd
+        //   be drawn in the window, where the softened edges of the shadows hide the difference.
+        // The masks and levels of detail of the casters are found in parallel, and the casters are split by them after.
+        std::pmr::vector<GLuint> casterStaticMasks(shadowCasters.size(), 0, &frameArena), casterUpdatedMasks(shadowCasters.size(), 0, &frameArena);
+        std::pmr::vector<uint32_t> casterLodLevels(shadowCasters.size(), 0, &frameArena);
+        const auto &activeCamera = *cameraManager.getCamera(activeCameraHandle);
+        ParallelTasks::runChunked(shadowCasters.size(), MIN_PARALLEL_MODELS, [&](const uint32_t, const size_t begin, const size_t end) {
+          for (size_t i = begin; i < end; i++)
+          {
+            if ((shadowMasks[i] & updatedFacesMask) == 0)
+            {
+              continue;
+            }
+            const std::pair<SlotHandle, uint64_t> caster(shadowCasters[i]->getModelHandle(), shadowCasters[i]->getRenderGeneration());
+            GLuint staticLightsMask = 0;
+            for (unsigned long j = 0; j < lights.size(); j++)
+            {
+              const auto &staticCasters = lightShadowMapStates[j].staticCasters;
+              if (((shadowMasks[i] >> (j * 6)) & 0x3fu) != 0 && std::binary_search(staticCasters.begin(), staticCasters.end(), caster))
+              {
+                staticLightsMask |= 0x3fu << (j * 6);
+              }
+            }
+            casterStaticMasks[i] = shadowMasks[i] & clearedFacesMask & staticLightsMask;
+            casterUpdatedMasks[i] = shadowMasks[i] & updatedFacesMask & ~staticLightsMask;
+            casterLodLevels[i] = selectModelLod(*shadowCasters[i]->getObjectDetails(), getModelScreenSize(*shadowCasters[i], activeCamera, windowView.viewport.w), SHADOW_LOD_BIAS);
+          }
+        });
+        std::pmr::vector<std::shared_ptr<ModelBaseIntf>> staticShadowCasters(&frameArena), updatedShadowCasters(&frameArena);
+        std::pmr::vector<GLuint> staticShadowMasks(&frameArena), updatedShadowMasks(&frameArena);
+        std::pmr::vector<uint32_t> staticShadowLodLevels(&frameArena), updatedShadowLodLevels(&frameArena);
+        for (unsigned long i = 0; i < shadowCasters.size(); i++)
         {
-          continue;
+          if (casterStaticMasks[i] != 0)
+          {
+            staticShadowCasters.push_back(shadowCasters[i]);
+            staticShadowMasks.push_back(casterStaticMasks[i]);
+            staticShadowLodLevels.push_back(casterLodLevels[i]);
+          }
+          if (casterUpdatedMasks[i] != 0)
+          {
+            updatedShadowCasters.push_back(shadowCasters[i]);
+            updatedShadowMasks.push_back(casterUpdatedMasks[i]);
+            updatedShadowLodLevels.push_back(casterLodLevels[i]);
+          }
         }
-
-        // Get the view and projection matrices of the light.
-        const auto viewMatrices = light->getViewMatrices();
-        const auto projectionMatrices = light->getProjectionMatrices();
-
-        // Get the uniform ID of the count of the projection-view matrix variable and set it.
-        const auto vpMatrixCountVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].vpMatrixCount").c_str());
-        glUniform1i(vpMatrixCountVertexId, viewMatrices.size());
-        const auto vpMatrixCountGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].vpMatrixCount").c_str());
-        glUniform1i(vpMatrixCountGeometryId, viewMatrices.size());
-        const auto vpMatrixCountFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].vpMatrixCount").c_str());
-        glUniform1i(vpMatrixCountFragmentId, viewMatrices.size());
-
-        // Get the uniform ID of the light position variable and set it.
-        const auto lightPositionVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].lightPosition").c_str());
-        glUniform3f(lightPositionVertexId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-        const auto lightPositionGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].lightPosition").c_str());
-        glUniform3f(lightPositionGeometryId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-        const auto lightPositionFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].lightPosition").c_str());
-        glUniform3f(lightPositionFragmentId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-
-        // Get the uniform ID of the lights' shadow map layer ID variable and set it.
-        const auto layerIdVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].layerId").c_str());
-        glUniform1i(layerIdVertexId, lightDetails.textureArrayLayerId);
-        const auto layerIdGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].layerId").c_str());
-        glUniform1i(layerIdGeometryId, lightDetails.textureArrayLayerId);
-        const auto layerIdFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].layerId").c_str());
-        glUniform1i(layerIdFragmentId, lightDetails.textureArrayLayerId);
-
-        // Get the uniform ID of the near plane of the light variable and set it.
-        const auto nearPlaneVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_vertex[" + std::to_string(i) + "].nearPlane").c_str());
-        glUniform1f(nearPlaneVertexId, lightDetails.nearPlane);
-        const auto nearPlaneGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_geometry[" + std::to_string(i) + "].nearPlane").c_str());
-        glUniform1f(nearPlaneGeometryId, lightDetails.nearPlane);
-        const auto nearPlaneFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_fragment[" + std::to_string(i) + "].nearPlane").c_str());
-        glUniform1f(nearPlaneFragmentId, lightDetails.nearPlane);
-
-        // Get the uniform ID of the far plane of the light variable and set it.
-        const auto farPlaneVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_vertex[" + std::to_string(i) + "].farPlane").c_str());
-        glUniform1f(farPlaneVertexId, lightDetails.farPlane);
-        const auto farPlaneGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_geometry[" + std::to_string(i) + "].farPlane").c_str());
-        glUniform1f(farPlaneGeometryId, lightDetails.farPlane);
-        const auto farPlaneFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("projectionDetails_fragment[" + std::to_string(i) + "].farPlane").c_str());
-        glUniform1f(farPlaneFragmentId, lightDetails.farPlane);
-
-        // Iterate through the view matrices of the light.
-        for (unsigned long j = 0; j < viewMatrices.size(); j++)
+        groupModelInstances(staticShadowCasters, staticShadowMasks, staticShadowLodLevels, false, instanceMatrices, instanceShadowMasks, instanceTextureHandles, instanceSpins, staticShadowInstanceGroups[lightType]);
+        groupModelInstances(updatedShadowCasters, updatedShadowMasks, updatedShadowLodLevels, false, instanceMatrices, instanceShadowMasks, instanceTextureHandles, instanceSpins, shadowInstanceGroups[lightType]);
+        shadowCastersText += " " + std::to_string(updatedShadowCasters.size()) + "+" + std::to_string(staticShadowCasters.size()) + "/" + std::to_string(shadowCasters.size()) + (lightType == ShadowBufferType::CONE ? " (Cone)" : (lightType == ShadowBufferType::POINT ? " (Point)" : " (Directional)"));
+      }
+      // Keep the states of the current lights only, so removed lights don't linger.
+      shadowMapStates = newShadowMapStates;
+    }
+    else
+    {
+      // Shadows aren't rendered, so every shadow map needs rendering again once they're enabled.
+      shadowMapStates.clear();
+    }
+    cullShadowCastersZone.end();
+    textManager.addFormattedText(glm::vec2(1, 11.5f), 0.5f, shadowCastersText, " | Shadow Maps Updated: ", updatedShadowMapsCount, "/", shadowMapsCount, " (From Static Casters: ", restoredShadowMapsCount, ")");
+    ProfileZone uploadInstancesZone("Upload Instance Data");
+    std::pmr::vector<std::pmr::vector<ModelInstanceGroup>> viewsModelInstanceGroups(&frameArena);
+    viewsModelInstanceGroups.reserve(viewsVisibleModels.size());
+    std::pmr::vector<ImpostorInstanceRange> viewsImpostorInstanceRanges(&frameArena);
+    viewsImpostorInstanceRanges.reserve(viewsVisibleModels.size());
+    impostorBatch.beginFrame();
+    uint32_t modelLightsCount = 0, viewModelsCount = 0;
+    for (unsigned long i = 0; i < viewsVisibleModels.size(); i++)
+    {
+      const auto &viewVisibleModels = viewsVisibleModels[i];
+      viewsModelInstanceGroups.emplace_back();
+      // The models drawn in the views keep the masks of the lights reaching them where the shadow casters keep their shadow
+      //   map face masks, so the model shaders only light them with those lights.
+      const auto lightMasks = findModelLightMasks(viewVisibleModels, categorizedLights, modelLightsCount);
+      const auto impostorFirstInstance = impostorBatch.getInstancesCount();
+      const auto meshModels = addImpostorInstances(*views[i], viewVisibleModels, lightMasks, viewsLodLevels[i], viewsImpostorCoverages[i]);
+      viewsImpostorInstanceRanges.push_back({impostorFirstInstance, impostorBatch.getInstancesCount() - impostorFirstInstance});
+      groupModelInstances(meshModels.models, meshModels.lightMasks, meshModels.lodLevels, bindlessTexturesEnabled, instanceMatrices, instanceShadowMasks, instanceTextureHandles, instanceSpins, viewsModelInstanceGroups.back());
+      viewModelsCount += viewVisibleModels.size();
+      // The projectiles are left out of the shadow maps, since they're too small to cast a shadow worth the draws.
+      groupProjectileInstances(cameraManager.getCamera(views[i]->cameraHandle)->getFrustum(), views[i]->layerMask, bindlessTexturesEnabled, instanceMatrices, instanceShadowMasks, instanceTextureHandles, instanceSpins, viewsModelInstanceGroups.back());
+    }
+    uploadInstanceData(instanceMatrices, instanceShadowMasks, instanceTextureHandles, instanceSpins);
+    impostorBatch.uploadInstanceData(getPassStats());
+    uploadInstancesZone.end();
+    textManager.addFormattedText(glm::vec2(1, 16), 0.5f, "Shadowed Lights Per Model: ", viewModelsCount > 0 ? float_t(modelLightsCount) / viewModelsCount : 0.0f,
+                                 " | Shadowed Lights: ", categorizedLights[ShadowBufferType::CONE].size() + categorizedLights[ShadowBufferType::POINT].size() +
+                                                                     categorizedLights[ShadowBufferType::DIRECTIONAL].size(),
+                                 " | Impostors: ", impostorBatch.getDrawnImpostorsCount(), " (Captured Objects: ", impostorBatch.getCapturedObjectsCount(), ")");
+
+    // Declare the passes of the frame in the render graph, which binds and clears the framebuffers they draw to. The shadow
+    //   atlases, the framebuffers of the views and the window outlive the frame, while the targets the window view is
+    //   rendered to with dynamic resolution or anti-aliasing are transient, placed in the pool of the graph.
+    renderGraph.begin();
+    const auto coneShadowsResource = renderGraph.importFramebuffer("Cone Shadow Maps", shadowBufferManager.getConeLightShadowBufferId());
+    const auto pointShadowsResource = renderGraph.importFramebuffer("Point Shadow Maps", shadowBufferManager.getPointLightShadowBufferId());
+    const auto directionalShadowsResource = renderGraph.importFramebuffer("Directional Shadow Maps", shadowBufferManager.getDirectionalLightShadowBufferId());
+    const auto windowResource = renderGraph.importFramebuffer("Window", 0);
+    const auto sceneTargetResource = upscaleEnabled ? renderGraph.createRenderTarget("Scene Target", {VIEWPORT_WIDTH, VIEWPORT_HEIGHT, GL_RGBA8, GL_DEPTH_COMPONENT24, 0, GL_LINEAR})
+                                                    : windowResource;
+    // The multisampled target has the formats of the scene render target, so its samples can be resolved into it.
+    const auto multisampleTargetResource = multisampleEnabled ? renderGraph.createRenderTarget("Multisample Target", {VIEWPORT_WIDTH, VIEWPORT_HEIGHT, GL_RGBA8, GL_DEPTH_COMPONENT24, antiAliasingModeSamples.at(antiAliasingMode), GL_LINEAR})
+                                                              : sceneTargetResource;
+    // Views sharing a framebuffer draw to the same resource, so they're drawn in the order they were declared.
+    std::pmr::map<GLuint, uint32_t> framebufferResources({{0, windowResource}}, &frameArena);
+    std::pmr::vector<uint32_t> viewResources(&frameArena);
+    for (unsigned long i = 0; i < views.size(); i++)
+    {
+      if (i == windowViewIndex)
+      {
+        viewResources.push_back(multisampleTargetResource);
+        continue;
+      }
+      if (framebufferResources.count(views[i]->framebufferId) == 0)
+      {
+        framebufferResources[views[i]->framebufferId] = renderGraph.importFramebuffer("Camera View", views[i]->framebufferId);
+      }
+      viewResources.push_back(framebufferResources.at(views[i]->framebufferId));
+    }
+    const RenderGraphClear noClear = {0, glm::vec4(0.0f), glm::ivec4(0)};
+
+    // Render the light shadowmaps. The shadow maps are already cleared, and those not being rendered again keep their
+    //   contents from earlier frames.
+    auto categorizedLightDetails = createShadowBufferTypeLists<LightDetails>();
+    std::optional<ProfileZone> modelRenderZone;
+    renderGraph.addPass("Shadows", {}, {coneShadowsResource, pointShadowsResource, directionalShadowsResource}, noClear, [&]() {
+      ProfileZone lightRenderZone("Light Render");
+      renderLights(categorizedLights, staticShadowInstanceGroups, storedStaticFaces, shadowInstanceGroups, categorizedLightDetails);
+      textManager.addFormattedText(glm::vec2(1, 25.5f), 0.5f, "Light Render: ", lightRenderZone.end(), "ms | GPU (Cone): ", shadowRenderGpuTimers[ShadowBufferType::CONE].getElapsedTime(), "ms | GPU (Point): ", shadowRenderGpuTimers[ShadowBufferType::POINT].getElapsedTime(),
+                                   "ms | GPU (Directional): ", shadowRenderGpuTimers[ShadowBufferType::DIRECTIONAL].getElapsedTime(), "ms");
+      // The model render starts right after the shadows.
+      modelRenderZone.emplace("Model Render");
+      modelRenderGpuTimer.begin();
+    });
+
+    // Render the models to each view with the shadow maps of the frame, measuring the time the GPU takes as well, since the
+    //   draw calls only queue the work. Each view has its own camera matrices and light clusters, and clears only its own
+    //   viewport, since views can share a framebuffer. The GPU timers can't be nested, so the views up to the window view,
+    //   the anti-aliasing of the window view, and the views drawn over the window are each measured on their own.
+    for (unsigned long i = 0; i < views.size(); i++)
+    {
+      // The window view and the views drawn over it can show the views rendered to other framebuffers.
+      std::vector<uint32_t> viewReads({coneShadowsResource, pointShadowsResource, directionalShadowsResource});
+      for (unsigned long j = 0; i >= windowViewIndex && j < windowViewIndex; j++)
+      {
+        viewReads.push_back(viewResources[j]);
+      }
+      renderGraph.addPass(i == windowViewIndex ? "Window View" : "Camera View", viewReads, {viewResources[i]}, {GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), views[i]->viewport}, [&, i]() {
+        if (i == windowViewIndex)
         {
-          // Calculate the projection-view matrix.
-          const auto vpMatrix = projectionMatrices[j] * viewMatrices[j];
-          // Get the uniform ID of the projection-view matrix of the light variable and set it.
-          const auto vpMatrixVertexId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_vertex[" + std::to_string(i) + "].vpMatrices[" + std::to_string(j) + "]").c_str());
-          glUniformMatrix4fv(vpMatrixVertexId, 1, GL_FALSE, &vpMatrix[0][0]);
-          const auto vpMatrixGeometryId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_geometry[" + std::to_string(i) + "].vpMatrices[" + std::to_string(j) + "]").c_str());
-          glUniformMatrix4fv(vpMatrixGeometryId, 1, GL_FALSE, &vpMatrix[0][0]);
-          const auto vpMatrixFragmentId = glGetUniformLocation(light->getShaderDetails()->getShaderId(), ("lightDetails_fragment[" + std::to_string(i) + "].vpMatrices[" + std::to_string(j) + "]").c_str());
-          glUniformMatrix4fv(vpMatrixFragmentId, 1, GL_FALSE, &vpMatrix[0][0]);
+          windowView.framebufferId = renderGraph.getFramebufferId(viewResources[i]);
         }
+        currentRenderPass = RenderPass::SETUP;
+        updateCameraUniformBlock(views[i]->cameraHandle);
+        updateLightClusters(clusteredLights, *views[i], i == windowViewIndex);
+        renderModels(*views[i], i == windowViewIndex, categorizedLightDetails, viewsModelInstanceGroups[i], viewsImpostorInstanceRanges[i]);
+      });
+      if (i != windowViewIndex)
+      {
+        continue;
       }
 
-      // Get the uniform ID of the lights count variable and set it.
-      const auto lightsCountVertexId = glGetUniformLocation(firstLight->getShaderDetails()->getShaderId(), "lightsCount");
-      glUniform1i(lightsCountVertexId, lights.second.size());
-
-      // Iterate through the models in the scene.
-      for (const auto &model : modelManager.getAllModels())
+      // Test the models of the window view against its depth, for culling the hidden ones in the next frame, which is only
+      //   read on the CPU.
+      if (occlusionCullingEnabled)
       {
-        // Get the model matrix of the model.
-        const auto modelMatrix = model->getModelMatrix();
-        // Get the uniform ID of the model matrix variable and set it.
-        const auto modelMatrixId = glGetUniformLocation(firstLight->getShaderDetails()->getShaderId(), "modelMatrix");
-        glUniformMatrix4fv(modelMatrixId, 1, GL_FALSE, &modelMatrix[0][0]);
-
-        // Define a vertex attribute array that contains the vertex position data of the model.
-        VertexAttributeArray vertexArray("VertexArray", model->getObjectDetails()->getVertexBufferId(), 3);
-
-        // Enable it so that it can be used by the GPU.
-        vertexArray.enableAttribute();
-
-        // Draw the triangles of the model.
-        glDrawArrays(GL_TRIANGLES, 0, model->getObjectDetails()->getBufferSize());
+        renderGraph.addPass("Occlusion Queries", {}, {multisampleTargetResource}, noClear, [&]() {
+          testOcclusion(windowView, occlusionTestedModels, activeCameraPosition);
+        }, true);
       }
 
-      // Bind the window framebuffer as the active framebuffer.
-      glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-      const auto endTime = glfwGetTime();
-
-      lightNamesProcessTime[firstLight->getLightName()] += (endTime - startTime) * 1000;
+      // Resolve the samples of the window view, and upscale it to the window, smoothing its edges with FXAA if enabled.
+      // Without either, the window view was rendered to the window, which the pass only measures for the timers.
+      const std::vector<uint32_t> antiAliasingWrites = multisampleEnabled ? std::vector<uint32_t>({sceneTargetResource, windowResource}) : std::vector<uint32_t>({windowResource});
+      renderGraph.addPass("Anti-Aliasing", {multisampleTargetResource, sceneTargetResource}, antiAliasingWrites, noClear, [&]() {
+        modelRenderGpuTimer.end();
+        ProfileZone antiAliasingZone("Anti-Aliasing");
+        antiAliasingGpuTimer.begin();
+        if (multisampleEnabled)
+        {
+          renderGraph.getRenderTarget(multisampleTargetResource).resolve(renderGraph.getFramebufferId(sceneTargetResource), glm::ivec2(windowView.viewport.z, windowView.viewport.w));
+        }
+        if (upscaleEnabled)
+        {
+          renderGraph.bindFramebuffer(0);
+          upscaleScene(windowView, renderGraph.getRenderTarget(sceneTargetResource), fxaaEnabled);
+        }
+        antiAliasingGpuTimer.end();
+        antiAliasingZone.end();
+        textManager.addFormattedText(glm::vec2(1, 14), 0.5f, "Anti-Aliasing (N): ", antiAliasingModeNames.at(antiAliasingMode), multisampleEnabled && renderGraph.getRenderTarget(multisampleTargetResource).getSamplesCount() != antiAliasingModeSamples.at(antiAliasingMode) ? " (Unsupported)" : "", " | GPU: ", antiAliasingGpuTimer.getElapsedTime(), "ms");
+        // The views drawn over the window are measured from here on.
+        overlayViewsGpuTimer.begin();
+      });
     }
 
-    auto height = 21.5f;
-    for (const auto &lightCounts : lightNamesCount)
+    renderGraph.execute();
+    // Leave the matrices of the active camera for whatever is drawn over the window afterwards.
+    if (windowViewIndex != views.size() - 1)
     {
-      const auto avgRenderTime = lightNamesProcessTime[lightCounts.first] / lightCounts.second;
-      textManager.addText(lightCounts.first + " Light Render Instances: " + std::to_string(lightCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms", glm::vec2(1, height), 0.5f);
-      height -= 0.5f;
+      currentRenderPass = RenderPass::SETUP;
+      updateCameraUniformBlock(activeCameraHandle);
     }
-
-    // Return the map of the categorized lights.
-    return categorizedLightDetails;
+    overlayViewsGpuTimer.end();
+    // The framebuffers of the passes were bound by the render graph.
+    renderStats[static_cast<uint32_t>(RenderPass::SETUP)].stateChanges += renderGraph.getFramebufferBindsCount();
+    // Fence the instance data of the frame now that everything drawing with it was queued.
+    instanceStreamingBuffer.endFrame();
+    indirectDrawBatch.endFrame();
+    impostorBatch.endFrame();
+    textManager.addFormattedText(glm::vec2(1, 25), 0.5f, "Model Render: ", modelRenderZone->end(), "ms | GPU: ", modelRenderGpuTimer.getElapsedTime(), "ms | Shadow Quality (K): ", shadowQualityNames.at(shadowQuality), " | Depth Pre-pass (L): ", (depthPrePassEnabled ? "On" : "Off"), " | Shading (G): ", (deferredShadingEnabled ? "Deferred" : "Forward"), " | Bindless Textures (U): ", (bindlessTexturesEnabled ? "On" : (GLEW_ARB_bindless_texture ? "Off" : "Unsupported")));
+    textManager.addFormattedText(glm::vec2(1, 15.5f), 0.5f, "Render Graph Passes: ", renderGraph.getPassesCount() - renderGraph.getCulledPassesCount(), "/", renderGraph.getPassesCount(), " | Transient Targets: ", renderGraph.getTransientTargetsCount(),
+                                 " (Aliased: ", renderGraph.getAliasedTargetsCount(), ") | Framebuffer Binds: ", renderGraph.getFramebufferBindsCount(), " (Skipped: ", renderGraph.getSkippedFramebufferBindsCount(), ") | Clears: ", renderGraph.getClearsCount(), " (Skipped: ", renderGraph.getSkippedClearsCount(), ") | GL State Calls: ",
+                                 GlStateCache::getInstance().getIssuedCallsCount(), " (Skipped: ", GlStateCache::getInstance().getSkippedCallsCount(), ")");
+
+    // Show the work of the whole frame, along with the draw calls of each pass.
+    const auto totalStats = sumRenderStats(renderStats);
+    std::string passDrawCallsText = "";
+    for (uint32_t i = 0; i < RENDER_PASSES_COUNT; i++)
+    {
+      passDrawCallsText += (i == 0 ? "" : "/") + std::to_string(renderStats[i].drawCalls);
+    }
+    textManager.addFormattedText(glm::vec2(1, 14.5f), 0.5f, "Draw Calls: ", totalStats.drawCalls, " (Setup/Shadows/Depth/Models/Lighting/Upscale/Particles/Occlusion: ", passDrawCallsText, ") | Instances: ", totalStats.instances, " | Triangles: ", totalStats.triangles, " | Uniforms: ", totalStats.uniformCalls, " | Uploaded: ", totalStats.uploadedBytes / 1024, "KB | State Changes: ", totalStats.stateChanges);
   }
 
   /**
-   * Render the shadow maps for all the models in the scene.
-   * 
-   * @param categorizedLights  The categorized map of lights in the scene.
+   * Compile and draw the shader variants the frames can pick for the registered models and the projectiles, for every
+   * number of lights with shadow maps there can be, into 1x1 targets behind the loading screen. Drivers finish compiling
+   * programs and patching them for the state they're drawn with at their first draw, which would otherwise hitch the
+   * first frame a shot light or a toggled light changes the number of lights. Only the variants of the current features,
+   * shadow quality tier and shading are drawn, since changing those is already a hitch of its own.
    */
-  void renderModels(const std::map<const ShadowBufferType, std::vector<LightDetails>> &categorizedLights) const
+  void prewarmShaders()
   {
-    // Switch the viewport to the size of the window viewport.
-    windowManager.switchToWindowViewport();
-    // Set the clear screen color to pure white.
-    windowManager.setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
-
-    // Clear the color buffer and depth buffer of the screen.
-    windowManager.clearScreen(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    // Set the current active shader ID to 0.
-    GLuint currentShaderId = 0;
-    // Get the active camera to use to render the video.
-    const auto activeCamera = cameraManager.getCamera(activeCameraId);
-    // Get the view matrix of the camera.
-    const auto viewMatrix = activeCamera->getViewMatrix();
-    // Get the projection matrix of the camera.
-    const auto projectionMatrix = activeCamera->getProjectionMatrix();
-
-    auto modelNamesCount = std::map<const std::string, int>({});
-    auto modelNamesProcessTime = std::map<const std::string, double>({});
-    auto modelNamesPolygonCount = std::map<const std::string, long>({});
-    auto totalPolygons = 0l;
-
-    // Iterate through all the models in the scene.
-    for (const auto &model : modelManager.getAllModels())
+    GpuDebugGroup prewarmGroup("Prewarm Shaders");
+    // Draw each combination of object, texture and shader once.
+    std::pmr::vector<std::shared_ptr<ModelBaseIntf>> prewarmModels(&frameArena);
+    std::pmr::set<std::tuple<const ObjectDetails *, const TextureDetails *, const ShaderDetails *>> prewarmedModels(&frameArena);
+    auto models = modelManager.getAllModels();
+    if (projectileManager.getProjectileModel() != nullptr)
     {
-      // Check if the shader of the light is the same as the currently used shader.
-      if (currentShaderId != model->getShaderDetails()->getShaderId())
+      models.push_back(projectileManager.getProjectileModel());
+    }
+    for (const auto &model : models)
+    {
+      if (prewarmedModels.insert(std::make_tuple(model->getObjectDetails().get(), model->getTextureDetails().get(), model->getShaderDetails().get())).second)
       {
-        // If not, set it as the currently used shader and use it.
-        currentShaderId = model->getShaderDetails()->getShaderId();
-        glUseProgram(currentShaderId);
+        prewarmModels.push_back(model);
       }
+    }
+    if (prewarmModels.empty())
+    {
+      return;
+    }
 
-      if (modelNamesCount.find(model->getModelName()) != modelNamesCount.end())
-      {
-        modelNamesCount[model->getModelName()]++;
-      }
-      else
+    // Draw the models unlit at their finest level of detail, with their instance data streamed the way a frame does.
+    std::pmr::vector<glm::mat4> instanceMatrices(&frameArena);
+    std::pmr::vector<GLuint> instanceLightMasks(&frameArena);
+    std::pmr::vector<GLuint64> instanceTextureHandles(&frameArena);
+    std::pmr::vector<glm::vec2> instanceSpins(&frameArena);
+    std::pmr::vector<ModelInstanceGroup> modelInstanceGroups(&frameArena);
+    groupModelInstances(prewarmModels, std::pmr::vector<GLuint>(prewarmModels.size(), 0, &frameArena), std::pmr::vector<uint32_t>(prewarmModels.size(), 0, &frameArena), bindlessTexturesEnabled,
+                        instanceMatrices, instanceLightMasks, instanceTextureHandles, instanceSpins, modelInstanceGroups);
+    uploadInstanceData(instanceMatrices, instanceLightMasks, instanceTextureHandles, instanceSpins);
+    const auto drawModels = [&](const std::function<std::shared_ptr<const ShaderDetails>(ModelBaseIntf &)> &getShader) {
+      for (const auto &modelInstanceGroup : modelInstanceGroups)
       {
-        modelNamesCount[model->getModelName()] = 1;
-        modelNamesProcessTime[model->getModelName()] = 0.0f;
+        auto &model = *modelInstanceGroup.firstModel;
+        const auto &objectDetails = *model.getObjectDetails();
+        const auto &lod = objectDetails.getLod(0);
+        GlStateCache::getInstance().useProgram(getShader(model)->getShaderId());
+        GlStateCache::getInstance().bindVertexArray(objectDetails.getVertexArrayId());
+        VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase + modelInstanceGroup.firstInstance);
+        VertexArray::attachInstanceIntegerAttribute(INSTANCE_LIGHT_MASK_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceShadowMaskBase + modelInstanceGroup.firstInstance);
+        VertexArray::attachInstanceVectorAttribute(INSTANCE_SPIN_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), 2, instanceSpinBase + modelInstanceGroup.firstInstance);
+        if (bindlessTexturesEnabled)
+        {
+          VertexArray::attachInstanceTextureHandleAttribute(INSTANCE_TEXTURE_HANDLE_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceTextureHandleBase + modelInstanceGroup.firstInstance);
+        }
+        else
+        {
+          GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+          GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, model.getTextureDetails()->getTextureId());
+        }
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * lod.firstIndex), modelInstanceGroup.instanceCount, objectDetails.getBaseVertex());
       }
+    };
 
-      const auto startTime = glfwGetTime();
-
-      // Get the model matrix of the model.
-      const auto modelMatrix = model->getModelMatrix();
-      // Get the uniform ID of the model matrix variable and set it.
-      const auto modelMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_vertex.modelMatrix");
-      glUniformMatrix4fv(modelMatrixVertexId, 1, GL_FALSE, &modelMatrix[0][0]);
-      const auto modelMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_fragment.modelMatrix");
-      glUniformMatrix4fv(modelMatrixFragmentId, 1, GL_FALSE, &modelMatrix[0][0]);
-
-      // Get the uniform ID of the diffuse texture of the model variable and set it.
-      const auto diffuseTextureId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "diffuseTexture");
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture(GL_TEXTURE_2D, model->getTextureDetails()->getTextureId());
-      glUniform1i(diffuseTextureId, 0);
-
-      // Get the uniform ID of the view matrix of the camera variable and set it.
-      const auto viewMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_vertex.viewMatrix");
-      glUniformMatrix4fv(viewMatrixVertexId, 1, GL_FALSE, &viewMatrix[0][0]);
-      const auto viewMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_fragment.viewMatrix");
-      glUniformMatrix4fv(viewMatrixFragmentId, 1, GL_FALSE, &viewMatrix[0][0]);
-
-      // Get the uniform ID of the projection matrix of the camera variable and set it.
-      const auto projectionMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_vertex.projectionMatrix");
-      glUniformMatrix4fv(projectionMatrixVertexId, 1, GL_FALSE, &projectionMatrix[0][0]);
-      const auto projectionMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "modelDetails_fragment.projectionMatrix");
-      glUniformMatrix4fv(projectionMatrixFragmentId, 1, GL_FALSE, &projectionMatrix[0][0]);
-
-      // Get the uniform ID of the disable feature mask variable and set it.
-      const auto disableFeatureMaskId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "disableFeatureMask");
-      glUniform1i(disableFeatureMaskId, disableFeatureMask);
-
-      // Get the uniform ID of the ambient lighting factor variable and set it.
-      const auto ambientFactorId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "ambientFactor");
-      glUniform1f(ambientFactorId, ambientFactor);
-      // Get the uniform ID of the cone lights count in the scene and set it.
-      const auto coneLightsCountId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "coneLightsCount");
-      glUniform1i(coneLightsCountId, categorizedLights.at(ShadowBufferType::CONE).size());
-      // Get the uniform ID of the point lights count in the scene and set it.
-      const auto pointLightsCountId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "pointLightsCount");
-      glUniform1i(pointLightsCountId, categorizedLights.at(ShadowBufferType::POINT).size());
-
-      // If lighting is not disabled, then setup the lighting information.
-      if (disableFeatureMask < DISABLE_LIGHT)
-      {
-        // Iterate through the cone lights in the scene.
-        for (unsigned long i = 0; i < categorizedLights.at(ShadowBufferType::CONE).size(); i++)
+    // Ask for every variant before drawing any of them, so the drivers compiling in parallel work on all of them at once
+    //   and the draws only wait for the ones not done yet.
+    const auto hasImpostors = std::any_of(prewarmModels.begin(), prewarmModels.end(), [](const std::shared_ptr<ModelBaseIntf> &model) { return model->hasImpostor(); });
+    for (int32_t coneLightsCount = 0; coneLightsCount <= MAX_CONE_LIGHTS; coneLightsCount++)
+    {
+      for (int32_t pointLightsCount = 0; pointLightsCount <= MAX_POINT_LIGHTS; pointLightsCount++)
+      {
+        for (int32_t directionalLightsCount = 0; directionalLightsCount <= MAX_DIRECTIONAL_LIGHTS; directionalLightsCount++)
         {
-          // Get the details of the cone light.
-          const auto lightDetails = categorizedLights.at(ShadowBufferType::CONE)[i];
-
-          // Get the uniform ID of the light position variable and set it.
-          const auto lightPositionVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionVertexId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-          const auto lightPositionFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionFragmentId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-
-          // Get the uniform ID of the count of the projection-view matrix variable and set it.
-          const auto lightVpMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixVertexId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-          const auto lightVpMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixFragmentId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-
-          // Get the uniform ID of the light color-intensity variable and set it.
-          const auto lightColorIntensityVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityVertexId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-          const auto lightColorIntensityFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityFragmentId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-
-          // Get the uniform ID of the near plane of the light variable and set it.
-          const auto lightNearPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneVertexId, lightDetails.nearPlane);
-          const auto lightNearPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneFragmentId, lightDetails.nearPlane);
-
-          // Get the uniform ID of the far plane of the light variable and set it.
-          const auto lightFarPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneVertexId, lightDetails.farPlane);
-          const auto lightFarPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneFragmentId, lightDetails.farPlane);
-
-          // Get the uniform ID of the lights' shadow map layer ID variable and set it.
-          const auto lightLayerIdVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_vertex[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdVertexId, lightDetails.textureArrayLayerId);
-          const auto lightLayerIdFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("coneLightDetails_fragment[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdFragmentId, lightDetails.textureArrayLayerId);
+          const auto modelShaderDefines = getModelShaderDefines(coneLightsCount, pointLightsCount, directionalLightsCount);
+          for (const auto &model : prewarmModels)
+          {
+            shaderManager.getShaderVariant(model->getShaderDetails(), getGeometryShaderDefines(false, modelShaderDefines));
+          }
+          if (hasImpostors)
+          {
+            shaderManager.getShaderVariant(deferredLightingShader, modelShaderDefines + "#define IMPOSTOR\n");
+          }
+          if (deferredShadingEnabled)
+          {
+            shaderManager.getShaderVariant(deferredLightingShader, "#define DEFERRED_LIGHTING\n" + modelShaderDefines);
+          }
         }
+      }
+    }
+    if (deferredShadingEnabled)
+    {
+      for (const auto &model : prewarmModels)
+      {
+        shaderManager.getShaderVariant(model->getShaderDetails(), getGeometryShaderDefines(true, ""));
+      }
+      if (hasImpostors)
+      {
+        shaderManager.getShaderVariant(deferredLightingShader, "#define DEFERRED_GBUFFER\n#define IMPOSTOR\n");
+      }
+    }
 
-        // Iterate through the point lights in the scene.
-        for (unsigned long i = 0; i < categorizedLights.at(ShadowBufferType::POINT).size(); i++)
+    // The views besides the window are always shaded forward, and the window is too unless it's shaded deferred, so the
+    // forward variants are drawn for every number of lights, along with the lighting pass variants when shading deferred.
+    const RenderTarget prewarmTarget({1, 1, GL_RGBA8, GL_DEPTH_COMPONENT24, 0, GL_NEAREST});
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, prewarmTarget.getFramebufferId());
+    GlStateCache::getInstance().setViewport(0, 0, 1, 1);
+    if (depthPrePassEnabled)
+    {
+      drawModels([this](ModelBaseIntf &) { return depthPrePassShader; });
+    }
+    uint32_t prewarmedVariantsCount = 0;
+    for (int32_t coneLightsCount = 0; coneLightsCount <= MAX_CONE_LIGHTS; coneLightsCount++)
+    {
+      for (int32_t pointLightsCount = 0; pointLightsCount <= MAX_POINT_LIGHTS; pointLightsCount++)
+      {
+        for (int32_t directionalLightsCount = 0; directionalLightsCount <= MAX_DIRECTIONAL_LIGHTS; directionalLightsCount++)
         {
-          // Get the details of the point light.
-          const auto lightDetails = categorizedLights.at(ShadowBufferType::POINT)[i];
-
-          // Get the uniform ID of the light position variable and set it.
-          const auto lightPositionVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionVertexId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-          const auto lightPositionFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].lightPosition").c_str());
-          glUniform3f(lightPositionFragmentId, lightDetails.lightPosition.x, lightDetails.lightPosition.y, lightDetails.lightPosition.z);
-
-          // Get the uniform ID of the count of the projection-view matrix variable and set it.
-          const auto lightVpMatrixVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixVertexId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-          const auto lightVpMatrixFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].lightVpMatrix").c_str());
-          glUniformMatrix4fv(lightVpMatrixFragmentId, 1, GL_FALSE, &lightDetails.lightVpMatrix[0][0]);
-
-          // Get the uniform ID of the light color-intensity variable and set it.
-          const auto lightColorIntensityVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityVertexId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-          const auto lightColorIntensityFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].lightColorIntensity").c_str());
-          glUniform3f(lightColorIntensityFragmentId, lightDetails.lightColor.r * lightDetails.lightIntensity, lightDetails.lightColor.g * lightDetails.lightIntensity, lightDetails.lightColor.b * lightDetails.lightIntensity);
-
-          // Get the uniform ID of the near plane of the light variable and set it.
-          const auto lightNearPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneVertexId, lightDetails.nearPlane);
-          const auto lightNearPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].nearPlane").c_str());
-          glUniform1f(lightNearPlaneFragmentId, lightDetails.nearPlane);
-
-          // Get the uniform ID of the far plane of the light variable and set it.
-          const auto lightFarPlaneVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneVertexId, lightDetails.farPlane);
-          const auto lightFarPlaneFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].farPlane").c_str());
-          glUniform1f(lightFarPlaneFragmentId, lightDetails.farPlane);
-
-          // Get the uniform ID of the lights' shadow map layer ID variable and set it.
-          const auto lightLayerIdVertexId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_vertex[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdVertexId, lightDetails.textureArrayLayerId / 6);
-          const auto lightLayerIdFragmentId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), ("pointLightDetails_fragment[" + std::to_string(i) + "].layerId").c_str());
-          glUniform1i(lightLayerIdFragmentId, lightDetails.textureArrayLayerId / 6);
+          const auto modelShaderDefines = getModelShaderDefines(coneLightsCount, pointLightsCount, directionalLightsCount);
+          const auto forwardShaderDefines = getGeometryShaderDefines(false, modelShaderDefines);
+          drawModels([&](ModelBaseIntf &model) { return shaderManager.getShaderVariant(model.getShaderDetails(), forwardShaderDefines); });
+          // The impostors are only compiled, which they were when asked for, since they're drawn with the quad of the
+          //   impostor batch.
+          if (deferredShadingEnabled)
+          {
+            const auto &lightingShader = shaderManager.getShaderVariant(deferredLightingShader, "#define DEFERRED_LIGHTING\n" + modelShaderDefines);
+            GlStateCache::getInstance().useProgram(lightingShader->getShaderId());
+            GlStateCache::getInstance().bindVertexArray(fullScreenVertexArrayId);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+          }
+          prewarmedVariantsCount++;
         }
       }
-
-      // Get the uniform ID of the cone light shadow map texture array and set it.
-      const auto coneLightTextureId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "coneLightTextures");
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D_ARRAY, shadowBufferManager.getConeLightTextureArrayId());
-      glUniform1i(coneLightTextureId, 1);
-
-      // Get the uniform ID of the point light shadow map texture array and set it.
-      const auto pointLightTextureId = glGetUniformLocation(model->getShaderDetails()->getShaderId(), "pointLightTextures");
-      glActiveTexture(GL_TEXTURE2);
-      glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadowBufferManager.getPointLightTextureArrayId());
-      glUniform1i(pointLightTextureId, 2);
-
-      // Define vertex attribute arrays that contains the vertex position, UV coordinates, and normal vector data of the model.
-      VertexAttributeArray vertexArray("VertexArray", model->getObjectDetails()->getVertexBufferId(), 3);
-      VertexAttributeArray uvArray("UvArray", model->getObjectDetails()->getUvBufferId(), 2);
-      VertexAttributeArray normalArray("NormalArray", model->getObjectDetails()->getNormalBufferId(), 3);
-
-      // Enable them so that it can be used by the GPU.
-      vertexArray.enableAttribute();
-      uvArray.enableAttribute();
-      normalArray.enableAttribute();
-
-      // Draw the triangles of the model.
-      glDrawArrays(GL_TRIANGLES, 0, model->getObjectDetails()->getBufferSize());
-      const auto endTime = glfwGetTime();
-
-      modelNamesProcessTime[model->getModelName()] += (endTime - startTime) * 1000;
-      modelNamesPolygonCount[model->getModelName()] = model->getObjectDetails()->getBufferSize() / 3;
-      totalPolygons += model->getObjectDetails()->getBufferSize() / 3;
     }
 
-    auto height = 23.0f;
-    for (const auto &modelCounts : modelNamesCount)
+    // The surfaces recorded into the geometry buffer don't depend on the lights, so they're drawn once.
+    if (deferredShadingEnabled)
     {
-      const auto avgRenderTime = modelNamesProcessTime[modelCounts.first] / modelCounts.second;
-      textManager.addText(modelCounts.first + " Model Render Instances: " + std::to_string(modelCounts.second) + " | Render (avg): " + std::to_string(avgRenderTime) + "ms | Polygon Count: " + std::to_string(modelNamesPolygonCount[modelCounts.first]), glm::vec2(1, height), 0.5f);
-      height -= 0.5f;
+      const GeometryBuffer prewarmGeometryBuffer(1, 1);
+      GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, prewarmGeometryBuffer.getFramebufferId());
+      const auto geometryShaderDefines = getGeometryShaderDefines(true, "");
+      drawModels([&](ModelBaseIntf &model) { return shaderManager.getShaderVariant(model.getShaderDetails(), geometryShaderDefines); });
     }
-    textManager.addText("Total Polygons: " + std::to_string(totalPolygons), glm::vec2(1, 12.5f), 0.5f);
+    // The impostor variants were never used, so they're waited for here instead.
+    shaderManager.finishPendingPrograms();
+
+    // Wait for the drivers to finish the programs, so none of it is left for the first frame.
+    glFinish();
+    GlStateCache::getInstance().bindVertexArray(0);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GlStateCache::getInstance().setViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    Logger::getInstance().info("Prewarmed the shaders of ", modelInstanceGroups.size(), " models for ", prewarmedVariantsCount, " light counts");
   }
 
   /**
-   * Render the scene with the light shadowmaps and the models.
+   * Render the scene to the window as sprites only, for the menus whose models are all drawn with the unlit shaders
+   *   through an orthographic camera. None of the lights, shadows, views or anti-aliasing of the full render are used,
+   *   and the models not drawn with the unlit shaders are left out. The menu scenes don't move any lights either, so
+   *   there is no lighting to bake for them, and the shadow maps are left untouched until the game scene renders.
+   * 
+   * @param frameTime  The time of the frame.
    */
-  void render()
+  void renderSprites(const FrameTime &frameTime)
   {
-    // Get the time at the start of the frame.
-    const auto currentTime = glfwGetTime();
-    auto updateStartTime = currentTime, updateEndTime = currentTime;
-
-    // Check if the "L" has been pressed 500ms after the last time the disable feature mask was changed.
-    if (controlManager.isKeyPressed(GLFW_KEY_L) && (currentTime - lastDisableFeatureMaskChange) > 0.5f)
+    renderStats = {};
+    currentRenderPass = RenderPass::SETUP;
+    GlStateCache::getInstance().resetCounts();
+    spinTime = float_t(frameTime.now);
+
+    // Cull the sprites outside the view of the active camera.
+    ProfileZone cullModelsZone("Cull Models");
+    const auto &activeCamera = *cameraManager.getCamera(activeCameraHandle);
+    const auto &allModels = modelManager.getAllModels();
+    auto sprites = cullModels(allModels, activeCamera.getFrustum(), ~0u);
+    sprites.erase(std::remove_if(sprites.begin(), sprites.end(), [](const std::shared_ptr<ModelBaseIntf> &model) { return !SpriteBatch::isSprite(*model); }), sprites.end());
+    cullModelsZone.end();
+
+    // Stream in the mip levels of the textures the sprites need for how big they are on the screen.
+    ProfileZone streamTexturesZone("Stream Textures");
+    for (const auto &sprite : sprites)
     {
-      // "L" was pressed, meaning we need to start disabling render features.
-      // Check which features have already been disabled.
-      switch (disableFeatureMask)
-      {
-      case 0:
-        // No features were disabled. Start disabling shadows.
-        disableFeatureMask = DISABLE_SHADOW;
-        break;
-      case 1:
-        // Shadows were disabled. Start disabling lighting.
-        disableFeatureMask = DISABLE_LIGHT;
-        break;
-      case 2:
-      default:
-        // All features were disabled. Enable everything.
-        disableFeatureMask = 0;
-      }
-      // Update the timestamp for when the disable feature mask was changed
-      lastDisableFeatureMaskChange = currentTime;
+      textureManager.requestTextureSize(*sprite->getTextureDetails(), getModelScreenSize(*sprite, activeCamera, VIEWPORT_HEIGHT));
+    }
+    textureManager.processTextureStreaming();
+    streamTexturesZone.end();
+
+    // Draw the sprites straight to the window.
+    updateCameraUniformBlock(activeCameraHandle);
+    currentRenderPass = RenderPass::MODELS;
+    ProfileZone spriteRenderZone("Sprite Render");
+    modelRenderGpuTimer.begin();
+    {
+      GpuDebugGroup spritesGroup("Sprites");
+      GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+      GlStateCache::getInstance().setViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+      windowManager.setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+      windowManager.clearScreen(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      spriteBatch.draw(sprites, activeCamera.getViewProjectionMatrix(), spinTime, multiDrawIndirectEnabled, getPassStats());
     }
+    modelRenderGpuTimer.end();
+    spriteBatch.endFrame();
 
-    // Render the light shadowmaps.
-    updateStartTime = glfwGetTime();
-    const auto categorizedLights = renderLights();
-    updateEndTime = glfwGetTime();
-    textManager.addText("Light Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 25.5f), 0.5f);
+    const auto &spriteStats = renderStats[static_cast<uint32_t>(RenderPass::MODELS)];
+    textManager.addFormattedText(glm::vec2(1, 25), 0.5f, "Sprite Render: ", spriteRenderZone.end(), "ms | GPU: ", modelRenderGpuTimer.getElapsedTime(), "ms | Sprites: ", spriteBatch.getDrawnSpritesCount(), " (Culled: ", allModels.size() - sprites.size(), ") | Skipped: ", spriteBatch.getSkippedSpritesCount());
+    textManager.addFormattedText(glm::vec2(1, 14.5f), 0.5f, "Draw Calls: ", spriteStats.drawCalls, " | Instances: ", spriteStats.instances, " | Triangles: ", spriteStats.triangles, " | Uploaded: ", sumRenderStats(renderStats).uploadedBytes / 1024, "KB | Multi-draw Indirect: ", (multiDrawIndirectEnabled ? "On" : "Off"));
+  }
 
-    // Render the models.
-    updateStartTime = glfwGetTime();
-    renderModels(categorizedLights);
-    updateEndTime = glfwGetTime();
-    textManager.addText("Model Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 25), 0.5f);
+  /**
+   * Get the work each pass submitted to render the latest frame.
+   * 
+   * @return The work of each pass.
+   */
+  const std::array<RenderStats, RENDER_PASSES_COUNT> &getRenderStats() const
+  {
+    return renderStats;
+  }
 
-    // Update the last start time of the latest rendered frame to the start time of the current frame.
-    lastTime = currentTime;
+  /**
+   * Get the time the GPU took to render the shadow maps and the models, as of the latest available timer results.
+   * 
+   * @return The GPU time, in milliseconds.
+   */
+  double_t getGpuRenderTime() const
+  {
+    double_t gpuRenderTime = modelRenderGpuTimer.getElapsedTime() + antiAliasingGpuTimer.getElapsedTime() + overlayViewsGpuTimer.getElapsedTime();
+    for (const auto &shadowRenderGpuTimer : shadowRenderGpuTimers)
+    {
+      gpuRenderTime += shadowRenderGpuTimer.getElapsedTime();
+    }
+    return gpuRenderTime;
   }
 
   /**
@@ -596,17 +3412,35 @@ public:
    */
   static RenderManager &getInstance()
   {
+    // Singleton instance of the render manager, constructed the first time it's asked for.
+    static RenderManager instance;
     return instance;
   }
 };
 
-// Initialize the render manager singleton instance static variable.
-RenderManager RenderManager::instance;
 // Initialize the ambient lighting factor static variable.
 const float_t RenderManager::ambientFactor = 0.25f;
 // Initialize the mask value for disabling shadows static variable.
 const int32_t RenderManager::DISABLE_SHADOW = 1;
 // Initialize the mask value for disabling lighting static variable.
 const int32_t RenderManager::DISABLE_LIGHT = 2;
+// Initialize the shadow quality tier shader variant definitions static variable. The highest tier is the shader's default.
+const std::map<const ShadowQuality, const std::string> RenderManager::shadowQualityDefines({{ShadowQuality::LOW, "#define SHADOW_QUALITY 0\n"},
+                                                                                          {ShadowQuality::MEDIUM, "#define SHADOW_QUALITY 1\n"},
+                                                                                          {ShadowQuality::HIGH, ""}});
+// Initialize the shadow quality tier names static variable.
+const std::map<const ShadowQuality, const std::string> RenderManager::shadowQualityNames({{ShadowQuality::LOW, "Low"},
+                                                                                        {ShadowQuality::MEDIUM, "Medium"},
+                                                                                        {ShadowQuality::HIGH, "High"}});
+// Initialize the anti-aliasing mode names static variable.
+const std::map<const AntiAliasingMode, const std::string> RenderManager::antiAliasingModeNames({{AntiAliasingMode::OFF, "Off"},
+                                                                                              {AntiAliasingMode::MSAA_2X, "MSAA 2x"},
+                                                                                              {AntiAliasingMode::MSAA_4X, "MSAA 4x"},
+                                                                                              {AntiAliasingMode::MSAA_8X, "MSAA 8x"},
+                                                                                              {AntiAliasingMode::FXAA, "FXAA"}});
+// Initialize the multisampled anti-aliasing mode samples counts static variable.
+const std::map<const AntiAliasingMode, const uint32_t> RenderManager::antiAliasingModeSamples({{AntiAliasingMode::MSAA_2X, 2},
+                                                                                              {AntiAliasingMode::MSAA_4X, 4},
+                                                                                              {AntiAliasingMode::MSAA_8X, 8}});
 
 #endif
\ No newline at end of file
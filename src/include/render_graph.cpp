@@ -0,0 +1,556 @@
+#ifndef INCLUDE_RENDER_GRAPH_CPP
+#define INCLUDE_RENDER_GRAPH_CPP
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+#include "window.cpp"
+#include "render_target.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for defining how a pass of the render graph clears the framebuffer it draws to before drawing.
+ */
+struct RenderGraphClear
+{
+  // What buffers to clear (color/depth/stencil), where 0 doesn't clear anything.
+  GLbitfield mask;
+  // The color to clear the color buffer to.
+  glm::vec4 color;
+  // The left, bottom, width and height of the area of the framebuffer to clear, in pixels, since views can share one.
+  glm::ivec4 area;
+};
+
+/**
+ * Class for the render graph of a frame, which the passes of the frame declare the framebuffers they read and draw to
+ *   with before any of them runs. When it's executed, the graph culls the passes whose results nothing needs, orders the
+ *   rest so every pass runs after those drawing what it reads, and places the transient render targets in a pool of
+ *   targets, where targets with the same storage share it when they're not needed at the same time. Running the passes,
+ *   it binds and clears the framebuffer each draws to, leaving out the binds and clears that wouldn't change anything.
+ *   The framebuffers imported into the graph, such as the window and the shadow atlases, outlive the frame, so the passes
+ *   drawing to them are never culled.
+ */
+class RenderGraph
+{
+private:
+  /**
+   * Structure for a framebuffer the passes of the frame read or draw to.
+   */
+  struct Resource
+  {
+    // The name of the resource, for the debug output.
+    std::string name;
+    // Whether the framebuffer outlives the frame, and the ID of the framebuffer if it does.
+    bool imported;
+    GLuint importedFramebufferId;
+    // The storage of the transient render target, and the index of the target it was placed in within the pool.
+    RenderTargetDescription description;
+    int32_t targetIndex;
+    // What buffers of the framebuffer were cleared since it was last drawn to, and the area they were cleared in.
+    GLbitfield clearedMask;
+    glm::ivec4 clearedArea;
+  };
+
+  /**
+   * Structure for a pass of the frame.
+   */
+  struct Pass
+  {
+    // The name of the pass, for the debug output.
+    std::string name;
+    // The resources the pass reads, and those it draws to, the first of which is bound before the pass runs.
+    std::vector<uint32_t> reads;
+    std::vector<uint32_t> writes;
+    // How the first of the resources drawn to is cleared before the pass runs.
+    RenderGraphClear clear;
+    // Whether the pass has results outside the graph, like queries read on the CPU, so it's never culled.
+    bool hasSideEffects;
+    // The work of the pass.
+    std::function<void()> execute;
+  };
+
+  // The resources and the passes declared for the frame.
+  std::vector<Resource> resources;
+  std::vector<Pass> passes;
+
+  // The pool of transient render targets, kept between frames, and whether each was placed in by the current frame.
+  std::vector<std::unique_ptr<RenderTarget>> targetPool;
+  std::vector<bool> targetPoolUsed;
+
+  // The framebuffer bound through the graph, which isn't known until the graph binds one.
+  GLuint boundFramebufferId;
+  bool boundFramebufferKnown;
+
+  // The counts of the latest frame, for the debug output.
+  uint32_t culledPassesCount;
+  uint32_t aliasedTargetsCount;
+  uint32_t framebufferBindsCount;
+  uint32_t skippedFramebufferBindsCount;
+  uint32_t clearsCount;
+  uint32_t skippedClearsCount;
+
+  /**
+   * Find the passes whose results are needed, spreading back from the passes drawing to the imported framebuffers or with
+   *   results outside the graph, through the resources they read, until no more passes are found.
+   *
+   * @return Whether each pass is needed.
+   */
+  std::vector<bool> findNeededPasses() const
+  {
+    std::vector<bool> neededPasses(passes.size(), false);
+    std::vector<bool> neededResources(resources.size(), false);
+    for (auto progressed = true; progressed;)
+    {
+      progressed = false;
+      for (uint32_t i = 0; i < passes.size(); i++)
+      {
+        const auto &pass = passes[i];
+        auto needed = pass.hasSideEffects;
+        for (const auto &write : pass.writes)
+        {
+          needed = needed || resources[write].imported || neededResources[write];
+        }
+        if (!needed || neededPasses[i])
+        {
+          continue;
+        }
+        neededPasses[i] = true;
+        for (const auto &read : pass.reads)
+        {
+          neededResources[read] = true;
+        }
+        progressed = true;
+      }
+    }
+    return neededPasses;
+  }
+
+  /**
+   * Order the needed passes so every pass runs after the passes drawing to what it reads or draws to, with the passes
+   *   drawing to the same resource kept in the order they were declared, and the passes free to run in any order kept in
+   *   the order they were declared as well.
+   *
+   * @param neededPasses  Whether each pass is needed.
+   *
+   * @return The indices of the needed passes, in the order they run.
+   */
+  std::vector<uint32_t> orderPasses(const std::vector<bool> &neededPasses) const
+  {
+    // Every pass depends on the passes drawing to the resources it reads, and on the passes declared before it drawing to
+    //   the resources it draws to.
+    std::vector<std::vector<uint32_t>> dependents(passes.size());
+    std::vector<uint32_t> dependenciesCounts(passes.size(), 0);
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+      for (uint32_t j = 0; j < passes.size(); j++)
+      {
+        if (i == j || !neededPasses[i] || !neededPasses[j])
+        {
+          continue;
+        }
+        auto dependsOn = false;
+        for (const auto &write : passes[j].writes)
+        {
+          for (const auto &read : passes[i].reads)
+          {
+            dependsOn = dependsOn || read == write;
+          }
+          for (const auto &otherWrite : passes[i].writes)
+          {
+            dependsOn = dependsOn || (j < i && otherWrite == write);
+          }
+        }
+        if (dependsOn)
+        {
+          dependents[j].push_back(i);
+          dependenciesCounts[i]++;
+        }
+      }
+    }
+
+    // Keep running the earliest declared pass whose dependencies all ran.
+    std::vector<uint32_t> orderedPasses({});
+    std::vector<bool> orderedFlags(passes.size(), false);
+    for (auto progressed = true; progressed;)
+    {
+      progressed = false;
+      for (uint32_t i = 0; i < passes.size(); i++)
+      {
+        if (!neededPasses[i] || orderedFlags[i] || dependenciesCounts[i] > 0)
+        {
+          continue;
+        }
+        orderedPasses.push_back(i);
+        orderedFlags[i] = true;
+        for (const auto &dependent : dependents[i])
+        {
+          dependenciesCounts[dependent]--;
+        }
+        progressed = true;
+        break;
+      }
+    }
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+      if (neededPasses[i] && !orderedFlags[i])
+      {
+        // The passes depend on each other in a loop. Time to crash.
+        Logger::getInstance().error("Failed at render graph pass ", passes[i].name);
+        exit(1);
+      }
+    }
+    return orderedPasses;
+  }
+
+  /**
+   * Place the transient render targets read or drawn to by the ordered passes in the pool of targets, sharing a target
+   *   of the same storage between render targets whose passes don't overlap, and release the targets of the pool the
+   *   frame doesn't need.
+   *
+   * @param orderedPasses  The indices of the needed passes, in the order they run.
+   */
+  void placeTransientTargets(const std::vector<uint32_t> &orderedPasses)
+  {
+    // Find the first and last of the ordered passes each resource is used by.
+    std::vector<int32_t> firstUses(resources.size(), -1);
+    std::vector<int32_t> lastUses(resources.size(), -1);
+    for (uint32_t i = 0; i < orderedPasses.size(); i++)
+    {
+      const auto &pass = passes[orderedPasses[i]];
+      for (const auto &uses : {&pass.reads, &pass.writes})
+      {
+        for (const auto &resource : *uses)
+        {
+          firstUses[resource] = firstUses[resource] == -1 ? i : firstUses[resource];
+          lastUses[resource] = i;
+        }
+      }
+    }
+
+    // Place the render targets in the order they're first used, in a target of the pool no other render target is still
+    //   using, or in a new one.
+    std::fill(targetPoolUsed.begin(), targetPoolUsed.end(), false);
+    std::vector<int32_t> targetPoolLastUses(targetPool.size(), -1);
+    for (uint32_t use = 0; use < orderedPasses.size(); use++)
+    {
+      for (uint32_t i = 0; i < resources.size(); i++)
+      {
+        auto &resource = resources[i];
+        if (resource.imported || firstUses[i] != int32_t(use))
+        {
+          continue;
+        }
+        for (uint32_t j = 0; j < targetPool.size() && resource.targetIndex == -1; j++)
+        {
+          if (targetPool[j]->getDescription() == resource.description && targetPoolLastUses[j] < int32_t(use))
+          {
+            resource.targetIndex = j;
+            aliasedTargetsCount += targetPoolUsed[j] ? 1 : 0;
+          }
+        }
+        if (resource.targetIndex == -1)
+        {
+          targetPool.push_back(std::make_unique<RenderTarget>(resource.description));
+          targetPoolUsed.push_back(false);
+          targetPoolLastUses.push_back(-1);
+          resource.targetIndex = targetPool.size() - 1;
+        }
+        targetPoolUsed[resource.targetIndex] = true;
+        targetPoolLastUses[resource.targetIndex] = lastUses[i];
+      }
+    }
+
+    // Release the targets the frame doesn't need, such as the multisampled targets once MSAA is turned off, moving the
+    //   targets after them back.
+    for (uint32_t j = targetPool.size(); j-- > 0;)
+    {
+      if (targetPoolUsed[j])
+      {
+        continue;
+      }
+      targetPool.erase(targetPool.begin() + j);
+      targetPoolUsed.erase(targetPoolUsed.begin() + j);
+      for (auto &resource : resources)
+      {
+        resource.targetIndex -= resource.targetIndex > int32_t(j) ? 1 : 0;
+      }
+    }
+  }
+
+  /**
+   * Clear the framebuffer of the resource as the pass asks, unless it was cleared that way since it was last drawn to.
+   *
+   * @param resource  The resource the pass draws to first.
+   * @param clear     How the pass clears it.
+   */
+  void clearResource(Resource &resource, const RenderGraphClear &clear)
+  {
+    const auto &cleared = resource.clearedArea;
+    const auto clearedArea = cleared.x <= clear.area.x && cleared.y <= clear.area.y && cleared.x + cleared.z >= clear.area.x + clear.area.z &&
+                             cleared.y + cleared.w >= clear.area.y + clear.area.w;
+    if ((resource.clearedMask & clear.mask) == clear.mask && clearedArea)
+    {
+      skippedClearsCount++;
+      return;
+    }
+    auto &windowManager = WindowManager::getInstance();
+    GlStateCache::getInstance().setCapability(GL_SCISSOR_TEST, true);
+    glScissor(clear.area.x, clear.area.y, clear.area.z, clear.area.w);
+    windowManager.setClearColor(clear.color);
+    windowManager.clearScreen(clear.mask);
+    GlStateCache::getInstance().setCapability(GL_SCISSOR_TEST, false);
+    resource.clearedMask = clear.mask;
+    resource.clearedArea = clear.area;
+    clearsCount++;
+  }
+
+public:
+  RenderGraph()
+      : resources({}),
+        passes({}),
+        targetPool(),
+        targetPoolUsed({}),
+        boundFramebufferId(0),
+        boundFramebufferKnown(false),
+        culledPassesCount(0),
+        aliasedTargetsCount(0),
+        framebufferBindsCount(0),
+        skippedFramebufferBindsCount(0),
+        clearsCount(0),
+        skippedClearsCount(0) {}
+
+  // Preventing copying the render graph, since it owns its pool of render targets.
+  RenderGraph(const RenderGraph &) = delete;
+
+  /**
+   * Start declaring the passes of a new frame, forgetting the resources and passes of the previous frame while keeping its
+   *   pool of render targets.
+   */
+  void begin()
+  {
+    resources.clear();
+    passes.clear();
+  }
+
+  /**
+   * Import a framebuffer that outlives the frame into the graph, such as the window or a shadow atlas.
+   *
+   * @param name           The name of the framebuffer.
+   * @param framebufferId  The ID of the framebuffer, where 0 is the window.
+   *
+   * @return The resource of the framebuffer.
+   */
+  uint32_t importFramebuffer(const std::string &name, const GLuint &framebufferId)
+  {
+    resources.push_back({name, true, framebufferId, {}, -1, 0, glm::ivec4(0)});
+    return resources.size() - 1;
+  }
+
+  /**
+   * Declare a transient render target only used within the frame, which is placed in the pool of render targets when the
+   *   graph is executed.
+   *
+   * @param name         The name of the render target.
+   * @param description  The storage of the render target.
+   *
+   * @return The resource of the render target.
+   */
+  uint32_t createRenderTarget(const std::string &name, const RenderTargetDescription &description)
+  {
+    resources.push_back({name, false, 0, description, -1, 0, glm::ivec4(0)});
+    return resources.size() - 1;
+  }
+
+  /**
+   * Declare a pass of the frame, with the resources it reads and draws to.
+   *
+   * @param name            The name of the pass.
+   * @param reads           The resources the pass reads.
+   * @param writes          The resources the pass draws to, the first of which is bound and cleared before it runs.
+   * @param clear           How the first of the resources drawn to is cleared before the pass runs.
+   * @param execute         The work of the pass.
+   * @param hasSideEffects  Whether the pass has results outside the graph, so it's never culled.
+   */
+  void addPass(const std::string &name, const std::vector<uint32_t> &reads, const std::vector<uint32_t> &writes, const RenderGraphClear &clear,
+               const std::function<void()> &execute, const bool &hasSideEffects = false)
+  {
+    passes.push_back({name, reads, writes, clear, hasSideEffects, execute});
+  }
+
+  /**
+   * Cull, order and run the passes of the frame, placing the transient render targets they use first, and leave the
+   *   window framebuffer bound afterwards for whatever is drawn over the frame.
+   */
+  void execute()
+  {
+    culledPassesCount = 0;
+    aliasedTargetsCount = 0;
+    framebufferBindsCount = 0;
+    skippedFramebufferBindsCount = 0;
+    clearsCount = 0;
+    skippedClearsCount = 0;
+    // The framebuffer may have been bound outside the graph since the previous frame.
+    boundFramebufferKnown = false;
+
+    const auto neededPasses = findNeededPasses();
+    culledPassesCount = std::count(neededPasses.begin(), neededPasses.end(), false);
+    const auto orderedPasses = orderPasses(neededPasses);
+    placeTransientTargets(orderedPasses);
+
+    for (const auto &passIndex : orderedPasses)
+    {
+      const auto &pass = passes[passIndex];
+      if (!pass.writes.empty())
+      {
+        bindFramebuffer(getFramebufferId(pass.writes.front()));
+        if (pass.clear.mask != 0)
+        {
+          clearResource(resources[pass.writes.front()], pass.clear);
+        }
+      }
+      pass.execute();
+      for (const auto &write : pass.writes)
+      {
+        resources[write].clearedMask = 0;
+      }
+    }
+    bindFramebuffer(0);
+  }
+
+  /**
+   * Bind the given framebuffer, unless it's already bound through the graph. The passes switching between framebuffers
+   *   while running bind them through here, so the graph keeps knowing which one is bound.
+   *
+   * @param framebufferId  The ID of the framebuffer, where 0 is the window.
+   *
+   * @return Whether the framebuffer was bound.
+   */
+  bool bindFramebuffer(const GLuint &framebufferId)
+  {
+    if (boundFramebufferKnown && boundFramebufferId == framebufferId)
+    {
+      skippedFramebufferBindsCount++;
+      return false;
+    }
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    boundFramebufferId = framebufferId;
+    boundFramebufferKnown = true;
+    framebufferBindsCount++;
+    return true;
+  }
+
+  /**
+   * Get the ID of the framebuffer of the given resource, which is only known for a transient render target once the graph
+   *   is executed.
+   *
+   * @param resource  The resource.
+   *
+   * @return The framebuffer ID.
+   */
+  GLuint getFramebufferId(const uint32_t &resource) const
+  {
+    return resources[resource].imported ? resources[resource].importedFramebufferId : targetPool[resources[resource].targetIndex]->getFramebufferId();
+  }
+
+  /**
+   * Get the render target the given transient render target was placed in, while its passes run.
+   *
+   * @param resource  The resource of the transient render target.
+   *
+   * @return The render target.
+   */
+  const RenderTarget &getRenderTarget(const uint32_t &resource) const
+  {
+    return *targetPool[resources[resource].targetIndex];
+  }
+
+  /**
+   * Get the number of passes declared for the latest frame.
+   *
+   * @return The passes count.
+   */
+  uint32_t getPassesCount() const
+  {
+    return passes.size();
+  }
+
+  /**
+   * Get the number of passes of the latest frame culled since nothing needed their results.
+   *
+   * @return The culled passes count.
+   */
+  const uint32_t &getCulledPassesCount() const
+  {
+    return culledPassesCount;
+  }
+
+  /**
+   * Get the number of render targets in the pool of transient render targets.
+   *
+   * @return The render targets count.
+   */
+  uint32_t getTransientTargetsCount() const
+  {
+    return targetPool.size();
+  }
+
+  /**
+   * Get the number of transient render targets of the latest frame placed in a target of the pool another render target
+   *   of the frame was placed in earlier.
+   *
+   * @return The aliased render targets count.
+   */
+  const uint32_t &getAliasedTargetsCount() const
+  {
+    return aliasedTargetsCount;
+  }
+
+  /**
+   * Get the number of framebuffers bound through the graph in the latest frame.
+   *
+   * @return The binds count.
+   */
+  const uint32_t &getFramebufferBindsCount() const
+  {
+    return framebufferBindsCount;
+  }
+
+  /**
+   * Get the number of framebuffer binds left out in the latest frame, since the framebuffer was already bound.
+   *
+   * @return The skipped binds count.
+   */
+  const uint32_t &getSkippedFramebufferBindsCount() const
+  {
+    return skippedFramebufferBindsCount;
+  }
+
+  /**
+   * Get the number of clears of the passes of the latest frame.
+   *
+   * @return The clears count.
+   */
+  const uint32_t &getClearsCount() const
+  {
+    return clearsCount;
+  }
+
+  /**
+   * Get the number of clears of the passes left out in the latest frame, since the framebuffer was already cleared.
+   *
+   * @return The skipped clears count.
+   */
+  const uint32_t &getSkippedClearsCount() const
+  {
+    return skippedClearsCount;
+  }
+};
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef INCLUDE_RENDER_QUEUE_CPP
+#define INCLUDE_RENDER_QUEUE_CPP
+
+#include <vector>
+#include <array>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+
+/**
+ * Structure for defining an item of the render queue, along with the key it's sorted by.
+ */
+struct RenderQueueItem
+{
+  // The key the item is sorted by, made of its pass, shader, texture, mesh and depth in that order of importance.
+  uint64_t sortKey;
+  // The index of the item in the list of things the caller draws, such as its model instance groups.
+  uint32_t itemIndex;
+};
+
+/**
+ * Structure for counting the state changes of a render queue submission, or the ones it didn't need to make.
+ */
+struct RenderStateChanges
+{
+  // The number of shader program switches.
+  uint32_t programs;
+  // The number of diffuse texture binds.
+  uint32_t textures;
+  // The number of vertex array object binds.
+  uint32_t meshes;
+};
+
+/**
+ * Class for a queue of draws that is sorted by the state each draw needs, so draws sharing a shader, and then a texture
+ * and a mesh, are submitted one after another. The state is only changed when it differs from the last draw submitted,
+ * and the changes that were made and the ones that were avoided are counted.
+ */
+class RenderQueue
+{
+private:
+  // The number of bits of each part of the sort key. The parts are taken from the lowest bits of the IDs given, which
+  //   can only make different IDs sort next to each other, while the state itself is still compared in full.
+  static const uint32_t PASS_BITS = 4;
+  static const uint32_t SHADER_BITS = 16;
+  static const uint32_t TEXTURE_BITS = 16;
+  static const uint32_t MESH_BITS = 16;
+  static const uint32_t DEPTH_BITS = 12;
+
+  // The items pushed into the queue, sorted once sort is called.
+  std::vector<RenderQueueItem> items;
+  // The buffer the items are moved to between the passes of the radix sort.
+  std::vector<RenderQueueItem> sortBuffer;
+
+  // The state of the last draw submitted, with 0 meaning unknown.
+  GLuint currentProgramId;
+  GLuint currentTextureId;
+  GLuint currentVertexArrayId;
+
+  // The state changes made, and the ones avoided, since the queue was last cleared.
+  RenderStateChanges appliedChanges;
+  RenderStateChanges avoidedChanges;
+
+  /**
+   * Get the lowest bits of the given value.
+   *
+   * @param value  The value.
+   * @param bits   The number of bits to keep.
+   *
+   * @return The lowest bits of the value.
+   */
+  static uint64_t getKeyPart(const uint64_t &value, const uint32_t &bits)
+  {
+    return value & ((1ull << bits) - 1);
+  }
+
+public:
+  RenderQueue()
+      : items({}),
+        sortBuffer({}),
+        currentProgramId(0),
+        currentTextureId(0),
+        currentVertexArrayId(0),
+        appliedChanges({0, 0, 0}),
+        avoidedChanges({0, 0, 0}) {}
+
+  /**
+   * Remove all the items from the queue and reset the counted state changes, ready for the next frame.
+   */
+  void clear()
+  {
+    items.clear();
+    appliedChanges = {0, 0, 0};
+    avoidedChanges = {0, 0, 0};
+    resetState();
+  }
+
+  /**
+   * Forget the state of the last draw submitted, so the next draws set all their state again. This needs to be called
+   * before submitting, since other code may have changed the state in between.
+   */
+  void resetState()
+  {
+    currentProgramId = 0;
+    currentTextureId = 0;
+    currentVertexArrayId = 0;
+  }
+
+  /**
+   * Push a draw into the queue.
+   *
+   * @param pass         The pass of the draw, with lower passes drawn first.
+   * @param shaderId     The ID of the shader program of the draw.
+   * @param textureId    The ID of the texture of the draw.
+   * @param meshId       The ID of the vertex array object of the draw.
+   * @param depth        The depth of the draw between 0 (near) and 1 (far), so draws of the same state go front to back.
+   * @param itemIndex    The index of the draw in the list of things the caller draws.
+   */
+  void push(const uint32_t &pass, const GLuint &shaderId, const GLuint &textureId, const GLuint &meshId, const float_t &depth, const uint32_t &itemIndex)
+  {
+    const auto depthPart = static_cast<uint64_t>(glm::clamp(depth, 0.0f, 1.0f) * ((1u << DEPTH_BITS) - 1));
+    const auto sortKey = getKeyPart(pass, PASS_BITS) << (SHADER_BITS + TEXTURE_BITS + MESH_BITS + DEPTH_BITS) |
+                         getKeyPart(shaderId, SHADER_BITS) << (TEXTURE_BITS + MESH_BITS + DEPTH_BITS) |
+                         getKeyPart(textureId, TEXTURE_BITS) << (MESH_BITS + DEPTH_BITS) |
+                         getKeyPart(meshId, MESH_BITS) << DEPTH_BITS |
+                         depthPart;
+    items.push_back({sortKey, itemIndex});
+  }
+
+  /**
+   * Sort the items of the queue by their keys, with a radix sort going through the keys a byte at a time from the lowest
+   * byte. Bytes that are the same for every item are skipped, which in practice is most of them.
+   */
+  void sort()
+  {
+    sortBuffer.resize(items.size());
+    for (uint32_t shift = 0; shift < 64; shift += 8)
+    {
+      // Count the items with each value of the byte.
+      std::array<uint32_t, 256> byteCounts = {};
+      for (const auto &item : items)
+      {
+        byteCounts[(item.sortKey >> shift) & 0xff]++;
+      }
+      // Skip the byte if every item has the same value for it, since the order wouldn't change.
+      if (items.empty() || byteCounts[(items.front().sortKey >> shift) & 0xff] == items.size())
+      {
+        continue;
+      }
+
+      // Turn the counts into the positions each value starts at, then move the items there in their current order.
+      uint32_t offset = 0;
+      for (auto &byteCount : byteCounts)
+      {
+        const auto count = byteCount;
+        byteCount = offset;
+        offset += count;
+      }
+      for (const auto &item : items)
+      {
+        sortBuffer[byteCounts[(item.sortKey >> shift) & 0xff]++] = item;
+      }
+      items.swap(sortBuffer);
+    }
+  }
+
+  /**
+   * Get the items of the queue, in sorted order once sort has been called.
+   *
+   * @return The items of the queue.
+   */
+  const std::vector<RenderQueueItem> &getItems() const
+  {
+    return items;
+  }
+
+  /**
+   * Use the given shader program, if it isn't already in use.
+   *
+   * @param programId  The ID of the shader program.
+   *
+   * @return Whether the program was switched, meaning the uniforms shared by its draws need setting.
+   */
+  bool useProgram(const GLuint &programId)
+  {
+    if (currentProgramId == programId)
+    {
+      avoidedChanges.programs++;
+      return false;
+    }
+    currentProgramId = programId;
+    GlStateCache::getInstance().useProgram(programId);
+    appliedChanges.programs++;
+    return true;
+  }
+
+  /**
+   * Bind the given texture to the active texture unit, if it isn't already bound.
+   *
+   * @param textureId  The ID of the texture.
+   */
+  void bindTexture(const GLuint &textureId)
+  {
+    if (currentTextureId == textureId)
+    {
+      avoidedChanges.textures++;
+      return;
+    }
+    currentTextureId = textureId;
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureId);
+    appliedChanges.textures++;
+  }
+
+  /**
+   * Bind the given vertex array object, if it isn't already bound.
+   *
+   * @param vertexArrayId  The ID of the vertex array object.
+   */
+  void bindVertexArray(const GLuint &vertexArrayId)
+  {
+    if (currentVertexArrayId == vertexArrayId)
+    {
+      avoidedChanges.meshes++;
+      return;
+    }
+    currentVertexArrayId = vertexArrayId;
+    GlStateCache::getInstance().bindVertexArray(vertexArrayId);
+    appliedChanges.meshes++;
+  }
+
+  /**
+   * Get the state changes made since the queue was last cleared.
+   *
+   * @return The state changes made.
+   */
+  const RenderStateChanges &getAppliedChanges() const
+  {
+    return appliedChanges;
+  }
+
+  /**
+   * Get the state changes that weren't needed since the queue was last cleared, since the state was already set.
+   *
+   * @return The state changes avoided.
+   */
+  const RenderStateChanges &getAvoidedChanges() const
+  {
+    return avoidedChanges;
+  }
+};
+
+#endif
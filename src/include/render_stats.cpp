@@ -0,0 +1,81 @@
+#ifndef INCLUDE_RENDER_STATS_CPP
+#define INCLUDE_RENDER_STATS_CPP
+
+#include <string>
+#include <array>
+
+/**
+ * The passes of a frame whose work is counted, with the uploads shared by the passes counted on their own.
+ */
+enum class RenderPass : uint32_t
+{
+  SETUP = 0,
+  SHADOWS = 1,
+  DEPTH_PRE_PASS = 2,
+  MODELS = 3,
+  DEFERRED_LIGHTING = 4,
+  UPSCALE = 5,
+  PARTICLES = 6,
+  OCCLUSION = 7,
+};
+
+// The number of passes whose work is counted.
+const uint32_t RENDER_PASSES_COUNT = 8;
+
+// The names of the passes, for reporting.
+const std::array<std::string, RENDER_PASSES_COUNT> renderPassNames = {"Setup", "Shadows", "Depth Pre-pass", "Models", "Lighting", "Upscale", "Particles", "Occlusion"};
+
+/**
+ * Structure for counting the work a pass submits to the GPU in a frame.
+ */
+struct RenderStats
+{
+  // The number of draw calls, with a multi-draw indirect call counting once.
+  uint32_t drawCalls;
+  // The number of instances drawn, and the number of triangles drawn across all of them.
+  uint64_t instances;
+  uint64_t triangles;
+  // The number of uniform variables set.
+  uint32_t uniformCalls;
+  // The number of bytes written to buffers of the GPU.
+  uint64_t uploadedBytes;
+  // The number of framebuffer, program, texture, sampler and vertex array binds, and instance attribute changes.
+  uint32_t stateChanges;
+
+  /**
+   * Add the work counted by another pass.
+   *
+   * @param other  The work of the other pass.
+   *
+   * @return The counted work.
+   */
+  RenderStats &operator+=(const RenderStats &other)
+  {
+    drawCalls += other.drawCalls;
+    instances += other.instances;
+    triangles += other.triangles;
+    uniformCalls += other.uniformCalls;
+    uploadedBytes += other.uploadedBytes;
+    stateChanges += other.stateChanges;
+    return *this;
+  }
+};
+
+/**
+ * Add up the work counted by every pass of a frame.
+ *
+ * @param passesStats  The work of each pass.
+ *
+ * @return The work of the whole frame.
+ */
+RenderStats sumRenderStats(const std::array<RenderStats, RENDER_PASSES_COUNT> &passesStats)
+{
+  RenderStats totalStats = {};
+  for (const auto &passStats : passesStats)
+  {
+    totalStats += passStats;
+  }
+  return totalStats;
+}
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef INCLUDE_RENDER_TARGET_CPP
+#define INCLUDE_RENDER_TARGET_CPP
+
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "gl_state.cpp"
+#include "constants.cpp"
+#include "window.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for describing the storage of a render target, which render targets are only shared between when they match.
+ */
+struct RenderTargetDescription
+{
+  // The width and height of the target, in pixels.
+  int32_t width;
+  int32_t height;
+  // The formats the colors and depths are stored in.
+  GLenum colorFormat;
+  GLenum depthFormat;
+  // The number of samples of each pixel, where 0 stores the target in textures that can be read by shaders, and any
+  //   other count in renderbuffers that can only be resolved.
+  uint32_t samplesCount;
+  // The filter the color texture is read with.
+  GLint colorFilter;
+
+  bool operator==(const RenderTargetDescription &other) const
+  {
+    return width == other.width && height == other.height && colorFormat == other.colorFormat && depthFormat == other.depthFormat &&
+           samplesCount == other.samplesCount && colorFilter == other.colorFilter;
+  }
+};
+
+/**
+ * Class for an offscreen target the scene is rendered to, such as with dynamic resolution or anti-aliasing, holding the
+ *   colors and depths of what was rendered. A target without samples is stored in textures, so it can be upscaled to the
+ *   window, and a multisampled target in renderbuffers, resolved into a target without samples of the same formats.
+ */
+class RenderTarget
+{
+private:
+  // The storage of the target.
+  const RenderTargetDescription description;
+  // The number of samples of each pixel, which can be less than described if the GPU doesn't support as many.
+  const uint32_t samplesCount;
+
+  // The textures or the renderbuffers holding the colors and the depths.
+  const GLuint colorStorageId;
+  const GLuint depthStorageId;
+  // The framebuffer the storage is attached to.
+  const GLuint framebufferId;
+
+  /**
+   * Limit the number of samples of the description to the most the GPU supports.
+   *
+   * @param description  The storage of the target.
+   *
+   * @return The samples count.
+   */
+  static uint32_t getSupportedSamplesCount(const RenderTargetDescription &description)
+  {
+    if (description.samplesCount == 0)
+    {
+      return 0;
+    }
+    GLint maxSamplesCount;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamplesCount);
+    return std::min(description.samplesCount, static_cast<uint32_t>(maxSamplesCount));
+  }
+
+  /**
+   * Create a texture or a multisampled renderbuffer of the size of the target.
+   *
+   * @param internalFormat  The format the storage stores its data in.
+   * @param format          The format of the pixel data.
+   * @param type            The data type of the pixel data.
+   * @param filter          The filter the texture is read with.
+   *
+   * @return The ID of the created texture or renderbuffer.
+   */
+  GLuint createStorage(const GLenum &internalFormat, const GLenum &format, const GLenum &type, const GLint &filter) const
+  {
+    if (samplesCount > 0)
+    {
+      GLuint newRenderbufferId;
+      glGenRenderbuffers(1, &newRenderbufferId);
+      glBindRenderbuffer(GL_RENDERBUFFER, newRenderbufferId);
+      glRenderbufferStorageMultisample(GL_RENDERBUFFER, samplesCount, internalFormat, description.width, description.height);
+      glBindRenderbuffer(GL_RENDERBUFFER, 0);
+      return newRenderbufferId;
+    }
+    GLuint newTextureId;
+    glGenTextures(1, &newTextureId);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, newTextureId);
+    if (WindowManager::getInstance().isTextureStorageSupported())
+    {
+      glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, description.width, description.height);
+    }
+    else
+    {
+      glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, description.width, description.height, 0, format, type, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+    return newTextureId;
+  }
+
+  /**
+   * Attach a texture or a renderbuffer of the target to the bound framebuffer.
+   *
+   * @param attachment  The attachment point.
+   * @param storageId   The ID of the texture or the renderbuffer.
+   */
+  void attachStorage(const GLenum &attachment, const GLuint &storageId) const
+  {
+    if (samplesCount > 0)
+    {
+      glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, storageId);
+    }
+    else
+    {
+      glFramebufferTexture(GL_FRAMEBUFFER, attachment, storageId, 0);
+    }
+  }
+
+  /**
+   * Create the framebuffer of the target, with the color storage as its color output and the depth storage as its depth
+   *   buffer.
+   *
+   * @return The ID of the created framebuffer.
+   */
+  GLuint createFramebuffer() const
+  {
+    GLuint newFramebufferId;
+    glGenFramebuffers(1, &newFramebufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, newFramebufferId);
+    attachStorage(GL_COLOR_ATTACHMENT0, colorStorageId);
+    attachStorage(GL_DEPTH_ATTACHMENT, depthStorageId);
+
+    // Check if the framebuffer was successfully created.
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      // Framebuffer is not ready. Time to crash.
+      Logger::getInstance().error("Failed at render target 1");
+      exit(1);
+    }
+
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return newFramebufferId;
+  }
+
+public:
+  /**
+   * Create a render target with the given storage.
+   *
+   * @param description  The storage of the target.
+   */
+  RenderTarget(const RenderTargetDescription &description)
+      : description(description),
+        samplesCount(getSupportedSamplesCount(description)),
+        colorStorageId(createStorage(description.colorFormat, GL_RGBA, GL_UNSIGNED_BYTE, description.colorFilter)),
+        depthStorageId(createStorage(description.depthFormat, GL_DEPTH_COMPONENT, GL_FLOAT, GL_NEAREST)),
+        framebufferId(createFramebuffer()) {}
+
+  // Preventing copying the render target, since it owns its storage and framebuffer.
+  RenderTarget(const RenderTarget &) = delete;
+
+  ~RenderTarget()
+  {
+    GlStateCache::getInstance().deleteFramebuffers(1, &framebufferId);
+    if (samplesCount > 0)
+    {
+      glDeleteRenderbuffers(1, &colorStorageId);
+      glDeleteRenderbuffers(1, &depthStorageId);
+    }
+    else
+    {
+      GlStateCache::getInstance().deleteTextures(1, &colorStorageId);
+      GlStateCache::getInstance().deleteTextures(1, &depthStorageId);
+    }
+  }
+
+  /**
+   * Get the storage the target was described with.
+   *
+   * @return The description of the target.
+   */
+  const RenderTargetDescription &getDescription() const
+  {
+    return description;
+  }
+
+  /**
+   * Get the number of samples of each pixel, which can be less than described if the GPU doesn't support as many.
+   *
+   * @return The samples count.
+   */
+  const uint32_t &getSamplesCount() const
+  {
+    return samplesCount;
+  }
+
+  /**
+   * Get the ID of the framebuffer of the target.
+   *
+   * @return The framebuffer ID.
+   */
+  const GLuint &getFramebufferId() const
+  {
+    return framebufferId;
+  }
+
+  /**
+   * Bind the textures of a target without samples to the given texture units, starting from the color, then the depth.
+   *
+   * @param firstTextureUnit  The texture unit of the color texture.
+   */
+  void bindTextures(const GLuint &firstTextureUnit) const
+  {
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0 + firstTextureUnit);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, colorStorageId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0 + firstTextureUnit + 1);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, depthStorageId);
+  }
+
+  /**
+   * Resolve the samples of the colors and depths of the bottom-left of the target into the same area of the bound
+   *   framebuffer, which must have the same formats, and read from that framebuffer again afterwards.
+   *
+   * @param boundFramebufferId  The ID of the bound framebuffer to resolve into.
+   * @param size                The size of the area to resolve, in pixels.
+   */
+  void resolve(const GLuint &boundFramebufferId, const glm::ivec2 &size) const
+  {
+    GlStateCache::getInstance().bindFramebuffer(GL_READ_FRAMEBUFFER, framebufferId);
+    glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    GlStateCache::getInstance().bindFramebuffer(GL_READ_FRAMEBUFFER, boundFramebufferId);
+  }
+};
+
+#endif
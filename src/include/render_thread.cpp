@@ -0,0 +1,164 @@
+#ifndef INCLUDE_RENDER_THREAD_CPP
+#define INCLUDE_RENDER_THREAD_CPP
+
+#include <atomic>
+#include <thread>
+#include <functional>
+
+#include <GLFW/glfw3.h>
+
+#include "constants.cpp"
+#include "spsc_queue.cpp"
+#include "thread_affinity.cpp"
+
+/**
+ * Class for the thread the GL work of the frames runs on when the render thread is enabled, which owns the GL context
+ *   of the window while it runs. The thread running the scene submits the work as packets into a lock-free queue, and
+ *   waits for a packet only once it needs the work done, so it can go on with the next frame while the render thread
+ *   swaps the buffers. While the thread isn't running, the packets run right away on the submitting thread.
+ */
+class RenderThread
+{
+private:
+  // The packets of work submitted and not yet taken by the render thread.
+  SpscQueue<std::function<void()>, RENDER_PACKET_QUEUE_SIZE> packets;
+  // The render thread, and whether it was asked to stop once its packets are done.
+  std::thread thread;
+  std::atomic<bool> stopRequested;
+  // The window whose context the render thread owns.
+  GLFWwindow *window;
+  // The number of packets submitted, and the number of them that are done.
+  uint64_t submittedPacketsCount;
+  std::atomic<uint64_t> completedPacketsCount;
+
+  /**
+   * Run the packets submitted to the render thread, in order, until it's asked to stop.
+   */
+  void runPackets()
+  {
+    ThreadLayout::getInstance().applyToCurrentThread(ThreadRole::RENDER);
+    glfwMakeContextCurrent(window);
+    std::function<void()> packet;
+    while (!stopRequested.load(std::memory_order_acquire))
+    {
+      if (!packets.pop(packet))
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      packet();
+      // Let go of whatever the packet holds on to before it's counted as done.
+      packet = nullptr;
+      completedPacketsCount.fetch_add(1, std::memory_order_release);
+    }
+    glfwMakeContextCurrent(nullptr);
+  }
+
+public:
+  RenderThread()
+      : packets(),
+        thread(),
+        stopRequested(false),
+        window(nullptr),
+        submittedPacketsCount(0),
+        completedPacketsCount(0) {}
+
+  // Preventing copying the render thread, since it owns the thread.
+  RenderThread(const RenderThread &) = delete;
+
+  ~RenderThread()
+  {
+    stop();
+  }
+
+  /**
+   * Check if the render thread is running, so the packets run on it instead of right away.
+   *
+   * @return Whether the render thread is running.
+   */
+  bool isRunning() const
+  {
+    return thread.joinable();
+  }
+
+  /**
+   * Start the render thread, handing the GL context of the window over to it. The calling thread must not make any GL
+   *   calls until the render thread is stopped.
+   *
+   * @param newWindow  The window whose context the render thread owns.
+   */
+  void start(GLFWwindow *newWindow)
+  {
+    if (isRunning())
+    {
+      return;
+    }
+    window = newWindow;
+    stopRequested.store(false, std::memory_order_relaxed);
+    glfwMakeContextCurrent(nullptr);
+    thread = std::thread(&RenderThread::runPackets, this);
+  }
+
+  /**
+   * Stop the render thread once all the packets submitted to it are done, taking the GL context of the window back.
+   */
+  void stop()
+  {
+    if (!isRunning())
+    {
+      return;
+    }
+    waitForIdle();
+    stopRequested.store(true, std::memory_order_release);
+    thread.join();
+    glfwMakeContextCurrent(window);
+  }
+
+  /**
+   * Submit a packet of work, which runs on the render thread after the packets submitted before it, or right away if
+   *   the render thread isn't running.
+   *
+   * @param packet  The packet.
+   *
+   * @return The number of the packet, to wait for it with.
+   */
+  uint64_t submit(std::function<void()> &&packet)
+  {
+    submittedPacketsCount++;
+    if (!isRunning())
+    {
+      packet();
+      completedPacketsCount.fetch_add(1, std::memory_order_release);
+      return submittedPacketsCount;
+    }
+    // The queue only fills up if the render thread is a whole queue of packets behind, so wait for it to catch up.
+    while (!packets.push(std::move(packet)))
+    {
+      std::this_thread::yield();
+    }
+    return submittedPacketsCount;
+  }
+
+  /**
+   * Wait until the given packet, and the ones submitted before it, are done.
+   *
+   * @param packetNumber  The number of the packet.
+   */
+  void waitFor(const uint64_t &packetNumber) const
+  {
+    while (completedPacketsCount.load(std::memory_order_acquire) < packetNumber)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Wait until all the packets submitted are done.
+   */
+  void waitForIdle() const
+  {
+    waitFor(submittedPacketsCount);
+  }
+};
+
+#endif
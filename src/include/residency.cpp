@@ -0,0 +1,89 @@
+#ifndef INCLUDE_RESIDENCY_CPP
+#define INCLUDE_RESIDENCY_CPP
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+/**
+ * Class for tracking resources that have no more references but are kept resident, so they can be reused without being
+ * loaded again. The resources that were released the longest time ago are evicted first once the resident resources go
+ * over the budget.
+ */
+class ResidencyCache
+{
+private:
+  // The names of the unused resources, from the least recently released to the most recently released.
+  std::list<std::string> unusedNames;
+  // A map of the unused resource names to their position in the list and their size.
+  std::map<const std::string, std::pair<std::list<std::string>::iterator, uint64_t>> unusedResources;
+  // The total size of the unused resources.
+  uint64_t unusedSize;
+
+public:
+  ResidencyCache()
+      : unusedNames({}),
+        unusedResources({}),
+        unusedSize(0) {}
+
+  /**
+   * Mark the resource as unused, so it is kept resident until it's evicted.
+   *
+   * @param name  The name of the resource.
+   * @param size  The size of the resource, in the same units as the budget.
+   */
+  void markUnused(const std::string &name, const uint64_t &size)
+  {
+    markUsed(name);
+    unusedResources.insert(std::make_pair(name, std::make_pair(unusedNames.insert(unusedNames.end(), name), size)));
+    unusedSize += size;
+  }
+
+  /**
+   * Mark the resource as used again, so it is no longer a candidate for eviction.
+   *
+   * @param name  The name of the resource.
+   */
+  void markUsed(const std::string &name)
+  {
+    const auto unusedResource = unusedResources.find(name);
+    if (unusedResource != unusedResources.end())
+    {
+      unusedSize -= unusedResource->second.second;
+      unusedNames.erase(unusedResource->second.first);
+      unusedResources.erase(unusedResource);
+    }
+  }
+
+  /**
+   * Remove the least recently released resources until the unused resources fit in the given budget.
+   *
+   * @param budget  The maximum total size of the unused resources to keep resident.
+   *
+   * @return The names of the resources to evict, which the caller needs to destroy.
+   */
+  std::vector<std::string> evict(const uint64_t &budget)
+  {
+    std::vector<std::string> evictedNames;
+    while (unusedSize > budget)
+    {
+      const auto name = unusedNames.front();
+      markUsed(name);
+      evictedNames.push_back(name);
+    }
+    return evictedNames;
+  }
+
+  /**
+   * Get the total size of the unused resources kept resident.
+   *
+   * @return The size of the unused resources.
+   */
+  uint64_t getUnusedSize() const
+  {
+    return unusedSize;
+  }
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef INCLUDE_SAMPLER_CPP
+#define INCLUDE_SAMPLER_CPP
+
+#include <array>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "gl_state.cpp"
+
+/**
+ * Enum for the presets of the shared samplers, each a way of filtering and wrapping the textures bound with it.
+ */
+enum class SamplerPreset
+{
+  // Bilinear filtering within the two closest mip levels, blended together.
+  TRILINEAR,
+  // Trilinear filtering with up to 2, 4, 8 or 16 samples along the direction the texture is squashed in on the screen,
+  //   which keeps the textures seen at grazing angles sharp.
+  ANISOTROPIC_2X,
+  ANISOTROPIC_4X,
+  ANISOTROPIC_8X,
+  ANISOTROPIC_16X,
+  // The closest texel of the full sized level, for the textures read one texel at a time.
+  NEAREST,
+  // Hardware depth comparisons against a reference depth, with the results of the four closest texels blended together.
+  SHADOW_COMPARE
+};
+
+// The number of sampler presets.
+const uint32_t SAMPLER_PRESETS_COUNT = 7;
+
+/**
+ * A manager class for the samplers shared by every texture, one for each preset, created the first time they're asked
+ *   for. Binding a sampler to a texture unit overrides the parameters of the textures bound to it, so how the textures of
+ *   a pass are filtered can be changed while the game runs without creating the textures again.
+ */
+class SamplerManager
+{
+private:
+  // The IDs of the samplers of the presets, or 0 for those not created yet.
+  std::array<GLuint, SAMPLER_PRESETS_COUNT> samplerIds;
+
+  SamplerManager()
+      : samplerIds({}) {}
+
+  ~SamplerManager()
+  {
+    for (const auto &samplerId : samplerIds)
+    {
+      if (samplerId != 0)
+      {
+        glDeleteSamplers(1, &samplerId);
+      }
+    }
+  }
+
+  /**
+   * Get the most samples the anisotropic presets can take, which is limited by the driver, or 1 if it can't filter
+   *   anisotropically at all.
+   *
+   * @param samplesCount  The number of samples of the preset.
+   *
+   * @return The number of samples to take.
+   */
+  static GLfloat getAnisotropy(const GLfloat &samplesCount)
+  {
+    if (!GLEW_EXT_texture_filter_anisotropic)
+    {
+      return 1.0f;
+    }
+    GLfloat maxAnisotropy = 1.0f;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+    return std::min(samplesCount, maxAnisotropy);
+  }
+
+  /**
+   * Create the sampler of a preset.
+   *
+   * @param preset  The preset.
+   *
+   * @return The ID of the created sampler.
+   */
+  static GLuint createSampler(const SamplerPreset &preset)
+  {
+    GLuint newSamplerId;
+    glGenSamplers(1, &newSamplerId);
+
+    // The textures of the models are clamped like they were created with, and the texture coordinates of the shadow maps
+    //   are always kept inside the shadow atlas tiles, so there is no need for a border.
+    glSamplerParameteri(newSamplerId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(newSamplerId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(newSamplerId, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    switch (preset)
+    {
+    case SamplerPreset::NEAREST:
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      break;
+    case SamplerPreset::SHADOW_COMPARE:
+      // Linear filtering on a depth comparison filters the comparison results, not the depth values.
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      // A texel passes (is lit) when the reference depth is not further away than the recorded depth.
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+      break;
+    default:
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+      glSamplerParameteri(newSamplerId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      if (preset != SamplerPreset::TRILINEAR)
+      {
+        const auto samplesCount = GLfloat(2u << (static_cast<uint32_t>(preset) - static_cast<uint32_t>(SamplerPreset::ANISOTROPIC_2X)));
+        glSamplerParameterf(newSamplerId, GL_TEXTURE_MAX_ANISOTROPY_EXT, getAnisotropy(samplesCount));
+      }
+      break;
+    }
+    return newSamplerId;
+  }
+
+public:
+  // Preventing copying the sampler manager, making sure only one instance can exist.
+  SamplerManager(const SamplerManager &) = delete;
+
+  /**
+   * Get the sampler of a preset, creating it the first time it's asked for.
+   *
+   * @param preset  The preset.
+   *
+   * @return The ID of the sampler.
+   */
+  GLuint getSamplerId(const SamplerPreset &preset)
+  {
+    auto &samplerId = samplerIds[static_cast<uint32_t>(preset)];
+    if (samplerId == 0)
+    {
+      samplerId = createSampler(preset);
+    }
+    return samplerId;
+  }
+
+  /**
+   * Bind the sampler of a preset to a texture unit, for the textures bound to it to be filtered the way of the preset.
+   *
+   * @param unit    The index of the texture unit, from 0 on.
+   * @param preset  The preset.
+   */
+  void bindSampler(const GLuint &unit, const SamplerPreset &preset)
+  {
+    GlStateCache::getInstance().bindSampler(unit, getSamplerId(preset));
+  }
+
+  /**
+   * Unbind the sampler of a texture unit, for the textures bound to it to be filtered with their own parameters again.
+   *
+   * @param unit  The index of the texture unit, from 0 on.
+   */
+  static void unbindSampler(const GLuint &unit)
+  {
+    GlStateCache::getInstance().bindSampler(unit, 0);
+  }
+
+  /**
+   * Returns the singleton instance of the sampler manager.
+   *
+   * @return The sampler manager singleton instance.
+   */
+  static SamplerManager &getInstance()
+  {
+    // Singleton instance of the sampler manager, constructed the first time it's asked for.
+    static SamplerManager instance;
+    return instance;
+  }
+};
+
+#endif
@@ -20,6 +20,8 @@
 #include "shader.cpp"
 #include "collider.cpp"
 #include "text.cpp"
+#include "startup.cpp"
+#include "world.cpp"
 #include "../scenes/scene_base.cpp"
 
 /**
@@ -28,9 +30,6 @@
 class SceneManager
 {
 private:
-  // Singleton instance of the scene manager.
-  static SceneManager instance;
-
   std::string activeSceneId;
   // The map of registered scenes.
   std::map<const std::string, std::shared_ptr<SceneBase>> registeredScenes;
@@ -135,10 +134,42 @@ public:
     {
       return false;
     }
+    // The scene runs in its world, so the models it creates and the managers it asks for are the ones of its world.
+    WorldScope worldScope(activeScene->second->getWorld());
 
-    activeScene->second->init();
+    // Initializing the first scene is the last phase of starting up the engine.
+    auto &startupProfiler = StartupProfiler::getInstance();
+    if (startupProfiler.isFinished())
+    {
+      activeScene->second->init();
+    }
+    else
+    {
+      startupProfiler.runPhase(StartupPhase::FIRST_SCENE, [&] { activeScene->second->init(); });
+      startupProfiler.finish();
+    }
+    // Start loading the scenes that can follow in the background while the active scene runs, so switching to them is
+    //   immediate instead of waiting for their assets to load.
+    const auto preloadSceneIds = activeScene->second->getPreloadSceneIds();
+    for (const auto &preloadSceneId : preloadSceneIds)
+    {
+      const auto preloadScene = registeredScenes.find(preloadSceneId);
+      if (preloadScene != registeredScenes.end() && preloadScene->second != activeScene->second)
+      {
+        preloadScene->second->preload();
+      }
+    }
     const auto nextSceneId = activeScene->second->execute();
     activeScene->second->deinit();
+    // Release the assets of the preloaded scenes that didn't follow.
+    for (const auto &preloadSceneId : preloadSceneIds)
+    {
+      const auto preloadScene = registeredScenes.find(preloadSceneId);
+      if (preloadScene != registeredScenes.end() && preloadScene->second != activeScene->second && preloadSceneId != nextSceneId)
+      {
+        preloadScene->second->cancelPreload();
+      }
+    }
     if (!nextSceneId.has_value())
     {
       return false;
@@ -156,11 +187,10 @@ public:
    */
   static SceneManager &getInstance()
   {
+    // Singleton instance of the scene manager, constructed the first time it's asked for.
+    static SceneManager instance;
     return instance;
   }
 };
 
-// Initialize the scene manager singleton instance static variable.
-SceneManager SceneManager::instance;
-
 #endif
\ No newline at end of file
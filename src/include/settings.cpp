@@ -0,0 +1,404 @@
+#ifndef INCLUDE_SETTINGS_CPP
+#define INCLUDE_SETTINGS_CPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+#include <limits>
+#include <algorithm>
+
+#include "constants.cpp"
+#include "file_watcher.cpp"
+#include "log.cpp"
+
+/**
+ * A manager class for the settings of the engine, by their names, which are read from a settings file as lines of
+ *   "name = value", with anything after a "#" left out. Each setting is registered by whoever owns what it sets, along
+ *   with how its value is applied, and the value in the settings file is applied the moment it's registered, so the file
+ *   loaded at startup sets up everything created after it. While the game runs, the settings file is checked for changes,
+ *   and the settings whose values changed are applied again and their listeners called, so they can reallocate only the
+ *   resources they size. The settings that can only be picked before what they set up is created take effect on the next
+ *   start instead.
+ */
+class SettingsManager
+{
+private:
+  /**
+   * Structure for a registered setting.
+   */
+  struct Setting
+  {
+    // Whether the setting can be changed while the game runs.
+    bool live;
+    // Apply a value of the setting, returning whether it was a valid value.
+    std::function<bool(const std::string &)> apply;
+    // The functions called after a changed value was applied while the game runs.
+    std::vector<std::function<void()>> listeners;
+  };
+
+  // The registered settings, by their names.
+  std::map<const std::string, Setting> settings;
+  // The values read from the settings file, by the names of their settings, including those not registered yet.
+  std::map<const std::string, std::string> values;
+  // The path to the settings file, or empty if none was loaded.
+  std::string settingsFilePath;
+  // The watcher of the settings file.
+  FileWatcher fileWatcher;
+  // The time the settings file was last checked at.
+  double_t lastCheckTime;
+
+  SettingsManager()
+      : settings({}),
+        values({}),
+        settingsFilePath(""),
+        fileWatcher(),
+        lastCheckTime(0.0)
+  {
+    // The sizes of the shadow atlases are reallocated by the shadow buffer manager when they change, and the V-Sync
+    //   settings are applied by the window manager, which add their listeners.
+    // A size of 0 is rejected, as the shadow map size option does, since it would make empty atlases and tiles.
+    const auto setShadowAtlasSize = [](uint32_t &target) {
+      return [&target](const uint32_t &size) {
+        if (size == 0)
+        {
+          return false;
+        }
+        target = size;
+        return true;
+      };
+    };
+    add<uint32_t>("cone_shadow_atlas_size", true, setShadowAtlasSize(CONE_SHADOW_ATLAS_SIZE));
+    add<uint32_t>("point_shadow_atlas_size", true, setShadowAtlasSize(POINT_SHADOW_ATLAS_SIZE));
+    add<uint32_t>("directional_shadow_atlas_size", true, setShadowAtlasSize(DIRECTIONAL_SHADOW_ATLAS_SIZE));
+    add("shadow_atlas_memory_budget", true, SHADOW_ATLAS_MEMORY_BUDGET);
+    add("swap_interval", true, SWAP_INTERVAL);
+    add<uint32_t>("frame_rate_cap", true, [](const uint32_t &frameRateCap) { FRAME_RATE_CAP = std::max<uint32_t>(frameRateCap, 1); });
+    add("idle_throttle", true, IDLE_THROTTLE_ENABLED);
+    add("idle_frame_rate", true, IDLE_FRAME_RATE);
+    add("idle_pause", true, IDLE_PAUSE_ENABLED);
+    add("shadow_render_budget", true, SHADOW_RENDER_BUDGET);
+    add("gpu_render_budget", true, GPU_RENDER_BUDGET);
+    add("impostor_screen_size", true, IMPOSTOR_SCREEN_SIZE);
+    add("keep_game_scene_warm", true, KEEP_GAME_SCENE_WARM);
+    add("hitch_threshold", true, HITCH_THRESHOLD);
+    add("hitch_min_frame_time", true, HITCH_MIN_FRAME_TIME);
+    add("text_overlay_refresh_rate", true, TEXT_OVERLAY_REFRESH_RATE);
+    // The threads are started and placed, and the assets mounted, once at startup.
+    add("render_thread", false, RENDER_THREAD_ENABLED);
+    add("thread_affinity", false, THREAD_AFFINITY_ENABLED);
+    add("hot_reload", false, ASSET_HOT_RELOAD_ENABLED);
+    addChoice("log_level", true, {"debug", "info", "warning", "error"}, [](const size_t &index) {
+      Logger::getInstance().setMinSeverity(static_cast<LogSeverity>(index));
+    });
+  }
+
+  /**
+   * Apply a value to a registered setting, warning about it if it isn't a valid value.
+   *
+   * @param name     The name of the setting.
+   * @param setting  The setting.
+   * @param text     The text of the value.
+   *
+   * @return Whether the value was applied.
+   */
+  static bool applyValue(const std::string &name, const Setting &setting, const std::string &text)
+  {
+    if (!setting.apply(text))
+    {
+      Logger::getInstance().warning("Invalid value \"", text, "\" of the setting ", name);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Read the values of the settings file, leaving out the comments, the blank lines and the lines that aren't settings.
+   *
+   * @param filePath   The path to the settings file.
+   * @param newValues  The map to store the values to, by the names of their settings.
+   *
+   * @return Whether the settings file could be read.
+   */
+  static bool readValues(const std::string &filePath, std::map<const std::string, std::string> &newValues)
+  {
+    std::ifstream settingsFile(filePath);
+    if (!settingsFile.is_open())
+    {
+      return false;
+    }
+    const auto trim = [](const std::string &text) {
+      const auto first = text.find_first_not_of(" \t\r");
+      return first == std::string::npos ? std::string() : text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    };
+    std::string line;
+    for (uint32_t lineNumber = 1; std::getline(settingsFile, line); lineNumber++)
+    {
+      line = trim(line.substr(0, line.find('#')));
+      if (line.empty())
+      {
+        continue;
+      }
+      const auto separator = line.find('=');
+      if (separator == std::string::npos || trim(line.substr(0, separator)).empty())
+      {
+        Logger::getInstance().warning("Skipped line ", lineNumber, " of the settings file ", filePath, ", which isn't a setting");
+        continue;
+      }
+      newValues[trim(line.substr(0, separator))] = trim(line.substr(separator + 1));
+    }
+    return true;
+  }
+
+public:
+  // Preventing copying the settings manager, making sure only one instance can exist.
+  SettingsManager(const SettingsManager &) = delete;
+
+  /**
+   * Read a value of a setting, or of an option given on the command line.
+   *
+   * @param text   The text of the value.
+   * @param value  The value to store the read value to.
+   *
+   * @return Whether the text was a valid value.
+   */
+  template <typename T>
+  static bool parseValue(const std::string &text, T &value)
+  {
+    if constexpr (std::is_same_v<T, bool>)
+    {
+      if (text == "true" || text == "on" || text == "1")
+      {
+        value = true;
+        return true;
+      }
+      if (text == "false" || text == "off" || text == "0")
+      {
+        value = false;
+        return true;
+      }
+      return false;
+    }
+    else
+    {
+      // Unsigned values are read as signed ones first, so negative values aren't wrapped around, and integers too big for
+      //   their type aren't cut down to fit.
+      std::conditional_t<std::is_integral_v<T>, int64_t, double_t> parsedValue;
+      std::istringstream stream(text);
+      stream >> parsedValue;
+      if (stream.fail() || !stream.eof() || (std::is_unsigned_v<T> && parsedValue < 0))
+      {
+        return false;
+      }
+      if constexpr (std::is_integral_v<T> && sizeof(T) < sizeof(int64_t))
+      {
+        if (parsedValue < int64_t(std::numeric_limits<T>::lowest()) || parsedValue > int64_t(std::numeric_limits<T>::max()))
+        {
+          return false;
+        }
+      }
+      value = static_cast<T>(parsedValue);
+      return true;
+    }
+  }
+
+  /**
+   * Register a setting, applying the value of it in the settings file right away if there is one.
+   *
+   * @param name   The name of the setting.
+   * @param live   Whether the setting can be changed while the game runs.
+   * @param apply  Apply a value of the setting, returning whether it was a valid value.
+   */
+  void addSetting(const std::string &name, const bool &live, const std::function<bool(const std::string &)> &apply)
+  {
+    auto &setting = settings[name];
+    setting.live = live;
+    setting.apply = apply;
+    const auto value = values.find(name);
+    if (value != values.end())
+    {
+      applyValue(name, setting, value->second);
+    }
+  }
+
+  /**
+   * Register a setting holding a boolean or a number, given to a setter. A setter returning whether it took the value
+   *   can reject it, which is warned about like a value that can't be read.
+   *
+   * @param name    The name of the setting.
+   * @param live    Whether the setting can be changed while the game runs.
+   * @param setter  The function setting the value.
+   */
+  template <typename T, typename Setter>
+  void add(const std::string &name, const bool &live, const Setter &setter)
+  {
+    addSetting(name, live, [setter](const std::string &text) {
+      T value;
+      if (!parseValue(text, value))
+      {
+        return false;
+      }
+      if constexpr (std::is_same_v<std::invoke_result_t<Setter, const T &>, bool>)
+      {
+        return setter(value);
+      }
+      else
+      {
+        setter(value);
+        return true;
+      }
+    });
+  }
+
+  /**
+   * Register a setting holding a boolean or a number, stored to a global.
+   *
+   * @param name    The name of the setting.
+   * @param live    Whether the setting can be changed while the game runs.
+   * @param target  The global.
+   */
+  template <typename T>
+  void add(const std::string &name, const bool &live, T &target)
+  {
+    add<T>(name, live, [&target](const T &value) { target = value; });
+  }
+
+  /**
+   * Register a setting holding one of the given names, given to a setter as the index of the name.
+   *
+   * @param name    The name of the setting.
+   * @param live    Whether the setting can be changed while the game runs.
+   * @param names   The names the setting can hold.
+   * @param setter  The function setting the index of the name.
+   */
+  void addChoice(const std::string &name, const bool &live, const std::vector<std::string> &names, const std::function<void(const size_t &)> &setter)
+  {
+    addSetting(name, live, [names, setter](const std::string &text) {
+      for (size_t i = 0; i < names.size(); i++)
+      {
+        if (names[i] == text)
+        {
+          setter(i);
+          return true;
+        }
+      }
+      return false;
+    });
+  }
+
+  /**
+   * Add a function called after the value of a setting changed while the game runs, once it's applied.
+   *
+   * @param name      The name of the setting, which is registered if it isn't yet.
+   * @param listener  The function.
+   */
+  void addListener(const std::string &name, const std::function<void()> &listener)
+  {
+    settings[name].listeners.push_back(listener);
+  }
+
+  /**
+   * Load the settings file, applying the values of the settings already registered, and keeping the rest for when
+   *   they're registered. The file is watched for changes from then on.
+   *
+   * @param filePath  The path to the settings file.
+   *
+   * @return Whether the settings file could be read.
+   */
+  bool load(const std::string &filePath)
+  {
+    std::map<const std::string, std::string> newValues({});
+    if (!readValues(filePath, newValues))
+    {
+      Logger::getInstance().warning("Could not read the settings file ", filePath);
+      return false;
+    }
+    values = newValues;
+    for (const auto &value : values)
+    {
+      const auto setting = settings.find(value.first);
+      if (setting != settings.end() && setting->second.apply)
+      {
+        applyValue(value.first, setting->second, value.second);
+      }
+    }
+    settingsFilePath = filePath;
+    fileWatcher.watch("settings", {filePath});
+    Logger::getInstance().info("Loaded ", values.size(), " settings from ", filePath);
+    return true;
+  }
+
+  /**
+   * Check whether the settings file is due to be checked again, which it is every watch interval once one is loaded.
+   *
+   * @param currentTime  The time of the frame.
+   *
+   * @return Whether the settings file should be checked.
+   */
+  bool isCheckDue(const double_t &currentTime)
+  {
+    if (settingsFilePath.empty() || currentTime - lastCheckTime < ASSET_WATCH_INTERVAL)
+    {
+      return false;
+    }
+    lastCheckTime = currentTime;
+    return true;
+  }
+
+  /**
+   * Read the settings file again if it changed since it was last checked, applying the settings whose values changed
+   *   and calling their listeners. The listeners can make GL calls and replace what the models read while updating, so
+   *   this has to run with the GL context while the models aren't updating.
+   */
+  void reloadChangedSettings()
+  {
+    std::map<const std::string, std::string> newValues({});
+    if (fileWatcher.findChangedAssets().empty() || !readValues(settingsFilePath, newValues))
+    {
+      return;
+    }
+    for (const auto &newValue : newValues)
+    {
+      const auto value = values.find(newValue.first);
+      if (value != values.end() && value->second == newValue.second)
+      {
+        continue;
+      }
+      values[newValue.first] = newValue.second;
+      const auto setting = settings.find(newValue.first);
+      if (setting == settings.end() || !setting->second.apply)
+      {
+        Logger::getInstance().warning("Unknown setting ", newValue.first, " in the settings file ", settingsFilePath);
+      }
+      else if (!setting->second.live)
+      {
+        Logger::getInstance().warning("The setting ", newValue.first, " takes effect on the next start");
+      }
+      else if (applyValue(newValue.first, setting->second, newValue.second))
+      {
+        for (const auto &listener : setting->second.listeners)
+        {
+          listener();
+        }
+        Logger::getInstance().info("Changed the setting ", newValue.first, " to ", newValue.second);
+      }
+    }
+  }
+
+  /**
+   * Returns the singleton instance of the settings manager.
+   *
+   * @return The settings manager singleton instance.
+   */
+  static SettingsManager &getInstance()
+  {
+    // Singleton instance of the settings manager, constructed the first time it's asked for.
+    static SettingsManager instance;
+    return instance;
+  }
+};
+
+#endif
@@ -4,13 +4,52 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <memory>
-#include <iostream>
 #include <fstream>
 #include <sstream>
+#include <functional>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+
+#include <stdio.h>
+#include <string.h>
 
 #include <GL/glew.h>
 
+#include "gl_state.cpp"
+#include "constants.cpp"
+#include "residency.cpp"
+#include "file_watcher.cpp"
+#include "gl_debug.cpp"
+#include "asset_archive.cpp"
+#include "window.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for the header of a program binary file, which is followed by the driver identifier and then the program binary.
+ */
+struct ProgramBinaryFileHeader
+{
+	// The magic identifier of the file format, "GTSP".
+	char magic[4];
+	// The version of the file format.
+	uint32_t version;
+	// The hash of the source code of the shaders the program was linked from.
+	uint64_t sourceHash;
+	// The length of the driver identifier that follows the header.
+	uint32_t driverIdentifierLength;
+	// The format of the program binary, as reported by the driver.
+	uint32_t binaryFormat;
+	// The length of the program binary.
+	uint32_t binaryLength;
+	// Padding to keep the header size a multiple of 8 bytes.
+	uint32_t padding;
+};
+
+static_assert(sizeof(ProgramBinaryFileHeader) == 32, "Program binary file header must be tightly packed");
+
 /**
  * Class for containing the details of the shader.
  */
@@ -20,8 +59,12 @@ class ShaderDetails
 	friend class ShaderManager;
 
 private:
-	// The ID of the shader program.
-	const GLuint shaderId;
+	// The ID of the shader program, which the shader manager swaps in place when the shader files are reloaded, so every
+	//   model sharing the details draws with the reloaded program.
+	mutable GLuint shaderId;
+	// Whether the shader program is still being compiled and linked in parallel, in which case it's waited for the first
+	//   time its ID or uniform locations are asked for.
+	mutable bool pending;
 
 	// The name of the shader.
 	const std::string shaderName;
@@ -31,14 +74,30 @@ private:
 	const std::string geometryShaderFilePath;
 	// The file path to the fragment shader.
 	const std::string fragmentShaderFilePath;
+	// The preprocessor definitions inserted into the shaders, which are empty unless the shader program is a variant.
+	const std::string shaderDefines;
+	// The outputs of the vertex shader captured into buffers with transform feedback, in the order they're interleaved,
+	//   which are empty unless the shader program only advances state on the GPU without drawing anything.
+	const std::vector<std::string> transformFeedbackVaryings;
+	// The file path to the compute shader, which is empty unless the shader program is dispatched on its own instead of
+	//   drawing, in which case it's the program's only shader.
+	const std::string computeShaderFilePath;
+
+	// The locations of the active uniforms of the shader program, indexed by their uniform keys, swapped along with the ID.
+	mutable std::vector<GLint> uniformLocations;
 
 public:
-	ShaderDetails(const GLuint &shaderId, const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+	ShaderDetails(const GLuint &shaderId, const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath, const std::string &shaderDefines, const std::vector<GLint> &uniformLocations, const std::vector<std::string> &transformFeedbackVaryings = {}, const std::string &computeShaderFilePath = "")
 			: shaderId(shaderId),
+				pending(false),
 				shaderName(shaderName),
 				vertexShaderFilePath(vertexShaderFilePath),
 				geometryShaderFilePath(geometryShaderFilePath),
-				fragmentShaderFilePath(fragmentShaderFilePath) {}
+				fragmentShaderFilePath(fragmentShaderFilePath),
+				shaderDefines(shaderDefines),
+				transformFeedbackVaryings(transformFeedbackVaryings),
+				computeShaderFilePath(computeShaderFilePath),
+				uniformLocations(uniformLocations) {}
 
 	/**
    * Get the name of the shader program.
@@ -51,14 +110,30 @@ public:
 	}
 
 	/**
-   * Get the ID of the shader program.
+   * Get the ID of the shader program, waiting for it to finish linking if it's still being compiled in parallel.
    * 
    * @return The shader program ID.
    */
-	const GLuint &getShaderId() const
+	const GLuint &getShaderId() const;
+
+	/**
+   * Get the file path to the fragment shader of the shader program.
+   * 
+   * @return The fragment shader file path.
+   */
+	const std::string &getFragmentShaderFilePath() const
 	{
-		return shaderId;
+		return fragmentShaderFilePath;
 	}
+
+	/**
+	 * Get the location of a uniform of the shader program using its precomputed uniform key.
+	 * 
+	 * @param uniformKey  The key of the uniform, as returned by the shader manager.
+	 * 
+	 * @return The uniform location, or -1 if the shader program has no such active uniform.
+	 */
+	GLint getUniformLocation(const uint32_t &uniformKey) const;
 };
 
 /**
@@ -67,16 +142,138 @@ public:
 class ShaderManager
 {
 private:
-	// Singleton instance of the shader manager.
-	static ShaderManager instance;
+	// The binding points of the uniform blocks shared across shader programs.
+	const static std::map<const std::string, GLuint> uniformBlockBindings;
 
 	// A map of created shaders.
 	std::map<const std::string, const std::shared_ptr<const ShaderDetails>> namedShaders;
 	// A map counting the references to the created shaders.
 	std::map<const std::string, int32_t> namedShaderReferences;
+	// The shader programs with no more references that are kept resident until they're evicted.
+	ResidencyCache residentShaders;
+	// A map of the variants of the created shaders, by the name of the shader they were created from and then by the
+	//   preprocessor definitions they were asked for with. Variants live as long as the shader they were created from.
+	std::map<const std::string, std::map<const std::string, const std::shared_ptr<const ShaderDetails>>> shaderVariants;
+	// A map of the keys assigned to uniform names, shared by all shader programs.
+	std::map<const std::string, uint32_t> uniformKeys;
+	// The watcher of the shader files of the created shader programs, by the names of the shader programs.
+	FileWatcher shaderFileWatcher;
+
+	/**
+	 * Structure for a shader program submitted to be compiled and linked in parallel, whose results are checked once it's done.
+	 */
+	struct PendingProgram
+	{
+		// The IDs of the shaders linked into the shader program, deleted once it's checked.
+		std::vector<GLuint> shaderIds;
+		// The hash of the source code of the shaders, for saving the program binary once it's linked.
+		uint64_t sourceHash;
+	};
+
+	// The shader programs still being compiled and linked in parallel, by their details.
+	std::map<const ShaderDetails *, PendingProgram> pendingPrograms;
+	// The number of shader programs submitted to be compiled in parallel since the last time none were pending, and the
+	//   number of them that are done.
+	uint32_t requestedProgramsCount;
+	uint32_t completedProgramsCount;
+
+	// The magic identifier and version of the program binary file format.
+	static constexpr char programBinaryFileMagic[4] = {'G', 'T', 'S', 'P'};
+	static const uint32_t programBinaryFileVersion = 1;
+
+	/**
+	 * Get the preprocessor definitions shared by every shader, which carry the constants the shaders have to agree on
+	 * with the rest of the game, so they're only ever written down in the constants.
+	 * 
+	 * @return The shared preprocessor definitions, one "#define" per line.
+	 */
+	static std::string getSharedShaderDefines()
+	{
+		std::stringstream sharedShaderDefines;
+		// The sizes of the arrays of light details in the light uniform block.
+		sharedShaderDefines << "#define MAX_SIMPLE_LIGHTS " << MAX_CONE_LIGHTS << "\n"
+												<< "#define MAX_CUBE_LIGHTS " << MAX_POINT_LIGHTS << "\n"
+												<< "#define MAX_DIRECTIONAL_LIGHTS " << MAX_DIRECTIONAL_LIGHTS << "\n";
+		// The number of cascades the shadow map of each directional light is split into.
+		sharedShaderDefines << "#define SHADOW_CASCADES_COUNT " << SHADOW_CASCADES_COUNT << "\n";
+		// The number of layers of the cone light shadow atlas, which are the views of its multiview framebuffer.
+		sharedShaderDefines << "#define CONE_SHADOW_ATLAS_LAYERS " << CONE_SHADOW_ATLAS_LAYERS << "\n";
+		// The number of light clusters along the width, height and depth of the view frustum.
+		sharedShaderDefines << "#define CLUSTER_GRID_WIDTH " << LIGHT_CLUSTER_GRID_WIDTH << "\n"
+												<< "#define CLUSTER_GRID_HEIGHT " << LIGHT_CLUSTER_GRID_HEIGHT << "\n"
+												<< "#define CLUSTER_GRID_DEPTH " << LIGHT_CLUSTER_GRID_DEPTH << "\n";
+		// The number of particle emitters, the number of particles each of them owns, and how long the particles live for.
+		sharedShaderDefines << "#define MAX_PARTICLE_EMITTERS " << MAX_PARTICLE_EMITTERS << "\n"
+												<< "#define PARTICLES_PER_EMITTER " << PARTICLES_PER_EMITTER << "\n"
+												<< "#define PARTICLE_MAX_LIFETIME " << std::fixed << PARTICLE_MAX_LIFETIME << "\n";
+		return sharedShaderDefines.str();
+	}
+
+	/**
+	 * Read the shader code from the given shader file, replacing each "#include" directive with the code of the file it
+	 * names, found relative to the file including it. Each file is only included once, however many files include it,
+	 * which also stops files from including each other forever.
+	 * 
+	 * @param shaderName         The name of the shader program being loaded.
+	 * @param shaderFilePath     The file path to the shader code.
+	 * @param includedFilePaths  The file paths to the files included so far, which the included files are added to.
+	 * 
+	 * @return The shader code with the included files expanded.
+	 */
+	std::string expandShaderCode(const std::string &shaderName, const std::string &shaderFilePath, std::vector<std::string> &includedFilePaths)
+	{
+		// Go through the shader code line by line, looking for the include directives.
+		std::istringstream shaderCodeStream(readShaderFile(shaderName, shaderFilePath));
+		std::stringstream expandedShaderCode;
+		std::string shaderCodeLine;
+		while (std::getline(shaderCodeStream, shaderCodeLine))
+		{
+			const auto directivePosition = shaderCodeLine.find_first_not_of(" \t");
+			if (directivePosition == std::string::npos || shaderCodeLine.compare(directivePosition, 8, "#include") != 0)
+			{
+				expandedShaderCode << shaderCodeLine << "\n";
+				continue;
+			}
+
+			// Read the name of the included file from between the quotes.
+			const auto nameStartPosition = shaderCodeLine.find('"', directivePosition);
+			const auto nameEndPosition = nameStartPosition == std::string::npos ? std::string::npos : shaderCodeLine.find('"', nameStartPosition + 1);
+			if (nameEndPosition == std::string::npos)
+			{
+				// The directive doesn't name a file. Time to crash.
+				Logger::getInstance().error(shaderName, "\n", shaderFilePath, "\nFailed at shader include");
+				exit(1);
+			}
+			const auto includedFilePath = (std::filesystem::path(shaderFilePath).parent_path() / shaderCodeLine.substr(nameStartPosition + 1, nameEndPosition - nameStartPosition - 1)).lexically_normal().string();
+
+			// Expand the included file in place of the directive, unless it was already included.
+			if (std::find(includedFilePaths.begin(), includedFilePaths.end(), includedFilePath) == includedFilePaths.end())
+			{
+				includedFilePaths.push_back(includedFilePath);
+				expandedShaderCode << expandShaderCode(shaderName, includedFilePath, includedFilePaths);
+			}
+		}
+		return expandedShaderCode.str();
+	}
 
 	/**
-	 * Read the shader code from the given shader file.
+	 * Read the shader code from the given shader file, with the files it includes expanded and the shared preprocessor
+	 * definitions inserted.
+	 * 
+	 * @param shaderName         The name of the shader program being loaded.
+	 * @param shaderFilePath     The file path to the shader code.
+	 * @param includedFilePaths  The file paths to the files the shader code included, which are added to.
+	 * 
+	 * @return The shader code.
+	 */
+	std::string loadShaderCode(const std::string &shaderName, const std::string &shaderFilePath, std::vector<std::string> &includedFilePaths)
+	{
+		return insertShaderDefines(expandShaderCode(shaderName, shaderFilePath, includedFilePaths), getSharedShaderDefines());
+	}
+
+	/**
+	 * Read the shader code from the given shader file, with the files it includes expanded and the shared preprocessor
+	 * definitions inserted.
 	 * 
 	 * @param shaderName      The name of the shader program being loaded.
 	 * @param shaderFilePath  The file path to the shader code.
@@ -85,34 +282,64 @@ private:
 	 */
 	std::string loadShaderCode(const std::string &shaderName, const std::string &shaderFilePath)
 	{
-		// Create an input file stream for reading the shader file.
-		const std::ifstream shaderStream(shaderFilePath, std::ios::in);
-		// Check if the input file stream is open.
-		if (!shaderStream.is_open())
+		std::vector<std::string> includedFilePaths({});
+		return loadShaderCode(shaderName, shaderFilePath, includedFilePaths);
+	}
+
+	/**
+	 * Get the file paths to the files of the shader program, which are the files of its shaders and every file they
+	 * include, so editing an included file reloads the shader programs using it.
+	 * 
+	 * @param shaderName       The name of the shader program.
+	 * @param shaderFilePaths  The file paths to the source code of the shaders.
+	 * 
+	 * @return The file paths to the files of the shader program.
+	 */
+	std::vector<std::string> getShaderFilePaths(const std::string &shaderName, const std::vector<std::string> &shaderFilePaths)
+	{
+		std::vector<std::string> includedFilePaths({});
+		for (const auto &shaderFilePath : shaderFilePaths)
 		{
-			// Couldn't open the input file stream. Time to crash.
-			std::cout << shaderName << std::endl
-								<< "Failed at shader 1" << std::endl;
-			exit(1);
+			if (!shaderFilePath.empty())
+			{
+				loadShaderCode(shaderName, shaderFilePath, includedFilePaths);
+			}
 		}
+		includedFilePaths.insert(includedFilePaths.begin(), shaderFilePaths.begin(), shaderFilePaths.end());
+		return includedFilePaths;
+	}
 
-		// Define a stringstream to read the file contents into.
-		std::stringstream sstr;
-		// Push the contents of the input file stream into the string stream.
-		sstr << shaderStream.rdbuf();
+	/**
+	 * Read the contents of the given shader file as they are.
+	 * 
+	 * @param shaderName      The name of the shader program being loaded.
+	 * @param shaderFilePath  The file path to the shader code.
+	 * 
+	 * @return The contents of the shader file.
+	 */
+	static std::string readShaderFile(const std::string &shaderName, const std::string &shaderFilePath)
+	{
+		// Open the shader file, from the asset archive if it's packed in it.
+		AssetFile shaderFile;
+		// Check if the shader file is accessible.
+		if (!AssetFileSystem::getInstance().open(shaderFilePath, shaderFile))
+		{
+			// Couldn't open the shader file. Time to crash.
+			Logger::getInstance().error(shaderName, "\nFailed at shader 1");
+			exit(1);
+		}
 
-		// Return the string contents of the string stream.
-		return sstr.str();
+		// Return the contents of the shader file.
+		return std::string(reinterpret_cast<const char *>(shaderFile.getData()), shaderFile.getSize());
 	}
 
 	/**
-	 * Compiles the given shader code to the given shader.
+	 * Submits the given shader code to be compiled to the given shader, without waiting for the result.
 	 * 
-	 * @param shaderName  The name of the shader program being compiled.
 	 * @param shaderCode  The shader code.
 	 * @param shaderId    The ID of the shader.
 	 */
-	void compileShader(const std::string &shaderName, const std::string &shaderCode, const GLuint &shaderId)
+	void compileShader(const std::string &shaderCode, const GLuint &shaderId)
 	{
 		// Convert the shader source code string into a character array.
 		const auto sourcePointer = shaderCode.c_str();
@@ -120,7 +347,19 @@ private:
 		glShaderSource(shaderId, 1, &sourcePointer, NULL);
 		// Compile the shader.
 		glCompileShader(shaderId);
+	}
 
+	/**
+	 * Checks the result of compiling the given shader, waiting for it if it's still being compiled.
+	 * 
+	 * @param shaderName     The name of the shader program being compiled.
+	 * @param shaderId       The ID of the shader.
+	 * @param exitOnFailure  Whether to crash if the shader failed to compile, instead of reporting it.
+	 * 
+	 * @return Whether the shader compiled.
+	 */
+	bool checkShaderCompiled(const std::string &shaderName, const GLuint &shaderId, const bool &exitOnFailure)
+	{
 		// Define variables for capturing the compilation result information.
 		auto result = GL_FALSE;
 		int32_t infoLogLength;
@@ -133,20 +372,27 @@ private:
 			// There is an error. Time to crash.
 			std::vector<char> shaderErrorMessage(infoLogLength + 1);
 			glGetShaderInfoLog(shaderId, infoLogLength, NULL, &shaderErrorMessage[0]);
-			std::cout << shaderName << std::endl
-								<< &shaderErrorMessage[0] << std::endl
-								<< "Failed at shader 2" << std::endl;
-			exit(1);
+			Logger::getInstance().error(shaderName, "\n", &shaderErrorMessage[0], "\nFailed at shader 2");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return false;
 		}
+		return true;
 	}
 
 	/**
-	 * Creates a shader program using the list of given shaders (vertex, geometry, fragment).
+	 * Creates a shader program using the list of given shaders (vertex, geometry, fragment), and submits it to be linked
+	 * without waiting for the result. The shaders can still be compiling, in which case the link waits for them.
 	 * 
-	 * @param shaderName  The name of the shader program being compiled.
-	 * @param shaderIds   The IDs of the shaders to link together.
+	 * @param shaderIds                  The IDs of the shaders to link together.
+	 * @param transformFeedbackVaryings  The outputs of the vertex shader to capture with transform feedback, interleaved
+	 *                                   in the given order.
+	 * 
+	 * @return The ID of the shader program.
 	 */
-	GLuint createProgram(const std::string &shaderName, const std::vector<GLuint> &shaderIds)
+	GLuint createProgram(const std::vector<GLuint> &shaderIds, const std::vector<std::string> &transformFeedbackVaryings)
 	{
 		// Create a new shader program.
 		const auto programId = glCreateProgram();
@@ -156,9 +402,39 @@ private:
 			// Attach the shader to the main shader program.
 			glAttachShader(programId, shaderId);
 		}
+		// Name the outputs captured with transform feedback, which has to be done before the program is linked.
+		if (!transformFeedbackVaryings.empty())
+		{
+			std::vector<const char *> varyingNames({});
+			for (const auto &transformFeedbackVarying : transformFeedbackVaryings)
+			{
+				varyingNames.push_back(transformFeedbackVarying.c_str());
+			}
+			glTransformFeedbackVaryings(programId, varyingNames.size(), &varyingNames[0], GL_INTERLEAVED_ATTRIBS);
+		}
+		// Let the driver know the linked program will be read back for the program binary cache.
+		if (isProgramBinaryCacheSupported())
+		{
+			glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
 		// Link the shader together.
 		glLinkProgram(programId);
 
+		// Return the ID of the created shader program.
+		return programId;
+	}
+
+	/**
+	 * Checks the result of linking the given shader program, waiting for it if it's still being linked.
+	 * 
+	 * @param shaderName     The name of the shader program being linked.
+	 * @param programId      The ID of the shader program.
+	 * @param exitOnFailure  Whether to crash if the shader program failed to link, instead of reporting it.
+	 * 
+	 * @return Whether the shader program linked.
+	 */
+	bool checkProgramLinked(const std::string &shaderName, const GLuint &programId, const bool &exitOnFailure)
+	{
 		// Define variables for capturing the compilation result information.
 		auto result = GL_FALSE;
 		int32_t infoLogLength;
@@ -171,112 +447,611 @@ private:
 			// There is an error. Time to crash.
 			std::vector<char> programErrorMessage(infoLogLength + 1);
 			glGetProgramInfoLog(programId, infoLogLength, NULL, &programErrorMessage[0]);
-			std::cout << shaderName << std::endl
-								<< &programErrorMessage[0] << std::endl
-								<< "Failed at shader 3" << std::endl;
-			exit(1);
+			Logger::getInstance().error(shaderName, "\n", &programErrorMessage[0], "\nFailed at shader 3");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return false;
 		}
+		return true;
+	}
 
-		// Return the ID of the created shader program.
-		return programId;
+	/**
+	 * Binds the shared uniform blocks used by the linked shader program to their binding points.
+	 * 
+	 * @param programId  The ID of the linked shader program.
+	 */
+	void bindUniformBlocks(const GLuint &programId)
+	{
+		// Iterate through all the shared uniform blocks.
+		for (const auto &uniformBlockBinding : uniformBlockBindings)
+		{
+			// Check if the shader program uses the uniform block.
+			const auto uniformBlockIndex = glGetUniformBlockIndex(programId, uniformBlockBinding.first.c_str());
+			if (uniformBlockIndex != GL_INVALID_INDEX)
+			{
+				// If it does, connect the block to its binding point.
+				glUniformBlockBinding(programId, uniformBlockIndex, uniformBlockBinding.second);
+			}
+		}
 	}
 
 	/**
-	 * Loads a shader program using the given vertex shader file and fragment shader file.
+	 * Stores the location of a uniform in the list of uniform locations, under the key of the uniform name.
 	 * 
-	 * @param shaderName              The name of the shader program being loaded.
-	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
-	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 * @param uniformLocations  The list of uniform locations indexed by uniform keys.
+	 * @param uniformName       The name of the uniform.
+	 * @param uniformLocation   The location of the uniform.
+	 */
+	void storeUniformLocation(std::vector<GLint> &uniformLocations, const std::string &uniformName, const GLint &uniformLocation)
+	{
+		// Get the key of the uniform name.
+		const auto uniformKey = getUniformKey(uniformName);
+		// Grow the list of locations if required, marking the new slots as inactive uniforms.
+		if (uniformKey >= uniformLocations.size())
+		{
+			uniformLocations.resize(uniformKey + 1, -1);
+		}
+		// Store the location of the uniform.
+		uniformLocations[uniformKey] = uniformLocation;
+	}
+
+	/**
+	 * Reads the locations of all the active uniforms of the linked shader program.
 	 * 
-	 * @return The ID of the shader program.
+	 * @param programId  The ID of the linked shader program.
+	 * 
+	 * @return The list of uniform locations indexed by uniform keys.
 	 */
-	GLuint loadShaders(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath)
+	std::vector<GLint> loadUniformLocations(const GLuint &programId)
 	{
-		// Create a vertex shader.
-		const auto vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
-		// Create a fragment shader.
-		const auto fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);
+		// Define the list of uniform locations.
+		std::vector<GLint> uniformLocations({});
 
-		// Load the vertex shader code.
-		const auto vertexShaderCode = loadShaderCode(shaderName, vertexShaderFilePath);
-		// Load the fragment shader code.
-		const auto fragmentShaderCode = loadShaderCode(shaderName, fragmentShaderFilePath);
+		// Read the number of active uniforms and the length of the longest uniform name.
+		GLint activeUniformsCount = 0, maxUniformNameLength = 0;
+		glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &activeUniformsCount);
+		glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformNameLength);
 
-		// Compile the vertex shader code.
-		compileShader(shaderName, vertexShaderCode, vertexShaderId);
-		// Compile the fragment shader code.
-		compileShader(shaderName, fragmentShaderCode, fragmentShaderId);
+		// Define a buffer to read the uniform names into.
+		std::vector<char> uniformNameBuffer(maxUniformNameLength + 1);
+		// Iterate through all the active uniforms.
+		for (GLint i = 0; i < activeUniformsCount; i++)
+		{
+			// Read the name, size and type of the uniform.
+			GLsizei uniformNameLength = 0;
+			GLint uniformSize = 0;
+			GLenum uniformType;
+			glGetActiveUniform(programId, i, uniformNameBuffer.size(), &uniformNameLength, &uniformSize, &uniformType, &uniformNameBuffer[0]);
+			const std::string uniformName(&uniformNameBuffer[0], uniformNameLength);
 
-		// Create the shader program using the vertex shader and fragment shader.
-		const auto programId = createProgram(shaderName, std::vector<GLuint>({vertexShaderId, fragmentShaderId}));
+			// Get the location of the uniform. Uniforms inside uniform blocks have no location, so skip them.
+			const auto uniformLocation = glGetUniformLocation(programId, uniformName.c_str());
+			if (uniformLocation < 0)
+			{
+				continue;
+			}
 
-		// Detach and delete the vertex shader since it's no longer required.
-		glDetachShader(programId, vertexShaderId);
-		glDeleteShader(vertexShaderId);
+			// Store the location of the uniform under the name reported by the driver.
+			storeUniformLocation(uniformLocations, uniformName, uniformLocation);
 
-		// Detach and delete the fragment shader since it's no longer required.
-		glDetachShader(programId, fragmentShaderId);
-		glDeleteShader(fragmentShaderId);
+			// Arrays of primitives are reported only by their first element (e.g. "vpMatrices[0]").
+			const std::string arraySuffix = "[0]";
+			if (uniformName.size() > arraySuffix.size() && uniformName.compare(uniformName.size() - arraySuffix.size(), arraySuffix.size(), arraySuffix) == 0)
+			{
+				// Get the name of the array without the element suffix.
+				const auto arrayName = uniformName.substr(0, uniformName.size() - arraySuffix.size());
+				// The bare array name refers to the first element as well.
+				storeUniformLocation(uniformLocations, arrayName, uniformLocation);
+				// Store the locations of the rest of the elements of the array.
+				for (GLint j = 1; j < uniformSize; j++)
+				{
+					const auto elementName = arrayName + "[" + std::to_string(j) + "]";
+					storeUniformLocation(uniformLocations, elementName, glGetUniformLocation(programId, elementName.c_str()));
+				}
+			}
+		}
 
-		// Return the shader program ID.
+		// Return the list of uniform locations.
+		return uniformLocations;
+	}
+
+	/**
+	 * Check if the driver can save and load linked shader programs as program binaries.
+	 * 
+	 * @return Whether the program binary cache can be used.
+	 */
+	static bool isProgramBinaryCacheSupported()
+	{
+		// Check if program binaries are available through the core profile or the extension.
+		if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+		{
+			return false;
+		}
+		// Check if the driver supports at least one program binary format.
+		GLint binaryFormatsCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatsCount);
+		return binaryFormatsCount > 0;
+	}
+
+	/**
+	 * Get the string identifying the driver, since program binaries are only valid for the driver that created them.
+	 * 
+	 * @return The vendor, renderer and version strings of the driver.
+	 */
+	static std::string getDriverIdentifier()
+	{
+		return std::string((const char *)glGetString(GL_VENDOR)) + "\n" + (const char *)glGetString(GL_RENDERER) + "\n" + (const char *)glGetString(GL_VERSION);
+	}
+
+	/**
+	 * Hash the source code of the shaders of a shader program.
+	 * 
+	 * @param shaderCodes  The source code of the shaders, in the order they are linked.
+	 * 
+	 * @return The hash of the source code.
+	 */
+	static uint64_t hashShaderCodes(const std::vector<std::string> &shaderCodes)
+	{
+		uint64_t sourceHash = shaderCodes.size();
+		for (const auto &shaderCode : shaderCodes)
+		{
+			// Combine the hash of each shader code with the hashes of the previous ones.
+			sourceHash ^= std::hash<std::string>()(shaderCode) + 0x9e3779b97f4a7c15ull + (sourceHash << 6) + (sourceHash >> 2);
+		}
+		return sourceHash;
+	}
+
+	/**
+	 * Get the file path of the program binary file of the shader program. The characters of the name that aren't letters,
+	 * digits, dashes or underscores, such as the "::" between the parts of the name, are replaced with underscores, since
+	 * not every file system allows them in a file name. Names that end up the same only share a file, whose header keeps
+	 * the wrong one from being loaded.
+	 * 
+	 * @param shaderName  The name of the shader program.
+	 * 
+	 * @return The file path to the program binary file.
+	 */
+	static std::string getProgramBinaryFilePath(const std::string &shaderName)
+	{
+		auto fileName = shaderName;
+		for (auto &character : fileName)
+		{
+			if (!std::isalnum(static_cast<unsigned char>(character)) && character != '-' && character != '_')
+			{
+				character = '_';
+			}
+		}
+		return SHADER_CACHE_DIRECTORY + "/" + fileName + ".bin";
+	}
+
+	/**
+	 * Load the shader program from its program binary file, if the file was saved by the same driver from the same source code.
+	 * 
+	 * @param shaderName  The name of the shader program being loaded.
+	 * @param sourceHash  The hash of the source code of the shaders of the shader program.
+	 * 
+	 * @return The ID of the shader program, or 0 if the program binary file could not be used.
+	 */
+	GLuint loadProgramBinary(const std::string &shaderName, const uint64_t &sourceHash)
+	{
+		if (!isProgramBinaryCacheSupported())
+		{
+			return 0;
+		}
+
+		// Open the program binary file, if it exists.
+		const auto file = fopen(getProgramBinaryFilePath(shaderName).c_str(), "rb");
+		if (file == NULL)
+		{
+			return 0;
+		}
+
+		// Read the header and check that the file matches the source code and the driver.
+		const auto driverIdentifier = getDriverIdentifier();
+		ProgramBinaryFileHeader header;
+		std::string savedDriverIdentifier;
+		std::vector<char> binary;
+		auto valid = fread(&header, sizeof(header), 1, file) == 1 &&
+								 memcmp(header.magic, programBinaryFileMagic, sizeof(header.magic)) == 0 &&
+								 header.version == programBinaryFileVersion &&
+								 header.sourceHash == sourceHash &&
+								 header.driverIdentifierLength == driverIdentifier.size();
+		if (valid)
+		{
+			savedDriverIdentifier.resize(header.driverIdentifierLength);
+			binary.resize(header.binaryLength);
+			valid = fread(&savedDriverIdentifier[0], 1, savedDriverIdentifier.size(), file) == savedDriverIdentifier.size() &&
+							savedDriverIdentifier == driverIdentifier &&
+							header.binaryLength > 0 &&
+							fread(&binary[0], 1, binary.size(), file) == binary.size();
+		}
+		// Done reading the file, so close it.
+		fclose(file);
+		if (!valid)
+		{
+			return 0;
+		}
+
+		// Create the shader program from the binary, and check that the driver accepted it.
+		const auto programId = glCreateProgram();
+		glProgramBinary(programId, header.binaryFormat, &binary[0], binary.size());
+		auto result = GL_FALSE;
+		glGetProgramiv(programId, GL_LINK_STATUS, &result);
+		if (result != GL_TRUE)
+		{
+			// The driver rejected the binary, so the shader program needs to be compiled again.
+			GlStateCache::getInstance().deleteProgram(programId);
+			return 0;
+		}
+
+		// Connect the shared uniform blocks of the shader program to their binding points.
+		bindUniformBlocks(programId);
+
+		// Return the ID of the loaded shader program.
 		return programId;
 	}
 
 	/**
-	 * Loads a shader program using the given vertex shader file, geometry shader file and fragment shader file.
+	 * Save the linked shader program to its program binary file, so it can be loaded without compiling on later runs.
 	 * 
-	 * @param shaderName              The name of the shader program being loaded.
-	 * @param vertexShaderFilePath    The file path to the vertex shader source code.
-	 * @param geometryShaderFilePath  The file path to the geometry shader source code.
-	 * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+	 * @param shaderName  The name of the shader program.
+	 * @param sourceHash  The hash of the source code of the shaders of the shader program.
+	 * @param programId   The ID of the linked shader program.
+	 */
+	void saveProgramBinary(const std::string &shaderName, const uint64_t &sourceHash, const GLuint &programId)
+	{
+		if (!isProgramBinaryCacheSupported())
+		{
+			return;
+		}
+
+		// Read the program binary back from the driver.
+		GLint binaryLength = 0;
+		glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		if (binaryLength <= 0)
+		{
+			return;
+		}
+		std::vector<char> binary(binaryLength);
+		GLenum binaryFormat;
+		glGetProgramBinary(programId, binaryLength, &binaryLength, &binaryFormat, &binary[0]);
+
+		// Make sure the cache directory exists. Failing to save the cache only means compiling again on the next run.
+		std::error_code errorCode;
+		std::filesystem::create_directories(SHADER_CACHE_DIRECTORY, errorCode);
+		const auto programBinaryFilePath = getProgramBinaryFilePath(shaderName);
+		const auto temporaryFilePath = programBinaryFilePath + ".tmp";
+		const auto file = fopen(temporaryFilePath.c_str(), "wb");
+		if (file == NULL)
+		{
+			return;
+		}
+
+		// Write the header, the driver identifier and the program binary.
+		const auto driverIdentifier = getDriverIdentifier();
+		ProgramBinaryFileHeader header;
+		memcpy(header.magic, programBinaryFileMagic, sizeof(header.magic));
+		header.version = programBinaryFileVersion;
+		header.sourceHash = sourceHash;
+		header.driverIdentifierLength = driverIdentifier.size();
+		header.binaryFormat = binaryFormat;
+		header.binaryLength = binaryLength;
+		header.padding = 0;
+		const auto written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+												 fwrite(driverIdentifier.c_str(), 1, driverIdentifier.size(), file) == driverIdentifier.size() &&
+												 fwrite(&binary[0], 1, binaryLength, file) == (size_t)binaryLength;
+		fclose(file);
+
+		// Replace the old program binary file only if the new one was written completely.
+		if (written)
+		{
+			remove(programBinaryFilePath.c_str());
+			rename(temporaryFilePath.c_str(), programBinaryFilePath.c_str());
+		}
+		else
+		{
+			remove(temporaryFilePath.c_str());
+		}
+	}
+
+	/**
+	 * Insert the given preprocessor definitions into the shader code, right after its version directive, since nothing
+	 * else is allowed to come before the version directive.
 	 * 
-	 * @return The ID of the shader program.
+	 * @param shaderCode     The shader code.
+	 * @param shaderDefines  The preprocessor definitions to insert, one "#define" per line.
+	 * 
+	 * @return The shader code with the definitions inserted.
 	 */
-	GLuint loadShaders(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+	static std::string insertShaderDefines(const std::string &shaderCode, const std::string &shaderDefines)
 	{
-		// Create a vertex shader.
-		const auto vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
-		// Create a geometry shader.
-		const auto geometryShaderId = glCreateShader(GL_GEOMETRY_SHADER);
-		// Create a fragment shader.
-		const auto fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);
+		if (shaderDefines.empty())
+		{
+			return shaderCode;
+		}
+		// Find the end of the line with the version directive, if there is one.
+		const auto versionPosition = shaderCode.find("#version");
+		if (versionPosition == std::string::npos)
+		{
+			return shaderDefines + shaderCode;
+		}
+		const auto lineEndPosition = shaderCode.find('\n', versionPosition);
+		if (lineEndPosition == std::string::npos)
+		{
+			return shaderCode + "\n" + shaderDefines;
+		}
+		return shaderCode.substr(0, lineEndPosition + 1) + shaderDefines + shaderCode.substr(lineEndPosition + 1);
+	}
 
-		// Load the vertex shader code.
-		const auto vertexShaderCode = loadShaderCode(shaderName, vertexShaderFilePath);
-		// Load the geometry shader code.
-		const auto geometryShaderCode = loadShaderCode(shaderName, geometryShaderFilePath);
-		// Load the fragment shader code.
-		const auto fragmentShaderCode = loadShaderCode(shaderName, fragmentShaderFilePath);
+	/**
+	 * Submits a shader program using the given shader files, with the given preprocessor definitions inserted into each
+	 * of them, to be compiled and linked without waiting for the results, which the driver can work on in parallel. If
+	 * the program binary saved by an earlier run is still valid, the shader program is loaded from it instead, and there
+	 * are no shaders to wait for.
+	 * 
+	 * @param shaderName                 The name of the shader program being loaded.
+	 * @param shaderStageFilePaths       The types of the shaders (vertex, geometry, fragment) and the file paths to their source code,
+	 *                                   in the order they are linked.
+	 * @param shaderDefines              The preprocessor definitions to insert into the shader code.
+	 * @param transformFeedbackVaryings  The outputs of the vertex shader to capture with transform feedback, if any.
+	 * @param shaderIds                  The list to store the IDs of the submitted shaders to, which is left empty if the
+	 *                                   shader program was loaded from its program binary.
+	 * @param sourceHash                 The hash of the source code of the shaders, stored for saving the program binary.
+	 * 
+	 * @return The ID of the shader program.
+	 */
+	GLuint submitShaders(const std::string &shaderName, const std::vector<std::pair<GLenum, std::string>> &shaderStageFilePaths, const std::string &shaderDefines, const std::vector<std::string> &transformFeedbackVaryings, std::vector<GLuint> &shaderIds, uint64_t &sourceHash)
+	{
+		// Load the code of all the shaders.
+		std::vector<std::string> shaderCodes({});
+		for (const auto &shaderStageFilePath : shaderStageFilePaths)
+		{
+			shaderCodes.push_back(insertShaderDefines(loadShaderCode(shaderName, shaderStageFilePath.second), shaderDefines));
+		}
 
-		// Compile the vertex shader code.
-		compileShader(shaderName, vertexShaderCode, vertexShaderId);
-		// Compile the geometry shader code.
-		compileShader(shaderName, geometryShaderCode, geometryShaderId);
-		// Compile the fragment shader code.
-		compileShader(shaderName, fragmentShaderCode, fragmentShaderId);
+		// Use the program binary saved by an earlier run if it's still valid. The captured outputs are linked into the
+		//   binary, so they're hashed along with the code.
+		auto hashedCodes = shaderCodes;
+		hashedCodes.insert(hashedCodes.end(), transformFeedbackVaryings.begin(), transformFeedbackVaryings.end());
+		sourceHash = hashShaderCodes(hashedCodes);
+		const auto cachedProgramId = loadProgramBinary(shaderName, sourceHash);
+		if (cachedProgramId != 0)
+		{
+			GpuDebugLabels::labelObject(GL_PROGRAM, cachedProgramId, shaderName);
+			return cachedProgramId;
+		}
 
-		// Create the shader program using the vertex shader, geometry shader and fragment shader.
-		const auto programId = createProgram(shaderName, std::vector<GLuint>({vertexShaderId, geometryShaderId, fragmentShaderId}));
+		// Create and compile each of the shaders, and link them into the shader program.
+		for (unsigned long i = 0; i < shaderStageFilePaths.size(); i++)
+		{
+			shaderIds.push_back(glCreateShader(shaderStageFilePaths[i].first));
+			compileShader(shaderCodes[i], shaderIds[i]);
+		}
+		return createProgram(shaderIds, transformFeedbackVaryings);
+	}
 
-		// Detach and delete the vertex shader since it's no longer required.
-		glDetachShader(programId, vertexShaderId);
-		glDeleteShader(vertexShaderId);
+	/**
+	 * Checks the results of compiling and linking the submitted shader program, waiting for them if they aren't done,
+	 * deletes its shaders, and saves it to its program binary file.
+	 * 
+	 * @param shaderName     The name of the shader program being loaded.
+	 * @param programId      The ID of the shader program.
+	 * @param shaderIds      The IDs of the shaders linked into the shader program.
+	 * @param sourceHash     The hash of the source code of the shaders.
+	 * @param exitOnFailure  Whether to crash if the shaders failed to compile or link, instead of reporting it.
+	 * 
+	 * @return The ID of the shader program, or 0 if the shaders failed to compile or link.
+	 */
+	GLuint finishShaders(const std::string &shaderName, const GLuint &programId, const std::vector<GLuint> &shaderIds, const uint64_t &sourceHash, const bool &exitOnFailure)
+	{
+		// Report the first shader that failed to compile, or else whether the shader program failed to link.
+		auto linked = true;
+		for (unsigned long i = 0; i < shaderIds.size() && linked; i++)
+		{
+			linked = checkShaderCompiled(shaderName, shaderIds[i], exitOnFailure);
+		}
+		linked = linked && checkProgramLinked(shaderName, programId, exitOnFailure);
 
-		// Detach and delete the geometry shader since it's no longer required.
-		glDetachShader(programId, geometryShaderId);
-		glDeleteShader(geometryShaderId);
+		// Detach and delete the shaders since they're no longer required.
+		for (const auto &shaderId : shaderIds)
+		{
+			glDetachShader(programId, shaderId);
+			glDeleteShader(shaderId);
+		}
+		if (!linked)
+		{
+			GlStateCache::getInstance().deleteProgram(programId);
+			return 0;
+		}
 
-		// Detach and delete the fragment shader since it's no longer required.
-		glDetachShader(programId, fragmentShaderId);
-		glDeleteShader(fragmentShaderId);
+		// Connect the shared uniform blocks of the shader program to their binding points.
+		bindUniformBlocks(programId);
+		// Save the linked shader program so later runs can skip compiling it.
+		saveProgramBinary(shaderName, sourceHash, programId);
+		// Name the shader program for GPU captures.
+		GpuDebugLabels::labelObject(GL_PROGRAM, programId, shaderName);
 
 		// Return the shader program ID.
 		return programId;
 	}
 
+	/**
+	 * Loads a shader program using the given shader files, with the given preprocessor definitions inserted into each
+	 * of them, waiting for it to compile and link.
+	 * 
+	 * @param shaderName                 The name of the shader program being loaded.
+	 * @param shaderStageFilePaths       The types of the shaders (vertex, geometry, fragment) and the file paths to their source code,
+	 *                                   in the order they are linked.
+	 * @param shaderDefines              The preprocessor definitions to insert into the shader code.
+	 * @param exitOnFailure              Whether to crash if the shaders fail to compile or link, instead of reporting it.
+	 * @param transformFeedbackVaryings  The outputs of the vertex shader to capture with transform feedback, if any.
+	 * 
+	 * @return The ID of the shader program, or 0 if the shaders failed to compile or link.
+	 */
+	GLuint loadShaders(const std::string &shaderName, const std::vector<std::pair<GLenum, std::string>> &shaderStageFilePaths, const std::string &shaderDefines, const bool &exitOnFailure, const std::vector<std::string> &transformFeedbackVaryings = {})
+	{
+		std::vector<GLuint> shaderIds({});
+		uint64_t sourceHash = 0;
+		const auto programId = submitShaders(shaderName, shaderStageFilePaths, shaderDefines, transformFeedbackVaryings, shaderIds, sourceHash);
+		return shaderIds.empty() ? programId : finishShaders(shaderName, programId, shaderIds, sourceHash, exitOnFailure);
+	}
+
+	/**
+	 * Loads the shader program of the given details from its shader files. Where the driver compiles in parallel, the
+	 * shader program is only submitted, and left pending until it's done or it's used, so a scene can submit all of its
+	 * shader programs up front and only wait on the ones it draws with right away.
+	 * 
+	 * @param shaderDetails  The details of the shader program, whose ID and uniform locations are set.
+	 */
+	void loadShaderProgram(const ShaderDetails &shaderDetails)
+	{
+		std::vector<GLuint> shaderIds({});
+		uint64_t sourceHash = 0;
+		shaderDetails.shaderId = submitShaders(shaderDetails.shaderName, getShaderStageFilePaths(shaderDetails), shaderDetails.shaderDefines, shaderDetails.transformFeedbackVaryings, shaderIds, sourceHash);
+		if (!shaderIds.empty() && WindowManager::getInstance().isParallelShaderCompileSupported())
+		{
+			shaderDetails.pending = true;
+			pendingPrograms.insert(std::make_pair(&shaderDetails, PendingProgram{shaderIds, sourceHash}));
+			requestedProgramsCount++;
+			return;
+		}
+		if (!shaderIds.empty())
+		{
+			shaderDetails.shaderId = finishShaders(shaderDetails.shaderName, shaderDetails.shaderId, shaderIds, sourceHash, true);
+		}
+		shaderDetails.uniformLocations = loadUniformLocations(shaderDetails.shaderId);
+	}
+
+	/**
+	 * Stop waiting for the shader program if it's still being compiled in parallel, deleting its shaders, since the
+	 * shader program is about to be deleted.
+	 * 
+	 * @param shaderDetails  The details of the shader program.
+	 */
+	void discardPendingProgram(const ShaderDetails &shaderDetails)
+	{
+		const auto pendingProgram = pendingPrograms.find(&shaderDetails);
+		if (pendingProgram == pendingPrograms.end())
+		{
+			return;
+		}
+		for (const auto &shaderId : pendingProgram->second.shaderIds)
+		{
+			glDeleteShader(shaderId);
+		}
+		shaderDetails.pending = false;
+		pendingPrograms.erase(pendingProgram);
+		completePendingProgram();
+	}
+
+	/**
+	 * Count a pending shader program as done, starting the counts over once none are pending.
+	 */
+	void completePendingProgram()
+	{
+		completedProgramsCount++;
+		if (pendingPrograms.empty())
+		{
+			requestedProgramsCount = 0;
+			completedProgramsCount = 0;
+		}
+	}
+
+	/**
+	 * Get the types of the shaders of the shader program and the file paths to their source code, in the order they are linked.
+	 * 
+	 * @param shaderDetails  The details of the shader program.
+	 * 
+	 * @return The types of the shaders and the file paths to their source code.
+	 */
+	static std::vector<std::pair<GLenum, std::string>> getShaderStageFilePaths(const ShaderDetails &shaderDetails)
+	{
+		// The compute shader programs have no other shaders.
+		if (!shaderDetails.computeShaderFilePath.empty())
+		{
+			return {{GL_COMPUTE_SHADER, shaderDetails.computeShaderFilePath}};
+		}
+		std::vector<std::pair<GLenum, std::string>> shaderStageFilePaths({{GL_VERTEX_SHADER, shaderDetails.vertexShaderFilePath}});
+		if (!shaderDetails.geometryShaderFilePath.empty())
+		{
+			shaderStageFilePaths.push_back({GL_GEOMETRY_SHADER, shaderDetails.geometryShaderFilePath});
+		}
+		// The shader programs only advancing state with transform feedback have no fragment shader.
+		if (!shaderDetails.fragmentShaderFilePath.empty())
+		{
+			shaderStageFilePaths.push_back({GL_FRAGMENT_SHADER, shaderDetails.fragmentShaderFilePath});
+		}
+		return shaderStageFilePaths;
+	}
+
+	/**
+	 * Compile the shader program again from its shader files, and swap the new program into its details in place. If the
+	 *   shaders fail to compile, the error is reported and the last program is kept, so a mistake in a shader being worked
+	 *   on doesn't end the run.
+	 * 
+	 * @param shaderDetails  The details of the shader program to reload.
+	 * 
+	 * @return Whether the shader program was reloaded.
+	 */
+	bool reloadShaderProgram(const ShaderDetails &shaderDetails)
+	{
+		// The program being replaced has to be done before it's deleted.
+		finishPendingProgram(shaderDetails);
+		const auto programId = loadShaders(shaderDetails.shaderName, getShaderStageFilePaths(shaderDetails), shaderDetails.shaderDefines, false, shaderDetails.transformFeedbackVaryings);
+		if (programId == 0)
+		{
+			Logger::getInstance().warning(shaderDetails.shaderName, "\nFailed at reloading shader, keeping the last one");
+			return false;
+		}
+		// The driver keeps the old program until the commands drawing with it are done.
+		GlStateCache::getInstance().deleteProgram(shaderDetails.shaderId);
+		shaderDetails.shaderId = programId;
+		shaderDetails.uniformLocations = loadUniformLocations(programId);
+		return true;
+	}
+
+	/**
+	 * Deletes the shader program and all the variants created from it.
+	 * 
+	 * @param shaderDetails  The details of the shader program to delete.
+	 */
+	void deleteShaderProgram(const std::shared_ptr<const ShaderDetails> &shaderDetails)
+	{
+		// Delete the variants of the shader program. A variant can be stored under more than one set of definitions, and
+		//   definitions the shader program doesn't refer to give back the shader program itself, so delete each program once.
+		const auto variants = shaderVariants.find(shaderDetails->shaderName);
+		if (variants != shaderVariants.end())
+		{
+			std::set<GLuint> variantProgramIds({});
+			for (const auto &variant : variants->second)
+			{
+				discardPendingProgram(*variant.second);
+				variantProgramIds.insert(variant.second->shaderId);
+			}
+			variantProgramIds.erase(shaderDetails->shaderId);
+			for (const auto &variantProgramId : variantProgramIds)
+			{
+				GlStateCache::getInstance().deleteProgram(variantProgramId);
+			}
+			shaderVariants.erase(variants);
+		}
+		// Delete the shader program.
+		discardPendingProgram(*shaderDetails);
+		GlStateCache::getInstance().deleteProgram(shaderDetails->shaderId);
+	}
+
 	ShaderManager()
 			: namedShaders({}),
-				namedShaderReferences({}) {}
+				namedShaderReferences({}),
+				residentShaders(),
+				shaderVariants({}),
+				uniformKeys({}),
+				shaderFileWatcher(),
+				pendingPrograms({}),
+				requestedProgramsCount(0),
+				completedProgramsCount(0) {}
 
 public:
 	// Preventing copying the shader manager, making sure only one instance can exist.
@@ -298,19 +1073,19 @@ public:
 		const auto existingShader = namedShaders.find(shaderName);
 		if (existingShader != namedShaders.end())
 		{
-			// Shader already loaded. Increase its reference count and return it.
+			// Shader already loaded. Increase its reference count, keep it from being evicted, and return it.
 			namedShaderReferences[shaderName]++;
+			residentShaders.markUsed(shaderName);
 			return existingShader->second;
 		}
 
-		// Load the shader program and store its details.
-		const auto shaderProgramId = loadShaders(shaderName, vertexShaderFilePath, fragmentShaderFilePath);
-
-		// Create a new shader program details with the captured data.
-		const auto newShader = std::make_shared<const ShaderDetails>(shaderProgramId, shaderName, vertexShaderFilePath, "", fragmentShaderFilePath);
+		// Create a new shader program details, and load the shader program into it.
+		const auto newShader = std::make_shared<const ShaderDetails>(0, shaderName, vertexShaderFilePath, "", fragmentShaderFilePath, "", std::vector<GLint>({}));
+		loadShaderProgram(*newShader);
 
-		// Insert the newly created shader program into the map of created shader programs.
+		// Insert the newly created shader program into the map of created shader programs, and watch its shader files.
 		namedShaders.insert(std::make_pair(shaderName, newShader));
+		shaderFileWatcher.watch(shaderName, getShaderFilePaths(shaderName, {vertexShaderFilePath, fragmentShaderFilePath}));
 		// Set the reference count of the shader program to 1.
 		namedShaderReferences[shaderName] = 1;
 
@@ -335,19 +1110,92 @@ public:
 		const auto existingShader = namedShaders.find(shaderName);
 		if (existingShader != namedShaders.end())
 		{
-			// Shader already loaded. Increase its reference count and return it.
+			// Shader already loaded. Increase its reference count, keep it from being evicted, and return it.
+			namedShaderReferences[shaderName]++;
+			residentShaders.markUsed(shaderName);
+			return existingShader->second;
+		}
+
+		// Create a new shader program details, and load the shader program into it.
+		const auto newShader = std::make_shared<const ShaderDetails>(0, shaderName, vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath, "", std::vector<GLint>({}));
+		loadShaderProgram(*newShader);
+
+		// Insert the newly created shader program into the map of created shader programs, and watch its shader files.
+		namedShaders.insert(std::make_pair(shaderName, newShader));
+		shaderFileWatcher.watch(shaderName, getShaderFilePaths(shaderName, {vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath}));
+		// Set the reference count of the shader program to 1.
+		namedShaderReferences[shaderName] = 1;
+
+		// Return the shader program details.
+		return namedShaders[shaderName];
+	}
+
+	/**
+	 * Load and create a shader program with only a vertex shader, whose outputs are captured into buffers with transform
+	 * feedback instead of being drawn, for advancing state on the GPU. If a shader program with the same name was already
+	 * created, return the same shader program.
+	 * 
+	 * @param shaderName                 The name of the shader program being loaded.
+	 * @param vertexShaderFilePath       The file path to the vertex shader source code.
+	 * @param transformFeedbackVaryings  The outputs of the vertex shader to capture, interleaved in the given order.
+	 * 
+	 * @return The details of the loaded shader program.
+	 */
+	const std::shared_ptr<const ShaderDetails> &createTransformFeedbackProgram(const std::string &shaderName, const std::string &vertexShaderFilePath, const std::vector<std::string> &transformFeedbackVaryings)
+	{
+		// Check if an shader program with the name already exists.
+		const auto existingShader = namedShaders.find(shaderName);
+		if (existingShader != namedShaders.end())
+		{
+			// Shader already loaded. Increase its reference count, keep it from being evicted, and return it.
 			namedShaderReferences[shaderName]++;
+			residentShaders.markUsed(shaderName);
 			return existingShader->second;
 		}
 
-		// Load the shader program and store its details.
-		const auto shaderProgramId = loadShaders(shaderName, vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath);
+		// Create a new shader program details, and load the shader program into it.
+		const auto newShader = std::make_shared<const ShaderDetails>(0, shaderName, vertexShaderFilePath, "", "", "", std::vector<GLint>({}), transformFeedbackVaryings);
+		loadShaderProgram(*newShader);
+
+		// Insert the newly created shader program into the map of created shader programs, and watch its shader file.
+		namedShaders.insert(std::make_pair(shaderName, newShader));
+		shaderFileWatcher.watch(shaderName, getShaderFilePaths(shaderName, {vertexShaderFilePath}));
+		// Set the reference count of the shader program to 1.
+		namedShaderReferences[shaderName] = 1;
+
+		// Return the shader program details.
+		return namedShaders[shaderName];
+	}
+
+	/**
+	 * Load and create a shader program with only a compute shader, dispatched on its own for working on buffers on the
+	 * GPU. If a shader program with the same name was already created, return the same shader program. Must only be
+	 * called where compute shaders are supported.
+	 * 
+	 * @param shaderName             The name of the shader program being loaded.
+	 * @param computeShaderFilePath  The file path to the compute shader source code.
+	 * 
+	 * @return The details of the loaded shader program.
+	 */
+	const std::shared_ptr<const ShaderDetails> &createComputeProgram(const std::string &shaderName, const std::string &computeShaderFilePath)
+	{
+		// Check if an shader program with the name already exists.
+		const auto existingShader = namedShaders.find(shaderName);
+		if (existingShader != namedShaders.end())
+		{
+			// Shader already loaded. Increase its reference count, keep it from being evicted, and return it.
+			namedShaderReferences[shaderName]++;
+			residentShaders.markUsed(shaderName);
+			return existingShader->second;
+		}
 
-		// Create a new shader program details with the captured data.
-		const auto newShader = std::make_shared<const ShaderDetails>(shaderProgramId, shaderName, vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath);
+		// Create a new shader program details with the compute shader as its only shader, and load the shader program into it.
+		const auto newShader = std::make_shared<const ShaderDetails>(0, shaderName, "", "", "", "", std::vector<GLint>({}), std::vector<std::string>({}), computeShaderFilePath);
+		loadShaderProgram(*newShader);
 
-		// Insert the newly created shader program into the map of created shader programs.
+		// Insert the newly created shader program into the map of created shader programs, and watch its shader file.
 		namedShaders.insert(std::make_pair(shaderName, newShader));
+		shaderFileWatcher.watch(shaderName, getShaderFilePaths(shaderName, {computeShaderFilePath}));
 		// Set the reference count of the shader program to 1.
 		namedShaderReferences[shaderName] = 1;
 
@@ -355,6 +1203,117 @@ public:
 		return namedShaders[shaderName];
 	}
 
+	/**
+	 * Get the key of the given uniform name, assigning a new key if the name hasn't been seen before.
+	 * The key is the same across all shader programs, so it can be computed once and used to look up
+	 * uniform locations without any string work.
+	 * 
+	 * @param uniformName  The name of the uniform.
+	 * 
+	 * @return The key of the uniform.
+	 */
+	uint32_t getUniformKey(const std::string &uniformName)
+	{
+		// Check if the uniform name already has a key.
+		const auto existingUniformKey = uniformKeys.find(uniformName);
+		if (existingUniformKey != uniformKeys.end())
+		{
+			return existingUniformKey->second;
+		}
+
+		// Assign the next free key to the uniform name.
+		const uint32_t newUniformKey = uniformKeys.size();
+		uniformKeys.insert(std::make_pair(uniformName, newUniformKey));
+
+		// Return the new key.
+		return newUniformKey;
+	}
+
+	/**
+	 * Keep only the preprocessor definitions whose names appear in the code of the shaders of the shader program, since
+	 * the rest can't change the compiled program and would only create duplicate variants.
+	 * 
+	 * @param shaderDetails  The details of the shader program.
+	 * @param shaderDefines  The preprocessor definitions, one "#define" per line.
+	 * 
+	 * @return The preprocessor definitions the shader program refers to.
+	 */
+	std::string filterShaderDefines(const ShaderDetails &shaderDetails, const std::string &shaderDefines)
+	{
+		// Load the code of all the shaders of the shader program.
+		std::string shaderCodes = loadShaderCode(shaderDetails.shaderName, shaderDetails.vertexShaderFilePath) + loadShaderCode(shaderDetails.shaderName, shaderDetails.fragmentShaderFilePath);
+		if (!shaderDetails.geometryShaderFilePath.empty())
+		{
+			shaderCodes += loadShaderCode(shaderDetails.shaderName, shaderDetails.geometryShaderFilePath);
+		}
+
+		// Go through the definitions line by line.
+		std::string usedShaderDefines;
+		std::istringstream shaderDefinesStream(shaderDefines);
+		std::string shaderDefine;
+		while (std::getline(shaderDefinesStream, shaderDefine))
+		{
+			// Read the name of the definition, and keep the definition if the shader code refers to the name.
+			std::istringstream shaderDefineStream(shaderDefine);
+			std::string directive, defineName;
+			shaderDefineStream >> directive >> defineName;
+			if (!defineName.empty() && shaderCodes.find(defineName) != std::string::npos)
+			{
+				usedShaderDefines += shaderDefine + "\n";
+			}
+		}
+		return usedShaderDefines;
+	}
+
+	/**
+	 * Return the variant of the given shader program compiled with the given preprocessor definitions inserted into all
+	 * of its shaders, creating it the first time it's asked for. Definitions the shaders don't refer to are ignored, and
+	 * without any definitions left, the shader program itself is returned.
+	 * 
+	 * @param shaderDetails  The details of the shader program to get the variant of.
+	 * @param shaderDefines  The preprocessor definitions of the variant, one "#define" per line.
+	 * 
+	 * @return The details of the variant of the shader program.
+	 */
+	const std::shared_ptr<const ShaderDetails> &getShaderVariant(const std::shared_ptr<const ShaderDetails> &shaderDetails, const std::string &shaderDefines)
+	{
+		if (shaderDefines.empty())
+		{
+			return shaderDetails;
+		}
+
+		// Check if the variant was already asked for with the same definitions.
+		auto &variants = shaderVariants[shaderDetails->shaderName];
+		const auto existingVariant = variants.find(shaderDefines);
+		if (existingVariant != variants.end())
+		{
+			return existingVariant->second;
+		}
+
+		// Find the definitions that make a difference, and check if a variant was already created for them.
+		const auto usedShaderDefines = filterShaderDefines(*shaderDetails, shaderDefines);
+		if (usedShaderDefines.empty())
+		{
+			return variants.insert(std::make_pair(shaderDefines, shaderDetails)).first->second;
+		}
+		const auto existingUsedVariant = variants.find(usedShaderDefines);
+		if (existingUsedVariant != variants.end())
+		{
+			return variants.insert(std::make_pair(shaderDefines, existingUsedVariant->second)).first->second;
+		}
+
+		// Name the variant after the shader program and its definitions, which also keeps its program binary file apart.
+		std::stringstream variantName;
+		variantName << shaderDetails->shaderName << "::Variant" << std::hex << std::hash<std::string>()(usedShaderDefines);
+
+		// Create the variant details, load the variant into them from the same shader files as the shader program, and store
+		//   it under both sets of definitions.
+		const auto newVariant = std::make_shared<const ShaderDetails>(0, variantName.str(), shaderDetails->vertexShaderFilePath, shaderDetails->geometryShaderFilePath, shaderDetails->fragmentShaderFilePath, usedShaderDefines, std::vector<GLint>({}));
+		loadShaderProgram(*newVariant);
+		variants.insert(std::make_pair(usedShaderDefines, newVariant));
+		return variants.insert(std::make_pair(shaderDefines, newVariant)).first->second;
+	}
+
 	/**
    * Return the shader program created with the given name.
    * 
@@ -368,7 +1327,8 @@ public:
 	}
 
 	/**
-	 * Delete a reference to the shader program, and destroy it if no more references are present.
+	 * Delete a reference to the shader program. Once no more references are present, the shader program is kept resident
+	 * so it can be reused, and the least recently used unused shader programs are destroyed if they go over the residency budget.
 	 * 
 	 * @param shaderDetails  The details of the shader program to destroy.
 	 */
@@ -379,14 +1339,129 @@ public:
 		// Check if there are no more references to the shader program.
 		if (namedShaderReferences[shaderDetails->getShaderName()] <= 0)
 		{
-			// No more references left, so time to clean.
-			// Remove the shader program from the created shader programs references map.
+			// No more references left, so remove the shader program from the created shader programs references map and keep it resident.
 			namedShaderReferences.erase(shaderDetails->getShaderName());
-			// Remove the shader program from the created shader programs map.
-			namedShaders.erase(shaderDetails->getShaderName());
-			// Delete the shader program.
-			glDeleteProgram(shaderDetails->shaderId);
+			residentShaders.markUnused(shaderDetails->getShaderName(), 1);
+			// Destroy the unused shader programs that don't fit in the residency budget.
+			for (const auto &evictedShaderName : residentShaders.evict(SHADER_RESIDENCY_BUDGET))
+			{
+				// Keep the shader program details alive until the shader program is deleted.
+				const auto evictedShader = namedShaders.at(evictedShaderName);
+				// Remove the shader program from the created shader programs map, and stop watching its shader files.
+				namedShaders.erase(evictedShaderName);
+				shaderFileWatcher.unwatch(evictedShaderName);
+				// Delete the shader program along with its variants.
+				deleteShaderProgram(evictedShader);
+			}
+		}
+	}
+
+	/**
+	 * Wait for the shader program to finish compiling and linking if it's still pending, checking the results and reading
+	 * its uniform locations.
+	 * 
+	 * @param shaderDetails  The details of the shader program.
+	 */
+	void finishPendingProgram(const ShaderDetails &shaderDetails)
+	{
+		const auto pendingProgram = pendingPrograms.find(&shaderDetails);
+		if (pendingProgram == pendingPrograms.end())
+		{
+			return;
+		}
+		shaderDetails.pending = false;
+		shaderDetails.shaderId = finishShaders(shaderDetails.shaderName, shaderDetails.shaderId, pendingProgram->second.shaderIds, pendingProgram->second.sourceHash, true);
+		shaderDetails.uniformLocations = loadUniformLocations(shaderDetails.shaderId);
+		pendingPrograms.erase(pendingProgram);
+		completePendingProgram();
+	}
+
+	/**
+	 * Finish the pending shader programs the driver is done compiling and linking, without waiting for the rest.
+	 */
+	void processPendingPrograms()
+	{
+		for (auto pendingProgramIt = pendingPrograms.begin(); pendingProgramIt != pendingPrograms.end();)
+		{
+			// Move on before finishing the shader program, which removes it.
+			const auto &shaderDetails = *(pendingProgramIt++)->first;
+			auto completed = GL_FALSE;
+			glGetProgramiv(shaderDetails.shaderId, GL_COMPLETION_STATUS_ARB, &completed);
+			if (completed == GL_TRUE)
+			{
+				finishPendingProgram(shaderDetails);
+			}
+		}
+	}
+
+	/**
+	 * Wait for all the pending shader programs to finish compiling and linking.
+	 */
+	void finishPendingPrograms()
+	{
+		while (!pendingPrograms.empty())
+		{
+			finishPendingProgram(*pendingPrograms.begin()->first);
+		}
+	}
+
+	/**
+	 * Check if any shader programs are still being compiled and linked in parallel.
+	 * 
+	 * @return Whether there are pending shader programs.
+	 */
+	bool hasPendingPrograms() const
+	{
+		return !pendingPrograms.empty();
+	}
+
+	/**
+	 * Get the progress of the shader programs being compiled and linked in parallel.
+	 * 
+	 * @return The fraction of the submitted shader programs that are done, from 0 to 1.
+	 */
+	float getPendingProgramProgress() const
+	{
+		return requestedProgramsCount == 0 ? 1.0f : float(completedProgramsCount) / requestedProgramsCount;
+	}
+
+	/**
+	 * Reload the shader programs whose shader files changed since they were last checked, along with their variants. The
+	 *   programs are swapped into the details every model already shares, so nothing has to ask for them again.
+	 * 
+	 * @return The names of the reloaded shader programs.
+	 */
+	std::vector<std::string> reloadChangedShaders()
+	{
+		std::vector<std::string> reloadedShaderNames({});
+		for (const auto &shaderName : shaderFileWatcher.findChangedAssets())
+		{
+			const auto &shaderDetails = namedShaders.at(shaderName);
+			if (!reloadShaderProgram(*shaderDetails))
+			{
+				continue;
+			}
+			reloadedShaderNames.push_back(shaderName);
+			// Watch the files the shaders include now, since the edit could have changed them.
+			shaderFileWatcher.watch(shaderName, getShaderFilePaths(shaderName, {shaderDetails->vertexShaderFilePath, shaderDetails->geometryShaderFilePath, shaderDetails->fragmentShaderFilePath}));
+
+			// Reload each variant once, since a variant can be stored under more than one set of definitions, and the shader
+			//   program itself is stored for the definitions it doesn't refer to.
+			const auto variants = shaderVariants.find(shaderName);
+			if (variants == shaderVariants.end())
+			{
+				continue;
+			}
+			std::set<const ShaderDetails *> reloadedVariants({shaderDetails.get()});
+			for (const auto &variant : variants->second)
+			{
+				if (reloadedVariants.insert(variant.second.get()).second)
+				{
+					reloadShaderProgram(*variant.second);
+				}
+			}
 		}
+		return reloadedShaderNames;
 	}
 
 	/**
@@ -396,11 +1471,35 @@ public:
    */
 	static ShaderManager &getInstance()
 	{
+		// Singleton instance of the shader manager, constructed the first time it's asked for.
+		static ShaderManager instance;
 		return instance;
 	}
 };
 
-// Initialize the shader manager singleton instance static variable.
-ShaderManager ShaderManager::instance;
+inline const GLuint &ShaderDetails::getShaderId() const
+{
+	// The shader program is needed right away, so wait for it if it's still pending.
+	if (pending)
+	{
+		ShaderManager::getInstance().finishPendingProgram(*this);
+	}
+	return shaderId;
+}
+
+inline GLint ShaderDetails::getUniformLocation(const uint32_t &uniformKey) const
+{
+	if (pending)
+	{
+		ShaderManager::getInstance().finishPendingProgram(*this);
+	}
+	// Keys registered after this shader program was linked can never be active uniforms of it.
+	return uniformKey < uniformLocations.size() ? uniformLocations[uniformKey] : -1;
+}
+
+// Initialize the shared uniform block binding points static variable.
+const std::map<const std::string, GLuint> ShaderManager::uniformBlockBindings({{"LightUniformBlock", LIGHT_UNIFORM_BLOCK_BINDING},
+                                                                                       {"CameraUniformBlock", CAMERA_UNIFORM_BLOCK_BINDING},
+                                                                                       {"FrameUniformBlock", FRAME_UNIFORM_BLOCK_BINDING}});
 
 #endif
\ No newline at end of file
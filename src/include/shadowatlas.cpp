@@ -0,0 +1,216 @@
+#ifndef INCLUDE_SHADOWATLAS_CPP
+#define INCLUDE_SHADOWATLAS_CPP
+
+#include <vector>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+/**
+ * Structure for defining a square tile of a layer of a shadow atlas.
+ */
+struct ShadowAtlasTile
+{
+  // The ID of the layer of the atlas the tile is in.
+  uint32_t layerId;
+  // The position of the bottom-left corner of the tile in the layer, in texels.
+  uint32_t x;
+  uint32_t y;
+  // The width and height of the tile, in texels.
+  uint32_t size;
+
+  bool operator==(const ShadowAtlasTile &other) const
+  {
+    return layerId == other.layerId && x == other.x && y == other.y && size == other.size;
+  }
+};
+
+/**
+ * Class for handing out square tiles from the layers of a shadow atlas, so lights can have shadow maps of different sizes
+ * sharing the same texture layers. Each level of tiles is half the size of the level before it, starting from the size
+ * of a whole layer, and tiles are always placed at multiples of their own size, so a freed tile can be reused by any
+ * tile of the same size or smaller.
+ */
+class ShadowAtlas
+{
+private:
+  // The width and height of a layer of the atlas, in texels.
+  uint32_t layerSize;
+  // The number of layers in the atlas, which grows when the atlas runs out of space.
+  uint32_t layersCount;
+  // The number of tile sizes, with the smallest tiles being the layer size halved one less than this many times.
+  const uint32_t levelsCount;
+
+  // The tiles handed out from each layer.
+  std::vector<std::vector<ShadowAtlasTile>> allocatedTiles;
+
+  /**
+   * Check if the area of the given tile is free in its layer.
+   *
+   * @param tile  The tile to check.
+   *
+   * @return Whether the tile overlaps no handed out tiles.
+   */
+  bool isTileFree(const ShadowAtlasTile &tile) const
+  {
+    for (const auto &allocatedTile : allocatedTiles[tile.layerId])
+    {
+      if (tile.x < allocatedTile.x + allocatedTile.size && allocatedTile.x < tile.x + tile.size &&
+          tile.y < allocatedTile.y + allocatedTile.size && allocatedTile.y < tile.y + tile.size)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+public:
+  ShadowAtlas(const uint32_t &layerSize, const uint32_t &layersCount, const uint32_t &levelsCount)
+      : layerSize(layerSize),
+        layersCount(layersCount),
+        levelsCount(std::max(1u, levelsCount)),
+        allocatedTiles(layersCount) {}
+
+  /**
+   * Get the width and height of a layer of the atlas.
+   *
+   * @return The size of a layer, in texels.
+   */
+  const uint32_t &getLayerSize() const
+  {
+    return layerSize;
+  }
+
+  /**
+   * Get the number of layers in the atlas.
+   *
+   * @return The number of layers.
+   */
+  const uint32_t &getLayersCount() const
+  {
+    return layersCount;
+  }
+
+  /**
+   * Add empty layers to the atlas, keeping the tiles handed out from the layers it had.
+   *
+   * @param newLayersCount  The number of layers, which is left as it is if there are more layers already.
+   */
+  void grow(const uint32_t &newLayersCount)
+  {
+    layersCount = std::max(layersCount, newLayersCount);
+    allocatedTiles.resize(layersCount);
+  }
+
+  /**
+   * Change the width and height of the layers of the atlas, taking back every tile handed out, since they no longer
+   * cover the same texels.
+   *
+   * @param newLayerSize  The width and height of a layer, in texels.
+   */
+  void resize(const uint32_t &newLayerSize)
+  {
+    layerSize = newLayerSize;
+    for (auto &layerTiles : allocatedTiles)
+    {
+      layerTiles.clear();
+    }
+  }
+
+  /**
+   * Get the width and height of the tiles of the given level.
+   *
+   * @param level  The level of the tiles.
+   *
+   * @return The size of the tiles, in texels.
+   */
+  uint32_t getTileSize(const uint32_t &level) const
+  {
+    return std::max(1u, layerSize >> level);
+  }
+
+  /**
+   * Get the level of the smallest tiles that are at least the given size, or the level of the smallest tiles if they're
+   * all bigger.
+   *
+   * @param size  The width and height needed, in texels.
+   *
+   * @return The level of the tiles.
+   */
+  uint32_t getTileLevel(const uint32_t &size) const
+  {
+    uint32_t level = 0;
+    while (level + 1 < levelsCount && getTileSize(level + 1) >= size)
+    {
+      level++;
+    }
+    return level;
+  }
+
+  /**
+   * Hand out a free tile of the given level, or the biggest free tile of a smaller level if there is no space left for it.
+   *
+   * @param level                The level of the tile wanted.
+   * @param tile                 The tile to store the handed out tile to.
+   * @param smallerTilesAllowed  Whether a smaller tile can be handed out when there's no space left for one of the level.
+   *
+   * @return Whether a tile could be handed out.
+   */
+  bool allocateTile(const uint32_t &level, ShadowAtlasTile &tile, const bool &smallerTilesAllowed = true)
+  {
+    // Try the given level first, then fall back to smaller tiles.
+    const auto firstLevel = std::min(level, levelsCount - 1);
+    const auto lastLevel = smallerTilesAllowed ? levelsCount - 1 : firstLevel;
+    for (auto currentLevel = firstLevel; currentLevel <= lastLevel; currentLevel++)
+    {
+      const auto size = getTileSize(currentLevel);
+      // Take the first free position in any layer, filling each layer before moving on to the next.
+      for (uint32_t layerId = 0; layerId < layersCount; layerId++)
+      {
+        for (uint32_t y = 0; y + size <= layerSize; y += size)
+        {
+          for (uint32_t x = 0; x + size <= layerSize; x += size)
+          {
+            const ShadowAtlasTile candidateTile = {layerId, x, y, size};
+            if (isTileFree(candidateTile))
+            {
+              allocatedTiles[layerId].push_back(candidateTile);
+              tile = candidateTile;
+              return true;
+            }
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Give back a tile handed out earlier, so its area can be reused.
+   *
+   * @param tile  The tile to release.
+   */
+  void releaseTile(const ShadowAtlasTile &tile)
+  {
+    auto &layerTiles = allocatedTiles[tile.layerId];
+    const auto allocatedTile = std::find(layerTiles.begin(), layerTiles.end(), tile);
+    if (allocatedTile != layerTiles.end())
+    {
+      layerTiles.erase(allocatedTile);
+    }
+  }
+
+  /**
+   * Get the area the tile covers in its layer as texture coordinates.
+   *
+   * @param tile  The tile.
+   *
+   * @return The bottom-left (x, y) and top-right (z, w) texture coordinates of the tile.
+   */
+  glm::vec4 getTileBounds(const ShadowAtlasTile &tile) const
+  {
+    return glm::vec4(tile.x, tile.y, tile.x + tile.size, tile.y + tile.size) / static_cast<float_t>(layerSize);
+  }
+};
+
+#endif
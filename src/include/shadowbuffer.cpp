@@ -3,14 +3,19 @@
 
 #include <string>
 #include <map>
-#include <set>
+#include <array>
 #include <memory>
 #include <limits>
+#include <algorithm>
 
 #include <GL/glew.h>
 
+#include "gl_state.cpp"
 #include "constants.cpp"
 #include "window.cpp"
+#include "shadowatlas.cpp"
+#include "memory.cpp"
+#include "log.cpp"
 
 /**
  * Enum of supported shadow buffer types.
@@ -18,9 +23,33 @@
 enum ShadowBufferType
 {
   CONE,
-  POINT
+  POINT,
+  DIRECTIONAL
 };
 
+// The number of types of shadow buffers.
+const uint32_t SHADOW_BUFFER_TYPES_COUNT = ShadowBufferType::DIRECTIONAL + 1;
+
+/**
+ * Array holding a value for each type of shadow buffer, indexed by the type.
+ */
+template <typename T>
+using ShadowBufferTypeArray = std::array<T, SHADOW_BUFFER_TYPES_COUNT>;
+
+/**
+ * Enum of the precisions the shadow maps can store their depths in.
+ */
+enum class ShadowDepthFormat
+{
+  DEPTH_16,
+  DEPTH_24,
+  DEPTH_32F
+};
+
+// The precision of the depths of the shadow maps. 16 bit depths halve the memory the shadow passes write and the shadow
+//   lookups read compared to the other formats, at the cost of more shadow acne on large light ranges.
+const ShadowDepthFormat SHADOW_DEPTH_FORMAT = ShadowDepthFormat::DEPTH_24;
+
 /**
  * Class for containing the details of the shadow buffer.
  */
@@ -32,12 +61,15 @@ class ShadowBufferDetails
 private:
   // The ID of the shadow buffer.
   const GLuint shadowBufferId;
-  // The ID of the texture array the shadow buffer copies data to in a layer.
-  const GLuint shadowBufferTextureArrayId;
-  // The ID of the layer of the texture array that the shadow buffer data is stored in.
-  const uint32_t shadowBufferTextureArrayLayerId;
+  // The ID of the texture array the shadow buffer copies data to in a layer, which changes when the array is reallocated.
+  GLuint shadowBufferTextureArrayId;
   // The type of the shadow buffer.
   const ShadowBufferType shadowBufferType;
+  // The tile of the shadow atlas that the shadow buffer data is stored in. For point lights, the tile is in a cube map,
+  // and is at the same place in each of its faces, and for directional lights it's at the same place in each cascade.
+  ShadowAtlasTile shadowBufferTile;
+  // The level of the tile size last requested for the shadow buffer, which may be bigger than the tile it got.
+  uint32_t requestedTileLevel;
 
   // The name of the shadow buffer.
   const std::string shadowBufferName;
@@ -46,13 +78,15 @@ public:
   ShadowBufferDetails(
       const GLuint &shadowBufferId,
       const GLuint &shadowBufferTextureArrayId,
-      const uint32_t &shadowBufferTextureArrayLayerId,
+      const ShadowAtlasTile &shadowBufferTile,
+      const uint32_t &requestedTileLevel,
       const std::string &shadowBufferName,
       const ShadowBufferType &shadowBufferType)
       : shadowBufferId(shadowBufferId),
         shadowBufferTextureArrayId(shadowBufferTextureArrayId),
-        shadowBufferTextureArrayLayerId(shadowBufferTextureArrayLayerId),
         shadowBufferType(shadowBufferType),
+        shadowBufferTile(shadowBufferTile),
+        requestedTileLevel(requestedTileLevel),
         shadowBufferName(shadowBufferName) {}
 
   /**
@@ -76,13 +110,32 @@ public:
   }
 
   /**
-   * Get the ID of the layer of the texture array that the shadow buffer data is stored in.
+   * Get the ID of the layer of the texture array that the shadow buffer data is stored in. For point lights, this is the
+   * layer of the first face of the cube map, and for directional lights the layer of the first cascade.
    * 
    * @return The layer ID.
    */
-  const GLuint &getShadowBufferTextureArrayLayerId() const
+  GLuint getShadowBufferTextureArrayLayerId() const
+  {
+    switch (shadowBufferType)
+    {
+    case POINT:
+      return 6 * shadowBufferTile.layerId;
+    case DIRECTIONAL:
+      return SHADOW_CASCADES_COUNT * shadowBufferTile.layerId;
+    default:
+      return shadowBufferTile.layerId;
+    }
+  }
+
+  /**
+   * Get the tile of the shadow atlas that the shadow buffer data is stored in.
+   * 
+   * @return The shadow atlas tile.
+   */
+  const ShadowAtlasTile &getShadowBufferTile() const
   {
-    return shadowBufferTextureArrayLayerId;
+    return shadowBufferTile;
   }
 
   /**
@@ -115,99 +168,322 @@ private:
   // The number of faces in a cube map.
   const static unsigned short facesPerCubeMap;
 
-  // Singleton instance of the shadow buffer manager.
-  static ShadowBufferManager instance;
-
   // A map of created textures.
-  std::map<const std::string, const std::shared_ptr<const ShadowBufferDetails>> namedShadowBuffers;
+  CountedMap<const std::string, const std::shared_ptr<ShadowBufferDetails>, MemorySubsystem::SHADOW_BUFFERS> namedShadowBuffers;
   // A map counting the references to the created textures.
-  std::map<const std::string, int32_t> namedShadowBufferReferences;
+  CountedMap<const std::string, int32_t, MemorySubsystem::SHADOW_BUFFERS> namedShadowBufferReferences;
 
   // The texture ID of the texture array for cone lights.
-  const GLuint coneLightTextureArrayId;
+  GLuint coneLightTextureArrayId;
   // The shadow framebuffer ID that the texture array for cone lights is attached to.
   const GLuint coneLightShadowBufferId;
-  // The set of layer IDs being used in the texture array for cone lights.
-  static std::set<uint32_t> assignedConeLightTextureArrayLayerIds;
+  // The atlas handing out the tiles of the texture array for cone lights.
+  ShadowAtlas coneLightShadowAtlas;
 
   // The texture ID of the texture array for point lights.
-  const GLuint pointLightTextureArrayId;
+  GLuint pointLightTextureArrayId;
   // The shadow framebuffer ID that the texture array for point lights is attached to.
   const GLuint pointLightShadowBufferId;
-  // The set of layer IDs being used in the texture array for point lights.
-  static std::set<uint32_t> assignedPointLightTextureArrayLayerIds;
+  // The atlas handing out the tiles of the cube maps of the texture array for point lights.
+  ShadowAtlas pointLightShadowAtlas;
+
+  // The texture ID of the texture array for directional lights.
+  GLuint directionalLightTextureArrayId;
+  // The shadow framebuffer ID that the texture array for directional lights is attached to.
+  const GLuint directionalLightShadowBufferId;
+  // The atlas handing out the tiles of the stacks of cascades of the texture array for directional lights.
+  ShadowAtlas directionalLightShadowAtlas;
+
+  // The framebuffer used to clear single layers of the texture arrays.
+  const GLuint layerClearBufferId;
+
+  // The number of times the contents of the shadow maps were lost, such as when a texture array was reallocated
+  //   without copying its layers over, after which every shadow map needs rendering again.
+  uint64_t contentsGeneration;
+
+  // The IDs of the texture arrays keeping the shadow maps as they were with only their static casters drawn, laid out
+  //   the same as the texture arrays of the shadow atlases so each shadow map keeps its tile, or 0 for the types of
+  //   shadow buffer that haven't cached any yet.
+  ShadowBufferTypeArray<GLuint> staticCasterTextureArrayIds;
+  // The number of times the cached static casters of the shadow maps were lost, which happens whenever a shadow atlas
+  //   is reallocated, since the texture arrays they're cached in are discarded along with it.
+  uint64_t staticCasterGeneration;
+
+  /**
+   * Create a framebuffer for clearing single layers of the texture arrays, which are attached to it when they're cleared.
+   * 
+   * @return The ID of the framebuffer.
+   */
+  static GLuint createLayerClearBuffer()
+  {
+    GLuint layerClearBufferId;
+    glGenFramebuffers(1, &layerClearBufferId);
+    // Tell OpenGL not to read or draw color data.
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, layerClearBufferId);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    return layerClearBufferId;
+  }
+
+  /**
+   * Get the shadow atlas that hands out the tiles for the given type of shadow buffer.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * 
+   * @return The shadow atlas.
+   */
+  ShadowAtlas &getShadowAtlas(const ShadowBufferType &shadowBufferType)
+  {
+    switch (shadowBufferType)
+    {
+    case POINT:
+      return pointLightShadowAtlas;
+    case DIRECTIONAL:
+      return directionalLightShadowAtlas;
+    default:
+      return coneLightShadowAtlas;
+    }
+  }
+
+
+  /**
+   * Get the ID of the texture array of the given type of shadow buffer.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * 
+   * @return The ID of the texture array.
+   */
+  GLuint &getTextureArrayId(const ShadowBufferType &shadowBufferType)
+  {
+    return shadowBufferType == POINT ? pointLightTextureArrayId : (shadowBufferType == DIRECTIONAL ? directionalLightTextureArrayId : coneLightTextureArrayId);
+  }
+
+  /**
+   * Get the number of layers of the texture array making up a layer of the shadow atlas of the given type of shadow
+   * buffer, which is a layer for each face of a cube map for point lights, and for each cascade for directional lights.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * 
+   * @return The number of layers of the texture array.
+   */
+  static uint32_t getTextureLayersPerAtlasLayer(const ShadowBufferType &shadowBufferType)
+  {
+    return shadowBufferType == POINT ? facesPerCubeMap : (shadowBufferType == DIRECTIONAL ? SHADOW_CASCADES_COUNT : 1);
+  }
+
+  /**
+   * Get the most layers the shadow atlas of the given type of shadow buffer grows to.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * 
+   * @return The number of layers of the shadow atlas.
+   */
+  static uint32_t getMaxAtlasLayersCount(const ShadowBufferType &shadowBufferType)
+  {
+    return shadowBufferType == POINT ? POINT_SHADOW_ATLAS_MAX_LAYERS : (shadowBufferType == DIRECTIONAL ? DIRECTIONAL_SHADOW_ATLAS_MAX_LAYERS : CONE_SHADOW_ATLAS_MAX_LAYERS);
+  }
+
+  /**
+   * Get the GPU memory used by a texture array of the given type of shadow buffer.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * @param layerSize         The width and height of the layers of the shadow atlas, in texels.
+   * @param atlasLayersCount  The number of layers of the shadow atlas.
+   * 
+   * @return The size in bytes.
+   */
+  static uint64_t getTextureArrayMemorySize(const ShadowBufferType &shadowBufferType, const uint64_t &layerSize, const uint64_t &atlasLayersCount)
+  {
+    return layerSize * layerSize * atlasLayersCount * getTextureLayersPerAtlasLayer(shadowBufferType) * getDepthTexelSize();
+  }
+
+  /**
+   * Initialize a texture array for the given type of shadow buffer.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * @param layerSize         The width and height of the layers of the shadow atlas, in texels.
+   * @param atlasLayersCount  The number of layers of the shadow atlas.
+   * 
+   * @return The ID of the texture array.
+   */
+  GLuint initializeTextureArrays(const ShadowBufferType &shadowBufferType, const GLsizei &layerSize, const GLsizei &atlasLayersCount)
+  {
+    if (shadowBufferType == POINT)
+    {
+      return initializePointLightTextureArrays(layerSize, atlasLayersCount);
+    }
+    return initializeFlatTextureArrays(layerSize, atlasLayersCount * getTextureLayersPerAtlasLayer(shadowBufferType));
+  }
 
   /**
-   * Finds a free layer ID in the shadow map texture array that can be assigned to a cone light and returns it.
+   * Replace the texture array of the given type of shadow buffer, deleting the one it had and attaching the new one to
+   * the same shadow framebuffer, so the shadow buffers of the type only need to be given its ID.
    * 
-   * @return Index of an available layer in the cone light shadow map texture array.
+   * @param shadowBufferType   The type of the shadow buffer.
+   * @param newTextureArrayId  The ID of the new texture array.
    */
-  uint32_t createNewConeLightLayerId()
+  void replaceTextureArray(const ShadowBufferType &shadowBufferType, const GLuint &newTextureArrayId)
   {
-    // Iterate through all possible indices for layers in the cone light shadow map texture array.
-    for (uint32_t i = 0; i < MAX_CONE_LIGHTS; i++)
+    auto &textureArrayId = getTextureArrayId(shadowBufferType);
+    GlStateCache::getInstance().deleteTextures(1, &textureArrayId);
+    textureArrayId = newTextureArrayId;
+    const auto &shadowBufferId = shadowBufferType == POINT ? pointLightShadowBufferId : (shadowBufferType == DIRECTIONAL ? directionalLightShadowBufferId : coneLightShadowBufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, shadowBufferId);
+    attachShadowTextureArray(shadowBufferType, textureArrayId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    for (const auto &namedShadowBuffer : namedShadowBuffers)
     {
-      // Check if the index is already in use.
-      if (assignedConeLightTextureArrayLayerIds.find(i) != assignedConeLightTextureArrayLayerIds.end())
+      if (namedShadowBuffer.second->shadowBufferType == shadowBufferType)
       {
-        // If it is, skip it.
-        continue;
+        namedShadowBuffer.second->shadowBufferTextureArrayId = textureArrayId;
       }
-
-      // The current index is available. Mark it as in-use and return it.
-      assignedConeLightTextureArrayLayerIds.insert(i);
-      return i;
     }
+  }
 
-    // Could not find any available index. Time to crash.
-    std::cout << "Failed at shadowbuffer 1" << std::endl;
-    exit(1);
+  /**
+   * Discard the texture array the static casters of the given type of shadow buffer are cached in, if there is one,
+   * which is created again at the size of the shadow atlas the next time they're cached.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   */
+  void discardStaticCasters(const ShadowBufferType &shadowBufferType)
+  {
+    auto &staticCasterTextureArrayId = staticCasterTextureArrayIds[shadowBufferType];
+    if (staticCasterTextureArrayId != 0)
+    {
+      GlStateCache::getInstance().deleteTextures(1, &staticCasterTextureArrayId);
+      staticCasterTextureArrayId = 0;
+      staticCasterGeneration++;
+    }
   }
 
   /**
-   * Finds a free layer ID in the shadow map texture array that can be assigned to a point light and returns it.
+   * Copy the faces of the tile of the shadow buffer from one texture array of its type to another.
    * 
-   * @return Index of an available layer in the point light shadow map texture array.
+   * @param shadowBufferDetails     The details of the shadow buffer.
+   * @param sourceTextureArrayId    The ID of the texture array to copy from.
+   * @param targetTextureArrayId    The ID of the texture array to copy to.
+   * @param facesMask               The mask of the faces of the shadow buffer to copy, with a bit for each face.
    */
-  uint32_t createNewPointLightLayerId()
+  static void copyShadowBufferFaces(const ShadowBufferDetails &shadowBufferDetails, const GLuint &sourceTextureArrayId, const GLuint &targetTextureArrayId, const GLuint &facesMask)
   {
-    // Iterate through all possible indices for layers in the point light shadow map texture array.
-    for (uint32_t i = 0; i < MAX_POINT_LIGHTS; i++)
+    const auto &shadowBufferType = shadowBufferDetails.getShadowBufferType();
+    const auto target = shadowBufferType == POINT ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY;
+    const auto &tile = shadowBufferDetails.getShadowBufferTile();
+    for (uint32_t i = 0; i < getTextureLayersPerAtlasLayer(shadowBufferType); i++)
     {
-      // Check if the index is already in use.
-      if (assignedPointLightTextureArrayLayerIds.find(i) != assignedPointLightTextureArrayLayerIds.end())
+      if ((facesMask & (1u << i)) == 0)
       {
-        // If it is, skip it.
         continue;
       }
+      const auto layerId = shadowBufferDetails.getShadowBufferTextureArrayLayerId() + i;
+      glCopyImageSubData(sourceTextureArrayId, target, 0, tile.x, tile.y, layerId, targetTextureArrayId, target, 0, tile.x, tile.y, layerId, tile.size, tile.size, 1);
+    }
+  }
+
+  /**
+   * Grow the shadow atlas of the given type of shadow buffer to twice its layers, as long as it stays within its most
+   * layers and the shadow atlases stay within their memory budget. The layers it had are copied into the new texture
+   * array if the GPU can copy between textures, and are lost otherwise. The static casters cached of the type are lost
+   * either way, and the memory they take once they're cached again is counted against the budget.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * 
+   * @return Whether the shadow atlas grew.
+   */
+  bool growShadowAtlas(const ShadowBufferType &shadowBufferType)
+  {
+    auto &shadowAtlas = getShadowAtlas(shadowBufferType);
+    const auto layersCount = shadowAtlas.getLayersCount();
+    const auto newLayersCount = std::min(2 * layersCount, getMaxAtlasLayersCount(shadowBufferType));
+    const auto layerSize = shadowAtlas.getLayerSize();
+    const auto copiesCount = staticCasterTextureArrayIds[shadowBufferType] != 0 ? 2 : 1;
+    const auto newMemorySize = getGpuMemorySize() + copiesCount * getTextureArrayMemorySize(shadowBufferType, layerSize, newLayersCount - layersCount);
+    if (newLayersCount <= layersCount || newMemorySize > SHADOW_ATLAS_MEMORY_BUDGET)
+    {
+      return false;
+    }
 
-      // The current index is available. Mark it as in-use and return it.
-      assignedPointLightTextureArrayLayerIds.insert(i);
-      return facesPerCubeMap * i;
+    const auto newTextureArrayId = initializeTextureArrays(shadowBufferType, layerSize, newLayersCount);
+    if (WindowManager::getInstance().isCopyImageSupported())
+    {
+      // Copy every layer the texture array had, which keeps the shadow maps in them as they were rendered.
+      const auto target = shadowBufferType == POINT ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY;
+      glCopyImageSubData(getTextureArrayId(shadowBufferType), target, 0, 0, 0, 0, newTextureArrayId, target, 0, 0, 0, 0, layerSize, layerSize, layersCount * getTextureLayersPerAtlasLayer(shadowBufferType));
+    }
+    else
+    {
+      contentsGeneration++;
+    }
+    replaceTextureArray(shadowBufferType, newTextureArrayId);
+    discardStaticCasters(shadowBufferType);
+    shadowAtlas.grow(newLayersCount);
+    Logger::getInstance().info("Grew the ", shadowBufferType == POINT ? "point" : (shadowBufferType == DIRECTIONAL ? "directional" : "cone"), " light shadow atlas to ", newLayersCount, " layers");
+    return true;
+  }
+
+  /**
+   * Finds a free tile in the shadow atlas for the given type of shadow buffer, falling back to a smaller tile if there
+   * is no space left for one of the given level. If it's allowed to, the shadow atlas grows before it settles for a
+   * smaller tile.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * @param tileLevel         The level of the tile size wanted.
+   * @param growthAllowed     Whether the shadow atlas can grow to fit the tile.
+   * @param tile              The tile to store the tile assigned to the shadow buffer to.
+   * 
+   * @return Whether a tile could be assigned, which it can't when even the smallest tile doesn't fit.
+   */
+  bool createNewTile(const ShadowBufferType &shadowBufferType, const uint32_t &tileLevel, const bool &growthAllowed, ShadowAtlasTile &tile)
+  {
+    auto &shadowAtlas = getShadowAtlas(shadowBufferType);
+    while (growthAllowed && !shadowAtlas.allocateTile(tileLevel, tile, false))
+    {
+      if (!growShadowAtlas(shadowBufferType))
+      {
+        return shadowAtlas.allocateTile(tileLevel, tile);
+      }
     }
+    return growthAllowed || shadowAtlas.allocateTile(tileLevel, tile);
+  }
 
-    // Could not find any available index. Time to crash.
-    std::cout << "Failed at shadowbuffer 2" << std::endl;
-    exit(1);
+  /**
+   * Attach the texture array of a type of shadow buffer to the bound framebuffer as its depth attachment. The cone light
+   * shadow atlas is attached with a view for each of its layers where multiview is supported, so the cone lights are
+   * all rendered in a single pass, and every other texture array as a layered attachment.
+   * 
+   * @param shadowBufferType            The type of the shadow buffer.
+   * @param shadowBufferTextureArrayId  The ID of the texture array to attach.
+   */
+  static void attachShadowTextureArray(const ShadowBufferType &shadowBufferType, const GLuint &shadowBufferTextureArrayId)
+  {
+    if (shadowBufferType == CONE && WindowManager::getInstance().isMultiviewSupported())
+    {
+      glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferTextureArrayId, 0, 0, CONE_SHADOW_ATLAS_LAYERS);
+      return;
+    }
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferTextureArrayId, 0);
   }
 
   /**
 	 * Create a shadow framebuffer that can capture the depth values of objects drawn to it.
 	 * 
+	 * @param shadowBufferType            The type of the shadow buffers drawn to the framebuffer.
 	 * @param shadowBufferTextureArrayId  The ID of the texture array to attach.
 	 * 
 	 * @return The ID of the depth texture.
 	 */
-  GLuint createShadowBuffer(const GLuint &shadowBufferTextureArrayId)
+  GLuint createShadowBuffer(const ShadowBufferType &shadowBufferType, const GLuint &shadowBufferTextureArrayId)
   {
     // Define a variable for storing the framebuffer ID.
     GLuint shadowBufferId;
     // Create a new texture and store the framebuffer ID.
     glGenFramebuffers(1, &shadowBufferId);
     // Bind the framebuffer.
-    glBindFramebuffer(GL_FRAMEBUFFER, shadowBufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, shadowBufferId);
     // Attach the depth texture array as the depth texture for the bounded framebuffer.
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferTextureArrayId, 0);
+    attachShadowTextureArray(shadowBufferType, shadowBufferTextureArrayId);
 
     // Tell OpenGL not to read or draw color data.
     glDrawBuffer(GL_NONE);
@@ -217,32 +493,98 @@ private:
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
       // Framebuffer is not ready. Time to crash.
-      std::cout << "Failed at shadow buffer 3" << std::endl;
+      Logger::getInstance().error("Failed at shadow buffer 3");
       exit(1);
     }
 
     // Unbind the framebuffer now that we're done.
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Return the ID of the created framebuffer.
     return shadowBufferId;
   }
 
   /**
-   * Initialize the cone light shadow map texture array to which cone light
-   *   shadow maps are drawn to.
+   * Get the sized internal format of the shadow maps, for the precision they store their depths in.
+   * 
+   * @return The internal format.
    */
-  GLuint initializeConeLightTextureArrays()
+  static GLenum getDepthInternalFormat()
+  {
+    switch (SHADOW_DEPTH_FORMAT)
+    {
+    case ShadowDepthFormat::DEPTH_16:
+      return GL_DEPTH_COMPONENT16;
+    case ShadowDepthFormat::DEPTH_32F:
+      return GL_DEPTH_COMPONENT32F;
+    default:
+      return GL_DEPTH_COMPONENT24;
+    }
+  }
+
+  /**
+   * Get the size of a texel of the shadow maps. 24 bit depths are taken as 4 bytes, which is what drivers store them in.
+   * 
+   * @return The size in bytes.
+   */
+  static uint64_t getDepthTexelSize()
+  {
+    return SHADOW_DEPTH_FORMAT == ShadowDepthFormat::DEPTH_16 ? 2 : 4;
+  }
+
+  /**
+   * Allocate the layers of the bound texture array, with immutable storage if supported.
+   * 
+   * @param target       The target the texture array is bound to.
+   * @param layerSize    The width and height of the layers, in texels.
+   * @param layersCount  The number of layers, which is a layer for each face of each cube map of cube map arrays.
+   */
+  static void allocateTextureArray(const GLenum &target, const GLsizei &layerSize, const GLsizei &layersCount)
+  {
+    if (WindowManager::getInstance().isTextureStorageSupported())
+    {
+      glTexStorage3D(target, 1, getDepthInternalFormat(), layerSize, layerSize, layersCount);
+    }
+    else
+    {
+      glTexImage3D(target, 0, getDepthInternalFormat(), layerSize, layerSize, layersCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    }
+  }
+
+  /**
+   * Initialize a 2D shadow map texture array, to which the cone light shadow
+   *   maps or the directional light cascades are drawn to.
+   * 
+   * @param layerSize    The width and height of the layers of the texture array, in texels.
+   * @param layersCount  The number of layers of the texture array.
+   */
+  GLuint initializeFlatTextureArrays(const GLsizei &layerSize, const GLsizei &layersCount)
   {
     GLuint newTextureId;
+    // The black depth read outside the layers, which marks those coordinates as always being in shadow.
+    GLfloat outsideMapDepth[] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      // Create the texture array with immutable storage, and set it up without binding it.
+      glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &newTextureId);
+      glTextureStorage3D(newTextureId, 1, getDepthInternalFormat(), layerSize, layerSize, layersCount);
+      glTextureParameteri(newTextureId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+      glTextureParameteri(newTextureId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+      glTextureParameteri(newTextureId, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTextureParameteri(newTextureId, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTextureParameterfv(newTextureId, GL_TEXTURE_BORDER_COLOR, outsideMapDepth);
+      return newTextureId;
+    }
+
     // Generate a new texture.
     glGenTextures(1, &newTextureId);
 
     // Bind the texture as a 2D image texture array.
-    glBindTexture(GL_TEXTURE_2D_ARRAY, newTextureId);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, newTextureId);
     // Define the size of an image, number of images (layers), and the type of data
     //   being drawn to the texture array as a whole.
-    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT, MAX_CONE_LIGHTS, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    allocateTextureArray(GL_TEXTURE_2D_ARRAY, layerSize, layersCount);
 
     // Provide parameters for behaviour when reading coordinates that are out-of-bounds,
     //   as well as algorithms to use for maginifcation and minification.
@@ -256,37 +598,46 @@ private:
     //   are clamped to the border, this will make sure that when the texture is
     //   queried for out-of-bounds coordinates, a black color is returned, which
     //   will mark those coordinates as always being in shadow.
-    GLfloat outsideMapDepth[] = {0.0f, 0.0f, 0.0f};
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, outsideMapDepth);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, outsideMapDepth);
 
     // Unbind the texture now that we're done.
-    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
-    // Generate a shadow framebuffer for the cone light texture array and save the ID.
+    // Return the ID of the texture array, for generating its shadow framebuffer.
     return newTextureId;
   }
 
-  GLuint initializePointLightTextureArrays()
+  /**
+   * Initialize a cube map shadow map texture array, to which the point light shadow maps are drawn to.
+   * 
+   * @param layerSize      The width and height of the faces of the cube maps, in texels.
+   * @param cubeMapsCount  The number of cube maps of the texture array.
+   */
+  GLuint initializePointLightTextureArrays(const GLsizei &layerSize, const GLsizei &cubeMapsCount)
   {
     GLuint newTextureId;
+
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      // Create the cube map array with immutable storage, with a layer for every face of every cube map.
+      glCreateTextures(GL_TEXTURE_CUBE_MAP_ARRAY, 1, &newTextureId);
+      glTextureStorage3D(newTextureId, 1, getDepthInternalFormat(), layerSize, layerSize, facesPerCubeMap * cubeMapsCount);
+      glTextureParameteri(newTextureId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTextureParameteri(newTextureId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTextureParameteri(newTextureId, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+      glTextureParameteri(newTextureId, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTextureParameteri(newTextureId, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      return newTextureId;
+    }
+
     // Generate a new texture.
     glGenTextures(1, &newTextureId);
 
     // Bind the texture as a cube map texture array.
-    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, newTextureId);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, newTextureId);
     // Define the size of a cube map, number of cube maps (face layers), and the type
     //   of data being drawn to the texture array as a whole.
-    glTexImage3D(
-        GL_TEXTURE_CUBE_MAP_ARRAY,
-        0,
-        GL_DEPTH_COMPONENT,
-        FRAMEBUFFER_WIDTH,
-        FRAMEBUFFER_HEIGHT,
-        facesPerCubeMap * MAX_POINT_LIGHTS,
-        0,
-        GL_DEPTH_COMPONENT,
-        GL_FLOAT,
-        nullptr);
+    allocateTextureArray(GL_TEXTURE_CUBE_MAP_ARRAY, layerSize, facesPerCubeMap * cubeMapsCount);
 
     // Provide parameters for behaviour when reading coordinates that are out-of-bounds,
     //   as well as algorithms to use for maginifcation and minification.
@@ -297,7 +648,7 @@ private:
     glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
     // Unbind the texture now that we're done.
-    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
 
     // Generate a shadow framebuffer for the point light texture array and save the ID.
     return newTextureId;
@@ -306,22 +657,44 @@ private:
   ShadowBufferManager()
       : namedShadowBuffers({}),
         namedShadowBufferReferences({}),
-        coneLightTextureArrayId(initializeConeLightTextureArrays()),
-        coneLightShadowBufferId(createShadowBuffer(coneLightTextureArrayId)),
-        pointLightTextureArrayId(initializePointLightTextureArrays()),
-        pointLightShadowBufferId(createShadowBuffer(pointLightTextureArrayId))
+        coneLightTextureArrayId(initializeFlatTextureArrays(CONE_SHADOW_ATLAS_SIZE, CONE_SHADOW_ATLAS_LAYERS)),
+        coneLightShadowBufferId(createShadowBuffer(CONE, coneLightTextureArrayId)),
+        coneLightShadowAtlas(CONE_SHADOW_ATLAS_SIZE, CONE_SHADOW_ATLAS_LAYERS, SHADOW_ATLAS_TILE_LEVELS),
+        pointLightTextureArrayId(initializePointLightTextureArrays(POINT_SHADOW_ATLAS_SIZE, POINT_SHADOW_ATLAS_LAYERS)),
+        pointLightShadowBufferId(createShadowBuffer(POINT, pointLightTextureArrayId)),
+        pointLightShadowAtlas(POINT_SHADOW_ATLAS_SIZE, POINT_SHADOW_ATLAS_LAYERS, SHADOW_ATLAS_TILE_LEVELS),
+        directionalLightTextureArrayId(initializeFlatTextureArrays(DIRECTIONAL_SHADOW_ATLAS_SIZE, SHADOW_CASCADES_COUNT * DIRECTIONAL_SHADOW_ATLAS_LAYERS)),
+        directionalLightShadowBufferId(createShadowBuffer(DIRECTIONAL, directionalLightTextureArrayId)),
+        directionalLightShadowAtlas(DIRECTIONAL_SHADOW_ATLAS_SIZE, DIRECTIONAL_SHADOW_ATLAS_LAYERS, SHADOW_ATLAS_TILE_LEVELS),
+        layerClearBufferId(createLayerClearBuffer()),
+        contentsGeneration(0),
+        staticCasterTextureArrayIds({{0, 0, 0}}),
+        staticCasterGeneration(0)
   {
   }
 
   ~ShadowBufferManager()
   {
     // Delete the texture array and framebuffer containing the shadow buffer data for cone lights.
-    glDeleteTextures(1, &coneLightTextureArrayId);
-    glDeleteFramebuffers(1, &coneLightShadowBufferId);
+    GlStateCache::getInstance().deleteTextures(1, &coneLightTextureArrayId);
+    GlStateCache::getInstance().deleteFramebuffers(1, &coneLightShadowBufferId);
 
     // Delete the texture array and framebuffer containing the shadow buffer data for point lights.
-    glDeleteTextures(1, &pointLightTextureArrayId);
-    glDeleteFramebuffers(1, &pointLightShadowBufferId);
+    GlStateCache::getInstance().deleteTextures(1, &pointLightTextureArrayId);
+    GlStateCache::getInstance().deleteFramebuffers(1, &pointLightShadowBufferId);
+
+    // Delete the texture array and framebuffer containing the shadow buffer data for directional lights.
+    GlStateCache::getInstance().deleteTextures(1, &directionalLightTextureArrayId);
+    GlStateCache::getInstance().deleteFramebuffers(1, &directionalLightShadowBufferId);
+
+    // Delete the texture arrays the static casters of the shadow maps are cached in.
+    for (uint32_t shadowBufferType = 0; shadowBufferType < SHADOW_BUFFER_TYPES_COUNT; shadowBufferType++)
+    {
+      discardStaticCasters(static_cast<ShadowBufferType>(shadowBufferType));
+    }
+
+    // Delete the framebuffer used for clearing layers.
+    GlStateCache::getInstance().deleteFramebuffers(1, &layerClearBufferId);
   }
 
 public:
@@ -338,7 +711,7 @@ public:
 	 * 
 	 * @return The details of the loaded shadow buffer.
 	 */
-  const std::shared_ptr<const ShadowBufferDetails> &createShadowBuffer(const std::string &shadowBufferName, const ShadowBufferType &shadowBufferType)
+  std::shared_ptr<const ShadowBufferDetails> createShadowBuffer(const std::string &shadowBufferName, const ShadowBufferType &shadowBufferType)
   {
     // Check if an shadow buffer with the name already exists.
     const auto existingShadowBuffer = namedShadowBuffers.find(shadowBufferName);
@@ -353,8 +726,6 @@ public:
     GLuint shadowBufferId;
     // Define a variable for storing the ID of the texture array a layer is being assigned from.
     GLuint shadowBufferTextureArrayId;
-    // Define a variable for storing the layer in the texture array that the shadow buffer is bound to.
-    uint32_t shadowBufferTextureArrayLayerId;
     // Check the type of shadow buffer requested.
     switch (shadowBufferType)
     {
@@ -363,20 +734,30 @@ public:
       shadowBufferId = pointLightShadowBufferId;
       // Set the texture array ID as the one for point lights.
       shadowBufferTextureArrayId = pointLightTextureArrayId;
-      // Get a layer assigned for the point light cube map texture.
-      shadowBufferTextureArrayLayerId = createNewPointLightLayerId();
+      break;
+    case DIRECTIONAL:
+      // Set the shadow framebuffer ID for directional lights.
+      shadowBufferId = directionalLightShadowBufferId;
+      // Set the texture array ID as the one for directional lights.
+      shadowBufferTextureArrayId = directionalLightTextureArrayId;
       break;
     default:
       // Set the shadow framebuffer ID for cone lights.
       shadowBufferId = coneLightShadowBufferId;
       // Set the texture array ID as the one for cone lights.
       shadowBufferTextureArrayId = coneLightTextureArrayId;
-      // Get a layer assigned for the cone light 2D texture.
-      shadowBufferTextureArrayLayerId = createNewConeLightLayerId();
+    }
+    // Get a tile assigned for the shadow buffer, starting with a whole layer until the light asks for a different size.
+    // The light goes without shadows if there is no space left for one within the budget of the shadow atlases.
+    ShadowAtlasTile shadowBufferTile;
+    if (!createNewTile(shadowBufferType, 0, true, shadowBufferTile))
+    {
+      Logger::getInstance().warning("No space left in the shadow atlas for ", shadowBufferName, ", which is left without shadows");
+      return nullptr;
     }
 
     // Create a new shadow buffer details with the captured data.
-    const auto newShadowBuffer = std::make_shared<const ShadowBufferDetails>(shadowBufferId, shadowBufferTextureArrayId, shadowBufferTextureArrayLayerId, shadowBufferName, shadowBufferType);
+    const auto newShadowBuffer = std::make_shared<ShadowBufferDetails>(shadowBufferId, shadowBufferTextureArrayId, shadowBufferTile, 0, shadowBufferName, shadowBufferType);
 
     // Insert the newly created shadow buffer into the map of created textures.
     namedShadowBuffers.insert(std::make_pair(shadowBufferName, newShadowBuffer));
@@ -387,6 +768,161 @@ public:
     return namedShadowBuffers[shadowBufferName];
   }
 
+  /**
+   * Move the shadow buffer to a tile of the shadow atlas fitting the given shadow map size, if it isn't in one already.
+   * The contents of the shadow buffer are lost when it moves, so it needs rendering again.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer to resize.
+   * @param shadowMapSize        The width and height wanted for the shadow map, in texels.
+   */
+  void resizeShadowBuffer(const ShadowBufferDetails &shadowBufferDetails, const uint32_t &shadowMapSize)
+  {
+    auto &shadowAtlas = getShadowAtlas(shadowBufferDetails.getShadowBufferType());
+    const auto tileLevel = shadowAtlas.getTileLevel(shadowMapSize);
+    const auto &shadowBuffer = namedShadowBuffers.at(shadowBufferDetails.getShadowBufferName());
+    // Keep the current tile if it's what was asked for, and it wasn't a smaller tile given when the atlas was full.
+    if (shadowBuffer->requestedTileLevel == tileLevel && shadowBuffer->shadowBufferTile.size == shadowAtlas.getTileSize(tileLevel))
+    {
+      return;
+    }
+    // Give back the current tile first, so its space can be reused for the new one, which means there's always at least
+    // the space of the tile it had. The atlas doesn't grow for a resize, since the lights ask for new sizes all the time.
+    shadowAtlas.releaseTile(shadowBuffer->shadowBufferTile);
+    createNewTile(shadowBufferDetails.getShadowBufferType(), tileLevel, false, shadowBuffer->shadowBufferTile);
+    shadowBuffer->requestedTileLevel = tileLevel;
+  }
+
+  /**
+   * Reallocate the texture array of the given type of shadow buffer at the size of the layers of its type, if it
+   * changed, attaching the new array to the same shadow framebuffer and giving every shadow buffer of the type a new
+   * tile of the level it last asked for. The contents of the shadow buffers of the type are lost, so they need
+   * rendering again.
+   *
+   * @param shadowBufferType  The type of the shadow buffers.
+   */
+  void resizeShadowAtlas(const ShadowBufferType &shadowBufferType)
+  {
+    auto &shadowAtlas = getShadowAtlas(shadowBufferType);
+    const auto layerSize = getShadowAtlasSize(shadowBufferType);
+    if (shadowAtlas.getLayerSize() == layerSize)
+    {
+      return;
+    }
+
+    // Replace the texture array, leaving the framebuffer it's attached to in place.
+    replaceTextureArray(shadowBufferType, initializeTextureArrays(shadowBufferType, layerSize, shadowAtlas.getLayersCount()));
+    discardStaticCasters(shadowBufferType);
+    contentsGeneration++;
+
+    // Hand the shadow buffers of the type tiles of the resized atlas, in the same order they'd get them when created.
+    shadowAtlas.resize(layerSize);
+    for (const auto &namedShadowBuffer : namedShadowBuffers)
+    {
+      const auto &shadowBuffer = namedShadowBuffer.second;
+      if (shadowBuffer->shadowBufferType == shadowBufferType)
+      {
+        createNewTile(shadowBufferType, shadowBuffer->requestedTileLevel, false, shadowBuffer->shadowBufferTile);
+      }
+    }
+  }
+
+  /**
+   * Get the width and height of the layers of the shadow atlas of the given type of shadow buffer.
+   * 
+   * @param shadowBufferType  The type of the shadow buffer.
+   * 
+   * @return The size of the layers, in texels.
+   */
+  static uint32_t getShadowAtlasSize(const ShadowBufferType &shadowBufferType)
+  {
+    return shadowBufferType == POINT ? POINT_SHADOW_ATLAS_SIZE : (shadowBufferType == DIRECTIONAL ? DIRECTIONAL_SHADOW_ATLAS_SIZE : CONE_SHADOW_ATLAS_SIZE);
+  }
+
+  /**
+   * Get the area the tile of the shadow buffer covers in its layer as texture coordinates.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer.
+   * 
+   * @return The bottom-left (x, y) and top-right (z, w) texture coordinates of the tile.
+   */
+  glm::vec4 getShadowBufferTileBounds(const ShadowBufferDetails &shadowBufferDetails) const
+  {
+    const auto &shadowBufferType = shadowBufferDetails.getShadowBufferType();
+    const auto &shadowAtlas = shadowBufferType == POINT ? pointLightShadowAtlas : (shadowBufferType == DIRECTIONAL ? directionalLightShadowAtlas : coneLightShadowAtlas);
+    return shadowAtlas.getTileBounds(shadowBufferDetails.getShadowBufferTile());
+  }
+
+  /**
+   * Clear the tile of the texture array the shadow buffer is rendered to, leaving the tiles of other shadow buffers untouched.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer to clear.
+   * @param facesMask            The mask of the faces of the shadow buffer to clear, with a bit for each face.
+   */
+  void clearShadowBuffer(const ShadowBufferDetails &shadowBufferDetails, const GLuint &facesMask = 0x3fu) const
+  {
+    // Point lights are stored as a face layer for each face of their cube map, and directional lights as a layer for each
+    //   of their cascades, while cone lights use a single layer.
+    const uint32_t layersCount = shadowBufferDetails.getShadowBufferType() == POINT ? facesPerCubeMap : (shadowBufferDetails.getShadowBufferType() == DIRECTIONAL ? SHADOW_CASCADES_COUNT : 1);
+    // Only clear the area of the tile, since other shadow buffers share the layers.
+    const auto &tile = shadowBufferDetails.getShadowBufferTile();
+    GlStateCache::getInstance().setCapability(GL_SCISSOR_TEST, true);
+    glScissor(tile.x, tile.y, tile.size, tile.size);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, layerClearBufferId);
+    for (uint32_t i = 0; i < layersCount; i++)
+    {
+      if ((facesMask & (1u << i)) == 0)
+      {
+        continue;
+      }
+      // Attach the layer and clear it.
+      glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowBufferDetails.getShadowBufferTextureArrayId(), 0, shadowBufferDetails.getShadowBufferTextureArrayLayerId() + i);
+      glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GlStateCache::getInstance().setCapability(GL_SCISSOR_TEST, false);
+  }
+
+  /**
+   * Check if the static casters of the shadow maps can be cached, which they're copied in and out of their cache for.
+   * 
+   * @return Whether the static casters can be cached.
+   */
+  static bool isStaticCasterCacheSupported()
+  {
+    return WindowManager::getInstance().isCopyImageSupported();
+  }
+
+  /**
+   * Cache the faces of the tile of the shadow buffer as they are, with only the static casters of the shadow map drawn
+   * into them, creating the texture array they're cached in for the type of the shadow buffer if there isn't one yet.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer.
+   * @param facesMask            The mask of the faces of the shadow buffer to cache, with a bit for each face.
+   */
+  void storeStaticCasters(const ShadowBufferDetails &shadowBufferDetails, const GLuint &facesMask)
+  {
+    const auto &shadowBufferType = shadowBufferDetails.getShadowBufferType();
+    auto &staticCasterTextureArrayId = staticCasterTextureArrayIds[shadowBufferType];
+    if (staticCasterTextureArrayId == 0)
+    {
+      const auto &shadowAtlas = getShadowAtlas(shadowBufferType);
+      staticCasterTextureArrayId = initializeTextureArrays(shadowBufferType, shadowAtlas.getLayerSize(), shadowAtlas.getLayersCount());
+    }
+    copyShadowBufferFaces(shadowBufferDetails, shadowBufferDetails.getShadowBufferTextureArrayId(), staticCasterTextureArrayId, facesMask);
+  }
+
+  /**
+   * Replace the faces of the tile of the shadow buffer with its cached static casters, which clears whatever else was
+   * drawn into them, so only the moving casters need to be drawn over them again.
+   * 
+   * @param shadowBufferDetails  The details of the shadow buffer.
+   * @param facesMask            The mask of the faces of the shadow buffer to restore, with a bit for each face.
+   */
+  void restoreStaticCasters(const ShadowBufferDetails &shadowBufferDetails, const GLuint &facesMask) const
+  {
+    copyShadowBufferFaces(shadowBufferDetails, staticCasterTextureArrayIds[shadowBufferDetails.getShadowBufferType()], shadowBufferDetails.getShadowBufferTextureArrayId(), facesMask);
+  }
+
   /**
    * Return the shadow buffer created with the given name.
    * 
@@ -394,7 +930,7 @@ public:
    * 
    * @return The shadow buffer created with the given name.
    */
-  const std::shared_ptr<const ShadowBufferDetails> &getShadowBufferDetails(const std::string &shadowBufferName) const
+  std::shared_ptr<const ShadowBufferDetails> getShadowBufferDetails(const std::string &shadowBufferName) const
   {
     return namedShadowBuffers.at(shadowBufferName);
   }
@@ -416,17 +952,8 @@ public:
       namedShadowBufferReferences.erase(shadowBufferDetails->getShadowBufferName());
       // Remove the shadow buffer from the created textures map.
       namedShadowBuffers.erase(shadowBufferDetails->getShadowBufferName());
-      // Check the type of light the shadow map was used for.
-      switch (shadowBufferDetails->getShadowBufferType())
-      {
-      case POINT:
-        // Un-assign the layer that was reserved for the shadow buffer in the point light shadow map texture array.
-        assignedPointLightTextureArrayLayerIds.erase(shadowBufferDetails->getShadowBufferTextureArrayLayerId() / facesPerCubeMap);
-        break;
-      default:
-        // Un-assign the layer that was reserved for the shadow buffer in the cone light shadow map texture array.
-        assignedConeLightTextureArrayLayerIds.erase(shadowBufferDetails->getShadowBufferTextureArrayLayerId());
-      }
+      // Un-assign the tile that was reserved for the shadow buffer in the shadow atlas of its type.
+      getShadowAtlas(shadowBufferDetails->getShadowBufferType()).releaseTile(shadowBufferDetails->getShadowBufferTile());
     }
   }
 
@@ -450,6 +977,16 @@ public:
     return pointLightTextureArrayId;
   }
 
+  /**
+   * Get the ID of the texture array of the directional light shadow cascades.
+   * 
+   * @return The ID of the texture array.
+   */
+  const GLuint &getDirectionalLightTextureArrayId() const
+  {
+    return directionalLightTextureArrayId;
+  }
+
   /**
    * Get the ID of the shadow framebuffer of the cone light shadow textures.
    * 
@@ -470,6 +1007,50 @@ public:
     return pointLightShadowBufferId;
   }
 
+  /**
+   * Get the ID of the shadow framebuffer of the directional light shadow cascades.
+   * 
+   * @return The ID of the shadow buffer.
+   */
+  const GLuint &getDirectionalLightShadowBufferId() const
+  {
+    return directionalLightShadowBufferId;
+  }
+
+  /**
+   * Get the number of times the contents of the shadow maps were lost, which they're all rendered again after.
+   *
+   * @return The generation of the contents of the shadow maps.
+   */
+  const uint64_t &getContentsGeneration() const
+  {
+    return contentsGeneration;
+  }
+
+  /**
+   * Get the number of times the cached static casters of the shadow maps were lost, which they're all cached again after.
+   *
+   * @return The generation of the cached static casters.
+   */
+  const uint64_t &getStaticCasterGeneration() const
+  {
+    return staticCasterGeneration;
+  }
+
+  /**
+   * Get the GPU memory used by the shadow maps, being the layers of the cone, point and directional light texture arrays,
+   * along with the copies of those whose static casters are cached.
+   *
+   * @return The size in bytes.
+   */
+  uint64_t getGpuMemorySize() const
+  {
+    const auto getCopiesCount = [this](const ShadowBufferType &shadowBufferType) -> uint64_t { return staticCasterTextureArrayIds[shadowBufferType] != 0 ? 2 : 1; };
+    return getCopiesCount(CONE) * getTextureArrayMemorySize(CONE, coneLightShadowAtlas.getLayerSize(), coneLightShadowAtlas.getLayersCount()) +
+           getCopiesCount(POINT) * getTextureArrayMemorySize(POINT, pointLightShadowAtlas.getLayerSize(), pointLightShadowAtlas.getLayersCount()) +
+           getCopiesCount(DIRECTIONAL) * getTextureArrayMemorySize(DIRECTIONAL, directionalLightShadowAtlas.getLayerSize(), directionalLightShadowAtlas.getLayersCount());
+  }
+
   /**
    * Returns the singleton instance of the shadow buffer manager.
    * 
@@ -477,17 +1058,13 @@ public:
    */
   static ShadowBufferManager &getInstance()
   {
+    // Singleton instance of the shadow buffer manager, constructed the first time it's asked for.
+    static ShadowBufferManager instance;
     return instance;
   }
 };
 
 // Initialize the number of faces in a single cube map static variable.
 const unsigned short ShadowBufferManager::facesPerCubeMap = 6;
-// Initialize the cone lights texture array assigned layer IDs set static variable.
-std::set<uint32_t> ShadowBufferManager::assignedConeLightTextureArrayLayerIds = std::set<uint32_t>({});
-// Initialize the point lights texture array assigned layer IDs set static variable.
-std::set<uint32_t> ShadowBufferManager::assignedPointLightTextureArrayLayerIds = std::set<uint32_t>({});
-// Initialize the shadow buffer manager singleton instance static variable.
-ShadowBufferManager ShadowBufferManager::instance;
 
 #endif
\ No newline at end of file
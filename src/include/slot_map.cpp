@@ -0,0 +1,258 @@
+#ifndef INCLUDE_SLOT_MAP_CPP
+#define INCLUDE_SLOT_MAP_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <functional>
+
+#include "log.cpp"
+
+/**
+ * Structure for a handle to an entry of a slot map. The generation changes every time the slot of the handle is
+ *   reused, so a handle to a removed entry never finds the entry that took its slot.
+ */
+struct SlotHandle
+{
+  // The index of the slot of the entry.
+  uint32_t index;
+  // The generation of the slot when the entry was inserted, where 0 is never used by an inserted entry.
+  uint32_t generation;
+
+  /**
+   * Check whether the handle ever pointed to an entry.
+   *
+   * @return Whether the handle is valid.
+   */
+  bool isValid() const
+  {
+    return generation != 0;
+  }
+
+  bool operator==(const SlotHandle &other) const
+  {
+    return index == other.index && generation == other.generation;
+  }
+
+  bool operator!=(const SlotHandle &other) const
+  {
+    return !(*this == other);
+  }
+
+  bool operator<(const SlotHandle &other) const
+  {
+    return index != other.index ? index < other.index : generation < other.generation;
+  }
+};
+
+// Hash the slot handles with both of their fields, so they can be the keys of unordered maps.
+namespace std
+{
+  template <>
+  struct hash<SlotHandle>
+  {
+    size_t operator()(const SlotHandle &handle) const
+    {
+      return hash<uint64_t>()((static_cast<uint64_t>(handle.generation) << 32) | handle.index);
+    }
+  };
+}
+
+/**
+ * Class for a container that finds, inserts and removes its entries by handle in constant time, while keeping the
+ *   entries packed together so they can be iterated without gaps. Removing an entry moves the last entry into its
+ *   place, so the order of the entries only holds until an entry is removed.
+ */
+template <typename T>
+class SlotMap
+{
+private:
+  /**
+   * Structure for a slot the handles point to.
+   */
+  struct Slot
+  {
+    // The index of the entry in the slot in the packed list of entries.
+    uint32_t valueIndex;
+    // The generation of the slot, which changes every time the entry in it is removed.
+    uint32_t generation;
+  };
+
+  // The packed list of entries.
+  std::vector<T> values;
+  // The index of the slot of each entry in the packed list of entries.
+  std::vector<uint32_t> valueSlots;
+  // The slots the handles point to.
+  std::vector<Slot> slots;
+  // The indices of the slots without an entry, reused by the next inserted entries.
+  std::vector<uint32_t> freeSlots;
+
+  /**
+   * Get the index of the entry of the handle in the packed list of entries.
+   *
+   * @param handle  The handle of the entry.
+   *
+   * @return The index of the entry, or the number of entries if the handle doesn't point to one.
+   */
+  size_t getValueIndex(const SlotHandle &handle) const
+  {
+    if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation)
+    {
+      return values.size();
+    }
+    return slots[handle.index].valueIndex;
+  }
+
+public:
+  SlotMap()
+      : values({}),
+        valueSlots({}),
+        slots({}),
+        freeSlots({}) {}
+
+  /**
+   * Insert an entry at the end of the packed list of entries, reusing a free slot for it if there is one.
+   *
+   * @param value  The entry to insert.
+   *
+   * @return The handle of the entry.
+   */
+  SlotHandle insert(const T &value)
+  {
+    if (freeSlots.empty())
+    {
+      freeSlots.push_back(slots.size());
+      slots.push_back({0, 1});
+    }
+    const auto slotIndex = freeSlots.back();
+    freeSlots.pop_back();
+
+    auto &slot = slots[slotIndex];
+    slot.valueIndex = values.size();
+    values.push_back(value);
+    valueSlots.push_back(slotIndex);
+    return {slotIndex, slot.generation};
+  }
+
+  /**
+   * Remove the entry of the handle, moving the last entry into its place in the packed list.
+   *
+   * @param handle  The handle of the entry.
+   *
+   * @return Whether the handle pointed to an entry.
+   */
+  bool remove(const SlotHandle &handle)
+  {
+    const auto valueIndex = getValueIndex(handle);
+    if (valueIndex == values.size())
+    {
+      return false;
+    }
+
+    // Move the last entry into the place of the removed one.
+    const auto lastValueIndex = values.size() - 1;
+    if (valueIndex != lastValueIndex)
+    {
+      values[valueIndex] = std::move(values[lastValueIndex]);
+      valueSlots[valueIndex] = valueSlots[lastValueIndex];
+      slots[valueSlots[valueIndex]].valueIndex = valueIndex;
+    }
+    values.pop_back();
+    valueSlots.pop_back();
+
+    // Free the slot, skipping the generation 0 when it wraps around.
+    auto &slot = slots[handle.index];
+    slot.generation = slot.generation + 1 != 0 ? slot.generation + 1 : 1;
+    freeSlots.push_back(handle.index);
+    return true;
+  }
+
+  /**
+   * Remove all the entries. The slots are kept, so the handles of the removed entries stay invalid.
+   */
+  void clear()
+  {
+    while (!values.empty())
+    {
+      remove({valueSlots.back(), slots[valueSlots.back()].generation});
+    }
+  }
+
+  /**
+   * Check whether the handle points to an entry.
+   *
+   * @param handle  The handle.
+   *
+   * @return Whether the entry of the handle exists.
+   */
+  bool contains(const SlotHandle &handle) const
+  {
+    return getValueIndex(handle) != values.size();
+  }
+
+  /**
+   * Find the entry of the handle.
+   *
+   * @param handle  The handle of the entry.
+   *
+   * @return The entry, or null if the handle doesn't point to one.
+   */
+  T *find(const SlotHandle &handle)
+  {
+    const auto valueIndex = getValueIndex(handle);
+    return valueIndex != values.size() ? &values[valueIndex] : nullptr;
+  }
+
+  /**
+   * Find the entry of the handle.
+   *
+   * @param handle  The handle of the entry.
+   *
+   * @return The entry, or null if the handle doesn't point to one.
+   */
+  const T *find(const SlotHandle &handle) const
+  {
+    const auto valueIndex = getValueIndex(handle);
+    return valueIndex != values.size() ? &values[valueIndex] : nullptr;
+  }
+
+  /**
+   * Get the entry of the handle, which has to exist.
+   *
+   * @param handle  The handle of the entry.
+   *
+   * @return The entry.
+   */
+  const T &get(const SlotHandle &handle) const
+  {
+    const auto value = find(handle);
+    if (value == nullptr)
+    {
+      Logger::getInstance().error("Failed at finding the slot map entry ", handle.index, ":", handle.generation);
+      exit(1);
+    }
+    return *value;
+  }
+
+  /**
+   * Get the packed list of entries.
+   *
+   * @return The list of entries.
+   */
+  const std::vector<T> &getValues() const
+  {
+    return values;
+  }
+
+  /**
+   * Get the number of entries.
+   *
+   * @return The number of entries.
+   */
+  size_t size() const
+  {
+    return values.size();
+  }
+};
+
+#endif
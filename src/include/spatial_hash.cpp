@@ -0,0 +1,238 @@
+#ifndef INCLUDE_SPATIAL_HASH_CPP
+#define INCLUDE_SPATIAL_HASH_CPP
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "slot_map.cpp"
+#include "collider.cpp"
+#include "broadphase.cpp"
+
+/**
+ * Class for a broadphase that hashes the bounding boxes of the entries into the cells of a uniform grid, so only the
+ * entries sharing a cell with a box need to be checked against it. Cells are only created once an entry is in them,
+ * so the grid has no bounds.
+ */
+class SpatialHash : public Broadphase
+{
+private:
+  /**
+   * Structure for defining the range of cells an entry is in.
+   */
+  struct CellRange
+  {
+    // The cells with the smallest and the largest coordinates the entry is in.
+    glm::ivec3 minCell;
+    glm::ivec3 maxCell;
+  };
+
+  /**
+   * Structure for defining an entry in a cell, with its layers kept next to it so the query can skip it right away.
+   */
+  struct CellEntry
+  {
+    // The handle of the entry.
+    SlotHandle entryId;
+    // The mask of the collision layers of the entry.
+    uint32_t layers;
+  };
+
+  // The size of each cell along every axis.
+  const float_t cellSize;
+
+  // The entries in each cell, by the key of the cell.
+  std::unordered_map<uint64_t, std::vector<CellEntry>> cells;
+  // The range of cells each entry is in, by the handle of the entry.
+  std::unordered_map<SlotHandle, CellRange> entryCellRanges;
+  // The layers of each entry, by the handle of the entry.
+  std::unordered_map<SlotHandle, uint32_t> entryLayers;
+
+  /**
+   * Get the key of the cell with the given coordinates, packing 21 bits of each coordinate into the key.
+   *
+   * @param cell  The coordinates of the cell.
+   *
+   * @return The key of the cell.
+   */
+  static uint64_t getCellKey(const glm::ivec3 &cell)
+  {
+    const auto mask = (1ull << 21) - 1;
+    return ((static_cast<uint64_t>(cell.x) & mask) << 42) | ((static_cast<uint64_t>(cell.y) & mask) << 21) | (static_cast<uint64_t>(cell.z) & mask);
+  }
+
+  /**
+   * Get the range of cells the given box is in.
+   *
+   * @param box  The box.
+   *
+   * @return The range of cells.
+   */
+  CellRange getCellRange(const AxisAlignedBoundingBox &box) const
+  {
+    return {glm::ivec3(glm::floor(box.getMinCorner() / cellSize)), glm::ivec3(glm::floor(box.getMaxCorner() / cellSize))};
+  }
+
+  /**
+   * Run the given function on the key of every cell of the range.
+   *
+   * @param cellRange  The range of cells.
+   * @param function   The function to run on the key of each cell.
+   */
+  template <typename F>
+  static void forEachCell(const CellRange &cellRange, const F &function)
+  {
+    for (auto x = cellRange.minCell.x; x <= cellRange.maxCell.x; x++)
+    {
+      for (auto y = cellRange.minCell.y; y <= cellRange.maxCell.y; y++)
+      {
+        for (auto z = cellRange.minCell.z; z <= cellRange.maxCell.z; z++)
+        {
+          function(getCellKey(glm::ivec3(x, y, z)));
+        }
+      }
+    }
+  }
+
+  /**
+   * Add the entry to every cell of the range.
+   *
+   * @param entryId    The handle of the entry.
+   * @param cellRange  The range of cells.
+   * @param layers     The mask of the collision layers of the entry.
+   */
+  void addToCells(const SlotHandle &entryId, const CellRange &cellRange, const uint32_t &layers)
+  {
+    forEachCell(cellRange, [&](const uint64_t &cellKey) {
+      cells[cellKey].push_back({entryId, layers});
+    });
+  }
+
+  /**
+   * Remove the entry from every cell of the range, dropping the cells left empty.
+   *
+   * @param entryId    The handle of the entry.
+   * @param cellRange  The range of cells.
+   */
+  void removeFromCells(const SlotHandle &entryId, const CellRange &cellRange)
+  {
+    forEachCell(cellRange, [&](const uint64_t &cellKey) {
+      const auto cell = cells.find(cellKey);
+      if (cell == cells.end())
+      {
+        return;
+      }
+      cell->second.erase(std::remove_if(cell->second.begin(), cell->second.end(), [&](const CellEntry &cellEntry) { return cellEntry.entryId == entryId; }),
+                         cell->second.end());
+      if (cell->second.empty())
+      {
+        cells.erase(cell);
+      }
+    });
+  }
+
+public:
+  /**
+   * Create a spatial hash.
+   *
+   * @param cellSize  The size of each cell along every axis, which works best around the size of the largest entries.
+   */
+  SpatialHash(const float_t &cellSize)
+      : cellSize(cellSize),
+        cells({}),
+        entryCellRanges({}),
+        entryLayers({}) {}
+
+  /**
+   * Insert the entry with the given box, or move it to the cells of the box if it was already inserted.
+   *
+   * @param entryId  The handle of the entry.
+   * @param box      The bounding box of the entry.
+   * @param layers   The mask of the collision layers of the entry.
+   */
+  void update(const SlotHandle &entryId, const AxisAlignedBoundingBox &box, const uint32_t &layers) override
+  {
+    const auto cellRange = getCellRange(box);
+    const auto entryCellRange = entryCellRanges.find(entryId);
+    if (entryCellRange != entryCellRanges.end())
+    {
+      // Moving within the same cells doesn't change anything, which is the case for most moves.
+      auto &currentLayers = entryLayers[entryId];
+      if (entryCellRange->second.minCell == cellRange.minCell && entryCellRange->second.maxCell == cellRange.maxCell && currentLayers == layers)
+      {
+        return;
+      }
+      removeFromCells(entryId, entryCellRange->second);
+      entryCellRange->second = cellRange;
+      currentLayers = layers;
+    }
+    else
+    {
+      entryCellRanges.emplace(entryId, cellRange);
+      entryLayers.emplace(entryId, layers);
+    }
+    addToCells(entryId, cellRange, layers);
+  }
+
+  /**
+   * Remove the entry, if it was inserted.
+   *
+   * @param entryId  The handle of the entry.
+   */
+  void remove(const SlotHandle &entryId) override
+  {
+    const auto entryCellRange = entryCellRanges.find(entryId);
+    if (entryCellRange == entryCellRanges.end())
+    {
+      return;
+    }
+    removeFromCells(entryId, entryCellRange->second);
+    entryCellRanges.erase(entryCellRange);
+    entryLayers.erase(entryId);
+  }
+
+  /**
+   * Remove all the entries.
+   */
+  void clear() override
+  {
+    cells.clear();
+    entryCellRanges.clear();
+    entryLayers.clear();
+  }
+
+  /**
+   * Get the handles of the entries on any of the given layers sharing a cell with the given box, which are the only
+   *   ones that can overlap it.
+   *
+   * @param box        The box to query.
+   * @param layerMask  The mask of the collision layers of the entries to find.
+   * @param entryIds   The list to store the handles of the entries to, each only once.
+   */
+  void query(const AxisAlignedBoundingBox &box, const uint32_t &layerMask, std::vector<SlotHandle> &entryIds) const override
+  {
+    entryIds.clear();
+    forEachCell(getCellRange(box), [&](const uint64_t &cellKey) {
+      const auto cell = cells.find(cellKey);
+      if (cell == cells.end())
+      {
+        return;
+      }
+      for (const auto &cellEntry : cell->second)
+      {
+        if (cellEntry.layers & layerMask)
+        {
+          entryIds.push_back(cellEntry.entryId);
+        }
+      }
+    });
+    // Entries spanning several of the cells show up once for each of them.
+    std::sort(entryIds.begin(), entryIds.end());
+    entryIds.erase(std::unique(entryIds.begin(), entryIds.end()), entryIds.end());
+  }
+};
+
+#endif
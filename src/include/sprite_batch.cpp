@@ -0,0 +1,473 @@
+#ifndef INCLUDE_SPRITE_BATCH_CPP
+#define INCLUDE_SPRITE_BATCH_CPP
+
+#include <array>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <memory_resource>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include "gl_state.cpp"
+#include "common.cpp"
+#include "constants.cpp"
+#include "shader.cpp"
+#include "texture.cpp"
+#include "object.cpp"
+#include "streaming_buffer.cpp"
+#include "indirect_draw.cpp"
+#include "render_stats.cpp"
+#include "frame_arena.cpp"
+#include "gl_debug.cpp"
+#include "log.cpp"
+#include "../models/model_base_intf.cpp"
+
+/**
+ * Class for drawing the unlit models of the menus as sprites, without any of the lights, shadows or per-model uniforms of
+ *   the models of the game. The textures of the sprites are copied into the layers of a texture array, so the sprites
+ *   sharing a vertex array are drawn together whatever their textures, with each instance picking its layer. The opaque
+ *   sprites are drawn first, and the sprites whose black parts are transparent after them, so they blend over the rest.
+ *   With multi-draw indirect, that makes a single draw call for every run of sprites sharing a vertex array, and otherwise
+ *   one for every object.
+ */
+class SpriteBatch
+{
+private:
+  /**
+   * Structure for the texture copied into a layer of the sprite texture array.
+   */
+  struct SpriteTextureLayer
+  {
+    // The details of the texture, which the layer is free to take over once they're gone.
+    std::weak_ptr<const TextureDetails> textureDetails;
+    // The ID of the texture that was copied, which changes once the texture file is reloaded, so it's copied again.
+    GLuint sourceTextureId;
+    // The frame the layer was last drawn with, so the layer used the longest time ago is taken over once all are used.
+    uint64_t lastUsedFrame;
+  };
+
+  /**
+   * Structure for the instances of the sprites sharing an object, drawn together.
+   */
+  struct SpriteInstanceGroup
+  {
+    // The details of the object of the sprites.
+    const ObjectDetails *objectDetails;
+    // The index of the instance data of the first sprite, and the number of sprites.
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+  };
+
+  // The bit set in the instance data of the sprites whose black parts are drawn transparent, next to their layer.
+  static const GLuint BLACK_ALPHA_FLAG;
+  // The fragment shaders of the models that are drawn as sprites, the second fading out the dark parts of the texture.
+  static const std::string UNLIT_FRAGMENT_SHADER_FILE_PATH;
+  static const std::string UNLIT_BLACK_ALPHA_FRAGMENT_SHADER_FILE_PATH;
+
+  // The shader program drawing the sprites, and the key of the uniform of the texture array.
+  const std::shared_ptr<const ShaderDetails> &spriteShader;
+  const uint32_t spriteTexturesKey;
+  // The shader program drawing the textures into the layers of the texture array, and the key of the uniform of the
+  //   texture drawn.
+  const std::shared_ptr<const ShaderDetails> &copyShader;
+  const uint32_t sourceTextureKey;
+  // The ID of the texture array the textures of the sprites are copied into, and the textures in its layers.
+  const GLuint textureArrayId;
+  std::array<SpriteTextureLayer, SPRITE_TEXTURE_LAYERS_COUNT> textureLayers;
+  // The ID of the framebuffer the textures are drawn into the layers through, and of the vertex array of the full-screen
+  //   triangle they're drawn with, which has no vertex data.
+  GLuint framebufferId;
+  const GLuint copyVertexArrayId;
+  // The number of frames drawn so far.
+  uint64_t framesCount;
+
+  // The buffer the model matrices and the layers of the sprites are streamed through, and the draws collected to be
+  //   submitted with a single multi-draw indirect call.
+  StreamingBuffer instanceStreamingBuffer;
+  IndirectDrawBatch indirectDrawBatch;
+  // The number of sprites drawn in the latest frame, and the number left out since their textures didn't fit the array.
+  uint32_t drawnSpritesCount;
+  uint32_t skippedSpritesCount;
+
+  /**
+   * Create the texture array the textures of the sprites are copied into, with all its mip levels.
+   *
+   * @return The ID of the texture array.
+   */
+  static GLuint createTextureArray()
+  {
+    GLuint textureArrayId;
+    glGenTextures(1, &textureArrayId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, textureArrayId);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, SPRITE_TEXTURE_SIZE, SPRITE_TEXTURE_SIZE, SPRITE_TEXTURE_LAYERS_COUNT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // Generating the mip levels creates their storage, so the array can be sampled before anything is copied into it.
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    GpuDebugLabels::labelObject(GL_TEXTURE, textureArrayId, "Sprite Textures");
+    return textureArrayId;
+  }
+
+  /**
+   * Copy the finest uploaded mip level of a texture into a layer of the texture array, scaled to the size of the layer.
+   *   The texture is drawn over the layer instead of blitted, since block compressed textures, which the baked textures
+   *   are, can't be read through a framebuffer.
+   *
+   * @param textureId  The ID of the texture.
+   * @param layer      The layer of the texture array.
+   */
+  void copyTexture(const GLuint &textureId, const uint32_t &layer)
+  {
+    auto &glStateCache = GlStateCache::getInstance();
+    glStateCache.bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureArrayId, 0, layer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      Logger::getInstance().error("Failed at SpriteBatch 1");
+      glStateCache.bindFramebuffer(GL_FRAMEBUFFER, 0);
+      return;
+    }
+
+    // Keep the viewport and the blending the sprites are drawn with, so they're put back once the layer is drawn, since
+    //   the texture has to replace the layer rather than blend over it.
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    const auto blendEnabled = glIsEnabled(GL_BLEND) == GL_TRUE;
+    glStateCache.setViewport(0, 0, SPRITE_TEXTURE_SIZE, SPRITE_TEXTURE_SIZE);
+    glStateCache.setCapability(GL_BLEND, false);
+
+    // Draw the texture over the whole layer, which scales it with its filtering along the way.
+    glStateCache.useProgram(copyShader->getShaderId());
+    glUniform1i(copyShader->getUniformLocation(sourceTextureKey), 0);
+    glStateCache.activeTexture(GL_TEXTURE0);
+    glStateCache.bindTexture(GL_TEXTURE_2D, textureId);
+    glStateCache.bindVertexArray(copyVertexArrayId);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glStateCache.bindVertexArray(0);
+    glStateCache.bindTexture(GL_TEXTURE_2D, 0);
+
+    glStateCache.setCapability(GL_BLEND, blendEnabled);
+    glStateCache.setViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glStateCache.bindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  /**
+   * Check that a block compressed texture, the format the textures baked by the asset baker are in, is copied into the
+   *   texture array, by copying a single block of a known color into the first layer and reading a texel of it back.
+   *   The first layer is copied over again once a sprite takes it, since no texture is recorded in it.
+   */
+  void checkCompressedTextureCopy()
+  {
+    // A single BC1 block, uploaded the way the baked textures are, with both of its colors pure red so every texel of
+    //   it decodes to pure red.
+    const std::array<uint8_t, 8> redBlock = {0x00, 0xF8, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00};
+    auto &glStateCache = GlStateCache::getInstance();
+    GLuint blockTextureId;
+    glGenTextures(1, &blockTextureId);
+    glStateCache.activeTexture(GL_TEXTURE0);
+    glStateCache.bindTexture(GL_TEXTURE_2D, blockTextureId);
+    glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 4, 4, 0, redBlock.size(), redBlock.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glStateCache.bindTexture(GL_TEXTURE_2D, 0);
+    copyTexture(blockTextureId, 0);
+
+    // Read back the texel at the center of the layer, which is still attached to the framebuffer.
+    std::array<uint8_t, 4> texel = {};
+    glStateCache.bindFramebuffer(GL_READ_FRAMEBUFFER, framebufferId);
+    glStateCache.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glReadPixels(SPRITE_TEXTURE_SIZE / 2, SPRITE_TEXTURE_SIZE / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel.data());
+    glStateCache.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    glStateCache.deleteTextures(1, &blockTextureId);
+    if (texel[0] < 250 || texel[1] > 5 || texel[2] > 5)
+    {
+      Logger::getInstance().error("Failed at SpriteBatch 2");
+    }
+  }
+
+  /**
+   * Find the layer of the texture array holding the texture, copying the texture into the layer used the longest time
+   *   ago if it isn't in the array yet, or if it was reloaded since it was copied.
+   *
+   * @param textureDetails   The details of the texture.
+   * @param texturesChanged  Set if the texture was copied into the array.
+   *
+   * @return The layer, or nothing if every layer holds a texture drawn in the frame already.
+   */
+  std::optional<uint32_t> findTextureLayer(const std::shared_ptr<const TextureDetails> &textureDetails, bool &texturesChanged)
+  {
+    uint32_t layer = 0;
+    for (uint32_t i = 0; i < SPRITE_TEXTURE_LAYERS_COUNT; i++)
+    {
+      if (textureLayers[i].textureDetails.lock() == textureDetails)
+      {
+        layer = i;
+        break;
+      }
+      // Layers whose textures are gone are taken over before any others.
+      if (textureLayers[i].textureDetails.expired())
+      {
+        textureLayers[i].lastUsedFrame = 0;
+      }
+      if (textureLayers[i].lastUsedFrame < textureLayers[layer].lastUsedFrame)
+      {
+        layer = i;
+      }
+    }
+
+    auto &textureLayer = textureLayers[layer];
+    if (textureLayer.textureDetails.lock() != textureDetails)
+    {
+      if (textureLayer.lastUsedFrame == framesCount)
+      {
+        return std::nullopt;
+      }
+      textureLayer.textureDetails = textureDetails;
+      textureLayer.sourceTextureId = 0;
+    }
+    if (textureLayer.sourceTextureId != textureDetails->getTextureId())
+    {
+      textureLayer.sourceTextureId = textureDetails->getTextureId();
+      copyTexture(textureLayer.sourceTextureId, layer);
+      texturesChanged = true;
+    }
+    textureLayer.lastUsedFrame = framesCount;
+    return layer;
+  }
+
+public:
+  SpriteBatch()
+      : spriteShader(ShaderManager::getInstance().createShaderProgram("SpriteShader", "assets/shaders/vertex/sprite.glsl", "assets/shaders/fragment/sprite.glsl")),
+        spriteTexturesKey(ShaderManager::getInstance().getUniformKey("spriteTextures")),
+        copyShader(ShaderManager::getInstance().createShaderProgram("SpriteCopyShader", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/sprite_copy.glsl")),
+        sourceTextureKey(ShaderManager::getInstance().getUniformKey("sourceTexture")),
+        textureArrayId(createTextureArray()),
+        textureLayers(),
+        framebufferId(0),
+        copyVertexArrayId(VertexArray::create()),
+        framesCount(0),
+        instanceStreamingBuffer(SPRITE_STREAMING_BUFFER_SIZE),
+        indirectDrawBatch(),
+        drawnSpritesCount(0),
+        skippedSpritesCount(0)
+  {
+    textureLayers.fill({std::weak_ptr<const TextureDetails>(), 0, 0});
+    glGenFramebuffers(1, &framebufferId);
+    checkCompressedTextureCopy();
+  }
+
+  // Preventing copying the sprite batch, since it owns its texture array, framebuffer and shaders.
+  SpriteBatch(const SpriteBatch &) = delete;
+
+  ~SpriteBatch()
+  {
+    GlStateCache::getInstance().deleteFramebuffers(1, &framebufferId);
+    GlStateCache::getInstance().deleteVertexArrays(1, &copyVertexArrayId);
+    GlStateCache::getInstance().deleteTextures(1, &textureArrayId);
+    ShaderManager::getInstance().destroyShaderProgram(spriteShader);
+    ShaderManager::getInstance().destroyShaderProgram(copyShader);
+  }
+
+  /**
+   * Check if the model is drawn as a sprite, which is the case for the models drawn with the unlit shaders.
+   *
+   * @param model  The model.
+   *
+   * @return Whether the model is a sprite.
+   */
+  static bool isSprite(ModelBaseIntf &model)
+  {
+    const auto &shaderDetails = model.getShaderDetails();
+    return shaderDetails != nullptr && (shaderDetails->getFragmentShaderFilePath() == UNLIT_FRAGMENT_SHADER_FILE_PATH ||
+                                        shaderDetails->getFragmentShaderFilePath() == UNLIT_BLACK_ALPHA_FRAGMENT_SHADER_FILE_PATH);
+  }
+
+  /**
+   * Draw the sprites to the bound framebuffer with the matrices of the camera uniform block, blended with the blending
+   *   that's enabled. The sprites blended over the rest are drawn after the others, from the farthest to the nearest.
+   *
+   * @param sprites           The models drawn as sprites.
+   * @param vpMatrix          The projection-view matrix of the camera, which the blended sprites are ordered by.
+   * @param spinTime          The time the spins of the sprites are evaluated at.
+   * @param multiDrawIndirect Whether the sprites sharing a vertex array are drawn with a single multi-draw indirect call.
+   * @param stats             The work of the pass, which the work of drawing the sprites is added to.
+   */
+  void draw(const std::pmr::vector<std::shared_ptr<ModelBaseIntf>> &sprites, const glm::mat4 &vpMatrix, const float_t &spinTime, const bool &multiDrawIndirect, RenderStats &stats)
+  {
+    framesCount++;
+    drawnSpritesCount = 0;
+    auto &frameArena = FrameArena::getInstance();
+
+    // Group the opaque sprites by their vertex array and their object, which keeps the sprites sharing a vertex array
+    //   next to each other. The sprites blended over the rest are kept apart with their depths, since they have to be
+    //   drawn from the back whatever their vertex arrays are.
+    std::pmr::map<std::tuple<GLuint, const ObjectDetails *>, std::pmr::vector<uint32_t>> groupedSpriteIndices(&frameArena);
+    std::pmr::vector<std::pair<float_t, uint32_t>> blendedSprites(&frameArena);
+    std::pmr::vector<GLuint> spriteLayers(sprites.size(), 0, &frameArena);
+    auto texturesChanged = false;
+    for (uint32_t i = 0; i < sprites.size(); i++)
+    {
+      const auto &sprite = sprites[i];
+      const auto layer = findTextureLayer(sprite->getTextureDetails(), texturesChanged);
+      if (!layer.has_value())
+      {
+        skippedSpritesCount++;
+        continue;
+      }
+      const auto blackAlpha = sprite->getShaderDetails()->getFragmentShaderFilePath() == UNLIT_BLACK_ALPHA_FRAGMENT_SHADER_FILE_PATH;
+      spriteLayers[i] = *layer | (blackAlpha ? BLACK_ALPHA_FLAG : 0);
+      if (blackAlpha)
+      {
+        const auto clipPosition = vpMatrix * glm::vec4(sprite->getModelPosition(), 1.0f);
+        blendedSprites.push_back({clipPosition.z / clipPosition.w, i});
+        continue;
+      }
+      const auto &objectDetails = sprite->getObjectDetails();
+      groupedSpriteIndices[std::make_tuple(objectDetails->getVertexArrayId(), objectDetails.get())].push_back(i);
+    }
+    if (groupedSpriteIndices.empty() && blendedSprites.empty())
+    {
+      return;
+    }
+    // Filter the layers the textures were copied into down to their coarser mip levels.
+    if (texturesChanged)
+    {
+      GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+      GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, textureArrayId);
+      glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+
+    // Lay out the instance data group by group, with the spins turned into the matrices, and the vertex matrix of the
+    //   object applied first for the compact vertex format.
+    std::pmr::vector<glm::mat4> instanceMatrices(&frameArena);
+    std::pmr::vector<GLuint> instanceLayers(&frameArena);
+    std::pmr::vector<SpriteInstanceGroup> spriteInstanceGroups(&frameArena);
+    const auto addInstance = [&](const uint32_t &spriteIndex, const ObjectDetails &objectDetails) {
+      const auto spin = sprites[spriteIndex]->getRenderSpin();
+      const auto spinMatrix = spin.y != 0.0f || spin.x != 0.0f ? glm::rotate(spin.x + spin.y * spinTime, glm::vec3(0.0f, 1.0f, 0.0f)) : glm::mat4(1.0f);
+      instanceMatrices.push_back(sprites[spriteIndex]->getRenderMatrix() * spinMatrix * objectDetails.getVertexMatrix());
+      instanceLayers.push_back(spriteLayers[spriteIndex]);
+    };
+    for (const auto &group : groupedSpriteIndices)
+    {
+      const auto &objectDetails = *std::get<1>(group.first);
+      spriteInstanceGroups.push_back({&objectDetails, static_cast<uint32_t>(instanceMatrices.size()), static_cast<uint32_t>(group.second.size())});
+      for (const auto &spriteIndex : group.second)
+      {
+        addInstance(spriteIndex, objectDetails);
+      }
+    }
+    // Lay out the blended sprites from the farthest, in groups of the ones next to each other sharing an object.
+    std::stable_sort(blendedSprites.begin(), blendedSprites.end(), [](const auto &a, const auto &b) {
+      return a.first > b.first;
+    });
+    const auto opaqueGroupsCount = spriteInstanceGroups.size();
+    for (const auto &blendedSprite : blendedSprites)
+    {
+      const auto &objectDetails = *sprites[blendedSprite.second]->getObjectDetails();
+      if (spriteInstanceGroups.size() == opaqueGroupsCount || spriteInstanceGroups.back().objectDetails != &objectDetails)
+      {
+        spriteInstanceGroups.push_back({&objectDetails, static_cast<uint32_t>(instanceMatrices.size()), 0});
+      }
+      spriteInstanceGroups.back().instanceCount++;
+      addInstance(blendedSprite.second, objectDetails);
+    }
+    drawnSpritesCount = instanceMatrices.size();
+    const auto matricesSize = sizeof(glm::mat4) * instanceMatrices.size();
+    const auto layersSize = sizeof(GLuint) * instanceLayers.size();
+    instanceStreamingBuffer.reserve(matricesSize + layersSize, sizeof(glm::mat4));
+    const auto instanceMatrixBase = instanceStreamingBuffer.write(&instanceMatrices[0], matricesSize, sizeof(glm::mat4)) / sizeof(glm::mat4);
+    const auto instanceLayerBase = instanceStreamingBuffer.write(&instanceLayers[0], layersSize, sizeof(GLuint)) / sizeof(GLuint);
+    stats.uploadedBytes += matricesSize + layersSize;
+
+    // The sprites only need the texture array, which is bound once for all of them.
+    GlStateCache::getInstance().useProgram(spriteShader->getShaderId());
+    glUniform1i(spriteShader->getUniformLocation(spriteTexturesKey), 0);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, textureArrayId);
+    stats.uniformCalls++;
+    stats.stateChanges += 2;
+
+    for (const auto &spriteInstanceGroup : spriteInstanceGroups)
+    {
+      const auto &objectDetails = *spriteInstanceGroup.objectDetails;
+      const auto &lod = objectDetails.getLod(0);
+      const auto &vertexArrayId = objectDetails.getVertexArrayId();
+      stats.instances += spriteInstanceGroup.instanceCount;
+      stats.triangles += uint64_t(spriteInstanceGroup.instanceCount) * lod.indexCount / 3;
+
+      if (multiDrawIndirect)
+      {
+        // Submit the draws collected before once the vertex array changes. The draws of a call are drawn in the order
+        //   they were added, so the blended sprites sharing the call still go over the opaque ones.
+        if (!indirectDrawBatch.isBatching(spriteShader->getShaderId(), textureArrayId, vertexArrayId))
+        {
+          stats.drawCalls += indirectDrawBatch.submit();
+          GlStateCache::getInstance().bindVertexArray(vertexArrayId);
+          VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase);
+          VertexArray::attachInstanceIntegerAttribute(INSTANCE_SPRITE_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceLayerBase);
+          stats.stateChanges += 3;
+        }
+        indirectDrawBatch.add(spriteShader->getShaderId(), textureArrayId, vertexArrayId, {lod.indexCount, spriteInstanceGroup.instanceCount, lod.firstIndex, objectDetails.getBaseVertex(), spriteInstanceGroup.firstInstance});
+      }
+      else
+      {
+        // Point the instance attributes at the instance data of the group, since there is no base instance support.
+        GlStateCache::getInstance().bindVertexArray(vertexArrayId);
+        VertexArray::attachInstanceMatrixAttribute(INSTANCE_MATRIX_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceMatrixBase + spriteInstanceGroup.firstInstance);
+        VertexArray::attachInstanceIntegerAttribute(INSTANCE_SPRITE_ATTRIBUTE_LOCATION, instanceStreamingBuffer.getBufferId(), instanceLayerBase + spriteInstanceGroup.firstInstance);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, (void *)(sizeof(uint32_t) * lod.firstIndex), spriteInstanceGroup.instanceCount, objectDetails.getBaseVertex());
+        stats.drawCalls++;
+        stats.stateChanges += 3;
+      }
+    }
+    stats.drawCalls += indirectDrawBatch.submit();
+    GlStateCache::getInstance().bindVertexArray(0);
+  }
+
+  /**
+   * Finish the current frame once the sprites were drawn, so the next one streams its data elsewhere.
+   */
+  void endFrame()
+  {
+    instanceStreamingBuffer.endFrame();
+    indirectDrawBatch.endFrame();
+  }
+
+  /**
+   * Get the number of sprites drawn in the latest frame.
+   *
+   * @return The number of sprites.
+   */
+  const uint32_t &getDrawnSpritesCount() const
+  {
+    return drawnSpritesCount;
+  }
+
+  /**
+   * Get the number of sprites left out since their textures didn't fit into the texture array, since it was created.
+   *
+   * @return The number of sprites.
+   */
+  const uint32_t &getSkippedSpritesCount() const
+  {
+    return skippedSpritesCount;
+  }
+};
+
+// Initialize the black alpha flag static variable, as the top bit of the layer.
+const GLuint SpriteBatch::BLACK_ALPHA_FLAG = 1u << 31;
+// Initialize the fragment shaders of the sprites static variables.
+const std::string SpriteBatch::UNLIT_FRAGMENT_SHADER_FILE_PATH = "assets/shaders/fragment/unlit.glsl";
+const std::string SpriteBatch::UNLIT_BLACK_ALPHA_FRAGMENT_SHADER_FILE_PATH = "assets/shaders/fragment/unlit_black_alpha.glsl";
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef INCLUDE_SPSC_QUEUE_CPP
+#define INCLUDE_SPSC_QUEUE_CPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * Class for a fixed-size queue between exactly one thread pushing into it and one thread popping from it, which needs no
+ *   locking. Each thread only writes its own end of the ring, and publishes it with release ordering once the slot it
+ *   moved past is written or read, so the other thread sees the slot as it was left.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+private:
+  // The slots of the ring.
+  std::array<T, Capacity> slots;
+  // The number of values popped, written only by the popping thread, and the number of values pushed, written only by
+  //   the pushing thread. They're kept on their own cache lines, so the threads don't contend over them.
+  alignas(64) std::atomic<size_t> head;
+  alignas(64) std::atomic<size_t> tail;
+
+public:
+  SpscQueue()
+      : slots(),
+        head(0),
+        tail(0) {}
+
+  // Preventing copying the queue, since the threads hold on to it.
+  SpscQueue(const SpscQueue &) = delete;
+
+  /**
+   * Push a value into the queue, from the pushing thread.
+   *
+   * @param value  The value, which is only moved from if it was pushed.
+   *
+   * @return Whether the value was pushed, which it isn't if the queue is full.
+   */
+  bool push(T &&value)
+  {
+    const auto currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail - head.load(std::memory_order_acquire) == Capacity)
+    {
+      return false;
+    }
+    slots[currentTail % Capacity] = std::move(value);
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Pop the oldest value from the queue, from the popping thread.
+   *
+   * @param value  The value, set if one was popped.
+   *
+   * @return Whether a value was popped, which it isn't if the queue is empty.
+   */
+  bool pop(T &value)
+  {
+    const auto currentHead = head.load(std::memory_order_relaxed);
+    if (currentHead == tail.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    value = std::move(slots[currentHead % Capacity]);
+    head.store(currentHead + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef INCLUDE_STARTUP_CPP
+#define INCLUDE_STARTUP_CPP
+
+#include <string>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#include "thread_affinity.cpp"
+#include "log.cpp"
+
+/**
+ * The phases the engine starts up in, in the order they're started.
+ */
+enum class StartupPhase : uint32_t
+{
+  WINDOW = 0,
+  GL = 1,
+  FONTS = 2,
+  SHADERS = 3,
+  FIRST_SCENE = 4,
+};
+
+// The number of phases the engine starts up in.
+const uint32_t STARTUP_PHASES_COUNT = 5;
+
+// The names of the phases, for reporting.
+const std::array<std::string, STARTUP_PHASES_COUNT> startupPhaseNames = {"Window", "GL", "Fonts", "Shaders", "First Scene"};
+
+/**
+ * Class for timing the phases the engine starts up in, from the start of the game until its first scene is initialized.
+ *   The phases run on worker threads overlap the phases of the main thread, so the time taken to start up is the time the
+ *   last phase ended at rather than the sum of the phases.
+ */
+class StartupProfiler
+{
+private:
+  /**
+   * Structure for the time a phase ran at.
+   */
+  struct StartupPhaseTime
+  {
+    // The time the phase started at since the game started, and the time it took, in milliseconds.
+    double_t startTime;
+    double_t duration;
+    // Whether the phase ran on a thread other than the main thread.
+    bool onWorker;
+    // Whether the phase ran at all.
+    bool ran;
+  };
+
+  // The time the game started at, and the thread it started on.
+  const std::chrono::steady_clock::time_point startTime;
+  const std::thread::id mainThreadId;
+  // The lock guarding the times of the phases, since the phases on the workers end while the main thread runs others.
+  mutable std::mutex phaseTimesMutex;
+  std::array<StartupPhaseTime, STARTUP_PHASES_COUNT> phaseTimes;
+  // Whether the engine has started up, after which no more phases run.
+  bool finished;
+
+  StartupProfiler()
+      : startTime(std::chrono::steady_clock::now()),
+        mainThreadId(std::this_thread::get_id()),
+        phaseTimesMutex(),
+        phaseTimes(),
+        finished(false)
+  {
+    phaseTimes.fill({0.0, 0.0, false, false});
+  }
+
+  /**
+   * Get the time since the game started.
+   *
+   * @return The elapsed time, in milliseconds.
+   */
+  double_t getElapsedTime() const
+  {
+    return std::chrono::duration<double_t, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+  }
+
+public:
+  /**
+   * Returns the singleton instance of the startup profiler, which starts the clock the phases are timed with, so it's
+   *   asked for first thing in the game.
+   *
+   * @return The startup profiler singleton instance.
+   */
+  static StartupProfiler &getInstance()
+  {
+    // Singleton instance of the startup profiler, constructed the first time it's asked for.
+    static StartupProfiler instance;
+    return instance;
+  }
+
+  /**
+   * Run a phase of starting up on the calling thread, and time it.
+   *
+   * @param phase     The phase.
+   * @param function  The function running the phase.
+   */
+  template <typename Function>
+  void runPhase(const StartupPhase &phase, const Function &function)
+  {
+    const auto phaseStartTime = getElapsedTime();
+    function();
+    const auto phaseEndTime = getElapsedTime();
+
+    std::lock_guard<std::mutex> lock(phaseTimesMutex);
+    phaseTimes[static_cast<uint32_t>(phase)] = {phaseStartTime, phaseEndTime - phaseStartTime, std::this_thread::get_id() != mainThreadId, true};
+  }
+
+  /**
+   * Check if the engine has started up.
+   *
+   * @return Whether the engine has started up.
+   */
+  bool isFinished() const
+  {
+    return finished;
+  }
+
+  /**
+   * Mark the engine as started up, and log the times of its phases along with the cores the threads were placed on.
+   */
+  void finish()
+  {
+    finished = true;
+    Logger::getInstance().info("Started up in ", getStartupTime(), " ms");
+    for (uint32_t i = 0; i < STARTUP_PHASES_COUNT; i++)
+    {
+      const auto phaseTime = getPhaseTime(static_cast<StartupPhase>(i));
+      if (phaseTime.ran)
+      {
+        Logger::getInstance().info("  ", startupPhaseNames[i], ": ", phaseTime.duration, " ms at ", phaseTime.startTime, " ms", (phaseTime.onWorker ? " on a worker" : ""));
+      }
+    }
+    ThreadLayout::getInstance().log();
+  }
+
+  /**
+   * Get the time a phase of starting up ran at.
+   *
+   * @param phase  The phase.
+   *
+   * @return The time of the phase, which is all zero if it didn't run.
+   */
+  StartupPhaseTime getPhaseTime(const StartupPhase &phase) const
+  {
+    std::lock_guard<std::mutex> lock(phaseTimesMutex);
+    return phaseTimes[static_cast<uint32_t>(phase)];
+  }
+
+  /**
+   * Get the time the engine took to start up, being the time the last of its phases ended at.
+   *
+   * @return The time taken to start up, in milliseconds.
+   */
+  double_t getStartupTime() const
+  {
+    std::lock_guard<std::mutex> lock(phaseTimesMutex);
+    double_t startupTime = 0.0;
+    for (const auto &phaseTime : phaseTimes)
+    {
+      startupTime = std::max(startupTime, phaseTime.startTime + phaseTime.duration);
+    }
+    return startupTime;
+  }
+};
+
+#endif
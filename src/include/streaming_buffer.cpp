@@ -0,0 +1,267 @@
+#ifndef INCLUDE_STREAMING_BUFFER_CPP
+#define INCLUDE_STREAMING_BUFFER_CPP
+
+#include <array>
+#include <cstring>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "gl_state.cpp"
+#include "constants.cpp"
+#include "window.cpp"
+#include "log.cpp"
+
+/**
+ * Class for a buffer of data written every frame, like dynamic geometry and per-instance data. The buffer is split into
+ *   a ring of regions, one for each of the frames the GPU can still be reading from, so writing the data of a frame never
+ *   has to wait for the GPU or make the driver reallocate the buffer. Each region is fenced once the frame is done with
+ *   it, and only waited on when the ring comes back around to it. The buffer stays mapped where persistent mapping is
+ *   supported, and is mapped unsynchronized for every write otherwise.
+ */
+class StreamingBuffer
+{
+private:
+  // The ID of the buffer.
+  GLuint bufferId;
+  // The size of each region of the buffer.
+  size_t regionSize;
+  // Whether the buffer is mapped persistently, and the pointer to its mapped storage if so.
+  bool isPersistentlyMapped;
+  uint8_t *mappedStorage;
+  // The fences placed after the commands reading each region were queued, or null if the region isn't being read.
+  std::array<GLsync, STREAMING_BUFFER_REGION_COUNT> regionFences;
+  // The index of the region the current frame is writing to.
+  uint32_t regionIndex;
+  // The number of bytes written to the region of the current frame, and whether its fence has been waited on.
+  size_t regionUsedSize;
+  bool isRegionReady;
+
+  /**
+   * Create the storage of the buffer for the current region size, mapping it persistently if supported.
+   */
+  void createStorage()
+  {
+    const auto storageSize = regionSize * STREAMING_BUFFER_REGION_COUNT;
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      // Create and map the storage by name, which always supports persistent mapping, without touching the bindings.
+      const GLbitfield storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glCreateBuffers(1, &bufferId);
+      glNamedBufferStorage(bufferId, storageSize, NULL, storageFlags);
+      isPersistentlyMapped = true;
+      mappedStorage = static_cast<uint8_t *>(glMapNamedBufferRange(bufferId, 0, storageSize, storageFlags));
+      if (mappedStorage == nullptr)
+      {
+        Logger::getInstance().error("Failed at mapping streaming buffer");
+        exit(1);
+      }
+      return;
+    }
+    glGenBuffers(1, &bufferId);
+    GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+    isPersistentlyMapped = GLEW_ARB_buffer_storage;
+    if (isPersistentlyMapped)
+    {
+      // Coherent mapping makes the writes visible to the GPU without flushing them.
+      const GLbitfield storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_COPY_WRITE_BUFFER, storageSize, NULL, storageFlags);
+      mappedStorage = static_cast<uint8_t *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, storageSize, storageFlags));
+      if (mappedStorage == nullptr)
+      {
+        Logger::getInstance().error("Failed at mapping streaming buffer");
+        exit(1);
+      }
+    }
+    else
+    {
+      glBufferData(GL_COPY_WRITE_BUFFER, storageSize, NULL, GL_STREAM_DRAW);
+      mappedStorage = nullptr;
+    }
+    GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+  /**
+   * Delete the storage of the buffer, dropping the fences of its regions. The driver keeps the storage around until the
+   *   GPU is done reading it.
+   */
+  void destroyStorage()
+  {
+    if (isPersistentlyMapped && WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      glUnmapNamedBuffer(bufferId);
+    }
+    else if (isPersistentlyMapped)
+    {
+      GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+      glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+      GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    GlStateCache::getInstance().deleteBuffers(1, &bufferId);
+    for (auto &regionFence : regionFences)
+    {
+      if (regionFence != nullptr)
+      {
+        glDeleteSync(regionFence);
+        regionFence = nullptr;
+      }
+    }
+  }
+
+  /**
+   * Wait for the GPU to be done reading the region of the current frame, before the frame writes to it.
+   */
+  void waitForRegion()
+  {
+    auto &regionFence = regionFences[regionIndex];
+    if (regionFence != nullptr)
+    {
+      // The wait only times out so the commands get flushed, so keep waiting until the fence is signalled.
+      while (glClientWaitSync(regionFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+      {
+      }
+      glDeleteSync(regionFence);
+      regionFence = nullptr;
+    }
+    isRegionReady = true;
+  }
+
+  /**
+   * Get the offset within the region of the current frame the next data would be written at.
+   *
+   * @param alignment  The alignment in bytes of the data.
+   *
+   * @return The offset within the region.
+   */
+  size_t getAlignedUsedSize(const size_t &alignment) const
+  {
+    return (regionUsedSize + alignment - 1) / alignment * alignment;
+  }
+
+public:
+  /**
+   * Create a streaming buffer.
+   *
+   * @param regionSize  The number of bytes each frame can write before the buffer has to grow.
+   */
+  StreamingBuffer(const size_t &regionSize)
+      : bufferId(0),
+        regionSize(regionSize),
+        isPersistentlyMapped(false),
+        mappedStorage(nullptr),
+        regionFences(),
+        regionIndex(0),
+        regionUsedSize(0),
+        isRegionReady(false)
+  {
+    regionFences.fill(nullptr);
+    createStorage();
+  }
+
+  // Preventing copying the streaming buffer, since it owns the buffer and the fences.
+  StreamingBuffer(const StreamingBuffer &) = delete;
+
+  ~StreamingBuffer()
+  {
+    destroyStorage();
+  }
+
+  /**
+   * Get the ID of the buffer, which changes whenever the buffer grows, so it should be read again every frame.
+   *
+   * @return The ID of the buffer.
+   */
+  const GLuint &getBufferId() const
+  {
+    return bufferId;
+  }
+
+  /**
+   * Get the size of the storage of the buffer, across all its regions.
+   *
+   * @return The size in bytes.
+   */
+  size_t getStorageSize() const
+  {
+    return regionSize * STREAMING_BUFFER_REGION_COUNT;
+  }
+
+  /**
+   * Make sure the given number of bytes can still be written in the current frame without the buffer growing, so data
+   *   written in several parts ends up in the same buffer.
+   *
+   * @param size       The number of bytes.
+   * @param alignment  The alignment in bytes of the first part.
+   */
+  void reserve(const size_t &size, const size_t &alignment = 16)
+  {
+    if (getAlignedUsedSize(alignment) + size <= regionSize)
+    {
+      return;
+    }
+    // Grow the buffer into new storage, which nothing is reading yet. The data already written this frame stays in the
+    //   old storage, which the commands queued with it still read from.
+    destroyStorage();
+    while (regionSize < size)
+    {
+      regionSize *= 2;
+    }
+    regionSize *= 2;
+    createStorage();
+    regionUsedSize = 0;
+    isRegionReady = true;
+  }
+
+  /**
+   * Write the data to the region of the current frame.
+   *
+   * @param data       The data.
+   * @param size       The size of the data in bytes.
+   * @param alignment  The alignment in bytes the data needs within the buffer.
+   *
+   * @return The offset in bytes of the data within the buffer.
+   */
+  size_t write(const void *data, const size_t &size, const size_t &alignment = 16)
+  {
+    reserve(size, alignment);
+    if (!isRegionReady)
+    {
+      waitForRegion();
+    }
+
+    const auto regionOffset = getAlignedUsedSize(alignment);
+    const auto bufferOffset = regionIndex * regionSize + regionOffset;
+    if (isPersistentlyMapped)
+    {
+      std::memcpy(mappedStorage + bufferOffset, data, size);
+    }
+    else if (size > 0)
+    {
+      // The region is known to be free, so there's nothing for the driver to synchronize.
+      GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+      const auto mappedRange = glMapBufferRange(GL_COPY_WRITE_BUFFER, bufferOffset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+      std::memcpy(mappedRange, data, size);
+      glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+      GlStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    regionUsedSize = regionOffset + size;
+    return bufferOffset;
+  }
+
+  /**
+   * Finish the current frame once all the commands reading its data were queued, fencing its region and moving on to
+   *   the next one.
+   */
+  void endFrame()
+  {
+    if (regionUsedSize > 0)
+    {
+      regionFences[regionIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    regionIndex = (regionIndex + 1) % STREAMING_BUFFER_REGION_COUNT;
+    regionUsedSize = 0;
+    isRegionReady = false;
+  }
+};
+
+#endif
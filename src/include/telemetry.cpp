@@ -0,0 +1,417 @@
+#ifndef INCLUDE_TELEMETRY_CPP
+#define INCLUDE_TELEMETRY_CPP
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#else
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include "constants.cpp"
+#include "spsc_queue.cpp"
+#include "memory.cpp"
+#include "render_stats.cpp"
+#include "benchmark.cpp"
+#include "thread_affinity.cpp"
+#include "log.cpp"
+
+#ifdef _WIN32
+typedef SOCKET TelemetrySocket;
+const TelemetrySocket INVALID_TELEMETRY_SOCKET = INVALID_SOCKET;
+#else
+typedef int TelemetrySocket;
+const TelemetrySocket INVALID_TELEMETRY_SOCKET = -1;
+#endif
+// The flags the responses to the scrapes are sent with, which keep a scraper closing the connection early from raising
+//   SIGPIPE on Linux and ending the game. Windows doesn't raise it, and macOS has it turned off on the socket instead.
+#ifdef MSG_NOSIGNAL
+const int TELEMETRY_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int TELEMETRY_SEND_FLAGS = 0;
+#endif
+
+/**
+ * A manager class for exporting the measurements of the frames to a monitoring system while the game runs, for the
+ *   machines whose overlay can't be seen. The frames are pushed into a lock-free queue by the thread running the scene,
+ *   and dropped if the queue is full, so the frame loop never waits on the exporter. The exporter thread keeps the latest
+ *   frames and serves their percentiles, the render stats, the memory of each subsystem and the counts of the models of
+ *   the latest frame as a Prometheus scrape endpoint over HTTP.
+ */
+class TelemetryExporter
+{
+private:
+  // The frames pushed by the thread running the scene and not yet taken by the exporter thread.
+  SpscQueue<BenchmarkFrame, TELEMETRY_QUEUE_SIZE> pendingFrames;
+  // The number of frames dropped since the queue was full.
+  std::atomic<uint64_t> droppedFramesCount;
+
+  // The exporter thread, and whether it was asked to stop.
+  std::thread thread;
+  std::atomic<bool> stopRequested;
+  // The socket the scrapes are accepted on.
+  TelemetrySocket listenSocket;
+
+  // The latest frames taken from the queue, as a ring of at most TELEMETRY_WINDOW_FRAMES frames, along with the number
+  //   of frames taken so far and the sums of their times. Only the exporter thread touches them.
+  std::vector<BenchmarkFrame> windowFrames;
+  uint64_t framesCount;
+  double_t frameTimesSum;
+  double_t cpuRenderTimesSum;
+  double_t gpuRenderTimesSum;
+
+  TelemetryExporter()
+      : pendingFrames(),
+        droppedFramesCount(0),
+        thread(),
+        stopRequested(false),
+        listenSocket(INVALID_TELEMETRY_SOCKET),
+        windowFrames({}),
+        framesCount(0),
+        frameTimesSum(0.0),
+        cpuRenderTimesSum(0.0),
+        gpuRenderTimesSum(0.0) {}
+
+  /**
+   * Close a socket.
+   *
+   * @param socket  The socket.
+   */
+  static void closeSocket(const TelemetrySocket &socket)
+  {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+  }
+
+  /**
+   * Wait for a socket to have something to read, such as a scrape to accept.
+   *
+   * @param socket   The socket.
+   * @param timeout  The longest time to wait, in milliseconds.
+   *
+   * @return Whether the socket has something to read.
+   */
+  static bool waitForReadable(const TelemetrySocket &socket, const int32_t &timeout)
+  {
+#ifdef _WIN32
+    WSAPOLLFD pollSocket = {socket, POLLRDNORM, 0};
+    return WSAPoll(&pollSocket, 1, timeout) > 0;
+#else
+    pollfd pollSocket = {socket, POLLIN, 0};
+    return poll(&pollSocket, 1, timeout) > 0;
+#endif
+  }
+
+  /**
+   * Take the frames pushed since the last time into the window of the latest frames.
+   */
+  void takePendingFrames()
+  {
+    BenchmarkFrame frame;
+    while (pendingFrames.pop(frame))
+    {
+      if (windowFrames.size() < TELEMETRY_WINDOW_FRAMES)
+      {
+        windowFrames.push_back(frame);
+      }
+      else
+      {
+        windowFrames[framesCount % TELEMETRY_WINDOW_FRAMES] = frame;
+      }
+      framesCount++;
+      frameTimesSum += frame.frameTime;
+      cpuRenderTimesSum += frame.cpuRenderTime;
+      gpuRenderTimesSum += frame.gpuRenderTime;
+    }
+  }
+
+  /**
+   * Write the percentiles of a time over the window of the latest frames as a Prometheus summary, with the sum and the
+   *   count of every frame taken so far.
+   *
+   * @param metrics  The stream to write to.
+   * @param name     The name of the metric.
+   * @param help     The description of the metric.
+   * @param values   The values of the time in each frame of the window.
+   * @param sum      The sum of the values of every frame taken so far.
+   */
+  void writeSummary(std::ostringstream &metrics, const std::string &name, const std::string &help, std::vector<double_t> values, const double_t &sum) const
+  {
+    std::sort(values.begin(), values.end());
+    metrics << "# HELP " << name << " " << help << "\n# TYPE " << name << " summary\n";
+    for (const auto &quantile : {0.5, 0.95, 0.99})
+    {
+      metrics << name << "{quantile=\"" << quantile << "\"} " << BenchmarkRecorder::getPercentile(values, quantile) << "\n";
+    }
+    metrics << name << "_sum " << sum << "\n"
+            << name << "_count " << framesCount << "\n";
+  }
+
+  /**
+   * Write the header of a Prometheus gauge.
+   *
+   * @param metrics  The stream to write to.
+   * @param name     The name of the metric.
+   * @param help     The description of the metric.
+   */
+  static void writeGaugeHeader(std::ostringstream &metrics, const std::string &name, const std::string &help)
+  {
+    metrics << "# HELP " << name << " " << help << "\n# TYPE " << name << " gauge\n";
+  }
+
+  /**
+   * Write the metrics of the latest frames in the Prometheus text format.
+   *
+   * @return The metrics.
+   */
+  std::string writeMetrics() const
+  {
+    std::ostringstream metrics;
+    metrics << "# HELP game_frames_total The number of frames exported.\n# TYPE game_frames_total counter\ngame_frames_total " << framesCount << "\n";
+    metrics << "# HELP game_telemetry_dropped_frames_total The number of frames dropped since the exporter fell behind.\n"
+            << "# TYPE game_telemetry_dropped_frames_total counter\ngame_telemetry_dropped_frames_total " << droppedFramesCount.load(std::memory_order_relaxed) << "\n";
+    if (windowFrames.empty())
+    {
+      return metrics.str();
+    }
+
+    std::vector<double_t> frameTimes({}), cpuRenderTimes({}), gpuRenderTimes({});
+    for (const auto &frame : windowFrames)
+    {
+      frameTimes.push_back(frame.frameTime);
+      cpuRenderTimes.push_back(frame.cpuRenderTime);
+      gpuRenderTimes.push_back(frame.gpuRenderTime);
+    }
+    writeSummary(metrics, "game_frame_time_milliseconds", "The time the frames took on the CPU.", frameTimes, frameTimesSum);
+    writeSummary(metrics, "game_cpu_render_time_milliseconds", "The time the CPU took to submit the rendering of the scene.", cpuRenderTimes, cpuRenderTimesSum);
+    writeSummary(metrics, "game_gpu_render_time_milliseconds", "The time the GPU took to render the scene.", gpuRenderTimes, gpuRenderTimesSum);
+
+    // The counts are the ones of the latest frame.
+    const auto &latestFrame = windowFrames[(framesCount - 1) % TELEMETRY_WINDOW_FRAMES];
+    writeGaugeHeader(metrics, "game_render_draw_calls", "The draw calls of each render pass in the latest frame.");
+    for (uint32_t i = 0; i < RENDER_PASSES_COUNT; i++)
+    {
+      metrics << "game_render_draw_calls{pass=\"" << renderPassNames[i] << "\"} " << latestFrame.renderStats[i].drawCalls << "\n";
+    }
+    writeGaugeHeader(metrics, "game_render_triangles", "The triangles drawn by each render pass in the latest frame.");
+    for (uint32_t i = 0; i < RENDER_PASSES_COUNT; i++)
+    {
+      metrics << "game_render_triangles{pass=\"" << renderPassNames[i] << "\"} " << latestFrame.renderStats[i].triangles << "\n";
+    }
+    const auto totalRenderStats = sumRenderStats(latestFrame.renderStats);
+    writeGaugeHeader(metrics, "game_render_instances", "The instances drawn in the latest frame.");
+    metrics << "game_render_instances " << totalRenderStats.instances << "\n";
+    writeGaugeHeader(metrics, "game_render_uploaded_bytes", "The bytes written to buffers of the GPU in the latest frame.");
+    metrics << "game_render_uploaded_bytes " << totalRenderStats.uploadedBytes << "\n";
+    writeGaugeHeader(metrics, "game_render_state_changes", "The state changes made in the latest frame.");
+    metrics << "game_render_state_changes " << totalRenderStats.stateChanges << "\n";
+
+    writeGaugeHeader(metrics, "game_memory_cpu_bytes", "The CPU memory allocated by the containers of each subsystem.");
+    for (uint32_t i = 0; i < MEMORY_SUBSYSTEMS_COUNT; i++)
+    {
+      metrics << "game_memory_cpu_bytes{subsystem=\"" << MemoryManager::getSubsystemName(i) << "\"} " << latestFrame.memorySizes.cpuSizes[i] << "\n";
+    }
+    writeGaugeHeader(metrics, "game_memory_gpu_bytes", "The GPU memory of the buffers and textures of each subsystem.");
+    for (uint32_t i = 0; i < MEMORY_SUBSYSTEMS_COUNT; i++)
+    {
+      metrics << "game_memory_gpu_bytes{subsystem=\"" << MemoryManager::getSubsystemName(i) << "\"} " << latestFrame.memorySizes.gpuSizes[i] << "\n";
+    }
+
+    writeGaugeHeader(metrics, "game_models", "The models of the scene in the latest frame.");
+    metrics << "game_models " << latestFrame.modelsCount << "\n";
+    writeGaugeHeader(metrics, "game_model_bytes", "The CPU memory of each model of the scene in the latest frame, on average.");
+    metrics << "game_model_bytes " << latestFrame.memorySizes.cpuSizes[static_cast<uint32_t>(MemorySubsystem::MODELS)] / std::max<uint32_t>(latestFrame.modelsCount, 1) << "\n";
+    writeGaugeHeader(metrics, "game_collision_checks", "The narrowphase collision tests made in the latest frame.");
+    metrics << "game_collision_checks " << latestFrame.collisionChecksCount << "\n";
+    writeGaugeHeader(metrics, "game_heap_allocations", "The heap allocations made during the latest frame.");
+    metrics << "game_heap_allocations " << latestFrame.allocationsCount << "\n";
+    return metrics.str();
+  }
+
+  /**
+   * Answer a scrape with the metrics of the latest frames, whatever it asked for.
+   *
+   * @param clientSocket  The socket of the scrape.
+   */
+  void serveScrape(const TelemetrySocket &clientSocket) const
+  {
+    // Read the request, which only has to arrive, since every path is answered with the metrics.
+    char request[1024];
+    if (waitForReadable(clientSocket, 100))
+    {
+      recv(clientSocket, request, sizeof(request), 0);
+    }
+    const auto body = writeMetrics();
+    const auto response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " + std::to_string(body.size()) +
+                          "\r\nConnection: close\r\n\r\n" + body;
+    size_t sentSize = 0;
+    while (sentSize < response.size())
+    {
+      const auto sent = send(clientSocket, response.data() + sentSize, static_cast<int>(response.size() - sentSize), TELEMETRY_SEND_FLAGS);
+      if (sent <= 0)
+      {
+        break;
+      }
+      sentSize += sent;
+    }
+  }
+
+  /**
+   * Take the frames pushed by the thread running the scene and answer the scrapes, until the exporter is asked to stop.
+   */
+  void runExporter()
+  {
+    ThreadLayout::getInstance().applyToCurrentThread(ThreadRole::TELEMETRY);
+    while (!stopRequested.load(std::memory_order_acquire))
+    {
+      const auto scrapePending = waitForReadable(listenSocket, 100);
+      takePendingFrames();
+      if (scrapePending)
+      {
+        const auto clientSocket = accept(listenSocket, nullptr, nullptr);
+        if (clientSocket != INVALID_TELEMETRY_SOCKET)
+        {
+#ifdef SO_NOSIGPIPE
+          // Sending to a scraper that closed the connection early mustn't raise SIGPIPE, which would end the game.
+          const int noSigpipe = 1;
+          setsockopt(clientSocket, SOL_SOCKET, SO_NOSIGPIPE, reinterpret_cast<const char *>(&noSigpipe), sizeof(noSigpipe));
+#endif
+          serveScrape(clientSocket);
+          closeSocket(clientSocket);
+        }
+      }
+    }
+  }
+
+public:
+  // Preventing copying the telemetry exporter, making sure only one instance can exist.
+  TelemetryExporter(const TelemetryExporter &) = delete;
+
+  ~TelemetryExporter()
+  {
+    stop();
+  }
+
+  /**
+   * Returns the singleton instance of the telemetry exporter.
+   *
+   * @return The telemetry exporter singleton instance.
+   */
+  static TelemetryExporter &getInstance()
+  {
+    // Singleton instance of the telemetry exporter, constructed the first time it's asked for.
+    static TelemetryExporter instance;
+    return instance;
+  }
+
+  /**
+   * Check if the exporter is running, so the frames are worth pushing to it.
+   *
+   * @return Whether the exporter is running.
+   */
+  bool isRunning() const
+  {
+    return thread.joinable();
+  }
+
+  /**
+   * Start serving the metrics of the frames on the given port of every interface of the machine.
+   *
+   * @param port  The port.
+   *
+   * @return Whether the exporter could listen on the port.
+   */
+  bool start(const uint16_t &port)
+  {
+    if (isRunning())
+    {
+      return true;
+    }
+#ifdef _WIN32
+    WSADATA socketsData;
+    if (WSAStartup(MAKEWORD(2, 2), &socketsData) != 0)
+    {
+      Logger::getInstance().error("Failed at telemetry 1");
+      return false;
+    }
+#endif
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket == INVALID_TELEMETRY_SOCKET)
+    {
+      Logger::getInstance().error("Failed at telemetry 2");
+      return false;
+    }
+    // Let the port be listened on again right after the game restarts.
+    const int32_t reuseAddress = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuseAddress), sizeof(reuseAddress));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listenSocket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(listenSocket, 4) != 0)
+    {
+      Logger::getInstance().error("Failed at telemetry 3");
+      closeSocket(listenSocket);
+      listenSocket = INVALID_TELEMETRY_SOCKET;
+      return false;
+    }
+    windowFrames.reserve(TELEMETRY_WINDOW_FRAMES);
+    stopRequested.store(false, std::memory_order_relaxed);
+    thread = std::thread(&TelemetryExporter::runExporter, this);
+    Logger::getInstance().info("Serving telemetry on port ", port);
+    return true;
+  }
+
+  /**
+   * Stop serving the metrics, once the scrape being answered is done.
+   */
+  void stop()
+  {
+    if (!isRunning())
+    {
+      return;
+    }
+    stopRequested.store(true, std::memory_order_release);
+    thread.join();
+    closeSocket(listenSocket);
+    listenSocket = INVALID_TELEMETRY_SOCKET;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+  }
+
+  /**
+   * Push the measurements of a frame to the exporter, from the thread running the scene. The frame is dropped if the
+   *   exporter fell too far behind to take it.
+   *
+   * @param frame  The measurements of the frame.
+   */
+  void addFrame(BenchmarkFrame &&frame)
+  {
+    if (!pendingFrames.push(std::move(frame)))
+    {
+      droppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+};
+
+#endif
@@ -1,21 +1,37 @@
 #ifndef INCLUDE_TEXT_CPP
 #define INCLUDE_TEXT_CPP
 
-#include <iostream>
 #include <map>
+#include <list>
+#include <optional>
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <charconv>
+#include <type_traits>
+#include <future>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include "gl_state.cpp"
 #include "constants.cpp"
 #include "common.cpp"
 #include "window.cpp"
 #include "shader.cpp"
+#include "streaming_buffer.cpp"
+#include "memory.cpp"
+#include "gl_debug.cpp"
+#include "asset_archive.cpp"
+#include "startup.cpp"
+#include "thread_affinity.cpp"
+#include "log.cpp"
 
 /**
  * Class containing information about a text character.
@@ -27,198 +43,739 @@ class TextCharacter
   friend class TextCharacterSet;
 
 private:
-  const unsigned char character;
-  const uint32_t characterSetLayerId;
+  const char32_t character;
   const glm::vec2 size;
   const glm::vec2 bearing;
   const float_t advance;
+  // The corners of the character in the glyph atlas, as UVs.
+  const glm::vec2 minUv;
   const glm::vec2 maxUv;
 
 public:
-  TextCharacter(const unsigned char &character,
+  TextCharacter(const char32_t &character,
                 const glm::vec2 &size,
                 const glm::vec2 &bearing,
                 const float_t &advance,
-                const glm::vec2 &maxUv,
-                const uint32_t &characterSetLayerId)
+                const glm::vec2 &minUv,
+                const glm::vec2 &maxUv)
       : character(character),
-        characterSetLayerId(characterSetLayerId),
         size(size),
         bearing(bearing),
         advance(advance),
+        minUv(minUv),
         maxUv(maxUv) {}
 
-  const unsigned char &getCharacter() const
+  const char32_t &getCharacter() const
   {
     return character;
   }
 };
 
+/**
+ * The ways the glyphs of a character set can be stored in its atlas.
+ */
+enum class TextRenderMode
+{
+  // The coverage of the glyphs, rendered at the size of the text, which gets blurry once the text is scaled.
+  BITMAP,
+  // The distance of each pixel from the outline of the glyphs, which stays sharp at any scale.
+  SIGNED_DISTANCE_FIELD
+};
+
+/**
+ * Class for the characters of a font, rasterized into the cells of a glyph atlas the first time they're used. Once every
+ *   cell is taken, the character used the longest time ago gives up its cell, so fonts with far more characters than the
+ *   atlas holds only keep the ones being shown.
+ */
 class TextCharacterSet
 {
   // Let the text manager access private variables.
   friend class TextManager;
 
 private:
+  /**
+   * Structure for a rendered glyph waiting to be copied into the atlas.
+   */
+  struct GlyphBitmap
+  {
+    uint32_t width;
+    uint32_t height;
+    glm::vec2 bearing;
+    float_t advance;
+    // The rows of the glyph, without any padding between them.
+    std::vector<uint8_t> pixels;
+  };
+
+  /**
+   * Structure for a character rasterized into the atlas.
+   */
+  struct CachedCharacter
+  {
+    TextCharacter textCharacter;
+    // The cell of the atlas the glyph is stored in, or no cell for glyphs without any pixels, which are never evicted.
+    uint32_t cellIndex;
+    // The frame the character was last used in.
+    uint64_t lastUsedFrame;
+    // The position of the character in the list of the characters stored in cells, by when they were last used.
+    std::list<char32_t>::iterator recentlyUsedPosition;
+  };
+
+  // The number of empty pixels kept around each glyph in the atlas, so filtering never picks up the neighbouring glyphs.
+  static const uint32_t GLYPH_PADDING = 1;
+  // The cell index of the characters without a cell.
+  static const uint32_t NO_CELL = std::numeric_limits<uint32_t>::max();
+
   const std::string fontId;
   const std::string fontFilePath;
+  const TextRenderMode renderMode;
+
+  // The FreeType library and the face of the font, kept open to rasterize the characters the first time they're used,
+  //   along with the font file the face reads from.
+  FT_Library freeType;
+  FT_Face fontFace;
+  AssetFile fontFile;
+  // The scale from the size the glyphs are rasterized at to the size of the text.
+  float_t metricsScale;
+
+  // The texture of the glyph atlas, holding the characters stored in its cells, created once the atlas is.
+  GLuint characterTextureId;
+  // The width and height of the cells of the atlas, including the padding after the glyph, and the number of cells along
+  //   each side of the atlas.
+  uint32_t cellSize;
+  uint32_t cellsPerRow;
+  // The size of the glyph atlas, in bytes.
+  uint64_t atlasSize;
+
+  std::map<const char32_t, CachedCharacter> characterMap;
+  // The characters by their values for the first characters, pointing into the map of characters, so finding a
+  //   character is a single load from a flat table.
+  std::array<CachedCharacter *, std::numeric_limits<unsigned char>::max() + 1> characterLookup;
+  // The characters stored in cells, from the most recently used to the least.
+  std::list<char32_t> recentlyUsedCharacters;
+  // The cells of the atlas no character is stored in.
+  std::vector<uint32_t> freeCells;
+  // The glyphs rasterized ahead of their characters being used, waiting to be copied into the atlas.
+  std::map<const char32_t, GlyphBitmap> rasterizedGlyphs;
+  // The character handed out for a character that didn't fit in the atlas, drawn blank.
+  std::optional<TextCharacter> blankCharacter;
+  // The frame the characters are being used in, and the number of times a character gave up its cell, which moves the
+  //   characters of the text built before.
+  uint64_t currentFrame;
+  uint64_t atlasGeneration;
+
+  GLuint createTexture()
+  {
+    GLuint newTextureId;
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      // Create the texture by name, its storage is allocated once the size of the atlas is known.
+      glCreateTextures(GL_TEXTURE_2D, 1, &newTextureId);
+      return newTextureId;
+    }
+    glGenTextures(1, &newTextureId);
+    return newTextureId;
+  }
 
-  const GLuint characterTextureArrayId;
+  /**
+   * Find the distance of every pixel to the nearest pixel marked as a seed, with two sweeps over the pixels that carry the
+   *   offset to the nearest seed found so far over from the neighbouring pixels.
+   *
+   * @param seeds   Whether each pixel is a seed, row by row.
+   * @param width   The width of the pixels.
+   * @param height  The height of the pixels.
+   *
+   * @return The distances, in pixels.
+   */
+  static std::vector<float_t> findSeedDistances(const std::vector<bool> &seeds, const int32_t &width, const int32_t &height)
+  {
+    // Pixels without any seed found yet are as far as can be, without the squared length overflowing.
+    std::vector<glm::ivec2> offsets(width * height, glm::ivec2(1 << 14));
+    for (int32_t i = 0; i < width * height; i++)
+    {
+      if (seeds[i])
+      {
+        offsets[i] = glm::ivec2(0);
+      }
+    }
 
-  std::map<const unsigned char, const TextCharacter> characterMap;
+    const auto compare = [&](const int32_t &x, const int32_t &y, const int32_t &offsetX, const int32_t &offsetY) {
+      if (x + offsetX < 0 || x + offsetX >= width || y + offsetY < 0 || y + offsetY >= height)
+      {
+        return;
+      }
+      auto &offset = offsets[y * width + x];
+      const auto neighbourOffset = offsets[(y + offsetY) * width + x + offsetX] + glm::ivec2(offsetX, offsetY);
+      if (neighbourOffset.x * neighbourOffset.x + neighbourOffset.y * neighbourOffset.y < offset.x * offset.x + offset.y * offset.y)
+      {
+        offset = neighbourOffset;
+      }
+    };
+
+    // Carry the offsets down from the pixels above and to the left, then up from the pixels below and to the right.
+    for (int32_t y = 0; y < height; y++)
+    {
+      for (int32_t x = 0; x < width; x++)
+      {
+        compare(x, y, -1, 0);
+        compare(x, y, 0, -1);
+        compare(x, y, -1, -1);
+        compare(x, y, 1, -1);
+      }
+      for (int32_t x = width - 1; x >= 0; x--)
+      {
+        compare(x, y, 1, 0);
+      }
+    }
+    for (int32_t y = height - 1; y >= 0; y--)
+    {
+      for (int32_t x = width - 1; x >= 0; x--)
+      {
+        compare(x, y, 1, 0);
+        compare(x, y, 0, 1);
+        compare(x, y, -1, 1);
+        compare(x, y, 1, 1);
+      }
+      for (int32_t x = 0; x < width; x++)
+      {
+        compare(x, y, -1, 0);
+      }
+    }
 
-  GLuint createTextureArray()
+    std::vector<float_t> distances(width * height);
+    for (int32_t i = 0; i < width * height; i++)
+    {
+      distances[i] = glm::length(glm::vec2(offsets[i]));
+    }
+    return distances;
+  }
+
+  /**
+   * Turn the coverage of the glyph into its signed distance field, growing it by the spread on each side so the field
+   *   has room to fall off outside the outline.
+   *
+   * @param glyphBitmap  The glyph, replaced with its distance field.
+   */
+  static void createDistanceField(GlyphBitmap &glyphBitmap)
   {
-    GLuint newTextureArrayId;
-    glGenTextures(1, &newTextureArrayId);
-    return newTextureArrayId;
+    const int32_t width = glyphBitmap.width + 2 * TEXT_SDF_SPREAD;
+    const int32_t height = glyphBitmap.height + 2 * TEXT_SDF_SPREAD;
+    std::vector<bool> insidePixels(width * height, false);
+    std::vector<bool> outsidePixels(width * height, true);
+    for (uint32_t y = 0; y < glyphBitmap.height; y++)
+    {
+      for (uint32_t x = 0; x < glyphBitmap.width; x++)
+      {
+        const auto pixelIndex = (y + TEXT_SDF_SPREAD) * width + x + TEXT_SDF_SPREAD;
+        insidePixels[pixelIndex] = glyphBitmap.pixels[y * glyphBitmap.width + x] >= 128;
+        outsidePixels[pixelIndex] = !insidePixels[pixelIndex];
+      }
+    }
+
+    // Store the distance as 0.5 on the outline, rising inside the glyph and falling outside it, reaching the ends at the
+    //   spread.
+    const auto distancesToInside = findSeedDistances(insidePixels, width, height);
+    const auto distancesToOutside = findSeedDistances(outsidePixels, width, height);
+    glyphBitmap.pixels.assign(width * height, 0);
+    for (int32_t i = 0; i < width * height; i++)
+    {
+      const auto signedDistance = distancesToOutside[i] - distancesToInside[i];
+      glyphBitmap.pixels[i] = static_cast<uint8_t>(glm::clamp(0.5f + signedDistance / (2.0f * TEXT_SDF_SPREAD), 0.0f, 1.0f) * 255.0f);
+    }
+
+    glyphBitmap.width = width;
+    glyphBitmap.height = height;
+    glyphBitmap.bearing += glm::vec2(-1.0f * TEXT_SDF_SPREAD, 1.0f * TEXT_SDF_SPREAD);
   }
 
   void loadFont(const std::string &fontId, const std::string &fontFilePath)
   {
-    FT_Library freeType;
     if (FT_Init_FreeType(&freeType))
     {
-      std::cout << fontId << std::endl
-                << "Failed at text character set 1" << std::endl;
+      Logger::getInstance().error(fontId, "\nFailed at text character set 1");
       exit(1);
     }
 
-    FT_Face fontFace;
-    if (FT_New_Face(freeType, fontFilePath.c_str(), 0, &fontFace))
+    // Read the face from the font file where it's held, from the asset archive if it's packed in it.
+    if (!AssetFileSystem::getInstance().open(fontFilePath, fontFile) ||
+        FT_New_Memory_Face(freeType, fontFile.getData(), static_cast<FT_Long>(fontFile.getSize()), 0, &fontFace))
     {
-      std::cout << fontId << std::endl
-                << "Failed at text character set 2" << std::endl;
+      Logger::getInstance().error(fontId, "\nFailed at text character set 2");
       exit(1);
     }
 
-    FT_Set_Pixel_Sizes(fontFace, 0, TEXT_HEIGHT);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    glBindTexture(GL_TEXTURE_2D_ARRAY, characterTextureArrayId);
+    // Distance fields are rendered at a fixed size and scaled to the size of the text, so the same atlas serves any size.
+    const auto isDistanceField = renderMode == TextRenderMode::SIGNED_DISTANCE_FIELD;
+    const auto glyphSize = isDistanceField ? TEXT_SDF_GLYPH_SIZE : TEXT_HEIGHT;
+    metricsScale = static_cast<float_t>(TEXT_HEIGHT) / glyphSize;
+    FT_Set_Pixel_Sizes(fontFace, 0, glyphSize);
+
+    // Make the cells big enough for a line of the font or its widest advance, along with the room the distance field
+    //   grows the glyphs by. The rare glyphs reaching further are cut off at the edges of their cells.
+    const auto lineHeight = static_cast<uint32_t>((fontFace->size->metrics.height + 63) / 64);
+    const auto maxAdvance = static_cast<uint32_t>((fontFace->size->metrics.max_advance + 63) / 64);
+    cellSize = std::max(lineHeight, maxAdvance) + (isDistanceField ? 2 * TEXT_SDF_SPREAD : 0) + GLYPH_PADDING;
+    cellsPerRow = (TEXT_GLYPH_ATLAS_SIZE - GLYPH_PADDING) / cellSize;
+    atlasSize = uint64_t(TEXT_GLYPH_ATLAS_SIZE) * TEXT_GLYPH_ATLAS_SIZE;
+    // Hand the cells out from the first one.
+    for (uint32_t i = cellsPerRow * cellsPerRow; i > 0; i--)
+    {
+      freeCells.push_back(i - 1);
+    }
+    characterLookup.fill(nullptr);
 
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Rasterize the printable ASCII characters up front, which most of the text is made of, so the first frames showing
+    //   them only have to copy their glyphs into the atlas.
+    for (char32_t character = ' '; character <= '~'; character++)
+    {
+      rasterizedGlyphs.emplace(character, rasterizeGlyph(character));
+    }
+  }
 
-    float_t maxWidth = 0;
-    float_t maxRows = 0;
-    for (unsigned char character = 0; character < std::numeric_limits<unsigned char>::max(); character++)
+  /**
+   * Create the texture of the glyph atlas, allocated cleared so the padding around the glyphs is always empty. Unlike
+   *   loading the font, it has to be done on the thread the GL context is current on.
+   */
+  void createAtlas()
+  {
+    characterTextureId = createTexture();
+    const std::vector<uint8_t> atlasPixels(atlasSize, 0);
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
     {
-      if (FT_Load_Char(fontFace, character, FT_LOAD_RENDER))
+      // Allocate the immutable storage of the atlas and fill it by name, without binding it.
+      glTextureStorage2D(characterTextureId, 1, GL_R8, TEXT_GLYPH_ATLAS_SIZE, TEXT_GLYPH_ATLAS_SIZE);
+      GpuDebugLabels::labelObject(GL_TEXTURE, characterTextureId, fontId + " Font Atlas");
+
+      glTextureParameteri(characterTextureId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTextureParameteri(characterTextureId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTextureParameteri(characterTextureId, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTextureParameteri(characterTextureId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      glTextureSubImage2D(characterTextureId, 0, 0, 0, TEXT_GLYPH_ATLAS_SIZE, TEXT_GLYPH_ATLAS_SIZE, GL_RED, GL_UNSIGNED_BYTE, &atlasPixels[0]);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else
+    {
+      GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, characterTextureId);
+      GpuDebugLabels::labelObject(GL_TEXTURE, characterTextureId, fontId + " Font Atlas");
+
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      if (WindowManager::getInstance().isTextureStorageSupported())
+      {
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, TEXT_GLYPH_ATLAS_SIZE, TEXT_GLYPH_ATLAS_SIZE);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TEXT_GLYPH_ATLAS_SIZE, TEXT_GLYPH_ATLAS_SIZE, GL_RED, GL_UNSIGNED_BYTE, &atlasPixels[0]);
+      }
+      else
       {
-        std::cout << fontId << std::endl
-                  << "Failed at text character set 3" << std::endl;
-        continue;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, TEXT_GLYPH_ATLAS_SIZE, TEXT_GLYPH_ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, &atlasPixels[0]);
       }
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-      maxWidth = glm::max(maxWidth, static_cast<float_t>(fontFace->glyph->bitmap.width));
-      maxRows = glm::max(maxRows, static_cast<float_t>(fontFace->glyph->bitmap.rows));
+      GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
     }
+  }
 
-    std::vector<uint8_t> clearData(maxWidth * maxRows, 0);
-    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RED, maxWidth, maxRows, std::numeric_limits<unsigned char>::max(), 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+  /**
+   * Render the glyph of the character, along with its metrics.
+   *
+   * @param character  The character.
+   *
+   * @return The glyph, which is empty for characters without any pixels, or that failed to render.
+   */
+  GlyphBitmap rasterizeGlyph(const char32_t &character) const
+  {
+    if (FT_Load_Char(fontFace, character, FT_LOAD_RENDER))
+    {
+      Logger::getInstance().error(fontId, "\nFailed at text character set 3");
+      return {0, 0, glm::vec2(0.0f), 0.0f, {}};
+    }
 
-    for (unsigned char character = 0; character < std::numeric_limits<unsigned char>::max(); character++)
+    const auto &bitmap = fontFace->glyph->bitmap;
+    GlyphBitmap glyphBitmap({bitmap.width, bitmap.rows,
+                             glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap_left), static_cast<float_t>(fontFace->glyph->bitmap_top)),
+                             static_cast<float_t>(fontFace->glyph->advance.x) / 64.0f,
+                             std::vector<uint8_t>(bitmap.width * bitmap.rows)});
+    for (uint32_t row = 0; row < bitmap.rows; row++)
     {
-      if (FT_Load_Char(fontFace, character, FT_LOAD_RENDER))
-      {
-        std::cout << fontId << std::endl
-                  << "Failed at text character set 4" << std::endl;
-        continue;
-      }
+      std::copy_n(bitmap.buffer + row * bitmap.pitch, bitmap.width, glyphBitmap.pixels.begin() + row * bitmap.width);
+    }
+    if (renderMode == TextRenderMode::SIGNED_DISTANCE_FIELD && !glyphBitmap.pixels.empty())
+    {
+      createDistanceField(glyphBitmap);
+    }
+    return glyphBitmap;
+  }
 
-      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<uint32_t>(character), maxWidth, maxRows, 1, GL_RED, GL_UNSIGNED_BYTE, &clearData[0]);
-      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<uint32_t>(character), fontFace->glyph->bitmap.width, fontFace->glyph->bitmap.rows, 1, GL_RED, GL_UNSIGNED_BYTE, fontFace->glyph->bitmap.buffer);
+  /**
+   * Get the position of the bottom-left corner of the glyph in the cell of the atlas.
+   *
+   * @param cellIndex  The index of the cell.
+   *
+   * @return The position of the glyph, in pixels.
+   */
+  glm::uvec2 getCellPosition(const uint32_t &cellIndex) const
+  {
+    return glm::uvec2(cellIndex % cellsPerRow, cellIndex / cellsPerRow) * cellSize + GLYPH_PADDING;
+  }
 
-      const TextCharacter textCharacter(
-          character,
-          glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap.width), static_cast<float_t>(fontFace->glyph->bitmap.rows)),
-          glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap_left), static_cast<float_t>(fontFace->glyph->bitmap_top)),
-          static_cast<float_t>(fontFace->glyph->advance.x) / 64.0f,
-          glm::vec2(static_cast<float_t>(fontFace->glyph->bitmap.width) / maxWidth, static_cast<float_t>(fontFace->glyph->bitmap.rows) / maxRows),
-          (uint32_t)character);
-      characterMap.insert(std::pair<const unsigned char, const TextCharacter>(character, textCharacter));
+  /**
+   * Copy the glyph into the cell of the atlas, clearing the rest of the cell so nothing of the glyph stored there before
+   *   remains around it. The glyph is cut off at the edges of the cell.
+   *
+   * @param cellIndex    The index of the cell.
+   * @param glyphBitmap  The glyph, cut down to the size of the cell.
+   */
+  void uploadGlyph(const uint32_t &cellIndex, GlyphBitmap &glyphBitmap) const
+  {
+    const auto glyphCellSize = cellSize - GLYPH_PADDING;
+    std::vector<uint8_t> cellPixels(glyphCellSize * glyphCellSize, 0);
+    const auto copiedWidth = std::min(glyphBitmap.width, glyphCellSize);
+    const auto copiedHeight = std::min(glyphBitmap.height, glyphCellSize);
+    for (uint32_t row = 0; row < copiedHeight; row++)
+    {
+      std::copy_n(glyphBitmap.pixels.begin() + row * glyphBitmap.width, copiedWidth, cellPixels.begin() + row * glyphCellSize);
     }
+    glyphBitmap.width = copiedWidth;
+    glyphBitmap.height = copiedHeight;
 
-    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    const auto cellPosition = getCellPosition(cellIndex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (WindowManager::getInstance().isDirectStateAccessSupported())
+    {
+      glTextureSubImage2D(characterTextureId, 0, cellPosition.x, cellPosition.y, glyphCellSize, glyphCellSize, GL_RED, GL_UNSIGNED_BYTE, &cellPixels[0]);
+    }
+    else
+    {
+      GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, characterTextureId);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, cellPosition.x, cellPosition.y, glyphCellSize, glyphCellSize, GL_RED, GL_UNSIGNED_BYTE, &cellPixels[0]);
+      GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+    }
     glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  }
 
-    FT_Done_Face(fontFace);
-    FT_Done_FreeType(freeType);
+  /**
+   * Find a cell of the atlas for a new glyph, taking the cell of the least recently used character once they're all
+   *   taken. The characters used in the current frame keep their cells, since the text of the frame is built with them.
+   *
+   * @return The index of the cell, or no cell if every cell holds a character used in the current frame.
+   */
+  uint32_t findFreeCell()
+  {
+    if (!freeCells.empty())
+    {
+      const auto cellIndex = freeCells.back();
+      freeCells.pop_back();
+      return cellIndex;
+    }
+    if (recentlyUsedCharacters.empty())
+    {
+      return NO_CELL;
+    }
+    const auto leastRecentlyUsed = characterMap.find(recentlyUsedCharacters.back());
+    if (leastRecentlyUsed->second.lastUsedFrame == currentFrame)
+    {
+      return NO_CELL;
+    }
+
+    // Evict the character, which moves the characters of the text built before.
+    const auto cellIndex = leastRecentlyUsed->second.cellIndex;
+    if (leastRecentlyUsed->first < characterLookup.size())
+    {
+      characterLookup[leastRecentlyUsed->first] = nullptr;
+    }
+    characterMap.erase(leastRecentlyUsed);
+    recentlyUsedCharacters.pop_back();
+    atlasGeneration++;
+    return cellIndex;
+  }
+
+  /**
+   * Rasterize the character into a cell of the atlas, and add it to the characters of the set.
+   *
+   * @param character  The character.
+   *
+   * @return The added character, or nothing if the atlas has no room for it in the current frame.
+   */
+  CachedCharacter *loadCharacter(const char32_t &character)
+  {
+    // Take the glyph rasterized up front if there's one, it's rasterized again if it's ever evicted.
+    const auto rasterizedGlyph = rasterizedGlyphs.find(character);
+    auto glyphBitmap = rasterizedGlyph != rasterizedGlyphs.end() ? std::move(rasterizedGlyph->second) : rasterizeGlyph(character);
+    if (rasterizedGlyph != rasterizedGlyphs.end())
+    {
+      rasterizedGlyphs.erase(rasterizedGlyph);
+    }
+    auto cellIndex = NO_CELL;
+    if (!glyphBitmap.pixels.empty())
+    {
+      cellIndex = findFreeCell();
+      if (cellIndex == NO_CELL)
+      {
+        // The character is drawn blank, and rasterized again once it's used in a later frame.
+        blankCharacter.emplace(character, glm::vec2(0.0f), glm::vec2(0.0f), glyphBitmap.advance * metricsScale, glm::vec2(0.0f), glm::vec2(0.0f));
+        return nullptr;
+      }
+      uploadGlyph(cellIndex, glyphBitmap);
+    }
+
+    const auto glyphPosition = cellIndex != NO_CELL ? glm::vec2(getCellPosition(cellIndex)) : glm::vec2(0.0f);
+    const auto glyphSize = glm::vec2(static_cast<float_t>(glyphBitmap.width), static_cast<float_t>(glyphBitmap.height));
+    const TextCharacter textCharacter(
+        character,
+        glyphSize * metricsScale,
+        glyphBitmap.bearing * metricsScale,
+        glyphBitmap.advance * metricsScale,
+        glyphPosition / float_t(TEXT_GLYPH_ATLAS_SIZE),
+        (glyphPosition + glyphSize) / float_t(TEXT_GLYPH_ATLAS_SIZE));
+    auto &cachedCharacter = characterMap.insert(std::pair<const char32_t, CachedCharacter>(character, {textCharacter, cellIndex, currentFrame, recentlyUsedCharacters.end()})).first->second;
+    if (cellIndex != NO_CELL)
+    {
+      recentlyUsedCharacters.push_front(character);
+      cachedCharacter.recentlyUsedPosition = recentlyUsedCharacters.begin();
+    }
+    if (character < characterLookup.size())
+    {
+      characterLookup[character] = &cachedCharacter;
+    }
+    return &cachedCharacter;
   }
 
-  TextCharacterSet(const std::string &fontId, const std::string &fontFilePath)
+  TextCharacterSet(const std::string &fontId, const std::string &fontFilePath, const TextRenderMode &renderMode)
       : fontId(fontId),
         fontFilePath(fontFilePath),
-        characterTextureArrayId(createTextureArray())
+        renderMode(renderMode),
+        freeType(nullptr),
+        fontFace(nullptr),
+        fontFile(),
+        metricsScale(1.0f),
+        characterTextureId(0),
+        cellSize(0),
+        cellsPerRow(0),
+        atlasSize(0),
+        characterMap({}),
+        characterLookup({}),
+        recentlyUsedCharacters({}),
+        freeCells({}),
+        rasterizedGlyphs({}),
+        blankCharacter(),
+        currentFrame(0),
+        atlasGeneration(0)
   {
+    // Loading the font doesn't touch the GL context, so the character set can be created on any thread, with its atlas
+    //   created after on the thread the context is current on.
     loadFont(fontId, fontFilePath);
   }
 
 public:
+  // Preventing copying the character set, since it owns the face of the font and points into its own characters.
+  TextCharacterSet(const TextCharacterSet &) = delete;
+
+  ~TextCharacterSet()
+  {
+    FT_Done_Face(fontFace);
+    FT_Done_FreeType(freeType);
+  }
+
   const std::string &getFontId() const
   {
     return fontId;
   }
 
-  const TextCharacter &getCharacter(const unsigned char &character) const
+  const TextRenderMode &getRenderMode() const
+  {
+    return renderMode;
+  }
+
+  const uint64_t &getAtlasSize() const
+  {
+    return atlasSize;
+  }
+
+  /**
+   * Get the number of times a character gave up its cell of the atlas, which moves the characters of the text built
+   *   before it changed.
+   *
+   * @return The atlas generation.
+   */
+  const uint64_t &getAtlasGeneration() const
+  {
+    return atlasGeneration;
+  }
+
+  /**
+   * Start a new frame of using the characters, letting the characters used in the frames before give up their cells.
+   */
+  void beginFrame()
+  {
+    currentFrame++;
+  }
+
+  /**
+   * Get the character, rasterizing it into the atlas if it's the first time it's used, and marking it as used in the
+   *   current frame.
+   *
+   * @param character  The character.
+   *
+   * @return The character, only valid until the next character is found.
+   */
+  const TextCharacter &getCharacter(const char32_t &character)
   {
-    return characterMap.at(character);
+    auto cachedCharacter = character < characterLookup.size() ? characterLookup[character] : nullptr;
+    if (cachedCharacter == nullptr)
+    {
+      const auto foundCharacter = characterMap.find(character);
+      cachedCharacter = foundCharacter != characterMap.end() ? &foundCharacter->second : loadCharacter(character);
+      if (cachedCharacter == nullptr)
+      {
+        return *blankCharacter;
+      }
+    }
+
+    cachedCharacter->lastUsedFrame = currentFrame;
+    if (cachedCharacter->cellIndex != NO_CELL)
+    {
+      recentlyUsedCharacters.splice(recentlyUsedCharacters.begin(), recentlyUsedCharacters, cachedCharacter->recentlyUsedPosition);
+    }
+    return cachedCharacter->textCharacter;
   }
 };
 
 /**
- * Class for containing the details of the text to render.
+ * Structure for the details of the text to render, as plain data pointing into the text of the frame, so adding text
+ *   allocates nothing once the lists of the frame have grown.
  */
-class TextDetails
+struct TextDetails
 {
-private:
-  // The text content to render.
-  const std::string content;
+  // The offset of the text content in the text of the frame, and its length.
+  uint32_t contentOffset;
+  uint32_t contentLength;
   // The position of the text, with the origin being the bottom-left of the screen.
-  const glm::vec2 position;
+  glm::vec2 position;
   // The normalized scale of the text, where a value of 1.0f is 100% the default size of the text.
-  const float_t scale;
+  float_t scale;
+  // The color of the text, as 8-bit RGBA.
+  glm::u8vec4 color;
+};
 
-public:
-  TextDetails(
-      const std::string &content,
-      const glm::vec2 &position,
-      const float_t &scale)
-      : content(content),
-        position(position),
-        scale(scale) {}
+/**
+ * Structure for the instance record of a character of text, which the text vertex shader expands into the quad of the
+ *   character.
+ */
+struct TextGlyphInstance
+{
+  // The position of the bottom-left corner of the character on the screen (x, y), and its width and height (z, w), in
+  //   pixels.
+  glm::vec4 rect;
+  // The UVs of the top-left (x, y) and bottom-right (z, w) corners of the glyph in the glyph atlas.
+  glm::vec4 uvRect;
+  // The color of the character, as 8-bit RGBA.
+  glm::u8vec4 color;
+};
+
+/**
+ * Structure for the geometry of a line of text, kept between renders so lines that don't change aren't built again.
+ */
+struct TextLineGeometry
+{
+  // The text content, position, scale and color the geometry was built for.
+  std::string content;
+  glm::vec2 position;
+  float_t scale;
+  glm::u8vec4 color;
+  // The instance records of the characters of the line with any pixels to draw.
+  CountedVector<TextGlyphInstance, MemorySubsystem::TEXT> glyphs;
+  // The generation of the glyph atlas the geometry was built with, since the characters are moved once it changes.
+  uint64_t atlasGeneration;
+
+  TextLineGeometry()
+      : content(""),
+        position(0.0f),
+        scale(0.0f),
+        color(0),
+        glyphs({}),
+        atlasGeneration(0) {}
 
   /**
-   * Get the content of the text.
+   * Check whether the geometry was built for the given text, with the characters where they are in the glyph atlas.
+   * 
+   * @param content          The content of the text.
+   * @param textDetails      The text.
+   * @param atlasGeneration  The current generation of the glyph atlas.
    * 
-   * @return The text content.
+   * @return Whether the geometry is of the text.
    */
-  const std::string &getContent() const
+  bool isGeometryOf(const std::string_view &content, const TextDetails &textDetails, const uint64_t &atlasGeneration) const
   {
-    return content;
+    return this->atlasGeneration == atlasGeneration && scale == textDetails.scale && position == textDetails.position && color == textDetails.color &&
+           this->content == content;
   }
+};
+
+/**
+ * Class for a value shown in the text overlay that changes every frame, such as a frame time, aggregated over the frames
+ *   between the refreshes of the overlay, so a throttled overlay shows the average and the worst of them instead of
+ *   whichever frame happened to refresh it.
+ */
+class TextOverlayValue
+{
+private:
+  // The sum, the count and the largest of the values added since the last refresh.
+  double_t valuesSum;
+  uint32_t valuesCount;
+  double_t maxValue;
+  // The average and the largest value of the frames before the last refresh, which are the ones shown.
+  double_t shownAverage;
+  double_t shownMax;
+
+public:
+  TextOverlayValue()
+      : valuesSum(0.0),
+        valuesCount(0),
+        maxValue(0.0),
+        shownAverage(0.0),
+        shownMax(0.0) {}
 
   /**
-   * Get the position of the text, with the origin being the bottom-left of the screen.
+   * Add the value of a frame.
    * 
-   * @return The text position.
+   * @param value  The value.
    */
-  const glm::vec2 &getPosition() const
+  void add(const double_t &value)
   {
-    return position;
+    valuesSum += value;
+    valuesCount++;
+    maxValue = std::max(maxValue, value);
   }
 
   /**
-   * Get the scale of the text, where a value of 1.0f is 100% the default size of the text.
-   * 
-   * @return The text scale.
+   * Show the average and the largest of the values added since the last refresh, starting over for the next one. Called
+   *   in the frames the overlay is drawn again.
    */
-  const float_t &getScale() const
+  void refresh()
+  {
+    if (valuesCount > 0)
+    {
+      shownAverage = valuesSum / valuesCount;
+      shownMax = maxValue;
+    }
+    valuesSum = 0.0;
+    valuesCount = 0;
+    maxValue = 0.0;
+  }
+
+  const double_t &getAverage() const
   {
-    return scale;
+    return shownAverage;
+  }
+
+  const double_t &getMax() const
+  {
+    return shownMax;
   }
 };
 
@@ -232,72 +789,287 @@ private:
   WindowManager &windowManager;
   ShaderManager &shaderManager;
 
-  static TextManager instance;
-  const static TextCharacterSet characterSet;
+  // The characters of the font of the text.
+  const std::shared_ptr<TextCharacterSet> characterSet;
 
   // The shader program details of the model.
   const std::shared_ptr<const ShaderDetails> textShader;
   const glm::mat4 textProjectionMatrix;
-  const GLuint textVertexBufferId;
-  const GLuint textUvBufferId;
-  const GLuint textUvLayerBufferId;
-
-  std::vector<std::shared_ptr<const TextDetails>> textToRenderMap;
+  // The buffer the instance records of the characters of each frame are streamed through.
+  StreamingBuffer textStreamingBuffer;
+  const GLuint textVertexArrayId;
+  const uint32_t textTextureKey;
+  const uint32_t projectionKey;
+
+  // The text to render in the frame, and the contents of all of it one after the other, both cleared once the frame is
+  //   rendered while keeping their storage.
+  CountedVector<TextDetails, MemorySubsystem::TEXT> textToRender;
+  CountedVector<char, MemorySubsystem::TEXT> frameText;
+  // The geometry of the lines of text of the last render, in the order they were rendered in.
+  CountedVector<TextLineGeometry, MemorySubsystem::TEXT> textLineGeometries;
+  // The list the instance records of all the lines of a frame are gathered in before being streamed, reused between
+  //   renders.
+  CountedVector<TextGlyphInstance, MemorySubsystem::TEXT> frameGlyphs;
+  // Whether the text added is kept to be rendered, which it isn't while the overlay is hidden or between its refreshes,
+  //   so the frames in between don't format the text they'd throw away.
+  bool textAccepted;
+
+  // The texture the overlay was last drawn into and the framebuffer it's attached to, created the first time the overlay
+  //   is throttled, along with whether it holds the overlay being shown, the number of characters drawn into it, and the
+  //   time the overlay is next drawn again at.
+  GLuint overlayTextureId;
+  GLuint overlayFramebufferId;
+  bool overlayCached;
+  uint32_t overlayCharactersCount;
+  double_t nextOverlayRefreshTime;
+  // The shader compositing the overlay texture over the window, and the empty vertex array its triangle covering the
+  //   screen is drawn with.
+  const std::shared_ptr<const ShaderDetails> overlayShader;
+  const GLuint overlayVertexArrayId;
+  const uint32_t overlayTextureKey;
 
   void clearTextToRenderMap()
   {
-    textToRenderMap.clear();
+    textToRender.clear();
+    frameText.clear();
+    textAccepted = true;
   }
 
-  GLuint createTextVertexBuffer()
+  /**
+   * Create the texture the overlay is drawn into, of the size of the viewport, and the framebuffer it's attached to.
+   */
+  void createOverlayTarget()
   {
-    GLuint newBufferId;
-    glGenBuffers(1, &newBufferId);
-
-    glBindBuffer(GL_ARRAY_BUFFER, newBufferId);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float_t) * 6 * 2 * MAX_TEXT_CHARS, NULL, GL_DYNAMIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenTextures(1, &overlayTextureId);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, overlayTextureId);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, VIEWPORT_WIDTH, VIEWPORT_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+    GpuDebugLabels::labelObject(GL_TEXTURE, overlayTextureId, "Text Overlay");
+
+    glGenFramebuffers(1, &overlayFramebufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, overlayFramebufferId);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, overlayTextureId, 0);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
 
-    return newBufferId;
+  /**
+   * Get the content of the text in the text of the frame.
+   * 
+   * @param textDetails  The text.
+   * 
+   * @return The content, only valid until more text is added.
+   */
+  std::string_view getContent(const TextDetails &textDetails) const
+  {
+    return std::string_view(frameText.data() + textDetails.contentOffset, textDetails.contentLength);
   }
 
-  GLuint createTextUvBuffer()
+  /**
+   * Append a part of the content of a text to the text of the frame, writing numbers the same way as `std::to_string`
+   *   does without allocating a string for them.
+   * 
+   * @param part  The part, which can be a number or anything viewable as a string.
+   */
+  template <typename T>
+  void appendTextPart(const T &part)
   {
-    GLuint newBufferId;
-    glGenBuffers(1, &newBufferId);
+    if constexpr (std::is_arithmetic<T>::value)
+    {
+      const auto partOffset = frameText.size();
+      frameText.resize(partOffset + MAX_FORMATTED_NUMBER_LENGTH);
+      const auto partStart = frameText.data() + partOffset;
+      std::to_chars_result result;
+      if constexpr (std::is_floating_point<T>::value)
+      {
+        result = std::to_chars(partStart, partStart + MAX_FORMATTED_NUMBER_LENGTH, part, std::chars_format::fixed, 6);
+      }
+      else
+      {
+        result = std::to_chars(partStart, partStart + MAX_FORMATTED_NUMBER_LENGTH, part);
+      }
+      // Numbers too long to show in a line are only marked.
+      if (result.ec != std::errc())
+      {
+        *partStart = '#';
+        result.ptr = partStart + 1;
+      }
+      frameText.resize(result.ptr - frameText.data());
+    }
+    else
+    {
+      const std::string_view partView(part);
+      frameText.insert(frameText.end(), partView.begin(), partView.end());
+    }
+  }
 
-    glBindBuffer(GL_ARRAY_BUFFER, newBufferId);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float_t) * 6 * 2 * MAX_TEXT_CHARS, NULL, GL_DYNAMIC_DRAW);
+  /**
+   * Decode the character starting at the given offset of the UTF-8 text, moving the offset past it. Malformed sequences
+   *   are decoded as the replacement character, one byte at a time.
+   * 
+   * @param text    The text.
+   * @param offset  The offset of the first byte of the character, moved to the first byte of the next one.
+   * 
+   * @return The character.
+   */
+  static char32_t decodeUtf8Character(const std::string_view &text, size_t &offset)
+  {
+    const char32_t replacementCharacter = 0xfffd;
+    const auto leadByte = static_cast<uint8_t>(text[offset++]);
+    if (leadByte < 0x80)
+    {
+      return leadByte;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // The lead byte gives the number of bytes following it, and the high bits of the character.
+    uint32_t continuationBytesCount;
+    char32_t character;
+    if ((leadByte & 0xe0) == 0xc0)
+    {
+      continuationBytesCount = 1;
+      character = leadByte & 0x1f;
+    }
+    else if ((leadByte & 0xf0) == 0xe0)
+    {
+      continuationBytesCount = 2;
+      character = leadByte & 0x0f;
+    }
+    else if ((leadByte & 0xf8) == 0xf0)
+    {
+      continuationBytesCount = 3;
+      character = leadByte & 0x07;
+    }
+    else
+    {
+      return replacementCharacter;
+    }
+    if (offset + continuationBytesCount > text.size())
+    {
+      return replacementCharacter;
+    }
+    for (uint32_t i = 0; i < continuationBytesCount; i++)
+    {
+      const auto continuationByte = static_cast<uint8_t>(text[offset + i]);
+      if ((continuationByte & 0xc0) != 0x80)
+      {
+        return replacementCharacter;
+      }
+      character = (character << 6) | (continuationByte & 0x3f);
+    }
 
-    return newBufferId;
+    // Characters written with more bytes than they need, the surrogate halves and the values past the last character
+    //   are malformed too.
+    const char32_t minCharacters[] = {0x80, 0x800, 0x10000};
+    if (character < minCharacters[continuationBytesCount - 1] || (character >= 0xd800 && character <= 0xdfff) || character > 0x10ffff)
+    {
+      return replacementCharacter;
+    }
+    offset += continuationBytesCount;
+    return character;
   }
 
-  GLuint createTextUvLayerBuffer()
+  /**
+   * Build the geometry of the characters of the line of text.
+   * 
+   * @param textLine      The line of text.
+   * @param lineGeometry  The geometry to build, replacing what it had.
+   */
+  void buildLineGeometry(const TextDetails &textLine, TextLineGeometry &lineGeometry)
   {
-    GLuint newBufferId;
-    glGenBuffers(1, &newBufferId);
+    const auto content = getContent(textLine);
+    lineGeometry.content.assign(content.begin(), content.end());
+    lineGeometry.position = textLine.position;
+    lineGeometry.scale = textLine.scale;
+    lineGeometry.color = textLine.color;
+    lineGeometry.glyphs.clear();
+
+    auto startX = textLine.position.x * TEXT_WIDTH;
+    for (size_t offset = 0; offset < content.size();)
+    {
+      const auto &textCharacter = characterSet->getCharacter(decodeUtf8Character(content, offset));
 
-    glBindBuffer(GL_ARRAY_BUFFER, newBufferId);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float_t) * 6 * 1 * MAX_TEXT_CHARS, NULL, GL_DYNAMIC_DRAW);
+      const auto xPos = startX + (textCharacter.bearing.x * textLine.scale);
+      const auto yPos = (textLine.position.y * TEXT_HEIGHT) - ((textCharacter.size.y - textCharacter.bearing.y) * textLine.scale);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+      const auto width = textCharacter.size.x * textLine.scale;
+      const auto height = textCharacter.size.y * textLine.scale;
 
-    return newBufferId;
+      // Characters without any pixels, like spaces, only move the characters after them.
+      if (width > 0.0f && height > 0.0f)
+      {
+        lineGeometry.glyphs.push_back({glm::vec4(xPos, yPos, width, height), glm::vec4(textCharacter.minUv, textCharacter.maxUv), textLine.color});
+      }
+
+      startX += textCharacter.advance * textLine.scale;
+    }
+    lineGeometry.atlasGeneration = characterSet->getAtlasGeneration();
+  }
+
+  /**
+   * Point the instance attributes of the text vertex array at the instance records of the frame in the streaming buffer.
+   * 
+   * @param glyphsOffset  The offset in bytes of the instance records of the frame in the streaming buffer.
+   */
+  void attachTextGlyphs(const size_t &glyphsOffset) const
+  {
+    const auto &bufferId = textStreamingBuffer.getBufferId();
+    const auto recordSize = sizeof(TextGlyphInstance);
+    VertexArray::attachInstanceRecordAttribute(VERTEX_POSITION_ATTRIBUTE_LOCATION, bufferId, 4, recordSize, glyphsOffset + offsetof(TextGlyphInstance, rect));
+    VertexArray::attachInstanceRecordAttribute(VERTEX_UV_ATTRIBUTE_LOCATION, bufferId, 4, recordSize, glyphsOffset + offsetof(TextGlyphInstance, uvRect));
+    VertexArray::attachInstanceRecordAttribute(INSTANCE_COLOR_ATTRIBUTE_LOCATION, bufferId, 4, recordSize, glyphsOffset + offsetof(TextGlyphInstance, color), GL_UNSIGNED_BYTE, GL_TRUE);
   }
 
   TextManager()
       : shaderManager(ShaderManager::getInstance()),
         windowManager(WindowManager::getInstance()),
-        textShader(shaderManager.createShaderProgram("Text", "assets/shaders/vertex/text.glsl", "assets/shaders/fragment/text.glsl")),
+        characterSet(loadCharacterSet().get()),
+        textShader(characterSet->getRenderMode() == TextRenderMode::SIGNED_DISTANCE_FIELD
+                       ? shaderManager.createShaderProgram("TextSdf", "assets/shaders/vertex/text.glsl", "assets/shaders/fragment/text_sdf.glsl")
+                       : shaderManager.createShaderProgram("Text", "assets/shaders/vertex/text.glsl", "assets/shaders/fragment/text.glsl")),
         textProjectionMatrix(glm::ortho(0.0f, 1.0f * VIEWPORT_WIDTH, 0.0f, 1.0f * VIEWPORT_HEIGHT)),
-        textVertexBufferId(createTextVertexBuffer()),
-        textUvBufferId(createTextUvBuffer()),
-        textUvLayerBufferId(createTextUvLayerBuffer()) {}
+        textStreamingBuffer(sizeof(TextGlyphInstance) * INITIAL_TEXT_CHARS),
+        textVertexArrayId(VertexArray::create()),
+        textTextureKey(shaderManager.getUniformKey("textTexture")),
+        projectionKey(shaderManager.getUniformKey("projection")),
+        textToRender({}),
+        frameText({}),
+        textLineGeometries({}),
+        frameGlyphs({}),
+        textAccepted(true),
+        overlayTextureId(0),
+        overlayFramebufferId(0),
+        overlayCached(false),
+        overlayCharactersCount(0),
+        nextOverlayRefreshTime(0.0),
+        overlayShader(shaderManager.createShaderProgram("TextOverlay", "assets/shaders/vertex/upscale.glsl", "assets/shaders/fragment/text_overlay.glsl")),
+        overlayVertexArrayId(VertexArray::create()),
+        overlayTextureKey(shaderManager.getUniformKey("overlayTexture"))
+  {
+    characterSet->createAtlas();
+  }
 
 public:
+  /**
+   * Start loading the characters of the font of the text on a worker thread the first time it's called, which opens the
+   *   font and rasterizes its most used characters without touching the GL context. The text manager waits for it once
+   *   it's created, so starting it early lets it overlap the rest of starting up.
+   *
+   * @return The loading characters of the font.
+   */
+  static const std::shared_future<std::shared_ptr<TextCharacterSet>> &loadCharacterSet()
+  {
+    static const auto loadingCharacterSet = launchLoader([] {
+      std::shared_ptr<TextCharacterSet> loadedCharacterSet;
+      StartupProfiler::getInstance().runPhase(StartupPhase::FONTS, [&] {
+        loadedCharacterSet.reset(new TextCharacterSet("Roboto", "assets/fonts/Roboto-Regular.ttf", TextRenderMode::SIGNED_DISTANCE_FIELD));
+      });
+      return loadedCharacterSet;
+    }).share();
+    return loadingCharacterSet;
+  }
+
   /**
    * Returns the singleton instance of the text manager.
    * 
@@ -305,137 +1077,242 @@ public:
    */
   static TextManager &getInstance()
   {
+    // Singleton instance of the debug render manager, constructed the first time it's asked for.
+    static TextManager instance;
     return instance;
   }
 
+  /**
+   * Get the GPU memory used by the text, being the glyph atlas and the buffer the text is streamed through.
+   *
+   * @return The size in bytes.
+   */
+  uint64_t getGpuMemorySize() const
+  {
+    const uint64_t overlaySize = overlayTextureId == 0 ? 0 : uint64_t(VIEWPORT_WIDTH) * VIEWPORT_HEIGHT * 4;
+    return characterSet->getAtlasSize() + textStreamingBuffer.getStorageSize() + overlaySize;
+  }
+
   uint32_t render()
   {
-    std::vector<float_t> characterVertices({});
-    std::vector<float_t> characterUvs({});
-    std::vector<float_t> characterUvLayers({});
-    for (auto &textLine : textToRenderMap)
+    return renderText(false);
+  }
+
+  /**
+   * Start a frame of the text overlay, picking whether the text added in the frame is kept. None of it is while the
+   *   overlay is hidden, and while it's throttled by TEXT_OVERLAY_REFRESH_RATE only the frames refreshing it keep theirs,
+   *   the others compositing the overlay last drawn instead.
+   * 
+   * @param shown        Whether the overlay is shown.
+   * @param currentTime  The time of the frame, in seconds.
+   * 
+   * @return Whether the overlay is drawn again in the frame.
+   */
+  bool beginOverlayFrame(const bool &shown, const double_t &currentTime)
+  {
+    if (!shown)
     {
-      auto startX = textLine->getPosition().x * TEXT_WIDTH;
-      for (auto &ch : textLine->getContent())
-      {
-        if (characterVertices.size() / (6 * 2) >= MAX_TEXT_CHARS)
-        {
-          goto BufferFilled;
-        }
+      textAccepted = false;
+      overlayCached = false;
+      return false;
+    }
+    if (TEXT_OVERLAY_REFRESH_RATE > 0.0f && overlayCached && currentTime < nextOverlayRefreshTime)
+    {
+      textAccepted = false;
+      return false;
+    }
+    textAccepted = true;
+    nextOverlayRefreshTime = currentTime + (TEXT_OVERLAY_REFRESH_RATE > 0.0f ? 1.0 / TEXT_OVERLAY_REFRESH_RATE : 0.0);
+    return true;
+  }
 
-        const auto textCharacter = characterSet.getCharacter(ch);
+  /**
+   * Render the text overlay started by beginOverlayFrame. Unless it's throttled, the text is rendered straight to the
+   *   window. Otherwise the frames refreshing it render the text into the overlay texture, and every frame composites
+   *   the texture over the window with a single triangle.
+   * 
+   * @return The number of characters in the overlay.
+   */
+  uint32_t renderOverlay()
+  {
+    if (TEXT_OVERLAY_REFRESH_RATE <= 0.0f)
+    {
+      overlayCached = false;
+      return render();
+    }
+    if (!textAccepted)
+    {
+      clearTextToRenderMap();
+    }
+    else
+    {
+      if (overlayTextureId == 0)
+      {
+        createOverlayTarget();
+      }
+      GpuDebugGroup overlayRefreshGroup("Text Overlay Refresh");
+      const GLfloat transparent[] = {0.0f, 0.0f, 0.0f, 0.0f};
+      GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, overlayFramebufferId);
+      windowManager.switchToWindowViewport();
+      glClearBufferfv(GL_COLOR, 0, transparent);
+      overlayCharactersCount = renderText(true);
+      GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+      overlayCached = true;
+    }
+    if (!overlayCached || overlayCharactersCount == 0)
+    {
+      return 0;
+    }
 
-        {
-          const auto xPos = startX + (textCharacter.bearing.x * textLine->getScale());
-          const auto yPos = (textLine->getPosition().y * TEXT_HEIGHT) - ((textCharacter.size.y - textCharacter.bearing.y) * textLine->getScale());
-
-          const auto width = textCharacter.size.x * textLine->getScale();
-          const auto height = textCharacter.size.y * textLine->getScale();
-
-          characterVertices.push_back(xPos);
-          characterVertices.push_back(yPos + height);
-          characterVertices.push_back(xPos);
-          characterVertices.push_back(yPos);
-          characterVertices.push_back(xPos + width);
-          characterVertices.push_back(yPos);
-
-          characterVertices.push_back(xPos);
-          characterVertices.push_back(yPos + height);
-          characterVertices.push_back(xPos + width);
-          characterVertices.push_back(yPos);
-          characterVertices.push_back(xPos + width);
-          characterVertices.push_back(yPos + height);
-        }
+    // Composite the overlay, whose colors are already multiplied by their coverage, over the window.
+    GpuDebugGroup overlayGroup("Text Overlay");
+    windowManager.enableBlending(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    GlStateCache::getInstance().setCapability(GL_DEPTH_TEST, false);
+    GlStateCache::getInstance().useProgram(overlayShader->getShaderId());
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, overlayTextureId);
+    glUniform1i(overlayShader->getUniformLocation(overlayTextureKey), 0);
+    GlStateCache::getInstance().bindVertexArray(overlayVertexArrayId);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    GlStateCache::getInstance().bindVertexArray(0);
+    GlStateCache::getInstance().setCapability(GL_DEPTH_TEST, true);
+    windowManager.disableBlending();
+    return overlayCharactersCount;
+  }
 
+private:
+  /**
+   * Render the text added for the frame to the framebuffer bound, clearing it for the next frame.
+   * 
+   * @param premultipliedAlpha  Whether the text is rendered into the overlay texture, keeping its coverage in the alphas
+   *                            and its colors multiplied by it, so it blends over the window the same way once composited.
+   * 
+   * @return The number of characters rendered.
+   */
+  uint32_t renderText(const bool &premultipliedAlpha)
+  {
+    // Build the geometry of the lines that changed since the last render. Building a line can take the cells of the glyph
+    //   atlas of characters of the lines built before, which are then built again, until no more characters move.
+    characterSet->beginFrame();
+    uint64_t builtAtlasGeneration;
+    do
+    {
+      builtAtlasGeneration = characterSet->getAtlasGeneration();
+      for (size_t i = 0; i < textToRender.size(); i++)
+      {
+        if (i == textLineGeometries.size())
         {
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(textCharacter.maxUv.y);
-          characterUvs.push_back(textCharacter.maxUv.x);
-          characterUvs.push_back(textCharacter.maxUv.y);
-
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(0.0f);
-          characterUvs.push_back(textCharacter.maxUv.x);
-          characterUvs.push_back(textCharacter.maxUv.y);
-          characterUvs.push_back(textCharacter.maxUv.x);
-          characterUvs.push_back(0.0f);
+          textLineGeometries.emplace_back();
         }
-
+        auto &lineGeometry = textLineGeometries[i];
+        if (!lineGeometry.isGeometryOf(getContent(textToRender[i]), textToRender[i], characterSet->getAtlasGeneration()))
         {
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
-          characterUvLayers.push_back(static_cast<float_t>(textCharacter.characterSetLayerId));
+          buildLineGeometry(textToRender[i], lineGeometry);
         }
-
-        startX += textCharacter.advance * textLine->getScale();
       }
+    } while (builtAtlasGeneration != characterSet->getAtlasGeneration());
+
+    // Gather the instance records of all the lines to stream them in one go. The streaming buffer grows to fit however
+    //   many characters the frame has.
+    frameGlyphs.clear();
+    for (size_t i = 0; i < textToRender.size(); i++)
+    {
+      const auto &lineGeometry = textLineGeometries[i];
+      frameGlyphs.insert(frameGlyphs.end(), lineGeometry.glyphs.begin(), lineGeometry.glyphs.end());
     }
+    const auto charactersCount = static_cast<uint32_t>(frameGlyphs.size());
+    // Drop the geometry of the lines no longer rendered.
+    textLineGeometries.erase(textLineGeometries.begin() + std::min(textToRender.size(), textLineGeometries.size()), textLineGeometries.end());
 
-  BufferFilled:
+    clearTextToRenderMap();
 
-    if (characterVertices.empty())
+    if (charactersCount == 0)
     {
       return 0;
     }
 
+    GpuDebugGroup textGroup("Text");
+    const auto glyphsOffset = textStreamingBuffer.write(&frameGlyphs[0], sizeof(TextGlyphInstance) * frameGlyphs.size());
+
     windowManager.enableBlending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (premultipliedAlpha)
+    {
+      GlStateCache::getInstance().setBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
 
     // Render text
-    glUseProgram(textShader->getShaderId());
+    GlStateCache::getInstance().useProgram(textShader->getShaderId());
 
-    const auto textTextureId = glGetUniformLocation(textShader->getShaderId(), "textTexture");
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, characterSet.characterTextureArrayId);
+    const auto textTextureId = textShader->getUniformLocation(textTextureKey);
+    GlStateCache::getInstance().activeTexture(GL_TEXTURE0);
+    GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, characterSet->characterTextureId);
     glUniform1i(textTextureId, 0);
 
-    const auto projectionId = glGetUniformLocation(textShader->getShaderId(), "projection");
+    const auto projectionId = textShader->getUniformLocation(projectionKey);
     glUniformMatrix4fv(projectionId, 1, GL_FALSE, &textProjectionMatrix[0][0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, textVertexBufferId);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float_t) * characterVertices.size(), &characterVertices[0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, textUvBufferId);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float_t) * characterUvs.size(), &characterUvs[0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, textUvLayerBufferId);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float_t) * characterUvLayers.size(), &characterUvLayers[0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    { // Define vertex attribute arrays that contains the vertex position, UV coordinates, and normal vector data of the model.
-      VertexAttributeArray vertexArray("VertexArray", textVertexBufferId, 2);
-      VertexAttributeArray uvArray("UvArray", textUvBufferId, 2);
-      VertexAttributeArray normalArray("UvLayerArray", textUvLayerBufferId, 1);
+    // Bind the vertex array object of the text, pointing it at where the instance records of the frame were streamed to,
+    //   and draw a quad of four vertices for each of them.
+    GlStateCache::getInstance().bindVertexArray(textVertexArrayId);
+    attachTextGlyphs(glyphsOffset);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, charactersCount);
+    GlStateCache::getInstance().bindVertexArray(0);
 
-      // Enable them so that it can be used by the GPU.
-      vertexArray.enableAttribute();
-      uvArray.enableAttribute();
-      normalArray.enableAttribute();
-
-      glDrawArrays(GL_TRIANGLES, 0, characterVertices.size() / 2);
-    }
+    // Fence the instance records of the frame now that the draw reading them was queued.
+    textStreamingBuffer.endFrame();
 
     windowManager.disableBlending();
 
+    return charactersCount;
+  }
+
+public:
+  /**
+   * Drop the text added for the frame without rendering it, for frames that aren't drawn.
+   */
+  void discardText()
+  {
     clearTextToRenderMap();
+  }
 
-    return characterUvLayers.size() / 6;
+  /**
+   * Add a line of text to render in the frame.
+   * 
+   * @param content   The content of the text, in UTF-8.
+   * @param position  The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale     The scale of the text, where a value of 1.0f is 100% the default size of the text.
+   * @param color     The color of the text, as 8-bit RGBA.
+   */
+  void addText(const std::string_view &content, const glm::vec2 &position, const float_t &scale, const glm::u8vec4 &color = glm::u8vec4(255))
+  {
+    if (!textAccepted)
+    {
+      return;
+    }
+    const auto contentOffset = frameText.size();
+    appendTextPart(content);
+    textToRender.push_back({static_cast<uint32_t>(contentOffset), static_cast<uint32_t>(content.size()), position, scale, color});
   }
 
-  void addText(const std::string &content, const glm::vec2 &position, const float_t &scale)
+  /**
+   * Add a line of white text to render in the frame, made of the given parts one after the other. The parts are written
+   *   into the text of the frame as they are, so no strings are built for them.
+   * 
+   * @param position  The position of the text, with the origin being the bottom-left of the screen.
+   * @param scale     The scale of the text, where a value of 1.0f is 100% the default size of the text.
+   * @param parts     The parts of the content, each a number or anything viewable as a UTF-8 string.
+   */
+  template <typename... Parts>
+  void addFormattedText(const glm::vec2 &position, const float_t &scale, const Parts &...parts)
   {
-    textToRenderMap.push_back(std::make_shared<const TextDetails>(content, position, scale));
+    if (!textAccepted)
+    {
+      return;
+    }
+    const auto contentOffset = frameText.size();
+    (appendTextPart(parts), ...);
+    textToRender.push_back({static_cast<uint32_t>(contentOffset), static_cast<uint32_t>(frameText.size() - contentOffset), position, scale, glm::u8vec4(255)});
   }
 };
 
-// Initialize the text character set static variable.
-const TextCharacterSet TextManager::characterSet = TextCharacterSet("Roboto", "assets/fonts/Roboto-Regular.ttf");
-// Initialize the text manager singleton instance static variable.
-TextManager TextManager::instance;
-
 #endif
\ No newline at end of file
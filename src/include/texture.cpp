@@ -2,13 +2,50 @@
 #define INCLUDE_TEXTURE_CPP
 
 #include <string>
+#include <filesystem>
 #include <map>
-#include <iostream>
 #include <fstream>
 #include <memory>
+#include <algorithm>
+#include <vector>
+#include <functional>
+#include <future>
+#include <chrono>
+#include <cmath>
+#include <limits>
 
 #include <GL/glew.h>
 
+#include "gl_state.cpp"
+#include "image.cpp"
+#include "constants.cpp"
+#include "residency.cpp"
+#include "file_watcher.cpp"
+#include "memory.cpp"
+#include "gl_debug.cpp"
+#include "window.cpp"
+#include "thread_affinity.cpp"
+#include "log.cpp"
+
+/**
+ * Structure for the mip levels of a texture, where only the coarse levels of a block compressed texture are uploaded at
+ *   first, and the finer ones are streamed in once the models using the texture get big enough on the screen to need them.
+ */
+struct TextureMipLevels
+{
+	// The block compression format of the texture, if streamed.
+	CompressedImageFormat format;
+	// The width and height of the finest mip level of the texture file.
+	uint32_t width;
+	uint32_t height;
+	// The number of mip levels in the texture file, or 0 if the texture isn't streamed.
+	uint32_t levelsCount;
+	// The finest mip level uploaded, which the base level of the texture is clamped to.
+	uint32_t residentLevel;
+	// The number of bytes of the mip levels streamed in, or about to be, since the texture was loaded.
+	uint64_t streamedBytes;
+};
+
 /**
  * Class for containing the details of the shader.
  */
@@ -18,17 +55,30 @@ class TextureDetails
 	friend class TextureManager;
 
 private:
-	// The ID of the texture containing the texture data.
-	const GLuint textureId;
+	// The ID of the texture containing the texture data, which the texture manager swaps in place when the texture file is
+	//   reloaded, so every model sharing the details samples the reloaded texture.
+	mutable GLuint textureId;
+	// The mip levels of the texture, which the texture manager updates as it streams in finer levels.
+	mutable TextureMipLevels mipLevels;
+	// The GPU memory used by the mip levels of the texture, in bytes, which the texture manager updates along with them.
+	mutable uint64_t textureSize;
+	// The finest mip level the models drawn with the texture needed since the texture manager last streamed textures.
+	mutable uint32_t requiredLevel;
+	// The bindless handle of the texture, or 0 if it wasn't asked for since the texture was created.
+	mutable GLuint64 textureHandle;
 
-	// The name of the texture.
+	// The key of the texture, being the normalized path to its file, which is what the texture manager shares it by.
 	const std::string textureName;
 	// The file path to the texture data.
 	const std::string textureFilePath;
 
 public:
-	TextureDetails(const GLuint &textureId, const std::string &textureName, const std::string &textureFilePath)
+	TextureDetails(const GLuint &textureId, const TextureMipLevels &mipLevels, const uint64_t &textureSize, const std::string &textureName, const std::string &textureFilePath)
 			: textureId(textureId),
+				mipLevels(mipLevels),
+				textureSize(textureSize),
+				requiredLevel(std::numeric_limits<uint32_t>::max()),
+				textureHandle(0),
 				textureName(textureName),
 				textureFilePath(textureFilePath) {}
 
@@ -43,9 +93,9 @@ public:
 	}
 
 	/**
-   * Get the ID of the shader program.
+   * Get the key of the texture, shared by every name it was asked for with.
    * 
-   * @return The shader program ID.
+   * @return The texture key.
    */
 	const std::string &getTextureName() const
 	{
@@ -53,19 +103,128 @@ public:
 	}
 };
 
+/**
+ * Structure for containing the image of a texture decoded by a worker thread.
+ */
+struct DecodedTexture
+{
+	// Whether the texture was decoded from a block compressed DDS file.
+	bool compressed;
+	// The uncompressed image of the texture, if not compressed.
+	ImageData image;
+	// The block compressed image of the texture, if compressed.
+	CompressedImageData compressedImage;
+};
+
+/**
+ * Structure for tracking a texture being decoded and uploaded in the background.
+ */
+struct PendingTextureUpload
+{
+	// The key of the texture.
+	std::string textureName;
+	// The file path to the texture data.
+	std::string textureFilePath;
+	// The image of the texture being decoded by a worker thread.
+	std::future<DecodedTexture> decodingTexture;
+	// The decoded image of the texture, once decoding is complete.
+	DecodedTexture decodedTexture;
+	// The ID of the texture, once decoding is complete and its storage is created.
+	GLuint textureId;
+	// The mip level being uploaded.
+	uint32_t uploadLevel;
+	// The next row of the mip level to upload.
+	uint32_t uploadRow;
+	// The number of bytes of the texture uploaded so far.
+	uint64_t uploadedBytes;
+	// The callbacks to call with the details of the texture once it's uploaded.
+	std::vector<std::function<void(const std::shared_ptr<const TextureDetails> &)>> callbacks;
+};
+
+/**
+ * Structure for tracking the finer mip levels of a texture being streamed in.
+ */
+struct PendingTextureStream
+{
+	// The details of the texture being streamed.
+	std::shared_ptr<const TextureDetails> textureDetails;
+	// The texture file being read again by a worker thread for the finer mip levels, until reading is complete.
+	std::future<DecodedTexture> decodingTexture;
+	// The decoded texture file, once reading is complete.
+	DecodedTexture decodedTexture;
+	// The finest mip level to stream in.
+	uint32_t targetLevel;
+};
+
+/**
+ * Structure for a texture replaced while the frames in flight could still be sampling it through its bindless handle.
+ */
+struct RetiredTexture
+{
+	// The ID of the texture.
+	GLuint textureId;
+	// The bindless handle of the texture, or 0 if it had none.
+	GLuint64 textureHandle;
+	// The number of frames left until no frame in flight can be sampling the texture.
+	uint32_t framesLeft;
+	// Whether the texture is deleted, or only its handle was replaced, by one with another sampler.
+	bool deletesTexture;
+};
+
 /**
  * A manager class for managing textures used by models.
  */
 class TextureManager
 {
 private:
-	// Singleton instance of the texture manager.
-	static TextureManager instance;
-
 	// A map of created textures.
-	std::map<const std::string, const std::shared_ptr<const TextureDetails>> namedTextures;
+	CountedMap<const std::string, const std::shared_ptr<const TextureDetails>, MemorySubsystem::TEXTURES> namedTextures;
 	// A map counting the references to the created textures.
-	std::map<const std::string, int32_t> namedTextureReferences;
+	CountedMap<const std::string, int32_t, MemorySubsystem::TEXTURES> namedTextureReferences;
+	// The keys of the textures by the names they were asked for with, which the maps of the textures are keyed by instead,
+	//   so the models loading the same file under different names share a single texture.
+	CountedMap<const std::string, std::string, MemorySubsystem::TEXTURES> textureKeys;
+	// The textures with no more references that are kept resident until they're evicted.
+	ResidencyCache residentTextures;
+
+	// The list of textures being decoded and uploaded in the background, in the order they were requested.
+	CountedVector<std::shared_ptr<PendingTextureUpload>, MemorySubsystem::TEXTURES> pendingUploads;
+	// The ring of pixel buffers used for streaming texture data to the GPU.
+	std::vector<GLuint> uploadBufferIds;
+	// The index of the pixel buffer in the ring to use for the next upload.
+	uint32_t nextUploadBufferIndex;
+	// The number of textures requested and completed since the last time there were no pending uploads, used for reporting progress.
+	uint32_t requestedUploadsCount;
+	uint32_t completedUploadsCount;
+	// The list of textures whose finer mip levels are being streamed in.
+	CountedVector<std::shared_ptr<PendingTextureStream>, MemorySubsystem::TEXTURES> pendingStreams;
+	// The number of bytes of the mip levels streamed in, or about to be, across all the textures.
+	uint64_t streamedTexturesSize;
+	// The replaced textures with bindless handles, and the handles replaced by ones with another sampler, which are deleted
+	//   and made non-resident once the frames in flight are done with them.
+	CountedVector<RetiredTexture, MemorySubsystem::TEXTURES> retiredTextures;
+	// The sampler the bindless handles of the textures are created with, or 0 for the parameters of the textures.
+	GLuint handleSamplerId;
+	// The watcher of the files of the created textures, by the keys of the textures.
+	FileWatcher textureFileWatcher;
+
+	/**
+	 * Get the number of levels of the full mip chain of a texture, down to a single pixel.
+	 * 
+	 * @param width   The width of the texture.
+	 * @param height  The height of the texture.
+	 * 
+	 * @return The number of mip levels.
+	 */
+	static GLsizei getMipLevelCount(const uint32_t &width, const uint32_t &height)
+	{
+		GLsizei levelCount = 1;
+		for (auto size = std::max(width, height); size > 1; size >>= 1)
+		{
+			levelCount++;
+		}
+		return levelCount;
+	}
 
 	/**
 	 * Create a 2D texture of the given width and height, and store the data of the texture.
@@ -81,12 +240,35 @@ private:
 	{
 		// Define a variable for storing the texture ID.
 		GLuint textureId;
+
+		if (WindowManager::getInstance().isDirectStateAccessSupported())
+		{
+			// Create the texture with immutable storage for its whole mip chain, and edit it by name without binding it.
+			glCreateTextures(GL_TEXTURE_2D, 1, &textureId);
+			glTextureStorage2D(textureId, getMipLevelCount(width, height), GL_RGB8, width, height);
+			glTextureSubImage2D(textureId, 0, 0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, textureData);
+			glTextureParameteri(textureId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTextureParameteri(textureId, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTextureParameteri(textureId, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTextureParameteri(textureId, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glGenerateTextureMipmap(textureId);
+			return textureId;
+		}
+
 		// Create a new texture and store the ID.
 		glGenTextures(1, &textureId);
 		// Bind the texture as a 2D texture.
-		glBindTexture(GL_TEXTURE_2D, textureId);
-		// Create a 2D RGB texture image on the bounded texture.
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, textureData);
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureId);
+		// Create a 2D RGB texture image on the bounded texture, with immutable storage for its whole mip chain if supported.
+		if (WindowManager::getInstance().isTextureStorageSupported())
+		{
+			glTexStorage2D(GL_TEXTURE_2D, getMipLevelCount(width, height), GL_RGB8, width, height);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, textureData);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, textureData);
+		}
 
 		// Provide parameters for behaviour when reading coordinates that are out-of-bounds,
 		//   as well as algorithms to use for maginifcation and minification.
@@ -99,128 +281,614 @@ private:
 		glGenerateMipmap(GL_TEXTURE_2D);
 
 		// Unbind the texture now that we're done.
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
 
 		// Return the ID of the created texture.
 		return textureId;
 	}
 
 	/**
-	 * Load the BMP image and create a texture for it.
+	 * Check if the GPU supports sampling textures of the given block compression format.
 	 * 
-	 * @param textureName      The name of the texture being loaded.
-	 * @param textureFilePath  The file path to the texture data.
+	 * @param format  The block compression format.
 	 * 
-	 * @return The ID of the texture.
+	 * @return Whether the format is supported.
+	 */
+	static bool isCompressedFormatSupported(const CompressedImageFormat &format)
+	{
+		return format == BC7 ? GLEW_ARB_texture_compression_bptc : GLEW_EXT_texture_compression_s3tc;
+	}
+
+	/**
+	 * Get the OpenGL internal format of the given block compression format.
+	 * 
+	 * @param format  The block compression format.
+	 * 
+	 * @return The OpenGL internal format.
 	 */
-	GLuint loadBmpTexture(const std::string &textureName, const std::string &textureFilePath)
+	static GLenum getCompressedInternalFormat(const CompressedImageFormat &format)
 	{
-		// Define vectors for storing the BMP metadata information.
-		unsigned char header[54];
-		uint32_t dataPos;
-		uint32_t imageSize;
-		uint32_t width, height;
+		switch (format)
+		{
+		case BC1:
+			return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case BC3:
+			return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		default:
+			return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		}
+	}
 
-		// Open the BMP file.
-		const auto file = fopen(textureFilePath.c_str(), "rb");
-		// Check if the file is accessible.
-		if (!file)
+	/**
+	 * Get the coarsest mip level of the block compressed image that's still loaded up front, which is the first one no
+	 * bigger than the initial streaming size.
+	 * 
+	 * @param imageData  The block compressed image.
+	 * 
+	 * @return The mip level.
+	 */
+	static uint32_t getInitialLevel(const CompressedImageData &imageData)
+	{
+		uint32_t level = 0;
+		while (level + 1 < imageData.levels.size() && std::max(imageData.width, imageData.height) >> level > TEXTURE_STREAMING_INITIAL_SIZE)
+		{
+			level++;
+		}
+		return level;
+	}
+
+	/**
+	 * Get the mip levels a texture created from the decoded texture starts with. Only block compressed textures with a mip
+	 * chain are streamed, since the mip levels of the other textures are generated on the GPU from the finest one.
+	 * 
+	 * @param decodedTexture  The decoded texture.
+	 * 
+	 * @return The mip levels of the texture.
+	 */
+	static TextureMipLevels getMipLevels(const DecodedTexture &decodedTexture)
+	{
+		if (!decodedTexture.compressed)
 		{
-			// Could not read the BMP file. Time to crash.
-			std::cout << textureName << std::endl
-								<< "Failed at texture 1" << std::endl;
-			exit(1);
+			return {BC1, decodedTexture.image.width, decodedTexture.image.height, 0, 0, 0};
 		}
+		const auto &image = decodedTexture.compressedImage;
+		if (image.levels.size() <= 1)
+		{
+			return {image.format, image.width, image.height, 0, 0, 0};
+		}
+		return {image.format, image.width, image.height, static_cast<uint32_t>(image.levels.size()), getInitialLevel(image), 0};
+	}
 
-		// Read the first 54 bytes of the file (contains the BMP header).
-		const auto readBytes = fread(header, 1, 54, file);
-		// Check if we managed to read the first 54 bytes.
-		if (readBytes != 54)
+	/**
+	 * Get the size in bytes of the given mip levels of a block compressed texture, from the size of the blocks of its format.
+	 * 
+	 * @param mipLevels   The mip levels of the texture.
+	 * @param startLevel  The finest mip level to count.
+	 * @param endLevel    The mip level after the coarsest one to count.
+	 * 
+	 * @return The size of the mip levels.
+	 */
+	static uint64_t getCompressedLevelsSize(const TextureMipLevels &mipLevels, const uint32_t &startLevel, const uint32_t &endLevel)
+	{
+		const uint64_t blockSize = mipLevels.format == BC1 ? 8 : 16;
+		uint64_t size = 0;
+		for (auto level = startLevel; level < endLevel; level++)
 		{
-			// Could not read the BMP file. Time to crash.
-			fclose(file);
-			std::cout << textureName << std::endl
-								<< "Failed at texture 2" << std::endl;
-			exit(1);
+			const uint64_t levelWidth = std::max(1u, mipLevels.width >> level), levelHeight = std::max(1u, mipLevels.height >> level);
+			size += (levelWidth + 3) / 4 * ((levelHeight + 3) / 4) * blockSize;
 		}
-		// Check if the first two characters of the header start with "BM".
-		if (header[0] != 'B' || header[1] != 'M')
+		return size;
+	}
+
+	/**
+	 * Create a 2D texture from the block compressed image, uploading its pre-generated mip chain from the given level and
+	 * leaving the finer levels to be streamed in.
+	 * 
+	 * @param imageData   The block compressed image.
+	 * @param firstLevel  The finest mip level to upload.
+	 * 
+	 * @return The ID of the texture.
+	 */
+	GLuint create2dCompressedTexture(const CompressedImageData &imageData, const uint32_t &firstLevel)
+	{
+		// Define a variable for storing the texture ID.
+		GLuint textureId;
+		// Create a new texture and store the ID.
+		glGenTextures(1, &textureId);
+		// Bind the texture as a 2D texture.
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureId);
+
+		// Upload each of the mip levels as is, since the GPU can sample the compressed blocks directly. The storage is only
+		//   immutable when the whole chain is uploaded, since the levels streamed in later are defined once they arrive.
+		const auto internalFormat = getCompressedInternalFormat(imageData.format);
+		const auto immutableStorage = firstLevel == 0 && WindowManager::getInstance().isTextureStorageSupported();
+		if (immutableStorage)
 		{
-			// Invalid file. Time to crash.
-			fclose(file);
-			std::cout << textureName << std::endl
-								<< "Failed at texture 3" << std::endl;
-			exit(1);
+			glTexStorage2D(GL_TEXTURE_2D, imageData.levels.size(), internalFormat, imageData.width, imageData.height);
 		}
-		// Check if number of bits per pixel is 24 (1 byte per color channel).
-		if (*(int32_t *)&(header[0x1C]) != 24)
+		for (auto i = firstLevel; i < imageData.levels.size(); i++)
 		{
-			// Cannot support color format. Time to crash.
-			fclose(file);
-			std::cout << textureName << std::endl
-								<< "Failed at texture 4" << std::endl;
-			exit(1);
+			const auto levelWidth = std::max(1u, imageData.width >> i);
+			const auto levelHeight = std::max(1u, imageData.height >> i);
+			if (immutableStorage)
+			{
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, levelWidth, levelHeight, internalFormat, imageData.levels[i].size(), imageData.levels[i].data());
+			}
+			else
+			{
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, levelWidth, levelHeight, 0, imageData.levels[i].size(), imageData.levels[i].data());
+			}
 		}
-		// Check if compression is enabled.
-		if (*(int32_t *)&(header[0x1E]) != 0)
+
+		// Set the texture wrapping and filtering, only using the mip levels that were uploaded.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, imageData.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, imageData.levels.size() - 1);
+
+		// Unbind the texture now that we're done.
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+
+		// Return the ID of the created texture.
+		return textureId;
+	}
+
+	/**
+	 * Check if the baked DDS file next to the image was written before the image, such as after the image is edited
+	 * without being baked again, in which case the image is loaded instead. Files that aren't on disk, such as the ones
+	 * in the asset archive, count as up to date.
+	 * 
+	 * @param textureFilePath  The file path to the image.
+	 * 
+	 * @return Whether the baked DDS file is older than the image.
+	 */
+	static bool isBakedTextureStale(const std::string &textureFilePath)
+	{
+		std::error_code imageErrorCode, bakedErrorCode;
+		const auto imageWriteTime = std::filesystem::last_write_time(textureFilePath, imageErrorCode);
+		const auto bakedWriteTime = std::filesystem::last_write_time(ImageLoader::getCompressedFilePath(textureFilePath), bakedErrorCode);
+		return !imageErrorCode && !bakedErrorCode && imageWriteTime > bakedWriteTime;
+	}
+
+	/**
+	 * Load the texture from the given file path. DDS files are loaded as block compressed textures. For other images, a
+	 * baked DDS file next to the image is used when present, up to date and supported by the GPU, and the BMP image is
+	 * loaded otherwise.
+	 * 
+	 * @param textureName      The name of the texture being loaded.
+	 * @param textureFilePath  The file path to the texture data.
+	 * @param mipLevels        The mip levels the texture starts with, which are set.
+	 * @param exitOnFailure    Whether to crash if the texture can't be loaded, instead of reporting it.
+	 * 
+	 * @return The ID of the texture, or 0 if it couldn't be loaded.
+	 */
+	GLuint loadTexture(const std::string &textureName, const std::string &textureFilePath, TextureMipLevels &mipLevels, const bool &exitOnFailure = true)
+	{
+		// Check if the texture itself is a DDS file.
+		const auto isDdsFile = textureFilePath.size() >= 4 && textureFilePath.compare(textureFilePath.size() - 4, 4, ".dds") == 0;
+
+		// Try reading the DDS file.
+		DecodedTexture decodedTexture;
+		decodedTexture.compressed = true;
+		if ((isDdsFile || !isBakedTextureStale(textureFilePath)) &&
+				ImageLoader::readDdsFile(isDdsFile ? textureFilePath : ImageLoader::getCompressedFilePath(textureFilePath), decodedTexture.compressedImage) &&
+				isCompressedFormatSupported(decodedTexture.compressedImage.format))
 		{
-			// Cannot support compressed BMPs. Time to crash.
-			fclose(file);
-			std::cout << textureName << std::endl
-								<< "Failed at texture 5" << std::endl;
-			exit(1);
+			mipLevels = getMipLevels(decodedTexture);
+			return create2dCompressedTexture(decodedTexture.compressedImage, mipLevels.residentLevel);
 		}
 
-		// Grab the BMP metadata information
-		dataPos = *(int32_t *)&(header[0x0A]);
-		imageSize = *(int32_t *)&(header[0x22]);
-		width = *(int32_t *)&(header[0x12]);
-		height = *(int32_t *)&(header[0x16]);
+		if (isDdsFile)
+		{
+			// Could not load the DDS file, and there's nothing to fall back to. Time to crash.
+			Logger::getInstance().error(textureName, "\nFailed at texture 6");
+			if (exitOnFailure)
+			{
+				exit(1);
+			}
+			return 0;
+		}
 
-		// Some BMP files can be misformatted, so guess missing information.
-		if (imageSize == 0)
+		// No usable compressed texture, so load the BMP image. The image is uploaded straight from where its mapped file or
+		//   the asset archive holds it, so its pixels aren't copied into a buffer first, and it's only read into one if its
+		//   file is cut short.
+		decodedTexture.compressed = false;
+		MappedImageData mappedImage;
+		if (ImageLoader::mapBmpFile(textureName, textureFilePath, mappedImage, exitOnFailure))
 		{
-			// Image size would be width times height. But since each pixel contains 3 bytes of information
-			//   (one per color channel), multiply that result by 3.
-			imageSize = width * height * 3;
+			decodedTexture.image.width = mappedImage.width;
+			decodedTexture.image.height = mappedImage.height;
+			mipLevels = getMipLevels(decodedTexture);
+			return create2dTexture(mappedImage.pixels, mappedImage.width, mappedImage.height);
 		}
-		if (dataPos == 0)
+		decodedTexture.image = ImageLoader::readBmpFile(textureName, textureFilePath, exitOnFailure);
+		if (decodedTexture.image.pixels.empty())
 		{
-			// Data should start right after the BMP header, which is located at the start of the file and is 54 bytes in size.
-			// So read from that point after.
-			dataPos = 54;
+			return 0;
 		}
+		mipLevels = getMipLevels(decodedTexture);
+		return create2dTexture(decodedTexture.image.pixels.data(), decodedTexture.image.width, decodedTexture.image.height);
+	}
 
-		// Create a buffer for storing the texture RBG data.
-		const auto textureData = new unsigned char[imageSize];
+	/**
+	 * Decode the texture from the given file path without touching OpenGL, so it can be run by a worker thread. A baked
+	 * DDS file is preferred the same way as in loadTexture, unless it's older than the image.
+	 * 
+	 * @param textureName      The name of the texture being decoded.
+	 * @param textureFilePath  The file path to the texture data.
+	 * @param allowCompressed  Whether block compressed DDS files can be used.
+	 * 
+	 * @return The decoded texture.
+	 */
+	static DecodedTexture decodeTexture(const std::string &textureName, const std::string &textureFilePath, const bool &allowCompressed)
+	{
+		DecodedTexture decodedTexture;
+		// Check if the texture itself is a DDS file.
+		const auto isDdsFile = textureFilePath.size() >= 4 && textureFilePath.compare(textureFilePath.size() - 4, 4, ".dds") == 0;
+		// Try reading the DDS file.
+		decodedTexture.compressed = allowCompressed && (isDdsFile || !isBakedTextureStale(textureFilePath)) && ImageLoader::readDdsFile(isDdsFile ? textureFilePath : ImageLoader::getCompressedFilePath(textureFilePath), decodedTexture.compressedImage);
+		if (!decodedTexture.compressed)
+		{
+			if (isDdsFile)
+			{
+				// Could not load the DDS file, and there's nothing to fall back to. Time to crash.
+				Logger::getInstance().error(textureName, "\nFailed at texture 6");
+				exit(1);
+			}
+			// No usable compressed texture, so read the BMP image.
+			decodedTexture.image = ImageLoader::readBmpFile(textureName, textureFilePath);
+		}
+		return decodedTexture;
+	}
 
-		// Read the texture data from the file and store into the buffer.
-		fread(textureData, 1, imageSize, file);
+	/**
+	 * Get the size in bytes of the given decoded texture, counting only the mip levels uploaded up front.
+	 * 
+	 * @param decodedTexture  The decoded texture.
+	 * 
+	 * @return The size of the texture data.
+	 */
+	static uint64_t getDecodedTextureSize(const DecodedTexture &decodedTexture)
+	{
+		if (!decodedTexture.compressed)
+		{
+			return decodedTexture.image.pixels.size();
+		}
+		uint64_t size = 0;
+		const auto &levels = decodedTexture.compressedImage.levels;
+		for (auto i = getInitialLevel(decodedTexture.compressedImage); i < levels.size(); i++)
+		{
+			size += levels[i].size();
+		}
+		return size;
+	}
 
-		// Close the file now that we're done reading it.
-		fclose(file);
+	/**
+	 * Create the texture and allocate the storage of the mip levels uploaded up front, without uploading any data.
+	 * 
+	 * @param decodedTexture  The decoded texture to create the storage for.
+	 * 
+	 * @return The ID of the texture.
+	 */
+	GLuint createTextureStorage(const DecodedTexture &decodedTexture)
+	{
+		// Define a variable for storing the texture ID.
+		GLuint textureId;
+		// Create a new texture and store the ID.
+		glGenTextures(1, &textureId);
+		// Bind the texture as a 2D texture.
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureId);
 
-		// Create the 2D texture and store the texture data there.
-		const auto textureId = create2dTexture(textureData, width, height);
+		if (decodedTexture.compressed)
+		{
+			// Allocate each of the compressed mip levels uploaded up front, leaving the finer ones to be streamed in.
+			const auto &image = decodedTexture.compressedImage;
+			const auto initialLevel = getInitialLevel(image);
+			if (initialLevel == 0 && WindowManager::getInstance().isTextureStorageSupported())
+			{
+				// The whole chain is uploaded up front, so none of the levels is defined later and the storage can be immutable.
+				glTexStorage2D(GL_TEXTURE_2D, image.levels.size(), getCompressedInternalFormat(image.format), image.width, image.height);
+			}
+			else
+			{
+				for (auto i = initialLevel; i < image.levels.size(); i++)
+				{
+					glCompressedTexImage2D(GL_TEXTURE_2D, i, getCompressedInternalFormat(image.format), std::max(1u, image.width >> i), std::max(1u, image.height >> i), 0, image.levels[i].size(), NULL);
+				}
+			}
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, initialLevel);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels.size() - 1);
+		}
+		else
+		{
+			// Allocate the base level, the mip levels are generated once it's uploaded.
+			const auto &image = decodedTexture.image;
+			if (WindowManager::getInstance().isTextureStorageSupported())
+			{
+				glTexStorage2D(GL_TEXTURE_2D, getMipLevelCount(image.width, image.height), GL_RGB8, image.width, image.height);
+			}
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, image.width, image.height, 0, GL_BGR, GL_UNSIGNED_BYTE, NULL);
+			}
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		}
 
-		// Delete the texture data file we're storing since we no longer need it.
-		delete[] textureData;
+		// Set the texture wrapping and magnification filtering.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		// Unbind the texture now that we're done.
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
 
 		// Return the ID of the created texture.
 		return textureId;
 	}
 
+	/**
+	 * Copy the next chunk of the pending upload into the next pixel buffer of the ring, and upload it to the texture from there.
+	 * 
+	 * @param pendingUpload  The texture being uploaded.
+	 * 
+	 * @return The number of bytes uploaded.
+	 */
+	uint32_t uploadNextChunk(PendingTextureUpload &pendingUpload)
+	{
+		// Create the ring of pixel buffers if this is the first upload.
+		if (uploadBufferIds.empty())
+		{
+			uploadBufferIds.resize(TEXTURE_UPLOAD_BUFFER_COUNT);
+			glGenBuffers(TEXTURE_UPLOAD_BUFFER_COUNT, &uploadBufferIds[0]);
+			for (const auto &uploadBufferId : uploadBufferIds)
+			{
+				GlStateCache::getInstance().bindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBufferId);
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, TEXTURE_UPLOAD_BUFFER_SIZE, NULL, GL_STREAM_DRAW);
+			}
+		}
+
+		// Get the data of the level being uploaded, and the size of the rows it's uploaded in.
+		// Compressed levels are uploaded in rows of 4x4 pixel blocks, and uncompressed levels in rows of pixels.
+		const auto &decodedTexture = pendingUpload.decodedTexture;
+		const auto format = decodedTexture.compressedImage.format;
+		const uint32_t levelWidth = std::max(1u, (decodedTexture.compressed ? decodedTexture.compressedImage.width : decodedTexture.image.width) >> pendingUpload.uploadLevel);
+		const uint32_t levelHeight = std::max(1u, (decodedTexture.compressed ? decodedTexture.compressedImage.height : decodedTexture.image.height) >> pendingUpload.uploadLevel);
+		const auto &levelData = decodedTexture.compressed ? decodedTexture.compressedImage.levels[pendingUpload.uploadLevel] : decodedTexture.image.pixels;
+		const uint32_t rowHeight = decodedTexture.compressed ? 4 : 1;
+		const uint32_t rowCount = (levelHeight + rowHeight - 1) / rowHeight;
+		const uint32_t rowSize = levelData.size() / rowCount;
+
+		// Grab as many rows as fit in a pixel buffer, but at least one.
+		const uint32_t chunkRows = std::min(rowCount - pendingUpload.uploadRow, std::max(1u, TEXTURE_UPLOAD_BUFFER_SIZE / rowSize));
+		const uint32_t chunkSize = chunkRows * rowSize;
+		const uint32_t chunkY = pendingUpload.uploadRow * rowHeight;
+		const uint32_t chunkHeight = std::min(chunkRows * rowHeight, levelHeight - chunkY);
+
+		// Copy the rows into the next pixel buffer of the ring. Invalidating it lets the driver hand out fresh memory instead of waiting on the previous upload.
+		const auto uploadBufferId = uploadBufferIds[nextUploadBufferIndex];
+		nextUploadBufferIndex = (nextUploadBufferIndex + 1) % uploadBufferIds.size();
+		GlStateCache::getInstance().bindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBufferId);
+		if (chunkSize > TEXTURE_UPLOAD_BUFFER_SIZE)
+		{
+			// A single row doesn't fit in the pixel buffer, so grow it.
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, chunkSize, NULL, GL_STREAM_DRAW);
+		}
+		const auto mappedBuffer = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, chunkSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		memcpy(mappedBuffer, &levelData[pendingUpload.uploadRow * rowSize], chunkSize);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		// Upload the rows from the pixel buffer into the texture.
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, pendingUpload.textureId);
+		if (decodedTexture.compressed)
+		{
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, pendingUpload.uploadLevel, 0, chunkY, levelWidth, chunkHeight, getCompressedInternalFormat(format), chunkSize, (void *)0);
+		}
+		else
+		{
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, chunkY, levelWidth, chunkHeight, GL_BGR, GL_UNSIGNED_BYTE, (void *)0);
+		}
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+		GlStateCache::getInstance().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		// Move on to the next rows, or the next level once the level is complete.
+		pendingUpload.uploadRow += chunkRows;
+		if (pendingUpload.uploadRow >= rowCount)
+		{
+			pendingUpload.uploadRow = 0;
+			pendingUpload.uploadLevel++;
+		}
+
+		return chunkSize;
+	}
+
+	/**
+	 * Check if all the data of the pending upload has been uploaded.
+	 * 
+	 * @param pendingUpload  The texture being uploaded.
+	 * 
+	 * @return Whether the upload is complete.
+	 */
+	static bool isUploadComplete(const PendingTextureUpload &pendingUpload)
+	{
+		return pendingUpload.uploadLevel >= (pendingUpload.decodedTexture.compressed ? pendingUpload.decodedTexture.compressedImage.levels.size() : 1);
+	}
+
+	/**
+	 * Get the GPU memory used by the mip levels of the texture.
+	 * 
+	 * @param textureId  The ID of the texture.
+	 * 
+	 * @return The size of the texture, in bytes.
+	 */
+	static uint64_t getTextureSize(const GLuint &textureId)
+	{
+		uint64_t textureSize = 0;
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureId);
+		// Iterate through the mip levels of the texture from its base level, since the finer levels of streamed textures
+		//   might not be there, until a level with no size is found.
+		GLint baseLevel;
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &baseLevel);
+		for (GLint level = baseLevel;; level++)
+		{
+			GLint width, height, compressed;
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+			if (width == 0 || height == 0)
+			{
+				break;
+			}
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED, &compressed);
+			// Compressed levels report their size, while uncompressed levels are assumed to be padded to 4 bytes a texel.
+			GLint compressedSize = 0;
+			if (compressed)
+			{
+				glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize);
+			}
+			textureSize += compressed ? (uint64_t)compressedSize : (uint64_t)width * height * 4;
+		}
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+		return textureSize;
+	}
+
+	/**
+	 * Get the key of the texture loaded from the given file, being the normalized path to the file.
+	 * 
+	 * @param textureFilePath  The file path to the texture data.
+	 * 
+	 * @return The key of the texture.
+	 */
+	static std::string getTextureKey(const std::string &textureFilePath)
+	{
+		return std::filesystem::path(textureFilePath).lexically_normal().generic_string();
+	}
+
+	/**
+	 * Get the files the texture can be loaded from, which for images other than DDS files includes the baked DDS file next
+	 *   to the image, since that one is loaded instead when present.
+	 * 
+	 * @param textureFilePath  The file path to the texture data.
+	 * 
+	 * @return The file paths the texture can be loaded from.
+	 */
+	static std::vector<std::string> getTextureFilePaths(const std::string &textureFilePath)
+	{
+		const auto isDdsFile = textureFilePath.size() >= 4 && textureFilePath.compare(textureFilePath.size() - 4, 4, ".dds") == 0;
+		if (isDdsFile)
+		{
+			return {textureFilePath};
+		}
+		return {textureFilePath, ImageLoader::getCompressedFilePath(textureFilePath)};
+	}
+
+	/**
+	 * Stop streaming in the finer mip levels of the texture, giving back the part of the streaming budget its levels took.
+	 * 
+	 * @param textureDetails  The details of the texture.
+	 */
+	void cancelTextureStream(const TextureDetails &textureDetails)
+	{
+		pendingStreams.erase(std::remove_if(pendingStreams.begin(), pendingStreams.end(), [&](const std::shared_ptr<PendingTextureStream> &pendingStream) {
+													 return pendingStream->textureDetails.get() == &textureDetails;
+												 }),
+												 pendingStreams.end());
+		streamedTexturesSize -= textureDetails.mipLevels.streamedBytes;
+		textureDetails.mipLevels.streamedBytes = 0;
+	}
+
+	/**
+	 * Delete the texture of the details, once the frames in flight are done with it if it has a bindless handle, or had one
+	 *   replaced in the last frames, since they could still be sampling it through the handle.
+	 * 
+	 * @param textureDetails  The details of the texture.
+	 */
+	void retireTexture(const TextureDetails &textureDetails)
+	{
+		const auto hasRetiredHandle = std::any_of(retiredTextures.begin(), retiredTextures.end(), [&](const RetiredTexture &retiredTexture) {
+			return retiredTexture.textureId == textureDetails.textureId;
+		});
+		if (textureDetails.textureHandle == 0 && !hasRetiredHandle)
+		{
+			GlStateCache::getInstance().deleteTextures(1, &textureDetails.textureId);
+			return;
+		}
+		retiredTextures.push_back({textureDetails.textureId, textureDetails.textureHandle, STREAMING_BUFFER_REGION_COUNT, true});
+		textureDetails.textureHandle = 0;
+	}
+
+	/**
+	 * Upload the next finer mip level of the streamed texture from the texture file read again for it, and start sampling
+	 *   the level once it's there.
+	 * 
+	 * @param textureDetails  The details of the texture.
+	 * @param imageData       The block compressed image read from the texture file.
+	 * 
+	 * @return The number of bytes uploaded.
+	 */
+	static uint32_t uploadStreamedLevel(const TextureDetails &textureDetails, const CompressedImageData &imageData)
+	{
+		auto &mipLevels = textureDetails.mipLevels;
+		const auto level = mipLevels.residentLevel - 1;
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureDetails.textureId);
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, getCompressedInternalFormat(imageData.format), std::max(1u, imageData.width >> level), std::max(1u, imageData.height >> level), 0, imageData.levels[level].size(), imageData.levels[level].data());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+		GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+		mipLevels.residentLevel = level;
+		textureDetails.textureSize += imageData.levels[level].size();
+		return imageData.levels[level].size();
+	}
+
+	/**
+	 * Remove the texture from the created textures map, and delete the texture.
+	 * 
+	 * @param textureName  The name of the texture to delete.
+	 */
+	void deleteTexture(const std::string &textureName)
+	{
+		// Keep the texture details alive until the texture is deleted.
+		const auto textureDetails = namedTextures.at(textureName);
+		// Remove the texture from the created textures map, and stop watching its files and streaming it.
+		namedTextures.erase(textureName);
+		textureFileWatcher.unwatch(textureName);
+		cancelTextureStream(*textureDetails);
+		// Delete the texture containing the texture data.
+		retireTexture(*textureDetails);
+	}
+
 	TextureManager()
 			: namedTextures({}),
-				namedTextureReferences({}) {}
+				namedTextureReferences({}),
+				textureKeys({}),
+				residentTextures(),
+				pendingUploads({}),
+				uploadBufferIds({}),
+				nextUploadBufferIndex(0),
+				requestedUploadsCount(0),
+				completedUploadsCount(0),
+				pendingStreams({}),
+				streamedTexturesSize(0),
+				retiredTextures({}),
+				handleSamplerId(0),
+				textureFileWatcher() {}
 
 public:
 	// Preventing copying the texture manager, making sure only one instance can exist.
 	TextureManager(const TextureManager &) = delete;
 
+	~TextureManager()
+	{
+		// Delete the ring of pixel buffers if it was created.
+		if (!uploadBufferIds.empty())
+		{
+			GlStateCache::getInstance().deleteBuffers(uploadBufferIds.size(), &uploadBufferIds[0]);
+		}
+	}
+
 	/**
-	 * Load and create an texture from the given texture file path. If an texture with the same name was already created,
-	 * return the same texture.
+	 * Load and create an texture from the given texture file path. If a texture was already created from the same file,
+	 * under any name, return the same texture.
 	 * 
 	 * @param textureName      The name of the texture.
 	 * @param textureFilePath  The file path to the texture data.
@@ -229,28 +897,200 @@ public:
 	 */
 	const std::shared_ptr<const TextureDetails> &create2dTexture(const std::string &textureName, const std::string &textureFilePath)
 	{
-		// Check if an texture with the name already exists.
-		const auto existingTexture = namedTextures.find(textureName);
+		// Share the texture with whatever else loaded the same file, keeping the name as an alias of it.
+		const auto textureKey = getTextureKey(textureFilePath);
+		textureKeys[textureName] = textureKey;
+
+		// Check if a texture with the key already exists.
+		const auto existingTexture = namedTextures.find(textureKey);
 		if (existingTexture != namedTextures.end())
 		{
-			// Texture already loaded. Increase its reference count and return it.
-			namedTextureReferences[textureName]++;
+			// Texture already loaded. Increase its reference count, keep it from being evicted, and return it.
+			namedTextureReferences[textureKey]++;
+			residentTextures.markUsed(textureKey);
 			return existingTexture->second;
 		}
 
-		// Load the BMP image file and store its details.
-		const GLuint textureId = loadBmpTexture(textureName, textureFilePath);
+		// Load the texture file and store its details.
+		TextureMipLevels mipLevels;
+		const GLuint textureId = loadTexture(textureKey, textureFilePath, mipLevels);
+		GpuDebugLabels::labelObject(GL_TEXTURE, textureId, textureKey);
 
 		// Create a new texture details with the captured data.
-		const auto newTexture = std::make_shared<const TextureDetails>(textureId, textureName, textureFilePath);
+		const auto newTexture = std::make_shared<const TextureDetails>(textureId, mipLevels, getTextureSize(textureId), textureKey, textureFilePath);
 
-		// Insert the newly created texture into the map of created textures.
-		namedTextures.insert(std::make_pair(textureName, newTexture));
+		// Insert the newly created texture into the map of created textures, and watch its files.
+		namedTextures.insert(std::make_pair(textureKey, newTexture));
+		textureFileWatcher.watch(textureKey, getTextureFilePaths(textureFilePath));
 		// Set the reference count of the texture to 1.
-		namedTextureReferences[textureName] = 1;
+		namedTextureReferences[textureKey] = 1;
 
 		// Return the texture details.
-		return namedTextures[textureName];
+		return namedTextures[textureKey];
+	}
+
+	/**
+	 * Load and create a texture from the given texture file path in the background. The file is decoded by a worker thread,
+	 * and uploaded through pixel buffers over several calls to processPendingUploads. If a texture was already created from
+	 * the same file, under any name, the callback is called right away with it.
+	 * 
+	 * @param textureName      The name of the texture.
+	 * @param textureFilePath  The file path to the texture data.
+	 * @param callback         The function to call with the details of the texture once it's created.
+	 */
+	void create2dTextureAsync(const std::string &textureName, const std::string &textureFilePath, const std::function<void(const std::shared_ptr<const TextureDetails> &)> &callback)
+	{
+		// Share the texture with whatever else loaded the same file, keeping the name as an alias of it.
+		const auto textureKey = getTextureKey(textureFilePath);
+		textureKeys[textureName] = textureKey;
+
+		// Check if a texture with the key already exists.
+		const auto existingTexture = namedTextures.find(textureKey);
+		if (existingTexture != namedTextures.end())
+		{
+			// Texture already loaded. Increase its reference count, keep it from being evicted, and pass it on.
+			namedTextureReferences[textureKey]++;
+			residentTextures.markUsed(textureKey);
+			callback(existingTexture->second);
+			return;
+		}
+
+		// Check if the texture is already being loaded.
+		for (const auto &pendingUpload : pendingUploads)
+		{
+			if (pendingUpload->textureName == textureKey)
+			{
+				// Texture is on its way. Increase its reference count and wait for it with the other callbacks.
+				namedTextureReferences[textureKey]++;
+				pendingUpload->callbacks.push_back(callback);
+				return;
+			}
+		}
+
+		// Start decoding the texture on a worker thread.
+		const auto pendingUpload = std::make_shared<PendingTextureUpload>();
+		pendingUpload->textureName = textureKey;
+		pendingUpload->textureFilePath = textureFilePath;
+		pendingUpload->decodingTexture = launchLoader(decodeTexture, textureKey, textureFilePath, isCompressedFormatSupported(BC1));
+		pendingUpload->textureId = 0;
+		pendingUpload->uploadLevel = 0;
+		pendingUpload->uploadRow = 0;
+		pendingUpload->uploadedBytes = 0;
+		pendingUpload->callbacks.push_back(callback);
+		pendingUploads.push_back(pendingUpload);
+		requestedUploadsCount++;
+
+		// Set the reference count of the texture to 1.
+		namedTextureReferences[textureKey] = 1;
+	}
+
+	/**
+	 * Continue the textures being uploaded in the background, uploading at most the given number of bytes. Textures that are
+	 * fully uploaded are created and passed on to their callbacks.
+	 * 
+	 * @param maxUploadBytes  The maximum number of bytes to upload during this call.
+	 */
+	void processPendingUploads(const uint32_t &maxUploadBytes = TEXTURE_UPLOAD_BUFFER_SIZE * TEXTURE_UPLOAD_BUFFER_COUNT)
+	{
+		uint32_t uploadedBytes = 0;
+		for (auto pendingUploadIt = pendingUploads.begin(); pendingUploadIt != pendingUploads.end() && uploadedBytes < maxUploadBytes;)
+		{
+			auto &pendingUpload = **pendingUploadIt;
+
+			// Check if the texture has finished decoding, skipping it if not so other textures can make progress.
+			if (pendingUpload.textureId == 0)
+			{
+				if (pendingUpload.decodingTexture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				{
+					++pendingUploadIt;
+					continue;
+				}
+				pendingUpload.decodedTexture = pendingUpload.decodingTexture.get();
+				// Check if the GPU can sample the compressed format, and decode the BMP image instead if not.
+				if (pendingUpload.decodedTexture.compressed && !isCompressedFormatSupported(pendingUpload.decodedTexture.compressedImage.format))
+				{
+					pendingUpload.decodingTexture = launchLoader(decodeTexture, pendingUpload.textureName, pendingUpload.textureFilePath, false);
+					++pendingUploadIt;
+					continue;
+				}
+				// Decoding is complete, so create the storage of the texture, starting the upload from the first level uploaded up front.
+				pendingUpload.textureId = createTextureStorage(pendingUpload.decodedTexture);
+				GpuDebugLabels::labelObject(GL_TEXTURE, pendingUpload.textureId, pendingUpload.textureName);
+				pendingUpload.uploadLevel = getMipLevels(pendingUpload.decodedTexture).residentLevel;
+			}
+
+			// Upload chunks of the texture until it's complete or the budget is used up.
+			while (!isUploadComplete(pendingUpload) && uploadedBytes < maxUploadBytes)
+			{
+				const auto chunkSize = uploadNextChunk(pendingUpload);
+				uploadedBytes += chunkSize;
+				pendingUpload.uploadedBytes += chunkSize;
+			}
+			if (!isUploadComplete(pendingUpload))
+			{
+				break;
+			}
+
+			// Generate the mip levels of uncompressed textures now that the base level is uploaded.
+			if (!pendingUpload.decodedTexture.compressed)
+			{
+				GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, pendingUpload.textureId);
+				glGenerateMipmap(GL_TEXTURE_2D);
+				GlStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+			}
+
+			// Create a new texture details, insert it into the map of created textures, watch its files, and pass it on.
+			const auto newTexture = std::make_shared<const TextureDetails>(pendingUpload.textureId, getMipLevels(pendingUpload.decodedTexture), getTextureSize(pendingUpload.textureId), pendingUpload.textureName, pendingUpload.textureFilePath);
+			namedTextures.insert(std::make_pair(pendingUpload.textureName, newTexture));
+			textureFileWatcher.watch(pendingUpload.textureName, getTextureFilePaths(pendingUpload.textureFilePath));
+			for (const auto &callback : pendingUpload.callbacks)
+			{
+				callback(newTexture);
+			}
+
+			pendingUploadIt = pendingUploads.erase(pendingUploadIt);
+			completedUploadsCount++;
+		}
+
+		// Reset the progress once all the textures are uploaded.
+		if (pendingUploads.empty())
+		{
+			requestedUploadsCount = 0;
+			completedUploadsCount = 0;
+		}
+	}
+
+	/**
+	 * Check if there are textures still being decoded or uploaded in the background.
+	 * 
+	 * @return Whether there are pending texture uploads.
+	 */
+	bool hasPendingUploads() const
+	{
+		return !pendingUploads.empty();
+	}
+
+	/**
+	 * Get the progress of the textures being loaded in the background.
+	 * 
+	 * @return The fraction of the requested textures that have been decoded and uploaded, from 0 to 1.
+	 */
+	float getPendingUploadProgress() const
+	{
+		if (requestedUploadsCount == 0)
+		{
+			return 1.0f;
+		}
+		// Count decoding as the first half of loading a texture, and uploading as the second half.
+		float progress = completedUploadsCount;
+		for (const auto &pendingUpload : pendingUploads)
+		{
+			if (pendingUpload->textureId != 0)
+			{
+				progress += 0.5f + 0.5f * pendingUpload->uploadedBytes / getDecodedTextureSize(pendingUpload->decodedTexture);
+			}
+		}
+		return progress / requestedUploadsCount;
 	}
 
 	/**
@@ -262,11 +1102,233 @@ public:
    */
 	const std::shared_ptr<const TextureDetails> &getTextureDetails(const std::string &textureName) const
 	{
-		return namedTextures.at(textureName);
+		return namedTextures.at(textureKeys.at(textureName));
+	}
+
+	/**
+	 * Note the size on the screen of a model drawn with the texture, so the texture streams in the mip level with about
+	 *   one texel for each pixel the model covers. The texture is taken to be spread across the whole model.
+	 * 
+	 * @param textureDetails  The details of the texture.
+	 * @param screenSize      The size of the model across the screen, in pixels.
+	 */
+	void requestTextureSize(const TextureDetails &textureDetails, const float_t &screenSize)
+	{
+		const auto &mipLevels = textureDetails.mipLevels;
+		if (mipLevels.levelsCount == 0)
+		{
+			return;
+		}
+		const auto texelsPerPixel = std::max(mipLevels.width, mipLevels.height) / std::max(screenSize, 1.0f);
+		const auto level = texelsPerPixel > 1.0f ? static_cast<uint32_t>(std::log2(texelsPerPixel)) : 0u;
+		textureDetails.requiredLevel = std::min({textureDetails.requiredLevel, level, mipLevels.levelsCount - 1});
+	}
+
+	/**
+	 * Stream in the finer mip levels the textures were asked for since the last call, as long as they fit in the streaming
+	 *   budget. The texture files are read again by worker threads, and the levels are uploaded one at a time from the
+	 *   coarsest, at most the given number of bytes during this call, so the textures get sharper without hitching.
+	 * 
+	 * @param maxUploadBytes  The maximum number of bytes to upload during this call.
+	 */
+	void processTextureStreaming(const uint32_t &maxUploadBytes = TEXTURE_STREAMING_BYTES_PER_FRAME)
+	{
+		// Delete the replaced textures the frames in flight are done with.
+		for (auto retiredTextureIt = retiredTextures.begin(); retiredTextureIt != retiredTextures.end();)
+		{
+			if (--retiredTextureIt->framesLeft > 0)
+			{
+				++retiredTextureIt;
+				continue;
+			}
+			if (retiredTextureIt->textureHandle != 0)
+			{
+				glMakeTextureHandleNonResidentARB(retiredTextureIt->textureHandle);
+			}
+			if (retiredTextureIt->deletesTexture)
+			{
+				GlStateCache::getInstance().deleteTextures(1, &retiredTextureIt->textureId);
+			}
+			retiredTextureIt = retiredTextures.erase(retiredTextureIt);
+		}
+
+		// Continue the textures whose files have been read.
+		uint32_t uploadedBytes = 0;
+		for (auto pendingStreamIt = pendingStreams.begin(); pendingStreamIt != pendingStreams.end() && uploadedBytes < maxUploadBytes;)
+		{
+			auto &pendingStream = **pendingStreamIt;
+			const auto &textureDetails = *pendingStream.textureDetails;
+			auto &mipLevels = textureDetails.mipLevels;
+
+			// Check if the texture file has been read, skipping it if not so other textures can make progress.
+			if (pendingStream.decodingTexture.valid())
+			{
+				if (pendingStream.decodingTexture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				{
+					++pendingStreamIt;
+					continue;
+				}
+				pendingStream.decodedTexture = pendingStream.decodingTexture.get();
+				// Check the file still has the levels of the texture, since it could have changed since the texture was loaded,
+				//   and stop streaming the texture if not.
+				const auto &image = pendingStream.decodedTexture.compressedImage;
+				if (!pendingStream.decodedTexture.compressed || image.format != mipLevels.format || image.width != mipLevels.width || image.height != mipLevels.height || image.levels.size() != mipLevels.levelsCount)
+				{
+					const auto unusedBytes = getCompressedLevelsSize(mipLevels, pendingStream.targetLevel, mipLevels.residentLevel);
+					mipLevels.streamedBytes -= unusedBytes;
+					streamedTexturesSize -= unusedBytes;
+					mipLevels.levelsCount = 0;
+					pendingStreamIt = pendingStreams.erase(pendingStreamIt);
+					continue;
+				}
+			}
+
+			// A texture with a bindless handle can't be changed anymore, so all its levels are uploaded into a new texture
+			//   replacing it instead, which gets a handle of its own the next time it's drawn.
+			if (textureDetails.textureHandle != 0)
+			{
+				const auto textureId = create2dCompressedTexture(pendingStream.decodedTexture.compressedImage, pendingStream.targetLevel);
+				GpuDebugLabels::labelObject(GL_TEXTURE, textureId, textureDetails.textureName);
+				uploadedBytes += getCompressedLevelsSize(mipLevels, pendingStream.targetLevel, mipLevels.levelsCount);
+				retireTexture(textureDetails);
+				textureDetails.textureId = textureId;
+				textureDetails.textureSize = getTextureSize(textureId);
+				mipLevels.residentLevel = pendingStream.targetLevel;
+				pendingStreamIt = pendingStreams.erase(pendingStreamIt);
+				continue;
+			}
+
+			// Upload the levels until the target level is reached or the budget is used up.
+			while (mipLevels.residentLevel > pendingStream.targetLevel && uploadedBytes < maxUploadBytes)
+			{
+				uploadedBytes += uploadStreamedLevel(textureDetails, pendingStream.decodedTexture.compressedImage);
+			}
+			if (mipLevels.residentLevel > pendingStream.targetLevel)
+			{
+				break;
+			}
+			pendingStreamIt = pendingStreams.erase(pendingStreamIt);
+		}
+
+		// Start streaming in the textures that need finer levels than they have, for as many levels as fit in the budget.
+		for (const auto &namedTexture : namedTextures)
+		{
+			const auto &textureDetails = namedTexture.second;
+			const auto requiredLevel = textureDetails->requiredLevel;
+			textureDetails->requiredLevel = std::numeric_limits<uint32_t>::max();
+			const auto &mipLevels = textureDetails->mipLevels;
+			if (mipLevels.levelsCount == 0 || requiredLevel >= mipLevels.residentLevel ||
+					std::any_of(pendingStreams.begin(), pendingStreams.end(), [&](const std::shared_ptr<PendingTextureStream> &pendingStream) { return pendingStream->textureDetails == textureDetails; }))
+			{
+				continue;
+			}
+			auto targetLevel = mipLevels.residentLevel;
+			while (targetLevel > requiredLevel && streamedTexturesSize + getCompressedLevelsSize(mipLevels, targetLevel - 1, targetLevel) <= TEXTURE_STREAMING_BUDGET)
+			{
+				targetLevel--;
+				// Reserve the size of the level in the budget right away, so the textures starting together can't go over it.
+				const auto levelSize = getCompressedLevelsSize(mipLevels, targetLevel, targetLevel + 1);
+				textureDetails->mipLevels.streamedBytes += levelSize;
+				streamedTexturesSize += levelSize;
+			}
+			if (targetLevel == mipLevels.residentLevel)
+			{
+				continue;
+			}
+
+			// Start reading the texture file again on a worker thread.
+			const auto pendingStream = std::make_shared<PendingTextureStream>();
+			pendingStream->textureDetails = textureDetails;
+			pendingStream->decodingTexture = launchLoader(decodeTexture, textureDetails->textureName, textureDetails->textureFilePath, true);
+			pendingStream->targetLevel = targetLevel;
+			pendingStreams.push_back(pendingStream);
+		}
+	}
+
+	/**
+	 * Get the bindless handle of the texture, creating it with the sampler of the handles and making it resident the first
+	 *   time it's asked for. The texture can't be changed once it has a handle, so it's replaced by a new texture whenever
+	 *   it's changed after that.
+	 * 
+	 * @param textureDetails  The details of the texture.
+	 * 
+	 * @return The bindless handle of the texture.
+	 */
+	const GLuint64 &getTextureHandle(const TextureDetails &textureDetails)
+	{
+		if (textureDetails.textureHandle == 0)
+		{
+			textureDetails.textureHandle = handleSamplerId == 0 ? glGetTextureHandleARB(textureDetails.textureId) : glGetTextureSamplerHandleARB(textureDetails.textureId, handleSamplerId);
+			// The texture gets back the same handle it had with the sampler before, which is still resident if it's waiting
+			//   for the frames in flight to be retired.
+			const auto retiredHandle = std::find_if(retiredTextures.begin(), retiredTextures.end(), [&](const RetiredTexture &retiredTexture) {
+				return !retiredTexture.deletesTexture && retiredTexture.textureHandle == textureDetails.textureHandle;
+			});
+			if (retiredHandle != retiredTextures.end())
+			{
+				retiredTextures.erase(retiredHandle);
+			}
+			else
+			{
+				glMakeTextureHandleResidentARB(textureDetails.textureHandle);
+			}
+		}
+		return textureDetails.textureHandle;
+	}
+
+	/**
+	 * Set the sampler the bindless handles of the textures are created with, which they're filtered with instead of their
+	 *   own parameters. The handles created with another sampler are retired once the frames in flight are done with them,
+	 *   and the textures get new handles the next time they're drawn.
+	 * 
+	 * @param samplerId  The ID of the sampler, or 0 for the parameters of the textures.
+	 */
+	void setHandleSampler(const GLuint &samplerId)
+	{
+		if (handleSamplerId == samplerId)
+		{
+			return;
+		}
+		handleSamplerId = samplerId;
+		for (const auto &namedTexture : namedTextures)
+		{
+			const auto &textureDetails = *namedTexture.second;
+			if (textureDetails.textureHandle != 0)
+			{
+				retiredTextures.push_back({textureDetails.textureId, textureDetails.textureHandle, STREAMING_BUFFER_REGION_COUNT, false});
+				textureDetails.textureHandle = 0;
+			}
+		}
+	}
+
+	/**
+	 * Get the number of bytes of the mip levels streamed in, or about to be, across all the textures.
+	 * 
+	 * @return The size of the streamed mip levels.
+	 */
+	const uint64_t &getStreamedTexturesSize() const
+	{
+		return streamedTexturesSize;
 	}
 
 	/**
-	 * Delete a reference to the texture, and destroy it if no more references are present.
+	 * Get the GPU memory used by the created textures, including the unused ones kept resident.
+	 * 
+	 * @return The size in bytes.
+	 */
+	uint64_t getGpuMemorySize() const
+	{
+		uint64_t texturesSize = 0;
+		for (const auto &namedTexture : namedTextures)
+		{
+			texturesSize += namedTexture.second->textureSize;
+		}
+		return texturesSize;
+	}
+
+	/**
+	 * Delete a reference to the texture. Once no more references are present, the texture is kept resident so it can be
+	 * reused, and the least recently used unused textures are destroyed if they go over the residency budget.
 	 * 
 	 * @param textureDetails  The details of the texture to destroy.
 	 */
@@ -277,16 +1339,50 @@ public:
 		// Check if there are no more references to the texture.
 		if (namedTextureReferences[textureDetails->getTextureName()] <= 0)
 		{
-			// No more references left, so time to clean.
-			// Remove the texture from the created textures references map.
+			// No more references left, so remove the texture from the created textures references map and keep it resident.
 			namedTextureReferences.erase(textureDetails->getTextureName());
-			// Remove the texture from the created textures map.
-			namedTextures.erase(textureDetails->getTextureName());
-			// Delete the texture containing the texture data.
-			glDeleteTextures(1, &textureDetails->textureId);
+			residentTextures.markUnused(textureDetails->getTextureName(), textureDetails->textureSize);
+			// Destroy the unused textures that don't fit in the residency budget.
+			for (const auto &evictedTextureName : residentTextures.evict(TEXTURE_RESIDENCY_BUDGET))
+			{
+				deleteTexture(evictedTextureName);
+			}
 		}
 	}
 
+	/**
+	 * Reload the textures whose files changed since they were last checked. The textures are swapped into the details
+	 *   every model already shares, so nothing has to ask for them again.
+	 * 
+	 * @return The names of the reloaded textures.
+	 */
+	std::vector<std::string> reloadChangedTextures()
+	{
+		std::vector<std::string> reloadedTextureNames({});
+		for (const auto &textureName : textureFileWatcher.findChangedAssets())
+		{
+			const auto &textureDetails = namedTextures.at(textureName);
+			// A file still being written can fail to load, in which case the last texture is kept until it's written again.
+			TextureMipLevels mipLevels;
+			const auto textureId = loadTexture(textureName, textureDetails->textureFilePath, mipLevels, false);
+			if (textureId == 0)
+			{
+				Logger::getInstance().warning(textureName, "\nFailed at reloading texture, keeping the last one");
+				continue;
+			}
+			// The texture starts over from the coarse levels of the new file, and its finer levels are streamed in again.
+			cancelTextureStream(*textureDetails);
+			textureDetails->mipLevels = mipLevels;
+			GpuDebugLabels::labelObject(GL_TEXTURE, textureId, textureName);
+			// The driver keeps the old texture until the commands sampling it are done.
+			retireTexture(*textureDetails);
+			textureDetails->textureId = textureId;
+			textureDetails->textureSize = getTextureSize(textureId);
+			reloadedTextureNames.push_back(textureName);
+		}
+		return reloadedTextureNames;
+	}
+
 	/**
    * Returns the singleton instance of the texture manager.
    * 
@@ -294,11 +1390,10 @@ public:
    */
 	static TextureManager &getInstance()
 	{
+		// Singleton instance of the texture manager, constructed the first time it's asked for.
+		static TextureManager instance;
 		return instance;
 	}
 };
 
-// Initialize the texture manager singleton instance static variable.
-TextureManager TextureManager::instance;
-
 #endif
\ No newline at end of file
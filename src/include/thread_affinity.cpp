@@ -0,0 +1,433 @@
+#ifndef INCLUDE_THREAD_AFFINITY_CPP
+#define INCLUDE_THREAD_AFFINITY_CPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <thread>
+#include <future>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/sysctl.h>
+#include <sys/qos.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#include "constants.cpp"
+#include "log.cpp"
+
+/**
+ * The roles of the threads of the engine, each of which is placed on the cores and given the priority of its role.
+ */
+enum class ThreadRole : uint32_t
+{
+  // The thread running the scenes, which also runs jobs while it waits for them.
+  MAIN = 0,
+  // The thread running the GL work of the frames, when the render thread is enabled.
+  RENDER = 1,
+  // The workers of the job system.
+  JOB = 2,
+  // The threads loading the font, the meshes and the textures, and writing the captured frames, in the background.
+  LOADER = 3,
+  // The thread serving the telemetry of the frames.
+  TELEMETRY = 4,
+};
+
+// The number of roles of the threads.
+const uint32_t THREAD_ROLES_COUNT = 5;
+
+// The names of the roles, for reporting.
+const std::array<std::string, THREAD_ROLES_COUNT> threadRoleNames = {"Main", "Render", "Job", "Loader", "Telemetry"};
+
+/**
+ * Enum for the priorities the threads of a role run at, relative to the other threads of the process.
+ */
+enum class ThreadPriority
+{
+  LOW,
+  NORMAL,
+  HIGH
+};
+
+/**
+ * Class for placing the threads of the engine on the cores of the machine by their roles. The main thread and the render
+ *   thread each get a performance core of their own, the loaders share the efficiency cores, or the cores left over if
+ *   the machine has no efficiency cores, and the job system gets a worker for every core left over, so the threads of the
+ *   frame don't fight over the same cores. The cores are told apart by their maximum frequency on Linux and by their
+ *   efficiency class on Windows. macOS doesn't let threads be pinned, so there the roles only get their priorities, as
+ *   quality of service classes the scheduler places the threads by. The layout is worked out once, the first time it's
+ *   asked for, from THREAD_AFFINITY_ENABLED and RENDER_THREAD_ENABLED, so those are set before anything starts a thread.
+ */
+class ThreadLayout
+{
+private:
+  // The logical cores the process can run on, split into the performance and the efficiency cores. Every core counts as a
+  //   performance core on machines whose cores are all alike.
+  std::vector<uint32_t> performanceCores;
+  std::vector<uint32_t> efficiencyCores;
+  // Whether the threads can be pinned to cores on this OS.
+  const bool pinningSupported;
+  // Whether the threads are placed by their roles at all.
+  const bool enabled;
+  // The cores the threads of each role can run on, where none means any core, and the priority of each role.
+  std::array<std::vector<uint32_t>, THREAD_ROLES_COUNT> roleCores;
+  std::array<ThreadPriority, THREAD_ROLES_COUNT> rolePriorities;
+  // The number of threads running jobs, including the threads that aren't workers.
+  uint32_t jobThreadsCount;
+
+  /**
+   * Find the logical cores the process can run on, and which of them are efficiency cores.
+   *
+   * @return Whether the threads can be pinned to the cores found.
+   */
+  bool detectCores()
+  {
+#ifdef _WIN32
+    // Read the efficiency class of each physical core, where the higher classes are the faster cores. Only the cores of
+    //   the first processor group can be pinned to by a thread affinity mask.
+    DWORD bufferSize = 0;
+    GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &bufferSize);
+    std::vector<char> buffer(bufferSize);
+    auto information = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+    if (bufferSize == 0 || !GetLogicalProcessorInformationEx(RelationProcessorCore, information, &bufferSize))
+    {
+      Logger::getInstance().error("Failed at thread affinity 1");
+      return false;
+    }
+    std::vector<std::pair<uint32_t, BYTE>> cores({});
+    BYTE maxEfficiencyClass = 0;
+    for (DWORD offset = 0; offset < bufferSize;)
+    {
+      const auto core = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+      const auto &groupMask = core->Processor.GroupMask[0];
+      for (uint32_t i = 0; groupMask.Group == 0 && i < sizeof(KAFFINITY) * 8; i++)
+      {
+        if ((groupMask.Mask >> i) & 1)
+        {
+          cores.push_back({i, core->Processor.EfficiencyClass});
+        }
+      }
+      maxEfficiencyClass = std::max(maxEfficiencyClass, core->Processor.EfficiencyClass);
+      offset += core->Size;
+    }
+    for (const auto &core : cores)
+    {
+      (core.second == maxEfficiencyClass ? performanceCores : efficiencyCores).push_back(core.first);
+    }
+    return true;
+#elif defined(__APPLE__)
+    // The cores can't be told apart by the threads, only counted, with the first performance level being the fastest.
+    int32_t performanceCoresCount = 0, efficiencyCoresCount = 0;
+    size_t size = sizeof(int32_t);
+    if (sysctlbyname("hw.perflevel0.logicalcpu", &performanceCoresCount, &size, nullptr, 0) != 0)
+    {
+      performanceCoresCount = static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    size = sizeof(int32_t);
+    if (sysctlbyname("hw.perflevel1.logicalcpu", &efficiencyCoresCount, &size, nullptr, 0) != 0)
+    {
+      efficiencyCoresCount = 0;
+    }
+    for (int32_t i = 0; i < performanceCoresCount + efficiencyCoresCount; i++)
+    {
+      (i < performanceCoresCount ? performanceCores : efficiencyCores).push_back(i);
+    }
+    return false;
+#else
+    // Take the cores the process is allowed on, and count the ones slower than the fastest as efficiency cores.
+    cpu_set_t processCores;
+    CPU_ZERO(&processCores);
+    if (sched_getaffinity(0, sizeof(processCores), &processCores) != 0)
+    {
+      Logger::getInstance().error("Failed at thread affinity 1");
+      return false;
+    }
+    std::vector<std::pair<uint32_t, uint64_t>> cores({});
+    uint64_t maxFrequency = 0;
+    for (uint32_t i = 0; i < CPU_SETSIZE; i++)
+    {
+      if (CPU_ISSET(i, &processCores))
+      {
+        // Cores without a frequency driver all count as the same kind of core.
+        uint64_t frequency = 0;
+        std::ifstream frequencyFile("/sys/devices/system/cpu/cpu" + std::to_string(i) + "/cpufreq/cpuinfo_max_freq");
+        frequencyFile >> frequency;
+        cores.push_back({i, frequency});
+        maxFrequency = std::max(maxFrequency, frequency);
+      }
+    }
+    for (const auto &core : cores)
+    {
+      (core.second == maxFrequency ? performanceCores : efficiencyCores).push_back(core.first);
+    }
+    return true;
+#endif
+  }
+
+  /**
+   * Work out the cores of each role from the cores found.
+   */
+  void buildLayout()
+  {
+    // Fall back to a job thread for each hardware thread if the cores couldn't be found.
+    const auto coresCount = static_cast<uint32_t>(performanceCores.size() + efficiencyCores.size());
+    jobThreadsCount = coresCount > 0 ? coresCount : std::max(1u, std::thread::hardware_concurrency());
+    // Reserving cores only pays off with enough of them left over for the jobs.
+    if (!enabled || coresCount < 4)
+    {
+      return;
+    }
+
+    // Give the main thread and the render thread a performance core each, falling back to the efficiency cores.
+    std::vector<uint32_t> freeCores(performanceCores);
+    freeCores.insert(freeCores.end(), efficiencyCores.begin(), efficiencyCores.end());
+    const auto reserveCore = [&](const ThreadRole &role) {
+      roleCores[static_cast<uint32_t>(role)] = {freeCores.front()};
+      freeCores.erase(freeCores.begin());
+    };
+    reserveCore(ThreadRole::MAIN);
+    if (RENDER_THREAD_ENABLED)
+    {
+      reserveCore(ThreadRole::RENDER);
+    }
+
+    // The jobs get the rest of the cores, one worker on each, along with the main thread.
+    roleCores[static_cast<uint32_t>(ThreadRole::JOB)] = freeCores;
+    jobThreadsCount = static_cast<uint32_t>(freeCores.size()) + 1;
+    // The loaders and the telemetry only run now and then, so they share the efficiency cores, or the cores of the jobs
+    //   on machines without any, at a lower priority than the jobs.
+    const auto &backgroundCores = efficiencyCores.empty() ? freeCores : efficiencyCores;
+    roleCores[static_cast<uint32_t>(ThreadRole::LOADER)] = backgroundCores;
+    roleCores[static_cast<uint32_t>(ThreadRole::TELEMETRY)] = backgroundCores;
+  }
+
+  /**
+   * Pin the calling thread to the given cores.
+   *
+   * @param cores  The cores.
+   */
+  void pinCurrentThread(const std::vector<uint32_t> &cores) const
+  {
+    if (!pinningSupported || cores.empty())
+    {
+      return;
+    }
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (const auto &core : cores)
+    {
+      mask |= DWORD_PTR(1) << core;
+    }
+    if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+    {
+      Logger::getInstance().error("Failed at thread affinity 2");
+    }
+#elif !defined(__APPLE__)
+    cpu_set_t coreSet;
+    CPU_ZERO(&coreSet);
+    for (const auto &core : cores)
+    {
+      CPU_SET(core, &coreSet);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(coreSet), &coreSet) != 0)
+    {
+      Logger::getInstance().error("Failed at thread affinity 2");
+    }
+#endif
+  }
+
+  /**
+   * Check if the threads can be given a high priority. On Linux, lowering the nice value below 0 needs CAP_SYS_NICE or
+   *   enough headroom in RLIMIT_NICE, which unprivileged processes normally don't have, and the high priority roles are
+   *   left at the normal priority there instead of failing each time they start.
+   *
+   * @return Whether the high priority can be set.
+   */
+  static bool isHighPriorityAllowed()
+  {
+#if defined(_WIN32) || defined(__APPLE__)
+    return true;
+#else
+    if (geteuid() == 0)
+    {
+      return true;
+    }
+    // The soft limit of RLIMIT_NICE is 20 minus the lowest nice value allowed, which has to reach the nice value of -5
+    //   the high priority is set with.
+    rlimit niceLimit;
+    return getrlimit(RLIMIT_NICE, &niceLimit) == 0 && (niceLimit.rlim_cur == RLIM_INFINITY || niceLimit.rlim_cur >= 25);
+#endif
+  }
+
+  /**
+   * Set the priority of the calling thread. Raising it may need privileges the game doesn't have, in which case the thread
+   *   is left at its priority and a warning is logged.
+   *
+   * @param priority  The priority.
+   */
+  static void setCurrentThreadPriority(const ThreadPriority &priority)
+  {
+#ifdef _WIN32
+    if (!SetThreadPriority(GetCurrentThread(), priority == ThreadPriority::HIGH ? THREAD_PRIORITY_ABOVE_NORMAL : priority == ThreadPriority::LOW ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_NORMAL))
+    {
+      Logger::getInstance().warning("Failed at thread priority 1");
+    }
+#elif defined(__APPLE__)
+    // The quality of service class also decides whether the thread is placed on the performance or the efficiency cores.
+    if (pthread_set_qos_class_self_np(priority == ThreadPriority::HIGH ? QOS_CLASS_USER_INTERACTIVE : priority == ThreadPriority::LOW ? QOS_CLASS_UTILITY : QOS_CLASS_USER_INITIATED, 0) != 0)
+    {
+      Logger::getInstance().warning("Failed at thread priority 1");
+    }
+#else
+    // The nice value of a thread on Linux is its own, set through its thread id.
+    // The high priority is only asked for when RLIMIT_NICE or the user allow it, since the call fails otherwise.
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), priority == ThreadPriority::HIGH ? -5 : priority == ThreadPriority::LOW ? 5 : 0) != 0)
+    {
+      Logger::getInstance().warning("Failed at thread priority 1: ", std::strerror(errno));
+    }
+#endif
+  }
+
+  /**
+   * Build the list of the given cores, for reporting.
+   *
+   * @param cores  The cores.
+   *
+   * @return The list of the cores, or "any" if there are none.
+   */
+  static std::string formatCores(const std::vector<uint32_t> &cores)
+  {
+    if (cores.empty())
+    {
+      return "any";
+    }
+    std::string list = "";
+    for (const auto &core : cores)
+    {
+      list += (list.empty() ? "" : ",") + std::to_string(core);
+    }
+    return list;
+  }
+
+  ThreadLayout()
+      : performanceCores({}),
+        efficiencyCores({}),
+        pinningSupported(detectCores()),
+        enabled(THREAD_AFFINITY_ENABLED),
+        roleCores(),
+        rolePriorities({ThreadPriority::NORMAL, isHighPriorityAllowed() ? ThreadPriority::HIGH : ThreadPriority::NORMAL, ThreadPriority::NORMAL, ThreadPriority::LOW, ThreadPriority::LOW}),
+        jobThreadsCount(1)
+  {
+    buildLayout();
+  }
+
+public:
+  // Preventing copying the thread layout, making sure only one instance can exist.
+  ThreadLayout(const ThreadLayout &) = delete;
+
+  /**
+   * Returns the singleton instance of the thread layout.
+   *
+   * @return The thread layout singleton instance.
+   */
+  static ThreadLayout &getInstance()
+  {
+    // Singleton instance of the thread layout, constructed the first time it's asked for.
+    static ThreadLayout instance;
+    return instance;
+  }
+
+  /**
+   * Place the calling thread on the cores of its role, and give it the priority of its role. A job worker is pinned to a
+   *   core of its own out of the cores of the jobs.
+   *
+   * @param role         The role of the thread.
+   * @param workerIndex  The index of the job worker, starting from 1, for the job role.
+   */
+  void applyToCurrentThread(const ThreadRole &role, const uint32_t &workerIndex = 0) const
+  {
+    if (!enabled)
+    {
+      return;
+    }
+    const auto &cores = roleCores[static_cast<uint32_t>(role)];
+    if (role == ThreadRole::JOB && !cores.empty() && workerIndex > 0)
+    {
+      pinCurrentThread({cores[(workerIndex - 1) % cores.size()]});
+    }
+    else
+    {
+      pinCurrentThread(cores);
+    }
+    setCurrentThreadPriority(rolePriorities[static_cast<uint32_t>(role)]);
+  }
+
+  /**
+   * Get the number of threads the job system runs jobs on, including the threads that aren't workers, which is one for
+   *   each core left over once the main thread and the render thread have theirs.
+   *
+   * @return The number of threads.
+   */
+  const uint32_t &getJobThreadsCount() const
+  {
+    return jobThreadsCount;
+  }
+
+  /**
+   * Log the cores found and the cores and priorities of each role.
+   */
+  void log() const
+  {
+    Logger::getInstance().info("Thread layout: ", performanceCores.size(), " performance cores, ", efficiencyCores.size(), " efficiency cores, ", jobThreadsCount, " job threads", (!enabled ? ", placement off" : !pinningSupported ? ", priorities only" : ""));
+    if (!enabled)
+    {
+      return;
+    }
+    const char *priorityNames[] = {"low", "normal", "high"};
+    for (uint32_t i = 0; i < THREAD_ROLES_COUNT; i++)
+    {
+      if (static_cast<ThreadRole>(i) == ThreadRole::RENDER && !RENDER_THREAD_ENABLED)
+      {
+        continue;
+      }
+      Logger::getInstance().info("  ", threadRoleNames[i], ": cores ", (pinningSupported ? formatCores(roleCores[i]) : "any"), ", ", priorityNames[static_cast<uint32_t>(rolePriorities[i])], " priority");
+    }
+  }
+};
+
+/**
+ * Run a function on a thread of its own in the background as a loader thread, placed on the cores of the loaders.
+ *
+ * @param function   The function.
+ * @param arguments  The arguments to the function, copied into the thread.
+ *
+ * @return The future of the result of the function.
+ */
+template <typename Function, typename... Arguments>
+auto launchLoader(Function function, Arguments... arguments)
+{
+  return std::async(std::launch::async, [function, arguments...]() {
+    ThreadLayout::getInstance().applyToCurrentThread(ThreadRole::LOADER);
+    return function(arguments...);
+  });
+}
+
+#endif
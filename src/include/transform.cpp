@@ -0,0 +1,427 @@
+#ifndef INCLUDE_TRANSFORM_CPP
+#define INCLUDE_TRANSFORM_CPP
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "job_system.cpp"
+#include "transform_batch.cpp"
+
+/**
+ * A manager class for storing the transformations of the models as a structure of arrays, so the model matrices of all
+ *   the models that moved can be rebuilt together in one pass instead of every time a model moves.
+ */
+class TransformManager
+{
+private:
+  // The positions of the transforms.
+  std::vector<glm::vec3> positions;
+  // The rotations of the transforms, as quaternions, so building the matrices and turning the transforms takes no trig.
+  std::vector<glm::quat> rotations;
+  // The scales of the transforms.
+  std::vector<glm::vec3> scales;
+  // The matrices of the transforms, which are stale while the transform is dirty.
+  std::vector<glm::mat4> matrices;
+  // Whether each transform changed since its matrix was last built.
+  std::vector<uint8_t> dirtyFlags;
+  // The indices of the dirty transforms, each only once, in a list for each thread of the job system, so models updating
+  //   in parallel can mark their own transforms.
+  std::vector<std::vector<uint32_t>> dirtyTransforms;
+  // The indices of the transforms that were destroyed, reused by the next created transforms.
+  std::vector<uint32_t> freeTransforms;
+  // The list the indices of the dirty transforms whose matrices are built together are stored to, reused between passes.
+  std::vector<uint32_t> rebuiltTransforms;
+
+  // The positions, rotations and scales of the transforms at the end of the previous simulation step.
+  std::vector<glm::vec3> previousPositions;
+  std::vector<glm::quat> previousRotations;
+  std::vector<glm::vec3> previousScales;
+  // The matrices of the transforms to render with, between the previous and the latest simulation step, and the number
+  //   of times each of them changed, which also counts the changes between the steps.
+  std::vector<glm::mat4> renderMatrices;
+  std::vector<uint64_t> renderGenerations;
+  // The number of simulation steps between the updates of each transform, and the number of steps its updates are
+  //   shifted by, so the transforms updated every few steps are rendered over all the steps between their updates.
+  std::vector<uint32_t> updateIntervals;
+  std::vector<uint32_t> updatePhases;
+  // The number of transforms not updated every step, with the previous transformations of all the transforms stored in
+  //   one go while there are none.
+  size_t scheduledTransformsCount;
+  // The index of the latest simulation step.
+  uint64_t latestStepIndex;
+
+  // The instance of the world the thread is simulating, which is used instead of the singleton instance while there is one.
+  inline static thread_local TransformManager *worldInstance = nullptr;
+  // The worlds create instances of their own.
+  friend class World;
+
+  /**
+   * Returns the singleton instance of the transform manager, which is the one of the default world.
+   *
+   * @return The transform manager singleton instance.
+   */
+  static TransformManager &getSingleton()
+  {
+    // Singleton instance of the transform manager, constructed the first time it's asked for.
+    static TransformManager instance;
+    return instance;
+  }
+
+  TransformManager()
+      : positions({}),
+        rotations({}),
+        scales({}),
+        matrices({}),
+        dirtyFlags({}),
+        dirtyTransforms(JobSystem::getInstance().getThreadsCount()),
+        freeTransforms({}),
+        rebuiltTransforms({}),
+        previousPositions({}),
+        previousRotations({}),
+        previousScales({}),
+        renderMatrices({}),
+        renderGenerations({}),
+        updateIntervals({}),
+        updatePhases({}),
+        scheduledTransformsCount(0),
+        latestStepIndex(0) {}
+
+  /**
+   * Mark the transform as changed, so its matrix is built again. Only the owner of the transform marks it, so the flag
+   *   of the transform needs no locking.
+   *
+   * @param transformIndex  The index of the transform.
+   */
+  void markDirty(const uint32_t &transformIndex)
+  {
+    if (!dirtyFlags[transformIndex])
+    {
+      dirtyFlags[transformIndex] = 1;
+      dirtyTransforms[JobSystem::getCurrentThreadIndex()].push_back(transformIndex);
+    }
+  }
+
+public:
+  // Preventing copying the transform manager, making sure only one instance can exist.
+  TransformManager(const TransformManager &) = delete;
+
+  /**
+   * Create a transform, reusing the place of a destroyed one if there is one. The transformation is taken by value,
+   *   since it can come from another transform that moves while the arrays grow. The transforms are only created and
+   *   destroyed while nothing is updating in parallel.
+   *
+   * @param position  The position.
+   * @param rotation  The rotation.
+   * @param scale     The scale.
+   *
+   * @return The index of the transform.
+   */
+  uint32_t createTransform(const glm::vec3 position, const glm::quat rotation, const glm::vec3 scale)
+  {
+    uint32_t transformIndex;
+    if (!freeTransforms.empty())
+    {
+      transformIndex = freeTransforms.back();
+      freeTransforms.pop_back();
+    }
+    else
+    {
+      transformIndex = positions.size();
+      positions.push_back(glm::vec3(0.0f));
+      rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+      scales.push_back(glm::vec3(1.0f));
+      matrices.push_back(glm::mat4(1.0f));
+      dirtyFlags.push_back(0);
+      previousPositions.push_back(glm::vec3(0.0f));
+      previousRotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+      previousScales.push_back(glm::vec3(1.0f));
+      renderMatrices.push_back(glm::mat4(1.0f));
+      renderGenerations.push_back(0);
+      updateIntervals.push_back(1);
+      updatePhases.push_back(0);
+    }
+
+    positions[transformIndex] = position;
+    rotations[transformIndex] = rotation;
+    scales[transformIndex] = scale;
+    markDirty(transformIndex);
+    resetPreviousTransform(transformIndex);
+    return transformIndex;
+  }
+
+  /**
+   * Set the transformation of the previous simulation step of the transform to its current one, so it is rendered
+   *   where it is instead of moving there from where it was, such as after being placed somewhere new.
+   *
+   * @param transformIndex  The index of the transform.
+   */
+  void resetPreviousTransform(const uint32_t &transformIndex)
+  {
+    previousPositions[transformIndex] = positions[transformIndex];
+    previousRotations[transformIndex] = rotations[transformIndex];
+    previousScales[transformIndex] = scales[transformIndex];
+    renderMatrices[transformIndex] = TransformBatch::createMatrix(positions[transformIndex], rotations[transformIndex], scales[transformIndex]);
+    renderGenerations[transformIndex]++;
+  }
+
+  /**
+   * Destroy the transform, so its place can be reused.
+   *
+   * @param transformIndex  The index of the transform.
+   */
+  void destroyTransform(const uint32_t &transformIndex)
+  {
+    setUpdateSchedule(transformIndex, 1, 0);
+    freeTransforms.push_back(transformIndex);
+  }
+
+  /**
+   * Set the number of simulation steps between the updates of the transform, and the number of steps its updates are
+   *   shifted by, so it's rendered between where it was at its previous and its latest update over all the steps between
+   *   them. The update of the step with the index i is the one the transform updates at if (i + phase) % interval is 0.
+   *
+   * @param transformIndex  The index of the transform.
+   * @param interval        The number of steps between the updates of the transform.
+   * @param phase           The number of steps the updates of the transform are shifted by.
+   */
+  void setUpdateSchedule(const uint32_t &transformIndex, const uint32_t &interval, const uint32_t &phase)
+  {
+    if (updateIntervals[transformIndex] > 1)
+    {
+      scheduledTransformsCount--;
+    }
+    if (interval > 1)
+    {
+      scheduledTransformsCount++;
+    }
+    updateIntervals[transformIndex] = interval;
+    updatePhases[transformIndex] = phase;
+  }
+
+  /**
+   * Get the position of the transform.
+   *
+   * @param transformIndex  The index of the transform.
+   *
+   * @return The position.
+   */
+  const glm::vec3 &getPosition(const uint32_t &transformIndex) const
+  {
+    return positions[transformIndex];
+  }
+
+  /**
+   * Get the rotation of the transform.
+   *
+   * @param transformIndex  The index of the transform.
+   *
+   * @return The rotation.
+   */
+  const glm::quat &getRotation(const uint32_t &transformIndex) const
+  {
+    return rotations[transformIndex];
+  }
+
+  /**
+   * Get the scale of the transform.
+   *
+   * @param transformIndex  The index of the transform.
+   *
+   * @return The scale.
+   */
+  const glm::vec3 &getScale(const uint32_t &transformIndex) const
+  {
+    return scales[transformIndex];
+  }
+
+  /**
+   * Get the matrix of the transform, building it first if the transform changed since the last pass.
+   *
+   * @param transformIndex  The index of the transform.
+   *
+   * @return The matrix.
+   */
+  const glm::mat4 &getMatrix(const uint32_t &transformIndex)
+  {
+    if (dirtyFlags[transformIndex])
+    {
+      // Build the matrix now, leaving the transform in the dirty list for the pass to skip.
+      matrices[transformIndex] = TransformBatch::createMatrix(positions[transformIndex], rotations[transformIndex], scales[transformIndex]);
+      dirtyFlags[transformIndex] = 0;
+    }
+    return matrices[transformIndex];
+  }
+
+  /**
+   * Set the position of the transform.
+   *
+   * @param transformIndex  The index of the transform.
+   * @param newPosition     The position.
+   */
+  void setPosition(const uint32_t &transformIndex, const glm::vec3 &newPosition)
+  {
+    positions[transformIndex] = newPosition;
+    markDirty(transformIndex);
+  }
+
+  /**
+   * Set the rotation of the transform.
+   *
+   * @param transformIndex  The index of the transform.
+   * @param newRotation     The rotation.
+   */
+  void setRotation(const uint32_t &transformIndex, const glm::quat &newRotation)
+  {
+    rotations[transformIndex] = newRotation;
+    markDirty(transformIndex);
+  }
+
+  /**
+   * Turn the transform by the given rotation around the axes of the world, on top of the rotation it has.
+   *
+   * @param transformIndex  The index of the transform.
+   * @param rotation        The rotation to turn by.
+   */
+  void rotate(const uint32_t &transformIndex, const glm::quat &rotation)
+  {
+    // Normalize the result, so the rounding errors of turning the transform every step don't add up to a scale.
+    rotations[transformIndex] = glm::normalize(rotation * rotations[transformIndex]);
+    markDirty(transformIndex);
+  }
+
+  /**
+   * Set the scale of the transform.
+   *
+   * @param transformIndex  The index of the transform.
+   * @param newScale        The scale.
+   */
+  void setScale(const uint32_t &transformIndex, const glm::vec3 &newScale)
+  {
+    scales[transformIndex] = newScale;
+    markDirty(transformIndex);
+  }
+
+  /**
+   * Get the matrix of the transform to render with, as last interpolated between the simulation steps.
+   *
+   * @param transformIndex  The index of the transform.
+   *
+   * @return The matrix to render with.
+   */
+  const glm::mat4 &getRenderMatrix(const uint32_t &transformIndex) const
+  {
+    return renderMatrices[transformIndex];
+  }
+
+  /**
+   * Get the render generation of the transform, which increases every time the matrix to render it with changes, even
+   *   between the simulation steps.
+   *
+   * @param transformIndex  The index of the transform.
+   *
+   * @return The render generation.
+   */
+  const uint64_t &getRenderGeneration(const uint32_t &transformIndex) const
+  {
+    return renderGenerations[transformIndex];
+  }
+
+  /**
+   * Store the transformations of the transforms updating at the next simulation step as the ones of their previous
+   *   update, before the step moves them. The transforms not updating at the step keep the ones of their latest update.
+   *
+   * @param stepIndex  The index of the next simulation step.
+   */
+  void storePreviousTransforms(const uint64_t &stepIndex)
+  {
+    latestStepIndex = stepIndex;
+    if (scheduledTransformsCount == 0)
+    {
+      previousPositions = positions;
+      previousRotations = rotations;
+      previousScales = scales;
+      return;
+    }
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+      if ((stepIndex + updatePhases[i]) % updateIntervals[i] == 0)
+      {
+        previousPositions[i] = positions[i];
+        previousRotations[i] = rotations[i];
+        previousScales[i] = scales[i];
+      }
+    }
+  }
+
+  /**
+   * Build the matrices to render with of all the transforms, between their transformations of the previous and the
+   *   latest simulation step, or of their previous and latest update for the transforms updated every few steps, which
+   *   are spread over all the steps between their updates.
+   *
+   * @param factor  How far along to the latest simulation step the rendered frame is, between 0 and 1.
+   */
+  void interpolateRenderMatrices(const float_t &factor)
+  {
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+      // Transforms that didn't move are rendered where they are.
+      if (previousPositions[i] == positions[i] && previousRotations[i] == rotations[i] && previousScales[i] == scales[i])
+      {
+        const auto &matrix = getMatrix(i);
+        if (renderMatrices[i] != matrix)
+        {
+          renderMatrices[i] = matrix;
+          renderGenerations[i]++;
+        }
+        continue;
+      }
+      const auto &interval = updateIntervals[i];
+      const auto transformFactor = interval == 1 ? factor : (((latestStepIndex + updatePhases[i]) % interval) + factor) / interval;
+      renderMatrices[i] = TransformBatch::createMatrix(glm::mix(previousPositions[i], positions[i], transformFactor),
+                                                       glm::slerp(previousRotations[i], rotations[i], transformFactor),
+                                                       glm::mix(previousScales[i], scales[i], transformFactor));
+      renderGenerations[i]++;
+    }
+  }
+
+  /**
+   * Build the matrices of all the transforms that changed since the last pass, in one go over the packed arrays, a batch
+   *   of transforms at a time.
+   */
+  void updateDirtyMatrices()
+  {
+    rebuiltTransforms.clear();
+    for (auto &threadDirtyTransforms : dirtyTransforms)
+    {
+      for (const auto &transformIndex : threadDirtyTransforms)
+      {
+        // Transforms whose matrix was already asked for since they changed are up to date, and the ones marked again
+        //   since are only in the batch once.
+        if (!dirtyFlags[transformIndex])
+        {
+          continue;
+        }
+        rebuiltTransforms.push_back(transformIndex);
+        dirtyFlags[transformIndex] = 0;
+      }
+      threadDirtyTransforms.clear();
+    }
+    TransformBatch::createMatrices(positions.data(), rotations.data(), scales.data(), rebuiltTransforms.data(), rebuiltTransforms.size(), matrices.data());
+  }
+
+  /**
+   * Returns the instance of the transform manager of the world the thread is simulating, or the singleton instance of the
+   *   default world if there is none.
+   * 
+   * @return The transform manager instance.
+   */
+  static TransformManager &getInstance()
+  {
+    return worldInstance != nullptr ? *worldInstance : getSingleton();
+  }
+};
+
+#endif
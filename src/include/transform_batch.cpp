@@ -0,0 +1,161 @@
+#ifndef INCLUDE_TRANSFORM_BATCH_CPP
+#define INCLUDE_TRANSFORM_BATCH_CPP
+
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORM_BATCH_SSE2
+#endif
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/**
+ * Class for building the matrices of batches of transformations four at a time, and the boxes around transformed boxes
+ * a whole corner at a time, using SSE2, or one at a time with the same math where SSE2 isn't available. Both take the
+ * same steps in the same order as glm does, so the matrices and the boxes come out the same to the last bit whichever
+ * way they're built, and the simulations don't change with it.
+ */
+class TransformBatch
+{
+private:
+  // The number of transformations built at once.
+  static const size_t LANES_COUNT = 4;
+
+public:
+  // Prevent creating the transform batch, since it only has static members.
+  TransformBatch() = delete;
+
+  /**
+   * Create the matrix of the given transformation, translating the rotated and scaled axes without multiplying any
+   *   matrices.
+   *
+   * @param position  The position.
+   * @param rotation  The rotation.
+   * @param scale     The scale.
+   *
+   * @return The matrix of the transformation.
+   */
+  static glm::mat4 createMatrix(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale)
+  {
+    const auto rotationMatrix = glm::mat3_cast(rotation);
+    return glm::mat4(glm::vec4(rotationMatrix[0] * scale.x, 0.0f),
+                     glm::vec4(rotationMatrix[1] * scale.y, 0.0f),
+                     glm::vec4(rotationMatrix[2] * scale.z, 0.0f),
+                     glm::vec4(position, 1.0f));
+  }
+
+  /**
+   * Create the matrices of the transformations at the given indices of the arrays of the transformations, storing each
+   *   at the same index of the array of matrices.
+   *
+   * @param positions     The array of positions.
+   * @param rotations     The array of rotations.
+   * @param scales        The array of scales.
+   * @param indices       The indices of the transformations to build the matrices of.
+   * @param indicesCount  The number of indices.
+   * @param matrices      The array of matrices to store the matrices to.
+   */
+  static void createMatrices(const glm::vec3 *positions, const glm::quat *rotations, const glm::vec3 *scales,
+                             const uint32_t *indices, const size_t &indicesCount, glm::mat4 *matrices)
+  {
+    size_t i = 0;
+#ifdef TRANSFORM_BATCH_SSE2
+    const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+    for (; i + LANES_COUNT <= indicesCount; i += LANES_COUNT)
+    {
+      const uint32_t lanes[LANES_COUNT] = {indices[i], indices[i + 1], indices[i + 2], indices[i + 3]};
+      // Gather each component of the four transformations into the lanes of a register.
+      const auto gather = [&](const float_t *values, const size_t &stride) {
+        return _mm_setr_ps(values[lanes[0] * stride], values[lanes[1] * stride], values[lanes[2] * stride], values[lanes[3] * stride]);
+      };
+      const auto rotationX = gather(&rotations[0].x, 4), rotationY = gather(&rotations[0].y, 4), rotationZ = gather(&rotations[0].z, 4), rotationW = gather(&rotations[0].w, 4);
+
+      // Build the rotation matrices the way glm::mat3_cast does.
+      const auto qxx = _mm_mul_ps(rotationX, rotationX), qyy = _mm_mul_ps(rotationY, rotationY), qzz = _mm_mul_ps(rotationZ, rotationZ);
+      const auto qxz = _mm_mul_ps(rotationX, rotationZ), qxy = _mm_mul_ps(rotationX, rotationY), qyz = _mm_mul_ps(rotationY, rotationZ);
+      const auto qwx = _mm_mul_ps(rotationW, rotationX), qwy = _mm_mul_ps(rotationW, rotationY), qwz = _mm_mul_ps(rotationW, rotationZ);
+      const auto scaleX = gather(&scales[0].x, 3), scaleY = gather(&scales[0].y, 3), scaleZ = gather(&scales[0].z, 3);
+      // The columns of the matrices, with each rotated axis scaled, then the position.
+      __m128 columns[4][4] = {
+          {_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz))), scaleX),
+           _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxy, qwz)), scaleX),
+           _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxz, qwy)), scaleX),
+           zero},
+          {_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxy, qwz)), scaleY),
+           _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz))), scaleY),
+           _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qyz, qwx)), scaleY),
+           zero},
+          {_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxz, qwy)), scaleZ),
+           _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qyz, qwx)), scaleZ),
+           _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy))), scaleZ),
+           zero},
+          {gather(&positions[0].x, 3), gather(&positions[0].y, 3), gather(&positions[0].z, 3), one}};
+
+      // Turn the lanes of each column back into the column of each matrix.
+      for (size_t column = 0; column < 4; column++)
+      {
+        _MM_TRANSPOSE4_PS(columns[column][0], columns[column][1], columns[column][2], columns[column][3]);
+        for (size_t lane = 0; lane < LANES_COUNT; lane++)
+        {
+          _mm_storeu_ps(&matrices[lanes[lane]][column].x, columns[column][lane]);
+        }
+      }
+    }
+#endif
+    // Build the rest of the matrices one at a time.
+    for (; i < indicesCount; i++)
+    {
+      const auto &index = indices[i];
+      matrices[index] = createMatrix(positions[index], rotations[index], scales[index]);
+    }
+  }
+
+  /**
+   * Find the smallest axis-aligned box around the given corners of a box once transformed by a matrix.
+   *
+   * @param matrix     The matrix.
+   * @param corners    The eight corners of the box.
+   * @param minCorner  The corner of the transformed box with the smallest coordinates, set by the call.
+   * @param maxCorner  The corner of the transformed box with the largest coordinates, set by the call.
+   */
+  static void transformBox(const glm::mat4 &matrix, const std::array<glm::vec3, 8> &corners, glm::vec3 &minCorner, glm::vec3 &maxCorner)
+  {
+#ifdef TRANSFORM_BATCH_SSE2
+    const auto column0 = _mm_loadu_ps(&matrix[0].x), column1 = _mm_loadu_ps(&matrix[1].x);
+    const auto column2 = _mm_loadu_ps(&matrix[2].x), column3 = _mm_loadu_ps(&matrix[3].x);
+    // Transform the corners the way glm multiplies a matrix by a vector, adding up the products in pairs.
+    const auto transformCorner = [&](const glm::vec3 &corner) {
+      return _mm_add_ps(_mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(corner.x)), _mm_mul_ps(column1, _mm_set1_ps(corner.y))),
+                        _mm_add_ps(_mm_mul_ps(column2, _mm_set1_ps(corner.z)), column3));
+    };
+    auto newMinCorner = transformCorner(corners[0]);
+    auto newMaxCorner = newMinCorner;
+    for (size_t i = 1; i < corners.size(); i++)
+    {
+      // Keep the corner found so far on ties, like glm::min and glm::max.
+      const auto newCorner = transformCorner(corners[i]);
+      newMinCorner = _mm_min_ps(newCorner, newMinCorner);
+      newMaxCorner = _mm_max_ps(newCorner, newMaxCorner);
+    }
+    alignas(16) float_t minValues[4], maxValues[4];
+    _mm_store_ps(minValues, newMinCorner);
+    _mm_store_ps(maxValues, newMaxCorner);
+    minCorner = glm::vec3(minValues[0], minValues[1], minValues[2]);
+    maxCorner = glm::vec3(maxValues[0], maxValues[1], maxValues[2]);
+#else
+    minCorner = glm::vec3(matrix * glm::vec4(corners[0], 1.0f));
+    maxCorner = minCorner;
+    for (size_t i = 1; i < corners.size(); i++)
+    {
+      const auto newCorner = glm::vec3(matrix * glm::vec4(corners[i], 1.0f));
+      minCorner = glm::min(minCorner, newCorner);
+      maxCorner = glm::max(maxCorner, newCorner);
+    }
+#endif
+  }
+};
+
+#endif
@@ -1,15 +1,54 @@
 #ifndef INCLUDE_WINDOW_CPP
 #define INCLUDE_WINDOW_CPP
 
-#include <iostream>
 #include <set>
 #include <string>
+#include <array>
+#include <thread>
+#include <chrono>
+#include <algorithm>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
+#include "gl_state.cpp"
 #include "constants.cpp"
+#include "frame_arena.cpp"
+#include "gl_debug.cpp"
+#include "log.cpp"
+#include "settings.cpp"
+
+/**
+ * Enum for the modes of waiting for the GPU after swapping the buffers, so the input of the next frame is read closer
+ *   to when the frame is shown instead of while the driver still has older frames queued up.
+ */
+enum class LatencyMode
+{
+  // The driver queues up as many frames as it likes.
+  OFF,
+  // The CPU waits for the GPU once it gets more than the allowed frames ahead of it.
+  FRAME_FENCE,
+  // The CPU waits for the GPU to finish every frame, including its swap.
+  FINISH_SWAP
+};
+
+/**
+ * Enum for the modes of swapping the buffers, which the V-Sync toggle cycles through.
+ */
+enum class SwapMode
+{
+  // Swap as soon as the frame is done.
+  DISABLED,
+  // Wait for one or two screen refreshes before swapping.
+  SINGLE_SYNC,
+  DOUBLE_SYNC,
+  // Wait for a screen refresh, unless the frame missed it, in which case swap right away and tear instead of stalling
+  //   for the next one. Only in the cycle when the driver lists a swap control tear extension.
+  ADAPTIVE_SYNC,
+  // Swap as soon as the frame is done, but sleep out the rest of the frame time of the frame rate cap first.
+  FRAME_RATE_CAP
+};
 
 /**
  * A class to manage the window.
@@ -17,15 +56,59 @@
 class WindowManager
 {
 private:
-  // Singleton instance of the window manager.
-  static WindowManager instance;
-
   // Is GLFW initialized.
   const bool isGlfwInitialized;
   // A pointer to the GLFW created window.
   GLFWwindow *const window;
   // Is GLEW initialized.
   const bool isGlewInitialized;
+  // The names of the OpenGL extensions supported by the driver.
+  const std::set<std::string> supportedExtensions;
+  // Whether the vertex shader can select the layer of a layered framebuffer to render to.
+  const bool vertexShaderLayerSupported;
+  // Whether a draw can render into several layers of a framebuffer at once, with every output of the vertex shader
+  //   depending on the view.
+  const bool multiviewSupported;
+  // Whether the driver can report its performance warnings through the debug output.
+  const bool debugOutputSupported;
+  // Whether the draws of many meshes can be read from a buffer of draw commands by a single call, each with its own base
+  //   instance.
+  const bool multiDrawIndirectSupported;
+  // Whether compute shaders can be run, reading and writing shader storage buffers.
+  const bool computeShaderSupported;
+  // Whether textures can be allocated with immutable storage, laying out all their levels and layers at once.
+  const bool textureStorageSupported;
+  // Whether buffers and textures can be created and edited by their names, with immutable storage, without binding them.
+  const bool directStateAccessSupported;
+  // Whether the texels of a texture can be copied straight into another texture, without a framebuffer.
+  const bool copyImageSupported;
+  // Whether the driver can compile and link shader programs on its own threads, reporting when each one is done.
+  const bool parallelShaderCompileSupported;
+  // The renderbuffers holding the colors and the depths of the frames when rendering offscreen, and the framebuffer they're
+  //   attached to, which is bound in place of the window, or 0 when rendering to the window.
+  std::array<GLuint, 2> offscreenRenderbufferIds;
+  const GLuint offscreenFramebufferId;
+
+  // Whether the driver can swap right away when a frame misses the screen refresh it was synced to.
+  const bool adaptiveSyncSupported;
+  // The mode of swapping the buffers, and its name for the overlay, built whenever the mode changes.
+  SwapMode swapMode;
+  std::string swapModeName;
+  // The time the next frame is swapped at in the frame rate cap mode.
+  double_t nextFrameDeadline;
+
+  // Whether the window has the input focus and whether it's minimized, kept up to date by the GLFW callbacks, and the
+  //   time the next frame starts at while the window is idle.
+  bool windowFocused;
+  bool windowIconified;
+  double_t nextIdleTick;
+
+  // The mode of waiting for the GPU after swapping the buffers.
+  LatencyMode latencyMode;
+  // The fences placed after the swaps of the frames in flight, or null where no frame is, with the next one placed at
+  //   the given index.
+  std::array<GLsync, LOW_LATENCY_FRAMES_IN_FLIGHT> frameFences;
+  uint32_t frameFenceIndex;
 
   /**
    * Initialize GLFW library.
@@ -38,16 +121,21 @@ private:
     if (!glfwInit())
     {
       // Failed to initialize. Time to crash.
-      std::cout << "Failed at window 1" << std::endl;
+      Logger::getInstance().error("Failed at window 1");
       exit(1);
     }
 
-    // Set up OpenGL window hints for creating an OpenGL context.
-    glfwWindowHint(GLFW_SAMPLES, 4);
+    // Set up OpenGL window hints for creating an OpenGL context. The window isn't multisampled, since the scene is
+    //   anti-aliased in its own render targets, and the text drawn over it doesn't need it.
+    glfwWindowHint(GLFW_SAMPLES, 0);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // Because MacOS.
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Ask for a debug context, which drivers only report most of their performance warnings in.
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, DEBUG_CONTEXT_ENABLED ? GL_TRUE : GL_FALSE);
+    // Keep the window hidden when rendering offscreen, where it's only there for its GL context.
+    glfwWindowHint(GLFW_VISIBLE, OFFSCREEN_ENABLED ? GL_FALSE : GL_TRUE);
 
     return true;
   }
@@ -66,7 +154,7 @@ private:
     if (newWindow == NULL)
     {
       // Failed to create. Time to crash.
-      std::cout << "Failed at window 2" << std::endl;
+      Logger::getInstance().error("Failed at window 2");
       exit(1);
     }
 
@@ -75,20 +163,11 @@ private:
 
     // Get the size of the viewport of the window (this should be the same as the window width, but on MacOS it is float_t).
     glfwGetFramebufferSize(newWindow, &VIEWPORT_WIDTH, &VIEWPORT_HEIGHT);
-    // Define the framebuffer width as float_t the viewport width.
-    FRAMEBUFFER_WIDTH = VIEWPORT_WIDTH;
-    // Define the framebuffer height as float_t the viewport width (so that framebuffer is a square).
-    FRAMEBUFFER_HEIGHT = VIEWPORT_WIDTH;
     // Define the text height as 1/26 of the viewport height (so we can fit approx 20 lines in the screen).
     TEXT_HEIGHT = VIEWPORT_HEIGHT / 26;
     // Define the text width as 1/80 of the viewport width (so we can fit approx 80 characters per line in the screen).
     TEXT_WIDTH = VIEWPORT_WIDTH / 80;
 
-    // Set the option for sticky keys on the window to true. This means keys will remain in the pressed state until they're processed.
-    // This allows us to catch key presses that may be missed if we didn't poll in time.
-    glfwSetInputMode(newWindow, GLFW_STICKY_KEYS, true);
-    glfwSetInputMode(newWindow, GLFW_STICKY_MOUSE_BUTTONS, true);
-
     // Set what the interval is for swapping buffers. A value of zero means the swap should be immediate.
     // A value of 1 means that a single screen refresh should occur before swapping buffers.
     glfwSwapInterval(SWAP_INTERVAL);
@@ -110,49 +189,248 @@ private:
     if (glewInit() != GLEW_OK)
     {
       // Failed to initialize. Time to crash.
-      std::cout << "Failed at window 3" << std::endl;
+      Logger::getInstance().error("Failed at window 3");
+      exit(1);
+    }
+
+    // Set the viewport width to the values we got from GLFW.
+    GlStateCache::getInstance().setViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+
+    // Set the color to use when clearing the screen/framebuffer.
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+    // Enable depth testing of the fragments, allowing the GPU to drop fragments from a single object and not process them if a condition is satisfied.
+    GlStateCache::getInstance().setCapability(GL_DEPTH_TEST, true);
+    // Use the less than function for depth testing fragments. This means any fragment of an object that is behind another fragment of the same object is dropped.
+    glDepthFunc(GL_LESS);
+
+    // Enable culling of faces/polygons. This means that any face/polygon that is behind another polygon within the same object is dropped.
+    GlStateCache::getInstance().setCapability(GL_CULL_FACE, true);
+    glCullFace(GL_BACK);
+
+    return true;
+  }
+
+  /**
+   * Create the framebuffer rendered into in place of the window when rendering offscreen, of the size of the viewport
+   *   of the window, and bind it in place of the window. A hidden window can fail the pixel ownership test, leaving what's
+   *   drawn to it undefined and letting the driver skip the work, so the frames are drawn into a framebuffer of their own.
+   * 
+   * @return The ID of the framebuffer, or 0 if not rendering offscreen.
+   */
+  GLuint createOffscreenFramebuffer()
+  {
+    if (!OFFSCREEN_ENABLED)
+    {
+      return 0;
+    }
+    glGenRenderbuffers(2, offscreenRenderbufferIds.data());
+    glBindRenderbuffer(GL_RENDERBUFFER, offscreenRenderbufferIds[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    glBindRenderbuffer(GL_RENDERBUFFER, offscreenRenderbufferIds[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLuint framebufferId;
+    glGenFramebuffers(1, &framebufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreenRenderbufferIds[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, offscreenRenderbufferIds[1]);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      // Failed to create the framebuffer. Time to crash.
+      Logger::getInstance().error("Failed at window 5");
       exit(1);
     }
+    GpuDebugLabels::labelObject(GL_FRAMEBUFFER, framebufferId, "Offscreen Window");
+    GlStateCache::getInstance().setWindowFramebuffer(framebufferId);
+    GlStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    Logger::getInstance().info("Rendering offscreen at ", VIEWPORT_WIDTH, "x", VIEWPORT_HEIGHT);
+    return framebufferId;
+  }
 
+  /**
+   * Read the names of the OpenGL extensions supported by the driver, and check that the required extensions are present.
+   * 
+   * @return The set of the supported extension names.
+   */
+  std::set<std::string> loadSupportedExtensions()
+  {
     int32_t numberOfExtensions;
     glGetIntegerv(GL_NUM_EXTENSIONS, &numberOfExtensions);
-    std::set<std::string> supportedExtensions;
+    std::set<std::string> extensions;
     for (int32_t i = 0; i < numberOfExtensions; i++)
     {
       const auto extensionName = (const char *)glGetStringi(GL_EXTENSIONS, i);
-      supportedExtensions.insert(std::string(extensionName));
+      extensions.insert(std::string(extensionName));
     }
 
     // Check if cube map array textures are supported
-    if (supportedExtensions.find("GL_ARB_texture_cube_map_array") == supportedExtensions.end())
+    if (extensions.find("GL_ARB_texture_cube_map_array") == extensions.end())
     {
       // Not supported. Time to crash.
-      std::cout << "Failed at window 4" << std::endl;
+      Logger::getInstance().error("Failed at window 4");
       exit(1);
     }
 
-    // Set the viewport width to the values we got from GLFW.
-    glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    return extensions;
+  }
 
-    // Set the color to use when clearing the screen/framebuffer.
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  WindowManager() : isGlfwInitialized(initializeGlfw()),
+                    window(createWindow()),
+                    isGlewInitialized(initializeGlew()),
+                    supportedExtensions(loadSupportedExtensions()),
+                    vertexShaderLayerSupported(isExtensionSupported("GL_ARB_shader_viewport_layer_array") || isExtensionSupported("GL_AMD_vertex_shader_layer")),
+                    multiviewSupported(isExtensionSupported("GL_OVR_multiview2")),
+                    debugOutputSupported(GLEW_VERSION_4_3 || isExtensionSupported("GL_KHR_debug")),
+                    multiDrawIndirectSupported(GLEW_VERSION_4_3 || (isExtensionSupported("GL_ARB_draw_indirect") && isExtensionSupported("GL_ARB_multi_draw_indirect") && isExtensionSupported("GL_ARB_base_instance"))),
+                    computeShaderSupported(GLEW_VERSION_4_3 || (isExtensionSupported("GL_ARB_compute_shader") && isExtensionSupported("GL_ARB_shader_storage_buffer_object"))),
+                    textureStorageSupported(GLEW_VERSION_4_2 || isExtensionSupported("GL_ARB_texture_storage")),
+                    directStateAccessSupported(GLEW_VERSION_4_5 || (isExtensionSupported("GL_ARB_direct_state_access") && isExtensionSupported("GL_ARB_buffer_storage") && isExtensionSupported("GL_ARB_texture_storage"))),
+                    copyImageSupported(GLEW_VERSION_4_3 || isExtensionSupported("GL_ARB_copy_image")),
+                    parallelShaderCompileSupported(GLEW_ARB_parallel_shader_compile || isExtensionSupported("GL_KHR_parallel_shader_compile")),
+                    offscreenRenderbufferIds({0, 0}),
+                    offscreenFramebufferId(createOffscreenFramebuffer()),
+                    adaptiveSyncSupported(glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")),
+                    swapMode(SWAP_INTERVAL == 0 ? SwapMode::DISABLED : SWAP_INTERVAL == 1 ? SwapMode::SINGLE_SYNC : SwapMode::DOUBLE_SYNC),
+                    swapModeName(""),
+                    nextFrameDeadline(0.0),
+                    windowFocused(glfwGetWindowAttrib(window, GLFW_FOCUSED) != 0),
+                    windowIconified(glfwGetWindowAttrib(window, GLFW_ICONIFIED) != 0),
+                    nextIdleTick(0.0),
+                    latencyMode(LatencyMode::OFF),
+                    frameFences(),
+                    frameFenceIndex(0)
+  {
+    frameFences.fill(nullptr);
+    applySwapMode();
+    glfwSetWindowFocusCallback(window, onWindowFocus);
+    glfwSetWindowIconifyCallback(window, onWindowIconify);
+    if (DEBUG_CONTEXT_ENABLED && debugOutputSupported)
+    {
+      GlDebugLog::getInstance().attach();
+    }
+    // Let the driver compile on as many threads as it likes. Drivers with only the KHR version already do by default.
+    if (GLEW_ARB_parallel_shader_compile)
+    {
+      glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+    // Pick the swap mode of the swap interval again when it, or the frame rate it's capped at, changes in the settings.
+    SettingsManager::getInstance().addListener("swap_interval", [this]() { setSwapInterval(SWAP_INTERVAL); });
+    SettingsManager::getInstance().addListener("frame_rate_cap", [this]() { applySwapMode(); });
+  }
 
-    // Enable depth testing of the fragments, allowing the GPU to drop fragments from a single object and not process them if a condition is satisfied.
-    glEnable(GL_DEPTH_TEST);
-    // Use the less than function for depth testing fragments. This means any fragment of an object that is behind another fragment of the same object is dropped.
-    glDepthFunc(GL_LESS);
+  /**
+   * Set the swap interval of the current swap mode, and build its name.
+   */
+  void applySwapMode()
+  {
+    switch (swapMode)
+    {
+    case SwapMode::SINGLE_SYNC:
+      SWAP_INTERVAL = 1;
+      swapModeName = "True (Single-Sync)";
+      break;
+    case SwapMode::DOUBLE_SYNC:
+      SWAP_INTERVAL = 2;
+      swapModeName = "True (Double-Sync)";
+      break;
+    case SwapMode::ADAPTIVE_SYNC:
+      // A negative interval lets the swap tear when the frame is late.
+      SWAP_INTERVAL = -1;
+      swapModeName = "True (Adaptive)";
+      break;
+    case SwapMode::FRAME_RATE_CAP:
+      SWAP_INTERVAL = 0;
+      swapModeName = "False (Capped at " + std::to_string(FRAME_RATE_CAP) + "fps)";
+      break;
+    case SwapMode::DISABLED:
+    default:
+      SWAP_INTERVAL = 0;
+      swapModeName = "False";
+    }
+    glfwSwapInterval(SWAP_INTERVAL);
+    nextFrameDeadline = glfwGetTime();
+  }
 
-    // Enable culling of faces/polygons. This means that any face/polygon that is behind another polygon within the same object is dropped.
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+  /**
+   * Wait until the time the next frame is swapped at in the frame rate cap mode, sleeping for most of the wait and
+   *   spinning for the rest of it, so the frames are paced evenly without keeping the CPU busy.
+   */
+  void waitForFrameDeadline()
+  {
+    const auto frameInterval = 1.0 / FRAME_RATE_CAP;
+    auto now = glfwGetTime();
+    // Don't rush through frames to catch up after a slow one, just pace the frames from now on.
+    if (nextFrameDeadline < now - frameInterval)
+    {
+      nextFrameDeadline = now;
+    }
+    if (nextFrameDeadline - now > FRAME_RATE_CAP_SPIN_TIME)
+    {
+      std::this_thread::sleep_for(std::chrono::duration<double_t>(nextFrameDeadline - now - FRAME_RATE_CAP_SPIN_TIME));
+    }
+    while (glfwGetTime() < nextFrameDeadline)
+    {
+    }
+    nextFrameDeadline += frameInterval;
+  }
 
-    return true;
+  /**
+   * Callback for the window gaining or losing the input focus.
+   *
+   * @param window   The window.
+   * @param focused  Whether the window gained the focus.
+   */
+  static void onWindowFocus(GLFWwindow *, int32_t focused)
+  {
+    getInstance().windowFocused = focused != 0;
   }
 
-  WindowManager() : isGlfwInitialized(initializeGlfw()),
-                    window(createWindow()),
-                    isGlewInitialized(initializeGlew())
+  /**
+   * Callback for the window being minimized or restored.
+   *
+   * @param window     The window.
+   * @param iconified  Whether the window was minimized.
+   */
+  static void onWindowIconify(GLFWwindow *, int32_t iconified)
+  {
+    getInstance().windowIconified = iconified != 0;
+  }
+
+  /**
+   * Delete the fences of the frames in flight, without waiting for them.
+   */
+  void clearFrameFences()
+  {
+    for (auto &frameFence : frameFences)
+    {
+      if (frameFence != nullptr)
+      {
+        glDeleteSync(frameFence);
+        frameFence = nullptr;
+      }
+    }
+    frameFenceIndex = 0;
+  }
+
+  /**
+   * Wait for the GPU to be done with the oldest frame in flight once all of the allowed frames are, and place the fence
+   *   of the frame just swapped in its place.
+   */
+  void limitFramesInFlight()
   {
+    auto &frameFence = frameFences[frameFenceIndex];
+    if (frameFence != nullptr)
+    {
+      // The wait only times out so the commands get flushed, so keep waiting until the fence is signalled.
+      while (glClientWaitSync(frameFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+      {
+      }
+      glDeleteSync(frameFence);
+    }
+    frameFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameFenceIndex = (frameFenceIndex + 1) % LOW_LATENCY_FRAMES_IN_FLIGHT;
   }
 
 public:
@@ -161,6 +439,13 @@ public:
 
   ~WindowManager()
   {
+    clearFrameFences();
+    if (offscreenFramebufferId != 0)
+    {
+      GlStateCache::getInstance().setWindowFramebuffer(0);
+      GlStateCache::getInstance().deleteFramebuffers(1, &offscreenFramebufferId);
+      glDeleteRenderbuffers(2, offscreenRenderbufferIds.data());
+    }
     // Destroy the GLFW window on application termination.
     glfwDestroyWindow(window);
   }
@@ -175,32 +460,173 @@ public:
     return window;
   }
 
+  /**
+   * Check if the driver supports the given OpenGL extension.
+   * 
+   * @param extensionName  The name of the extension.
+   * 
+   * @return Whether the extension is supported.
+   */
+  bool isExtensionSupported(const std::string &extensionName) const
+  {
+    return supportedExtensions.find(extensionName) != supportedExtensions.end();
+  }
+
+  /**
+   * Check if the vertex shader can select the layer of a layered framebuffer to render to, so shadow maps can be rendered
+   * with instancing instead of a geometry shader.
+   * 
+   * @return Whether vertex shader layer selection is supported.
+   */
+  bool isVertexShaderLayerSupported() const
+  {
+    return vertexShaderLayerSupported;
+  }
+
+  /**
+   * Check if a single draw can render into several layers of a framebuffer, once per view, with the vertex shader
+   * picking what to draw into each from the view index, so the shadow maps of all the cone lights are rendered in one pass.
+   * 
+   * @return Whether multiview with view-dependent vertex shader outputs is supported.
+   */
+  bool isMultiviewSupported() const
+  {
+    return multiviewSupported;
+  }
+
+  /**
+   * Check if the draws of many meshes can be submitted with a single multi-draw indirect call, with the instance data of
+   * each draw picked by its base instance.
+   * 
+   * @return Whether multi-draw indirect with base instances is supported.
+   */
+  bool isMultiDrawIndirectSupported() const
+  {
+    return multiDrawIndirectSupported;
+  }
+
+  /**
+   * Check if compute shaders can be run, with shader storage buffers for them to read from and write to.
+   * 
+   * @return Whether compute shaders are supported.
+   */
+  bool isComputeShaderSupported() const
+  {
+    return computeShaderSupported;
+  }
+
+  /**
+   * Check if textures can be allocated with immutable storage, which can't be resized or have levels added later, but
+   * lets the driver lay out all the levels and layers at once.
+   * 
+   * @return Whether immutable texture storage is supported.
+   */
+  bool isTextureStorageSupported() const
+  {
+    return textureStorageSupported;
+  }
+
+  /**
+   * Check if the texels of a region of a texture can be copied straight into another texture, which lets the texture
+   * arrays grow while keeping the layers they had.
+   * 
+   * @return Whether copying between textures is supported.
+   */
+  bool isCopyImageSupported() const
+  {
+    return copyImageSupported;
+  }
+
+  /**
+   * Check if the shader programs can be compiled and linked by the driver in the background, so any number of them can
+   * be submitted at once and only checked on once they're done.
+   * 
+   * @return Whether parallel shader compilation is supported.
+   */
+  bool isParallelShaderCompileSupported() const
+  {
+    return parallelShaderCompileSupported;
+  }
+
+  /**
+   * Check if buffers and textures can be created with immutable storage and edited by their names, instead of being bound
+   * to be edited and unbound again.
+   * 
+   * @return Whether direct state access is supported.
+   */
+  bool isDirectStateAccessSupported() const
+  {
+    return directStateAccessSupported;
+  }
+
+  /**
+   * Check if the driver reports its performance warnings through the debug output, which are logged when the debug
+   * context is enabled.
+   * 
+   * @return Whether the debug output is supported.
+   */
+  bool isDebugOutputSupported() const
+  {
+    return debugOutputSupported;
+  }
+
   /**
    * Set the viewport to the size of the window viewport.
    */
   void switchToWindowViewport()
   {
-    glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    GlStateCache::getInstance().setViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
   }
 
   /**
-   * Set the viewport to the size of the framebuffer.
+   * Move on to the next mode of swapping the buffers.
+   * * Disabled swaps immediately.
+   * * Single-sync and double-sync wait for one or two screen refreshes before swapping buffers.
+   * * Adaptive waits for a screen refresh unless the frame is late, and is skipped if the driver doesn't support it.
+   * * The frame rate cap swaps immediately, after sleeping out the rest of the frame time of FRAME_RATE_CAP.
    */
-  void switchToFrameBufferViewport()
+  void toggleVsync()
   {
-    glViewport(0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+    switch (swapMode)
+    {
+    case SwapMode::DISABLED:
+      swapMode = SwapMode::SINGLE_SYNC;
+      break;
+    case SwapMode::SINGLE_SYNC:
+      swapMode = SwapMode::DOUBLE_SYNC;
+      break;
+    case SwapMode::DOUBLE_SYNC:
+      swapMode = adaptiveSyncSupported ? SwapMode::ADAPTIVE_SYNC : SwapMode::FRAME_RATE_CAP;
+      break;
+    case SwapMode::ADAPTIVE_SYNC:
+      swapMode = SwapMode::FRAME_RATE_CAP;
+      break;
+    case SwapMode::FRAME_RATE_CAP:
+    default:
+      swapMode = SwapMode::DISABLED;
+    }
+    applySwapMode();
   }
 
   /**
-   * Toggle what the interval is for swapping buffers.
-   * * A value of 0 means the swap should be immediate.
-   * * A value of 1 means that a single screen refresh should occur before swapping buffers. 
-   * * A value of 2 means that two screen refreshes should occur before swapping buffers. 
+   * Set the number of screen refreshes to wait for before swapping buffers, with 0 disabling V-Sync.
+   * 
+   * @param swapInterval  The number of screen refreshes.
    */
-  void toggleVsync()
+  void setSwapInterval(const int32_t &swapInterval)
   {
-    SWAP_INTERVAL = SWAP_INTERVAL == 0 ? 2 : SWAP_INTERVAL == 2 ? 1 : 0;
-    glfwSwapInterval(SWAP_INTERVAL);
+    swapMode = swapInterval == 0 ? SwapMode::DISABLED : swapInterval == 1 ? SwapMode::SINGLE_SYNC : SwapMode::DOUBLE_SYNC;
+    applySwapMode();
+  }
+
+  /**
+   * Get the name of the mode of swapping the buffers, for showing in the overlay.
+   * 
+   * @return The name of the mode.
+   */
+  const std::string &getSwapModeName() const
+  {
+    return swapModeName;
   }
 
   /**
@@ -225,26 +651,106 @@ public:
 
   void enableBlending(const GLenum sFactor, const GLenum dFactor)
   {
-    glDisable(GL_CULL_FACE);
+    GlStateCache::getInstance().setCapability(GL_CULL_FACE, false);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(sFactor, dFactor);
+    GlStateCache::getInstance().setCapability(GL_BLEND, true);
+    GlStateCache::getInstance().setBlendFunc(sFactor, dFactor);
   }
 
   void disableBlending()
   {
-    glEnable(GL_CULL_FACE);
+    GlStateCache::getInstance().setCapability(GL_CULL_FACE, true);
     glCullFace(GL_BACK);
 
-    glDisable(GL_BLEND);
+    GlStateCache::getInstance().setCapability(GL_BLEND, false);
+  }
+
+  /**
+   * Move on to the next mode of waiting for the GPU after swapping the buffers, going back to not waiting after the last.
+   */
+  void toggleLatencyMode()
+  {
+    latencyMode = latencyMode == LatencyMode::OFF ? LatencyMode::FRAME_FENCE : latencyMode == LatencyMode::FRAME_FENCE ? LatencyMode::FINISH_SWAP : LatencyMode::OFF;
+    clearFrameFences();
+  }
+
+  /**
+   * Get the name of the mode of waiting for the GPU after swapping the buffers, for showing in the overlay.
+   * 
+   * @return The name of the mode.
+   */
+  const char *getLatencyModeName() const
+  {
+    return latencyMode == LatencyMode::OFF ? "Off" : latencyMode == LatencyMode::FRAME_FENCE ? "Frame Fence" : "Finish Swap";
   }
 
   /**
-   * Swap the active framebuffer of the window to the one on which was drawn.
+   * Swap the active framebuffer of the window to the one on which was drawn, then wait for the GPU as the latency mode
+   *   asks, so the input polled right after is as fresh as it can be by the time its frame is shown. The scratch data of
+   *   the frame is done with once it's swapped, so the frame arena is reset for the next one.
    */
   void swapBuffers()
   {
+    FrameArena::getInstance().reset();
+    if (swapMode == SwapMode::FRAME_RATE_CAP)
+    {
+      waitForFrameDeadline();
+    }
     glfwSwapBuffers(window);
+    switch (latencyMode)
+    {
+    case LatencyMode::FRAME_FENCE:
+      limitFramesInFlight();
+      break;
+    case LatencyMode::FINISH_SWAP:
+      // With V-Sync, this blocks until the swapped frame is shown.
+      glFinish();
+      break;
+    case LatencyMode::OFF:
+    default:
+      break;
+    }
+  }
+
+  /**
+   * Check if the window is minimized, in which case nothing drawn to it can be seen.
+   *
+   * @return Whether the window is minimized.
+   */
+  bool isWindowIconified() const
+  {
+    return windowIconified;
+  }
+
+  /**
+   * Check if the window is idle, being minimized or without the input focus, such as when it's behind another window.
+   *   A window rendering offscreen is never idle, since it's hidden on purpose.
+   *
+   * @return Whether the window is idle.
+   */
+  bool isWindowIdle() const
+  {
+    return !OFFSCREEN_ENABLED && (windowIconified || !windowFocused);
+  }
+
+  /**
+   * Sleep until the next frame is due at the frame rate of IDLE_FRAME_RATE, so an idle window keeps the CPU and the GPU
+   *   mostly asleep while still handling its events.
+   */
+  void waitForIdleTick()
+  {
+    const auto idleInterval = 1.0 / std::max<uint32_t>(IDLE_FRAME_RATE, 1);
+    const auto now = glfwGetTime();
+    // Start pacing from now once the window becomes idle, instead of from the last time it was.
+    if (nextIdleTick < now - idleInterval)
+    {
+      nextIdleTick = now;
+    }
+    if (nextIdleTick > now)
+    {
+      std::this_thread::sleep_for(std::chrono::duration<double_t>(nextIdleTick - now));
+    }
+    nextIdleTick += idleInterval;
   }
 
   /**
@@ -264,11 +770,10 @@ public:
    */
   static WindowManager &getInstance()
   {
+    // Singleton instance of the window manager, constructed the first time it's asked for.
+    static WindowManager instance;
     return instance;
   }
 };
 
-// Initialize the window manager singleton instance static variable.
-WindowManager WindowManager::instance;
-
 #endif
\ No newline at end of file
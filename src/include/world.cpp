@@ -0,0 +1,278 @@
+#ifndef INCLUDE_WORLD_CPP
+#define INCLUDE_WORLD_CPP
+
+#include <memory>
+
+#include "events.cpp"
+#include "transform.cpp"
+#include "light.cpp"
+#include "camera.cpp"
+#include "models.cpp"
+#include "collision.cpp"
+#include "attachment.cpp"
+#include "projectiles.cpp"
+#include "control.cpp"
+
+/**
+ * Class for the simulation state of a game of its own: its gameplay events, its models with their transformations,
+ *   lights, cameras, collisions, attachments, projectiles and controls. The scenes are given the world they play in,
+ *   and the models hold on to the world that was entered when they were created. The game played in the window plays
+ *   in the default world, whose managers are the singleton ones the renderer draws, while every simulated game gets a
+ *   world, so many of them can be stepped at once on different threads. The managers of the world are the ones their getInstance gives while a
+ *   thread has entered the world with a world scope. The subsystems bound to the GL context or the window, such as the
+ *   render, shadow buffer, text, window, object, texture and shader managers, belong to the thread owning the context
+ *   rather than to a world, so they're left out of it. Worlds other than the default one are only simulated headless,
+ *   since they have no window to take input from or draw to.
+ */
+class World
+{
+private:
+  // The managers of the world, in the order they're created, with each created after the managers it depends on.
+  std::shared_ptr<EventBus> eventBus;
+  std::shared_ptr<TransformManager> transformManager;
+  std::shared_ptr<LightManager> lightManager;
+  std::shared_ptr<CameraManager> cameraManager;
+  std::shared_ptr<ModelManager> modelManager;
+  std::shared_ptr<CollisionManager> collisionManager;
+  std::shared_ptr<AttachmentManager> attachmentManager;
+  std::shared_ptr<ProjectileManager> projectileManager;
+  std::shared_ptr<ControlManager> controlManager;
+
+  // The world the thread is simulating, or null while it uses the default world.
+  inline static thread_local World *currentWorld = nullptr;
+
+  /**
+   * Create the given manager of the world, or take the singleton manager for the default world, and have its getInstance
+   *   give it on this thread from now on.
+   *
+   * @param manager  The pointer to create the manager in.
+   * @param owned    Whether the world owns the manager, rather than taking the singleton manager.
+   */
+  template <typename Manager>
+  static void createManager(std::shared_ptr<Manager> &manager, const bool &owned)
+  {
+    if (owned)
+    {
+      manager.reset(new Manager());
+    }
+    else
+    {
+      // The singleton manager outlives the world, so the world doesn't delete it.
+      manager.reset(&Manager::getSingleton(), [](Manager *) {});
+    }
+    Manager::worldInstance = manager.get();
+  }
+
+  /**
+   * Make the given world the one the thread is simulating, so the getInstance of the managers give its managers, or give
+   *   the singletons of the default world again if there's no world.
+   *
+   * @param world  The world, or null for the default world.
+   */
+  static void setCurrentWorld(World *const world)
+  {
+    currentWorld = world;
+    EventBus::worldInstance = world != nullptr ? world->eventBus.get() : nullptr;
+    TransformManager::worldInstance = world != nullptr ? world->transformManager.get() : nullptr;
+    LightManager::worldInstance = world != nullptr ? world->lightManager.get() : nullptr;
+    CameraManager::worldInstance = world != nullptr ? world->cameraManager.get() : nullptr;
+    ModelManager::worldInstance = world != nullptr ? world->modelManager.get() : nullptr;
+    CollisionManager::worldInstance = world != nullptr ? world->collisionManager.get() : nullptr;
+    AttachmentManager::worldInstance = world != nullptr ? world->attachmentManager.get() : nullptr;
+    ProjectileManager::worldInstance = world != nullptr ? world->projectileManager.get() : nullptr;
+    ControlManager::worldInstance = world != nullptr ? world->controlManager.get() : nullptr;
+  }
+
+  /**
+   * Create a world, with managers of its own or with the singleton managers.
+   *
+   * @param owned  Whether the world has managers of its own, rather than the singleton managers of the default world.
+   */
+  World(const bool &owned)
+  {
+    // Create the managers with the world entered, so each of them finds the managers of the world created before it.
+    const auto previousWorld = currentWorld;
+    setCurrentWorld(this);
+    createManager(eventBus, owned);
+    createManager(transformManager, owned);
+    createManager(lightManager, owned);
+    createManager(cameraManager, owned);
+    createManager(modelManager, owned);
+    createManager(collisionManager, owned);
+    createManager(attachmentManager, owned);
+    createManager(projectileManager, owned);
+    createManager(controlManager, owned);
+    setCurrentWorld(previousWorld);
+  }
+
+  // The world scopes enter and leave the worlds.
+  friend class WorldScope;
+
+public:
+  /**
+   * Create a world with managers of its own.
+   */
+  World()
+      : World(true) {}
+
+  // Preventing copying the world, since the models in it hold on to its managers.
+  World(const World &) = delete;
+
+  ~World()
+  {
+    // Destroy the managers in the reverse order of creating them, so the models go while the managers they hold on to
+    //   are still there.
+    const auto previousWorld = currentWorld;
+    setCurrentWorld(this);
+    controlManager.reset();
+    projectileManager.reset();
+    attachmentManager.reset();
+    collisionManager.reset();
+    modelManager.reset();
+    cameraManager.reset();
+    lightManager.reset();
+    transformManager.reset();
+    eventBus.reset();
+    setCurrentWorld(previousWorld == this ? nullptr : previousWorld);
+  }
+
+  /**
+   * Returns the default world, whose managers are the singleton ones the game played in the window uses.
+   *
+   * @return The default world.
+   */
+  static World &getDefault()
+  {
+    // Singleton instance of the default world, constructed the first time it's asked for.
+    static World instance(false);
+    return instance;
+  }
+
+  /**
+   * Returns the world the thread is simulating, or the default world if it hasn't entered one.
+   *
+   * @return The current world.
+   */
+  static World &getCurrent()
+  {
+    return currentWorld != nullptr ? *currentWorld : getDefault();
+  }
+
+  /**
+   * Get the event bus of the world.
+   *
+   * @return The event bus.
+   */
+  EventBus &getEventBus() const
+  {
+    return *eventBus;
+  }
+
+  /**
+   * Get the transform manager of the world.
+   *
+   * @return The transform manager.
+   */
+  TransformManager &getTransformManager() const
+  {
+    return *transformManager;
+  }
+
+  /**
+   * Get the light manager of the world.
+   *
+   * @return The light manager.
+   */
+  LightManager &getLightManager() const
+  {
+    return *lightManager;
+  }
+
+  /**
+   * Get the camera manager of the world.
+   *
+   * @return The camera manager.
+   */
+  CameraManager &getCameraManager() const
+  {
+    return *cameraManager;
+  }
+
+  /**
+   * Get the model manager of the world.
+   *
+   * @return The model manager.
+   */
+  ModelManager &getModelManager() const
+  {
+    return *modelManager;
+  }
+
+  /**
+   * Get the collision manager of the world.
+   *
+   * @return The collision manager.
+   */
+  CollisionManager &getCollisionManager() const
+  {
+    return *collisionManager;
+  }
+
+  /**
+   * Get the attachment manager of the world.
+   *
+   * @return The attachment manager.
+   */
+  AttachmentManager &getAttachmentManager() const
+  {
+    return *attachmentManager;
+  }
+
+  /**
+   * Get the projectile manager of the world.
+   *
+   * @return The projectile manager.
+   */
+  ProjectileManager &getProjectileManager() const
+  {
+    return *projectileManager;
+  }
+
+  /**
+   * Get the control manager of the world.
+   *
+   * @return The control manager.
+   */
+  ControlManager &getControlManager() const
+  {
+    return *controlManager;
+  }
+};
+
+/**
+ * Class for entering a world on the calling thread for as long as the scope lives, going back to the world entered
+ *   before once it ends, so the scopes can be nested.
+ */
+class WorldScope
+{
+private:
+  // The world the thread was simulating before the scope.
+  World *const previousWorld;
+
+public:
+  WorldScope(World &world)
+      : previousWorld(World::currentWorld)
+  {
+    World::setCurrentWorld(&world);
+  }
+
+  // Preventing copying the world scope, since it leaves the world when it ends.
+  WorldScope(const WorldScope &) = delete;
+
+  ~WorldScope()
+  {
+    World::setCurrentWorld(previousWorld);
+  }
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "light_base.cpp"
+#include "../include/window.cpp"
 
 /**
  * Class that represents a cone light.
@@ -20,14 +21,37 @@ private:
   float_t verticalAngle;
 
   /**
-   * Create the view matrices for the cone light.
+   * Check if the vertex shader of the cone lights writes into the layers of the shadow atlas by itself, with multiview or
+   * with the layer selected per instance, without a geometry shader.
    * 
-   * @param horizontalAngle  The horizontal angle of the light.
-   * @param verticalAngle  The vertical angle of the light.
+   * @return Whether the vertex shader selects the layer.
+   */
+  static bool isLayerSelectedByVertexShader()
+  {
+    return WindowManager::getInstance().isMultiviewSupported() || WindowManager::getInstance().isVertexShaderLayerSupported();
+  }
+
+  /**
+   * Get the vertex shader the shadow maps of the cone lights are rendered with, for what the driver supports.
+   * 
+   * @return The file path to the vertex shader.
+   */
+  static std::string getVertexShaderFilePath()
+  {
+    if (WindowManager::getInstance().isMultiviewSupported())
+    {
+      return "assets/shaders/vertex/cone_light_multiview.glsl";
+    }
+    return WindowManager::getInstance().isVertexShaderLayerSupported() ? "assets/shaders/vertex/cone_light_layered.glsl" : "assets/shaders/vertex/light_base.glsl";
+  }
+
+protected:
+  /**
+   * Create the view matrix for the single face of the cone light, pointing along its angles.
    * 
-   * @return The list of view matrices for the cone light.
+   * @param newViewMatrices  The array to store the view matrix of the face in.
    */
-  std::vector<glm::mat4> createViewMatrices(const float_t &horizontalAngle, const float_t &verticalAngle)
+  void createViewMatrices(std::array<glm::mat4, MAX_FACES_COUNT> &newViewMatrices) const override
   {
     // Calculate the direction of the light.
     const auto direction = glm::vec3(
@@ -45,23 +69,10 @@ private:
     const auto up = glm::cross(right, direction);
 
     // Get the position of the light.
-    const auto position = getLightPosition();
+    const auto &position = getLightPosition();
 
-    // Calculate and return the view matrices of the light.
-    return std::vector<glm::mat4>({glm::lookAt(position, position + direction, up)});
-  }
-
-  /**
-   * Create the projection matrices for the cone light.
-   * 
-   * @param nearPlane  The closest distance the light can project from.
-   * @param farPlane   The farthest distance the light can project till.
-   * 
-   * @return The list of projection matrices for the cone light.
-   */
-  std::vector<glm::mat4> createProjectionMatrices(const float_t &nearPlane, const float_t &farPlane)
-  {
-    return std::vector<glm::mat4>({glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane)});
+    // Calculate the view matrix of the light.
+    newViewMatrices[0] = glm::lookAt(position, position + direction, up);
   }
 
 public:
@@ -70,47 +81,26 @@ public:
             lightId,
             "Cone",
             glm::vec3(1.0f), 100.0f,
-            "assets/shaders/vertex/light_base.glsl", "assets/shaders/geometry/cone_light.glsl", "assets/shaders/fragment/cone_light.glsl",
+            // Render every layer of the shadow atlas in a single pass with multiview, and otherwise draw each model once
+            // per light with the vertex shader selecting the layer, since fanning triangles out in a geometry shader is
+            // slow on most GPUs. The geometry shader is only left for drivers with neither.
+            getVertexShaderFilePath(), isLayerSelectedByVertexShader() ? "" : "assets/shaders/geometry/cone_light.glsl", "assets/shaders/fragment/cone_light.glsl",
             glm::vec3(0.0f),
             0.1f, 100.0f,
-            createViewMatrices(0.0f, 0.0f), createProjectionMatrices(0.1f, 100.0f),
+            1,
             ShadowBufferType::CONE),
         horizontalAngle(0.0f),
         verticalAngle(0.0f) {}
 
   virtual ~ConeLight() {}
 
-  void setLightPosition(const glm::vec3 &newPosition) override
-  {
-    // Update the light position.
-    LightBase::setLightPosition(newPosition);
-    // Update the view matrices.
-    setViewMatrices(createViewMatrices(horizontalAngle, verticalAngle));
-  }
-
   void setLightAngles(const float_t &newHorizontalAngle, const float_t &newVerticalAngle)
   {
     // Update the light angles.
     horizontalAngle = newHorizontalAngle;
     verticalAngle = newVerticalAngle;
-    // Update the view matrices.
-    setViewMatrices(createViewMatrices(newHorizontalAngle, newVerticalAngle));
-  }
-
-  void setLightNearPlane(const float_t &newNearPlane) override
-  {
-    // Update the light near plane.
-    LightBase::setLightNearPlane(newNearPlane);
-    // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(newNearPlane, getLightFarPlane()));
-  }
-
-  void setLightFarPlane(const float_t &newFarPlane) override
-  {
-    // Update the light far plane.
-    LightBase::setLightFarPlane(newFarPlane);
-    // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), newFarPlane));
+    // Mark the view matrix as stale.
+    markViewMatricesDirty();
   }
 
   /**
@@ -0,0 +1,235 @@
+#ifndef LIGHT_DIRECTIONAL_LIGHT_CPP
+#define LIGHT_DIRECTIONAL_LIGHT_CPP
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <string>
+#include <limits>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "light_base.cpp"
+#include "../camera/camera_base.cpp"
+
+/**
+ * Class that represents a directional light, which shines the same way everywhere in the scene, like the sun. Its shadow
+ *   map is split into cascades, each a face of the light covering a slice of the view frustum of the camera further out
+ *   than the one before, so the shadows close to the camera get as much of the shadow map as the ones far away.
+ */
+class DirectionalLight : public LightBase
+{
+private:
+  float_t horizontalAngle;
+  float_t verticalAngle;
+
+  // The view and orthographic projection matrices of the cascades, as last fitted to the camera.
+  std::array<glm::mat4, MAX_FACES_COUNT> cascadeViewMatrices;
+  std::array<glm::mat4, MAX_FACES_COUNT> cascadeProjectionMatrices;
+  // The distances from the camera the cascades reach till, as last fitted to the camera.
+  std::array<float_t, MAX_FACES_COUNT> cascadeSplits;
+
+  /**
+   * Get the distance from the camera the given cascade reaches till, mixing splits spread evenly between the near plane and
+   *   the shadow distance with splits spread logarithmically, which give the cascades close to the camera more detail.
+   *
+   * @param cascadeIndex    The index of the cascade.
+   * @param nearDistance    The distance of the near plane of the camera.
+   * @param shadowDistance  The distance the last cascade reaches till.
+   *
+   * @return The split distance of the cascade.
+   */
+  static float_t getCascadeSplit(const uint32_t &cascadeIndex, const float_t &nearDistance, const float_t &shadowDistance)
+  {
+    const auto ratio = float_t(cascadeIndex + 1) / SHADOW_CASCADES_COUNT;
+    const auto logSplit = nearDistance * std::pow(shadowDistance / nearDistance, ratio);
+    const auto uniformSplit = nearDistance + (shadowDistance - nearDistance) * ratio;
+    return SHADOW_CASCADE_SPLIT_LAMBDA * logSplit + (1.0f - SHADOW_CASCADE_SPLIT_LAMBDA) * uniformSplit;
+  }
+
+protected:
+  /**
+   * Create the view matrices of the cascades of the directional light, as last fitted to the camera.
+   *
+   * @param newViewMatrices  The array to store the view matrices of the cascades in.
+   */
+  void createViewMatrices(std::array<glm::mat4, MAX_FACES_COUNT> &newViewMatrices) const override
+  {
+    newViewMatrices = cascadeViewMatrices;
+  }
+
+  /**
+   * Get the orthographic projection matrix of a cascade of the directional light, as last fitted to the camera.
+   *
+   * @param faceIndex  The index of the cascade.
+   *
+   * @return The projection matrix of the cascade.
+   */
+  const glm::mat4 &getFaceProjectionMatrix(const uint32_t &faceIndex) const override
+  {
+    return cascadeProjectionMatrices[faceIndex];
+  }
+
+public:
+  DirectionalLight(const std::string &lightId)
+      : LightBase(
+            lightId,
+            "Directional",
+            glm::vec3(1.0f), 1.0f,
+            // The cascades are flat shadow maps like the one of a cone light, so they're rendered with the same shaders.
+            "assets/shaders/vertex/light_base.glsl", "assets/shaders/geometry/cone_light.glsl", "assets/shaders/fragment/cone_light.glsl",
+            glm::vec3(0.0f),
+            0.1f, 100.0f,
+            SHADOW_CASCADES_COUNT,
+            ShadowBufferType::DIRECTIONAL),
+        horizontalAngle(0.0f),
+        verticalAngle(-glm::pi<float_t>() / 2.0f),
+        cascadeViewMatrices(),
+        cascadeProjectionMatrices(),
+        cascadeSplits() {}
+
+  virtual ~DirectionalLight() {}
+
+  /**
+   * Get the direction the light shines in.
+   *
+   * @return The light direction.
+   */
+  glm::vec3 getLightDirection() const
+  {
+    return glm::vec3(
+        cos(verticalAngle) * sin(horizontalAngle),
+        sin(verticalAngle),
+        cos(verticalAngle) * cos(horizontalAngle));
+  }
+
+  /**
+   * Get the distances from the camera the cascades reach till, as last fitted to the camera. Only the first faces count of
+   *   them are used.
+   *
+   * @return The cascade split distances.
+   */
+  const std::array<float_t, MAX_FACES_COUNT> &getCascadeSplits() const
+  {
+    return cascadeSplits;
+  }
+
+  /**
+   * A directional light reaches every model in the scene, however far away it is.
+   *
+   * @return The light influence radius.
+   */
+  float_t getInfluenceRadius() const override
+  {
+    return std::numeric_limits<float_t>::infinity();
+  }
+
+  void setLightAngles(const float_t &newHorizontalAngle, const float_t &newVerticalAngle)
+  {
+    // Update the light angles.
+    horizontalAngle = newHorizontalAngle;
+    verticalAngle = newVerticalAngle;
+    // Mark the view matrices as stale.
+    markViewMatricesDirty();
+  }
+
+  /**
+   * Fit the cascades of the light to the slices of the view frustum of the camera, up to the far plane of the light. Each
+   *   cascade is a box around the sphere around its slice, which keeps its size however the camera turns, and it only moves
+   *   in steps of whole texels of its shadow map, so the edges of the shadows don't shimmer as the camera moves.
+   *
+   * @param camera  The camera the scene is rendered from.
+   */
+  void fitToCamera(const CameraBase &camera) override
+  {
+    // Get the corners of the near and far planes of the camera in world-space, along with their distances from the camera.
+    const auto &inverseViewProjectionMatrix = camera.getInverseViewProjectionMatrix();
+    std::array<glm::vec3, 8> frustumCorners;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+      const auto corner = inverseViewProjectionMatrix * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+      frustumCorners[i] = glm::vec3(corner) / corner.w;
+    }
+    const auto &viewMatrix = camera.getViewMatrix();
+    const auto nearDistance = std::max(-(viewMatrix * glm::vec4(frustumCorners[0], 1.0f)).z, 0.001f);
+    const auto farDistance = std::max(-(viewMatrix * glm::vec4(frustumCorners[4], 1.0f)).z, nearDistance + 0.001f);
+    const auto shadowDistance = std::min(farDistance, getLightFarPlane());
+
+    // Pick an up vector for the light that isn't along its direction.
+    const auto direction = getLightDirection();
+    const auto up = std::abs(direction.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+    const auto lightViewMatrix = glm::lookAt(glm::vec3(0.0f), direction, up);
+    const auto shadowMapSize = castsShadows() ? float_t(getShadowBufferDetails()->getShadowBufferTile().size) : float_t(DIRECTIONAL_SHADOW_ATLAS_SIZE);
+
+    std::array<glm::mat4, MAX_FACES_COUNT> newViewMatrices = cascadeViewMatrices;
+    std::array<glm::mat4, MAX_FACES_COUNT> newProjectionMatrices = cascadeProjectionMatrices;
+    glm::vec3 firstCascadeCenter(0.0f);
+    auto sliceStart = nearDistance;
+    for (uint32_t i = 0; i < SHADOW_CASCADES_COUNT; i++)
+    {
+      const auto sliceEnd = getCascadeSplit(i, nearDistance, shadowDistance);
+      cascadeSplits[i] = sliceEnd;
+
+      // Get the corners of the slice along the edges of the frustum, and the sphere around them.
+      std::array<glm::vec3, 8> sliceCorners;
+      glm::vec3 sliceCenter(0.0f);
+      for (uint32_t j = 0; j < 4; j++)
+      {
+        const auto edgeStart = frustumCorners[j], edgeEnd = frustumCorners[j + 4];
+        sliceCorners[j] = glm::mix(edgeStart, edgeEnd, (sliceStart - nearDistance) / (farDistance - nearDistance));
+        sliceCorners[j + 4] = glm::mix(edgeStart, edgeEnd, (sliceEnd - nearDistance) / (farDistance - nearDistance));
+        sliceCenter += sliceCorners[j] + sliceCorners[j + 4];
+      }
+      sliceCenter /= 8.0f;
+      auto radius = 0.0f;
+      for (const auto &sliceCorner : sliceCorners)
+      {
+        radius = std::max(radius, glm::distance(sliceCenter, sliceCorner));
+      }
+      // Round the radius up, so the size of the cascade doesn't change with tiny changes to the slice.
+      radius = std::ceil(radius * 16.0f) / 16.0f;
+
+      // Move the center of the cascade in steps of whole texels across the face of the light.
+      const auto texelSize = 2.0f * radius / shadowMapSize;
+      auto lightSpaceCenter = lightViewMatrix * glm::vec4(sliceCenter, 1.0f);
+      lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+      lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+      const auto cascadeCenter = glm::vec3(glm::inverse(lightViewMatrix) * lightSpaceCenter);
+      if (i == 0)
+      {
+        firstCascadeCenter = cascadeCenter;
+      }
+
+      // Look at the center of the cascade from far enough back to catch the models casting shadows into the slice.
+      const auto eyeDistance = radius + SHADOW_CASCADE_CASTER_DISTANCE;
+      newViewMatrices[i] = glm::lookAt(cascadeCenter - direction * eyeDistance, cascadeCenter, up);
+      newProjectionMatrices[i] = glm::ortho(-radius, radius, -radius, radius, 0.0f, eyeDistance + radius);
+      sliceStart = sliceEnd;
+    }
+
+    // Keep the cascades as they are if they haven't moved, so their shadow maps aren't rendered again.
+    if (newViewMatrices == cascadeViewMatrices && newProjectionMatrices == cascadeProjectionMatrices)
+    {
+      return;
+    }
+    cascadeViewMatrices = newViewMatrices;
+    cascadeProjectionMatrices = newProjectionMatrices;
+    // Keep the position of the light at the center of the first cascade, which is where the light matters most, and mark
+    //   the view matrices and the shadow map of the light as stale.
+    setLightPosition(firstCascadeCenter);
+  }
+
+  /**
+   * Creates a new instance of the directional light.
+   *
+   * @param lightId  The ID of the light.
+   */
+  const static std::shared_ptr<DirectionalLight> create(const std::string &lightId)
+  {
+    return std::make_shared<DirectionalLight>(lightId);
+  }
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef LIGHT_GLOW_LIGHT_CPP
+#define LIGHT_GLOW_LIGHT_CPP
+
+#include <vector>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "light_base.cpp"
+
+/**
+ * Class that represents a glow light, which spreads like a point light but has no shadow map, so it's only lit through
+ *   the light clusters and never costs a shadow pass. Good for small lights like the glow of a projectile.
+ */
+class GlowLight : public LightBase
+{
+protected:
+  /**
+   * Glow lights have no faces, so there are no view matrices to create.
+   * 
+   * @param newViewMatrices  The array to store the view matrices of the faces in.
+   */
+  void createViewMatrices(std::array<glm::mat4, MAX_FACES_COUNT> &) const override {}
+
+public:
+  GlowLight(const std::string &lightId)
+      : LightBase(
+            lightId,
+            "Glow",
+            glm::vec3(1.0f), 100.0f,
+            "", "",
+            glm::vec3(0.0f),
+            1.1f, 100.0f,
+            0,
+            ShadowBufferType::POINT,
+            false) {}
+
+  virtual ~GlowLight() {}
+
+  /**
+   * Creates a new instance of the glow light.
+   * 
+   * @param lightId  The ID of the light.
+   */
+  const static std::shared_ptr<GlowLight> create(const std::string &lightId)
+  {
+    return std::make_shared<GlowLight>(lightId);
+  }
+};
+
+#endif
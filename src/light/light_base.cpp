@@ -3,18 +3,29 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
 #include <string>
+#include <limits>
+#include <algorithm>
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 #include "../include/shader.cpp"
 #include "../include/shadowbuffer.cpp"
+#include "../include/slot_map.cpp"
+#include "../include/frame_time.cpp"
+#include "../include/frustum.cpp"
+#include "../camera/camera_base.cpp"
 
 /**
  * Base class for creating lights.
  */
 class LightBase
 {
+public:
+  // The most faces a light can have, one for each side of a cube.
+  static const uint32_t MAX_FACES_COUNT = 6;
 
 private:
   // The shader manager responsible for creating shader programs.
@@ -22,8 +33,10 @@ private:
   // The shadow buffer manager responsible for creating shadow buffers for lights.
   ShadowBufferManager &shadowBufferManager;
 
-  // The ID of the light.
+  // The ID of the light, kept for debugging.
   const std::string lightId;
+  // The handle of the light in the light manager, which is invalid while the light isn't registered.
+  SlotHandle lightHandle;
   // The name of the light.
   const std::string lightName;
 
@@ -39,14 +52,93 @@ private:
   // The farthest distance the light can capture till.
   float_t farPlane;
 
-  // The list of view matrices of the light.
-  std::vector<glm::mat4> viewMatrices;
-  // The list of projection matrices of the light.
-  std::vector<glm::mat4> projectionMatrices;
-  // The shader program details of the light.
+  // The number of faces of the light, each looking out from the light in its own direction.
+  const uint32_t facesCount;
+  // The view matrices of the faces of the light, the projection matrix shared by all the faces, and the projection-view
+  //   matrices of the faces. They're only rebuilt when they're asked for after the light moved or its planes changed, so
+  //   lights moving every frame without casting shadows never build them.
+  std::array<glm::mat4, MAX_FACES_COUNT> viewMatrices;
+  glm::mat4 projectionMatrix;
+  std::array<glm::mat4, MAX_FACES_COUNT> viewProjectionMatrices;
+  bool areViewMatricesDirty;
+  bool isProjectionMatrixDirty;
+  // The type of the shadow map of the light, which also decides how the light spreads.
+  const ShadowBufferType lightType;
+  // The shader program details of the light, which is empty if the light doesn't cast shadows.
   const std::shared_ptr<const ShaderDetails> shaderDetails;
-  // The shadow buffer details of the light.
+  // The shadow buffer details of the light, which is empty if the light doesn't cast shadows.
   const std::shared_ptr<const ShadowBufferDetails> shadowBufferDetails;
+  // Whether the shadow map faces are rendered by drawing each model instance once per light face, with the vertex shader
+  // selecting the layer, instead of fanning each triangle out to the faces in a geometry shader.
+  const bool instancedFaces;
+  // The number of times the details of the light affecting its shadow map have changed, used to detect when the cached
+  // shadow map is stale.
+  uint64_t changeGeneration;
+  // The largest size of the shadow map of the light, as a fraction of the size of a shadow atlas layer.
+  float_t shadowMapScale;
+  // The most faces of the shadow map rendered again in a frame while it's stale, and the number of frames each stale
+  //   face has waited to be rendered again.
+  uint32_t facesPerUpdate;
+  std::array<uint32_t, MAX_FACES_COUNT> faceStaleFrames;
+
+  /**
+   * Create the shader program of the light, leaving out the geometry shader if no file path is given for it.
+   * 
+   * @param shaderManager           The shader manager to create the shader program with.
+   * @param lightName               The name of the light.
+   * @param vertexShaderFilePath    The file path to the vertex shader source code.
+   * @param geometryShaderFilePath  The file path to the geometry shader source code, or an empty string for none.
+   * @param fragmentShaderFilePath  The file path to the fragment shader source code.
+   * 
+   * @return The details of the shader program.
+   */
+  static const std::shared_ptr<const ShaderDetails> &createShaderProgram(ShaderManager &shaderManager, const std::string &lightName, const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath)
+  {
+    if (geometryShaderFilePath.empty())
+    {
+      return shaderManager.createShaderProgram(lightName + "::Shader", vertexShaderFilePath, fragmentShaderFilePath);
+    }
+    return shaderManager.createShaderProgram(lightName + "::Shader", vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath);
+  }
+
+  /**
+   * Rebuild the matrices of the faces of the light that are stale.
+   */
+  void updateMatrices()
+  {
+    if (!areViewMatricesDirty && !isProjectionMatrixDirty)
+    {
+      return;
+    }
+    if (isProjectionMatrixDirty)
+    {
+      projectionMatrix = createProjectionMatrix();
+    }
+    if (areViewMatricesDirty)
+    {
+      createViewMatrices(viewMatrices);
+    }
+    for (uint32_t i = 0; i < facesCount; i++)
+    {
+      viewProjectionMatrices[i] = getFaceProjectionMatrix(i) * viewMatrices[i];
+    }
+    areViewMatricesDirty = false;
+    isProjectionMatrixDirty = false;
+  }
+
+  /**
+   * Check if the camera can see into the volume a face of the light captures, by testing the frustum of the face against
+   * the frustum of the camera.
+   * 
+   * @param faceIndex      The index of the face.
+   * @param cameraFrustum  The frustum of the camera.
+   * 
+   * @return Whether the camera might see into the face.
+   */
+  bool isFaceVisible(const uint32_t &faceIndex, const Frustum &cameraFrustum) const
+  {
+    return cameraFrustum.intersectsFrustum(Frustum(viewProjectionMatrices[faceIndex]));
+  }
 
 protected:
   LightBase(
@@ -56,21 +148,33 @@ protected:
       const std::string &vertexShaderFilePath, const std::string &fragmentShaderFilePath,
       const glm::vec3 &position,
       const float_t &nearPlane, const float_t &farPlane,
-      const std::vector<glm::mat4> &viewMatrices, const std::vector<glm::mat4> &projectionMatrices,
-      const ShadowBufferType &shadowBufferType)
+      const uint32_t &facesCount,
+      const ShadowBufferType &shadowBufferType,
+      const bool &castsShadows = true)
       : shaderManager(ShaderManager::getInstance()),
         shadowBufferManager(ShadowBufferManager::getInstance()),
         lightId(lightId),
+        lightHandle({0, 0}),
         lightName(lightName),
         lightColor(lightColor),
         lightIntensity(lightIntensity),
         position(position),
         nearPlane(nearPlane),
         farPlane(farPlane),
-        viewMatrices(viewMatrices),
-        projectionMatrices(projectionMatrices),
-        shaderDetails(shaderManager.createShaderProgram(lightName + "::Shader", vertexShaderFilePath, fragmentShaderFilePath)),
-        shadowBufferDetails(shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType))
+        facesCount(facesCount),
+        viewMatrices(),
+        projectionMatrix(1.0f),
+        viewProjectionMatrices(),
+        areViewMatricesDirty(true),
+        isProjectionMatrixDirty(true),
+        lightType(shadowBufferType),
+        shaderDetails(castsShadows ? shaderManager.createShaderProgram(lightName + "::Shader", vertexShaderFilePath, fragmentShaderFilePath) : std::shared_ptr<const ShaderDetails>()),
+        shadowBufferDetails(castsShadows ? shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType) : std::shared_ptr<const ShadowBufferDetails>()),
+        instancedFaces(true),
+        changeGeneration(0),
+        shadowMapScale(1.0f),
+        facesPerUpdate(facesCount),
+        faceStaleFrames()
   {
   }
 
@@ -81,30 +185,90 @@ protected:
       const std::string &vertexShaderFilePath, const std::string &geometryShaderFilePath, const std::string &fragmentShaderFilePath,
       const glm::vec3 &position,
       const float_t &nearPlane, const float_t &farPlane,
-      const std::vector<glm::mat4> &viewMatrices, const std::vector<glm::mat4> &projectionMatrices,
-      const ShadowBufferType &shadowBufferType)
+      const uint32_t &facesCount,
+      const ShadowBufferType &shadowBufferType,
+      const bool &castsShadows = true)
       : shaderManager(ShaderManager::getInstance()),
         shadowBufferManager(ShadowBufferManager::getInstance()),
         lightId(lightId),
+        lightHandle({0, 0}),
         lightName(lightName),
         lightColor(lightColor),
         lightIntensity(lightIntensity),
         position(position),
         nearPlane(nearPlane),
         farPlane(farPlane),
-        viewMatrices(viewMatrices),
-        projectionMatrices(projectionMatrices),
-        shaderDetails(shaderManager.createShaderProgram(lightName + "::Shader", vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath)),
-        shadowBufferDetails(shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType))
+        facesCount(facesCount),
+        viewMatrices(),
+        projectionMatrix(1.0f),
+        viewProjectionMatrices(),
+        areViewMatricesDirty(true),
+        isProjectionMatrixDirty(true),
+        lightType(shadowBufferType),
+        shaderDetails(castsShadows ? createShaderProgram(shaderManager, lightName, vertexShaderFilePath, geometryShaderFilePath, fragmentShaderFilePath) : std::shared_ptr<const ShaderDetails>()),
+        shadowBufferDetails(castsShadows ? shadowBufferManager.createShadowBuffer(lightId + "::ShadowMap", shadowBufferType) : std::shared_ptr<const ShadowBufferDetails>()),
+        instancedFaces(geometryShaderFilePath.empty()),
+        changeGeneration(0),
+        shadowMapScale(1.0f),
+        facesPerUpdate(facesCount),
+        faceStaleFrames()
+  {
+  }
+
+  /**
+   * Create the view matrices of the faces of the light, from where the light is and which way it points.
+   * 
+   * @param newViewMatrices  The array to store the view matrices of the faces in.
+   */
+  virtual void createViewMatrices(std::array<glm::mat4, MAX_FACES_COUNT> &newViewMatrices) const = 0;
+
+  /**
+   * Create the projection matrix shared by the faces of the light, from its planes.
+   * 
+   * @return The projection matrix of the faces.
+   */
+  virtual glm::mat4 createProjectionMatrix() const
   {
+    return glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+  }
+
+  /**
+   * Get the projection matrix of a face of the light, which is the perspective projection shared by all the faces unless
+   *   the light gives each face its own.
+   * 
+   * @param faceIndex  The index of the face.
+   * 
+   * @return The projection matrix of the face.
+   */
+  virtual const glm::mat4 &getFaceProjectionMatrix(const uint32_t &) const
+  {
+    return projectionMatrix;
+  }
+
+  /**
+   * Mark the view matrices of the light as stale, for when which way the light points changes.
+   */
+  void markViewMatricesDirty()
+  {
+    areViewMatricesDirty = true;
+    // Mark the shadow map of the light as stale.
+    changeGeneration++;
   }
 
   virtual ~LightBase()
   {
-    // Destroy the shader program for the light.
-    shaderManager.destroyShaderProgram(shaderDetails);
-    // Destroy the shadow buffer for the light.
-    shadowBufferManager.destroyShadowBuffer(shadowBufferDetails);
+    // Lights that don't cast shadows have no shader program or shadow buffer to destroy, while the lights that were left
+    // without a shadow buffer by a full shadow atlas still have their shader program.
+    if (shaderDetails != nullptr)
+    {
+      // Destroy the shader program for the light.
+      shaderManager.destroyShaderProgram(shaderDetails);
+    }
+    if (castsShadows())
+    {
+      // Destroy the shadow buffer for the light.
+      shadowBufferManager.destroyShadowBuffer(shadowBufferDetails);
+    }
   }
 
 public:
@@ -118,6 +282,26 @@ public:
     return lightId;
   }
 
+  /**
+   * Get the handle of the light in the light manager.
+   * 
+   * @return The light handle.
+   */
+  const SlotHandle &getLightHandle() const
+  {
+    return lightHandle;
+  }
+
+  /**
+   * Set the handle of the light in the light manager, done by the light manager when the light is registered.
+   * 
+   * @param newLightHandle  The light handle.
+   */
+  void setLightHandle(const SlotHandle &newLightHandle)
+  {
+    lightHandle = newLightHandle;
+  }
+
   /**
    * Get the name of the light.
    * 
@@ -178,6 +362,40 @@ public:
     return farPlane;
   }
 
+  /**
+   * Get the radius around the light it can light models within. Since light falls off with the square of the distance, a
+   * light stops reaching once its attenuation drops below the cutoff, and it never reaches past its far plane.
+   * 
+   * @return The light influence radius.
+   */
+  virtual float_t getInfluenceRadius() const
+  {
+    const auto lightColorIntensity = lightColor * lightIntensity;
+    const auto brightestChannel = std::max(lightColorIntensity.r, std::max(lightColorIntensity.g, lightColorIntensity.b));
+    return std::min(farPlane, std::sqrt(brightestChannel / CLUSTERED_LIGHT_ATTENUATION_CUTOFF));
+  }
+
+  /**
+   * Get the type of the light, which is the same as the type of its shadow map even when it doesn't cast shadows.
+   * 
+   * @return The light type.
+   */
+  const ShadowBufferType &getLightType() const
+  {
+    return lightType;
+  }
+
+  /**
+   * Check if the light casts shadows. Lights that don't cast shadows have no shader program or shadow buffer, and
+   * only light the scene through the light clusters.
+   * 
+   * @return Whether the light casts shadows.
+   */
+  bool castsShadows() const
+  {
+    return shadowBufferDetails != nullptr;
+  }
+
   /**
    * Get the shader program details of the light.
    * 
@@ -188,6 +406,99 @@ public:
     return shaderDetails;
   }
 
+  /**
+   * Check if the shadow map faces of the light are rendered by drawing each model instance once per light face, instead
+   * of with a geometry shader.
+   * 
+   * @return Whether the light uses instanced faces.
+   */
+  bool hasInstancedFaces() const
+  {
+    return instancedFaces;
+  }
+
+  /**
+   * Get the change generation of the light, which increases every time a detail of the light affecting its shadow map changes.
+   * 
+   * @return The light change generation.
+   */
+  const uint64_t &getChangeGeneration() const
+  {
+    return changeGeneration;
+  }
+
+  /**
+   * Get the largest size of the shadow map of the light, as a fraction of the size of a shadow atlas layer. The shadow map
+   * can be smaller when the light only covers a small part of the screen.
+   * 
+   * @return The light shadow map scale.
+   */
+  const float_t &getShadowMapScale() const
+  {
+    return shadowMapScale;
+  }
+
+  /**
+   * Get the most faces of the shadow map of the light rendered again in a frame while it's stale.
+   * 
+   * @return The light faces per update.
+   */
+  const uint32_t &getFacesPerUpdate() const
+  {
+    return facesPerUpdate;
+  }
+
+  /**
+   * Pick the stale faces of the shadow map of the light to render again in the frame, up to the faces per update of the
+   * light. The faces the camera can see go first, and the others are picked once they've waited long enough, so every
+   * face is rendered again within a few frames.
+   * 
+   * @param staleFacesMask  The mask of the stale faces, with a bit for each face.
+   * @param cameraFrustum   The frustum of the camera the scene is rendered from.
+   * 
+   * @return The mask of the faces to render again.
+   */
+  GLuint selectUpdatedFaces(const GLuint &staleFacesMask, const Frustum &cameraFrustum)
+  {
+    if (facesPerUpdate >= facesCount)
+    {
+      return staleFacesMask;
+    }
+    updateMatrices();
+
+    // Score the stale faces by the frames they've waited, with the faces in view of the camera ahead by a full round.
+    std::array<std::pair<uint32_t, uint32_t>, MAX_FACES_COUNT> faceScores;
+    uint32_t staleFacesCount = 0;
+    for (uint32_t i = 0; i < facesCount; i++)
+    {
+      if ((staleFacesMask & (1u << i)) == 0)
+      {
+        faceStaleFrames[i] = 0;
+        continue;
+      }
+      faceScores[staleFacesCount++] = {faceStaleFrames[i] + (isFaceVisible(i, cameraFrustum) ? MAX_FACES_COUNT : 0), i};
+    }
+    std::stable_sort(faceScores.begin(), faceScores.begin() + staleFacesCount, [](const auto &a, const auto &b) {
+      return a.first > b.first;
+    });
+
+    GLuint updatedFacesMask = 0;
+    for (uint32_t i = 0; i < staleFacesCount; i++)
+    {
+      const auto &faceIndex = faceScores[i].second;
+      if (i < facesPerUpdate)
+      {
+        updatedFacesMask |= 1u << faceIndex;
+        faceStaleFrames[faceIndex] = 0;
+      }
+      else
+      {
+        faceStaleFrames[faceIndex]++;
+      }
+    }
+    return updatedFacesMask;
+  }
+
   /**
    * Get the shadow buffer of the light.
    * 
@@ -199,23 +510,48 @@ public:
   }
 
   /**
-   * Get the view matrices of the light.
+   * Get the number of faces of the light.
+   * 
+   * @return The light faces count.
+   */
+  const uint32_t &getFacesCount() const
+  {
+    return facesCount;
+  }
+
+  /**
+   * Get the view matrices of the faces of the light, rebuilding them first if they're stale. Only the first faces count
+   *   of them are used.
    * 
    * @return The light view matrices.
    */
-  const std::vector<glm::mat4> &getViewMatrices() const
+  const std::array<glm::mat4, MAX_FACES_COUNT> &getViewMatrices()
   {
+    updateMatrices();
     return viewMatrices;
   }
 
   /**
-   * Get the projection matrices of the light.
+   * Get the projection matrix shared by the faces of the light, rebuilding it first if it's stale.
    * 
-   * @return The light projection matrices.
+   * @return The light projection matrix.
    */
-  const std::vector<glm::mat4> &getProjectionMatrices() const
+  const glm::mat4 &getProjectionMatrix()
   {
-    return projectionMatrices;
+    updateMatrices();
+    return projectionMatrix;
+  }
+
+  /**
+   * Get the projection-view matrices of the faces of the light, rebuilding them first if they're stale. Only the first
+   *   faces count of them are used.
+   * 
+   * @return The light projection-view matrices.
+   */
+  const std::array<glm::mat4, MAX_FACES_COUNT> &getViewProjectionMatrices()
+  {
+    updateMatrices();
+    return viewProjectionMatrices;
   }
 
   /**
@@ -226,6 +562,8 @@ public:
   virtual void setLightPosition(const glm::vec3 &newPosition)
   {
     position = newPosition;
+    // Mark the view matrices and the shadow map of the light as stale.
+    markViewMatricesDirty();
   }
 
   /**
@@ -256,6 +594,9 @@ public:
   virtual void setLightNearPlane(const float_t &newNearPlane)
   {
     nearPlane = newNearPlane;
+    // Mark the projection matrix and the shadow map of the light as stale.
+    isProjectionMatrixDirty = true;
+    changeGeneration++;
   }
 
   /**
@@ -266,28 +607,40 @@ public:
   virtual void setLightFarPlane(const float_t &newFarPlane)
   {
     farPlane = newFarPlane;
+    // Mark the projection matrix and the shadow map of the light as stale.
+    isProjectionMatrixDirty = true;
+    changeGeneration++;
   }
 
   /**
-   * Set the view matrices of the light.
+   * Set the largest size of the shadow map of the light, as a fraction of the size of a shadow atlas layer.
    * 
-   * @param newViewMatrices  The light view matrices.
+   * @param newShadowMapScale  The light shadow map scale.
    */
-  virtual void setViewMatrices(const std::vector<glm::mat4> &newViewMatrices)
+  virtual void setShadowMapScale(const float_t &newShadowMapScale)
   {
-    viewMatrices = newViewMatrices;
+    shadowMapScale = newShadowMapScale;
   }
 
   /**
-   * Set the projection matrices of the light.
+   * Set the most faces of the shadow map of the light rendered again in a frame while it's stale, so lights with many
+   * faces can spread rendering their shadow maps over several frames.
    * 
-   * @param newProjectionMatrices  The light projection matrices.
+   * @param newFacesPerUpdate  The light faces per update, which is kept between 1 and the faces count.
    */
-  virtual void setProjectionMatrices(const std::vector<glm::mat4> &newProjectionMatrices)
+  void setFacesPerUpdate(const uint32_t &newFacesPerUpdate)
   {
-    projectionMatrices = newProjectionMatrices;
+    facesPerUpdate = std::max(1u, std::min(newFacesPerUpdate, facesCount));
   }
 
+  /**
+   * Fit the faces of the light to what the given camera sees, for lights whose shadow maps follow the camera instead of
+   *   staying where the light is. Done every frame the shadow map of the light can be rendered, before it's culled.
+   * 
+   * @param camera  The camera the scene is rendered from.
+   */
+  virtual void fitToCamera(const CameraBase &) {}
+
   /**
    * Initialize the light once registered.
    */
@@ -300,8 +653,10 @@ public:
 
   /**
    * Update the light during the update step before starting rendering.
+   * 
+   * @param frameTime  The time of the frame.
    */
-  virtual void update() {}
+  virtual void update(const FrameTime &) {}
 };
 
 #endif
\ No newline at end of file
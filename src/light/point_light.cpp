@@ -9,91 +9,70 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "light_base.cpp"
+#include "../include/window.cpp"
 
 /**
  * Class that represents a point light.
  */
 class PointLight : public LightBase
 {
-private:
+protected:
   /**
-   * Create the view matrices for the point light.
+   * Create the view matrices for the six faces of the point light.
    * 
-   * @return The list of view matrices for the point light.
+   * @param newViewMatrices  The array to store the view matrices of the faces in.
    */
-  std::vector<glm::mat4> createViewMatrices()
+  void createViewMatrices(std::array<glm::mat4, MAX_FACES_COUNT> &newViewMatrices) const override
   {
-    const auto position = getLightPosition();
-    return std::vector<glm::mat4>({glm::lookAt(position, position + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
-                                   glm::lookAt(position, position + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
-                                   glm::lookAt(position, position + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
-                                   glm::lookAt(position, position + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)),
-                                   glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
-                                   glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))});
+    const auto &position = getLightPosition();
+    newViewMatrices[0] = glm::lookAt(position, position + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    newViewMatrices[1] = glm::lookAt(position, position + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    newViewMatrices[2] = glm::lookAt(position, position + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    newViewMatrices[3] = glm::lookAt(position, position + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    newViewMatrices[4] = glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    newViewMatrices[5] = glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
   }
 
   /**
-   * Create the projection matrices for the point light.
+   * Create the projection matrix of the faces of the point light. The faces keep a near plane of 0.1, since the near plane
+   *   of the light is instead the radius around it that the fragment shader pushes out to the far plane, so the model
+   *   carrying the light doesn't shadow the scene.
    * 
-   * @param nearPlane  The closest distance the light can project from.
-   * @param farPlane   The farthest distance the light can project till.
-   * 
-   * @return The list of projection matrices for the point light.
+   * @return The projection matrix of the faces.
    */
-  std::vector<glm::mat4> createProjectionMatrices(const float_t &nearPlane, const float_t &farPlane)
+  glm::mat4 createProjectionMatrix() const override
   {
-    return std::vector<glm::mat4>({glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane),
-                                   glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane),
-                                   glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane),
-                                   glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane),
-                                   glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane),
-                                   glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane)});
+    return glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, getLightFarPlane());
   }
 
 public:
-  PointLight(const std::string &lightId)
+  PointLight(const std::string &lightId, const bool &castsShadows = true)
       : LightBase(
             lightId,
             "Point",
             glm::vec3(1.0f), 100.0f,
-            "assets/shaders/vertex/light_base.glsl", "assets/shaders/geometry/point_light.glsl", "assets/shaders/fragment/point_light.glsl",
+            // Render the six faces with instancing if the vertex shader can select the layer, since fanning triangles out
+            // in a geometry shader is slow on most GPUs.
+            WindowManager::getInstance().isVertexShaderLayerSupported() ? "assets/shaders/vertex/point_light_layered.glsl" : "assets/shaders/vertex/light_base.glsl",
+            WindowManager::getInstance().isVertexShaderLayerSupported() ? "" : "assets/shaders/geometry/point_light.glsl",
+            "assets/shaders/fragment/point_light.glsl",
             glm::vec3(0.0f),
             1.1f, 100.0f,
-            createViewMatrices(), createProjectionMatrices(0.1f, 100.0f),
-            ShadowBufferType::POINT) {}
+            6,
+            ShadowBufferType::POINT,
+            castsShadows) {}
 
   virtual ~PointLight() {}
 
-  void setLightPosition(const glm::vec3 &newPosition) override
-  {
-    // Update the light position.
-    LightBase::setLightPosition(newPosition);
-    // Update the view matrices.
-    setViewMatrices(createViewMatrices());
-  }
-
-  void setLightNearPlane(const float_t &newNearPlane) override
-  {
-    // Update the light near plane.
-    LightBase::setLightNearPlane(newNearPlane);
-    // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(newNearPlane, getLightFarPlane()));
-  }
-
-  void setLightFarPlane(const float_t &newFarPlane) override
-  {
-    // Update the light far plane.
-    LightBase::setLightFarPlane(newFarPlane);
-    // Update the projection matrices.
-    setProjectionMatrices(createProjectionMatrices(getLightNearPlane(), newFarPlane));
-  }
-
   /**
    * Creates a new instance of the point light.
+   * 
+   * @param lightId       The ID of the light.
+   * @param castsShadows  Whether the light casts shadows, or is only lit through the light clusters.
    */
-  const static std::shared_ptr<PointLight> create(const std::string &lightId)
+  const static std::shared_ptr<PointLight> create(const std::string &lightId, const bool &castsShadows = true)
   {
-    return std::make_shared<PointLight>(lightId);
+    return std::make_shared<PointLight>(lightId, castsShadows);
   }
 };
 
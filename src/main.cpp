@@ -1,5 +1,9 @@
+#include <iostream>
 #include <string>
+#include <optional>
+#include <memory>
 #include <future>
+#include <filesystem>
 
 #include <GL/glew.h>
 
@@ -11,23 +15,213 @@
 
 using namespace glm;
 
-int main(void)
+int main(int argc, char **argv)
 {
+	// Start the clock the phases of starting up are timed with, and the log writer, before the main thread is placed so
+	// the writer isn't left sharing its core.
+	StartupProfiler &startupProfiler = StartupProfiler::getInstance();
+	Logger &logger = Logger::getInstance();
 	SceneManager &sceneManager = SceneManager::getInstance();
 
-	auto mainMenuScene = MainMenuScene::create("MainMenuScene");
-	auto gameScene = GameScene::create("GameScene");
-	auto endScene = EndScene::create("EndScene");
+	// Load the settings file given by the option for it, or the default settings file if there is one, before the other
+	// options, so the options override the settings.
+	std::string settingsFilePath = std::filesystem::exists(DEFAULT_SETTINGS_FILE) ? DEFAULT_SETTINGS_FILE : "";
+	for (auto i = 1; i + 1 < argc; i++)
+	{
+		if (std::string(argv[i]) == "--settings")
+		{
+			settingsFilePath = argv[i + 1];
+		}
+	}
+	if (!settingsFilePath.empty() && !SettingsManager::getInstance().load(settingsFilePath))
+	{
+		return 1;
+	}
+
+	// Print how the options are used, for when they aren't valid.
+	const auto printUsage = [argv]() {
+		std::cout << "Usage: " << argv[0] << " [--benchmark <idle|sweep|stress> [<width> <height> <depth>] [--corner-box-test]] [--render-thread] [--no-thread-affinity] [--hot-reload] [--capture] [--no-idle-throttle] [--idle-pause] [--quiet] [--shadow-map-size <texels>] [--record <file> | --replay <file>] [--telemetry <port>] [--settings <file>]" << std::endl;
+	};
+
+	// Check for the options to run the GL work of the frames on a render thread, to leave the threads wherever the OS
+	// places them, to hot reload the assets, to capture every frame, to keep the frames going at full rate or to pause the
+	// scene while the window is minimized or unfocused, to render offscreen in a hidden window, to log only the warnings and
+	// errors, to pick the size of the largest shadow maps, to record or replay the input of the game, to export the
+	// telemetry of the frames, and the settings file loaded above, which go after every other option in any order.
+	std::string replayFilePath = "";
+	while (argc >= 2)
+	{
+		const std::string option(argv[argc - 1]);
+		if (argc >= 3 && std::string(argv[argc - 2]) == "--record")
+		{
+			INPUT_RECORDING_FILE = option;
+			argc -= 2;
+			continue;
+		}
+		else if (argc >= 3 && std::string(argv[argc - 2]) == "--telemetry")
+		{
+			if (!SettingsManager::parseValue(option, TELEMETRY_PORT))
+			{
+				printUsage();
+				return 1;
+			}
+			argc -= 2;
+			continue;
+		}
+		else if (argc >= 3 && std::string(argv[argc - 2]) == "--shadow-map-size")
+		{
+			uint32_t shadowMapSize;
+			if (!SettingsManager::parseValue(option, shadowMapSize) || shadowMapSize == 0)
+			{
+				printUsage();
+				return 1;
+			}
+			CONE_SHADOW_ATLAS_SIZE = POINT_SHADOW_ATLAS_SIZE = DIRECTIONAL_SHADOW_ATLAS_SIZE = shadowMapSize;
+			argc -= 2;
+			continue;
+		}
+		else if (argc >= 3 && std::string(argv[argc - 2]) == "--settings")
+		{
+			argc -= 2;
+			continue;
+		}
+		else if (argc >= 3 && std::string(argv[argc - 2]) == "--replay")
+		{
+			replayFilePath = option;
+			argc -= 2;
+			continue;
+		}
+		else if (option == "--render-thread")
+		{
+			RENDER_THREAD_ENABLED = true;
+		}
+		else if (option == "--no-thread-affinity")
+		{
+			THREAD_AFFINITY_ENABLED = false;
+		}
+		else if (option == "--hot-reload")
+		{
+			ASSET_HOT_RELOAD_ENABLED = true;
+		}
+		else if (option == "--capture")
+		{
+			FrameCaptureManager::getInstance().setContinuousCaptureEnabled(true);
+		}
+		else if (option == "--no-idle-throttle")
+		{
+			IDLE_THROTTLE_ENABLED = false;
+		}
+		else if (option == "--idle-pause")
+		{
+			IDLE_PAUSE_ENABLED = true;
+		}
+		else if (option == "--offscreen")
+		{
+			OFFSCREEN_ENABLED = true;
+		}
+		else if (option == "--quiet")
+		{
+			logger.setMinSeverity(WARNING_SEVERITY);
+		}
+		else
+		{
+			break;
+		}
+		argc--;
+	}
+
+	// Place the main thread on its core now that the options the thread layout is worked out from are known, before any
+	// other thread is started.
+	ThreadLayout::getInstance().applyToCurrentThread(ThreadRole::MAIN);
+
+	// Serve the assets from the packed asset archive if there is one, so they're read in one go instead of one file at a
+	// time. Hot reloaded assets are read from their loose files, so the changes to them are seen.
+	if (!ASSET_HOT_RELOAD_ENABLED)
+	{
+		AssetFileSystem::getInstance().mountArchive(ASSET_ARCHIVE_FILE);
+	}
+
+	// Check if a benchmark scenario was asked for, which skips the main menu and plays the scenario instead of the player.
+	std::optional<BenchmarkScenario> benchmarkScenario = std::nullopt;
+	if (argc >= 2 && std::string(argv[1]) == "--benchmark")
+	{
+		// Check for the option to use the corner containment box-box collision test, for comparing against it.
+		const auto cornerBoxTest = argc >= 4 && std::string(argv[argc - 1]) == "--corner-box-test";
+		const auto argumentsCount = cornerBoxTest ? argc - 1 : argc;
+
+		BenchmarkScenario scenario;
+		if ((argumentsCount != 3 && argumentsCount != 6) || !BenchmarkScenario::find(argv[2], scenario))
+		{
+			printUsage();
+			return 1;
+		}
+		scenario.separatingAxisBoxTestEnabled = !cornerBoxTest;
+		// Override the size of the grid of enemies of the scenario, if one was given.
+		if (argumentsCount == 6)
+		{
+			if (!SettingsManager::parseValue(argv[3], scenario.enemyGridSize.x) || !SettingsManager::parseValue(argv[4], scenario.enemyGridSize.y) ||
+					!SettingsManager::parseValue(argv[5], scenario.enemyGridSize.z) || scenario.enemyGridSize.x == 0 || scenario.enemyGridSize.y == 0 || scenario.enemyGridSize.z == 0)
+			{
+				printUsage();
+				return 1;
+			}
+		}
+		benchmarkScenario = scenario;
+	}
+
+	// Replay a recorded game as a benchmark, taking the time and the input of each frame from the recording.
+	if (!replayFilePath.empty())
+	{
+		auto recording = std::make_shared<InputRecording>();
+		if (benchmarkScenario || !InputRecording::load(replayFilePath, *recording) || recording->frames.empty())
+		{
+			printUsage();
+			return 1;
+		}
+		benchmarkScenario = BenchmarkScenario::fromRecording("replay", recording);
+	}
+
+	// Benchmarks and replays time every frame, so they run at full rate whether the window has the focus or not.
+	if (benchmarkScenario)
+	{
+		IDLE_THROTTLE_ENABLED = false;
+		IDLE_PAUSE_ENABLED = false;
+	}
+
+	// Start up the engine in timed phases, instead of in whatever order its subsystems are first used in. The font is
+	// loaded on a worker, since it doesn't need the GL context, while the main thread opens the window and compiles the
+	// shaders, which have to be done on the thread the context is current on.
+	TextManager::loadCharacterSet();
+	startupProfiler.runPhase(StartupPhase::WINDOW, [] { WindowManager::getInstance(); });
+	startupProfiler.runPhase(StartupPhase::GL, [] {
+		ShadowBufferManager::getInstance();
+		TextureManager::getInstance();
+		World::getDefault();
+	});
+	startupProfiler.runPhase(StartupPhase::SHADERS, [] {
+		ParticleManager::getInstance();
+		DebugRenderManager::getInstance();
+		TextManager::getInstance();
+		RenderManager::getInstance();
+	});
+
+	// The scenes play in the default world, whose managers are the ones the renderer draws.
+	auto &world = World::getDefault();
+	auto mainMenuScene = MainMenuScene::create(world, "MainMenuScene");
+	auto gameScene = GameScene::create(world, "GameScene", benchmarkScenario);
+	auto endScene = EndScene::create(world, "EndScene");
 
 	sceneManager.registerScene(mainMenuScene);
 	sceneManager.registerScene(gameScene);
 	sceneManager.registerScene(endScene);
 
-	sceneManager.registerActiveScene(mainMenuScene->getSceneId());
+	// Serve the telemetry of the frames for monitoring the game remotely, if it was asked for.
+	if (TELEMETRY_PORT != 0)
+	{
+		TelemetryExporter::getInstance().start(TELEMETRY_PORT);
+	}
 
-	GLuint vertexArrayID;
-	glGenVertexArrays(1, &vertexArrayID);
-	glBindVertexArray(vertexArrayID);
+	sceneManager.registerActiveScene(benchmarkScenario ? gameScene->getSceneId() : mainMenuScene->getSceneId());
 
 	while (sceneManager.executeActiveScene())
 		;
@@ -36,7 +230,5 @@ int main(void)
 	sceneManager.deregisterScene("GameScene");
 	sceneManager.deregisterScene("MainMenuScene");
 
-	glDeleteVertexArrays(1, &vertexArrayID);
-
 	return 0;
 }
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include <GL/glew.h>
+
+#include "include/asset_archive.cpp"
+#include "include/benchmark.cpp"
+#include "include/settings.cpp"
+#include "include/parallel.cpp"
+
+#include "scenes/simulated_game.cpp"
+
+/**
+ * Batch simulation of many independent games of a benchmark scenario, each in a world of its own and seeded apart, for
+ * balance testing and training bots, where the number of games simulated per second is what counts. The games are taken
+ * one at a time by every thread of the job system, each simulating its games on its own instead of splitting their
+ * steps across the threads, since there are enough games to keep every thread busy.
+ *
+ * Usage: main_batch <idle|sweep|stress> <games> [<width> <height> <depth>]
+ */
+int main(int argc, char **argv)
+{
+	BenchmarkScenario scenario;
+	uint32_t gamesCount = 0;
+	if ((argc != 3 && argc != 6) || !BenchmarkScenario::find(argv[1], scenario) || !SettingsManager::parseValue(argv[2], gamesCount) || gamesCount == 0)
+	{
+		std::cout << "Usage: " << argv[0] << " <idle|sweep|stress> <games> [<width> <height> <depth>]" << std::endl;
+		return 1;
+	}
+	// Override the size of the grid of enemies of the scenario, if one was given.
+	if (argc == 6)
+	{
+		if (!SettingsManager::parseValue(argv[3], scenario.enemyGridSize.x) || !SettingsManager::parseValue(argv[4], scenario.enemyGridSize.y) ||
+				!SettingsManager::parseValue(argv[5], scenario.enemyGridSize.z) || scenario.enemyGridSize.x == 0 || scenario.enemyGridSize.y == 0 || scenario.enemyGridSize.z == 0)
+		{
+			std::cout << "Usage: " << argv[0] << " <idle|sweep|stress> <games> [<width> <height> <depth>]" << std::endl;
+			return 1;
+		}
+	}
+
+	AssetFileSystem::getInstance().mountArchive(ASSET_ARCHIVE_FILE);
+	SimulatedGame::prepare(scenario);
+
+	// Simulate the games on every thread, with each thread taking the next game once it finishes one.
+	std::vector<uint32_t> stepsCounts(gamesCount, 0);
+	std::vector<uint32_t> enemiesCounts(gamesCount, 0);
+	std::atomic<uint32_t> nextGame(0);
+	const auto threadsCount = ParallelTasks::getTaskCount();
+	const auto startTime = std::chrono::steady_clock::now();
+	ParallelTasks::run(threadsCount, [&](const uint32_t) {
+		ParallelTasks::setSerial(true);
+		for (auto gameIndex = nextGame.fetch_add(1); gameIndex < gamesCount; gameIndex = nextGame.fetch_add(1))
+		{
+			SimulatedGame game(scenario, scenario.seed + gameIndex);
+			game.run();
+			stepsCounts[gameIndex] = game.getStepsCount();
+			enemiesCounts[gameIndex] = game.getEnemiesCount();
+		}
+		ParallelTasks::setSerial(false);
+	});
+	const auto elapsedTime = std::chrono::duration<double_t>(std::chrono::steady_clock::now() - startTime).count();
+
+	// Report the throughput, and how the games went.
+	uint64_t totalStepsCount = 0, totalEnemiesCount = 0;
+	uint32_t clearedGamesCount = 0;
+	for (uint32_t i = 0; i < gamesCount; i++)
+	{
+		totalStepsCount += stepsCounts[i];
+		totalEnemiesCount += enemiesCounts[i];
+		clearedGamesCount += enemiesCounts[i] == 0 ? 1 : 0;
+	}
+	std::cout << "Simulated " << gamesCount << " games of " << scenario.name << " on " << threadsCount << " threads in " << elapsedTime << " s" << std::endl
+						<< "  " << gamesCount / elapsedTime << " games/s, " << gamesCount / elapsedTime / threadsCount << " games/s per thread, "
+						<< totalStepsCount / elapsedTime << " steps/s" << std::endl
+						<< "  " << clearedGamesCount << " games cleared, " << double_t(totalEnemiesCount) / gamesCount << " enemies left on average" << std::endl;
+	return 0;
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cmath>
+
+#include <GL/glew.h>
+
+#include "include/asset_archive.cpp"
+#include "include/benchmark.cpp"
+#include "include/settings.cpp"
+
+#include "scenes/simulated_game.cpp"
+
+/**
+ * Headless simulation of the game scene, which plays a benchmark scenario with the models, colliders and projectiles of
+ * the game but without a window or a GL context, so many of them can run side by side for validating the simulation and
+ * play-testing it with bots. The objects only keep the bounds of their meshes, the textures and shaders aren't loaded,
+ * and the lights are left out, since they only matter to rendering. The simulation is stepped at the fixed time step of
+ * the game as fast as it goes, with the time of each step given to the models instead of read from the clock.
+ *
+ * Usage: main_headless <idle|sweep|stress> [<width> <height> <depth>]
+ */
+int main(int argc, char **argv)
+{
+	BenchmarkScenario scenario;
+	if ((argc != 2 && argc != 5) || !BenchmarkScenario::find(argv[1], scenario))
+	{
+		std::cout << "Usage: " << argv[0] << " <idle|sweep|stress> [<width> <height> <depth>]" << std::endl;
+		return 1;
+	}
+	// Override the size of the grid of enemies of the scenario, if one was given.
+	if (argc == 5)
+	{
+		if (!SettingsManager::parseValue(argv[2], scenario.enemyGridSize.x) || !SettingsManager::parseValue(argv[3], scenario.enemyGridSize.y) ||
+				!SettingsManager::parseValue(argv[4], scenario.enemyGridSize.z) || scenario.enemyGridSize.x == 0 || scenario.enemyGridSize.y == 0 || scenario.enemyGridSize.z == 0)
+		{
+			std::cout << "Usage: " << argv[0] << " <idle|sweep|stress> [<width> <height> <depth>]" << std::endl;
+			return 1;
+		}
+	}
+
+	AssetFileSystem::getInstance().mountArchive(ASSET_ARCHIVE_FILE);
+
+	// Play the scenario, until it ends or every enemy is destroyed.
+	SimulatedGame::prepare(scenario);
+	SimulatedGame game(scenario, scenario.seed);
+	const auto startTime = std::chrono::steady_clock::now();
+	game.run();
+	const auto elapsedTime = std::chrono::duration<double_t, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	std::cout << "Simulated " << game.getStepsCount() << " steps (" << game.getStepsCount() * SIMULATION_TIME_STEP << " s) of " << scenario.name << " in "
+						<< elapsedTime << " ms, " << game.getEnemiesCount() << " enemies left" << std::endl;
+	return 0;
+}
@@ -0,0 +1,350 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+
+#include <GL/glew.h>
+
+#include "include/micro_benchmark.cpp"
+#include "include/window.cpp"
+#include "include/collider.cpp"
+#include "include/mesh.cpp"
+#include "include/object.cpp"
+#include "include/texture.cpp"
+#include "include/text.cpp"
+#include "include/world.cpp"
+
+#include "light/point_light.cpp"
+#include "models/enemy_model.cpp"
+
+/**
+ * Create a collider shape of the given type around the origin, about a unit in size.
+ *
+ * @param shapeType  The type of the shape.
+ * @param position   The position of the shape.
+ * @param rotation   The rotation of the shape.
+ *
+ * @return The collider shape.
+ */
+std::shared_ptr<ColliderShape> createShape(const ColliderShapeType &shapeType, const glm::vec3 &position, const glm::quat &rotation)
+{
+	const glm::vec3 scale(1.0f);
+	switch (shapeType)
+	{
+	case ColliderShapeType::BOX:
+		return std::make_shared<BoxColliderShape>(position, rotation, scale, glm::vec3(-0.5f), glm::vec3(0.5f));
+	case ColliderShapeType::PILL:
+		return std::make_shared<PillColliderShape>(position, rotation, scale, 0.3f, 0.4f);
+	case ColliderShapeType::CYLINDER:
+		return std::make_shared<CylinderColliderShape>(position, rotation, scale, 0.4f, 0.4f);
+	default:
+		return std::make_shared<SphereColliderShape>(position, rotation, scale, 0.5f);
+	}
+}
+
+/**
+ * Register the micro-benchmarks of the deep collision tests of each pair of shape types, with the shapes placed close
+ * enough for their bounding boxes to overlap, so the deep test is what's measured.
+ *
+ * @param runner  The runner to register the micro-benchmarks with.
+ */
+void addCollisionBenchmarks(MicroBenchmarkRunner &runner)
+{
+	const std::vector<std::pair<ColliderShapeType, std::string>> shapeTypes = {
+			{ColliderShapeType::SPHERE, "sphere"}, {ColliderShapeType::BOX, "box"}, {ColliderShapeType::PILL, "pill"}, {ColliderShapeType::CYLINDER, "cylinder"}};
+	for (size_t i = 0; i < shapeTypes.size(); i++)
+	{
+		for (size_t j = 0; j <= i; j++)
+		{
+			const auto shapeType1 = shapeTypes[i].first, shapeType2 = shapeTypes[j].first;
+			runner.add("collision/" + shapeTypes[i].second + "-" + shapeTypes[j].second, false, [shapeType1, shapeType2]() {
+				// Place the pairs of shapes at random offsets and rotations, so both the colliding and the separated paths are taken.
+				std::mt19937 generator(1);
+				std::uniform_real_distribution<float_t> offsetDistribution(-0.8f, 0.8f), angleDistribution(0.0f, glm::radians(360.0f));
+				const auto randomRotation = [&]() { return glm::quat(glm::vec3(angleDistribution(generator), angleDistribution(generator), angleDistribution(generator))); };
+				auto shapePairs = std::make_shared<std::vector<std::pair<std::shared_ptr<ColliderShape>, std::shared_ptr<ColliderShape>>>>();
+				for (uint32_t k = 0; k < 64; k++)
+				{
+					const glm::vec3 offset(offsetDistribution(generator), offsetDistribution(generator), offsetDistribution(generator));
+					shapePairs->push_back({createShape(shapeType1, glm::vec3(0.0f), randomRotation()), createShape(shapeType2, offset, randomRotation())});
+				}
+				return [shapePairs](const uint64_t &iterations) {
+					uint64_t collisionsCount = 0;
+					for (uint64_t k = 0; k < iterations; k++)
+					{
+						const auto &shapePair = (*shapePairs)[k % shapePairs->size()];
+						collisionsCount += DeepCollisionValidator::haveShapesCollided(*shapePair.first, *shapePair.second, true) ? 1 : 0;
+					}
+					return collisionsCount;
+				};
+			});
+		}
+	}
+}
+
+/**
+ * Register the micro-benchmarks of creating and updating the axis aligned bounding boxes, and of moving a collider shape,
+ * which updates its transformed box.
+ *
+ * @param runner  The runner to register the micro-benchmarks with.
+ */
+void addBoundingBoxBenchmarks(MicroBenchmarkRunner &runner)
+{
+	for (const auto &verticesCount : {8u, 1024u})
+	{
+		runner.add("aabb/construct-" + std::to_string(verticesCount) + "-vertices", false, [verticesCount]() {
+			std::mt19937 generator(1);
+			std::uniform_real_distribution<float_t> coordinateDistribution(-1.0f, 1.0f);
+			auto vertices = std::make_shared<std::vector<glm::vec3>>();
+			for (uint32_t i = 0; i < verticesCount; i++)
+			{
+				vertices->push_back(glm::vec3(coordinateDistribution(generator), coordinateDistribution(generator), coordinateDistribution(generator)));
+			}
+			return [vertices](const uint64_t &iterations) {
+				double_t sum = 0.0;
+				for (uint64_t i = 0; i < iterations; i++)
+				{
+					const AxisAlignedBoundingBox box(*vertices);
+					sum += box.getMaxCorner().x - box.getMinCorner().x;
+				}
+				return static_cast<uint64_t>(sum);
+			};
+		});
+	}
+	runner.add("aabb/update-corners", false, []() {
+		auto box = std::make_shared<AxisAlignedBoundingBox>(glm::vec3(-1.0f), glm::vec3(1.0f));
+		return [box](const uint64_t &iterations) {
+			double_t sum = 0.0;
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				const auto offset = float_t(i % 64) * 0.01f;
+				box->update(glm::vec3(-1.0f - offset), glm::vec3(1.0f + offset));
+				sum += box->getCorners()[7].x;
+			}
+			return static_cast<uint64_t>(sum);
+		};
+	});
+	runner.add("aabb/collider-update-transformations", false, []() {
+		auto shape = std::make_shared<BoxColliderShape>(glm::vec3(0.0f), glm::quat(glm::vec3(0.0f)), glm::vec3(1.0f), glm::vec3(-0.5f), glm::vec3(0.5f));
+		return [shape](const uint64_t &iterations) {
+			double_t sum = 0.0;
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				const auto step = float_t(i % 64) * 0.01f;
+				shape->updateTransformations(glm::vec3(step, 0.0f, -step), glm::quat(glm::vec3(0.0f, step, 0.0f)), glm::vec3(1.0f));
+				sum += shape->getTransformedBox().getMaxCorner().x;
+			}
+			return static_cast<uint64_t>(sum);
+		};
+	});
+}
+
+/**
+ * Register the micro-benchmarks of loading the mesh of each object asset, both parsing its OBJ file and reading its
+ * binary mesh file.
+ *
+ * @param runner  The runner to register the micro-benchmarks with.
+ */
+void addMeshBenchmarks(MicroBenchmarkRunner &runner)
+{
+	std::vector<std::string> objectFilePaths({});
+	std::error_code errorCode;
+	for (const auto &entry : std::filesystem::directory_iterator("assets/objects", errorCode))
+	{
+		if (entry.path().extension() == ".obj")
+		{
+			objectFilePaths.push_back(entry.path().generic_string());
+		}
+	}
+	std::sort(objectFilePaths.begin(), objectFilePaths.end());
+	for (const auto &objectFilePath : objectFilePaths)
+	{
+		const auto objectName = std::filesystem::path(objectFilePath).stem().string();
+		// Parsing the OBJ file also optimizes the mesh, builds its levels of detail, and writes its binary mesh file.
+		runner.add("mesh/parse-" + objectName, false, [objectName, objectFilePath]() {
+			return [objectName, objectFilePath](const uint64_t &iterations) {
+				uint64_t indicesCount = 0;
+				for (uint64_t i = 0; i < iterations; i++)
+				{
+					indicesCount += MeshLoader::reloadMesh(objectName, objectFilePath).indices.size();
+				}
+				return indicesCount;
+			};
+		});
+		runner.add("mesh/load-" + objectName, false, [objectName, objectFilePath]() {
+			return [objectName, objectFilePath](const uint64_t &iterations) {
+				uint64_t indicesCount = 0;
+				for (uint64_t i = 0; i < iterations; i++)
+				{
+					indicesCount += MeshLoader::loadMesh(objectName, objectFilePath).indices.size();
+				}
+				return indicesCount;
+			};
+		});
+	}
+}
+
+/**
+ * Register the micro-benchmarks of rendering the given number of characters of text, with the lines changing every
+ * iteration so their glyphs are laid out again, and with the lines unchanged so only their cached geometry is drawn.
+ *
+ * @param runner  The runner to register the micro-benchmarks with.
+ */
+void addTextBenchmarks(MicroBenchmarkRunner &runner)
+{
+	for (const auto &charactersCount : {80u, 800u, 8000u})
+	{
+		for (const auto &changing : {true, false})
+		{
+			runner.add("text/render-" + std::to_string(charactersCount) + (changing ? "-changing" : "-cached"), true, [charactersCount, changing]() {
+				auto lines = std::make_shared<std::vector<std::string>>(charactersCount / MAX_TEXT_LENGTH, std::string(MAX_TEXT_LENGTH, 'a'));
+				return [lines, changing](const uint64_t &iterations) {
+					auto &textManager = TextManager::getInstance();
+					uint64_t renderedCharactersCount = 0;
+					for (uint64_t i = 0; i < iterations; i++)
+					{
+						for (size_t j = 0; j < lines->size(); j++)
+						{
+							if (changing)
+							{
+								(*lines)[j][0] = 'a' + (i % 26);
+							}
+							textManager.addText((*lines)[j], glm::vec2(1.0f, 1.0f + j * 0.5f), 0.5f);
+						}
+						renderedCharactersCount += textManager.render();
+					}
+					return renderedCharactersCount;
+				};
+			});
+		}
+	}
+}
+
+/**
+ * Register the micro-benchmarks of iterating the models of a world with the given numbers of them registered, both over
+ * all the models and over the view of the models of a type.
+ *
+ * @param runner  The runner to register the micro-benchmarks with.
+ */
+void addModelBenchmarks(MicroBenchmarkRunner &runner)
+{
+	for (const auto &modelsCount : {100u, 1000u, 10000u})
+	{
+		const auto prepareWorld = [modelsCount]() {
+			auto world = std::make_shared<World>();
+			WorldScope worldScope(*world);
+			for (uint32_t i = 0; i < modelsCount; i++)
+			{
+				const auto enemyModel = EnemyModel::create("Enemy" + std::to_string(i));
+				enemyModel->setModelPosition(glm::vec3(float_t(i % 100), float_t(i / 100), 0.0f));
+				world->getModelManager().registerModel(enemyModel);
+			}
+			return world;
+		};
+		runner.add("models/get-all-" + std::to_string(modelsCount), false, [prepareWorld]() {
+			const auto world = prepareWorld();
+			return [world](const uint64_t &iterations) {
+				double_t sum = 0.0;
+				for (uint64_t i = 0; i < iterations; i++)
+				{
+					for (const auto &model : world->getModelManager().getAllModels())
+					{
+						sum += model->getModelPosition().x;
+					}
+				}
+				return static_cast<uint64_t>(sum);
+			};
+		});
+		runner.add("models/view-" + std::to_string(modelsCount), false, [prepareWorld]() {
+			const auto world = prepareWorld();
+			return [world](const uint64_t &iterations) {
+				double_t sum = 0.0;
+				for (uint64_t i = 0; i < iterations; i++)
+				{
+					for (const auto &enemyModel : world->getModelManager().view<EnemyModel>())
+					{
+						sum += enemyModel.getModelPosition().x;
+					}
+				}
+				return static_cast<uint64_t>(sum);
+			};
+		});
+	}
+}
+
+/**
+ * Register the micro-benchmark of rebuilding the matrices of the six faces of a point light after it moves.
+ *
+ * @param runner  The runner to register the micro-benchmarks with.
+ */
+void addLightBenchmarks(MicroBenchmarkRunner &runner)
+{
+	runner.add("light/point-matrices", true, []() {
+		const auto pointLight = PointLight::create("MicroBenchmarkLight", false);
+		return [pointLight](const uint64_t &iterations) {
+			double_t sum = 0.0;
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				pointLight->setLightPosition(glm::vec3(float_t(i % 64) * 0.1f, 1.0f, 0.0f));
+				sum += pointLight->getViewProjectionMatrices()[0][3][0];
+			}
+			return static_cast<uint64_t>(std::abs(sum));
+		};
+	});
+}
+
+/**
+ * Micro-benchmarks of the hot functions of the engine, each timed on its own, for judging optimizations of a function by
+ * its own time rather than by the noise of whole frames. The micro-benchmarks whose names start with any of the given
+ * prefixes are run, or all of them if none are given. The window is only opened if one of them needs the GL context, so
+ * the rest run headless.
+ *
+ * Usage: micro_bench [<prefix>...]
+ */
+int main(int argc, char **argv)
+{
+	const std::vector<std::string> prefixes(argv + 1, argv + argc);
+
+	MicroBenchmarkRunner runner;
+	addCollisionBenchmarks(runner);
+	addBoundingBoxBenchmarks(runner);
+	addMeshBenchmarks(runner);
+	addTextBenchmarks(runner);
+	addModelBenchmarks(runner);
+	addLightBenchmarks(runner);
+
+	// Open the window for the micro-benchmarks that need the GL context, or keep the objects on the CPU otherwise.
+	if (runner.needsContext(prefixes))
+	{
+		WindowManager::getInstance();
+	}
+	else
+	{
+		HEADLESS_ENABLED = true;
+	}
+
+	// Load the objects of the models, which the models are created from.
+	auto &objectManager = ObjectManager::getInstance();
+	EnemyModel::initModel();
+	while (objectManager.hasPendingLoads() || (!HEADLESS_ENABLED && TextureManager::getInstance().hasPendingUploads()))
+	{
+		objectManager.processPendingLoads();
+		if (!HEADLESS_ENABLED)
+		{
+			TextureManager::getInstance().processPendingUploads();
+		}
+	}
+
+	const auto results = runner.run(prefixes);
+	if (results.empty())
+	{
+		std::cout << "No micro-benchmarks start with the given prefixes" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <optional>
 
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -13,25 +14,59 @@
 
 #include "../include/constants.cpp"
 #include "../include/control.cpp"
+#include "../include/camera.cpp"
+#include "../include/render.cpp"
+#include "../include/collision.cpp"
 
 #include "model_base.cpp"
 
 /**
- * Class that represents a title model.
+ * Class that represents a cursor model, which finds the button under it with a ray from the camera through the cursor.
  */
 class CursorModel : public ModelBase<CursorModel>
 {
 private:
+  // The furthest distance from the camera the buttons are looked for at.
+  inline static const float_t PICK_DISTANCE = 100.0f;
+
   // The control manager responsible for managing controls and inputs of the window.
   ControlManager &controlManager;
+  // The camera manager responsible for managing the cameras in the scene.
+  CameraManager &cameraManager;
+  // The render manager, whose active camera the ray goes out from.
+  RenderManager &renderManager;
+  // The collision manager the ray is queried with.
+  CollisionManager &collisionManager;
 
   // Whether to accept input or not.
   bool acceptInput;
-  // The last time the ability to accept input was changed.
-  float_t lastAcceptInputChange;
 
-  // The timestamp of the last time the update for the camera was started.
-  float_t lastTime;
+  // The mask of the collision layers of the models that can be picked.
+  const uint32_t pickableLayers;
+  // The cursor position the picked model was last looked for at, so the ray is only queried when the cursor moves.
+  std::optional<glm::vec2> pickedScreenPosition;
+  // The handle of the model under the cursor, which is invalid if there isn't one. The handle is kept instead of the
+  //   model, since the buttons already keep the cursor.
+  SlotHandle hoveredModelHandle;
+
+  /**
+   * Find the model under the cursor, with a ray from the active camera through the cursor, unless the cursor hasn't
+   *   moved since it was last looked for.
+   *
+   * @param screenPosition  The position of the cursor on the screen.
+   */
+  void pickModel(const glm::vec2 &screenPosition)
+  {
+    if (pickedScreenPosition == screenPosition)
+    {
+      return;
+    }
+    pickedScreenPosition = screenPosition;
+
+    const auto ray = cameraManager.getCamera(renderManager.getActiveCameraHandle())->getScreenRay(screenPosition);
+    RaycastHit hit;
+    hoveredModelHandle = collisionManager.raycast(ray, PICK_DISTANCE, pickableLayers, hit) ? hit.model->getModelHandle() : SlotHandle({0, 0});
+  }
 
 public:
   CursorModel(const std::string &modelId)
@@ -39,10 +74,14 @@ public:
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.025f, 0.05f, 2.5f),
             ColliderShapeType::BOX),
-        controlManager(ControlManager::getInstance()),
-        lastTime(glfwGetTime()),
+        controlManager(getWorld().getControlManager()),
+        cameraManager(getWorld().getCameraManager()),
+        renderManager(RenderManager::getInstance()),
+        collisionManager(getWorld().getCollisionManager()),
         acceptInput(true),
-        lastAcceptInputChange(glfwGetTime() - 10.0f) {}
+        pickableLayers(COLLISION_LAYER_MENU),
+        pickedScreenPosition(std::nullopt),
+        hoveredModelHandle({0, 0}) {}
 
   static void initModel()
   {
@@ -66,29 +105,38 @@ public:
     return std::make_shared<CursorModel>(modelId);
   }
 
-  void update() override
+  /**
+   * Get the handle of the model under the cursor.
+   *
+   * @return The handle of the model, which is invalid if there isn't one.
+   */
+  const SlotHandle &getHoveredModelHandle() const
   {
-    // Get the current time for the start of the update.
-    const auto currentTime = glfwGetTime();
-    // Get the time difference since the start of the last update.
-    const auto deltaTime = float_t(currentTime - lastTime);
+    return hoveredModelHandle;
+  }
 
-    // Check if the M key was pressed after 500ms since the last accept input change.
-    if (controlManager.isKeyPressed(GLFW_KEY_M) && (currentTime - lastAcceptInputChange) > 0.5f)
+  bool castsShadows() const override
+  {
+    // The cursor only points at the menus, so its shadow would only get in the way.
+    return false;
+  }
+
+  void update(const FrameTime &) override
+  {
+    // Check if the M key was pressed for the accept input toggle.
+    if (controlManager.wasKeyPressed(GLFW_KEY_M))
     {
       // "M" key was pressed. Toggle accepting input.
       acceptInput = !acceptInput;
 
       setModelPosition(glm::vec3(0.0f));
       controlManager.setCursorPosition(CursorPosition(0.5f, 0.5f));
-
-      // Update the timestamp for the last time accept input flag was changed.
-      lastAcceptInputChange = currentTime;
     }
 
-    // If input is not being accepted, just consume mouse inputs and end.
+    // If input is not being accepted, just consume mouse inputs and end, with the cursor left in the centre.
     if (!acceptInput)
     {
+      pickModel(glm::vec2(0.5f));
       return;
     }
 
@@ -98,6 +146,7 @@ public:
 
     const auto newCursorPosition = glm::vec3((2.0f * ASPECT_RATIO) * (cursorPosition->getX() - 0.5f), -2.0f * (cursorPosition->getY() - 0.5f), 0.0f);
     setModelPosition(newCursorPosition);
+    pickModel(glm::vec2(cursorPosition->getX(), cursorPosition->getY()));
   }
 };
 
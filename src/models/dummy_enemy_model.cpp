@@ -18,9 +18,8 @@
 class DummyEnemyModel : public ModelBase<DummyEnemyModel>
 {
 private:
-  float_t rotationSpeedY;
-
-  float_t lastTime;
+  // The speed the enemy spins at, which the vertex shaders turn it by.
+  const float_t rotationSpeedY;
 
 public:
   DummyEnemyModel(const std::string &modelId)
@@ -28,8 +27,11 @@ public:
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.1f, 0.1f, 0.1f),
             ColliderShapeType::SPHERE),
-        rotationSpeedY(-1.0f),
-        lastTime(glfwGetTime()) {}
+        rotationSpeedY(-1.0f)
+  {
+    // The enemy only spins in the vertex shaders, so its collider never moves once it is placed.
+    getColliderDetails()->setColliderMotion(ColliderMotion::STATIC);
+  }
 
   static void initModel()
   {
@@ -50,14 +52,16 @@ public:
     return std::make_shared<DummyEnemyModel>(modelId);
   }
 
-  void update() override
+  glm::vec2 getRenderSpin() const override
   {
-    const auto currentTime = glfwGetTime();
-    const auto deltaTime = currentTime - lastTime;
-
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
+    // The enemy only spins in place, which its sphere collider doesn't change with.
+    return glm::vec2(0.0f, -rotationSpeedY);
+  }
 
-    lastTime = currentTime;
+  UpdateFrequency getUpdateFrequency() const override
+  {
+    // The enemy has nothing to update, with the vertex shaders spinning it.
+    return UpdateFrequency::EVENT_DRIVEN;
   }
 };
 
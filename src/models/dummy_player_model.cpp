@@ -22,16 +22,13 @@ class DummyPlayerModel : public ModelBase<DummyPlayerModel>
 private:
   float_t rotationSpeedY;
 
-  float_t lastTime;
-
 public:
   DummyPlayerModel(const std::string &modelId)
       : ModelBase(
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(glm::pi<float_t>() / 2.0f, 0.0f, 0.0f), glm::vec3(0.075f, 0.075f, 0.075f),
             ColliderShapeType::BOX),
-        rotationSpeedY(-1.0f),
-        lastTime(glfwGetTime()) {}
+        rotationSpeedY(-1.0f) {}
 
   static void initModel()
   {
@@ -39,7 +36,8 @@ public:
         "DummyPlayer",
         "assets/objects/spaceship.obj",
         "assets/textures/spaceship.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl");
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl",
+        MeshVertexFormat::COMPACT);
   }
 
   static void deinitModel()
@@ -52,14 +50,21 @@ public:
     return std::make_shared<DummyPlayerModel>(modelId);
   }
 
-  void update() override
+  UpdateFrequency getUpdateFrequency() const override
   {
-    const auto currentTime = glfwGetTime();
-    const auto deltaTime = currentTime - lastTime;
+    // The player only turns slowly in the menus, which a few updates a second are smooth enough for once they're
+    //   rendered between them.
+    return UpdateFrequency::EVERY_NTH_STEP;
+  }
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
+  uint32_t getUpdateInterval() const override
+  {
+    return 4;
+  }
 
-    lastTime = currentTime;
+  void update(const FrameTime &frameTime) override
+  {
+    rotateModel(glm::angleAxis(-rotationSpeedY * frameTime.delta, glm::vec3(0.0f, 1.0f, 0.0f)));
   }
 };
 
@@ -21,16 +21,13 @@ class DummyShotModel : public ModelBase<DummyShotModel>
 private:
   float_t rotationSpeedY;
 
-  float_t lastTime;
-
 public:
   DummyShotModel(const std::string &modelId)
       : ModelBase(
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3((-1.0f * glm::pi<float_t>()) / 2, 0.0f, 0.0f), glm::vec3(0.01f, 0.01f, 0.01f),
             ColliderShapeType::BOX),
-        rotationSpeedY(-1.0f),
-        lastTime(glfwGetTime()) {}
+        rotationSpeedY(-1.0f) {}
 
   static void initModel()
   {
@@ -38,7 +35,8 @@ public:
         "DummyShot",
         "assets/objects/shot.obj",
         "assets/textures/shot.bmp",
-        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl");
+        "assets/shaders/vertex/unlit.glsl", "assets/shaders/fragment/unlit.glsl",
+        MeshVertexFormat::COMPACT);
   }
 
   static void deinitModel()
@@ -51,14 +49,27 @@ public:
     return std::make_shared<DummyShotModel>(modelId);
   }
 
-  void update() override
+  bool castsShadows() const override
+  {
+    // The shots are too small for their shadows to be seen.
+    return false;
+  }
+
+  UpdateFrequency getUpdateFrequency() const override
   {
-    const auto currentTime = glfwGetTime();
-    const auto deltaTime = currentTime - lastTime;
+    // The shot only turns slowly in the menus, which a few updates a second are smooth enough for once they're
+    //   rendered between them.
+    return UpdateFrequency::EVERY_NTH_STEP;
+  }
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
+  uint32_t getUpdateInterval() const override
+  {
+    return 4;
+  }
 
-    lastTime = currentTime;
+  void update(const FrameTime &frameTime) override
+  {
+    rotateModel(glm::angleAxis(-rotationSpeedY * frameTime.delta, glm::vec3(0.0f, 1.0f, 0.0f)));
   }
 };
 
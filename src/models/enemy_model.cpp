@@ -20,22 +20,33 @@
 class EnemyModel : public ModelBase<EnemyModel>
 {
 private:
-  static std::mt19937 mtGenerator;
-  static std::uniform_real_distribution<float_t> mtInitialRotationDistribution;
-  static std::uniform_real_distribution<float_t> mtRotationSpeedDistribution;
+  // The random number generator and distributions of the enemies, one for each thread, so the games simulated side by
+  //   side each create their enemies from their own seed.
+  static thread_local std::mt19937 mtGenerator;
+  static thread_local std::uniform_real_distribution<float_t> mtInitialRotationDistribution;
+  static thread_local std::uniform_real_distribution<float_t> mtRotationSpeedDistribution;
 
-  float_t rotationSpeedY;
+  // The event bus the model spawns and destroys models through, so it can update and react without touching the models.
+  EventBus &eventBus;
 
-  float_t lastTime;
+  // The angle the enemy is turned by at time 0, and the speed it spins at, which the vertex shaders turn it by.
+  const float_t spinPhase;
+  const float_t rotationSpeedY;
 
 public:
   EnemyModel(const std::string &modelId)
       : ModelBase(
             modelId,
-            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, mtInitialRotationDistribution(mtGenerator), 0.0f), glm::vec3(1.0f, 1.0f, 1.0f),
+            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f),
             ColliderShapeType::SPHERE),
-        rotationSpeedY(mtRotationSpeedDistribution(mtGenerator)),
-        lastTime(glfwGetTime()) {}
+        eventBus(getWorld().getEventBus()),
+        spinPhase(mtInitialRotationDistribution(mtGenerator)),
+        rotationSpeedY(mtRotationSpeedDistribution(mtGenerator))
+  {
+    // The enemies only spin in the vertex shaders, so their colliders never move once they are placed.
+    getColliderDetails()->setColliderMotion(ColliderMotion::STATIC);
+    getColliderDetails()->setCollisionLayers(COLLISION_LAYER_ENEMY);
+  }
 
   static void initModel()
   {
@@ -56,19 +67,63 @@ public:
     return std::make_shared<EnemyModel>(modelId);
   }
 
-  void update() override
+  /**
+   * Seed the random number generator of the initial rotations and rotation speeds of the enemies created on the calling
+   * thread, so the enemies created afterwards are the same every time.
+   *
+   * @param seed  The seed.
+   */
+  static void seedRandomGenerator(const uint32_t &seed)
+  {
+    mtGenerator.seed(seed);
+  }
+
+  glm::vec2 getRenderSpin() const override
   {
-    const auto currentTime = glfwGetTime();
-    const auto deltaTime = currentTime - lastTime;
+    // The enemies only spin in place, which their sphere colliders don't change with, so the vertex shaders spin them
+    //   instead of their transformations being changed every step.
+    return glm::vec2(spinPhase, -rotationSpeedY);
+  }
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, rotationSpeedY * deltaTime, 0.0f));
+  bool isUpdateThreadSafe() const override
+  {
+    // The enemies don't update anything.
+    return true;
+  }
+
+  UpdateFrequency getUpdateFrequency() const override
+  {
+    // The enemies only react to being hit.
+    return UpdateFrequency::EVENT_DRIVEN;
+  }
 
-    lastTime = currentTime;
+  bool hasSpinInvariantShadow() const override
+  {
+    // The saws spin around their own vertical axis, which only moves their teeth around in their shadows.
+    return true;
+  }
+
+  bool hasImpostor() const override
+  {
+    // The enemies are round saws crowding the scene, which look the same from every side they're seen from.
+    return true;
+  }
+
+  void onCollision(const std::shared_ptr<ModelBaseIntf> &) override
+  {
+    // Enemy has been hit by a shot. Destroy the enemy.
+    eventBus.publish(ModelDestroyEvent({getModelHandle()}), getModelHandle().index);
+  }
+
+  void onProjectileHit(const SlotHandle &) override
+  {
+    // Enemy has been hit by a projectile. Destroy the enemy.
+    eventBus.publish(ModelDestroyEvent({getModelHandle()}), getModelHandle().index);
   }
 };
 
-std::mt19937 EnemyModel::mtGenerator = std::mt19937(std::clock());
-std::uniform_real_distribution<float_t> EnemyModel::mtInitialRotationDistribution = std::uniform_real_distribution<float_t>(0.0f, glm::radians(359.99f));
-std::uniform_real_distribution<float_t> EnemyModel::mtRotationSpeedDistribution = std::uniform_real_distribution<float_t>(glm::radians(30.0f), glm::radians(180.0f));
+thread_local std::mt19937 EnemyModel::mtGenerator = std::mt19937(std::clock());
+thread_local std::uniform_real_distribution<float_t> EnemyModel::mtInitialRotationDistribution = std::uniform_real_distribution<float_t>(0.0f, glm::radians(359.99f));
+thread_local std::uniform_real_distribution<float_t> EnemyModel::mtRotationSpeedDistribution = std::uniform_real_distribution<float_t>(glm::radians(30.0f), glm::radians(180.0f));
 
 #endif
\ No newline at end of file
@@ -18,6 +18,10 @@
 #include "../include/texture.cpp"
 #include "../include/shader.cpp"
 #include "../include/collider.cpp"
+#include "../include/constants.cpp"
+#include "../include/world.cpp"
+#include "../include/profiler.cpp"
+#include "../include/memory.cpp"
 
 #include "model_base_intf.cpp"
 
@@ -31,6 +35,8 @@ class ModelBase : public ModelBaseIntf
 private:
   // The name of the model.
   inline static std::string modelName;
+  // The name of the colliders of the models.
+  inline static std::string colliderName;
 
   // The object details of the model.
   inline static std::shared_ptr<const ObjectDetails> objectDetails;
@@ -39,45 +45,61 @@ private:
   // The shader program details of the model.
   inline static std::shared_ptr<const ShaderDetails> shaderDetails;
 
-  // The ID of the model.
-  const std::string modelId;
+  // The ID of the model, kept for finding the model by name and for debugging, shared with the models given the same ID.
+  const std::string &modelId;
+  // The handle of the model in the model manager, which is invalid while the model isn't registered.
+  SlotHandle modelHandle;
 
-  // The position of the model.
-  glm::vec3 position;
-  // The rotation of the model.
-  glm::vec3 rotation;
-  // The scale of the model.
-  glm::vec3 scale;
+  // The world the model was created in, and its transform manager storing the transformations of the models.
+  World &world;
+  TransformManager &transformManager;
+  // The index of the position, rotation, scale, and model matrix of the model in the transform manager.
+  const uint32_t transformIndex;
 
-  // The model matrix of the model.
-  glm::mat4 modelMatrix;
+  // The collider details of the model, with the collider shape kept in them, which the collider follows the model by.
+  mutable ColliderDetails colliderDetails;
+  // Whether the transformations of the model changed since the collider was last moved to them.
+  mutable bool colliderStale;
 
-  // The collider details of the model.
-  std::shared_ptr<ColliderDetails> colliderDetails;
+  // The number of times the transformations of the model have changed, used to detect when cached renders are stale.
+  uint64_t changeGeneration;
+  // The mask of the render layers of the model.
+  uint32_t renderLayers;
 
   /**
-   * Create the model matrix of the madel.
+   * Mark the transformations of the model as changed. The model matrix is rebuilt by the next pass of the transform
+   *   manager, and the collider follows the next time it is asked for.
    */
-  glm::mat4 createModelMatrix()
+  void markTransformationsChanged()
   {
-    // Calculate and return the model matrix using the position, rotation, and scaling values of the model.
-    return glm::translate(position) * glm::toMat4(glm::quat(rotation)) * glm::scale(scale);
+    colliderStale = true;
+    changeGeneration++;
   }
 
-  const std::shared_ptr<ColliderDetails> createColliderDetails(const ColliderShapeType &colliderShapeType)
+  ColliderDetails createColliderDetails(const ColliderShapeType &colliderShapeType)
   {
-    // Get the vertices of the model.
-    auto modelVertices = objectDetails->getVertices();
+    const auto &position = getModelPosition();
+    const auto &rotation = getModelOrientation();
+    const auto &scale = getModelScale();
+    // The bounds the colliders are made from are calculated once with the object, so every model of it shares them
+    //   instead of going through its vertices again.
+    const auto &boundsMin = objectDetails->getBoundsMin();
+    const auto &boundsMax = objectDetails->getBoundsMax();
     // Check what collider shape is required,
     switch (colliderShapeType)
     {
     case BOX:
       // Create a box collider for the model.
-      return std::make_shared<ColliderDetails>(modelName + "::Collider", std::make_shared<BoxColliderShape>(position, rotation, scale, modelVertices));
-      break;
+      return ColliderDetails(colliderName, std::in_place_type<BoxColliderShape>, position, rotation, scale, boundsMin, boundsMax);
+    case CYLINDER:
+      // Create a cylinder collider for the model.
+      return ColliderDetails(colliderName, std::in_place_type<CylinderColliderShape>, position, rotation, scale, objectDetails->getAxisRadius(), std::max(std::abs(boundsMin.y), std::abs(boundsMax.y)));
+    case PILL:
+      // Create a pill collider for the model.
+      return ColliderDetails(colliderName, std::in_place_type<PillColliderShape>, position, rotation, scale, objectDetails->getAxisRadius(), objectDetails->getPillHalfHeight());
     default:
       // Create a sphere collider for the model.
-      return std::make_shared<ColliderDetails>(modelName + "::Collider", std::make_shared<SphereColliderShape>(position, rotation, scale, modelVertices));
+      return ColliderDetails(colliderName, std::in_place_type<SphereColliderShape>, position, rotation, scale, objectDetails->getBoundingRadius());
     }
   }
 
@@ -85,43 +107,56 @@ protected:
   ModelBase(
       const std::string &modelId,
       const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scale,
-      const std::shared_ptr<ColliderShape> &colliderShape)
-      : modelId(modelId),
-        position(position),
-        rotation(rotation),
-        scale(scale),
-        modelMatrix(createModelMatrix()),
-        colliderDetails(std::make_shared<ColliderDetails>(modelName + "::Collider", colliderShape))
+      const ColliderShapeType &colliderShapeType)
+      : modelId(internModelId(modelId)),
+        modelHandle({0, 0}),
+        world(World::getCurrent()),
+        transformManager(world.getTransformManager()),
+        transformIndex(transformManager.createTransform(position, glm::quat(rotation), scale)),
+        colliderDetails(createColliderDetails(colliderShapeType)),
+        colliderStale(false),
+        changeGeneration(0),
+        renderLayers(DEFAULT_RENDER_LAYERS)
   {
+    // Count the model against the memory of the models, collider included since it is kept inside the model.
+    MemoryManager::getInstance().addCpuSize(MemorySubsystem::MODELS, int64_t(sizeof(T)));
   }
 
-  ModelBase(
-      const std::string &modelId,
-      const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scale,
-      const ColliderShapeType &colliderShapeType)
-      : modelId(modelId),
-        position(position),
-        rotation(rotation),
-        scale(scale),
-        modelMatrix(createModelMatrix()),
-        colliderDetails(createColliderDetails(colliderShapeType))
+  ~ModelBase()
   {
+    transformManager.destroyTransform(transformIndex);
+    MemoryManager::getInstance().addCpuSize(MemorySubsystem::MODELS, -int64_t(sizeof(T)));
   }
 
   /**
-   * Initialize the base model dependencies
+   * Initialize the base model dependencies. The dense objects drawn into many shadow map faces can ask for the compact
+   * vertex format, halving the vertex data read by every pass.
    */
   static void initModelDeps(
       const std::string &modelName,
       const std::string &modelObjectFilePath,
       const std::string &modelTextureFilePath,
-      const std::string &modelVertexShaderFilePath, const std::string &modelFragmentShaderFilePath)
+      const std::string &modelVertexShaderFilePath, const std::string &modelFragmentShaderFilePath,
+      const MeshVertexFormat &modelVertexFormat = MeshVertexFormat::FULL)
   {
-    objectDetails = objectManager.createObject(modelName + "::Object", modelObjectFilePath);
-    textureDetails = textureManager.create2dTexture(modelName + "::Texture", modelTextureFilePath);
-    shaderDetails = shaderManager.createShaderProgram(modelName + "::Shader", modelVertexShaderFilePath, modelFragmentShaderFilePath);
+    // Load the object and texture in the background, the scene waits for them before using the model. The managers of
+    //   the assets are only asked for here, so a model type that's never initialized doesn't create them.
+    ObjectManager::getInstance().createObjectAsync(
+        modelName + "::Object", modelObjectFilePath, [](const std::shared_ptr<const ObjectDetails> &loadedObjectDetails) {
+          objectDetails = loadedObjectDetails;
+        },
+        modelVertexFormat);
+    // A headless game only simulates the model, which needs the bounds of its object but not its texture or shader.
+    if (!HEADLESS_ENABLED)
+    {
+      TextureManager::getInstance().create2dTextureAsync(modelName + "::Texture", modelTextureFilePath, [](const std::shared_ptr<const TextureDetails> &loadedTextureDetails) {
+        textureDetails = loadedTextureDetails;
+      });
+      shaderDetails = ShaderManager::getInstance().createShaderProgram(modelName + "::Shader", modelVertexShaderFilePath, modelFragmentShaderFilePath);
+    }
 
     ModelBase::modelName = modelName;
+    ModelBase::colliderName = modelName + "::Collider";
   }
 
   /**
@@ -130,11 +165,24 @@ protected:
   static void deinitModelDeps()
   {
     // Destroy the object for the model.
-    objectManager.destroyObject(objectDetails);
-    // Destroy the texture for the model.
-    textureManager.destroyTexture(textureDetails);
-    // Destroy the shader program for the model.
-    shaderManager.destroyShaderProgram(shaderDetails);
+    ObjectManager::getInstance().destroyObject(objectDetails);
+    if (!HEADLESS_ENABLED)
+    {
+      // Destroy the texture for the model.
+      TextureManager::getInstance().destroyTexture(textureDetails);
+      // Destroy the shader program for the model.
+      ShaderManager::getInstance().destroyShaderProgram(shaderDetails);
+    }
+  }
+
+  /**
+   * Get the world the model was created in, whose managers the model is registered into.
+   * 
+   * @return The world of the model.
+   */
+  World &getWorld() const
+  {
+    return world;
   }
 
 public:
@@ -148,16 +196,75 @@ public:
     return modelId;
   }
 
+  /**
+   * Get the handle of the model in the model manager.
+   * 
+   * @return The model handle.
+   */
+  const SlotHandle &getModelHandle() const
+  {
+    return modelHandle;
+  }
+
+  /**
+   * Set the handle of the model in the model manager, done by the model manager when the model is registered.
+   * 
+   * @param newModelHandle  The model handle.
+   */
+  void setModelHandle(const SlotHandle &newModelHandle)
+  {
+    modelHandle = newModelHandle;
+  }
+
   /**
    * Get the name of the model.
    * 
    * @return The model name.
    */
-  std::string getModelName() const
+  const std::string &getModelName() const
   {
     return modelName;
   }
 
+  /**
+   * Get the type ID of the model, which is the same for all the models of the same class.
+   * 
+   * @return The model type ID.
+   */
+  size_t getModelTypeId() const
+  {
+    return ModelBaseIntf::getTypeId<T>();
+  }
+
+  /**
+   * Update a run of models of the type one after the other, calling the update of the type directly, since all of them
+   *   are known to be of it.
+   * 
+   * @param models       The models to update, all of the type.
+   * @param frameTimes   The time of the frame of each of the models.
+   * @param updateTimes  The list to store the time each of the models took to update to.
+   * @param modelsCount  The number of models to update.
+   */
+  static void updateModels(const std::shared_ptr<ModelBaseIntf> *models, const FrameTime *frameTimes, double *updateTimes, const size_t &modelsCount)
+  {
+    for (size_t i = 0; i < modelsCount; i++)
+    {
+      ProfileZone modelZone(modelName);
+      static_cast<T &>(*models[i]).T::update(frameTimes[i]);
+      updateTimes[i] = modelZone.end();
+    }
+  }
+
+  /**
+   * Get the function updating the models of the type of the model.
+   * 
+   * @return The function updating the models of the type.
+   */
+  UpdateModelsFunction getUpdateModelsFunction() const
+  {
+    return &ModelBase<T>::updateModels;
+  }
+
   /**
    * Get the position of the model.
    * 
@@ -165,17 +272,27 @@ public:
    */
   const glm::vec3 &getModelPosition() const
   {
-    return position;
+    return transformManager.getPosition(transformIndex);
   }
 
   /**
-   * Get the rotation of the model.
+   * Get the rotation of the model, as euler angles worked out from its orientation.
    * 
    * @return The model rotation.
    */
-  const glm::vec3 &getModelRotation() const
+  glm::vec3 getModelRotation() const
   {
-    return rotation;
+    return glm::eulerAngles(getModelOrientation());
+  }
+
+  /**
+   * Get the orientation of the model.
+   * 
+   * @return The model orientation.
+   */
+  const glm::quat &getModelOrientation() const
+  {
+    return transformManager.getRotation(transformIndex);
   }
 
   /**
@@ -185,7 +302,7 @@ public:
    */
   const glm::vec3 &getModelScale() const
   {
-    return scale;
+    return transformManager.getScale(transformIndex);
   }
 
   /**
@@ -219,23 +336,103 @@ public:
   }
 
   /**
-   * Get the collider details of the model.
+   * Get the collider details of the model, moving the collider to the transformations of the model first if they
+   *   changed since it was last asked for.
    * 
    * @return The model collider details.
    */
-  const std::shared_ptr<ColliderDetails> &getColliderDetails() const
+  ColliderDetails *getColliderDetails() const
   {
-    return colliderDetails;
+    if (colliderStale)
+    {
+      // Update the collider with the new transformation details, sharing the model matrix with it.
+      colliderDetails.getColliderShape()->updateTransformations(getModelPosition(), getModelOrientation(), getModelScale(), getModelMatrix());
+      colliderStale = false;
+    }
+    return &colliderDetails;
   }
 
   /**
-   * Get the model matrix of the model.
+   * Get the model matrix of the model, which is built right away if the transform manager hasn't rebuilt it since the
+   *   model last moved.
    * 
    * @return The model matrix.
    */
   const glm::mat4 &getModelMatrix() const
   {
-    return modelMatrix;
+    return transformManager.getMatrix(transformIndex);
+  }
+
+  /**
+   * Get the model matrix to render the model with, between where the model was at the previous and the latest
+   *   simulation step.
+   * 
+   * @return The model matrix to render with.
+   */
+  const glm::mat4 &getRenderMatrix() const
+  {
+    return transformManager.getRenderMatrix(transformIndex);
+  }
+
+  /**
+   * Render the model where it is now until the next simulation step, instead of moving it there from where it was.
+   */
+  void resetRenderInterpolation()
+  {
+    transformManager.resetPreviousTransform(transformIndex);
+  }
+
+  /**
+   * Render the model between where it was at its previous and its latest update, over the given number of simulation
+   *   steps between its updates, instead of between the previous and the latest step.
+   * 
+   * @param interval  The number of steps between the updates of the model.
+   * @param phase     The number of steps the updates of the model are shifted by.
+   */
+  void setUpdateSchedule(const uint32_t &interval, const uint32_t &phase)
+  {
+    transformManager.setUpdateSchedule(transformIndex, interval, phase);
+  }
+
+  /**
+   * Get the change generation of the model, which increases every time the transformations of the model change.
+   * 
+   * @return The model change generation.
+   */
+  const uint64_t &getChangeGeneration() const
+  {
+    return changeGeneration;
+  }
+
+  /**
+   * Get the render generation of the model, which increases every time the transformations of the model or the model
+   *   matrix it's rendered with between the simulation steps change.
+   * 
+   * @return The model render generation.
+   */
+  uint64_t getRenderGeneration() const
+  {
+    return changeGeneration + transformManager.getRenderGeneration(transformIndex);
+  }
+
+  /**
+   * Get the mask of the render layers of the model, which the camera views pick the models they draw by.
+   * 
+   * @return The model render layers.
+   */
+  const uint32_t &getRenderLayers() const
+  {
+    return renderLayers;
+  }
+
+  /**
+   * Set the mask of the render layers of the model.
+   * 
+   * @param newRenderLayers  The model render layers.
+   */
+  void setRenderLayers(const uint32_t &newRenderLayers)
+  {
+    renderLayers = newRenderLayers;
   }
 
   /**
@@ -246,11 +443,9 @@ public:
   void setModelPosition(const glm::vec3 &newPosition)
   {
     // Set the new position.
-    position = newPosition;
-    // Update the collider with the new transformation details
-    colliderDetails->getColliderShape()->updateTransformations(newPosition, rotation, scale);
-    // Update the model matrix.
-    modelMatrix = createModelMatrix();
+    transformManager.setPosition(transformIndex, newPosition);
+    // Mark the model as changed.
+    markTransformationsChanged();
   }
 
   /**
@@ -260,12 +455,34 @@ public:
    */
   void setModelRotation(const glm::vec3 &newRotation)
   {
-    // Set the new rotation.
-    rotation = newRotation;
-    // Update the collider with the new transformation details
-    colliderDetails->getColliderShape()->updateTransformations(position, newRotation, scale);
-    // Update the model matrix.
-    modelMatrix = createModelMatrix();
+    setModelOrientation(glm::quat(newRotation));
+  }
+
+  /**
+   * Set the orientation of the model.
+   * 
+   * @param newOrientation  The model orientation.
+   */
+  void setModelOrientation(const glm::quat &newOrientation)
+  {
+    // Set the new orientation.
+    transformManager.setRotation(transformIndex, newOrientation);
+    // Mark the model as changed.
+    markTransformationsChanged();
+  }
+
+  /**
+   * Turn the model by the given rotation around the axes of the world, which takes no trig, unlike changing its euler
+   *   angles.
+   * 
+   * @param rotation  The rotation to turn the model by.
+   */
+  void rotateModel(const glm::quat &rotation)
+  {
+    // Turn the model.
+    transformManager.rotate(transformIndex, rotation);
+    // Mark the model as changed.
+    markTransformationsChanged();
   }
 
   /**
@@ -276,11 +493,9 @@ public:
   void setModelScale(const glm::vec3 &newScale)
   {
     // Set the new scale.
-    scale = newScale;
-    // Update the collider with the new transformation details
-    colliderDetails->getColliderShape()->updateTransformations(position, rotation, newScale);
-    // Update the model matrix.
-    modelMatrix = createModelMatrix();
+    transformManager.setScale(transformIndex, newScale);
+    // Mark the model as changed.
+    markTransformationsChanged();
   }
 };
 
@@ -7,6 +7,9 @@
 #include <memory>
 #include <algorithm>
 #include <iterator>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -18,6 +21,22 @@
 #include "../include/texture.cpp"
 #include "../include/shader.cpp"
 #include "../include/collider.cpp"
+#include "../include/slot_map.cpp"
+#include "../include/frame_time.cpp"
+
+/**
+ * Enum for how often the model manager updates a model.
+ */
+enum class UpdateFrequency
+{
+  // Every step of the simulation, or every frame in the scenes without simulation steps.
+  EVERY_STEP,
+  // Every few steps, as many as the update interval of the model, with the models of the same interval spread over the
+  //   steps by their handles, so their updates are split evenly between the steps.
+  EVERY_NTH_STEP,
+  // Never by the steps, with the model only reacting to the collisions, the hits and the events it gets.
+  EVENT_DRIVEN
+};
 
 /**
  * Base class for creating models.
@@ -25,15 +44,50 @@
 class ModelBaseIntf
 {
 
+private:
+  // The number of model types given a type ID so far, which the threads simulating games side by side can add to at once.
+  inline static std::atomic<size_t> modelTypesCount{0};
+
+  // The IDs given to the models so far, each kept once however many models are given it, so the models refer to their
+  //   ID instead of each carrying a copy of it. The strings of a set don't move as it grows.
+  inline static std::unordered_set<std::string> modelIds;
+  // The lock guarding the IDs, since the models of the games simulated side by side are created at once.
+  inline static std::mutex modelIdsMutex;
+
 protected:
-  // The object manager responsible for creating objects.
-  static ObjectManager &objectManager;
-  // The texture manager responsible for creating textures.
-  static TextureManager &textureManager;
-  // The shader manager responsible for creating shader programs.
-  static ShaderManager &shaderManager;
+  /**
+   * Get the kept copy of the model ID, keeping it the first time it is given to a model.
+   * 
+   * @param modelId  The model ID.
+   * 
+   * @return The kept model ID, which is never freed.
+   */
+  static const std::string &internModelId(const std::string &modelId)
+  {
+    std::lock_guard<std::mutex> modelIdsLock(modelIdsMutex);
+    return *modelIds.insert(modelId).first;
+  }
 
 public:
+  /**
+   * Get the type ID of the given model type, handing out the next ID to each type the first time it is asked for.
+   * 
+   * @return The type ID of the model type.
+   */
+  template <typename T>
+  static size_t getTypeId()
+  {
+    static const size_t typeId = modelTypesCount.fetch_add(1, std::memory_order_relaxed);
+    return typeId;
+  }
+
+  /**
+   * Get the type ID of the model, which is the same for all the models of the same class.
+   * 
+   * @return The model type ID.
+   */
+  virtual size_t getModelTypeId() const = 0;
+
   /**
    * Get the ID of the model.
    * 
@@ -41,12 +95,26 @@ public:
    */
   virtual const std::string &getModelId() const = 0;
 
+  /**
+   * Get the handle of the model in the model manager.
+   * 
+   * @return The model handle.
+   */
+  virtual const SlotHandle &getModelHandle() const = 0;
+
+  /**
+   * Set the handle of the model in the model manager, done by the model manager when the model is registered.
+   * 
+   * @param newModelHandle  The model handle.
+   */
+  virtual void setModelHandle(const SlotHandle &newModelHandle) = 0;
+
   /**
    * Get the name of the model.
    * 
    * @return The model name.
    */
-  virtual std::string getModelName() const = 0;
+  virtual const std::string &getModelName() const = 0;
 
   /**
    * Get the position of the model.
@@ -56,11 +124,18 @@ public:
   virtual const glm::vec3 &getModelPosition() const = 0;
 
   /**
-   * Get the rotation of the model.
+   * Get the rotation of the model, as euler angles.
    * 
    * @return The model rotation.
    */
-  virtual const glm::vec3 &getModelRotation() const = 0;
+  virtual glm::vec3 getModelRotation() const = 0;
+
+  /**
+   * Get the orientation of the model.
+   * 
+   * @return The model orientation.
+   */
+  virtual const glm::quat &getModelOrientation() const = 0;
 
   /**
    * Get the scale of the model.
@@ -95,7 +170,7 @@ public:
    * 
    * @return The model collider details.
    */
-  virtual const std::shared_ptr<ColliderDetails> &getColliderDetails() const = 0;
+  virtual ColliderDetails *getColliderDetails() const = 0;
 
   /**
    * Get the model matrix of the model.
@@ -104,6 +179,102 @@ public:
    */
   virtual const glm::mat4 &getModelMatrix() const = 0;
 
+  /**
+   * Get the model matrix to render the model with, between where the model was at the previous and the latest
+   *   simulation step.
+   * 
+   * @return The model matrix to render with.
+   */
+  virtual const glm::mat4 &getRenderMatrix() const = 0;
+
+  /**
+   * Render the model where it is now until the next simulation step, instead of moving it there from where it was.
+   */
+  virtual void resetRenderInterpolation() = 0;
+
+  /**
+   * Render the model between where it was at its previous and its latest update, over the given number of simulation
+   *   steps between its updates, instead of between the previous and the latest step.
+   * 
+   * @param interval  The number of steps between the updates of the model.
+   * @param phase     The number of steps the updates of the model are shifted by.
+   */
+  virtual void setUpdateSchedule(const uint32_t &interval, const uint32_t &phase) = 0;
+
+  /**
+   * Get the spin the model is rendered with around its own vertical axis, which the vertex shaders turn it by at the
+   *   time of each frame, so purely cosmetic spinning doesn't change the transformations or the collider of the model.
+   *   Only models whose colliders don't turn with them, like spheres, can spin this way.
+   * 
+   * @return The angle the model is turned by at time 0 (x) and the speed it turns at in radians per second (y).
+   */
+  virtual glm::vec2 getRenderSpin() const
+  {
+    return glm::vec2(0.0f);
+  }
+
+  /**
+   * Check if the model is drawn into the shadow maps of the lights, which the models too small or too flat for their
+   *   shadows to be seen opt out of, for every model of their type.
+   * 
+   * @return Whether the model casts shadows.
+   */
+  virtual bool castsShadows() const
+  {
+    return true;
+  }
+
+  /**
+   * Check if the shadow of the model stays about the same while it spins in the vertex shaders, which lets a shadow map
+   *   keep the model in its cached static casters while it spins in place, instead of rendering it again every frame.
+   * 
+   * @return Whether the spin of the model can be left out of its shadow.
+   */
+  virtual bool hasSpinInvariantShadow() const
+  {
+    return false;
+  }
+
+  /**
+   * Check if the model is drawn as an impostor once it's only a few pixels on the screen, showing its object pre-rendered
+   *   from around its vertical axis, which only models looking about the same from above as from the side should be.
+   * 
+   * @return Whether the model has an impostor.
+   */
+  virtual bool hasImpostor() const
+  {
+    return false;
+  }
+
+  /**
+   * Get the change generation of the model, which increases every time the transformations of the model change.
+   * 
+   * @return The model change generation.
+   */
+  virtual const uint64_t &getChangeGeneration() const = 0;
+
+  /**
+   * Get the render generation of the model, which increases every time the transformations of the model or the model
+   *   matrix it's rendered with between the simulation steps change.
+   * 
+   * @return The model render generation.
+   */
+  virtual uint64_t getRenderGeneration() const = 0;
+
+  /**
+   * Get the mask of the render layers of the model, which the camera views pick the models they draw by.
+   * 
+   * @return The model render layers.
+   */
+  virtual const uint32_t &getRenderLayers() const = 0;
+
+  /**
+   * Set the mask of the render layers of the model.
+   * 
+   * @param newRenderLayers  The model render layers.
+   */
+  virtual void setRenderLayers(const uint32_t &newRenderLayers) = 0;
+
   /**
    * Set the position of the model.
    * 
@@ -112,12 +283,26 @@ public:
   virtual void setModelPosition(const glm::vec3 &newPosition) = 0;
 
   /**
-   * Set the rotation of the model.
+   * Set the rotation of the model, as euler angles.
    * 
    * @param newRotation  The model rotation.
    */
   virtual void setModelRotation(const glm::vec3 &newRotation) = 0;
 
+  /**
+   * Set the orientation of the model.
+   * 
+   * @param newOrientation  The model orientation.
+   */
+  virtual void setModelOrientation(const glm::quat &newOrientation) = 0;
+
+  /**
+   * Turn the model by the given rotation around the axes of the world.
+   * 
+   * @param rotation  The rotation to turn the model by.
+   */
+  virtual void rotateModel(const glm::quat &rotation) = 0;
+
   /**
    * Set the scale of the model.
    * 
@@ -131,18 +316,84 @@ public:
   virtual void init() {}
 
   /**
-   * De-initialize the model once de-registered.
+   * De-initialize the model, once it was destroyed and the de-registered models are removed, or when the scene
+   *   de-initializes all its models.
    */
   virtual void deinit() {}
 
   /**
    * Update the model during the update step before starting rendering.
+   * 
+   * @param frameTime  The time of the frame.
    */
-  virtual void update() {}
-};
+  virtual void update(const FrameTime &) {}
 
-ObjectManager &ModelBaseIntf::objectManager = ObjectManager::getInstance();
-TextureManager &ModelBaseIntf::textureManager = TextureManager::getInstance();
-ShaderManager &ModelBaseIntf::shaderManager = ShaderManager::getInstance();
+  /**
+   * Function updating a run of models of the same type one after the other, each with the time of its own frame,
+   *   storing the time each of them took to update.
+   */
+  typedef void (*UpdateModelsFunction)(const std::shared_ptr<ModelBaseIntf> *models, const FrameTime *frameTimes, double *updateTimes, const size_t &modelsCount);
+
+  /**
+   * Get the function updating the models of the type of the model, which calls the update of the type directly instead
+   *   of through the virtual update of each model, so it can be inlined into the loop.
+   * 
+   * @return The function updating the models of the type.
+   */
+  virtual UpdateModelsFunction getUpdateModelsFunction() const = 0;
+
+  /**
+   * Check whether the update of the model can run in parallel with the updates of other models, which is only the case
+   *   if it touches nothing but the model itself, and doesn't register or de-register any models.
+   * 
+   * @return Whether the update of the model is thread-safe.
+   */
+  virtual bool isUpdateThreadSafe() const
+  {
+    return false;
+  }
+
+  /**
+   * Get how often the model is updated, which is every step unless the model does little enough in its updates to do
+   *   it less often, or nothing at all.
+   * 
+   * @return The update frequency of the model.
+   */
+  virtual UpdateFrequency getUpdateFrequency() const
+  {
+    return UpdateFrequency::EVERY_STEP;
+  }
+
+  /**
+   * Get the number of steps between the updates of the model, if it updates every few steps. The time of the frame the
+   *   model is updated with covers all of them.
+   * 
+   * @return The update interval of the model.
+   */
+  virtual uint32_t getUpdateInterval() const
+  {
+    return 1;
+  }
+
+  /**
+   * React to colliding with another model, once the collisions of the frame have been found.
+   * 
+   * @param otherModel  The model collided with.
+   */
+  virtual void onCollision(const std::shared_ptr<ModelBaseIntf> &) {}
+
+  /**
+   * React to being hit by a projectile, once the projectiles of the step have moved.
+   * 
+   * @param ownerHandle  The handle of the model that fired the projectile.
+   */
+  virtual void onProjectileHit(const SlotHandle &) {}
+
+  /**
+   * React to being dropped from the list of models of the model manager after being de-registered, after which the
+   *   model can be registered again, such as by putting it back into a pool.
+   */
+  virtual void onRemoved() {}
+};
 
 #endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef MODELS_MODEL_POOL_CPP
+#define MODELS_MODEL_POOL_CPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+/**
+ * Class for a pool of models that come and go often, such as shots, so the models and everything they own are made
+ *   once and then reused instead of being created and destroyed every time.
+ */
+template <typename T>
+class ModelPool
+{
+private:
+  // The function creating a new model with the given index, used when the pool has no free models.
+  const std::function<std::shared_ptr<T>(const uint32_t &)> createModel;
+
+  // The models free to be reused.
+  std::vector<std::shared_ptr<T>> freeModels;
+  // The number of models the pool created.
+  uint32_t createdModelsCount;
+
+public:
+  /**
+   * Create an empty pool.
+   *
+   * @param createModel  The function creating a new model with the given index, which is unique within the pool.
+   */
+  ModelPool(const std::function<std::shared_ptr<T>(const uint32_t &)> &createModel)
+      : createModel(createModel),
+        freeModels({}),
+        createdModelsCount(0) {}
+
+  /**
+   * Take a model from the pool, creating a new one if none are free. The model is used as it was left when released,
+   *   so it has to be reset before being used again.
+   *
+   * @return The model.
+   */
+  std::shared_ptr<T> acquire()
+  {
+    if (freeModels.empty())
+    {
+      return createModel(createdModelsCount++);
+    }
+    auto model = std::move(freeModels.back());
+    freeModels.pop_back();
+    return model;
+  }
+
+  /**
+   * Put a model back into the pool once it is no longer used.
+   *
+   * @param model  The model.
+   */
+  void release(const std::shared_ptr<T> &model)
+  {
+    freeModels.push_back(model);
+  }
+
+  /**
+   * Destroy all the free models of the pool.
+   */
+  void clear()
+  {
+    freeModels.clear();
+  }
+};
+
+#endif
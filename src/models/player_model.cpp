@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <limits>
 
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -14,6 +15,8 @@
 #include "../include/control.cpp"
 #include "../include/light.cpp"
 #include "../include/models.cpp"
+#include "../include/attachment.cpp"
+#include "../include/projectiles.cpp"
 
 #include "model_base.cpp"
 #include "shot_model.cpp"
@@ -22,57 +25,64 @@
 /**
  * Class that represents a player model.
  */
-class PlayerModel : public ModelBase<PlayerModel>
+class PlayerModel : public ModelBase<PlayerModel>, public std::enable_shared_from_this<PlayerModel>
 {
 private:
   // The speed of movement with key inputs.
   static float_t keyboardSpeed;
+  // The shortest time between two shots, in seconds.
+  static float_t shotInterval;
 
-  // The model manager responsible for managing the models in the scene.
-  ModelManager &modelManager;
+  // The event bus the model spawns and destroys models through, so it can update and react without touching the models.
+  EventBus &eventBus;
   // The light manager responsible for managing the lights in the scene.
   LightManager &lightManager;
+  // The attachment manager moving the eye lights with the player.
+  AttachmentManager &attachmentManager;
+  // The projectile manager the sprays of projectiles are fired into.
+  ProjectileManager &projectileManager;
   // The control manager responsible for managing controls and inputs of the window.
   const ControlManager &controlManager;
 
-  // The timestamp of the last time the update for the camera was started.
-  float_t lastTime;
   // The timestamp of the last time a shot was created.
   float_t lastShot;
-  // The ID of the last created shot.
-  uint32_t shotId;
+  // The timestamp of the last time a burst of projectiles was sprayed, and the number of bursts sprayed, which turns
+  //   the pattern of each burst a little from the last.
+  float_t lastBurst;
+  uint32_t burstsCount;
 
   // Whether to show the eye light or not.
   static bool isEyeLightPresent;
-  // The timestamp for the last time the eye light was toggled.
-  static float_t lastEyeLightChange;
+  // Whether the eye light was asked to be toggled, which the player does on its next update.
+  static bool isEyeLightToggleRequested;
   // The instance of the first eye light for the player.
   std::shared_ptr<ConeLight> eyeLight1;
   // The instance of the second eye light for the player.
   std::shared_ptr<ConeLight> eyeLight2;
+  // The handles of the attachments of the eye lights to the player, so they follow it when it moves.
+  SlotHandle eyeLight1Attachment;
+  SlotHandle eyeLight2Attachment;
 
   /**
-   * Create a new eye light.
-   * 
-   * @param position  The position of the model.
+   * Create the eye lights, attached to the player so they follow it.
    */
-  void createEyeLight(glm::vec3 position)
+  void createEyeLight()
   {
     // Create first eye light and set its properties.
     eyeLight1 = ConeLight::create(getModelId() + "::EyeLight1");
-    eyeLight1->setLightPosition(glm::vec3(position.x + 2.12f, position.y - 0.089f, position.z - 2.5f));
     eyeLight1->setLightAngles(glm::pi<float_t>(), 0.0f);
     eyeLight1->setLightIntensity(350.0f);
+    eyeLight1Attachment = attachmentManager.attachLight(eyeLight1, shared_from_this(), glm::vec3(-2.12f, -0.089f, -2.5f));
     // Register the first eye light.
     eyeLight1->init();
     lightManager.registerLight(eyeLight1);
 
-    // Create first eye light and set its properties.
+    // Create second eye light and set its properties.
     eyeLight2 = ConeLight::create(getModelId() + "::EyeLight2");
-    eyeLight1->setLightPosition(glm::vec3(position.x - 2.12f, position.y - 0.089f, position.z - 2.5f));
     eyeLight2->setLightAngles(glm::pi<float_t>(), 0.0f);
     eyeLight2->setLightIntensity(350.0f);
-    // Register the first eye light.
+    eyeLight2Attachment = attachmentManager.attachLight(eyeLight2, shared_from_this(), glm::vec3(2.12f, -0.089f, -2.5f));
+    // Register the second eye light.
     eyeLight2->init();
     lightManager.registerLight(eyeLight2);
 
@@ -86,40 +96,37 @@ private:
   void destroyEyeLight()
   {
     // Destroy the eye lights.
+    attachmentManager.detach(eyeLight1Attachment);
     eyeLight1->deinit();
     lightManager.deregisterLight(eyeLight1);
+    attachmentManager.detach(eyeLight2Attachment);
     eyeLight2->deinit();
     lightManager.deregisterLight(eyeLight2);
     // Update the eye light toggle.
     isEyeLightPresent = false;
   }
 
-  /**
-   * Update the existing eye light.
-   */
-  void updateEyeLight(const glm::vec3 &newPosition)
-  {
-    // Check if eye light toggle is enabled.
-    if (isEyeLightPresent)
-    {
-      // Update the eye lights.
-      eyeLight1->setLightPosition(glm::vec3(newPosition.x - 2.12f, newPosition.y - 0.089f, newPosition.z - 2.5f));
-      eyeLight2->setLightPosition(glm::vec3(newPosition.x + 2.12f, newPosition.y - 0.089f, newPosition.z - 2.5f));
-    }
-  }
-
 public:
   PlayerModel(const std::string &modelId)
       : ModelBase(
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f),
             ColliderShapeType::BOX),
-        modelManager(ModelManager::getInstance()),
-        lightManager(LightManager::getInstance()),
-        controlManager(ControlManager::getInstance()),
-        lastTime(glfwGetTime()),
-        lastShot(glfwGetTime() - 10.0f),
-        shotId(0) {}
+        eventBus(getWorld().getEventBus()),
+        lightManager(getWorld().getLightManager()),
+        attachmentManager(getWorld().getAttachmentManager()),
+        projectileManager(getWorld().getProjectileManager()),
+        controlManager(getWorld().getControlManager()),
+        lastShot(-std::numeric_limits<float_t>::infinity()),
+        lastBurst(-std::numeric_limits<float_t>::infinity()),
+        burstsCount(0),
+        eyeLight1Attachment({0, 0}),
+        eyeLight2Attachment({0, 0})
+  {
+    // The player is only moved by the controls.
+    getColliderDetails()->setColliderMotion(ColliderMotion::KINEMATIC);
+    getColliderDetails()->setCollisionLayers(COLLISION_LAYER_PLAYER);
+  }
 
   static void initModel()
   {
@@ -127,7 +134,8 @@ public:
         "Player",
         "assets/objects/spaceship.obj",
         "assets/textures/spaceship.bmp",
-        "assets/shaders/vertex/default.glsl", "assets/shaders/fragment/default.glsl");
+        "assets/shaders/vertex/default.glsl", "assets/shaders/fragment/default.glsl",
+        MeshVertexFormat::COMPACT);
   }
 
   static void deinitModel()
@@ -143,6 +151,45 @@ public:
     return std::make_shared<PlayerModel>(modelId);
   }
 
+  /**
+   * Set the shortest time between two shots of the players.
+   * 
+   * @param newShotInterval  The shortest time between two shots, in seconds.
+   */
+  static void setShotInterval(const float_t &newShotInterval)
+  {
+    shotInterval = newShotInterval;
+  }
+
+  /**
+   * Get the shortest time between two shots of the players.
+   * 
+   * @return The shortest time between two shots, in seconds.
+   */
+  static const float_t &getShotInterval()
+  {
+    return shotInterval;
+  }
+
+  /**
+   * Set whether the players create their eye lights when they're initialized.
+   *
+   * @param enabled  Whether the eye lights are created.
+   */
+  static void setEyeLightEnabled(const bool &enabled)
+  {
+    isEyeLightPresent = enabled;
+  }
+
+  /**
+   * Ask for the eye light to be toggled, which the player does on its next update, so a key press toggles it once
+   *   however many simulation steps the frame takes.
+   */
+  static void toggleEyeLight()
+  {
+    isEyeLightToggleRequested = !isEyeLightToggleRequested;
+  }
+
   void init() override
   {
     // Set the rotation of the model.
@@ -152,7 +199,7 @@ public:
     if (isEyeLightPresent)
     {
       // Create the eye lights.
-      createEyeLight(getModelPosition());
+      createEyeLight();
     }
   }
 
@@ -167,28 +214,24 @@ public:
     }
   }
 
-  void update() override
+  void update(const FrameTime &frameTime) override
   {
-    // Get the timestamp for the start of the update.
-    auto currentTime = glfwGetTime();
-    // Get the time difference since the start of the last update.
-    auto deltaTime = currentTime - lastTime;
+    // Get the timestamp for the start of the frame, and the time difference since the start of the last frame.
+    const auto &currentTime = frameTime.now;
+    const auto &deltaTime = frameTime.delta;
 
-    // Check if "J" key was pressed after 500ms since the last eye light toggle.
-    if (controlManager.isKeyPressed(GLFW_KEY_J) && (currentTime - lastEyeLightChange) > 0.5f)
+    // Check if the eye light was asked to be toggled, and create/destroy it accordingly.
+    if (isEyeLightToggleRequested)
     {
-      // "H" key was pressed. Toggle the eye light and create/destroy it accordingly.
-      isEyeLightPresent = !isEyeLightPresent;
       if (isEyeLightPresent)
       {
-        createEyeLight(getModelPosition());
+        destroyEyeLight();
       }
       else
       {
-        destroyEyeLight();
+        createEyeLight();
       }
-      // Update the timestamp for when the eye light was last toggled.
-      lastEyeLightChange = currentTime;
+      isEyeLightToggleRequested = false;
     }
 
     // Get the player position.
@@ -215,35 +258,49 @@ public:
     newPosition = glm::vec3(glm::clamp<float_t>(newPosition.x, -11.0f, 11.0f), glm::clamp<float_t>(newPosition.y, -6.0f, 6.0f), newPosition.z);
     // Update the shot position.
     setModelPosition(newPosition);
-    // Update the eye lights.
-    updateEyeLight(newPosition);
+    // The eye lights are moved with the player by the attachment manager, once all the models have updated.
 
     // Check if "Space" key was pressed after 500ms since the last shot creation.
-    if (controlManager.isKeyPressed(GLFW_KEY_SPACE) && (currentTime - lastShot) > 0.17f)
+    if (controlManager.isKeyPressed(GLFW_KEY_SPACE) && (currentTime - lastShot) > shotInterval)
     {
-      // "Space" was pressed. Create a new shot and set its properties.
-      const auto newShot = ShotModel::create("Shot" + std::to_string(shotId));
+      // "Space" was pressed. Take a shot from the pool and set its properties.
+      const auto newShot = ShotModel::acquire();
       newShot->setModelPosition(glm::vec3(newPosition.x, newPosition.y - 0.05f, newPosition.z - 2.225f));
-      // Register the shot model.
+      // Spawn the shot model, which is registered once the models are done updating.
       newShot->init();
-      modelManager.registerModel(newShot);
+      eventBus.publish(ModelSpawnEvent({newShot}), getModelHandle().index);
 
-      // Increment the next usable shot ID.
-      shotId++;
       // Update the timestamp for when a shot was last created.
       lastShot = currentTime;
     }
 
-    // Set the timestamp for the start of the last update to the starting timestamp of the current update.
-    lastTime = currentTime;
+    // Check if "F" key is held down to spray bursts of projectiles.
+    if (controlManager.isKeyPressed(GLFW_KEY_F) && (currentTime - lastBurst) >= PROJECTILE_BURST_INTERVAL)
+    {
+      // "F" is held. Spray the projectiles of the burst in rings around the front of the player, which only hit enemies.
+      const glm::vec3 burstPosition(newPosition.x, newPosition.y - 0.05f, newPosition.z - 2.225f);
+      const auto ringsCount = 8u, ringSize = PROJECTILE_BURST_SIZE / ringsCount;
+      const auto burstTurn = burstsCount * 0.1f;
+      for (uint32_t i = 0; i < ringsCount * ringSize; i++)
+      {
+        const auto angle = glm::two_pi<float_t>() * (i % ringSize) / ringSize + burstTurn;
+        const auto spread = 0.05f + 0.05f * (i / ringSize);
+        const auto direction = glm::normalize(glm::vec3(std::cos(angle) * spread, std::sin(angle) * spread, -1.0f));
+        projectileManager.fireProjectile(getModelHandle(), burstPosition, direction * PROJECTILE_SPEED, PROJECTILE_LIFETIME, COLLISION_LAYER_ENEMY);
+      }
+      lastBurst = currentTime;
+      burstsCount++;
+    }
   }
 };
 
 // Initialize the keyboard speed static variable.
 float_t PlayerModel::keyboardSpeed = 10.0f;
+// Initialize the shortest time between two shots static variable.
+float_t PlayerModel::shotInterval = 0.17f;
 // Initialize the eye light toggle static variable.
 bool PlayerModel::isEyeLightPresent = true;
-// Initialize the last time the eye light toggle was changed static variable.
-float_t PlayerModel::lastEyeLightChange = -1;
+// Initialize the eye light toggle request static variable.
+bool PlayerModel::isEyeLightToggleRequested = false;
 
 #endif
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include "../include/models.cpp"
 
 #include "model_base.cpp"
+#include "cursor_model.cpp"
 
 /**
  * Class that represents a restart button model.
@@ -32,7 +33,7 @@ private:
 
   bool _isClicked;
 
-  std::shared_ptr<ModelBaseIntf> cursor;
+  std::shared_ptr<CursorModel> cursor;
 
 public:
   RestartModel(const std::string &modelId)
@@ -40,9 +41,13 @@ public:
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), DEFAULT_SCALE,
             ColliderShapeType::BOX),
-        modelManager(ModelManager::getInstance()),
-        controlManager(ControlManager::getInstance()),
-        _isClicked(false) {}
+        modelManager(getWorld().getModelManager()),
+        controlManager(getWorld().getControlManager()),
+        _isClicked(false)
+  {
+    // The cursor picks the menu items by their layer.
+    getColliderDetails()->setCollisionLayers(COLLISION_LAYER_MENU);
+  }
 
   static void initModel()
   {
@@ -73,15 +78,15 @@ public:
 
   void init() override
   {
-    cursor = modelManager.getModel("Cursor");
+    cursor = std::static_pointer_cast<CursorModel>(modelManager.getModel("Cursor"));
   }
 
-  void update() override
+  void update(const FrameTime &) override
   {
-    const auto cursorCollided = DeepCollisionValidator::haveShapesCollided(cursor->getColliderDetails()->getColliderShape(), this->getColliderDetails()->getColliderShape(), false);
-    if (cursorCollided)
+    // The cursor finds the button under it once it moves.
+    if (cursor->getHoveredModelHandle() == getModelHandle())
     {
-      if (controlManager.isMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT))
+      if (controlManager.wasMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT))
       {
         _isClicked = true;
       }
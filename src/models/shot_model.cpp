@@ -12,58 +12,95 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "../include/models.cpp"
+#include "../include/attachment.cpp"
 #include "../include/light.cpp"
 #include "../include/control.cpp"
 
 #include "model_base.cpp"
+#include "model_pool.cpp"
 #include "../light/point_light.cpp"
+#include "../light/glow_light.cpp"
 
 /**
  * Class that represents a shot/bullet model.
  */
-class ShotModel : public ModelBase<ShotModel>
+class ShotModel : public ModelBase<ShotModel>, public std::enable_shared_from_this<ShotModel>
 {
 private:
+  // The pool of shots, which the shots are fired from and put back into once they're removed. Each thread has its own,
+  //   since the shots belong to the world they were created in.
+  static thread_local ModelPool<ShotModel> pool;
+
   // The speed of the shot.
   static double shotSpeed;
   // Whether to show the light or not.
   static bool isShotLightPresent;
-  // The timestamp for the last time the shot light was toggled.
-  static float_t lastShotLightChange;
+  // The number of shot lights that cast shadows.
+  static int32_t shadowedShotLightsCount;
 
-  // The model manager responsible for managing the models in the scene.
-  ModelManager &modelManager;
+  // The event bus the model spawns and destroys models through, so it can update and react without touching the models.
+  EventBus &eventBus;
   // The light manager responsible for managing the lights in the scene.
   LightManager &lightManager;
-  // The control manager responsible for managing controls and inputs of the window.
-  const ControlManager &controlManager;
-
-  float_t rotationSpeedZ;
+  // The attachment manager moving the shot light with the shot.
+  AttachmentManager &attachmentManager;
 
-  // The timestamp of the last time the update for the camera was started.
-  float_t lastTime;
+  // The rotation the shot spins by around the Z axis every update, built once so the updates take no trig.
+  const glm::quat spinStep;
 
-  // The instance of the point light for the shot.
-  std::shared_ptr<PointLight> shotLight;
+  // The instance of the light for the shot, which stays with the shot while it is in the pool unless it casts shadows.
+  std::shared_ptr<LightBase> shotLight;
+  // Whether the shot light is registered with the light manager.
+  bool isShotLightRegistered;
+  // The handle of the attachment of the shot light to the shot, while it is registered.
+  SlotHandle shotLightAttachment;
 
   /**
-   * Create a new shot light.
+   * Show the shot light, creating it first if the shot doesn't have one yet.
    */
   void createShotLight()
   {
-    // Destroy any existing shot light.
-    destroyShotLight();
-
-    // Create shot light and set its properties.
-    shotLight = PointLight::create(getModelId() + "::ShotLight");
-    shotLight->setLightPosition(getModelPosition() + glm::vec3(0.0f, 0.0f, 0.75f));
+    // Check if shot light doesn't exist.
+    if (shotLight == nullptr)
+    {
+      // Create shot light and set its properties. Only the first few shot lights are point lights casting shadows, and
+      //   the rest are glow lights, only lighting the scene through the light clusters without any shadow pass.
+      if (shadowedShotLightsCount < static_cast<int32_t>(SHADOWED_SHOT_LIGHTS_COUNT))
+      {
+        shotLight = PointLight::create(getModelId() + "::ShotLight");
+        shadowedShotLightsCount++;
+        // Shot lights are small, so give them smaller shadow maps.
+        shotLight->setShadowMapScale(0.5f);
+        // Shot lights move every frame, so only refresh a few of their faces each frame, starting with the ones in view.
+        shotLight->setFacesPerUpdate(SHOT_LIGHT_FACES_PER_UPDATE);
+      }
+      else
+      {
+        shotLight = GlowLight::create(getModelId() + "::ShotLight");
+      }
+      shotLight->init();
+    }
 
-    // Register the shot light.
-    shotLight->init();
-    lightManager.registerLight(shotLight);
+    // Register the shot light and attach it to the shot, unless it already is.
+    if (!isShotLightRegistered)
+    {
+      shotLightAttachment = attachmentManager.attachLight(shotLight, shared_from_this(), glm::vec3(0.0f, 0.0f, 0.75f));
+      lightManager.registerLight(shotLight);
+      isShotLightRegistered = true;
+    }
+  }
 
-    // Update the shot light toggle.
-    isShotLightPresent = true;
+  /**
+   * Hide the shot light, keeping it for when the shot is fired again.
+   */
+  void hideShotLight()
+  {
+    if (isShotLightRegistered)
+    {
+      attachmentManager.detach(shotLightAttachment);
+      lightManager.deregisterLight(shotLight);
+      isShotLightRegistered = false;
+    }
   }
 
   /**
@@ -71,16 +108,18 @@ private:
    */
   void destroyShotLight()
   {
+    hideShotLight();
     // Check if shot light exists
     if (shotLight != nullptr)
     {
       // Destroy the shot light.
+      if (shotLight->castsShadows())
+      {
+        shadowedShotLightsCount--;
+      }
       shotLight->deinit();
-      lightManager.deregisterLight(shotLight);
       shotLight = nullptr;
     }
-    // Update the shot light toggle.
-    isShotLightPresent = false;
   }
 
   /**
@@ -91,19 +130,13 @@ private:
     // Check if shot light toggle is enabled.
     if (isShotLightPresent)
     {
-      // check if shot light doesn't exist.
-      if (shotLight == nullptr)
-      {
-        // Create shot light.
-        createShotLight();
-      }
-      // Update the shot light.
-      shotLight->setLightPosition(getModelPosition() + glm::vec3(0.0f, 0.0f, 0.75f));
+      // Show the shot light, creating it first if needed.
+      createShotLight();
     }
     // Check if shot light exists.
     else if (shotLight != nullptr)
     {
-      // Destroy any existing shot light.
+      // Destroy any existing shot light, freeing its shadow map.
       destroyShotLight();
     }
   }
@@ -114,12 +147,23 @@ public:
             modelId,
             glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.075f),
             ColliderShapeType::BOX),
-        modelManager(ModelManager::getInstance()),
-        lightManager(LightManager::getInstance()),
-        controlManager(ControlManager::getInstance()),
-        rotationSpeedZ(glm::radians(5.0f)),
-        lastTime(glfwGetTime()),
-        shotLight(nullptr) {}
+        eventBus(getWorld().getEventBus()),
+        lightManager(getWorld().getLightManager()),
+        attachmentManager(getWorld().getAttachmentManager()),
+        spinStep(glm::angleAxis(-glm::radians(5.0f), glm::vec3(0.0f, 0.0f, 1.0f))),
+        shotLight(nullptr),
+        isShotLightRegistered(false),
+        shotLightAttachment({0, 0})
+  {
+    // The shots only move along their own path.
+    getColliderDetails()->setColliderMotion(ColliderMotion::KINEMATIC);
+    getColliderDetails()->setCollisionLayers(COLLISION_LAYER_SHOT);
+  }
+
+  ~ShotModel()
+  {
+    destroyShotLight();
+  }
 
   static void initModel()
   {
@@ -127,14 +171,25 @@ public:
         "Shot",
         "assets/objects/shot.obj",
         "assets/textures/shot.bmp",
-        "assets/shaders/vertex/shot.glsl", "assets/shaders/fragment/shot.glsl");
+        "assets/shaders/vertex/shot.glsl", "assets/shaders/fragment/shot.glsl",
+        MeshVertexFormat::COMPACT);
   }
 
   static void deinitModel()
   {
+    clearPool();
     ModelBase::deinitModelDeps();
   }
 
+  /**
+   * Destroy the shots left in the pool of the calling thread, along with their lights, which has to be done before the
+   *   world they were created in goes.
+   */
+  static void clearPool()
+  {
+    pool.clear();
+  }
+
   /**
    * Creates a new instance of the shot model.
    */
@@ -143,36 +198,94 @@ public:
     return std::make_shared<ShotModel>(modelId);
   }
 
+  /**
+   * Take a shot from the pool of shots, which is only created if none of the earlier shots are free. The shot is reset
+   *   by initializing it.
+   * 
+   * @return The shot.
+   */
+  static std::shared_ptr<ShotModel> acquire()
+  {
+    return pool.acquire();
+  }
+
+  /**
+   * Set whether the shots have lights, which the shots pick up on their next update.
+   * 
+   * @param enabled  Whether the shots have lights.
+   */
+  static void setShotLightsEnabled(const bool &enabled)
+  {
+    isShotLightPresent = enabled;
+  }
+
+  /**
+   * Check if the shots have lights.
+   * 
+   * @return Whether the shots have lights.
+   */
+  static const bool &areShotLightsEnabled()
+  {
+    return isShotLightPresent;
+  }
+
+  /**
+   * Toggle whether the shots have lights, which the shots pick up on their next update.
+   */
+  static void toggleShotLights()
+  {
+    isShotLightPresent = !isShotLightPresent;
+  }
+
   void init() override
   {
-    // Set the rotation of the model.
+    // Reset the rotation of the model, since the shot may be reused from the pool.
     setModelRotation(glm::vec3(0.0f, glm::radians(180.0f), 0.0f));
 
+    // A reused shot with a glow light takes a shadowed light instead if one of their slots was freed while it was pooled.
+    if (shotLight != nullptr && !shotLight->castsShadows() && shadowedShotLightsCount < static_cast<int32_t>(SHADOWED_SHOT_LIGHTS_COUNT))
+    {
+      destroyShotLight();
+    }
+
     // Check if shot light toggle is enabled.
     if (isShotLightPresent)
     {
-      // Create a shot light.
+      // Show the shot light.
       createShotLight();
     }
   }
 
   void deinit() override
   {
-    // Check if shot light toggle is enabled.
-    if (isShotLightPresent)
+    // Hide the shot light, which stays with the shot in the pool. A shadowed light is destroyed instead, so the shots in
+    //   flight can take its slot instead of it sitting idle in the pool.
+    if (shotLight != nullptr && shotLight->castsShadows())
     {
-      // Destroy the shot light and update the toggle.
       destroyShotLight();
-      isShotLightPresent = true;
     }
+    else
+    {
+      hideShotLight();
+    }
+  }
+
+  void onRemoved() override
+  {
+    // The model manager no longer holds on to the shot, so put it back into the pool.
+    pool.release(shared_from_this());
+  }
+
+  bool castsShadows() const override
+  {
+    // The shots are small and carry their own lights, so their shadows are never seen.
+    return false;
   }
 
-  void update() override
+  void update(const FrameTime &frameTime) override
   {
-    // Get the timestamp for the start of the update.
-    const auto currentTime = glfwGetTime();
-    // Get the time difference since the start of the last update.
-    const auto deltaTime = currentTime - lastTime;
+    // Get the time difference since the start of the last frame.
+    const auto &deltaTime = frameTime.delta;
 
     // Get the position of the shot.
     const auto currentPosition = getModelPosition();
@@ -180,68 +293,23 @@ public:
     if (currentPosition.z < -50.0f)
     {
       // If it has, destroy it.
-      this->deinit();
-      modelManager.deregisterModel(this->getModelId());
+      eventBus.publish(ModelDestroyEvent({getModelHandle()}), getModelHandle().index);
       return;
     }
 
-    // Check if "H" key was pressed after 500ms since the last shot light toggle.
-    if (controlManager.isKeyPressed(GLFW_KEY_H) && (currentTime - lastShotLightChange) > 0.5f)
-    {
-      // "H" key was pressed. Toggle the shot light.
-      isShotLightPresent = !isShotLightPresent;
-      // Update the timestamp for when the shot light was last toggled.
-      lastShotLightChange = currentTime;
-    }
-
-    const auto timeSlices = 12;
-    for (auto i = 0; i < timeSlices; i++)
-    {
-      // Update the shot position.
-      setModelPosition(getModelPosition() - glm::vec3(0.0f, 0.0f, (shotSpeed * deltaTime) / timeSlices));
-
-      if (currentPosition.z > 1.5f)
-      {
-        continue;
-      }
-
-      // Get the list of registered models.
-      const auto models = modelManager.getAllModels();
-      // Iterate over the list of registered models.
-      for (const auto &model : models)
-      {
-        // Check if the current model is an enemy model.
-        if (model->getModelName() != "Enemy")
-        {
-          continue;
-        }
-
-        if (glm::distance(model->getModelPosition(), currentPosition) > 3.0f)
-        {
-          continue;
-        }
-
-        // Check if collided with the enemy model.
-        if (DeepCollisionValidator::haveShapesCollided(getColliderDetails()->getColliderShape(), model->getColliderDetails()->getColliderShape(), true))
-        {
-          // Shot has collided with an enemy. Destroy both.
-          model->deinit();
-          modelManager.deregisterModel(model);
-
-          this->deinit();
-          modelManager.deregisterModel(this->getModelId());
-          return;
-        }
-      }
-    }
+    // Update the shot position. The collision manager tests the whole path of the shot for hits after the update.
+    setModelPosition(currentPosition - glm::vec3(0.0f, 0.0f, shotSpeed * deltaTime));
 
-    setModelRotation(getModelRotation() - glm::vec3(0.0f, 0.0f, rotationSpeedZ));
+    rotateModel(spinStep);
 
     // Update the shot light.
     updateShotLight();
+  }
 
-    // Set the timestamp for the start of the last update to the starting timestamp of the current update.
-    lastTime = currentTime;
+  void onCollision(const std::shared_ptr<ModelBaseIntf> &) override
+  {
+    // Shot has collided with an enemy. Destroy the shot, and the enemy destroys itself.
+    eventBus.publish(ModelDestroyEvent({getModelHandle()}), getModelHandle().index);
   }
 };
 
@@ -249,7 +317,11 @@ public:
 double ShotModel::shotSpeed = 120.0f;
 // Initialize the shot light toggle static variable.
 bool ShotModel::isShotLightPresent = true;
-// Initialize the last time the shot light toggle was changed static variable.
-float_t ShotModel::lastShotLightChange = -1;
+// Initialize the number of shot lights casting shadows static variable.
+int32_t ShotModel::shadowedShotLightsCount = 0;
+// Initialize the shot pool static variable.
+thread_local ModelPool<ShotModel> ShotModel::pool([](const uint32_t &shotIndex) {
+  return ShotModel::create("Shot" + std::to_string(shotIndex));
+});
 
 #endif
\ No newline at end of file
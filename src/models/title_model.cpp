@@ -47,7 +47,13 @@ public:
     return std::make_shared<TitleModel>(modelId);
   }
 
-  void update() override
+  UpdateFrequency getUpdateFrequency() const override
+  {
+    // The title just stays where it is.
+    return UpdateFrequency::EVENT_DRIVEN;
+  }
+
+  void update(const FrameTime &) override
   {
   }
 };
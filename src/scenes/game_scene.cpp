@@ -5,6 +5,7 @@
 #include <optional>
 #include <memory>
 #include <vector>
+#include <ctime>
 
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -14,12 +15,23 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "../include/window.cpp"
-#include "../include/control.cpp"
+#include "../include/world.cpp"
 #include "../include/camera.cpp"
 #include "../include/light.cpp"
 #include "../include/render.cpp"
+#include "../include/collision.cpp"
+#include "../include/attachment.cpp"
+#include "../include/projectiles.cpp"
+#include "../include/particles.cpp"
 #include "../include/debug_render.cpp"
 #include "../include/text.cpp"
+#include "../include/gpu_timer.cpp"
+#include "../include/profiler.cpp"
+#include "../include/benchmark.cpp"
+#include "../include/input_recording.cpp"
+#include "../include/frame_history.cpp"
+#include "../include/settings.cpp"
+#include "../include/log.cpp"
 
 #include "../camera/perspective_camera.cpp"
 #include "../models/enemy_model.cpp"
@@ -31,52 +43,145 @@ class GameScene : public SceneBase
 {
 private:
   ControlManager &controlManager;
+  EventBus &eventBus;
   ModelManager &modelManager;
+  CollisionManager &collisionManager;
+  AttachmentManager &attachmentManager;
+  ProjectileManager &projectileManager;
+  ParticleManager &particleManager;
   LightManager &lightManager;
   CameraManager &cameraManager;
   RenderManager &renderManager;
   DebugRenderManager &debugRenderManager;
+  ProfileManager &profileManager;
+  FrameHistoryManager &frameHistoryManager;
+
+  // The indices of the stages whose timings are kept in the frame history.
+  const uint32_t frameHistoryStage;
+  const uint32_t processHistoryStage;
+  const uint32_t renderHistoryStage;
+  const uint32_t simulationHistoryStage;
+  const uint32_t textRenderHistoryStage;
+
+  // The benchmark scenario the scene plays through instead of taking input from the player, if it's being benchmarked.
+  const std::optional<BenchmarkScenario> benchmarkScenario;
+  // The fixed time step of the frames of a benchmark, in seconds.
+  static const double_t benchmarkTimeStep;
+
+  std::vector<SlotHandle> sceneCameraHandles;
+  std::vector<SlotHandle> sceneModelHandles;
+  // The subscription of the scene to the light toggle events, while the scene is running.
+  SlotHandle lightToggleSubscription;
+  // The subscription of the scene to the events of a type of model running out, while the scene is running, and whether
+  //   the last enemy was destroyed, which is when the game is over.
+  SlotHandle modelTypeClearedSubscription;
+  bool enemiesCleared;
+
+  /**
+   * Structure for a model of the scene kept between runs of the scene, along with the transformations it started with.
+   */
+  struct ModelSnapshot
+  {
+    std::shared_ptr<ModelBaseIntf> model;
+    glm::vec3 position;
+    glm::quat orientation;
+    glm::vec3 scale;
+  };
+
+  // The camera and the models of the scene kept between runs of the scene, which are empty until the scene first runs.
+  std::shared_ptr<PerspectiveCamera> sceneCamera;
+  std::vector<ModelSnapshot> sceneModelSnapshots;
+
+  // The play session being recorded, if the game is recorded.
+  InputRecording inputRecording;
+
+  /**
+   * Check if the scene keeps its models, camera and assets once it's done, so restarting it only resets them.
+   *
+   * @return Whether the scene is kept warm.
+   */
+  bool isKeptWarm() const
+  {
+    // A benchmark ends the game, so there's nothing to restart, and a recorded game starts cold every time, like its
+    //   replay does.
+    return KEEP_GAME_SCENE_WARM && !benchmarkScenario && INPUT_RECORDING_FILE.empty();
+  }
+
+  /**
+   * Register a model created for the scene, keeping a snapshot of it to reset it to if the scene is kept warm.
+   *
+   * @param model  The model.
+   */
+  void addSceneModel(const std::shared_ptr<ModelBaseIntf> &model)
+  {
+    if (isKeptWarm())
+    {
+      sceneModelSnapshots.push_back({model, model->getModelPosition(), model->getModelOrientation(), model->getModelScale()});
+    }
+    sceneModelHandles.push_back(modelManager.registerModel(std::shared_ptr<ModelBaseIntf>(model)));
+  }
 
-  std::vector<std::string> sceneCameraIds;
-  std::vector<std::string> sceneModelIds;
+  /**
+   * Put the models kept from the previous run of the scene back where they started, and register them again, including
+   *   the enemies destroyed in that run.
+   */
+  void resetSceneModels()
+  {
+    for (const auto &modelSnapshot : sceneModelSnapshots)
+    {
+      modelSnapshot.model->setModelPosition(modelSnapshot.position);
+      modelSnapshot.model->setModelOrientation(modelSnapshot.orientation);
+      modelSnapshot.model->setModelScale(modelSnapshot.scale);
+      modelSnapshot.model->resetRenderInterpolation();
+      sceneModelHandles.push_back(modelManager.registerModel(std::shared_ptr<ModelBaseIntf>(modelSnapshot.model)));
+    }
+  }
 
   void initCameras()
   {
-    // Create a perspective camera, and set its properties.
+    // Create a perspective camera, unless one was kept from the previous run, and set its properties.
     const auto cameraId = "MainCamera";
-    sceneCameraIds.push_back(cameraId);
 
-    const auto perspectiveCamera = PerspectiveCamera::create(cameraId);
-    perspectiveCamera->setCameraPosition(glm::vec3(0.0f, 20.0f, 40.0f));
-    perspectiveCamera->setCameraAngles(glm::pi<float_t>(), -(glm::pi<float_t>() / 4.3f));
+    if (sceneCamera == nullptr)
+    {
+      sceneCamera = PerspectiveCamera::create(cameraId);
+    }
+    sceneCamera->setCameraPosition(glm::vec3(0.0f, 20.0f, 40.0f));
+    sceneCamera->setCameraAngles(glm::pi<float_t>(), -(glm::pi<float_t>() / 4.3f));
 
-    cameraManager.registerCamera(perspectiveCamera);
-    renderManager.registerActiveCamera(perspectiveCamera->getCameraId());
+    sceneCameraHandles.push_back(cameraManager.registerCamera(sceneCamera));
+    renderManager.registerActiveCamera(sceneCamera->getCameraHandle());
   }
 
   void deinitCameras()
   {
-    for (const auto &cameraId : sceneCameraIds)
+    for (const auto &cameraHandle : sceneCameraHandles)
     {
-      cameraManager.deregisterCamera(cameraId);
+      cameraManager.deregisterCamera(cameraHandle);
+    }
+    sceneCameraHandles.clear();
+    if (!isKeptWarm())
+    {
+      sceneCamera = nullptr;
     }
   }
 
   void initEnemyModels()
   {
-    // Create 45 enemy models stacked in a grid format (5 x 3 x 3), and set their properties.
-    for (auto i = -2; i <= 2; i++)
+    // Create the enemy models stacked in a grid format (5 x 3 x 3 unless a benchmark asks for another size), centered
+    //   on the width and height and going away from the player on the depth, and set their properties.
+    const auto gridSize = benchmarkScenario ? benchmarkScenario->enemyGridSize : glm::uvec3(5, 3, 3);
+    for (uint32_t x = 0; x < gridSize.x; x++)
     {
-      for (auto j = -1; j <= 1; j++)
+      for (uint32_t y = 0; y < gridSize.y; y++)
       {
-        for (auto k = -2; k <= 0; k++)
+        for (uint32_t z = 0; z < gridSize.z; z++)
         {
-          const auto enemyModelId = "Enemy" + std::to_string((9 * (i + 2)) + (3 * (j + 1)) + (k + 2));
-          sceneModelIds.push_back(enemyModelId);
+          const auto enemyModelId = "Enemy" + std::to_string((gridSize.y * gridSize.z * x) + (gridSize.z * y) + z);
 
           const auto enemyModel = EnemyModel::create(enemyModelId);
-          enemyModel->setModelPosition(glm::vec3(i * 5, j * 5, k * 5));
-          modelManager.registerModel(enemyModel);
+          enemyModel->setModelPosition(glm::vec3(x - (gridSize.x - 1) / 2.0f, y - (gridSize.y - 1) / 2.0f, z - (gridSize.z - 1.0f)) * 5.0f);
+          addSceneModel(enemyModel);
         }
       }
     }
@@ -86,76 +191,185 @@ private:
   {
     // Create a player model.
     const auto playerModelId = "MainPlayer";
-    sceneModelIds.push_back(playerModelId);
 
     const auto playerModel = PlayerModel::create(playerModelId);
-    modelManager.registerModel(playerModel);
+    addSceneModel(playerModel);
   }
 
   void initModels()
   {
-    EnemyModel::initModel();
-    renderLoadingText("Loading (35%)", glm::vec2(1, 1), 1.0f);
-    PlayerModel::initModel();
-    renderLoadingText("Loading (60%)", glm::vec2(1, 1), 1.0f);
-    ShotModel::initModel();
-    renderLoadingText("Loading (85%)", glm::vec2(1, 1), 1.0f);
+    // Request the assets of the models unless the scene was preloaded, and wait for whatever is still loading.
+    preload();
+    waitForAssetLoads(10, 85);
+
+    // Reset the models kept from the previous run, or create them if there are none.
+    if (!sceneModelSnapshots.empty())
+    {
+      resetSceneModels();
+    }
+    else
+    {
+      initEnemyModels();
+      renderLoadingText("Loading (90%)", glm::vec2(1, 1), 1.0f);
+      initPlayerModels();
+    }
+
+    // The shots destroy the enemies they hit.
+    collisionManager.registerCollisionPair(COLLISION_LAYER_SHOT, COLLISION_LAYER_ENEMY);
 
-    initEnemyModels();
-    renderLoadingText("Loading (90%)", glm::vec2(1, 1), 1.0f);
-    initPlayerModels();
+    // Draw the projectiles as shots turned like the shots are fired, which is never registered itself.
+    const auto projectileModel = ShotModel::create("Projectile");
+    projectileModel->setModelRotation(glm::vec3(0.0f, glm::radians(180.0f), 0.0f));
+    projectileManager.setProjectileModel(projectileModel);
   }
 
   void deinitModels()
   {
-    for (const auto &modelId : sceneModelIds)
+    collisionManager.deregisterAllCollisionPairs();
+    projectileManager.clearProjectiles();
+    projectileManager.setProjectileModel(nullptr);
+    particleManager.clearParticles();
+
+    for (const auto &modelHandle : sceneModelHandles)
     {
-      modelManager.deregisterModel(modelId);
+      modelManager.deregisterModel(modelHandle);
     }
 
-    // Iterate over the list of registered models.
-    for (const auto &model : modelManager.getAllModels())
+    sceneModelHandles.clear();
+
+    // Iterate over the list of registered shot models, which go back into the pool of shots once they're removed.
+    for (const auto &shotModel : modelManager.view<ShotModel>())
     {
-      // Check if the current model is a shot model.
-      if (model->getModelName() != "Shot")
-      {
-        continue;
-      }
+      modelManager.deregisterModel(shotModel.getModelHandle());
+    }
+    modelManager.removeDeregisteredModels();
 
-      modelManager.deregisterModel(model->getModelId());
+    // Keep the models, the pool of shots and the assets for the next run if the scene is kept warm.
+    if (!isKeptWarm())
+    {
+      releaseRequestedAssets();
     }
+  }
+
+  void requestAssets()
+  {
+    EnemyModel::initModel();
+    PlayerModel::initModel();
+    ShotModel::initModel();
+  }
 
+  void releaseAssets()
+  {
+    // The models kept between runs go along with their assets.
+    sceneModelSnapshots.clear();
+    sceneCamera = nullptr;
     EnemyModel::deinitModel();
     PlayerModel::deinitModel();
     ShotModel::deinitModel();
   }
 
 public:
-  GameScene(const std::string &sceneId)
-      : SceneBase(sceneId, "GameScene"),
-        controlManager(ControlManager::getInstance()),
-        modelManager(ModelManager::getInstance()),
-        lightManager(LightManager::getInstance()),
-        cameraManager(CameraManager::getInstance()),
+  GameScene(World &world, const std::string &sceneId, const std::optional<BenchmarkScenario> &benchmarkScenario = std::nullopt)
+      : SceneBase(world, sceneId, "GameScene"),
+        controlManager(world.getControlManager()),
+        eventBus(world.getEventBus()),
+        modelManager(world.getModelManager()),
+        collisionManager(world.getCollisionManager()),
+        attachmentManager(world.getAttachmentManager()),
+        projectileManager(world.getProjectileManager()),
+        particleManager(ParticleManager::getInstance()),
+        lightManager(world.getLightManager()),
+        cameraManager(world.getCameraManager()),
         renderManager(RenderManager::getInstance()),
-        debugRenderManager(DebugRenderManager::getInstance())
+        debugRenderManager(DebugRenderManager::getInstance()),
+        profileManager(ProfileManager::getInstance()),
+        frameHistoryManager(FrameHistoryManager::getInstance()),
+        frameHistoryStage(frameHistoryManager.addStage("Frame", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f))),
+        processHistoryStage(frameHistoryManager.addStage("Process", glm::vec4(1.0f, 1.0f, 0.0f, 1.0f))),
+        renderHistoryStage(frameHistoryManager.addStage("Render", glm::vec4(0.0f, 1.0f, 1.0f, 1.0f))),
+        simulationHistoryStage(frameHistoryManager.addStage("Simulation", glm::vec4(1.0f, 0.0f, 1.0f, 1.0f))),
+        textRenderHistoryStage(frameHistoryManager.addStage("Text Render", glm::vec4(0.0f, 1.0f, 0.0f, 1.0f))),
+        benchmarkScenario(benchmarkScenario),
+        lightToggleSubscription({0, 0}),
+        modelTypeClearedSubscription({0, 0}),
+        enemiesCleared(false),
+        sceneCamera(nullptr),
+        sceneModelSnapshots({}),
+        inputRecording({0, glm::uvec3(0), 0.0f, false, false, {}})
   {
-    sceneModelIds = std::vector<std::string>({});
-    sceneCameraIds = std::vector<std::string>({});
+    sceneModelHandles = std::vector<SlotHandle>({});
+    sceneCameraHandles = std::vector<SlotHandle>({});
+
+    // The broadphase can be picked in the settings as well as switched with the "C" key, so the benchmark matrix can
+    //   compare the two.
+    SettingsManager::getInstance().addChoice("broadphase", true, {"spatial_hash", "aabb_tree"}, [this](const size_t &index) {
+      modelManager.setBroadphaseType(static_cast<BroadphaseType>(index));
+    });
   }
 
-  const static std::shared_ptr<GameScene> create(const std::string &sceneId)
+  const static std::shared_ptr<GameScene> create(World &world, const std::string &sceneId, const std::optional<BenchmarkScenario> &benchmarkScenario = std::nullopt)
   {
-    return std::make_shared<GameScene>(sceneId);
+    return std::make_shared<GameScene>(world, sceneId, benchmarkScenario);
+  }
+
+  const std::vector<std::string> getPreloadSceneIds() const
+  {
+    // The end scene follows the game, unless it's a benchmark, which ends the game and shouldn't be measured loading it.
+    if (benchmarkScenario)
+    {
+      return {};
+    }
+    return {"EndScene"};
   }
 
   const void init()
   {
+    // Seed the enemies for a benchmark, so every run of it starts the same, and set up how fast the player fires,
+    //   whether the shots are lit and which box-box collision test is used.
+    if (benchmarkScenario)
+    {
+      EnemyModel::seedRandomGenerator(benchmarkScenario->seed);
+      PlayerModel::setShotInterval(benchmarkScenario->shotInterval);
+      ShotModel::setShotLightsEnabled(benchmarkScenario->shotLightsEnabled);
+      DeepCollisionValidator::setSeparatingAxisBoxTestEnabled(benchmarkScenario->separatingAxisBoxTestEnabled);
+    }
+    // Seed the enemies of a recorded game with a seed of its own, and keep what the game starts with, so a replay of
+    //   it starts the same.
+    else if (!INPUT_RECORDING_FILE.empty())
+    {
+      const auto seed = static_cast<uint32_t>(std::clock());
+      EnemyModel::seedRandomGenerator(seed);
+      inputRecording = {seed, glm::uvec3(5, 3, 3), PlayerModel::getShotInterval(), ShotModel::areShotLightsEnabled(),
+                        DeepCollisionValidator::isSeparatingAxisBoxTestEnabled(), {}};
+    }
+
+    // Toggle the lights the light toggle events ask for, which the models pick up on their next update.
+    lightToggleSubscription = eventBus.subscribe<LightToggleEvent>([](const LightToggleEvent &event) {
+      if (event.target == LightToggleTarget::SHOT_LIGHTS)
+      {
+        ShotModel::toggleShotLights();
+      }
+      else
+      {
+        PlayerModel::toggleEyeLight();
+      }
+    });
+    // Note the last enemy being destroyed, instead of counting the enemies every frame.
+    modelTypeClearedSubscription = eventBus.subscribe<ModelTypeClearedEvent>([this](const ModelTypeClearedEvent &event) {
+      if (event.modelTypeId == ModelBaseIntf::getTypeId<EnemyModel>())
+      {
+        enemiesCleared = true;
+      }
+    });
+
     renderLoadingText("Loading (0%)", glm::vec2(1, 1), 1.0f);
     initCameras();
     renderLoadingText("Loading (10%)", glm::vec2(1, 1), 1.0f);
     initModels();
     renderLoadingText("Loading (95%)", glm::vec2(1, 1), 1.0f);
+    // Draw the shader variants the models can be drawn with behind the loading screen, so the first shot light or toggled
+    //   light in the game doesn't wait for them to compile.
+    renderManager.prewarmShaders();
 
     // Poll for events and set the mouse to the center of the screen
     controlManager.disableCursor();
@@ -170,178 +384,244 @@ public:
     deinitModels();
     renderLoadingText("Cleaning (50%)", glm::vec2(1, 1), 1.0f);
     deinitCameras();
+    eventBus.unsubscribe<LightToggleEvent>(lightToggleSubscription);
+    eventBus.unsubscribe<ModelTypeClearedEvent>(modelTypeClearedSubscription);
     renderLoadingText("Cleaning (100%)", glm::vec2(1, 1), 1.0f);
   }
 
-  const uint32_t getEnemyModelsCount()
-  {
-    uint32_t enemyModelsCount = 0;
-
-    // Iterate over the list of registered models.
-    for (const auto &model : modelManager.getAllModels())
-    {
-      if (model->getModelName() != "Enemy")
-      {
-        continue;
-      }
-
-      ++enemyModelsCount;
-    }
-
-    return enemyModelsCount;
-  }
-
   const std::optional<std::string> execute()
   {
-    // consume events we don't want passed on
-    controlManager.isKeyPressed(GLFW_KEY_SPACE);
-    controlManager.isKeyPressed(GLFW_KEY_ESCAPE);
-    windowManager.isWindowCloseRequested();
-
     modelManager.initAllModels();
     cameraManager.initAllCameras();
     lightManager.initAllLights();
-
-    // Set debug mode to initially false.
-    auto debugEnabled = false;
-    // Set the timestamp for when debug mode toggle was changed to 10 seconds in the past.
-    auto lastDebugEnabledChange = glfwGetTime() - 10;
-
-    // Set debug text to initially false.
-    auto textEnabled = false;
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastTextEnabledChange = glfwGetTime() - 10;
-
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastVsyncToggledChange = glfwGetTime() - 10;
-
-    // Start the game loop.
-    auto textRenderTimeLast = 0.0f;
-    auto frameTimeLast = 0.0f;
-    auto processTimeLast = 0.0f;
-    uint32_t textCharsRenderedLast = 0;
-    do
+    // Drop the events of the enemies cleared away by the last run of the scene, and start from the enemies there are.
+    eventBus.dispatch<ModelTypeClearedEvent>();
+    enemiesCleared = modelManager.getRegisteredModelsCount<EnemyModel>() == 0;
+
+    // Run a benchmark without V-Sync, from a fixed starting time, recording each frame after the warmup frames.
+    const auto benchmarkStartTime = glfwGetTime();
+    // The time the simulation has reached, moving forward in fixed steps to catch up with the frames. It starts with the
+    //   benchmark, so a replay of a recorded game takes the same steps in every frame.
+    auto simulationTime = benchmarkStartTime;
+    uint64_t simulationStepIndex = 0;
+    // The time the simulation steps of the latest frame took, in milliseconds.
+    auto simulationTimeLast = 0.0f;
+    // Record the game from its first frame, if it's recorded.
+    const auto inputRecorded = !benchmarkScenario && !INPUT_RECORDING_FILE.empty();
+    inputRecording.frames.clear();
+    uint32_t benchmarkFrame = 0;
+    BenchmarkRecorder benchmarkRecorder;
+    if (benchmarkScenario)
     {
-      textManager.addText("Window Dimensions: " + std::to_string(WINDOW_WIDTH) + "x" + std::to_string(WINDOW_HEIGHT) + "px", glm::vec2(1, 11), 0.5f);
-      textManager.addText("Viewport Dimensions: " + std::to_string(VIEWPORT_WIDTH) + "x" + std::to_string(VIEWPORT_HEIGHT) + "px", glm::vec2(1, 10.5f), 0.5f);
-      textManager.addText("Framebuffer Dimensions: " + std::to_string(FRAMEBUFFER_WIDTH) + "x" + std::to_string(FRAMEBUFFER_HEIGHT) + "px", glm::vec2(1, 10), 0.5f);
-      textManager.addText("Text Dimensions: " + std::to_string(TEXT_WIDTH) + "x" + std::to_string(TEXT_HEIGHT) + "px", glm::vec2(1, 9.5f), 0.5f);
-      textManager.addText("Max Lights:", glm::vec2(1, 9), 0.5f);
-      textManager.addText(std::to_string(MAX_CONE_LIGHTS) + " Cone Lights", glm::vec2(3, 8.5f), 0.5f);
-      textManager.addText(std::to_string(MAX_POINT_LIGHTS) + " Point Lights", glm::vec2(3, 8), 0.5f);
-      textManager.addText("Max Text Characters: " + std::to_string(MAX_TEXT_CHARS) + " chars", glm::vec2(1, 7.5f), 0.5f);
-
-      auto isSwapEnabledStr = SWAP_INTERVAL == 0 ? std::string("False") : SWAP_INTERVAL == 1 ? std::string("True (Single-Sync)") : std::string("True (Double-Sync)");
-      textManager.addText("VSync Enabled: " + isSwapEnabledStr, glm::vec2(1, 7), 0.5f);
-
-      // Get the time at the start of the loop.
-      const auto currentTime = glfwGetTime();
-      auto updateStartTime = currentTime, updateEndTime = currentTime;
+      windowManager.setSwapInterval(0);
+    }
 
-      // Check if "B" key was pressed beyond 500ms since the last debug mode toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_B) && (currentTime - lastDebugEnabledChange) > 0.5f)
+    SceneLoopHooks hooks;
+    hooks.beginFrame = [&]() {
+      // Step a benchmark replaying a recorded game to the time of the frame in the recording, and set the keys and mouse
+      // buttons that changed in the frame, so it plays out exactly as it was recorded however long the frames take.
+      if (benchmarkScenario && benchmarkScenario->inputRecording)
       {
-        // "B" key was pressed. Toggle debug mode and update the last change timestamp.
-        debugEnabled = !debugEnabled;
-        lastDebugEnabledChange = currentTime;
+        const auto &recordedFrame = benchmarkScenario->inputRecording->frames[benchmarkFrame];
+        glfwSetTime(benchmarkStartTime + recordedFrame.time);
+        controlManager.setRecordedInput(recordedFrame.changes);
       }
-
-      // Check if "T" key was pressed beyond 500ms since the last debug text toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_T) && (currentTime - lastTextEnabledChange) > 0.5f)
+      // Step a benchmark a fixed time forward every frame, so the models move the same in every run however long the
+      // frames take, and hold down the keys of its input track.
+      else if (benchmarkScenario)
       {
-        // "T" key was pressed. Toggle debug text and update the last change timestamp.
-        textEnabled = !textEnabled;
-        lastTextEnabledChange = currentTime;
+        glfwSetTime(benchmarkStartTime + benchmarkFrame * benchmarkTimeStep);
+        controlManager.setScriptedKeys(benchmarkScenario->getKeysAtFrame(benchmarkFrame));
       }
-
-      // Check if "V" key was pressed beyond 500ms since the last vsync toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_V) && (currentTime - lastVsyncToggledChange) > 0.5f)
+    };
+    // Start the frames of a replay exactly at the times they were recorded at, instead of wherever the clock got to.
+    if (benchmarkScenario && benchmarkScenario->inputRecording)
+    {
+      hooks.readFrameTime = [&]() { return benchmarkStartTime + benchmarkScenario->inputRecording->frames[benchmarkFrame].time; };
+    }
+    hooks.update = [&](const FrameTime &frameTime) {
+      // Record the time of the frame and the input it reacts to, if the game is recorded, with the buttons already held
+      // down at the first frame.
+      if (inputRecorded)
       {
-        // "V" key was pressed. Toggle vsync and update the last change timestamp.
-        windowManager.toggleVsync();
-        lastVsyncToggledChange = currentTime;
+        inputRecording.frames.push_back({frameTime.now - benchmarkStartTime, {}});
+        controlManager.getInputChanges(inputRecording.frames.back().changes, inputRecording.frames.size() == 1);
       }
 
-      // Update the lights.
-      updateStartTime = glfwGetTime();
-      lightManager.updateAllLights();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Light Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 0.5f), 0.5f);
-
-      // Update the cameras.
-      updateStartTime = glfwGetTime();
-      modelManager.updateAllModels();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Model Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1), 0.5f);
-
-      // Update the models.
-      updateStartTime = glfwGetTime();
-      cameraManager.updateAllCameras();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Camera Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1.5f), 0.5f);
-
-      // Render the scene.
-      updateStartTime = glfwGetTime();
-      renderManager.render();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2), 0.5f);
-
-      // Check if debug mode is enabled.
-      if (debugEnabled)
+      // The game is over once every enemy is destroyed.
+      if (enemiesCleared)
       {
-        // Render the debug models fo the main models and lights.
-        updateStartTime = glfwGetTime();
-        debugRenderManager.render();
-        updateEndTime = glfwGetTime();
-        textManager.addText("Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2.5f), 0.5f);
+        return false;
       }
+      const auto &currentTime = frameTime.now;
 
-      // Render text
-      textManager.addText("Text Render (Last Frame): " + std::to_string(textRenderTimeLast) + "ms", glm::vec2(1, 3), 0.5f);
-      textManager.addText("Text Characters Rendered (Last Frame): " + std::to_string(textCharsRenderedLast) + " chars", glm::vec2(1, 3.5f), 0.5f);
+      textManager.addText("Max Lights:", glm::vec2(1, 9), 0.5f);
+      textManager.addFormattedText(glm::vec2(3, 8.5f), 0.5f, MAX_CONE_LIGHTS, " Cone Lights");
+      textManager.addFormattedText(glm::vec2(3, 8), 0.5f, MAX_POINT_LIGHTS, " Point Lights");
 
-      textManager.addText("Process Time (Last Frame): " + std::to_string(processTimeLast) + "ms", glm::vec2(1, 4.5f), 0.5f);
-      textManager.addText("Process Rate (Last Frame): " + std::to_string(1000 / processTimeLast) + "fps", glm::vec2(1, 5), 0.5f);
-      textManager.addText("Frame Time (Last Frame): " + std::to_string(frameTimeLast) + "ms", glm::vec2(1, 5.5f), 0.5f);
-      textManager.addText("Frame Rate (Last Frame): " + std::to_string(1000 / frameTimeLast) + "fps", glm::vec2(1, 6), 0.5f);
+      // Check if "H" key was pressed for the shot light toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_H))
+      {
+        // "H" key was pressed. Toggle the lights of the shots, which they pick up on their next update.
+        eventBus.publish(LightToggleEvent({LightToggleTarget::SHOT_LIGHTS}));
+      }
 
-      const auto dividerPositions = std::vector<double>({23.5f, 20.5f, 17.5f, 15.5f, 14, 13, 11.5f, 6.5f, 4});
-      for (const auto &yPosition : dividerPositions)
+      // Check if "J" key was pressed for the eye light toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_J))
       {
-        textManager.addText("---------------", glm::vec2(1, yPosition), 0.5f);
+        // "J" key was pressed. Toggle the eye light of the player, which it does on its next update.
+        eventBus.publish(LightToggleEvent({LightToggleTarget::EYE_LIGHTS}));
       }
+      // Handle the toggles of the frame before the simulation steps, so the first step already picks them up.
+      eventBus.dispatch<LightToggleEvent>();
 
-      // Check if debug text is enabled.
-      updateStartTime = glfwGetTime();
-      if (textEnabled)
+      // Check if "C" key was pressed for the broadphase switch. The toggles are read once a frame instead of in the
+      // simulation steps, so a key press toggles once however many steps the frame takes.
+      if (controlManager.wasKeyPressed(GLFW_KEY_C))
       {
-        textCharsRenderedLast = textManager.render();
+        // "C" key was pressed. Switch between the spatial hash and the AABB tree.
+        modelManager.setBroadphaseType(modelManager.getBroadphaseType() == BroadphaseType::SPATIAL_HASH ? BroadphaseType::AABB_TREE : BroadphaseType::SPATIAL_HASH);
       }
-      updateEndTime = glfwGetTime();
-      textRenderTimeLast = (updateEndTime - updateStartTime) * 1000;
-      processTimeLast = (updateEndTime - currentTime) * 1000;
 
-      // Swap the window framebuffers.
-      windowManager.swapBuffers();
+      // Move the simulation forward in fixed steps until it catches up with the frame, so the game plays the same
+      // however fast the frames are, dropping the time of a frame too slow to catch up with.
+      simulationTime = std::max(simulationTime, currentTime - MAX_SIMULATION_CATCH_UP_TIME);
+      auto lightUpdateTime = 0.0, modelUpdateTime = 0.0, collisionUpdateTime = 0.0, projectileUpdateTime = 0.0;
+      uint32_t simulationStepsCount = 0;
+      // Allow for the rounding of the frame times, so frames of whole steps always get all of their steps.
+      while (simulationTime + SIMULATION_TIME_STEP <= currentTime + 1e-6)
+      {
+        simulationTime += SIMULATION_TIME_STEP;
+        const FrameTime stepTime({simulationTime, float_t(SIMULATION_TIME_STEP), simulationStepIndex++});
+        simulationStepsCount++;
+        // Keep where the models were before the step, to render them between there and where they end up.
+        modelManager.storePreviousTransformations();
+        projectileManager.storePreviousPositions();
+
+        // Update the lights.
+        {
+          ProfileZone lightUpdateZone("Light Update");
+          lightManager.updateAllLights(stepTime);
+          lightUpdateTime += lightUpdateZone.end();
+        }
+
+        // Update the models.
+        {
+          ProfileZone modelUpdateZone("Model Update");
+          modelManager.updateAllModels(stepTime);
+          // Move the lights attached to the models that moved.
+          attachmentManager.updateAttachments();
+          modelUpdateTime += modelUpdateZone.end();
+        }
+
+        // Find the collisions of the models after they've all moved, and let them react.
+        {
+          ProfileZone collisionUpdateZone("Collision Update");
+          collisionManager.updateCollisions(stepTime);
+          // Throw out a burst of particles where each shot hit, which the GPU takes on from there.
+          for (const auto &collisionEvent : collisionManager.getCollisionEvents())
+          {
+            particleManager.emitBurst(collisionEvent.model->getModelPosition(), stepTime.now);
+          }
+          collisionUpdateTime += collisionUpdateZone.end();
+        }
 
-      updateEndTime = glfwGetTime();
-      frameTimeLast = (updateEndTime - currentTime) * 1000;
+        // Move the projectiles and let the models they hit react, once the colliders of the models are where they moved.
+        {
+          ProfileZone projectileUpdateZone("Projectile Update");
+          projectileManager.updateProjectiles(stepTime);
+          projectileUpdateTime += projectileUpdateZone.end();
+        }
 
-      // Poll for window events.
-      controlManager.pollEvents();
+        // Remove the models destroyed during the step from the lists of models in one pass.
+        modelManager.removeDeregisteredModels();
+      }
+      simulationTimeLast = float_t(lightUpdateTime + modelUpdateTime + collisionUpdateTime + projectileUpdateTime);
+      // Render the models between the last two steps, as far along as the frame is past the last step.
+      const auto interpolationFactor = float_t(glm::clamp((currentTime - simulationTime) / SIMULATION_TIME_STEP, 0.0, 1.0));
+      modelManager.interpolateRenderTransformations(interpolationFactor);
+      projectileManager.interpolateRenderPositions(interpolationFactor);
+
+      lightManager.addUpdateStatsText();
+      modelManager.addUpdateStatsText();
+      const auto broadphaseName = modelManager.getBroadphaseType() == BroadphaseType::AABB_TREE ? "AABB Tree" : "Spatial Hash";
+      textManager.addFormattedText(glm::vec2(1, 0.5f), 0.5f, "Light Update: ", lightUpdateTime, "ms");
+      textManager.addFormattedText(glm::vec2(1, 1), 0.5f, "Model Update: ", modelUpdateTime, "ms | Simulation Steps: ", simulationStepsCount);
+      textManager.addFormattedText(glm::vec2(1, 4), 0.5f, "Collision Update (", broadphaseName, "): ", collisionUpdateTime, "ms | Candidate Pairs: ",
+                                   collisionManager.getCandidatePairsCount(), " | Separated: ", collisionManager.getSeparatedPairsCount(), " | Narrowphase Checks: ",
+                                   collisionManager.getNarrowphaseChecksCount(), " | Collisions: ",
+                                   collisionManager.getCollisionEvents().size());
+      textManager.addFormattedText(glm::vec2(1, 6.5f), 0.5f, "Projectile Update: ", projectileUpdateTime, "ms | Projectiles (F): ", projectileManager.getProjectilesCount(), " | Hits: ", projectileManager.getHitsCount(),
+                                   " | Particle Bursts: ", particleManager.getBurstsCount());
 
-      // Continue loop as long as escape key isn't pressed or the window close is not requested.
-    } while (
-        getEnemyModelsCount() > 0 &&
-        !controlManager.isKeyPressed(GLFW_KEY_ESCAPE) &&
-        !windowManager.isWindowCloseRequested());
+      // Update the cameras.
+      {
+        ProfileZone cameraUpdateZone("Camera Update");
+        cameraManager.updateAllCameras(frameTime);
+        textManager.addFormattedText(glm::vec2(1, 1.5f), 0.5f, "Camera Update: ", cameraUpdateZone.end(), "ms");
+      }
+
+      return true;
+    };
+    hooks.render = [&](const FrameTime &frameTime) {
+      // Keep loading the scenes that can follow in the background, which uploads their assets.
+      {
+        ProfileZone preloadZone("Preload");
+        continuePreloads();
+      }
+      renderManager.render(frameTime);
+    };
+    hooks.addTextOverlay = [&]() {
+      // Draw the graph of the latest frames along with the text.
+      frameHistoryManager.addOverlay();
+    };
+    hooks.endFrame = [&](const SceneFrameTimings &frameTimings) {
+      // Keep the timings of the frame, whether the overlay is shown or not, so the graph has them once it is.
+      frameHistoryManager.record(frameHistoryStage, frameTimings.frameTime);
+      frameHistoryManager.record(processHistoryStage, frameTimings.processTime);
+      frameHistoryManager.record(renderHistoryStage, float_t(frameTimings.renderTime));
+      frameHistoryManager.record(simulationHistoryStage, simulationTimeLast);
+      frameHistoryManager.record(textRenderHistoryStage, frameTimings.textRenderTime);
+
+      // Record the frame of a benchmark once the warmup frames are done.
+      if (benchmarkScenario && benchmarkFrame >= benchmarkScenario->warmupFramesCount)
+      {
+        benchmarkRecorder.addFrame({frameTimings.frameZoneTime, frameTimings.renderTime, renderManager.getGpuRenderTime(), renderManager.getRenderStats(),
+                                    modelManager.getRegisteredModelsCount(), collisionManager.getNarrowphaseChecksCount(), frameTimings.allocationsCount, MemoryManager::getInstance().getSizes()});
+      }
+      benchmarkFrame++;
+      return !benchmarkScenario || benchmarkFrame < benchmarkScenario->warmupFramesCount + benchmarkScenario->framesCount;
+    };
+    sceneLoop.run(hooks);
 
     modelManager.deinitAllModels();
     lightManager.deinitAllLights();
     cameraManager.deinitAllCameras();
 
+    // Write the recording of the game, which a later run of the game overwrites.
+    if (inputRecorded && inputRecording.save(INPUT_RECORDING_FILE))
+    {
+      Logger::getInstance().info("Wrote the input of ", inputRecording.frames.size(), " frames to ", INPUT_RECORDING_FILE);
+    }
+
+    // Write the results of a benchmark, and end the game instead of moving on to the end scene.
+    if (benchmarkScenario)
+    {
+      controlManager.disableScriptedInput();
+      const auto resultsFilePath = "benchmark-" + benchmarkScenario->name + ".json";
+      if (benchmarkRecorder.writeResults(resultsFilePath, *benchmarkScenario))
+      {
+        Logger::getInstance().info("Wrote the results of the ", benchmarkScenario->name, " benchmark to ", resultsFilePath);
+      }
+      return std::nullopt;
+    }
+
     return "EndScene";
   }
 };
 
+// Initialize the fixed time step of the frames of a benchmark static variable, running the benchmarks at 60 frames per
+// second of game time.
+const double_t GameScene::benchmarkTimeStep = 1.0 / 60.0;
+
 #endif
\ No newline at end of file
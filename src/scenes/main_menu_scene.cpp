@@ -14,7 +14,7 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "../include/window.cpp"
-#include "../include/control.cpp"
+#include "../include/world.cpp"
 #include "../include/camera.cpp"
 #include "../include/render.cpp"
 #include "../include/debug_render.cpp"
@@ -41,8 +41,8 @@ private:
   RenderManager &renderManager;
   DebugRenderManager &debugRenderManager;
 
-  std::vector<std::string> sceneCameraIds;
-  std::vector<std::string> sceneModelIds;
+  std::vector<SlotHandle> sceneCameraHandles;
+  std::vector<SlotHandle> sceneModelHandles;
 
   std::shared_ptr<StartModel> startModel;
   std::shared_ptr<ExitModel> exitModel;
@@ -51,11 +51,10 @@ private:
   {
     // Create a perspective camera, and set its properties.
     const auto cameraId = "MainCamera";
-    sceneCameraIds.push_back(cameraId);
 
     const auto orthographicCamera = OrthographicCamera::create(cameraId);
-    cameraManager.registerCamera(orthographicCamera);
-    renderManager.registerActiveCamera(orthographicCamera->getCameraId());
+    sceneCameraHandles.push_back(cameraManager.registerCamera(orthographicCamera));
+    renderManager.registerActiveCamera(orthographicCamera->getCameraHandle());
 
     orthographicCamera->setCameraPosition(glm::vec3(0.0f, 0.0f, 5.0f));
     orthographicCamera->setCameraAngles(glm::pi<float_t>(), 0.0f);
@@ -63,19 +62,18 @@ private:
 
   void deinitCameras()
   {
-    for (const auto &cameraId : sceneCameraIds)
+    for (const auto &cameraHandle : sceneCameraHandles)
     {
-      cameraManager.deregisterCamera(cameraId);
+      cameraManager.deregisterCamera(cameraHandle);
     }
   }
 
   void initEnemyModels()
   {
     const auto enemyModelId = "Enemy";
-    sceneModelIds.push_back(enemyModelId);
 
     const auto enemyModel = DummyEnemyModel::create(enemyModelId);
-    modelManager.registerModel(enemyModel);
+    sceneModelHandles.push_back(modelManager.registerModel(enemyModel));
     enemyModel->setModelPosition(glm::vec3(-0.3f, 0.2f, 0.0f));
   }
 
@@ -83,10 +81,9 @@ private:
   {
     // Create a player model.
     const auto playerModelId = "MainPlayer";
-    sceneModelIds.push_back(playerModelId);
 
     const auto playerModel = DummyPlayerModel::create(playerModelId);
-    modelManager.registerModel(playerModel);
+    sceneModelHandles.push_back(modelManager.registerModel(playerModel));
     playerModel->setModelPosition(glm::vec3(0.0f, 0.2f, 0.0f));
   }
 
@@ -94,10 +91,9 @@ private:
   {
     // Create a shot model.
     const auto shotModelId = "Shot";
-    sceneModelIds.push_back(shotModelId);
 
     const auto shotModel = DummyShotModel::create(shotModelId);
-    modelManager.registerModel(shotModel);
+    sceneModelHandles.push_back(modelManager.registerModel(shotModel));
     shotModel->setModelPosition(glm::vec3(0.3f, 0.3f, 0.0f));
   }
 
@@ -106,56 +102,42 @@ private:
     {
       // Create a title model.
       const auto titleModelId = "Title";
-      sceneModelIds.push_back(titleModelId);
 
       const auto titleModel = TitleModel::create(titleModelId);
-      modelManager.registerModel(titleModel);
+      sceneModelHandles.push_back(modelManager.registerModel(titleModel));
       titleModel->setModelPosition(glm::vec3(0.0f, 0.7f, 0.0f));
     }
     {
       // Create a start button model.
       const auto startModelId = "Start";
-      sceneModelIds.push_back(startModelId);
 
       startModel = StartModel::create(startModelId);
-      modelManager.registerModel(startModel);
+      sceneModelHandles.push_back(modelManager.registerModel(startModel));
       startModel->setModelPosition(glm::vec3(0.0f, -0.15f, 0.0f));
     }
     {
       // Create a exit button model.
       const auto exitModelId = "Exit";
-      sceneModelIds.push_back(exitModelId);
 
       exitModel = ExitModel::create(exitModelId);
-      modelManager.registerModel(exitModel);
+      sceneModelHandles.push_back(modelManager.registerModel(exitModel));
       exitModel->setModelPosition(glm::vec3(0.0f, -0.7f, 0.0f));
     }
     {
       // Create a cursor model.
       const auto cursorModelId = "Cursor";
-      sceneModelIds.push_back(cursorModelId);
 
       const auto cursorModel = CursorModel::create(cursorModelId);
-      modelManager.registerModel(cursorModel);
+      sceneModelHandles.push_back(modelManager.registerModel(cursorModel));
       cursorModel->setModelPosition(glm::vec3(0.0f, 0.0f, 0.0f));
     }
   }
 
   void initModels()
   {
-    TitleModel::initModel();
-    renderLoadingText("Loading (15%)", glm::vec2(1, 1), 1.0f);
-    StartModel::initModel();
-    ExitModel::initModel();
-    renderLoadingText("Loading (20%)", glm::vec2(1, 1), 1.0f);
-    CursorModel::initModel();
-    renderLoadingText("Loading (25%)", glm::vec2(1, 1), 1.0f);
-    DummyEnemyModel::initModel();
-    renderLoadingText("Loading (40%)", glm::vec2(1, 1), 1.0f);
-    DummyPlayerModel::initModel();
-    renderLoadingText("Loading (55%)", glm::vec2(1, 1), 1.0f);
-    DummyShotModel::initModel();
-    renderLoadingText("Loading (70%)", glm::vec2(1, 1), 1.0f);
+    // Request the assets of the models unless the scene was preloaded, and wait for whatever is still loading.
+    preload();
+    waitForAssetLoads(10, 70);
 
     initEnemyModels();
     renderLoadingText("Loading (85%)", glm::vec2(1, 1), 1.0f);
@@ -168,11 +150,28 @@ private:
 
   void deinitModels()
   {
-    for (const auto &modelId : sceneModelIds)
+    for (const auto &modelHandle : sceneModelHandles)
     {
-      modelManager.deregisterModel(modelId);
+      modelManager.deregisterModel(modelHandle);
     }
+    modelManager.removeDeregisteredModels();
+
+    releaseRequestedAssets();
+  }
+
+  void requestAssets()
+  {
+    TitleModel::initModel();
+    StartModel::initModel();
+    ExitModel::initModel();
+    CursorModel::initModel();
+    DummyEnemyModel::initModel();
+    DummyPlayerModel::initModel();
+    DummyShotModel::initModel();
+  }
 
+  void releaseAssets()
+  {
     TitleModel::deinitModel();
     StartModel::deinitModel();
     ExitModel::deinitModel();
@@ -183,21 +182,27 @@ private:
   }
 
 public:
-  MainMenuScene(const std::string &sceneId)
-      : SceneBase(sceneId, "MainMenuScene"),
-        controlManager(ControlManager::getInstance()),
-        modelManager(ModelManager::getInstance()),
-        cameraManager(CameraManager::getInstance()),
+  MainMenuScene(World &world, const std::string &sceneId)
+      : SceneBase(world, sceneId, "MainMenuScene"),
+        controlManager(world.getControlManager()),
+        modelManager(world.getModelManager()),
+        cameraManager(world.getCameraManager()),
         renderManager(RenderManager::getInstance()),
         debugRenderManager(DebugRenderManager::getInstance())
   {
-    sceneModelIds = std::vector<std::string>({});
-    sceneCameraIds = std::vector<std::string>({});
+    sceneModelHandles = std::vector<SlotHandle>({});
+    sceneCameraHandles = std::vector<SlotHandle>({});
+  }
+
+  const static std::shared_ptr<MainMenuScene> create(World &world, const std::string &sceneId)
+  {
+    return std::make_shared<MainMenuScene>(world, sceneId);
   }
 
-  const static std::shared_ptr<MainMenuScene> create(const std::string &sceneId)
+  const std::vector<std::string> getPreloadSceneIds() const
   {
-    return std::make_shared<MainMenuScene>(sceneId);
+    // The game is the only scene started from here, so load it while the player is still in the menu.
+    return {"GameScene"};
   }
 
   const void init()
@@ -226,151 +231,58 @@ public:
 
   const std::optional<std::string> execute()
   {
-    // consume leftover events that we don't want to be accidentally processed
-    controlManager.isKeyPressed(GLFW_KEY_ESCAPE);
-    controlManager.isMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT);
-    windowManager.isWindowCloseRequested();
-
     cameraManager.initAllCameras();
     modelManager.initAllModels();
 
-    // Set debug mode to initially false.
-    auto debugEnabled = false;
-    // Set the timestamp for when debug mode toggle was changed to 10 seconds in the past.
-    auto lastDebugEnabledChange = glfwGetTime() - 10;
-
-    // Set debug text to initially false.
-    auto textEnabled = false;
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastTextEnabledChange = glfwGetTime() - 10;
-
-    // Set the timestamp for when debug text toggle was changed to 10 seconds in the past.
-    auto lastVsyncToggledChange = glfwGetTime() - 10;
-
-    // Start the game loop.
-    auto textRenderTimeLast = 0.0f;
-    auto frameTimeLast = 0.0f;
-    auto processTimeLast = 0.0f;
-    uint32_t textCharsRenderedLast = 0;
-    do
-    {
-      textManager.addText("Window Dimensions: " + std::to_string(WINDOW_WIDTH) + "x" + std::to_string(WINDOW_HEIGHT) + "px", glm::vec2(1, 11), 0.5f);
-      textManager.addText("Viewport Dimensions: " + std::to_string(VIEWPORT_WIDTH) + "x" + std::to_string(VIEWPORT_HEIGHT) + "px", glm::vec2(1, 10.5f), 0.5f);
-      textManager.addText("Text Dimensions: " + std::to_string(TEXT_WIDTH) + "x" + std::to_string(TEXT_HEIGHT) + "px", glm::vec2(1, 9.5f), 0.5f);
-      textManager.addText("Max Text Characters: " + std::to_string(MAX_TEXT_CHARS) + " chars", glm::vec2(1, 7.5f), 0.5f);
-
-      auto isSwapEnabledStr = SWAP_INTERVAL == 0 ? std::string("False") : SWAP_INTERVAL == 1 ? std::string("True (Single-Sync)") : std::string("True (Double-Sync)");
-      textManager.addText("VSync Enabled: " + isSwapEnabledStr, glm::vec2(1, 7), 0.5f);
-
-      // Get the time at the start of the loop.
-      const auto currentTime = glfwGetTime();
-      auto updateStartTime = currentTime, updateEndTime = currentTime;
-
-      // Check if "B" key was pressed beyond 500ms since the last debug mode toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_B) && (currentTime - lastDebugEnabledChange) > 0.5f)
-      {
-        // "B" key was pressed. Toggle debug mode and update the last change timestamp.
-        debugEnabled = !debugEnabled;
-        lastDebugEnabledChange = currentTime;
-      }
-
-      // Check if "T" key was pressed beyond 500ms since the last debug text toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_T) && (currentTime - lastTextEnabledChange) > 0.5f)
-      {
-        // "T" key was pressed. Toggle debug text and update the last change timestamp.
-        textEnabled = !textEnabled;
-        lastTextEnabledChange = currentTime;
-      }
+    // The scene to switch to once the loop stops, if any.
+    std::optional<std::string> nextSceneId = std::nullopt;
 
-      // Check if "V" key was pressed beyond 500ms since the last vsync toggle.
-      if (controlManager.isKeyPressed(GLFW_KEY_V) && (currentTime - lastVsyncToggledChange) > 0.5f)
-      {
-        // "V" key was pressed. Toggle vsync and update the last change timestamp.
-        windowManager.toggleVsync();
-        lastVsyncToggledChange = currentTime;
-      }
+    SceneLoopHooks hooks;
+    hooks.update = [&](const FrameTime &frameTime) {
+      // Update the models.
+      auto updateStartTime = glfwGetTime();
+      modelManager.storePreviousTransformations();
+      modelManager.updateAllModels(frameTime);
+      modelManager.removeDeregisteredModels();
+      // Each frame is a step, so the models updating every frame are rendered where they are, and the ones updating
+      //   every few frames between their previous and latest update.
+      modelManager.interpolateRenderTransformations(1.0f);
+      modelManager.addUpdateStatsText();
+      auto updateEndTime = glfwGetTime();
+      textManager.addFormattedText(glm::vec2(1, 1), 0.5f, "Model Update: ", (updateEndTime - updateStartTime) * 1000, "ms");
 
       // Update the cameras.
       updateStartTime = glfwGetTime();
-      modelManager.updateAllModels();
+      cameraManager.updateAllCameras(frameTime);
       updateEndTime = glfwGetTime();
-      textManager.addText("Model Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1), 0.5f);
-
-      // Update the models.
-      updateStartTime = glfwGetTime();
-      cameraManager.updateAllCameras();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Camera Update: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 1.5f), 0.5f);
+      textManager.addFormattedText(glm::vec2(1, 1.5f), 0.5f, "Camera Update: ", (updateEndTime - updateStartTime) * 1000, "ms");
 
       if (startModel->isClicked())
       {
-        return "GameScene";
+        nextSceneId = "GameScene";
+        return false;
       }
       if (exitModel->isClicked())
       {
-        break;
+        return false;
       }
+      return true;
+    };
+    hooks.render = [&](const FrameTime &frameTime) {
+      // Keep loading the scenes that can follow in the background, which uploads their assets.
+      continuePreloads();
 
-      // Render the scene.
-      updateStartTime = glfwGetTime();
+      // The buttons and the title are unlit and seen through an orthographic camera, so they're drawn as sprites, blended.
       windowManager.enableBlending(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      renderManager.render();
+      renderManager.renderSprites(frameTime);
       windowManager.disableBlending();
-      updateEndTime = glfwGetTime();
-      textManager.addText("Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2), 0.5f);
-
-      // Check if debug mode is enabled.
-      if (debugEnabled)
-      {
-        // Render the debug models fo the main models and lights.
-        updateStartTime = glfwGetTime();
-        debugRenderManager.render();
-        updateEndTime = glfwGetTime();
-        textManager.addText("Debug Render: " + std::to_string((updateEndTime - updateStartTime) * 1000) + "ms", glm::vec2(1, 2.5f), 0.5f);
-      }
-
-      // Render text
-      textManager.addText("Text Render (Last Frame): " + std::to_string(textRenderTimeLast) + "ms", glm::vec2(1, 3), 0.5f);
-      textManager.addText("Text Characters Rendered (Last Frame): " + std::to_string(textCharsRenderedLast) + " chars", glm::vec2(1, 3.5f), 0.5f);
-
-      textManager.addText("Process Time (Last Frame): " + std::to_string(processTimeLast) + "ms", glm::vec2(1, 4.5f), 0.5f);
-      textManager.addText("Process Rate (Last Frame): " + std::to_string(1000 / processTimeLast) + "fps", glm::vec2(1, 5), 0.5f);
-      textManager.addText("Frame Time (Last Frame): " + std::to_string(frameTimeLast) + "ms", glm::vec2(1, 5.5f), 0.5f);
-      textManager.addText("Frame Rate (Last Frame): " + std::to_string(1000 / frameTimeLast) + "fps", glm::vec2(1, 6), 0.5f);
-
-      const auto dividerPositions = std::vector<double>({23.5f, 20.5f, 17.5f, 15.5f, 14, 13, 11.5f, 6.5f, 4});
-      for (const auto &yPosition : dividerPositions)
-      {
-        textManager.addText("---------------", glm::vec2(1, yPosition), 0.5f);
-      }
-
-      // Check if debug text is enabled.
-      updateStartTime = glfwGetTime();
-      if (textEnabled)
-      {
-        textCharsRenderedLast = textManager.render();
-      }
-      updateEndTime = glfwGetTime();
-      textRenderTimeLast = (updateEndTime - updateStartTime) * 1000;
-      processTimeLast = (updateEndTime - currentTime) * 1000;
-
-      // Swap the window framebuffers.
-      windowManager.swapBuffers();
-
-      updateEndTime = glfwGetTime();
-      frameTimeLast = (updateEndTime - currentTime) * 1000;
-
-      // Poll for window events.
-      controlManager.pollEvents();
-
-      // Continue loop as long as escape key isn't pressed or the window close is not requested.
-    } while (!controlManager.isKeyPressed(GLFW_KEY_ESCAPE) &&
-             !windowManager.isWindowCloseRequested());
+    };
+    sceneLoop.run(hooks);
 
     cameraManager.deinitAllCameras();
     modelManager.deinitAllModels();
 
-    return std::nullopt;
+    return nextSceneId;
   }
 };
 
@@ -15,6 +15,8 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include "scene_loop.cpp"
+
 /**
  * Base class for creating scenes.
  */
@@ -26,15 +28,31 @@ private:
   const std::string sceneId;
   // The name of the scene.
   const std::string sceneName;
+  // Whether the assets of the scene were requested, either by preloading the scene or by initializing it.
+  bool assetsRequested;
+  // The world the scene plays in, which is entered while the scene runs so the models it creates belong to it.
+  World &world;
 
 protected:
   WindowManager &windowManager;
   TextManager &textManager;
+  ObjectManager &objectManager;
+  TextureManager &textureManager;
+  ShaderManager &shaderManager;
+
+  // The loop the scene runs its frames in.
+  SceneLoop sceneLoop;
 
-  SceneBase(const std::string &sceneId, const std::string &sceneName)
+  SceneBase(World &world, const std::string &sceneId, const std::string &sceneName)
       : windowManager(WindowManager::getInstance()),
         textManager(TextManager::getInstance()),
-        sceneId(sceneId), sceneName(sceneName)
+        objectManager(ObjectManager::getInstance()),
+        textureManager(TextureManager::getInstance()),
+        shaderManager(ShaderManager::getInstance()),
+        sceneId(sceneId), sceneName(sceneName),
+        assetsRequested(false),
+        world(world),
+        sceneLoop(world)
   {
   }
 
@@ -53,6 +71,67 @@ protected:
     windowManager.swapBuffers();
   }
 
+  /**
+   * Keep processing the objects, textures and shader programs loading in the background until they're all ready,
+   * rendering the loading progress each frame.
+   * 
+   * @param startPercentage  The loading percentage to show before any assets are ready.
+   * @param endPercentage    The loading percentage to show once all assets are ready.
+   */
+  void waitForAssetLoads(const uint32_t &startPercentage, const uint32_t &endPercentage)
+  {
+    while (objectManager.hasPendingLoads() || textureManager.hasPendingUploads() || shaderManager.hasPendingPrograms())
+    {
+      objectManager.processPendingLoads();
+      textureManager.processPendingUploads();
+      shaderManager.processPendingPrograms();
+      const auto progress = (objectManager.getPendingLoadProgress() + textureManager.getPendingUploadProgress() + shaderManager.getPendingProgramProgress()) / 3.0f;
+      const auto percentage = startPercentage + (uint32_t)(progress * (endPercentage - startPercentage));
+      renderLoadingText("Loading (" + std::to_string(percentage) + "%)", glm::vec2(1, 1), 1.0f);
+    }
+  }
+
+  /**
+   * Continue loading the assets of the scenes being preloaded, with only a small part of the textures uploaded each
+   * frame so the running scene doesn't hitch. The shader programs the driver is done compiling are only checked on,
+   * which never waits for the rest.
+   */
+  void continuePreloads()
+  {
+    objectManager.processPendingLoads();
+    textureManager.processPendingUploads(PRELOAD_UPLOAD_BYTES_PER_FRAME);
+    shaderManager.processPendingPrograms();
+  }
+
+  /**
+   * Start loading the objects, textures and shaders of the models of the scene, which the scene waits for once it's
+   * initialized.
+   */
+  virtual void requestAssets() {}
+
+  /**
+   * Release the objects, textures and shaders of the models of the scene.
+   */
+  virtual void releaseAssets() {}
+
+  /**
+   * Release the assets of the scene, if they were requested.
+   */
+  void releaseRequestedAssets()
+  {
+    if (assetsRequested)
+    {
+      // The models only get their assets once they're loaded, so the ones still loading have to finish first.
+      while (objectManager.hasPendingLoads() || textureManager.hasPendingUploads())
+      {
+        objectManager.processPendingLoads();
+        textureManager.processPendingUploads();
+      }
+      assetsRequested = false;
+      releaseAssets();
+    }
+  }
+
 public:
   /**
    * Get the ID of the scene.
@@ -74,6 +153,47 @@ public:
     return sceneName;
   }
 
+  /**
+   * Get the world the scene plays in.
+   * 
+   * @return The world of the scene.
+   */
+  World &getWorld() const
+  {
+    return world;
+  }
+
+  /**
+   * Start loading the assets of the scene in the background, while another scene is still running, so switching to the
+   * scene doesn't have to wait for them. Nothing is requested if the assets already were.
+   */
+  void preload()
+  {
+    if (!assetsRequested)
+    {
+      assetsRequested = true;
+      requestAssets();
+    }
+  }
+
+  /**
+   * Release the assets of a scene that was preloaded but isn't switched to after all.
+   */
+  void cancelPreload()
+  {
+    releaseRequestedAssets();
+  }
+
+  /**
+   * Get the IDs of the scenes that can follow this scene, which are preloaded while this scene is running.
+   *
+   * @return The IDs of the scenes to preload.
+   */
+  virtual const std::vector<std::string> getPreloadSceneIds() const
+  {
+    return {};
+  }
+
   /**
    * Initialize the scene once registered.
    */
@@ -0,0 +1,474 @@
+#ifndef SCENES_SCENE_LOOP_CPP
+#define SCENES_SCENE_LOOP_CPP
+
+#include <functional>
+#include <atomic>
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "../include/constants.cpp"
+#include "../include/window.cpp"
+#include "../include/world.cpp"
+#include "../include/render.cpp"
+#include "../include/debug_render.cpp"
+#include "../include/text.cpp"
+#include "../include/gpu_timer.cpp"
+#include "../include/profiler.cpp"
+#include "../include/frame_time.cpp"
+#include "../include/render_thread.cpp"
+#include "../include/hot_reload.cpp"
+#include "../include/settings.cpp"
+#include "../include/memory.cpp"
+#include "../include/frame_capture.cpp"
+#include "../include/telemetry.cpp"
+#include "../include/hitch_detector.cpp"
+#include "../include/log.cpp"
+
+/**
+ * Structure for the timings of a frame run by the scene loop.
+ */
+struct SceneFrameTimings
+{
+  // The time of the whole frame, including the swap, in milliseconds. With the render thread, the swap of the frame may
+  //   still be going on when the frame finishes, so this is the time of the frame before.
+  float_t frameTime;
+  // The time of the frame until the swap, in milliseconds.
+  float_t processTime;
+  // The time the CPU took to render the scene and the text, in milliseconds.
+  double_t renderTime;
+  float_t textRenderTime;
+  // The time of the profiling zone of the frame, in milliseconds.
+  double_t frameZoneTime;
+  // The number of heap allocations made by every thread during the frame.
+  uint64_t allocationsCount;
+};
+
+/**
+ * Structure for the hooks a scene runs its frames with in the scene loop. Only the update hook has to be given.
+ */
+struct SceneLoopHooks
+{
+  // Prepare the frame before its time is read, such as stepping the clock of a benchmark.
+  std::function<void()> beginFrame;
+  // Read the time of the frame, such as the time of a frame being replayed, which is read from GLFW if not given.
+  std::function<double_t()> readFrameTime;
+  // Update the scene for the frame and add its text, returning whether the loop keeps going.
+  std::function<bool(const FrameTime &)> update;
+  // Render the scene, which the render manager does as is if not given. It runs on the render thread if that's enabled,
+  //   so it's the only hook that can make GL calls.
+  std::function<void(const FrameTime &)> render;
+  // Add the overlays drawn along with the text, only while the text is shown.
+  std::function<void()> addTextOverlay;
+  // Finish the frame once it's swapped, returning whether the loop keeps going.
+  std::function<bool(const SceneFrameTimings &)> endFrame;
+};
+
+/**
+ * Class for the loop the scenes run their frames in, handling what every scene does each frame: the event polling, the
+ *   debug and V-Sync toggles, the timing and profiling of the frame, the render of the scene, the debug models and the
+ *   text, and the swap. The scenes only give the hooks for what they do differently. The GL work of each frame is
+ *   submitted to the render thread, which runs it right away unless the render thread is enabled, so only the render
+ *   hook can make GL calls. The update of the next frame only overlaps with the swap of the frame before, not its
+ *   render, since the render reads the colliders, lists and lights of the models that the update changes.
+ */
+class SceneLoop
+{
+private:
+  WindowManager &windowManager;
+  ControlManager &controlManager;
+  ModelManager &modelManager;
+  CollisionManager &collisionManager;
+  RenderManager &renderManager;
+  DebugRenderManager &debugRenderManager;
+  TextManager &textManager;
+  ProfileManager &profileManager;
+  HotReloadManager &hotReloadManager;
+  SettingsManager &settingsManager;
+  ObjectManager &objectManager;
+  TextureManager &textureManager;
+  ShadowBufferManager &shadowBufferManager;
+  MemoryManager &memoryManager;
+  FrameArena &frameArena;
+  FrameCaptureManager &frameCaptureManager;
+  TelemetryExporter &telemetryExporter;
+
+  // The timers measuring the time the GPU takes to render the debug models and the text.
+  GpuTimer debugRenderGpuTimer;
+  GpuTimer textRenderGpuTimer;
+  // The thread the GL work of the frames is submitted to.
+  RenderThread renderThread;
+  // The detector of the frames that take much longer than the ones before them.
+  HitchDetector hitchDetector;
+
+public:
+  SceneLoop(World &world)
+      : windowManager(WindowManager::getInstance()),
+        controlManager(world.getControlManager()),
+        modelManager(world.getModelManager()),
+        collisionManager(world.getCollisionManager()),
+        renderManager(RenderManager::getInstance()),
+        debugRenderManager(DebugRenderManager::getInstance()),
+        textManager(TextManager::getInstance()),
+        profileManager(ProfileManager::getInstance()),
+        hotReloadManager(HotReloadManager::getInstance()),
+        settingsManager(SettingsManager::getInstance()),
+        objectManager(ObjectManager::getInstance()),
+        textureManager(TextureManager::getInstance()),
+        shadowBufferManager(ShadowBufferManager::getInstance()),
+        memoryManager(MemoryManager::getInstance()),
+        frameArena(FrameArena::getInstance()),
+        frameCaptureManager(FrameCaptureManager::getInstance()),
+        telemetryExporter(TelemetryExporter::getInstance()),
+        debugRenderGpuTimer(),
+        textRenderGpuTimer(),
+        renderThread(),
+        hitchDetector() {}
+
+  // Preventing copying the scene loop, since it owns its GPU timers and the render thread.
+  SceneLoop(const SceneLoop &) = delete;
+
+  /**
+   * Run the frames of the scene until one of its hooks stops the loop, escape is pressed, or the window is closed.
+   *
+   * @param hooks  The hooks of the scene.
+   */
+  void run(const SceneLoopHooks &hooks)
+  {
+    // Consume the leftover events that shouldn't be processed by the scene.
+    controlManager.clearInputEdges();
+    windowManager.isWindowCloseRequested();
+
+    // Set debug mode and debug text to initially false.
+    auto debugEnabled = false;
+    auto textEnabled = false;
+
+    // Start the clock of the frames, which every update of a frame reads the time of the frame from, and only compare
+    //   the frames against the ones of this run when looking for hitches.
+    FrameClock frameClock;
+    hitchDetector.reset();
+
+    // Hand the GL context over to the render thread while the loop runs, if it's enabled.
+    if (RENDER_THREAD_ENABLED)
+    {
+      renderThread.start(windowManager.getWindow());
+    }
+
+    // Start the loop. The time of the whole frame is set by the render thread once the frame is swapped.
+    auto textRenderTimeLast = 0.0f;
+    std::atomic<float_t> frameTimeLast(0.0f);
+    auto processTimeLast = 0.0f;
+    uint32_t textCharsRenderedLast = 0;
+    TextOverlayValue frameTimeValue, processTimeValue, renderTimeValue, textRenderTimeValue;
+    uint64_t allocationsCountLast = 0;
+    uint64_t loopFrame = 0;
+    do
+    {
+      // Start the frame, with every profiling zone of the frame nested under the frame zone, checking the allocation free
+      // zones once the frames have warmed up.
+      profileManager.nextFrame(PROFILE_TRACE_FRAMES);
+      profileManager.setAllocationFreeZonesChecked(ALLOCATION_FREE_ZONES_CHECKED && loopFrame++ >= ALLOCATION_FREE_WARMUP_FRAMES);
+      const auto frameStartAllocationsCount = AllocationCounter::getAllocationsCount();
+      ProfileZone frameZone("Frame");
+
+      // Slow the frames down to the idle frame rate while the window is minimized or unfocused, since nobody is
+      // watching it closely enough to need every frame.
+      const auto windowIdle = IDLE_THROTTLE_ENABLED && windowManager.isWindowIdle();
+      if (windowIdle)
+      {
+        ProfileZone idleWaitZone("Idle Wait");
+        windowManager.waitForIdleTick();
+      }
+
+      // Poll for window events at the start of the frame, right after the swap of the previous one waited for the GPU
+      // in the low latency modes, so the input the frame reacts to is as fresh as it can be.
+      {
+        ProfileZone pollEventsZone("Poll Events");
+        controlManager.pollEvents();
+      }
+
+      if (hooks.beginFrame)
+      {
+        hooks.beginFrame();
+      }
+
+      // Start the frame of the text overlay, which leaves out the text of the frame while it's hidden, or while it's
+      // throttled and this frame isn't the one drawing it again.
+      const auto overlayRefreshed = textManager.beginOverlayFrame(textEnabled, glfwGetTime());
+
+      textManager.addFormattedText(glm::vec2(1, 11), 0.5f, "Window Dimensions: ", WINDOW_WIDTH, "x", WINDOW_HEIGHT, "px");
+      textManager.addFormattedText(glm::vec2(1, 10.5f), 0.5f, "Viewport Dimensions: ", VIEWPORT_WIDTH, "x", VIEWPORT_HEIGHT, "px");
+      textManager.addFormattedText(glm::vec2(1, 10), 0.5f, "Shadow Atlas Dimensions: ", CONE_SHADOW_ATLAS_SIZE, "px (Cone) ", POINT_SHADOW_ATLAS_SIZE, "px (Point) ", DIRECTIONAL_SHADOW_ATLAS_SIZE, "px (Directional)");
+      textManager.addFormattedText(glm::vec2(1, 9.5f), 0.5f, "Text Dimensions: ", TEXT_WIDTH, "x", TEXT_HEIGHT, "px");
+      textManager.addFormattedText(glm::vec2(1, 7.5f), 0.5f, "Initial Text Buffer: ", INITIAL_TEXT_CHARS, " chars");
+
+      textManager.addFormattedText(glm::vec2(1, 7), 0.5f, "VSync Enabled: ", windowManager.getSwapModeName(), " | Low Latency: ", windowManager.getLatencyModeName(), " | Capture: ", (frameCaptureManager.isContinuousCaptureEnabled() ? "On" : "Off"), " (Saved ", frameCaptureManager.getSavedFramesCount(), ", Dropped ", frameCaptureManager.getDroppedFramesCount(), ")");
+
+      // Get the time at the start of the loop, read once for the whole frame.
+      const auto &frameTime = hooks.readFrameTime ? frameClock.tick(hooks.readFrameTime()) : frameClock.tick();
+      const auto &currentTime = frameTime.now;
+
+      // Reload the assets whose files changed, if hot reloading is enabled. The reload needs the GL context, and replaces
+      //   details the models read while updating, so the render thread is waited for before the scene updates.
+      if (hotReloadManager.isCheckDue(currentTime))
+      {
+        ProfileZone hotReloadZone("Hot Reload");
+        renderThread.waitFor(renderThread.submit([&]() { hotReloadManager.reloadChangedAssets(); }));
+      }
+
+      // Apply the settings that changed in the settings file, the same way, since they can reallocate the resources they
+      //   size.
+      if (settingsManager.isCheckDue(currentTime))
+      {
+        ProfileZone settingsReloadZone("Settings Reload");
+        renderThread.waitFor(renderThread.submit([&]() { settingsManager.reloadChangedSettings(); }));
+      }
+
+      // Check if "B" key was pressed for the debug mode toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_B))
+      {
+        // "B" key was pressed. Toggle debug mode.
+        debugEnabled = !debugEnabled;
+      }
+
+      // Check if "T" key was pressed for the debug text toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_T))
+      {
+        // "T" key was pressed. Toggle debug text.
+        textEnabled = !textEnabled;
+      }
+
+      // Check if "V" key was pressed for the vsync toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_V))
+      {
+        // "V" key was pressed. Toggle vsync, which sets the swap interval of the GL context.
+        renderThread.submit([&]() { windowManager.toggleVsync(); });
+      }
+
+      // Check if "I" key was pressed for the latency mode toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_I))
+      {
+        // "I" key was pressed. Move on to the next mode of waiting for the GPU after the swap, which drops the fences of
+        // the frames in flight.
+        renderThread.submit([&]() { windowManager.toggleLatencyMode(); });
+      }
+
+      // Check if "F12" key was pressed for a screenshot.
+      if (controlManager.wasKeyPressed(GLFW_KEY_F12))
+      {
+        // "F12" key was pressed. Capture the next frame once it's drawn, which the render thread reads back.
+        renderThread.submit([&]() { frameCaptureManager.requestScreenshot(); });
+      }
+
+      // Check if "F11" key was pressed for the continuous capture toggle.
+      if (controlManager.wasKeyPressed(GLFW_KEY_F11))
+      {
+        // "F11" key was pressed. Toggle capturing every frame.
+        renderThread.submit([&]() { frameCaptureManager.toggleContinuousCapture(); });
+      }
+
+      // Check if "P" key was pressed for the profile trace export.
+      if (controlManager.wasKeyPressed(GLFW_KEY_P))
+      {
+        // "P" key was pressed. Write the profiling zones of the latest frames to the trace file, once the render thread
+        // is done recording its zones.
+        renderThread.waitForIdle();
+        const auto zonesCount = profileManager.exportChromeTrace(PROFILE_TRACE_FILE, PROFILE_TRACE_FRAMES);
+        Logger::getInstance().info("Exported ", zonesCount, " profiling zones of the last ", PROFILE_TRACE_FRAMES, " frames to ", PROFILE_TRACE_FILE);
+      }
+
+      // Update the scene, stopping before rendering if the scene is done. The scene is kept where it is while the window
+      // is idle if pausing is enabled, with the simulation dropping the time it missed once it's updated again.
+      if (!(IDLE_PAUSE_ENABLED && windowIdle) && !hooks.update(frameTime))
+      {
+        break;
+      }
+
+      // Nothing drawn to a minimized window can be seen, so its frames are neither rendered nor swapped, only dropping
+      // the scratch data and the text of the frame that the render and the swap would have.
+      auto cpuRenderTime = 0.0;
+      if (IDLE_THROTTLE_ENABLED && windowManager.isWindowIconified())
+      {
+        renderThread.waitFor(renderThread.submit([&]() {
+          frameArena.reset();
+          textManager.discardText();
+        }));
+        processTimeLast = (glfwGetTime() - currentTime) * 1000;
+        const auto frameZoneTime = frameZone.end();
+        allocationsCountLast = AllocationCounter::getAllocationsCount() - frameStartAllocationsCount;
+        if (hooks.endFrame && !hooks.endFrame({frameTimeLast.load(), processTimeLast, cpuRenderTime, textRenderTimeLast, frameZoneTime, allocationsCountLast}))
+        {
+          break;
+        }
+        continue;
+      }
+
+      // Render the scene, the debug models and the text. The render thread is waited for once they're submitted, since
+      // they read the state the next frame updates, but not for the swap, which the next frame can overlap with.
+      const auto renderPacket = renderThread.submit([&, frameTime]() {
+        {
+          ProfileZone renderZone("Render");
+          if (hooks.render)
+          {
+            hooks.render(frameTime);
+          }
+          else
+          {
+            renderManager.render(frameTime);
+          }
+          cpuRenderTime = renderZone.end();
+
+          // Aggregate the times changing every frame over the frames between the refreshes of the overlay, which is every
+          // frame unless it's throttled.
+          frameTimeValue.add(frameTimeLast.load());
+          processTimeValue.add(processTimeLast);
+          renderTimeValue.add(cpuRenderTime);
+          textRenderTimeValue.add(textRenderTimeLast);
+          if (overlayRefreshed)
+          {
+            frameTimeValue.refresh();
+            processTimeValue.refresh();
+            renderTimeValue.refresh();
+            textRenderTimeValue.refresh();
+          }
+          textManager.addFormattedText(glm::vec2(1, 2), 0.5f, "Render: ", renderTimeValue.getAverage(), "ms | Max: ", renderTimeValue.getMax(), "ms");
+          textManager.addFormattedText(glm::vec2(1, 15), 0.5f, "Heap Allocations (Last Frame): ", allocationsCountLast, " | Render: ", renderZone.getAllocationsCount(), " | Frame Arena: ", frameArena.getLastFrameUsedSize() / 1024, "/", frameArena.getCapacity() / 1024, "KB | GL Performance Warnings: ", (DEBUG_CONTEXT_ENABLED && windowManager.isDebugOutputSupported() ? std::to_string(GlDebugLog::getInstance().getMessagesCount()) : "Off"));
+        }
+
+        // Check if debug mode is enabled.
+        if (debugEnabled)
+        {
+          // Render the debug models fo the main models and lights.
+          ProfileZone debugRenderZone("Debug Render");
+          debugRenderGpuTimer.begin();
+          debugRenderManager.render();
+          debugRenderGpuTimer.end();
+          textManager.addFormattedText(glm::vec2(1, 2.5f), 0.5f, "Debug Render: ", debugRenderZone.end(), "ms | GPU: ", debugRenderGpuTimer.getElapsedTime(), "ms");
+        }
+
+        // Render text
+        textManager.addFormattedText(glm::vec2(1, 3), 0.5f, "Text Render: ", textRenderTimeValue.getAverage(), "ms | Max: ", textRenderTimeValue.getMax(), "ms | GPU: ", textRenderGpuTimer.getElapsedTime(), "ms");
+        textManager.addFormattedText(glm::vec2(1, 3.5f), 0.5f, "Text Characters Rendered (Last Frame): ", textCharsRenderedLast, " chars");
+
+        textManager.addFormattedText(glm::vec2(1, 4.5f), 0.5f, "Process Time: ", processTimeValue.getAverage(), "ms | Max: ", processTimeValue.getMax(), "ms");
+        textManager.addFormattedText(glm::vec2(1, 5), 0.5f, "Process Rate: ", 1000 / processTimeValue.getAverage(), "fps");
+        textManager.addFormattedText(glm::vec2(1, 5.5f), 0.5f, "Frame Time: ", frameTimeValue.getAverage(), "ms | Max: ", frameTimeValue.getMax(), "ms");
+        textManager.addFormattedText(glm::vec2(1, 6), 0.5f, "Frame Rate: ", 1000 / frameTimeValue.getAverage(), "fps");
+
+        // Report the GPU memory of each manager, which is kept for the benchmark even when the text isn't shown, along with
+        // the memory the driver has left if it says.
+        memoryManager.setGpuSize(MemorySubsystem::OBJECTS, objectManager.getGpuMemorySize());
+        memoryManager.setGpuSize(MemorySubsystem::TEXTURES, textureManager.getGpuMemorySize());
+        memoryManager.setGpuSize(MemorySubsystem::SHADOW_BUFFERS, shadowBufferManager.getGpuMemorySize());
+        memoryManager.setGpuSize(MemorySubsystem::TEXT, textManager.getGpuMemorySize());
+        const auto memorySizes = memoryManager.getSizes();
+        const auto toMegabytes = [](const uint64_t &size) { return size / (1024.0 * 1024.0); };
+        const auto toKilobytes = [](const uint64_t &size) { return size / 1024.0; };
+        uint64_t deviceTotalSize = 0, deviceAvailableSize = 0;
+        if (MemoryManager::queryDeviceMemory(deviceTotalSize, deviceAvailableSize))
+        {
+          textManager.addFormattedText(glm::vec2(1, 8.5f), 0.5f, "GPU Memory: Objects ", toMegabytes(memorySizes.gpuSizes[0]), " | Textures ", toMegabytes(memorySizes.gpuSizes[1]), " | Shadows ", toMegabytes(memorySizes.gpuSizes[2]), " | Text ", toMegabytes(memorySizes.gpuSizes[3]), " | Free ", toMegabytes(deviceAvailableSize), " / ", toMegabytes(deviceTotalSize), "MB");
+        }
+        else
+        {
+          textManager.addFormattedText(glm::vec2(1, 8.5f), 0.5f, "GPU Memory: Objects ", toMegabytes(memorySizes.gpuSizes[0]), " | Textures ", toMegabytes(memorySizes.gpuSizes[1]), " | Shadows ", toMegabytes(memorySizes.gpuSizes[2]), " | Text ", toMegabytes(memorySizes.gpuSizes[3]), "MB");
+        }
+        const auto modelsCount = std::max<uint32_t>(modelManager.getRegisteredModelsCount(), 1);
+        textManager.addFormattedText(glm::vec2(1, 8), 0.5f, "CPU Memory: Objects ", toKilobytes(memorySizes.cpuSizes[0]), " | Textures ", toKilobytes(memorySizes.cpuSizes[1]), " | Shadows ", toKilobytes(memorySizes.cpuSizes[2]), " | Text ", toKilobytes(memorySizes.cpuSizes[3]), " | Models ", toKilobytes(memorySizes.cpuSizes[4]), "KB (", memorySizes.cpuSizes[4] / modelsCount, " bytes each)");
+
+        const double_t dividerPositions[] = {23.5f, 20.5f, 17.5f, 15.5f, 14, 13, 11.5f, 6.5f, 4};
+        for (const auto &yPosition : dividerPositions)
+        {
+          textManager.addText("---------------", glm::vec2(1, yPosition), 0.5f);
+        }
+
+        // Check if debug text is enabled.
+        {
+          ProfileZone textRenderZone("Text Render", true);
+          if (textEnabled)
+          {
+            // Add the overlays of the scene along with the text, since they're only built while the text is shown.
+            if (hooks.addTextOverlay)
+            {
+              hooks.addTextOverlay();
+            }
+            debugRenderManager.renderScreenLines();
+            textRenderGpuTimer.begin();
+            textCharsRenderedLast = textManager.renderOverlay();
+            textRenderGpuTimer.end();
+          }
+          else
+          {
+            textManager.discardText();
+          }
+          textRenderTimeLast = textRenderZone.end();
+        }
+      });
+      // Without the render thread running, the packets run right away, so the frame is processed once the render packet
+      // returns. Take its time before the swap runs, to leave the swap out of it as the render thread does.
+      if (!renderThread.isRunning())
+      {
+        processTimeLast = (glfwGetTime() - currentTime) * 1000;
+      }
+      const auto swapStartTime = currentTime;
+      renderThread.submit([&, swapStartTime]() {
+        // Capture the frame before it's swapped if it was asked for, without waiting for the frames captured before.
+        {
+          ProfileZone frameCaptureZone("Frame Capture");
+          frameCaptureManager.captureFrame();
+        }
+
+        // Swap the window framebuffers.
+        {
+          ProfileZone swapBuffersZone("Swap Buffers");
+          windowManager.swapBuffers();
+        }
+        frameTimeLast = (glfwGetTime() - swapStartTime) * 1000;
+      });
+      {
+        ProfileZone waitForRenderZone("Wait For Render");
+        renderThread.waitFor(renderPacket);
+      }
+      if (renderThread.isRunning())
+      {
+        processTimeLast = (glfwGetTime() - currentTime) * 1000;
+      }
+
+      // Let the scene finish the frame with its timings, stopping the loop if the scene is done.
+      const auto frameZoneTime = frameZone.end();
+      allocationsCountLast = AllocationCounter::getAllocationsCount() - frameStartAllocationsCount;
+      // Push the measurements of the frame to the telemetry exporter, if it's running, without waiting for it.
+      if (telemetryExporter.isRunning())
+      {
+        telemetryExporter.addFrame({frameZoneTime, cpuRenderTime, renderManager.getGpuRenderTime(), renderManager.getRenderStats(),
+                                    modelManager.getRegisteredModelsCount(), collisionManager.getNarrowphaseChecksCount(), allocationsCountLast, memoryManager.getSizes()});
+      }
+      // Look for a hitch among the frames the window wasn't idle for, since the idle frames are slowed down on purpose. If
+      //   the frame was one, write the latest frames to a trace once the render thread is done recording its zones.
+      const auto hitchMedianFrameTime = windowIdle ? 0.0 : hitchDetector.addFrame(frameZoneTime);
+      if (hitchMedianFrameTime > 0.0)
+      {
+        renderThread.waitForIdle();
+        const auto traceFilePath = hitchDetector.writeTrace({frameZoneTime, cpuRenderTime, renderManager.getGpuRenderTime(), renderManager.getRenderStats(),
+                                                             modelManager.getRegisteredModelsCount(), collisionManager.getNarrowphaseChecksCount(), allocationsCountLast, memoryManager.getSizes()},
+                                                            hitchMedianFrameTime);
+        Logger::getInstance().warning("Hitch of ", frameZoneTime, " ms against a median of ", hitchMedianFrameTime, " ms, wrote the last ", PROFILE_TRACE_FRAMES, " frames to ", traceFilePath);
+      }
+      if (hooks.endFrame && !hooks.endFrame({frameTimeLast.load(), processTimeLast, cpuRenderTime, textRenderTimeLast, frameZoneTime, allocationsCountLast}))
+      {
+        break;
+      }
+
+      // Continue loop as long as escape key isn't pressed or the window close is not requested.
+    } while (!controlManager.wasKeyPressed(GLFW_KEY_ESCAPE) &&
+             !windowManager.isWindowCloseRequested());
+
+    // Take the GL context back once the render thread is done, so the scene can clean up.
+    renderThread.stop();
+
+    // Write out the frames still being captured, so the scene can clean up the GL objects.
+    frameCaptureManager.finishCaptures();
+  }
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef SCENES_SIMULATED_GAME_CPP
+#define SCENES_SIMULATED_GAME_CPP
+
+#include <string>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "../include/constants.cpp"
+#include "../include/world.cpp"
+#include "../include/object.cpp"
+#include "../include/frame_time.cpp"
+#include "../include/benchmark.cpp"
+
+#include "../models/enemy_model.cpp"
+#include "../models/player_model.cpp"
+#include "../models/shot_model.cpp"
+
+/**
+ * Class for the game scene simulated headless in a world of its own, playing the grid of enemies and the scripted keys
+ *   of a benchmark scenario through the same simulation steps as the game scene, with the time of each step given to the
+ *   models instead of read from a clock. The objects only keep the bounds of their meshes, the textures and shaders
+ *   aren't loaded and the lights are left out, since they only matter to rendering. Each thread simulates one game at a
+ *   time, since the shots are pooled for each thread.
+ */
+class SimulatedGame
+{
+private:
+  // The scenario the game plays.
+  const BenchmarkScenario scenario;
+  // The world the game is simulated in, and its managers.
+  World world;
+  ModelManager &modelManager;
+  CollisionManager &collisionManager;
+  AttachmentManager &attachmentManager;
+  ProjectileManager &projectileManager;
+  ControlManager &controlManager;
+  // The number of steps simulated so far.
+  uint32_t stepsCount;
+
+public:
+  /**
+   * Set up the settings shared by the games simulated for the scenario, and load the objects of their models, once
+   *   before any of the games are created.
+   *
+   * @param scenario  The scenario the games play.
+   */
+  static void prepare(const BenchmarkScenario &scenario)
+  {
+    // Nothing is created on the GPU from here on.
+    HEADLESS_ENABLED = true;
+    PlayerModel::setShotInterval(scenario.shotInterval);
+    PlayerModel::setEyeLightEnabled(false);
+    ShotModel::setShotLightsEnabled(false);
+    DeepCollisionValidator::setSeparatingAxisBoxTestEnabled(scenario.separatingAxisBoxTestEnabled);
+    // The shots destroy the enemies they hit, in every game, since the pairs of collision layers are shared by the worlds.
+    CollisionManager::getInstance().registerCollisionPair(COLLISION_LAYER_SHOT, COLLISION_LAYER_ENEMY);
+
+    // Load the objects of the models, whose bounds the colliders are made from.
+    auto &objectManager = ObjectManager::getInstance();
+    EnemyModel::initModel();
+    PlayerModel::initModel();
+    ShotModel::initModel();
+    while (objectManager.hasPendingLoads())
+    {
+      objectManager.processPendingLoads();
+    }
+  }
+
+  /**
+   * Create the game, with the enemies laid out in the grid of the scenario as the game scene lays them out.
+   *
+   * @param scenario  The scenario the game plays.
+   * @param seed      The seed of the random number generators of the game.
+   */
+  SimulatedGame(const BenchmarkScenario &scenario, const uint32_t &seed)
+      : scenario(scenario),
+        world(),
+        modelManager(world.getModelManager()),
+        collisionManager(world.getCollisionManager()),
+        attachmentManager(world.getAttachmentManager()),
+        projectileManager(world.getProjectileManager()),
+        controlManager(world.getControlManager()),
+        stepsCount(0)
+  {
+    WorldScope worldScope(world);
+    EnemyModel::seedRandomGenerator(seed);
+
+    const auto &gridSize = scenario.enemyGridSize;
+    for (uint32_t x = 0; x < gridSize.x; x++)
+    {
+      for (uint32_t y = 0; y < gridSize.y; y++)
+      {
+        for (uint32_t z = 0; z < gridSize.z; z++)
+        {
+          const auto enemyModel = EnemyModel::create("Enemy" + std::to_string((gridSize.y * gridSize.z * x) + (gridSize.z * y) + z));
+          enemyModel->setModelPosition(glm::vec3(x - (gridSize.x - 1) / 2.0f, y - (gridSize.y - 1) / 2.0f, z - (gridSize.z - 1.0f)) * 5.0f);
+          modelManager.registerModel(enemyModel);
+        }
+      }
+    }
+    modelManager.registerModel(PlayerModel::create("MainPlayer"));
+
+    const auto projectileModel = ShotModel::create("Projectile");
+    projectileModel->setModelRotation(glm::vec3(0.0f, glm::radians(180.0f), 0.0f));
+    projectileManager.setProjectileModel(projectileModel);
+    modelManager.initAllModels();
+  }
+
+  // Preventing copying the game, since the models in its world hold on to its managers.
+  SimulatedGame(const SimulatedGame &) = delete;
+
+  ~SimulatedGame()
+  {
+    // The shots left in the pool of the thread were created in the world of the game, so they go before it does.
+    WorldScope worldScope(world);
+    ShotModel::clearPool();
+  }
+
+  /**
+   * Step the simulation once, in the same order as the game scene steps it, with the keys of the scenario for the step.
+   */
+  void step()
+  {
+    WorldScope worldScope(world);
+    controlManager.setScriptedKeys(scenario.getKeysAtFrame(stepsCount));
+    const FrameTime stepTime({(stepsCount + 1) * SIMULATION_TIME_STEP, float_t(SIMULATION_TIME_STEP), stepsCount});
+    stepsCount++;
+
+    modelManager.storePreviousTransformations();
+    projectileManager.storePreviousPositions();
+    modelManager.updateAllModels(stepTime);
+    attachmentManager.updateAttachments();
+    collisionManager.updateCollisions(stepTime);
+    projectileManager.updateProjectiles(stepTime);
+    modelManager.removeDeregisteredModels();
+  }
+
+  /**
+   * Step the simulation until the game is finished.
+   */
+  void run()
+  {
+    while (!isFinished())
+    {
+      step();
+    }
+  }
+
+  /**
+   * Check if the game is finished, which is once every frame of the scenario was simulated or every enemy is destroyed.
+   *
+   * @return Whether the game is finished.
+   */
+  bool isFinished() const
+  {
+    return stepsCount >= scenario.warmupFramesCount + scenario.framesCount || getEnemiesCount() == 0;
+  }
+
+  /**
+   * Get the number of steps simulated so far.
+   *
+   * @return The number of steps.
+   */
+  const uint32_t &getStepsCount() const
+  {
+    return stepsCount;
+  }
+
+  /**
+   * Get the number of enemies left in the game.
+   *
+   * @return The number of enemies.
+   */
+  uint32_t getEnemiesCount() const
+  {
+    return modelManager.getRegisteredModelsCount<EnemyModel>();
+  }
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+
+#include "../include/mesh.cpp"
+#include "../include/image.cpp"
+
+/**
+ * Check if the file path ends with the given extension.
+ *
+ * @param filePath   The file path to check.
+ * @param extension  The extension to look for, including the dot.
+ *
+ * @return Whether the file path has the extension.
+ */
+bool hasExtension(const std::string &filePath, const std::string &extension)
+{
+	return filePath.size() >= extension.size() && filePath.compare(filePath.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/**
+ * Bake the OBJ object file into a binary mesh file next to it.
+ *
+ * @param objectFilePath  The file path to the OBJ file.
+ * @param vertexFormat    The format to store the vertices of the mesh in, where the mesh allows it.
+ *
+ * @return Whether the object was baked.
+ */
+bool bakeObject(const std::string &objectFilePath, const MeshVertexFormat &vertexFormat)
+{
+	// Parse the object file and write it as a binary mesh file.
+	const auto meshFilePath = MeshLoader::getMeshFilePath(objectFilePath);
+	auto meshData = MeshLoader::parseObjFile(objectFilePath, objectFilePath);
+	if (vertexFormat == MeshVertexFormat::COMPACT)
+	{
+		MeshLoader::compactMesh(meshData);
+	}
+	if (!MeshLoader::writeMeshFile(meshFilePath, MeshLoader::getFileSize(objectFilePath), vertexFormat, meshData))
+	{
+		return false;
+	}
+
+	std::cout << "Baked " << objectFilePath << " (" << meshData.vertices.size() << " vertices, " << meshData.indices.size() << " indices" << (meshData.vertexFormat == MeshVertexFormat::COMPACT ? ", compact" : "") << ", " << meshData.lods.size() << " levels of detail, " << meshData.meshlets.size() << " meshlets, ACMR " << meshData.acmrBefore << " -> " << meshData.acmrAfter << ")" << std::endl;
+	return true;
+}
+
+/**
+ * Bake the BMP image file into a mip-mapped, BC1 compressed DDS file next to it.
+ *
+ * @param imageFilePath  The file path to the BMP file.
+ *
+ * @return Whether the image was baked.
+ */
+bool bakeImage(const std::string &imageFilePath)
+{
+	// Read the image, compress it along with its mip chain, and write it as a DDS file.
+	const auto ddsFilePath = ImageLoader::getCompressedFilePath(imageFilePath);
+	const auto compressedImageData = ImageLoader::compressBc1(ImageLoader::readBmpFile(imageFilePath, imageFilePath));
+	if (!ImageLoader::writeDdsFile(ddsFilePath, compressedImageData))
+	{
+		return false;
+	}
+
+	std::cout << "Baked " << imageFilePath << " (" << compressedImageData.width << "x" << compressedImageData.height << ", " << compressedImageData.levels.size() << " mip levels)" << std::endl;
+	return true;
+}
+
+/**
+ * Offline asset baker. Converts the given OBJ object files into binary mesh files, and the given BMP image files into
+ * compressed DDS files, next to them, so the game never has to parse or compress them at load time. The OBJ files after
+ * "--compact" are baked with the compact vertex format, which the game has to ask for when loading them.
+ *
+ * Usage: asset_baker <object.obj|image.bmp>... [--compact <object.obj>...]
+ */
+int main(int argc, char **argv)
+{
+	// Check if any files were given to bake.
+	if (argc < 2)
+	{
+		std::cout << "Usage: " << argv[0] << " <object.obj|image.bmp>... [--compact <object.obj>...]" << std::endl;
+		return 1;
+	}
+
+	// Iterate through the given asset files.
+	auto vertexFormat = MeshVertexFormat::FULL;
+	for (int i = 1; i < argc; i++)
+	{
+		// Bake the objects after the compact flag with the compact vertex format.
+		const std::string assetFilePath = argv[i];
+		if (assetFilePath == "--compact")
+		{
+			vertexFormat = MeshVertexFormat::COMPACT;
+			continue;
+		}
+
+		// Bake the asset based on its type.
+		if (hasExtension(assetFilePath, ".obj") ? !bakeObject(assetFilePath, vertexFormat) : hasExtension(assetFilePath, ".bmp") ? !bakeImage(assetFilePath) : true)
+		{
+			// Could not bake the asset. Time to crash.
+			std::cout << assetFilePath << std::endl
+								<< "Failed at asset baker 1" << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
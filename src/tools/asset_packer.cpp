@@ -0,0 +1,60 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <filesystem>
+
+#include "../include/asset_archive.cpp"
+
+/**
+ * Offline asset packer. Packs every file under the given directories into an asset archive, each named by its path from
+ * the working directory, which is the path the game loads it from when run from the same directory. The files that
+ * compress well are compressed with LZ4 when "--compress" is given.
+ *
+ * Usage: asset_packer <archive> <directory>... [--compress]
+ */
+int main(int argc, char **argv)
+{
+	// Check if an archive and any directories were given to pack.
+	const auto compress = argc >= 2 && std::string(argv[argc - 1]) == "--compress";
+	const auto argumentsCount = compress ? argc - 1 : argc;
+	if (argumentsCount < 3)
+	{
+		std::cout << "Usage: " << argv[0] << " <archive> <directory>... [--compress]" << std::endl;
+		return 1;
+	}
+
+	// Gather the files under the given directories.
+	std::vector<std::pair<std::string, std::string>> files;
+	for (int i = 2; i < argumentsCount; i++)
+	{
+		std::error_code errorCode;
+		for (std::filesystem::recursive_directory_iterator entry(argv[i], errorCode), end; !errorCode && entry != end; entry.increment(errorCode))
+		{
+			if (entry->is_regular_file())
+			{
+				const auto filePath = entry->path().generic_string();
+				files.push_back(std::make_pair(filePath, filePath));
+			}
+		}
+		if (errorCode)
+		{
+			// Could not read the directory. Time to crash.
+			std::cout << argv[i] << std::endl
+								<< "Failed at asset packer 1" << std::endl;
+			return 1;
+		}
+	}
+
+	// Pack the files into the archive.
+	if (!AssetFileSystem::writeArchive(argv[1], files, compress))
+	{
+		// Could not write the archive. Time to crash.
+		std::cout << argv[1] << std::endl
+							<< "Failed at asset packer 2" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Packed " << files.size() << " files into " << argv[1] << std::endl;
+	return 0;
+}
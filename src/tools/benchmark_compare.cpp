@@ -0,0 +1,143 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "../include/json_reader.cpp"
+
+/**
+ * Write the baseline back out with the values of its metrics replaced by the given results.
+ *
+ * @param baselineFilePath  The path of the baseline file.
+ * @param baseline          The baseline, with the values of its metrics already replaced.
+ *
+ * @return Whether the baseline could be written.
+ */
+bool writeBaseline(const std::string &baselineFilePath, const JsonValue &baseline)
+{
+	std::ofstream baselineFile(baselineFilePath, std::ios::out | std::ios::trunc);
+	if (!baselineFile.is_open())
+	{
+		return false;
+	}
+
+	const auto &scenarios = baseline.members.at("scenarios").members;
+	baselineFile << "{\n  \"scenarios\": {";
+	for (auto scenario = scenarios.begin(); scenario != scenarios.end(); scenario++)
+	{
+		baselineFile << (scenario == scenarios.begin() ? "" : ",") << "\n    \"" << scenario->first << "\": {";
+		for (auto metric = scenario->second.members.begin(); metric != scenario->second.members.end(); metric++)
+		{
+			baselineFile << (metric == scenario->second.members.begin() ? "" : ",") << "\n      \"" << metric->first << "\": {\"value\": "
+									 << metric->second.members.at("value").number << ", \"tolerance\": " << metric->second.members.at("tolerance").number << "}";
+		}
+		baselineFile << "\n    }";
+	}
+	baselineFile << "\n  }\n}\n";
+	return true;
+}
+
+/**
+ * Benchmark regression check. Compares the results of the benchmark scenarios in the given directory against a baseline,
+ * and fails if any metric of the baseline went up by more than its tolerance, given as a fraction of its value. Every
+ * metric is one where lower is better, like frame times and draw calls. Metrics without a value yet, such as in a
+ * baseline never recorded on the reference machine, are only reported. With --update, the baseline is rewritten with
+ * the values of the results instead, keeping its tolerances.
+ *
+ * Usage: benchmark_compare <baseline.json> <results directory> [--update]
+ */
+int main(int argc, char **argv)
+{
+	// Check if the baseline and the results directory were given.
+	if (argc != 3 && !(argc == 4 && std::string(argv[3]) == "--update"))
+	{
+		std::cout << "Usage: " << argv[0] << " <baseline.json> <results directory> [--update]" << std::endl;
+		return 1;
+	}
+	const std::string baselineFilePath = argv[1];
+	const std::string resultsDirectoryPath = argv[2];
+	const auto update = argc == 4;
+
+	JsonValue baseline;
+	if (!JsonReader::readFile(baselineFilePath, baseline) || baseline.members.count("scenarios") == 0)
+	{
+		// Could not read the baseline. Time to crash.
+		std::cout << baselineFilePath << std::endl
+							<< "Failed at benchmark compare 1" << std::endl;
+		return 1;
+	}
+
+	// Iterate through the scenarios of the baseline, comparing each of their metrics against the results of the scenario.
+	uint32_t regressionsCount = 0;
+	uint32_t unsetMetricsCount = 0;
+	for (auto &scenario : baseline.members["scenarios"].members)
+	{
+		const auto resultsFilePath = resultsDirectoryPath + "/benchmark-" + scenario.first + ".json";
+		JsonValue results;
+		if (!JsonReader::readFile(resultsFilePath, results))
+		{
+			// Could not read the results of the scenario. Time to crash.
+			std::cout << resultsFilePath << std::endl
+								<< "Failed at benchmark compare 2" << std::endl;
+			return 1;
+		}
+
+		for (auto &metric : scenario.second.members)
+		{
+			double_t result = 0.0;
+			if (!findMetric(results, metric.first, result))
+			{
+				// The results don't have the metric. Time to crash.
+				std::cout << scenario.first << " " << metric.first << std::endl
+									<< "Failed at benchmark compare 3" << std::endl;
+				return 1;
+			}
+
+			// Report the metrics that have no value to compare against yet, until the baseline is recorded.
+			if (!update && metric.second.members.count("value") == 0)
+			{
+				std::cout << "UNSET " << scenario.first << " " << metric.first << ": " << result << std::endl;
+				unsetMetricsCount++;
+				continue;
+			}
+
+			auto &baselineValue = metric.second.members["value"].number;
+			const auto &tolerance = metric.second.members["tolerance"].number;
+			const auto limit = baselineValue * (1.0 + tolerance);
+			const auto regressed = result > limit;
+			std::cout << (update ? "UPDATE " : regressed ? "REGRESSED " : "OK ") << scenario.first << " " << metric.first << ": "
+								<< result << " (baseline " << baselineValue << ", limit " << limit << ")" << std::endl;
+			if (update)
+			{
+				baselineValue = result;
+			}
+			else if (regressed)
+			{
+				regressionsCount++;
+			}
+		}
+	}
+
+	if (update)
+	{
+		if (!writeBaseline(baselineFilePath, baseline))
+		{
+			// Could not write the baseline. Time to crash.
+			std::cout << baselineFilePath << std::endl
+								<< "Failed at benchmark compare 4" << std::endl;
+			return 1;
+		}
+		std::cout << "Updated " << baselineFilePath << std::endl;
+		return 0;
+	}
+
+	if (unsetMetricsCount > 0)
+	{
+		std::cout << unsetMetricsCount << " metrics have no baseline yet, run perf_bench_update on the reference machine to record them" << std::endl;
+	}
+	if (regressionsCount > 0)
+	{
+		std::cout << regressionsCount << " metrics regressed beyond their tolerance" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,360 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../include/json_reader.cpp"
+
+/**
+ * Structure for defining a setting compared by the benchmark matrix, along with the values it's compared with.
+ */
+struct MatrixSetting
+{
+	// The name of the setting, as it's written in the settings file.
+	std::string name;
+	// The values the setting takes, in the order they're compared in.
+	std::vector<std::string> values;
+};
+
+/**
+ * Structure for defining a benchmark matrix, which runs each benchmark scenario with every combination of the values of
+ * the compared settings, a number of times each.
+ */
+struct BenchmarkMatrix
+{
+	// The benchmark scenarios run with each configuration.
+	std::vector<std::string> scenarios;
+	// The metrics of the benchmark results compared, by their paths in the results, such as "frameTime.p95".
+	std::vector<std::string> metrics;
+	// The number of times each scenario is run with each configuration, whose results are compared.
+	uint32_t repetitions;
+	// The number of times each scenario is run with each configuration before the repetitions, whose results are left
+	//   out, so the caches of the files and the shader programs are warm for the measured runs.
+	uint32_t warmupRuns;
+	// The compared settings.
+	std::vector<MatrixSetting> settings;
+};
+
+// A configuration of the benchmark matrix, as the names and values of the compared settings.
+typedef std::vector<std::pair<std::string, std::string>> MatrixConfiguration;
+
+/**
+ * Split the text into its words, separated by whitespace or by the given separator.
+ *
+ * @param text       The text.
+ * @param separator  The character separating the words, along with whitespace.
+ *
+ * @return The words.
+ */
+std::vector<std::string> splitWords(const std::string &text, const char &separator)
+{
+	std::string spacedText(text);
+	std::replace(spacedText.begin(), spacedText.end(), separator, ' ');
+	std::istringstream textStream(spacedText);
+	std::vector<std::string> words({});
+	std::string word;
+	while (textStream >> word)
+	{
+		words.push_back(word);
+	}
+	return words;
+}
+
+/**
+ * Read the benchmark matrix from a file of lines of "name = value", like the settings file, with anything after a "#"
+ * left out. The "scenarios" and "metrics" lines list their values separated by spaces, "repetitions" and "warmup_runs"
+ * are numbers, and every other line is a setting compared with its values separated by "|".
+ *
+ * @param filePath  The path to the matrix file.
+ * @param matrix    The matrix to store the read matrix to.
+ *
+ * @return Whether the matrix file could be read and has at least one scenario, metric and repetition.
+ */
+bool readMatrix(const std::string &filePath, BenchmarkMatrix &matrix)
+{
+	std::ifstream matrixFile(filePath);
+	if (!matrixFile.is_open())
+	{
+		return false;
+	}
+	matrix = {{}, {"frameTime.mean", "frameTime.p95", "cpuRenderTime.mean", "gpuRenderTime.mean"}, 5, 1, {}};
+	std::string line;
+	while (std::getline(matrixFile, line))
+	{
+		line = line.substr(0, line.find('#'));
+		const auto separator = line.find('=');
+		if (separator == std::string::npos)
+		{
+			continue;
+		}
+		const auto names = splitWords(line.substr(0, separator), ' ');
+		if (names.size() != 1)
+		{
+			return false;
+		}
+		const auto &name = names[0];
+		const auto value = line.substr(separator + 1);
+		if (name == "scenarios")
+		{
+			matrix.scenarios = splitWords(value, ' ');
+		}
+		else if (name == "metrics")
+		{
+			matrix.metrics = splitWords(value, ' ');
+		}
+		else if (name == "repetitions" || name == "warmup_runs")
+		{
+			(name == "repetitions" ? matrix.repetitions : matrix.warmupRuns) = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+		}
+		else
+		{
+			matrix.settings.push_back({name, splitWords(value, '|')});
+			if (matrix.settings.back().values.empty())
+			{
+				return false;
+			}
+		}
+	}
+	return !matrix.scenarios.empty() && !matrix.metrics.empty() && matrix.repetitions > 0;
+}
+
+/**
+ * Get every combination of the values of the compared settings, with the first value of each setting in the first
+ * configuration, which the others are compared against.
+ *
+ * @param matrix  The benchmark matrix.
+ *
+ * @return The configurations.
+ */
+std::vector<MatrixConfiguration> getConfigurations(const BenchmarkMatrix &matrix)
+{
+	std::vector<MatrixConfiguration> configurations({{}});
+	for (const auto &setting : matrix.settings)
+	{
+		std::vector<MatrixConfiguration> expandedConfigurations({});
+		for (const auto &configuration : configurations)
+		{
+			for (const auto &value : setting.values)
+			{
+				expandedConfigurations.push_back(configuration);
+				expandedConfigurations.back().push_back({setting.name, value});
+			}
+		}
+		configurations = expandedConfigurations;
+	}
+	return configurations;
+}
+
+/**
+ * Get the name of a configuration, for the comparison table.
+ *
+ * @param configuration  The configuration.
+ *
+ * @return The values of the settings of the configuration, or "defaults" if it has none.
+ */
+std::string getConfigurationName(const MatrixConfiguration &configuration)
+{
+	std::string name;
+	for (const auto &setting : configuration)
+	{
+		name += (name.empty() ? "" : " ") + setting.first + "=" + setting.second;
+	}
+	return name.empty() ? "defaults" : name;
+}
+
+/**
+ * Run a benchmark scenario with a configuration, by running the game with a settings file holding the settings of the
+ * configuration, and read its results.
+ *
+ * @param mainFilePath   The path to the game.
+ * @param mainOptions    The options given to the game after the scenario, each starting with a space.
+ * @param scenario       The name of the scenario.
+ * @param configuration  The configuration.
+ * @param results        The results to store the read results of the scenario to.
+ *
+ * @return Whether the scenario ran and its results could be read.
+ */
+bool runBenchmark(const std::string &mainFilePath, const std::string &mainOptions, const std::string &scenario, const MatrixConfiguration &configuration, JsonValue &results)
+{
+	const std::string settingsFilePath = "benchmark-matrix.cfg";
+	std::ofstream settingsFile(settingsFilePath, std::ios::out | std::ios::trunc);
+	if (!settingsFile.is_open())
+	{
+		return false;
+	}
+	for (const auto &setting : configuration)
+	{
+		settingsFile << setting.first << " = " << setting.second << "\n";
+	}
+	settingsFile.close();
+
+	// Remove the results of the last run, so a run that fails to write its results isn't read as this one.
+	const auto resultsFilePath = "benchmark-" + scenario + ".json";
+	std::remove(resultsFilePath.c_str());
+	const auto command = "\"" + mainFilePath + "\" --benchmark " + scenario + mainOptions + " --quiet --settings " + settingsFilePath;
+	return std::system(command.c_str()) == 0 && JsonReader::readFile(resultsFilePath, results);
+}
+
+/**
+ * Get the 97.5th percentile of Student's t-distribution with the given degrees of freedom, which the 95% confidence
+ * interval of a mean spans on either side of it, in standard errors.
+ *
+ * @param degreesOfFreedom  The degrees of freedom, one less than the number of values.
+ *
+ * @return The percentile.
+ */
+double_t getStudentTQuantile(const uint32_t &degreesOfFreedom)
+{
+	static const double_t quantiles[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+																						2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+																						2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+	// Past the table, the distribution is close enough to the normal one.
+	return degreesOfFreedom - 1 < sizeof(quantiles) / sizeof(quantiles[0]) ? quantiles[degreesOfFreedom - 1] : 1.960;
+}
+
+/**
+ * Get the mean of the values and the half width of its 95% confidence interval.
+ *
+ * @param values  The values, one per repetition.
+ *
+ * @return The mean and the half width, which is 0 for a single value.
+ */
+std::pair<double_t, double_t> getMeanConfidenceInterval(const std::vector<double_t> &values)
+{
+	double_t sum = 0.0;
+	for (const auto &value : values)
+	{
+		sum += value;
+	}
+	const auto mean = sum / values.size();
+	if (values.size() < 2)
+	{
+		return {mean, 0.0};
+	}
+	double_t squaredDeviationsSum = 0.0;
+	for (const auto &value : values)
+	{
+		squaredDeviationsSum += (value - mean) * (value - mean);
+	}
+	const auto standardError = std::sqrt(squaredDeviationsSum / (values.size() - 1) / values.size());
+	return {mean, getStudentTQuantile(values.size() - 1) * standardError};
+}
+
+/**
+ * Benchmark configuration comparison. Runs each benchmark scenario of the matrix file with every combination of the
+ * values of its compared settings, first the warmup runs and then the repetitions, and prints a table per scenario of
+ * the mean of each compared metric over the repetitions with its 95% confidence interval. Every configuration is also
+ * compared against the first one by the first metric, marked with a "*" where their confidence intervals don't overlap.
+ * Must be run from the directory the game runs in. The options after the game are given to it on every run, such as
+ * --offscreen.
+ *
+ * Usage: benchmark_matrix <matrix file> <game executable> [game options...]
+ */
+int main(int argc, char **argv)
+{
+	// Check if the matrix file and the game were given.
+	if (argc < 3)
+	{
+		std::cout << "Usage: " << argv[0] << " <matrix file> <game executable> [game options...]" << std::endl;
+		return 1;
+	}
+	const std::string matrixFilePath = argv[1];
+	const std::string mainFilePath = argv[2];
+	std::string mainOptions;
+	for (auto i = 3; i < argc; i++)
+	{
+		mainOptions += " " + std::string(argv[i]);
+	}
+
+	BenchmarkMatrix matrix;
+	if (!readMatrix(matrixFilePath, matrix))
+	{
+		// Could not read the matrix. Time to crash.
+		std::cout << matrixFilePath << std::endl
+							<< "Failed at benchmark matrix 1" << std::endl;
+		return 1;
+	}
+	const auto configurations = getConfigurations(matrix);
+	std::cout << "Comparing " << configurations.size() << " configurations on " << matrix.scenarios.size() << " scenarios, with "
+						<< matrix.warmupRuns << " warmup runs and " << matrix.repetitions << " repetitions each" << std::endl;
+
+	for (const auto &scenario : matrix.scenarios)
+	{
+		// Run the scenario with every configuration, collecting the values of the metrics of each repetition.
+		std::vector<std::vector<std::pair<double_t, double_t>>> summaries({});
+		for (const auto &configuration : configurations)
+		{
+			std::vector<std::vector<double_t>> metricValues(matrix.metrics.size());
+			for (uint32_t run = 0; run < matrix.warmupRuns + matrix.repetitions; run++)
+			{
+				std::cout << scenario << " " << getConfigurationName(configuration) << " " << (run < matrix.warmupRuns ? "warmup " + std::to_string(run + 1) : "run " + std::to_string(run - matrix.warmupRuns + 1)) << std::endl;
+				JsonValue results;
+				if (!runBenchmark(mainFilePath, mainOptions, scenario, configuration, results))
+				{
+					// The scenario failed to run. Time to crash.
+					std::cout << scenario << " " << getConfigurationName(configuration) << std::endl
+										<< "Failed at benchmark matrix 2" << std::endl;
+					return 1;
+				}
+				for (size_t i = 0; i < matrix.metrics.size() && run >= matrix.warmupRuns; i++)
+				{
+					double_t value = 0.0;
+					if (!findMetric(results, matrix.metrics[i], value))
+					{
+						// The results don't have the metric. Time to crash.
+						std::cout << scenario << " " << matrix.metrics[i] << std::endl
+											<< "Failed at benchmark matrix 3" << std::endl;
+						return 1;
+					}
+					metricValues[i].push_back(value);
+				}
+			}
+			summaries.push_back({});
+			for (const auto &values : metricValues)
+			{
+				summaries.back().push_back(getMeanConfidenceInterval(values));
+			}
+		}
+
+		// Print the table of the scenario, with a row per configuration and a column per metric.
+		size_t nameWidth = std::string("Configuration").size();
+		for (const auto &configuration : configurations)
+		{
+			nameWidth = std::max(nameWidth, getConfigurationName(configuration).size());
+		}
+		const int32_t columnWidth = 22;
+		std::cout << std::endl
+							<< scenario << std::endl
+							<< std::left << std::setw(nameWidth) << "Configuration";
+		for (const auto &metric : matrix.metrics)
+		{
+			std::cout << " | " << std::setw(columnWidth) << metric;
+		}
+		std::cout << " | " << matrix.metrics[0] << " vs first" << std::endl;
+		for (size_t i = 0; i < configurations.size(); i++)
+		{
+			std::cout << std::left << std::setw(nameWidth) << getConfigurationName(configurations[i]);
+			for (const auto &summary : summaries[i])
+			{
+				std::ostringstream cell;
+				cell << std::fixed << std::setprecision(3) << summary.first << " +/- " << summary.second;
+				std::cout << " | " << std::setw(columnWidth) << cell.str();
+			}
+			const auto &first = summaries[0][0];
+			const auto &current = summaries[i][0];
+			const auto overlapping = std::abs(current.first - first.first) <= current.second + first.second;
+			std::ostringstream difference;
+			difference << std::showpos << std::fixed << std::setprecision(1) << (first.first == 0.0 ? 0.0 : (current.first / first.first - 1.0) * 100.0) << "%" << (overlapping ? "" : " *");
+			std::cout << " | " << (i == 0 ? std::string("-") : difference.str()) << std::endl;
+		}
+		std::cout << std::endl;
+	}
+	return 0;
+}